@@ -30,6 +30,8 @@
 #ifndef __AMBI_BIN_H_INCLUDED__
 #define __AMBI_BIN_H_INCLUDED__
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -52,8 +54,19 @@ typedef enum _AMBI_BIN_INPUT_ORDERS{
     
 }AMBI_BIN_INPUT_ORDERS;
     
-/** Maximum supported Ambisonic order */
-#define AMBI_BIN_MAX_SH_ORDER ( 7 )
+/**
+ * Maximum supported Ambisonic order; which sizes the decoding matrices of each
+ * instance. With the embedded profile (see SAF_EMBEDDED_PROFILE), it is
+ * SAF_EMBEDDED_MAX_SH_ORDER instead (default: 3), and higher orders are
+ * clamped to it
+ */
+#if !defined(SAF_EMBEDDED_PROFILE)
+# define AMBI_BIN_MAX_SH_ORDER ( 7 )
+#elif defined(SAF_EMBEDDED_MAX_SH_ORDER)
+# define AMBI_BIN_MAX_SH_ORDER ( SAF_EMBEDDED_MAX_SH_ORDER )
+#else
+# define AMBI_BIN_MAX_SH_ORDER ( 3 )
+#endif
     
 /**
  * Available decoding methods for the ambi_bin example. See saf_hoa_internal.h
@@ -73,6 +86,23 @@ typedef enum _AMBI_BIN_DECODING_METHODS{
 /** Number of decoding method options */
 #define AMBI_BIN_NUM_DECODING_METHODS ( 5 )
 
+/**
+ * Available domains in which to apply the binaural decoder
+ */
+typedef enum _AMBI_BIN_DECODING_DOMAINS{
+    DECODING_DOMAIN_AUTO = 1, /**< Time-domain for orders up to
+                               *   AMBI_BIN_TIME_DOMAIN_MAX_ORDER (where it is
+                               *   cheaper), otherwise the filterbank */
+    DECODING_DOMAIN_TFT,      /**< Per-band decoding matrices, applied in the
+                               *   afSTFT domain */
+    DECODING_DOMAIN_TIME      /**< 2 x nSH matrix of FIR decoding filters,
+                               *   applied via partitioned convolution */
+    
+}AMBI_BIN_DECODING_DOMAINS;
+
+/** Highest order which DECODING_DOMAIN_AUTO decodes in the time-domain */
+#define AMBI_BIN_TIME_DOMAIN_MAX_ORDER ( 2 )
+
 /**
  * Available Ambisonic channel ordering conventions
  *
@@ -131,6 +161,23 @@ typedef enum _AMBI_BIN_CODEC_STATUS {
  */
 void ambi_bin_create(void** const phAmbi);
 
+/**
+ * Creates an instance of ambi_bin, which decodes the same input to the binaural
+ * signals of several listeners, each with their own head orientation
+ *
+ * The input spectra (i.e. the forward filterbank) are shared by all of the
+ * listeners; only the rotation, decoding and inverse filterbank are carried
+ * out per listener. The outputs are ordered: [listener0_left,
+ * listener0_right, listener1_left, ...]. Listener 0 follows ambi_bin_setYaw()
+ * etc., and the others ambi_bin_setListenerOrientation(). The number of
+ * listeners is fixed for the lifetime of the instance.
+ *
+ * @param[in] phAmbi     (&) address of ambi_bin handle
+ * @param[in] nListeners Number of listeners (minimum: 1)
+ */
+void ambi_bin_createMultiListener(void** const phAmbi,
+                                  int nListeners);
+
 /**
  * Destroys an instance of ambi_bin
  *
@@ -138,6 +185,25 @@ void ambi_bin_create(void** const phAmbi);
  */
 void ambi_bin_destroy(void** const phAmbi);
 
+/**
+ * Creates a new instance of ambi_bin, with the same configuration (and number
+ * of listeners) as an existing one
+ *
+ * If the existing instance is initialised, then the clone is returned
+ * initialised also: the (read-only) HRIR data and filterbank HRTFs are shared
+ * with it, and the binaural decoding matrices are copied rather than
+ * recomputed. Only the afSTFT, the audio buffers, the rotation matrices and
+ * (if used) the time-domain decoder are set up anew.
+ *
+ * @note The existing instance must not be processing audio or be
+ *       (re)initialised while it is being cloned.
+ *
+ * @param[in] hAmbi   ambi_bin handle of the instance to clone
+ * @param[in] phClone (&) address of the new ambi_bin handle
+ */
+void ambi_bin_clone(void* const hAmbi,
+                    void** const phClone);
+
 /**
  * Initialises ambi_bin with default settings, and samplerate.
  *
@@ -154,9 +220,36 @@ void ambi_bin_init(void* const hAmbi,
  */
 void ambi_bin_initCodec(void* const hAmbi);
 
+/**
+ * Prepares the instance for playback, from the calling (non-real-time) thread;
+ * i.e. initialises the codec (if needed), and runs ambi_bin_process() over a
+ * few blocks of silence, such that the first audio callback does not incur
+ * the cost of touching the buffers and tables for the first time. The block
+ * size is also passed to the internal FIFO, which selects whether it adds any
+ * latency (see ambi_bin_getProcessingDelay())
+ *
+ * @note Call after ambi_bin_init(), and before the first call to
+ *       ambi_bin_process() (e.g. in the host's prepare-to-play callback); see
+ *       saf_warmUp.h
+ *
+ * @param[in] hAmbi     ambi_bin handle
+ * @param[in] nInputs   Number of input channels (as passed by the host)
+ * @param[in] nOutputs  Number of output channels (as passed by the host)
+ * @param[in] blockSize Number of samples per block (as passed by the host)
+ */
+void ambi_bin_prepareToPlay(void* const hAmbi,
+                            int nInputs,
+                            int nOutputs,
+                            int blockSize);
+
 /**
  * Decodes input spherical harmonic signals to the binaural channels.
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in ambi_bin_getProcessingDelay()
+ *
  * @param[in] hAmbi    ambi_bin handle
  * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
@@ -171,6 +264,84 @@ void ambi_bin_process(void* const hAmbi,
                       int nOutputs,
                       int nSamples);
 
+/**
+ * Same as ambi_bin_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hAmbi    ambi_bin handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void ambi_bin_processInterleaved(void* const hAmbi,
+                                 const float* inputs,
+                                 float* outputs,
+                                 int nInputs,
+                                 int nOutputs,
+                                 int nSamples);
+
+/**
+ * Decodes one afSTFT-domain frame of spherical harmonic signals to the binaural
+ * channels, for use as a stage of a saf_tfGraph (see
+ * saf_tfGraph_stageProcessor)
+ *
+ * This is the main processing of ambi_bin_process(), without the FIFO and the
+ * forward/inverse afSTFT; which are instead applied once for the whole chain by
+ * the graph. The time-domain decoder is not available in this mode (0 is
+ * returned if it is enabled).
+ *
+ * @param[in]  hAmbi         ambi_bin handle
+ * @param[in]  inTF          Input frame (complex); FLAT: HYBRID_BANDS x
+ *                           nInputs x TIME_SLOTS
+ * @param[out] outTF         Output frame (complex); FLAT: HYBRID_BANDS x
+ *                           nOutputs x TIME_SLOTS
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels
+ * @param[in]  nBands        Number of bands (must be HYBRID_BANDS)
+ * @param[in]  nTimeSlots    Number of time slots (must be TIME_SLOTS)
+ * @returns Number of output channels (NUM_EARS per listener), or 0 if not
+ *          ready
+ */
+int ambi_bin_processTF(void* const hAmbi,
+                       const float* inTF,
+                       float* outTF,
+                       int nInputs,
+                       int maxNumOutputs,
+                       int nBands,
+                       int nTimeSlots);
+
+/**
+ * Decodes a whole recording to the binaural channels, using several threads
+ * (intended for batch rendering, rather than real-time use)
+ *
+ * The signals are split into one segment per thread, each of which is decoded
+ * by its own instance with the current configuration of 'hAmbi'. Each segment
+ * is preceded by a few frames of the previous one, so that the filterbank
+ * state is warmed up, and the output matches that of ambi_bin_process() to
+ * within numerical precision. Unlike ambi_bin_process(), the output is
+ * aligned with the input; i.e. the processing delay is compensated for.
+ *
+ * @note ambi_bin_init() must have been called on 'hAmbi' (for the sampling
+ *       rate), but 'hAmbi' itself is not used for the processing, so it may
+ *       be used concurrently for real-time processing.
+ *
+ * @param[in]  hAmbi    ambi_bin handle
+ * @param[in]  inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[out] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nOutputs Number of output channels
+ * @param[in]  nSamples Number of samples per channel
+ * @param[in]  nThreads Number of threads ('0': one per CPU core)
+ */
+void ambi_bin_renderOffline(void* const hAmbi,
+                            const float* const* inputs,
+                            float* const* outputs,
+                            int nInputs,
+                            int nOutputs,
+                            int nSamples,
+                            int nThreads);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -208,6 +379,26 @@ void ambi_bin_setUseDefaultHRIRsflag(void* const hAmbi, int newState);
  */
 void ambi_bin_setSofaFilePath(void* const hAmbi, const char* path);
 
+/**
+ * Sets a prebaked decoder (e.g. one designed offline and exported with
+ * ambi_bin_getDecoder()), to use instead of one designed from the HRIRs; in
+ * which case ambi_bin_initCodec() neither loads the HRIRs nor designs a decoder
+ *
+ * The decoding order is then that of the prebaked decoder, and the decoder is
+ * applied in the afSTFT domain. With the embedded profile
+ * (SAF_EMBEDDED_PROFILE), the decoder design is not compiled in, and so a
+ * prebaked decoder must be set for ambi_bin to produce any output.
+ *
+ * @param[in] hAmbi  ambi_bin handle
+ * @param[in] decMtx Decoding matrices (complex); FLAT:
+ *                   ambi_bin_getNumberOfBands() x 2 x (order+1)^2; or
+ *                   NULL, to design the decoder from the HRIRs again
+ * @param[in] order  Decoding order of 'decMtx' (at most AMBI_BIN_MAX_SH_ORDER)
+ */
+void ambi_bin_setPrebakedDecoder(void* const hAmbi,
+                                 const float* decMtx,
+                                 int order);
+
 /**
  * Sets the decoding order (see AMBI_BIN_INPUT_ORDERS enum).
  *
@@ -257,6 +448,32 @@ void ambi_bin_setEnablePhaseWarping(void* const hAmbi, int newState);
  */
 void ambi_bin_setEnableRotation(void* const hAmbi, int newState);
 
+/**
+ * Sets the domain in which to apply the decoder (see
+ * 'AMBI_BIN_DECODING_DOMAINS' enum; default: DECODING_DOMAIN_TFT)
+ *
+ * The time-domain path applies FIR decoding filters (see
+ * getBinauralAmbiDecoderFilters()) to the rotated SH signals, and so it
+ * bypasses the filterbank and its delay. It is only used if the HRIRs are at
+ * the host sampling rate, and with a single listener; otherwise the filterbank
+ * path is used regardless. See ambi_bin_getProcessingDelay().
+ *
+ * @note The two decoders are designed at different frequency resolutions, so
+ *       their magnitude responses differ somewhat (typically within 2dB).
+ */
+void ambi_bin_setDecodingDomain(void* const hAmbi,
+                                AMBI_BIN_DECODING_DOMAINS newDomain);
+
+/**
+ * Sets a flag to enable/disable (1 or 0, default: 1) merging the rotation
+ * matrix into the per-band decoding matrices whenever the rotation changes
+ *
+ * When enabled, each band then costs a single 2 x nSH matrix product per
+ * frame, rather than an nSH x nSH rotation followed by the 2 x nSH decoding.
+ * The outputs are the same to within numerical precision.
+ */
+void ambi_bin_setEnableRotationFusion(void* const hAmbi, int newState);
+
 /**
  * Sets the 'yaw' rotation angle, in degrees
  */
@@ -293,6 +510,23 @@ void ambi_bin_setFlipRoll(void* const hAmbi, int newState);
  */
 void ambi_bin_setRPYflag(void* const hAmbi, int newState);
 
+/**
+ * Sets the head orientation of one of the listeners, in DEGREES; see
+ * ambi_bin_createMultiListener() (the flip and rotation order flags apply to
+ * all listeners)
+ *
+ * @param[in] hAmbi         ambi_bin handle
+ * @param[in] listenerIndex Listener index; 0..ambi_bin_getNumListeners()-1
+ * @param[in] newYaw        Yaw angle, in DEGREES
+ * @param[in] newPitch      Pitch angle, in DEGREES
+ * @param[in] newRoll       Roll angle, in DEGREES
+ */
+void ambi_bin_setListenerOrientation(void* const hAmbi,
+                                     int listenerIndex,
+                                     float newYaw,
+                                     float newPitch,
+                                     float newRoll);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -370,6 +604,25 @@ int ambi_bin_getNormType(void* const hAmbi);
  */
 int ambi_bin_getNumEars(void);
 
+/**
+ * Returns the number of frequency bands employed by ambi_bin
+ */
+int ambi_bin_getNumberOfBands(void);
+
+/**
+ * Copies the current decoding matrices, e.g. to store them as a prebaked
+ * decoder (see ambi_bin_setPrebakedDecoder())
+ *
+ * @param[in]  hAmbi  ambi_bin handle
+ * @param[out] decMtx Decoding matrices (complex); FLAT:
+ *                    ambi_bin_getNumberOfBands() x 2 x
+ *                    ambi_bin_getNSHrequired()
+ * @returns Decoding order of the matrices, or 0 if ambi_bin is not yet
+ *          initialised (in which case nothing is copied)
+ */
+int ambi_bin_getDecoder(void* const hAmbi,
+                        float* decMtx);
+
 /**
  * Returns the number of spherical harmonic signals required by the current
  * decoding order: (current_order+1)^2
@@ -400,6 +653,24 @@ int ambi_bin_getEnablePhaseWarping(void* const hAmbi);
  */
 int ambi_bin_getEnableRotation(void* const hAmbi);
 
+/**
+ * Returns the domain in which the decoder is asked to be applied (see
+ * 'AMBI_BIN_DECODING_DOMAINS' enum)
+ */
+int ambi_bin_getDecodingDomain(void* const hAmbi);
+
+/**
+ * Returns 1 if the decoder is currently applied in the time-domain, or 0 if
+ * it is applied in the afSTFT domain (resolved by ambi_bin_initCodec())
+ */
+int ambi_bin_getUsesTimeDomainDecoding(void* const hAmbi);
+
+/**
+ * Returns the flag value which dictates whether the rotation is merged into
+ * the decoding matrices ('0' disabled, '1' enabled)
+ */
+int ambi_bin_getEnableRotationFusion(void* const hAmbi);
+
 /**
  * Returns the 'yaw' rotation angle, in degree
  */
@@ -439,6 +710,9 @@ int ambi_bin_getFlipRoll(void* const hAmbi);
  */
 int ambi_bin_getRPYflag(void* const hAmbi);
 
+/** Returns the number of listeners (see ambi_bin_createMultiListener()) */
+int ambi_bin_getNumListeners(void* const hAmbi);
+
 /**
  * Returns the number of directions in the currently used HRIR set
  */
@@ -460,10 +734,42 @@ int ambi_bin_getHRIRsamplerate(void* const hAmbi);
 int ambi_bin_getDAWsamplerate(void* const hAmbi);
 
 /**
- * Returns the processing delay in samples (may be used for delay compensation
- * features)
+ * Returns the processing delay of this instance in samples (may be used for
+ * delay compensation features), which is lower when decoding in the
+ * time-domain; and which includes the latency of the internal FIFO, if any
+ * (i.e. if the host block size is not a multiple of FRAME_SIZE)
+ */
+int ambi_bin_getProcessingDelay(void* const hAmbi);
+
+/**
+ * Returns the handle of the profiler, which (when SAF_ENABLE_PROFILING is
+ * defined) times the stages of the processing loop; see saf_profiler_getStats()
+ */
+void* ambi_bin_getProfiler(void* const hAmbi);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* ambi_bin_getTelemetry(void* const hAmbi);
+
+/**
+ * Returns the handle of the report of the last ambi_bin_initCodec() call, which
+ * lists the time and memory taken by each of its stages; see
+ * saf_initReport_print()
+ */
+void* ambi_bin_getInitReport(void* const hAmbi);
+
+/**
+ * Returns the number of bytes currently held by this instance for its audio
+ * buffers and tables; which scales with the configured decoding order
+ * (see ambi_bin_setInputOrderPreset())
+ *
+ * @note Excludes the HRIR data shared between instances (see
+ *       hrtfCache_acquire()), and the internals of the afSTFT and FIFO.
  */
-int ambi_bin_getProcessingDelay(void);
+size_t ambi_bin_getMemoryUsage(void* const hAmbi);
 
     
 #ifdef __cplusplus
@@ -33,10 +33,19 @@ void ambi_bin_create
 (
     void ** const phAmbi
 )
+{
+    ambi_bin_createMultiListener(phAmbi, 1);
+}
+
+void ambi_bin_createMultiListener
+(
+    void ** const phAmbi,
+    int nListeners
+)
 {
     ambi_bin_data* pData = (ambi_bin_data*)malloc1d(sizeof(ambi_bin_data));
     *phAmbi = (void*)pData;
-    int ch, band;
+    int band, l;
 
     /* default user parameters */
     for (band = 0; band<HYBRID_BANDS; band++)
@@ -48,6 +57,8 @@ void ambi_bin_create
     pData->enableDiffuseMatching = 0;
     pData->enablePhaseWarping = 0;
     pData->enableRotation = 0;
+    pData->enableRotationFusion = 1;
+    pData->domain = DECODING_DOMAIN_TFT;
     pData->yaw = 0.0f;
     pData->pitch = 0.0f;
     pData->roll = 0.0f;
@@ -59,19 +70,27 @@ void ambi_bin_create
     pData->order = pData->new_order = 1;
     pData->nSH =  (pData->order+1)*(pData->order+1);  
     
+    /* listeners (the first one is controlled by the yaw/pitch/roll above) */
+    pData->nListeners = MAX(nListeners, 1);
+    pData->listeners = NULL;
+    if(pData->nListeners>1){
+        pData->listeners = (ambi_bin_listener*)malloc1d((pData->nListeners-1)*sizeof(ambi_bin_listener));
+        for(l=0; l<pData->nListeners-1; l++){
+            pData->listeners[l].yaw = pData->listeners[l].pitch = pData->listeners[l].roll = 0.0f;
+            pData->listeners[l].recalc_M_rotFLAG = 1;
+        }
+    }
+    pData->M_decRot = NULL;
+    
     /* afSTFT stuff */
     pData->hSTFT = NULL;
-    pData->STFTOutputFrameTF = malloc1d(NUM_EARS * sizeof(complexVector));
-    for(ch=0; ch< NUM_EARS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, NUM_EARS), HOP_SIZE, sizeof(float));
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
+    pData->nSHalloc = 0;
+    pData->hArena = NULL;
+    pData->SHFrameTD = NULL;
+    pData->SHframeTF = pData->SHframeTF_rot = NULL;
+    pData->tempHopFrameTD = NULL;
+    pData->binframeTF = (float_complex***)malloc3d(HYBRID_BANDS, NUM_EARS*(pData->nListeners), TIME_SLOTS, sizeof(float_complex));
+    ambi_bin_resizeBuffers(*phAmbi, pData->nSH);
 
     /* codec data */
     pData->progressBar0_1 = 0.0f;
@@ -80,16 +99,36 @@ void ambi_bin_create
     pData->pars = (ambi_bin_codecPars*)malloc1d(sizeof(ambi_bin_codecPars));
     ambi_bin_codecPars* pars = pData->pars;
     pars->sofa_filepath = NULL;
+    pars->hHRTFs = NULL;
     pars->hrirs = NULL;
     pars->hrir_dirs_deg = NULL;
     pars->itds_s = NULL;
     pars->hrtf_fb = NULL;
+    pars->decFilterLength = 0;
+    pars->prebakedDec = NULL;
+    pars->prebakedOrder = 0;
+    memset(pars->M_dec, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+    pData->useTimeDomain = 0;
+    pData->hMatrixConv = NULL;
+    pData->tdFrame_rot = NULL;
+    pData->tdFrame_bin = NULL;
     
     /* flags */
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
     pData->codecStatus = CODEC_STATUS_NOT_INITIALISED;
     pData->recalc_M_rotFLAG = 1;
     pData->reinit_hrtfsFLAG = 1;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, NUM_EARS*(pData->nListeners));
+    saf_profiler_create(&(pData->hProfiler));
+    saf_telemetry_create(&(pData->hTelemetry));
+    saf_initReport_create(&(pData->hInitReport));
+    saf_initDeps_create(&(pData->hInitDeps), AMBI_BIN_NUM_INIT_STAGES);
+    
+    /* rotation matrix generator (allocation-free, so it may be used in the processing loop) */
+    shRotMtxReal_create(&(pData->hSHrot), MAX_SH_ORDER);
+    shOrderDetector_create(&(pData->hOrderDet), MAX_SH_ORDER, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*48000.0f));
 }
 
 void ambi_bin_destroy
@@ -99,7 +138,6 @@ void ambi_bin_destroy
 {
     ambi_bin_data *pData = (ambi_bin_data*)(*phAmbi);
     ambi_bin_codecPars *pars = pData->pars;
-    int ch;
     
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -111,31 +149,102 @@ void ambi_bin_destroy
         /* free afSTFT and buffers */
         if(pData->hSTFT!=NULL)
             afSTFTfree(pData->hSTFT);
-        if(pData->STFTInputFrameTF!=NULL){
-            for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-                free(pData->STFTInputFrameTF[ch].re);
-                free(pData->STFTInputFrameTF[ch].im);
-            }
-        }
-        for (ch = 0; ch< NUM_EARS; ch++) {
-            free(pData->STFTOutputFrameTF[ch].re);
-            free(pData->STFTOutputFrameTF[ch].im);
-        }
-        free(pData->STFTInputFrameTF);
-        free(pData->STFTOutputFrameTF);
+#ifdef SAF_EMBEDDED_PROFILE
+        arena_destroy(&(pData->hArena));
+#else
+        free(pData->SHFrameTD);
+        free(pData->SHframeTF);
+        free(pData->SHframeTF_rot);
         free(pData->tempHopFrameTD);
-        free(pars->hrtf_fb);
-        free(pars->itds_s);
-        free(pars->hrirs);
-        free(pars->hrir_dirs_deg);
+        free(pData->M_decRot);
+#endif
+        free(pData->binframeTF);
+        free(pData->listeners);
+        if(pData->hMatrixConv!=NULL)
+            saf_matrixConv_destroy(&(pData->hMatrixConv));
+        free(pData->tdFrame_rot);
+        free(pData->tdFrame_bin);
+#ifndef SAF_EMBEDDED_PROFILE
+        hrtfCache_release(&(pars->hHRTFs));
+#endif
+        free(pars->prebakedDec);
         free(pars);
         free(pData->progressBarText);
         
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_profiler_destroy(&(pData->hProfiler));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        saf_initReport_destroy(&(pData->hInitReport));
+        saf_initDeps_destroy(&(pData->hInitDeps));
+        shRotMtxReal_destroy(&(pData->hSHrot));
+        shOrderDetector_destroy(&(pData->hOrderDet));
         free(pData);
         pData = NULL;
     }
 }
 
+void ambi_bin_clone
+(
+    void * const hAmbi,
+    void ** const phClone
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_codecPars* pars = pData->pars;
+    ambi_bin_data *pClone;
+    ambi_bin_codecPars* clonePars;
+    
+    ambi_bin_createMultiListener(phClone, pData->nListeners);
+    pClone = (ambi_bin_data*)(*phClone);
+    clonePars = pClone->pars;
+    
+    /* user parameters */
+    memcpy(pClone->EQ, pData->EQ, HYBRID_BANDS*sizeof(float));
+    pClone->useDefaultHRIRsFLAG = pData->useDefaultHRIRsFLAG;
+    pClone->chOrdering = pData->chOrdering;
+    pClone->norm = pData->norm;
+    pClone->enableMaxRE = pData->enableMaxRE;
+    pClone->enableDiffuseMatching = pData->enableDiffuseMatching;
+    pClone->enablePhaseWarping = pData->enablePhaseWarping;
+    pClone->enableRotation = pData->enableRotation;
+    pClone->enableRotationFusion = pData->enableRotationFusion;
+    pClone->domain = pData->domain;
+    pClone->yaw = pData->yaw;
+    pClone->pitch = pData->pitch;
+    pClone->roll = pData->roll;
+    pClone->bFlipYaw = pData->bFlipYaw;
+    pClone->bFlipPitch = pData->bFlipPitch;
+    pClone->bFlipRoll = pData->bFlipRoll;
+    pClone->useRollPitchYawFlag = pData->useRollPitchYawFlag;
+    pClone->method = pData->method;
+    pClone->new_order = pData->new_order;
+    if(pData->nListeners>1)
+        memcpy(pClone->listeners, pData->listeners, (pData->nListeners-1)*sizeof(ambi_bin_listener));
+    if(pars->sofa_filepath!=NULL){
+        clonePars->sofa_filepath = malloc1d(strlen(pars->sofa_filepath) + 1);
+        strcpy(clonePars->sofa_filepath, pars->sofa_filepath);
+    }
+    if(pars->prebakedDec!=NULL)
+        ambi_bin_setPrebakedDecoder(*phClone, (const float*)pars->prebakedDec, pars->prebakedOrder);
+    ambi_bin_init(*phClone, pData->fs);
+    
+#ifndef SAF_EMBEDDED_PROFILE
+    /* take over the (shared) HRIR data and the decoding matrices, along with
+     * the inputs they were computed for; such that ambi_bin_initCodec() then
+     * only sets up the afSTFT, the buffers and the rotations */
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED && pars->hHRTFs!=NULL){
+        hrtfCache_retain(pars->hHRTFs);
+        clonePars->hHRTFs = pars->hHRTFs;
+        hrtfCache_getData(clonePars->hHRTFs, &(clonePars->hrirs), &(clonePars->hrir_dirs_deg), &(clonePars->N_hrir_dirs),
+                          &(clonePars->hrir_len), &(clonePars->hrir_fs), &(clonePars->itds_s), &(clonePars->hrtf_fb), NULL);
+        memcpy(clonePars->M_dec, pars->M_dec, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+        saf_initDeps_copy(pData->hInitDeps, pClone->hInitDeps);
+        pClone->reinit_hrtfsFLAG = 0;
+        ambi_bin_initCodec(*phClone);
+    }
+#endif
+}
+
 void ambi_bin_init
 (
     void * const hAmbi,
@@ -157,6 +266,7 @@ void ambi_bin_init
     /* default starting values */
     memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
     pData->recalc_M_rotFLAG = 1;
+    shOrderDetector_reset(pData->hOrderDet, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*(float)sampleRate));
 }
 
 void ambi_bin_initCodec
@@ -167,6 +277,9 @@ void ambi_bin_initCodec
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
     ambi_bin_codecPars* pars = pData->pars;
     int i, j, nSH, order, band;
+#ifndef SAF_EMBEDDED_PROFILE
+    void* hHRTFs;
+#endif
     
     if (pData->codecStatus != CODEC_STATUS_NOT_INITIALISED)
         return; /* re-init not required, or already happening */
@@ -180,101 +293,159 @@ void ambi_bin_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Preparing HRIRs");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    saf_initReport_start(pData->hInitReport);
     
     /* (Re)Initialise afSTFT */
-    order = pData->new_order;
+    saf_initReport_beginStage("afSTFTinit");
+    order = pars->prebakedDec!=NULL ? pars->prebakedOrder : pData->new_order;
     nSH = (order+1)*(order+1);
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, nSH, NUM_EARS, 0, 1);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, nSH, NUM_EARS*(pData->nListeners), 0, 1, AFSTFT_NUM_THREADS_AUTO);
     else if(pData->nSH != nSH) {/* Or change the number of channels */
-        afSTFTchannelChange(pData->hSTFT, nSH, NUM_EARS);
+        afSTFTchannelChange(pData->hSTFT, nSH, NUM_EARS*(pData->nListeners));
         afSTFTclearBuffers(pData->hSTFT);
     }
+    ambi_bin_resizeBuffers(hAmbi, nSH);
     pData->nSH = nSH;
+    saf_initReport_endStage();
     
-    if(pData->reinit_hrtfsFLAG){
-        /* load sofa file or default hrir data */
+#ifndef SAF_EMBEDDED_PROFILE
+    /* the HRIRs depend on the sofa file (or the default set) and the frequency
+     * vector (and are not required by a prebaked decoder) */
+    if(pData->reinit_hrtfsFLAG)
+        saf_initDeps_invalidate(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS);
+    pData->reinit_hrtfsFLAG = 0;
+    saf_initDeps_begin(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS, &(pData->useDefaultHRIRsFLAG), sizeof(int));
+    saf_initDeps_addString(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS, !pData->useDefaultHRIRsFLAG ? pars->sofa_filepath : NULL);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS, pData->freqVector, HYBRID_BANDS*sizeof(float));
+    if(pars->prebakedDec==NULL && saf_initDeps_isStale(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS)){
+        /* load sofa file or default hrir data (setting path to NULL loads
+         * default HRIR data), along with the ITDs and the diffuse-field
+         * equalised filterbank HRTFs; which are shared with any other
+         * instances using the same HRIRs */
         strcpy(pData->progressBarText,"Preparing HRIRs");
         pData->progressBar0_1 = 0.15f;
-        if(!pData->useDefaultHRIRsFLAG && pars->sofa_filepath!=NULL){
-            loadSofaFile(pars->sofa_filepath,
-                         &(pars->hrirs),
-                         &(pars->hrir_dirs_deg),
-                         &(pars->N_hrir_dirs),
-                         &(pars->hrir_len),
-                         &(pars->hrir_fs));
-        }
-        else{
-            loadSofaFile(NULL, /* setting path to NULL loads default HRIR data */
-                         &(pars->hrirs),
-                         &(pars->hrir_dirs_deg),
-                         &(pars->N_hrir_dirs),
-                         &(pars->hrir_len),
-                         &(pars->hrir_fs));
-        }
-        
-        /* estimate the ITDs for each HRIR */
-        pData->progressBar0_1 = 0.3f;
-        pars->itds_s = realloc1d(pars->itds_s, pars->N_hrir_dirs*sizeof(float));
-        estimateITDs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrir_fs, pars->itds_s);
-        
-        /* convert hrirs to filterbank coefficients */
+        saf_initReport_beginStage("hrtfCache_acquire");
+        hrtfCache_acquire(&hHRTFs, !pData->useDefaultHRIRsFLAG ? pars->sofa_filepath : NULL,
+                          pData->freqVector, HYBRID_BANDS);
+        saf_initReport_endStage();
+        hrtfCache_release(&(pars->hHRTFs));
+        pars->hHRTFs = hHRTFs;
+        hrtfCache_getData(pars->hHRTFs, &(pars->hrirs), &(pars->hrir_dirs_deg), &(pars->N_hrir_dirs),
+                          &(pars->hrir_len), &(pars->hrir_fs), &(pars->itds_s), &(pars->hrtf_fb), NULL);
         pData->progressBar0_1 = 0.9f;
-        pars->hrtf_fb = realloc1d(pars->hrtf_fb, HYBRID_BANDS * NUM_EARS * (pars->N_hrir_dirs)*sizeof(float_complex));
-        HRIRs2FilterbankHRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrtf_fb);
-        diffuseFieldEqualiseHRTFs(pars->N_hrir_dirs, pars->itds_s, pData->freqVector, HYBRID_BANDS, pars->hrtf_fb);
-        
-        pData->reinit_hrtfsFLAG = 0;
+        saf_initDeps_commit(pData->hInitDeps, AMBI_BIN_STAGE_HRIRS);
     }
     
-    /* get new decoder */
+    /* get new decoder (unless the decoding method, order, options, and HRIRs
+     * are those of the current decoder) */
     strcpy(pData->progressBarText,"Computing Decoder");
     pData->progressBar0_1 = 0.95f;
-    float_complex* decMtx;
-    decMtx = calloc1d(HYBRID_BANDS*NUM_EARS*nSH, sizeof(float_complex));
-    switch(pData->method){
-        default:
-        case DECODING_METHOD_LS:
-            getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
-                                      BINAURAL_DECODER_LS, order, pData->freqVector, pars->itds_s, NULL,
-                                      pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
-            break;
-        case DECODING_METHOD_LSDIFFEQ:
-            getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
-                                      BINAURAL_DECODER_LSDIFFEQ, order, pData->freqVector, pars->itds_s, NULL,
-                                      pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
-            break;
-        case DECODING_METHOD_SPR:
-            getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
-                                      BINAURAL_DECODER_SPR, order, pData->freqVector, pars->itds_s, NULL,
-                                      pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
-            break;
-        case DECODING_METHOD_TA:
-            getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
-                                      BINAURAL_DECODER_TA, order, pData->freqVector, pars->itds_s, NULL,
-                                      pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
-            break;
-        case DECODING_METHOD_MAGLS:
-            getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
-                                      BINAURAL_DECODER_MAGLS, order, pData->freqVector, pars->itds_s, NULL,
-                                      pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
-            break;
+    saf_initDeps_begin(pData->hInitDeps, AMBI_BIN_STAGE_DECODER);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, &(pData->method), sizeof(AMBI_BIN_DECODING_METHODS));
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, &order, sizeof(int));
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, &(pData->enableDiffuseMatching), sizeof(int));
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, &(pData->enableMaxRE), sizeof(int));
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, &(pData->enablePhaseWarping), sizeof(int));
+    saf_initDeps_addDependency(pData->hInitDeps, AMBI_BIN_STAGE_DECODER, AMBI_BIN_STAGE_HRIRS);
+    if(pars->prebakedDec==NULL && saf_initDeps_isStale(pData->hInitDeps, AMBI_BIN_STAGE_DECODER)){
+        float_complex* decMtx;
+        void* hPar;
+        saf_initReport_beginStage("getBinauralAmbiDecoderMtx");
+        decMtx = calloc1d(HYBRID_BANDS*NUM_EARS*nSH, sizeof(float_complex));
+        saf_parfor_create(&hPar, SAF_PARFOR_NUM_THREADS_AUTO); /* (split over the bands) */
+        switch(pData->method){
+            default:
+            case DECODING_METHOD_LS:
+                getBinauralAmbiDecoderMtxParallel(hPar, pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
+                                                  BINAURAL_DECODER_LS, order, pData->freqVector, pars->itds_s, NULL,
+                                                  pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
+                break;
+            case DECODING_METHOD_LSDIFFEQ:
+                getBinauralAmbiDecoderMtxParallel(hPar, pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
+                                                  BINAURAL_DECODER_LSDIFFEQ, order, pData->freqVector, pars->itds_s, NULL,
+                                                  pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
+                break;
+            case DECODING_METHOD_SPR:
+                getBinauralAmbiDecoderMtxParallel(hPar, pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
+                                                  BINAURAL_DECODER_SPR, order, pData->freqVector, pars->itds_s, NULL,
+                                                  pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
+                break;
+            case DECODING_METHOD_TA:
+                getBinauralAmbiDecoderMtxParallel(hPar, pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
+                                                  BINAURAL_DECODER_TA, order, pData->freqVector, pars->itds_s, NULL,
+                                                  pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
+                break;
+            case DECODING_METHOD_MAGLS:
+                getBinauralAmbiDecoderMtxParallel(hPar, pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
+                                                  BINAURAL_DECODER_MAGLS, order, pData->freqVector, pars->itds_s, NULL,
+                                                  pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
+                break;
+        }
+        saf_parfor_destroy(&hPar);
+        saf_initReport_endStage();
+    
+        /* Apply Phase Warping */
+        if(pData->enablePhaseWarping){
+            // COMING SOON
+        }
+    
+        /* replace current decoder */
+        memset(pars->M_dec, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+        for(band=0; band<HYBRID_BANDS; band++)
+            for(i=0; i<NUM_EARS; i++)
+                for(j=0; j<nSH; j++)
+                    pars->M_dec[band][i][j] = decMtx[band*2*nSH + i*nSH + j];
+        free(decMtx);
+        saf_initDeps_commit(pData->hInitDeps, AMBI_BIN_STAGE_DECODER);
     }
+#endif /* SAF_EMBEDDED_PROFILE */
     
-    /* Apply Phase Warping */
-    if(pData->enablePhaseWarping){
-        // COMING SOON
+    /* or take over the prebaked decoder (which replaces the designed one, so
+     * that is then designed anew once the prebaked decoder is removed) */
+    if(pars->prebakedDec!=NULL){
+        memset(pars->M_dec, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+        for(band=0; band<HYBRID_BANDS; band++)
+            for(i=0; i<NUM_EARS; i++)
+                for(j=0; j<nSH; j++)
+                    pars->M_dec[band][i][j] = pars->prebakedDec[band*NUM_EARS*nSH + i*nSH + j];
+        saf_initDeps_invalidate(pData->hInitDeps, AMBI_BIN_STAGE_DECODER);
     }
+#ifdef SAF_EMBEDDED_PROFILE
+    else /* (silent, until a decoder is prebaked) */
+        memset(pars->M_dec, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+    pData->useTimeDomain = 0;
+#else
     
-    /* replace current decoder */
-    memset(pars->M_dec, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
-    for(band=0; band<HYBRID_BANDS; band++)
-        for(i=0; i<NUM_EARS; i++)
-            for(j=0; j<nSH; j++)
-                pars->M_dec[band][i][j] = decMtx[band*2*nSH + i*nSH + j];
-    free(decMtx);
+    /* decode in the time-domain instead, if requested (or cheaper) and
+     * possible; otherwise release the time-domain decoder */
+    pData->useTimeDomain = (pData->domain==DECODING_DOMAIN_TIME ||
+                            (pData->domain==DECODING_DOMAIN_AUTO && order<=AMBI_BIN_TIME_DOMAIN_MAX_ORDER)) &&
+                           pData->nListeners==1 && pars->hrir_fs==pData->fs && pars->prebakedDec==NULL;
+    if(pData->useTimeDomain){
+        saf_initReport_beginStage("ambi_bin_initTimeDomainDecoder");
+        ambi_bin_initTimeDomainDecoder(hAmbi, order);
+        saf_initReport_endStage();
+    }
+#endif
+    if(!pData->useTimeDomain && pData->hMatrixConv!=NULL){
+        saf_matrixConv_destroy(&(pData->hMatrixConv));
+        free(pData->tdFrame_rot);
+        free(pData->tdFrame_bin);
+        pData->tdFrame_rot = pData->tdFrame_bin = NULL;
+        pars->decFilterLength = 0;
+    }
+    
+    /* the rotated decoders of the listeners are derived from this decoder */
+    pData->recalc_M_rotFLAG = 1;
+    for(i=0; i<pData->nListeners-1; i++)
+        pData->listeners[i].recalc_M_rotFLAG = 1;
     
     pData->order = order;
+    saf_initReport_finish(pData->hInitReport);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -282,32 +453,109 @@ void ambi_bin_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISED;
 }
 
-void ambi_bin_process
+void ambi_bin_prepareToPlay
+(
+    void* const hAmbi,
+    int nInputs,
+    int nOutputs,
+    int blockSize
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+
+    ambi_bin_initCodec(hAmbi);
+    saf_fifo_setHostBlockSize(pData->hFIFO, blockSize);
+    saf_warmUp_run(hAmbi, &ambi_bin_process, nInputs, nOutputs, blockSize, SAF_WARMUP_NUM_SAMPLES);
+}
+
+/**
+ * Applies the main (afSTFT-domain) processing to 'SHframeTF', i.e. the
+ * rotation and the binaural decoding, and places the result in 'binframeTF'
+ */
+static void ambi_bin_processFrameTF
 (
     void  *  const hAmbi,
-    float ** const inputs,
-    float ** const outputs,
-    int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int order,
+    int nSH_active,
+    int enableRot
 )
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
     ambi_bin_codecPars* pars = pData->pars;
-    int n, t, ch, i, j, band;
-    int o[MAX_SH_ORDER+2];
+    int i, j, band, nSH;
     const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float Rxyz[3][3];
     float* M_rot_tmp;
     
+    nSH = (order+1)*(order+1);
+    if(pData->nListeners>1 || pData->enableRotationFusion)
+        ambi_bin_decodeListeners(hAmbi, order, enableRot);
+    else{
+            /* Apply rotation */
+        if(order > 0 && enableRot) {
+            if(pData->recalc_M_rotFLAG){
+                SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+                memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+                M_rot_tmp = pData->M_rot_tmp;
+                yawPitchRoll2Rzyx(pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
+                shRotMtxReal_compute(pData->hSHrot, Rxyz, order, M_rot_tmp);
+                for (i = 0; i < nSH; i++)
+                    for (j = 0; j < nSH; j++)
+                        pData->M_rot[i][j] = cmplxf(M_rot_tmp[i*nSH + j], 0.0f);
+                pData->recalc_M_rotFLAG = 0;
+                SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+            }
+            SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+            for(band = 0; band < HYBRID_BANDS; band++) {
+                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH_active, TIME_SLOTS, nSH_active, &calpha,
+                            pData->M_rot, MAX_NUM_SH_SIGNALS,
+                            pData->SHframeTF[band][0], TIME_SLOTS, &cbeta,
+                            pData->SHframeTF_rot[band][0], TIME_SLOTS);
+            }
+        }
+        else{
+            SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+            utility_cvvcopy(ADR3D(pData->SHframeTF), HYBRID_BANDS*(pData->nSHalloc)*TIME_SLOTS, ADR3D(pData->SHframeTF_rot));
+        }
+    
+        /* mix to headphones */
+        for(band = 0; band < HYBRID_BANDS; band++) {
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, TIME_SLOTS, nSH_active, &calpha,
+                        pars->M_dec[band], MAX_NUM_SH_SIGNALS,
+                        pData->SHframeTF_rot[band][0], TIME_SLOTS, &cbeta,
+                        pData->binframeTF[band][0], TIME_SLOTS);
+        }
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+    }
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void ambi_bin_processFrame
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int n, t, ch, i;
+    int o[MAX_SH_ORDER+2];
+    
     /* local copies of user parameters */
-    int order, nSH, enableRot;
+    int order, nSH, nSH_active, enableRot;
     AMBI_BIN_NORM_TYPES norm;
     AMBI_BIN_CH_ORDER chOrdering;
   
     /* decode audio to loudspeakers or headphones */
-    if ( (nSamples == FRAME_SIZE) && (pData->codecStatus == CODEC_STATUS_INITIALISED) ){
+    if (pData->codecStatus == CODEC_STATUS_INITIALISED){
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
         
         /* copy user parameters to local variables */
         for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
@@ -318,6 +566,7 @@ void ambi_bin_process
         enableRot = pData->enableRotation;
         
         /* Load time-domain data */
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
         switch(chOrdering){
             case CH_ACN:
                 for(i=0; i < MIN(nSH, nInputs); i++)
@@ -359,69 +608,295 @@ void ambi_bin_process
                 break;
         }
         
-        /* Apply time-frequency transform (TFT) */
-        for(t=0; t< TIME_SLOTS; t++) {
-            for(ch = 0; ch < nSH; ch++)
-                utility_svvcopy(&(pData->SHFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, pData->tempHopFrameTD, pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < nSH; ch++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+        /* the components above the effective order of the input carry no
+         * content, so the (single listener) rotation and decoding below may
+         * skip them */
+        nSH_active = ORDER2NSH(shOrderDetector_apply(pData->hOrderDet, pData->SHFrameTD, order, FRAME_SIZE));
+        
+        /* the time-domain decoder bypasses the filterbank */
+        if(pData->useTimeDomain){
+            SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
+            ambi_bin_decodeTimeDomain(hAmbi, order, enableRot, outputs, nOutputs);
         }
-    
-        /* Main processing: */
-            /* Apply rotation */
-        if(order > 0 && enableRot) {
-            if(pData->recalc_M_rotFLAG){
-                memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
-                M_rot_tmp = malloc1d(nSH*nSH * sizeof(float));
-                yawPitchRoll2Rzyx(pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
-                getSHrotMtxReal(Rxyz, M_rot_tmp, order);
-                for (i = 0; i < nSH; i++)
-                    for (j = 0; j < nSH; j++)
-                        pData->M_rot[i][j] = cmplxf(M_rot_tmp[i*nSH + j], 0.0f);
-                free(M_rot_tmp);
-                pData->recalc_M_rotFLAG = 0;
-            }
-            for(band = 0; band < HYBRID_BANDS; band++) {
-                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, TIME_SLOTS, nSH, &calpha,
-                            pData->M_rot, MAX_NUM_SH_SIGNALS,
-                            pData->SHframeTF[band], TIME_SLOTS, &cbeta,
-                            pData->SHframeTF_rot[band], TIME_SLOTS);
+        else{
+            /* Apply time-frequency transform (TFT) */
+            for(t=0; t< TIME_SLOTS; t++) {
+                for(ch = 0; ch < nSH; ch++)
+                    utility_svvcopy(&(pData->SHFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
+                afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD, &(pData->SHframeTF[0][0][t]), pData->nSHalloc*TIME_SLOTS, TIME_SLOTS);
             }
-        }
-        else
-            utility_cvvcopy((const float_complex*)pData->SHframeTF, HYBRID_BANDS*MAX_NUM_SH_SIGNALS*TIME_SLOTS, (float_complex*)pData->SHframeTF_rot);
-            
-        /* mix to headphones */
-        for(band = 0; band < HYBRID_BANDS; band++) {
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, TIME_SLOTS, nSH, &calpha,
-                        pars->M_dec[band], MAX_NUM_SH_SIGNALS,
-                        pData->SHframeTF_rot[band], TIME_SLOTS, &cbeta,
-                        pData->binframeTF[band], TIME_SLOTS);
-        }
+            SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
+    
+            /* Main processing: */
+            ambi_bin_processFrameTF(hAmbi, order, nSH_active, enableRot);
    
-        /* inverse-TFT */
-        //postGain = powf(10.0f, POST_GAIN/20.0f);
-        for(t = 0; t < TIME_SLOTS; t++) {
-            for(band = 0; band < HYBRID_BANDS; band++) {
-                for(ch = 0; ch < NUM_EARS; ch++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->binframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->binframeTF[band][ch][t]);
-                }
+            /* inverse-TFT */
+            //postGain = powf(10.0f, POST_GAIN/20.0f);
+            SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
+            for(t = 0; t < TIME_SLOTS; t++) {
+                afSTFTinversePlanar(pData->hSTFT, &(pData->binframeTF[0][0][t]), NUM_EARS*(pData->nListeners)*TIME_SLOTS, TIME_SLOTS, pData->tempHopFrameTD);
+                for (ch = 0; ch < MIN(NUM_EARS*(pData->nListeners), nOutputs); ch++)
+                    utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+                for (; ch < nOutputs; ch++)
+                    memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
             }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
-                utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
-            for (; ch < nOutputs; ch++)
-                memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
+            SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
         }
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
-    else
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+}
+
+void ambi_bin_process
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_bin_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+int ambi_bin_processTF
+(
+    void  *  const hAmbi,
+    const float *  inTF,
+    float *        outTF,
+    int            nInputs,
+    int            maxNumOutputs,
+    int            nBands,
+    int            nTimeSlots
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int n, ch, band, order, nSH, nSH_in, nOut;
+    int o[MAX_SH_ORDER+2];
+    const int fuma2acn[4] = {0, 3, 1, 2};
+    float scale;
+    const float_complex* pInTF;
+    float_complex* pOutTF;
+    AMBI_BIN_NORM_TYPES norm;
+    
+    /* the time-domain decoder has no afSTFT-domain equivalent */
+    if (pData->codecStatus != CODEC_STATUS_INITIALISED){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return 0;
+    }
+    if (pData->useTimeDomain || nBands != HYBRID_BANDS || nTimeSlots != TIME_SLOTS)
+        return 0;
+    pData->procStatus = PROC_STATUS_ONGOING;
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    norm = pData->norm;
+    order = pData->order;
+    nSH = (order+1)*(order+1);
+    pInTF = (const float_complex*)inTF;
+    pOutTF = (float_complex*)outTF;
+    
+    /* Load the TF frame (converting to ACN/N3D, as in ambi_bin_processFrame()) */
+    for(band=0; band<HYBRID_BANDS; band++){
+        if(pData->chOrdering==CH_FUMA){ /* only for first-order */
+            nSH_in = nInputs>=4 ? 4 : 0;
+            for(ch=0; ch<nSH_in; ch++)
+                utility_cvvcopy(&pInTF[(band*nInputs + fuma2acn[ch])*TIME_SLOTS], TIME_SLOTS, pData->SHframeTF[band][ch]);
+        }
+        else{
+            nSH_in = MIN(nSH, nInputs);
+            utility_cvvcopy(&pInTF[band*nInputs*TIME_SLOTS], nSH_in*TIME_SLOTS, pData->SHframeTF[band][0]);
+        }
+        if(nSH_in<nSH)
+            memset(pData->SHframeTF[band][nSH_in], 0, (nSH-nSH_in)*TIME_SLOTS*sizeof(float_complex));
+        for (n = 0; n<order+1 && norm!=NORM_N3D; n++){
+            scale = norm==NORM_SN3D ? sqrtf(2.0f*(float)n+1.0f) : (n==0 ? sqrtf(2.0f) : sqrtf(3.0f));
+            for (ch = o[n]; ch<o[n+1]; ch++)
+                utility_svsmul((float*)pData->SHframeTF[band][ch], &scale, 2*TIME_SLOTS, NULL);
+        }
+    }
+    
+    /* Main processing: */
+    ambi_bin_processFrameTF(hAmbi, order, nSH, pData->enableRotation);
+    nOut = MIN(NUM_EARS*(pData->nListeners), maxNumOutputs);
+    for(band=0; band<HYBRID_BANDS; band++)
+        utility_cvvcopy(pData->binframeTF[band][0], nOut*TIME_SLOTS, &pOutTF[band*nOut*TIME_SLOTS]);
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+    saf_telemetry_frameEnd(pData->hTelemetry);
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
+    return nOut;
+}
+
+void ambi_bin_processInterleaved
+(
+    void  *  const hAmbi,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_bin_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Renders the segment of an offline job spanning the frames [first, last),
+ * using the instance of the calling thread; called via saf_parfor_run()
+ */
+static void ambi_bin_offlineRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    ambi_bin_offlineJob* job = (ambi_bin_offlineJob*)(hCtx);
+    ambi_bin_data *pW = (ambi_bin_data*)(job->hWorkers[threadIndex]);
+    float** frameIn, **frameOut;
+    int f, ch, nValid, n0, nStart, nEnd, fEnd;
+    
+    frameIn = (float**)malloc2d(MAX(job->nInputs, 1), FRAME_SIZE, sizeof(float));
+    frameOut = (float**)malloc2d(MAX(job->nOutputs, 1), FRAME_SIZE, sizeof(float));
+    
+    /* the output of frame 'f' spans the samples [f*FRAME_SIZE-delay,
+     * (f+1)*FRAME_SIZE-delay) of the delay-compensated output; so the frames
+     * are processed until the end of the segment has been written. The
+     * pre-roll frames are only processed to warm up the filterbank. */
+    nStart = first*FRAME_SIZE;
+    nEnd = MIN(last*FRAME_SIZE, job->nSamples);
+    fEnd = (nEnd + job->delay + FRAME_SIZE - 1)/FRAME_SIZE;
+    for(f=MAX(first-job->nPreRollFrames, 0); f<fEnd; f++){
+        /* (zero padded after the end of the signals) */
+        n0 = f*FRAME_SIZE;
+        nValid = CLAMP(job->nSamples - n0, 0, FRAME_SIZE);
+        for(ch=0; ch<job->nInputs; ch++){
+            if(nValid>0)
+                memcpy(frameIn[ch], &(job->inputs[ch][n0]), nValid*sizeof(float));
+            memset(&(frameIn[ch][nValid]), 0, (FRAME_SIZE-nValid)*sizeof(float));
+        }
+        ambi_bin_processFrame(pW, frameIn, frameOut, job->nInputs, job->nOutputs);
+        
+        /* copy over the part of this frame's output that lies in the segment */
+        n0 = f*FRAME_SIZE - job->delay;
+        if(n0+FRAME_SIZE<=nStart || n0>=nEnd)
+            continue;
+        for(ch=0; ch<job->nOutputs; ch++)
+            memcpy(&(job->outputs[ch][MAX(n0, nStart)]), &(frameOut[ch][MAX(nStart-n0, 0)]),
+                   (MIN(n0+FRAME_SIZE, nEnd) - MAX(n0, nStart))*sizeof(float));
+    }
+    
+    free(frameIn);
+    free(frameOut);
+}
+
+void ambi_bin_renderOffline
+(
+    void  *  const      hAmbi,
+    const float* const* inputs,
+    float* const*       outputs,
+    int                 nInputs,
+    int                 nOutputs,
+    int                 nSamples,
+    int                 nThreads
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_data *pW;
+    ambi_bin_offlineJob job;
+    void* hParFor;
+    int i, nFrames, nThreadsInUse;
+    
+    nFrames = (nSamples + FRAME_SIZE - 1)/FRAME_SIZE;
+    if(nFrames<1)
+        return;
+    
+    /* one single-threaded instance per thread, with the current configuration */
+    saf_parfor_create(&hParFor, nThreads);
+    nThreadsInUse = saf_parfor_getNumThreads(hParFor);
+    job.hWorkers = (void**)malloc1d(nThreadsInUse*sizeof(void*));
+    for(i=0; i<nThreadsInUse; i++){
+        ambi_bin_createMultiListener(&(job.hWorkers[i]), pData->nListeners);
+        pW = (ambi_bin_data*)(job.hWorkers[i]);
+        pW->nSH = (pData->new_order+1)*(pData->new_order+1);
+        afSTFTinit(&(pW->hSTFT), HOP_SIZE, pW->nSH, NUM_EARS*(pW->nListeners), 0, 1, 1); /* (the threads are already taken) */
+        pW->new_order = pData->new_order;
+        pW->enableMaxRE = pData->enableMaxRE;
+        pW->enableDiffuseMatching = pData->enableDiffuseMatching;
+        pW->enablePhaseWarping = pData->enablePhaseWarping;
+        pW->method = pData->method;
+        memcpy(pW->EQ, pData->EQ, HYBRID_BANDS*sizeof(float));
+        if(!pData->useDefaultHRIRsFLAG && pData->pars->sofa_filepath!=NULL)
+            ambi_bin_setSofaFilePath(job.hWorkers[i], pData->pars->sofa_filepath);
+        if(pData->pars->prebakedDec!=NULL)
+            ambi_bin_setPrebakedDecoder(job.hWorkers[i], (const float*)pData->pars->prebakedDec, pData->pars->prebakedOrder);
+        pW->chOrdering = pData->chOrdering;
+        pW->norm = pData->norm;
+        pW->enableRotation = pData->enableRotation;
+        pW->enableRotationFusion = pData->enableRotationFusion;
+        pW->domain = pData->domain;
+        pW->yaw = pData->yaw;
+        pW->pitch = pData->pitch;
+        pW->roll = pData->roll;
+        pW->bFlipYaw = pData->bFlipYaw;
+        pW->bFlipPitch = pData->bFlipPitch;
+        pW->bFlipRoll = pData->bFlipRoll;
+        pW->useRollPitchYawFlag = pData->useRollPitchYawFlag;
+        if(pData->nListeners>1)
+            memcpy(pW->listeners, pData->listeners, (pData->nListeners-1)*sizeof(ambi_bin_listener));
+        ambi_bin_init(job.hWorkers[i], pData->fs);
+        ambi_bin_initCodec(job.hWorkers[i]);
+    }
+    
+    /* the FIFO is bypassed, so only the delay of the filterbank (if any)
+     * remains; and twice that, plus the length of any decoding filters, is
+     * enough for the state to settle */
+    pW = (ambi_bin_data*)(job.hWorkers[0]);
+    job.delay = ambi_bin_getProcessingDelay(job.hWorkers[0]) - saf_fifo_getLatency(pW->hFIFO);
+    job.nPreRollFrames = (2*job.delay + pW->pars->decFilterLength + FRAME_SIZE - 1)/FRAME_SIZE + 1;
+    
+    /* render */
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.nInputs = MIN(nInputs, MAX_NUM_SH_SIGNALS);
+    job.nOutputs = nOutputs;
+    job.nSamples = nSamples;
+    saf_parfor_run(hParFor, &ambi_bin_offlineRange, (void*)&job, nFrames);
+    
+    for(i=0; i<nThreadsInUse; i++)
+        ambi_bin_destroy(&(job.hWorkers[i]));
+    free(job.hWorkers);
+    saf_parfor_destroy(&hParFor);
 }
 
 
@@ -440,7 +915,6 @@ void ambi_bin_setUseDefaultHRIRsflag(void* const hAmbi, int newState)
     
     if((!pData->useDefaultHRIRsFLAG) && (newState)){
         pData->useDefaultHRIRsFLAG = newState;
-        pData->reinit_hrtfsFLAG = 1;
         ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
     }
 }
@@ -453,13 +927,34 @@ void ambi_bin_setSofaFilePath(void* const hAmbi, const char* path)
     pars->sofa_filepath = malloc1d(strlen(path) + 1);
     strcpy(pars->sofa_filepath, path);
     pData->useDefaultHRIRsFLAG = 0;
-    pData->reinit_hrtfsFLAG = 1;
+    ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+}
+
+void ambi_bin_setPrebakedDecoder(void* const hAmbi, const float* decMtx, int order)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_codecPars* pars = pData->pars;
+    int nSH;
+    
+    /* (not safe to replace the decoder during intialisation) */
+    while (pData->codecStatus == CODEC_STATUS_INITIALISING)
+        SAF_SLEEP(10);
+    free(pars->prebakedDec);
+    pars->prebakedDec = NULL;
+    if(decMtx!=NULL && order>=1 && order<=MAX_SH_ORDER){
+        nSH = (order+1)*(order+1);
+        pars->prebakedDec = (float_complex*)malloc1d(HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex));
+        memcpy(pars->prebakedDec, decMtx, HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex));
+        pars->prebakedOrder = order;
+        pData->new_order = order;
+    }
     ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
 }
 
 void ambi_bin_setInputOrderPreset(void* const hAmbi, AMBI_BIN_INPUT_ORDERS newOrder)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    newOrder = (AMBI_BIN_INPUT_ORDERS)CLAMP((int)newOrder, 1, MAX_SH_ORDER);
     if(pData->order != (int)newOrder){
         pData->new_order = (int)newOrder;
         ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
@@ -525,6 +1020,24 @@ void ambi_bin_setEnableRotation(void* const hAmbi, int newState)
     pData->enableRotation = newState;
 }
 
+void ambi_bin_setDecodingDomain(void* const hAmbi, AMBI_BIN_DECODING_DOMAINS newDomain)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    if(pData->domain != newDomain){
+        pData->domain = newDomain;
+        ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void ambi_bin_setEnableRotationFusion(void* const hAmbi, int newState)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    if(newState!=pData->enableRotationFusion){
+        pData->enableRotationFusion = newState;
+        pData->recalc_M_rotFLAG = 1; /* (both paths keep their rotation in a different matrix) */
+    }
+}
+
 void ambi_bin_setYaw(void  * const hAmbi, float newYaw)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
@@ -549,27 +1062,42 @@ void ambi_bin_setRoll(void* const hAmbi, float newRoll)
 void ambi_bin_setFlipYaw(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int l;
     if(newState !=pData->bFlipYaw ){
         pData->bFlipYaw = newState;
         ambi_bin_setYaw(hAmbi, -ambi_bin_getYaw(hAmbi));
+        for(l=0; l<pData->nListeners-1; l++){
+            pData->listeners[l].yaw = -pData->listeners[l].yaw;
+            pData->listeners[l].recalc_M_rotFLAG = 1;
+        }
     }
 }
 
 void ambi_bin_setFlipPitch(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int l;
     if(newState !=pData->bFlipPitch ){
         pData->bFlipPitch = newState;
         ambi_bin_setPitch(hAmbi, -ambi_bin_getPitch(hAmbi));
+        for(l=0; l<pData->nListeners-1; l++){
+            pData->listeners[l].pitch = -pData->listeners[l].pitch;
+            pData->listeners[l].recalc_M_rotFLAG = 1;
+        }
     }
 }
 
 void ambi_bin_setFlipRoll(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int l;
     if(newState !=pData->bFlipRoll ){
         pData->bFlipRoll = newState;
         ambi_bin_setRoll(hAmbi, -ambi_bin_getRoll(hAmbi));
+        for(l=0; l<pData->nListeners-1; l++){
+            pData->listeners[l].roll = -pData->listeners[l].roll;
+            pData->listeners[l].recalc_M_rotFLAG = 1;
+        }
     }
 }
 
@@ -579,6 +1107,33 @@ void ambi_bin_setRPYflag(void* const hAmbi, int newState)
     pData->useRollPitchYawFlag = newState;
 }
 
+void ambi_bin_setListenerOrientation
+(
+    void* const hAmbi,
+    int listenerIndex,
+    float newYaw,
+    float newPitch,
+    float newRoll
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_listener* lis;
+    
+    if(listenerIndex<0 || listenerIndex>=pData->nListeners)
+        return;
+    if(listenerIndex==0){
+        ambi_bin_setYaw(hAmbi, newYaw);
+        ambi_bin_setPitch(hAmbi, newPitch);
+        ambi_bin_setRoll(hAmbi, newRoll);
+        return;
+    }
+    lis = &(pData->listeners[listenerIndex-1]);
+    lis->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
+    lis->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
+    lis->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
+    lis->recalc_M_rotFLAG = 1;
+}
+
 
 /* Get Functions */
 
@@ -663,6 +1218,27 @@ int ambi_bin_getNumEars()
     return NUM_EARS;
 }
 
+int ambi_bin_getNumberOfBands(void)
+{
+    return HYBRID_BANDS;
+}
+
+int ambi_bin_getDecoder(void* const hAmbi, float* decMtx)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_codecPars* pars = pData->pars;
+    float_complex* dec = (float_complex*)decMtx;
+    int band, i, nSH;
+    
+    if(pData->codecStatus!=CODEC_STATUS_INITIALISED)
+        return 0;
+    nSH = (pData->order+1)*(pData->order+1);
+    for(band=0; band<HYBRID_BANDS; band++)
+        for(i=0; i<NUM_EARS; i++)
+            memcpy(&(dec[band*NUM_EARS*nSH + i*nSH]), pars->M_dec[band][i], nSH*sizeof(float_complex));
+    return pData->order;
+}
+
 int ambi_bin_getNSHrequired(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
@@ -675,6 +1251,24 @@ int ambi_bin_getEnableRotation(void* const hAmbi)
     return pData->enableRotation;
 }
 
+int ambi_bin_getDecodingDomain(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return (int)pData->domain;
+}
+
+int ambi_bin_getUsesTimeDomainDecoding(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->useTimeDomain;
+}
+
+int ambi_bin_getEnableRotationFusion(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->enableRotationFusion;
+}
+
 float ambi_bin_getYaw(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
@@ -717,6 +1311,12 @@ int ambi_bin_getRPYflag(void* const hAmbi)
     return pData->useRollPitchYawFlag;
 }
 
+int ambi_bin_getNumListeners(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->nListeners;
+}
+
 int ambi_bin_getNDirs(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
@@ -744,7 +1344,49 @@ int ambi_bin_getDAWsamplerate(void* const hAmbi)
     return pData->fs;
 }
 
-int ambi_bin_getProcessingDelay()
+int ambi_bin_getProcessingDelay(void* const hAmbi)
 {
-    return 12*HOP_SIZE;
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return saf_fifo_getLatency(pData->hFIFO) + (pData->useTimeDomain ? 0 : 12*HOP_SIZE);
+}
+
+void* ambi_bin_getProfiler(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->hProfiler;
+}
+
+void* ambi_bin_getTelemetry(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->hTelemetry;
+}
+
+void* ambi_bin_getInitReport(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->hInitReport;
+}
+
+size_t ambi_bin_getMemoryUsage(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    size_t n, nL, nHop, bytes;
+    
+    n = (size_t)pData->nSHalloc;
+    nL = (size_t)pData->nListeners;
+    nHop = (size_t)MAX(pData->nSHalloc, NUM_EARS*pData->nListeners);
+    bytes = sizeof(ambi_bin_data) + sizeof(ambi_bin_codecPars);
+    bytes += n*sizeof(float*) + n*FRAME_SIZE*sizeof(float);             /* SHFrameTD */
+    bytes += 2*HYBRID_BANDS*(sizeof(float_complex**) + n*sizeof(float_complex*) +
+                             n*TIME_SLOTS*sizeof(float_complex));       /* SHframeTF, SHframeTF_rot */
+    bytes += HYBRID_BANDS*(sizeof(float_complex**) + NUM_EARS*nL*sizeof(float_complex*) +
+                           NUM_EARS*nL*TIME_SLOTS*sizeof(float_complex)); /* binframeTF */
+    bytes += nHop*sizeof(float*) + nHop*HOP_SIZE*sizeof(float);         /* tempHopFrameTD */
+    if(pData->useTimeDomain)
+        bytes += (n+NUM_EARS)*FRAME_SIZE*sizeof(float);                 /* tdFrame_rot, tdFrame_bin (excl. the convolver) */
+    bytes += (nL-1)*sizeof(ambi_bin_listener);                         /* listeners */
+    bytes += nL*HYBRID_BANDS*NUM_EARS*n*sizeof(float_complex);          /* M_decRot */
+    bytes += AMBI_BIN_PROGRESSBARTEXT_CHAR_LENGTH*sizeof(char);
+    return bytes;
 }
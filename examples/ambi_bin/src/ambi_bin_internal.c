@@ -40,3 +40,197 @@ void ambi_bin_setCodecStatus(void* const hAmbi, AMBI_BIN_CODEC_STATUS newStatus)
     }
     pData->codecStatus = newStatus;
 }
+
+void ambi_bin_resizeBuffers(void* const hAmbi, int nSH)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    
+#ifdef SAF_EMBEDDED_PROFILE
+    int nTemp;
+    
+    if(pData->nSHalloc>0)
+        return;
+    nSH = MAX_NUM_SH_SIGNALS;
+    nTemp = MAX(nSH, NUM_EARS*pData->nListeners);
+    arena_create(&(pData->hArena), arena_size2d(nSH, FRAME_SIZE, sizeof(float)) +
+                                   2*arena_size3d(HYBRID_BANDS, nSH, TIME_SLOTS, sizeof(float_complex)) +
+                                   arena_size2d(nTemp, HOP_SIZE, sizeof(float)) +
+                                   arena_size1d(pData->nListeners*HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex)));
+    pData->SHFrameTD = (float**)arena_malloc2d_aligned(pData->hArena, nSH, FRAME_SIZE, sizeof(float));
+    pData->SHframeTF = (float_complex***)arena_malloc3d_aligned(pData->hArena, HYBRID_BANDS, nSH, TIME_SLOTS, sizeof(float_complex));
+    pData->SHframeTF_rot = (float_complex***)arena_malloc3d_aligned(pData->hArena, HYBRID_BANDS, nSH, TIME_SLOTS, sizeof(float_complex));
+    pData->tempHopFrameTD = (float**)arena_malloc2d_aligned(pData->hArena, nTemp, HOP_SIZE, sizeof(float));
+    pData->M_decRot = (float_complex*)arena_malloc1d_aligned(pData->hArena, pData->nListeners*HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex));
+    pData->nSHalloc = nSH;
+#else
+    if(nSH==pData->nSHalloc)
+        return;
+    pData->SHFrameTD = (float**)realloc2d((void**)pData->SHFrameTD, nSH, FRAME_SIZE, sizeof(float));
+    pData->SHframeTF = (float_complex***)realloc3d((void***)pData->SHframeTF, HYBRID_BANDS, nSH, TIME_SLOTS, sizeof(float_complex));
+    pData->SHframeTF_rot = (float_complex***)realloc3d((void***)pData->SHframeTF_rot, HYBRID_BANDS, nSH, TIME_SLOTS, sizeof(float_complex));
+    pData->tempHopFrameTD = (float**)realloc2d((void**)pData->tempHopFrameTD, MAX(nSH, NUM_EARS*pData->nListeners), HOP_SIZE, sizeof(float));
+    pData->M_decRot = (float_complex*)realloc1d(pData->M_decRot, pData->nListeners*HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex));
+    pData->nSHalloc = nSH;
+#endif
+}
+
+void ambi_bin_decodeListeners
+(
+    void* const hAmbi,
+    int order,
+    int enableRot
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_codecPars* pars = pData->pars;
+    ambi_bin_listener* lis;
+    const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    float_complex* M_decRot;
+    float Rxyz[3][3];
+    int l, i, j, band, nSH, rotate;
+    
+    nSH = (order+1)*(order+1);
+    rotate = order > 0 && enableRot;
+    
+    /* update the rotated decoders of any listeners that have moved */
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+    for(l=0; l<pData->nListeners && rotate; l++){
+        lis = l==0 ? NULL : &(pData->listeners[l-1]);
+        if(!(l==0 ? pData->recalc_M_rotFLAG : lis->recalc_M_rotFLAG))
+            continue;
+        if(l==0)
+            yawPitchRoll2Rzyx(pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
+        else
+            yawPitchRoll2Rzyx(lis->yaw, lis->pitch, lis->roll, pData->useRollPitchYawFlag, Rxyz);
+        shRotMtxReal_compute(pData->hSHrot, Rxyz, order, pData->M_rot_tmp);
+        for (i = 0; i < nSH; i++)
+            for (j = 0; j < nSH; j++)
+                pData->M_rot[i][j] = cmplxf(pData->M_rot_tmp[i*nSH + j], 0.0f);
+        M_decRot = &(pData->M_decRot[l*HYBRID_BANDS*NUM_EARS*nSH]);
+        for(band = 0; band < HYBRID_BANDS; band++) {
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, nSH, nSH, &calpha,
+                        pars->M_dec[band], MAX_NUM_SH_SIGNALS,
+                        pData->M_rot, MAX_NUM_SH_SIGNALS, &cbeta,
+                        &(M_decRot[band*NUM_EARS*nSH]), nSH);
+        }
+        if(l==0)
+            pData->recalc_M_rotFLAG = 0;
+        else
+            lis->recalc_M_rotFLAG = 0;
+    }
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+    
+    /* mix to the headphones of each listener */
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+    for(l=0; l<pData->nListeners; l++){
+        M_decRot = &(pData->M_decRot[l*HYBRID_BANDS*NUM_EARS*nSH]);
+        for(band = 0; band < HYBRID_BANDS; band++) {
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, TIME_SLOTS, nSH, &calpha,
+                        rotate ? &(M_decRot[band*NUM_EARS*nSH]) : (float_complex*)pars->M_dec[band],
+                        rotate ? nSH : MAX_NUM_SH_SIGNALS,
+                        pData->SHframeTF[band][0], TIME_SLOTS, &cbeta,
+                        pData->binframeTF[band][l*NUM_EARS], TIME_SLOTS);
+        }
+    }
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+}
+
+#ifndef SAF_EMBEDDED_PROFILE
+void ambi_bin_initTimeDomainDecoder
+(
+    void* const hAmbi,
+    int order
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    ambi_bin_codecPars* pars = pData->pars;
+    BINAURAL_AMBI_DECODER_METHODS method;
+    float_complex* hrtfs;
+    float* freqVector, *decFilters;
+    int nSH, fftSize, nBins;
+    
+    nSH = (order+1)*(order+1);
+    fftSize = 2;
+    while(fftSize < 2*pars->hrir_len)
+        fftSize *= 2;
+    nBins = fftSize/2 + 1;
+    switch(pData->method){
+        default:
+        case DECODING_METHOD_LS:       method = BINAURAL_DECODER_LS;       break;
+        case DECODING_METHOD_LSDIFFEQ: method = BINAURAL_DECODER_LSDIFFEQ; break;
+        case DECODING_METHOD_SPR:      method = BINAURAL_DECODER_SPR;      break;
+        case DECODING_METHOD_TA:       method = BINAURAL_DECODER_TA;       break;
+        case DECODING_METHOD_MAGLS:    method = BINAURAL_DECODER_MAGLS;    break;
+    }
+    
+    /* diffuse-field equalised HRTFs, at the resolution of the FFT */
+    hrtfs = malloc1d(nBins*NUM_EARS*(pars->N_hrir_dirs)*sizeof(float_complex));
+    HRIRs2HRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, fftSize, hrtfs);
+    freqVector = malloc1d(nBins*sizeof(float));
+    getUniformFreqVector(fftSize, (float)pars->hrir_fs, freqVector);
+    diffuseFieldEqualiseHRTFs(pars->N_hrir_dirs, pars->itds_s, freqVector, nBins, hrtfs);
+    
+    /* decoding filters; FLAT: NUM_EARS x nSH x fftSize, i.e. nCHout x nCHin x
+     * length_h, as expected by saf_matrixConv */
+    decFilters = malloc1d(NUM_EARS*nSH*fftSize*sizeof(float));
+    getBinauralAmbiDecoderFilters(hrtfs, pars->hrir_dirs_deg, pars->N_hrir_dirs, fftSize, (float)pars->hrir_fs,
+                                  method, order, pars->itds_s, NULL, pData->enableDiffuseMatching,
+                                  pData->enableMaxRE, decFilters);
+    if(pData->hMatrixConv!=NULL)
+        saf_matrixConv_destroy(&(pData->hMatrixConv));
+    saf_matrixConv_create(&(pData->hMatrixConv), FRAME_SIZE, decFilters, fftSize, nSH, NUM_EARS, 1);
+    pars->decFilterLength = fftSize;
+    pData->tdFrame_rot = (float*)realloc1d(pData->tdFrame_rot, nSH*FRAME_SIZE*sizeof(float));
+    pData->tdFrame_bin = (float*)realloc1d(pData->tdFrame_bin, NUM_EARS*FRAME_SIZE*sizeof(float));
+    
+    free(hrtfs);
+    free(freqVector);
+    free(decFilters);
+}
+#endif /* SAF_EMBEDDED_PROFILE */
+
+void ambi_bin_decodeTimeDomain
+(
+    void* const hAmbi,
+    int order,
+    int enableRot,
+    float** const outputs,
+    int nOutputs
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    float Rxyz[3][3];
+    float* SHframe;
+    int nSH, ch;
+    
+    nSH = (order+1)*(order+1);
+    
+    /* rotate the SH signals (rather than the filters) */
+    SHframe = ADR2D(pData->SHFrameTD);
+    if(order > 0 && enableRot){
+        if(pData->recalc_M_rotFLAG){
+            SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+            yawPitchRoll2Rzyx(pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
+            shRotMtxReal_compute(pData->hSHrot, Rxyz, order, pData->M_rot_tmp);
+            pData->recalc_M_rotFLAG = 0;
+            SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+        }
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
+                    pData->M_rot_tmp, nSH,
+                    SHframe, FRAME_SIZE, 0.0f,
+                    pData->tdFrame_rot, FRAME_SIZE);
+        SHframe = pData->tdFrame_rot;
+    }
+    else{
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+    }
+    
+    /* apply the 2 x nSH matrix of decoding filters */
+    saf_matrixConv_apply(pData->hMatrixConv, SHframe, pData->tdFrame_bin);
+    for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+        utility_svvcopy(&(pData->tdFrame_bin[ch*FRAME_SIZE]), FRAME_SIZE, outputs[ch]);
+    for (; ch < nOutputs; ch++)
+        memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+}
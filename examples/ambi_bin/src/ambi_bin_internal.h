@@ -54,6 +54,17 @@ typedef enum _AMBI_BIN_PROC_STATUS{
                               *   be reinitialised if needed. */
 }AMBI_BIN_PROC_STATUS;
 
+/**
+ * Stages of the initialisation, which are only recomputed if their inputs have
+ * changed (see saf_initDeps.h)
+ */
+typedef enum _AMBI_BIN_INIT_STAGES{
+    AMBI_BIN_STAGE_HRIRS = 0, /**< HRIRs and filterbank HRTFs */
+    AMBI_BIN_STAGE_DECODER,   /**< binaural decoding matrices */
+    
+    AMBI_BIN_NUM_INIT_STAGES
+}AMBI_BIN_INIT_STAGES;
+
 
 /* ========================================================================== */
 /*                            Internal Parameters                             */
@@ -65,6 +76,9 @@ typedef enum _AMBI_BIN_PROC_STATUS{
 #define NUM_EARS ( 2 ) /* true for most humans */
 #define MAX_SH_ORDER ( AMBI_BIN_MAX_SH_ORDER ) /* 7->64 channels; maximum for most hosts */
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER+1)*(MAX_SH_ORDER+1) )
+#if MAX_SH_ORDER < 1 || MAX_SH_ORDER > 7
+# error "AMBI_BIN_MAX_SH_ORDER must be between 1 and 7"
+#endif
 #define POST_GAIN ( -9.0f )   /* dB */
 #ifndef DEG2RAD
 # define DEG2RAD(x) (x * PI / 180.0f)
@@ -88,6 +102,7 @@ typedef struct _ambi_bin_codecPars
     
     /* sofa file info */
     char* sofa_filepath;    /**< absolute/relevative file path for a sofa file */
+    void* hHRTFs;           /**< shared HRIR data; see hrtfCache_acquire() */
     float* hrirs;           /**< time domain HRIRs; FLAT: N_hrir_dirs x 2 x hrir_len */
     float* hrir_dirs_deg;   /**< directions of the HRIRs in degrees [azi elev]; FLAT: N_hrir_dirs x 2 */
     int N_hrir_dirs;        /**< number of HRIR directions in the current sofa file */
@@ -98,7 +113,22 @@ typedef struct _ambi_bin_codecPars
     float* itds_s;          /**< interaural-time differences for each HRIR (in seconds); N_hrirs x 1 */
     float_complex* hrtf_fb; /**< HRTF filterbank coeffs; FLAT: nBands x nCH x N_hrirs */
     
+    /* time-domain decoder */
+    int decFilterLength;    /**< length of the FIR decoding filters (0 if not used) */
+    
+    /* prebaked decoder */
+    float_complex* prebakedDec; /**< see ambi_bin_setPrebakedDecoder(); FLAT: HYBRID_BANDS x NUM_EARS x (prebakedOrder+1)^2; NULL if not used */
+    int prebakedOrder;      /**< decoding order of prebakedDec */
+    
 }ambi_bin_codecPars;
+
+/** Orientation of an additional listener; see ambi_bin_createMultiListener() */
+typedef struct _ambi_bin_listener
+{
+    float yaw, pitch, roll;         /**< rotation angles in radians (with any flips applied) */
+    int recalc_M_rotFLAG;           /**< 0: no init required, 1: init required */
+    
+}ambi_bin_listener;
     
 /**
  * Main structure for ambi_bin. Contains variables for audio buffers, afSTFT,
@@ -108,16 +138,25 @@ typedef struct _ambi_bin
 {
     /* audio buffers + afSTFT time-frequency transform handle */
     int fs;                         /**< host sampling rate */
-    float SHFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
-    float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
-    float_complex SHframeTF_rot[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
-    float_complex binframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hProfiler; /**< per-stage timing (see saf_profiler.h) */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
+    void* hInitReport; /**< stages of the last initCodec() call (see saf_initReport.h) */
+    void* hInitDeps; /**< inputs of the initialisation stages, see AMBI_BIN_INIT_STAGES (and saf_initDeps.h) */
+    int nSHalloc;                   /**< number of SH signals the buffers below are sized for; see ambi_bin_resizeBuffers() */
+    void* hArena;                   /**< backing allocation of the buffers below, with the embedded profile; NULL otherwise */
+    float** SHFrameTD;              /**< nSHalloc x FRAME_SIZE */
+    float_complex*** SHframeTF;     /**< HYBRID_BANDS x nSHalloc x TIME_SLOTS */
+    float_complex*** SHframeTF_rot; /**< HYBRID_BANDS x nSHalloc x TIME_SLOTS */
+    float_complex*** binframeTF;    /**< HYBRID_BANDS x (NUM_EARS*nListeners) x TIME_SLOTS */
     void* hSTFT;                    /**< afSTFT handle */
     int afSTFTdelay;                /**< for host delay compensation */
-    float** tempHopFrameTD;         /**< temporary multi-channel time-domain buffer of size "HOP_SIZE". */
+    float** tempHopFrameTD;         /**< temporary multi-channel time-domain buffer of size "HOP_SIZE"; MAX(nSHalloc, NUM_EARS*nListeners) x HOP_SIZE */
     float freqVector[HYBRID_BANDS]; /**< frequency vector for time-frequency transform, in Hz */
+    int useTimeDomain;              /**< 1: decode in the time-domain, 0: in the afSTFT domain; see ambi_bin_initCodec() */
+    void* hMatrixConv;              /**< time-domain decoder (saf_matrixConv handle); NULL if not used */
+    float* tdFrame_rot;             /**< rotated SH frame for the time-domain decoder; FLAT: nSH x FRAME_SIZE */
+    float* tdFrame_bin;             /**< binaural frame of the time-domain decoder; FLAT: NUM_EARS x FRAME_SIZE */
      
     /* our codec configuration */
     AMBI_BIN_CODEC_STATUS codecStatus;
@@ -128,12 +167,18 @@ typedef struct _ambi_bin
     /* internal variables */
     AMBI_BIN_PROC_STATUS procStatus;
     float_complex M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS]; 
+    float M_rot_tmp[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS]; /**< packed nSH x nSH real rotation matrix */
+    void* hSHrot;                   /**< SH rotation matrix generator handle */
+    void* hOrderDet;                /**< effective input order detector; only the orders carrying content are rotated/decoded */
+    int nListeners;                 /**< number of listeners decoded from the same input spectra; fixed at creation */
+    ambi_bin_listener* listeners;   /**< listeners 1..nListeners-1 (listener 0 uses yaw/pitch/roll); (nListeners-1) x 1 */
+    float_complex* M_decRot;        /**< decoders with the rotation of each listener applied; FLAT: nListeners x HYBRID_BANDS x NUM_EARS x nSHalloc */
     int new_order;                  /**< new decoding order */
     int nSH;                        /**< number of spherical harmonic signals */
     
     /* flags */ 
     int recalc_M_rotFLAG;           /**< 0: no init required, 1: init required */
-    int reinit_hrtfsFLAG;           /**< 0: no init required, 1: init required */
+    int reinit_hrtfsFLAG;           /**< 1: reload the HRIRs, even if their inputs are unchanged */
     
     /* user parameters */
     int order;                      /**< current decoding order */
@@ -146,12 +191,28 @@ typedef struct _ambi_bin
     AMBI_BIN_CH_ORDER chOrdering;
     AMBI_BIN_NORM_TYPES norm;
     int enableRotation;
+    AMBI_BIN_DECODING_DOMAINS domain; /**< requested decoding domain; see ambi_bin_setDecodingDomain() */
+    int enableRotationFusion;       /**< 1: merge the rotation into the decoding matrices (see ambi_bin_decodeListeners()), 0: rotate the SH signals */
     float yaw, roll, pitch;         /**< rotation angles in degrees */
     int bFlipYaw, bFlipPitch, bFlipRoll; /**< flag to flip the sign of the individual rotation angles */
     int useRollPitchYawFlag;        /**< rotation order flag, 1: r-p-y, 0: y-p-r */
     
 } ambi_bin_data;
 
+/** An offline rendering job, split into segments over the threads of a pool */
+typedef struct _ambi_bin_offlineJob
+{
+    void** hWorkers;             /* one ambi_bin instance per thread */
+    const float* const* inputs;  /* input signals; nInputs x nSamples */
+    float* const* outputs;       /* output signals; nOutputs x nSamples */
+    int nInputs;                 /* number of input signals */
+    int nOutputs;                /* number of output signals */
+    int nSamples;                /* number of samples per channel */
+    int nPreRollFrames;          /* frames processed before each segment, for the filterbank to settle */
+    int delay;                   /* delay of the filterbank, in samples, which is compensated for */
+    
+} ambi_bin_offlineJob;
+
 
 /* ========================================================================== */
 /*                             Internal Functions                             */
@@ -163,6 +224,69 @@ typedef struct _ambi_bin
 void ambi_bin_setCodecStatus(void* const hAmbi,
                              AMBI_BIN_CODEC_STATUS newStatus);
 
+/**
+ * (Re)allocates the buffers which scale with the number of SH signals, if
+ * 'nSH' differs from the number they are currently sized for; so that an
+ * instance only holds the memory required by its current decoding order.
+ *
+ * With the embedded profile (SAF_EMBEDDED_PROFILE), the buffers are instead
+ * sized for MAX_NUM_SH_SIGNALS by the first call, and carved out of one arena
+ * (see arena_create()); so that the footprint of an instance is fixed at
+ * creation, and nothing is reallocated afterwards.
+ *
+ * @note Must not be called while processing.
+ */
+void ambi_bin_resizeBuffers(void* const hAmbi,
+                            int nSH);
+
+/**
+ * Decodes the (non-rotated) SH input spectra to the binaural signals of each
+ * listener; used when there is more than one (see
+ * ambi_bin_createMultiListener()), or if rotation fusion is enabled
+ *
+ * The rotation of each listener is merged into its own copy of the decoding
+ * matrices (M_decRot = M_dec * M_rot) whenever it changes, so that each
+ * listener then only costs one NUM_EARS x nSH matrix multiplication per band.
+ *
+ * @param[in] hAmbi     ambi_bin handle
+ * @param[in] order     Decoding order
+ * @param[in] enableRot 1: apply the rotation of each listener, 0: do not
+ */
+void ambi_bin_decodeListeners(void* const hAmbi,
+                              int order,
+                              int enableRot);
+
+/**
+ * (Re)computes the FIR decoding filters from the current HRIRs, and
+ * (re)creates the partitioned convolver that applies them
+ *
+ * The HRTFs are diffuse-field equalised (as the filterbank HRTFs are) before
+ * the decoder is designed, and the FFT size is twice the HRIR length (rounded
+ * up to a power of 2). Not available with the embedded profile, since the
+ * HRIRs are not used.
+ *
+ * @param[in] hAmbi ambi_bin handle
+ * @param[in] order Decoding order
+ */
+void ambi_bin_initTimeDomainDecoder(void* const hAmbi,
+                                    int order);
+
+/**
+ * Decodes one frame of (N3D) SH signals in the time-domain; rotating them
+ * first (if enabled), and then applying the FIR decoding filters
+ *
+ * @param[in]  hAmbi     ambi_bin handle
+ * @param[in]  order     Decoding order
+ * @param[in]  enableRot 1: apply the rotation, 0: do not
+ * @param[out] outputs   Output frame; nOutputs x FRAME_SIZE
+ * @param[in]  nOutputs  Number of output channels
+ */
+void ambi_bin_decodeTimeDomain(void* const hAmbi,
+                               int order,
+                               int enableRot,
+                               float** const outputs,
+                               int nOutputs);
+
 
 #ifdef __cplusplus
 } /* extern "C" { */
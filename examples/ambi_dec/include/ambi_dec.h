@@ -177,6 +177,9 @@ typedef enum _AMBI_DEC_CODEC_STATUS {
 /** Maximum number of loudspeakers supported */
 #define AMBI_DEC_MAX_NUM_OUTPUTS ( 64 )
 
+/** Maximum number of additional layouts, see ambi_dec_addLayout() */
+#define AMBI_DEC_MAX_NUM_LAYOUTS ( 4 )
+
 /** Minimum transition value between low/high frequency decoders, in Hz */
 #define AMBI_DEC_TRANSITION_MIN_VALUE ( 500.0f )
 
@@ -221,9 +224,41 @@ void ambi_dec_init(void* const hAmbi,
  */
 void ambi_dec_initCodec(void* const hAmbi);
 
+/**
+ * Prepares the instance for playback, from the calling (non-real-time) thread;
+ * i.e. initialises the codec (if needed), and runs ambi_dec_process() over a
+ * few blocks of silence, such that the first audio callback does not incur
+ * the cost of touching the buffers and tables for the first time. The block
+ * size is also passed to the internal FIFO, which selects whether it adds any
+ * latency (see ambi_dec_getProcessingDelay())
+ *
+ * @note Call after ambi_dec_init(), and before the first call to
+ *       ambi_dec_process() (e.g. in the host's prepare-to-play callback); see
+ *       saf_warmUp.h
+ *
+ * @param[in] hAmbi     ambi_dec handle
+ * @param[in] nInputs   Number of input channels (as passed by the host)
+ * @param[in] nOutputs  Number of output channels (as passed by the host)
+ * @param[in] blockSize Number of samples per block (as passed by the host)
+ */
+void ambi_dec_prepareToPlay(void* const hAmbi,
+                            int nInputs,
+                            int nOutputs,
+                            int blockSize);
+
 /**
  * Decodes input spherical harmonic signals to the loudspeaker channels.
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in ambi_dec_getProcessingDelay(). However, if the
+ *       time-domain path is enabled (see ambi_dec_setEnableTimeDomainPath())
+ *       and the settings are frequency-independent (i.e. the loudspeaker
+ *       signals are not binauralised and the master order is used for all
+ *       bands), then the signals are instead decoded directly in the
+ *       time-domain, without any added latency.
+ *
  * @param[in] hAmbi    ambi_dec handle
  * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
@@ -238,6 +273,113 @@ void ambi_dec_process(void* const hAmbi,
                       int nOutputs,
                       int nSamples);
 
+/**
+ * Same as ambi_dec_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hAmbi    ambi_dec handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void ambi_dec_processInterleaved(void* const hAmbi,
+                                 const float* inputs,
+                                 float* outputs,
+                                 int nInputs,
+                                 int nOutputs,
+                                 int nSamples);
+
+/**
+ * Decodes one afSTFT-domain frame of spherical harmonic signals to the
+ * loudspeakers (or to the binaural channels, if enabled), for use as a stage of
+ * a saf_tfGraph (see saf_tfGraph_stageProcessor)
+ *
+ * This is the main processing of ambi_dec_process(), without the FIFO and the
+ * forward/inverse afSTFT; which are instead applied once for the whole chain by
+ * the graph. The time-domain path and the SH order detector (which operate on
+ * time-domain signals) are not used.
+ *
+ * @param[in]  hAmbi         ambi_dec handle
+ * @param[in]  inTF          Input frame (complex); FLAT: HYBRID_BANDS x
+ *                           nInputs x TIME_SLOTS
+ * @param[out] outTF         Output frame (complex); FLAT: HYBRID_BANDS x
+ *                           nOutputs x TIME_SLOTS
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels
+ * @param[in]  nBands        Number of bands (must be HYBRID_BANDS)
+ * @param[in]  nTimeSlots    Number of time slots (must be TIME_SLOTS)
+ * @returns Number of output channels (nLoudspeakers, or NUM_EARS if
+ *          binauralising), or 0 if not ready
+ */
+int ambi_dec_processTF(void* const hAmbi,
+                       const float* inTF,
+                       float* outTF,
+                       int nInputs,
+                       int maxNumOutputs,
+                       int nBands,
+                       int nTimeSlots);
+
+/**
+ * Attaches another ambi_dec instance as an additional output layout, which is
+ * decoded from the TF-domain frames of this instance; i.e. one forward afSTFT
+ * (and input conversion/order detection) serves all of the layouts
+ *
+ * The layout instance is configured as usual (loudspeaker directions,
+ * decoding methods and orders, binaural mode, etc.), using its own set
+ * functions and its own ambi_dec_initCodec(); including the rebuilding of its
+ * decoders in the background. Its input settings (channel order and
+ * normalisation) are ignored, since the shared frames are already ACN/N3D.
+ * Each layout applies its own inverse afSTFT, and so the latency is the same
+ * for all layouts. The layout instance is not destroyed by this instance.
+ *
+ * @note Not thread safe; only add layouts while not processing. Only the
+ *       afSTFT path is used by ambi_dec_processLayouts() (i.e. not the
+ *       time-domain path).
+ *
+ * @param[in] hAmbi   ambi_dec handle (the primary layout)
+ * @param[in] hLayout ambi_dec handle of the additional layout
+ * @returns Index of the layout (1..AMBI_DEC_MAX_NUM_LAYOUTS), or -1 if
+ *          AMBI_DEC_MAX_NUM_LAYOUTS has been reached
+ */
+int ambi_dec_addLayout(void* const hAmbi,
+                       void* const hLayout);
+
+/** Detaches all of the additional layouts (see ambi_dec_addLayout()) */
+void ambi_dec_clearLayouts(void* const hAmbi);
+
+/**
+ * Returns the total number of output channels of ambi_dec_processLayouts();
+ * i.e. the sum, over this instance and the additional layouts, of the number
+ * of loudspeakers (or NUM_EARS, if binauralising)
+ */
+int ambi_dec_getNumLayoutOutputs(void* const hAmbi);
+
+/**
+ * Decodes input spherical harmonic signals to this instance's loudspeakers
+ * and to those of all of the additional layouts (see ambi_dec_addLayout())
+ *
+ * The output channels of the layouts are concatenated, in order: first those
+ * of this instance, followed by those of layout 1, layout 2, and so on. Each
+ * layout has as many channels as it has loudspeakers (or NUM_EARS, if it is
+ * binauralising its loudspeaker signals); see ambi_dec_getNumLayoutOutputs().
+ * Output channels beyond these are zeroed. With no additional layouts, this is
+ * the same as ambi_dec_process().
+ *
+ * @param[in] hAmbi    ambi_dec handle
+ * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[in] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples in 'inputs'/'output' matrices
+ */
+void ambi_dec_processLayouts(void* const hAmbi,
+                             float** const inputs,
+                             float** const outputs,
+                             int nInputs,
+                             int nOutputs,
+                             int nSamples);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -417,6 +559,22 @@ void ambi_dec_setDecNormType(void* const hAmbi, int index, int newID);
  */
 void ambi_dec_setTransitionFreq(void* const hAmbi, float newValue);
 
+/**
+ * Enables/disables the time-domain path, which is used whenever the settings
+ * are frequency-independent (no binauralisation, and the master order for all
+ * bands)
+ *
+ * The time-domain path bypasses the afSTFT (and the FIFO) and so adds no
+ * latency. The low and high frequency decoders are instead applied to the
+ * outputs of a 4th-order Linkwitz-Riley crossover at the transition frequency.
+ * Note that switching between the two paths is not seamless.
+ *
+ * @param[in] hAmbi    ambi_dec handle
+ * @param[in] newState 0: always use the afSTFT, 1: use the time-domain path
+ *                     when possible (default)
+ */
+void ambi_dec_setEnableTimeDomainPath(void* const hAmbi, int newState);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -577,6 +735,12 @@ int ambi_dec_getDecNormType(void* const hAmbi, int index);
  * decoder to the high frequency decoder.
  */
 float ambi_dec_getTransitionFreq(void* const hAmbi);
+
+/**
+ * Returns whether the time-domain path is enabled (1) or not (0); see
+ * ambi_dec_setEnableTimeDomainPath()
+ */
+int ambi_dec_getEnableTimeDomainPath(void* const hAmbi);
     
 /**
  * Returns the HRIR sample rate
@@ -589,10 +753,35 @@ int ambi_dec_getHRIRsamplerate(void* const hAmbi);
 int ambi_dec_getDAWsamplerate(void* const hAmbi);
     
 /**
- * Returns the processing delay in samples; may be used for delay compensation
+ * Returns the processing delay in samples of the path (afSTFT or time-domain)
+ * which was used for the most recent block; may be used for delay compensation
  * features
+ *
+ * This is 0 when decoding in the time-domain. Otherwise, it is the delay of
+ * the afSTFT, plus the latency of the internal FIFO, if any (i.e. if the host
+ * block size is not a multiple of FRAME_SIZE)
+ */
+int ambi_dec_getProcessingDelay(void* const hAmbi);
+
+/**
+ * Returns the handle of the profiler, which (when SAF_ENABLE_PROFILING is
+ * defined) times the stages of the processing loop; see saf_profiler_getStats()
+ */
+void* ambi_dec_getProfiler(void* const hAmbi);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* ambi_dec_getTelemetry(void* const hAmbi);
+
+/**
+ * Returns the handle of the report of the last ambi_dec_initCodec() call, which
+ * lists the time and memory taken by each of its stages; see
+ * saf_initReport_print()
  */
-int ambi_dec_getProcessingDelay(void);
+void* ambi_dec_getInitReport(void* const hAmbi);
 
 
 #ifdef __cplusplus
@@ -40,7 +40,7 @@ void ambi_dec_create
 {
     ambi_dec_data* pData = (ambi_dec_data*)malloc1d(sizeof(ambi_dec_data));
     *phAmbi = (void*)pData;
-    int i, j, ch, band;
+    int ch, band;
 
     /* default user parameters */
     pData->masterOrder = pData->new_masterOrder = 1;
@@ -61,17 +61,10 @@ void ambi_dec_create
     
     /* afSTFT stuff */
     pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS), HOP_SIZE, sizeof(float));
-    pData->STFTOutputFrameTF = malloc1d(MAX_NUM_LOUDSPEAKERS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_LOUDSPEAKERS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
+    arena_create(&(pData->hArena), arena_size2d(MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS), HOP_SIZE, sizeof(float)) +
+                                   arena_size2d(MAX_NUM_SH_SIGNALS, FRAME_SIZE, sizeof(float)) +
+                                   arena_size2d(MAX_NUM_LOUDSPEAKERS, FRAME_SIZE, sizeof(float)));
+    pData->tempHopFrameTD = (float**)arena_malloc2d_aligned(pData->hArena, MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS), HOP_SIZE, sizeof(float));
     
     /* codec data */
     pData->progressBar0_1 = 0.0f;
@@ -80,15 +73,11 @@ void ambi_dec_create
     pData->codecStatus = CODEC_STATUS_NOT_INITIALISED;
     pData->pars = (ambi_dec_codecPars*)malloc1d(sizeof(ambi_dec_codecPars));
     ambi_dec_codecPars* pars = pData->pars;
-    for (i=0; i<NUM_DECODERS; i++){
-        for(j=0; j<MAX_SH_ORDER; j++){
-            pars->M_dec[i][j] = NULL;
-            pars->M_dec_cmplx[i][j] = NULL;
-            pars->M_dec_maxrE[i][j] = NULL;
-            pars->M_dec_cmplx_maxrE[i][j] = NULL;
-        }
-    }
+    pars->dec = NULL;
+    pars->decCache = (ambi_dec_decoder*)calloc1d(1, sizeof(ambi_dec_decoder));
+    memset(pars->maxrE_weights, 0, MAX_SH_ORDER*sizeof(float*));
     pars->sofa_filepath = NULL;
+    pars->hHRTFs = NULL;
     pars->hrirs = NULL;
     pars->hrir_dirs_deg = NULL;
     pars->hrtf_vbap_gtableIdx = NULL;
@@ -99,12 +88,34 @@ void ambi_dec_create
     
     /* internal parameters */ 
     pData->binauraliseLS = pData->new_binauraliseLS = 0;
+    pData->enableTDpath = 1;
+    pData->tdPathActive = 0;
+    pData->xover_fc = 0.0f;
+    pData->xover_fs = 0;
+    IIRFilterbank_create(&(pData->hXover), MAX_NUM_SH_SIGNALS, &(pData->transitionFreq), 1, 48000.0f);
+    shOrderDetector_create(&(pData->hOrderDet), MAX_SH_ORDER, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*48000.0f));
+    pData->nSH_active = 1;
+    pData->nLayouts = 0;
+    pData->hLayoutFIFO = NULL;
     
     /* flags */
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
     pData->reinit_hrtfsFLAG = 1;
+    pData->clearTFbuffersFLAG = 0;
     for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
         pData->recalc_hrtf_interpFLAG[ch] = 1; 
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS);
+    saf_profiler_create(&(pData->hProfiler));
+    saf_telemetry_create(&(pData->hTelemetry));
+    saf_initReport_create(&(pData->hInitReport));
+    saf_initDeps_create(&(pData->hInitDeps), AMBI_DEC_NUM_INIT_STAGES);
+    pData->planarInTD = (float**)arena_malloc2d_aligned(pData->hArena, MAX_NUM_SH_SIGNALS, FRAME_SIZE, sizeof(float));
+    pData->planarOutTD = (float**)arena_malloc2d_aligned(pData->hArena, MAX_NUM_LOUDSPEAKERS, FRAME_SIZE, sizeof(float));
+    
+    /* for rebuilding the decoders in the background, once already initialised */
+    saf_asyncInit_create(&(pData->hDecInit), &ambi_dec_buildDecoder, &ambi_dec_destroyDecoder, NULL, *phAmbi);
 }
 
 void ambi_dec_destroy
@@ -114,7 +125,7 @@ void ambi_dec_destroy
 {
     ambi_dec_data *pData = (ambi_dec_data*)(*phAmbi);
     ambi_dec_codecPars *pars = pData->pars;
-    int i, j, ch;
+    int n;
     
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -123,40 +134,29 @@ void ambi_dec_destroy
             SAF_SLEEP(10);
         }
         
+        /* cancel/wait for any background rebuild of the decoders */
+        saf_asyncInit_destroy(&(pData->hDecInit));
+        
         /* free afSTFT and buffers */
         if(pData->hSTFT!=NULL)
             afSTFTfree(pData->hSTFT);
-        if(pData->STFTInputFrameTF!=NULL){
-            for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-                free(pData->STFTInputFrameTF[ch].re);
-                free(pData->STFTInputFrameTF[ch].im);
-            }
-        }
-        if((pData->STFTOutputFrameTF!=NULL)){
-            for (ch = 0; ch < MAX_NUM_LOUDSPEAKERS; ch++) {
-                free(pData->STFTOutputFrameTF[ch].re);
-                free(pData->STFTOutputFrameTF[ch].im);
-            }
-        }
-        free(pData->STFTInputFrameTF);
-        free(pData->STFTOutputFrameTF);
-        free(pData->tempHopFrameTD);
         free(pars->hrtf_vbap_gtableComp);
         free(pars->hrtf_vbap_gtableIdx);
-        free(pars->hrtf_fb);
-        free(pars->hrtf_fb_mag);
-        free(pars->itds_s);
-        free(pars->hrirs);
-        free(pars->hrir_dirs_deg);
-        for (i=0; i<NUM_DECODERS; i++){
-            for(j=0; j<MAX_SH_ORDER; j++){
-                free(pars->M_dec[i][j]);
-                free(pars->M_dec_cmplx[i][j]);
-                free(pars->M_dec_maxrE[i][j]);
-                free(pars->M_dec_cmplx_maxrE[i][j]);
-            }
-        }
+        hrtfCache_release(&(pars->hHRTFs));
+        ambi_dec_destroyDecoder(pData, (void*)pars->dec);
+        ambi_dec_destroyDecoder(pData, (void*)pars->decCache);
+        for(n=0; n<MAX_SH_ORDER; n++)
+            free(pars->maxrE_weights[n]);
         free(pData->progressBarText);
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_fifo_destroy(&(pData->hLayoutFIFO));
+        saf_profiler_destroy(&(pData->hProfiler));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        saf_initReport_destroy(&(pData->hInitReport));
+        saf_initDeps_destroy(&(pData->hInitDeps));
+        arena_destroy(&(pData->hArena));
+        IIRFilterbank_destroy(&(pData->hXover));
+        shOrderDetector_destroy(&(pData->hOrderDet));
         free(pData);
         pData = NULL;
     }
@@ -179,6 +179,7 @@ void ambi_dec_init
         else /* Assume 48kHz */
             pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     }
+    shOrderDetector_reset(pData->hOrderDet, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*(float)sampleRate));
 }
 
 void ambi_dec_initCodec
@@ -188,9 +189,9 @@ void ambi_dec_initCodec
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     ambi_dec_codecPars* pars = pData->pars;
-    int i, ch, d, j, n, ng, nGrid_dirs, masterOrder, nSH_order, max_nSH, nLoudspeakers;
-    float* grid_dirs_deg, *Y, *M_dec_tmp, *g, *a, *e, *a_n, *hrtf_vbap_gtable;;
-    float a_avg[MAX_SH_ORDER], e_avg[MAX_SH_ORDER], azi_incl[2], sum_elev;
+    int ch, masterOrder, max_nSH, nLoudspeakers, nOutputs, nGains;
+    ambi_dec_decoder* dec;
+    void* hHRTFs, *hPar;
     
     if (pData->codecStatus != CODEC_STATUS_NOT_INITIALISED)
         return; /* re-init not required, or already happening */
@@ -204,393 +205,1037 @@ void ambi_dec_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    saf_initReport_start(pData->hInitReport);
     
-    /* reinit afSTFT */
+    /* reinit afSTFT (only if the number of channels has changed) */
+    saf_initReport_beginStage("afSTFTinit");
     masterOrder = pData->new_masterOrder;
     max_nSH = (masterOrder+1)*(masterOrder+1);
     nLoudspeakers = pData->new_nLoudpkrs;
+    nOutputs = pData->new_binauraliseLS ? NUM_EARS : nLoudspeakers;
+    saf_initDeps_begin(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT, &max_nSH, sizeof(int));
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT, &nOutputs, sizeof(int));
     if(pData->hSTFT==NULL){
-        if(pData->new_binauraliseLS)
-            afSTFTinit(&(pData->hSTFT), HOP_SIZE, max_nSH, NUM_EARS, 0, 1);
-        else
-            afSTFTinit(&(pData->hSTFT), HOP_SIZE, max_nSH, nLoudspeakers, 0, 1);
-        afSTFTclearBuffers(pData->hSTFT);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, max_nSH, nOutputs, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+        saf_initDeps_commit(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT);
     }
-    else{
-        if(pData->new_binauraliseLS)
-            afSTFTchannelChange(pData->hSTFT, max_nSH, NUM_EARS);
-        else
-            afSTFTchannelChange(pData->hSTFT, max_nSH, nLoudspeakers);
-        afSTFTclearBuffers(pData->hSTFT);
+    else if(saf_initDeps_isStale(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT)){
+        afSTFTchannelChange(pData->hSTFT, max_nSH, nOutputs);
+        saf_initDeps_commit(pData->hInitDeps, AMBI_DEC_STAGE_AFSTFT);
     }
+    afSTFTclearBuffers(pData->hSTFT);
+    saf_initReport_endStage();
     pData->binauraliseLS = pData->new_binauraliseLS;
     pData->nLoudpkrs = nLoudspeakers;
     
-    /* Quick and dirty check to find loudspeaker dimensionality */
+    /* (re)compute the decoding matrices; superseding any background rebuild */
     strcpy(pData->progressBarText,"Computing decoder");
     pData->progressBar0_1 = 0.2f;
-    sum_elev = 0.0f;
-    for(ch=0; ch < nLoudspeakers; ch++)
-        sum_elev += fabsf(pData->loudpkrs_dirs_deg[ch][1]);
-    if( (((sum_elev < 5.0f) && (sum_elev > -5.0f))) || (nLoudspeakers < 4) )
-        pData->loudpkrs_nDims = 2;
-    else
-        pData->loudpkrs_nDims = 3;
-    
-    /* add virtual loudspeakers for 2D case */
-    if (pData->loudpkrs_nDims == 2){
-        assert(nLoudspeakers<=MAX_NUM_LOUDSPEAKERS-2);
-        pData->loudpkrs_dirs_deg[nLoudspeakers][0] = 0.0f;
-        pData->loudpkrs_dirs_deg[nLoudspeakers][1] = -90.0f;
-        pData->loudpkrs_dirs_deg[nLoudspeakers+1][0] = 0.0f;
-        pData->loudpkrs_dirs_deg[nLoudspeakers+1][1] = 90.0f;
-        nLoudspeakers += 2;
-    }
-    
-    /* prep */
-    nGrid_dirs = 480; /* Minimum t-design of degree 30, has 480 points */
-    g = malloc1d(nLoudspeakers*sizeof(float));
-    a = malloc1d(nGrid_dirs*sizeof(float));
-    e = malloc1d(nGrid_dirs*sizeof(float));
-    
-    /* calculate loudspeaker decoding matrices */
-    for( d=0; d<NUM_DECODERS; d++){
-        M_dec_tmp = malloc1d(nLoudspeakers * max_nSH * sizeof(float));
-        switch(pData->dec_method[d]){
-            case DECODING_METHOD_SAD:
-                getLoudspeakerAmbiDecoderMtx((float*)pData->loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_SAD, masterOrder, 0, M_dec_tmp);
-                break;
-            case DECODING_METHOD_MMD:
-                getLoudspeakerAmbiDecoderMtx((float*)pData->loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_MMD, masterOrder, 0, M_dec_tmp);
-                break;
-            case DECODING_METHOD_EPAD:
-                getLoudspeakerAmbiDecoderMtx((float*)pData->loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_EPAD, masterOrder, 0, M_dec_tmp);
-                break;
-            case DECODING_METHOD_ALLRAD:
-                getLoudspeakerAmbiDecoderMtx((float*)pData->loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_ALLRAD, masterOrder, 0, M_dec_tmp);
-                break;
-        }
-        
-        /* diffuse-field EQ for orders 1..masterOrder */
-        for( n=1; n<=masterOrder; n++){
-            /* truncate M_dec for each order */
-            nSH_order = (n+1)*(n+1);
-            free(pars->M_dec[d][n-1]);
-            pars->M_dec[d][n-1] = malloc1d(nLoudspeakers* nSH_order * sizeof(float));
-            free(pars->M_dec_cmplx[d][n-1]);
-            pars->M_dec_cmplx[d][n-1] = malloc1d(nLoudspeakers * nSH_order * sizeof(float_complex));
-            for(i=0; i<nLoudspeakers; i++){
-                for(j=0; j<nSH_order; j++){
-                    pars->M_dec[d][n-1][i*nSH_order+j] = M_dec_tmp[i*max_nSH +j]; /* for applying in the time domain, and... */
-                    pars->M_dec_cmplx[d][n-1][i*nSH_order+j] = cmplxf(pars->M_dec[d][n-1][i*nSH_order+j], 0.0f); /* for the time-frequency domain */
-                }
-            }
-            
-            /* create dedicated maxrE weighted versions */
-            a_n = malloc1d(nSH_order*nSH_order*sizeof(float));
-            getMaxREweights(n, 1, a_n); /* weights returned as diagonal matrix */
-            free(pars->M_dec_maxrE[d][n-1]);
-            pars->M_dec_maxrE[d][n-1] = malloc1d(nLoudspeakers * nSH_order * sizeof(float));
-            free(pars->M_dec_cmplx_maxrE[d][n-1]);
-            pars->M_dec_cmplx_maxrE[d][n-1] = malloc1d(nLoudspeakers * nSH_order * sizeof(float_complex));
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, nSH_order, nSH_order, 1.0f,
-                        pars->M_dec[d][n-1], nSH_order,
-                        a_n, nSH_order, 0.0f,
-                        pars->M_dec_maxrE[d][n-1], nSH_order); /* for applying in the time domain */
-            for(i=0; i<nLoudspeakers * nSH_order; i++)
-                pars->M_dec_cmplx_maxrE[d][n-1][i] = cmplxf(pars->M_dec_maxrE[d][n-1][i], 0.0f); /* for the time-frequency domain */
-            
-            /* fire a plane-wave from each grid direction to find the total energy/amplitude (using non-maxrE weighted versions) */
-            Y = malloc1d(nSH_order*sizeof(float));
-            grid_dirs_deg = (float*)(&__Tdesign_degree_30_dirs_deg[0][0]);
-            for(ng=0; ng<nGrid_dirs; ng++){
-                azi_incl[0] = grid_dirs_deg[ng*2]*M_PI/180.0f;
-                azi_incl[1] = M_PI/2.0f-grid_dirs_deg[ng*2+1]*M_PI/180.0f;
-                getSHreal(n, (float*)azi_incl, 1,  Y);
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nLoudspeakers, 1, nSH_order, 1.0f,
-                            pars->M_dec[d][n-1], nSH_order,
-                            Y, nSH_order, 0.0f,
-                            g, 1);
-                a[ng] = e[ng] = 0.0f;
-                for(i=0; i<nLoudspeakers; i++){
-                    a[ng] += g[i];
-                    e[ng] += powf(g[i], 2.0f);
-                }
-            }
-            
-            /* determine the order+decoder dependent normalisation factor for energy+amplitude preserving decoding */
-            a_avg[n-1] = e_avg[n-1] = 0.0f;
-            for(ng=0; ng<nGrid_dirs; ng++){
-                a_avg[n-1] += a[ng];
-                e_avg[n-1] += e[ng];
-            }
-            a_avg[n-1] /= (float)nGrid_dirs;
-            e_avg[n-1] /= (float)nGrid_dirs;
-            pars->M_norm[d][n-1][0] = 1.0f/(a_avg[n-1]+2.23e-6f); /* use this to preserve omni amplitude */
-            pars->M_norm[d][n-1][1] = sqrtf(1.0f/(e_avg[n-1]+2.23e-6f));  /* use this to preserve omni energy */
-            free(a_n);
-            free(Y);
-            
-            /* remove virtual loudspeakers from the decoder */
-            if (pData->loudpkrs_nDims == 2){
-                pars->M_dec[d][n-1] = realloc1d(pars->M_dec[d][n-1], pData->nLoudpkrs * nSH_order * sizeof(float));
-                pars->M_dec_cmplx[d][n-1] = realloc1d(pars->M_dec_cmplx[d][n-1], pData->nLoudpkrs * nSH_order * sizeof(float_complex));
-                pars->M_dec_maxrE[d][n-1] = realloc1d(pars->M_dec_maxrE[d][n-1], pData->nLoudpkrs * nSH_order * sizeof(float));
-                pars->M_dec_cmplx_maxrE[d][n-1] = realloc1d(pars->M_dec_cmplx_maxrE[d][n-1], pData->nLoudpkrs * nSH_order * sizeof(float_complex));
-            }
-        }
-        free(M_dec_tmp);
-    }
+    saf_asyncInit_cancel(pData->hDecInit);
+    saf_asyncInit_wait(pData->hDecInit); /* (the builds share the cached decoders) */
+    saf_initReport_beginStage("ambi_dec_buildDecoder");
+    dec = (ambi_dec_decoder*)ambi_dec_buildDecoder(hAmbi, NULL);
+    saf_initReport_endStage();
+    ambi_dec_destroyDecoder(hAmbi, (void*)pars->dec);
+    pars->dec = dec;
+    pData->loudpkrs_nDims = dec->loudpkrs_nDims;
     
     /* update order */
     pData->masterOrder = pData->new_masterOrder;
     
-    /* Binaural-related initialisations */
-    if(pData->reinit_hrtfsFLAG){
-        strcpy(pData->progressBarText,"Computing VBAP gain table");
+    /* Binaural-related initialisations; the HRIRs depend on the sofa file (or
+     * the default set) and the frequency vector, and the VBAP gain table only
+     * on the HRIRs */
+    if(pData->reinit_hrtfsFLAG)
+        saf_initDeps_invalidate(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS);
+    pData->reinit_hrtfsFLAG = 0;
+    saf_initDeps_begin(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS, &(pData->useDefaultHRIRsFLAG), sizeof(int));
+    saf_initDeps_addString(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS, !pData->useDefaultHRIRsFLAG ? pars->sofa_filepath : NULL);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS, pData->freqVector, HYBRID_BANDS*sizeof(float));
+    if(saf_initDeps_isStale(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS)){
+        strcpy(pData->progressBarText,"Loading HRIRs");
         pData->progressBar0_1 = 0.4f;
         
-        /* load sofa file or load default hrir data */
-        if(!pData->useDefaultHRIRsFLAG && pars->sofa_filepath!=NULL){
-            loadSofaFile(pars->sofa_filepath,
-                         &(pars->hrirs),
-                         &(pars->hrir_dirs_deg),
-                         &(pars->N_hrir_dirs),
-                         &(pars->hrir_len),
-                         &(pars->hrir_fs));
-        }
-        else{
-            loadSofaFile(NULL, /* setting path to NULL loads default HRIR data */
-                         &(pars->hrirs),
-                         &(pars->hrir_dirs_deg),
-                         &(pars->N_hrir_dirs),
-                         &(pars->hrir_len),
-                         &(pars->hrir_fs));
-        }
-        
-        /* estimate the ITDs for each HRIR */
-        pars->itds_s = realloc1d(pars->itds_s, pars->N_hrir_dirs*sizeof(float));
-        estimateITDs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrir_fs, pars->itds_s);
+        /* load sofa file or load default hrir data (setting path to NULL
+         * loads default HRIR data), along with the ITDs and the diffuse-field
+         * equalised filterbank HRTFs; which are shared with any other
+         * instances using the same HRIRs */
+        saf_initReport_beginStage("hrtfCache_acquire");
+        hrtfCache_acquire(&hHRTFs, !pData->useDefaultHRIRsFLAG ? pars->sofa_filepath : NULL,
+                          pData->freqVector, HYBRID_BANDS);
+        saf_initReport_endStage();
+        hrtfCache_release(&(pars->hHRTFs));
+        pars->hHRTFs = hHRTFs;
+        hrtfCache_getData(pars->hHRTFs, &(pars->hrirs), &(pars->hrir_dirs_deg), &(pars->N_hrir_dirs),
+                          &(pars->hrir_len), &(pars->hrir_fs), &(pars->itds_s), &(pars->hrtf_fb), &(pars->hrtf_fb_mag));
+        saf_initDeps_commit(pData->hInitDeps, AMBI_DEC_STAGE_HRIRS);
+        for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
+    }
+    saf_initDeps_begin(pData->hInitDeps, AMBI_DEC_STAGE_HRTF_VBAP);
+    saf_initDeps_addDependency(pData->hInitDeps, AMBI_DEC_STAGE_HRTF_VBAP, AMBI_DEC_STAGE_HRIRS);
+    if(saf_initDeps_isStale(pData->hInitDeps, AMBI_DEC_STAGE_HRTF_VBAP)){
+        strcpy(pData->progressBarText,"Computing VBAP gain table");
+        pData->progressBar0_1 = 0.6f;
         
-        /* generate VBAP gain table for the hrir_dirs */
-        hrtf_vbap_gtable = NULL;
+        /* generate the compressed VBAP gain table for the hrir_dirs (i.e. only
+         * the 3 non-zero gains per direction), as an interpolation table */
+        free1d((void**)&(pars->hrtf_vbap_gtableComp));
+        free1d((void**)&(pars->hrtf_vbap_gtableIdx));
         pars->hrtf_vbapTableRes[0] = 2; /* azimuth resolution in degrees */
         pars->hrtf_vbapTableRes[1] = 5; /* elevation resolution in degrees */
-        generateVBAPgainTable3D(pars->hrir_dirs_deg, pars->N_hrir_dirs, pars->hrtf_vbapTableRes[0], pars->hrtf_vbapTableRes[1], 1, 0, 0.0f,
-                                &hrtf_vbap_gtable, &(pars->N_hrtf_vbap_gtable), &(pars->hrtf_nTriangles));
-        if(hrtf_vbap_gtable==NULL){
+        saf_initReport_beginStage("generateCompressedVBAPgainTable3D");
+        saf_parfor_create(&hPar, SAF_PARFOR_NUM_THREADS_AUTO); /* (split over the grid directions) */
+        generateCompressedVBAPgainTable3DParallel(hPar, pars->hrir_dirs_deg, pars->N_hrir_dirs, pars->hrtf_vbapTableRes[0], pars->hrtf_vbapTableRes[1], 1, 0, 0.0f,
+                                                  &(pars->hrtf_vbap_gtableComp), &(pars->hrtf_vbap_gtableIdx), &nGains,
+                                                  &(pars->N_hrtf_vbap_gtable), &(pars->hrtf_nTriangles));
+        saf_parfor_destroy(&hPar);
+        saf_initReport_endStage();
+        if(pars->hrtf_vbap_gtableComp==NULL){
             /* if generating vbap gain tabled failed, re-calculate with default HRIR set (which is known to triangulate correctly) */
             pData->useDefaultHRIRsFLAG = 1;
             ambi_dec_initCodec(hAmbi);
         }
-        
-        /* compress VBAP table (i.e. remove the zero elements) */
-        pars->hrtf_vbap_gtableComp = realloc1d(pars->hrtf_vbap_gtableComp, pars->N_hrtf_vbap_gtable * 3 * sizeof(float));
-        pars->hrtf_vbap_gtableIdx  = realloc1d(pars->hrtf_vbap_gtableIdx,  pars->N_hrtf_vbap_gtable * 3 * sizeof(int));
-        compressVBAPgainTable3D(hrtf_vbap_gtable, pars->N_hrtf_vbap_gtable, pars->N_hrir_dirs, pars->hrtf_vbap_gtableComp, pars->hrtf_vbap_gtableIdx);
-        
-        /* convert hrirs to filterbank coefficients */
-        strcpy(pData->progressBarText,"Preparing HRIRs");
-        pData->progressBar0_1 = 0.85f;
-        pars->hrtf_fb = realloc1d(pars->hrtf_fb, HYBRID_BANDS * NUM_EARS * (pars->N_hrir_dirs)*sizeof(float_complex));
-        HRIRs2FilterbankHRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrtf_fb);
-        diffuseFieldEqualiseHRTFs(pars->N_hrir_dirs, pars->itds_s, pData->freqVector, HYBRID_BANDS, pars->hrtf_fb);
-        
-        /* calculate magnitude responses */
-        pars->hrtf_fb_mag = realloc1d(pars->hrtf_fb_mag, HYBRID_BANDS*NUM_EARS*(pars->N_hrir_dirs)*sizeof(float));
-        for(i=0; i<HYBRID_BANDS*NUM_EARS* (pars->N_hrir_dirs); i++)
-            pars->hrtf_fb_mag[i] = cabsf(pars->hrtf_fb[i]);
-        
-        /* clean-up */
-        free(hrtf_vbap_gtable);
-        pData->reinit_hrtfsFLAG = 0;
+        else{
+            VBAPgainTable2InterpTable(pars->hrtf_vbap_gtableComp, pars->N_hrtf_vbap_gtable, nGains);
+            saf_initDeps_commit(pData->hInitDeps, AMBI_DEC_STAGE_HRTF_VBAP);
+        }
     }
+    saf_initReport_finish(pData->hInitReport);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
     pData->progressBar0_1 = 1.0f;
     pData->codecStatus = CODEC_STATUS_INITIALISED;
+}
+
+void ambi_dec_prepareToPlay
+(
+    void* const hAmbi,
+    int nInputs,
+    int nOutputs,
+    int blockSize
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+
+    ambi_dec_initCodec(hAmbi);
+    saf_fifo_setHostBlockSize(pData->hFIFO, blockSize);
+    saf_warmUp_run(hAmbi, &ambi_dec_process, nInputs, nOutputs, blockSize, SAF_WARMUP_NUM_SAMPLES);
+}
+
+/**
+ * Requests that the decoding matrices are recomputed; which is carried out in
+ * the background (and crossfaded to) if the codec is already initialised and
+ * neither the number of loudspeakers, the master order, nor the binauralisation
+ * flag have changed; or otherwise by the next call to ambi_dec_initCodec()
+ */
+static void ambi_dec_requestDecoderUpdate(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     
-    free(g);
-    free(a);
-    free(e);
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED && pData->pars->dec!=NULL &&
+       pData->new_nLoudpkrs==pData->nLoudpkrs && pData->new_masterOrder==pData->masterOrder &&
+       pData->new_binauraliseLS==pData->binauraliseLS)
+        saf_asyncInit_request(pData->hDecInit);
+    else
+        ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
 }
 
-void ambi_dec_process
+/**
+ * Swaps in the decoder rebuilt in the background, if one is ready and it still
+ * matches the current configuration
+ *
+ * @returns The previous decoder (to crossfade from, and which should then be
+ *          passed to saf_asyncInit_retire()); or NULL, if no swap took place
+ */
+static ambi_dec_decoder* ambi_dec_swapDecoder
+(
+    ambi_dec_data* pData,
+    int nLoudspeakers,
+    int masterOrder
+)
+{
+    ambi_dec_codecPars* pars = pData->pars;
+    ambi_dec_decoder* newDec, *oldDec;
+    
+    newDec = (ambi_dec_decoder*)saf_asyncInit_fetch(pData->hDecInit);
+    if(newDec==NULL)
+        return NULL;
+    if(newDec->nLoudpkrs!=nLoudspeakers || newDec->masterOrder!=masterOrder){
+        saf_asyncInit_retire(pData->hDecInit, (void*)newDec);
+        return NULL;
+    }
+    oldDec = pars->dec;
+    pars->dec = newDec;
+    pData->loudpkrs_nDims = newDec->loudpkrs_nDims;
+    return oldDec;
+}
+
+/**
+ * Loads 'len' samples of the input signals (starting from 'offset') into
+ * SHFrameTD, converting them to ACN/N3D
+ */
+static void ambi_dec_loadInputs
+(
+    ambi_dec_data* pData,
+    float ** const inputs,
+    int nInputs,
+    int offset,
+    int len,
+    int masterOrder,
+    AMBI_DEC_CH_ORDER chOrdering,
+    AMBI_DEC_NORM_TYPES norm
+)
+{
+    int n, ch, i, nSH;
+    int o[MAX_SH_ORDER+2];
+    
+    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    nSH = (masterOrder+1)*(masterOrder+1);
+    
+    /* Load time-domain data */
+    switch(chOrdering){
+        case CH_ACN:
+            for(i=0; i < MIN(nSH, nInputs); i++)
+                utility_svvcopy(&(inputs[i][offset]), len, pData->SHFrameTD[i]);
+            for(; i<nSH; i++)
+                memset(pData->SHFrameTD[i], 0, len * sizeof(float)); /* fill remaining channels with zeros */
+            break;
+        case CH_FUMA:   /* only for first-order, convert to ACN */
+            if(nInputs>=4){
+                utility_svvcopy(&(inputs[0][offset]), len, pData->SHFrameTD[0]);
+                utility_svvcopy(&(inputs[1][offset]), len, pData->SHFrameTD[3]);
+                utility_svvcopy(&(inputs[2][offset]), len, pData->SHFrameTD[1]);
+                utility_svvcopy(&(inputs[3][offset]), len, pData->SHFrameTD[2]);
+                for(i=4; i<nSH; i++)
+                    memset(pData->SHFrameTD[i], 0, len * sizeof(float)); /* fill remaining channels with zeros */
+            }
+            else
+                for(i=0; i<nSH; i++)
+                    memset(pData->SHFrameTD[i], 0, len * sizeof(float));
+            break;
+    }
+    
+    /* account for input normalisation scheme */
+    switch(norm){
+        case NORM_N3D:  /* already in N3D, do nothing */
+            break;
+        case NORM_SN3D: /* convert to N3D */
+            for (n = 0; n<masterOrder+1; n++)
+                for (ch = o[n]; ch<o[n+1]; ch++)
+                    for(i = 0; i<len; i++)
+                        pData->SHFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
+            break;
+        case NORM_FUMA: /* only for first-order, convert to N3D */
+            for(i = 0; i<len; i++)
+                pData->SHFrameTD[0][i] *= sqrtf(2.0f);
+            for (ch = 1; ch<4; ch++)
+                for(i = 0; i<len; i++)
+                    pData->SHFrameTD[ch][i] *= sqrtf(3.0f);
+            break;
+    }
+}
+
+/**
+ * Decodes the current TF-domain frame of SH signals to the loudspeakers, using
+ * the decoding matrices in 'dec'
+ *
+ * Only the first nSH_active components are read (those above are taken to be
+ * zero, see shOrderDetector_apply()), which is simply the leading columns of
+ * each decoding matrix.
+ *
+ * The decoding matrices are real-valued, and so they are applied to the real
+ * and imaginary parts of the (interleaved) complex signals in one real-valued
+ * matrix multiplication per band: outputframeTF[band] (nLoudspeakers x
+ * 2*TIME_SLOTS) = alpha * M_dec (nLoudspeakers x nSH) * SHframeTF[band] (nSH x
+ * 2*TIME_SLOTS); where the diffuse-field normalisation is applied via alpha.
+ * Consecutive bands which use the same decoder and order form one group, which
+ * is passed to cblas_sgemm_batch() when using Intel MKL.
+ */
+static void ambi_dec_decodeFrame
+(
+    ambi_dec_data* pData,
+    ambi_dec_decoder* dec,
+    int nLoudspeakers,
+    int masterOrder,
+    int* orderPerBand,
+    float transitionFreq,
+    int* rE_WEIGHT,
+    AMBI_DEC_DIFFUSE_FIELD_EQ_APPROACH* diffEQmode,
+    int nSH_active,
+    float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]
+)
+{
+    int band, groupEnd, orderBand, nSH_band, decIdx;
+    float alpha;
+    float* M;
+#if defined(SAF_USE_INTEL_MKL)
+    int b, nGroups;
+    MKL_INT m_array[HYBRID_BANDS], n_array[HYBRID_BANDS], k_array[HYBRID_BANDS], ld_array[HYBRID_BANDS], group_size[HYBRID_BANDS];
+    CBLAS_TRANSPOSE trans_array[HYBRID_BANDS];
+    float alpha_array[HYBRID_BANDS], beta_array[HYBRID_BANDS];
+    const float* a_array[HYBRID_BANDS], *b_array[HYBRID_BANDS];
+    float* c_array[HYBRID_BANDS];
+    
+    nGroups = 0;
+#endif
+    memset(outputframeTF, 0, HYBRID_BANDS*MAX_NUM_LOUDSPEAKERS*TIME_SLOTS*sizeof(float_complex));
+    for(band=0; band<HYBRID_BANDS; band=groupEnd){
+        orderBand = MAX(MIN(orderPerBand[band], masterOrder),1);
+        nSH_band = (orderBand+1)*(orderBand+1);
+        decIdx = pData->freqVector[band] < transitionFreq ? 0 : 1; /* different decoder for low (0) and high (1) frequencies */
+        M = rE_WEIGHT[decIdx] ? dec->M_dec_maxrE[decIdx][orderBand-1] : dec->M_dec[decIdx][orderBand-1];
+        if(diffEQmode[decIdx]==AMPLITUDE_PRESERVING)
+            alpha = dec->M_norm[decIdx][orderBand-1][0];
+        else
+            alpha = dec->M_norm[decIdx][orderBand-1][1];
+        
+        /* find the consecutive bands which use the same decoder and order */
+        for(groupEnd=band+1; groupEnd<HYBRID_BANDS; groupEnd++)
+            if(MAX(MIN(orderPerBand[groupEnd], masterOrder),1) != orderBand ||
+               (pData->freqVector[groupEnd] < transitionFreq ? 0 : 1) != decIdx)
+                break;
+        
+#if defined(SAF_USE_INTEL_MKL)
+        trans_array[nGroups] = CblasNoTrans;
+        m_array[nGroups] = nLoudspeakers;
+        n_array[nGroups] = 2*TIME_SLOTS;
+        k_array[nGroups] = MIN(nSH_band, nSH_active);
+        ld_array[nGroups] = nSH_band;
+        alpha_array[nGroups] = alpha;
+        beta_array[nGroups] = 0.0f;
+        group_size[nGroups] = groupEnd-band;
+        for(b=band; b<groupEnd; b++){
+            a_array[b] = M;
+            b_array[b] = (const float*)pData->SHframeTF[b];
+            c_array[b] = (float*)outputframeTF[b];
+        }
+        nGroups++;
+#else
+        for(; band<groupEnd; band++){
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, 2*TIME_SLOTS, MIN(nSH_band, nSH_active), alpha,
+                        M, nSH_band,
+                        (float*)pData->SHframeTF[band], 2*TIME_SLOTS, 0.0f,
+                        (float*)outputframeTF[band], 2*TIME_SLOTS);
+        }
+#endif
+    }
+#if defined(SAF_USE_INTEL_MKL)
+    /* (n_array is also the leading dimension of B and C) */
+    cblas_sgemm_batch(CblasRowMajor, trans_array, trans_array, m_array, n_array, k_array, alpha_array,
+                      a_array, ld_array, b_array, n_array, beta_array, c_array, n_array, nGroups, group_size);
+#endif
+}
+
+/**
+ * Decodes (and optionally binauralises) the current TF-domain frame of SH
+ * signals; i.e. the main processing of ambi_dec_processFrame(), which is
+ * shared with ambi_dec_processTF()
+ */
+static void ambi_dec_processFrameTF
+(
+    void  *  const hAmbi,
+    int            nLoudspeakers,
+    int            masterOrder,
+    int            binauraliseLS,
+    int            nSH_active
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    ambi_dec_codecPars* pars = pData->pars;
+    int t, ch, ear, i, band, crossfade;
+    float fadeIn;
+    ambi_dec_decoder* oldDec;
+    
+    /* local copies of user parameters */
+    int orderPerBand[HYBRID_BANDS], rE_WEIGHT[NUM_DECODERS];
+    float transitionFreq;
+    AMBI_DEC_DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];
+    memcpy(orderPerBand, pData->orderPerBand, HYBRID_BANDS*sizeof(int));
+    transitionFreq = pData->transitionFreq;
+    memcpy(diffEQmode, pData->diffEQmode, NUM_DECODERS*sizeof(int));
+    memcpy(rE_WEIGHT, pData->rE_WEIGHT, NUM_DECODERS*sizeof(int));
+    
+    /* swap in the decoder rebuilt in the background (if it is ready, and
+     * still matches the current configuration), and keep the output of the
+     * old decoder for this frame, to crossfade from. The old decoder is
+     * then destroyed in the background. */
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+    crossfade = 0;
+    oldDec = ambi_dec_swapDecoder(pData, nLoudspeakers, masterOrder);
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+    if(oldDec!=NULL){
+        ambi_dec_decodeFrame(pData, oldDec, nLoudspeakers, masterOrder, orderPerBand, transitionFreq,
+                             rE_WEIGHT, diffEQmode, nSH_active, pData->outputframeTF_prev);
+        saf_asyncInit_retire(pData->hDecInit, (void*)oldDec);
+        crossfade = 1;
+    }
+    
+    /* Decode to loudspeaker set-up */
+    ambi_dec_decodeFrame(pData, pars->dec, nLoudspeakers, masterOrder, orderPerBand, transitionFreq,
+                         rE_WEIGHT, diffEQmode, nSH_active, pData->outputframeTF);
+    
+    /* linear crossfade (over the time slots) from the old decoder */
+    if(crossfade){
+        for(band=0; band<HYBRID_BANDS; band++){
+            for(i=0; i<nLoudspeakers; i++){
+                for(t=0; t<TIME_SLOTS; t++){
+                    fadeIn = (float)(t+1)/(float)TIME_SLOTS;
+                    pData->outputframeTF[band][i][t] = ccaddf(crmulf(pData->outputframeTF[band][i][t], fadeIn),
+                                                              crmulf(pData->outputframeTF_prev[band][i][t], 1.0f-fadeIn));
+                }
+            }
+        }
+    }
+        
+    /* binauralise the loudspeaker signals */
+    if(binauraliseLS){
+        memset(pData->binframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
+        /* interpolate hrtfs and apply to each source */
+        for (ch = 0; ch < nLoudspeakers; ch++) {
+            if(pData->recalc_hrtf_interpFLAG[ch]){
+                ambi_dec_interpHRTFs(hAmbi, pData->loudpkrs_dirs_deg[ch][0], pData->loudpkrs_dirs_deg[ch][1], pars->hrtf_interp[ch]);
+                pData->recalc_hrtf_interpFLAG[ch] = 0;
+            }
+            for (band = 0; band < HYBRID_BANDS; band++)
+                for (ear = 0; ear < NUM_EARS; ear++)
+                    for (t = 0; t < TIME_SLOTS; t++)
+                        pData->binframeTF[band][ear][t] = ccaddf(pData->binframeTF[band][ear][t], ccmulf(pData->outputframeTF[band][ch][t], pars->hrtf_interp[ch][band][ear]));
+        }
+            
+        /* scale by sqrt(number of loudspeakers) */
+        for (band = 0; band < HYBRID_BANDS; band++)
+            for (ear = 0; ear < NUM_EARS; ear++)
+                for (t = 0; t < TIME_SLOTS; t++)
+                    pData->binframeTF[band][ear][t] = crmulf(pData->binframeTF[band][ear][t], 1.0f/sqrtf((float)nLoudspeakers));
+    }
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+}
+
+/**
+ * Applies the inverse afSTFT to the current TF-domain frame of loudspeaker (or
+ * binaural) signals, and zeros any remaining output channels
+ */
+static void ambi_dec_inverseFrameTF
+(
+    ambi_dec_data* pData,
+    float ** const outputs,
+    int            nOutputs,
+    int            nLoudspeakers,
+    int            binauraliseLS
+)
+{
+    int t, ch;
+    
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
+    for(t = 0; t < TIME_SLOTS; t++) {
+        if(binauraliseLS)
+            afSTFTinversePlanar(pData->hSTFT, &(pData->binframeTF[0][0][t]), NUM_EARS*TIME_SLOTS, TIME_SLOTS, pData->tempHopFrameTD);
+        else
+            afSTFTinversePlanar(pData->hSTFT, &(pData->outputframeTF[0][0][t]), MAX_NUM_LOUDSPEAKERS*TIME_SLOTS, TIME_SLOTS, pData->tempHopFrameTD);
+        for(ch = 0; ch < MIN(binauraliseLS==1 ? NUM_EARS : nLoudspeakers, nOutputs); ch++)
+            utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+        for (; ch < nOutputs; ch++)
+            memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
+    }
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void ambi_dec_processFrame
 (
     void  *  const hAmbi,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    ambi_dec_codecPars* pars = pData->pars;
-    int n, t, ch, ear, i, band, orderBand, nSH_band, decIdx, nSH;
-    int o[MAX_SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    int t, ch, nSH, nSH_active;
+    float* pSHFrameTD[MAX_NUM_SH_SIGNALS];
 
     /* local copies of user parameters */
     int nLoudspeakers, binauraliseLS, masterOrder;
-    int orderPerBand[HYBRID_BANDS], rE_WEIGHT[NUM_DECODERS];
-    float transitionFreq;
-    AMBI_DEC_DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];
     AMBI_DEC_NORM_TYPES norm;
     AMBI_DEC_CH_ORDER chOrdering;
     
     /* decode audio to loudspeakers or headphones */
-    if( (nSamples == FRAME_SIZE) && (pData->codecStatus==CODEC_STATUS_INITIALISED) ) {
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED) {
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        
+        /* the afSTFT buffers hold old signals, if the time-domain path was in use */
+        if(pData->clearTFbuffersFLAG){
+            afSTFTclearBuffers(pData->hSTFT);
+            pData->clearTFbuffersFLAG = 0;
+        }
         
         /* copy user parameters to local variables */
-        for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
         masterOrder = pData->masterOrder;
         nSH = (masterOrder+1)*(masterOrder+1);
         nLoudspeakers = pData->nLoudpkrs;
-        memcpy(orderPerBand, pData->orderPerBand, HYBRID_BANDS*sizeof(int));
-        transitionFreq = pData->transitionFreq;
-        memcpy(diffEQmode, pData->diffEQmode, NUM_DECODERS*sizeof(int));
         binauraliseLS = pData->binauraliseLS;
         norm = pData->norm;
         chOrdering = pData->chOrdering;
-        memcpy(rE_WEIGHT, pData->rE_WEIGHT, NUM_DECODERS*sizeof(int));
         
         /* Load time-domain data */
-        switch(chOrdering){
-            case CH_ACN:
-                for(i=0; i < MIN(nSH, nInputs); i++)
-                    utility_svvcopy(inputs[i], FRAME_SIZE, pData->SHFrameTD[i]);
-                for(; i<nSH; i++)
-                    memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                break;
-            case CH_FUMA:   /* only for first-order, convert to ACN */
-                if(nInputs>=4){
-                    utility_svvcopy(inputs[0], FRAME_SIZE, pData->SHFrameTD[0]);
-                    utility_svvcopy(inputs[1], FRAME_SIZE, pData->SHFrameTD[3]);
-                    utility_svvcopy(inputs[2], FRAME_SIZE, pData->SHFrameTD[1]);
-                    utility_svvcopy(inputs[3], FRAME_SIZE, pData->SHFrameTD[2]);
-                    for(i=4; i<nSH; i++)
-                        memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                }
-                else
-                    for(i=0; i<nSH; i++)
-                        memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float));
-                break;
-        }
-        
-        /* account for input normalisation scheme */
-        switch(norm){
-            case NORM_N3D:  /* already in N3D, do nothing */
-                break;
-            case NORM_SN3D: /* convert to N3D */
-                for (n = 0; n<masterOrder+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->SHFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
-                break;
-            case NORM_FUMA: /* only for first-order, convert to N3D */
-                for(i = 0; i<FRAME_SIZE; i++)
-                    pData->SHFrameTD[0][i] *= sqrtf(2.0f);
-                for (ch = 1; ch<4; ch++)
-                    for(i = 0; i<FRAME_SIZE; i++)
-                        pData->SHFrameTD[ch][i] *= sqrtf(3.0f);
-                break;
-        }
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
+        ambi_dec_loadInputs(pData, inputs, nInputs, 0, FRAME_SIZE, masterOrder, chOrdering, norm);
+        for(ch=0; ch<nSH; ch++)
+            pSHFrameTD[ch] = pData->SHFrameTD[ch];
+        nSH_active = ORDER2NSH(MAX(shOrderDetector_apply(pData->hOrderDet, pSHFrameTD, masterOrder, FRAME_SIZE), 1));
+        pData->nSH_active = nSH_active;
         
         /* Apply time-frequency transform (TFT) */
         for(t=0; t< TIME_SLOTS; t++) {
             for(ch = 0; ch < nSH; ch++)
                 utility_svvcopy(&(pData->SHFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < nSH; ch++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+            afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD, &(pData->SHframeTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS);
         }
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
         
         /* Main processing: */
-        /* Decode to loudspeaker set-up */
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_LOUDSPEAKERS*TIME_SLOTS*sizeof(float_complex));
-        for(band=0; band<HYBRID_BANDS; band++){
-            orderBand = MAX(MIN(orderPerBand[band], masterOrder),1);
-            nSH_band = (orderBand+1)*(orderBand+1);
-            decIdx = pData->freqVector[band] < transitionFreq ? 0 : 1; /* different decoder for low (0) and high (1) frequencies */
-            if(rE_WEIGHT[decIdx]){
-                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSH_band, &calpha,
-                            pars->M_dec_cmplx_maxrE[decIdx][orderBand-1], nSH_band,
-                            pData->SHframeTF[band], TIME_SLOTS, &cbeta,
-                            pData->outputframeTF[band], TIME_SLOTS);
-            }
-            else{
-                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSH_band, &calpha,
-                            pars->M_dec_cmplx[decIdx][orderBand-1], nSH_band,
-                            pData->SHframeTF[band], TIME_SLOTS, &cbeta,
-                            pData->outputframeTF[band], TIME_SLOTS);
-            }
-            for(i=0; i<nLoudspeakers; i++){
-                for(t=0; t<TIME_SLOTS; t++){
-                    if(diffEQmode[decIdx]==AMPLITUDE_PRESERVING)
-                        pData->outputframeTF[band][i][t] = crmulf(pData->outputframeTF[band][i][t], pars->M_norm[decIdx][orderBand-1][0]);
-                    else
-                        pData->outputframeTF[band][i][t] = crmulf(pData->outputframeTF[band][i][t], pars->M_norm[decIdx][orderBand-1][1]);
-                }
-            }
+        ambi_dec_processFrameTF(hAmbi, nLoudspeakers, masterOrder, binauraliseLS, nSH_active);
+        
+        /* inverse-TFT */
+        ambi_dec_inverseFrameTF(pData, outputs, nOutputs, nLoudspeakers, binauraliseLS);
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        saf_telemetry_frameEnd(pData->hTelemetry);
+    }
+    else{
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+}
+
+/**
+ * Returns 1 if the current settings may be realised without the afSTFT (i.e.
+ * the loudspeaker signals are not binauralised, and the master order is used
+ * for all bands), and the time-domain path is enabled; 0 otherwise
+ */
+static int ambi_dec_useTDpath(ambi_dec_data* pData)
+{
+    int band;
+    
+    if(!pData->enableTDpath || pData->binauraliseLS)
+        return 0;
+    for(band=0; band<HYBRID_BANDS; band++)
+        if(pData->orderPerBand[band] < pData->masterOrder)
+            return 0;
+    return 1;
+}
+
+/**
+ * Decodes the first 'len' samples of SHFrameTD (low-passed if 'split') and
+ * SHFrameTD_hi (high-passed) to the loudspeakers, using the master order
+ * decoding matrices in 'dec'; i.e. one real-valued matrix multiplication per
+ * decoder: outputFrameTD (nLoudspeakers x len) = alpha * M_dec (nLoudspeakers x
+ * nSH) * SHFrameTD (nSH x len). If not 'split', only the low-frequency decoder
+ * is applied (to the full-band signals). As for ambi_dec_decodeFrame(), only
+ * the first nSH_active components are read
+ */
+static void ambi_dec_decodeFrameTD
+(
+    ambi_dec_data* pData,
+    ambi_dec_decoder* dec,
+    int nLoudspeakers,
+    int masterOrder,
+    int split,
+    int* rE_WEIGHT,
+    AMBI_DEC_DIFFUSE_FIELD_EQ_APPROACH* diffEQmode,
+    int nSH_active,
+    int len,
+    float outputFrameTD[MAX_NUM_LOUDSPEAKERS][FRAME_SIZE]
+)
+{
+    int d, nSH;
+    float alpha;
+    float* M;
+    
+    nSH = (masterOrder+1)*(masterOrder+1);
+    for(d=0; d<(split ? NUM_DECODERS : 1); d++){
+        M = rE_WEIGHT[d] ? dec->M_dec_maxrE[d][masterOrder-1] : dec->M_dec[d][masterOrder-1];
+        if(diffEQmode[d]==AMPLITUDE_PRESERVING)
+            alpha = dec->M_norm[d][masterOrder-1][0];
+        else
+            alpha = dec->M_norm[d][masterOrder-1][1];
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, len, MIN(nSH, nSH_active), alpha,
+                    M, nSH,
+                    d==0 ? (float*)pData->SHFrameTD : (float*)pData->SHFrameTD_hi, FRAME_SIZE, d==0 ? 0.0f : 1.0f,
+                    (float*)outputFrameTD, FRAME_SIZE);
+    }
+}
+
+/**
+ * Decodes a block of any length directly in the time-domain (i.e. without the
+ * FIFO or afSTFT, and therefore without any added latency)
+ *
+ * The low and high frequency decoders are applied to the outputs of a
+ * 4th-order Linkwitz-Riley crossover at the transition frequency (two cascaded
+ * 2nd-order Butterworth sections), which sum to an all-pass response. The
+ * crossover is skipped if both decoders are the same.
+ */
+static void ambi_dec_processTD
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    ambi_dec_codecPars* pars = pData->pars;
+    int s, len, ch, i, nSH, nSH_active, split;
+    float fadeIn;
+    float* SHFrame_lo[MAX_NUM_SH_SIGNALS];
+    float* SHFrame_hi[MAX_NUM_SH_SIGNALS];
+    float** SHFrame_bands[2] = { SHFrame_lo, SHFrame_hi };
+    ambi_dec_decoder* oldDec;
+    
+    /* local copies of user parameters */
+    int nLoudspeakers, masterOrder;
+    int rE_WEIGHT[NUM_DECODERS];
+    float transitionFreq;
+    AMBI_DEC_DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];
+    AMBI_DEC_NORM_TYPES norm;
+    AMBI_DEC_CH_ORDER chOrdering;
+    
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED) {
+        pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        
+        /* copy user parameters to local variables */
+        masterOrder = pData->masterOrder;
+        nSH = (masterOrder+1)*(masterOrder+1);
+        nLoudspeakers = pData->nLoudpkrs;
+        transitionFreq = pData->transitionFreq;
+        memcpy(diffEQmode, pData->diffEQmode, NUM_DECODERS*sizeof(int));
+        norm = pData->norm;
+        chOrdering = pData->chOrdering;
+        memcpy(rE_WEIGHT, pData->rE_WEIGHT, NUM_DECODERS*sizeof(int));
+        
+        /* (re)design the crossover, and start from cleared filter states when
+         * switching over from the afSTFT path */
+        if(pData->xover_fc!=transitionFreq || pData->xover_fs!=pData->fs){
+            IIRFilterbank_setCutoffFreqs(pData->hXover, &transitionFreq, (float)pData->fs);
+            pData->xover_fc = transitionFreq;
+            pData->xover_fs = pData->fs;
         }
-            
-        /* binauralise the loudspeaker signals */
-        if(binauraliseLS){
-            memset(pData->binframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
-            /* interpolate hrtfs and apply to each source */
-            for (ch = 0; ch < nLoudspeakers; ch++) {
-                if(pData->recalc_hrtf_interpFLAG[ch]){
-                    ambi_dec_interpHRTFs(hAmbi, pData->loudpkrs_dirs_deg[ch][0], pData->loudpkrs_dirs_deg[ch][1], pars->hrtf_interp[ch]);
-                    pData->recalc_hrtf_interpFLAG[ch] = 0;
-                }
-                for (band = 0; band < HYBRID_BANDS; band++)
-                    for (ear = 0; ear < NUM_EARS; ear++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->binframeTF[band][ear][t] = ccaddf(pData->binframeTF[band][ear][t], ccmulf(pData->outputframeTF[band][ch][t], pars->hrtf_interp[ch][band][ear]));
-            }
-                
-            /* scale by sqrt(number of loudspeakers) */
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ear = 0; ear < NUM_EARS; ear++)
-                    for (t = 0; t < TIME_SLOTS; t++)
-                        pData->binframeTF[band][ear][t] = crmulf(pData->binframeTF[band][ear][t], 1.0f/sqrtf((float)nLoudspeakers));
+        if(!pData->tdPathActive){
+            IIRFilterbank_reset(pData->hXover);
+            pData->tdPathActive = 1;
         }
         
-        
-        /* inverse-TFT */
-        for(t = 0; t < TIME_SLOTS; t++) {
-            for(band = 0; band < HYBRID_BANDS; band++) {
-                if(binauraliseLS){
-                    for (ch = 0; ch < NUM_EARS; ch++) {
-                        pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->binframeTF[band][ch][t]);
-                        pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->binframeTF[band][ch][t]);
-                    }
+        for(s=0; s<nSamples; s+=len){
+            len = MIN(nSamples-s, FRAME_SIZE);
+            
+            /* Load time-domain data */
+            ambi_dec_loadInputs(pData, inputs, nInputs, s, len, masterOrder, chOrdering, norm);
+            for(ch=0; ch<nSH; ch++)
+                SHFrame_lo[ch] = pData->SHFrameTD[ch];
+            nSH_active = ORDER2NSH(MAX(shOrderDetector_apply(pData->hOrderDet, SHFrame_lo, masterOrder, len), 1));
+            
+            /* swap in the decoder rebuilt in the background (see ambi_dec_processFrame()) */
+            oldDec = ambi_dec_swapDecoder(pData, nLoudspeakers, masterOrder);
+            
+            /* split into low and high frequencies, unless both decoders are the same */
+            split = !(pars->dec->sameMethod && rE_WEIGHT[0]==rE_WEIGHT[1] && diffEQmode[0]==diffEQmode[1]) ||
+                    (oldDec!=NULL && !oldDec->sameMethod);
+            if(split){
+                for(ch=0; ch<nSH_active; ch++){
+                    SHFrame_lo[ch] = pData->SHFrameTD[ch];
+                    SHFrame_hi[ch] = pData->SHFrameTD_hi[ch];
                 }
-                else {
-                    for(ch = 0; ch < nLoudspeakers; ch++) {
-                        pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                        pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
+                IIRFilterbank_apply(pData->hXover, SHFrame_lo, SHFrame_bands, nSH_active, len);
+            }
+            
+            /* Decode to loudspeaker set-up, and crossfade from the old decoder */
+            ambi_dec_decodeFrameTD(pData, pars->dec, nLoudspeakers, masterOrder, split, rE_WEIGHT, diffEQmode, nSH_active, len, pData->outputFrameTD);
+            if(oldDec!=NULL){
+                ambi_dec_decodeFrameTD(pData, oldDec, nLoudspeakers, masterOrder, split, rE_WEIGHT, diffEQmode, nSH_active, len, pData->outputFrameTD_prev);
+                saf_asyncInit_retire(pData->hDecInit, (void*)oldDec);
+                for(ch=0; ch<nLoudspeakers; ch++){
+                    for(i=0; i<len; i++){
+                        fadeIn = (float)(i+1)/(float)len;
+                        pData->outputFrameTD[ch][i] = fadeIn*pData->outputFrameTD[ch][i] + (1.0f-fadeIn)*pData->outputFrameTD_prev[ch][i];
                     }
                 }
             }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for(ch = 0; ch < MIN(binauraliseLS==1 ? NUM_EARS : nLoudspeakers, nOutputs); ch++)
-                utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+            
+            /* copy to output */
+            for(ch = 0; ch < MIN(nLoudspeakers, nOutputs); ch++)
+                utility_svvcopy(pData->outputFrameTD[ch], len, &(outputs[ch][s]));
             for (; ch < nOutputs; ch++)
-                memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
+                memset(&(outputs[ch][s]), 0, len*sizeof(float));
         }
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
-    else
+    else{
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch], 0, nSamples*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+}
+
+void ambi_dec_process
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* frequency-independent decoding is carried out directly in the
+     * time-domain, otherwise the signals are buffered into frames for the
+     * afSTFT */
+    if(ambi_dec_useTDpath(pData))
+        ambi_dec_processTD(hAmbi, inputs, outputs, nInputs, nOutputs, nSamples);
+    else{
+        if(pData->tdPathActive){
+            saf_fifo_flush(pData->hFIFO);
+            pData->clearTFbuffersFLAG = 1;
+            pData->tdPathActive = 0;
+        }
+        saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_dec_processFrame, hAmbi);
+    }
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+int ambi_dec_processTF
+(
+    void  *  const hAmbi,
+    const float *  inTF,
+    float *        outTF,
+    int            nInputs,
+    int            maxNumOutputs,
+    int            nBands,
+    int            nTimeSlots
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    int n, ch, band, nSH, nSH_in, nOut, nLoudspeakers, binauraliseLS, masterOrder;
+    int o[MAX_SH_ORDER+2];
+    const int fuma2acn[4] = {0, 3, 1, 2};
+    float scale;
+    const float_complex* pInTF;
+    float_complex* pOutTF;
+    AMBI_DEC_NORM_TYPES norm;
+    
+    if(pData->codecStatus != CODEC_STATUS_INITIALISED){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return 0;
+    }
+    if(nBands != HYBRID_BANDS || nTimeSlots != TIME_SLOTS)
+        return 0;
+    pData->procStatus = PROC_STATUS_ONGOING;
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    masterOrder = pData->masterOrder;
+    nSH = (masterOrder+1)*(masterOrder+1);
+    nLoudspeakers = pData->nLoudpkrs;
+    binauraliseLS = pData->binauraliseLS;
+    norm = pData->norm;
+    pInTF = (const float_complex*)inTF;
+    pOutTF = (float_complex*)outTF;
+    
+    /* Load the TF frame (converting to ACN/N3D, as in ambi_dec_loadInputs()) */
+    for(band=0; band<HYBRID_BANDS; band++){
+        if(pData->chOrdering==CH_FUMA){ /* only for first-order */
+            nSH_in = nInputs>=4 ? 4 : 0;
+            for(ch=0; ch<nSH_in; ch++)
+                utility_cvvcopy(&pInTF[(band*nInputs + fuma2acn[ch])*TIME_SLOTS], TIME_SLOTS, pData->SHframeTF[band][ch]);
+        }
+        else{
+            nSH_in = MIN(nSH, nInputs);
+            utility_cvvcopy(&pInTF[band*nInputs*TIME_SLOTS], nSH_in*TIME_SLOTS, pData->SHframeTF[band][0]);
+        }
+        if(nSH_in<nSH)
+            memset(pData->SHframeTF[band][nSH_in], 0, (nSH-nSH_in)*TIME_SLOTS*sizeof(float_complex));
+        for (n = 0; n<masterOrder+1 && norm!=NORM_N3D; n++){
+            scale = norm==NORM_SN3D ? sqrtf(2.0f*(float)n+1.0f) : (n==0 ? sqrtf(2.0f) : sqrtf(3.0f));
+            for (ch = o[n]; ch<o[n+1]; ch++)
+                utility_svsmul((float*)pData->SHframeTF[band][ch], &scale, 2*TIME_SLOTS, NULL);
+        }
+    }
+    
+    /* Main processing (the order detector operates on time-domain signals, and
+     * so all nSH components are decoded): */
+    ambi_dec_processFrameTF(hAmbi, nLoudspeakers, masterOrder, binauraliseLS, nSH);
+    nOut = MIN(binauraliseLS ? NUM_EARS : nLoudspeakers, maxNumOutputs);
+    for(band=0; band<HYBRID_BANDS; band++)
+        utility_cvvcopy(binauraliseLS ? pData->binframeTF[band][0] : pData->outputframeTF[band][0],
+                        nOut*TIME_SLOTS, &pOutTF[band*nOut*TIME_SLOTS]);
+    SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+    return nOut;
+}
+
+void ambi_dec_processInterleaved
+(
+    void  *  const hAmbi,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    int s, t, ch, len, nIn, nOut;
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* the time-domain path works on the host blocks directly, so these are
+     * passed through planar buffers, in chunks of up to FRAME_SIZE */
+    if(ambi_dec_useTDpath(pData)){
+        nIn = MIN(nInputs, MAX_NUM_SH_SIGNALS);
+        nOut = MIN(nOutputs, MAX_NUM_LOUDSPEAKERS);
+        for(s=0; s<nSamples; s+=len){
+            len = MIN(nSamples-s, FRAME_SIZE);
+            for(t=0; t<len; t++)
+                for(ch=0; ch<nIn; ch++)
+                    pData->planarInTD[ch][t] = inputs[(s+t)*nInputs+ch];
+            ambi_dec_processTD(hAmbi, pData->planarInTD, pData->planarOutTD, nIn, nOut, len);
+            for(t=0; t<len; t++){
+                for(ch=0; ch<nOut; ch++)
+                    outputs[(s+t)*nOutputs+ch] = pData->planarOutTD[ch][t];
+                for(; ch<nOutputs; ch++)
+                    outputs[(s+t)*nOutputs+ch] = 0.0f;
+            }
+        }
+    }
+    else{
+        if(pData->tdPathActive){
+            saf_fifo_flush(pData->hFIFO);
+            pData->clearTFbuffersFLAG = 1;
+            pData->tdPathActive = 0;
+        }
+        saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_dec_processFrame, hAmbi);
+    }
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/** Returns the current number of output channels of an ambi_dec instance */
+static int ambi_dec_numOutputChannels(ambi_dec_data* pData)
+{
+    return pData->binauraliseLS ? NUM_EARS : pData->nLoudpkrs;
+}
+
+/**
+ * Decodes the current TF-domain frame of SH signals of the primary instance
+ * 'pMain' with the decoders of the layout instance 'hLayout', and applies the
+ * inverse afSTFT of the layout
+ */
+static void ambi_dec_processLayoutFrame
+(
+    ambi_dec_data* pMain,
+    void  *  const hLayout,
+    float ** const outputs,
+    int            nOutputs
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hLayout);
+    int ch, band, nSH, nSH_copy, nSH_active;
+    
+    /* local copies of user parameters */
+    int nLoudspeakers, binauraliseLS, masterOrder;
+    
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED && pMain->codecStatus==CODEC_STATUS_INITIALISED) {
+        pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        if(pData->clearTFbuffersFLAG){
+            afSTFTclearBuffers(pData->hSTFT);
+            pData->clearTFbuffersFLAG = 0;
+        }
+        
+        /* copy user parameters to local variables */
+        masterOrder = pData->masterOrder;
+        nSH = (masterOrder+1)*(masterOrder+1);
+        nLoudspeakers = pData->nLoudpkrs;
+        binauraliseLS = pData->binauraliseLS;
+        
+        /* share the TF frame of the primary instance (the components beyond its
+         * master order are zero) */
+        nSH_copy = MIN(nSH, ORDER2NSH(pMain->masterOrder));
+        for(band=0; band<HYBRID_BANDS; band++){
+            utility_cvvcopy(pMain->SHframeTF[band][0], nSH_copy*TIME_SLOTS, pData->SHframeTF[band][0]);
+            if(nSH_copy<nSH)
+                memset(pData->SHframeTF[band][nSH_copy], 0, (nSH-nSH_copy)*TIME_SLOTS*sizeof(float_complex));
+        }
+        nSH_active = MIN(pMain->nSH_active, nSH);
+        
+        /* Main processing, and inverse-TFT */
+        ambi_dec_processFrameTF(hLayout, nLoudspeakers, masterOrder, binauraliseLS, nSH_active);
+        ambi_dec_inverseFrameTF(pData, outputs, nOutputs, nLoudspeakers, binauraliseLS);
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        saf_telemetry_frameEnd(pData->hTelemetry);
+    }
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+/**
+ * Processes one frame of FRAME_SIZE samples for this instance and all of the
+ * additional layouts; called by the layout FIFO once a full frame of input
+ * samples has been collected
+ */
+static void ambi_dec_processLayoutsFrame
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    int l, ch, nCH, offset;
+    
+    /* primary layout (which also applies the forward afSTFT) */
+    nCH = MIN(ambi_dec_numOutputChannels(pData), nOutputs);
+    ambi_dec_processFrame(hAmbi, inputs, outputs, nInputs, nCH);
+    offset = nCH;
+    
+    /* additional layouts, from the same TF frame */
+    for(l=0; l<pData->nLayouts; l++){
+        nCH = MIN(ambi_dec_numOutputChannels((ambi_dec_data*)pData->hLayouts[l]), nOutputs-offset);
+        ambi_dec_processLayoutFrame(pData, pData->hLayouts[l], &outputs[offset], nCH);
+        offset += nCH;
+    }
+    for(ch=offset; ch<nOutputs; ch++)
+        memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+}
+
+int ambi_dec_addLayout
+(
+    void  *  const hAmbi,
+    void  *  const hLayout
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    
+    if(pData->nLayouts>=AMBI_DEC_MAX_NUM_LAYOUTS || hLayout==hAmbi)
+        return -1;
+    pData->hLayouts[pData->nLayouts++] = hLayout;
+    
+    /* enough output channels for all of the layouts */
+    saf_fifo_destroy(&(pData->hLayoutFIFO));
+    saf_fifo_create(&(pData->hLayoutFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, (pData->nLayouts+1)*MAX_NUM_LOUDSPEAKERS);
+    return pData->nLayouts;
+}
+
+void ambi_dec_clearLayouts
+(
+    void  *  const hAmbi
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    
+    pData->nLayouts = 0;
+    saf_fifo_destroy(&(pData->hLayoutFIFO));
+}
+
+int ambi_dec_getNumLayoutOutputs
+(
+    void  *  const hAmbi
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    ambi_dec_data *pLayout;
+    int l, nCH;
+    
+    nCH = pData->new_binauraliseLS ? NUM_EARS : pData->new_nLoudpkrs;
+    for(l=0; l<pData->nLayouts; l++){
+        pLayout = (ambi_dec_data*)pData->hLayouts[l];
+        nCH += pLayout->new_binauraliseLS ? NUM_EARS : pLayout->new_nLoudpkrs;
+    }
+    return nCH;
+}
+
+void ambi_dec_processLayouts
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    ambi_dec_data *pLayout;
+    int l;
+    unsigned int fpState;
+    int blasState;
+    
+    if(pData->hLayoutFIFO==NULL){
+        ambi_dec_process(hAmbi, inputs, outputs, nInputs, nOutputs, nSamples);
+        return;
+    }
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* the afSTFT buffers hold old signals, if the time-domain path was in use */
+    if(pData->tdPathActive){
+        pData->clearTFbuffersFLAG = 1;
+        pData->tdPathActive = 0;
+    }
+    for(l=0; l<pData->nLayouts; l++){
+        pLayout = (ambi_dec_data*)pData->hLayouts[l];
+        if(pLayout->tdPathActive){
+            pLayout->clearTFbuffersFLAG = 1;
+            pLayout->tdPathActive = 0;
+        }
+    }
+    saf_fifo_process(pData->hLayoutFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_dec_processLayoutsFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
 
 /* Set Functions */
 
@@ -641,7 +1286,7 @@ void ambi_dec_setLoudspeakerAzi_deg(void* const hAmbi, int index, float newAzi_d
     if(pData->loudpkrs_dirs_deg[index][0] != newAzi_deg){
         pData->loudpkrs_dirs_deg[index][0] = newAzi_deg;
         pData->recalc_hrtf_interpFLAG[index] = 1;
-        ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+        ambi_dec_requestDecoderUpdate(hAmbi);
     }
 }
 
@@ -653,7 +1298,7 @@ void ambi_dec_setLoudspeakerElev_deg(void* const hAmbi, int index, float newElev
     if(pData->loudpkrs_dirs_deg[index][1] != newElev_deg){
         pData->loudpkrs_dirs_deg[index][1] = newElev_deg;
         pData->recalc_hrtf_interpFLAG[index] = 1;
-        ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+        ambi_dec_requestDecoderUpdate(hAmbi);
     }
 }
 
@@ -685,7 +1330,6 @@ void ambi_dec_setUseDefaultHRIRsflag(void* const hAmbi, int newState)
     
     if((!pData->useDefaultHRIRsFLAG) && (newState)){
         pData->useDefaultHRIRsFLAG = newState;
-        pData->reinit_hrtfsFLAG = 1;
         ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
     }
 }
@@ -698,7 +1342,6 @@ void ambi_dec_setSofaFilePath(void* const hAmbi, const char* path)
     pars->sofa_filepath = malloc1d(strlen(path) + 1);
     strcpy(pars->sofa_filepath, path);
     pData->useDefaultHRIRsFLAG = 0;
-    pData->reinit_hrtfsFLAG = 1;
     ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
 }
 
@@ -710,7 +1353,7 @@ void ambi_dec_setOutputConfigPreset(void* const hAmbi, int newPresetID)
     loadLoudspeakerArrayPreset(newPresetID, pData->loudpkrs_dirs_deg, &(pData->new_nLoudpkrs), &(pData->loudpkrs_nDims));
     for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
         pData->recalc_hrtf_interpFLAG[ch] = 1;
-    ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+    ambi_dec_requestDecoderUpdate(hAmbi);
 }
 
 void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
@@ -797,7 +1440,7 @@ void ambi_dec_setDecMethod(void* const hAmbi, int index, int newID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     pData->dec_method[index] = newID;
-    ambi_dec_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
+    ambi_dec_requestDecoderUpdate(hAmbi);
 }
 
 void ambi_dec_setDecEnableMaxrE(void* const hAmbi, int index, int newID)
@@ -818,6 +1461,12 @@ void ambi_dec_setTransitionFreq(void* const hAmbi, float newValue)
     pData->transitionFreq = CLAMP(newValue, AMBI_DEC_TRANSITION_MIN_VALUE, AMBI_DEC_TRANSITION_MAX_VALUE);
 }
 
+void ambi_dec_setEnableTimeDomainPath(void* const hAmbi, int newState)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    pData->enableTDpath = newState ? 1 : 0;
+}
+
 
 /* Get Functions */
 
@@ -963,6 +1612,12 @@ float ambi_dec_getTransitionFreq(void* const hAmbi)
     return pData->transitionFreq;
 }
 
+int ambi_dec_getEnableTimeDomainPath(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->enableTDpath;
+}
+
 int ambi_dec_getHRIRsamplerate(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
@@ -976,9 +1631,28 @@ int ambi_dec_getDAWsamplerate(void* const hAmbi)
     return pData->fs;
 }
 
-int ambi_dec_getProcessingDelay()
+int ambi_dec_getProcessingDelay(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->tdPathActive ? 0 : saf_fifo_getLatency(pData->hFIFO) + 12*HOP_SIZE;
+}
+
+void* ambi_dec_getProfiler(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->hProfiler;
+}
+
+void* ambi_dec_getTelemetry(void* const hAmbi)
 {
-    return 12*HOP_SIZE;
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->hTelemetry;
+}
+
+void* ambi_dec_getInitReport(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->hInitReport;
 }
 
 
@@ -55,18 +55,13 @@ void ambi_dec_interpHRTFs
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     ambi_dec_codecPars* pars = pData->pars;
     int i, band;
-    int aziIndex, elevIndex, N_azi, idx3d;
+    int idx3d;
     float_complex ipd;
-    float aziRes, elevRes, weights[1][3], itds3[3],  itdInterp[1];
+    float weights[1][3], itds3[3],  itdInterp[1];
     float magnitudes3[HYBRID_BANDS][3][NUM_EARS], magInterp[HYBRID_BANDS][NUM_EARS];
 
     /* find closest pre-computed VBAP direction */
-    aziRes = (float)pars->hrtf_vbapTableRes[0];
-    elevRes = (float)pars->hrtf_vbapTableRes[1];
-    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
-    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
-    idx3d = elevIndex * N_azi + aziIndex;
+    idx3d = getVBAPgainTableIdx3D(azimuth_deg, elevation_deg, pars->hrtf_vbapTableRes[0], pars->hrtf_vbapTableRes[1]);
     for (i = 0; i < 3; i++)
         weights[0][i] = pars->hrtf_vbap_gtableComp[idx3d*3 + i];
     
@@ -102,6 +97,225 @@ void ambi_dec_interpHRTFs
     }
 }
 
+/**
+ * Copies the matrices of decoder 'dSrc' of 'src' into decoder 'dDst' of 'dst'
+ * (reallocating them as needed)
+ */
+static void ambi_dec_copyDecoderMatrices
+(
+    ambi_dec_decoder* src,
+    int dSrc,
+    ambi_dec_decoder* dst,
+    int dDst,
+    int nLoudspeakers,
+    int masterOrder
+)
+{
+    int n, nSH_order;
+    
+    for(n=1; n<=masterOrder; n++){
+        nSH_order = (n+1)*(n+1);
+        dst->M_dec[dDst][n-1] = realloc1d(dst->M_dec[dDst][n-1], nLoudspeakers*nSH_order*sizeof(float));
+        memcpy(dst->M_dec[dDst][n-1], src->M_dec[dSrc][n-1], nLoudspeakers*nSH_order*sizeof(float));
+        dst->M_dec_maxrE[dDst][n-1] = realloc1d(dst->M_dec_maxrE[dDst][n-1], nLoudspeakers*nSH_order*sizeof(float));
+        memcpy(dst->M_dec_maxrE[dDst][n-1], src->M_dec_maxrE[dSrc][n-1], nLoudspeakers*nSH_order*sizeof(float));
+        dst->M_norm[dDst][n-1][0] = src->M_norm[dSrc][n-1][0];
+        dst->M_norm[dDst][n-1][1] = src->M_norm[dSrc][n-1][1];
+    }
+}
+
+void* ambi_dec_buildDecoder
+(
+    void* const hAmbi,
+    void* const hAsync
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    ambi_dec_codecPars* pars = pData->pars;
+    ambi_dec_decoder* dec;
+    int i, ch, d, j, n, ng, nGrid_dirs, masterOrder, nSH_order, max_nSH, nLoudspeakers, stage;
+    float* grid_dirs_deg, *Y, *M_dec_tmp, *g, *a, *e;
+    float a_avg[MAX_SH_ORDER], e_avg[MAX_SH_ORDER], azi_incl[2], sum_elev;
+    float loudpkrs_dirs_deg[MAX_NUM_LOUDSPEAKERS][2];
+    AMBI_DEC_DECODING_METHODS dec_method[NUM_DECODERS];
+    
+    /* take a copy of the parameters, which may change during the build */
+    masterOrder = pData->new_masterOrder;
+    max_nSH = (masterOrder+1)*(masterOrder+1);
+    nLoudspeakers = pData->new_nLoudpkrs;
+    memcpy(loudpkrs_dirs_deg, pData->loudpkrs_dirs_deg, MAX_NUM_LOUDSPEAKERS*2*sizeof(float));
+    memcpy(dec_method, pData->dec_method, NUM_DECODERS*sizeof(AMBI_DEC_DECODING_METHODS));
+    dec = (ambi_dec_decoder*)calloc1d(1, sizeof(ambi_dec_decoder));
+    dec->masterOrder = masterOrder;
+    dec->nLoudpkrs = nLoudspeakers;
+    dec->sameMethod = dec_method[0]==dec_method[1] ? 1 : 0;
+    
+    /* Quick and dirty check to find loudspeaker dimensionality */
+    sum_elev = 0.0f;
+    for(ch=0; ch < nLoudspeakers; ch++)
+        sum_elev += fabsf(loudpkrs_dirs_deg[ch][1]);
+    if( (((sum_elev < 5.0f) && (sum_elev > -5.0f))) || (nLoudspeakers < 4) )
+        dec->loudpkrs_nDims = 2;
+    else
+        dec->loudpkrs_nDims = 3;
+    
+    /* add virtual loudspeakers for 2D case */
+    if (dec->loudpkrs_nDims == 2){
+        assert(nLoudspeakers<=MAX_NUM_LOUDSPEAKERS-2);
+        loudpkrs_dirs_deg[nLoudspeakers][0] = 0.0f;
+        loudpkrs_dirs_deg[nLoudspeakers][1] = -90.0f;
+        loudpkrs_dirs_deg[nLoudspeakers+1][0] = 0.0f;
+        loudpkrs_dirs_deg[nLoudspeakers+1][1] = 90.0f;
+        nLoudspeakers += 2;
+    }
+    
+    /* max_rE weights (returned as diagonal matrices), for orders 1..masterOrder */
+    saf_initDeps_begin(pData->hInitDeps, AMBI_DEC_STAGE_MAXRE_WEIGHTS);
+    saf_initDeps_addInput(pData->hInitDeps, AMBI_DEC_STAGE_MAXRE_WEIGHTS, &masterOrder, sizeof(int));
+    if(saf_initDeps_isStale(pData->hInitDeps, AMBI_DEC_STAGE_MAXRE_WEIGHTS)){
+        for(n=1; n<=masterOrder; n++){
+            nSH_order = (n+1)*(n+1);
+            pars->maxrE_weights[n-1] = realloc1d(pars->maxrE_weights[n-1], nSH_order*nSH_order*sizeof(float));
+            getMaxREweights(n, 1, pars->maxrE_weights[n-1]);
+        }
+        saf_initDeps_commit(pData->hInitDeps, AMBI_DEC_STAGE_MAXRE_WEIGHTS);
+    }
+    
+    /* prep */
+    nGrid_dirs = 480; /* Minimum t-design of degree 30, has 480 points */
+    g = malloc1d(nLoudspeakers*sizeof(float));
+    a = malloc1d(nGrid_dirs*sizeof(float));
+    e = malloc1d(nGrid_dirs*sizeof(float));
+    
+    /* calculate loudspeaker decoding matrices; unless those of the last build
+     * may be reused (i.e. if the decoding method, the master order, and the
+     * loudspeaker set-up are unchanged), or if the other decoder uses the same
+     * decoding method */
+    for( d=0; d<NUM_DECODERS; d++){
+        if(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync))
+            break;
+        stage = AMBI_DEC_STAGE_DECODER_LF + d;
+        saf_initDeps_begin(pData->hInitDeps, stage);
+        saf_initDeps_addInput(pData->hInitDeps, stage, &(dec_method[d]), sizeof(AMBI_DEC_DECODING_METHODS));
+        saf_initDeps_addInput(pData->hInitDeps, stage, &masterOrder, sizeof(int));
+        saf_initDeps_addInput(pData->hInitDeps, stage, &(dec->nLoudpkrs), sizeof(int));
+        saf_initDeps_addInput(pData->hInitDeps, stage, loudpkrs_dirs_deg, (dec->nLoudpkrs)*2*sizeof(float));
+        saf_initDeps_addDependency(pData->hInitDeps, stage, AMBI_DEC_STAGE_MAXRE_WEIGHTS);
+        if(!saf_initDeps_isStale(pData->hInitDeps, stage)){
+            ambi_dec_copyDecoderMatrices(pars->decCache, d, dec, d, dec->nLoudpkrs, masterOrder);
+            continue;
+        }
+        if(d>0 && dec->sameMethod){
+            ambi_dec_copyDecoderMatrices(dec, 0, dec, d, dec->nLoudpkrs, masterOrder);
+            ambi_dec_copyDecoderMatrices(dec, d, pars->decCache, d, dec->nLoudpkrs, masterOrder);
+            saf_initDeps_commit(pData->hInitDeps, stage);
+            continue;
+        }
+        M_dec_tmp = malloc1d(nLoudspeakers * max_nSH * sizeof(float));
+        switch(dec_method[d]){
+            case DECODING_METHOD_SAD:
+                getLoudspeakerAmbiDecoderMtxCached((float*)loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_SAD, masterOrder, 0, M_dec_tmp);
+                break;
+            case DECODING_METHOD_MMD:
+                getLoudspeakerAmbiDecoderMtxCached((float*)loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_MMD, masterOrder, 0, M_dec_tmp);
+                break;
+            case DECODING_METHOD_EPAD:
+                getLoudspeakerAmbiDecoderMtxCached((float*)loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_EPAD, masterOrder, 0, M_dec_tmp);
+                break;
+            case DECODING_METHOD_ALLRAD:
+                getLoudspeakerAmbiDecoderMtxCached((float*)loudpkrs_dirs_deg, nLoudspeakers, LOUDSPEAKER_DECODER_ALLRAD, masterOrder, 0, M_dec_tmp);
+                break;
+        }
+        
+        /* diffuse-field EQ for orders 1..masterOrder */
+        for( n=1; n<=masterOrder; n++){
+            /* truncate M_dec for each order */
+            nSH_order = (n+1)*(n+1);
+            dec->M_dec[d][n-1] = malloc1d(nLoudspeakers* nSH_order * sizeof(float));
+            for(i=0; i<nLoudspeakers; i++)
+                for(j=0; j<nSH_order; j++)
+                    dec->M_dec[d][n-1][i*nSH_order+j] = M_dec_tmp[i*max_nSH +j];
+            
+            /* create dedicated maxrE weighted versions */
+            dec->M_dec_maxrE[d][n-1] = malloc1d(nLoudspeakers * nSH_order * sizeof(float));
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, nSH_order, nSH_order, 1.0f,
+                        dec->M_dec[d][n-1], nSH_order,
+                        pars->maxrE_weights[n-1], nSH_order, 0.0f,
+                        dec->M_dec_maxrE[d][n-1], nSH_order);
+            
+            /* fire a plane-wave from each grid direction to find the total energy/amplitude (using non-maxrE weighted versions) */
+            Y = malloc1d(nSH_order*sizeof(float));
+            grid_dirs_deg = (float*)(&__Tdesign_degree_30_dirs_deg[0][0]);
+            for(ng=0; ng<nGrid_dirs; ng++){
+                azi_incl[0] = grid_dirs_deg[ng*2]*M_PI/180.0f;
+                azi_incl[1] = M_PI/2.0f-grid_dirs_deg[ng*2+1]*M_PI/180.0f;
+                getSHreal(n, (float*)azi_incl, 1,  Y);
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nLoudspeakers, 1, nSH_order, 1.0f,
+                            dec->M_dec[d][n-1], nSH_order,
+                            Y, nSH_order, 0.0f,
+                            g, 1);
+                a[ng] = e[ng] = 0.0f;
+                for(i=0; i<nLoudspeakers; i++){
+                    a[ng] += g[i];
+                    e[ng] += powf(g[i], 2.0f);
+                }
+            }
+            
+            /* determine the order+decoder dependent normalisation factor for energy+amplitude preserving decoding */
+            a_avg[n-1] = e_avg[n-1] = 0.0f;
+            for(ng=0; ng<nGrid_dirs; ng++){
+                a_avg[n-1] += a[ng];
+                e_avg[n-1] += e[ng];
+            }
+            a_avg[n-1] /= (float)nGrid_dirs;
+            e_avg[n-1] /= (float)nGrid_dirs;
+            dec->M_norm[d][n-1][0] = 1.0f/(a_avg[n-1]+2.23e-6f); /* use this to preserve omni amplitude */
+            dec->M_norm[d][n-1][1] = sqrtf(1.0f/(e_avg[n-1]+2.23e-6f));  /* use this to preserve omni energy */
+            free(Y);
+            
+            /* remove virtual loudspeakers from the decoder */
+            if (dec->loudpkrs_nDims == 2){
+                dec->M_dec[d][n-1] = realloc1d(dec->M_dec[d][n-1], dec->nLoudpkrs * nSH_order * sizeof(float));
+                dec->M_dec_maxrE[d][n-1] = realloc1d(dec->M_dec_maxrE[d][n-1], dec->nLoudpkrs * nSH_order * sizeof(float));
+            }
+        }
+        free(M_dec_tmp);
+        
+        /* keep a copy, for the next build */
+        ambi_dec_copyDecoderMatrices(dec, d, pars->decCache, d, dec->nLoudpkrs, masterOrder);
+        saf_initDeps_commit(pData->hInitDeps, stage);
+    }
+    
+    free(g);
+    free(a);
+    free(e);
+    if(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync)){
+        ambi_dec_destroyDecoder(hAmbi, (void*)dec);
+        return NULL;
+    }
+    return (void*)dec;
+}
+
+void ambi_dec_destroyDecoder
+(
+    void* const hAmbi,
+    void* decoder
+)
+{
+    ambi_dec_decoder* dec = (ambi_dec_decoder*)decoder;
+    int i, j;
+    
+    if(dec!=NULL){
+        for (i=0; i<NUM_DECODERS; i++){
+            for(j=0; j<MAX_SH_ORDER; j++){
+                free(dec->M_dec[i][j]);
+                free(dec->M_dec_maxrE[i][j]);
+            }
+        }
+        free(dec);
+    }
+}
+
 void loadLoudspeakerArrayPreset
 (
     AMBI_DEC_LOUDSPEAKER_ARRAY_PRESETS preset,
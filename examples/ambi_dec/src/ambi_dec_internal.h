@@ -58,6 +58,21 @@ typedef enum _AMBI_DEC_PROC_STATUS{
                               *   be reinitialised if needed. */
 }AMBI_DEC_PROC_STATUS;
 
+/**
+ * Stages of the initialisation, which are only recomputed if their inputs have
+ * changed (see saf_initDeps.h)
+ */
+typedef enum _AMBI_DEC_INIT_STAGES{
+    AMBI_DEC_STAGE_AFSTFT = 0,    /**< afSTFT channel configuration */
+    AMBI_DEC_STAGE_HRIRS,         /**< HRIRs and filterbank HRTFs */
+    AMBI_DEC_STAGE_HRTF_VBAP,     /**< VBAP gain table for the HRIR directions */
+    AMBI_DEC_STAGE_MAXRE_WEIGHTS, /**< max_rE weights for orders 1..masterOrder */
+    AMBI_DEC_STAGE_DECODER_LF,    /**< low-frequency decoding matrices */
+    AMBI_DEC_STAGE_DECODER_HF,    /**< high-frequency decoding matrices */
+    
+    AMBI_DEC_NUM_INIT_STAGES
+}AMBI_DEC_INIT_STAGES;
+
 
 /* ========================================================================== */
 /*                            Internal Parameters                             */
@@ -79,6 +94,23 @@ typedef enum _AMBI_DEC_PROC_STATUS{
 /*                                 Structures                                 */
 /* ========================================================================== */
 
+/**
+ * Loudspeaker decoding matrices (for one loudspeaker set-up and master order),
+ * which are built as a whole (see ambi_dec_buildDecoder()), so that a new set
+ * may be prepared in the background while the current one is still in use
+ */
+typedef struct _ambi_dec_decoder
+{
+    int masterOrder;                            /**< master decoding order */
+    int nLoudpkrs;                              /**< number of loudspeakers (excluding the virtual ones used for 2D set-ups) */
+    int loudpkrs_nDims;                         /**< dimensionality of the loudspeaker set-up */
+    int sameMethod;                             /**< 1: the low- and high-frequency decoders use the same decoding method */
+    float* M_dec[NUM_DECODERS][MAX_SH_ORDER];   /**< ambisonic decoding matrices ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
+    float* M_dec_maxrE[NUM_DECODERS][MAX_SH_ORDER]; /**< ambisonic decoding matrices with maxrE weighting ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
+    float M_norm[NUM_DECODERS][MAX_SH_ORDER][2]; /**< norm coefficients to preserve omni energy/amplitude between different orders and decoders */
+    
+}ambi_dec_decoder;
+
 /**
  * Contains variables for sofa file loading, HRTF interpolation, and the
  * loudspeaker decoders.
@@ -86,14 +118,13 @@ typedef enum _AMBI_DEC_PROC_STATUS{
 typedef struct _ambi_dec_codecPars
 {
     /* decoders */
-    float* M_dec[NUM_DECODERS][MAX_SH_ORDER];   /**< ambisonic decoding matrices ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
-    float_complex* M_dec_cmplx[NUM_DECODERS][MAX_SH_ORDER]; /**< complex ambisonic decoding matrices ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
-    float* M_dec_maxrE[NUM_DECODERS][MAX_SH_ORDER]; /**< ambisonic decoding matrices with maxrE weighting ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
-    float_complex* M_dec_cmplx_maxrE[NUM_DECODERS][MAX_SH_ORDER]; /**< complex ambisonic decoding matrices with maxrE weighting ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
-    float M_norm[NUM_DECODERS][MAX_SH_ORDER][2]; /**< norm coefficients to preserve omni energy/amplitude between different orders and decoders */
+    ambi_dec_decoder* dec;                      /**< decoding matrices currently in use */
+    ambi_dec_decoder* decCache;                 /**< copies of the matrices of the last committed AMBI_DEC_STAGE_DECODER_LF/HF stages; only accessed by ambi_dec_buildDecoder() */
+    float* maxrE_weights[MAX_SH_ORDER];         /**< max_rE weights (as diagonal matrices) for orders 1..masterOrder; only accessed by ambi_dec_buildDecoder() */
     
     /* sofa file info */
     char* sofa_filepath;                        /**< absolute/relevative file path for a sofa file */
+    void* hHRTFs;                               /**< shared HRIR data; see hrtfCache_acquire() */
     float* hrirs;                               /**< time domain HRIRs; N_hrir_dirs x 2 x hrir_len */
     float* hrir_dirs_deg;                       /**< directions of the HRIRs in degrees [azi elev]; N_hrir_dirs x 2 */
     int N_hrir_dirs;                            /**< number of HRIR directions in the current sofa file */
@@ -122,23 +153,47 @@ typedef struct _ambi_dec_codecPars
 typedef struct _ambi_dec
 {
     /* audio buffers + afSTFT time-frequency transform handle */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hProfiler; /**< per-stage timing (see saf_profiler.h) */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
+    void* hInitReport; /**< stages of the last initCodec() call (see saf_initReport.h) */
+    void* hInitDeps; /**< inputs of the initialisation stages, see AMBI_DEC_INIT_STAGES (and saf_initDeps.h) */
+    void* hArena; /**< arena holding the (aligned) buffers below, which are allocated once at creation */
+    float** planarInTD;  /**< planar input chunk, for interleaved time-domain path processing; MAX_NUM_SH_SIGNALS x FRAME_SIZE */
+    float** planarOutTD; /**< planar output chunk, for interleaved time-domain path processing; MAX_NUM_LOUDSPEAKERS x FRAME_SIZE */
     float SHFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
     float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS];
+    float_complex outputframeTF_prev[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]; /**< output of the previous decoder, to crossfade from */
     float_complex binframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;
+    float SHFrameTD_hi[MAX_NUM_SH_SIGNALS][FRAME_SIZE]; /**< high-passed SH signals, for the time-domain path */
+    float outputFrameTD[MAX_NUM_LOUDSPEAKERS][FRAME_SIZE]; /**< loudspeaker signals, for the time-domain path */
+    float outputFrameTD_prev[MAX_NUM_LOUDSPEAKERS][FRAME_SIZE]; /**< output of the previous decoder, for the time-domain path */
     void* hSTFT;                         /**< afSTFT handle */
     int afSTFTdelay;                     /**< for host delay compensation */
     float** tempHopFrameTD;              /**< temporary multi-channel time-domain buffer of size "HOP_SIZE". */
     int fs;                              /**< host sampling rate */
     float freqVector[HYBRID_BANDS];      /**< frequency vector for time-frequency transform, in Hz */
     
+    /* time-domain path (frequency-independent decoding, without the afSTFT) */
+    void* hXover;                        /**< crossover (two band IIRFilterbank) */
+    float xover_fc;                      /**< transition frequency the crossover was designed for, in Hz */
+    int xover_fs;                        /**< sampling rate the crossover was designed for */
+    int tdPathActive;                    /**< 1: the time-domain path was used for the last block, 0: the afSTFT path */
+    void* hOrderDet;                     /**< effective input order detector; only the orders carrying content are decoded */
+    int nSH_active;                      /**< number of SH components detected in the last afSTFT frame */
+    
+    /* additional layouts, decoded from SHframeTF (see ambi_dec_addLayout()) */
+    int nLayouts;                        /**< number of additional layouts */
+    void* hLayouts[AMBI_DEC_MAX_NUM_LAYOUTS]; /**< ambi_dec handles of the additional layouts */
+    void* hLayoutFIFO;                   /**< FIFO for ambi_dec_processLayouts(); NULL if there are no layouts */
+    
     /* our codec configuration */
     AMBI_DEC_CODEC_STATUS codecStatus;
     float progressBar0_1;
     char* progressBarText;
     ambi_dec_codecPars* pars;            /**< codec parameters */
+    void* hDecInit;                      /**< saf_asyncInit handle; builds new decoders in the background */
     
     /* internal variables */
     int loudpkrs_nDims;                  /**< dimensionality of the current loudspeaker set-up */
@@ -148,7 +203,8 @@ typedef struct _ambi_dec
     
     /* flags */
     AMBI_DEC_PROC_STATUS procStatus;
-    int reinit_hrtfsFLAG; /**< 0: no init required, 1: init required */
+    int reinit_hrtfsFLAG; /**< 1: reload the HRIRs, even if their inputs are unchanged */
+    int clearTFbuffersFLAG; /**< 1: afSTFT buffers are stale (after using the time-domain path) and should be cleared */
     int recalc_hrtf_interpFLAG[MAX_NUM_LOUDSPEAKERS]; /**< 0: no init required, 1: init required */
     
     /* user parameters */
@@ -162,6 +218,7 @@ typedef struct _ambi_dec
     float loudpkrs_dirs_deg[MAX_NUM_LOUDSPEAKERS][NUM_DECODERS]; /* loudspeaker directions in degrees [azi, elev] */
     int useDefaultHRIRsFLAG;             /**< 1: use default HRIRs in database, 0: use those from SOFA file */
     int binauraliseLS;                   /**< 1: convolve loudspeaker signals with HRTFs, 0: output loudspeaker signals */
+    int enableTDpath;                    /**< 1: use the time-domain path whenever the settings are frequency-independent */
     AMBI_DEC_CH_ORDER chOrdering;        /**< only ACN is supported */
     AMBI_DEC_NORM_TYPES norm;            /**< N3D or SN3D */
     
@@ -192,6 +249,32 @@ void ambi_dec_interpHRTFs(void* const hAmbi,
                           float elevation_deg,
                           float_complex h_intrp[HYBRID_BANDS][NUM_EARS]);
 
+/**
+ * Computes the loudspeaker decoding matrices for the current loudspeaker
+ * directions, decoding methods, and (new) master order and number of
+ * loudspeakers
+ *
+ * The matrices of a decoder are only recomputed if its decoding method, the
+ * master order, or the loudspeaker set-up have changed since the last build;
+ * otherwise they are copied from pars->decCache.
+ *
+ * @note This does not modify the decoder currently in use, and so it may be
+ *       called from the background initialisation thread (see saf_asyncInit.h);
+ *       however, only one build may be ongoing at a time
+ *
+ * @param[in] hAmbi  ambi_dec handle
+ * @param[in] hAsync saf_asyncInit handle, for cancelling the build; may be NULL
+ * @returns   New ambi_dec_decoder; or NULL, if the build was cancelled
+ */
+void* ambi_dec_buildDecoder(void* const hAmbi,
+                            void* const hAsync);
+
+/**
+ * Destroys a decoder returned by ambi_dec_buildDecoder() (may be NULL)
+ */
+void ambi_dec_destroyDecoder(void* const hAmbi,
+                             void* decoder);
+
 /**
  * Returns the loudspeaker directions for a specified loudspeaker array preset.
  *
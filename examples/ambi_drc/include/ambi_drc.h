@@ -56,6 +56,8 @@ extern "C" {
 #define AMBI_DRC_MAX_SH_ORDER ( 7 )
 #define MAX_ORDER ( AMBI_DRC_MAX_SH_ORDER )
 #define MAX_NUM_SH_SIGNALS ( (MAX_ORDER+1)*(MAX_ORDER+1) )
+#define AMBI_DRC_TD_NUM_BANDS ( 9 ) /* number of octave bands used by the time-domain path (63Hz..16kHz) */
+#define AMBI_DRC_MAX_NUM_STEMS ( 16 ) /* maximum number of stems for ambi_drc_processMultiStem() */
 #ifdef ENABLE_TF_DISPLAY
 # define NUM_DISPLAY_SECONDS ( 8 ) /* How many seconds the display will show historic TF data */
 # define NUM_DISPLAY_TIME_SLOTS ( (int)(NUM_DISPLAY_SECONDS*48000.0f/(float)HOP_SIZE) )
@@ -153,6 +155,13 @@ void ambi_drc_init(void* const hAmbi,
  * Applies the frequency-dependent dynamic range compression to the input
  * spherical harmonic signals.
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in ambi_drc_getProcessingDelay(). However, if the
+ *       time-domain path is enabled (see ambi_drc_setEnableTimeDomainPath()),
+ *       then the blocks are processed directly, without any added latency.
+ *
  * @param[in] hAmbi    ambi_drc handle
  * @param[in] inputs   Input channel buffers; 2-D array: nCH x nSamples
  * @param[in] outputs  Output channel buffers; 2-D array: nCH x nSamples
@@ -165,6 +174,84 @@ void ambi_drc_process(void* const hAmbi,
                       int nCH,
                       int nSamples);
 
+/**
+ * Same as ambi_drc_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hAmbi    ambi_drc handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nCH
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nCH
+ * @param[in] nCH      Number of input/output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void ambi_drc_processInterleaved(void* const hAmbi,
+                                 const float* inputs,
+                                 float* outputs,
+                                 int nCH,
+                                 int nSamples);
+
+/**
+ * Applies the dynamic range compression to one afSTFT-domain frame, for use as
+ * a stage of a saf_tfGraph (see saf_tfGraph_stageProcessor)
+ *
+ * This is the main processing of ambi_drc_process(), without the FIFO and the
+ * forward/inverse afSTFT; which are instead applied once for the whole chain by
+ * the graph. The time-domain path is not used.
+ *
+ * @param[in]  hAmbi         ambi_drc handle
+ * @param[in]  inTF          Input frame (complex); FLAT: HYBRID_BANDS x
+ *                           nInputs x TIME_SLOTS
+ * @param[out] outTF         Output frame (complex); FLAT: HYBRID_BANDS x nSH x
+ *                           TIME_SLOTS
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels
+ * @param[in]  nBands        Number of bands (must be HYBRID_BANDS)
+ * @param[in]  nTimeSlots    Number of time slots (must be TIME_SLOTS)
+ * @returns Number of output channels (nSH), or 0 if not ready
+ */
+int ambi_drc_processTF(void* const hAmbi,
+                       const float* inTF,
+                       float* outTF,
+                       int nInputs,
+                       int maxNumOutputs,
+                       int nBands,
+                       int nTimeSlots);
+
+/**
+ * Applies the same (linked) frequency-dependent dynamic range compression to a
+ * number of spherical harmonic streams ("stems") at once
+ *
+ * The gain factors are computed once per time-frequency tile, either from the
+ * weighted power sum of the omni components of all of the stems (see
+ * ambi_drc_setStemWeight()), or from the power of a mono sidechain signal (if
+ * one is given); and are then applied to all of the SH components of all of
+ * the stems. Compared with running one ambi_drc instance per stem and linking
+ * their gains externally, each stem is passed through the afSTFT only once in
+ * each direction, and the gain computer is evaluated only once.
+ *
+ * @note The number of stems is set with ambi_drc_setNumStems(). This function
+ *       always uses the afSTFT path (with the same latency as
+ *       ambi_drc_process()), and has its own FIFO, filterbank and detector
+ *       states; the memory for which is only allocated once it is first called.
+ *       The gain display shows the shared gain factors.
+ *
+ * @param[in] hAmbi     ambi_drc handle
+ * @param[in] inputs    Input stems; 3-D array: nStems x nCH x nSamples
+ * @param[in] outputs   Output stems; 3-D array: nStems x nCH x nSamples
+ * @param[in] sidechain Sidechain signal, which drives the detector instead of
+ *                      the stems; nSamples x 1 (or NULL, to use the stems)
+ * @param[in] nStems    Number of stems (stems beyond ambi_drc_getNumStems()
+ *                      are zeroed)
+ * @param[in] nCH       Number of input/output channels per stem
+ * @param[in] nSamples  Number of samples in each channel
+ */
+void ambi_drc_processMultiStem(void* const hAmbi,
+                               float*** const inputs,
+                               float*** const outputs,
+                               float* const sidechain,
+                               int nStems,
+                               int nCH,
+                               int nSamples);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -235,6 +322,41 @@ void ambi_drc_setNormType(void* const hAmbi, int newType);
  */
 void ambi_drc_setInputPreset(void* const hAmbi, AMBI_DRC_INPUT_ORDER newPreset);
 
+/**
+ * Enables/disables the (low-latency) time-domain path
+ *
+ * The time-domain path bypasses the afSTFT (and the FIFO) and so adds no
+ * latency. The input signals are instead divided into AMBI_DRC_TD_NUM_BANDS
+ * octave bands by a tree of 4th-order Linkwitz-Riley crossovers (see
+ * IIRFilterbank_create()), which sum back to an all-pass response; and the gain
+ * factors are computed every HOP_SIZE samples (or once per block, for smaller
+ * blocks), based on the mean power of each omni band, and interpolated
+ * linearly in between. The frequency resolution is therefore much coarser than
+ * that of the afSTFT. Note that switching between the two paths is not
+ * seamless.
+ *
+ * @param[in] hAmbi    ambi_drc handle
+ * @param[in] newState 0: use the afSTFT (default), 1: use the time-domain path
+ */
+void ambi_drc_setEnableTimeDomainPath(void* const hAmbi, int newState);
+
+/**
+ * Sets the number of stems processed by ambi_drc_processMultiStem(); 1 to
+ * AMBI_DRC_MAX_NUM_STEMS
+ */
+void ambi_drc_setNumStems(void* const hAmbi, int newValue);
+
+/**
+ * Sets the (linear, amplitude) weight with which a stem contributes to the
+ * shared detector of ambi_drc_processMultiStem(); default: 1, while 0 excludes
+ * the stem from the detector (it is still compressed)
+ *
+ * @param[in] hAmbi     ambi_drc handle
+ * @param[in] stemIndex Index of the stem; 0..AMBI_DRC_MAX_NUM_STEMS-1
+ * @param[in] newValue  Weight; >=0
+ */
+void ambi_drc_setStemWeight(void* const hAmbi, int stemIndex, float newValue);
+
     
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -314,12 +436,40 @@ int ambi_drc_getNSHrequired(void* const hAmbi);
  * Returns the DAW/Host sample rate
  */
 int ambi_drc_getSamplerate(void* const hAmbi);
+
+/**
+ * Returns whether the time-domain path is enabled (1) or not (0); see
+ * ambi_drc_setEnableTimeDomainPath()
+ */
+int ambi_drc_getEnableTimeDomainPath(void* const hAmbi);
+
+/**
+ * Returns the number of stems processed by ambi_drc_processMultiStem()
+ */
+int ambi_drc_getNumStems(void* const hAmbi);
+
+/**
+ * Returns the detector weight of a stem; see ambi_drc_setStemWeight()
+ */
+float ambi_drc_getStemWeight(void* const hAmbi, int stemIndex);
     
 /**
- * Returns the processing delay in samples; may be used for delay compensation
+ * Returns the processing delay in samples of the path (afSTFT or time-domain)
+ * which was used for the most recent block; may be used for delay compensation
  * features
+ *
+ * This is 0 when processing in the time-domain. Otherwise, it is the delay of
+ * the afSTFT, plus the latency of the internal FIFO, if any (i.e. if the host
+ * block size is not a multiple of FRAME_SIZE)
+ */
+int ambi_drc_getProcessingDelay(void* const hAmbi);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the afSTFT); see saf_telemetry_getSnapshot()
  */
-int ambi_drc_getProcessingDelay(void);
+void* ambi_drc_getTelemetry(void* const hAmbi);
     
     
 #ifdef __cplusplus
@@ -46,21 +46,12 @@ void ambi_drc_create
 {
     ambi_drc_data* pData = (ambi_drc_data*)malloc1d(sizeof(ambi_drc_data));
     *phAmbi = (void*)pData;
-    int ch;
+    float octaveCentreFreqs[AMBI_DRC_TD_NUM_BANDS] = { 62.5f, 125.0f, 250.0f, 500.0f, 1e3f, 2e3f, 4e3f, 8e3f, 16e3f };
+    int s;
  
     /* afSTFT stuff */
     pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS*sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
     pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_SH_SIGNALS), HOP_SIZE, sizeof(float));
-    pData->STFTOutputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS*sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    } 
     
     /* internal */
     pData->fs = 48000;
@@ -81,11 +72,42 @@ void ambi_drc_create
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
     pData->currentOrder = INPUT_ORDER_1;
+    pData->enableTDpath = 0;
+    memset(pData->coeffs_pars, 0, 5*sizeof(float)); /* (forces the coefficients to be computed) */
+    
+    /* time-domain path */
+    getOctaveBandCutoffFreqs(octaveCentreFreqs, AMBI_DRC_TD_NUM_BANDS, pData->fbCutoffFreqs);
+    IIRFilterbank_create(&(pData->hFB), MAX_NUM_SH_SIGNALS, pData->fbCutoffFreqs, AMBI_DRC_TD_NUM_BANDS-1, pData->fs);
+    pData->tdPathActive = 0;
+    
+    /* multi-stem processing (allocated once it is first used) */
+    pData->hFIFO_ms = NULL;
+    pData->hSTFT_ms = NULL;
+    pData->hSTFT_sc = NULL;
+    pData->stemsFrameTF = NULL;
+    pData->scFrameTF = NULL;
+    pData->stemsHopTD = NULL;
+    pData->scHopTD = NULL;
+    memset(pData->stemsZeros, 0, FRAME_SIZE*sizeof(float));
+    memset(pData->yL_z1_ms, 0, HYBRID_BANDS * sizeof(float));
+    for(s=0; s<AMBI_DRC_MAX_NUM_STEMS; s++)
+        pData->stemWeights[s] = 1.0f;
+    pData->nStems = 0;
+    pData->new_nStems = 1;
+    pData->stemsNSH = 0;
+    pData->scActive = 0;
+    pData->reInitStems = 1;
     
     /* for dynamically allocating the number of channels */
     ambi_drc_setInputOrder(pData->currentOrder, &(pData->new_nSH));
     pData->nSH = pData->new_nSH;
     pData->reInitTFT = 1;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, MAX_NUM_SH_SIGNALS);
+    saf_telemetry_create(&(pData->hTelemetry));
+    pData->planarInTD = (float**)malloc2d(MAX_NUM_SH_SIGNALS, FRAME_SIZE, sizeof(float));
+    pData->planarOutTD = (float**)malloc2d(MAX_NUM_SH_SIGNALS, FRAME_SIZE, sizeof(float));
 }
 
 void ambi_drc_destroy
@@ -94,25 +116,30 @@ void ambi_drc_destroy
 )
 {
     ambi_drc_data *pData = (ambi_drc_data*)(*phAmbi);
-    int ch;
 
     if (pData != NULL) {
         if (pData->hSTFT != NULL) {
             afSTFTfree(pData->hSTFT);
-            for (ch = 0; ch < MAX_NUM_SH_SIGNALS; ch++) {
-                free(pData->STFTInputFrameTF[ch].re);
-                free(pData->STFTInputFrameTF[ch].im);
-                free(pData->STFTOutputFrameTF[ch].re);
-                free(pData->STFTOutputFrameTF[ch].im);
-            }
-            free(pData->STFTInputFrameTF);
-            free(pData->STFTOutputFrameTF);
             free(pData->tempHopFrameTD);
         }
 #ifdef ENABLE_TF_DISPLAY
         free(pData->gainsTF_bank0);
         free(pData->gainsTF_bank1);
 #endif
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        free(pData->planarInTD);
+        free(pData->planarOutTD);
+        IIRFilterbank_destroy(&(pData->hFB));
+        if (pData->hSTFT_ms != NULL) {
+            afSTFTfree(pData->hSTFT_ms);
+            afSTFTfree(pData->hSTFT_sc);
+        }
+        saf_fifo_destroy(&(pData->hFIFO_ms));
+        free(pData->stemsFrameTF);
+        free(pData->scFrameTF);
+        free(pData->stemsHopTD);
+        free(pData->scHopTD);
         free(pData);
         pData = NULL;
     }
@@ -125,16 +152,27 @@ void ambi_drc_init
 )
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    int band;
+    int band, k;
 
     pData->fs = (float)sampleRate;
     memset(pData->yL_z1, 0, HYBRID_BANDS * sizeof(float));
+    memset(pData->yL_z1_ms, 0, HYBRID_BANDS * sizeof(float));
     for(band=0; band <HYBRID_BANDS; band++){
         if(sampleRate==44100)
             pData->freqVector[band] =  (float)__afCenterFreq44100[band];
         else /* assume 48e3 */
             pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     }
+    
+    /* time-domain path (its states are cleared before the next block) */
+    IIRFilterbank_setCutoffFreqs(pData->hFB, pData->fbCutoffFreqs, pData->fs);
+    pData->tdPathActive = 0;
+    for(band=0; band<HYBRID_BANDS; band++){
+        for(k=0; k<AMBI_DRC_TD_NUM_BANDS-1; k++)
+            if(pData->freqVector[band] < pData->fbCutoffFreqs[k])
+                break;
+        pData->hybridBand2tdBand[band] = k;
+    }
 
 #ifdef ENABLE_TF_DISPLAY
     pData->rIdx = 0;
@@ -154,20 +192,104 @@ void ambi_drc_init
     }
 }
 
-void ambi_drc_process
+#ifdef ENABLE_TF_DISPLAY
+/**
+ * Stores the gain factors of one time slot in the circular buffers used for
+ * plotting, and increments the buffer indices
+ */
+static void ambi_drc_storeGainsTF
+(
+    ambi_drc_data* pData,
+    const float* gains
+)
+{
+    int band;
+    
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        if(pData->storeIdx==0)
+            pData->gainsTF_bank0[band][pData->wIdx] = gains[band];
+        else
+            pData->gainsTF_bank1[band][pData->wIdx] = gains[band];
+    }
+    pData->wIdx++;
+    pData->rIdx++;
+    if (pData->wIdx >= NUM_DISPLAY_TIME_SLOTS){
+        pData->wIdx = 0;
+        pData->storeIdx = pData->storeIdx == 0 ? 1 : 0;
+    }
+    if (pData->rIdx >= NUM_DISPLAY_TIME_SLOTS)
+        pData->rIdx = 0;
+}
+#endif
+
+/**
+ * Computes the gain factors of one TF frame from its omni component, and
+ * applies them to the first 'nSH' channels. Band 'band' of channel 'ch' of
+ * time slot 't' is found at [band*bandStride + ch*TIME_SLOTS + t], of both
+ * 'inTF' and 'outTF'
+ */
+static void ambi_drc_applyGainsTF
+(
+    ambi_drc_data* pData,
+    const float_complex* inTF,
+    int inBandStride,
+    float_complex* outTF,
+    int outBandStride,
+    int nSH
+)
+{
+    int t, ch, band;
+    float g, makeup, boost, theshold, ratio, knee;
+    float_complex X;
+    
+    ambi_drc_updateCoeffs(pData);
+    boost = pData->boost;
+    makeup = pData->makeup;
+    theshold = pData->theshold;
+    ratio = pData->ratio;
+    knee = pData->knee;
+    
+    /* Calculate the dynamic range compression gain factors per frequency band based on the omnidirectional component.
+     *     McCormack, L., & Välimäki, V. (2017). "FFT-Based Dynamic Range Compression". in Proceedings of the 14th
+     *     Sound and Music Computing Conference, July 5-8, Espoo, Finland.*/
+    for (t = 0; t < TIME_SLOTS; t++) {
+        /* calculate the gain factors for all frequencies based on the (boosted) omni component */
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            X = inTF[band*inBandStride + 0/* omni */ + t];
+            pData->pwr[band] = boost*boost * (crealf(X)*crealf(X) + cimagf(X)*cimagf(X));
+        }
+        ambi_drc_computeGains(pData->pwr, HYBRID_BANDS, theshold, ratio, knee, pData->alpha_a, pData->alpha_r,
+                              pData->yL_z1, pData->gains);
+#ifdef ENABLE_TF_DISPLAY
+        /* store gain factors in circular buffer for plotting */
+        ambi_drc_storeGainsTF(pData, pData->gains);
+#endif
+        
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            /* apply input boost, and the same gain factor to all SH components, the spatial characteristics will
+             * be preserved (although, ones perception of them may of course change) */
+            g = boost*pData->gains[band]*makeup;
+            for (ch = 0; ch < nSH; ch++)
+                outTF[band*outBandStride + ch*TIME_SLOTS + t] = crmulf(inTF[band*inBandStride + ch*TIME_SLOTS + t], g);
+        }
+    }
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void ambi_drc_processFrame
 (
     void*   const hAmbi,
     float** const inputs,
     float** const outputs,
-    int nCh,
-    int nSamples
-)                                         
+    int nInputs,
+    int nOutputs
+)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    int i, n, t, ch, band;
-    int o[MAX_ORDER+2];
-    float xG, yG, xL, yL, cdB, alpha_a, alpha_r;
-    float makeup, boost, theshold, ratio, knee;
+    int i, t, ch;
     
     /* reinitialise if needed */
     if(pData->reInitTFT==1){
@@ -177,19 +299,11 @@ void ambi_drc_process
     }
 
     /* Main processing loop */
-    if (nSamples == FRAME_SIZE && pData->reInitTFT == 0) {
-        /* prep */
-        for(n=0; n<MAX_ORDER+2; n++){  o[n] = n*n;  }
-        alpha_a = expf(-1.0f / ( (pData->attack_ms  / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
-        alpha_r = expf(-1.0f / ( (pData->release_ms / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
-        boost = powf(10.0f, pData->inGain / 20.0f);
-        makeup = powf(10.0f, pData->outGain / 20.0f);
-        theshold = pData->theshold;
-        ratio = pData->ratio;
-        knee = pData->knee;
+    if (pData->reInitTFT == 0) {
+        saf_telemetry_frameBegin(pData->hTelemetry);
         
         /* Load time-domain data */
-        for(i=0; i < MIN(pData->nSH, nCh); i++)
+        for(i=0; i < MIN(pData->nSH, nInputs); i++)
             utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
         for(; i<pData->nSH; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
@@ -198,75 +312,451 @@ void ambi_drc_process
         for(t=0; t< TIME_SLOTS; t++) {
             for(ch = 0; ch < pData->nSH; ch++)
                 utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ch = 0; ch < pData->nSH; ch++)
-                    pData->inputFrameTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+            afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD, &(pData->inputFrameTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS);
         }
         
         /* Main processing: */
-        /* Calculate the dynamic range compression gain factors per frequency band based on the omnidirectional component.
-            *     McCormack, L., & Välimäki, V. (2017). "FFT-Based Dynamic Range Compression". in Proceedings of the 14th
-            *     Sound and Music Computing Conference, July 5-8, Espoo, Finland.*/
-        for (t = 0; t < TIME_SLOTS; t++) {
-            for (band = 0; band < HYBRID_BANDS; band++) {
-                /* apply input boost */
-                for (ch = 0; ch < pData->nSH; ch++)
-                    pData->inputFrameTF[band][ch][t] = crmulf(pData->inputFrameTF[band][ch][t], boost);
-
-                /* calculate gain factor for this frequency based on the omni component */
-                xG = 10.0f*log10f(powf(cabsf(pData->inputFrameTF[band][0/* omni */][t]), 2.0f) + 2e-13f);
-                yG = ambi_drc_gainComputer(xG, theshold, ratio, knee);
-                xL = xG - yG;
-                yL = ambi_drc_smoothPeakDetector(xL, pData->yL_z1[band], alpha_a, alpha_r);
-                pData->yL_z1[band] = yL;
-                cdB = -yL;
-                cdB = MAX(SPECTRAL_FLOOR, sqrtf(powf(10.0f, cdB / 20.0f)));
-
-#ifdef ENABLE_TF_DISPLAY
-                /* store gain factors in circular buffer for plotting */
-                if(pData->storeIdx==0)
-                    pData->gainsTF_bank0[band][pData->wIdx] = cdB;
-                else
-                    pData->gainsTF_bank1[band][pData->wIdx] = cdB;
-#endif
-                /* apply same gain factor to all SH components, the spatial characteristics will be preserved
-                    * (although, ones perception of them may of course change) */
-                for (ch = 0; ch < pData->nSH; ch++)
-                    pData->outputFrameTF[band][ch][t] = crmulf(pData->inputFrameTF[band][ch][t], cdB*makeup);
-            }
-#ifdef ENABLE_TF_DISPLAY
-            /* increment circular buffer indices */
-            pData->wIdx++;
-            pData->rIdx++;
-            if (pData->wIdx >= NUM_DISPLAY_TIME_SLOTS){
-                pData->wIdx = 0;
-                pData->storeIdx = pData->storeIdx == 0 ? 1 : 0;
-            }
-            if (pData->rIdx >= NUM_DISPLAY_TIME_SLOTS)
-                pData->rIdx = 0;
-#endif
-        }
+        ambi_drc_applyGainsTF(pData, (const float_complex*)pData->inputFrameTF, MAX_NUM_SH_SIGNALS*TIME_SLOTS,
+                              (float_complex*)pData->outputFrameTF, MAX_NUM_SH_SIGNALS*TIME_SLOTS, pData->nSH);
        
         /* Inverse time-frequency transform */
         for(t = 0; t < TIME_SLOTS; t++) {
-            for (ch = 0; ch < pData->nSH; ch++) {
-                for (band = 0; band < HYBRID_BANDS; band++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->outputFrameTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->outputFrameTF[band][ch][t]);
-                }
-            }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for(ch = 0; ch < MIN(pData->nSH, nCh); ch++)
+            afSTFTinversePlanar(pData->hSTFT, &(pData->outputFrameTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS, pData->tempHopFrameTD);
+            for(ch = 0; ch < MIN(pData->nSH, nOutputs); ch++)
                 utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
-            for (; ch < nCh; ch++)
+            for (; ch < nOutputs; ch++)
                 memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
         }
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
     else {
-        for (ch=0; ch < nCh; ch++)
+        for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
+}
+
+int ambi_drc_processTF
+(
+    void*  const hAmbi,
+    const float* inTF,
+    float* outTF,
+    int nInputs,
+    int maxNumOutputs,
+    int nBands,
+    int nTimeSlots
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int band, nSH, nSH_in;
+    float_complex* pOutTF;
+    
+    /* reinitialise if needed (the afSTFT is also created, but is not used here) */
+    if(pData->reInitTFT==1){
+        pData->reInitTFT = 2;
+        ambi_drc_initTFT(hAmbi);
+        pData->reInitTFT = 0;
+    }
+    if(pData->reInitTFT!=0){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return 0;
+    }
+    if(nBands!=HYBRID_BANDS || nTimeSlots!=TIME_SLOTS)
+        return 0;
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* the channels that are missing from the input are left as zeros */
+    nSH = MIN(pData->nSH, maxNumOutputs);
+    nSH_in = MIN(nSH, nInputs);
+    pOutTF = (float_complex*)outTF;
+    if(nSH_in<nSH)
+        for(band=0; band<HYBRID_BANDS; band++)
+            memset(&(pOutTF[(band*nSH + nSH_in)*TIME_SLOTS]), 0, (nSH-nSH_in)*TIME_SLOTS*sizeof(float_complex));
+    if(nSH_in>0)
+        ambi_drc_applyGainsTF(pData, (const float_complex*)inTF, nInputs*TIME_SLOTS, pOutTF, nSH*TIME_SLOTS, nSH_in);
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    return nSH;
+}
+
+/**
+ * Processes a block of any length directly in the time-domain (i.e. without the
+ * FIFO or afSTFT, and therefore without any added latency)
+ *
+ * The signals are divided into octave bands with the IIR filterbank, in
+ * sub-blocks of up to HOP_SIZE samples. One gain factor per band and sub-block
+ * is computed from the mean power of the omni band (using the same gain
+ * computer and peak detector as the afSTFT path, with the time constants
+ * scaled to the sub-block length), which is ramped to linearly over the
+ * sub-block; and the bands are then summed back together.
+ */
+static void ambi_drc_processTD
+(
+    void*   const hAmbi,
+    float** const inputs,
+    float** const outputs,
+    int nCh,
+    int nSamples
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int s, i, ch, k, band, len, nSH;
+    float cdB, alpha_a_len, alpha_r_len;
+    float makeup, boost, theshold, ratio, knee, pwr, gain, gainStep;
+    float* inPtrs[MAX_NUM_SH_SIGNALS];
+    float* bandPtrs[AMBI_DRC_TD_NUM_BANDS][MAX_NUM_SH_SIGNALS];
+    float** bands[AMBI_DRC_TD_NUM_BANDS];
+    
+    /* reinitialise if needed */
+    if(pData->reInitTFT==1){
+        pData->reInitTFT = 2;
+        ambi_drc_initTFT(hAmbi);
+        pData->reInitTFT = 0;
+    }
+    if(pData->reInitTFT!=0){
+        for (ch=0; ch < nCh; ch++)
+            memset(outputs[ch], 0, nSamples*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return;
+    }
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* prep */
+    nSH = pData->nSH;
+    ambi_drc_updateCoeffs(hAmbi);
+    boost = pData->boost;
+    makeup = pData->makeup;
+    theshold = pData->theshold;
+    ratio = pData->ratio;
+    knee = pData->knee;
+    for(ch=0; ch<nSH; ch++)
+        inPtrs[ch] = pData->inputFrameTD[ch];
+    for(k=0; k<AMBI_DRC_TD_NUM_BANDS; k++){
+        for(ch=0; ch<nSH; ch++)
+            bandPtrs[k][ch] = pData->bandsTD[k][ch];
+        bands[k] = bandPtrs[k];
     }
+    
+    for(s=0; s<nSamples; s+=len){
+        len = MIN(nSamples-s, HOP_SIZE);
+        
+        /* load this sub-block (with the input boost), and split it into bands */
+        for(ch=0; ch < MIN(nSH, nCh); ch++)
+            utility_svsmul(&(inputs[ch][s]), &boost, len, pData->inputFrameTD[ch]);
+        for(; ch<nSH; ch++)
+            memset(pData->inputFrameTD[ch], 0, len * sizeof(float));
+        IIRFilterbank_apply(pData->hFB, inPtrs, bands, nSH, len);
+        
+        /* the gain factor for each band, based on its omni component */
+        alpha_a_len = len==HOP_SIZE ? pData->alpha_a : powf(pData->alpha_a, (float)len/(float)HOP_SIZE);
+        alpha_r_len = len==HOP_SIZE ? pData->alpha_r : powf(pData->alpha_r, (float)len/(float)HOP_SIZE);
+        for(k=0; k<AMBI_DRC_TD_NUM_BANDS; k++){
+            pwr = 0.0f;
+            for(i=0; i<len; i++)
+                pwr += pData->bandsTD[k][0/* omni */][i] * pData->bandsTD[k][0][i];
+            pData->pwr[k] = pwr/(float)len;
+        }
+        ambi_drc_computeGains(pData->pwr, AMBI_DRC_TD_NUM_BANDS, theshold, ratio, knee, alpha_a_len, alpha_r_len,
+                              pData->yL_z1_td, pData->gains);
+        for(ch=0; ch<nSH; ch++)
+            memset(pData->inputFrameTD[ch], 0, len * sizeof(float));
+        for(k=0; k<AMBI_DRC_TD_NUM_BANDS; k++){
+            cdB = pData->gains[k];
+            
+            /* apply the gain (ramped from that of the previous sub-block) to
+             * all SH components, and sum the bands back together (into
+             * inputFrameTD, which is no longer needed) */
+            gainStep = (cdB*makeup - pData->gain_z1_td[k])/(float)len;
+            for(ch=0; ch<nSH; ch++){
+                gain = pData->gain_z1_td[k];
+                for(i=0; i<len; i++){
+                    gain += gainStep;
+                    pData->inputFrameTD[ch][i] += gain * pData->bandsTD[k][ch][i];
+                }
+            }
+            pData->gain_z1_td[k] = cdB*makeup;
+        }
+        
+#ifdef ENABLE_TF_DISPLAY
+        /* store gain factors in circular buffer for plotting */
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            cdB = pData->gain_z1_td[pData->hybridBand2tdBand[band]]/makeup;
+            if(pData->storeIdx==0)
+                pData->gainsTF_bank0[band][pData->wIdx] = cdB;
+            else
+                pData->gainsTF_bank1[band][pData->wIdx] = cdB;
+        }
+        pData->wIdx++;
+        pData->rIdx++;
+        if (pData->wIdx >= NUM_DISPLAY_TIME_SLOTS){
+            pData->wIdx = 0;
+            pData->storeIdx = pData->storeIdx == 0 ? 1 : 0;
+        }
+        if (pData->rIdx >= NUM_DISPLAY_TIME_SLOTS)
+            pData->rIdx = 0;
+#endif
+        
+        /* copy to output */
+        for(ch = 0; ch < MIN(nSH, nCh); ch++)
+            utility_svvcopy(pData->inputFrameTD[ch], len, &(outputs[ch][s]));
+        for (; ch < nCh; ch++)
+            memset(&(outputs[ch][s]), 0, len*sizeof(float));
+    }
+    saf_telemetry_frameEnd(pData->hTelemetry);
+}
+
+/**
+ * Switches between the time-domain and afSTFT paths (if needed), and returns
+ * 1 if the time-domain path is to be used, or 0 otherwise
+ */
+static int ambi_drc_selectPath
+(
+    ambi_drc_data* pData
+)
+{
+    int k;
+    
+    /* the time-domain path starts from cleared states; as does the afSTFT
+     * path, when switching back to it */
+    if(pData->enableTDpath){
+        if(!pData->tdPathActive){
+            IIRFilterbank_reset(pData->hFB);
+            memset(pData->yL_z1_td, 0, AMBI_DRC_TD_NUM_BANDS * sizeof(float));
+            for(k=0; k<AMBI_DRC_TD_NUM_BANDS; k++)
+                pData->gain_z1_td[k] = powf(10.0f, pData->outGain / 20.0f);
+            pData->tdPathActive = 1;
+        }
+        return 1;
+    }
+    if(pData->tdPathActive){
+        saf_fifo_flush(pData->hFIFO);
+        if(pData->hSTFT!=NULL)
+            afSTFTclearBuffers(pData->hSTFT);
+        pData->tdPathActive = 0;
+    }
+    return 0;
+}
+
+void ambi_drc_process
+(
+    void*   const hAmbi,
+    float** const inputs,
+    float** const outputs,
+    int nCh,
+    int nSamples
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    if(ambi_drc_selectPath(pData))
+        ambi_drc_processTD(hAmbi, inputs, outputs, nCh, nSamples);
+    else
+        saf_fifo_process(pData->hFIFO, inputs, outputs, nCh, nCh, nSamples, &ambi_drc_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void ambi_drc_processInterleaved
+(
+    void*   const hAmbi,
+    const float* inputs,
+    float* outputs,
+    int nCh,
+    int nSamples
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int s, t, ch, len, nChTD;
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* the time-domain path works on the host blocks directly, so these are
+     * passed through planar buffers, in chunks of up to FRAME_SIZE */
+    if(ambi_drc_selectPath(pData)){
+        nChTD = MIN(nCh, MAX_NUM_SH_SIGNALS);
+        for(s=0; s<nSamples; s+=len){
+            len = MIN(nSamples-s, FRAME_SIZE);
+            for(t=0; t<len; t++)
+                for(ch=0; ch<nChTD; ch++)
+                    pData->planarInTD[ch][t] = inputs[(s+t)*nCh+ch];
+            ambi_drc_processTD(hAmbi, pData->planarInTD, pData->planarOutTD, nChTD, len);
+            for(t=0; t<len; t++){
+                for(ch=0; ch<nChTD; ch++)
+                    outputs[(s+t)*nCh+ch] = pData->planarOutTD[ch][t];
+                for(; ch<nCh; ch++)
+                    outputs[(s+t)*nCh+ch] = 0.0f;
+            }
+        }
+    }
+    else
+        saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nCh, nCh, nSamples, &ambi_drc_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples of all of the stems (and of the
+ * sidechain); called by the multi-stem FIFO once a full frame of input samples
+ * has been collected
+ */
+static void ambi_drc_processFrameMultiStem
+(
+    void*   const hAmbi,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int t, s, ch, band, nSH, nStemCh;
+    float g, pwr, boost, makeup;
+    float w2[AMBI_DRC_MAX_NUM_STEMS];
+    float_complex X;
+    float_complex* stemsTF;
+    
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* prep */
+    nSH = pData->stemsNSH;
+    nStemCh = pData->nStems * nSH;
+    stemsTF = pData->stemsFrameTF;
+    ambi_drc_updateCoeffs(hAmbi);
+    boost = pData->boost;
+    makeup = pData->makeup;
+    for(s=0; s<pData->nStems; s++)
+        w2[s] = boost*boost * pData->stemWeights[s]*pData->stemWeights[s];
+    
+    /* Apply time-frequency transform (to the sidechain only if it is used) */
+    for(t=0; t< TIME_SLOTS; t++) {
+        for(ch = 0; ch < nStemCh; ch++)
+            utility_svvcopy(&(inputs[ch][t*HOP_SIZE]), HOP_SIZE, pData->stemsHopTD[ch]);
+        afSTFTforwardPlanar(pData->hSTFT_ms, pData->stemsHopTD, &(stemsTF[t]), nStemCh*TIME_SLOTS, TIME_SLOTS);
+        if(pData->scActive){
+            utility_svvcopy(&(inputs[nStemCh][t*HOP_SIZE]), HOP_SIZE, pData->scHopTD[0]);
+            afSTFTforwardPlanar(pData->hSTFT_sc, pData->scHopTD, &(pData->scFrameTF[t]), TIME_SLOTS, TIME_SLOTS);
+        }
+    }
+    
+    /* One set of gain factors per time slot, based on the (boosted) sidechain,
+     * or on the weighted power sum of the omni components of the stems; which
+     * are then applied to all of the SH components of all of the stems */
+    for (t = 0; t < TIME_SLOTS; t++) {
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            if(pData->scActive){
+                X = pData->scFrameTF[band*TIME_SLOTS + t];
+                pwr = boost*boost * (crealf(X)*crealf(X) + cimagf(X)*cimagf(X));
+            }
+            else{
+                pwr = 0.0f;
+                for(s=0; s<pData->nStems; s++){
+                    X = stemsTF[band*nStemCh*TIME_SLOTS + (s*nSH/* omni */)*TIME_SLOTS + t];
+                    pwr += w2[s] * (crealf(X)*crealf(X) + cimagf(X)*cimagf(X));
+                }
+            }
+            pData->pwr[band] = pwr;
+        }
+        ambi_drc_computeGains(pData->pwr, HYBRID_BANDS, pData->theshold, pData->ratio, pData->knee, pData->alpha_a,
+                              pData->alpha_r, pData->yL_z1_ms, pData->gains);
+#ifdef ENABLE_TF_DISPLAY
+        ambi_drc_storeGainsTF(pData, pData->gains);
+#endif
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            g = boost*pData->gains[band]*makeup;
+            for (ch = 0; ch < nStemCh; ch++)
+                stemsTF[band*nStemCh*TIME_SLOTS + ch*TIME_SLOTS + t] = crmulf(stemsTF[band*nStemCh*TIME_SLOTS + ch*TIME_SLOTS + t], g);
+        }
+    }
+    
+    /* Inverse time-frequency transform */
+    for(t = 0; t < TIME_SLOTS; t++) {
+        afSTFTinversePlanar(pData->hSTFT_ms, &(stemsTF[t]), nStemCh*TIME_SLOTS, TIME_SLOTS, pData->stemsHopTD);
+        for(ch = 0; ch < MIN(nStemCh, nOutputs); ch++)
+            utility_svvcopy(pData->stemsHopTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+    }
+    saf_telemetry_frameEnd(pData->hTelemetry);
+}
+
+void ambi_drc_processMultiStem
+(
+    void*    const hAmbi,
+    float*** const inputs,
+    float*** const outputs,
+    float*   const sidechain,
+    int nStems,
+    int nCh,
+    int nSamples
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int s, ch, n, len, nSH, nStemCh;
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* reinitialise if needed (the stems are allocated for the current number
+     * of SH signals) */
+    if(pData->reInitTFT==1){
+        pData->reInitTFT = 2;
+        ambi_drc_initTFT(hAmbi);
+        pData->reInitTFT = 0;
+    }
+    if(pData->reInitTFT==0 && (pData->reInitStems==1 || pData->stemsNSH!=pData->nSH)){
+        pData->reInitStems = 2;
+        ambi_drc_initStems(hAmbi);
+        pData->scActive = 0;
+        pData->reInitStems = 0;
+    }
+    if(pData->reInitTFT!=0 || pData->reInitStems!=0){
+        for(s=0; s<nStems; s++)
+            for (ch=0; ch < nCh; ch++)
+                memset(outputs[s][ch], 0, nSamples*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        saf_blasThreads_end(blasState);
+        saf_denormals_guardEnd(fpState);
+        return;
+    }
+    
+    /* the sidechain starts from a cleared state, when it is (re-)connected */
+    if(sidechain!=NULL && !pData->scActive)
+        afSTFTclearBuffers(pData->hSTFT_sc);
+    pData->scActive = sidechain!=NULL ? 1 : 0;
+    
+    /* The stems are passed through the FIFO in chunks of up to FRAME_SIZE, so
+     * that any missing channels may be replaced with the zero/dummy buffers */
+    nSH = pData->stemsNSH;
+    nStemCh = pData->nStems * nSH;
+    for(n=0; n<nSamples; n+=len){
+        len = MIN(nSamples-n, FRAME_SIZE);
+        for(s=0; s<pData->nStems; s++){
+            for(ch=0; ch<nSH; ch++){
+                pData->stemsInPtrs[s*nSH+ch] = s<nStems && ch<nCh ? &(inputs[s][ch][n]) : pData->stemsZeros;
+                pData->stemsOutPtrs[s*nSH+ch] = s<nStems && ch<nCh ? &(outputs[s][ch][n]) : pData->stemsDummy;
+            }
+        }
+        pData->stemsInPtrs[nStemCh] = sidechain!=NULL ? &(sidechain[n]) : pData->stemsZeros;
+        saf_fifo_process(pData->hFIFO_ms, pData->stemsInPtrs, pData->stemsOutPtrs, nStemCh+1, nStemCh, len,
+                         &ambi_drc_processFrameMultiStem, hAmbi);
+    }
+    
+    /* channels/stems beyond those processed */
+    for(s=0; s<nStems; s++)
+        for(ch = s<pData->nStems ? nSH : 0; ch<nCh; ch++)
+            memset(outputs[s][ch], 0, nSamples*sizeof(float));
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 /* SETS */
@@ -347,6 +837,27 @@ void ambi_drc_setInputPreset(void* const hAmbi, AMBI_DRC_INPUT_ORDER newPreset)
         pData->norm = NORM_SN3D;
 }
 
+void ambi_drc_setEnableTimeDomainPath(void* const hAmbi, int newState)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    pData->enableTDpath = newState ? 1 : 0;
+}
+
+
+void ambi_drc_setNumStems(void* const hAmbi, int newValue)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    pData->new_nStems = CLAMP(newValue, 1, AMBI_DRC_MAX_NUM_STEMS);
+    if(pData->new_nStems != pData->nStems)
+        pData->reInitStems = 1;
+}
+
+void ambi_drc_setStemWeight(void* const hAmbi, int stemIndex, float newValue)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    if(stemIndex>=0 && stemIndex<AMBI_DRC_MAX_NUM_STEMS)
+        pData->stemWeights[stemIndex] = MAX(newValue, 0.0f);
+}
 
 /* GETS */
 
@@ -452,8 +963,35 @@ int ambi_drc_getSamplerate(void* const hAmbi)
     return (int)(pData->fs+0.5f);
 }
 
-int ambi_drc_getProcessingDelay()
+int ambi_drc_getEnableTimeDomainPath(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    return pData->enableTDpath;
+}
+
+int ambi_drc_getNumStems(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    return pData->new_nStems;
+}
+
+float ambi_drc_getStemWeight(void* const hAmbi, int stemIndex)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    if(stemIndex>=0 && stemIndex<AMBI_DRC_MAX_NUM_STEMS)
+        return pData->stemWeights[stemIndex];
+    return 0.0f;
+}
+
+int ambi_drc_getProcessingDelay(void* const hAmbi)
 {
-    return 12*HOP_SIZE;
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    return pData->tdPathActive ? 0 : saf_fifo_getLatency(pData->hFIFO) + 12*HOP_SIZE;
+}
+
+void* ambi_drc_getTelemetry(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    return pData->hTelemetry;
 }
 
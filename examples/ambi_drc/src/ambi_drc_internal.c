@@ -42,45 +42,72 @@
 /* Adapted from:
  * D. Giannoulis, M. Massberg, and J. D. Reiss, “Digital dynamic range compressor design: Tutorial and analysis,”
  * Journal of the Audio Engineering Society, vol. 60, no. 6, pp. 399–408, June 2012. */
-float ambi_drc_gainComputer
+void ambi_drc_computeGains
 (
-    float xG,
+    float* pwr,
+    int nBands,
     float T,
     float R,
-    float W
+    float W,
+    float alpha_a,
+    float alpha_r,
+    float* yL_z1,
+    float* gains
 )
 {
-    float yG;
-    if (2.0f*(xG - T) < -W)
-        yG = xG;
-    else if (2.0f*(fabsf(xG - T)) <= W)
-        yG = xG + (1.0f / R - 1.0f) * powf(xG - T + W / 2.0f, 2.0f) / (2.0f*W);
-    else if (2.0f*(xG - T) > W)
-        yG = T + (xG - T) / R;
-    else
-        yG = 0.0f;
-
-    return yG;
+    int band;
+    float d, yG_knee, yG_comp, yG, xL, yL, alpha, kneeScale, invR;
+    float xG[HYBRID_BANDS];
+    
+    assert(nBands<=HYBRID_BANDS);
+    
+    /* xG = 10*log10(pwr) */
+    for(band=0; band<nBands; band++)
+        pwr[band] += 2e-13f;
+    utility_svlog2approx(pwr, nBands, xG);
+    
+    /* gain computer, and smooth peak detector */
+    invR = 1.0f/R;
+    kneeScale = W > 0.0f ? (invR - 1.0f) / (2.0f*W) : 0.0f;
+    for(band=0; band<nBands; band++){
+        xG[band] *= 3.010299957f; /* 10*log10(2) */
+        d = xG[band] - T;
+        yG_knee = xG[band] + kneeScale * (d + W/2.0f) * (d + W/2.0f);
+        yG_comp = T + d * invR;
+        yG = 2.0f*d < -W ? xG[band] : (2.0f*fabsf(d) <= W && W > 0.0f ? yG_knee : yG_comp);
+        xL = xG[band] - yG;
+        alpha = xL > yL_z1[band] ? alpha_a : alpha_r;
+        yL = alpha*yL_z1[band] + (1.0f - alpha) * xL;
+        yL_z1[band] = yL;
+        
+        /* sqrt(10^(-yL/20)) = 2^(-yL*log2(10)/40) */
+        gains[band] = -0.0830482024f * yL;
+    }
+    utility_svexp2approx(gains, nBands, gains);
+    for(band=0; band<nBands; band++)
+        gains[band] = MAX(SPECTRAL_FLOOR, gains[band]);
 }
 
-/* Adapted from:
- * D. Giannoulis, M. Massberg, and J. D. Reiss, “Digital dynamic range compressor design: Tutorial and analysis,”
- * Journal of the Audio Engineering Society, vol. 60, no. 6, pp. 399–408, June 2012. */
-float ambi_drc_smoothPeakDetector
+void ambi_drc_updateCoeffs
 (
-    float xL,
-    float yL_z1,
-    float alpha_a,
-    float alpha_r
+    void* const hAmbi
 )
 {
-    float yL;
-    if (xL > yL_z1)
-        yL = alpha_a*yL_z1 + (1.0f - alpha_a) * xL;
-    else
-        yL = alpha_r*yL_z1 + (1.0f - alpha_r) * xL;
-
-    return yL;
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    float pars[5];
+    
+    pars[0] = pData->attack_ms;
+    pars[1] = pData->release_ms;
+    pars[2] = pData->fs;
+    pars[3] = pData->inGain;
+    pars[4] = pData->outGain;
+    if(memcmp(pars, pData->coeffs_pars, 5*sizeof(float))!=0){
+        pData->alpha_a = expf(-1.0f / ( (pars[0] / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pars[2] * 0.001f));
+        pData->alpha_r = expf(-1.0f / ( (pars[1] / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pars[2] * 0.001f));
+        pData->boost = powf(10.0f, pars[3] / 20.0f);
+        pData->makeup = powf(10.0f, pars[4] / 20.0f);
+        memcpy(pData->coeffs_pars, pars, 5*sizeof(float));
+    }
 }
 
 void ambi_drc_initTFT
@@ -90,14 +117,55 @@ void ambi_drc_initTFT
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
 
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    
     /* Initialise afSTFT */
     if (pData->hSTFT == NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSH, pData->new_nSH, 0, 1);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSH, pData->new_nSH, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     else if(pData->nSH!=pData->new_nSH){/* Or change the number of channels */
         afSTFTchannelChange(pData->hSTFT, pData->new_nSH, pData->new_nSH);
         afSTFTclearBuffers(pData->hSTFT);
     }
     pData->nSH = pData->new_nSH; 
+    saf_telemetry_reinitEnd(pData->hTelemetry);
+}
+
+void ambi_drc_initStems
+(
+    void* const hAmbi
+)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    int nStemCh;
+    
+    nStemCh = pData->new_nStems * pData->nSH;
+
+    /* afSTFTs */
+    if (pData->hSTFT_ms == NULL){
+        afSTFTinit(&(pData->hSTFT_ms), HOP_SIZE, nStemCh, nStemCh, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+        afSTFTinit(&(pData->hSTFT_sc), HOP_SIZE, 1, 0, 0, 1, 1);
+    }
+    else{
+        if(pData->nStems*pData->stemsNSH != nStemCh)
+            afSTFTchannelChange(pData->hSTFT_ms, nStemCh, nStemCh);
+        afSTFTclearBuffers(pData->hSTFT_ms);
+        afSTFTclearBuffers(pData->hSTFT_sc);
+    }
+    
+    /* FIFO and buffers */
+    saf_fifo_destroy(&(pData->hFIFO_ms));
+    saf_fifo_create(&(pData->hFIFO_ms), FRAME_SIZE, nStemCh+1, nStemCh);
+    free(pData->stemsFrameTF);
+    free(pData->stemsHopTD);
+    pData->stemsFrameTF = (float_complex*)malloc1d(HYBRID_BANDS*nStemCh*TIME_SLOTS*sizeof(float_complex));
+    pData->stemsHopTD = (float**)malloc2d(nStemCh, HOP_SIZE, sizeof(float));
+    if(pData->scFrameTF == NULL){
+        pData->scFrameTF = (float_complex*)malloc1d(HYBRID_BANDS*TIME_SLOTS*sizeof(float_complex));
+        pData->scHopTD = (float**)malloc2d(1, HOP_SIZE, sizeof(float));
+    }
+    memset(pData->yL_z1_ms, 0, HYBRID_BANDS * sizeof(float));
+    pData->nStems = pData->new_nStems;
+    pData->stemsNSH = pData->nSH;
 }
 
 void ambi_drc_setInputOrder(AMBI_DRC_INPUT_ORDER inOrder, int* nSH)
@@ -60,12 +60,14 @@ extern "C" {
 typedef struct _ambi_drc
 {    
     /* audio buffers and afSTFT handle */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
+    float** planarInTD;  /**< planar input chunk, for interleaved time-domain path processing; MAX_NUM_SH_SIGNALS x FRAME_SIZE */
+    float** planarOutTD; /**< planar output chunk, for interleaved time-domain path processing; MAX_NUM_SH_SIGNALS x FRAME_SIZE */
     float inputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE]; 
     float_complex inputFrameTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
     float_complex outputFrameTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
     void* hSTFT; 
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;    
     float** tempHopFrameTD;
     float freqVector[HYBRID_BANDS];
 
@@ -73,8 +75,45 @@ typedef struct _ambi_drc
     int nSH, new_nSH;
     float fs;
     float yL_z1[HYBRID_BANDS];
+    float pwr[HYBRID_BANDS];    /**< omni power per band, of the current time slot */
+    float gains[HYBRID_BANDS];  /**< gain factors per band, of the current time slot */
+    
+    /* coefficients, cached until the parameters change (see ambi_drc_updateCoeffs()) */
+    float alpha_a, alpha_r;     /**< attack/release coefficients, per time slot (HOP_SIZE samples) */
+    float boost, makeup;        /**< input/output gains, linear */
+    float coeffs_pars[5];       /**< attack_ms, release_ms, fs, inGain and outGain, for which the above were computed */
     int reInitTFT; /**< 0: no init required, 1: init required, 2: init in progress */
 
+    /* time-domain path (octave bands, without the afSTFT) */
+    void* hFB;                         /**< IIRFilterbank handle */
+    float fbCutoffFreqs[AMBI_DRC_TD_NUM_BANDS-1]; /**< crossover frequencies, Hz */
+    float bandsTD[AMBI_DRC_TD_NUM_BANDS][MAX_NUM_SH_SIGNALS][HOP_SIZE]; /**< band signals of the current sub-block */
+    float yL_z1_td[AMBI_DRC_TD_NUM_BANDS]; /**< peak detector states, per octave band */
+    float gain_z1_td[AMBI_DRC_TD_NUM_BANDS]; /**< gains applied at the end of the previous sub-block */
+    int hybridBand2tdBand[HYBRID_BANDS]; /**< octave band in which each afSTFT band lies (for the display) */
+    int tdPathActive;                  /**< 1: the time-domain path was used for the last block, 0: the afSTFT path */
+
+    /* multi-stem processing (see ambi_drc_processMultiStem()). Stem 's',
+     * channel 'ch', is channel s*stemsNSH+ch of the FIFO/afSTFT, and the
+     * sidechain is the last FIFO input channel */
+    void* hFIFO_ms;                    /**< FIFO handle; nStems*stemsNSH+1 inputs, nStems*stemsNSH outputs */
+    void* hSTFT_ms;                    /**< afSTFT handle of the stems; nStems*stemsNSH channels */
+    void* hSTFT_sc;                    /**< afSTFT handle of the sidechain; 1 input channel */
+    float_complex* stemsFrameTF;       /**< FLAT: HYBRID_BANDS x nStems*stemsNSH x TIME_SLOTS */
+    float_complex* scFrameTF;          /**< FLAT: HYBRID_BANDS x TIME_SLOTS */
+    float** stemsHopTD;                /**< nStems*stemsNSH x HOP_SIZE */
+    float** scHopTD;                   /**< 1 x HOP_SIZE */
+    float* stemsInPtrs[AMBI_DRC_MAX_NUM_STEMS*MAX_NUM_SH_SIGNALS+1];  /**< input channel pointers passed to the FIFO */
+    float* stemsOutPtrs[AMBI_DRC_MAX_NUM_STEMS*MAX_NUM_SH_SIGNALS];   /**< output channel pointers passed to the FIFO */
+    float stemsZeros[FRAME_SIZE];      /**< in place of the channels which are not given */
+    float stemsDummy[FRAME_SIZE];      /**< in place of the channels which are not wanted */
+    float yL_z1_ms[HYBRID_BANDS];      /**< peak detector states of the shared detector */
+    float stemWeights[AMBI_DRC_MAX_NUM_STEMS]; /**< detector weight of each stem */
+    int nStems, new_nStems;            /**< current (0: nothing allocated yet) and requested number of stems */
+    int stemsNSH;                      /**< number of SH signals per stem, with which the above were allocated */
+    int scActive;                      /**< 1: the sidechain drives the detector, 0: the stems */
+    int reInitStems;                   /**< 0: no init required, 1: init required, 2: init in progress */
+
 #ifdef ENABLE_TF_DISPLAY
     int wIdx, rIdx;
     int storeIdx;
@@ -87,6 +126,7 @@ typedef struct _ambi_drc
     AMBI_DRC_CH_ORDER chOrdering;
     AMBI_DRC_NORM_TYPES norm;
     AMBI_DRC_INPUT_ORDER currentOrder;
+    int enableTDpath;  /**< 1: use the time-domain path, 0: the afSTFT */
     
 } ambi_drc_data;
      
@@ -95,15 +135,63 @@ typedef struct _ambi_drc
 /*                             Internal Functions                             */
 /* ========================================================================== */
 
-float ambi_drc_gainComputer(float xG, float T, float R, float W);
+/**
+ * Computes the gain factors for a number of bands at once, from the power of
+ * their omni components [1,2]
+ *
+ * The input power is converted to dB, and passed through the gain computer
+ * (threshold 'T', ratio 'R', knee width 'W') and the smooth peak detector
+ * (with the attack/release coefficients); and the gain factors are then
+ * sqrt(10^(-yL/20)), limited to SPECTRAL_FLOOR. The conversions to/from dB use
+ * utility_svlog2approx() and utility_svexp2approx(), and the rest is
+ * branchless.
+ *
+ * @param[in,out] pwr     Power of the omni component, per band (overwritten);
+ *                        nBands x 1
+ * @param[in]     nBands  Number of bands (at most HYBRID_BANDS)
+ * @param[in]     T       Threshold, dB
+ * @param[in]     R       Ratio
+ * @param[in]     W       Knee width, dB
+ * @param[in]     alpha_a Attack coefficient
+ * @param[in]     alpha_r Release coefficient
+ * @param[in,out] yL_z1   Peak detector states; nBands x 1
+ * @param[out]    gains   Gain factors; nBands x 1
+ *
+ * @see [1] D. Giannoulis, M. Massberg, and J. D. Reiss, "Digital dynamic range
+ *          compressor design: Tutorial and analysis," Journal of the Audio
+ *          Engineering Society, vol. 60, no. 6, pp. 399–408, June 2012.
+ * @see [2] McCormack, L., & Välimäki, V. (2017). "FFT-Based Dynamic Range
+ *          Compression". in Proceedings of the 14th Sound and Music Computing
+ *          Conference, July 5-8, Espoo, Finland.
+ */
+void ambi_drc_computeGains(float* pwr,
+                           int nBands,
+                           float T,
+                           float R,
+                           float W,
+                           float alpha_a,
+                           float alpha_r,
+                           float* yL_z1,
+                           float* gains);
 
-float ambi_drc_smoothPeakDetector(float xL, float yL_z1, float alpha_a, float alpha_r);
+/**
+ * Recomputes the attack/release coefficients and the input/output gains, if
+ * any of the parameters they depend on have changed since the last call
+ */
+void ambi_drc_updateCoeffs(void* const hAmbi);
     
 /**
  * Initialise the filterbank used by ambi_drc.
  */
 void ambi_drc_initTFT(void* const hAmbi);
 
+/**
+ * (Re)allocates the FIFO, afSTFTs and buffers used by
+ * ambi_drc_processMultiStem(), for the requested number of stems and the
+ * current number of SH signals
+ */
+void ambi_drc_initStems(void* const hAmbi);
+
 void ambi_drc_setInputOrder(AMBI_DRC_INPUT_ORDER inOrder, int* nSH);
 
     
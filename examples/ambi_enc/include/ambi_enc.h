@@ -146,6 +146,11 @@ void ambi_enc_init(void* const hAmbi,
  * Encodes input signals into spherical harmonic signals, at the specified
  * encoding directions.
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in ambi_enc_getProcessingDelay()
+ *
  * @param[in] hAmbi    Ambi_enc handle
  * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
@@ -160,6 +165,23 @@ void ambi_enc_process(void* const hAmbi,
                       int nOutputs,
                       int nSamples);
 
+/**
+ * Same as ambi_enc_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hAmbi    ambi_enc handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void ambi_enc_processInterleaved(void* const hAmbi,
+                                 const float* inputs,
+                                 float* outputs,
+                                 int nInputs,
+                                 int nOutputs,
+                                 int nSamples);
+
     
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -269,6 +291,20 @@ int ambi_enc_getChOrder(void* const hAmbi);
  */
 int ambi_enc_getNormType(void* const hAmbi);
 
+/**
+ * Returns the processing delay in samples (may be used for delay compensation
+ * features), which includes the latency of the internal FIFO, if any (i.e. if
+ * the host block size is not a multiple of FRAME_SIZE)
+ */
+int ambi_enc_getProcessingDelay(void* const hAmbi);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed, and time taken per frame); see
+ * saf_telemetry_getSnapshot()
+ */
+void* ambi_enc_getTelemetry(void* const hAmbi);
+
 
 #ifdef __cplusplus
 } /* extern "C" { */
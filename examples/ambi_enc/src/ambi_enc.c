@@ -43,6 +43,10 @@ void ambi_enc_create
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
     pData->order = OUTPUT_ORDER_FIRST;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_INPUTS, MAX_NUM_SH_SIGNALS);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void ambi_enc_destroy
@@ -53,6 +57,8 @@ void ambi_enc_destroy
     ambi_enc_data *pData = (ambi_enc_data*)(*phAmbi);
     
     if (pData != NULL) {
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
         free(pData);
         pData = NULL;
     }
@@ -69,134 +75,192 @@ void ambi_enc_init
     
     pData->fs = (float)sampleRate;
     for(i=1; i<=FRAME_SIZE; i++)
-        pData->interpolator[i-1] = (float)i*1.0f/(float)FRAME_SIZE;
-    memset(pData->prev_Y, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float));
+        pData->rampDown[i-1] = 1.0f - (float)i*1.0f/(float)FRAME_SIZE;
+    memset(pData->Y, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_INPUTS*sizeof(float));
+    memset(pData->prev_Y, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_INPUTS*sizeof(float));
     memset(pData->prev_inputFrameTD, 0, MAX_NUM_INPUTS*FRAME_SIZE*sizeof(float));
     for(i=0; i<MAX_NUM_INPUTS; i++)
         pData->recalc_SH_FLAG[i] = 1;
 }
 
-void ambi_enc_process
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void ambi_enc_processFrame
 (
     void  *  const hAmbi,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int i, j, ch, n, nSources, nSH;
-    int o[MAX_ORDER+2];
-    float src_dirs[MAX_NUM_INPUTS][2], azi_incl[2], scale;
-    float* Y_src;
+    int i, j, k, ch, n, nSources, nSH, nRecalc, nMoving;
+    int o[MAX_ORDER+2], recalcIdx[MAX_NUM_INPUTS];
+    float src_dirs[MAX_NUM_INPUTS][2], scale;
     AMBI_ENC_CH_ORDER chOrdering;
     AMBI_ENC_NORM_TYPES norm;
     int order;
     
-    if (nSamples == FRAME_SIZE) {
-        /* prep */
-        for(n=0; n<MAX_ORDER+2; n++){  o[n] = n*n;  }
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
-        nSources = pData->nSources;
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
-        order = MIN(pData->order, MAX_ORDER);
-        nSH = (order+1)*(order+1);
-        Y_src = malloc1d(nSH*sizeof(float));
-        
-        /* Load time-domain data */
-        for(i=0; i < MIN(nSources,nInputs); i++)
-            utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
-        for(; i<MAX_NUM_INPUTS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
-
-        /* recalulate SHs */
-        for(i=0; i<nSources; i++){
-            if(pData->recalc_SH_FLAG[i]){
-                azi_incl[0] = pData->src_dirs_deg[i][0]*M_PI/180.0f;
-                azi_incl[1] =  M_PI/2.0f - pData->src_dirs_deg[i][1]*M_PI/180.0f;
-                getSHreal_recur(order, azi_incl, 1, Y_src);
-                for(j=0; j<nSH; j++)
-                    pData->Y[j][i] = sqrtf(4.0f*M_PI)*Y_src[j];
-                for(; j<MAX_NUM_SH_SIGNALS; j++)
-                    pData->Y[j][i] = 0.0f;
-                pData->recalc_SH_FLAG[i] = 0;
-            }
-            else{
-                for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
-                    pData->Y[j][i] = pData->prev_Y[j][i];
-            }
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* prep */
+    for(n=0; n<MAX_ORDER+2; n++){  o[n] = n*n;  }
+    chOrdering = pData->chOrdering;
+    norm = pData->norm;
+    nSources = pData->nSources;
+    memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+    order = MIN(pData->order, MAX_ORDER);
+    nSH = (order+1)*(order+1);
+    
+    /* Load time-domain data */
+    for(i=0; i < MIN(nSources,nInputs); i++)
+        utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
+    for(; i<MAX_NUM_INPUTS; i++)
+        memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+
+    /* recalulate SHs (for all of the sources that have been moved, in one batch) */
+    for(i=0, nRecalc=0; i<nSources; i++){
+        if(pData->recalc_SH_FLAG[i]){
+            recalcIdx[nRecalc] = i;
+            pData->recalc_dirs_rad[nRecalc][0] = src_dirs[i][0]*M_PI/180.0f;
+            pData->recalc_dirs_rad[nRecalc][1] = M_PI/2.0f - src_dirs[i][1]*M_PI/180.0f;
+            pData->recalc_SH_FLAG[i] = 0;
+            nRecalc++;
         }
-        
-        /* spatially encode the input signals into spherical harmonic signals */
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSources, 1.0f,
-                    (float*)pData->prev_Y, MAX_NUM_INPUTS,
-                    (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                    (float*)pData->tempFrame, FRAME_SIZE);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSources, 1.0f,
-                    (float*)pData->Y, MAX_NUM_INPUTS,
-                    (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                    (float*)pData->outputFrameTD, FRAME_SIZE);
-        
-        for (i=0; i < nSH; i++)
-            for(j=0; j<FRAME_SIZE; j++)
-                pData->outputFrameTD[i][j] = pData->interpolator[j] * pData->outputFrameTD[i][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
-        
-        /* for next frame */
-        utility_svvcopy((const float*)pData->inputFrameTD, nSources*FRAME_SIZE, (float*)pData->prev_inputFrameTD);
-        utility_svvcopy((const float*)pData->Y, MAX_NUM_INPUTS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_Y);
-        
-        /* scale by 1/sqrt(nSources) */
-        scale = 1.0f/sqrtf((float)nSources);
-        utility_svsmul((float*)pData->outputFrameTD, &scale, nSH*FRAME_SIZE, NULL);
-
-        /* norm scheme */
-        switch(norm){
-            case NORM_N3D: /* already N3D */
-                break;
-            case NORM_SN3D:
-                for (n = 0; n<order+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->outputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
-                break;
-            case NORM_FUMA: /* only for first-order */
-                for(i = 0; i<FRAME_SIZE; i++)
-                    pData->outputFrameTD[0][i] /= sqrtf(2.0f);
-                for (ch = 1; ch<4; ch++)
-                    for(i = 0; i<FRAME_SIZE; i++)
-                        pData->outputFrameTD[ch][i] /= sqrtf(3.0f);
-                break;
+    }
+    if(nRecalc>0){
+        getSHreal_fast(order, (float*)pData->recalc_dirs_rad, nRecalc, pData->recalc_Y);
+        for(k=0; k<nRecalc; k++){
+            i = recalcIdx[k];
+            for(j=0; j<nSH; j++)
+                pData->Y[j][i] = sqrtf(4.0f*M_PI)*pData->recalc_Y[j*nRecalc+k];
+            for(; j<MAX_NUM_SH_SIGNALS; j++)
+                pData->Y[j][i] = 0.0f;
         }
-
-        /* copy SH signals to output buffer */
-        switch(chOrdering){
-            case CH_ACN:
-                for(i = 0; i < MIN(nSH,nOutputs); i++)
-                    utility_svvcopy(pData->outputFrameTD[i], FRAME_SIZE, outputs[i]);
-                for(; i < nOutputs; i++)
-                    memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
-                break;
-            case CH_FUMA: /* only for first-order */
-                if(nOutputs>=4){
-                    utility_svvcopy(pData->outputFrameTD[0], FRAME_SIZE, outputs[0]);
-                    utility_svvcopy(pData->outputFrameTD[1], FRAME_SIZE, outputs[2]);
-                    utility_svvcopy(pData->outputFrameTD[2], FRAME_SIZE, outputs[3]);
-                    utility_svvcopy(pData->outputFrameTD[3], FRAME_SIZE, outputs[1]);
-                }
-                else
-                    for(i=0; i<nOutputs; i++)
-                        memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
+    }
+    
+    /* The output is ramped from the previous to the current SH gains, i.e.:
+     *   Y*x.*interp + prev_Y*x.*(1-interp) = Y*x + (prev_Y-Y)*(x.*(1-interp))
+     * so only the sources with changed gains require the second term */
+    for(i=0, nMoving=0; i<nSources; i++){
+        for(j=0; j<nSH; j++)
+            if(pData->Y[j][i] != pData->prev_Y[j][i])
                 break;
+        if(j<nSH){
+            for(j=0; j<nSH; j++)
+                pData->delta_Y[j][nMoving] = pData->prev_Y[j][i] - pData->Y[j][i];
+            utility_svvmul(pData->prev_inputFrameTD[i], (const float*)pData->rampDown, FRAME_SIZE, pData->rampFrameTD[nMoving]);
+            nMoving++;
         }
-        free((void*)Y_src);
     }
-    else{
-        for (ch=0; ch < nOutputs; ch++)
-            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+    
+    /* spatially encode the input signals into spherical harmonic signals (and
+     * scale by 1/sqrt(nSources)) */
+    scale = 1.0f/sqrtf((float)nSources);
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSources, scale,
+                (float*)pData->Y, MAX_NUM_INPUTS,
+                (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
+                (float*)pData->outputFrameTD, FRAME_SIZE);
+    if(nMoving>0){
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nMoving, scale,
+                    (float*)pData->delta_Y, MAX_NUM_INPUTS,
+                    (float*)pData->rampFrameTD, FRAME_SIZE, 1.0f,
+                    (float*)pData->outputFrameTD, FRAME_SIZE);
     }
+    
+    /* for next frame */
+    utility_svvcopy((const float*)pData->inputFrameTD, nSources*FRAME_SIZE, (float*)pData->prev_inputFrameTD);
+    utility_svvcopy((const float*)pData->Y, MAX_NUM_INPUTS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_Y);
+
+    /* norm scheme */
+    switch(norm){
+        case NORM_N3D: /* already N3D */
+            break;
+        case NORM_SN3D:
+            for (n = 0; n<order+1; n++)
+                for (ch = o[n]; ch<o[n+1]; ch++)
+                    for(i = 0; i<FRAME_SIZE; i++)
+                        pData->outputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
+            break;
+        case NORM_FUMA: /* only for first-order */
+            for(i = 0; i<FRAME_SIZE; i++)
+                pData->outputFrameTD[0][i] /= sqrtf(2.0f);
+            for (ch = 1; ch<4; ch++)
+                for(i = 0; i<FRAME_SIZE; i++)
+                    pData->outputFrameTD[ch][i] /= sqrtf(3.0f);
+            break;
+    }
+
+    /* copy SH signals to output buffer */
+    switch(chOrdering){
+        case CH_ACN:
+            for(i = 0; i < MIN(nSH,nOutputs); i++)
+                utility_svvcopy(pData->outputFrameTD[i], FRAME_SIZE, outputs[i]);
+            for(; i < nOutputs; i++)
+                memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
+            break;
+        case CH_FUMA: /* only for first-order */
+            if(nOutputs>=4){
+                utility_svvcopy(pData->outputFrameTD[0], FRAME_SIZE, outputs[0]);
+                utility_svvcopy(pData->outputFrameTD[1], FRAME_SIZE, outputs[2]);
+                utility_svvcopy(pData->outputFrameTD[2], FRAME_SIZE, outputs[3]);
+                utility_svvcopy(pData->outputFrameTD[3], FRAME_SIZE, outputs[1]);
+            }
+            else
+                for(i=0; i<nOutputs; i++)
+                    memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
+            break;
+    }
+    saf_telemetry_frameEnd(pData->hTelemetry);
+}
+
+void ambi_enc_process
+(
+    void  *  const hAmbi,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_enc_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void ambi_enc_processInterleaved
+(
+    void  *  const hAmbi,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &ambi_enc_processFrame, hAmbi);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 /* Set Functions */
@@ -329,3 +393,14 @@ int ambi_enc_getNormType(void* const hAmbi)
     return (int)pData->norm;
 }
 
+int ambi_enc_getProcessingDelay(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    return saf_fifo_getLatency(pData->hFIFO);
+}
+
+void* ambi_enc_getTelemetry(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    return pData->hTelemetry;
+}
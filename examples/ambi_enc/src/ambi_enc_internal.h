@@ -55,15 +55,20 @@ extern "C" {
  */
 typedef struct _ambi_enc
 {
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
     float prev_inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
-    float tempFrame[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
+    float rampFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];       /**< inputs of the moving sources, multiplied by 'rampDown' */
     float outputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float fs;
     int recalc_SH_FLAG[MAX_NUM_INPUTS];
+    float recalc_dirs_rad[MAX_NUM_INPUTS][2];            /**< [azi, incl] of the sources to recalculate this frame */
+    float recalc_Y[MAX_NUM_SH_SIGNALS*MAX_NUM_INPUTS];   /**< batched SH gains of these sources; FLAT: nSH x nRecalc */
     float Y[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS];
     float prev_Y[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS];
-    float interpolator[FRAME_SIZE];
+    float delta_Y[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS];   /**< prev_Y - Y, for the moving sources only */
+    float rampDown[FRAME_SIZE];                          /**< linear ramp from 1 to 0 over the frame */
     
     /* user parameters */
     int nSources;
@@ -191,6 +191,36 @@ typedef enum _ARRAY2SH_EVAL_STATUS{
     EVAL_STATUS_EVALUATING          /**< Encoder is being evaluated */
 }ARRAY2SH_EVAL_STATUS;
 
+/**
+ * Resolution of the encoder evaluation (see array2sh_evalEncoder())
+ */
+typedef enum _ARRAY2SH_EVAL_RESOLUTIONS{
+    EVAL_RESOLUTION_FAST = 1, /**< Metrics computed for every 4th band above
+                               *   the lowest 12 (and interpolated in-between),
+                               *   using 252 simulated directions; intended for
+                               *   display */
+    EVAL_RESOLUTION_FULL      /**< Metrics computed for all bands, using 812
+                               *   simulated directions; intended for export */
+}ARRAY2SH_EVAL_RESOLUTIONS;
+
+/**
+ * Available domains in which to apply the encoding filters
+ */
+typedef enum _ARRAY2SH_ENCODING_DOMAINS{
+    ENCODING_DOMAIN_AUTO = 1, /**< Time-domain for orders up to
+                               *   ARRAY2SH_TIME_DOMAIN_MAX_ORDER (where it is
+                               *   cheaper), otherwise the filterbank */
+    ENCODING_DOMAIN_TFT,      /**< Per-band encoding matrices, applied in the
+                               *   afSTFT domain */
+    ENCODING_DOMAIN_TIME      /**< nSH x nSensors matrix of FIR encoding
+                               *   filters, applied via partitioned
+                               *   convolution */
+    
+}ARRAY2SH_ENCODING_DOMAINS;
+
+/** Highest order which ENCODING_DOMAIN_AUTO encodes in the time-domain */
+#define ARRAY2SH_TIME_DOMAIN_MAX_ORDER ( 1 )
+
 #define ARRAY2SH_MAX_NUM_SENSORS ( 64 )
 #define ARRAY2SH_MAX_GAIN_MIN_VALUE ( 0.0f )
 #define ARRAY2SH_MAX_GAIN_MAX_VALUE ( 80.0f )
@@ -243,6 +273,11 @@ void array2sh_evalEncoder(void* const hA2sh);
  * Spatially encode microphone/hydrophone array signals into spherical harmonic
  * signals
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in array2sh_getProcessingDelay()
+ *
  * @param[in] hA2sh     array2sh handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs   Output channel buffers; 2-D array: nOutputs x nSamples
@@ -257,6 +292,51 @@ void array2sh_process(void* const hA2sh,
                       int nOutputs,
                       int nSamples);
 
+/**
+ * Same as array2sh_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hA2sh    array2sh handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void array2sh_processInterleaved(void* const hA2sh,
+                                 const float* inputs,
+                                 float* outputs,
+                                 int nInputs,
+                                 int nOutputs,
+                                 int nSamples);
+
+/**
+ * Encodes one afSTFT-domain frame of microphone array signals into spherical
+ * harmonic signals, for use as a stage of a saf_tfGraph (see
+ * saf_tfGraph_stageProcessor)
+ *
+ * This is the main processing of array2sh_process(), without the FIFO and the
+ * forward/inverse afSTFT; which are instead applied once for the whole chain by
+ * the graph.
+ *
+ * @param[in]  hA2sh         array2sh handle
+ * @param[in]  inTF          Input frame (complex); FLAT: HYBRID_BANDS x
+ *                           nInputs x TIME_SLOTS
+ * @param[out] outTF         Output frame (complex); FLAT: HYBRID_BANDS x nSH x
+ *                           TIME_SLOTS
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels
+ * @param[in]  nBands        Number of bands (must be HYBRID_BANDS)
+ * @param[in]  nTimeSlots    Number of time slots (must be TIME_SLOTS)
+ * @returns Number of output channels (nSH), or 0 if not ready
+ */
+int array2sh_processTF(void* const hA2sh,
+                       const float* inTF,
+                       float* outTF,
+                       int nInputs,
+                       int maxNumOutputs,
+                       int nBands,
+                       int nTimeSlots);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -290,6 +370,16 @@ void array2sh_setRequestEncoderEvalFLAG(void* const hA2sh, int newState);
  */
 void array2sh_setEvalStatus(void* const hA2sh, ARRAY2SH_EVAL_STATUS evalStatus);
 
+/**
+ * Sets the resolution of the encoder evaluation (see
+ * 'ARRAY2SH_EVAL_RESOLUTIONS' enum); default: EVAL_RESOLUTION_FAST
+ *
+ * @note Changing the resolution also sets the eval status to
+ *       EVAL_STATUS_NOT_EVALUATED
+ */
+void array2sh_setEvalResolution(void* const hA2sh,
+                                ARRAY2SH_EVAL_RESOLUTIONS newResolution);
+
 /**
  * Analyses what the theoretical spatial aliasing frequency is, and conducts
  * diffuse-field equalisation above this (enable: 1, disable: 0).
@@ -409,6 +499,46 @@ void array2sh_setc(void* const hA2sh, float newc);
  */
 void array2sh_setGain(void* const hA2sh, float newGain);
 
+/**
+ * Sets the domain in which to apply the encoding filters (see
+ * 'ARRAY2SH_ENCODING_DOMAINS' enum; default: ENCODING_DOMAIN_TFT)
+ *
+ * The time-domain path converts the per-band encoding matrices into FIR
+ * filters once (whenever the filters are rebuilt), and applies them to the
+ * sensor signals with partitioned convolution; so it bypasses the filterbank
+ * and most of its delay. See array2sh_getProcessingDelay().
+ *
+ * @note array2sh_processTF() always applies the per-band encoding matrices
+ */
+void array2sh_setEncodingDomain(void* const hA2sh,
+                                ARRAY2SH_ENCODING_DOMAINS newDomain);
+
+/**
+ * Sets the file path of measured array responses (see saf_arrayResponses.h),
+ * from which the encoding filters are then computed, instead of from the
+ * analytic model of the array
+ *
+ * The filters are obtained by a regularised least-squares fit of the measured
+ * responses (of the bins nearest to each band) to the spherical harmonics of
+ * the measurement directions; see measuredArrayEncodingFilters(). The
+ * regularisation is taken from array2sh_setRegPar(), while the filter type
+ * and the diffuse-field equalisation do not apply. The number of sensors is
+ * set to that of the file.
+ *
+ * @note The file is memory-mapped whenever the filters are rebuilt (or
+ *       evaluated), so only the bins that are used are read. If it can no
+ *       longer be read at that point (or the number of sensors has since been
+ *       changed), the analytic model is used instead; see
+ *       array2sh_getUsesMeasuredResponses().
+ *
+ * @param[in] hA2sh array2sh handle
+ * @param[in] path  File path, or NULL to revert to the analytic model (the
+ *                  number of sensors is then kept)
+ * @returns   1 if the file is valid (or path is NULL), 0 otherwise (in which
+ *            case the settings are left unchanged)
+ */
+int array2sh_setMeasuredResponsesFilePath(void* const hA2sh, const char* path);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -419,6 +549,12 @@ void array2sh_setGain(void* const hA2sh, float newGain);
  */
 ARRAY2SH_EVAL_STATUS array2sh_getEvalStatus(void* const hA2sh);
 
+/**
+ * Returns the resolution of the encoder evaluation (see
+ * 'ARRAY2SH_EVAL_RESOLUTIONS' enum)
+ */
+ARRAY2SH_EVAL_RESOLUTIONS array2sh_getEvalResolution(void* const hA2sh);
+
 /**
  * (Optional) Returns current intialisation/processing progress, between 0..1
  *  - 0: intialisation/processing has started
@@ -566,6 +702,32 @@ float array2sh_getc(void* const hA2sh);
  */
 float array2sh_getGain(void* const hA2sh);
 
+/**
+ * Returns the domain in which the encoding filters are asked to be applied
+ * (see 'ARRAY2SH_ENCODING_DOMAINS' enum)
+ */
+int array2sh_getEncodingDomain(void* const hA2sh);
+
+/**
+ * Returns 1 if the encoding filters are applied in the time-domain (for the
+ * current, or the pending, encoding order), or 0 if they are applied in the
+ * afSTFT domain
+ */
+int array2sh_getUsesTimeDomainEncoding(void* const hA2sh);
+
+/**
+ * Returns the file path of the measured array responses ("no_file" if the
+ * analytic model of the array is used)
+ */
+char* array2sh_getMeasuredResponsesFilePath(void* const hA2sh);
+
+/**
+ * Returns 1 if the encoding filters currently in use were computed from
+ * measured array responses, or 0 if they were computed from the analytic model
+ * of the array
+ */
+int array2sh_getUsesMeasuredResponses(void* const hA2sh);
+
 /**
  * Returns a pointer to the frequency vector
  *
@@ -651,10 +813,19 @@ float* array2sh_getLevelDifference_Handle(void* const hA2sh, int* nCurves, int*
 int array2sh_getSamplingRate(void* const hA2sh);
     
 /**
- * Returns the processing delay in samples (may be used for delay compensation
- * features) 
+ * Returns the processing delay of this instance in samples (may be used for
+ * delay compensation features), which is lower when encoding in the
+ * time-domain; and which includes the latency of the internal FIFO, if any
+ * (i.e. if the host block size is not a multiple of FRAME_SIZE)
+ */
+int array2sh_getProcessingDelay(void* const hA2sh);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * building the encoding filters); see saf_telemetry_getSnapshot()
  */
-int array2sh_getProcessingDelay(void);
+void* array2sh_getTelemetry(void* const hA2sh);
    
     
 #ifdef __cplusplus
@@ -48,7 +48,6 @@ void array2sh_create
 {
     array2sh_data* pData = (array2sh_data*)malloc1d(sizeof(array2sh_data));
     *phA2sh = (void*)pData;
-    int ch;
      
     /* defualt parameters */
     array2sh_createArray(&(pData->arraySpecs)); 
@@ -61,19 +60,11 @@ void array2sh_create
     array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
     array2sh_initArray(arraySpecs, MICROPHONE_ARRAY_PRESET_DEFAULT, &(pData->order), 1);
     pData->enableDiffEQpastAliasing = 1;
+    pData->domain = ENCODING_DOMAIN_TFT;
+    pData->measured_filepath = NULL;
     
     /* time-frequency transform + buffers */
     pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = (complexVector*)malloc1d(MAX_NUM_SENSORS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SENSORS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    pData->STFTOutputFrameTF = (complexVector*)malloc1d(MAX_NUM_SH_SIGNALS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
     pData->tempHopFrameTD_in = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_SENSORS), HOP_SIZE, sizeof(float));
     pData->tempHopFrameTD_out = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_SENSORS), HOP_SIZE, sizeof(float));
     
@@ -82,16 +73,27 @@ void array2sh_create
     pData->progressBarText = malloc1d(ARRAY2SH_PROGRESSBARTEXT_CHAR_LENGTH*sizeof(char));
     strcpy(pData->progressBarText,"");
     pData->evalStatus = EVAL_STATUS_NOT_EVALUATED;
+    pData->evalResolution = EVAL_RESOLUTION_FAST;
     pData->evalRequestedFLAG = 0;
     pData->reinitSHTmatrixFLAG = 1;
     pData->new_order = pData->order;
-    pData->bN = NULL;
+    pData->enc = NULL;
+    pData->evalCopyingFLAG = 0;
+    pData->cache.bN_valid = 0;
+    pData->cache.hBesselTable = NULL;
+    pData->cache.dcoh_valid = 0;
+    pData->cache.dM_diffcoh = NULL;
+    saf_asyncInit_create(&(pData->hEncInit), &array2sh_buildEncoder, &array2sh_destroyEncoder, NULL, *phA2sh);
     
     /* display related stuff */
     pData->bN_modal_dB = (float**)malloc2d(HYBRID_BANDS, MAX_SH_ORDER + 1, sizeof(float));
     pData->bN_inv_dB = (float**)malloc2d(HYBRID_BANDS, MAX_SH_ORDER + 1, sizeof(float));
     pData->cSH = (float*)calloc1d((HYBRID_BANDS)*(MAX_SH_ORDER + 1),sizeof(float));
     pData->lSH = (float*)calloc1d((HYBRID_BANDS)*(MAX_SH_ORDER + 1),sizeof(float));
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SENSORS, MAX_NUM_SH_SIGNALS);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void array2sh_destroy
@@ -100,29 +102,25 @@ void array2sh_destroy
 )
 {
     array2sh_data *pData = (array2sh_data*)(*phM2sh);
-    int ch;
 
     if (pData != NULL) {
         /* not safe to free memory during evaluation */
         while (pData->evalStatus == EVAL_STATUS_EVALUATING)
             SAF_SLEEP(10);
         
+        /* stop any background rebuild, before freeing the encoder */
+        saf_asyncInit_destroy(&(pData->hEncInit));
+        array2sh_destroyEncoder((void*)pData, (void*)pData->enc);
+        free(pData->cache.dM_diffcoh);
+        sphBesselTable_destroy(&(pData->cache.hBesselTable));
+        
         /* free afSTFT and buffers */
         if (pData->hSTFT != NULL)
             afSTFTfree(pData->hSTFT);
-        for (ch = 0; ch< MAX_NUM_SENSORS; ch++) {
-            free(pData->STFTInputFrameTF[ch].re);
-            free(pData->STFTInputFrameTF[ch].im);
-        }
-        for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-            free(pData->STFTOutputFrameTF[ch].re);
-            free(pData->STFTOutputFrameTF[ch].im);
-        }
-        free(pData->STFTOutputFrameTF);
-        free(pData->STFTInputFrameTF);
         free(pData->tempHopFrameTD_in);
         free(pData->tempHopFrameTD_out);
         array2sh_destroyArray(&(pData->arraySpecs));
+        free(pData->measured_filepath);
         
         /* Display stuff */
         free((void**)pData->bN_modal_dB);
@@ -130,6 +128,8 @@ void array2sh_destroy
         
         free(pData->progressBarText);
         
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
         free(pData);
         pData = NULL;
     }
@@ -178,44 +178,222 @@ void array2sh_evalEncoder
     pData->evalStatus = EVAL_STATUS_RECENTLY_EVALUATED;
 }
 
-void array2sh_process
+/**
+ * Copies the magnitude responses of the regularised inverse modal filters and
+ * of the modal coefficients of 'enc' into the display buffers
+ */
+static void array2sh_copyMagCurves
+(
+    array2sh_data* pData,
+    array2sh_encoder* enc
+)
+{
+    memcpy(ADR2D(pData->bN_inv_dB), ADR2D(enc->bN_inv_dB), HYBRID_BANDS*(MAX_SH_ORDER+1)*sizeof(float));
+    memcpy(ADR2D(pData->bN_modal_dB), ADR2D(enc->bN_modal_dB), HYBRID_BANDS*(MAX_SH_ORDER+1)*sizeof(float));
+}
+
+/**
+ * Swaps in the encoder rebuilt in the background, if one is ready and it still
+ * matches the current encoding order and number of sensors
+ *
+ * @returns The previous encoder (to crossfade from, and which should then be
+ *          passed to saf_asyncInit_retire()); or NULL, if no swap took place
+ */
+static array2sh_encoder* array2sh_swapEncoder
+(
+    array2sh_data* pData,
+    int order,
+    int Q
+)
+{
+    array2sh_encoder* newEnc, *oldEnc;
+    
+    newEnc = (array2sh_encoder*)saf_asyncInit_fetch(pData->hEncInit);
+    if(newEnc==NULL)
+        return NULL;
+    if(newEnc->order!=order || newEnc->specs.Q!=Q || newEnc->useTimeDomain!=pData->enc->useTimeDomain){
+        saf_asyncInit_retire(pData->hEncInit, (void*)newEnc);
+        return NULL;
+    }
+    oldEnc = pData->enc;
+    pData->enc = newEnc;
+    array2sh_copyMagCurves(pData, newEnc);
+    return oldEnc;
+}
+
+/**
+ * Reinitialises the afSTFT, and recomputes the encoding matrix, if needed
+ */
+static void array2sh_updateEncoder
+(
+    void  *  const hA2sh
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    array2sh_encoder* enc;
+    
+    /* reinit TFT if needed */
+    array2sh_initTFT(hA2sh);
+    
+    /* compute encoding matrix if needed */
+    if (pData->reinitSHTmatrixFLAG) {
+        /* supersede any background rebuild (and wait for it, since the builds
+         * share the cached modal coefficients and diffuse coherence matrices) */
+        saf_asyncInit_cancel(pData->hEncInit);
+        saf_asyncInit_wait(pData->hEncInit);
+        enc = (array2sh_encoder*)array2sh_buildEncoder(hA2sh, NULL); /* compute encoding matrix */
+        array2sh_destroyEncoder(hA2sh, (void*)pData->enc);
+        pData->enc = enc;
+        pData->order = enc->order;
+        array2sh_copyMagCurves(pData, enc); /* magnitude response curves */
+        pData->reinitSHTmatrixFLAG = 0;
+    }
+}
+
+/**
+ * Applies the spherical harmonic transform (SHT) to the current TF-domain frame
+ * of sensor signals (inputframeTF -> SHframeTF); i.e. the main processing of
+ * array2sh_processFrame(), which is shared with array2sh_processTF()
+ */
+static void array2sh_encodeFrameTF
+(
+    array2sh_data* pData,
+    int order,
+    int Q
+)
+{
+    int t, i, band, nSH, crossfade;
+    const int strideW = MAX_NUM_SH_SIGNALS*MAX_NUM_SENSORS;
+    const int strideIn = MAX_NUM_SENSORS*TIME_SLOTS;
+    const int strideOut = MAX_NUM_SH_SIGNALS*TIME_SLOTS;
+    array2sh_encoder* enc, *oldEnc;
+    const float_complex cbeta = cmplxf(0.0f, 0.0f);
+    float_complex calpha;
+    float gain_lin, fadeIn;
+    
+    gain_lin = powf(10.0f, pData->gain_dB/20.0f);
+    calpha = cmplxf(gain_lin, 0.0f); /* post-gain is applied as part of the SHT */
+    nSH = (order+1)*(order+1);
+    
+    /* swap in the encoder rebuilt in the background (if it is ready, and
+     * still matches the current configuration), and keep the output of the
+     * old encoder for this frame, to crossfade from. The old encoder is
+     * then destroyed in the background. */
+    crossfade = 0;
+    oldEnc = array2sh_swapEncoder(pData, order, Q);
+    if(oldEnc!=NULL){
+        utility_cgemm_batch(ADR2D(oldEnc->W[0]), MAX_NUM_SENSORS, strideW,
+                            ADR2D(pData->inputframeTF[0]), TIME_SLOTS, strideIn,
+                            nSH, TIME_SLOTS, Q, calpha, cbeta,
+                            TIME_SLOTS, strideOut, HYBRID_BANDS,
+                            ADR2D(pData->SHframeTF_prev[0]));
+        saf_asyncInit_retire(pData->hEncInit, (void*)oldEnc);
+        crossfade = 1;
+    }
+    
+    /* Apply spherical harmonic transform (SHT), to all bands of the planar
+     * afSTFT output at once */
+    enc = pData->enc;
+    utility_cgemm_batch(ADR2D(enc->W[0]), MAX_NUM_SENSORS, strideW,
+                        ADR2D(pData->inputframeTF[0]), TIME_SLOTS, strideIn,
+                        nSH, TIME_SLOTS, Q, calpha, cbeta,
+                        TIME_SLOTS, strideOut, HYBRID_BANDS,
+                        ADR2D(pData->SHframeTF[0]));
+    
+    /* linear crossfade (over the time slots) from the old encoder */
+    if(crossfade){
+        for(band=0; band<HYBRID_BANDS; band++){
+            for(i=0; i<nSH; i++){
+                for(t=0; t<TIME_SLOTS; t++){
+                    fadeIn = (float)(t+1)/(float)TIME_SLOTS;
+                    pData->SHframeTF[band][i][t] = ccaddf(crmulf(pData->SHframeTF[band][i][t], fadeIn),
+                                                          crmulf(pData->SHframeTF_prev[band][i][t], 1.0f-fadeIn));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Applies the FIR encoding filters to the current frame of sensor signals
+ * (inputFrameTD -> SHframeTD); i.e. the main processing of
+ * array2sh_processFrame() when encoding in the time-domain
+ */
+static void array2sh_encodeFrameTD
+(
+    array2sh_data* pData,
+    int order,
+    int Q
+)
+{
+    int i, n, nSH, crossfade;
+    array2sh_encoder* oldEnc;
+    float gain_lin, fadeIn;
+    
+    gain_lin = powf(10.0f, pData->gain_dB/20.0f);
+    nSH = (order+1)*(order+1);
+    
+    /* swap in the encoder rebuilt in the background, and keep the output of
+     * the old filters for this frame, to crossfade from (the convolver of the
+     * new filters starts from silence; but, since TD_FILTER_LENGTH is at most
+     * FRAME_SIZE, it has caught up by the end of the crossfade) */
+    crossfade = 0;
+    oldEnc = array2sh_swapEncoder(pData, order, Q);
+    if(oldEnc!=NULL){
+        saf_matrixConv_apply(oldEnc->hMatrixConv, ADR2D(pData->inputFrameTD), ADR2D(pData->SHframeTD_prev));
+        saf_asyncInit_retire(pData->hEncInit, (void*)oldEnc);
+        crossfade = 1;
+    }
+    
+    /* Apply the nSH x Q matrix of encoding filters */
+    saf_matrixConv_apply(pData->enc->hMatrixConv, ADR2D(pData->inputFrameTD), ADR2D(pData->SHframeTD));
+    
+    /* linear crossfade (over the frame) from the old filters */
+    if(crossfade){
+        for(i=0; i<nSH; i++){
+            for(n=0; n<FRAME_SIZE; n++){
+                fadeIn = (float)(n+1)/(float)FRAME_SIZE;
+                pData->SHframeTD[i][n] = fadeIn*pData->SHframeTD[i][n] + (1.0f-fadeIn)*pData->SHframeTD_prev[i][n];
+            }
+        }
+    }
+    
+    /* post-gain */
+    utility_svsmul(ADR2D(pData->SHframeTD), &gain_lin, nSH*FRAME_SIZE, NULL);
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void array2sh_processFrame
 (
     void  *  const hA2sh,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
     array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
-    int n, t, ch, i, band, Q, order, nSH;
+    int n, t, ch, i, Q, order, nSH;
     int o[MAX_SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
     ARRAY2SH_CH_ORDER chOrdering;
     ARRAY2SH_NORM_TYPES norm;
-    float gain_lin;
     
-    /* reinit TFT if needed */
-    array2sh_initTFT(hA2sh);
-    
-    /* compute encoding matrix if needed */
-    if (pData->reinitSHTmatrixFLAG) {
-        array2sh_calculate_sht_matrix(hA2sh); /* compute encoding matrix */
-        array2sh_calculate_mag_curves(hA2sh); /* calculate magnitude response curves */
-        pData->reinitSHTmatrixFLAG = 0;
-    }
+    /* reinit TFT and encoding matrix if needed */
+    array2sh_updateEncoder(hA2sh);
 
     /* processing loop */
-    if ((nSamples == FRAME_SIZE) && (pData->reinitSHTmatrixFLAG==0) ) {
+    if (pData->reinitSHTmatrixFLAG==0) {
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
         
         /* prep */
         for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
         chOrdering = pData->chOrdering;
         norm = pData->norm;
-        gain_lin = powf(10.0f, pData->gain_dB/20.0f);
         Q = arraySpecs->Q;
         order = pData->order;
         nSH = (order+1)*(order+1);
@@ -226,52 +404,63 @@ void array2sh_process
         for(; i<Q; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
-        /* Apply time-frequency transform (TFT) */
-        for(t=0; t< TIME_SLOTS; t++) {
-            for(ch = 0; ch < Q; ch++)
-                utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD_in[ch]);
-            afSTFTforward(pData->hSTFT, pData->tempHopFrameTD_in, pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < Q; ch++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
-        }
-        
-        /* Apply spherical harmonic transform (SHT) */
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, TIME_SLOTS, Q, &calpha,
-                        pData->W[band], MAX_NUM_SENSORS,
-                        pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-                        pData->SHframeTF[band], TIME_SLOTS);
-        }
-      
-        /* inverse-TFT */
-        for(t = 0; t < TIME_SLOTS; t++) {
-            for(band = 0; band < HYBRID_BANDS; band++) {
-                for (ch = 0; ch < nSH; ch++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = gain_lin*crealf(pData->SHframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = gain_lin*cimagf(pData->SHframeTF[band][ch][t]);
-                }
-            }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD_out);
+        /* the time-domain encoder bypasses the filterbank */
+        if(pData->enc->useTimeDomain){
+            /* Main processing: */
+            array2sh_encodeFrameTD(pData, order, Q);
             
             /* copy SH signals to output buffer */
             switch(chOrdering){
                 case CH_ACN:  /* already ACN */
                     for (ch = 0; ch < MIN(nSH, nOutputs); ch++)
-                        utility_svvcopy(pData->tempHopFrameTD_out[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+                        utility_svvcopy(pData->SHframeTD[ch], FRAME_SIZE, outputs[ch]);
                     for (; ch < nOutputs; ch++)
-                        memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
+                        memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
                     break;
                 case CH_FUMA: /* convert to FuMa, only for first-order */
                     if(nOutputs>=4){
-                        utility_svvcopy(pData->tempHopFrameTD_out[0], HOP_SIZE, &(outputs[0][t* HOP_SIZE]));
-                        utility_svvcopy(pData->tempHopFrameTD_out[1], HOP_SIZE, &(outputs[2][t* HOP_SIZE]));
-                        utility_svvcopy(pData->tempHopFrameTD_out[2], HOP_SIZE, &(outputs[3][t* HOP_SIZE]));
-                        utility_svvcopy(pData->tempHopFrameTD_out[3], HOP_SIZE, &(outputs[1][t* HOP_SIZE]));
+                        utility_svvcopy(pData->SHframeTD[0], FRAME_SIZE, outputs[0]);
+                        utility_svvcopy(pData->SHframeTD[1], FRAME_SIZE, outputs[2]);
+                        utility_svvcopy(pData->SHframeTD[2], FRAME_SIZE, outputs[3]);
+                        utility_svvcopy(pData->SHframeTD[3], FRAME_SIZE, outputs[1]);
                     }
                     break;
             }
         }
+        else{
+            /* Apply time-frequency transform (TFT) */
+            for(t=0; t< TIME_SLOTS; t++) {
+                for(ch = 0; ch < Q; ch++)
+                    utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD_in[ch]);
+                afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD_in, &(pData->inputframeTF[0][0][t]), MAX_NUM_SENSORS*TIME_SLOTS, TIME_SLOTS);
+            }
+            
+            /* Main processing: */
+            array2sh_encodeFrameTF(pData, order, Q);
+          
+            /* inverse-TFT */
+            for(t = 0; t < TIME_SLOTS; t++) {
+                afSTFTinversePlanar(pData->hSTFT, &(pData->SHframeTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS, pData->tempHopFrameTD_out);
+                
+                /* copy SH signals to output buffer */
+                switch(chOrdering){
+                    case CH_ACN:  /* already ACN */
+                        for (ch = 0; ch < MIN(nSH, nOutputs); ch++)
+                            utility_svvcopy(pData->tempHopFrameTD_out[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+                        for (; ch < nOutputs; ch++)
+                            memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
+                        break;
+                    case CH_FUMA: /* convert to FuMa, only for first-order */
+                        if(nOutputs>=4){
+                            utility_svvcopy(pData->tempHopFrameTD_out[0], HOP_SIZE, &(outputs[0][t* HOP_SIZE]));
+                            utility_svvcopy(pData->tempHopFrameTD_out[1], HOP_SIZE, &(outputs[2][t* HOP_SIZE]));
+                            utility_svvcopy(pData->tempHopFrameTD_out[2], HOP_SIZE, &(outputs[3][t* HOP_SIZE]));
+                            utility_svvcopy(pData->tempHopFrameTD_out[3], HOP_SIZE, &(outputs[1][t* HOP_SIZE]));
+                        }
+                        break;
+                }
+            }
+        }
         
         /* apply normalisation scheme */
         switch(norm){
@@ -296,15 +485,159 @@ void array2sh_process
                         memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
                 break;
         }
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     }
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+void array2sh_process
+(
+    void  *  const hA2sh,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &array2sh_processFrame, hA2sh);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+int array2sh_processTF
+(
+    void  *  const hA2sh,
+    const float *  inTF,
+    float *        outTF,
+    int            nInputs,
+    int            maxNumOutputs,
+    int            nBands,
+    int            nTimeSlots
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
+    int n, ch, band, Q, nQ_in, order, nSH, nOut;
+    int o[MAX_SH_ORDER+2];
+    const int fuma2acn[4] = {0, 3, 1, 2};
+    float scale;
+    const float_complex* pInTF;
+    float_complex* pOutTF;
+    ARRAY2SH_CH_ORDER chOrdering;
+    ARRAY2SH_NORM_TYPES norm;
+    
+    if(nBands != HYBRID_BANDS || nTimeSlots != TIME_SLOTS)
+        return 0;
+    
+    /* reinit encoding matrix if needed */
+    array2sh_updateEncoder(hA2sh);
+    if (pData->reinitSHTmatrixFLAG){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return 0;
+    }
+    pData->procStatus = PROC_STATUS_ONGOING;
+    
+    /* prep */
+    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    chOrdering = pData->chOrdering;
+    norm = pData->norm;
+    Q = arraySpecs->Q;
+    order = pData->order;
+    nSH = (order+1)*(order+1);
+    pInTF = (const float_complex*)inTF;
+    pOutTF = (float_complex*)outTF;
+    nOut = chOrdering==CH_FUMA ? (maxNumOutputs>=4 ? 4 : 0) : MIN(nSH, maxNumOutputs);
+    if(nOut==0 || (norm==NORM_FUMA && maxNumOutputs<4)){
+        pData->procStatus = PROC_STATUS_NOT_ONGOING;
+        return 0;
+    }
+    
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* Load the TF frame */
+    nQ_in = MIN(Q, nInputs);
+    for(band=0; band<HYBRID_BANDS; band++){
+        utility_cvvcopy(&pInTF[band*nInputs*TIME_SLOTS], nQ_in*TIME_SLOTS, pData->inputframeTF[band][0]);
+        if(nQ_in<Q)
+            memset(pData->inputframeTF[band][nQ_in], 0, (Q-nQ_in)*TIME_SLOTS*sizeof(float_complex));
+    }
+    
+    /* Main processing: */
+    array2sh_encodeFrameTF(pData, order, Q);
+    
+    /* copy SH signals to the output frame (converting from ACN/N3D, as in
+     * array2sh_processFrame()) */
+    for(band=0; band<HYBRID_BANDS; band++){
+        for(ch=0; ch<nOut; ch++)
+            utility_cvvcopy(pData->SHframeTF[band][chOrdering==CH_FUMA ? fuma2acn[ch] : ch], TIME_SLOTS, &pOutTF[(band*nOut+ch)*TIME_SLOTS]);
+        for (n = 0; n<order+1 && norm!=NORM_N3D && (norm!=NORM_FUMA || n<2); n++){
+            scale = norm==NORM_SN3D ? 1.0f/sqrtf(2.0f*(float)n+1.0f) : (n==0 ? 1.0f/sqrtf(2.0f) : 1.0f/sqrtf(3.0f));
+            for (ch = o[n]; ch < MIN(o[n+1],nOut); ch++)
+                utility_svsmul((float*)&pOutTF[(band*nOut+ch)*TIME_SLOTS], &scale, 2*TIME_SLOTS, NULL);
+        }
+    }
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+    return nOut;
+}
+
+void array2sh_processInterleaved
+(
+    void  *  const hA2sh,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &array2sh_processFrame, hA2sh);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Requests that the encoding filters are recomputed; which is carried out in
+ * the background (and crossfaded to) if an encoder is already in use and
+ * neither the encoding order nor the number of sensors have changed; or
+ * otherwise by the next call to array2sh_processFrame()
+ */
+static void array2sh_requestFilterUpdate(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
+    
+    if(pData->enc!=NULL && !pData->reinitSHTmatrixFLAG &&
+       pData->new_order==pData->order && arraySpecs->newQ==arraySpecs->Q)
+        saf_asyncInit_request(pData->hEncInit);
+    else
+        pData->reinitSHTmatrixFLAG = 1;
+}
+
 /* Set Functions */
 
 void array2sh_refreshSettings(void* const hA2sh)
@@ -320,7 +653,7 @@ void array2sh_setEncodingOrder(void* const hA2sh, int newOrder)
     
     if(pData->new_order != newOrder){
         pData->new_order = newOrder;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
     /* FUMA only supports 1st order */
@@ -347,12 +680,21 @@ void array2sh_setEvalStatus(void* const hA2sh, ARRAY2SH_EVAL_STATUS new_evalStat
     pData->evalStatus = new_evalStatus;
 }
 
+void array2sh_setEvalResolution(void* const hA2sh, ARRAY2SH_EVAL_RESOLUTIONS newResolution)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    if(pData->evalResolution != newResolution){
+        pData->evalResolution = newResolution; /* (read once, at the start of an evaluation) */
+        array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
+    }
+}
+
 void array2sh_setDiffEQpastAliasing(void* const hA2sh, int newState)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
     if(pData->enableDiffEQpastAliasing != newState){
         pData->enableDiffEQpastAliasing = newState;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -364,7 +706,7 @@ void array2sh_setPreset(void* const hA2sh, int preset)
     
     array2sh_initArray(arraySpecs,(ARRAY2SH_MICROPHONE_ARRAY_PRESETS)preset, &(pData->new_order), 0);
     pData->c = (ARRAY2SH_MICROPHONE_ARRAY_PRESETS)preset == MICROPHONE_ARRAY_PRESET_AALTO_HYDROPHONE ? 1484.0f : 343.0f;
-    pData->reinitSHTmatrixFLAG = 1;
+    array2sh_requestFilterUpdate(hA2sh);
     array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
 }
 
@@ -376,7 +718,7 @@ void array2sh_setSensorAzi_rad(void* const hA2sh, int index, float newAzi_rad)
     if(arraySpecs->sensorCoords_rad[index][0] != newAzi_rad){
         arraySpecs->sensorCoords_rad[index][0] = newAzi_rad;
         arraySpecs->sensorCoords_deg[index][0] = newAzi_rad * (180.0f/M_PI);
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -389,7 +731,7 @@ void array2sh_setSensorElev_rad(void* const hA2sh, int index, float newElev_rad)
     if(arraySpecs->sensorCoords_rad[index][1] != newElev_rad){
         arraySpecs->sensorCoords_rad[index][1] = newElev_rad;
         arraySpecs->sensorCoords_deg[index][1] = newElev_rad * (180.0f/M_PI);
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -403,7 +745,7 @@ void array2sh_setSensorAzi_deg(void* const hA2sh, int index, float newAzi_deg)
     if(arraySpecs->sensorCoords_deg[index][0] != newAzi_deg){
         arraySpecs->sensorCoords_rad[index][0] = newAzi_deg * (M_PI/180.0f);
         arraySpecs->sensorCoords_deg[index][0] = newAzi_deg;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -416,7 +758,7 @@ void array2sh_setSensorElev_deg(void* const hA2sh, int index, float newElev_deg)
     if(arraySpecs->sensorCoords_deg[index][1] != newElev_deg){
         arraySpecs->sensorCoords_rad[index][1] = newElev_deg * (M_PI/180.0f);
         arraySpecs->sensorCoords_deg[index][1] = newElev_deg;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -430,12 +772,12 @@ void array2sh_setNumSensors(void* const hA2sh, int newQ)
     nSH = (pData->new_order+1)*(pData->new_order+1);
     if (newQ < nSH){
         pData->new_order = 1;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
     if(arraySpecs->Q != newQ){
         arraySpecs->newQ = newQ;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -448,7 +790,7 @@ void array2sh_setr(void* const hA2sh, float newr)
     newr = CLAMP(newr, ARRAY2SH_ARRAY_RADIUS_MIN_VALUE/1e3f, ARRAY2SH_ARRAY_RADIUS_MAX_VALUE/1e3f);
     if(arraySpecs->r!=newr){
         arraySpecs->r = newr;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -461,7 +803,7 @@ void array2sh_setR(void* const hA2sh, float newR)
     newR = CLAMP(newR, ARRAY2SH_BAFFLE_RADIUS_MIN_VALUE/1e3f, ARRAY2SH_BAFFLE_RADIUS_MAX_VALUE/1e3f);
     if(arraySpecs->R!=newR){
         arraySpecs->R = newR;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -473,7 +815,7 @@ void array2sh_setArrayType(void* const hA2sh, int newType)
     
     if(arraySpecs->arrayType != (ARRAY2SH_ARRAY_TYPES)newType){
         arraySpecs->arrayType = (ARRAY2SH_ARRAY_TYPES)newType;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -485,7 +827,7 @@ void array2sh_setWeightType(void* const hA2sh, int newType)
     
     if(arraySpecs->weightType!=(ARRAY2SH_WEIGHT_TYPES)newType){
         arraySpecs->weightType = (ARRAY2SH_WEIGHT_TYPES)newType;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -496,7 +838,7 @@ void array2sh_setFilterType(void* const hA2sh, int newType)
     
     if(pData->filterType!=(ARRAY2SH_FILTER_TYPES)newType){
         pData->filterType = (ARRAY2SH_FILTER_TYPES)newType;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -507,7 +849,7 @@ void array2sh_setRegPar(void* const hA2sh, float newVal)
      newVal = CLAMP(newVal, ARRAY2SH_MAX_GAIN_MIN_VALUE, ARRAY2SH_MAX_GAIN_MAX_VALUE);
     if(pData->regPar!=newVal){
         pData->regPar = newVal;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -532,7 +874,7 @@ void array2sh_setc(void* const hA2sh, float newc)
     newc = CLAMP(newc, ARRAY2SH_SPEED_OF_SOUND_MIN_VALUE, ARRAY2SH_SPEED_OF_SOUND_MAX_VALUE);
     if(newc!=pData->c){
         pData->c = newc;
-        pData->reinitSHTmatrixFLAG = 1;
+        array2sh_requestFilterUpdate(hA2sh);
         array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
     }
 }
@@ -543,6 +885,50 @@ void array2sh_setGain(void* const hA2sh, float newGain)
     pData->gain_dB = CLAMP(newGain, ARRAY2SH_POST_GAIN_MIN_VALUE, ARRAY2SH_POST_GAIN_MAX_VALUE);
 }
 
+void array2sh_setEncodingDomain(void* const hA2sh, ARRAY2SH_ENCODING_DOMAINS newDomain)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    if(pData->domain != newDomain){
+        pData->domain = newDomain;
+        pData->reinitSHTmatrixFLAG = 1; /* (not crossfaded, as the processing path changes) */
+    }
+}
+
+int array2sh_setMeasuredResponsesFilePath(void* const hA2sh, const char* path)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    void* hResp;
+    int nSensors;
+    
+    if(path==NULL && pData->measured_filepath==NULL)
+        return 1;
+    
+    /* only the header is read here; the responses are read when the filters are built */
+    nSensors = 0;
+    if(path!=NULL){
+        if(!saf_arrayResponses_open(&hResp, path))
+            return 0;
+        nSensors = saf_arrayResponses_getNumSensors(hResp);
+        saf_arrayResponses_close(&hResp);
+        if(nSensors>MAX_NUM_SENSORS)
+            return 0;
+    }
+    
+    /* (the path is copied by array2sh_buildEncoder(), which may be running in the background) */
+    saf_asyncInit_cancel(pData->hEncInit);
+    saf_asyncInit_wait(pData->hEncInit);
+    free(pData->measured_filepath);
+    pData->measured_filepath = NULL;
+    if(path!=NULL){
+        pData->measured_filepath = malloc1d(strlen(path) + 1);
+        strcpy(pData->measured_filepath, path);
+        array2sh_setNumSensors(hA2sh, nSensors);
+    }
+    array2sh_requestFilterUpdate(hA2sh);
+    array2sh_setEvalStatus(hA2sh, EVAL_STATUS_NOT_EVALUATED);
+    return 1;
+}
+
 
 /* Get Functions */
 
@@ -552,6 +938,12 @@ ARRAY2SH_EVAL_STATUS array2sh_getEvalStatus(void* const hA2sh)
     return pData->evalStatus;
 }
 
+ARRAY2SH_EVAL_RESOLUTIONS array2sh_getEvalResolution(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return pData->evalResolution;
+}
+
 float array2sh_getProgressBar0_1(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
@@ -699,6 +1091,33 @@ float array2sh_getGain(void* const hA2sh)
     return pData->gain_dB;
 }
 
+int array2sh_getEncodingDomain(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return (int)pData->domain;
+}
+
+int array2sh_getUsesTimeDomainEncoding(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return array2sh_getTimeDomainFLAG(hA2sh, pData->new_order);
+}
+
+char* array2sh_getMeasuredResponsesFilePath(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    if(pData->measured_filepath!=NULL)
+        return pData->measured_filepath;
+    else
+        return "no_file";
+}
+
+int array2sh_getUsesMeasuredResponses(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return pData->enc!=NULL && pData->enc->measuredPath!=NULL;
+}
+
 float* array2sh_getFreqVector(void* const hA2sh, int* nFreqPoints)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
@@ -744,7 +1163,14 @@ int array2sh_getSamplingRate(void* const hA2sh)
     return pData->fs;
 }
 
-int array2sh_getProcessingDelay()
+int array2sh_getProcessingDelay(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return saf_fifo_getLatency(pData->hFIFO) + (array2sh_getUsesTimeDomainEncoding(hA2sh) ? TD_FILTER_LENGTH/2 : 12*HOP_SIZE);
+}
+
+void* array2sh_getTelemetry(void* const hA2sh)
 {
-    return 12*HOP_SIZE;
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return pData->hTelemetry;
 }
@@ -43,11 +43,10 @@
 
 static void array2sh_replicate_order
 (
-    void* const hA2sh,
+    array2sh_encoder* enc,
     int order
 )
 {
-    array2sh_data *pData = (array2sh_data*)(hA2sh);
     int band, n, i;
     int o[MAX_SH_ORDER+2];
     
@@ -56,7 +55,199 @@ static void array2sh_replicate_order
     for(band=0; band<HYBRID_BANDS; band++)
         for(n=0; n < order+1; n++)
             for(i=o[n]; i < o[n+1]; i++)
-                pData->bN_inv_R[band][i] = pData->bN_inv[band][n];
+                enc->bN_inv_R[band][i] = enc->bN_inv[band][n];
+}
+
+/**
+ * Returns the modal coefficients for the order and array of 'enc'; FLAT:
+ * HYBRID_BANDS x (order+1). These are only recomputed (which involves
+ * evaluating Bessel/Hankel functions for every band) if the order, array
+ * type/construction, radii, speed of sound or sampling rate have changed since
+ * the previous build.
+ */
+static const double_complex* array2sh_getModalCoeffs
+(
+    array2sh_data* pData,
+    array2sh_encoder* enc,
+    double* kr,
+    double* kR
+)
+{
+    array2sh_filterCache* cache = &(pData->cache);
+    array2sh_arrayPars* specs = &(enc->specs);
+    int order, tableMaxN;
+    double maxKr, tableMaxKr;
+    
+    order = enc->order;
+    if(cache->bN_valid && cache->bN_order==order && cache->bN_fs==enc->fs &&
+       cache->bN_arrayType==specs->arrayType && cache->bN_weightType==specs->weightType &&
+       cache->bN_r==specs->r && cache->bN_R==specs->R && cache->bN_c==enc->c)
+        return cache->bN;
+    
+    /* (re)create the Bessel look-up table if it does not span the current kr
+     * range; with some headroom, so that e.g. dragging the radius sliders does
+     * not require it to be rebuilt each time */
+    maxKr = MAX(kr[HYBRID_BANDS-1], kR[HYBRID_BANDS-1]);
+    if(cache->hBesselTable!=NULL)
+        sphBesselTable_getRange(cache->hBesselTable, &tableMaxN, &tableMaxKr);
+    if(cache->hBesselTable==NULL || tableMaxKr<maxKr){
+        sphBesselTable_destroy(&(cache->hBesselTable));
+        sphBesselTable_create(&(cache->hBesselTable), MAX_SH_ORDER, 2.0*maxKr, BESSEL_TABLE_STEP);
+    }
+    
+    memset(cache->bN, 0, HYBRID_BANDS*(order+1)*sizeof(double_complex));
+    switch(specs->arrayType){
+        case ARRAY_CYLINDRICAL:
+            switch (specs->weightType){
+                case WEIGHT_RIGID_OMNI:   cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, cache->bN); break;
+                case WEIGHT_RIGID_CARD:   /* not supported */ break;
+                case WEIGHT_RIGID_DIPOLE: /* not supported */ break;
+                case WEIGHT_OPEN_OMNI:    cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, cache->bN);  break;
+                case WEIGHT_OPEN_CARD:    /* not supported */ break;
+                case WEIGHT_OPEN_DIPOLE:  /* not supported */ break;
+            }
+            break;
+        case ARRAY_SPHERICAL:
+            switch (specs->weightType){
+                case WEIGHT_OPEN_OMNI:   sphModalCoeffsTable(cache->hBesselTable, order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, 1.0, cache->bN); break;
+                case WEIGHT_OPEN_CARD:   sphModalCoeffsTable(cache->hBesselTable, order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, cache->bN); break;
+                case WEIGHT_OPEN_DIPOLE: sphModalCoeffsTable(cache->hBesselTable, order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, cache->bN); break;
+                case WEIGHT_RIGID_OMNI:
+                case WEIGHT_RIGID_CARD:
+                case WEIGHT_RIGID_DIPOLE:
+                    /* if sensors are flushed with the rigid baffle: */
+                    if(specs->R == specs->r )
+                        sphModalCoeffsTable(cache->hBesselTable, order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, 1.0, cache->bN);
+                    
+                    /* if sensors protrude from the rigid baffle: */
+                    else{
+                        if (specs->weightType == WEIGHT_RIGID_OMNI)
+                            sphScattererModalCoeffsTable(cache->hBesselTable, order, kr, kR, HYBRID_BANDS, cache->bN);
+                        else if (specs->weightType == WEIGHT_RIGID_CARD)
+                            sphScattererDirModalCoeffsTable(cache->hBesselTable, order, kr, kR, HYBRID_BANDS, 0.5, cache->bN);
+                        else if (specs->weightType == WEIGHT_RIGID_DIPOLE)
+                            sphScattererDirModalCoeffsTable(cache->hBesselTable, order, kr, kR, HYBRID_BANDS, 0.0, cache->bN);
+                    }
+                    break;
+            }
+            break;
+    }
+    cache->bN_valid = 1;
+    cache->bN_order = order;
+    cache->bN_fs = enc->fs;
+    cache->bN_arrayType = specs->arrayType;
+    cache->bN_weightType = specs->weightType;
+    cache->bN_r = specs->r;
+    cache->bN_R = specs->R;
+    cache->bN_c = enc->c;
+    return cache->bN;
+}
+
+/**
+ * Returns the theoretical diffuse coherence matrices for the (spherical) array
+ * of 'enc'; FLAT: Q x Q x HYBRID_BANDS. As with array2sh_getModalCoeffs(),
+ * these are only recomputed if the array, speed of sound or sampling rate have
+ * changed since the previous build.
+ */
+static const double* array2sh_getDiffCohMtx
+(
+    array2sh_data* pData,
+    array2sh_encoder* enc,
+    double* kr,
+    double* kR
+)
+{
+    array2sh_filterCache* cache = &(pData->cache);
+    array2sh_arrayPars* specs = &(enc->specs);
+    int Q, array_order;
+    float f_max, kR_max;
+    
+    Q = specs->Q;
+    if(cache->dcoh_valid && cache->dcoh_Q==Q && cache->dcoh_fs==enc->fs &&
+       cache->dcoh_arrayType==specs->arrayType && cache->dcoh_weightType==specs->weightType &&
+       cache->dcoh_r==specs->r && cache->dcoh_R==specs->R && cache->dcoh_c==enc->c &&
+       !memcmp(cache->dcoh_sensorCoords_rad, specs->sensorCoords_rad, Q*2*sizeof(float)))
+        return cache->dM_diffcoh;
+    
+    cache->dcoh_valid = 0;
+    cache->dM_diffcoh = realloc1d(cache->dM_diffcoh, Q*Q*(HYBRID_BANDS)*sizeof(double));
+    f_max = 20e3f;
+    kR_max = 2.0f*M_PI*f_max*(specs->r)/enc->c;
+    array_order = (int)(ceilf(2.0f*kR_max)+0.01f);
+    switch (specs->weightType){
+        case WEIGHT_RIGID_OMNI:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_RIGID, 1.0, kr, kR, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+        case WEIGHT_RIGID_CARD:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.5, kr, kR, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+        case WEIGHT_RIGID_DIPOLE:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.0, kr, kR, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+        case WEIGHT_OPEN_OMNI:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_OPEN, 1.0, kr, NULL, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+        case WEIGHT_OPEN_CARD:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, kr, NULL, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+        case WEIGHT_OPEN_DIPOLE:
+            sphDiffCohMtxTheoryCached(array_order, (float*)specs->sensorCoords_rad, Q, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, kr, NULL, HYBRID_BANDS, cache->dM_diffcoh);
+            break;
+    }
+    cache->dcoh_valid = 1;
+    cache->dcoh_Q = Q;
+    cache->dcoh_fs = enc->fs;
+    cache->dcoh_arrayType = specs->arrayType;
+    cache->dcoh_weightType = specs->weightType;
+    cache->dcoh_r = specs->r;
+    cache->dcoh_R = specs->R;
+    cache->dcoh_c = enc->c;
+    memcpy(cache->dcoh_sensorCoords_rad, specs->sensorCoords_rad, Q*2*sizeof(float));
+    return cache->dM_diffcoh;
+}
+
+/**
+ * Computes the encoding matrices of 'enc' from the measured array responses
+ * of the file 'enc->measuredPath', taking the bin nearest to each band
+ *
+ * @returns 1 if successful; 0 if the file could not be read, or does not
+ *          match the current number of sensors (enc->measuredPath is then
+ *          cleared, and the analytic model should be used instead)
+ */
+static int array2sh_buildMeasuredEncoder
+(
+    array2sh_data* pData,
+    array2sh_encoder* enc
+)
+{
+    void* hResp, *hWork;
+    int band, n;
+    const float_complex* H[HYBRID_BANDS];
+    
+    if(!saf_arrayResponses_open(&hResp, enc->measuredPath) ||
+       saf_arrayResponses_getNumSensors(hResp)!=enc->specs.Q){
+        saf_arrayResponses_close(&hResp);
+        free(enc->measuredPath);
+        enc->measuredPath = NULL;
+        return 0;
+    }
+    for(band=0; band<HYBRID_BANDS; band++)
+        H[band] = saf_arrayResponses_getBin(hResp, saf_arrayResponses_findBin(hResp, pData->freqVector[band]));
+    measuredArrayWorkspace_create(&hWork, enc->order, enc->specs.Q, saf_arrayResponses_getDirs_deg(hResp),
+                                  saf_arrayResponses_getNumDirs(hResp));
+    measuredArrayEncodingFilters(hWork, H, HYBRID_BANDS, enc->regPar, MAX_NUM_SENSORS,
+                                 MAX_NUM_SH_SIGNALS*MAX_NUM_SENSORS, &(enc->W[0][0][0]));
+    measuredArrayWorkspace_destroy(&hWork);
+    saf_arrayResponses_close(&hResp);
+    
+    /* (the modal responses do not apply, and are displayed as 0dB) */
+    for(band=0; band<HYBRID_BANDS; band++){
+        for(n=0; n<enc->order+1; n++){
+            enc->bN_modal[band][n] = cmplx(1.0, 0.0);
+            enc->bN_inv[band][n] = cmplx(1.0, 0.0);
+        }
+    }
+    return 1;
 }
 
 void array2sh_initTFT
@@ -71,7 +262,7 @@ void array2sh_initTFT
     new_nSH = (pData->new_order+1)*(pData->new_order+1);
     nSH = (pData->order+1)*(pData->order+1);
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, arraySpecs->newQ, new_nSH, 0, 1);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, arraySpecs->newQ, new_nSH, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     else if(arraySpecs->newQ != arraySpecs->Q || nSH != new_nSH){
         afSTFTchannelChange(pData->hSTFT, arraySpecs->newQ, new_nSH);
         afSTFTclearBuffers(pData->hSTFT); 
@@ -80,126 +271,118 @@ void array2sh_initTFT
     arraySpecs->Q = arraySpecs->newQ;
 }
 
-void array2sh_calculate_sht_matrix
+void* array2sh_buildEncoder
 (
-    void* const hA2sh
+    void* const hA2sh,
+    void* const hAsync
 )
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
+    array2sh_encoder* enc;
+    array2sh_arrayPars* specs;
     int i, j, band, n, order, nSH;
     double alpha, beta, g_lim, regPar;
     double kr[HYBRID_BANDS], kR[HYBRID_BANDS];
+    double_complex bN[HYBRID_BANDS*(MAX_SH_ORDER + 1)];
     float* Y_mic, *pinv_Y_mic;
     float_complex* pinv_Y_mic_cmplx, *diag_bN_inv_R;
     const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta  = cmplxf(0.0f, 0.0f);
     
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    
+    /* take a copy of the parameters, which may change during the build */
+    enc = (array2sh_encoder*)calloc1d(1, sizeof(array2sh_encoder));
+    memcpy(&(enc->specs), pData->arraySpecs, sizeof(array2sh_arrayPars));
+    enc->order = pData->new_order;
+    enc->filterType = pData->filterType;
+    enc->regPar = pData->regPar;
+    enc->c = pData->c;
+    enc->enableDiffEQpastAliasing = pData->enableDiffEQpastAliasing;
+    enc->fs = pData->fs;
+    enc->useTimeDomain = array2sh_getTimeDomainFLAG(hA2sh, enc->order);
+    enc->measuredPath = NULL;
+    if(pData->measured_filepath!=NULL){
+        enc->measuredPath = malloc1d(strlen(pData->measured_filepath) + 1);
+        strcpy(enc->measuredPath, pData->measured_filepath);
+    }
+    specs = &(enc->specs);
+    
     /* prep */
-    order = pData->new_order;
+    order = enc->order;
     nSH = (order+1)*(order+1);
-    arraySpecs->R = MIN(arraySpecs->R, arraySpecs->r);
+    specs->R = MIN(specs->R, specs->r);
     for(band=0; band<HYBRID_BANDS; band++){
-        kr[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->r)/pData->c;
-        kR[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->R)/pData->c;
+        kr[band] = 2.0*M_PI*(pData->freqVector[band])*(specs->r)/enc->c;
+        kR[band] = 2.0*M_PI*(pData->freqVector[band])*(specs->R)/enc->c;
     }
     
     /* Spherical harmponic weights for each sensor direction */
-    Y_mic = malloc1d(nSH*(arraySpecs->Q)*sizeof(float));
-    getRSH(order, (float*)arraySpecs->sensorCoords_deg, arraySpecs->Q, Y_mic); /* nSH x Q */
-    pinv_Y_mic = malloc1d( arraySpecs->Q * nSH *sizeof(float));
-    utility_spinv(Y_mic, nSH, arraySpecs->Q, pinv_Y_mic);
-    pinv_Y_mic_cmplx =  malloc1d((arraySpecs->Q) * nSH *sizeof(float_complex));
-    for(i=0; i<(arraySpecs->Q)*nSH; i++)
+    Y_mic = malloc1d(nSH*(specs->Q)*sizeof(float));
+    getRSH(order, (float*)specs->sensorCoords_deg, specs->Q, Y_mic); /* nSH x Q */
+    pinv_Y_mic = malloc1d( specs->Q * nSH *sizeof(float));
+    utility_spinv(NULL, Y_mic, nSH, specs->Q, pinv_Y_mic);
+    pinv_Y_mic_cmplx =  malloc1d((specs->Q) * nSH *sizeof(float_complex));
+    for(i=0; i<(specs->Q)*nSH; i++)
         pinv_Y_mic_cmplx[i] = cmplxf(pinv_Y_mic[i], 0.0f);
     
+    /* ---------------------------------------------------------------------------- */
+    /* Encoding filters based on measured array responses (if given, and readable): */
+    /* ---------------------------------------------------------------------------- */
+    if(enc->measuredPath!=NULL && array2sh_buildMeasuredEncoder(pData, enc)){
+        /* (see array2sh_buildMeasuredEncoder()) */
+    }
+    
     /* ------------------------------------------------------------------------------ */
     /* Encoding filters based on the regularised inversion of the modal coefficients: */
     /* ------------------------------------------------------------------------------ */
-    if ( (pData->filterType==FILTER_SOFT_LIM) || (pData->filterType==FILTER_TIKHONOV) ){
+    else if ( (enc->filterType==FILTER_SOFT_LIM) || (enc->filterType==FILTER_TIKHONOV) ){
         /* Compute modal responses */
-        free(pData->bN);
-        pData->bN = malloc1d((HYBRID_BANDS)*(order+1)*sizeof(double_complex));
-        switch(arraySpecs->arrayType){
-            case ARRAY_CYLINDRICAL:
-                switch (arraySpecs->weightType){
-                    case WEIGHT_RIGID_OMNI:   cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, pData->bN); break;
-                    case WEIGHT_RIGID_CARD:   /* not supported */ break;
-                    case WEIGHT_RIGID_DIPOLE: /* not supported */ break;
-                    case WEIGHT_OPEN_OMNI:    cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, pData->bN);  break;
-                    case WEIGHT_OPEN_CARD:    /* not supported */ break;
-                    case WEIGHT_OPEN_DIPOLE:  /* not supported */ break;
-                }
-                break;
-            case ARRAY_SPHERICAL:
-                switch (arraySpecs->weightType){
-                    case WEIGHT_OPEN_OMNI:   sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, 1.0, pData->bN); break;
-                    case WEIGHT_OPEN_CARD:   sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, pData->bN); break;
-                    case WEIGHT_OPEN_DIPOLE: sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, pData->bN); break;
-                    case WEIGHT_RIGID_OMNI:
-                    case WEIGHT_RIGID_CARD:
-                    case WEIGHT_RIGID_DIPOLE:
-                        /* if sensors are flushed with the rigid baffle: */
-                        if(arraySpecs->R == arraySpecs->r )
-                            sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, 1.0, pData->bN);
-
-                        /* if sensors protrude from the rigid baffle: */
-                        else{
-                            if (arraySpecs->weightType == WEIGHT_RIGID_OMNI)
-                                sphScattererModalCoeffs(order, kr, kR, HYBRID_BANDS, pData->bN);
-                            else if (arraySpecs->weightType == WEIGHT_RIGID_CARD)
-                                sphScattererDirModalCoeffs(order, kr, kR, HYBRID_BANDS, 0.5, pData->bN);
-                            else if (arraySpecs->weightType == WEIGHT_RIGID_DIPOLE)
-                                sphScattererDirModalCoeffs(order, kr, kR, HYBRID_BANDS, 0.0, pData->bN);
-                        }
-                        break;
-                }
-                break;
-        }
+        memcpy(bN, array2sh_getModalCoeffs(pData, enc, kr, kR), HYBRID_BANDS*(order+1)*sizeof(double_complex));
         
         for(band=0; band<HYBRID_BANDS; band++)
             for(n=0; n < order+1; n++)
-                pData->bN[band*(order+1)+n] = ccdiv(pData->bN[band*(order+1)+n], cmplx(4.0*M_PI, 0.0f)); /* 4pi term */
+                bN[band*(order+1)+n] = ccdiv(bN[band*(order+1)+n], cmplx(4.0*M_PI, 0.0f)); /* 4pi term */
 
         /* direct inverse */
-        regPar = pData->regPar;
+        regPar = enc->regPar;
         for(band=0; band<HYBRID_BANDS; band++)
             for(n=0; n < order+1; n++)
-                pData->bN_modal[band][n] = ccdiv(cmplx(1.0,0.0), (pData->bN[band*(order+1)+n]));
+                enc->bN_modal[band][n] = ccdiv(cmplx(1.0,0.0), (bN[band*(order+1)+n]));
         
         /* regularised inverse */
-        if (pData->filterType == FILTER_SOFT_LIM){
+        if (enc->filterType == FILTER_SOFT_LIM){
             /* Bernschutz, B., Porschmann, C., Spors, S., Weinzierl, S., Versterkung, B., 2011. Soft-limiting der
              modalen amplitudenverst?rkung bei sph?rischen mikrofonarrays im plane wave decomposition verfahren.
              Proceedings of the 37. Deutsche Jahrestagung fur Akustik (DAGA 2011) */
-            g_lim = sqrt(arraySpecs->Q)*pow(10.0,(regPar/20.0));
+            g_lim = sqrt(specs->Q)*pow(10.0,(regPar/20.0));
             for(band=0; band<HYBRID_BANDS; band++)
                 for(n=0; n < order+1; n++)
-                    pData->bN_inv[band][n] = crmul(pData->bN_modal[band][n], (2.0*g_lim*cabs(pData->bN[band*(order+1)+n]) / M_PI)
-                                                     * atan(M_PI / (2.0*g_lim*cabs(pData->bN[band*(order+1)+n]))) );
+                    enc->bN_inv[band][n] = crmul(enc->bN_modal[band][n], (2.0*g_lim*cabs(bN[band*(order+1)+n]) / M_PI)
+                                                     * atan(M_PI / (2.0*g_lim*cabs(bN[band*(order+1)+n]))) );
         }
-        else if(pData->filterType == FILTER_TIKHONOV){
+        else if(enc->filterType == FILTER_TIKHONOV){
             /* Moreau, S., Daniel, J., Bertet, S., 2006, 3D sound field recording with higher order ambisonics-objective
              measurements and validation of spherical microphone. In Audio Engineering Society Convention 120. */
-            alpha = sqrt(arraySpecs->Q)*pow(10.0,(regPar/20.0));
+            alpha = sqrt(specs->Q)*pow(10.0,(regPar/20.0));
             for(band=0; band<HYBRID_BANDS; band++){
                 for(n=0; n < order+1; n++){
                     beta = sqrt((1.0-sqrt(1.0-1.0/ pow(alpha,2.0)))/(1.0+sqrt(1.0-1.0/pow(alpha,2.0))));
-                    pData->bN_inv[band][n] = ccdiv(conj(pData->bN[band*(order+1)+n]), cmplx((pow(cabs(pData->bN[band*(order+1)+n]), 2.0) + pow(beta, 2.0)),0.0));
+                    enc->bN_inv[band][n] = ccdiv(conj(bN[band*(order+1)+n]), cmplx((pow(cabs(bN[band*(order+1)+n]), 2.0) + pow(beta, 2.0)),0.0));
                 }
             }
         }
         
         /* diag(filters) * Y */
-        array2sh_replicate_order(hA2sh, order); /* replicate orders */
+        array2sh_replicate_order(enc, order); /* replicate orders */
         
         diag_bN_inv_R = calloc1d(nSH*nSH, sizeof(float_complex));
         for(band=0; band<HYBRID_BANDS; band++){
             for(i=0; i<nSH; i++)
-                diag_bN_inv_R[i*nSH+i] = cmplxf((float)creal(pData->bN_inv_R[band][i]), (float)cimag(pData->bN_inv_R[band][i]));
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, (arraySpecs->Q), nSH, &calpha,
+                diag_bN_inv_R[i*nSH+i] = cmplxf((float)creal(enc->bN_inv_R[band][i]), (float)cimag(enc->bN_inv_R[band][i]));
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, (specs->Q), nSH, &calpha,
                         diag_bN_inv_R, nSH,
                         pinv_Y_mic_cmplx, nSH, &cbeta,
-                        pData->W[band], MAX_NUM_SENSORS);
+                        enc->W[band], MAX_NUM_SENSORS);
         }
         free(diag_bN_inv_R);
     }
@@ -207,7 +390,7 @@ void array2sh_calculate_sht_matrix
     /* ------------------------------------------------------------- */
     /* Encoding filters based on a linear-phase filter-bank approach */
     /* ------------------------------------------------------------- */
-    else if ( (pData->filterType==FILTER_Z_STYLE) || (pData->filterType==FILTER_Z_STYLE_MAXRE) ) {
+    else if ( (enc->filterType==FILTER_Z_STYLE) || (enc->filterType==FILTER_Z_STYLE_MAXRE) ) {
         /* Zotter, F. A Linear-Phase Filter-Bank Approach to Process Rigid Spherical Microphone Array Recordings. */
         double normH;
         float f_lim[MAX_SH_ORDER+1];
@@ -215,15 +398,15 @@ void array2sh_calculate_sht_matrix
         double_complex Hs[HYBRID_BANDS][MAX_SH_ORDER+1];
         
         /* find suitable cut-off frequencies */
-        switch (arraySpecs->weightType){
-            case WEIGHT_OPEN_OMNI:   sphArrayNoiseThreshold(order, arraySpecs->Q, arraySpecs->r, pData->c, ARRAY_CONSTRUCTION_OPEN, 1.0, pData->regPar, f_lim); break;
-            case WEIGHT_OPEN_CARD:   sphArrayNoiseThreshold(order, arraySpecs->Q, arraySpecs->r, pData->c, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, pData->regPar, f_lim); break;
-            case WEIGHT_OPEN_DIPOLE: sphArrayNoiseThreshold(order, arraySpecs->Q, arraySpecs->r, pData->c, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, pData->regPar, f_lim); break;
+        switch (specs->weightType){
+            case WEIGHT_OPEN_OMNI:   sphArrayNoiseThreshold(order, specs->Q, specs->r, enc->c, ARRAY_CONSTRUCTION_OPEN, 1.0, enc->regPar, f_lim); break;
+            case WEIGHT_OPEN_CARD:   sphArrayNoiseThreshold(order, specs->Q, specs->r, enc->c, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, enc->regPar, f_lim); break;
+            case WEIGHT_OPEN_DIPOLE: sphArrayNoiseThreshold(order, specs->Q, specs->r, enc->c, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, enc->regPar, f_lim); break;
             case WEIGHT_RIGID_OMNI:
             case WEIGHT_RIGID_CARD:
             case WEIGHT_RIGID_DIPOLE:
                 /* Currently no support for estimating the noise cut-off frequencies for rigid scatterers. */
-                sphArrayNoiseThreshold(order, arraySpecs->Q, arraySpecs->r, pData->c, ARRAY_CONSTRUCTION_RIGID, 1.0, pData->regPar, f_lim); break;
+                sphArrayNoiseThreshold(order, specs->Q, specs->r, enc->c, ARRAY_CONSTRUCTION_RIGID, 1.0, enc->regPar, f_lim); break;
         }
         
         /* design prototype filterbank */
@@ -247,54 +430,17 @@ void array2sh_calculate_sht_matrix
         }
                 
         /* compute inverse radial response */ 
-        free(pData->bN);
-        pData->bN = malloc1d((HYBRID_BANDS)*(order+1)*sizeof(double_complex));
-        switch(arraySpecs->arrayType){
-            case ARRAY_CYLINDRICAL:
-                switch (arraySpecs->weightType){
-                    case WEIGHT_RIGID_OMNI:   cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, pData->bN); break;
-                    case WEIGHT_RIGID_CARD:   /* not supported */ break;
-                    case WEIGHT_RIGID_DIPOLE: /* not supported */ break;
-                    case WEIGHT_OPEN_OMNI:    cylModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, pData->bN);  break;
-                    case WEIGHT_OPEN_CARD:    /* not supported */ break;
-                    case WEIGHT_OPEN_DIPOLE:  /* not supported */ break;
-                }
-                break;
-            case ARRAY_SPHERICAL:
-                switch (arraySpecs->weightType){
-                    case WEIGHT_OPEN_OMNI:   sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN, 1.0, pData->bN); break;
-                    case WEIGHT_OPEN_CARD:   sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, pData->bN); break;
-                    case WEIGHT_OPEN_DIPOLE: sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, pData->bN); break;
-                    case WEIGHT_RIGID_OMNI:
-                    case WEIGHT_RIGID_CARD:
-                    case WEIGHT_RIGID_DIPOLE:
-                        /* if sensors are flushed with the rigid baffle: */
-                        if(arraySpecs->R == arraySpecs->r )
-                            sphModalCoeffs(order, kr, HYBRID_BANDS, ARRAY_CONSTRUCTION_RIGID, 1.0, pData->bN);
-                        
-                        /* if sensors protrude from the rigid baffle: */
-                        else{
-                            if (arraySpecs->weightType == WEIGHT_RIGID_OMNI)
-                                sphScattererModalCoeffs(order, kr, kR, HYBRID_BANDS, pData->bN);
-                            else if (arraySpecs->weightType == WEIGHT_RIGID_CARD)
-                                sphScattererDirModalCoeffs(order, kr, kR, HYBRID_BANDS, 0.5, pData->bN);
-                            else if (arraySpecs->weightType == WEIGHT_RIGID_DIPOLE)
-                                sphScattererDirModalCoeffs(order, kr, kR, HYBRID_BANDS, 0.0, pData->bN);
-                        }
-                        break;
-                }
-                break;
-        }
+        memcpy(bN, array2sh_getModalCoeffs(pData, enc, kr, kR), HYBRID_BANDS*(order+1)*sizeof(double_complex));
         
         /* direct inverse (only required for GUI) */
         for(band=0; band<HYBRID_BANDS; band++)
             for(n=0; n < order+1; n++)
-                pData->bN_modal[band][n] = ccdiv(cmplx(4.0*M_PI, 0.0f), pData->bN[band*(order+1)+n]);
+                enc->bN_modal[band][n] = ccdiv(cmplx(4.0*M_PI, 0.0f), bN[band*(order+1)+n]);
 
         /* phase shift */
         for(band=0; band<HYBRID_BANDS; band++)
             for (n=0; n<order+1; n++)
-                Hs[band][n] = ccmul(cexp(cmplx(0.0, kr[band])), ccdiv(cmplx(4.0*M_PI, 0.0), pData->bN[band*(order+1)+n]));
+                Hs[band][n] = ccmul(cexp(cmplx(0.0, kr[band])), ccdiv(cmplx(4.0*M_PI, 0.0), bN[band*(order+1)+n]));
         
         /* apply max-re order weighting and diffuse equalisation (not the same as "array2sh_apply_diff_EQ") */
         float* wn;
@@ -305,10 +451,10 @@ void array2sh_calculate_sht_matrix
         for (n=0; n<order+1; n++){
             nSH_n = (n+1)*(n+1);
             wn = calloc1d(nSH_n*nSH_n, sizeof(float));
-            if(pData->filterType==FILTER_Z_STYLE)
+            if(enc->filterType==FILTER_Z_STYLE)
                 for (i=0; i<n+1; i++)
                     wn[(i*i)*nSH_n+(i*i)] = 1.0f;
-            else if(pData->filterType==FILTER_Z_STYLE_MAXRE)
+            else if(enc->filterType==FILTER_Z_STYLE_MAXRE)
                 getMaxREweights(n, 1, wn);
             scale = 0.0;
             for (i=0; i<n+1; i++)
@@ -337,41 +483,145 @@ void array2sh_calculate_sht_matrix
                         (const double*)W_np, MAX_SH_ORDER+1, 0.0,
                         (double*)HW, 1);
             for(band=0; band<HYBRID_BANDS; band++)
-                pData->bN_inv[band][n] = crmul(Hs[band][n], HW[band]);
+                enc->bN_inv[band][n] = crmul(Hs[band][n], HW[band]);
         }
         
         /* diag(filters) * Y */
-        array2sh_replicate_order(hA2sh, order); /* replicate orders */
+        array2sh_replicate_order(enc, order); /* replicate orders */
         diag_bN_inv_R = calloc1d(nSH*nSH, sizeof(float_complex));
         for(band=0; band<HYBRID_BANDS; band++){
             for(i=0; i<nSH; i++)
-                diag_bN_inv_R[i*nSH+i] = cmplxf((float)creal(pData->bN_inv_R[band][i]), (float)cimag(pData->bN_inv_R[band][i])); /* double->single */
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, (arraySpecs->Q), nSH, &calpha,
+                diag_bN_inv_R[i*nSH+i] = cmplxf((float)creal(enc->bN_inv_R[band][i]), (float)cimag(enc->bN_inv_R[band][i])); /* double->single */
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, (specs->Q), nSH, &calpha,
                         diag_bN_inv_R, nSH,
                         pinv_Y_mic_cmplx, nSH, &cbeta,
-                        pData->W[band], MAX_NUM_SENSORS);
+                        enc->W[band], MAX_NUM_SENSORS);
         }
         free(diag_bN_inv_R);
         
     }
-     
-    pData->order = order;
-    
-    if(pData->enableDiffEQpastAliasing)
-        array2sh_apply_diff_EQ(hA2sh);
-    
     free(Y_mic);
     free(pinv_Y_mic);
     free(pinv_Y_mic_cmplx);
+    
+    /* diffuse-field equalisation past aliasing (of the analytic model) */
+    if(enc->enableDiffEQpastAliasing && enc->measuredPath==NULL && !(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync)))
+        array2sh_apply_diff_EQ(hA2sh, enc);
+    
+    /* magnitude response curves (for the GUI) */
+    array2sh_calculate_mag_curves(enc);
+    
+    /* FIR encoding filters, if encoding in the time-domain */
+    if(enc->useTimeDomain && !(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync)))
+        array2sh_buildTimeDomainEncoder(hA2sh, enc);
+    
+    saf_telemetry_reinitEnd(pData->hTelemetry);
+    if(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync)){
+        array2sh_destroyEncoder(hA2sh, (void*)enc);
+        return NULL;
+    }
+    return (void*)enc;
+}
+
+void array2sh_destroyEncoder
+(
+    void* const hA2sh,
+    void* encoder
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    array2sh_encoder* enc = (array2sh_encoder*)encoder;
+    
+    if(enc!=NULL){
+        /* not safe to free, while array2sh_evaluateSHTfilters() is reading it */
+        while(pData->evalCopyingFLAG)
+            SAF_SLEEP(1);
+        if(enc->hMatrixConv!=NULL)
+            saf_matrixConv_destroy(&(enc->hMatrixConv));
+        free(enc->measuredPath);
+        free(enc);
+    }
+}
+
+int array2sh_getTimeDomainFLAG
+(
+    void* const hA2sh,
+    int order
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return pData->domain==ENCODING_DOMAIN_TIME ||
+           (pData->domain==ENCODING_DOMAIN_AUTO && order<=ARRAY2SH_TIME_DOMAIN_MAX_ORDER);
+}
+
+void array2sh_buildTimeDomainEncoder
+(
+    void* const hA2sh,
+    array2sh_encoder* enc
+)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    int i, q, k, band, nSH, Q, nBins;
+    float f_k, frac;
+    float* win, *filters, *h;
+    float_complex* H;
+    void* hFFT;
+    
+    nSH = (enc->order+1)*(enc->order+1);
+    Q = enc->specs.Q;
+    nBins = TD_FILTER_LENGTH/2 + 1;
+    H = malloc1d(nBins*sizeof(float_complex));
+    win = malloc1d(TD_FILTER_LENGTH*sizeof(float));
+    getWindowingFunction(WINDOWING_FUNCTION_HANN, TD_FILTER_LENGTH, win);
+    saf_rfft_create(&hFFT, TD_FILTER_LENGTH);
+    
+    /* FIR filters; FLAT: nSH x Q x TD_FILTER_LENGTH, i.e. nCHout x nCHin x
+     * length_h, as expected by saf_matrixConv */
+    filters = malloc1d(nSH*Q*TD_FILTER_LENGTH*sizeof(float));
+    for(i=0; i<nSH; i++){
+        for(q=0; q<Q; q++){
+            band = 0;
+            for(k=0; k<nBins; k++){
+                /* interpolate between the two nearest band centre frequencies */
+                f_k = (float)k*(float)enc->fs/(float)TD_FILTER_LENGTH;
+                while(band<HYBRID_BANDS-2 && pData->freqVector[band+1]<f_k)
+                    band++;
+                frac = (f_k-pData->freqVector[band])/(pData->freqVector[band+1]-pData->freqVector[band]);
+                frac = CLAMP(frac, 0.0f, 1.0f);
+                H[k] = ccaddf(crmulf(enc->W[band][i][q], 1.0f-frac), crmulf(enc->W[band+1][i][q], frac));
+                
+                /* delay by half of the filter length, i.e. exp(-j*pi*k) */
+                if(k%2==1)
+                    H[k] = crmulf(H[k], -1.0f);
+            }
+            H[0] = cmplxf(crealf(H[0]), 0.0f);
+            H[nBins-1] = cmplxf(crealf(H[nBins-1]), 0.0f);
+            h = &filters[(i*Q+q)*TD_FILTER_LENGTH];
+            saf_rfft_backward(hFFT, H, h);
+            utility_svvmul(h, win, TD_FILTER_LENGTH, h);
+        }
+    }
+    saf_matrixConv_create(&(enc->hMatrixConv), FRAME_SIZE, filters, TD_FILTER_LENGTH, Q, nSH, 1);
+    
+    saf_rfft_destroy(&hFFT);
+    free(H);
+    free(win);
+    free(filters);
 }
 
+
+
 /* Based on a MatLab script by Archontis Politis, 2019 */
-void array2sh_apply_diff_EQ(void* const hA2sh)
+void array2sh_apply_diff_EQ
+(
+    void* const hA2sh,
+    array2sh_encoder* enc
+)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
-    int i, j, band, array_order, idxf_alias, nSH;
-    float f_max, kR_max, f_alias, f_f_alias;
+    array2sh_arrayPars* arraySpecs = &(enc->specs);
+    int i, j, band, idxf_alias, nSH;
+    float f_alias, f_f_alias;
     double_complex* dM_diffcoh_s;
     const double_complex calpha = cmplx(1.0, 0.0); const double_complex cbeta  = cmplx(0.0, 0.0);
     double kr[HYBRID_BANDS], kR[HYBRID_BANDS];
@@ -380,54 +630,24 @@ void array2sh_apply_diff_EQ(void* const hA2sh)
     double_complex E_diff[MAX_NUM_SH_SIGNALS][MAX_NUM_SENSORS];
     double_complex W_diffEQ[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
     double_complex W_tmp[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
-    double* dM_diffcoh; 
+    const double* dM_diffcoh;
     
     if(arraySpecs->arrayType==ARRAY_CYLINDRICAL)
         return; /* unsupported */
     
     /* prep */
-    nSH = (pData->order+1)*(pData->order+1);
-    dM_diffcoh = malloc1d((arraySpecs->Q)*(arraySpecs->Q)* (HYBRID_BANDS) * sizeof(double_complex));
+    nSH = (enc->order+1)*(enc->order+1);
     dM_diffcoh_s = malloc1d((arraySpecs->Q)*(arraySpecs->Q) * sizeof(double_complex));
-    f_max = 20e3f;
-    kR_max = 2.0f*M_PI*f_max*(arraySpecs->r)/pData->c;
-    array_order = (int)(ceilf(2.0f*kR_max)+0.01f);
     for(band=0; band<HYBRID_BANDS; band++){
-        kr[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->r)/pData->c;
-        kR[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->R)/pData->c;
+        kr[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->r)/enc->c;
+        kR[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->R)/enc->c;
     }
     
-    /* Get theoretical diffuse coherence matrix */
-    switch(arraySpecs->arrayType){
-        case ARRAY_CYLINDRICAL:
-            return; /* Unsupported */
-            break;
-        case ARRAY_SPHERICAL:
-            switch (arraySpecs->weightType){
-                case WEIGHT_RIGID_OMNI:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_RIGID, 1.0, kr, kR, HYBRID_BANDS, dM_diffcoh);
-                    break;
-                case WEIGHT_RIGID_CARD:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.5, kr, kR, HYBRID_BANDS, dM_diffcoh);
-                    break;
-                case WEIGHT_RIGID_DIPOLE:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.0, kr, kR, HYBRID_BANDS, dM_diffcoh);
-                    break;
-                case WEIGHT_OPEN_OMNI:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_OPEN, 1.0, kr, NULL, HYBRID_BANDS, dM_diffcoh);
-                    break;
-                case WEIGHT_OPEN_CARD:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, kr, NULL, HYBRID_BANDS, dM_diffcoh);
-                    break;
-                case WEIGHT_OPEN_DIPOLE:
-                    sphDiffCohMtxTheory(array_order, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, kr, NULL, HYBRID_BANDS, dM_diffcoh);
-                    break;
-            }
-            break;
-    }
+    /* Get theoretical diffuse coherence matrix (cached across builds) */
+    dM_diffcoh = array2sh_getDiffCohMtx(pData, enc, kr, kR);
     
     /* determine band index for the spatial aliasing limit */
-    f_alias = sphArrayAliasLim(arraySpecs->r, pData->c, pData->order);
+    f_alias = sphArrayAliasLim(arraySpecs->r, enc->c, enc->order);
     idxf_alias = 1;
     f_f_alias = 1e13f;
     for(band=0; band<HYBRID_BANDS; band++){
@@ -443,7 +663,7 @@ void array2sh_apply_diff_EQ(void* const hA2sh)
             dM_diffcoh_s[i*(arraySpecs->Q)+j] = cmplx(dM_diffcoh[i*(arraySpecs->Q)* (HYBRID_BANDS) + j*(HYBRID_BANDS) + (idxf_alias)], 0.0);
     for(i=0; i<nSH; i++)
         for(j=0; j<arraySpecs->Q; j++)
-            W_tmp[i][j]= cmplx((double)crealf(pData->W[idxf_alias][i][j]), (double)cimagf(pData->W[idxf_alias][i][j]));
+            W_tmp[i][j]= cmplx((double)crealf(enc->W[idxf_alias][i][j]), (double)cimagf(enc->W[idxf_alias][i][j]));
     cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, (arraySpecs->Q), (arraySpecs->Q), &calpha,
                 W_tmp, MAX_NUM_SENSORS,
                 dM_diffcoh_s, (arraySpecs->Q), &cbeta,
@@ -462,7 +682,7 @@ void array2sh_apply_diff_EQ(void* const hA2sh)
                 dM_diffcoh_s[i*(arraySpecs->Q)+j] = cmplx(dM_diffcoh[i*(arraySpecs->Q)* (HYBRID_BANDS) + j*(HYBRID_BANDS) + (band)], 0.0);
         for(i=0; i<nSH; i++)
             for(j=0; j<arraySpecs->Q; j++)
-                W_tmp[i][j]= cmplx((double)crealf(pData->W[band][i][j]), (double)cimagf(pData->W[band][i][j]));
+                W_tmp[i][j]= cmplx((double)crealf(enc->W[band][i][j]), (double)cimagf(enc->W[band][i][j]));
         cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, (arraySpecs->Q), (arraySpecs->Q), &calpha,
                     W_tmp, MAX_NUM_SENSORS,
                     dM_diffcoh_s, (arraySpecs->Q), &cbeta,
@@ -480,24 +700,20 @@ void array2sh_apply_diff_EQ(void* const hA2sh)
                     W_diffEQ, MAX_NUM_SENSORS);
         for(i=0; i<nSH; i++)
             for(j=0; j<arraySpecs->Q; j++)
-                pData->W[band][i][j] = cmplxf((float)creal(W_diffEQ[i][j]), (float)cimag(W_diffEQ[i][j]));
+                enc->W[band][i][j] = cmplxf((float)creal(W_diffEQ[i][j]), (float)cimag(W_diffEQ[i][j]));
     }
     
-    pData->evalStatus = EVAL_STATUS_NOT_EVALUATED;
-    
-    free(dM_diffcoh);
     free(dM_diffcoh_s);
 }
 
-void array2sh_calculate_mag_curves(void* const hA2sh)
+void array2sh_calculate_mag_curves(array2sh_encoder* enc)
 {
-    array2sh_data *pData = (array2sh_data*)(hA2sh);
     int band, n;
     
     for(band = 0; band <HYBRID_BANDS; band++){
-        for(n = 0; n <pData->order+1; n++){
-            pData->bN_inv_dB[band][n] = 20.0f * (float)log10(cabs(pData->bN_inv[band][n]));
-            pData->bN_modal_dB[band][n] = 20.0f * (float)log10(cabs(pData->bN_modal[band][n]));
+        for(n = 0; n <enc->order+1; n++){
+            enc->bN_inv_dB[band][n] = 20.0f * (float)log10(cabs(enc->bN_inv[band][n]));
+            enc->bN_modal_dB[band][n] = 20.0f * (float)log10(cabs(enc->bN_modal[band][n]));
         }
     }
 }
@@ -505,98 +721,185 @@ void array2sh_calculate_mag_curves(void* const hA2sh)
 void array2sh_evaluateSHTfilters(void* hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    array2sh_arrayPars* arraySpecs = (array2sh_arrayPars*)(pData->arraySpecs);
-    int band, i, j, simOrder, order, nSH;
+    array2sh_encoder* enc;
+    array2sh_arrayPars specs;
+    array2sh_arrayPars* arraySpecs = &specs;
+    int band, i, j, n, simOrder, order, nSH, nEvalBands, nGrid, b0, b1;
+    int evalBands[HYBRID_BANDS];
+    float c, a;
     double kr[HYBRID_BANDS];
     double kR[HYBRID_BANDS];
-    float* Y_grid_real;
+    float* Y_grid_real, *grid_dirs_deg, *cSH_eval, *lSH_eval;
     float_complex* Y_grid, *H_array, *Wshort;
-     
-    assert(pData->W != NULL);
+    char* measuredPath;
+    void* hPar, *hResp;
     
-    strcpy(pData->progressBarText,"Simulating microphone array");
-    pData->progressBar0_1 = 0.35f;
+    /* take a copy of the encoding matrices currently in use, since these may
+     * be swapped out by the processing loop at any time */
+    pData->evalCopyingFLAG = 1;
+    enc = pData->enc;
+    if(enc == NULL){
+        pData->evalCopyingFLAG = 0;
+        return;
+    }
+    order = enc->order;
+    nSH = (order+1)*(order+1);
+    specs = enc->specs;
+    c = enc->c;
     
-    /* simulate the current array by firing 812 plane-waves around the surface of a theoretical version of the array
-     * and ascertaining the transfer function for each */
-    simOrder = (int)(2.0f*M_PI*MAX_EVAL_FREQ_HZ*(arraySpecs->r)/pData->c)+1;
-    for(band=0; band<HYBRID_BANDS; band++){
-        kr[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->r)/pData->c;
-        kR[band] = 2.0*M_PI*(pData->freqVector[band])*(arraySpecs->R)/pData->c;
+    /* The fast mode (intended for the GUI) evaluates only every
+     * EVAL_FAST_BAND_STEP-th band above the lowest EVAL_FAST_NUM_LOW_BANDS (and
+     * the last band), using a coarser grid of simulated directions; the full
+     * mode evaluates every band */
+    if(pData->evalResolution==EVAL_RESOLUTION_FULL){
+        for(band=0; band<HYBRID_BANDS; band++)
+            evalBands[band] = band;
+        nEvalBands = HYBRID_BANDS;
+        grid_dirs_deg = (float*)__geosphere_ico_9_0_dirs_deg;
+        nGrid = 812;
     }
-    H_array = malloc1d((HYBRID_BANDS) * (arraySpecs->Q) * 812*sizeof(float_complex));
-    switch(arraySpecs->arrayType){
-        case ARRAY_SPHERICAL:
-            switch(arraySpecs->weightType){
-                default:
-                case WEIGHT_RIGID_OMNI:
-                    simulateSphArray(simOrder, kr, kR, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_RIGID, 1.0, H_array);
-                    break;
-                case WEIGHT_RIGID_CARD:
-                    simulateSphArray(simOrder, kr, kR, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.5, H_array);
-                    break;
-                case WEIGHT_RIGID_DIPOLE:
-                    simulateSphArray(simOrder, kr, kR, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.0, H_array);
-                    break;
-                case WEIGHT_OPEN_OMNI:
-                    simulateSphArray(simOrder, kr, NULL, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_OPEN, 1.0, H_array);
-                    break;
-                case WEIGHT_OPEN_CARD:
-                    simulateSphArray(simOrder, kr, NULL, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, H_array);
-                    break;
-                case WEIGHT_OPEN_DIPOLE:
-                    simulateSphArray(simOrder, kr, NULL, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
-                                     (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, H_array);
-                    break;
-            }
-            break;
+    else{
+        for(band=0, nEvalBands=0; band<HYBRID_BANDS; band+=(band<EVAL_FAST_NUM_LOW_BANDS ? 1 : EVAL_FAST_BAND_STEP))
+            evalBands[nEvalBands++] = band;
+        if(evalBands[nEvalBands-1]!=HYBRID_BANDS-1)
+            evalBands[nEvalBands++] = HYBRID_BANDS-1;
+        grid_dirs_deg = (float*)__geosphere_ico_5_0_dirs_deg;
+        nGrid = 252;
+    }
+    Wshort = malloc1d(nEvalBands*nSH*(arraySpecs->Q)*sizeof(float_complex));
+    for(band=0; band<nEvalBands; band++)
+        for(i=0; i<nSH; i++)
+            for(j=0; j<(arraySpecs->Q); j++)
+                Wshort[band*nSH*(arraySpecs->Q) + i*(arraySpecs->Q) + j] = enc->W[evalBands[band]][i][j];
+    measuredPath = NULL;
+    if(enc->measuredPath!=NULL){
+        measuredPath = malloc1d(strlen(enc->measuredPath) + 1);
+        strcpy(measuredPath, enc->measuredPath);
+    }
+    pData->evalCopyingFLAG = 0;
+    
+    /* the responses of the array for the grid directions: measured (if the
+     * filters were computed from measurements), or simulated */
+    hResp = NULL;
+    if(measuredPath!=NULL && saf_arrayResponses_open(&hResp, measuredPath) &&
+       saf_arrayResponses_getNumSensors(hResp)==arraySpecs->Q){
+        strcpy(pData->progressBarText,"Reading measured array responses");
+        pData->progressBar0_1 = 0.35f;
+        grid_dirs_deg = (float*)saf_arrayResponses_getDirs_deg(hResp);
+        nGrid = saf_arrayResponses_getNumDirs(hResp);
+        H_array = malloc1d(nEvalBands * (arraySpecs->Q) * nGrid*sizeof(float_complex));
+        for(band=0; band<nEvalBands; band++)
+            memcpy(&H_array[band*(arraySpecs->Q)*nGrid],
+                   saf_arrayResponses_getBin(hResp, saf_arrayResponses_findBin(hResp, pData->freqVector[evalBands[band]])),
+                   (arraySpecs->Q)*nGrid*sizeof(float_complex));
+    }
+    else{
+        strcpy(pData->progressBarText,"Simulating microphone array");
+        pData->progressBar0_1 = 0.35f;
+    
+        /* simulate the current array by firing nGrid plane-waves around the surface of a theoretical version of the array
+         * and ascertaining the transfer function for each */
+        simOrder = (int)(2.0f*M_PI*MAX_EVAL_FREQ_HZ*(arraySpecs->r)/c)+1;
+        for(band=0; band<nEvalBands; band++){
+            kr[band] = 2.0*M_PI*(pData->freqVector[evalBands[band]])*(arraySpecs->r)/c;
+            kR[band] = 2.0*M_PI*(pData->freqVector[evalBands[band]])*(arraySpecs->R)/c;
+        }
+        H_array = malloc1d(nEvalBands * (arraySpecs->Q) * nGrid*sizeof(float_complex));
+        saf_parfor_create(&hPar, SAF_PARFOR_NUM_THREADS_AUTO); /* (split over the bands) */
+        switch(arraySpecs->arrayType){
+            case ARRAY_SPHERICAL:
+                switch(arraySpecs->weightType){
+                    default:
+                    case WEIGHT_RIGID_OMNI:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, kR, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_RIGID, 1.0, H_array);
+                        break;
+                    case WEIGHT_RIGID_CARD:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, kR, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.5, H_array);
+                        break;
+                    case WEIGHT_RIGID_DIPOLE:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, kR, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL, 0.0, H_array);
+                        break;
+                    case WEIGHT_OPEN_OMNI:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, NULL, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_OPEN, 1.0, H_array);
+                        break;
+                    case WEIGHT_OPEN_CARD:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, NULL, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.5, H_array);
+                        break;
+                    case WEIGHT_OPEN_DIPOLE:
+                        simulateSphArrayParallel(hPar, NULL, simOrder, kr, NULL, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q,
+                                         grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, 0.0, H_array);
+                        break;
+                }
+                break;
             
-        case ARRAY_CYLINDRICAL:
-            switch(arraySpecs->weightType){
-                default:
-                case WEIGHT_RIGID_OMNI:
-                case WEIGHT_RIGID_CARD:
-                case WEIGHT_RIGID_DIPOLE:
-                    simulateCylArray(simOrder, kr, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_RIGID, H_array);
-                    break;
-                case WEIGHT_OPEN_DIPOLE:
-                case WEIGHT_OPEN_CARD:
-                case WEIGHT_OPEN_OMNI:
-                    simulateCylArray(simOrder, kr, HYBRID_BANDS, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, (float*)__geosphere_ico_9_0_dirs_deg, 812, ARRAY_CONSTRUCTION_OPEN, H_array);
-                    break;
-            }
-            break;
+            case ARRAY_CYLINDRICAL:
+                switch(arraySpecs->weightType){
+                    default:
+                    case WEIGHT_RIGID_OMNI:
+                    case WEIGHT_RIGID_CARD:
+                    case WEIGHT_RIGID_DIPOLE:
+                        simulateCylArrayParallel(hPar, simOrder, kr, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_RIGID, H_array);
+                        break;
+                    case WEIGHT_OPEN_DIPOLE:
+                    case WEIGHT_OPEN_CARD:
+                    case WEIGHT_OPEN_OMNI:
+                        simulateCylArrayParallel(hPar, simOrder, kr, nEvalBands, (float*)arraySpecs->sensorCoords_rad, arraySpecs->Q, grid_dirs_deg, nGrid, ARRAY_CONSTRUCTION_OPEN, H_array);
+                        break;
+                }
+                break;
+        }
+        saf_parfor_destroy(&hPar);
     }
     
     strcpy(pData->progressBarText,"Evaluating encoding performance");
     pData->progressBar0_1 = 0.8f;
     
     /* generate ideal (real) spherical harmonics to compare with */
-    order = pData->order;
-    nSH = (order+1)*(order+1);
-    Y_grid_real = malloc1d(nSH*812*sizeof(float));
-    getRSH(order, (float*)__geosphere_ico_9_0_dirs_deg, 812, Y_grid_real);
-    Y_grid = malloc1d(nSH*812*sizeof(float_complex));
-    for(i=0; i<nSH*812; i++)
+    Y_grid_real = malloc1d(nSH*nGrid*sizeof(float));
+    getRSH(order, grid_dirs_deg, nGrid, Y_grid_real);
+    saf_arrayResponses_close(&hResp);
+    Y_grid = malloc1d(nSH*nGrid*sizeof(float_complex));
+    for(i=0; i<nSH*nGrid; i++)
         Y_grid[i] = cmplxf(Y_grid_real[i], 0.0f); /* "evaluateSHTfilters" function requires complex data type */
     
     /* compare the spherical harmonics obtained from encoding matrix 'W' with the ideal patterns */
-    Wshort = malloc1d(HYBRID_BANDS*nSH*(arraySpecs->Q)*sizeof(float_complex));
-    for(band=0; band<HYBRID_BANDS; band++)
-        for(i=0; i<nSH; i++)
-            for(j=0; j<(arraySpecs->Q); j++)
-                Wshort[band*nSH*(arraySpecs->Q) + i*(arraySpecs->Q) + j] = pData->W[band][i][j];
-    evaluateSHTfilters(order, Wshort, arraySpecs->Q, HYBRID_BANDS, H_array, 812, Y_grid, pData->cSH, pData->lSH);
+    if(nEvalBands==HYBRID_BANDS)
+        evaluateSHTfilters(order, Wshort, arraySpecs->Q, nEvalBands, H_array, nGrid, Y_grid, pData->cSH, pData->lSH);
+    else{
+        cSH_eval = malloc1d(nEvalBands*(order+1)*sizeof(float));
+        lSH_eval = malloc1d(nEvalBands*(order+1)*sizeof(float));
+        evaluateSHTfilters(order, Wshort, arraySpecs->Q, nEvalBands, H_array, nGrid, Y_grid, cSH_eval, lSH_eval);
+        
+        /* linearly interpolate the metrics over the bands that were skipped */
+        for(i=0; i<nEvalBands-1; i++){
+            b0 = evalBands[i];
+            b1 = evalBands[i+1];
+            for(band=b0; band<b1; band++){
+                a = (float)(band-b0)/(float)(b1-b0);
+                for(n=0; n<order+1; n++){
+                    pData->cSH[band*(order+1)+n] = (1.0f-a)*cSH_eval[i*(order+1)+n] + a*cSH_eval[(i+1)*(order+1)+n];
+                    pData->lSH[band*(order+1)+n] = (1.0f-a)*lSH_eval[i*(order+1)+n] + a*lSH_eval[(i+1)*(order+1)+n];
+                }
+            }
+        }
+        for(n=0; n<order+1; n++){
+            pData->cSH[(HYBRID_BANDS-1)*(order+1)+n] = cSH_eval[(nEvalBands-1)*(order+1)+n];
+            pData->lSH[(HYBRID_BANDS-1)*(order+1)+n] = lSH_eval[(nEvalBands-1)*(order+1)+n];
+        }
+        free(cSH_eval);
+        free(lSH_eval);
+    }
 
     free(Y_grid_real);
     free(Y_grid);
     free(H_array);
     free(Wshort);
+    free(measuredPath);
 }
 
 void array2sh_createArray(void ** const hPars)
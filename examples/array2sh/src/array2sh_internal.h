@@ -81,6 +81,10 @@ typedef enum _ARRAY2SH_PROC_STATUS{
 #define MAX_NUM_SENSORS ( ARRAY2SH_MAX_NUM_SENSORS ) /* Maximum permitted number of channels for the VST standard */
 #define MAX_EVAL_FREQ_HZ ( 20e3f )             /* Up to which frequency should the evaluation be accurate */
 #define MAX_NUM_SENSORS_IN_PRESET ( MAX_NUM_SENSORS )
+#define BESSEL_TABLE_STEP ( 0.05 )             /* kr grid spacing of the spherical Bessel look-up table */
+#define EVAL_FAST_BAND_STEP ( 4 )              /* EVAL_RESOLUTION_FAST: evaluate every Nth band... */
+#define EVAL_FAST_NUM_LOW_BANDS ( 12 )         /* ...except for the lowest (unevenly spaced hybrid) bands, which are all evaluated */
+#define TD_FILTER_LENGTH ( 4*HOP_SIZE )        /* length of the FIR encoding filters (time-domain encoding); at most FRAME_SIZE */
 
 
 /* ========================================================================== */
@@ -101,6 +105,61 @@ typedef struct _array2sh_arrayPars {
         
 }array2sh_arrayPars;
 
+/**
+ * Encoding filters (for one order and array configuration), which are built as
+ * a whole (see array2sh_buildEncoder()), so that a new set may be prepared in
+ * the background while the current one is still in use
+ */
+typedef struct _array2sh_encoder {
+    /* parameters the filters were built for */
+    int order;                      /* encoding order */
+    array2sh_arrayPars specs;       /* array configuration */
+    ARRAY2SH_FILTER_TYPES filterType; /* encoding filter approach */
+    float regPar;                   /* regularisation upper gain limit, dB */
+    float c;                        /* speed of sound, m/s */
+    int enableDiffEQpastAliasing;   /* 0: disabled, 1: enabled */
+    int fs;                         /* sampling rate, hz */
+    int useTimeDomain;              /* 1: FIR filters (hMatrixConv) are applied, 0: W is applied in the afSTFT domain */
+    char* measuredPath;             /* file of measured responses W was computed from; NULL: the analytic model was used */
+    
+    /* filters */
+    double_complex bN_modal[HYBRID_BANDS][MAX_SH_ORDER + 1];
+    double_complex bN_inv[HYBRID_BANDS][MAX_SH_ORDER + 1];
+    double_complex bN_inv_R[HYBRID_BANDS][MAX_NUM_SH_SIGNALS];
+    float_complex W[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][MAX_NUM_SENSORS]; /* encoding matrices */
+    float bN_modal_dB[HYBRID_BANDS][MAX_SH_ORDER + 1]; /* modal responses / no regularisation */
+    float bN_inv_dB[HYBRID_BANDS][MAX_SH_ORDER + 1];   /* modal responses / with regularisation */
+    void* hMatrixConv;              /* FIR encoding filters (saf_matrixConv handle), derived from W; NULL if not used */
+    
+}array2sh_encoder;
+
+/**
+ * Intermediate results of array2sh_buildEncoder(), which do not depend on the
+ * regularisation or filter type, and are therefore kept across builds (e.g.
+ * while the regularisation slider is dragged). Only ever accessed by one build
+ * at a time.
+ */
+typedef struct _array2sh_filterCache {
+    /* modal coefficients; FLAT: HYBRID_BANDS x (bN_order+1) */
+    int bN_valid;                   /* 1: bN holds the coefficients for the parameters below */
+    int bN_order, bN_fs;
+    ARRAY2SH_ARRAY_TYPES bN_arrayType;
+    ARRAY2SH_WEIGHT_TYPES bN_weightType;
+    float bN_r, bN_R, bN_c;
+    double_complex bN[HYBRID_BANDS*(MAX_SH_ORDER + 1)];
+    void* hBesselTable;             /* spherical Bessel look-up table (see sphBesselTable_create()); grown as needed */
+    
+    /* theoretical diffuse coherence matrices; FLAT: Q x Q x HYBRID_BANDS */
+    int dcoh_valid;                 /* 1: dM_diffcoh holds the matrices for the parameters below */
+    int dcoh_Q, dcoh_fs;
+    ARRAY2SH_ARRAY_TYPES dcoh_arrayType;
+    ARRAY2SH_WEIGHT_TYPES dcoh_weightType;
+    float dcoh_r, dcoh_R, dcoh_c;
+    float dcoh_sensorCoords_rad[MAX_NUM_SENSORS][2];
+    double* dM_diffcoh;
+    
+}array2sh_filterCache;
+
 /**
  * Main structure for array2sh. Contains variables for audio buffers, afSTFT,
  * encoding matrices, internal variables, flags, user parameters
@@ -108,22 +167,22 @@ typedef struct _array2sh_arrayPars {
 typedef struct _array2sh
 {
     /* audio buffers */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float inputFrameTD[MAX_NUM_SENSORS][FRAME_SIZE];
     float SHframeTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
+    float SHframeTD_prev[MAX_NUM_SH_SIGNALS][FRAME_SIZE]; /**< output of the previous FIR filters, to crossfade from */
     float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_SENSORS][TIME_SLOTS];
     float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;
+    float_complex SHframeTF_prev[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS]; /**< output of the previous filters, to crossfade from */
     float** tempHopFrameTD_in;
     float** tempHopFrameTD_out;
     
-    /* intermediates */
-    double_complex bN_modal[HYBRID_BANDS][MAX_SH_ORDER + 1];
-    double_complex* bN;
-    double_complex bN_inv[HYBRID_BANDS][MAX_SH_ORDER + 1];
-    double_complex bN_inv_R[HYBRID_BANDS][MAX_NUM_SH_SIGNALS]; 
-    float_complex W[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][MAX_NUM_SENSORS];
-    float_complex W_diffEQ[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][MAX_NUM_SENSORS];
+    /* encoding filters */
+    array2sh_encoder* enc;          /* filters currently in use */
+    void* hEncInit;                 /* saf_asyncInit handle; builds new filters in the background */
+    array2sh_filterCache cache;     /* see array2sh_buildEncoder() */
+    volatile int evalCopyingFLAG;   /* 1: array2sh_evaluateSHTfilters() is reading 'enc' */
     
     /* for displaying the bNs */
     float** bN_modal_dB;            /* modal responses / no regulaisation; HYBRID_BANDS x (MAX_SH_ORDER +1)  */
@@ -138,6 +197,7 @@ typedef struct _array2sh
     
     /* internal parameters */
     ARRAY2SH_EVAL_STATUS evalStatus;
+    ARRAY2SH_EVAL_RESOLUTIONS evalResolution;
     float progressBar0_1;
     char* progressBarText;
     int fs;                         /* sampling rate, hz */
@@ -158,6 +218,8 @@ typedef struct _array2sh
     float c;                        /* speed of sound, m/s */
     float gain_dB;                  /* post gain, dB */ 
     int enableDiffEQpastAliasing;   /* 0: disabled, 1: enabled */
+    ARRAY2SH_ENCODING_DOMAINS domain; /* requested encoding domain; see array2sh_setEncodingDomain() */
+    char* measured_filepath;        /* file of measured array responses; NULL: the analytic model is used */
     
 } array2sh_data;
 
@@ -169,27 +231,65 @@ typedef struct _array2sh
 /**
  * Initialise the filterbank used by array2sh.
  *
- * @note Call this function before array2sh_calculate_sht_matrix
+ * @note Call this function before array2sh_buildEncoder
  */
 void array2sh_initTFT(void* const hA2sh);
 
 /**
- * Computes the spherical harmonic transform (SHT) matrix, to spatially encode
- * input microphone/hydrophone signals into spherical harmonic signals.
+ * Computes the spherical harmonic transform (SHT) matrices, to spatially encode
+ * input microphone/hydrophone signals into spherical harmonic signals; for the
+ * current array configuration, filter settings, and (new) encoding order
+ *
+ * The modal coefficients and diffuse coherence matrices are cached across
+ * builds, and only recomputed if the parameters they depend on have changed.
+ *
+ * @note This does not modify the filters currently in use, and so it may be
+ *       called from the background initialisation thread (see saf_asyncInit.h)
+ *
+ * @param[in] hA2sh  array2sh handle
+ * @param[in] hAsync saf_asyncInit handle, for cancelling the build; may be NULL
+ * @returns   New array2sh_encoder; or NULL, if the build was cancelled
+ */
+void* array2sh_buildEncoder(void* const hA2sh,
+                            void* const hAsync);
+
+/**
+ * Returns 1 if filters built for the given encoding order are to be applied in
+ * the time-domain (according to the requested encoding domain), or 0 if not
+ */
+int array2sh_getTimeDomainFLAG(void* const hA2sh,
+                               int order);
+
+/**
+ * Converts the per-band encoding matrices of 'enc' into FIR filters, and
+ * creates the partitioned convolver that applies them (enc->hMatrixConv)
+ *
+ * The matrices are interpolated (linearly, between the band centre
+ * frequencies) onto the uniform frequency grid of a TD_FILTER_LENGTH-point
+ * FFT, delayed by half of the filter length, and the resulting filters are
+ * Hann windowed.
+ */
+void array2sh_buildTimeDomainEncoder(void* const hA2sh,
+                                     array2sh_encoder* enc);
+
+/**
+ * Destroys filters returned by array2sh_buildEncoder() (may be NULL)
  */
-void array2sh_calculate_sht_matrix(void* const hA2sh);
+void array2sh_destroyEncoder(void* const hA2sh,
+                             void* encoder);
 
 /**
  * Applies diffuse-field equalisation at frequencies above the spatial aliasing
- * limit.
+ * limit, to the filters in 'enc'.
  */
-void array2sh_apply_diff_EQ(void* const hA2sh);
+void array2sh_apply_diff_EQ(void* const hA2sh,
+                            array2sh_encoder* enc);
 
 /**
- * Computes the magnitude responses of the equalisation filters; the
+ * Computes the magnitude responses of the equalisation filters in 'enc'; the
  * absolute values of the regularised inversed modal coefficients.
  */
-void array2sh_calculate_mag_curves(void* const hA2sh);
+void array2sh_calculate_mag_curves(array2sh_encoder* enc);
 
 /**
  * Evaluates the spherical harmonic transform performance with the currently
@@ -57,12 +57,25 @@ typedef enum _BEAMFORMER_BEAM_ORDERS{
 typedef enum _BEAMFORMER_BEAM_TYPES {
     BEAM_TYPE_CARDIOID = 1,  /**< cardioid */
     BEAM_TYPE_HYPERCARDIOID, /**< hyper-cardioid */
-    BEAM_TYPE_MAX_EV         /**< hyper-cardioid with max_rE weighting */
+    BEAM_TYPE_MAX_EV,        /**< hyper-cardioid with max_rE weighting */
+    BEAM_TYPE_MVDR,          /**< adaptive; minimum-variance distortionless
+                              *   response towards each beam direction */
+    BEAM_TYPE_LCMV           /**< adaptive; linearly-constrained minimum-
+                              *   variance, with a distortionless response
+                              *   towards each beam direction and nulls
+                              *   towards the directions of all other beams
+                              *   (falls back to BEAM_TYPE_MVDR if there are
+                              *   not fewer beams than SH components) */
     
 } BEAMFORMER_BEAM_TYPES;
     
 /* Number of available beamformer types */
-#define BEAMFORMER_NUM_BEAM_TYPES ( 3 )
+#define BEAMFORMER_NUM_BEAM_TYPES ( 5 )
+
+#define BEAMFORMER_ADAPT_TIME_CONST_MIN_MS ( 10.0f )
+#define BEAMFORMER_ADAPT_TIME_CONST_MAX_MS ( 2000.0f )
+#define BEAMFORMER_DIAG_LOADING_MIN_DB ( -60.0f )
+#define BEAMFORMER_DIAG_LOADING_MAX_DB ( 0.0f )
  
 /**
  * Available Ambisonic channel ordering conventions
@@ -128,6 +141,11 @@ void beamformer_init(void* const hBeam,
 /**
  * Generates beamformers/virtual microphones in the specified directions
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in beamformer_getProcessingDelay()
+ *
  * @param[in] hBeam     beamformer handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs   Output channel buffers; 2-D array: nOutputs x nSamples
@@ -142,6 +160,23 @@ void beamformer_process(void* const hBeam,
                         int nOutputs,
                         int nSamples);
 
+/**
+ * Same as beamformer_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hBeam    beamformer handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void beamformer_processInterleaved(void* const hBeam,
+                                   const float* inputs,
+                                   float* outputs,
+                                   int nInputs,
+                                   int nOutputs,
+                                   int nSamples);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -197,6 +232,19 @@ void beamformer_setNormType(void* const hBeam, int newType);
  */
 void beamformer_setBeamType(void* const hBeam, int newID);
 
+/**
+ * Sets the time constant of the covariance estimate used by the adaptive beam
+ * types (BEAM_TYPE_MVDR/BEAM_TYPE_LCMV), in milliseconds
+ */
+void beamformer_setAdaptTimeConst_ms(void* const hBeam, float newValue);
+
+/**
+ * Sets the diagonal loading applied by the adaptive beam types
+ * (BEAM_TYPE_MVDR/BEAM_TYPE_LCMV), in dB relative to the mean power of the
+ * SH channels
+ */
+void beamformer_setDiagLoading_dB(void* const hBeam, float newValue);
+
     
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -257,7 +305,32 @@ int beamformer_getNormType(void* const hBeam);
  * Returns the beamforming approach employed (see 'BEAMFORMER_BEAM_TYPE' enum)
  */
 int beamformer_getBeamType(void* const hBeam); 
+
+/**
+ * Returns the time constant of the covariance estimate used by the adaptive
+ * beam types, in milliseconds
+ */
+float beamformer_getAdaptTimeConst_ms(void* const hBeam);
+
+/**
+ * Returns the diagonal loading applied by the adaptive beam types, in dB
+ * relative to the mean power of the SH channels
+ */
+float beamformer_getDiagLoading_dB(void* const hBeam);
     
+/**
+ * Returns the processing delay in samples (may be used for delay compensation
+ * features), which includes the latency of the internal FIFO, if any (i.e. if
+ * the host block size is not a multiple of FRAME_SIZE)
+ */
+int beamformer_getProcessingDelay(void* const hBeam);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, and time taken per frame); see
+ * saf_telemetry_getSnapshot()
+ */
+void* beamformer_getTelemetry(void* const hBeam);
     
 #ifdef __cplusplus
 } /* extern "C" { */
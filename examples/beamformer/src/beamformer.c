@@ -47,14 +47,32 @@ void beamformer_create
     pData->beamType = BEAM_TYPE_HYPERCARDIOID;
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
+    pData->adaptTimeConst_ms = 200.0f;
+    pData->diagLoading_dB = -20.0f;
     
     /* internal parameters */
     pData->new_nSH = pData->new_nSH = (pData->beamOrder+1)*(pData->beamOrder+1);
     
     /* flags */
     pData->reInitTFT = 1;
-    for(ch=0; ch<MAX_NUM_BEAMS; ch++)
+    for(ch=0; ch<MAX_NUM_BEAMS; ch++){
         pData->recalc_beamWeights[ch] = 1;
+        pData->beamRampFLAG[ch] = 0;
+    }
+    memset(pData->beamWeights, 0, MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS*sizeof(float));
+    memset(pData->prev_beamWeights, 0, MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS*sizeof(float));
+    rotateAxisCoeffsCache_create(&(pData->hRotCache), MAX_SH_ORDER, ROT_CACHE_NUM_ENTRIES);
+    for(i=1; i<=MAX_SH_ORDER; i++){ /* (so that switching the order or type does not compute any patterns) */
+        beamWeightsCached(SECTOR_PATTERN_CARDIOID, i, pData->beamPatterns[BEAM_TYPE_CARDIOID-1][i]);
+        beamWeightsCached(SECTOR_PATTERN_PWD, i, pData->beamPatterns[BEAM_TYPE_HYPERCARDIOID-1][i]);
+        beamWeightsCached(SECTOR_PATTERN_MAXRE, i, pData->beamPatterns[BEAM_TYPE_MAX_EV-1][i]);
+    }
+    utility_dglslv_create(&(pData->hLinSolve), MAX_NUM_BEAMS, MAX_NUM_SH_SIGNALS);
+    pData->reinitInvCov = 1;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, MAX_NUM_BEAMS);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void beamformer_destroy
@@ -66,6 +84,10 @@ void beamformer_destroy
     
     if (pData != NULL) {
         
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        rotateAxisCoeffsCache_destroy(&(pData->hRotCache));
+        utility_dglslv_destroy(&(pData->hLinSolve));
         free(pData);
         pData = NULL;
     }
@@ -87,24 +109,30 @@ void beamformer_init
     memset(pData->beamWeights, 0, MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS*sizeof(float));
     memset(pData->prev_beamWeights, 0, MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS*sizeof(float));
     memset(pData->prev_SHFrameTD, 0, MAX_NUM_SH_SIGNALS*FRAME_SIZE*sizeof(float));
-    for(ch=0; ch<MAX_NUM_BEAMS; ch++)
+    for(ch=0; ch<MAX_NUM_BEAMS; ch++){
         pData->recalc_beamWeights[ch] = 1;
+        pData->beamRampFLAG[ch] = 0;
+    }
+    pData->reinitInvCov = 1;
     for(i=1; i<=FRAME_SIZE; i++)
         pData->interpolator[i-1] = (float)i*1.0f/(float)FRAME_SIZE;
 }
 
-void beamformer_process
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void beamformer_processFrame
 (
     void  *  const hBeam,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     beamformer_data *pData = (beamformer_data*)(hBeam);
-    int n, ch, i, j, bi;
+    int n, ch, i;
     int o[MAX_SH_ORDER+2];
 
     /* local copies of user parameters */
@@ -120,7 +148,9 @@ void beamformer_process
     }
 
     /* decode audio to loudspeakers or headphones */
-    if( (nSamples == FRAME_SIZE) && (pData->reInitTFT==0) ) {
+    if(pData->reInitTFT==0) {
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        
         /* copy user parameters to local variables */
         for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
         beamOrder = pData->beamOrder;
@@ -171,55 +201,72 @@ void beamformer_process
         }
         
         /* Main processing: */
-        float* c_n;
-        c_n = malloc1d((beamOrder+1)*sizeof(float));
-            
-        /* calculate beamforming coeffients */
-        for(bi=0; bi<nBeams; bi++){
-            if(pData->recalc_beamWeights[bi]){
-                memset(pData->beamWeights[bi], 0, MAX_NUM_SH_SIGNALS*sizeof(float));
-                switch(pData->beamType){
-                    case BEAM_TYPE_CARDIOID: beamWeightsCardioid2Spherical(beamOrder, c_n); break;
-                    case BEAM_TYPE_HYPERCARDIOID: beamWeightsHypercardioid2Spherical(beamOrder, c_n); break;
-                    case BEAM_TYPE_MAX_EV: beamWeightsMaxEV(beamOrder, c_n); break;
-                }
-                rotateAxisCoeffsReal(beamOrder, c_n, M_PI/2.0f - pData->beam_dirs_deg[bi][1]*M_PI/180.0f,
-                                        pData->beam_dirs_deg[bi][0]*M_PI/180.0f, (float*)pData->beamWeights[bi]);
-                    
-                pData->recalc_beamWeights[bi] = 0;
-            }
-            else
-                memcpy(pData->beamWeights[bi], pData->prev_beamWeights[bi], pData->nSH*sizeof(float));
-        }
-        free(c_n);
-            
-        /* apply beam weights */
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBeams, FRAME_SIZE, pData->nSH, 1.0f,
-                    (const float*)pData->prev_beamWeights, MAX_NUM_SH_SIGNALS,
-                    (const float*)pData->prev_SHFrameTD, FRAME_SIZE, 0.0f,
-                    (float*)pData->tempFrame, FRAME_SIZE);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBeams, FRAME_SIZE, pData->nSH, 1.0f,
-                    (const float*)pData->beamWeights, MAX_NUM_SH_SIGNALS,
-                    (const float*)pData->prev_SHFrameTD, FRAME_SIZE, 0.0f,
-                    (float*)pData->outputFrameTD, FRAME_SIZE);
-            
-        for (i=0; i <nBeams; i++)
-            for(j=0; j<FRAME_SIZE; j++)
-                pData->outputFrameTD[i][j] =  pData->interpolator[j] * pData->outputFrameTD[i][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
+        beamformer_updateBeamBank(hBeam); /* (re)calculate the weights of any beams that have changed */
+        if(IS_ADAPTIVE_BEAM_TYPE(pData->beamType))
+            beamformer_updateAdaptiveBeams(hBeam);
+        beamformer_applyBeamBank(hBeam);
             
         /* for next frame */
         utility_svvcopy((const float*)pData->SHFrameTD, pData->nSH*FRAME_SIZE, (float*)pData->prev_SHFrameTD);
-        utility_svvcopy((const float*)pData->beamWeights, MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_beamWeights);
             
         /* copy to output buffer */
         for(ch = 0; ch < MIN(nBeams, nOutputs); ch++)
             utility_svvcopy(pData->outputFrameTD[ch], FRAME_SIZE, outputs[ch]);
         for (; ch < nOutputs; ch++)
             memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
-    else
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
+}
+
+void beamformer_process
+(
+    void  *  const hBeam,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &beamformer_processFrame, hBeam);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void beamformer_processInterleaved
+(
+    void  *  const hBeam,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &beamformer_processFrame, hBeam);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 
@@ -238,6 +285,7 @@ void beamformer_setBeamOrder(void  * const hBeam, int newValue)
     pData->beamOrder = MIN(MAX(newValue,1), MAX_SH_ORDER);
     pData->new_nSH = (pData->beamOrder+1)*(pData->beamOrder+1);
     pData->reInitTFT = 1;
+    pData->reinitInvCov = 1;
     for(ch=0; ch<MAX_NUM_BEAMS; ch++)
         pData->recalc_beamWeights[ch] = 1;
     /* FUMA only supports 1st order */
@@ -297,11 +345,25 @@ void beamformer_setBeamType(void* const hBeam, int newID)
 {
     beamformer_data *pData = (beamformer_data*)(hBeam);
     int ch;
+    if(IS_ADAPTIVE_BEAM_TYPE(newID) && !IS_ADAPTIVE_BEAM_TYPE(pData->beamType))
+        pData->reinitInvCov = 1;
     pData->beamType = newID;
     for(ch=0; ch<MAX_NUM_BEAMS; ch++)
         pData->recalc_beamWeights[ch] = 1;
 }
 
+void beamformer_setAdaptTimeConst_ms(void* const hBeam, float newValue)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    pData->adaptTimeConst_ms = CLAMP(newValue, BEAMFORMER_ADAPT_TIME_CONST_MIN_MS, BEAMFORMER_ADAPT_TIME_CONST_MAX_MS);
+}
+
+void beamformer_setDiagLoading_dB(void* const hBeam, float newValue)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    pData->diagLoading_dB = CLAMP(newValue, BEAMFORMER_DIAG_LOADING_MIN_DB, BEAMFORMER_DIAG_LOADING_MAX_DB);
+}
+
 /* Get Functions */
 
 int beamformer_getBeamOrder(void  * const hBeam)
@@ -362,5 +424,26 @@ int beamformer_getBeamType(void* const hBeam)
     return pData->beamType;
 }
 
+float beamformer_getAdaptTimeConst_ms(void* const hBeam)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    return pData->adaptTimeConst_ms;
+}
 
+float beamformer_getDiagLoading_dB(void* const hBeam)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    return pData->diagLoading_dB;
+}
+
+int beamformer_getProcessingDelay(void* const hBeam)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    return saf_fifo_getLatency(pData->hFIFO);
+}
 
+void* beamformer_getTelemetry(void* const hBeam)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    return pData->hTelemetry;
+}
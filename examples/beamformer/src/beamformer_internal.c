@@ -35,3 +35,208 @@ void beamformer_initTFT
     pData->nSH = pData->new_nSH;
 }
 
+void beamformer_updateBeamBank
+(
+    void* const hBeam
+)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    int i, q, bi, order, nSH, nChanged;
+    int changedIdx[MAX_NUM_BEAMS];
+    float theta_0[MAX_NUM_BEAMS], phi_0[MAX_NUM_BEAMS], dirs_rad[MAX_NUM_BEAMS*2];
+    
+    /* gather the look directions of the beams which have changed */
+    nChanged = 0;
+    for(bi=0; bi<pData->nBeams; bi++){
+        if(pData->recalc_beamWeights[bi]){
+            theta_0[nChanged] = M_PI/2.0f - pData->beam_dirs_deg[bi][1]*M_PI/180.0f;
+            phi_0[nChanged] = pData->beam_dirs_deg[bi][0]*M_PI/180.0f;
+            changedIdx[nChanged++] = bi;
+            pData->recalc_beamWeights[bi] = 0;
+        }
+    }
+    if(nChanged==0)
+        return;
+    
+    /* adaptive beams: only the steering vectors are needed here (N3D) */
+    if(IS_ADAPTIVE_BEAM_TYPE(pData->beamType)){
+        order = pData->beamOrder;
+        nSH = (order+1)*(order+1);
+        for(i=0; i<nChanged; i++){
+            dirs_rad[i*2] = phi_0[i];
+            dirs_rad[i*2+1] = theta_0[i];
+        }
+        getSHreal_fast(order, dirs_rad, nChanged, pData->newWeights);
+        for(i=0; i<nChanged; i++){
+            bi = changedIdx[i];
+            memset(pData->steerVecs[bi], 0, MAX_NUM_SH_SIGNALS*sizeof(float));
+            for(q=0; q<nSH; q++)
+                pData->steerVecs[bi][q] = sqrtf(4.0f*M_PI) * pData->newWeights[q*nChanged+i];
+        }
+        return;
+    }
+    
+    /* the axisymmetric pattern is the same for all beams */
+    order = pData->beamOrder;
+    nSH = (order+1)*(order+1);
+    rotateAxisCoeffsCache_setPattern(pData->hRotCache, order, pData->beamPatterns[pData->beamType-1][order]);
+    
+    /* rotate the pattern towards all of these beam directions at once */
+    rotateAxisCoeffsCache_get(pData->hRotCache, theta_0, phi_0, nChanged, pData->newWeights);
+    for(i=0; i<nChanged; i++){
+        bi = changedIdx[i];
+        memset(pData->beamWeights[bi], 0, MAX_NUM_SH_SIGNALS*sizeof(float));
+        memcpy(pData->beamWeights[bi], &(pData->newWeights[i*nSH]), nSH*sizeof(float));
+        pData->beamRampFLAG[bi] = 1;
+    }
+}
+
+void beamformer_applyBeamBank
+(
+    void* const hBeam
+)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    int i, j, bi, nRamps;
+    int rampIdx[MAX_NUM_BEAMS];
+    
+    /* gather the previous weights of the beams which are ramping */
+    nRamps = 0;
+    for(bi=0; bi<pData->nBeams; bi++){
+        if(pData->beamRampFLAG[bi]){
+            memcpy(pData->rampWeights[nRamps], pData->prev_beamWeights[bi], MAX_NUM_SH_SIGNALS*sizeof(float));
+            rampIdx[nRamps++] = bi;
+        }
+    }
+    
+    /* all beams, with the current weights */
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pData->nBeams, FRAME_SIZE, pData->nSH, 1.0f,
+                (const float*)pData->beamWeights, MAX_NUM_SH_SIGNALS,
+                (const float*)pData->prev_SHFrameTD, FRAME_SIZE, 0.0f,
+                (float*)pData->outputFrameTD, FRAME_SIZE);
+    if(nRamps==0)
+        return;
+    
+    /* ramping beams only, with the previous weights; and crossfade */
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nRamps, FRAME_SIZE, pData->nSH, 1.0f,
+                (const float*)pData->rampWeights, MAX_NUM_SH_SIGNALS,
+                (const float*)pData->prev_SHFrameTD, FRAME_SIZE, 0.0f,
+                (float*)pData->tempFrame, FRAME_SIZE);
+    for(i=0; i<nRamps; i++){
+        bi = rampIdx[i];
+        for(j=0; j<FRAME_SIZE; j++)
+            pData->outputFrameTD[bi][j] = pData->interpolator[j] * pData->outputFrameTD[bi][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
+        memcpy(pData->prev_beamWeights[bi], pData->beamWeights[bi], MAX_NUM_SH_SIGNALS*sizeof(float));
+        pData->beamRampFLAG[bi] = 0;
+    }
+}
+
+/**
+ * Rank-1 update of the scaled inverse 'P' (true inverse = s*P), i.e. the
+ * inverse of R + beta*x*x^T, given the inverse of R (Sherman-Morrison);
+ * 'k' = P*x must be given, and is overwritten
+ */
+static void beamformer_rankOneInvUpdate
+(
+    double* P,
+    int nSH,
+    double s,
+    double beta,
+    double xPx, /* x^T*P*x */
+    double* k
+)
+{
+    cblas_dger(CblasRowMajor, nSH, nSH, -beta*s/(1.0 + beta*s*xPx), k, 1, k, 1, P, nSH);
+}
+
+void beamformer_updateAdaptiveBeams
+(
+    void* const hBeam
+)
+{
+    beamformer_data *pData = (beamformer_data*)(hBeam);
+    int i, j, t, nSH, nBeams;
+    double lambda, beta, load, xPx;
+    double x[MAX_NUM_SH_SIGNALS], k[MAX_NUM_SH_SIGNALS];
+    
+    nSH = pData->nSH;
+    nBeams = pData->nBeams;
+    
+    /* (re)initialise to the inverse of a small identity matrix */
+    if(pData->reinitInvCov){
+        memset(pData->invCov, 0, nSH*nSH*sizeof(double));
+        for(i=0; i<nSH; i++)
+            pData->invCov[i*nSH+i] = 1.0e3;
+        pData->invCovScale = 1.0;
+        pData->meanPow = 0.0;
+        pData->loadingIdx = 0;
+        pData->reinitInvCov = 0;
+    }
+    
+    /* recursive update of the inverse, one snapshot every ADAPT_SNAPSHOT_STEP
+     * samples: R = lambda*R + (1-lambda)*(x*x^T + (nSH*loading)*e_l*e_l^T) */
+    lambda = exp(-(double)ADAPT_SNAPSHOT_STEP/(pData->adaptTimeConst_ms*1e-3*(double)pData->fs));
+    beta = (1.0-lambda)/lambda;
+    for(t=0; t<FRAME_SIZE; t+=ADAPT_SNAPSHOT_STEP){
+        xPx = 0.0;
+        for(i=0; i<nSH; i++){
+            x[i] = (double)pData->prev_SHFrameTD[i][t];
+            xPx += x[i]*x[i];
+        }
+        pData->meanPow = lambda*pData->meanPow + (1.0-lambda)*xPx/(double)nSH;
+        
+        /* forgetting and the new snapshot; note: the 1/lambda is kept in the scale */
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, nSH, nSH, 1.0, pData->invCov, nSH, x, 1, 0.0, k, 1);
+        xPx = cblas_ddot(nSH, x, 1, k, 1);
+        beamformer_rankOneInvUpdate(pData->invCov, nSH, pData->invCovScale, beta, xPx, k);
+        pData->invCovScale /= lambda;
+        
+        /* diagonal loading of one channel */
+        load = (1.0-lambda)*(double)nSH*(pow(10.0, (double)pData->diagLoading_dB/10.0)*pData->meanPow + ADAPT_LOADING_FLOOR);
+        j = pData->loadingIdx;
+        cblas_dcopy(nSH, &(pData->invCov[j]), nSH, k, 1); /* column j */
+        beamformer_rankOneInvUpdate(pData->invCov, nSH, pData->invCovScale, load, k[j], k);
+        pData->loadingIdx = (j+1) % nSH;
+    }
+    cblas_dscal(nSH*nSH, pData->invCovScale, pData->invCov, 1);
+    pData->invCovScale = 1.0;
+    
+    /* steering matrix, and invCov*C */
+    for(i=0; i<nSH; i++)
+        for(j=0; j<nBeams; j++)
+            pData->adaptC[i*nBeams+j] = (double)pData->steerVecs[j][i];
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nBeams, nSH, 1.0,
+                pData->invCov, nSH,
+                pData->adaptC, nBeams, 0.0,
+                pData->adaptPC, nBeams);
+    for(i=0; i<nSH; i++)
+        for(j=0; j<nBeams; j++)
+            pData->adaptW[j*nSH+i] = pData->adaptPC[i*nBeams+j]; /* (transpose) */
+    
+    if(pData->beamType==BEAM_TYPE_LCMV && nBeams<nSH){
+        /* W = (C^T*invCov*C)^-1 * (invCov*C)^T; i.e. unity gain towards each
+         * beam direction, and nulls towards all others */
+        cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nBeams, nBeams, nSH, 1.0,
+                    pData->adaptC, nBeams,
+                    pData->adaptPC, nBeams, 0.0,
+                    pData->adaptCPC, nBeams);
+        utility_dglslv(pData->hLinSolve, pData->adaptCPC, nBeams, pData->adaptW, nSH, pData->adaptW_sol);
+        for(j=0; j<nBeams; j++)
+            for(i=0; i<nSH; i++)
+                pData->beamWeights[j][i] = (float)pData->adaptW_sol[j*nSH+i];
+    }
+    else{
+        /* w_j = invCov*c_j / (c_j^T*invCov*c_j) */
+        for(j=0; j<nBeams; j++){
+            xPx = 0.0;
+            for(i=0; i<nSH; i++)
+                xPx += pData->adaptC[i*nBeams+j] * pData->adaptW[j*nSH+i];
+            for(i=0; i<nSH; i++)
+                pData->beamWeights[j][i] = (float)(pData->adaptW[j*nSH+i]/(xPx+2.23e-13));
+        }
+    }
+    for(j=0; j<nBeams; j++){
+        memset(&(pData->beamWeights[j][nSH]), 0, (MAX_NUM_SH_SIGNALS-nSH)*sizeof(float));
+        pData->beamRampFLAG[j] = 1;
+    }
+}
@@ -46,6 +46,10 @@ extern "C" {
 #define MAX_SH_ORDER ( BEAMFORMER_MAX_SH_ORDER )
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER+1)*(MAX_SH_ORDER+1) ) /* Maximum number of spherical harmonic components */
 #define MAX_NUM_BEAMS ( BEAMFORMER_MAX_NUM_BEAMS ) /* Maximum permitted channels for the VST standard */
+#define ROT_CACHE_NUM_ENTRIES ( 256 )            /* Number of beam directions held by the rotation cache */
+#define ADAPT_SNAPSHOT_STEP ( 4 )                /* Adaptive beams: covariance update every Nth sample */
+#define ADAPT_LOADING_FLOOR ( 1e-9 )             /* Adaptive beams: absolute diagonal loading (keeps the inverse bounded during silence) */
+#define IS_ADAPTIVE_BEAM_TYPE(t) ( (t)==BEAM_TYPE_MVDR || (t)==BEAM_TYPE_LCMV )
 
 
 /* ========================================================================== */
@@ -59,6 +63,8 @@ extern "C" {
 typedef struct _beamformer
 {
     /* audio buffers + afSTFT time-frequency transform handle */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float SHFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float prev_SHFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float tempFrame[MAX_NUM_BEAMS][FRAME_SIZE];
@@ -69,12 +75,31 @@ typedef struct _beamformer
     int nSH;
     int new_nBeams;                          /**< if new_nLoudpkrs != nLoudpkrs, afSTFT is reinitialised */
     int new_nSH; 
-    float beamWeights[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS];
-    float prev_beamWeights[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS];
+    float beamWeights[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS];      /**< beam bank; nBeams x MAX_NUM_SH_SIGNALS */
+    float prev_beamWeights[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS]; /**< beam bank of the previous frame */
+    float rampWeights[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS];      /**< previous weights of the ramping beams (compacted) */
+    float newWeights[MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS];        /**< weights of the re-steered beams; FLAT: nChanged x nSH */
+    void* hRotCache;                                           /**< rotateAxisCoeffsCache handle */
+    float beamPatterns[BEAM_TYPE_MAX_EV][MAX_SH_ORDER+1][MAX_SH_ORDER+1]; /**< axisymmetric weights of the non-adaptive beam types, per order (taken from beamWeightsCached() at creation) */
+    
+    /* adaptive (MVDR/LCMV) beams */
+    float steerVecs[MAX_NUM_BEAMS][MAX_NUM_SH_SIGNALS];        /**< N3D steering vectors of the beam directions */
+    double invCov[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS];      /**< inverse SH covariance matrix, divided by 'invCovScale'; FLAT: nSH x nSH */
+    double invCovScale;                                        /**< scale of 'invCov' (folded back in once per frame) */
+    double meanPow;                                            /**< recursive estimate of the mean SH channel power */
+    int loadingIdx;                                            /**< SH channel receiving the next diagonal loading update */
+    int reinitInvCov;                                          /**< 1: reset the inverse covariance matrix at the next frame */
+    double adaptC[MAX_NUM_SH_SIGNALS*MAX_NUM_BEAMS];           /**< steering matrix; FLAT: nSH x nBeams */
+    double adaptPC[MAX_NUM_SH_SIGNALS*MAX_NUM_BEAMS];          /**< invCov*adaptC; FLAT: nSH x nBeams */
+    double adaptCPC[MAX_NUM_BEAMS*MAX_NUM_BEAMS];              /**< adaptC^T*invCov*adaptC; FLAT: nBeams x nBeams */
+    double adaptW[MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS];           /**< scratch; FLAT: nBeams x nSH */
+    double adaptW_sol[MAX_NUM_BEAMS*MAX_NUM_SH_SIGNALS];       /**< LCMV weights; FLAT: nBeams x nSH */
+    void* hLinSolve;                                           /**< utility_dglslv workspace */
     float interpolator[FRAME_SIZE];
     
     /* flags */
     int recalc_beamWeights[MAX_NUM_BEAMS];   /**< 0: no init required, 1: init required */
+    int beamRampFLAG[MAX_NUM_BEAMS];         /**< 1: beam is crossfaded from its previous weights over the next frame */
     int reInitTFT;                           /**< 0: no init required, 1: init required, 2: init in progress */
     
     /* user parameters */
@@ -84,6 +109,8 @@ typedef struct _beamformer
     BEAMFORMER_BEAM_TYPES beamType;          /**< see 'BEAMFORMER_BEAM_TYPES' enum */
     BEAMFORMER_CH_ORDER chOrdering;          /**< only ACN is supported */
     BEAMFORMER_NORM_TYPES norm;              /**< N3D or SN3D */
+    float adaptTimeConst_ms;                 /**< adaptive beams: time constant of the covariance estimate, ms */
+    float diagLoading_dB;                    /**< adaptive beams: diagonal loading, dB relative to the mean SH channel power */
     
 } beamformer_data;
 
@@ -97,6 +124,33 @@ typedef struct _beamformer
  */
 void beamformer_initTFT(void* const hBeam);
 
+/**
+ * Recomputes the weights of the beams flagged in 'recalc_beamWeights', and
+ * flags these beams to be crossfaded from their previous weights
+ */
+void beamformer_updateBeamBank(void* const hBeam);
+
+/**
+ * Applies the beam bank to 'prev_SHFrameTD' and writes the result to
+ * 'outputFrameTD'
+ *
+ * All beams are computed with one GEMM. Only the beams that are ramping need
+ * a second GEMM (over just those beams); these are then crossfaded.
+ */
+void beamformer_applyBeamBank(void* const hBeam);
+
+/**
+ * Updates the inverse of the SH covariance matrix with the snapshots of
+ * 'prev_SHFrameTD', and recomputes the weights of all beams (which are then
+ * all flagged for crossfading); for the adaptive beam types
+ *
+ * The inverse is maintained with recursive (Sherman-Morrison) rank-1 updates,
+ * i.e. O(nSH^2) per snapshot, rather than being re-inverted every frame. The
+ * diagonal loading is applied in the same manner, by adding a rank-1 term to
+ * one SH channel per snapshot (cycling through the channels).
+ */
+void beamformer_updateAdaptiveBeams(void* const hBeam);
+
 
 #ifdef __cplusplus
 } /* extern "C" { */
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark.h
+ * @brief An end-to-end, real-time budget benchmark of the example processors
+ *
+ * Each example (ambi_bin, ambi_dec, ambi_drc, ambi_enc, array2sh, beamformer,
+ * binauraliser, dirass, matrixconv, multiconv, panner, powermap, rotator,
+ * sldoa, upmix) is instantiated at several orders/channel counts, and fed
+ * with white noise in blocks of the given host block size, for the given
+ * duration. The time taken by every call to its process (or analysis)
+ * function is measured, and reported as a fraction of the real-time budget
+ * (i.e. blockSize/samplerate seconds): the mean, the 99th percentile, and the
+ * worst case.
+ *
+ * Examples that offer approximate (faster) modes, e.g. reduced-precision HRTFs
+ * or the reduced quality levels, may also be compared with their reference
+ * mode (see benchmark_runAccuracy()), on the same test signals: reporting the
+ * time taken alongside the error of the outputs relative to the reference (the
+ * SNR, and the deviation of their long-term spectra; and for binaural outputs,
+ * the error of the ILDs and the ITD), and the error of the direction-of-arrival
+ * estimates of the analysers, relative to the true direction of the source.
+ *
+ * Parameter changes recorded in a session (see saf_automation.h) may also be
+ * replayed against a processor, in order to reproduce and profile the
+ * workload of e.g. moving sources, head tracking, or preset switching, offline
+ * (see benchmark_replayAutomation()).
+ *
+ * Finally, benchmark_runChecks() verifies some of the framework features that
+ * the results depend on (e.g. that the worker threads flush denormals).
+ *
+ * @note The first second of processing after initialisation is not included
+ *       in the statistics, since some of the examples complete their
+ *       initialisation during the first few process calls.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef __BENCHMARK_H_INCLUDED__
+#define __BENCHMARK_H_INCLUDED__
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ========================================================================== */
+/*                                   Enums                                    */
+/* ========================================================================== */
+
+/**
+ * Parameter indices of the automation replayed by benchmark_replayAutomation()
+ * (i.e. those passed to saf_automation_record() while recording a session);
+ * parameters that a processor does not have are ignored
+ */
+typedef enum _BENCHMARK_AUTOMATION_PARAMS {
+    BENCHMARK_PARAM_SOURCE_DIR = 0,   /**< Direction of a source; values: [index
+                                       *   azimuth elevation], in DEGREES */
+    BENCHMARK_PARAM_NUM_SOURCES,      /**< Number of sources; values: [number] */
+    BENCHMARK_PARAM_YAW_PITCH_ROLL,   /**< Orientation of the listener/scene (e.g.
+                                       *   from head tracking); values: [yaw
+                                       *   pitch roll], in DEGREES */
+    BENCHMARK_PARAM_ENABLE_ROTATION,  /**< values: [0 or 1] */
+    BENCHMARK_PARAM_INPUT_PRESET,     /**< Input configuration preset; values:
+                                       *   [presetID] */
+    BENCHMARK_PARAM_OUTPUT_PRESET     /**< Output configuration preset; values:
+                                       *   [presetID] */
+
+}BENCHMARK_AUTOMATION_PARAMS;
+
+
+/* ========================================================================== */
+/*                               Main Functions                               */
+/* ========================================================================== */
+
+/**
+ * Returns the number of example processors that may be benchmarked
+ */
+int benchmark_getNumProcessors(void);
+
+/**
+ * Returns the name of a processor (e.g. "binauraliser")
+ *
+ * @param[in] procIdx Processor index; 0..benchmark_getNumProcessors()-1
+ */
+const char* benchmark_getProcessorName(int procIdx);
+
+/**
+ * Benchmarks one processor, in all of its configurations, and prints one line
+ * per configuration to 'stream'
+ *
+ * @param[in] stream     Stream to print the results to (e.g. stdout)
+ * @param[in] procIdx    Processor index; 0..benchmark_getNumProcessors()-1
+ * @param[in] samplerate Host samplerate, in Hz
+ * @param[in] blockSize  Host block size, in samples
+ * @param[in] duration_s Duration of noise to process, per configuration, in
+ *                       seconds
+ * @param[in] quickFLAG  '1' only the smallest and largest configurations, '0'
+ *                       all configurations
+ */
+void benchmark_runProcessor(FILE* stream,
+                            int procIdx,
+                            int samplerate,
+                            int blockSize,
+                            float duration_s,
+                            int quickFLAG);
+
+/**
+ * Benchmarks all of the processors (see benchmark_runProcessor())
+ */
+void benchmark_runAll(FILE* stream,
+                      int samplerate,
+                      int blockSize,
+                      float duration_s,
+                      int quickFLAG);
+
+/**
+ * Returns the number of modes of a processor, including the reference mode
+ * (0: it has no approximate modes, and is not compared)
+ *
+ * @param[in] procIdx Processor index; 0..benchmark_getNumProcessors()-1
+ */
+int benchmark_getNumModes(int procIdx);
+
+/**
+ * Compares the approximate modes of one processor with its reference mode, in
+ * all of its configurations, and prints one line per configuration and mode
+ * to 'stream'
+ *
+ * The columns are: the mean time per block, as a fraction of the real-time
+ * budget; the SNR of the outputs relative to those of the reference mode, in
+ * dB; the mean absolute deviation of their long-term spectra, in dB; the mean
+ * absolute error of the ILDs in dB, and the error of the ITD in microseconds
+ * (binaural outputs only); and the mean angular error of the
+ * direction-of-arrival estimates, relative to the true direction of the test
+ * source, in degrees (analysers only). Metrics that do not apply are printed
+ * as "-".
+ *
+ * @param[in] stream     Stream to print the results to (e.g. stdout)
+ * @param[in] procIdx    Processor index; 0..benchmark_getNumProcessors()-1
+ * @param[in] samplerate Host samplerate, in Hz
+ * @param[in] blockSize  Host block size, in samples
+ * @param[in] duration_s Duration of the test signals to process, per
+ *                       configuration and mode, in seconds
+ * @param[in] quickFLAG  '1' only the smallest and largest configurations, '0'
+ *                       all configurations
+ */
+void benchmark_runAccuracy(FILE* stream,
+                           int procIdx,
+                           int samplerate,
+                           int blockSize,
+                           float duration_s,
+                           int quickFLAG);
+
+/**
+ * Compares the approximate modes of all of the processors that have them (see
+ * benchmark_runAccuracy())
+ */
+void benchmark_runAccuracyAll(FILE* stream,
+                              int samplerate,
+                              int blockSize,
+                              float duration_s,
+                              int quickFLAG);
+
+/**
+ * Returns 1 if automation may be replayed against a processor, 0 otherwise
+ *
+ * @param[in] procIdx Processor index; 0..benchmark_getNumProcessors()-1
+ */
+int benchmark_getAutomationSupport(int procIdx);
+
+/**
+ * Replays automation (see saf_automation.h, and BENCHMARK_AUTOMATION_PARAMS)
+ * against one configuration of a processor, fed with white noise
+ *
+ * Before each block is processed, the events positioned up to its first sample
+ * are applied (along with any re-initialisation they require, as would be
+ * carried out by the host's initialisation thread). The time taken by every
+ * call to the processing function is measured, and the mean, 99th percentile
+ * and worst case are printed as a fraction of the real-time budget, along with
+ * the time taken to apply the events; followed by the slowest blocks, their
+ * positions, and the parameters that changed just before them.
+ *
+ * @note Unlike benchmark_runProcessor(), the processing is timed from the first
+ *       block, since the automation usually starts with the session.
+ *
+ * @param[in] stream     Stream to print the results to (e.g. stdout)
+ * @param[in] procIdx    Processor index; 0..benchmark_getNumProcessors()-1
+ * @param[in] configIdx  Configuration index (see benchmark_runProcessor())
+ * @param[in] hAuto      saf_automation handle (e.g. as loaded with
+ *                       saf_automation_load()); it is rewound first
+ * @param[in] samplerate Host samplerate, in Hz (that of the recording)
+ * @param[in] blockSize  Host block size, in samples
+ * @param[in] duration_s Duration to process, in seconds; 0: until one second
+ *                       after the last event
+ */
+void benchmark_replayAutomation(FILE* stream,
+                                int procIdx,
+                                int configIdx,
+                                void* hAuto,
+                                int samplerate,
+                                int blockSize,
+                                float duration_s);
+
+/**
+ * Runs the self-checks, and prints one line per check to 'stream' ("ok",
+ * "FAILED", or "skipped" if it does not apply on this platform)
+ *
+ * The checks cover: the denormals guard inside the jobs of the saf_parfor
+ * worker threads (saf_denormals.h); the accuracy of utility_svsincosapprox()
+ * over its documented range; and the latency of saf_fifo, with and without
+ * host block sizes that are a multiple of its frame size.
+ *
+ * @param[in] stream Stream to print the results to (e.g. stdout)
+ * @returns The number of checks that failed
+ */
+int benchmark_runChecks(FILE* stream);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BENCHMARK_H_INCLUDED__ */
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark.c
+ * @brief An end-to-end, real-time budget benchmark of the example processors
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+
+/** All of the processors, in alphabetical order */
+static const benchmark_processor* const benchmark_processors[] = {
+    &benchmark_ambi_bin,
+    &benchmark_ambi_dec,
+    &benchmark_ambi_drc,
+    &benchmark_ambi_enc,
+    &benchmark_array2sh,
+    &benchmark_beamformer,
+    &benchmark_binauraliser,
+    &benchmark_dirass,
+    &benchmark_matrixconv,
+    &benchmark_multiconv,
+    &benchmark_panner,
+    &benchmark_powermap,
+    &benchmark_rotator,
+    &benchmark_sldoa,
+    &benchmark_upmix
+};
+
+/**
+ * Runs one configuration of a processor, and prints the statistics
+ */
+static void benchmark_runConfig
+(
+    FILE* stream,
+    const benchmark_processor* proc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    float duration_s
+)
+{
+    void* hProc;
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    int i, ch, nInputs, nOutputs, noiseLength, pos, nWarmupBlocks, nBlocks;
+    float budget, mean;
+    float** noise, **inputs, **outputs, *blockTimes;
+    double t0;
+
+    description[0] = '\0';
+    proc->create(&hProc, configIdx, samplerate, blockSize, description, &nInputs, &nOutputs);
+
+    /* white noise, which is looped over (so that generating it is not timed) */
+    noiseLength = MAX((int)(BENCHMARK_NOISE_LENGTH_S*(float)samplerate), blockSize);
+    noise = (float**)malloc2d(MAX(nInputs, 1), noiseLength, sizeof(float));
+    srand(1);
+    for(ch=0; ch<MAX(nInputs, 1); ch++)
+        for(i=0; i<noiseLength; i++)
+            noise[ch][i] = ((float)rand()/(float)RAND_MAX) - 0.5f;
+    inputs = (float**)malloc1d(MAX(nInputs, 1)*sizeof(float*));
+    outputs = (float**)calloc2d(MAX(nOutputs, 1), blockSize, sizeof(float));
+    nWarmupBlocks = (int)(BENCHMARK_WARMUP_TIME_S*(float)samplerate/(float)blockSize + 0.5f);
+    nBlocks = MAX((int)(duration_s*(float)samplerate/(float)blockSize + 0.5f), 1);
+    blockTimes = malloc1d(nBlocks*sizeof(float));
+
+    /* process, timing every block after the warm-up period */
+    pos = 0;
+    for(i=-nWarmupBlocks; i<nBlocks; i++){
+        if(pos+blockSize>noiseLength)
+            pos = 0;
+        for(ch=0; ch<nInputs; ch++)
+            inputs[ch] = &(noise[ch][pos]);
+        pos += blockSize;
+        t0 = saf_benchmark_getTime();
+        proc->process(hProc, inputs, outputs, nInputs, nOutputs, blockSize);
+        if(i>=0)
+            blockTimes[i] = (float)(saf_benchmark_getTime() - t0);
+    }
+
+    /* statistics, relative to the real-time budget */
+    budget = (float)blockSize/(float)samplerate;
+    mean = 0.0f;
+    for(i=0; i<nBlocks; i++)
+        mean += blockTimes[i];
+    mean /= (float)nBlocks;
+    sortf(blockTimes, NULL, NULL, nBlocks, 0);
+    fprintf(stream, "%-13s %-32s %5d %5d %9.2f%% %9.2f%% %9.2f%%\n", proc->name, description, nInputs, nOutputs,
+            100.0f*mean/budget, 100.0f*blockTimes[(int)(0.99f*(float)(nBlocks-1))]/budget, 100.0f*blockTimes[nBlocks-1]/budget);
+    fflush(stream);
+
+    proc->destroy(&hProc);
+    free(noise);
+    free(inputs);
+    free(outputs);
+    free(blockTimes);
+}
+
+int benchmark_getNumProcessors(void)
+{
+    return (int)(sizeof(benchmark_processors)/sizeof(benchmark_processors[0]));
+}
+
+const char* benchmark_getProcessorName(int procIdx)
+{
+    if(procIdx<0 || procIdx>=benchmark_getNumProcessors())
+        return NULL;
+    return benchmark_processors[procIdx]->name;
+}
+
+const benchmark_processor* benchmark_getProcessor(int procIdx)
+{
+    if(procIdx<0 || procIdx>=benchmark_getNumProcessors())
+        return NULL;
+    return benchmark_processors[procIdx];
+}
+
+void benchmark_runProcessor
+(
+    FILE* stream,
+    int procIdx,
+    int samplerate,
+    int blockSize,
+    float duration_s,
+    int quickFLAG
+)
+{
+    const benchmark_processor* proc;
+    int configIdx;
+
+    if(procIdx<0 || procIdx>=benchmark_getNumProcessors())
+        return;
+    proc = benchmark_processors[procIdx];
+    for(configIdx=0; configIdx<proc->nConfigs; configIdx++){
+        if(quickFLAG && configIdx!=0 && configIdx!=proc->nConfigs-1)
+            continue;
+        benchmark_runConfig(stream, proc, configIdx, samplerate, blockSize, duration_s);
+    }
+}
+
+void benchmark_runAll
+(
+    FILE* stream,
+    int samplerate,
+    int blockSize,
+    float duration_s,
+    int quickFLAG
+)
+{
+    int procIdx;
+
+    fprintf(stream, "Real-time budget benchmark; fs=%d Hz, block size=%d samples (%.3f ms), %.1f s per configuration\n",
+            samplerate, blockSize, 1e3f*(float)blockSize/(float)samplerate, duration_s);
+    fprintf(stream, "%-13s %-32s %5s %5s %10s %10s %10s\n", "processor", "configuration", "in", "out", "mean", "p99", "max");
+    for(procIdx=0; procIdx<benchmark_getNumProcessors(); procIdx++)
+        benchmark_runProcessor(stream, procIdx, samplerate, blockSize, duration_s, quickFLAG);
+}
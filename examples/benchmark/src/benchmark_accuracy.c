@@ -0,0 +1,360 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_accuracy.c
+ * @brief Accuracy-vs-speed comparison of the approximate modes of the example
+ *        processors with their reference modes
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+
+/** Outcome of processing the test signals in one mode */
+typedef struct _benchmark_modeResult {
+    float meanTime;     /**< mean time per block, in seconds */
+    float doaError;     /**< mean DoA error, in degrees (-1: no estimates) */
+    int nDoAs;          /**< number of DoA estimates */
+    float** outputs;    /**< outputs after the warm-up; nOutputs x len */
+    float** spectra;    /**< long-term power spectra; nOutputs x nBins */
+
+}benchmark_modeResult;
+
+/**
+ * Generates the test signals; nInputs x noiseLength (looped over)
+ */
+static float** benchmark_getTestSignals
+(
+    int inputType,
+    int nInputs,
+    int noiseLength
+)
+{
+    int i, ch, order;
+    float dir_deg[2], *Y, *src;
+    float** signals;
+
+    signals = (float**)malloc2d(MAX(nInputs, 1), noiseLength, sizeof(float));
+    srand(1);
+    for(ch=0; ch<MAX(nInputs, 1); ch++)
+        for(i=0; i<noiseLength; i++)
+            signals[ch][i] = ((float)rand()/(float)RAND_MAX) - 0.5f;
+    if(inputType==BENCHMARK_INPUT_SH_SOURCE && nInputs>0){
+        /* a source in the given direction (SN3D), plus the uncorrelated noise */
+        order = (int)(sqrtf((float)nInputs)+0.5f) - 1;
+        dir_deg[0] = BENCHMARK_SOURCE_AZI_DEG;
+        dir_deg[1] = BENCHMARK_SOURCE_ELEV_DEG;
+        Y = malloc1d(ORDER2NSH(order)*sizeof(float));
+        getRSH(order, (float*)dir_deg, 1, Y);
+        for(ch=0; ch<ORDER2NSH(order); ch++)
+            Y[ch] /= sqrtf(2.0f*floorf(sqrtf((float)ch))+1.0f);
+        src = malloc1d(noiseLength*sizeof(float));
+        for(i=0; i<noiseLength; i++)
+            src[i] = ((float)rand()/(float)RAND_MAX) - 0.5f;
+        for(ch=0; ch<MIN(nInputs, ORDER2NSH(order)); ch++)
+            for(i=0; i<noiseLength; i++)
+                signals[ch][i] = Y[ch]*src[i] + BENCHMARK_DIFFUSE_GAIN*signals[ch][i];
+        free(Y);
+        free(src);
+    }
+    return signals;
+}
+
+/**
+ * Computes the long-term power spectra of signals (Hann-windowed frames of
+ * BENCHMARK_SPECTRUM_NFFT samples, without overlap)
+ */
+static void benchmark_getSpectra
+(
+    float** signals,
+    int nChannels,
+    int len,
+    float** spectra
+)
+{
+    void* hFFT;
+    int ch, k, frame, nBins, nFrames;
+    float *win, *buf;
+    float_complex* spec;
+
+    nBins = BENCHMARK_SPECTRUM_NFFT/2+1;
+    nFrames = len/BENCHMARK_SPECTRUM_NFFT;
+    saf_rfft_create(&hFFT, BENCHMARK_SPECTRUM_NFFT);
+    win = malloc1d(BENCHMARK_SPECTRUM_NFFT*sizeof(float));
+    buf = malloc1d(BENCHMARK_SPECTRUM_NFFT*sizeof(float));
+    spec = malloc1d(nBins*sizeof(float_complex));
+    getWindowingFunction(WINDOWING_FUNCTION_HANN, BENCHMARK_SPECTRUM_NFFT, win);
+    for(ch=0; ch<nChannels; ch++){
+        memset(spectra[ch], 0, nBins*sizeof(float));
+        for(frame=0; frame<nFrames; frame++){
+            utility_svvmul(&(signals[ch][frame*BENCHMARK_SPECTRUM_NFFT]), win, BENCHMARK_SPECTRUM_NFFT, buf);
+            saf_rfft_forward(hFFT, buf, spec);
+            for(k=0; k<nBins; k++)
+                spectra[ch][k] += (crealf(spec[k])*crealf(spec[k]) + cimagf(spec[k])*cimagf(spec[k]))/(float)MAX(nFrames,1);
+        }
+    }
+    saf_rfft_destroy(&hFFT);
+    free(win);
+    free(buf);
+    free(spec);
+}
+
+/**
+ * Returns the ITD of a binaural signal, in seconds; i.e. the lag (within
+ * +/-BENCHMARK_MAX_ITD_S) that maximises the cross-correlation of the ears
+ */
+static float benchmark_getITD
+(
+    float** binaural,
+    int len,
+    int samplerate
+)
+{
+    int i, lag, maxLag, bestLag;
+    double xcorr, bestXcorr;
+
+    maxLag = (int)(BENCHMARK_MAX_ITD_S*(float)samplerate + 0.5f);
+    bestLag = 0;
+    bestXcorr = -1e30;
+    for(lag=-maxLag; lag<=maxLag; lag++){
+        xcorr = 0.0;
+        for(i=MAX(0, -lag); i<MIN(len, len-lag); i++)
+            xcorr += (double)binaural[0][i]*(double)binaural[1][i+lag];
+        if(xcorr>bestXcorr){
+            bestXcorr = xcorr;
+            bestLag = lag;
+        }
+    }
+    return (float)bestLag/(float)samplerate;
+}
+
+/**
+ * Processes the test signals in one mode of a processor
+ */
+static void benchmark_runMode
+(
+    const benchmark_processor* proc,
+    void* hProc,
+    float** testSignals,
+    int noiseLength,
+    int nInputs,
+    int nOutputs,
+    int samplerate,
+    int blockSize,
+    int nBlocks,
+    benchmark_modeResult* result
+)
+{
+    int i, ch, pos, nWarmupBlocks;
+    float doa_deg[2], est_xyz[3], src_xyz[3], dotp;
+    float** inputs, **outputs;
+    double t0, totalTime, doaError;
+
+    inputs = (float**)malloc1d(MAX(nInputs, 1)*sizeof(float*));
+    outputs = (float**)malloc1d(MAX(nOutputs, 1)*sizeof(float*));
+    unitSph2Cart(BENCHMARK_SOURCE_AZI_DEG*PI/180.0f, BENCHMARK_SOURCE_ELEV_DEG*PI/180.0f, src_xyz);
+    nWarmupBlocks = (int)(BENCHMARK_WARMUP_TIME_S*(float)samplerate/(float)blockSize + 0.5f);
+    result->outputs = nOutputs>0 ? (float**)calloc2d(nOutputs, nBlocks*blockSize, sizeof(float)) : NULL;
+    result->nDoAs = 0;
+    doaError = totalTime = 0.0;
+
+    /* process, timing every block after the warm-up period (the outputs of
+     * the warm-up period are written to the first block, and overwritten) */
+    pos = 0;
+    for(i=-nWarmupBlocks; i<nBlocks; i++){
+        if(pos+blockSize>noiseLength)
+            pos = 0;
+        for(ch=0; ch<nInputs; ch++)
+            inputs[ch] = &(testSignals[ch][pos]);
+        for(ch=0; ch<nOutputs; ch++)
+            outputs[ch] = &(result->outputs[ch][MAX(i, 0)*blockSize]);
+        pos += blockSize;
+        t0 = saf_benchmark_getTime();
+        proc->process(hProc, inputs, outputs, nInputs, nOutputs, blockSize);
+        if(i>=0)
+            totalTime += saf_benchmark_getTime() - t0;
+
+        /* (the activity-maps are only generated while they are being asked for) */
+        if(proc->getDoA!=NULL && proc->getDoA(hProc, doa_deg) && i>=0){
+            unitSph2Cart(doa_deg[0]*PI/180.0f, doa_deg[1]*PI/180.0f, est_xyz);
+            utility_svvdot(est_xyz, src_xyz, 3, &dotp);
+            doaError += (double)(acosf(CLAMP(dotp, -1.0f, 1.0f))*180.0f/PI);
+            result->nDoAs++;
+        }
+    }
+    result->meanTime = (float)(totalTime/(double)nBlocks);
+    result->doaError = result->nDoAs>0 ? (float)(doaError/(double)result->nDoAs) : -1.0f;
+    result->spectra = NULL;
+    if(nOutputs>0){
+        result->spectra = (float**)malloc2d(nOutputs, BENCHMARK_SPECTRUM_NFFT/2+1, sizeof(float));
+        benchmark_getSpectra(result->outputs, nOutputs, nBlocks*blockSize, result->spectra);
+    }
+    free(inputs);
+    free(outputs);
+}
+
+/**
+ * Runs one configuration of a processor in all of its modes, and prints the
+ * metrics of each mode relative to the reference mode
+ */
+static void benchmark_runConfigAccuracy
+(
+    FILE* stream,
+    const benchmark_processor* proc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    float duration_s
+)
+{
+    void* hProc;
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH], modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    char snr[16], specDev[16], ild[16], itd[16], doa[16];
+    int i, ch, k, modeIdx, nInputs, nOutputs, refInputs, refOutputs, noiseLength, nBlocks, len, nBins, kMin, kMax;
+    float budget, itdRef;
+    float** testSignals;
+    double sig, err, dev, ildErr, Pl, Pr, Pl_ref, Pr_ref;
+    benchmark_modeResult ref, cur;
+
+    noiseLength = MAX((int)(BENCHMARK_NOISE_LENGTH_S*(float)samplerate), blockSize);
+    nBlocks = MAX((int)(duration_s*(float)samplerate/(float)blockSize + 0.5f), 1);
+    len = nBlocks*blockSize;
+    budget = (float)blockSize/(float)samplerate;
+    nBins = BENCHMARK_SPECTRUM_NFFT/2+1;
+    kMin = MAX((int)(BENCHMARK_SPECTRUM_MIN_FREQ*(float)BENCHMARK_SPECTRUM_NFFT/(float)samplerate + 0.5f), 1);
+    kMax = MIN((int)(BENCHMARK_SPECTRUM_MAX_FREQ*(float)BENCHMARK_SPECTRUM_NFFT/(float)samplerate + 0.5f), nBins-1);
+    testSignals = NULL;
+    refInputs = refOutputs = 0;
+    itdRef = 0.0f;
+    memset(&ref, 0, sizeof(benchmark_modeResult));
+
+    for(modeIdx=0; modeIdx<proc->nModes; modeIdx++){
+        description[0] = modeDescription[0] = '\0';
+        proc->createMode(&hProc, configIdx, modeIdx, samplerate, blockSize, description, modeDescription, &nInputs, &nOutputs);
+        if(modeIdx==0){
+            testSignals = benchmark_getTestSignals(proc->inputType, nInputs, noiseLength);
+            refInputs = nInputs;
+            refOutputs = nOutputs;
+        }
+        else if(nInputs!=refInputs || nOutputs!=refOutputs){
+            /* (the modes must not change the number of channels) */
+            proc->destroy(&hProc);
+            continue;
+        }
+        benchmark_runMode(proc, hProc, testSignals, noiseLength, nInputs, nOutputs, samplerate, blockSize, nBlocks, &cur);
+        proc->destroy(&hProc);
+
+        /* metrics, relative to the reference mode */
+        strcpy(snr, "-"); strcpy(specDev, "-"); strcpy(ild, "-"); strcpy(itd, "-"); strcpy(doa, "-");
+        if(modeIdx==0){
+            ref = cur;
+            if(proc->binauralFLAG && nOutputs==2)
+                itdRef = benchmark_getITD(ref.outputs, len, samplerate);
+        }
+        else if(nOutputs>0){
+            sig = err = dev = 0.0;
+            for(ch=0; ch<nOutputs; ch++){
+                for(i=0; i<len; i++){
+                    sig += (double)ref.outputs[ch][i]*(double)ref.outputs[ch][i];
+                    err += ((double)cur.outputs[ch][i]-(double)ref.outputs[ch][i])*((double)cur.outputs[ch][i]-(double)ref.outputs[ch][i]);
+                }
+                for(k=kMin; k<=kMax; k++)
+                    dev += fabs(10.0*log10(((double)cur.spectra[ch][k]+1e-20)/((double)ref.spectra[ch][k]+1e-20)));
+            }
+            if(err>0.0)
+                sprintf(snr, "%.1f", 10.0*log10((sig+1e-30)/err));
+            else
+                strcpy(snr, "inf");
+            sprintf(specDev, "%.3f", dev/(double)(nOutputs*(kMax-kMin+1)));
+            if(proc->binauralFLAG && nOutputs==2){
+                ildErr = 0.0;
+                for(k=kMin; k<=kMax; k++){
+                    Pl = (double)cur.spectra[0][k]+1e-20;
+                    Pr = (double)cur.spectra[1][k]+1e-20;
+                    Pl_ref = (double)ref.spectra[0][k]+1e-20;
+                    Pr_ref = (double)ref.spectra[1][k]+1e-20;
+                    ildErr += fabs(10.0*log10(Pl/Pr) - 10.0*log10(Pl_ref/Pr_ref));
+                }
+                sprintf(ild, "%.3f", ildErr/(double)(kMax-kMin+1));
+                sprintf(itd, "%.1f", 1e6f*fabsf(benchmark_getITD(cur.outputs, len, samplerate)-itdRef));
+            }
+        }
+        if(cur.nDoAs>0)
+            sprintf(doa, "%.2f", cur.doaError);
+        fprintf(stream, "%-13s %-24s %-24s %9.2f%% %8s %8s %8s %8s %8s\n", proc->name, description, modeDescription,
+                100.0f*cur.meanTime/budget, snr, specDev, ild, itd, doa);
+        fflush(stream);
+        if(modeIdx>0){
+            free(cur.outputs);
+            free(cur.spectra);
+        }
+    }
+    free(ref.outputs);
+    free(ref.spectra);
+    free(testSignals);
+}
+
+int benchmark_getNumModes(int procIdx)
+{
+    const benchmark_processor* proc = benchmark_getProcessor(procIdx);
+    if(proc==NULL || proc->createMode==NULL)
+        return 0;
+    return proc->nModes;
+}
+
+void benchmark_runAccuracy
+(
+    FILE* stream,
+    int procIdx,
+    int samplerate,
+    int blockSize,
+    float duration_s,
+    int quickFLAG
+)
+{
+    const benchmark_processor* proc;
+    int configIdx;
+
+    if(benchmark_getNumModes(procIdx)<1)
+        return;
+    proc = benchmark_getProcessor(procIdx);
+    for(configIdx=0; configIdx<proc->nConfigs; configIdx++){
+        if(quickFLAG && configIdx!=0 && configIdx!=proc->nConfigs-1)
+            continue;
+        benchmark_runConfigAccuracy(stream, proc, configIdx, samplerate, blockSize, duration_s);
+    }
+}
+
+void benchmark_runAccuracyAll
+(
+    FILE* stream,
+    int samplerate,
+    int blockSize,
+    float duration_s,
+    int quickFLAG
+)
+{
+    int procIdx;
+
+    fprintf(stream, "Accuracy-vs-speed comparison; fs=%d Hz, block size=%d samples (%.3f ms), %.1f s per configuration and mode\n",
+            samplerate, blockSize, 1e3f*(float)blockSize/(float)samplerate, duration_s);
+    fprintf(stream, "%-13s %-24s %-24s %10s %8s %8s %8s %8s %8s\n", "processor", "configuration", "mode", "mean",
+            "SNR[dB]", "spec[dB]", "ILD[dB]", "ITD[us]", "DoA[deg]");
+    for(procIdx=0; procIdx<benchmark_getNumProcessors(); procIdx++)
+        benchmark_runAccuracy(stream, procIdx, samplerate, blockSize, duration_s, quickFLAG);
+}
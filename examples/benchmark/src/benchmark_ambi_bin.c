@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_ambi_bin.c
+ * @brief Benchmark configurations of the ambi_bin example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../ambi_bin/include/ambi_bin.h"
+
+static const int ambi_bin_orders[4] = {1, 3, 5, 7};
+
+static void benchmark_ambi_bin_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = ambi_bin_orders[configIdx];
+
+    ambi_bin_create(phProc);
+    ambi_bin_setInputOrderPreset(*phProc, (AMBI_BIN_INPUT_ORDERS)order);
+    ambi_bin_init(*phProc, samplerate);
+    ambi_bin_initCodec(*phProc);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = ambi_bin_getNumEars();
+    sprintf(description, "order=%d", order);
+}
+
+static void benchmark_ambi_bin_setParam
+(
+    void* const hProc,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    switch(param){
+        case BENCHMARK_PARAM_YAW_PITCH_ROLL:
+            if(nValues<3) break;
+            ambi_bin_setYaw(hProc, values[0]);
+            ambi_bin_setPitch(hProc, values[1]);
+            ambi_bin_setRoll(hProc, values[2]);
+            break;
+        case BENCHMARK_PARAM_ENABLE_ROTATION: if(nValues>0) ambi_bin_setEnableRotation(hProc, (int)values[0]); break;
+    }
+    ambi_bin_initCodec(hProc); /* (returns straight away, if it is not required) */
+}
+
+const benchmark_processor benchmark_ambi_bin = {
+    "ambi_bin", 4, benchmark_ambi_bin_create, ambi_bin_process, ambi_bin_destroy,
+    0, NULL, NULL, BENCHMARK_INPUT_NOISE, 1, benchmark_ambi_bin_setParam };
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_ambi_dec.c
+ * @brief Benchmark configurations of the ambi_dec example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../ambi_dec/include/ambi_dec.h"
+
+static const int ambi_dec_orders[4] = {1, 3, 5, 7};
+
+static void benchmark_ambi_dec_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = ambi_dec_orders[configIdx];
+
+    ambi_dec_create(phProc);
+    ambi_dec_setMasterDecOrder(*phProc, order);
+    ambi_dec_setDecOrderAllBands(*phProc, order);
+    ambi_dec_init(*phProc, samplerate);
+    ambi_dec_initCodec(*phProc);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = ambi_dec_getNumLoudspeakers(*phProc);
+    sprintf(description, "order=%d, %d loudspeakers", order, *nOutputs);
+}
+
+const benchmark_processor benchmark_ambi_dec = {
+    "ambi_dec", 4, benchmark_ambi_dec_create, ambi_dec_process, ambi_dec_destroy };
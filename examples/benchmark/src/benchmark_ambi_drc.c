@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_ambi_drc.c
+ * @brief Benchmark configurations of the ambi_drc example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../ambi_drc/include/ambi_drc.h"
+
+static const int ambi_drc_orders[4] = {1, 3, 5, 7};
+
+static void benchmark_ambi_drc_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = ambi_drc_orders[configIdx];
+
+    ambi_drc_create(phProc);
+    ambi_drc_setInputPreset(*phProc, (AMBI_DRC_INPUT_ORDER)order);
+    ambi_drc_init(*phProc, samplerate);
+    (*nInputs) = (*nOutputs) = ORDER2NSH(order);
+    sprintf(description, "order=%d", order);
+}
+
+static void benchmark_ambi_drc_process
+(
+    void* const hProc,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples
+)
+{
+    ambi_drc_process(hProc, inputs, outputs, MIN(nInputs, nOutputs), nSamples);
+}
+
+const benchmark_processor benchmark_ambi_drc = {
+    "ambi_drc", 4, benchmark_ambi_drc_create, benchmark_ambi_drc_process, ambi_drc_destroy };
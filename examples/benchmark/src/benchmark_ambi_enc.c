@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_ambi_enc.c
+ * @brief Benchmark configurations of the ambi_enc example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../ambi_enc/include/ambi_enc.h"
+
+static const int ambi_enc_configs[4][2] = {{8, 1}, {16, 3}, {32, 5}, {64, 7}}; /* nSources, order */
+
+static void benchmark_ambi_enc_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int nSources = MIN(ambi_enc_configs[configIdx][0], ambi_enc_getMaxNumSources());
+    int order = ambi_enc_configs[configIdx][1];
+
+    ambi_enc_create(phProc);
+    ambi_enc_setOutputOrder(*phProc, order);
+    ambi_enc_setNumSources(*phProc, nSources);
+    ambi_enc_init(*phProc, samplerate);
+    (*nInputs) = nSources;
+    (*nOutputs) = ORDER2NSH(order);
+    sprintf(description, "%d sources, order=%d", nSources, order);
+}
+
+const benchmark_processor benchmark_ambi_enc = {
+    "ambi_enc", 4, benchmark_ambi_enc_create, ambi_enc_process, ambi_enc_destroy };
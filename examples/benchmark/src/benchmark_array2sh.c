@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_array2sh.c
+ * @brief Benchmark configurations of the array2sh example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../array2sh/include/array2sh.h"
+
+static const int array2sh_presets[3] = {
+    MICROPHONE_ARRAY_PRESET_ZYLIA_1D,
+    MICROPHONE_ARRAY_PRESET_EIGENMIKE32,
+    MICROPHONE_ARRAY_PRESET_DTU_MIC
+};
+static const char* const array2sh_presetNames[3] = { "Zylia", "Eigenmike32", "DTU mic" };
+
+static void benchmark_array2sh_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order;
+
+    array2sh_create(phProc);
+    array2sh_setPreset(*phProc, array2sh_presets[configIdx]);
+    array2sh_init(*phProc, samplerate);
+    order = array2sh_getEncodingOrder(*phProc);
+    (*nInputs) = array2sh_getNumSensors(*phProc);
+    (*nOutputs) = ORDER2NSH(order);
+    sprintf(description, "%s, order=%d", array2sh_presetNames[configIdx], order);
+}
+
+const benchmark_processor benchmark_array2sh = {
+    "array2sh", 3, benchmark_array2sh_create, array2sh_process, array2sh_destroy };
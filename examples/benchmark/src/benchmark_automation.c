@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_automation.c
+ * @brief Replays recorded automation against the example processors, and
+ *        reports the time taken per block
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+
+/** Number of channels passed to the processors (presets may change the
+ *  number of channels during the replay; the examples ignore any extra ones) */
+#define BENCHMARK_AUTOMATION_MIN_NUM_CHANNELS ( 64 )
+
+/** Names of the BENCHMARK_AUTOMATION_PARAMS */
+static const char* const benchmark_paramNames[BENCHMARK_PARAM_OUTPUT_PRESET+1] = {
+    "source direction", "number of sources", "yaw/pitch/roll", "rotation on/off", "input preset", "output preset" };
+
+int benchmark_getAutomationSupport(int procIdx)
+{
+    const benchmark_processor* proc = benchmark_getProcessor(procIdx);
+    return proc!=NULL && proc->setParam!=NULL;
+}
+
+void benchmark_replayAutomation
+(
+    FILE* stream,
+    int procIdx,
+    int configIdx,
+    void* hAuto,
+    int samplerate,
+    int blockSize,
+    float duration_s
+)
+{
+    const benchmark_processor* proc;
+    void* hProc;
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    int i, j, b, ch, nInputs, nOutputs, noiseLength, pos, nBlocks, param, nValues, nEvents;
+    int* blockParams, *sortedIdx;
+    float budget, mean, p99, maxTime, maxSetTime, totalSetTime;
+    float values[SAF_AUTOMATION_MAX_NUM_VALUES];
+    float** noise, **inputs, **outputs, *blockTimes, *sortedTimes;
+    double t0, setTime;
+
+    if(!benchmark_getAutomationSupport(procIdx))
+        return;
+    proc = benchmark_getProcessor(procIdx);
+    configIdx = CLAMP(configIdx, 0, proc->nConfigs-1);
+    description[0] = '\0';
+    proc->create(&hProc, configIdx, samplerate, blockSize, description, &nInputs, &nOutputs);
+    nInputs = MAX(nInputs, BENCHMARK_AUTOMATION_MIN_NUM_CHANNELS);
+    nOutputs = MAX(nOutputs, BENCHMARK_AUTOMATION_MIN_NUM_CHANNELS);
+
+    /* white noise, which is looped over */
+    noiseLength = MAX((int)(BENCHMARK_NOISE_LENGTH_S*(float)samplerate), blockSize);
+    noise = (float**)malloc2d(nInputs, noiseLength, sizeof(float));
+    srand(1);
+    for(ch=0; ch<nInputs; ch++)
+        for(i=0; i<noiseLength; i++)
+            noise[ch][i] = ((float)rand()/(float)RAND_MAX) - 0.5f;
+    inputs = (float**)malloc1d(nInputs*sizeof(float*));
+    outputs = (float**)calloc2d(nOutputs, blockSize, sizeof(float));
+    if(duration_s>0.0f)
+        nBlocks = MAX((int)(duration_s*(float)samplerate/(float)blockSize + 0.5f), 1);
+    else
+        nBlocks = (int)((MAX(saf_automation_getLastPosition(hAuto), 0) + (long long)samplerate)/(long long)blockSize) + 1;
+    blockTimes = malloc1d(nBlocks*sizeof(float));
+    sortedTimes = malloc1d(nBlocks*sizeof(float));
+    sortedIdx = malloc1d(nBlocks*sizeof(int));
+    blockParams = calloc1d(nBlocks, sizeof(int));
+
+    /* apply the events due before each block, and then time the block */
+    saf_automation_rewind(hAuto);
+    nEvents = 0;
+    pos = 0;
+    maxSetTime = totalSetTime = 0.0f;
+    for(b=0; b<nBlocks; b++){
+        setTime = 0.0;
+        while(saf_automation_getNextEvent(hAuto, (long long)b*(long long)blockSize, NULL, &param, values, &nValues)){
+            t0 = saf_benchmark_getTime();
+            proc->setParam(hProc, param, values, nValues);
+            setTime += saf_benchmark_getTime() - t0;
+            if(param>=0 && param<=BENCHMARK_PARAM_OUTPUT_PRESET)
+                blockParams[b] |= 1<<param;
+            nEvents++;
+        }
+        maxSetTime = MAX(maxSetTime, (float)setTime);
+        totalSetTime += (float)setTime;
+
+        if(pos+blockSize>noiseLength)
+            pos = 0;
+        for(ch=0; ch<nInputs; ch++)
+            inputs[ch] = &(noise[ch][pos]);
+        pos += blockSize;
+        t0 = saf_benchmark_getTime();
+        proc->process(hProc, inputs, outputs, nInputs, nOutputs, blockSize);
+        blockTimes[b] = (float)(saf_benchmark_getTime() - t0);
+    }
+
+    /* statistics, relative to the real-time budget */
+    budget = (float)blockSize/(float)samplerate;
+    mean = 0.0f;
+    for(b=0; b<nBlocks; b++)
+        mean += blockTimes[b];
+    mean /= (float)nBlocks;
+    sortf(blockTimes, sortedTimes, sortedIdx, nBlocks, 1);
+    p99 = sortedTimes[MIN((int)(0.01f*(float)(nBlocks-1)+0.5f), nBlocks-1)];
+    maxTime = sortedTimes[0];
+    fprintf(stream, "Automation replay; %s (%s), %d events over %.2f s; fs=%d Hz, block size=%d samples (%.3f ms)\n",
+            proc->name, description, nEvents, (float)nBlocks*budget, samplerate, blockSize, 1e3f*budget);
+    fprintf(stream, "  process: mean %.2f%%, p99 %.2f%%, max %.2f%% of the budget\n",
+            100.0f*mean/budget, 100.0f*p99/budget, 100.0f*maxTime/budget);
+    fprintf(stream, "  applying the events: %.3f ms in total, %.3f ms at most before one block\n",
+            1e3f*totalSetTime, 1e3f*maxSetTime);
+    for(i=0; i<MIN(BENCHMARK_NUM_SLOWEST_BLOCKS, nBlocks); i++){
+        b = sortedIdx[i];
+        fprintf(stream, "  block %d (t=%.3f s): %.2f%%", b, (float)b*budget, 100.0f*blockTimes[b]/budget);
+        if(blockParams[b]==0)
+            fprintf(stream, " (no changes)");
+        else{
+            fprintf(stream, " after:");
+            for(j=0; j<=BENCHMARK_PARAM_OUTPUT_PRESET; j++)
+                if(blockParams[b] & (1<<j))
+                    fprintf(stream, " [%s]", benchmark_paramNames[j]);
+        }
+        fprintf(stream, "\n");
+    }
+    fflush(stream);
+
+    proc->destroy(&hProc);
+    free(noise);
+    free(inputs);
+    free(outputs);
+    free(blockTimes);
+    free(sortedTimes);
+    free(sortedIdx);
+    free(blockParams);
+}
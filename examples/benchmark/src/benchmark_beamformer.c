@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_beamformer.c
+ * @brief Benchmark configurations of the beamformer example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../beamformer/include/beamformer.h"
+
+static const int beamformer_configs[4][2] = {{1, 4}, {3, 16}, {5, 32}, {7, 64}}; /* order, nBeams */
+
+static void benchmark_beamformer_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = beamformer_configs[configIdx][0];
+    int nBeams = MIN(beamformer_configs[configIdx][1], beamformer_getMaxNumBeams());
+
+    beamformer_create(phProc);
+    beamformer_setBeamOrder(*phProc, order);
+    beamformer_setNumBeams(*phProc, nBeams);
+    beamformer_init(*phProc, samplerate);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = nBeams;
+    sprintf(description, "order=%d, %d beams", order, nBeams);
+}
+
+const benchmark_processor benchmark_beamformer = {
+    "beamformer", 4, benchmark_beamformer_create, beamformer_process, beamformer_destroy };
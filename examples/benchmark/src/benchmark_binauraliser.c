@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_binauraliser.c
+ * @brief Benchmark configurations of the binauraliser example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../binauraliser/include/binauraliser.h"
+
+static const int binauraliser_nSources[4] = {4, 16, 32, 64};
+
+/* the reference mode, followed by the reduced-precision HRTFs and the
+ * reduced quality levels */
+static const int binauraliser_modePrecisions[6] = {HRTF_PRECISION_FLOAT32, HRTF_PRECISION_FLOAT16, HRTF_PRECISION_BFLOAT16,
+                                                   HRTF_PRECISION_FLOAT32, HRTF_PRECISION_FLOAT32, HRTF_PRECISION_FLOAT32};
+static const int binauraliser_modeQualityLevels[6] = {0, 0, 0, 1, 2, 3};
+static const char* const binauraliser_modeNames[6] = {"reference", "HRTFs in float16", "HRTFs in bfloat16",
+                                                      "quality level 1", "quality level 2", "quality level 3"};
+
+static void benchmark_binauraliser_createMode
+(
+    void** const phProc,
+    int configIdx,
+    int modeIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int nSources = MIN(binauraliser_nSources[configIdx], binauraliser_getMaxNumSources());
+
+    /* (the mode is set before the codec is initialised, so that it is not
+     * applied in the background) */
+    binauraliser_create(phProc);
+    binauraliser_setNumSources(*phProc, nSources);
+    binauraliser_setHRTFprecision(*phProc, binauraliser_modePrecisions[modeIdx]);
+    binauraliser_setQualityLevel(*phProc, binauraliser_modeQualityLevels[modeIdx]);
+    binauraliser_init(*phProc, samplerate);
+    binauraliser_initCodec(*phProc);
+    (*nInputs) = nSources;
+    (*nOutputs) = binauraliser_getNumEars();
+    sprintf(description, "%d sources", nSources);
+    strcpy(modeDescription, binauraliser_modeNames[modeIdx]);
+}
+
+static void benchmark_binauraliser_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    benchmark_binauraliser_createMode(phProc, configIdx, 0, samplerate, blockSize, description, modeDescription, nInputs, nOutputs);
+}
+
+static void benchmark_binauraliser_setParam
+(
+    void* const hProc,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    switch(param){
+        case BENCHMARK_PARAM_SOURCE_DIR:
+            if(nValues<3) break;
+            binauraliser_setSourceAzi_deg(hProc, (int)values[0], values[1]);
+            binauraliser_setSourceElev_deg(hProc, (int)values[0], values[2]);
+            break;
+        case BENCHMARK_PARAM_NUM_SOURCES:     if(nValues>0) binauraliser_setNumSources(hProc, (int)values[0]); break;
+        case BENCHMARK_PARAM_YAW_PITCH_ROLL:
+            if(nValues<3) break;
+            binauraliser_setYaw(hProc, values[0]);
+            binauraliser_setPitch(hProc, values[1]);
+            binauraliser_setRoll(hProc, values[2]);
+            break;
+        case BENCHMARK_PARAM_ENABLE_ROTATION: if(nValues>0) binauraliser_setEnableRotation(hProc, (int)values[0]); break;
+        case BENCHMARK_PARAM_INPUT_PRESET:    if(nValues>0) binauraliser_setInputConfigPreset(hProc, (int)values[0]); break;
+    }
+    binauraliser_initCodec(hProc); /* (returns straight away, if it is not required) */
+}
+
+const benchmark_processor benchmark_binauraliser = {
+    "binauraliser", 4, benchmark_binauraliser_create, binauraliser_process, binauraliser_destroy,
+    6, benchmark_binauraliser_createMode, NULL, BENCHMARK_INPUT_NOISE, 1, benchmark_binauraliser_setParam };
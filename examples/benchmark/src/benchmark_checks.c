@@ -0,0 +1,274 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_checks.c
+ * @brief Self-checks of the framework features that the benchmarks rely on
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+
+#define BENCHMARK_CHECK_NUM_THREADS ( 4 )       /* threads of the saf_parfor pool of the denormals check */
+#define BENCHMARK_CHECK_INDICES_PER_THREAD ( 8 )
+#define BENCHMARK_CHECK_SINCOS_LEN ( 65536 )    /* arguments per range of the sincos check */
+#define BENCHMARK_CHECK_SINCOS_TOL ( 1.2e-7 )   /* absolute error allowed by the sincos check */
+#define BENCHMARK_CHECK_FIFO_FRAME_SIZE ( 64 )  /* frame size of the FIFO check */
+#define BENCHMARK_CHECK_FIFO_LEN ( 1024 )       /* length of the ramp passed through the FIFO */
+
+/** Context of the loop body of benchmark_checkDenormals() */
+typedef struct _benchmark_denormalsCtx {
+    int* flushed;       /**< per index: 1 if denormals were flushed */
+    int* threadIndex;   /**< per index: thread that processed it */
+
+}benchmark_denormalsCtx;
+
+/** Loop body, which records the floating-point modes it was run with */
+static void benchmark_denormalsBody
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    benchmark_denormalsCtx* ctx = (benchmark_denormalsCtx*)hCtx;
+    int i;
+
+    for(i=first; i<last; i++){
+        ctx->flushed[i] = saf_denormals_areFlushed();
+        ctx->threadIndex[i] = threadIndex;
+    }
+}
+
+/** Prints the outcome of a check, and returns 1 if it failed */
+static int benchmark_printCheck
+(
+    FILE* stream,
+    const char* name,
+    int passed,
+    const char* details
+)
+{
+    fprintf(stream, "%-48s %-7s %s\n", name, passed ? "ok" : "FAILED", details);
+    return passed ? 0 : 1;
+}
+
+/**
+ * Checks that the loop bodies run by the worker threads of saf_parfor flush
+ * denormals to zero while the guard is enabled, and that the workers are left
+ * in their previous modes afterwards (and when the guard is disabled)
+ */
+static int benchmark_checkDenormals
+(
+    FILE* stream
+)
+{
+    void* hPar;
+    int i, n, nThreads, nWorkerIdx, nFlushedOn, nFlushedOff, supported, wasEnabled;
+    unsigned int fpState;
+    char details[128];
+    benchmark_denormalsCtx ctx;
+
+    /* (the guard does nothing on platforms without a flush-to-zero mode) */
+    fpState = saf_denormals_guardBegin();
+    supported = saf_denormals_areFlushed();
+    saf_denormals_guardEnd(fpState);
+    wasEnabled = saf_denormals_getGuardEnabled();
+    if(!supported && wasEnabled){
+        fprintf(stream, "%-48s %-7s %s\n", "denormals: flushed in parfor workers", "skipped", "(not supported)");
+        return 0;
+    }
+
+    saf_parfor_create(&hPar, BENCHMARK_CHECK_NUM_THREADS);
+    nThreads = saf_parfor_getNumThreads(hPar);
+    n = nThreads*BENCHMARK_CHECK_INDICES_PER_THREAD;
+    ctx.flushed = malloc1d(n*sizeof(int));
+    ctx.threadIndex = malloc1d(n*sizeof(int));
+
+    /* guard enabled: as called from within the processing function of an
+     * example, every index should be processed with denormals flushed */
+    saf_denormals_setGuardEnabled(1);
+    fpState = saf_denormals_guardBegin();
+    saf_parfor_run(hPar, benchmark_denormalsBody, (void*)&ctx, n);
+    saf_denormals_guardEnd(fpState);
+    nWorkerIdx = nFlushedOn = 0;
+    for(i=0; i<n; i++){
+        nWorkerIdx += ctx.threadIndex[i] > 0 ? 1 : 0;
+        nFlushedOn += ctx.flushed[i];
+    }
+
+    /* guard disabled: no index should be flushed, which also shows that the
+     * workers restored their modes after the previous loop */
+    saf_denormals_setGuardEnabled(0);
+    saf_parfor_run(hPar, benchmark_denormalsBody, (void*)&ctx, n);
+    nFlushedOff = 0;
+    for(i=0; i<n; i++)
+        nFlushedOff += ctx.flushed[i];
+    saf_denormals_setGuardEnabled(wasEnabled);
+
+    sprintf(details, "(%d threads; enabled: %d/%d flushed, disabled: %d/%d)", nThreads, nFlushedOn, n, nFlushedOff, n);
+    saf_parfor_destroy(&hPar);
+    free(ctx.flushed);
+    free(ctx.threadIndex);
+    return benchmark_printCheck(stream, "denormals: flushed in parfor workers",
+                                nThreads>1 && nWorkerIdx>0 && nFlushedOn==n && nFlushedOff==0, details);
+}
+
+/**
+ * Checks the absolute error of utility_svsincosapprox() against the double
+ * precision sin()/cos(), for uniformly distributed arguments up to the
+ * documented range (|a| < 1e5)
+ */
+static int benchmark_checkSinCos
+(
+    FILE* stream
+)
+{
+    int i, r, nFailed;
+    float *a, *s, *c;
+    double err, maxErr;
+    char name[64], details[128];
+    const float ranges[3] = { 10.0f, 1e4f, 1e5f };
+
+    a = malloc1d(BENCHMARK_CHECK_SINCOS_LEN*sizeof(float));
+    s = malloc1d(BENCHMARK_CHECK_SINCOS_LEN*sizeof(float));
+    c = malloc1d(BENCHMARK_CHECK_SINCOS_LEN*sizeof(float));
+    nFailed = 0;
+    srand(1);
+    for(r=0; r<3; r++){
+        for(i=0; i<BENCHMARK_CHECK_SINCOS_LEN; i++)
+            a[i] = ranges[r]*(2.0f*((float)rand()/(float)RAND_MAX) - 1.0f);
+        utility_svsincosapprox(a, BENCHMARK_CHECK_SINCOS_LEN, s, c);
+        maxErr = 0.0;
+        for(i=0; i<BENCHMARK_CHECK_SINCOS_LEN; i++){
+            err = MAX(fabs((double)s[i] - sin((double)a[i])), fabs((double)c[i] - cos((double)a[i])));
+            maxErr = MAX(maxErr, err);
+        }
+        sprintf(name, "veclib: svsincosapprox, |a| < %g", ranges[r]);
+        sprintf(details, "(max error %.2e, tolerance %.2e)", maxErr, BENCHMARK_CHECK_SINCOS_TOL);
+        nFailed += benchmark_printCheck(stream, name, maxErr <= BENCHMARK_CHECK_SINCOS_TOL, details);
+    }
+    free(a);
+    free(s);
+    free(c);
+    return nFailed;
+}
+
+/** Frame processor, which passes the input frame through unchanged */
+static void benchmark_fifoIdentity
+(
+    void* const hProc,
+    float** const inFrame,
+    float** const outFrame,
+    int nInputs,
+    int nOutputs
+)
+{
+    int ch;
+
+    (void)hProc;
+    for(ch=0; ch<MIN(nInputs, nOutputs); ch++)
+        memcpy(outFrame[ch], inFrame[ch], BENCHMARK_CHECK_FIFO_FRAME_SIZE*sizeof(float));
+}
+
+/**
+ * Passes a ramp through the FIFO (in-place), in blocks of 'blockSize1' samples
+ * up to 'switchPos' and of 'blockSize2' samples after that; and returns the
+ * number of output samples from 'checkFrom' onwards which differ from the ramp
+ * delayed by the latency that is then reported
+ */
+static int benchmark_fifoMismatches
+(
+    void* const hFIFO,
+    int blockSize1,
+    int blockSize2,
+    int switchPos,
+    int checkFrom,
+    int* latency
+)
+{
+    float buf[BENCHMARK_CHECK_FIFO_LEN];
+    float* ptr;
+    int s, len, nMismatches;
+
+    for(s=0; s<BENCHMARK_CHECK_FIFO_LEN; s++)
+        buf[s] = (float)(s+1);
+    for(s=0; s<BENCHMARK_CHECK_FIFO_LEN; s+=len){
+        len = MIN(s<switchPos ? blockSize1 : blockSize2, BENCHMARK_CHECK_FIFO_LEN-s);
+        ptr = &(buf[s]);
+        saf_fifo_process(hFIFO, &ptr, &ptr, 1, 1, len, &benchmark_fifoIdentity, NULL);
+    }
+    *latency = saf_fifo_getLatency(hFIFO);
+    nMismatches = 0;
+    for(s=checkFrom; s<BENCHMARK_CHECK_FIFO_LEN; s++)
+        nMismatches += buf[s] != (s >= *latency ? (float)(s+1-*latency) : 0.0f);
+    return nMismatches;
+}
+
+/**
+ * Checks that saf_fifo adds no latency when the host block size is a multiple
+ * of the frame size, one frame otherwise, and that it reports whichever
+ * applies; including after switching from the former to the latter mid-stream
+ */
+static int benchmark_checkFIFO
+(
+    FILE* stream
+)
+{
+    void* hFIFO;
+    int nFailed, nMismatches, latency;
+    char details[128];
+    const int frameSize = BENCHMARK_CHECK_FIFO_FRAME_SIZE;
+
+    saf_fifo_create(&hFIFO, frameSize, 1, 1);
+    nFailed = 0;
+
+    nMismatches = benchmark_fifoMismatches(hFIFO, 2*frameSize, 2*frameSize, 0, 0, &latency);
+    sprintf(details, "(latency %d, %d mismatched samples)", latency, nMismatches);
+    nFailed += benchmark_printCheck(stream, "fifo: pass-through, block = 2x frame", latency==0 && nMismatches==0, details);
+
+    saf_fifo_setHostBlockSize(hFIFO, 3*frameSize/4);
+    nMismatches = benchmark_fifoMismatches(hFIFO, 3*frameSize/4, 3*frameSize/4, 0, 0, &latency);
+    sprintf(details, "(latency %d, %d mismatched samples)", latency, nMismatches);
+    nFailed += benchmark_printCheck(stream, "fifo: buffered, block = 3/4 frame", latency==frameSize && nMismatches==0, details);
+
+    /* (one frame of silence is inserted at the switch) */
+    saf_fifo_setHostBlockSize(hFIFO, SAF_FIFO_BLOCKSIZE_AUTO);
+    nMismatches = benchmark_fifoMismatches(hFIFO, 2*frameSize, 3*frameSize/4, 8*frameSize, 9*frameSize, &latency);
+    sprintf(details, "(latency %d, %d mismatched samples)", latency, nMismatches);
+    nFailed += benchmark_printCheck(stream, "fifo: pass-through, then buffered", latency==frameSize && nMismatches==0, details);
+
+    saf_fifo_destroy(&hFIFO);
+    return nFailed;
+}
+
+int benchmark_runChecks
+(
+    FILE* stream
+)
+{
+    int nFailed;
+
+    nFailed = 0;
+    nFailed += benchmark_checkDenormals(stream);
+    nFailed += benchmark_checkSinCos(stream);
+    nFailed += benchmark_checkFIFO(stream);
+    fprintf(stream, "%d check(s) failed\n", nFailed);
+    return nFailed;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_dirass.c
+ * @brief Benchmark configurations of the dirass example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../dirass/include/dirass.h"
+
+static const int dirass_orders[4] = {1, 3, 5, 7};
+
+/* the reference mode, followed by the reduced quality levels */
+static const char* const dirass_modeNames[DIRASS_QUALITY_MAX_LEVEL+1] = {"reference", "quality level 1", "quality level 2", "quality level 3"};
+
+static void benchmark_dirass_createMode
+(
+    void** const phProc,
+    int configIdx,
+    int modeIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = dirass_orders[configIdx];
+
+    dirass_create(phProc);
+    dirass_setInputOrder(*phProc, order);
+    dirass_setQualityLevel(*phProc, modeIdx);
+    dirass_init(*phProc, (float)samplerate);
+    dirass_initCodec(*phProc);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = 0;
+    sprintf(description, "order=%d", order);
+    strcpy(modeDescription, dirass_modeNames[modeIdx]);
+}
+
+static void benchmark_dirass_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    benchmark_dirass_createMode(phProc, configIdx, 0, samplerate, blockSize, description, modeDescription, nInputs, nOutputs);
+}
+
+/* (analysis only; the outputs are not used) */
+static void benchmark_dirass_process
+(
+    void* const hProc,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples
+)
+{
+    dirass_analysis(hProc, inputs, nInputs, nSamples, 1);
+}
+
+/* (the peak of the activity-map) */
+static int benchmark_dirass_getDoA
+(
+    void* const hProc,
+    float doa_deg[2]
+)
+{
+    int i, nDirs, pmapWidth, hfov, peakIdx;
+    float aspectRatio;
+    float *grid_dirs, *pmap;
+
+    if(!dirass_getPmap(hProc, &grid_dirs, &pmap, &nDirs, &pmapWidth, &hfov, &aspectRatio) || nDirs<1)
+        return 0;
+    peakIdx = 0;
+    for(i=1; i<nDirs; i++)
+        if(pmap[i]>pmap[peakIdx])
+            peakIdx = i;
+    doa_deg[0] = grid_dirs[peakIdx*2];
+    doa_deg[1] = grid_dirs[peakIdx*2+1];
+    return 1;
+}
+
+const benchmark_processor benchmark_dirass = {
+    "dirass", 4, benchmark_dirass_create, benchmark_dirass_process, dirass_destroy,
+    DIRASS_QUALITY_MAX_LEVEL+1, benchmark_dirass_createMode, benchmark_dirass_getDoA, BENCHMARK_INPUT_SH_SOURCE, 0 };
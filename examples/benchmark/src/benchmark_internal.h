@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_internal.h
+ * @brief An end-to-end, real-time budget benchmark of the example processors
+ *
+ * Each example is wrapped by a benchmark_processor (one per source file, since
+ * the example headers cannot all be included in the same translation unit).
+ * Examples that offer approximate (faster) modes also describe these, for the
+ * accuracy-vs-speed comparison of benchmark_accuracy.c.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef __BENCHMARK_INTERNAL_H_INCLUDED__
+#define __BENCHMARK_INTERNAL_H_INCLUDED__
+
+#include <stdio.h>
+#include <string.h>
+#include "benchmark.h"
+#include "saf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ========================================================================== */
+/*                            Internal Parameters                             */
+/* ========================================================================== */
+
+#define BENCHMARK_MAX_DESCRIPTION_LENGTH ( 64 ) /* characters, including '\0' */
+#define BENCHMARK_WARMUP_TIME_S ( 1.0f )        /* audio not included in the statistics */
+#define BENCHMARK_NOISE_LENGTH_S ( 1.0f )       /* noise is generated once, and then looped */
+#define BENCHMARK_SOURCE_AZI_DEG ( 30.0f )      /* direction of the source of BENCHMARK_INPUT_SH_SOURCE */
+#define BENCHMARK_SOURCE_ELEV_DEG ( 15.0f )     /* direction of the source of BENCHMARK_INPUT_SH_SOURCE */
+#define BENCHMARK_DIFFUSE_GAIN ( 0.1f )         /* gain of the uncorrelated noise of BENCHMARK_INPUT_SH_SOURCE */
+#define BENCHMARK_SPECTRUM_NFFT ( 1024 )        /* FFT size of the long-term spectra */
+#define BENCHMARK_SPECTRUM_MIN_FREQ ( 50.0f )   /* lowest frequency of the spectral metrics, Hz */
+#define BENCHMARK_SPECTRUM_MAX_FREQ ( 16e3f )   /* highest frequency of the spectral metrics, Hz */
+#define BENCHMARK_MAX_ITD_S ( 0.001f )          /* range of lags searched for the ITD */
+#define BENCHMARK_NUM_SLOWEST_BLOCKS ( 5 )      /* number of slowest blocks listed by the automation replay */
+
+
+/* ========================================================================== */
+/*                                   Enums                                    */
+/* ========================================================================== */
+
+/**
+ * Test signals fed to the processors by the accuracy comparison
+ */
+typedef enum _BENCHMARK_INPUT_TYPES {
+    BENCHMARK_INPUT_NOISE = 0,    /**< Uncorrelated white noise (default) */
+    BENCHMARK_INPUT_SH_SOURCE     /**< A white noise source at
+                                   *   BENCHMARK_SOURCE_AZI_DEG/ELEV_DEG,
+                                   *   encoded into SH signals (ACN/SN3D), plus
+                                   *   uncorrelated noise in each channel */
+
+}BENCHMARK_INPUT_TYPES;
+
+
+/* ========================================================================== */
+/*                                 Structures                                 */
+/* ========================================================================== */
+
+/**
+ * Creates and initialises an instance of a processor, in one of its
+ * configurations; returning the number of input/output channels, and a short
+ * description of the configuration (e.g. "order=3, 24 loudspeakers")
+ */
+typedef void (*benchmark_createFunc)(void** const phProc,
+                                     int configIdx,
+                                     int samplerate,
+                                     int blockSize,
+                                     char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+                                     int* nInputs,
+                                     int* nOutputs);
+
+/**
+ * Processes one block of audio (same signature as the *_process() functions)
+ */
+typedef void (*benchmark_processFunc)(void* const hProc,
+                                      float** const inputs,
+                                      float** const outputs,
+                                      int nInputs,
+                                      int nOutputs,
+                                      int nSamples);
+
+/**
+ * Destroys an instance of a processor
+ */
+typedef void (*benchmark_destroyFunc)(void** const phProc);
+
+/**
+ * Creates and initialises an instance of a processor, in one of its
+ * configurations, and in one of its modes (0: the reference mode, i.e. the
+ * same as benchmark_createFunc; >0: the approximate modes); also returning a
+ * short description of the mode (e.g. "HRTFs in float16")
+ */
+typedef void (*benchmark_createModeFunc)(void** const phProc,
+                                         int configIdx,
+                                         int modeIdx,
+                                         int samplerate,
+                                         int blockSize,
+                                         char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+                                         char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+                                         int* nInputs,
+                                         int* nOutputs);
+
+/**
+ * Returns 1 and the estimated direction-of-arrival of the dominant source, in
+ * DEGREES [azi elev], if a new estimate has been made since the last call;
+ * 0 otherwise
+ */
+typedef int (*benchmark_getDoAFunc)(void* const hProc,
+                                    float doa_deg[2]);
+
+/**
+ * Applies one automation event (see BENCHMARK_AUTOMATION_PARAMS; others are
+ * ignored), and carries out any re-initialisation that it requires
+ */
+typedef void (*benchmark_setParamFunc)(void* const hProc,
+                                       int param,
+                                       const float* values,
+                                       int nValues);
+
+/**
+ * Describes one example processor
+ */
+typedef struct _benchmark_processor {
+    const char* name;              /**< name of the example */
+    int nConfigs;                  /**< number of configurations (smallest first) */
+    benchmark_createFunc create;   /**< see benchmark_createFunc */
+    benchmark_processFunc process; /**< see benchmark_processFunc */
+    benchmark_destroyFunc destroy; /**< see benchmark_destroyFunc */
+    int nModes;                    /**< number of modes, including the
+                                    *   reference; 0: not compared */
+    benchmark_createModeFunc createMode; /**< see benchmark_createModeFunc */
+    benchmark_getDoAFunc getDoA;   /**< see benchmark_getDoAFunc (NULL: no
+                                    *   direction-of-arrival estimates) */
+    int inputType;                 /**< see BENCHMARK_INPUT_TYPES */
+    int binauralFLAG;              /**< '1' the outputs are binaural (also
+                                    *   compares their ILDs and ITDs) */
+    benchmark_setParamFunc setParam; /**< see benchmark_setParamFunc (NULL:
+                                      *   automation is not supported) */
+
+}benchmark_processor;
+
+
+/* ========================================================================== */
+/*                               Processors                                   */
+/* ========================================================================== */
+
+extern const benchmark_processor benchmark_ambi_bin;
+extern const benchmark_processor benchmark_ambi_dec;
+extern const benchmark_processor benchmark_ambi_drc;
+extern const benchmark_processor benchmark_ambi_enc;
+extern const benchmark_processor benchmark_array2sh;
+extern const benchmark_processor benchmark_beamformer;
+extern const benchmark_processor benchmark_binauraliser;
+extern const benchmark_processor benchmark_dirass;
+extern const benchmark_processor benchmark_matrixconv;
+extern const benchmark_processor benchmark_multiconv;
+extern const benchmark_processor benchmark_panner;
+extern const benchmark_processor benchmark_powermap;
+extern const benchmark_processor benchmark_rotator;
+extern const benchmark_processor benchmark_sldoa;
+extern const benchmark_processor benchmark_upmix;
+
+/**
+ * Returns one of the processors; procIdx: 0..benchmark_getNumProcessors()-1
+ */
+const benchmark_processor* benchmark_getProcessor(int procIdx);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BENCHMARK_INTERNAL_H_INCLUDED__ */
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_matrixconv.c
+ * @brief Benchmark configurations of the matrixconv example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../matrixconv/include/matrixconv.h"
+
+static const int matrixconv_configs[3][3] = {{4, 2, 1024}, {16, 2, 4096}, {64, 2, 4096}}; /* nInputs, nOutputs, filter length */
+
+static void benchmark_matrixconv_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int i, nCHin, nCHout, filterLength;
+    float** H;
+
+    nCHin = matrixconv_configs[configIdx][0];
+    nCHout = matrixconv_configs[configIdx][1];
+    filterLength = matrixconv_configs[configIdx][2];
+
+    /* random filters; loaded as: nCHout x (nCHin x filterLength) */
+    H = (float**)malloc2d(nCHout, nCHin*filterLength, sizeof(float));
+    for(i=0; i<nCHout*nCHin*filterLength; i++)
+        H[0][i] = 0.01f*(((float)rand()/(float)RAND_MAX) - 0.5f);
+    matrixconv_create(phProc);
+    matrixconv_setEnablePart(*phProc, 1);
+    matrixconv_setNumInputChannels(*phProc, nCHin);
+    matrixconv_setFilters(*phProc, (const float**)H, nCHout, nCHin*filterLength, samplerate);
+    matrixconv_init(*phProc, samplerate, blockSize);
+    free(H);
+    (*nInputs) = nCHin;
+    (*nOutputs) = nCHout;
+    sprintf(description, "%dx%d, filter length=%d", nCHin, nCHout, filterLength);
+}
+
+const benchmark_processor benchmark_matrixconv = {
+    "matrixconv", 3, benchmark_matrixconv_create, matrixconv_process, matrixconv_destroy };
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_multiconv.c
+ * @brief Benchmark configurations of the multiconv example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../multiconv/include/multiconv.h"
+
+static const int multiconv_configs[3][2] = {{2, 4096}, {16, 4096}, {64, 4096}}; /* nChannels, filter length */
+
+static void benchmark_multiconv_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int i, nCH, filterLength;
+    float** H;
+
+    nCH = multiconv_configs[configIdx][0];
+    filterLength = multiconv_configs[configIdx][1];
+
+    /* random filters; nCH x filterLength */
+    H = (float**)malloc2d(nCH, filterLength, sizeof(float));
+    for(i=0; i<nCH*filterLength; i++)
+        H[0][i] = 0.01f*(((float)rand()/(float)RAND_MAX) - 0.5f);
+    multiconv_create(phProc);
+    multiconv_setEnablePart(*phProc, 1);
+    multiconv_setNumChannels(*phProc, nCH);
+    multiconv_setFilters(*phProc, (const float**)H, nCH, filterLength, samplerate);
+    multiconv_init(*phProc, samplerate, blockSize);
+    free(H);
+    (*nInputs) = (*nOutputs) = nCH;
+    sprintf(description, "%d channels, filter length=%d", nCH, filterLength);
+}
+
+const benchmark_processor benchmark_multiconv = {
+    "multiconv", 3, benchmark_multiconv_create, multiconv_process, multiconv_destroy };
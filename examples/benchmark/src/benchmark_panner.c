@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_panner.c
+ * @brief Benchmark configurations of the panner example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../panner/include/panner.h"
+
+static const int panner_nSources[4] = {4, 16, 32, 64};
+
+static void benchmark_panner_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int nSources = MIN(panner_nSources[configIdx], panner_getMaxNumSources());
+
+    panner_create(phProc);
+    panner_setNumSources(*phProc, nSources);
+    panner_init(*phProc, samplerate);
+    panner_initCodec(*phProc);
+    (*nInputs) = nSources;
+    (*nOutputs) = panner_getNumLoudspeakers(*phProc);
+    sprintf(description, "%d sources, %d loudspeakers", nSources, *nOutputs);
+}
+
+static void benchmark_panner_setParam
+(
+    void* const hProc,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    switch(param){
+        case BENCHMARK_PARAM_SOURCE_DIR:
+            if(nValues<3) break;
+            panner_setSourceAzi_deg(hProc, (int)values[0], values[1]);
+            panner_setSourceElev_deg(hProc, (int)values[0], values[2]);
+            break;
+        case BENCHMARK_PARAM_NUM_SOURCES:    if(nValues>0) panner_setNumSources(hProc, (int)values[0]); break;
+        case BENCHMARK_PARAM_YAW_PITCH_ROLL:
+            if(nValues<3) break;
+            panner_setYaw(hProc, values[0]);
+            panner_setPitch(hProc, values[1]);
+            panner_setRoll(hProc, values[2]);
+            break;
+        case BENCHMARK_PARAM_INPUT_PRESET:   if(nValues>0) panner_setInputConfigPreset(hProc, (int)values[0]); break;
+        case BENCHMARK_PARAM_OUTPUT_PRESET:  if(nValues>0) panner_setOutputConfigPreset(hProc, (int)values[0]); break;
+    }
+    panner_initCodec(hProc); /* (returns straight away, if it is not required) */
+}
+
+const benchmark_processor benchmark_panner = {
+    "panner", 4, benchmark_panner_create, panner_process, panner_destroy,
+    0, NULL, NULL, BENCHMARK_INPUT_NOISE, 0, benchmark_panner_setParam };
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_powermap.c
+ * @brief Benchmark configurations of the powermap example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../powermap/include/powermap.h"
+
+static const int powermap_orders[4] = {1, 3, 5, 7};
+
+/* the reference mode, followed by the reduced quality levels */
+static const char* const powermap_modeNames[POWERMAP_QUALITY_MAX_LEVEL+1] = {"reference", "quality level 1", "quality level 2", "quality level 3"};
+
+static void benchmark_powermap_createMode
+(
+    void** const phProc,
+    int configIdx,
+    int modeIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = powermap_orders[configIdx];
+
+    powermap_create(phProc);
+    powermap_setMasterOrder(*phProc, order);
+    powermap_setAnaOrderAllBands(*phProc, order);
+    powermap_setQualityLevel(*phProc, modeIdx);
+    powermap_init(*phProc, (float)samplerate);
+    powermap_initCodec(*phProc);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = 0;
+    sprintf(description, "order=%d", order);
+    strcpy(modeDescription, powermap_modeNames[modeIdx]);
+}
+
+static void benchmark_powermap_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    char modeDescription[BENCHMARK_MAX_DESCRIPTION_LENGTH];
+    benchmark_powermap_createMode(phProc, configIdx, 0, samplerate, blockSize, description, modeDescription, nInputs, nOutputs);
+}
+
+/* (analysis only; the outputs are not used) */
+static void benchmark_powermap_process
+(
+    void* const hProc,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples
+)
+{
+    powermap_analysis(hProc, inputs, nInputs, nSamples, 1);
+}
+
+/* (the peak of the activity-map) */
+static int benchmark_powermap_getDoA
+(
+    void* const hProc,
+    float doa_deg[2]
+)
+{
+    int i, nDirs, pmapWidth, hfov, peakIdx;
+    int aspectRatio;
+    float *grid_dirs, *pmap;
+
+    if(!powermap_getPmap(hProc, &grid_dirs, &pmap, &nDirs, &pmapWidth, &hfov, &aspectRatio) || nDirs<1)
+        return 0;
+    peakIdx = 0;
+    for(i=1; i<nDirs; i++)
+        if(pmap[i]>pmap[peakIdx])
+            peakIdx = i;
+    doa_deg[0] = grid_dirs[peakIdx*2];
+    doa_deg[1] = grid_dirs[peakIdx*2+1];
+    return 1;
+}
+
+const benchmark_processor benchmark_powermap = {
+    "powermap", 4, benchmark_powermap_create, benchmark_powermap_process, powermap_destroy,
+    POWERMAP_QUALITY_MAX_LEVEL+1, benchmark_powermap_createMode, benchmark_powermap_getDoA, BENCHMARK_INPUT_SH_SOURCE, 0 };
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_rotator.c
+ * @brief Benchmark configurations of the rotator example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../rotator/include/rotator.h"
+
+static const int rotator_orders[4] = {1, 3, 5, 7};
+
+static void benchmark_rotator_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = rotator_orders[configIdx];
+
+    rotator_create(phProc);
+    rotator_setOrder(*phProc, order);
+    rotator_init(*phProc, samplerate);
+    (*nInputs) = (*nOutputs) = ORDER2NSH(order);
+    sprintf(description, "order=%d", order);
+}
+
+static void benchmark_rotator_setParam
+(
+    void* const hProc,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    if(param==BENCHMARK_PARAM_YAW_PITCH_ROLL && nValues>=3){
+        rotator_setYaw(hProc, values[0]);
+        rotator_setPitch(hProc, values[1]);
+        rotator_setRoll(hProc, values[2]);
+    }
+}
+
+const benchmark_processor benchmark_rotator = {
+    "rotator", 4, benchmark_rotator_create, rotator_process, rotator_destroy,
+    0, NULL, NULL, BENCHMARK_INPUT_NOISE, 0, benchmark_rotator_setParam };
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file benchmark_sldoa.c
+ * @brief Benchmark configurations of the sldoa example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "benchmark_internal.h"
+#include "../../sldoa/include/sldoa.h"
+
+static const int sldoa_orders[4] = {1, 3, 5, 7};
+
+static void benchmark_sldoa_create
+(
+    void** const phProc,
+    int configIdx,
+    int samplerate,
+    int blockSize,
+    char description[BENCHMARK_MAX_DESCRIPTION_LENGTH],
+    int* nInputs,
+    int* nOutputs
+)
+{
+    int order = sldoa_orders[configIdx];
+
+    sldoa_create(phProc);
+    sldoa_setMasterOrder(*phProc, order);
+    sldoa_setAnaOrderAllBands(*phProc, order);
+    sldoa_init(*phProc, (float)samplerate);
+    sldoa_initCodec(*phProc);
+    (*nInputs) = ORDER2NSH(order);
+    (*nOutputs) = 0;
+    sprintf(description, "order=%d", order);
+}
+
+/* (analysis only; the outputs are not used) */
+static void benchmark_sldoa_process
+(
+    void* const hProc,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples
+)
+{
+    sldoa_analysis(hProc, inputs, nInputs, nSamples, 1);
+}
+
+const benchmark_processor benchmark_sldoa = {
+    "sldoa", 4, benchmark_sldoa_create, benchmark_sldoa_process, sldoa_destroy };
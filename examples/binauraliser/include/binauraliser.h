@@ -32,6 +32,8 @@
 #ifndef __BINAURALISER_H_INCLUDED__
 #define __BINAURALISER_H_INCLUDED__
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -72,8 +74,20 @@ typedef enum _BINAURALISER_SOURCE_CONFIG_PRESETS{
 }BINAURALISER_SOURCE_CONFIG_PRESETS;
 
 typedef enum _INTERP_MODES{
-    INTERP_TRI = 1  /* Triangular interpolation */
+    INTERP_TRI = 1, /* Triangular interpolation */
+    INTERP_SH       /* Spherical harmonic interpolation */
 }INTERP_MODES;
+
+/**
+ * Available storage formats for the HRTF magnitudes and the interpolation
+ * table (the values match SAF_STORAGE_PRECISION)
+ */
+typedef enum _BINAURALISER_HRTF_PRECISION{
+    HRTF_PRECISION_FLOAT32 = 1, /**< Single-precision (default) */
+    HRTF_PRECISION_FLOAT16,     /**< IEEE 754 half-precision */
+    HRTF_PRECISION_BFLOAT16     /**< bfloat16 */
+
+}BINAURALISER_HRTF_PRECISION;
     
 /**
  * Current status of the codec.
@@ -90,6 +104,10 @@ typedef enum _BINAURALISER_CODEC_STATUS{
 }BINAURALISER_CODEC_STATUS;
 
 #define BINAURALISER_MAX_NUM_INPUTS ( 64 )
+#define BINAURALISER_LOD_MAX_ORDER ( 3 ) /**< maximum order of the spherical harmonic bed (see binauraliser_setEnableLOD()) */
+#define BINAURALISER_QUALITY_MAX_LEVEL ( 3 ) /**< see binauraliser_setQualityLevel() */
+#define BINAURALISER_NEAR_FIELD_REF_DIST_M ( 1.5f ) /**< distance of the HRTF measurements assumed by the near-field compensation, in metres */
+#define BINAURALISER_NEAR_FIELD_MIN_DIST_M ( 0.15f ) /**< closest source distance of the near-field compensation, in metres */
 #define BINAURALISER_PROGRESSBARTEXT_CHAR_LENGTH 256
 
 
@@ -104,6 +122,25 @@ typedef enum _BINAURALISER_CODEC_STATUS{
  */
 void binauraliser_create(void** const phBin);
 
+/**
+ * Creates an instance of the binauraliser, which processes frames of
+ * 'frameSize' samples rather than FRAME_SIZE
+ *
+ * Smaller frames reduce the latency (e.g. for head-tracked monitoring), while
+ * larger frames amortise the per-frame overhead (e.g. for offline rendering).
+ * The frame size is fixed for the lifetime of the instance.
+ *
+ * @note The hop size of the filterbank remains HOP_SIZE, since the HRTF
+ *       filterbank coefficients and band centre frequencies are derived for
+ *       that hop size.
+ *
+ * @param[in] phBin     (&) address of binauraliser handle
+ * @param[in] frameSize Processing frame size, in samples; rounded down to a
+ *                      multiple of HOP_SIZE (minimum: HOP_SIZE)
+ */
+void binauraliser_createWithFrameSize(void** const phBin,
+                                      int frameSize);
+
 /**
  * Destroys an instance of the binauraliser
  *
@@ -111,6 +148,26 @@ void binauraliser_create(void** const phBin);
  */
 void binauraliser_destroy(void** const phBin);
 
+/**
+ * Creates a new instance of the binauraliser, with the same configuration as
+ * an existing one
+ *
+ * If the existing instance is initialised, then the clone is returned
+ * initialised also: the (read-only) HRIR data and filterbank HRTFs are shared
+ * with it, and its interpolation table is copied rather than rebuilt. Only the
+ * afSTFT and the audio buffers are set up anew. This is considerably faster
+ * than creating and initialising each instance separately; e.g. when spinning
+ * up one instance per listener.
+ *
+ * @note The existing instance must not be processing audio or be
+ *       (re)initialised while it is being cloned.
+ *
+ * @param[in] hBin    binauraliser handle of the instance to clone
+ * @param[in] phClone (&) address of the new binauraliser handle
+ */
+void binauraliser_clone(void* const hBin,
+                        void** const phClone);
+
 /**
  * Initialises an instance of binauraliser with default settings
  *
@@ -127,9 +184,37 @@ void binauraliser_init(void* const hBin,
  */
 void binauraliser_initCodec(void* const hBin);
 
+/**
+ * Prepares the instance for playback, from the calling (non-real-time) thread;
+ * i.e. initialises the codec (if needed), and runs binauraliser_process() over a
+ * few blocks of silence, such that the first audio callback does not incur
+ * the cost of touching the buffers and tables for the first time. The block
+ * size is also passed to the internal FIFO, which selects whether it adds any
+ * latency (see binauraliser_getProcessingDelay())
+ *
+ * @note Call after binauraliser_init(), and before the first call to
+ *       binauraliser_process() (e.g. in the host's prepare-to-play callback); see
+ *       saf_warmUp.h
+ *
+ * @param[in] hBin      binauraliser handle
+ * @param[in] nInputs   Number of input channels (as passed by the host)
+ * @param[in] nOutputs  Number of output channels (as passed by the host)
+ * @param[in] blockSize Number of samples per block (as passed by the host)
+ */
+void binauraliser_prepareToPlay(void* const hBin,
+                                int nInputs,
+                                int nOutputs,
+                                int blockSize);
+
 /**
  * Binauralises the input signals at the user specified directions
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples (or the size given to
+ *       binauraliser_createWithFrameSize()). Unless the block size is a multiple
+ *       of the frame size, this adds one frame of latency, which is included
+ *       in binauraliser_getProcessingDelay()
+ *
  * @param[in] hBin      binauraliser handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs   Output channel buffers; 2-D array: nOutputs x nSamples
@@ -144,6 +229,55 @@ void binauraliser_process(void* const hBin,
                           int nOutputs,
                           int nSamples);
 
+/**
+ * Same as binauraliser_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hBin     binauraliser handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void binauraliser_processInterleaved(void* const hBin,
+                                     const float* inputs,
+                                     float* outputs,
+                                     int nInputs,
+                                     int nOutputs,
+                                     int nSamples);
+
+/**
+ * Binauralises a whole recording, using several threads (intended for batch
+ * rendering, rather than real-time use)
+ *
+ * The signals are split into one segment per thread, each of which is rendered
+ * by its own instance with the current configuration (and frame size) of
+ * 'hBin'. Each segment is preceded by a few frames of the previous one, so
+ * that the filterbank state is warmed up, and the output matches that of
+ * binauraliser_process() to within numerical precision. Unlike
+ * binauraliser_process(), the output is aligned with the input; i.e. the
+ * processing delay is compensated for.
+ *
+ * @note binauraliser_init() must have been called on 'hBin' (for the sampling
+ *       rate), but 'hBin' itself is not used for the processing, so it may be
+ *       used concurrently for real-time processing.
+ *
+ * @param[in]  hBin     binauraliser handle
+ * @param[in]  inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[out] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nOutputs Number of output channels
+ * @param[in]  nSamples Number of samples per channel
+ * @param[in]  nThreads Number of threads ('0': one per CPU core)
+ */
+void binauraliser_renderOffline(void* const hBin,
+                                const float* const* inputs,
+                                float* const* outputs,
+                                int nInputs,
+                                int nOutputs,
+                                int nSamples,
+                                int nThreads);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -169,6 +303,29 @@ void binauraliser_setSourceElev_deg(void* const hBin,
                                     int index,
                                     float newElev_deg);
 
+/**
+ * Sets the distance for a specific channel index, in METRES (only used when
+ * the near-field compensation is enabled; see
+ * binauraliser_setEnableNearField())
+ */
+void binauraliser_setSourceDist_m(void* const hBin,
+                                  int index,
+                                  float newDist_m);
+
+/**
+ * Sets the flag to enable/disable (1 or 0) the near-field compensation of
+ * sources closer than BINAURALISER_NEAR_FIELD_REF_DIST_M (default: 0)
+ *
+ * The HRTFs of such sources are filtered by the (cached) response of a rigid
+ * sphere model of the head, which boosts the ipsilateral ear and shadows the
+ * contralateral ear as a source approaches the head. The distance attenuation
+ * is left to the host.
+ *
+ * @note In the level-of-detail mode, the sources mixed into the SH bed are not
+ *       compensated.
+ */
+void binauraliser_setEnableNearField(void* const hBin, int newState);
+
 /**
  * Sets the number of input channels/sources to binauralise.
  */
@@ -222,6 +379,37 @@ void binauraliser_setPitch(void* const hBin, float newPitch);
  */
 void binauraliser_setRoll(void* const hBin, float newRoll);
 
+/**
+ * Sets the orientation as a quaternion (e.g. as received from a head-tracker),
+ * in place of the 'yaw', 'pitch' and 'roll' angles
+ *
+ * The processing loop estimates the angular velocity from consecutive
+ * quaternions, and extrapolates the latest one to the middle of the frame
+ * being processed (plus the time set with binauraliser_setPredictionTime());
+ * which compensates for the latency of the tracker and of the processing. The
+ * quaternion is converted into the yaw-pitch-roll rotation order, and the
+ * "flip" flags are applied to the resulting angles. Setting an angle returns
+ * to using the angles, until the next quaternion is set.
+ *
+ * @param[in] hBin        binauraliser handle
+ * @param[in] quat        Quaternion [w x y z]; the rotation from looking
+ *                        towards +x (with +z up) to the current orientation
+ * @param[in] timestamp_s Time at which the tracker measured the orientation,
+ *                        in seconds, of the monotonic clock of SAF (i.e.
+ *                        saf_benchmark_getTime()), or a negative value to use
+ *                        the time of this call
+ */
+void binauraliser_setQuaternion(void* const hBin,
+                                const float quat[4],
+                                double timestamp_s);
+
+/**
+ * Sets the additional time, in milliseconds, that the orientations given by
+ * binauraliser_setQuaternion() are predicted ahead (e.g. the output latency of
+ * the audio device); 0..100
+ */
+void binauraliser_setPredictionTime(void* const hBin, float newTime_ms);
+
 /**
  * Sets a flag as to whether to "flip" the sign of the current 'yaw' angle
  * (0: do not flip sign, 1: flip the sign)
@@ -246,9 +434,99 @@ void binauraliser_setFlipRoll(void* const hBin, int newState);
  */
 void binauraliser_setRPYflag(void* const hBin, int newState);
 
-/** NOT IMPLEMENTED YET */
+/**
+ * Sets the HRTF interpolation mode (see INTERP_MODES enum)
+ *
+ * INTERP_TRI interpolates between the 3 nearest measurements via a (dense)
+ * pre-computed VBAP gain table. INTERP_SH instead fits the HRTF magnitudes and
+ * ITDs of all measurements with a spherical harmonic expansion (once, when the
+ * HRTFs are (re)built), which is then evaluated for any direction; i.e. no
+ * table has to be stored, and the cost per direction does not depend on the
+ * density of the measurement grid. The HRTFs are rebuilt if the mode changes.
+ */
 void binauraliser_setInterpMode(void* const hBin, int newMode);
 
+/**
+ * Sets the storage format of the HRTF magnitudes and the interpolation table
+ * (see #BINAURALISER_HRTF_PRECISION)
+ *
+ * The reduced-precision formats halve the memory and cache footprint of the
+ * HRTF interpolation, with the values being converted back to single-precision
+ * on the fly. The half-precision magnitudes are shared by all instances using
+ * the same HRIR set and format.
+ */
+void binauraliser_setHRTFprecision(void* const hBin, int newPrecision);
+
+/**
+ * Enables/disables the level-of-detail (LOD) rendering mode (0: disabled, 1:
+ * enabled)
+ *
+ * In this mode, only the sources with the highest priority-weighted energy
+ * (see binauraliser_setSourcePriority()) are rendered with their own
+ * interpolated HRTFs; while the remaining sources are encoded (in the
+ * time-domain) into a shared spherical harmonic bed, which is rendered with one
+ * binaural Ambisonic decoder (MagLS). Therefore, the filterbank and the HRTF
+ * mix process nDirect + (order+1)^2 channels, rather than one per source.
+ * Sources moving between the direct path and the bed are crossfaded over one
+ * frame.
+ *
+ * @note The mode is only engaged if it reduces the number of channels; i.e.
+ *       if nDirect + (order+1)^2 < the number of sources.
+ */
+void binauraliser_setEnableLOD(void* const hBin, int newState);
+
+/**
+ * Sets the number of sources which are rendered directly in the LOD mode
+ * (see binauraliser_setEnableLOD())
+ */
+void binauraliser_setLODnumDirect(void* const hBin, int newValue);
+
+/**
+ * Sets the order of the spherical harmonic bed in the LOD mode;
+ * 1..BINAURALISER_LOD_MAX_ORDER (see binauraliser_setEnableLOD())
+ */
+void binauraliser_setLODorder(void* const hBin, int newOrder);
+
+/**
+ * Sets the priority of a source in the LOD mode (default: 1), which weights
+ * its (smoothed) energy when the sources to render directly are chosen. A
+ * priority of 0 keeps a source in the spherical harmonic bed.
+ */
+void binauraliser_setSourcePriority(void* const hBin, int index, float newPriority);
+
+/**
+ * Sets the quality level (0..BINAURALISER_QUALITY_MAX_LEVEL), with which the
+ * rendering cost may be reduced when the CPU is overloaded (see also
+ * saf_qualityControl.h); the user parameters are left untouched
+ *  - 0: full quality
+ *  - 1: the level-of-detail mode is used (see binauraliser_setEnableLOD()),
+ *       regardless of its setting
+ *  - 2: also, only half of binauraliser_getLODnumDirect() sources are
+ *       rendered directly
+ *  - 3: also, only a quarter of them are rendered directly
+ *
+ * @note Any change re-initialises the codec (i.e. binauraliser_initCodec()
+ *       must be called, as after any other configuration change), and the
+ *       first engagement of the LOD mode also computes its bed decoder;
+ *       hence the level should only be changed with some hysteresis.
+ */
+void binauraliser_setQualityLevel(void* const hBin, int newLevel);
+
+/**
+ * Sets the number of sources in the whole scene (default: 0, i.e. the number
+ * of sources of this instance), by which the mix is normalised
+ *
+ * This allows a large scene to be rendered by several instances (e.g. on
+ * different machines), each rendering a subset of its sources, and for their
+ * outputs to be summed (see saf_partialMix.h); which is then the same as
+ * rendering all of the sources with one instance.
+ *
+ * @note In the level-of-detail mode, each instance chooses its direct sources
+ *       among its own subset; hence the summed output is then not identical to
+ *       that of one instance.
+ */
+void binauraliser_setNumSceneSources(void* const hBin, int newValue);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -285,6 +563,17 @@ float binauraliser_getSourceAzi_deg(void* const hBin, int index);
  */
 float binauraliser_getSourceElev_deg(void* const hBin, int index);
 
+/**
+ * Returns the source distance for a given index, in METRES
+ */
+float binauraliser_getSourceDist_m(void* const hBin, int index);
+
+/**
+ * Returns the flag value which dictates whether the near-field compensation is
+ * enabled (1) or disabled (0)
+ */
+int binauraliser_getEnableNearField(void* const hBin);
+
 /**
  * Returns the number of inputs/sources in the current layout
  */
@@ -379,6 +668,12 @@ float binauraliser_getPitch(void* const hBin);
  */
 float binauraliser_getRoll(void* const hBin);
 
+/**
+ * Returns the additional time, in milliseconds, that the orientations given by
+ * binauraliser_setQuaternion() are predicted ahead
+ */
+float binauraliser_getPredictionTime(void* const hBin);
+
 /**
  * Returns a flag as to whether to "flip" the sign of the current 'yaw' angle
  * (0: do not flip sign, 1: flip the sign)
@@ -403,14 +698,82 @@ int binauraliser_getFlipRoll(void* const hBin);
  */
 int binauraliser_getRPYflag(void* const hBin);
 
-/** NOT IMPLEMENTED YET */
+/** Returns the HRTF interpolation mode (see INTERP_MODES enum) */
 int binauraliser_getInterpMode(void* const hBin);
 
+/**
+ * Returns the storage format of the HRTF magnitudes and the interpolation
+ * table (see #BINAURALISER_HRTF_PRECISION)
+ */
+int binauraliser_getHRTFprecision(void* const hBin);
+
+/**
+ * Returns the flag as to whether the level-of-detail mode is enabled (1) or
+ * disabled (0)
+ */
+int binauraliser_getEnableLOD(void* const hBin);
+
+/** Returns the number of sources rendered directly in the LOD mode */
+int binauraliser_getLODnumDirect(void* const hBin);
+
+/** Returns the order of the spherical harmonic bed in the LOD mode */
+int binauraliser_getLODorder(void* const hBin);
+
+/** Returns the priority of a source in the LOD mode */
+float binauraliser_getSourcePriority(void* const hBin, int index);
+
+/**
+ * Returns 1 if the level-of-detail mode is currently engaged (i.e. enabled,
+ * and reducing the number of channels), 0 otherwise
+ */
+int binauraliser_getLODisEngaged(void* const hBin);
+
+/** Returns the current quality level (0: full quality) */
+int binauraliser_getQualityLevel(void* const hBin);
+
+/** Returns the number of sources in the whole scene (0: those of this
+ *  instance), see binauraliser_setNumSceneSources() */
+int binauraliser_getNumSceneSources(void* const hBin);
+
 /**
  * Returns the processing delay in samples (may be used for delay compensation
- * purposes)
+ * purposes), which includes the latency of the internal FIFO, if any (i.e. if
+ * the host block size is not a multiple of the frame size)
+ */
+int binauraliser_getProcessingDelay(void* const hBin);
+
+/** Returns the processing frame size of this instance, in samples */
+int binauraliser_getFrameSize(void* const hBin);
+
+/**
+ * Returns the handle of the profiler, which (when SAF_ENABLE_PROFILING is
+ * defined) times the stages of the processing loop; see saf_profiler_getStats()
+ */
+void* binauraliser_getProfiler(void* const hBin);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* binauraliser_getTelemetry(void* const hBin);
+
+/**
+ * Returns the handle of the report of the last binauraliser_initCodec() call, which
+ * lists the time and memory taken by each of its stages; see
+ * saf_initReport_print()
+ */
+void* binauraliser_getInitReport(void* const hBin);
+
+/**
+ * Returns the number of bytes currently held by this instance for its audio
+ * buffers and tables; which scales with the configured number of
+ * sources (see binauraliser_setNumSources())
+ *
+ * @note Excludes the HRIR data shared between instances (see
+ *       hrtfCache_acquire()), and the internals of the afSTFT and FIFO.
  */
-int binauraliser_getProcessingDelay(void);
+size_t binauraliser_getMemoryUsage(void* const hBin);
 
 
 #ifdef __cplusplus
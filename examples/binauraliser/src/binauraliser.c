@@ -31,31 +31,112 @@
 
 #include "binauraliser_internal.h"
 
+/**
+ * Hands the direction (and distance) of a source over to the processing loop,
+ * which applies it at the start of the next frame
+ */
+static void binauraliser_pushSourceDir
+(
+    binauraliser_data* pData,
+    int ch
+)
+{
+    float values[3];
+
+    values[0] = pData->src_dirs_deg[ch][0];
+    values[1] = pData->src_dirs_deg[ch][1];
+    values[2] = pData->src_dist_m[ch];
+    saf_paramQueue_push(pData->hParamQueue, BINAURALISER_PARAM_SOURCE_DIR(ch), values, 3);
+}
+
+/**
+ * Hands the current orientation over to the processing loop, which applies it
+ * at the start of the next frame
+ */
+static void binauraliser_pushOrientation
+(
+    binauraliser_data* pData
+)
+{
+    float values[4];
+
+    values[0] = pData->yaw;
+    values[1] = pData->pitch;
+    values[2] = pData->roll;
+    values[3] = (float)pData->useRollPitchYawFlag;
+    saf_paramQueue_push(pData->hParamQueue, BINAURALISER_PARAM_ORIENTATION, values, 4);
+}
+
+/**
+ * Predicts the orientation (if it is given as quaternions) at 'lookAhead_s'
+ * seconds from now, plus the user prediction time; and flags the sources for
+ * rotation if it has changed
+ */
+static void binauraliser_predictOrientation
+(
+    binauraliser_data* pData,
+    double lookAhead_s
+)
+{
+    float quat[4], ypr[3];
+    
+    if(!pData->useQuaternion_proc)
+        return;
+    if(!saf_orientationPredictor_predict(pData->hOrientPred, saf_benchmark_getTime() + lookAhead_s +
+                                         (double)pData->predictionTime_ms/1000.0, quat))
+        return;
+    quaternion2yawPitchRoll(quat, &ypr[0], &ypr[1], &ypr[2]);
+    ypr[0] = pData->bFlipYaw == 1 ? -ypr[0] : ypr[0];
+    ypr[1] = pData->bFlipPitch == 1 ? -ypr[1] : ypr[1];
+    ypr[2] = pData->bFlipRoll == 1 ? -ypr[2] : ypr[2];
+    if(memcmp(ypr, pData->ypr_proc, 3*sizeof(float)) != 0 || pData->useRollPitchYawFlag_proc != 0){
+        memcpy(pData->ypr_proc, ypr, 3*sizeof(float));
+        pData->useRollPitchYawFlag_proc = 0;
+        pData->recalc_M_rotFLAG = 1;
+    }
+}
+
 void binauraliser_create
 (
     void ** const phBin
 )
+{
+    binauraliser_createWithFrameSize(phBin, FRAME_SIZE);
+}
+
+void binauraliser_createWithFrameSize
+(
+    void ** const phBin,
+    int frameSize
+)
 {
     binauraliser_data* pData = (binauraliser_data*)malloc1d(sizeof(binauraliser_data));
     *phBin = (void*)pData;
     int ch;
     
-    /* time-frequency transform + buffers */
+    /* time-frequency transform + buffers (the frame size is fixed for the
+     * lifetime of the instance, and rounded down to a multiple of HOP_SIZE) */
+    pData->nTimeSlots = MAX(frameSize/HOP_SIZE, 1);
+    pData->frameSize = pData->nTimeSlots*HOP_SIZE;
+    pData->outputframeTF = (float_complex***)malloc3d(HYBRID_BANDS, NUM_EARS, pData->nTimeSlots, sizeof(float_complex));
+    pData->outputframeTF_prev = (float_complex***)malloc3d(HYBRID_BANDS, NUM_EARS, pData->nTimeSlots, sizeof(float_complex));
     pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_INPUTS * sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_INPUTS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_INPUTS, NUM_EARS), HOP_SIZE, sizeof(float));
-    pData->STFTOutputFrameTF = malloc1d(NUM_EARS*sizeof(complexVector));
-    for(ch=0; ch< NUM_EARS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
+    pData->nSourcesAlloc = 0;
+    pData->inputFrameTD = NULL;
+    pData->inputframeTF = NULL;
+    pData->outputFrameTD = (float**)malloc2d(NUM_EARS, pData->frameSize, sizeof(float));
+    memset(pData->freqVector, 0, HYBRID_BANDS*sizeof(float)); /* (set by binauraliser_init) */
+    pData->nSourcesMix = 0;
+    pData->hrtf_interp = NULL;
+    pData->nCH_STFT = 0;
+    pData->lod_nDirect = pData->lod_nSH = 0;
+    pData->lod_frameTD = NULL;
+    pData->lod_decOrder = 0;
+    pData->lod_decMtx = NULL;
     
     /* hrir data */
     pData->useDefaultHRIRsFLAG=1;
+    pData->hHRTFs = NULL;
     pData->hrirs = NULL;
     pData->hrir_dirs_deg = NULL;
     pData->sofa_filepath = NULL;
@@ -64,10 +145,23 @@ void binauraliser_create
     pData->hrtf_vbap_gtableIdx = NULL;
     pData->hrtf_vbap_gtableComp = NULL;
     
+    /* SH fit (INTERP_SH) */
+    pData->hrtf_interpMode = INTERP_TRI;
+    pData->hrtf_shOrder = 0;
+    pData->hrtf_shCoeffs = NULL;
+    
     /* HRTF filterbank coefficients */
     pData->itds_s = NULL;
     pData->hrtf_fb = NULL;
     pData->hrtf_fb_mag = NULL;
+    pData->hrtf_precision = SAF_STORAGE_FLOAT32;
+    pData->hrtf_mags = NULL;
+    
+    /* interpolated HRTF cache */
+    pData->hrtf_cache = malloc1d(HRTF_CACHE_SIZE*HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+    pData->hrtf_cacheSlot = NULL;
+    pData->N_hrtf_vbap_gtable = 0;
+    binauraliser_resetHRTFcache(*phBin);
     
     /* flags/status */
     pData->progressBar0_1 = 0.0f;
@@ -83,7 +177,9 @@ void binauraliser_create
     /* user parameters */
     binauraliser_loadPreset(SOURCE_CONFIG_PRESET_DEFAULT, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims)); /*check setStateInformation if you change default preset*/
     pData->nSources = pData->new_nSources;
+    binauraliser_resizeBuffers(*phBin, pData->nSources);
     pData->interpMode = INTERP_TRI;
+    pData->hrtfPrecision = HRTF_PRECISION_FLOAT32;
     pData->yaw = 0.0f;
     pData->pitch = 0.0f;
     pData->roll = 0.0f;
@@ -91,7 +187,42 @@ void binauraliser_create
     pData->bFlipPitch = 0;
     pData->bFlipRoll = 0;
     pData->useRollPitchYawFlag = 0;
+    pData->predictionTime_ms = 0.0f;
     pData->enableRotation = 0;
+    pData->enableLOD = 0;
+    pData->qualityLevel = 0;
+    pData->nSceneSources = 0;
+    pData->lodNumDirect = 16;
+    pData->lodOrder = 1;
+    pData->enableNearField = 0;
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++){
+        pData->src_priority[ch] = 1.0f;
+        pData->src_dist_m[ch] = BINAURALISER_NEAR_FIELD_REF_DIST_M;
+    }
+    
+    /* parameter updates are handed over to the processing loop via a queue */
+    saf_paramQueue_create(&(pData->hParamQueue), BINAURALISER_NUM_PARAMS, BINAURALISER_NUM_PARAM_VALUES);
+    memcpy(pData->src_dirs_proc_deg, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+    memcpy(pData->src_dist_proc_m, pData->src_dist_m, MAX_NUM_INPUTS*sizeof(float));
+    pData->ypr_proc[0] = pData->yaw;
+    pData->ypr_proc[1] = pData->pitch;
+    pData->ypr_proc[2] = pData->roll;
+    pData->useRollPitchYawFlag_proc = pData->useRollPitchYawFlag;
+    saf_orientationPredictor_create(&(pData->hOrientPred));
+    pData->useQuaternion_proc = 0;
+    pData->hNearField = NULL; /* (created by binauraliser_init) */
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), pData->frameSize, MAX_NUM_INPUTS, NUM_EARS);
+    saf_profiler_create(&(pData->hProfiler));
+    saf_telemetry_create(&(pData->hTelemetry));
+    saf_initReport_create(&(pData->hInitReport));
+    
+    /* source mixing */
+    binauraliser_createMixWorkers(*phBin);
+    
+    /* for rebuilding the HRTFs in the background, once already initialised */
+    saf_asyncInit_create(&(pData->hHRTFsInit), &binauraliser_buildHRTFs, &binauraliser_destroyHRTFs, NULL, *phBin);
 }
 
 
@@ -101,7 +232,6 @@ void binauraliser_destroy
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(*phBin);
-    int ch;
 
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -110,34 +240,108 @@ void binauraliser_destroy
             SAF_SLEEP(10);
         }
         
+        /* cancel/wait for any background rebuild of the HRTFs */
+        saf_asyncInit_destroy(&(pData->hHRTFsInit));
+        
         /* free afSTFT and buffers */
         if(pData->hSTFT !=NULL)
             afSTFTfree(pData->hSTFT);
-        for(ch=0; ch< MAX_NUM_INPUTS; ch++) {
-            free(pData->STFTInputFrameTF[ch].re);
-            free(pData->STFTInputFrameTF[ch].im);
-        }
-        for (ch = 0; ch< NUM_EARS; ch++) {
-            free(pData->STFTOutputFrameTF[ch].re);
-            free(pData->STFTOutputFrameTF[ch].im);
-        }
-        free(pData->STFTInputFrameTF);
-        free(pData->STFTOutputFrameTF);
-        free(pData->tempHopFrameTD);
+        free(pData->inputFrameTD);
+        free(pData->inputframeTF);
+        free(pData->outputframeTF);
+        free(pData->outputframeTF_prev);
+        free(pData->outputFrameTD);
+        free(pData->hrtf_interp);
         free(pData->hrtf_vbap_gtableComp);
         free(pData->hrtf_vbap_gtableIdx);
-        free(pData->hrtf_fb);
-        free(pData->hrtf_fb_mag);
-        free(pData->itds_s);
-        free(pData->hrirs);
-        free(pData->hrir_dirs_deg);
+        free(pData->hrtf_shCoeffs);
+        free(pData->hrtf_cache);
+        free(pData->hrtf_cacheSlot);
+        free(pData->lod_frameTD);
+        free(pData->lod_decMtx);
+        hrtfCache_release(&(pData->hHRTFs));
         free(pData->progressBarText);
          
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_paramQueue_destroy(&(pData->hParamQueue));
+        saf_orientationPredictor_destroy(&(pData->hOrientPred));
+        nearFieldHRTFs_destroy(&(pData->hNearField));
+        saf_profiler_destroy(&(pData->hProfiler));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        saf_initReport_destroy(&(pData->hInitReport));
+        binauraliser_destroyMixWorkers(pData);
         free(pData);
         pData = NULL;
     }
 }
 
+void binauraliser_clone
+(
+    void * const hBin,
+    void ** const phClone
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_data *pClone;
+    binauraliser_hrtfSet* set;
+    
+    binauraliser_createWithFrameSize(phClone, pData->frameSize);
+    pClone = (binauraliser_data*)(*phClone);
+    
+    /* user parameters */
+    pClone->new_nSources = pData->new_nSources;
+    memcpy(pClone->src_dirs_deg, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+    memcpy(pClone->src_dist_m, pData->src_dist_m, MAX_NUM_INPUTS*sizeof(float));
+    pClone->enableNearField = pData->enableNearField;
+    pClone->input_nDims = pData->input_nDims;
+    pClone->interpMode = pData->interpMode;
+    pClone->hrtfPrecision = pData->hrtfPrecision;
+    pClone->enableRotation = pData->enableRotation;
+    pClone->yaw = pData->yaw;
+    pClone->pitch = pData->pitch;
+    pClone->roll = pData->roll;
+    pClone->bFlipYaw = pData->bFlipYaw;
+    pClone->bFlipPitch = pData->bFlipPitch;
+    pClone->bFlipRoll = pData->bFlipRoll;
+    pClone->useRollPitchYawFlag = pData->useRollPitchYawFlag;
+    pClone->predictionTime_ms = pData->predictionTime_ms;
+    pClone->enableLOD = pData->enableLOD;
+    pClone->lodNumDirect = pData->lodNumDirect;
+    pClone->lodOrder = pData->lodOrder;
+    memcpy(pClone->src_priority, pData->src_priority, MAX_NUM_INPUTS*sizeof(float));
+    pClone->qualityLevel = pData->qualityLevel;
+    pClone->nSceneSources = pData->nSceneSources;
+    pClone->useDefaultHRIRsFLAG = pData->useDefaultHRIRsFLAG;
+    if(pData->sofa_filepath!=NULL){
+        pClone->sofa_filepath = malloc1d(strlen(pData->sofa_filepath) + 1);
+        strcpy(pClone->sofa_filepath, pData->sofa_filepath);
+    }
+    
+    /* (the clone is not yet processing, so the parameters are applied to the
+     * processing loop directly) */
+    memcpy(pClone->src_dirs_proc_deg, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+    memcpy(pClone->src_dist_proc_m, pData->src_dist_m, MAX_NUM_INPUTS*sizeof(float));
+    pClone->ypr_proc[0] = pData->yaw;
+    pClone->ypr_proc[1] = pData->pitch;
+    pClone->ypr_proc[2] = pData->roll;
+    pClone->useRollPitchYawFlag_proc = pData->useRollPitchYawFlag;
+    binauraliser_init(*phClone, pData->fs);
+    
+    /* take over the HRTFs and the interpolation table (and the interpolated
+     * HRTFs cached so far), rather than rebuilding them */
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED && pData->hrtf_fb!=NULL){
+        set = binauraliser_copyHRTFs(hBin);
+        binauraliser_swapHRTFs(*phClone, set);
+        binauraliser_destroyHRTFs(*phClone, (void*)set);
+        memcpy(pClone->hrtf_cache, pData->hrtf_cache, HRTF_CACHE_SIZE*HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+        memcpy(pClone->hrtf_cacheIdx3d, pData->hrtf_cacheIdx3d, HRTF_CACHE_SIZE*sizeof(int));
+        memcpy(pClone->hrtf_cacheLastUsed, pData->hrtf_cacheLastUsed, HRTF_CACHE_SIZE*sizeof(unsigned int));
+        pClone->hrtf_cacheClock = pData->hrtf_cacheClock;
+        pClone->reInitHRTFsAndGainTables = 0;
+        binauraliser_initCodec(*phClone);
+    }
+}
+
 void binauraliser_init
 (
     void * const hBin,
@@ -145,18 +349,38 @@ void binauraliser_init
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int band;
+    int band, ch;
+    float freqVector[HYBRID_BANDS];
     
     /* define frequency vector */
     pData->fs = sampleRate;
     for(band=0; band <HYBRID_BANDS; band++){
         if(sampleRate == 44100)
-            pData->freqVector[band] =  (float)__afCenterFreq44100[band];
+            freqVector[band] =  (float)__afCenterFreq44100[band];
         else
-            pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
+            freqVector[band] =  (float)__afCenterFreq48e3[band];
     }
     /* defaults */
     pData->recalc_M_rotFLAG = 1;
+    
+    /* nothing else depends on the sampling rate (e.g. 48kHz<->96kHz) */
+    if(!memcmp(freqVector, pData->freqVector, HYBRID_BANDS*sizeof(float)))
+        return;
+    memcpy(pData->freqVector, freqVector, HYBRID_BANDS*sizeof(float));
+    
+    /* the interpolated HRTFs, and the near-field compensation, depend on the
+     * frequency vector */
+    nearFieldHRTFs_destroy(&(pData->hNearField));
+    nearFieldHRTFs_create(&(pData->hNearField), pData->freqVector, HYBRID_BANDS, NEAR_FIELD_DEFAULT_HEAD_RADIUS,
+                          BINAURALISER_NEAR_FIELD_REF_DIST_M, BINAURALISER_NEAR_FIELD_MIN_DIST_M,
+                          NEAR_FIELD_NUM_DISTANCES, NEAR_FIELD_NUM_ANGLES);
+    binauraliser_resetHRTFcache(hBin);
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    
+    /* restart any background rebuild of the HRTFs with the new frequencies */
+    if(saf_asyncInit_isBusy(pData->hHRTFsInit))
+        saf_asyncInit_request(pData->hHRTFsInit);
 }
 
 void binauraliser_initCodec
@@ -178,15 +402,23 @@ void binauraliser_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    saf_initReport_start(pData->hInitReport);
     
     /* check if TFT needs to be reinitialised */
+    saf_initReport_beginStage("binauraliser_initTFT");
     binauraliser_initTFT(hBin);
+    saf_initReport_endStage();
     
     /* reinit HRTFs and interpolation tables */
     if(pData->reInitHRTFsAndGainTables){
+        saf_initReport_beginStage("binauraliser_initHRTFsAndGainTables");
         binauraliser_initHRTFsAndGainTables(hBin);
+        saf_initReport_endStage();
         pData->reInitHRTFsAndGainTables = 0;
     }
+    saf_initReport_finish(pData->hInitReport);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -195,123 +427,517 @@ void binauraliser_initCodec
     
 }
 
-void binauraliser_process
+void binauraliser_prepareToPlay
+(
+    void* const hBin,
+    int nInputs,
+    int nOutputs,
+    int blockSize
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+
+    binauraliser_initCodec(hBin);
+    saf_fifo_setHostBlockSize(pData->hFIFO, blockSize);
+
+    /* pre-fault the HRTF filterbank coefficients and the interpolation table */
+    if(pData->hrtf_fb!=NULL){
+        saf_warmUp_touch(pData->hrtf_fb, HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float_complex), 0);
+        saf_warmUp_touch(pData->hrtf_vbap_gtableIdx, (pData->N_hrtf_vbap_gtable)*3*sizeof(int), 0);
+        saf_warmUp_touch(pData->hrtf_vbap_gtableComp, (pData->N_hrtf_vbap_gtable)*3*utility_storagePrecisionBytes(pData->hrtf_precision), 0);
+    }
+    saf_warmUp_run(hBin, &binauraliser_process, nInputs, nOutputs, blockSize, SAF_WARMUP_NUM_SAMPLES);
+}
+
+/**
+ * Requests that the HRTFs and interpolation tables are reinitialised; which is
+ * carried out in the background (and crossfaded to) if the codec is already
+ * initialised, or otherwise by the next call to binauraliser_initCodec()
+ */
+static void binauraliser_requestHRTFsReinit(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    
+    if(pData->codecStatus==CODEC_STATUS_INITIALISED && pData->hrtf_fb!=NULL && !pData->reInitHRTFsAndGainTables)
+        saf_asyncInit_request(pData->hHRTFsInit);
+    else{
+        pData->reInitHRTFsAndGainTables = 1;
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+/**
+ * Interpolates the HRTFs of one source (and applies the near-field
+ * compensation, if enabled)
+ */
+static void binauraliser_interpSourceHRTFs
+(
+    binauraliser_data* pData,
+    int ch,
+    int enableRotation,
+    float_complex* h_intrp
+)
+{
+    float* dir_deg;
+
+    dir_deg = enableRotation ? pData->src_dirs_rot_deg[ch] : pData->src_dirs_proc_deg[ch];
+    binauraliser_interpHRTFs((void*)pData, dir_deg[0], dir_deg[1], h_intrp);
+    if(pData->enableNearField && pData->hNearField!=NULL)
+        nearFieldHRTFs_apply(pData->hNearField, dir_deg[0], dir_deg[1], pData->src_dist_proc_m[ch], h_intrp);
+}
+
+/** Interpolates the HRTFs for any sources that have been flagged */
+static void binauraliser_updateInterpHRTFs
+(
+    void* const hBin,
+    int nSources,
+    int enableRotation
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch, s;
+    
+    /* in the LOD mode, the HRTFs are interpolated for the sources held by the
+     * direct slots */
+    if(pData->lod_nSH>0){
+        for(s=0; s<pData->lod_nDirect; s++){
+            ch = pData->lod_slotSrc[s];
+            if(ch<0 || (pData->recalc_hrtf_interpFLAG[ch] && afSTFTisChannelSilent(pData->hSTFT, s)))
+                memset(&(pData->hrtf_interp[s*HYBRID_BANDS*NUM_EARS]), 0, HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+            else if(pData->recalc_hrtf_interpFLAG[ch]){
+                binauraliser_interpSourceHRTFs(pData, ch, enableRotation, &(pData->hrtf_interp[s*HYBRID_BANDS*NUM_EARS]));
+                pData->recalc_hrtf_interpFLAG[ch] = 0;
+            }
+        }
+        return;
+    }
+    
+    for (ch = 0; ch < nSources; ch++) {
+        if(pData->recalc_hrtf_interpFLAG[ch] && afSTFTisChannelSilent(pData->hSTFT, ch)){
+            /* (silent sources are interpolated once they become active again) */
+            memset(&(pData->hrtf_interp[ch*HYBRID_BANDS*NUM_EARS]), 0, HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+        }
+        else if(pData->recalc_hrtf_interpFLAG[ch]){
+            binauraliser_interpSourceHRTFs(pData, ch, enableRotation, &(pData->hrtf_interp[ch*HYBRID_BANDS*NUM_EARS]));
+            pData->recalc_hrtf_interpFLAG[ch] = 0;
+        }
+    }
+}
+
+/** Rotates the direction of one source, and flags its HRTFs for interpolation */
+static void binauraliser_rotateSource
+(
+    binauraliser_data* pData,
+    int ch
+)
+{
+    float hypotxy;
+    
+    pData->src_dirs_xyz[ch][0] = cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][1])) * cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][0]));
+    pData->src_dirs_xyz[ch][1] = cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][1])) * sinf(DEG2RAD(pData->src_dirs_proc_deg[ch][0]));
+    pData->src_dirs_xyz[ch][2] = sinf(DEG2RAD(pData->src_dirs_proc_deg[ch][1]));
+    utility_sm3vmul((float*)pData->Rxyz_T, pData->src_dirs_xyz[ch], pData->src_dirs_rot_xyz[ch]);
+    hypotxy = sqrtf(powf(pData->src_dirs_rot_xyz[ch][0], 2.0f) + powf(pData->src_dirs_rot_xyz[ch][1], 2.0f));
+    pData->src_dirs_rot_deg[ch][0] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[ch][1], pData->src_dirs_rot_xyz[ch][0]));
+    pData->src_dirs_rot_deg[ch][1] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[ch][2], hypotxy));
+    pData->recalc_hrtf_interpFLAG[ch] = 1;
+}
+
+/** Rotates the directions of all sources (i.e. after the rotation changed) */
+static void binauraliser_rotateSources
+(
+    binauraliser_data* pData,
+    int nSources
+)
+{
+#ifdef SAF_ENABLE_FAST_MATH
+    /* as binauraliser_rotateSource(), but with the batched coordinate
+     * conversions over all of the sources */
+    int ch;
+    float azi[MAX_NUM_INPUTS], elev[MAX_NUM_INPUTS], x[MAX_NUM_INPUTS], y[MAX_NUM_INPUTS], z[MAX_NUM_INPUTS];
+    
+    for(ch=0; ch<nSources; ch++){
+        azi[ch] = DEG2RAD(pData->src_dirs_proc_deg[ch][0]);
+        elev[ch] = DEG2RAD(pData->src_dirs_proc_deg[ch][1]);
+    }
+    unitSph2CartBatch(azi, elev, nSources, x, y, z);
+    for(ch=0; ch<nSources; ch++){
+        pData->src_dirs_xyz[ch][0] = x[ch];
+        pData->src_dirs_xyz[ch][1] = y[ch];
+        pData->src_dirs_xyz[ch][2] = z[ch];
+        utility_sm3vmul((float*)pData->Rxyz_T, pData->src_dirs_xyz[ch], pData->src_dirs_rot_xyz[ch]);
+        x[ch] = pData->src_dirs_rot_xyz[ch][0];
+        y[ch] = pData->src_dirs_rot_xyz[ch][1];
+        z[ch] = pData->src_dirs_rot_xyz[ch][2];
+    }
+    unitCart2SphBatch(x, y, z, nSources, azi, elev);
+    for(ch=0; ch<nSources; ch++){
+        pData->src_dirs_rot_deg[ch][0] = RAD2DEG(azi[ch]);
+        pData->src_dirs_rot_deg[ch][1] = RAD2DEG(elev[ch]);
+        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    }
+#else
+    int ch;
+    
+    for(ch=0; ch<nSources; ch++)
+        binauraliser_rotateSource(pData, ch);
+#endif
+}
+
+/**
+ * Applies the parameter updates handed over by the setters. A new source
+ * direction only requires the HRTFs of that source to be interpolated again
+ * (and, when rotating, only that source to be rotated; unless the rotation
+ * matrix changed too, in which case all sources are rotated anyway)
+ */
+static void binauraliser_applyParamUpdates
+(
+    binauraliser_data* pData,
+    int nSources,
+    int enableRotation
+)
+{
+    int param, ch;
+    float values[BINAURALISER_NUM_PARAM_VALUES];
+    
+    while(saf_paramQueue_pop(pData->hParamQueue, &param, values, NULL)){
+        if(param==BINAURALISER_PARAM_ORIENTATION){
+            memcpy(pData->ypr_proc, values, 3*sizeof(float));
+            pData->useRollPitchYawFlag_proc = (int)values[3];
+            pData->useQuaternion_proc = 0;
+            pData->recalc_M_rotFLAG = 1;
+        }
+        else if(param==BINAURALISER_PARAM_QUATERNION){
+            saf_orientationPredictor_addSample(pData->hOrientPred, values, (double)values[4] + (double)values[5]);
+            pData->useQuaternion_proc = 1;
+        }
+        else{
+            ch = param - BINAURALISER_PARAM_SOURCE_DIR(0);
+            memcpy(pData->src_dirs_proc_deg[ch], values, 2*sizeof(float));
+            pData->src_dist_proc_m[ch] = values[2];
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
+            if(!enableRotation)
+                pData->recalc_M_rotFLAG = 1; /* (so that it is rotated once rotation is enabled) */
+            else if(ch<nSources && !pData->recalc_M_rotFLAG)
+                binauraliser_rotateSource(pData, ch);
+        }
+    }
+}
+
+/**
+ * Processes one frame of frameSize samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void binauraliser_processFrame
 (
     void  *  const hBin,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int t, ch, ear, i, band, nSources;
-    float src_dirs[MAX_NUM_INPUTS][2], Rxyz[3][3], hypotxy;
+    int t, ch, i, j, band, nSources, crossfade, frameSize, nTimeSlots;
+    float Rxyz[3][3], fadeIn;
     int enableRotation;
+    binauraliser_hrtfSet* newHRTFs;
     
     /* apply binaural panner */
-    if ((nSamples == FRAME_SIZE) && (pData->hrtf_fb!=NULL) && (pData->codecStatus==CODEC_STATUS_INITIALISED) ){
+    if ((pData->hrtf_fb!=NULL) && (pData->codecStatus==CODEC_STATUS_INITIALISED) ){
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
         
         /* copy user parameters to local variables */
         nSources = pData->nSources;
+        frameSize = pData->frameSize;
+        nTimeSlots = pData->nTimeSlots;
         enableRotation = pData->enableRotation;
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+        
+        /* Rotate source directions (before the TFT, as the level-of-detail
+         * mode encodes the sources into the SH bed in the time-domain) */
+        binauraliser_applyParamUpdates(pData, nSources, enableRotation);
+        binauraliser_predictOrientation(pData, 0.5*(double)frameSize/(double)pData->fs); /* (mid-frame) */
+        if(enableRotation && pData->recalc_M_rotFLAG){
+            pData->recalc_M_rotFLAG = 0;
+            yawPitchRoll2Rzyx (pData->ypr_proc[0], pData->ypr_proc[1], pData->ypr_proc[2], pData->useRollPitchYawFlag_proc, Rxyz);
+            /* (rotated row vectors: x_rot = x*Rxyz = Rxyz.'*x) */
+            for(i=0; i<3; i++)
+                for(j=0; j<3; j++)
+                    pData->Rxyz_T[i][j] = Rxyz[j][i];
+            binauraliser_rotateSources(pData, nSources);
+        }
         
         /* Load time-domain data */
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
         for(i=0; i < MIN(nSources,nInputs); i++)
-            utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
-        for(; i<MAX_NUM_INPUTS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+            utility_svvcopy(inputs[i], frameSize, pData->inputFrameTD[i]);
+        for(; i<nSources; i++)
+            memset(pData->inputFrameTD[i], 0, frameSize * sizeof(float));
         
-        /* Apply time-frequency transform (TFT) */
-        for(t=0; t< TIME_SLOTS; t++) {
-            for(ch = 0; ch < nSources; ch++)
-                utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < nSources; ch++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+        /* Apply time-frequency transform (TFT); in the LOD mode, to the direct
+         * slot signals and the SH bed signals */
+        if(pData->lod_nSH>0){
+            binauraliser_lodPrepareFrame(hBin, nSources, enableRotation);
+            afSTFTforwardFrame(pData->hSTFT, pData->lod_frameTD, nTimeSlots, &(pData->inputframeTF[0][0][0]), pData->nSourcesAlloc*nTimeSlots, nTimeSlots);
+            pData->nSourcesMix = pData->lod_nDirect;
+        }
+        else{
+            afSTFTforwardFrame(pData->hSTFT, pData->inputFrameTD, nTimeSlots, &(pData->inputframeTF[0][0][0]), pData->nSourcesAlloc*nTimeSlots, nTimeSlots);
+            pData->nSourcesMix = 0;
+            for(i=0; i<nSources; i++)
+                if(!afSTFTisChannelSilent(pData->hSTFT, i))
+                    pData->nSourcesMix = i+1;
         }
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_FORWARD);
         
         /* Main processing: */
-        /* Rotate source directions */
-        if(enableRotation && pData->recalc_M_rotFLAG){
-            yawPitchRoll2Rzyx (pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
-            for(i=0; i<nSources; i++){
-                pData->src_dirs_xyz[i][0] = cosf(DEG2RAD(pData->src_dirs_deg[i][1])) * cosf(DEG2RAD(pData->src_dirs_deg[i][0]));
-                pData->src_dirs_xyz[i][1] = cosf(DEG2RAD(pData->src_dirs_deg[i][1])) * sinf(DEG2RAD(pData->src_dirs_deg[i][0]));
-                pData->src_dirs_xyz[i][2] = sinf(DEG2RAD(pData->src_dirs_deg[i][1]));
-                pData->recalc_hrtf_interpFLAG[i] = 1;
-            }
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSources, 3, 3, 1.0f,
-                        (float*)(pData->src_dirs_xyz), 3,
-                        (float*)Rxyz, 3, 0.0f,
-                        (float*)(pData->src_dirs_rot_xyz), 3);
-            for(i=0; i<nSources; i++){
-                hypotxy = sqrtf(powf(pData->src_dirs_rot_xyz[i][0], 2.0f) + powf(pData->src_dirs_rot_xyz[i][1], 2.0f));
-                pData->src_dirs_rot_deg[i][0] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[i][1], pData->src_dirs_rot_xyz[i][0]));
-                pData->src_dirs_rot_deg[i][1] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[i][2], hypotxy));
-            }
-            pData->recalc_M_rotFLAG = 0;
+        /* interpolate hrtfs */
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+        binauraliser_updateInterpHRTFs(hBin, nSources, enableRotation);
+        
+        /* swap in the HRTFs rebuilt in the background (if they are ready), and
+         * keep the output of the old HRTFs for this frame, to crossfade from.
+         * The old HRTFs are then destroyed in the background. */
+        crossfade = 0;
+        newHRTFs = (binauraliser_hrtfSet*)saf_asyncInit_fetch(pData->hHRTFsInit);
+        if(newHRTFs!=NULL){
+            binauraliser_mixAllSources(hBin, nSources);
+            memcpy(&(pData->outputframeTF_prev[0][0][0]), &(pData->outputframeTF[0][0][0]), HYBRID_BANDS*NUM_EARS*nTimeSlots*sizeof(float_complex));
+            binauraliser_swapHRTFs(hBin, newHRTFs);
+            saf_asyncInit_retire(pData->hHRTFsInit, (void*)newHRTFs);
+            binauraliser_resetHRTFcache(hBin);
+            for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+                pData->recalc_hrtf_interpFLAG[ch] = 1;
+            binauraliser_updateInterpHRTFs(hBin, nSources, enableRotation);
+            crossfade = 1;
         }
-         
-        /* interpolate hrtfs and apply to each source */
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
-        for (ch = 0; ch < nSources; ch++) {
-            if(pData->recalc_hrtf_interpFLAG[ch]){
-                if(enableRotation)
-                    binauraliser_interpHRTFs(hBin, pData->src_dirs_rot_deg[ch][0], pData->src_dirs_rot_deg[ch][1], pData->hrtf_interp[ch]);
-                else
-                    binauraliser_interpHRTFs(hBin, pData->src_dirs_deg[ch][0], pData->src_dirs_deg[ch][1], pData->hrtf_interp[ch]);
-                pData->recalc_hrtf_interpFLAG[ch] = 0;
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PARAM_UPDATE);
+        
+        /* apply to each source, and scale by number of sources */
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
+        binauraliser_mixAllSources(hBin, nSources);
+        
+        /* linear crossfade (over the time slots) from the old HRTFs */
+        if(crossfade){
+            for(band=0; band<HYBRID_BANDS; band++){
+                for(i=0; i<NUM_EARS; i++){
+                    for(t=0; t<nTimeSlots; t++){
+                        fadeIn = (float)(t+1)/(float)nTimeSlots;
+                        pData->outputframeTF[band][i][t] = ccaddf(crmulf(pData->outputframeTF[band][i][t], fadeIn),
+                                                                  crmulf(pData->outputframeTF_prev[band][i][t], 1.0f-fadeIn));
+                    }
+                }
             }
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ear = 0; ear < NUM_EARS; ear++)
-                    for (t = 0; t < TIME_SLOTS; t++)
-                        pData->outputframeTF[band][ear][t] = ccaddf(pData->outputframeTF[band][ear][t], ccmulf(pData->inputframeTF[band][ch][t], pData->hrtf_interp[ch][band][ear]));
         }
-            
-        /* scale by number of sources */
-        for (band = 0; band < HYBRID_BANDS; band++)
-            for (ear = 0; ear < NUM_EARS; ear++)
-                for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ear][t] = crmulf(pData->outputframeTF[band][ear][t], 1.0f/sqrtf((float)nSources));
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_PROCESSING);
        
         /* inverse-TFT */
-        for (t = 0; t < TIME_SLOTS; t++) {
-            for (band = 0; band < HYBRID_BANDS; band++) {
-                for (ch = 0; ch < NUM_EARS; ch++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
-                }
-            }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
-                utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
-            for (; ch < nOutputs; ch++)
-                memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
-        }
+        SAF_PROFILER_BEGIN(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
+        afSTFTinverseFrame(pData->hSTFT, &(pData->outputframeTF[0][0][0]), NUM_EARS*nTimeSlots, nTimeSlots, nTimeSlots, pData->outputFrameTD);
+        for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+            utility_svvcopy(pData->outputFrameTD[ch], frameSize, outputs[ch]);
+        for (; ch < nOutputs; ch++)
+            memset(outputs[ch], 0, frameSize*sizeof(float));
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TFT_INVERSE);
+        SAF_PROFILER_END(pData->hProfiler, SAF_PROFILER_STAGE_TOTAL);
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
-            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+            memset(outputs[ch],0, pData->frameSize*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     }
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+void binauraliser_process
+(
+    void  *  const hBin,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &binauraliser_processFrame, hBin);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void binauraliser_processInterleaved
+(
+    void  *  const hBin,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &binauraliser_processFrame, hBin);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Renders the segment of an offline job spanning the frames [first, last),
+ * using the instance of the calling thread; called via saf_parfor_run()
+ */
+static void binauraliser_offlineRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    binauraliser_offlineJob* job = (binauraliser_offlineJob*)(hCtx);
+    binauraliser_data *pW = (binauraliser_data*)(job->hWorkers[threadIndex]);
+    float** frameIn, **frameOut;
+    int f, ch, nValid, n0, nStart, nEnd, fEnd, frameSize;
+    
+    frameSize = pW->frameSize;
+    frameIn = (float**)malloc2d(MAX(job->nInputs, 1), frameSize, sizeof(float));
+    frameOut = (float**)malloc2d(MAX(job->nOutputs, 1), frameSize, sizeof(float));
+    
+    /* the output of frame 'f' spans the samples [f*frameSize-delay,
+     * (f+1)*frameSize-delay) of the delay-compensated output; so the frames
+     * are processed until the end of the segment has been written. The
+     * pre-roll frames are only processed to warm up the filterbank. */
+    nStart = first*frameSize;
+    nEnd = MIN(last*frameSize, job->nSamples);
+    fEnd = (nEnd + job->delay + frameSize - 1)/frameSize;
+    for(f=MAX(first-job->nPreRollFrames, 0); f<fEnd; f++){
+        /* (zero padded after the end of the signals) */
+        n0 = f*frameSize;
+        nValid = CLAMP(job->nSamples - n0, 0, frameSize);
+        for(ch=0; ch<job->nInputs; ch++){
+            if(nValid>0)
+                memcpy(frameIn[ch], &(job->inputs[ch][n0]), nValid*sizeof(float));
+            memset(&(frameIn[ch][nValid]), 0, (frameSize-nValid)*sizeof(float));
+        }
+        binauraliser_processFrame(pW, frameIn, frameOut, job->nInputs, job->nOutputs);
+        
+        /* copy over the part of this frame's output that lies in the segment */
+        n0 = f*frameSize - job->delay;
+        if(n0+frameSize<=nStart || n0>=nEnd)
+            continue;
+        for(ch=0; ch<job->nOutputs; ch++)
+            memcpy(&(job->outputs[ch][MAX(n0, nStart)]), &(frameOut[ch][MAX(nStart-n0, 0)]),
+                   (MIN(n0+frameSize, nEnd) - MAX(n0, nStart))*sizeof(float));
+    }
+    
+    free(frameIn);
+    free(frameOut);
+}
+
+void binauraliser_renderOffline
+(
+    void  *  const      hBin,
+    const float* const* inputs,
+    float* const*       outputs,
+    int                 nInputs,
+    int                 nOutputs,
+    int                 nSamples,
+    int                 nThreads
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_data *pW;
+    binauraliser_offlineJob job;
+    void* hParFor;
+    int i, ch, nFrames, nThreadsInUse;
+    
+    nFrames = (nSamples + pData->frameSize - 1)/pData->frameSize;
+    if(nFrames<1)
+        return;
+    
+    /* the FIFO is bypassed, so only the delay of the filterbank remains; and
+     * twice that is enough for its state to settle */
+    job.delay = binauraliser_getProcessingDelay(hBin) - saf_fifo_getLatency(pData->hFIFO);
+    job.nPreRollFrames = (2*job.delay + pData->frameSize - 1)/pData->frameSize + 1;
+    
+    /* one single-threaded instance per thread, with the current configuration */
+    saf_parfor_create(&hParFor, nThreads);
+    nThreadsInUse = saf_parfor_getNumThreads(hParFor);
+    job.hWorkers = (void**)malloc1d(nThreadsInUse*sizeof(void*));
+    for(i=0; i<nThreadsInUse; i++){
+        binauraliser_createWithFrameSize(&(job.hWorkers[i]), pData->frameSize);
+        pW = (binauraliser_data*)(job.hWorkers[i]);
+        pW->new_nSources = pW->nSources = pData->new_nSources;
+        afSTFTinit(&(pW->hSTFT), HOP_SIZE, pW->nSources, NUM_EARS, 0, 1, 1); /* (the threads are already taken) */
+        pW->nCH_STFT = pW->nSources;
+        memcpy(pW->src_dirs_deg, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+        memcpy(pW->src_dist_m, pData->src_dist_m, MAX_NUM_INPUTS*sizeof(float));
+        pW->enableNearField = pData->enableNearField;
+        pW->input_nDims = pData->input_nDims;
+        pW->interpMode = pData->interpMode;
+        pW->hrtfPrecision = pData->hrtfPrecision;
+        if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL)
+            binauraliser_setSofaFilePath(job.hWorkers[i], pData->sofa_filepath);
+        pW->enableRotation = pData->enableRotation;
+        pW->yaw = pData->yaw;
+        pW->pitch = pData->pitch;
+        pW->roll = pData->roll;
+        pW->bFlipYaw = pData->bFlipYaw;
+        pW->bFlipPitch = pData->bFlipPitch;
+        pW->bFlipRoll = pData->bFlipRoll;
+        pW->useRollPitchYawFlag = pData->useRollPitchYawFlag;
+        pW->enableLOD = pData->enableLOD;
+        pW->lodNumDirect = pData->lodNumDirect;
+        pW->lodOrder = pData->lodOrder;
+        memcpy(pW->src_priority, pData->src_priority, MAX_NUM_INPUTS*sizeof(float));
+        pW->nSceneSources = pData->nSceneSources;
+        for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+            binauraliser_pushSourceDir(pW, ch);
+        binauraliser_pushOrientation(pW);
+        binauraliser_init(job.hWorkers[i], pData->fs);
+        binauraliser_initCodec(job.hWorkers[i]);
+    }
+    
+    /* render */
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.nInputs = MIN(nInputs, MAX_NUM_INPUTS);
+    job.nOutputs = nOutputs;
+    job.nSamples = nSamples;
+    saf_parfor_run(hParFor, &binauraliser_offlineRange, (void*)&job, nFrames);
+    
+    for(i=0; i<nThreadsInUse; i++)
+        binauraliser_destroy(&(job.hWorkers[i]));
+    free(job.hWorkers);
+    saf_parfor_destroy(&hParFor);
+}
+
 /* Set Functions */
 
 void binauraliser_refreshSettings(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     int ch;
-    pData->reInitHRTFsAndGainTables = 1;
     for(ch=0; ch<MAX_NUM_INPUTS; ch++)
         pData->recalc_hrtf_interpFLAG[ch] = 1;
-    binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    binauraliser_requestHRTFsReinit(hBin);
 }
 
 void binauraliser_setSourceAzi_deg(void* const hBin, int index, float newAzi_deg)
@@ -323,8 +949,7 @@ void binauraliser_setSourceAzi_deg(void* const hBin, int index, float newAzi_deg
     newAzi_deg = MIN(newAzi_deg, 180.0f);
     if(pData->src_dirs_deg[index][0]!=newAzi_deg){
         pData->src_dirs_deg[index][0] = newAzi_deg;
-        pData->recalc_hrtf_interpFLAG[index] = 1;
-        pData->recalc_M_rotFLAG = 1;
+        binauraliser_pushSourceDir(pData, index);
     }
 }
 
@@ -335,8 +960,29 @@ void binauraliser_setSourceElev_deg(void* const hBin, int index, float newElev_d
     newElev_deg = MIN(newElev_deg, 90.0f);
     if(pData->src_dirs_deg[index][1] != newElev_deg){
         pData->src_dirs_deg[index][1] = newElev_deg;
-        pData->recalc_hrtf_interpFLAG[index] = 1;
-        pData->recalc_M_rotFLAG = 1;
+        binauraliser_pushSourceDir(pData, index);
+    }
+}
+
+void binauraliser_setSourceDist_m(void* const hBin, int index, float newDist_m)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    newDist_m = MAX(newDist_m, BINAURALISER_NEAR_FIELD_MIN_DIST_M);
+    if(pData->src_dist_m[index] != newDist_m){
+        pData->src_dist_m[index] = newDist_m;
+        binauraliser_pushSourceDir(pData, index);
+    }
+}
+
+void binauraliser_setEnableNearField(void* const hBin, int newState)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch;
+
+    if(pData->enableNearField != newState){
+        pData->enableNearField = newState;
+        for (ch = 0; ch<MAX_NUM_INPUTS; ch++)
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
     }
 }
 
@@ -353,8 +999,7 @@ void binauraliser_setUseDefaultHRIRsflag(void* const hBin, int newState)
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     if((!pData->useDefaultHRIRsFLAG) && (newState)){
         pData->useDefaultHRIRsFLAG = newState;
-        pData->reInitHRTFsAndGainTables = 1;
-        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+        binauraliser_requestHRTFsReinit(hBin);
     }
 }
 
@@ -365,8 +1010,7 @@ void binauraliser_setSofaFilePath(void* const hBin, const char* path)
     pData->sofa_filepath = malloc1d(strlen(path) + 1);
     strcpy(pData->sofa_filepath, path);
     pData->useDefaultHRIRsFLAG = 0;
-    pData->reInitHRTFsAndGainTables = 1;
-    binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    binauraliser_requestHRTFsReinit(hBin);
 }
 
 void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID)
@@ -378,7 +1022,7 @@ void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID)
     if(pData->nSources != pData->new_nSources)
         binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
     for(ch=0; ch<MAX_NUM_INPUTS; ch++)
-        pData->recalc_hrtf_interpFLAG[ch] = 1;
+        binauraliser_pushSourceDir(pData, ch);
 }
 
 void binauraliser_setEnableRotation(void* const hBin, int newState)
@@ -396,21 +1040,48 @@ void binauraliser_setYaw(void  * const hBin, float newYaw)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     pData->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
-    pData->recalc_M_rotFLAG = 1;
+    binauraliser_pushOrientation(pData);
 }
 
 void binauraliser_setPitch(void* const hBin, float newPitch)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     pData->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
-    pData->recalc_M_rotFLAG = 1;
+    binauraliser_pushOrientation(pData);
 }
 
 void binauraliser_setRoll(void* const hBin, float newRoll)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     pData->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
-    pData->recalc_M_rotFLAG = 1;
+    binauraliser_pushOrientation(pData);
+}
+
+void binauraliser_setQuaternion(void* const hBin, const float quat[4], double timestamp_s)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    float yaw, pitch, roll;
+    float values[BINAURALISER_NUM_PARAM_VALUES];
+    
+    /* (for the get functions) */
+    quaternion2yawPitchRoll(quat, &yaw, &pitch, &roll);
+    pData->yaw = pData->bFlipYaw == 1 ? -yaw : yaw;
+    pData->pitch = pData->bFlipPitch == 1 ? -pitch : pitch;
+    pData->roll = pData->bFlipRoll == 1 ? -roll : roll;
+    
+    /* the timestamp is split into two floats, so that its precision is kept */
+    if(timestamp_s < 0.0)
+        timestamp_s = saf_benchmark_getTime();
+    memcpy(values, quat, 4*sizeof(float));
+    values[4] = (float)timestamp_s;
+    values[5] = (float)(timestamp_s - (double)values[4]);
+    saf_paramQueue_push(pData->hParamQueue, BINAURALISER_PARAM_QUATERNION, values, 6);
+}
+
+void binauraliser_setPredictionTime(void* const hBin, float newTime_ms)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    pData->predictionTime_ms = CLAMP(newTime_ms, 0.0f, BINAURALISER_MAX_PREDICTION_TIME_MS);
 }
 
 void binauraliser_setFlipYaw(void* const hBin, int newState)
@@ -444,12 +1115,78 @@ void binauraliser_setRPYflag(void* const hBin, int newState)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     pData->useRollPitchYawFlag = newState;
+    binauraliser_pushOrientation(pData);
 }
 
 void binauraliser_setInterpMode(void* const hBin, int newMode)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    pData->interpMode = newMode;
+    if(pData->interpMode != (INTERP_MODES)newMode){
+        pData->interpMode = (INTERP_MODES)newMode;
+        binauraliser_requestHRTFsReinit(hBin);
+    }
+}
+
+void binauraliser_setHRTFprecision(void* const hBin, int newPrecision)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->hrtfPrecision != (BINAURALISER_HRTF_PRECISION)newPrecision){
+        pData->hrtfPrecision = (BINAURALISER_HRTF_PRECISION)newPrecision;
+        binauraliser_requestHRTFsReinit(hBin);
+    }
+}
+
+void binauraliser_setEnableLOD(void* const hBin, int newState)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->enableLOD != newState){
+        pData->enableLOD = newState;
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void binauraliser_setLODnumDirect(void* const hBin, int newValue)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    newValue = CLAMP(newValue, 0, MAX_NUM_INPUTS);
+    if(pData->lodNumDirect != newValue){
+        pData->lodNumDirect = newValue;
+        if(pData->enableLOD || pData->qualityLevel>=1)
+            binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void binauraliser_setLODorder(void* const hBin, int newOrder)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    newOrder = CLAMP(newOrder, 1, BINAURALISER_LOD_MAX_ORDER);
+    if(pData->lodOrder != newOrder){
+        pData->lodOrder = newOrder;
+        if(pData->enableLOD || pData->qualityLevel>=1)
+            binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void binauraliser_setSourcePriority(void* const hBin, int index, float newPriority)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    pData->src_priority[index] = MAX(newPriority, 0.0f);
+}
+
+void binauraliser_setQualityLevel(void* const hBin, int newLevel)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    newLevel = CLAMP(newLevel, 0, BINAURALISER_QUALITY_MAX_LEVEL);
+    if(pData->qualityLevel != newLevel){
+        pData->qualityLevel = newLevel;
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void binauraliser_setNumSceneSources(void* const hBin, int newValue)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    pData->nSceneSources = MAX(newValue, 0);
 }
 
 
@@ -485,6 +1222,18 @@ float binauraliser_getSourceElev_deg(void* const hBin, int index)
     return pData->src_dirs_deg[index][1];
 }
 
+float binauraliser_getSourceDist_m(void* const hBin, int index)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->src_dist_m[index];
+}
+
+int binauraliser_getEnableNearField(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->enableNearField;
+}
+
 int binauraliser_getNumSources(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
@@ -588,6 +1337,12 @@ float binauraliser_getRoll(void* const hBin)
     return pData->bFlipRoll == 1 ? -RAD2DEG(pData->roll) : RAD2DEG(pData->roll);
 }
 
+float binauraliser_getPredictionTime(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->predictionTime_ms;
+}
+
 int binauraliser_getFlipYaw(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
@@ -618,9 +1373,110 @@ int binauraliser_getInterpMode(void* const hBin)
     return (int)pData->interpMode;
 }
 
-int binauraliser_getProcessingDelay()
+int binauraliser_getHRTFprecision(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return (int)pData->hrtfPrecision;
+}
+
+int binauraliser_getEnableLOD(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->enableLOD;
+}
+
+int binauraliser_getLODnumDirect(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->lodNumDirect;
+}
+
+int binauraliser_getLODorder(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->lodOrder;
+}
+
+float binauraliser_getSourcePriority(void* const hBin, int index)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->src_priority[index];
+}
+
+int binauraliser_getLODisEngaged(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->lod_nSH>0 ? 1 : 0;
+}
+
+int binauraliser_getQualityLevel(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->qualityLevel;
+}
+
+int binauraliser_getNumSceneSources(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->nSceneSources;
+}
+
+int binauraliser_getProcessingDelay(void* const hBin)
 {
-    return 12*HOP_SIZE;
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return saf_fifo_getLatency(pData->hFIFO) + 12*HOP_SIZE;
+}
+
+int binauraliser_getFrameSize(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->frameSize;
+}
+
+void* binauraliser_getProfiler(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hProfiler;
+}
+
+void* binauraliser_getTelemetry(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hTelemetry;
+}
+
+void* binauraliser_getInitReport(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hInitReport;
+}
+
+size_t binauraliser_getMemoryUsage(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    size_t n, nTS, bytes;
+    
+    n = (size_t)pData->nSourcesAlloc;
+    bytes = sizeof(binauraliser_data);
+    nTS = (size_t)pData->nTimeSlots;
+    bytes += n*sizeof(float*) + n*(size_t)pData->frameSize*sizeof(float); /* inputFrameTD */
+    bytes += HYBRID_BANDS*(sizeof(float_complex**) + n*sizeof(float_complex*) +
+                           n*nTS*sizeof(float_complex));                /* inputframeTF */
+    bytes += 2*HYBRID_BANDS*(sizeof(float_complex**) + NUM_EARS*sizeof(float_complex*) +
+                             NUM_EARS*nTS*sizeof(float_complex));       /* outputframeTF(_prev) */
+    bytes += NUM_EARS*sizeof(float*) + NUM_EARS*(size_t)pData->frameSize*sizeof(float); /* outputFrameTD */
+    bytes += n*HYBRID_BANDS*NUM_EARS*sizeof(float_complex);             /* hrtf_interp */
+    bytes += HRTF_CACHE_SIZE*HYBRID_BANDS*NUM_EARS*sizeof(float_complex); /* hrtf_cache */
+    bytes += NEAR_FIELD_NUM_DISTANCES*NEAR_FIELD_NUM_ANGLES*HYBRID_BANDS*sizeof(float_complex); /* hNearField */
+    bytes += (size_t)pData->N_hrtf_vbap_gtable*(3*sizeof(int) + 3*utility_storagePrecisionBytes(pData->hrtf_precision) +
+                                                sizeof(int)); /* VBAP table + cache look-up */
+    if(pData->hrtf_shCoeffs!=NULL)
+        bytes += (size_t)ORDER2NSH(pData->hrtf_shOrder)*(HYBRID_BANDS*NUM_EARS+1)*sizeof(float); /* hrtf_shCoeffs */
+    if(pData->lod_nSH>0)
+        bytes += (size_t)(pData->lod_nDirect+pData->lod_nSH)*(sizeof(float*) + (size_t)pData->frameSize*sizeof(float)); /* lod_frameTD */
+    bytes += HYBRID_BANDS*NUM_EARS*(size_t)ORDER2NSH(pData->lod_decOrder)*(pData->lod_decMtx!=NULL ? sizeof(float_complex) : 0); /* lod_decMtx */
+    bytes += BINAURALISER_PROGRESSBARTEXT_CHAR_LENGTH*sizeof(char);
+    return bytes;
 }
  
     
@@ -42,37 +42,153 @@ void binauraliser_setCodecStatus(void* const hBin, BINAURALISER_CODEC_STATUS new
     pData->codecStatus = newStatus;
 }
 
+/**
+ * Combines the (interpolated) HRTF magnitudes with the interaural phase
+ * difference of the (interpolated) ITD
+ */
+static void binauraliser_magsITD2HRTFs
+(
+    float* freqVector,
+    float itd,
+    float mags[HYBRID_BANDS][NUM_EARS],
+    float_complex* h
+)
+{
+    int band;
+#ifdef SAF_ENABLE_FAST_MATH
+    float ipd[HYBRID_BANDS], ipdSin[HYBRID_BANDS], ipdCos[HYBRID_BANDS];
+    
+    /* (exp(1i*ipd) = cos(ipd) + 1i*sin(ipd), for all bands at once) */
+    for (band = 0; band < HYBRID_BANDS; band++)
+        ipd[band] = freqVector[band]<1.5e3f ? 1.3f*(matlab_fmodf(2.0f*PI*(freqVector[band]) * itd + PI, 2.0f*PI) - PI)/2.0f : 0.0f;
+    utility_svsincosapprox(ipd, HYBRID_BANDS, ipdSin, ipdCos);
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        h[band*NUM_EARS+0] = cmplxf(ipdCos[band]*mags[band][0], ipdSin[band]*mags[band][0]);
+        h[band*NUM_EARS+1] = cmplxf(ipdCos[band]*mags[band][1], -ipdSin[band]*mags[band][1]);
+    }
+#else
+    float_complex ipd;
+    
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        if(freqVector[band]<1.5e3f)
+            ipd = cmplxf(0.0f, 1.3f*(matlab_fmodf(2.0f*PI*(freqVector[band]) * itd + PI, 2.0f*PI) - PI)/2.0f);
+        else
+            ipd = cmplxf(0.0f, 0.0f);
+        h[band*NUM_EARS+0] = crmulf(cexpf(ipd), mags[band][0]);
+        h[band*NUM_EARS+1] = crmulf(conjf(cexpf(ipd)), mags[band][1]);
+    }
+#endif
+}
+
+/** Evaluates the SH fit of the HRTF magnitudes and ITDs for one direction */
+static void binauraliser_interpHRTFsSH
+(
+    binauraliser_data *pData,
+    float azimuth_deg,
+    float elevation_deg,
+    float_complex* h_intrp
+)
+{
+    int i;
+    float x, y, z;
+    float Y[(HRTF_SH_MAX_ORDER+1)*(HRTF_SH_MAX_ORDER+1)];
+    float magsITD[HYBRID_BANDS*NUM_EARS+1];
+    
+    /* SH basis of this (exact) direction */
+    x = cosf(DEG2RAD(elevation_deg))*cosf(DEG2RAD(azimuth_deg));
+    y = cosf(DEG2RAD(elevation_deg))*sinf(DEG2RAD(azimuth_deg));
+    z = sinf(DEG2RAD(elevation_deg));
+    getSHreal_fastCart(pData->hrtf_shOrder, &x, &y, &z, 1, Y);
+    
+    /* magnitudes and ITD = coefficients^T * basis */
+    cblas_sgemv(CblasRowMajor, CblasTrans, ORDER2NSH(pData->hrtf_shOrder), HYBRID_BANDS*NUM_EARS+1, 1.0f,
+                pData->hrtf_shCoeffs, HYBRID_BANDS*NUM_EARS+1,
+                Y, 1, 0.0f,
+                magsITD, 1);
+    
+    /* (the truncated expansion may dip slightly below zero) */
+    for (i = 0; i < HYBRID_BANDS*NUM_EARS; i++)
+        magsITD[i] = MAX(magsITD[i], 0.0f);
+    binauraliser_magsITD2HRTFs(pData->freqVector, magsITD[HYBRID_BANDS*NUM_EARS], (float(*)[NUM_EARS])magsITD, h_intrp);
+}
+
 void binauraliser_interpHRTFs
 (
     void* const hBin,
     float azimuth_deg,
     float elevation_deg,
-    float_complex h_intrp[HYBRID_BANDS][NUM_EARS]
+    float_complex* h_intrp
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int i, band;
-    int aziIndex, elevIndex, N_azi, idx3d;
-    float_complex ipd;
-    float aziRes, elevRes, weights[3], itds3[3],  itdInterp;
+    int i, band, slot;
+    int idx3d;
+    unsigned int oldest;
+    size_t nBytes;
+    float_complex* h_cached;
+    float weights[3], itds3[3],  itdInterp;
+    float mags[HYBRID_BANDS*NUM_EARS];
     float magnitudes3[HYBRID_BANDS][3][NUM_EARS], magInterp[HYBRID_BANDS][NUM_EARS];
+    
+    if (pData->hrtf_interpMode == INTERP_SH) {
+        binauraliser_interpHRTFsSH(pData, azimuth_deg, elevation_deg, h_intrp);
+        return;
+    }
      
     /* find closest pre-computed VBAP direction */
-    aziRes = (float)pData->hrtf_vbapTableRes[0];
-    elevRes = (float)pData->hrtf_vbapTableRes[1];
-    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
-    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
-    idx3d = elevIndex * N_azi + aziIndex;
-    for (i = 0; i < 3; i++)
-        weights[i] = pData->hrtf_vbap_gtableComp[idx3d*3 + i];
+    idx3d = getVBAPgainTableIdx3D(azimuth_deg, elevation_deg, pData->hrtf_vbapTableRes[0], pData->hrtf_vbapTableRes[1]);
+    
+    /* the interpolated HRTFs only depend on this index, so return the cached
+     * set if this direction has already been interpolated */
+    if (++(pData->hrtf_cacheClock) == 0){
+        /* (rare) wrap-around; restart the least-recently-used ordering */
+        memset(pData->hrtf_cacheLastUsed, 0, HRTF_CACHE_SIZE*sizeof(unsigned int));
+        pData->hrtf_cacheClock = 1;
+    }
+    slot = pData->hrtf_cacheSlot[idx3d];
+    if (slot >= 0){
+        pData->hrtf_cacheLastUsed[slot] = pData->hrtf_cacheClock;
+        memcpy(h_intrp, &(pData->hrtf_cache[slot*HYBRID_BANDS*NUM_EARS]), HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+        return;
+    }
+    
+    /* otherwise, evict the least-recently-used set (empty slots first) */
+    slot = 0;
+    oldest = pData->hrtf_cacheLastUsed[0];
+    for (i = 1; i < HRTF_CACHE_SIZE && oldest != 0; i++){
+        if (pData->hrtf_cacheLastUsed[i] < oldest){
+            oldest = pData->hrtf_cacheLastUsed[i];
+            slot = i;
+        }
+    }
+    if (pData->hrtf_cacheIdx3d[slot] >= 0)
+        pData->hrtf_cacheSlot[pData->hrtf_cacheIdx3d[slot]] = -1;
+    pData->hrtf_cacheIdx3d[slot] = idx3d;
+    pData->hrtf_cacheSlot[idx3d] = slot;
+    pData->hrtf_cacheLastUsed[slot] = pData->hrtf_cacheClock;
+    h_cached = &(pData->hrtf_cache[slot*HYBRID_BANDS*NUM_EARS]);
+    
+    /* retrieve the 3 vbap weights */
+    nBytes = utility_storagePrecisionBytes(pData->hrtf_precision);
+    utility_svunpack((char*)pData->hrtf_vbap_gtableComp + idx3d*3*nBytes, 3, pData->hrtf_precision, weights);
     
     /* retrieve the 3 itds and hrtf magnitudes */
     for (i = 0; i < 3; i++) {
         itds3[i] = pData->itds_s[pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            magnitudes3[band][i][0] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 0*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
-            magnitudes3[band][i][1] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 1*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+        if (pData->hrtf_mags == NULL) {
+            for (band = 0; band < HYBRID_BANDS; band++) {
+                magnitudes3[band][i][0] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 0*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+                magnitudes3[band][i][1] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 1*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+            }
+        }
+        else {
+            /* one contiguous row per direction, converted on the fly */
+            utility_svunpack((char*)pData->hrtf_mags + (size_t)pData->hrtf_vbap_gtableIdx[idx3d*3+i]*HYBRID_BANDS*NUM_EARS*nBytes,
+                             HYBRID_BANDS*NUM_EARS, pData->hrtf_precision, mags);
+            for (band = 0; band < HYBRID_BANDS; band++) {
+                magnitudes3[band][i][0] = mags[band*NUM_EARS+0];
+                magnitudes3[band][i][1] = mags[band*NUM_EARS+1];
+            }
         }
     }
     
@@ -89,80 +205,581 @@ void binauraliser_interpHRTFs
     }
     
     /* introduce interaural phase difference */
-    for (band = 0; band < HYBRID_BANDS; band++) {
-        if(pData->freqVector[band]<1.5e3f)
-            ipd = cmplxf(0.0f, 1.3f*(matlab_fmodf(2.0f*PI*(pData->freqVector[band]) * itdInterp + PI, 2.0f*PI) - PI)/2.0f);
+    binauraliser_magsITD2HRTFs(pData->freqVector, itdInterp, magInterp, h_cached);
+    memcpy(h_intrp, h_cached, HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+}
+
+void binauraliser_resetHRTFcache(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i;
+    
+    if (pData->hrtf_cacheSlot != NULL)
+        for (i = 0; i < pData->N_hrtf_vbap_gtable; i++)
+            pData->hrtf_cacheSlot[i] = -1;
+    for (i = 0; i < HRTF_CACHE_SIZE; i++){
+        pData->hrtf_cacheIdx3d[i] = -1;
+        pData->hrtf_cacheLastUsed[i] = 0;
+    }
+    pData->hrtf_cacheClock = 0;
+}
+
+void binauraliser_mixSources
+(
+    void* const hBin,
+    int bandStart,
+    int bandEnd,
+    int nSources
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int band, nSourcesMix, nSH, nNorm;
+    float_complex calpha;
+    const float_complex cbeta = cmplxf(0.0f, 0.0f);
+    const float_complex cone = cmplxf(1.0f, 0.0f);
+    
+    /* (normalised by the number of sources in the whole scene, when only a
+     * part of it is rendered by this instance) */
+    nNorm = pData->nSceneSources > 0 ? pData->nSceneSources : nSources;
+    calpha = cmplxf(nNorm > 0 ? 1.0f/sqrtf((float)nNorm) : 0.0f, 0.0f);
+    
+    /* hrtf_interp[ch][band] is the (transposed) mixing matrix, with a stride of
+     * HYBRID_BANDS*NUM_EARS between sources, so no copy is required. Trailing
+     * silent sources contribute nothing, and are left out of the mix. (In the
+     * LOD mode, these are the direct slots) */
+    nSourcesMix = MIN(pData->nSourcesMix, nSources);
+    nSH = pData->lod_decMtx!=NULL && pData->lod_nSH==ORDER2NSH(pData->lod_decOrder) ? pData->lod_nSH : 0;
+    for(band=bandStart; band<bandEnd; band++){
+        if(nSourcesMix==0)
+            memset(pData->outputframeTF[band][0], 0, NUM_EARS*(pData->nTimeSlots)*sizeof(float_complex));
         else
-            ipd = cmplxf(0.0f, 0.0f);
-        h_intrp[band][0] = crmulf(cexpf(ipd), magInterp[band][0]);
-        h_intrp[band][1] = crmulf(conjf(cexpf(ipd)), magInterp[band][1]);
+            cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, NUM_EARS, pData->nTimeSlots, nSourcesMix, &calpha,
+                        &(pData->hrtf_interp[band*NUM_EARS]), HYBRID_BANDS*NUM_EARS,
+                        pData->inputframeTF[band][0], pData->nTimeSlots, &cbeta,
+                        pData->outputframeTF[band][0], pData->nTimeSlots);
+        
+        /* plus the decoded SH bed of the LOD mode (with the same scaling) */
+        if(nSH>0)
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, pData->nTimeSlots, nSH, &calpha,
+                        &(pData->lod_decMtx[band*NUM_EARS*nSH]), nSH,
+                        pData->inputframeTF[band][pData->lod_nDirect], pData->nTimeSlots, &cone,
+                        pData->outputframeTF[band][0], pData->nTimeSlots);
     }
 }
 
-void binauraliser_initHRTFsAndGainTables(void* const hBin)
+/** Mix worker thread, which mixes its range of bands each time a job is submitted */
+#if defined(_WIN32)
+static DWORD WINAPI binauraliser_mixWorkerThread(LPVOID arg)
+#else
+static void* binauraliser_mixWorkerThread(void* arg)
+#endif
+{
+    binauraliser_mixWorker *w = (binauraliser_mixWorker*)arg;
+    unsigned int fpState;
+    
+    while(1){
+        /* wait for the next job (or the request to exit) */
+#if defined(_WIN32)
+        EnterCriticalSection(&(w->mutex));
+        while(!w->jobPending && !w->exitFlag)
+            SleepConditionVariableCS(&(w->cond), &(w->mutex), INFINITE);
+        LeaveCriticalSection(&(w->mutex));
+#else
+        pthread_mutex_lock(&(w->mutex));
+        while(!w->jobPending && !w->exitFlag)
+            pthread_cond_wait(&(w->cond), &(w->mutex));
+        pthread_mutex_unlock(&(w->mutex));
+#endif
+        if(w->exitFlag)
+            break;
+        
+        /* process (flushing denormals, as for the calling thread) */
+        fpState = saf_denormals_guardBegin();
+        binauraliser_mixSources(w->hBin, w->bandStart, w->bandEnd, w->nSources);
+        saf_denormals_guardEnd(fpState);
+        
+        /* flag that the job has been completed */
+#if defined(_WIN32)
+        EnterCriticalSection(&(w->mutex));
+        w->jobPending = 0;
+        WakeAllConditionVariable(&(w->cond));
+        LeaveCriticalSection(&(w->mutex));
+#else
+        pthread_mutex_lock(&(w->mutex));
+        w->jobPending = 0;
+        pthread_cond_broadcast(&(w->cond));
+        pthread_mutex_unlock(&(w->mutex));
+#endif
+    }
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+void binauraliser_mixAllSources
+(
+    void* const hBin,
+    int nSources
+)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_mixWorker *w;
     int i;
-    float* hrtf_vbap_gtable;
     
-    strcpy(pData->progressBarText,"Loading HRIRs");
-    pData->progressBar0_1 = 0.2f;
+    /* submit the jobs */
+    for(i=1; i<BINAURALISER_MIX_NUM_THREADS; i++){
+        w = &(pData->mixWorkers[i]);
+        if(!w->threadRunning)
+            continue;
+#if defined(_WIN32)
+        EnterCriticalSection(&(w->mutex));
+        w->nSources = nSources;
+        w->jobPending = 1;
+        WakeAllConditionVariable(&(w->cond));
+        LeaveCriticalSection(&(w->mutex));
+#else
+        pthread_mutex_lock(&(w->mutex));
+        w->nSources = nSources;
+        w->jobPending = 1;
+        pthread_cond_broadcast(&(w->cond));
+        pthread_mutex_unlock(&(w->mutex));
+#endif
+    }
     
-    /* load sofa file or load default hrir data */
-    if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL){
-        loadSofaFile(pData->sofa_filepath,
-                     &(pData->hrirs),
-                     &(pData->hrir_dirs_deg),
-                     &(pData->N_hrir_dirs),
-                     &(pData->hrir_len),
-                     &(pData->hrir_fs));
+    /* mix the first range of bands in this thread, along with the ranges of
+     * any workers that failed to start */
+    w = &(pData->mixWorkers[0]);
+    binauraliser_mixSources(hBin, w->bandStart, w->bandEnd, nSources);
+    for(i=1; i<BINAURALISER_MIX_NUM_THREADS; i++){
+        w = &(pData->mixWorkers[i]);
+        if(!w->threadRunning)
+            binauraliser_mixSources(hBin, w->bandStart, w->bandEnd, nSources);
+    }
+    
+    /* wait for the workers to finish */
+    for(i=1; i<BINAURALISER_MIX_NUM_THREADS; i++){
+        w = &(pData->mixWorkers[i]);
+        if(!w->threadRunning)
+            continue;
+#if defined(_WIN32)
+        EnterCriticalSection(&(w->mutex));
+        while(w->jobPending)
+            SleepConditionVariableCS(&(w->cond), &(w->mutex), INFINITE);
+        LeaveCriticalSection(&(w->mutex));
+#else
+        pthread_mutex_lock(&(w->mutex));
+        while(w->jobPending)
+            pthread_cond_wait(&(w->cond), &(w->mutex));
+        pthread_mutex_unlock(&(w->mutex));
+#endif
+    }
+}
+
+void binauraliser_createMixWorkers(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_mixWorker *w;
+    int i;
+    
+    /* share the bands evenly between the threads */
+    for(i=0; i<BINAURALISER_MIX_NUM_THREADS; i++){
+        w = &(pData->mixWorkers[i]);
+        w->hBin = hBin;
+        w->bandStart = (i*HYBRID_BANDS)/BINAURALISER_MIX_NUM_THREADS;
+        w->bandEnd = ((i+1)*HYBRID_BANDS)/BINAURALISER_MIX_NUM_THREADS;
+        w->nSources = 0;
+        w->threadRunning = 0;
+        w->jobPending = 0;
+        w->exitFlag = 0;
+        if(i==0)
+            continue; /* audio thread */
+        
+        /* the bands are mixed in the calling thread if this fails */
+#if defined(_WIN32)
+        InitializeCriticalSection(&(w->mutex));
+        InitializeConditionVariable(&(w->cond));
+        w->thread = CreateThread(NULL, 0, binauraliser_mixWorkerThread, (LPVOID)w, 0, NULL);
+        w->threadRunning = w->thread != NULL ? 1 : 0;
+#else
+        pthread_mutex_init(&(w->mutex), NULL);
+        pthread_cond_init(&(w->cond), NULL);
+        w->threadRunning = pthread_create(&(w->thread), NULL, binauraliser_mixWorkerThread, (void*)w) == 0 ? 1 : 0;
+#endif
+    }
+}
+
+void binauraliser_destroyMixWorkers(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_mixWorker *w;
+    int i;
+    
+    for(i=1; i<BINAURALISER_MIX_NUM_THREADS; i++){
+        w = &(pData->mixWorkers[i]);
+        if(w->threadRunning){
+#if defined(_WIN32)
+            EnterCriticalSection(&(w->mutex));
+            w->exitFlag = 1;
+            WakeAllConditionVariable(&(w->cond));
+            LeaveCriticalSection(&(w->mutex));
+            WaitForSingleObject(w->thread, INFINITE);
+            CloseHandle(w->thread);
+#else
+            pthread_mutex_lock(&(w->mutex));
+            w->exitFlag = 1;
+            pthread_cond_broadcast(&(w->cond));
+            pthread_mutex_unlock(&(w->mutex));
+            pthread_join(w->thread, NULL);
+#endif
+            w->threadRunning = 0;
+        }
+#if defined(_WIN32)
+        DeleteCriticalSection(&(w->mutex));
+#else
+        pthread_mutex_destroy(&(w->mutex));
+        pthread_cond_destroy(&(w->cond));
+#endif
+    }
+}
+
+/** Returns 1 if the background build 'hAsync' (if any) has been cancelled */
+static int binauraliser_isBuildCancelled(void* const hAsync)
+{
+    return hAsync!=NULL && saf_asyncInit_isCancelled(hAsync);
+}
+
+/**
+ * Fits the HRTF magnitudes (per band and ear) and the ITDs of all measurements
+ * with a real SH expansion, via regularised least-squares (see INTERP_SH)
+ *
+ * The order is limited such that there are at least as many measurements as
+ * coefficients, and the higher orders are regularised more strongly; which
+ * keeps the expansion well-behaved over any gaps in the measurement grid.
+ */
+static void binauraliser_fitHRTFsSH
+(
+    binauraliser_hrtfSet* set
+)
+{
+    int i, n, m, nSH, nCol;
+    float reg;
+    float* dirs_rad, *Y, *YYt, *B;
+    
+    set->hrtf_shOrder = MAX(MIN(HRTF_SH_MAX_ORDER, (int)sqrtf((float)set->N_hrir_dirs)-1), 0);
+    nSH = ORDER2NSH(set->hrtf_shOrder);
+    nCol = HYBRID_BANDS*NUM_EARS+1;
+    
+    /* SH basis of the measurement directions */
+    dirs_rad = malloc1d(set->N_hrir_dirs*2*sizeof(float));
+    for(i=0; i<set->N_hrir_dirs; i++){
+        dirs_rad[i*2+0] = DEG2RAD(set->hrir_dirs_deg[i*2+0]);
+        dirs_rad[i*2+1] = PI/2.0f - DEG2RAD(set->hrir_dirs_deg[i*2+1]); /* elevation->inclination */
+    }
+    Y = malloc1d(nSH*(set->N_hrir_dirs)*sizeof(float));
+    getSHreal(set->hrtf_shOrder, dirs_rad, set->N_hrir_dirs, Y);
+    
+    /* normal equations: (Y*Y^T + reg) * coeffs = Y * [mags^T, itds] */
+    YYt = malloc1d(nSH*nSH*sizeof(float));
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, set->N_hrir_dirs, 1.0f,
+                Y, set->N_hrir_dirs,
+                Y, set->N_hrir_dirs, 0.0f,
+                YYt, nSH);
+    reg = 0.0f;
+    for(i=0; i<nSH; i++)
+        reg += YYt[i*nSH+i];
+    reg *= HRTF_SH_REGULARISATION/(float)nSH;
+    for(n=0, i=0; n<=set->hrtf_shOrder; n++)
+        for(m=-n; m<=n; m++, i++)
+            YYt[i*nSH+i] += reg*(float)(1+n*(n+1));
+    B = malloc1d(nSH*nCol*sizeof(float));
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, HYBRID_BANDS*NUM_EARS, set->N_hrir_dirs, 1.0f,
+                Y, set->N_hrir_dirs,
+                set->hrtf_fb_mag, set->N_hrir_dirs, 0.0f,
+                B, nCol);
+    cblas_sgemv(CblasRowMajor, CblasNoTrans, nSH, set->N_hrir_dirs, 1.0f,
+                Y, set->N_hrir_dirs,
+                set->itds_s, 1, 0.0f,
+                &B[HYBRID_BANDS*NUM_EARS], nCol);
+    set->hrtf_shCoeffs = malloc1d(nSH*nCol*sizeof(float));
+    utility_sslslv(NULL, YYt, nSH, B, nCol, set->hrtf_shCoeffs);
+    
+    free(dirs_rad);
+    free(Y);
+    free(YYt);
+    free(B);
+}
+
+void* binauraliser_buildHRTFs
+(
+    void* const hBin,
+    void* const hAsync
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_hrtfSet* set;
+    int i, nGains, useDefaultHRIRs;
+    float freqVector[HYBRID_BANDS];
+    float* gtableComp;
+    
+    set = (binauraliser_hrtfSet*)calloc1d(1, sizeof(binauraliser_hrtfSet));
+    useDefaultHRIRs = pData->useDefaultHRIRsFLAG;
+    set->hrtf_interpMode = pData->interpMode;
+    gtableComp = NULL;
+    nGains = 0;
+    memcpy(freqVector, pData->freqVector, HYBRID_BANDS*sizeof(float));
+    while(1){
+        if(binauraliser_isBuildCancelled(hAsync)){
+            binauraliser_destroyHRTFs(hBin, (void*)set);
+            return NULL;
+        }
+        strcpy(pData->progressBarText,"Loading HRIRs");
+        pData->progressBar0_1 = 0.2f;
+        
+        /* load sofa file or load default hrir data (setting path to NULL loads
+         * default HRIR data), along with the ITDs and the diffuse-field
+         * equalised filterbank HRTFs; which are shared with any other instances
+         * using the same HRIRs */
+        saf_initReport_beginStage("hrtfCache_acquire");
+        hrtfCache_acquire(&(set->hHRTFs), !useDefaultHRIRs ? pData->sofa_filepath : NULL,
+                          freqVector, HYBRID_BANDS);
+        saf_initReport_endStage();
+        hrtfCache_getData(set->hHRTFs, &(set->hrirs), &(set->hrir_dirs_deg), &(set->N_hrir_dirs),
+                          &(set->hrir_len), &(set->hrir_fs), &(set->itds_s), &(set->hrtf_fb), &(set->hrtf_fb_mag));
+        if(binauraliser_isBuildCancelled(hAsync)){
+            binauraliser_destroyHRTFs(hBin, (void*)set);
+            return NULL;
+        }
+        if(set->hrtf_interpMode == INTERP_SH)
+            break; /* (no interpolation table is required) */
+        
+        /* generate the compressed VBAP gain table (i.e. only the 3 non-zero
+         * gains per direction), and convert it into an amplitude-normalised
+         * interpolation table */
+        strcpy(pData->progressBarText,"Generating interpolation table");
+        pData->progressBar0_1 = 0.6f;
+        set->hrtf_vbapTableRes[0] = 2;
+        set->hrtf_vbapTableRes[1] = 5;
+        saf_initReport_beginStage("generateCompressedVBAPgainTable3D");
+        generateCompressedVBAPgainTable3D(set->hrir_dirs_deg, set->N_hrir_dirs, set->hrtf_vbapTableRes[0], set->hrtf_vbapTableRes[1], 1, 0, 0.0f,
+                                          &gtableComp, &(set->hrtf_vbap_gtableIdx), &nGains,
+                                          &(set->N_hrtf_vbap_gtable), &(set->nTriangles));
+        saf_initReport_endStage();
+        set->hrtf_vbap_gtableComp = gtableComp;
+        if(gtableComp==NULL && !useDefaultHRIRs){
+            /* if generating vbap gain tabled failed, re-calculate with default HRIR set */
+            useDefaultHRIRs = pData->useDefaultHRIRsFLAG = 1;
+            hrtfCache_release(&(set->hHRTFs));
+            free1d((void**)&(set->hrtf_vbap_gtableIdx));
+            continue;
+        }
+        break;
+    }
+    set->hrtf_precision = (SAF_STORAGE_PRECISION)pData->hrtfPrecision;
+    set->hrtf_mags = NULL;
+    if(set->hrtf_interpMode == INTERP_SH){
+        /* fit the SH expansion instead (always in single precision; the
+         * coefficients are few, compared to the table) */
+        strcpy(pData->progressBarText,"Fitting SH expansion");
+        pData->progressBar0_1 = 0.6f;
+        saf_initReport_beginStage("binauraliser_fitHRTFsSH");
+        binauraliser_fitHRTFsSH(set);
+        saf_initReport_endStage();
     }
     else{
-        loadSofaFile(NULL, /* setting path to NULL loads default HRIR data */
-                     &(pData->hrirs),
-                     &(pData->hrir_dirs_deg),
-                     &(pData->N_hrir_dirs),
-                     &(pData->hrir_len),
-                     &(pData->hrir_fs));
-    }
-    
-    /* estimate the ITDs for each HRIR */
-    pData->itds_s = realloc1d(pData->itds_s, pData->N_hrir_dirs*sizeof(float));
-    estimateITDs(pData->hrirs, pData->N_hrir_dirs, pData->hrir_len, pData->hrir_fs, pData->itds_s);
-    
-    /* generate VBAP gain table */
-    strcpy(pData->progressBarText,"Generating interpolation table");
-    pData->progressBar0_1 = 0.6f;
-    hrtf_vbap_gtable = NULL;
-    pData->hrtf_vbapTableRes[0] = 2;
-    pData->hrtf_vbapTableRes[1] = 5;
-    generateVBAPgainTable3D(pData->hrir_dirs_deg, pData->N_hrir_dirs, pData->hrtf_vbapTableRes[0], pData->hrtf_vbapTableRes[1], 1, 0, 0.0f,
-                            &hrtf_vbap_gtable, &(pData->N_hrtf_vbap_gtable), &(pData->nTriangles));
-    if(hrtf_vbap_gtable==NULL){
-        /* if generating vbap gain tabled failed, re-calculate with default HRIR set */
-        pData->useDefaultHRIRsFLAG = 1;
-        binauraliser_initHRTFsAndGainTables(hBin);
-    }
-    
-    /* compress VBAP table (i.e. remove the zero elements) */
-    pData->hrtf_vbap_gtableComp = realloc1d(pData->hrtf_vbap_gtableComp, pData->N_hrtf_vbap_gtable * 3 * sizeof(float));
-    pData->hrtf_vbap_gtableIdx  = realloc1d(pData->hrtf_vbap_gtableIdx,  pData->N_hrtf_vbap_gtable * 3 * sizeof(int));
-    compressVBAPgainTable3D(hrtf_vbap_gtable, pData->N_hrtf_vbap_gtable, pData->N_hrir_dirs, pData->hrtf_vbap_gtableComp, pData->hrtf_vbap_gtableIdx);
-    
-    /* convert hrirs to filterbank coefficients */
-    strcpy(pData->progressBarText,"Applying HRIR diffuse-field EQ");
-    pData->progressBar0_1 = 0.8f;
-    pData->hrtf_fb = realloc1d(pData->hrtf_fb, HYBRID_BANDS * NUM_EARS * (pData->N_hrir_dirs)*sizeof(float_complex));
-    HRIRs2FilterbankHRTFs(pData->hrirs, pData->N_hrir_dirs, pData->hrir_len, pData->hrtf_fb);
-    diffuseFieldEqualiseHRTFs(pData->N_hrir_dirs, pData->itds_s, pData->freqVector, HYBRID_BANDS, pData->hrtf_fb);
-    
-    /* calculate magnitude responses */
-    pData->hrtf_fb_mag = realloc1d(pData->hrtf_fb_mag, HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float)); 
-    for(i=0; i<HYBRID_BANDS*NUM_EARS* (pData->N_hrir_dirs); i++)
-        pData->hrtf_fb_mag[i] = cabsf(pData->hrtf_fb[i]);
-    
-    /* clean-up */
-    free1d((void**)&(hrtf_vbap_gtable));
+        VBAPgainTable2InterpTable(gtableComp, set->N_hrtf_vbap_gtable, nGains);
+        
+        /* convert the interpolation table into the requested storage format,
+         * and retrieve the (shared) HRTF magnitudes in that format */
+        if(set->hrtf_precision != SAF_STORAGE_FLOAT32){
+            set->hrtf_vbap_gtableComp = malloc1d(set->N_hrtf_vbap_gtable*3*utility_storagePrecisionBytes(set->hrtf_precision));
+            utility_svpack(gtableComp, set->N_hrtf_vbap_gtable*3, set->hrtf_precision, set->hrtf_vbap_gtableComp);
+            free(gtableComp);
+            set->hrtf_mags = hrtfCache_getMagnitudes(set->hHRTFs, set->hrtf_precision);
+        }
+        
+        /* the interpolated HRTF cache look-up for the new table (empty) */
+        set->hrtf_cacheSlot = malloc1d(set->N_hrtf_vbap_gtable*sizeof(int));
+        for(i=0; i<set->N_hrtf_vbap_gtable; i++)
+            set->hrtf_cacheSlot[i] = -1;
+    }
+    
+    /* binaural decoder for the SH bed of the level-of-detail mode */
+    set->lod_decOrder = 0;
+    set->lod_decMtx = NULL;
+    if(pData->enableLOD || pData->qualityLevel>=1){
+        if(binauraliser_isBuildCancelled(hAsync)){
+            binauraliser_destroyHRTFs(hBin, (void*)set);
+            return NULL;
+        }
+        strcpy(pData->progressBarText,"Computing LOD decoder");
+        pData->progressBar0_1 = 0.8f;
+        saf_initReport_beginStage("getBinauralAmbiDecoderMtx");
+        set->lod_decOrder = pData->lodOrder;
+        set->lod_decMtx = malloc1d(HYBRID_BANDS*NUM_EARS*ORDER2NSH(set->lod_decOrder)*sizeof(float_complex));
+        getBinauralAmbiDecoderMtx(set->hrtf_fb, set->hrir_dirs_deg, set->N_hrir_dirs, HYBRID_BANDS, BINAURAL_DECODER_MAGLS,
+                                  set->lod_decOrder, freqVector, set->itds_s, NULL, 1, 1, set->lod_decMtx);
+        saf_initReport_endStage();
+    }
+    
+    return (void*)set;
+}
+
+void binauraliser_destroyHRTFs
+(
+    void* const hBin,
+    void* hrtfSet
+)
+{
+    binauraliser_hrtfSet* set = (binauraliser_hrtfSet*)hrtfSet;
+    
+    if(set!=NULL){
+        hrtfCache_release(&(set->hHRTFs));
+        free(set->hrtf_vbap_gtableComp);
+        free(set->hrtf_vbap_gtableIdx);
+        free(set->hrtf_cacheSlot);
+        free(set->hrtf_shCoeffs);
+        free(set->lod_decMtx);
+        free(set);
+    }
+}
+
+binauraliser_hrtfSet* binauraliser_copyHRTFs
+(
+    void* const hBin
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_hrtfSet* set;
+    size_t nTableEntries;
+    
+    set = (binauraliser_hrtfSet*)calloc1d(1, sizeof(binauraliser_hrtfSet));
+    
+    /* HRIR data and filterbank HRTFs (shared) */
+    hrtfCache_retain(pData->hHRTFs);
+    set->hHRTFs = pData->hHRTFs;
+    set->hrirs = pData->hrirs;
+    set->hrir_dirs_deg = pData->hrir_dirs_deg;
+    set->N_hrir_dirs = pData->N_hrir_dirs;
+    set->hrir_len = pData->hrir_len;
+    set->hrir_fs = pData->hrir_fs;
+    set->itds_s = pData->itds_s;
+    set->hrtf_fb = pData->hrtf_fb;
+    set->hrtf_fb_mag = pData->hrtf_fb_mag;
+    set->hrtf_precision = pData->hrtf_precision;
+    set->hrtf_mags = pData->hrtf_mags;
+    
+    /* interpolation table (duplicated; it is owned by each instance) */
+    set->hrtf_vbapTableRes[0] = pData->hrtf_vbapTableRes[0];
+    set->hrtf_vbapTableRes[1] = pData->hrtf_vbapTableRes[1];
+    set->N_hrtf_vbap_gtable = pData->N_hrtf_vbap_gtable;
+    set->nTriangles = pData->nTriangles;
+    nTableEntries = (size_t)(pData->N_hrtf_vbap_gtable)*3;
+    if(pData->hrtf_vbap_gtableIdx!=NULL){
+        set->hrtf_vbap_gtableIdx = malloc1d(nTableEntries*sizeof(int));
+        memcpy(set->hrtf_vbap_gtableIdx, pData->hrtf_vbap_gtableIdx, nTableEntries*sizeof(int));
+        set->hrtf_vbap_gtableComp = malloc1d(nTableEntries*utility_storagePrecisionBytes(pData->hrtf_precision));
+        memcpy(set->hrtf_vbap_gtableComp, pData->hrtf_vbap_gtableComp, nTableEntries*utility_storagePrecisionBytes(pData->hrtf_precision));
+        set->hrtf_cacheSlot = malloc1d(pData->N_hrtf_vbap_gtable*sizeof(int));
+        memcpy(set->hrtf_cacheSlot, pData->hrtf_cacheSlot, pData->N_hrtf_vbap_gtable*sizeof(int));
+    }
+    
+    /* SH fit (duplicated) */
+    set->hrtf_interpMode = pData->hrtf_interpMode;
+    set->hrtf_shOrder = pData->hrtf_shOrder;
+    set->hrtf_shCoeffs = NULL;
+    if(pData->hrtf_shCoeffs!=NULL){
+        set->hrtf_shCoeffs = malloc1d(ORDER2NSH(set->hrtf_shOrder)*(HYBRID_BANDS*NUM_EARS+1)*sizeof(float));
+        memcpy(set->hrtf_shCoeffs, pData->hrtf_shCoeffs, ORDER2NSH(set->hrtf_shOrder)*(HYBRID_BANDS*NUM_EARS+1)*sizeof(float));
+    }
+    
+    /* binaural decoder for the SH bed of the level-of-detail mode */
+    set->lod_decOrder = pData->lod_decOrder;
+    set->lod_decMtx = NULL;
+    if(pData->lod_decMtx!=NULL){
+        set->lod_decMtx = malloc1d(HYBRID_BANDS*NUM_EARS*ORDER2NSH(set->lod_decOrder)*sizeof(float_complex));
+        memcpy(set->lod_decMtx, pData->lod_decMtx, HYBRID_BANDS*NUM_EARS*ORDER2NSH(set->lod_decOrder)*sizeof(float_complex));
+    }
+    
+    return set;
+}
+
+void binauraliser_swapHRTFs
+(
+    void* const hBin,
+    binauraliser_hrtfSet* hrtfSet
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_hrtfSet cur;
+    
+    cur.hHRTFs = pData->hHRTFs;
+    cur.hrirs = pData->hrirs;
+    cur.hrir_dirs_deg = pData->hrir_dirs_deg;
+    cur.N_hrir_dirs = pData->N_hrir_dirs;
+    cur.hrir_len = pData->hrir_len;
+    cur.hrir_fs = pData->hrir_fs;
+    cur.hrtf_vbapTableRes[0] = pData->hrtf_vbapTableRes[0];
+    cur.hrtf_vbapTableRes[1] = pData->hrtf_vbapTableRes[1];
+    cur.N_hrtf_vbap_gtable = pData->N_hrtf_vbap_gtable;
+    cur.hrtf_vbap_gtableIdx = pData->hrtf_vbap_gtableIdx;
+    cur.hrtf_vbap_gtableComp = pData->hrtf_vbap_gtableComp;
+    cur.nTriangles = pData->nTriangles;
+    cur.itds_s = pData->itds_s;
+    cur.hrtf_fb = pData->hrtf_fb;
+    cur.hrtf_fb_mag = pData->hrtf_fb_mag;
+    cur.hrtf_precision = pData->hrtf_precision;
+    cur.hrtf_mags = pData->hrtf_mags;
+    cur.hrtf_cacheSlot = pData->hrtf_cacheSlot;
+    cur.hrtf_interpMode = pData->hrtf_interpMode;
+    cur.hrtf_shOrder = pData->hrtf_shOrder;
+    cur.hrtf_shCoeffs = pData->hrtf_shCoeffs;
+    cur.lod_decOrder = pData->lod_decOrder;
+    cur.lod_decMtx = pData->lod_decMtx;
+    
+    pData->hHRTFs = hrtfSet->hHRTFs;
+    pData->hrirs = hrtfSet->hrirs;
+    pData->hrir_dirs_deg = hrtfSet->hrir_dirs_deg;
+    pData->N_hrir_dirs = hrtfSet->N_hrir_dirs;
+    pData->hrir_len = hrtfSet->hrir_len;
+    pData->hrir_fs = hrtfSet->hrir_fs;
+    pData->hrtf_vbapTableRes[0] = hrtfSet->hrtf_vbapTableRes[0];
+    pData->hrtf_vbapTableRes[1] = hrtfSet->hrtf_vbapTableRes[1];
+    pData->N_hrtf_vbap_gtable = hrtfSet->N_hrtf_vbap_gtable;
+    pData->hrtf_vbap_gtableIdx = hrtfSet->hrtf_vbap_gtableIdx;
+    pData->hrtf_vbap_gtableComp = hrtfSet->hrtf_vbap_gtableComp;
+    pData->nTriangles = hrtfSet->nTriangles;
+    pData->itds_s = hrtfSet->itds_s;
+    pData->hrtf_fb = hrtfSet->hrtf_fb;
+    pData->hrtf_fb_mag = hrtfSet->hrtf_fb_mag;
+    pData->hrtf_precision = hrtfSet->hrtf_precision;
+    pData->hrtf_mags = hrtfSet->hrtf_mags;
+    pData->hrtf_cacheSlot = hrtfSet->hrtf_cacheSlot;
+    pData->hrtf_interpMode = hrtfSet->hrtf_interpMode;
+    pData->hrtf_shOrder = hrtfSet->hrtf_shOrder;
+    pData->hrtf_shCoeffs = hrtfSet->hrtf_shCoeffs;
+    pData->lod_decOrder = hrtfSet->lod_decOrder;
+    pData->lod_decMtx = hrtfSet->lod_decMtx;
+    
+    (*hrtfSet) = cur;
+}
+
+void binauraliser_initHRTFsAndGainTables(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    binauraliser_hrtfSet* set;
+    
+    /* a background rebuild would be superseded by this one */
+    saf_asyncInit_cancel(pData->hHRTFsInit);
+    
+    /* build the new HRTFs, and swap them with the old ones */
+    set = (binauraliser_hrtfSet*)binauraliser_buildHRTFs(hBin, NULL);
+    binauraliser_swapHRTFs(hBin, set);
+    binauraliser_destroyHRTFs(hBin, (void*)set);
+    
+    /* the table has changed, so the interpolated HRTF cache is also cleared */
+    binauraliser_resetHRTFcache(hBin);
 }
 
 void binauraliser_initTFT
@@ -171,14 +788,193 @@ void binauraliser_initTFT
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch, nCH, nDirect, nSH;
+    
+    /* the level-of-detail mode is only engaged if it reduces the number of
+     * channels passing through the afSTFT (at reduced quality levels, it is
+     * used regardless of the user setting, with fewer direct sources) */
+    nDirect = MIN(pData->lodNumDirect >> MAX(pData->qualityLevel-1, 0), pData->new_nSources);
+    nSH = ORDER2NSH(pData->lodOrder);
+    if(!(pData->enableLOD || pData->qualityLevel>=1) || nDirect+nSH >= pData->new_nSources)
+        nDirect = nSH = 0;
+    nCH = nSH>0 ? nDirect+nSH : pData->new_nSources;
  
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSources, NUM_EARS, 0, 1);
-    else if(pData->new_nSources!=pData->nSources){
-        afSTFTchannelChange(pData->hSTFT, pData->new_nSources, NUM_EARS);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, nCH, NUM_EARS, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+    else if(nCH!=pData->nCH_STFT){
+        afSTFTchannelChange(pData->hSTFT, nCH, NUM_EARS);
         afSTFTclearBuffers(pData->hSTFT);
     }
+    pData->nCH_STFT = nCH;
+    binauraliser_resizeBuffers(hBin, pData->new_nSources);
     pData->nSources = pData->new_nSources;
+    
+    /* (re)start the LOD mode with all of the sources in the bed */
+    pData->lod_nDirect = nDirect;
+    pData->lod_nSH = nSH;
+    free(pData->lod_frameTD);
+    pData->lod_frameTD = nSH>0 ? (float**)calloc2d(nDirect+nSH, pData->frameSize, sizeof(float)) : NULL;
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++){
+        pData->lod_Ydirs_deg[ch][0] = pData->lod_Ydirs_deg[ch][1] = 1000.0f; /* (i.e. not yet computed) */
+        pData->lod_energy[ch] = 0.0f;
+        pData->lod_slotOf[ch] = pData->lod_slotSrc[ch] = -1;
+        pData->lod_slotState[ch] = LOD_SLOT_STEADY;
+    }
+    
+    /* the bed decoder is built along with the HRTFs */
+    if(nSH>0 && (pData->lod_decMtx==NULL || pData->lod_decOrder!=pData->lodOrder))
+        pData->reInitHRTFsAndGainTables = 1;
+}
+
+void binauraliser_resizeBuffers
+(
+    void* const hBin,
+    int nSources
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch;
+    
+    if(nSources==pData->nSourcesAlloc)
+        return;
+    pData->inputFrameTD = (float**)realloc2d((void**)pData->inputFrameTD, nSources, pData->frameSize, sizeof(float));
+    pData->inputframeTF = (float_complex***)realloc3d((void***)pData->inputframeTF, HYBRID_BANDS, nSources, pData->nTimeSlots, sizeof(float_complex));
+    pData->hrtf_interp = (float_complex*)realloc1d(pData->hrtf_interp, nSources*HYBRID_BANDS*NUM_EARS*sizeof(float_complex));
+    pData->nSourcesAlloc = nSources;
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+        pData->recalc_hrtf_interpFLAG[ch] = 1;
+}
+
+void binauraliser_lodPrepareFrame
+(
+    void* const hBin,
+    int nSources,
+    int enableRotation
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch, s, i, k, n, best, nChanged, nDirect, nSH, frameSize, state;
+    int changed[MAX_NUM_INPUTS], desired[MAX_NUM_INPUTS];
+    float energy, bestScore, w;
+    float score[MAX_NUM_INPUTS], dirs_deg[MAX_NUM_INPUTS][2], Ytmp[LOD_MAX_NUM_SH*MAX_NUM_INPUTS];
+    float (*src_dirs_deg)[2];
+    
+    nDirect = pData->lod_nDirect;
+    nSH = pData->lod_nSH;
+    frameSize = pData->frameSize;
+    src_dirs_deg = enableRotation ? pData->src_dirs_rot_deg : pData->src_dirs_proc_deg;
+    
+    /* SH encoding gains, for the sources which have moved */
+    nChanged = 0;
+    for(ch=0; ch<nSources; ch++){
+        if(pData->lod_Ydirs_deg[ch][0]!=src_dirs_deg[ch][0] || pData->lod_Ydirs_deg[ch][1]!=src_dirs_deg[ch][1]){
+            memcpy(pData->lod_Ydirs_deg[ch], src_dirs_deg[ch], 2*sizeof(float));
+            memcpy(dirs_deg[nChanged], src_dirs_deg[ch], 2*sizeof(float));
+            changed[nChanged++] = ch;
+        }
+    }
+    if(nChanged>0){
+        getRSH_recur(pData->lodOrder, (float*)dirs_deg, nChanged, Ytmp);
+        for(k=0; k<nSH; k++)
+            for(i=0; i<nChanged; i++)
+                pData->lod_Y[k][changed[i]] = Ytmp[k*nChanged+i];
+    }
+    
+    /* smoothed energies, weighted by the priorities (and favouring the sources
+     * already rendered directly, so that similar sources do not keep swapping) */
+    for(ch=0; ch<nSources; ch++){
+        utility_svvdot(pData->inputFrameTD[ch], pData->inputFrameTD[ch], frameSize, &energy);
+        pData->lod_energy[ch] = LOD_ENERGY_SMOOTHING*pData->lod_energy[ch] + (1.0f-LOD_ENERGY_SMOOTHING)*energy;
+        score[ch] = pData->src_priority[ch]*pData->lod_energy[ch];
+        s = pData->lod_slotOf[ch];
+        if(s>=0 && pData->lod_slotState[s]!=LOD_SLOT_FADE_OUT)
+            score[ch] *= LOD_HYSTERESIS;
+        desired[ch] = 0;
+    }
+    
+    /* the crossfades of the previous frame have been completed */
+    for(s=0; s<nDirect; s++){
+        if(pData->lod_slotState[s]==LOD_SLOT_FADE_OUT){
+            pData->lod_slotOf[pData->lod_slotSrc[s]] = -1;
+            pData->lod_slotSrc[s] = -1;
+        }
+        pData->lod_slotState[s] = LOD_SLOT_STEADY;
+    }
+    
+    /* the (up to) nDirect sources with the highest (non-zero) scores */
+    for(i=0; i<nDirect; i++){
+        best = -1;
+        bestScore = 0.0f;
+        for(ch=0; ch<nSources; ch++){
+            if(!desired[ch] && score[ch]>bestScore){
+                best = ch;
+                bestScore = score[ch];
+            }
+        }
+        if(best<0)
+            break;
+        desired[best] = 1;
+    }
+    
+    /* the sources which are no longer among them are faded out of their slots;
+     * and the vacant slots are given to those which are new (the slots fading
+     * out in this frame only become vacant in the next frame) */
+    for(s=0; s<nDirect; s++)
+        if(pData->lod_slotSrc[s]>=0 && !desired[pData->lod_slotSrc[s]])
+            pData->lod_slotState[s] = LOD_SLOT_FADE_OUT;
+    for(ch=0, s=0; ch<nSources; ch++){
+        if(!desired[ch] || pData->lod_slotOf[ch]>=0)
+            continue;
+        while(s<nDirect && pData->lod_slotSrc[s]>=0)
+            s++;
+        if(s==nDirect)
+            break;
+        pData->lod_slotSrc[s] = ch;
+        pData->lod_slotOf[ch] = s;
+        pData->lod_slotState[s] = LOD_SLOT_FADE_IN;
+        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    }
+    
+    /* direct slot signals (with a linear crossfade over the frame, for the
+     * sources moving into or out of their slots) */
+    for(s=0; s<nDirect; s++){
+        ch = pData->lod_slotSrc[s];
+        state = pData->lod_slotState[s];
+        if(ch<0)
+            memset(pData->lod_frameTD[s], 0, frameSize*sizeof(float));
+        else if(state==LOD_SLOT_STEADY)
+            utility_svvcopy(pData->inputFrameTD[ch], frameSize, pData->lod_frameTD[s]);
+        else{
+            for(n=0; n<frameSize; n++){
+                w = (float)(n+1)/(float)frameSize;
+                pData->lod_frameTD[s][n] = (state==LOD_SLOT_FADE_IN ? w : 1.0f-w) * pData->inputFrameTD[ch][n];
+            }
+        }
+    }
+    
+    /* SH bed signals; i.e. one matrix multiplication, with zero gains for the
+     * sources held by the direct slots: bed (nSH x frameSize) = Ybed (nSH x
+     * nSources) * inputFrameTD (nSources x frameSize). Plus the complementary
+     * parts of the sources being crossfaded */
+    for(k=0; k<nSH; k++)
+        for(ch=0; ch<nSources; ch++)
+            pData->lod_Ybed[k][ch] = pData->lod_slotOf[ch]<0 ? pData->lod_Y[k][ch] : 0.0f;
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, frameSize, nSources, 1.0f,
+                (float*)pData->lod_Ybed, MAX_NUM_INPUTS,
+                ADR2D(pData->inputFrameTD), frameSize, 0.0f,
+                pData->lod_frameTD[nDirect], frameSize);
+    for(s=0; s<nDirect; s++){
+        ch = pData->lod_slotSrc[s];
+        state = pData->lod_slotState[s];
+        if(ch<0 || state==LOD_SLOT_STEADY)
+            continue;
+        for(k=0; k<nSH; k++){
+            for(n=0; n<frameSize; n++){
+                w = (float)(n+1)/(float)frameSize;
+                pData->lod_frameTD[nDirect+k][n] += pData->lod_Y[k][ch] * (state==LOD_SLOT_FADE_IN ? 1.0f-w : w) * pData->inputFrameTD[ch][n];
+            }
+        }
+    }
 }
 
 void binauraliser_loadPreset
@@ -38,6 +38,11 @@
 #include <string.h>
 #include "binauraliser.h"
 #include "saf.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -64,9 +69,29 @@ typedef enum _BINAURALISER_PROC_STATUS{
 
 #define HOP_SIZE ( 128 )                                    /* STFT hop size = nBands */
 #define HYBRID_BANDS ( HOP_SIZE + 5 )                       /* hybrid mode incurs an additional 5 bands  */
-#define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16 */
+#define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16; default, see binauraliser_data.nTimeSlots */
 #define MAX_NUM_INPUTS ( BINAURALISER_MAX_NUM_INPUTS )      /* Maximum permited channels for the VST standard */
 #define NUM_EARS ( 2 )                                      /* true for most humans */
+#define HRTF_CACHE_SIZE ( 256 )                             /* number of interpolated HRTF sets to keep in the cache */
+#define HRTF_SH_MAX_ORDER ( SH_FAST_MAX_ORDER )             /* maximum order of the SH fit of the HRTF magnitudes and ITDs (INTERP_SH) */
+#define HRTF_SH_REGULARISATION ( 1e-3f )                    /* order-weighted Tikhonov regularisation of the SH fit (relative to the mean of the diagonal) */
+#define BINAURALISER_PARAM_ORIENTATION ( 0 )                /* yaw, pitch, roll (in radians), and the rotation order flag */
+#define BINAURALISER_PARAM_SOURCE_DIR(i) ( 1 + (i) )        /* azimuth and elevation of source 'i' (in degrees), and its distance (in metres) */
+#define BINAURALISER_PARAM_QUATERNION ( 1 + MAX_NUM_INPUTS ) /* quaternion (w,x,y,z), and its timestamp (split into two floats) */
+#define BINAURALISER_NUM_PARAMS ( 2 + MAX_NUM_INPUTS )      /* number of parameters handed over via the parameter queue */
+#define BINAURALISER_NUM_PARAM_VALUES ( 6 )                 /* maximum number of values per parameter */
+#define BINAURALISER_MAX_PREDICTION_TIME_MS ( 100.0f )      /* maximum of the user prediction time */
+#define NEAR_FIELD_NUM_DISTANCES ( 32 )                     /* number of distances in the near-field compensation table */
+#define NEAR_FIELD_NUM_ANGLES ( 37 )                        /* number of angles (to the ear axis) in the near-field compensation table */
+#define LOD_MAX_NUM_SH ( (BINAURALISER_LOD_MAX_ORDER+1)*(BINAURALISER_LOD_MAX_ORDER+1) ) /* maximum number of SH bed channels */
+#define LOD_ENERGY_SMOOTHING ( 0.8f )                       /* one-pole smoothing (per frame) of the source energies */
+#define LOD_HYSTERESIS ( 2.0f )                             /* score weighting of the sources already rendered directly */
+#define LOD_SLOT_STEADY ( 0 )                               /* direct slot holds its source for the whole frame */
+#define LOD_SLOT_FADE_IN ( 1 )                              /* source is crossfaded from the bed into the slot */
+#define LOD_SLOT_FADE_OUT ( 2 )                             /* source is crossfaded from the slot into the bed */
+#ifndef BINAURALISER_MIX_NUM_THREADS
+# define BINAURALISER_MIX_NUM_THREADS ( 1 )                 /* number of threads (including the audio thread) sharing the per-band source mix */
+#endif
 #ifndef DEG2RAD
 # define DEG2RAD(x) (x * PI / 180.0f)
 #endif
@@ -79,6 +104,61 @@ typedef enum _BINAURALISER_PROC_STATUS{
 /*                                 Structures                                 */
 /* ========================================================================== */
 
+/**
+ * Worker thread for the per-band source mix (see binauraliser_mixSources()).
+ * Each worker mixes its own range of bands, while the audio thread mixes the
+ * first range.
+ */
+typedef struct _binauraliser_mixWorker
+{
+    void* hBin;                   /**< binauraliser handle */
+    int bandStart, bandEnd;       /**< range of bands mixed by this worker */
+    int nSources;                 /**< number of sources for the current job */
+    int threadRunning, jobPending, exitFlag;
+#if defined(_WIN32)
+    HANDLE thread;
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+    
+} binauraliser_mixWorker;
+
+/**
+ * HRIR data, filterbank HRTFs and the VBAP interpolation table (or the SH fit,
+ * for INTERP_SH), which are (re)built together (see binauraliser_buildHRTFs()), and then swapped in/out
+ * of the main structure as one set (see binauraliser_swapHRTFs())
+ */
+typedef struct _binauraliser_hrtfSet
+{
+    void* hHRTFs;                    /**< shared HRIR data; see hrtfCache_acquire() */
+    float* hrirs;
+    float* hrir_dirs_deg;
+    int N_hrir_dirs;
+    int hrir_len;
+    int hrir_fs;
+    int hrtf_vbapTableRes[2];
+    int N_hrtf_vbap_gtable;
+    int* hrtf_vbap_gtableIdx;        /**< N_hrtf_vbap_gtable x 3 */
+    void* hrtf_vbap_gtableComp;      /**< N_hrtf_vbap_gtable x 3; stored as 'hrtf_precision' */
+    int nTriangles;
+    float* itds_s;
+    float_complex* hrtf_fb;
+    float* hrtf_fb_mag;
+    SAF_STORAGE_PRECISION hrtf_precision;
+    void* hrtf_mags;                 /**< shared; see hrtfCache_getMagnitudes() */
+    int* hrtf_cacheSlot;             /**< N_hrtf_vbap_gtable x 1 */
+    INTERP_MODES hrtf_interpMode;
+    int hrtf_shOrder;
+    float* hrtf_shCoeffs;            /**< (hrtf_shOrder+1)^2 x (HYBRID_BANDS*NUM_EARS+1) */
+    int lod_decOrder;                /**< order of 'lod_decMtx'; 0 if not built */
+    float_complex* lod_decMtx;       /**< binaural decoder of the LOD bed; FLAT: HYBRID_BANDS x NUM_EARS x (lod_decOrder+1)^2 */
+    
+} binauraliser_hrtfSet;
+
 /**
  * Main structure for binauraliser. Contains variables for audio buffers,
  * afSTFT, HRTFs, internal variables, flags, user parameters
@@ -86,19 +166,26 @@ typedef enum _BINAURALISER_PROC_STATUS{
 typedef struct _binauraliser
 {
     /* audio buffers */
-    float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
-    float outframeTD[NUM_EARS][FRAME_SIZE];
-    float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUTS][TIME_SLOTS];
-    float_complex outputframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;
-    float** tempHopFrameTD;
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hProfiler; /**< per-stage timing (see saf_profiler.h) */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
+    void* hInitReport; /**< stages of the last initCodec() call (see saf_initReport.h) */
+    int nSourcesAlloc;            /**< number of sources the buffers below are sized for; see binauraliser_resizeBuffers() */
+    int frameSize;                /**< processing frame size of this instance, a multiple of HOP_SIZE (FRAME_SIZE by default) */
+    int nTimeSlots;               /**< frameSize/HOP_SIZE */
+    float** inputFrameTD;         /**< nSourcesAlloc x frameSize */
+    float_complex*** inputframeTF; /**< HYBRID_BANDS x nSourcesAlloc x nTimeSlots */
+    float_complex*** outputframeTF; /**< HYBRID_BANDS x NUM_EARS x nTimeSlots */
+    float_complex*** outputframeTF_prev; /**< HYBRID_BANDS x NUM_EARS x nTimeSlots; output with the previous HRTFs, to crossfade from */
+    float** outputFrameTD;        /**< NUM_EARS x frameSize */
+    int nSourcesMix;              /**< number of sources to mix; i.e. up to the last source that afSTFT did not find to be silent */
     int fs;
     float freqVector[HYBRID_BANDS]; 
     void* hSTFT;
     
     /* sofa file info */
     char* sofa_filepath; 
+    void* hHRTFs;                    /**< shared HRIR data; see hrtfCache_acquire() */
     float* hrirs;
     float* hrir_dirs_deg;
     int N_hrir_dirs;
@@ -109,14 +196,50 @@ typedef struct _binauraliser
     int hrtf_vbapTableRes[2];
     int N_hrtf_vbap_gtable;
     int* hrtf_vbap_gtableIdx;        /**< N_hrtf_vbap_gtable x 3 */
-    float* hrtf_vbap_gtableComp;     /**< N_hrtf_vbap_gtable x 3 */
+    void* hrtf_vbap_gtableComp;      /**< N_hrtf_vbap_gtable x 3; stored as 'hrtf_precision' */
+    
+    /* SH fit of the HRTF magnitudes and ITDs (used instead of the VBAP gain
+     * table for INTERP_SH; see binauraliser_buildHRTFs()) */
+    INTERP_MODES hrtf_interpMode;    /**< interpolation mode the current HRTFs were built for */
+    int hrtf_shOrder;                /**< order of 'hrtf_shCoeffs'; 0 if not built */
+    float* hrtf_shCoeffs;            /**< SH coefficients of the magnitudes (nBands x nCH columns), followed by those of the ITDs (last column); FLAT: (hrtf_shOrder+1)^2 x (HYBRID_BANDS*NUM_EARS+1) */
     
     /* hrir filterbank coefficients */
     int useDefaultHRIRsFLAG; 
     float* itds_s;                   /**< interaural-time differences for each HRIR (in seconds); nBands x 1 */
     float_complex* hrtf_fb;          /**< hrtf filterbank coefficients; nBands x nCH x N_hrirs */
     float* hrtf_fb_mag;              /**< magnitudes of the hrtf filterbank coefficients; nBands x nCH x N_hrirs */
-    float_complex hrtf_interp[MAX_NUM_INPUTS][HYBRID_BANDS][NUM_EARS];
+    SAF_STORAGE_PRECISION hrtf_precision; /**< storage format of 'hrtf_vbap_gtableComp' and 'hrtf_mags' */
+    void* hrtf_mags;                 /**< shared magnitudes in 'hrtf_precision' (NULL for SAF_STORAGE_FLOAT32, which uses 'hrtf_fb_mag'); FLAT: N_hrirs x nBands x nCH */
+    float_complex* hrtf_interp;      /**< interpolated HRTFs for each source; FLAT: nSourcesAlloc x HYBRID_BANDS x NUM_EARS */
+    
+    /* interpolated HRTF cache (least-recently-used sets are evicted first) */
+    float_complex* hrtf_cache;       /**< cached interpolated HRTFs; FLAT: HRTF_CACHE_SIZE x HYBRID_BANDS x NUM_EARS */
+    int hrtf_cacheIdx3d[HRTF_CACHE_SIZE]; /**< VBAP table index held by each cache slot; -1 if empty */
+    unsigned int hrtf_cacheLastUsed[HRTF_CACHE_SIZE]; /**< value of 'hrtf_cacheClock' when each slot was last used */
+    unsigned int hrtf_cacheClock;    /**< incremented for each cache look-up */
+    int* hrtf_cacheSlot;             /**< cache slot for each VBAP table index; -1 if not cached; N_hrtf_vbap_gtable x 1 */
+    
+    /* level-of-detail rendering (see binauraliser_setEnableLOD()) */
+    int nCH_STFT;                    /**< current number of afSTFT input channels; nSources, or lod_nDirect+lod_nSH */
+    int lod_nDirect;                 /**< number of direct slots; 0 if the LOD mode is not engaged */
+    int lod_nSH;                     /**< number of SH bed channels; 0 if the LOD mode is not engaged */
+    float** lod_frameTD;             /**< direct slot signals, followed by the SH bed signals; (lod_nDirect+lod_nSH) x frameSize */
+    int lod_decOrder;                /**< order of 'lod_decMtx'; 0 if not built */
+    float_complex* lod_decMtx;       /**< binaural decoder of the bed; FLAT: HYBRID_BANDS x NUM_EARS x (lod_decOrder+1)^2 */
+    float lod_Y[LOD_MAX_NUM_SH][MAX_NUM_INPUTS]; /**< SH encoding gains of each source (ACN/N3D) */
+    float lod_Ybed[LOD_MAX_NUM_SH][MAX_NUM_INPUTS]; /**< lod_Y, with zeros for the sources held by the direct slots */
+    float lod_Ydirs_deg[MAX_NUM_INPUTS][2]; /**< directions lod_Y was computed for */
+    float lod_energy[MAX_NUM_INPUTS];       /**< smoothed frame energy of each source */
+    int lod_slotOf[MAX_NUM_INPUTS];         /**< direct slot of each source; -1 if only rendered via the bed */
+    int lod_slotSrc[MAX_NUM_INPUTS];        /**< source held by each direct slot; -1 if empty */
+    int lod_slotState[MAX_NUM_INPUTS];      /**< LOD_SLOT_STEADY, LOD_SLOT_FADE_IN, or LOD_SLOT_FADE_OUT */
+    
+    /* source mixing */
+    binauraliser_mixWorker mixWorkers[BINAURALISER_MIX_NUM_THREADS]; /**< [0] refers to the audio thread (no thread is started) */
+    
+    /* background HRTF (re)initialisation */
+    void* hHRTFsInit;                /**< saf_asyncInit handle; builds binauraliser_hrtfSet objects */
     
     /* flags/status */
     BINAURALISER_CODEC_STATUS codecStatus;
@@ -127,6 +250,17 @@ typedef struct _binauraliser
     int reInitHRTFsAndGainTables;
     int recalc_M_rotFLAG;
     
+    /* parameters in use by the processing loop */
+    void* hParamQueue;                          /**< parameter updates for the processing loop (see saf_paramQueue.h) */
+    float src_dirs_proc_deg[MAX_NUM_INPUTS][2]; /**< source directions in use by the processing loop */
+    float src_dist_proc_m[MAX_NUM_INPUTS];      /**< source distances in use by the processing loop */
+    float ypr_proc[3];                          /**< yaw, pitch, roll (in radians) in use by the processing loop */
+    int useRollPitchYawFlag_proc;               /**< rotation order flag in use by the processing loop */
+    float Rxyz_T[3][3];                         /**< transposed rotation matrix corresponding to ypr_proc */
+    void* hOrientPred;                          /**< predicts the orientation from the quaternions (see saf_orientation.h) */
+    int useQuaternion_proc;                     /**< 1: the orientation is predicted from the quaternions, 0: yaw-pitch-roll are used */
+    void* hNearField;                           /**< near-field compensation table (see nearFieldHRTFs_create()) */
+    
     /* misc. */
     float src_dirs_rot_deg[MAX_NUM_INPUTS][2];
     float src_dirs_rot_xyz[MAX_NUM_INPUTS][3];
@@ -139,14 +273,38 @@ typedef struct _binauraliser
     int nSources;
     int new_nSources;
     float src_dirs_deg[MAX_NUM_INPUTS][2];
+    float src_dist_m[MAX_NUM_INPUTS];        /**< source distances, in metres */
+    int enableNearField;                     /**< 1: near-field compensation enabled, 0: disabled */
     INTERP_MODES interpMode;
+    BINAURALISER_HRTF_PRECISION hrtfPrecision; /**< requested storage format; applied when the HRTFs are next (re)built */
     int enableRotation;
     float yaw, roll, pitch;                  /**< rotation angles in degrees */
     int bFlipYaw, bFlipPitch, bFlipRoll;     /**< flag to flip the sign of the individual rotation angles */
     int useRollPitchYawFlag;                 /**< rotation order flag, 1: r-p-y, 0: y-p-r */
+    float predictionTime_ms;                 /**< additional time the quaternions are predicted ahead (e.g. output latency) */
+    int enableLOD;                           /**< 1: level-of-detail mode enabled, 0: disabled */
+    int lodNumDirect;                        /**< number of sources rendered directly in the LOD mode */
+    int lodOrder;                            /**< order of the SH bed in the LOD mode */
+    float src_priority[MAX_NUM_INPUTS];      /**< priority of each source in the LOD mode */
+    int qualityLevel;                        /**< 0: full quality, see binauraliser_setQualityLevel() */
+    int nSceneSources;                       /**< number of sources the mix is normalised by (0: nSources), see binauraliser_setNumSceneSources() */
     
 } binauraliser_data;
 
+/** An offline rendering job, split into segments over the threads of a pool */
+typedef struct _binauraliser_offlineJob
+{
+    void** hWorkers;             /* one binauraliser instance per thread */
+    const float* const* inputs;  /* input signals; nInputs x nSamples */
+    float* const* outputs;       /* output signals; nOutputs x nSamples */
+    int nInputs;                 /* number of input signals */
+    int nOutputs;                /* number of output signals */
+    int nSamples;                /* number of samples per channel */
+    int nPreRollFrames;          /* frames processed before each segment, for the filterbank to settle */
+    int delay;                   /* delay of the filterbank, in samples, which is compensated for */
+    
+} binauraliser_offlineJob;
+
 
 /* ========================================================================== */
 /*                             Internal Functions                             */
@@ -159,36 +317,165 @@ void binauraliser_setCodecStatus(void* const hBin,
                                  BINAURALISER_CODEC_STATUS newStatus);
 
 /**
- * Interpolates between (up to) 3 HRTFs via amplitude-normalised VBAP gains.
+ * Interpolates between (up to) 3 HRTFs via amplitude-normalised VBAP gains
+ * (INTERP_TRI), or evaluates the SH fit of the HRTFs for the given direction
+ * (INTERP_SH).
  *
  * The HRTF magnitude responses and HRIR ITDs are interpolated seperately before
  * re-introducing the phase.
  *
+ * @note For INTERP_TRI, the result only depends on the closest direction in the
+ *       VBAP gain table. Therefore, the interpolated HRTFs are cached per table
+ *       index (computed the first time a direction is requested), so that
+ *       repeated look-ups (e.g. when head-tracking) simply copy the cached set.
+ *       For INTERP_SH, the SH basis of the exact direction is computed, and
+ *       the magnitudes and ITD are obtained as one matrix-vector product with
+ *       'hrtf_shCoeffs'; the cost of which does not depend on the number of
+ *       measured HRIRs (and no table, or cache, is required).
+ *
  * @param[in]  hBin          binauraliser handle
  * @param[in]  azimuth_deg   Source azimuth in DEGREES
  * @param[in]  elevation_deg Source elevation in DEGREES
- * @param[out] h_intrp       Interpolated HRTF
+ * @param[out] h_intrp       Interpolated HRTF; FLAT: HYBRID_BANDS x NUM_EARS
  */
 void binauraliser_interpHRTFs(void* const hBin,
                               float azimuth_deg,
                               float elevation_deg,
-                              float_complex h_intrp[HYBRID_BANDS][NUM_EARS]);
+                              float_complex* h_intrp);
+
+/**
+ * Clears the cache of interpolated HRTFs
+ *
+ * @note Must be called whenever the HRTFs, the VBAP gain table, or the
+ *       frequency vector change
+ */
+void binauraliser_resetHRTFcache(void* const hBin);
+
+/**
+ * Mixes the TF-domain source signals into the binaural output signals, for the
+ * bands bandStart..bandEnd-1
+ *
+ * For each band, the mix is carried out as one complex matrix multiplication:
+ * outputframeTF[band] (NUM_EARS x nTimeSlots) = hrtf_interp^T (NUM_EARS x
+ * nSources) * inputframeTF[band] (nSources x nTimeSlots), which also applies
+ * the 1/sqrt(nSources) scaling.
+ *
+ * @param[in] hBin      binauraliser handle
+ * @param[in] bandStart First band to mix
+ * @param[in] bandEnd   One past the last band to mix
+ * @param[in] nSources  Number of sources
+ */
+void binauraliser_mixSources(void* const hBin,
+                             int bandStart,
+                             int bandEnd,
+                             int nSources);
+
+/**
+ * Mixes all bands (see binauraliser_mixSources()), sharing the bands between
+ * the audio thread and the mix worker threads
+ *
+ * @note If BINAURALISER_MIX_NUM_THREADS is 1 (default), or the workers could
+ *       not be started, then all bands are mixed in the calling thread.
+ *
+ * @param[in] hBin     binauraliser handle
+ * @param[in] nSources Number of sources
+ */
+void binauraliser_mixAllSources(void* const hBin,
+                                int nSources);
+
+/**
+ * Starts the mix worker threads (BINAURALISER_MIX_NUM_THREADS-1 of them)
+ */
+void binauraliser_createMixWorkers(void* const hBin);
+
+/**
+ * Stops the mix worker threads
+ */
+void binauraliser_destroyMixWorkers(void* const hBin);
+
+/**
+ * Builds a new set of HRTFs: either loading the default set or loading from a
+ * SOFA file; and then generating a VBAP gain table for interpolation
+ *
+ * @note This does not modify the HRTFs currently in use, and so it may be
+ *       called from the background initialisation thread (see saf_asyncInit.h)
+ *
+ * @param[in] hBin   binauraliser handle
+ * @param[in] hAsync saf_asyncInit handle, for cancelling the build; may be NULL
+ * @returns   New binauraliser_hrtfSet; or NULL, if the build was cancelled
+ */
+void* binauraliser_buildHRTFs(void* const hBin,
+                              void* const hAsync);
+
+/**
+ * Destroys a set of HRTFs returned by binauraliser_buildHRTFs()
+ */
+void binauraliser_destroyHRTFs(void* const hBin,
+                               void* hrtfSet);
+
+/**
+ * Returns a copy of the HRTFs currently in use (e.g. to swap into a clone, see
+ * binauraliser_clone()); the shared HRIR data is retained rather than copied
+ * (see hrtfCache_retain()), and hence only the interpolation table, the
+ * interpolated HRTF cache look-up and the LOD decoder are duplicated
+ *
+ * @param[in] hBin binauraliser handle (which must be initialised)
+ * @returns   New binauraliser_hrtfSet, to be destroyed with
+ *            binauraliser_destroyHRTFs()
+ */
+binauraliser_hrtfSet* binauraliser_copyHRTFs(void* const hBin);
+
+/**
+ * Exchanges the HRTFs currently in use with those in 'hrtfSet'
+ *
+ * @note binauraliser_resetHRTFcache() must be called afterwards
+ */
+void binauraliser_swapHRTFs(void* const hBin,
+                            binauraliser_hrtfSet* hrtfSet);
 
 /**
  * Initialise the HRTFs: either loading the default set or loading from a SOFA
  * file; and then generate a VBAP gain table for interpolation.
  *
- * @note Call binauraliser_initTFT() (if needed) before calling this function
+ * @note Call binauraliser_initTFT() (if needed) before calling this function.
+ *       Any background (re)initialisation of the HRTFs is cancelled.
  */
 void binauraliser_initHRTFsAndGainTables(void* const hBin);
 
 /**
- * Initialise the filterbank used by binauraliser.
+ * Initialise the filterbank used by binauraliser, and (re)size the buffers to
+ * the new number of sources. The level-of-detail mode is also (re)started, if
+ * it is to be engaged (in which case the filterbank is given the direct slot
+ * and SH bed channels, rather than the sources).
  *
  * @note Call this function before binauraliser_initHRTFsAndGainTables()
  */
 void binauraliser_initTFT(void* const hBin);
 
+/**
+ * (Re)allocates the buffers which scale with the number of sources, if
+ * 'nSources' differs from the number they are currently sized for; so that an
+ * instance only holds the memory required by its current configuration.
+ *
+ * @note Must not be called while processing; all interpolated HRTFs are then
+ *       flagged to be recomputed.
+ */
+void binauraliser_resizeBuffers(void* const hBin,
+                                int nSources);
+
+/**
+ * Selects the sources to render directly in the LOD mode (see
+ * binauraliser_setEnableLOD()), and composes the direct slot signals and the
+ * SH bed signals in lod_frameTD; including the crossfades of the sources
+ * moving between the two paths
+ *
+ * @note Call once per frame, after inputFrameTD has been loaded and the
+ *       source directions have been updated
+ */
+void binauraliser_lodPrepareFrame(void* const hBin,
+                                  int nSources,
+                                  int enableRotation);
+
 /**
  * Returns the source directions for a specified source config preset.
  *
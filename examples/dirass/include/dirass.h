@@ -156,9 +156,16 @@ typedef enum _DIRASS_REASS_MODE {
     REASS_NEAREST,      /**< Each sector beamformer energy is re-assigned to the
                          *   nearest interpolation grid point, based on the
                          *   analysed DoA */
-    REASS_UPSCALE       /**< Each sector beamformer is re-encoded into spherical
+    REASS_UPSCALE,      /**< Each sector beamformer is re-encoded into spherical
                          *   harmonics of a higher order. The map is then
                          *   derived from the upscaled SHs as normal. */
+    REASS_UPSCALE_SPARSE /**< Approximation of REASS_UPSCALE, where the energy
+                         *   of each sector is instead splatted directly onto
+                         *   the nearby scanning grid points, weighted by the
+                         *   (truncated) upscaled beam pattern. This neglects
+                         *   the interference between the re-encoded sectors,
+                         *   but avoids the dense (upscaleOrder+1)^2 x
+                         *   nGrid_dirs projections. */
     
 } DIRASS_REASS_MODES;
     
@@ -197,6 +204,7 @@ typedef enum _DIRASS_CODEC_STATUS{
 }DIRASS_CODEC_STATUS;
 
 #define DIRASS_PROGRESSBARTEXT_CHAR_LENGTH 256
+#define DIRASS_QUALITY_MAX_LEVEL ( 3 ) /**< see dirass_setQualityLevel() */
     
 
 /* ========================================================================== */
@@ -237,6 +245,9 @@ void dirass_initCodec(void* const hDir);
  * Analyses the input spherical harmonic signals to generate an activity-map as
  * in [1]
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples
+ *
  * @param[in] hDir      dirass handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] nInputs   Number of input channels
@@ -255,6 +266,24 @@ void dirass_analysis(void* const hDir,
                      int nInputs,
                      int nSamples,
                      int isPlaying);
+
+/**
+ * Same as dirass_analysis(), but using the (ACN/N3D) time-domain frames of a
+ * shared analysis front-end (see shFrontEnd_create()); which may serve several
+ * analysers of the same spherical harmonic signals
+ *
+ * This function is subscribed to the front-end with needsCov = 0, e.g.: \code
+ *   shFrontEnd_subscribe(hFE, &dirass_analysisFrontEnd, hDir, 0);
+ * \endcode
+ * The front-end must use the same frame size (FRAME_SIZE) and sampling rate as
+ * dirass. Its input format is used instead of the channel order and
+ * normalisation settings of dirass.
+ *
+ * @param[in] hDir   dirass handle
+ * @param[in] hFrame Current frame of the front-end (see shFrontEnd_subscriber)
+ */
+void dirass_analysisFrontEnd(void* const hDir,
+                             const void* hFrame);
     
    
 /* ========================================================================== */
@@ -293,8 +322,8 @@ void dirass_setDisplayGridOption(void* const hDir,  int newOption);
 void dirass_setDispWidth(void* const hDir,  int newValue);
     
 /**
- * Sets the upscale order, if DIRASS_REASS_MODE is set to REASS_UPSCALE,
- * (see UPSCALE_ORDER enum).
+ * Sets the upscale order, if DIRASS_REASS_MODE is set to REASS_UPSCALE or
+ * REASS_UPSCALE_SPARSE (see UPSCALE_ORDER enum).
  */
 void dirass_setUpscaleOrder(void* const hDir,  int newOrder);
     
@@ -343,10 +372,57 @@ void dirass_setAspectRatio(void* const hDir, int newOption);
  */
 void dirass_setMapAvgCoeff(void* const hDir, float newValue);
     
+/**
+ * Sets the number of threads over which the per-sector DoA estimation is split
+ * ('1' single-threaded, or '0' for one thread per CPU core); which is applied
+ * upon re-initialisation
+ */
+void dirass_setNumThreads(void* const hDir, int newValue);
+
+/**
+ * Enables/Disables grid refinement: '1' only the sectors with energy above the
+ * refinement threshold have their DoA estimated (and are re-assigned), while
+ * the others keep their own look direction; '0' all sectors are re-assigned
+ * (default)
+ *
+ * @note Has no effect in the REASS_MODE_OFF mode
+ */
+void dirass_setGridRefinement(void* const hDir, int newState);
+
+/**
+ * Sets the sector energy threshold, relative to the range of sector energies
+ * in each frame, above which sectors are refined, 0..1 (see
+ * dirass_setGridRefinement())
+ */
+void dirass_setRefinementThreshold(void* const hDir, float newValue);
+
+/**
+ * Sets the maximum number of activity-maps generated per second ('0': one per
+ * frame)
+ */
+void dirass_setMaxUpdateRate(void* const hDir, float newValue);
+    
 /**
  * Informs dirass that it should compute a new activity-map
  */
 void dirass_requestPmapUpdate(void* const hDir);
+
+/**
+ * Sets the quality level (0..DIRASS_QUALITY_MAX_LEVEL), with which the cost
+ * of the analysis may be reduced when the CPU is overloaded (see also
+ * saf_qualityControl.h); the user parameters are left untouched
+ *  - 0: full quality
+ *  - 1: the activity-map update rate is halved
+ *  - 2: also, only the sectors above the refinement threshold are re-assigned
+ *       (dirass_setGridRefinement()), regardless of its setting
+ *  - 3: also, the update rate is quartered (rather than halved)
+ *
+ * @note May be called from any thread; the level takes effect from the next
+ *       activity-map, without re-initialising the codec. (The analysis order
+ *       is not reduced, as the sector and upscaling beamformers are designed
+ *       for the current orders)
+ */
+void dirass_setQualityLevel(void* const hDir, int newLevel);
     
 
 /* ========================================================================== */
@@ -462,10 +538,43 @@ int dirass_getAspectRatio(void* const hDir);
  */
 float dirass_getMapAvgCoeff(void* const hDir);
     
+/**
+ * Returns the number of threads that are actually in use for the per-sector DoA
+ * estimation
+ */
+int dirass_getNumThreads(void* const hDir);
+
+/**
+ * Returns '1' if grid refinement is enabled, '0' if disabled (see
+ * dirass_setGridRefinement())
+ */
+int dirass_getGridRefinement(void* const hDir);
+
+/**
+ * Returns the sector energy threshold above which sectors are refined, 0..1
+ */
+float dirass_getRefinementThreshold(void* const hDir);
+
+/**
+ * Returns the maximum number of activity-maps generated per second ('0': one
+ * per frame)
+ */
+float dirass_getMaxUpdateRate(void* const hDir);
+
+/**
+ * Returns the current quality level (0: full quality)
+ */
+int dirass_getQualityLevel(void* const hDir);
+    
 /**
  * Returns the latest computed activity-map if it is ready; otherwise it returns
  * 0, and you'll just have to wait a bit  
  *
+ * The activity-maps are handed over from the processing thread via a lock-free
+ * ring buffer, and the returned map is not written to until the next call to
+ * this function; so it may be read at the caller's own rate. If this function
+ * is not called for a while, then no new maps are generated.
+ *
  * @param[in]  hDir        (&) dirass handle
  * @param[out] grid_dirs   (&) scanning grid directions, in DEGREES; nDirs x 1
  * @param[out] pmap        (&) activity-map values; nDirs x 1
@@ -484,6 +593,27 @@ int dirass_getPmap(void* const hDir,
                    int* hfov,
                    float* aspectRatio);
 
+/**
+ * Returns the time (in seconds of processed audio) at which the activity-map
+ * last returned by dirass_getPmap() was generated
+ */
+double dirass_getPmapTimestamp(void* const hDir);
+
+/**
+ * Returns the delay of the analysis in samples, i.e. by how much the
+ * activity-maps lag behind the input signals (may be used for aligning them
+ * with the output of other processors); which is the latency of the FIFO, if
+ * the host block size is not a multiple of FRAME_SIZE
+ */
+int dirass_getProcessingDelay(void* const hDir);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* dirass_getTelemetry(void* const hDir);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -45,7 +45,6 @@ void dirass_create
 {
     dirass_data* pData = (dirass_data*)malloc1d(sizeof(dirass_data));
     *phDir = (void*)pData;
-    int i;
     
     /* codec data */
     pData->pars = (dirass_codecPars*)malloc1d(sizeof(dirass_codecPars));
@@ -54,6 +53,11 @@ void dirass_create
     pars->interp_dirs_rad = NULL;
     pars->Y_up = NULL;
     pars->interp_table = NULL;
+    pars->hInterpGridIdx = NULL;
+    pars->grid_xyz = NULL;
+    pars->hGridIdx = NULL;
+    pars->nbr_offset = NULL;
+    pars->nbr_idx = NULL;
     pars->w = NULL;
     pars->Cw = NULL;
     pars->Uw = NULL;
@@ -64,6 +68,13 @@ void dirass_create
     pars->est_dirs_idx = NULL;
     pars->prev_intensity = NULL;
     pars->prev_energy = NULL;
+    pars->sec_energy = NULL;
+    pars->active_idx = NULL;
+    
+    /* multi-threading */
+    pData->hParFor = NULL;
+    pData->nThreads = SAF_PARFOR_NUM_THREADS_AUTO;
+    pData->nThreadsInUse = 1;
     
     /* internal */
     pData->progressBar0_1 = 0.0f;
@@ -74,9 +85,10 @@ void dirass_create
 
     /* display */
     pData->pmap = NULL;
-    for(i=0; i<NUM_DISP_SLOTS; i++)
-        pData->pmap_grid[i] = NULL;
-    pData->pmapReady = 0;
+    pData->hPmapRing = NULL;
+    pData->frameTime_s = 0.0;
+    pData->pmapTimestamp_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
     pData->recalcPmap = 1;
     
     /* Default user parameters */
@@ -86,6 +98,7 @@ void dirass_create
     pData->upscaleOrder = pData->new_upscaleOrder = UPSCALE_ORDER_TENTH;
     pData->gridOption = GRID_GEOSPHERE_8;
     pData->pmapAvgCoeff = 0.666f;
+    pData->maxUpdateRate = 0.0f;
     pData->minFreq_hz = 100.0f;
     pData->maxFreq_hz = 8e3f;
     pData->dispWidth = 120;
@@ -93,6 +106,13 @@ void dirass_create
     pData->norm = NORM_SN3D;
     pData->HFOVoption = HFOV_360;
     pData->aspectRatioOption = ASPECT_RATIO_2_1;
+    pData->gridRefinement = 0;
+    pData->qualityLevel = 0;
+    pData->refineThreshold = 0.1f;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_INPUT_SH_SIGNALS, 0);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void dirass_destroy
@@ -102,7 +122,6 @@ void dirass_destroy
 {
     dirass_data *pData = (dirass_data*)(*phDir);
     dirass_codecPars* pars = pData->pars;
-    int i;
     
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -113,12 +132,16 @@ void dirass_destroy
         
         if(pData->pmap!=NULL)
             free(pData->pmap);
-        for(i=0; i<NUM_DISP_SLOTS; i++)
-            free(pData->pmap_grid[i]);
+        saf_frameRing_destroy(&(pData->hPmapRing));
         
         free(pars->interp_dirs_deg);
         free(pars->Y_up);
         free(pars->interp_table);
+        findClosestGridPoints_destroyIndex(&(pars->hInterpGridIdx));
+        free(pars->grid_xyz);
+        findClosestGridPoints_destroyIndex(&(pars->hGridIdx));
+        free(pars->nbr_offset);
+        free(pars->nbr_idx);
         free(pars->ss);
         free(pars->ssxyz);
         free(pars->Cxyz);
@@ -128,9 +151,14 @@ void dirass_destroy
         free(pars->est_dirs);
         free(pars->prev_intensity);
         free(pars->prev_energy);
+        free(pars->sec_energy);
+        free(pars->active_idx);
         
         free(pData->pars);
         free(pData->progressBarText);
+        saf_parfor_destroy(&(pData->hParFor));
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
         free(pData);
         pData = NULL;
     }
@@ -154,8 +182,8 @@ void dirass_init
         memset(pars->prev_energy, 0, pars->grid_nDirs*sizeof(float));
     memset(pData->Wz12_hpf, 0, MAX_NUM_INPUT_SH_SIGNALS*2*sizeof(float));
     memset(pData->Wz12_lpf, 0, MAX_NUM_INPUT_SH_SIGNALS*2*sizeof(float));
-    pData->pmapReady = 0;
-    pData->dispSlotIdx = 0;
+    pData->frameTime_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
 }
 
 void dirass_initCodec
@@ -177,8 +205,10 @@ void dirass_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
     
     dirass_initAna(hDir);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -187,40 +217,101 @@ void dirass_initCodec
 }
 
 
-void dirass_analysis
+/**
+ * Estimates the DoA of the sector signals (pars->ss) for the active sectors
+ * pars->active_idx[first..last-1]; called via saf_parfor_run() with per-thread
+ * velocity buffers
+ */
+static void dirass_sectorDoA
 (
-    void  *  const hDir,
-    float ** const inputs,
-    int            nInputs,
-    int            nSamples,
-    int            isPlaying
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    dirass_data *pData = (dirass_data*)(hCtx);
+    dirass_codecPars* pars = pData->pars;
+    int i, j, k, n, nSH;
+    float pmapAvgCoeff;
+    float intensity[3];
+    float* ssxyz;
+    
+    nSH = pData->job_nSH;
+    pmapAvgCoeff = pData->job_pmapAvgCoeff;
+    ssxyz = &(pars->ssxyz[threadIndex*3*FRAME_SIZE]);
+    for(n=first; n<last; n++){
+        i = pars->active_idx[n];
+        
+        /* beamforming to get velocity patterns */
+        cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, 3, FRAME_SIZE, nSH, 1.0f,
+                    &(pars->Cxyz[i*nSH*3]), 3,
+                    (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
+                    ssxyz, FRAME_SIZE);
+        
+        /* take the sum or mean ss.*ssxyz, to get intensity vector */
+        memset(intensity, 0, 3*sizeof(float));
+        for(k=0; k<3; k++){ 
+            for(j=0; j<FRAME_SIZE; j++)
+                intensity[k] += ssxyz[k*FRAME_SIZE + j] * pars->ss[i*FRAME_SIZE+j];
+            intensity[k] /= (float)FRAME_SIZE;
+            
+            /* average over time */
+            intensity[k] = pmapAvgCoeff * (pars->prev_intensity[i*3+k]) + (1.0f-pmapAvgCoeff) * intensity[k];
+            pars->prev_intensity[i*3+k] = intensity[k];
+        }
+
+        /* extract DoA [azi elev] convention */
+        pars->est_dirs[i*2] = atan2f(intensity[1], intensity[0]);
+        pars->est_dirs[i*2+1] = atan2f(intensity[2], sqrtf(powf(intensity[0], 2.0f) + powf(intensity[1], 2.0f)));
+        if(pData->job_DirAssMode==REASS_UPSCALE)
+            pars->est_dirs[i*2+1] = M_PI/2.0f - pars->est_dirs[i*2+1]; /* convert to inclination */
+    }
+}
+
+/**
+ * Analyses one frame of FRAME_SIZE samples, given in the specified channel
+ * ordering and normalisation conventions
+ */
+static void dirass_analyseFrame
+(
+    void  *  const    hDir,
+    float ** const    inputs,
+    int               nInputs,
+    DIRASS_CH_ORDER   chOrdering,
+    DIRASS_NORM_TYPES norm
 )
 {
     dirass_data *pData = (dirass_data*)(hDir);
     dirass_codecPars* pars = pData->pars;
-    int i, j, k, n, ch, sec_nSH, secOrder, nSH, up_nSH;
+    int i, j, n, ch, sec_nSH, secOrder, nSH, up_nSH, nActive, ind, kidx;
     int o[MAX_INPUT_SH_ORDER+2];
-    float intensity[3];
+    float minEnergy, maxEnergy, thresh, kpos;
+    float est_xyz[3];
+    float* pmap_grid;
     
     /* local parameters */
-    int inputOrder, DirAssMode, upscaleOrder;
-    float pmapAvgCoeff, minFreq_hz, maxFreq_hz;
-    DIRASS_NORM_TYPES norm;
-    DIRASS_CH_ORDER chOrdering;
+    int inputOrder, DirAssMode, upscaleOrder, gridRefinement, qualityLevel;
+    float pmapAvgCoeff, minFreq_hz, maxFreq_hz, refineThreshold, maxUpdateRate;
     
     /* The main processing: */
-    if (nSamples == FRAME_SIZE && (pData->codecStatus==CODEC_STATUS_INITIALISED) && isPlaying ) {
+    if (pData->codecStatus==CODEC_STATUS_INITIALISED) {
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
         
         /* copy current parameters to be thread safe */
         for(n=0; n<MAX_INPUT_SH_ORDER+2; n++){  o[n] = n*n;  }
-        norm = pData->norm;
-        chOrdering = pData->chOrdering;
         pmapAvgCoeff = pData->pmapAvgCoeff;
+        maxUpdateRate = pData->maxUpdateRate;
+        qualityLevel = pData->qualityLevel;
+        if(qualityLevel>=1) /* (reduced at reduced quality levels) */
+            maxUpdateRate = (qualityLevel>=3 ? 0.25f : 0.5f)*(maxUpdateRate>0.0f ? maxUpdateRate : (float)pData->fs/(float)FRAME_SIZE);
         DirAssMode = pData->DirAssMode;
         upscaleOrder = pData->upscaleOrder;
         minFreq_hz = pData->minFreq_hz;
         maxFreq_hz = pData->maxFreq_hz;
+        gridRefinement = pData->gridRefinement || qualityLevel>=2;
+        refineThreshold = pData->refineThreshold;
         inputOrder = pData->inputOrder;
         secOrder = inputOrder-1;
         nSH = (inputOrder+1)*(inputOrder+1);
@@ -271,9 +362,13 @@ void dirass_analysis
         }
         
         /* update the dirass powermap */
-        if(pData->recalcPmap==1){
+        pData->frameTime_s += (double)FRAME_SIZE/(double)pData->fs;
+        if(pData->recalcPmap==1 &&
+           (maxUpdateRate<=0.0f || pData->frameTime_s-pData->lastUpdateTime_s >= 1.0/(double)maxUpdateRate - 1e-9) &&
+           saf_frameRing_hasConsumer(pData->hPmapRing, pData->frameTime_s)){
             pData->recalcPmap = 0;
-            pData->pmapReady = 0;
+            pData->lastUpdateTime_s = pData->frameTime_s;
+            pmap_grid = saf_frameRing_beginWrite(pData->hPmapRing);
             
             /* filter input signals */
             float b[3], a[3];
@@ -285,38 +380,44 @@ void dirass_analysis
                 applyBiQuadFilter(b, a, pData->Wz12_lpf[i], pData->SHframeTD[i], FRAME_SIZE);
             
             /* DoA estimation for each spatially-localised sector */
-            if(DirAssMode==REASS_UPSCALE || DirAssMode==REASS_NEAREST){
+            if(DirAssMode==REASS_UPSCALE || DirAssMode==REASS_UPSCALE_SPARSE || DirAssMode==REASS_NEAREST){
                 /* Beamform using the sector patterns */
                 cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->grid_nDirs, FRAME_SIZE, sec_nSH, 1.0f,
                             pars->Cw, sec_nSH,
                             (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
                             pars->ss, FRAME_SIZE);
                 
+                /* with grid refinement, only the sectors with energy above the
+                 * threshold are re-assigned; the others keep their own look
+                 * direction (and forget their intensity history) */
+                minEnergy = maxEnergy = thresh = 0.0f;
+                if(gridRefinement){
+                    for(i=0; i<pars->grid_nDirs; i++)
+                        pars->sec_energy[i] = cblas_sdot(FRAME_SIZE, &(pars->ss[i*FRAME_SIZE]), 1, &(pars->ss[i*FRAME_SIZE]), 1);
+                    utility_siminv(pars->sec_energy, pars->grid_nDirs, &ind);
+                    minEnergy = pars->sec_energy[ind];
+                    utility_simaxv(pars->sec_energy, pars->grid_nDirs, &ind);
+                    maxEnergy = pars->sec_energy[ind];
+                    thresh = minEnergy + refineThreshold*(maxEnergy-minEnergy);
+                }
+                nActive = 0;
                 for(i=0; i<pars->grid_nDirs; i++){
-                    /* beamforming to get velocity patterns */
-                    cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, 3, FRAME_SIZE, nSH, 1.0f,
-                                &(pars->Cxyz[i*nSH*3]), 3,
-                                (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
-                                pars->ssxyz, FRAME_SIZE);
-                    
-                    /* take the sum or mean ss.*ssxyz, to get intensity vector */
-                    memset(intensity, 0, 3*sizeof(float));
-                    for(k=0; k<3; k++){ 
-                        for(j=0; j<FRAME_SIZE; j++)
-                            intensity[k] += pars->ssxyz[k*FRAME_SIZE + j] * pars->ss[i*FRAME_SIZE+j];
-                        intensity[k] /= (float)FRAME_SIZE;
-                        
-                        /* average over time */
-                        intensity[k] = pmapAvgCoeff * (pars->prev_intensity[i*3+k]) + (1.0f-pmapAvgCoeff) * intensity[k];
-                        pars->prev_intensity[i*3+k] = intensity[k];
+                    if(!gridRefinement || (maxEnergy>minEnergy && pars->sec_energy[i]>=thresh))
+                        pars->active_idx[nActive++] = i;
+                    else{
+                        pars->est_dirs[i*2] = pars->grid_dirs_rad[i];
+                        pars->est_dirs[i*2+1] = pars->grid_dirs_rad[pars->grid_nDirs+i];
+                        if(DirAssMode==REASS_UPSCALE)
+                            pars->est_dirs[i*2+1] = M_PI/2.0f - pars->est_dirs[i*2+1]; /* convert to inclination */
+                        memset(&(pars->prev_intensity[i*3]), 0, 3*sizeof(float));
                     }
-
-                    /* extract DoA [azi elev] convention */
-                    pars->est_dirs[i*2] = atan2f(intensity[1], intensity[0]);
-                    pars->est_dirs[i*2+1] = atan2f(intensity[2], sqrtf(powf(intensity[0], 2.0f) + powf(intensity[1], 2.0f)));
-                    if(DirAssMode==REASS_UPSCALE)
-                        pars->est_dirs[i*2+1] = M_PI/2.0f - pars->est_dirs[i*2+1]; /* convert to inclination */
                 }
+                
+                /* intensity-based DoA estimate per active sector; split over the threads */
+                pData->job_nSH = nSH;
+                pData->job_DirAssMode = DirAssMode;
+                pData->job_pmapAvgCoeff = pmapAvgCoeff;
+                saf_parfor_run(pData->hParFor, &dirass_sectorDoA, hDir, nActive);
             }
             
             /* Obtain pmap/upscaled pmap in the case of REASS_MODE_OFF and REASS_UPSCALE modes, respectively.
@@ -346,12 +447,12 @@ void dirass_analysis
                     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
                                 pars->interp_table, pars->grid_nDirs,
                                 pData->pmap, 1, 0.0f,
-                                pData->pmap_grid[pData->dispSlotIdx], 1);
+                                pmap_grid, 1);
                     break;
                     
                 case REASS_UPSCALE:
                     /* upscale */
-                    getSHreal_recur(upscaleOrder, pars->est_dirs, pars->grid_nDirs, pars->Y_up);
+                    getSHreal_fast(upscaleOrder, pars->est_dirs, pars->grid_nDirs, pars->Y_up);
                     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, up_nSH, FRAME_SIZE, pars->grid_nDirs, 1.0f,
                                 pars->Y_up, pars->grid_nDirs,
                                 pars->ss, FRAME_SIZE, 0.0f,
@@ -379,13 +480,51 @@ void dirass_analysis
                     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
                                 pars->interp_table, pars->grid_nDirs,
                                 pData->pmap, 1, 0.0f,
-                                pData->pmap_grid[pData->dispSlotIdx], 1);
+                                pmap_grid, 1);
+                    break;
+                    
+                case REASS_UPSCALE_SPARSE:
+                    /* sector energies */
+                    for(i=0; i<pars->grid_nDirs; i++)
+                        pars->sec_energy[i] = cblas_sdot(FRAME_SIZE, &(pars->ss[i*FRAME_SIZE]), 1, &(pars->ss[i*FRAME_SIZE]), 1);
+                    
+                    /* splat each sector energy onto the grid points around its DoA, weighted by the kernel */
+                    findClosestGridPoints_query(pars->hGridIdx, pars->est_dirs, pars->grid_nDirs, 0, pars->est_dirs_idx, NULL, NULL);
+                    memset(pData->pmap, 0, pars->grid_nDirs *sizeof(float));
+                    for(i=0; i<pars->grid_nDirs; i++){
+                        est_xyz[0] = cosf(pars->est_dirs[i*2+1])*cosf(pars->est_dirs[i*2]);
+                        est_xyz[1] = cosf(pars->est_dirs[i*2+1])*sinf(pars->est_dirs[i*2]);
+                        est_xyz[2] = sinf(pars->est_dirs[i*2+1]);
+                        ind = pars->est_dirs_idx[i];
+                        for(n=pars->nbr_offset[ind]; n<pars->nbr_offset[ind+1]; n++){
+                            j = pars->nbr_idx[n];
+                            kpos = (est_xyz[0]*pars->grid_xyz[j*3] + est_xyz[1]*pars->grid_xyz[j*3+1] +
+                                    est_xyz[2]*pars->grid_xyz[j*3+2] - pars->kernel_cosMin) * pars->kernel_scale;
+                            if(kpos<0.0f)
+                                continue;
+                            kidx = MIN((int)kpos, SPARSE_KERNEL_TABLE_SIZE-2);
+                            kpos = MIN(kpos-(float)kidx, 1.0f);
+                            pData->pmap[j] += (pars->kernel[kidx] + kpos*(pars->kernel[kidx+1]-pars->kernel[kidx])) * pars->sec_energy[i];
+                        }
+                    }
+                    
+                    /* average energy over time */
+                    for(i=0; i<pars->grid_nDirs; i++){
+                        pData->pmap[i] = pmapAvgCoeff * (pars->prev_energy[i]) + (1.0f-pmapAvgCoeff) * (pData->pmap[i]);
+                        pars->prev_energy[i] = pData->pmap[i];
+                    }
+                    
+                    /* interpolate the pmap */
+                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
+                                pars->interp_table, pars->grid_nDirs,
+                                pData->pmap, 1, 0.0f,
+                                pmap_grid, 1);
                     break;
                  
                 case REASS_NEAREST:
                     /* Assign the sector energies to the nearest display grid point */
-                    findClosestGridPoints(pars->interp_dirs_rad, pars->interp_nDirs, pars->est_dirs, pars->grid_nDirs, 0, pars->est_dirs_idx, NULL, NULL);
-                    memset(pData->pmap_grid[pData->dispSlotIdx], 0, pars->interp_nDirs * sizeof(float));
+                    findClosestGridPoints_query(pars->hInterpGridIdx, pars->est_dirs, pars->grid_nDirs, 0, pars->est_dirs_idx, NULL, NULL);
+                    memset(pmap_grid, 0, pars->interp_nDirs * sizeof(float));
                     for(i=0; i< pars->grid_nDirs; i++)
                         for(j=0; j<FRAME_SIZE; j++)
                             pData->pmap[i] = (pars->ss[i*FRAME_SIZE+j])*(pars->ss[i*FRAME_SIZE+j]); 
@@ -394,33 +533,97 @@ void dirass_analysis
                     for(i=0; i<pars->grid_nDirs; i++){
                         pData->pmap[i] = pmapAvgCoeff * (pars->prev_energy[i]) + (1.0f-pmapAvgCoeff) * (pData->pmap[i]);
                         pars->prev_energy[i] = pData->pmap[i];
-                        pData->pmap_grid[pData->dispSlotIdx][pars->est_dirs_idx[i]] += pData->pmap[i];
+                        pmap_grid[pars->est_dirs_idx[i]] += pData->pmap[i];
                     }
                     break;
             }
              
             /* ascertain the minimum and maximum values for pmap colour scaling */
-            int ind;
-            utility_siminv(pData->pmap_grid[pData->dispSlotIdx], pars->interp_nDirs, &ind);
-            pData->pmap_grid_minVal = pData->pmap_grid[pData->dispSlotIdx][ind];
-            utility_simaxv(pData->pmap_grid[pData->dispSlotIdx], pars->interp_nDirs, &ind);
-            pData->pmap_grid_maxVal = pData->pmap_grid[pData->dispSlotIdx][ind];
+            utility_siminv(pmap_grid, pars->interp_nDirs, &ind);
+            pData->pmap_grid_minVal = pmap_grid[ind];
+            utility_simaxv(pmap_grid, pars->interp_nDirs, &ind);
+            pData->pmap_grid_maxVal = pmap_grid[ind];
 
             /* normalise the pmap to 0..1 */
             for(i=0; i<pars->interp_nDirs; i++)
-                pData->pmap_grid[pData->dispSlotIdx][i] = (pData->pmap_grid[pData->dispSlotIdx][i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
+                pmap_grid[i] = (pmap_grid[i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
 
-            /* signify that the pmap in the current slot is ready for plotting */
-            pData->dispSlotIdx++;
-            if(pData->dispSlotIdx>=NUM_DISP_SLOTS)
-                pData->dispSlotIdx = 0;
-            pData->pmapReady = 1;
+            /* publish the pmap for plotting */
+            saf_frameRing_endWrite(pData->hPmapRing, pData->frameTime_s);
         }
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
+    else
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void dirass_analysisFrame
+(
+    void  *  const hDir,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    
+    dirass_analyseFrame(hDir, inputs, nInputs, pData->chOrdering, pData->norm);
+}
+
+void dirass_analysisFrontEnd
+(
+    void  *  const hDir,
+    const void *   hFrame
+)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    const shFrontEnd_frame* frame = (const shFrontEnd_frame*)hFrame;
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    /* (the front-end has already converted the signals to ACN/N3D) */
+    if (frame->frameSize == FRAME_SIZE)
+        dirass_analyseFrame(hDir, frame->TD, ORDER2NSH(frame->order), CH_ACN, NORM_N3D);
+    else
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_BLOCK_SIZE);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void dirass_analysis
+(
+    void  *  const hDir,
+    float ** const inputs,
+    int            nInputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    if(isPlaying)
+        saf_fifo_process(pData->hFIFO, inputs, NULL, nInputs, 0, nSamples, &dirass_analysisFrame, hDir);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
 /* SETS */
  
 void dirass_refreshSettings(void* const hDir)
@@ -486,7 +689,8 @@ void dirass_setDiRAssMode(void* const hDir,  int newMode)
         pData->DirAssMode = newMode;
         if(pars->prev_intensity!=NULL)
             memset(pars->prev_intensity, 0, pars->grid_nDirs*3*sizeof(float));
-        memset(pars->prev_energy, 0, pars->grid_nDirs*sizeof(float));
+        if(pars->prev_energy!=NULL)
+            memset(pars->prev_energy, 0, pars->grid_nDirs*sizeof(float));
     }
 }
 
@@ -540,6 +744,40 @@ void dirass_setMapAvgCoeff(void* const hDir, float newValue)
     pData->pmapAvgCoeff = MIN(MAX(0.0f, newValue), 0.999f);
 }
 
+void dirass_setNumThreads(void* const hDir, int newValue)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    newValue = newValue < 0 ? 0 : newValue;
+    if(pData->nThreads != newValue){
+        pData->nThreads = newValue;
+        dirass_setCodecStatus(hDir, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void dirass_setGridRefinement(void* const hDir, int newState)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    pData->gridRefinement = newState ? 1 : 0;
+}
+
+void dirass_setRefinementThreshold(void* const hDir, float newValue)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    pData->refineThreshold = MIN(MAX(0.0f, newValue), 1.0f);
+}
+
+void dirass_setMaxUpdateRate(void* const hDir, float newValue)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    pData->maxUpdateRate = MAX(0.0f, newValue);
+}
+
+void dirass_setQualityLevel(void* const hDir, int newLevel)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    pData->qualityLevel = CLAMP(newLevel, 0, DIRASS_QUALITY_MAX_LEVEL);
+}
+
 void dirass_requestPmapUpdate(void* const hDir)
 {
     dirass_data *pData = (dirass_data*)(hDir);
@@ -657,13 +895,47 @@ float dirass_getMapAvgCoeff(void* const hDir)
     return pData->pmapAvgCoeff;
 }
 
+int dirass_getNumThreads(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->nThreadsInUse;
+}
+
+int dirass_getGridRefinement(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->gridRefinement;
+}
+
+float dirass_getRefinementThreshold(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->refineThreshold;
+}
+
+float dirass_getMaxUpdateRate(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->maxUpdateRate;
+}
+
+int dirass_getQualityLevel(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->qualityLevel;
+}
+
 int dirass_getPmap(void* const hDir, float** grid_dirs, float** pmap, int* nDirs,int* pmapWidth, int* hfov, float* aspectRatio) 
 {
     dirass_data *pData = (dirass_data*)(hDir);
     dirass_codecPars* pars = pData->pars;
-    if((pData->codecStatus == CODEC_STATUS_INITIALISED) && pData->pmapReady){
+    int pmapReady;
+    
+    pmapReady = 0;
+    if((pData->codecStatus == CODEC_STATUS_INITIALISED) &&
+       saf_frameRing_acquire(pData->hPmapRing, pmap, &(pData->pmapTimestamp_s))){
+        pmapReady = 1;
         (*grid_dirs) = pars->interp_dirs_deg;
-        (*pmap) = pData->pmap_grid[pData->dispSlotIdx-1 < 0 ? NUM_DISP_SLOTS-1 : pData->dispSlotIdx-1];
         (*nDirs) = pars->interp_nDirs;
         (*pmapWidth) = pData->dispWidth;
         switch(pData->HFOVoption){
@@ -680,5 +952,23 @@ int dirass_getPmap(void* const hDir, float** grid_dirs, float** pmap, int* nDirs
             case ASPECT_RATIO_4_3:  (*aspectRatio) = 4.0f/3.0f; break;
         }
     }
-    return pData->pmapReady;
+    return pmapReady;
+}
+
+double dirass_getPmapTimestamp(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->pmapTimestamp_s;
+}
+
+int dirass_getProcessingDelay(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return saf_fifo_getLatency(pData->hFIFO);
+}
+
+void* dirass_getTelemetry(void* const hDir)
+{
+    dirass_data *pData = (dirass_data*)(hDir);
+    return pData->hTelemetry;
 }
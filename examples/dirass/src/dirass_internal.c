@@ -53,10 +53,10 @@ void dirass_initAna(void* const hDir)
 {
     dirass_data *pData = (dirass_data*)(hDir);
     dirass_codecPars* pars = pData->pars;
-    int i, j, N_azi, N_ele, nSH_order, order, nSH_sec, order_sec, order_up, nSH_up, geosphere_ico_freq, td_degree;
-    float hfov, vfov, fi, aspectRatio;
-    float *grid_x_axis, *grid_y_axis, *c_n;
-    float_complex* A_xyz;
+    int i, j, N_azi, N_ele, nSH_order, order, nSH_sec, order_sec, order_up, nSH_up, geosphere_ico_freq, td_degree, pass, nNbrs;
+    float hfov, vfov, fi, aspectRatio, theta_0, phi_0, kernel_angle, min_spacing, max_spacing, nbr_cosMin;
+    float *grid_x_axis, *grid_y_axis, *c_n, *grid_theta_rad, *grid_phi_rad, *u, *k_dirs, *Y_k;
+    void* hVel;
     
     order = pData->new_inputOrder;
     order_up = pData->new_upscaleOrder;
@@ -128,6 +128,7 @@ void dirass_initAna(void* const hDir)
             pars->grid_nDirs = __geosphere_ico_nPoints[geosphere_ico_freq];
             break;
     }
+    pars->grid_dirs_rad = presetDirsCache_getRad(pars->grid_dirs_deg, pars->grid_nDirs);
     
     /* generate interpolation table for current display config */
     switch(pData->HFOVoption){
@@ -165,75 +166,151 @@ void dirass_initAna(void* const hDir)
     free(pars->interp_table);
     generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, 0.0f, &(pars->interp_table), &(pars->interp_nDirs), &(pars->interp_nTri));
     VBAPgainTable2InterpTable(pars->interp_table, pars->interp_nDirs, pars->grid_nDirs);
+    findClosestGridPoints_destroyIndex(&(pars->hInterpGridIdx));
+    findClosestGridPoints_createIndex(&(pars->hInterpGridIdx), pars->interp_dirs_rad, pars->interp_nDirs, 0);
     
     strcpy(pData->progressBarText,"Computing Sector coefficients");
     pData->progressBar0_1 = 0.85f;
     
+    /* look directions of the scanning grid [inclination, azimuth], in radians */
+    grid_theta_rad = malloc1d(pars->grid_nDirs*sizeof(float));
+    grid_phi_rad = malloc1d(pars->grid_nDirs*sizeof(float));
+    for(i=0; i<pars->grid_nDirs; i++){
+        grid_theta_rad[i] = M_PI/2.0f - pars->grid_dirs_deg[i*2+1]*M_PI/180.0f;
+        grid_phi_rad[i] = pars->grid_dirs_rad[i];
+    }
+    
     /* get beamforming matrices for sector velocity and sector patterns */
     order_sec = order-1;
     nSH_sec = (order_sec+1)*(order_sec+1);
-    A_xyz = malloc1d(nSH_order*nSH_sec*3*sizeof(float_complex));
     c_n = malloc1d((order_sec+1)*sizeof(float));
-    computeVelCoeffsMtx(order_sec, A_xyz);
+    velCoeffsMtx_create(&hVel, order_sec);
     switch(pData->beamType){
-        case BEAM_TYPE_CARD: beamWeightsCardioid2Spherical(order_sec, c_n); break;
-        case BEAM_TYPE_HYPERCARD: beamWeightsHypercardioid2Spherical(order_sec, c_n); break;
-        case BEAM_TYPE_MAX_EV: beamWeightsMaxEV(order_sec, c_n); break;
+        case BEAM_TYPE_CARD: beamWeightsCached(SECTOR_PATTERN_CARDIOID, order_sec, c_n); break;
+        case BEAM_TYPE_HYPERCARD: beamWeightsCached(SECTOR_PATTERN_PWD, order_sec, c_n); break;
+        case BEAM_TYPE_MAX_EV: beamWeightsCached(SECTOR_PATTERN_MAXRE, order_sec, c_n); break;
     }
     pars->Cxyz = realloc1d(pars->Cxyz, pars->grid_nDirs * nSH_order * 3 * sizeof(float));
     pars->Cw = realloc1d(pars->Cw, pars->grid_nDirs * nSH_sec * sizeof(float));
-    for(i=0; i<pars->grid_nDirs; i++){
-        beamWeightsVelocityPatternsReal(order_sec, c_n, pars->grid_dirs_deg[i*2]*M_PI/180.0f,
-                                        pars->grid_dirs_deg[i*2+1]*M_PI/180.0f, A_xyz, &(pars->Cxyz[i*nSH_order*3]));
-        rotateAxisCoeffsReal(order_sec, c_n, M_PI/2.0f - pars->grid_dirs_deg[i*2+1]*M_PI/180.0f,
-                             pars->grid_dirs_deg[i*2]*M_PI/180.0f, &(pars->Cw[i*nSH_sec]));
-    }
-    free(A_xyz);
+    for(i=0; i<pars->grid_nDirs; i++)
+        beamWeightsVelocityPatternsRealSparse(hVel, c_n, pars->grid_dirs_rad[i],
+                                              pars->grid_dirs_rad[pars->grid_nDirs+i], &(pars->Cxyz[i*nSH_order*3]));
+    rotateAxisCoeffsRealBatch(order_sec, c_n, grid_theta_rad, grid_phi_rad, pars->grid_nDirs, pars->Cw);
+    velCoeffsMtx_destroy(&hVel);
     free(c_n);
 
     /* get regular beamforming weights */
     c_n = malloc1d((order+1)*sizeof(float));
     switch(pData->beamType){
-        case BEAM_TYPE_CARD: beamWeightsCardioid2Spherical(order, c_n); break;
-        case BEAM_TYPE_HYPERCARD: beamWeightsHypercardioid2Spherical(order, c_n); break;
-        case BEAM_TYPE_MAX_EV: beamWeightsMaxEV(order, c_n); break;
+        case BEAM_TYPE_CARD: beamWeightsCached(SECTOR_PATTERN_CARDIOID, order, c_n); break;
+        case BEAM_TYPE_HYPERCARD: beamWeightsCached(SECTOR_PATTERN_PWD, order, c_n); break;
+        case BEAM_TYPE_MAX_EV: beamWeightsCached(SECTOR_PATTERN_MAXRE, order, c_n); break;
     }
     pars->w = realloc1d(pars->w, pars->grid_nDirs * nSH_order * sizeof(float));
-    for(i=0; i<pars->grid_nDirs; i++){
-        rotateAxisCoeffsReal(order, c_n, M_PI/2.0f - pars->grid_dirs_deg[i*2+1]*M_PI/180.0f,
-                             pars->grid_dirs_deg[i*2]*M_PI/180.0f, &(pars->w[i*nSH_order]));
-    }
+    rotateAxisCoeffsRealBatch(order, c_n, grid_theta_rad, grid_phi_rad, pars->grid_nDirs, pars->w);
     free(c_n);
  
     /* beamforming weights for upscaled */
     c_n = malloc1d((order_up+1)*sizeof(float)); 
     switch(pData->beamType){
-        case BEAM_TYPE_CARD: beamWeightsCardioid2Spherical(order_up, c_n); break;
-        case BEAM_TYPE_HYPERCARD: beamWeightsHypercardioid2Spherical(order_up, c_n); break;
-        case BEAM_TYPE_MAX_EV: beamWeightsMaxEV(order_up, c_n); break;
+        case BEAM_TYPE_CARD: beamWeightsCached(SECTOR_PATTERN_CARDIOID, order_up, c_n); break;
+        case BEAM_TYPE_HYPERCARD: beamWeightsCached(SECTOR_PATTERN_PWD, order_up, c_n); break;
+        case BEAM_TYPE_MAX_EV: beamWeightsCached(SECTOR_PATTERN_MAXRE, order_up, c_n); break;
     } 
     pars->Uw = realloc1d(pars->Uw, pars->grid_nDirs * nSH_up * sizeof(float));
-    for(i=0; i<pars->grid_nDirs; i++){
-        rotateAxisCoeffsReal(order_up, c_n, M_PI/2.0f - pars->grid_dirs_deg[i*2+1]*M_PI/180.0f,
-                             pars->grid_dirs_deg[i*2]*M_PI/180.0f, &(pars->Uw[i*nSH_up]));
+    rotateAxisCoeffsRealBatch(order_up, c_n, grid_theta_rad, grid_phi_rad, pars->grid_nDirs, pars->Uw);
+    
+    /* kernel for the sparse re-assignment: the squared upscaled beam pattern,
+     * truncated at its first minimum (or once it has decayed below the
+     * threshold); and tabulated uniformly over the cosine of the angle */
+    u = malloc1d(nSH_up*sizeof(float));
+    k_dirs = malloc1d(SPARSE_KERNEL_TABLE_SIZE*2*sizeof(float));
+    Y_k = malloc1d(nSH_up*SPARSE_KERNEL_TABLE_SIZE*sizeof(float));
+    theta_0 = phi_0 = 0.0f;
+    rotateAxisCoeffsRealBatch(order_up, c_n, &theta_0, &phi_0, 1, u);
+    for(i=0; i<SPARSE_KERNEL_TABLE_SIZE; i++){
+        k_dirs[i*2] = 0.0f;
+        k_dirs[i*2+1] = (float)i*M_PI/(float)(SPARSE_KERNEL_TABLE_SIZE-1);
     }
+    getSHreal(order_up, k_dirs, SPARSE_KERNEL_TABLE_SIZE, Y_k);
+    cblas_sgemv(CblasRowMajor, CblasTrans, nSH_up, SPARSE_KERNEL_TABLE_SIZE, 1.0f, Y_k, SPARSE_KERNEL_TABLE_SIZE, u, 1, 0.0f, pars->kernel, 1);
+    for(i=0; i<SPARSE_KERNEL_TABLE_SIZE; i++)
+        pars->kernel[i] *= pars->kernel[i];
+    for(i=1; i<SPARSE_KERNEL_TABLE_SIZE-1; i++)
+        if(pars->kernel[i+1]>=pars->kernel[i] || pars->kernel[i]<SPARSE_KERNEL_THRESHOLD*pars->kernel[0])
+            break;
+    kernel_angle = k_dirs[i*2+1];
+    pars->kernel_cosMin = cosf(kernel_angle);
+    pars->kernel_scale = (float)(SPARSE_KERNEL_TABLE_SIZE-1)/(1.0f-pars->kernel_cosMin);
+    for(i=0; i<SPARSE_KERNEL_TABLE_SIZE; i++)
+        k_dirs[i*2+1] = acosf(MIN(pars->kernel_cosMin + (float)i/pars->kernel_scale, 1.0f));
+    getSHreal(order_up, k_dirs, SPARSE_KERNEL_TABLE_SIZE, Y_k);
+    cblas_sgemv(CblasRowMajor, CblasTrans, nSH_up, SPARSE_KERNEL_TABLE_SIZE, 1.0f, Y_k, SPARSE_KERNEL_TABLE_SIZE, u, 1, 0.0f, pars->kernel, 1);
+    for(i=0; i<SPARSE_KERNEL_TABLE_SIZE; i++)
+        pars->kernel[i] *= pars->kernel[i];
+    free(u);
+    free(k_dirs);
+    free(Y_k);
     free(c_n);
+    
+    /* neighbour lists: since the DoA estimates are first snapped to their
+     * closest grid point, the lists must cover the kernel support plus the
+     * largest (nearest-neighbour) grid spacing */
+    pars->grid_xyz = realloc1d(pars->grid_xyz, pars->grid_nDirs*3*sizeof(float));
+    for(i=0; i<pars->grid_nDirs; i++){
+        pars->grid_xyz[i*3]   = sinf(grid_theta_rad[i])*cosf(grid_phi_rad[i]);
+        pars->grid_xyz[i*3+1] = sinf(grid_theta_rad[i])*sinf(grid_phi_rad[i]);
+        pars->grid_xyz[i*3+2] = cosf(grid_theta_rad[i]);
+    }
+    findClosestGridPoints_destroyIndex(&(pars->hGridIdx));
+    findClosestGridPoints_createIndex(&(pars->hGridIdx), pars->grid_dirs_deg, pars->grid_nDirs, 1);
+    max_spacing = 0.0f;
+    for(i=0; i<pars->grid_nDirs; i++){
+        min_spacing = M_PI;
+        for(j=0; j<pars->grid_nDirs; j++)
+            if(j!=i)
+                min_spacing = MIN(min_spacing, acosf(MAX(MIN(cblas_sdot(3, &(pars->grid_xyz[i*3]), 1, &(pars->grid_xyz[j*3]), 1), 1.0f), -1.0f)));
+        max_spacing = MAX(max_spacing, min_spacing);
+    }
+    nbr_cosMin = kernel_angle+max_spacing >= M_PI ? -2.0f : cosf(kernel_angle+max_spacing);
+    pars->nbr_offset = realloc1d(pars->nbr_offset, (pars->grid_nDirs+1)*sizeof(int));
+    for(pass=0; pass<2; pass++){
+        nNbrs = 0;
+        for(i=0; i<pars->grid_nDirs; i++){
+            pars->nbr_offset[i] = nNbrs;
+            for(j=0; j<pars->grid_nDirs; j++){
+                if(cblas_sdot(3, &(pars->grid_xyz[i*3]), 1, &(pars->grid_xyz[j*3]), 1) >= nbr_cosMin){
+                    if(pass==1)
+                        pars->nbr_idx[nNbrs] = j;
+                    nNbrs++;
+                }
+            }
+        }
+        pars->nbr_offset[pars->grid_nDirs] = nNbrs;
+        if(pass==0)
+            pars->nbr_idx = realloc1d(pars->nbr_idx, nNbrs*sizeof(int));
+    }
+    free(grid_theta_rad);
+    free(grid_phi_rad);
  
     /* reallocate memory */
     pars->Y_up = realloc1d(pars->Y_up, nSH_up* (pars->grid_nDirs)*sizeof(float));
     pars->est_dirs = realloc1d(pars->est_dirs, pars->grid_nDirs * 2 * sizeof(float));
     pars->ss = realloc1d(pars->ss, pars->grid_nDirs * FRAME_SIZE * sizeof(float));
-    pars->ssxyz = realloc1d(pars->ssxyz, 3 * FRAME_SIZE * sizeof(float));
+    saf_parfor_destroy(&(pData->hParFor));
+    saf_parfor_create(&(pData->hParFor), pData->nThreads);
+    pData->nThreadsInUse = saf_parfor_getNumThreads(pData->hParFor);
+    pars->ssxyz = realloc1d(pars->ssxyz, pData->nThreadsInUse * 3 * FRAME_SIZE * sizeof(float));
     pData->pmap = realloc1d(pData->pmap, pars->grid_nDirs*sizeof(float));
     pars->est_dirs_idx = realloc1d(pars->est_dirs_idx, pars->grid_nDirs*sizeof(int));
     pars->prev_intensity = realloc1d(pars->prev_intensity, pars->grid_nDirs*3*sizeof(float));
     pars->prev_energy = realloc1d(pars->prev_energy, pars->grid_nDirs*sizeof(float));
+    pars->sec_energy = realloc1d(pars->sec_energy, pars->grid_nDirs*sizeof(float));
+    pars->active_idx = realloc1d(pars->active_idx, pars->grid_nDirs*sizeof(int));
     memset(pars->prev_intensity, 0, pars->grid_nDirs*3*sizeof(float));
     memset(pars->prev_energy, 0, pars->grid_nDirs*sizeof(float)); 
-    for(i=0; i<NUM_DISP_SLOTS; i++){
-        pData->pmap_grid[i] = realloc1d(pData->pmap_grid[i], pars->interp_nDirs*sizeof(float));
-        memset(pData->pmap_grid[i], 0, pars->interp_nDirs*sizeof(float));
-    }
+    saf_frameRing_destroy(&(pData->hPmapRing));
+    saf_frameRing_create(&(pData->hPmapRing), NUM_DISP_SLOTS, pars->interp_nDirs, DISP_CONSUMER_TIMEOUT_S);
     
     pData->inputOrder = order;
     pData->upscaleOrder = order_up;
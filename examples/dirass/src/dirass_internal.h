@@ -72,7 +72,10 @@ typedef enum _DIRASS_PROC_STATUS{
 #define MAX_DISPLAY_SH_ORDER ( 20 )
 #define MAX_NUM_INPUT_SH_SIGNALS ( (MAX_INPUT_SH_ORDER+1)*(MAX_INPUT_SH_ORDER+1) )
 #define MAX_NUM_DISPLAY_SH_SIGNALS ( (MAX_DISPLAY_SH_ORDER+1)*(MAX_DISPLAY_SH_ORDER+1) )
-#define NUM_DISP_SLOTS ( 2 )
+#define NUM_DISP_SLOTS ( 4 )             /**< number of frames in the display ring (see saf_frameRing.h) */
+#define DISP_CONSUMER_TIMEOUT_S ( 1.0 )  /**< no maps are generated if none have been read for this long */
+#define SPARSE_KERNEL_TABLE_SIZE ( 256 ) /**< number of samples in the REASS_UPSCALE_SPARSE kernel table */
+#define SPARSE_KERNEL_THRESHOLD ( 1e-3f ) /**< the kernel is truncated once it falls below this (relative) value, or at its first minimum */
 #ifndef M_PI
 # define M_PI ( 3.14159265359f )
 #endif
@@ -90,16 +93,20 @@ typedef struct _dirass_codecPars
     /* scanning grid and intepolation table */
     float* grid_dirs_deg;     /**< scanning grid directions; FLAT: grid_nDirs x 2 */
     int grid_nDirs;           /**< number of grid directions */
+    const float* grid_dirs_rad; /**< scanning grid directions in radians (shared, see presetDirsCache_getRad()); FLAT: 2 x grid_nDirs */
     float* interp_dirs_deg;   /**< interpolation directions, in degrees; FLAT: interp_nDirs x 2 */
     float* interp_dirs_rad;   /**< interpolation directions, in radians; FLAT: interp_nDirs x 2 */
     float* interp_table;      /**< interpolation table (spherical->rectangular grid); FLAT: interp_nDirs x grid_nDirs */
     int interp_nDirs;         /**< number of interpolation directions */
     int interp_nTri;          /**< number of triangles in the spherical scanning grid mesh */
+    void* hInterpGridIdx;     /**< nearest-neighbour search index for the interpolation directions */
     float* ss;                /**< beamformer sector signals; FLAT: grid_nDirs x FRAME_SIZE */
-    float* ssxyz;             /**< beamformer velocity signals; FLAT: 3 x FRAME_SIZE */
+    float* ssxyz;             /**< beamformer velocity signals, per thread; FLAT: nThreads x 3 x FRAME_SIZE */
     int* est_dirs_idx;        /**< DoA indices, into the interpolation directions; grid_nDirs x 1 */
     float* prev_intensity;    /**< previous intensity vectors (for averaging); FLAT: grid_nDirs x 3 */
     float* prev_energy;       /**< previous energy (for averaging); FLAT: grid_nDirs x 1 */
+    float* sec_energy;        /**< sector energies of the current frame (for grid refinement); grid_nDirs x 1 */
+    int* active_idx;          /**< indices of the sectors to re-assign in the current frame; nActive x 1 */
     
     /* sector beamforming and upscaling */
     float* Cxyz;              /**< beamforming weights for velocity patterns; FLAT: nDirs x (order+1)^2 x 3 */
@@ -108,6 +115,15 @@ typedef struct _dirass_codecPars
     float* Y_up;              /**< real SH weights for upscaling; FLAT: (upscaleOrder+1)^2 x grid_nDirs */
     float* est_dirs;          /**< estimated DoA per grid direction; grid_nDirs x 2 */
     
+    /* sparse re-assignment (REASS_UPSCALE_SPARSE) */
+    float* grid_xyz;          /**< unit Cartesian vectors of the scanning grid; FLAT: grid_nDirs x 3 */
+    void* hGridIdx;           /**< nearest-neighbour search index for the scanning grid */
+    float kernel[SPARSE_KERNEL_TABLE_SIZE]; /**< squared upscaled beam pattern, sampled uniformly over cos(angle) in [kernel_cosMin, 1] */
+    float kernel_cosMin;      /**< cosine of the kernel truncation angle */
+    float kernel_scale;       /**< (SPARSE_KERNEL_TABLE_SIZE-1)/(1-kernel_cosMin) */
+    int* nbr_offset;          /**< neighbour list of grid point 'g' is nbr_idx[nbr_offset[g]..nbr_offset[g+1]-1]; (grid_nDirs+1) x 1 */
+    int* nbr_idx;             /**< grid points within the kernel support (plus the grid spacing) of each grid point */
+    
     /* regular beamforming */
     float* w;                 /**< beamforming weights; FLAT: nDirs x (order+1)^2 */
      
@@ -120,6 +136,8 @@ typedef struct _dirass_codecPars
 typedef struct _dirass
 {
     /* Buffers */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float SHframeTD[MAX_NUM_INPUT_SH_SIGNALS][FRAME_SIZE];
     float SHframe_upTD[MAX_NUM_DISPLAY_SH_SIGNALS][FRAME_SIZE];
     float fs;                               /**< host sampling rate */
@@ -136,14 +154,23 @@ typedef struct _dirass
     char* progressBarText;
     dirass_codecPars* pars;                 /**< codec parameters */
     
+    /* multi-threading */
+    void* hParFor;                          /**< thread pool for the per-sector DoA estimation (see saf_parfor.h) */
+    int nThreads;                           /**< requested number of threads (0: one per CPU core) */
+    int nThreadsInUse;                      /**< number of threads actually in use */
+    int job_nSH;                            /**< current DoA job: number of input SH signals */
+    int job_DirAssMode;                     /**< current DoA job: see DIRASS_REASS_MODES enum */
+    float job_pmapAvgCoeff;                 /**< current DoA job: averaging coefficient */
+    
     /* display */
     float* pmap;                            /**< grid_nDirs x 1 */
-    float* pmap_grid[NUM_DISP_SLOTS];       /**< dirass interpolated to grid; interp_nDirs x 1 */
-    int dispSlotIdx;                        /**< current display slot index */
+    void* hPmapRing;                        /**< ring of activity-maps interpolated to grid (see saf_frameRing.h); NUM_DISP_SLOTS x interp_nDirs */
+    double frameTime_s;                     /**< time of the current frame, in seconds */
+    double pmapTimestamp_s;                 /**< time of the map last returned by dirass_getPmap(), in seconds */
+    double lastUpdateTime_s;                /**< time of the last generated map, in seconds */
     float pmap_grid_minVal;                 /**< minimum value in pmap */
     float pmap_grid_maxVal;                 /**< maximum value in pmap */
     int recalcPmap;                         /**< set this to 1 to generate a new image */
-    int pmapReady;                          /**< 0: image generation not started yet, 1: image is ready for plotting*/
     
     /* User parameters */
     int new_inputOrder, inputOrder;         /**< input/analysis order */
@@ -152,12 +179,16 @@ typedef struct _dirass
     int new_upscaleOrder, upscaleOrder;     /**< target upscale order */
     DIRASS_GRID_OPTIONS gridOption;         /**< grid option */
     float pmapAvgCoeff;                     /**< averaging coefficient for the intensity vector per grid direction */
+    float maxUpdateRate;                    /**< maximum number of maps per second (0: every frame) */
     float minFreq_hz;                       /**< minimum frequency to include in pmap generation, Hz */
     float maxFreq_hz;                       /**< maximum frequency to include in pmap generation, Hz */
     DIRASS_CH_ORDER chOrdering;             /**< ACN */
     DIRASS_NORM_TYPES norm;                 /**< N3D or SN3D */
     DIRASS_HFOV_OPTIONS HFOVoption;         /**< horzontal field-of-view option */
     DIRASS_ASPECT_RATIO_OPTIONS aspectRatioOption; /**< aspect ratio option */
+    int gridRefinement;                     /**< '1' only re-assign the sectors above 'refineThreshold', '0' re-assign all sectors */
+    float refineThreshold;                  /**< sector energy threshold (relative to the range over the sectors), 0..1 */
+    int qualityLevel;                       /**< 0: full quality, see dirass_setQualityLevel() */
     
 } dirass_data;
 
@@ -88,11 +88,18 @@ void matrixconv_process(void* const hMCnv,
 /**
  * Sets all intialisation flags to 1. Re-initialising all settings/variables,
  * as matrixconv is currently configured, at next available opportunity.
+ *
+ * @note Once initialised, the convolver is rebuilt in the background, and
+ *       matrixconv_process() then crossfades to it from the current one. The
+ *       same applies to all of the set functions below.
  */
 void matrixconv_refreshParams(void* const hMCnv);
 
 /**
  * Checks whether things have to be reinitialised, and does so if it is needed
+ *
+ * @note This builds the convolver in the calling thread, and is called by
+ *       matrixconv_init()
  */
 void matrixconv_checkReInit(void* const hMCnv);
 
@@ -120,6 +127,28 @@ void matrixconv_setFilters(void* const hMCnv,
                            int numSamples,
                            int sampleRate);
 
+/**
+ * Loads the matrix of filters from a WAV file, with the same layout as for
+ * matrixconv_setFilters() (i.e. one channel per output, in which the filters
+ * for each input are concatenated)
+ *
+ * Rather than being held in memory, the file is read (partition by partition)
+ * whenever the convolver is built; so the only copy of the filters that is then
+ * held in memory is their spectra. Integer PCM of 16, 24 or 32 bits, and 32 or
+ * 64 bit floating point files are supported.
+ *
+ * @note The file must therefore remain in place, for as long as it is in use;
+ *       if it can no longer be opened, then the processing is bypassed.
+ *
+ * @param[in] hMCnv matrixconv handle
+ * @param[in] path  Path to the WAV file
+ * @returns   1 if successful; 0 if the file could not be opened, its format is
+ *            not supported, or it has too many channels (the current filters
+ *            are then kept)
+ */
+int matrixconv_setFiltersFromWav(void* const hMCnv,
+                                 const char* path);
+
 /**
  * Enable (1), disable (0), partitioned convolution
  */
@@ -134,6 +163,13 @@ void matrixconv_setEnablePart(void* const hMCnv, int newState);
  *       output channel
  */
 void matrixconv_setNumInputChannels(void* const hMCnv, int newValue);
+
+/**
+ * Sets the number of threads over which the output channels are split ('1'
+ * single-threaded, or '0' for one thread per CPU core); which is applied
+ * upon re-initialisation
+ */
+void matrixconv_setNumThreads(void* const hMCnv, int newValue);
     
 
 /* ========================================================================== */
@@ -151,6 +187,11 @@ int matrixconv_getEnablePart(void* const hMCnv);
  */
 int matrixconv_getNumInputChannels(void* const hMCnv);
 
+/**
+ * Returns the number of threads that are actually in use for the convolution
+ */
+int matrixconv_getNumThreads(void* const hMCnv);
+
 /**
  * Returns the number of output channels (the same as the number of channels in
  * the loaded wav file)
@@ -182,6 +223,20 @@ int matrixconv_getFilterFs(void* const hMCnv);
  * Returns the samperate of the host
  */
 int matrixconv_getHostFs(void* const hMCnv);
+
+/**
+ * Returns the processing delay in samples (may be used for delay compensation
+ * purposes); which is 0, since the convolution is carried out with a hop size
+ * equal to the host block size
+ */
+int matrixconv_getProcessingDelay(void);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * building the convolvers); see saf_telemetry_getSnapshot()
+ */
+void* matrixconv_getTelemetry(void* const hMCnv);
     
     
 #ifdef __cplusplus
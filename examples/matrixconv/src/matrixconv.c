@@ -36,8 +36,14 @@ void matrixconv_create
     pData->hostBlockSize = -1; /* force initialisation */
     pData->inputFrameTD = NULL;
     pData->outputFrameTD = NULL;
-    pData->hMatrixConv = NULL;
+    pData->prevFrameTD = NULL;
+    pData->conv = NULL;
+    pData->conv_prev = NULL;
+    pData->fadePos = -1;
+    pData->nThreadsInUse = 1;
+    pData->matchPriorityFLAG = 0;
     pData->filters = NULL;
+    pData->wavPath = NULL;
     pData->reInitFilters = 1;
     pData->nfilters = 0;
     pData->filter_length = 0;
@@ -48,6 +54,12 @@ void matrixconv_create
     /* Default user parameters */
     pData->nInputChannels = 1;
     pData->enablePartitionedConv = 0;
+    pData->nThreads = SAF_PARFOR_NUM_THREADS_AUTO;
+    
+    saf_telemetry_create(&(pData->hTelemetry));
+    
+    /* convolvers are rebuilt in the background, once initialised */
+    saf_asyncInit_create(&(pData->hConvInit), &matrixconv_buildConvolver, &matrixconv_destroyConvolver, NULL, *phMCnv);
 }
 
 void matrixconv_destroy
@@ -58,10 +70,16 @@ void matrixconv_destroy
     matrixconv_data *pData = (matrixconv_data*)(*phMCnv);
     
     if (pData != NULL) {
+        /* (stopping the worker thread first, since it reads the filters) */
+        saf_asyncInit_destroy(&(pData->hConvInit));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        matrixconv_destroyConvolver((void*)pData, (void*)pData->conv);
+        matrixconv_destroyConvolver((void*)pData, (void*)pData->conv_prev);
         free2d((void***)&(pData->inputFrameTD));
         free2d((void***)&(pData->outputFrameTD));
+        free2d((void***)&(pData->prevFrameTD));
         free1d((void**)&(pData->filters));
-        saf_matrixConv_destroy(&(pData->hMatrixConv));
+        free1d((void**)&(pData->wavPath));
         free(pData);
         pData = NULL;
     }
@@ -81,6 +99,7 @@ void matrixconv_init
         pData->hostBlockSize = hostBlockSize;
         pData->inputFrameTD  = (float**)realloc2d((void**)pData->inputFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
         pData->outputFrameTD = (float**)realloc2d((void**)pData->outputFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
+        pData->prevFrameTD = (float**)realloc2d((void**)pData->prevFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
         memset(ADR2D(pData->inputFrameTD), 0, MAX_NUM_CHANNELS*hostBlockSize*sizeof(float));
         pData->reInitFilters = 1;
     }
@@ -100,16 +119,42 @@ void matrixconv_process
 )
 {
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
-    int i;
-    int numInputChannels, numOutputChannels, nFilters;
- 
-    matrixconv_checkReInit(hMCnv);
+    matrixconv_convolver* newConv;
+    int i, j, numInputChannels, numOutputChannels, numPrevChannels;
+    float g;
+    unsigned int fpState;
+    int blasState;
     
-    if (nSamples == pData->hostBlockSize && pData->reInitFilters == 0) {
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    if (nSamples == pData->hostBlockSize) {
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        
+        /* swap in the convolver rebuilt in the background (if one is ready), and crossfade to it from the current one */
+        if(pData->fadePos < 0){
+            newConv = (matrixconv_convolver*)saf_asyncInit_fetch(pData->hConvInit);
+            if(newConv!=NULL && newConv->hostBlockSize != pData->hostBlockSize)
+                saf_asyncInit_retire(pData->hConvInit, (void*)newConv); /* (stale) */
+            else if(newConv!=NULL){
+                pData->conv_prev = pData->conv;
+                pData->conv = newConv;
+                pData->fadePos = 0;
+                pData->nThreadsInUse = newConv->nThreadsInUse;
+                pData->matchPriorityFLAG = 1;
+            }
+        }
+        
+        /* so that the audio thread is not kept waiting on lower priority workers */
+        if(pData->matchPriorityFLAG && pData->conv!=NULL){
+            saf_parfor_setPriority(pData->conv->hParFor, SAF_PARFOR_PRIORITY_MATCH_CALLER);
+            pData->matchPriorityFLAG = 0;
+        }
+        
         /* prep */
-        numInputChannels = pData->nInputChannels;
-        numOutputChannels = pData->nOutputChannels;
-        nFilters = pData->nfilters;
+        numInputChannels = pData->conv!=NULL ? pData->conv->nInputChannels : pData->nInputChannels;
+        if(pData->fadePos>=0 && pData->conv_prev!=NULL)
+            numInputChannels = MAX(numInputChannels, pData->conv_prev->nInputChannels);
         
         /* Load time-domain data */
         for(i=0; i < MIN(numInputChannels, MIN(nInputs, MAX_NUM_CHANNELS)); i++)
@@ -117,32 +162,73 @@ void matrixconv_process
         for(; i<MAX_NUM_CHANNELS; i++)
             memset(pData->inputFrameTD[i], 0, pData->hostBlockSize * sizeof(float)); /* fill remaining channels with zeros */
  
-        /* Apply convolution */
-        if(pData->hMatrixConv != NULL && pData->filter_length>0)
-            saf_matrixConv_apply(pData->hMatrixConv, ADR2D(pData->inputFrameTD), ADR2D(pData->outputFrameTD));
-        /* if the matrix convolver handle has not been initialised yet (i.e. no filters have been loaded) then the processing is bypassed */
-        else
-            memcpy(ADR2D(pData->outputFrameTD), ADR2D(pData->inputFrameTD), MIN(MAX(numInputChannels,numOutputChannels), MATRIXCONV_MAX_NUM_CHANNELS) * (pData->hostBlockSize)*sizeof(float));
+        /* Apply convolution (the output remains silent until filters have been loaded) */
+        numOutputChannels = matrixconv_applyConvolver(pData, pData->conv, pData->outputFrameTD);
+        
+        /* crossfade from the output of the previous convolver */
+        if(pData->fadePos>=0){
+            numPrevChannels = matrixconv_applyConvolver(pData, pData->conv_prev, pData->prevFrameTD);
+            for(i=numOutputChannels; i<numPrevChannels; i++)
+                memset(pData->outputFrameTD[i], 0, pData->hostBlockSize*sizeof(float));
+            for(i=numPrevChannels; i<numOutputChannels; i++)
+                memset(pData->prevFrameTD[i], 0, pData->hostBlockSize*sizeof(float));
+            numOutputChannels = MAX(numOutputChannels, numPrevChannels);
+            for(i=0; i<numOutputChannels; i++){
+                for(j=0; j<pData->hostBlockSize; j++){
+                    g = MIN((float)(pData->fadePos+j+1)/(float)MATRIXCONV_CROSSFADE_LENGTH, 1.0f);
+                    pData->outputFrameTD[i][j] = g*pData->outputFrameTD[i][j] + (1.0f-g)*pData->prevFrameTD[i][j];
+                }
+            }
+            pData->fadePos += pData->hostBlockSize;
+            if(pData->fadePos >= MATRIXCONV_CROSSFADE_LENGTH){
+                saf_asyncInit_retire(pData->hConvInit, (void*)pData->conv_prev);
+                pData->conv_prev = NULL;
+                pData->fadePos = -1;
+            }
+        }
         
         /* copy signals to output buffer */
         for (i = 0; i < MIN(numOutputChannels, nOutputs); i++)
             utility_svvcopy(pData->outputFrameTD[i], pData->hostBlockSize, outputs[i]);
         for (; i < nOutputs; i++)
             memset(outputs[i], 0, pData->hostBlockSize*sizeof(float));
+        if(pData->conv!=NULL)
+            saf_telemetry_frameEnd(pData->hTelemetry);
+        else
+            saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     }
     else{
         for (i = 0; i < nOutputs; i++)
             memset(outputs[i], 0, nSamples*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_BLOCK_SIZE);
     }
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 
 /*sets*/
 
+/**
+ * Flags that the convolver should be rebuilt; in the background if already
+ * initialised (it is then crossfaded to in matrixconv_process()), or otherwise
+ * upon matrixconv_checkReInit()
+ */
+static void matrixconv_requestReInit(matrixconv_data* pData)
+{
+    if(pData->hostBlockSize>0 && (pData->filters!=NULL || pData->wavPath!=NULL)){
+        pData->reInitFilters = 0;
+        saf_asyncInit_request(pData->hConvInit);
+    }
+    else
+        pData->reInitFilters = 1;
+}
+
 void matrixconv_refreshParams(void* const hMCnv)
 {
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
-    pData->reInitFilters = 1;
+    matrixconv_requestReInit(pData);
 }
 
 void matrixconv_checkReInit(void* const hMCnv)
@@ -150,22 +236,22 @@ void matrixconv_checkReInit(void* const hMCnv)
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
     
     /* reinitialise if needed */
-    if ((pData->reInitFilters == 1) && (pData->filters !=NULL)) {
+    if ((pData->reInitFilters == 1) && (pData->filters !=NULL || pData->wavPath != NULL)) {
         pData->reInitFilters = 2;
-        saf_matrixConv_destroy(&(pData->hMatrixConv));
-        pData->hMatrixConv = NULL;
         
-        /* if length of the loaded wav file was not divisable by the specified number of inputs, then the handle remains NULL,
-         * and no convolution is applied */
-        if(pData->filter_length>0){
-            saf_matrixConv_create(&(pData->hMatrixConv),
-                                  pData->hostBlockSize,
-                                  pData->filters,
-                                  pData->filter_length,
-                                  pData->nInputChannels,
-                                  pData->nOutputChannels,
-                                  pData->enablePartitionedConv);
+        /* any build in the background would be for the old configuration */
+        saf_asyncInit_cancel(pData->hConvInit);
+        saf_asyncInit_wait(pData->hConvInit);
+        if(pData->fadePos>=0){
+            matrixconv_destroyConvolver((void*)pData, (void*)pData->conv_prev);
+            pData->conv_prev = NULL;
+            pData->fadePos = -1;
+            saf_asyncInit_retire(pData->hConvInit, NULL); /* (so that the next one may be fetched) */
         }
+        matrixconv_destroyConvolver((void*)pData, (void*)pData->conv);
+        pData->conv = (matrixconv_convolver*)matrixconv_buildConvolver((void*)pData, NULL);
+        pData->nThreadsInUse = pData->conv->nThreadsInUse;
+        pData->matchPriorityFLAG = 1;
         pData->reInitFilters = 0;
     }
 }
@@ -183,6 +269,11 @@ void matrixconv_setFilters
     int i;
     assert(numChannels<=MAX_NUM_CHANNELS_FOR_WAV && numChannels > 0 && numSamples > 0);
     
+    /* the background build reads the filters directly, so wait for it first */
+    saf_asyncInit_cancel(pData->hConvInit);
+    saf_asyncInit_wait(pData->hConvInit);
+    free1d((void**)&(pData->wavPath));
+    
     pData->nOutputChannels = MIN(numChannels, MAX_NUM_CHANNELS);
     pData->input_wav_length = numSamples;
     pData->nfilters = (pData->nOutputChannels) * (pData->nInputChannels);
@@ -200,7 +291,47 @@ void matrixconv_setFilters
     else
         pData->filter_length = 0;
 
-    pData->reInitFilters = 1;
+    matrixconv_requestReInit(pData);
+}
+
+int matrixconv_setFiltersFromWav
+(
+    void* const hMCnv,
+    const char* path
+)
+{
+    matrixconv_data *pData = (matrixconv_data*)(hMCnv);
+    matrixconv_wav wav;
+    
+    if(!matrixconv_wav_open(&wav, path))
+        return 0;
+    if(wav.nChannels > MAX_NUM_CHANNELS_FOR_WAV){
+        matrixconv_wav_close(&wav);
+        return 0;
+    }
+    
+    /* the background build reads the filters directly, so wait for it first */
+    saf_asyncInit_cancel(pData->hConvInit);
+    saf_asyncInit_wait(pData->hConvInit);
+    free1d((void**)&(pData->filters));
+    pData->wavPath = realloc1d(pData->wavPath, (strlen(path)+1)*sizeof(char));
+    strcpy(pData->wavPath, path);
+    
+    pData->nOutputChannels = MIN(wav.nChannels, MAX_NUM_CHANNELS);
+    pData->input_wav_length = wav.nFrames;
+    pData->nfilters = (pData->nOutputChannels) * (pData->nInputChannels);
+    pData->filter_fs = wav.sampleRate;
+    matrixconv_wav_close(&wav);
+    
+    /* if the number of samples in loaded data is not divisable by the currently specified number of
+     * inputs, then the filter length is set to 0 and no further processing is conducted. */
+    if(pData->input_wav_length % pData->nInputChannels == 0)
+        pData->filter_length = (pData->input_wav_length) / (pData->nInputChannels);
+    else
+        pData->filter_length = 0;
+    
+    matrixconv_requestReInit(pData);
+    return 1;
 }
 
 void matrixconv_setEnablePart(void* const hMCnv, int newState)
@@ -208,7 +339,7 @@ void matrixconv_setEnablePart(void* const hMCnv, int newState)
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
     if(pData->enablePartitionedConv!=newState){
         pData->enablePartitionedConv = newState;
-        pData->reInitFilters = 1;
+        matrixconv_requestReInit(pData);
     }
 }
 
@@ -221,12 +352,22 @@ void matrixconv_setNumInputChannels(void* const hMCnv, int newValue)
         pData->filter_length = (pData->input_wav_length) / (pData->nInputChannels);
     else
         pData->filter_length = 0;
-    pData->reInitFilters = 1;
+    matrixconv_requestReInit(pData);
 }
 
 
 /*gets*/
 
+void matrixconv_setNumThreads(void* const hMCnv, int newValue)
+{
+    matrixconv_data *pData = (matrixconv_data*)(hMCnv);
+    newValue = newValue < 0 ? 0 : newValue;
+    if(pData->nThreads != newValue){
+        pData->nThreads = newValue;
+        matrixconv_requestReInit(pData);
+    }
+}
+
 int matrixconv_getEnablePart(void* const hMCnv)
 {
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
@@ -239,6 +380,12 @@ int matrixconv_getNumInputChannels(void* const hMCnv)
     return pData->nInputChannels;
 }
 
+int matrixconv_getNumThreads(void* const hMCnv)
+{
+    matrixconv_data *pData = (matrixconv_data*)(hMCnv);
+    return pData->nThreadsInUse;
+}
+
 int matrixconv_getNumOutputChannels(void* const hMCnv)
 {
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
@@ -274,3 +421,14 @@ int matrixconv_getHostFs(void* const hMCnv)
     matrixconv_data *pData = (matrixconv_data*)(hMCnv);
     return pData->host_fs;
 }
+
+int matrixconv_getProcessingDelay()
+{
+    return 0;
+}
+
+void* matrixconv_getTelemetry(void* const hMCnv)
+{
+    matrixconv_data *pData = (matrixconv_data*)(hMCnv);
+    return pData->hTelemetry;
+}
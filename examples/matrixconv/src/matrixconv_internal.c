@@ -24,4 +24,234 @@
 #include "matrixconv.h"
 #include "matrixconv_internal.h"
 
+void* matrixconv_buildConvolver
+(
+    void* const hMCnv,
+    void* const hAsync
+)
+{
+    matrixconv_data *pData = (matrixconv_data*)(hMCnv);
+    matrixconv_convolver* conv;
+    matrixconv_wav wav;
+    int filter_length;
+    
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    
+    /* take a copy of the parameters, which may change during the build (the
+     * filters themselves are only replaced once any build has finished, see
+     * matrixconv_setFilters()) */
+    conv = (matrixconv_convolver*)calloc1d(1, sizeof(matrixconv_convolver));
+    conv->hostBlockSize = pData->hostBlockSize;
+    conv->nInputChannels = pData->nInputChannels;
+    conv->nOutputChannels = pData->nOutputChannels;
+    conv->hMatrixConv = NULL;
+    conv->hParFor = NULL;
+    conv->nThreadsInUse = 1;
+    filter_length = pData->filter_length;
+    
+    /* if length of the loaded wav file was not divisable by the specified number of inputs, then the handle remains NULL,
+     * and no convolution is applied */
+    if(filter_length>0 && pData->wavPath!=NULL){
+        /* transform the filters straight from the file (if it can still be opened) */
+        if(!matrixconv_wav_open(&wav, pData->wavPath)){
+            saf_telemetry_reinitEnd(pData->hTelemetry);
+            return (void*)conv;
+        }
+        wav.filter_length = filter_length;
+        wav.nOutputChannels = conv->nOutputChannels;
+        saf_matrixConv_createFromReader(&(conv->hMatrixConv),
+                                        conv->hostBlockSize,
+                                        &matrixconv_wav_read,
+                                        (void*)&wav,
+                                        filter_length,
+                                        conv->nInputChannels,
+                                        conv->nOutputChannels,
+                                        pData->enablePartitionedConv);
+        matrixconv_wav_close(&wav);
+    }
+    else if(filter_length>0)
+        saf_matrixConv_create(&(conv->hMatrixConv),
+                              conv->hostBlockSize,
+                              pData->filters,
+                              filter_length,
+                              conv->nInputChannels,
+                              conv->nOutputChannels,
+                              pData->enablePartitionedConv);
+    if(conv->hMatrixConv!=NULL){
+        if(hAsync!=NULL && saf_asyncInit_isCancelled(hAsync)){
+            matrixconv_destroyConvolver(hMCnv, (void*)conv);
+            saf_telemetry_reinitEnd(pData->hTelemetry);
+            return NULL;
+        }
+        
+        /* spread the output channels over the threads of the pool */
+        saf_parfor_create(&(conv->hParFor), pData->nThreads);
+        conv->nThreadsInUse = saf_parfor_getNumThreads(conv->hParFor);
+        saf_matrixConv_setThreadPool(conv->hMatrixConv, conv->hParFor);
+    }
+    
+    saf_telemetry_reinitEnd(pData->hTelemetry);
+    return (void*)conv;
+}
 
+void matrixconv_destroyConvolver
+(
+    void* const hMCnv,
+    void* convolver
+)
+{
+    matrixconv_convolver* conv = (matrixconv_convolver*)convolver;
+    
+    (void)hMCnv;
+    if(conv!=NULL){
+        saf_matrixConv_destroy(&(conv->hMatrixConv)); /* (before the pool it uses) */
+        saf_parfor_destroy(&(conv->hParFor));
+        free(conv);
+    }
+}
+
+int matrixconv_applyConvolver
+(
+    matrixconv_data* pData,
+    matrixconv_convolver* conv,
+    float** outputFrameTD
+)
+{
+    if(conv==NULL)
+        return 0;
+    if(conv->hMatrixConv!=NULL)
+        saf_matrixConv_apply(conv->hMatrixConv, ADR2D(pData->inputFrameTD), ADR2D(outputFrameTD));
+    /* if the length of the filters was not divisable by the number of inputs, then the processing is bypassed */
+    else
+        memcpy(ADR2D(outputFrameTD), ADR2D(pData->inputFrameTD), MIN(MAX(conv->nInputChannels,conv->nOutputChannels), MAX_NUM_CHANNELS) * (pData->hostBlockSize)*sizeof(float));
+    return MIN(conv->nOutputChannels, MAX_NUM_CHANNELS);
+}
+
+
+
+/** Little-endian unsigned integer of 'nBytes' bytes */
+static unsigned int matrixconv_wav_uint(const unsigned char* b, int nBytes)
+{
+    unsigned int val;
+    int i;
+    
+    for(i=nBytes-1, val=0; i>=0; i--)
+        val = (val<<8) | b[i];
+    return val;
+}
+
+int matrixconv_wav_open
+(
+    matrixconv_wav* wav,
+    const char* path
+)
+{
+    unsigned char hdr[40];
+    unsigned int chunkSize;
+    int format, foundFmt, blockAlign;
+    
+    memset(wav, 0, sizeof(matrixconv_wav));
+    wav->file = fopen(path, "rb");
+    if(wav->file==NULL)
+        return 0;
+    
+    /* RIFF header */
+    if(fread(hdr, 1, 12, wav->file)!=12 || memcmp(hdr, "RIFF", 4)!=0 || memcmp(&hdr[8], "WAVE", 4)!=0){
+        matrixconv_wav_close(wav);
+        return 0;
+    }
+    
+    /* find the format and data chunks (skipping any others) */
+    foundFmt = 0;
+    while(fread(hdr, 1, 8, wav->file)==8){
+        chunkSize = matrixconv_wav_uint(&hdr[4], 4);
+        if(memcmp(hdr, "fmt ", 4)==0 && chunkSize>=16){
+            if(fread(hdr, 1, MIN(chunkSize, 40), wav->file)!=MIN(chunkSize, 40))
+                break;
+            format = (int)matrixconv_wav_uint(hdr, 2);
+            if(format==0xFFFE && chunkSize>=26) /* WAVE_FORMAT_EXTENSIBLE: the format is given by the subformat GUID */
+                format = (int)matrixconv_wav_uint(&hdr[24], 2);
+            wav->nChannels = (int)matrixconv_wav_uint(&hdr[2], 2);
+            wav->sampleRate = (int)matrixconv_wav_uint(&hdr[4], 4);
+            wav->bytesPerSample = (int)matrixconv_wav_uint(&hdr[14], 2)/8;
+            wav->isFloat = format==3 ? 1 : 0;
+            blockAlign = (int)matrixconv_wav_uint(&hdr[12], 2);
+            if(!((format==1 && wav->bytesPerSample>=2 && wav->bytesPerSample<=4) ||
+                 (format==3 && (wav->bytesPerSample==4 || wav->bytesPerSample==8))) ||
+               wav->nChannels<1 || blockAlign!=(wav->nChannels)*(wav->bytesPerSample))
+                break;
+            foundFmt = 1;
+            chunkSize -= MIN(chunkSize, 40);
+        }
+        else if(memcmp(hdr, "data", 4)==0 && foundFmt){
+            wav->dataOffset = (long long)ftell(wav->file);
+            wav->nFrames = (int)(chunkSize/(unsigned int)((wav->nChannels)*(wav->bytesPerSample)));
+            return wav->nFrames>0 ? 1 : 0;
+        }
+        if(MATRIXCONV_FSEEK(wav->file, chunkSize + (chunkSize&1), SEEK_CUR)!=0) /* (chunks are padded to an even size) */
+            break;
+    }
+    matrixconv_wav_close(wav);
+    return 0;
+}
+
+void matrixconv_wav_close(matrixconv_wav* wav)
+{
+    if(wav->file!=NULL)
+        fclose(wav->file);
+    wav->file = NULL;
+    free(wav->buf);
+    wav->buf = NULL;
+    wav->bufLen = 0;
+}
+
+void matrixconv_wav_read
+(
+    void* const hReader,
+    int ni,
+    int offset,
+    int len,
+    float* H_seg
+)
+{
+    matrixconv_wav* wav = (matrixconv_wav*)hReader;
+    int i, no, frameLen, nRead, bps;
+    unsigned int u;
+    unsigned long long u64;
+    float f;
+    double d;
+    unsigned char* b;
+    
+    /* read the frames of the segment (for all channels) in one go */
+    frameLen = (wav->nChannels)*(wav->bytesPerSample);
+    if(len*frameLen > wav->bufLen){
+        wav->bufLen = len*frameLen;
+        wav->buf = realloc1d(wav->buf, wav->bufLen);
+    }
+    nRead = 0;
+    if(MATRIXCONV_FSEEK(wav->file, wav->dataOffset + (long long)(ni*(wav->filter_length) + offset)*frameLen, SEEK_SET)==0)
+        nRead = (int)fread(wav->buf, frameLen, len, wav->file);
+    
+    /* de-interleave, and convert to float */
+    bps = wav->bytesPerSample;
+    memset(H_seg, 0, (wav->nOutputChannels)*len*sizeof(float));
+    for(i=0; i<nRead; i++){
+        for(no=0; no<wav->nOutputChannels; no++){
+            b = &(wav->buf[i*frameLen + no*bps]);
+            if(wav->isFloat && bps==4){
+                u = matrixconv_wav_uint(b, 4);
+                memcpy(&f, &u, sizeof(float));
+                H_seg[no*len+i] = f;
+            }
+            else if(wav->isFloat){
+                u64 = ((unsigned long long)matrixconv_wav_uint(&b[4], 4) << 32) | matrixconv_wav_uint(b, 4);
+                memcpy(&d, &u64, sizeof(double));
+                H_seg[no*len+i] = (float)d;
+            }
+            else{
+                u = matrixconv_wav_uint(b, bps) << (8*(4-bps)); /* left-justified, so that it may be read as signed */
+                H_seg[no*len+i] = (float)((int)u) / 2147483648.0f;
+            }
+        }
+    }
+}
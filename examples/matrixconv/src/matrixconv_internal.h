@@ -47,12 +47,53 @@ extern "C" {
 #ifndef RAD2DEG
 # define RAD2DEG(x) (x * 180.0f / PI)
 #endif
+#define MATRIXCONV_CROSSFADE_LENGTH ( 2048 ) /**< length of the crossfade from the old to a new convolver, in samples */
+#if defined(_WIN32)
+# define MATRIXCONV_FSEEK _fseeki64 /**< (for WAV files larger than 2GB) */
+#else
+# define MATRIXCONV_FSEEK fseek
+#endif
     
     
 /* ========================================================================== */
 /*                                 Structures                                 */
 /* ========================================================================== */
 
+/**
+ * A matrix convolver and its thread pool, which are built as a whole (see
+ * matrixconv_buildConvolver()), so that a new one may be prepared in the
+ * background while the current one is still in use
+ */
+typedef struct _matrixconv_convolver
+{
+    void* hMatrixConv;     /**< saf_matrixConv handle; NULL if the filters could not be divided over the inputs (bypass) */
+    void* hParFor;         /**< thread pool for the convolver (see saf_parfor.h) */
+    int nThreadsInUse;     /**< number of threads actually in use */
+    int hostBlockSize;     /**< host block size the convolver was built for */
+    int nInputChannels;    /**< number of input channels */
+    int nOutputChannels;   /**< number of output channels */
+    
+}matrixconv_convolver;
+
+/**
+ * An opened WAV file, from which the filters are read by matrixconv_wav_read()
+ */
+typedef struct _matrixconv_wav
+{
+    FILE* file;
+    int nChannels;         /**< number of channels in the file */
+    int nFrames;           /**< number of sample frames in the file */
+    int sampleRate;        /**< samplerate of the file */
+    int bytesPerSample;    /**< 2, 3 or 4 (integer PCM), or 4 or 8 (floating point) */
+    int isFloat;           /**< 1: IEEE floating point, 0: integer PCM */
+    long long dataOffset;  /**< position of the sample data in the file, in bytes */
+    unsigned char* buf;    /**< raw (interleaved) frames being read */
+    int bufLen;            /**< length of 'buf', in bytes */
+    int filter_length;     /**< length of the filters (the inputs are concatenated in each channel) */
+    int nOutputChannels;   /**< number of channels which are read (i.e. outputs) */
+    
+}matrixconv_wav;
+
 /**
  * Main structure for matrixconv.
  */
@@ -61,25 +102,102 @@ typedef struct _matrixconv
     /* input/output buffers */
     float** inputFrameTD;
     float** outputFrameTD;
+    float** prevFrameTD;   /**< output of the convolver being faded out; MAX_NUM_CHANNELS x hostBlockSize */
     
     /* internal */
-    void* hMatrixConv;     /**< saf_matrixConv handle */
+    matrixconv_convolver* conv;      /**< convolver in use; NULL if no filters have been loaded yet */
+    matrixconv_convolver* conv_prev; /**< convolver being faded out (if fadePos>=0; may be NULL) */
+    int fadePos;           /**< samples of the crossfade from conv_prev to conv carried out so far; -1: not crossfading */
+    void* hConvInit;       /**< saf_asyncInit handle; builds new convolvers in the background */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
+    int nThreadsInUse;     /**< number of threads actually in use */
+    int matchPriorityFLAG; /**< FLAG: 1: set the priority of the thread pool to that of the audio thread (upon the next block) */
     int hostBlockSize;     /**< current host block size */
     float* filters;        /**< the matrix of filters; FLAT: nOutputChannels x nInputChannels x filter_length */
+    char* wavPath;         /**< WAV file that the filters are read from when building a convolver (see
+                            *   matrixconv_setFiltersFromWav()); or NULL, if they are held in 'filters' */
     int nfilters;          /**< the number of filters (nOutputChannels x nInputChannels) */
     int input_wav_length;  /**< length of the wav files loaded in samples (inputs are concatenated) */
     int filter_length;     /**< length of the filters (i.e. input_wav_length/nInputChannels) */
     int filter_fs;         /**< current samplerate of the filters */
     int host_fs;           /**< current samplerate of the host */
-    int reInitFilters;     /**< FLAG: 0: do not reinit, 1: reinit, 2: reinit in progress */
+    int reInitFilters;     /**< FLAG: 0: do not reinit, 1: reinit (upon matrixconv_checkReInit()), 2: reinit in progress */
     int nOutputChannels;   /**< number of output channels (same as the number of channels in the loaded wav) */
     
     /* user parameters */
     int nInputChannels;        /**< number of input channels */
     int enablePartitionedConv; /**< 0: disabled, 1: enabled */
+    int nThreads;              /**< requested number of threads (0: one per CPU core) */
     
 } matrixconv_data;
     
+
+/* ========================================================================== */
+/*                             Internal Functions                             */
+/* ========================================================================== */
+
+/**
+ * Builds a convolver (and its thread pool) for the current filters and
+ * settings
+ *
+ * @note This does not modify the convolver currently in use, and so it may be
+ *       called from the background initialisation thread (see saf_asyncInit.h)
+ *
+ * @param[in] hMCnv  matrixconv handle
+ * @param[in] hAsync saf_asyncInit handle, for cancelling the build; may be NULL
+ * @returns   New matrixconv_convolver; or NULL, if the build was cancelled
+ */
+void* matrixconv_buildConvolver(void* const hMCnv,
+                                void* const hAsync);
+
+/**
+ * Destroys a convolver returned by matrixconv_buildConvolver() (may be NULL)
+ */
+void matrixconv_destroyConvolver(void* const hMCnv,
+                                 void* convolver);
+
+/**
+ * Applies a convolver to the first hostBlockSize samples of inputFrameTD
+ *
+ * @param[in]  pData         matrixconv data
+ * @param[in]  conv          Convolver (may be NULL)
+ * @param[out] outputFrameTD Output signals; MAX_NUM_CHANNELS x hostBlockSize
+ * @returns    Number of output channels written (0 if conv is NULL)
+ */
+int matrixconv_applyConvolver(matrixconv_data* pData,
+                              matrixconv_convolver* conv,
+                              float** outputFrameTD);
+
+/**
+ * Opens a WAV file (integer PCM of 16, 24 or 32 bits; or 32 or 64 bit
+ * floating point), and reads its format
+ *
+ * @param[out] wav  WAV file
+ * @param[in]  path Path to the file
+ * @returns    1 if successful, 0 if the file could not be opened or its format
+ *             is not supported
+ */
+int matrixconv_wav_open(matrixconv_wav* wav,
+                        const char* path);
+
+/**
+ * Closes a WAV file opened with matrixconv_wav_open()
+ */
+void matrixconv_wav_close(matrixconv_wav* wav);
+
+/**
+ * Reads a segment of the filters from a WAV file (a saf_matrixConv_readFunc);
+ * where the filters for the input channels are concatenated in each channel
+ * of the file (see matrixconv_setFilters())
+ *
+ * @note Samples that cannot be read (e.g. if the file was truncated) are zero.
+ */
+void matrixconv_wav_read(void* const hReader,
+                         int ni,
+                         int offset,
+                         int len,
+                         float* H_seg);
+    
     
 #ifdef __cplusplus
 } /* extern "C" { */
@@ -88,11 +88,18 @@ void multiconv_process(void* const hMCnv,
 /**
  * Sets all intialisation flags to 1. Re-initialising all settings/variables,
  * as multiconv is currently configured, at next available opportunity.
+ *
+ * @note Once initialised, the convolver is rebuilt in the background, and
+ *       multiconv_process() then crossfades to it from the current one. The
+ *       same applies to all of the set functions below.
  */
 void multiconv_refreshParams(void* const hMCnv);
 
 /**
  * Checks whether things have to be reinitialised, and does so if it is needed
+ *
+ * @note This builds the convolver in the calling thread, and is called by
+ *       multiconv_init()
  */
 void multiconv_checkReInit(void* const hMCnv);
 
@@ -114,7 +121,11 @@ void multiconv_setFilters(void* const hMCnv,
                           int sampleRate);
     
 /**
- * Enable (1), disable (0), partitioned convolution
+ * Enable uniformly partitioned (1), non-uniformly partitioned (2), or disable
+ * (0), partitioned convolution
+ *
+ * @note The non-uniform mode processes the filter tails on worker threads, and
+ *       is intended for long filters combined with small host block sizes.
  */
 void multiconv_setEnablePart(void* const hMCnv, int newState);
     
@@ -129,8 +140,8 @@ void multiconv_setNumChannels(void* const hMCnv, int newValue);
 /* ========================================================================== */
 
 /**
- * Returns a flag indicating whether partitioned convolution is enabled (1) or
- * disabled (0)
+ * Returns a flag indicating whether uniformly partitioned (1), non-uniformly
+ * partitioned (2) convolution is enabled, or disabled (0)
  */
 int multiconv_getEnablePart(void* const hMCnv);
 
@@ -164,6 +175,20 @@ int multiconv_getFilterFs(void* const hMCnv);
  */
 int multiconv_getHostFs(void* const hMCnv);
 
+/**
+ * Returns the processing delay in samples (may be used for delay compensation
+ * purposes); which is 0, since the convolution is carried out with a hop size
+ * equal to the host block size
+ */
+int multiconv_getProcessingDelay(void);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * building the convolvers); see saf_telemetry_getSnapshot()
+ */
+void* multiconv_getTelemetry(void* const hMCnv);
+
 
 #ifdef __cplusplus
 } /* extern "C" { */
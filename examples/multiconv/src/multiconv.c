@@ -36,7 +36,10 @@ void multiconv_create
     pData->hostBlockSize = -1; /* force initialisation */
     pData->inputFrameTD = NULL;
     pData->outputFrameTD = NULL;
-    pData->hMultiConv = NULL;
+    pData->prevFrameTD = NULL;
+    pData->conv = NULL;
+    pData->conv_prev = NULL;
+    pData->fadePos = -1;
     pData->filters = NULL;
     pData->reInitFilters = 1;
     pData->nfilters = 0;
@@ -46,6 +49,11 @@ void multiconv_create
     /* Default user parameters */
     pData->nChannels = 1;
     pData->enablePartitionedConv = 0;
+    
+    saf_telemetry_create(&(pData->hTelemetry));
+    
+    /* convolvers are rebuilt in the background, once initialised */
+    saf_asyncInit_create(&(pData->hConvInit), &multiconv_buildConvolver, &multiconv_destroyConvolver, NULL, *phMCnv);
 }
 
 void multiconv_destroy
@@ -56,10 +64,15 @@ void multiconv_destroy
     multiconv_data *pData = (multiconv_data*)(*phMCnv);
     
     if (pData != NULL) {
+        /* (stopping the worker thread first, since it reads the filters) */
+        saf_asyncInit_destroy(&(pData->hConvInit));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        multiconv_destroyConvolver((void*)pData, (void*)pData->conv);
+        multiconv_destroyConvolver((void*)pData, (void*)pData->conv_prev);
         free2d((void***)&(pData->inputFrameTD));
         free2d((void***)&(pData->outputFrameTD));
+        free2d((void***)&(pData->prevFrameTD));
         free1d((void**)&(pData->filters));
-        saf_multiConv_destroy(&(pData->hMultiConv));
         free(pData);
         pData = NULL;
     }
@@ -79,6 +92,7 @@ void multiconv_init
         pData->hostBlockSize = hostBlockSize;
         pData->inputFrameTD  = (float**)realloc2d((void**)pData->inputFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
         pData->outputFrameTD = (float**)realloc2d((void**)pData->outputFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
+        pData->prevFrameTD = (float**)realloc2d((void**)pData->prevFrameTD, MAX_NUM_CHANNELS, hostBlockSize, sizeof(float));
         memset(ADR2D(pData->inputFrameTD), 0, MAX_NUM_CHANNELS*hostBlockSize*sizeof(float));
         pData->reInitFilters = 1;
     }
@@ -98,47 +112,109 @@ void multiconv_process
 )
 {
     multiconv_data *pData = (multiconv_data*)(hMCnv);
-    int i;
-    int numChannels, nFilters;
- 
-    multiconv_checkReInit(hMCnv);
+    multiconv_convolver* newConv;
+    int i, j, numChannels, nFilters, nPrevFilters;
+    float g;
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
     
-    if (nSamples == pData->hostBlockSize && pData->reInitFilters == 0) {
+    if (nSamples == pData->hostBlockSize) {
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        
+        /* swap in the convolver rebuilt in the background (if one is ready), and crossfade to it from the current one */
+        if(pData->fadePos < 0){
+            newConv = (multiconv_convolver*)saf_asyncInit_fetch(pData->hConvInit);
+            if(newConv!=NULL && newConv->hostBlockSize != pData->hostBlockSize)
+                saf_asyncInit_retire(pData->hConvInit, (void*)newConv); /* (stale) */
+            else if(newConv!=NULL){
+                pData->conv_prev = pData->conv;
+                pData->conv = newConv;
+                pData->fadePos = 0;
+            }
+        }
+        
         /* prep */
-        nFilters = pData->nfilters;
+        nFilters = pData->conv!=NULL ? pData->conv->nfilters : 0;
+        if(pData->fadePos>=0 && pData->conv_prev!=NULL)
+            nFilters = MAX(nFilters, pData->conv_prev->nfilters);
         numChannels = pData->nChannels;
         
         /* Load time-domain data */
         for(i=0; i < MIN(MIN(nFilters,numChannels), nInputs); i++)
             utility_svvcopy(inputs[i], pData->hostBlockSize, pData->inputFrameTD[i]);
-        for(; i<MAX(nFilters,numChannels); i++)
+        for(; i<MIN(nFilters, MAX_NUM_CHANNELS); i++)
             memset(pData->inputFrameTD[i], 0, pData->hostBlockSize * sizeof(float)); /* fill remaining channels with zeros */
  
-        /* Apply convolution */
-        if(pData->hMultiConv != NULL)
-            saf_multiConv_apply(pData->hMultiConv, ADR2D(pData->inputFrameTD), ADR2D(pData->outputFrameTD));
-        else
-            memcpy(ADR2D(pData->outputFrameTD), ADR2D(pData->inputFrameTD), MAX(nFilters,numChannels) * (pData->hostBlockSize)*sizeof(float));
+        /* Apply convolution (the output remains silent until filters have been loaded) */
+        nFilters = multiconv_applyConvolver(pData, pData->conv, pData->outputFrameTD);
+        
+        /* crossfade from the output of the previous convolver */
+        if(pData->fadePos>=0){
+            nPrevFilters = multiconv_applyConvolver(pData, pData->conv_prev, pData->prevFrameTD);
+            for(i=nFilters; i<nPrevFilters; i++)
+                memset(pData->outputFrameTD[i], 0, pData->hostBlockSize*sizeof(float));
+            for(i=nPrevFilters; i<nFilters; i++)
+                memset(pData->prevFrameTD[i], 0, pData->hostBlockSize*sizeof(float));
+            nFilters = MAX(nFilters, nPrevFilters);
+            for(i=0; i<nFilters; i++){
+                for(j=0; j<pData->hostBlockSize; j++){
+                    g = MIN((float)(pData->fadePos+j+1)/(float)MULTICONV_CROSSFADE_LENGTH, 1.0f);
+                    pData->outputFrameTD[i][j] = g*pData->outputFrameTD[i][j] + (1.0f-g)*pData->prevFrameTD[i][j];
+                }
+            }
+            pData->fadePos += pData->hostBlockSize;
+            if(pData->fadePos >= MULTICONV_CROSSFADE_LENGTH){
+                saf_asyncInit_retire(pData->hConvInit, (void*)pData->conv_prev);
+                pData->conv_prev = NULL;
+                pData->fadePos = -1;
+            }
+        }
         
-        /* copy signals to output buffer */
-        for (i = 0; i < MIN(MAX(nFilters,numChannels), nOutputs); i++)
+        /* copy signals to output buffer (channels without a filter are silent) */
+        for (i = 0; i < MIN(nFilters, nOutputs); i++)
             utility_svvcopy(pData->outputFrameTD[i], pData->hostBlockSize, outputs[i]);
         for (; i < nOutputs; i++)
             memset(outputs[i], 0, pData->hostBlockSize*sizeof(float));
+        if(pData->conv!=NULL)
+            saf_telemetry_frameEnd(pData->hTelemetry);
+        else
+            saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     }
     else{
         for (i = 0; i < nOutputs; i++)
             memset(outputs[i], 0, nSamples*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_BLOCK_SIZE);
     }
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 
 /*sets*/
 
+/**
+ * Flags that the convolver should be rebuilt; in the background if already
+ * initialised (it is then crossfaded to in multiconv_process()), or otherwise
+ * upon multiconv_checkReInit()
+ */
+static void multiconv_requestReInit(multiconv_data* pData)
+{
+    if(pData->hostBlockSize>0 && pData->filters!=NULL){
+        pData->reInitFilters = 0;
+        saf_asyncInit_request(pData->hConvInit);
+    }
+    else
+        pData->reInitFilters = 1;
+}
+
 void multiconv_refreshParams(void* const hMCnv)
 {
     multiconv_data *pData = (multiconv_data*)(hMCnv);
-    pData->reInitFilters = 1;
+    multiconv_requestReInit(pData);
 }
 
 void multiconv_checkReInit(void* const hMCnv)
@@ -148,8 +224,18 @@ void multiconv_checkReInit(void* const hMCnv)
     /* reinitialise if needed */
     if ((pData->reInitFilters == 1) && (pData->filters !=NULL)) {
         pData->reInitFilters = 2;
-        saf_multiConv_destroy(&(pData->hMultiConv));
-        saf_multiConv_create(&(pData->hMultiConv), pData->hostBlockSize, pData->filters, pData->filter_length, pData->nfilters, pData->enablePartitionedConv);
+        
+        /* any build in the background would be for the old configuration */
+        saf_asyncInit_cancel(pData->hConvInit);
+        saf_asyncInit_wait(pData->hConvInit);
+        if(pData->fadePos>=0){
+            multiconv_destroyConvolver((void*)pData, (void*)pData->conv_prev);
+            pData->conv_prev = NULL;
+            pData->fadePos = -1;
+            saf_asyncInit_retire(pData->hConvInit, NULL); /* (so that the next one may be fetched) */
+        }
+        multiconv_destroyConvolver((void*)pData, (void*)pData->conv);
+        pData->conv = (multiconv_convolver*)multiconv_buildConvolver((void*)pData, NULL);
         pData->reInitFilters = 0;
     }
 }
@@ -166,13 +252,16 @@ void multiconv_setFilters
     multiconv_data *pData = (multiconv_data*)(hMCnv);
     int i;
     
+    /* the background build reads the filters directly, so wait for it first */
+    saf_asyncInit_cancel(pData->hConvInit);
+    saf_asyncInit_wait(pData->hConvInit);
     pData->filters = realloc1d(pData->filters, numChannels*numSamples*sizeof(float));
     pData->nfilters = numChannels;
     pData->filter_length = numSamples;
     for(i=0; i<numChannels; i++)
         memcpy(&(pData->filters[i*numSamples]), H[i], numSamples*sizeof(float));
     pData->filter_fs = sampleRate;
-    pData->reInitFilters = 1;
+    multiconv_requestReInit(pData);
 }
 
 void multiconv_setEnablePart(void* const hMCnv, int newState)
@@ -180,7 +269,7 @@ void multiconv_setEnablePart(void* const hMCnv, int newState)
     multiconv_data *pData = (multiconv_data*)(hMCnv);
     if(pData->enablePartitionedConv!=newState){
         pData->enablePartitionedConv = newState;
-        pData->reInitFilters = 1;
+        multiconv_requestReInit(pData);
     }
 }
 
@@ -233,3 +322,14 @@ int multiconv_getHostFs(void* const hMCnv)
     multiconv_data *pData = (multiconv_data*)(hMCnv);
     return pData->host_fs;
 }
+
+int multiconv_getProcessingDelay()
+{
+    return 0;
+}
+
+void* multiconv_getTelemetry(void* const hMCnv)
+{
+    multiconv_data *pData = (multiconv_data*)(hMCnv);
+    return pData->hTelemetry;
+}
@@ -24,4 +24,54 @@
 #include "multiconv.h"
 #include "multiconv_internal.h"
 
+void* multiconv_buildConvolver
+(
+    void* const hMCnv,
+    void* const hAsync
+)
+{
+    multiconv_data *pData = (multiconv_data*)(hMCnv);
+    multiconv_convolver* conv;
+    
+    /* (the filters themselves are only replaced once any build has finished,
+     * see multiconv_setFilters()) */
+    (void)hAsync;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
+    conv = (multiconv_convolver*)calloc1d(1, sizeof(multiconv_convolver));
+    conv->hostBlockSize = pData->hostBlockSize;
+    conv->nfilters = pData->nfilters;
+    saf_multiConv_create(&(conv->hMultiConv), conv->hostBlockSize, pData->filters, pData->filter_length, conv->nfilters, pData->enablePartitionedConv);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
+    
+    return (void*)conv;
+}
+
+void multiconv_destroyConvolver
+(
+    void* const hMCnv,
+    void* convolver
+)
+{
+    multiconv_convolver* conv = (multiconv_convolver*)convolver;
+    
+    (void)hMCnv;
+    if(conv!=NULL){
+        saf_multiConv_destroy(&(conv->hMultiConv));
+        free(conv);
+    }
+}
+
+int multiconv_applyConvolver
+(
+    multiconv_data* pData,
+    multiconv_convolver* conv,
+    float** outputFrameTD
+)
+{
+    if(conv==NULL)
+        return 0;
+    saf_multiConv_apply(conv->hMultiConv, ADR2D(pData->inputFrameTD), ADR2D(outputFrameTD));
+    return MIN(conv->nfilters, MAX_NUM_CHANNELS);
+}
+
 
@@ -46,12 +46,25 @@ extern "C" {
 #ifndef RAD2DEG
 # define RAD2DEG(x) (x * 180.0f / PI)
 #endif
+#define MULTICONV_CROSSFADE_LENGTH ( 2048 ) /**< length of the crossfade from the old to a new convolver, in samples */
     
     
 /* ========================================================================== */
 /*                                 Structures                                 */
 /* ========================================================================== */
 
+/**
+ * A multi-channel convolver, which may be built in the background (see
+ * multiconv_buildConvolver()) while the current one is still in use
+ */
+typedef struct _multiconv_convolver
+{
+    void* hMultiConv;      /**< saf_multiConv handle */
+    int hostBlockSize;     /**< host block size the convolver was built for */
+    int nfilters;          /**< number of filters/channels */
+    
+}multiconv_convolver;
+
 /**
  * Main structure for multiconv.
  */
@@ -59,9 +72,14 @@ typedef struct _multiconv
 {
     float** inputFrameTD;
     float** outputFrameTD;
+    float** prevFrameTD;   /**< output of the convolver being faded out; MAX_NUM_CHANNELS x hostBlockSize */
     
     /* internal */
-    void* hMultiConv;
+    multiconv_convolver* conv;      /**< convolver in use; NULL if no filters have been loaded yet */
+    multiconv_convolver* conv_prev; /**< convolver being faded out (if fadePos>=0; may be NULL) */
+    int fadePos;           /**< samples of the crossfade from conv_prev to conv carried out so far; -1: not crossfading */
+    void* hConvInit;       /**< saf_asyncInit handle; builds new convolvers in the background */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     int hostBlockSize; 
     float* filters;   /**< FLAT: nfilters x filter_length */
     int nfilters;
@@ -77,6 +95,43 @@ typedef struct _multiconv
 } multiconv_data;
 
 
+/* ========================================================================== */
+/*                             Internal Functions                             */
+/* ========================================================================== */
+
+/**
+ * Builds a convolver for the current filters and settings
+ *
+ * @note This does not modify the convolver currently in use, and so it may be
+ *       called from the background initialisation thread (see saf_asyncInit.h)
+ *
+ * @param[in] hMCnv  multiconv handle
+ * @param[in] hAsync saf_asyncInit handle (unused, a build cannot be cancelled
+ *                   part way); may be NULL
+ * @returns   New multiconv_convolver
+ */
+void* multiconv_buildConvolver(void* const hMCnv,
+                               void* const hAsync);
+
+/**
+ * Destroys a convolver returned by multiconv_buildConvolver() (may be NULL)
+ */
+void multiconv_destroyConvolver(void* const hMCnv,
+                                void* convolver);
+
+/**
+ * Applies a convolver to the first hostBlockSize samples of inputFrameTD
+ *
+ * @param[in]  pData         multiconv data
+ * @param[in]  conv          Convolver (may be NULL)
+ * @param[out] outputFrameTD Output signals; MAX_NUM_CHANNELS x hostBlockSize
+ * @returns    Number of output channels written (0 if conv is NULL)
+ */
+int multiconv_applyConvolver(multiconv_data* pData,
+                             multiconv_convolver* conv,
+                             float** outputFrameTD);
+
+
 #ifdef __cplusplus
 } /* extern "C" { */
 #endif /* __cplusplus */
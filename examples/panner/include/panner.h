@@ -99,6 +99,8 @@ typedef enum _PANNER_CODEC_STATUS{
 #define PANNER_MAX_NUM_OUTPUTS ( 64 )
 #define PANNER_SPREAD_MIN_VALUE ( 0.0f )
 #define PANNER_SPREAD_MAX_VALUE ( 90.0f )
+#define PANNER_CLUSTER_THRESHOLD_MIN_VALUE ( 0.0f )
+#define PANNER_CLUSTER_THRESHOLD_MAX_VALUE ( 45.0f )
 #define PANNER_PROGRESSBARTEXT_CHAR_LENGTH 256
     
 
@@ -136,11 +138,38 @@ void panner_init(void* const hPan,
  */
 void panner_initCodec(void* const hPan);
 
+/**
+ * Prepares the instance for playback, from the calling (non-real-time) thread;
+ * i.e. initialises the codec (if needed), and runs panner_process() over a
+ * few blocks of silence, such that the first audio callback does not incur
+ * the cost of touching the buffers and tables for the first time. The block
+ * size is also passed to the internal FIFO, which selects whether it adds any
+ * latency (see panner_getProcessingDelay())
+ *
+ * @note Call after panner_init(), and before the first call to
+ *       panner_process() (e.g. in the host's prepare-to-play callback); see
+ *       saf_warmUp.h
+ *
+ * @param[in] hPan      panner handle
+ * @param[in] nInputs   Number of input channels (as passed by the host)
+ * @param[in] nOutputs  Number of output channels (as passed by the host)
+ * @param[in] blockSize Number of samples per block (as passed by the host)
+ */
+void panner_prepareToPlay(void* const hPan,
+                          int nInputs,
+                          int nOutputs,
+                          int blockSize);
+
 /**
  * Pans the input signals/sources to the loudspeaker channels using VBAP [1],
  * and optional spreading [2] and frequency-dependent normalisation as a
  * function of the room reverberation [3].
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in panner_getProcessingDelay()
+ *
  * @param[in] hPan      panner handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs   Output channel buffers; 2-D array: nOutputs x nSamples
@@ -166,6 +195,23 @@ void panner_process(void* const hPan,
                     int nInputs,
                     int nOutputs,
                     int nSamples);
+
+/**
+ * Same as panner_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hPan     panner handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void panner_processInterleaved(void* const hPan,
+                               const float* inputs,
+                               float* outputs,
+                               int nInputs,
+                               int nOutputs,
+                               int nSamples);
     
     
 /* ========================================================================== */
@@ -222,6 +268,12 @@ void panner_setInputConfigPreset(void* const hPan, int newPresetID);
  * Sets the room coefficient value 0..1 [1]; 0: normal room, 0.5: dry listening
  * room, 1: anechoic
  *
+ * @note With a value of 0 the panning gains do not depend on frequency, in
+ *       which case the sources are panned directly in the
+ *       time-domain, with the gains ramped over each frame as sources move.
+ *       The time-domain path is delayed to match the filterbank, so the
+ *       processing delay is the same either way.
+ *
  * @see [1] Laitinen, M., Vilkamo, J., Jussila, K., Politis, A., Pulkki, V.
  *          (2014). Gain normalisation in amplitude panning as a function of
  *          frequency and room reverberance. 55th International Conference of
@@ -231,6 +283,9 @@ void panner_setDTT(void* const hPan, float newValue);
     
 /**
  * Sets the degree of spread, in DEGREES
+ *
+ * @note Only applies to 3-D panning; sources are panned between the pair of
+ *       loudspeakers enclosing them, for horizontal loudspeaker setups
  */
 void panner_setSpread(void* const hPan, float newValue);
 
@@ -266,6 +321,50 @@ void panner_setFlipPitch(void* const hPan, int newState);
  * (0: do not flip sign, 1: flip the sign)
  */
 void panner_setFlipRoll(void* const hPan, int newState);
+
+/**
+ * Enables/disables the clustering of sources (0: disabled, 1: enabled)
+ *
+ * When enabled, and there are more sources than panner_getMaxNumClusters(),
+ * the sources are merged per frame into clusters of nearby sources, and the
+ * clusters are transformed and panned (towards their centroids) in place of
+ * the individual sources; the cost of the filterbank and panning therefore
+ * depends on the number of clusters, rather than the number of sources. The
+ * assignment of sources to clusters is kept for as long as possible, and
+ * any changes (of assignment, or of the cluster gains) are cross-faded.
+ *
+ * @note Only applies to 3-D panning with frequency-dependent gains (i.e. a
+ *       room coefficient above 0), as the time-domain path of
+ *       panner_setDTT() has no filterbank to save on.
+ */
+void panner_setEnableClustering(void* const hPan, int newState);
+
+/**
+ * Sets the maximum number of clusters (1..panner_getMaxNumSources())
+ */
+void panner_setMaxNumClusters(void* const hPan, int newValue);
+
+/**
+ * Sets the angular threshold, in DEGREES, within which sources are merged into
+ * the same cluster (PANNER_CLUSTER_THRESHOLD_MIN_VALUE..
+ * PANNER_CLUSTER_THRESHOLD_MAX_VALUE). If more clusters would be needed,
+ * sources join the nearest cluster regardless
+ */
+void panner_setClusterThreshold(void* const hPan, float newValue_deg);
+
+/**
+ * Sets the number of sources in the whole scene (default: 0, i.e. the number
+ * of sources of this instance), by which the output is normalised
+ *
+ * This allows a large scene to be rendered by several instances (e.g. on
+ * different machines), each panning a subset of its sources, and for their
+ * outputs to be summed (see saf_partialMix.h); which is then the same as
+ * panning all of the sources with one instance.
+ *
+ * @note With clustering enabled, each instance only clusters its own subset
+ *       of the sources.
+ */
+void panner_setNumSceneSources(void* const hPan, int newValue);
     
     
 /* ========================================================================== */
@@ -379,11 +478,47 @@ int panner_getFlipPitch(void* const hPan);
  */
 int panner_getFlipRoll(void* const hPan);
 
+/**
+ * Returns whether the clustering of sources is enabled (0: disabled,
+ * 1: enabled)
+ */
+int panner_getEnableClustering(void* const hPan);
+
+/**
+ * Returns the maximum number of clusters
+ */
+int panner_getMaxNumClusters(void* const hPan);
+
+/**
+ * Returns the angular threshold for merging sources into clusters, in DEGREES
+ */
+float panner_getClusterThreshold(void* const hPan);
+
+/**
+ * Returns the number of clusters currently in use (0: the sources are not
+ * being clustered)
+ */
+int panner_getNumActiveClusters(void* const hPan);
+
+/**
+ * Returns the number of sources in the whole scene (0: those of this
+ * instance), see panner_setNumSceneSources()
+ */
+int panner_getNumSceneSources(void* const hPan);
+
 /**
  * Returns the processing delay in samples (may be used for delay compensation
- * features) 
+ * features), which includes the latency of the internal FIFO, if any (i.e. if
+ * the host block size is not a multiple of FRAME_SIZE)
+ */
+int panner_getProcessingDelay(void* const hPan);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
  */
-int panner_getProcessingDelay(void);
+void* panner_getTelemetry(void* const hPan);
 
 
 #ifdef __cplusplus
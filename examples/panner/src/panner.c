@@ -42,6 +42,36 @@
  
 #include "panner_internal.h"
 
+/**
+ * Hands the direction of a source over to the processing loop, which applies
+ * it at the start of the next frame
+ */
+static void panner_pushSourceDir
+(
+    panner_data* pData,
+    int ch
+)
+{
+    saf_paramQueue_push(pData->hParamQueue, PANNER_PARAM_SOURCE_DIR(ch), pData->src_dirs_deg[ch], 2);
+}
+
+/**
+ * Hands the current orientation over to the processing loop, which applies it
+ * at the start of the next frame
+ */
+static void panner_pushOrientation
+(
+    panner_data* pData
+)
+{
+    float values[3];
+
+    values[0] = pData->yaw;
+    values[1] = pData->pitch;
+    values[2] = pData->roll;
+    saf_paramQueue_push(pData->hParamQueue, PANNER_PARAM_ORIENTATION, values, 3);
+}
+
 void panner_create
 (
     void ** const phPan
@@ -49,21 +79,10 @@ void panner_create
 {
     panner_data* pData = (panner_data*)malloc1d(sizeof(panner_data));
     *phPan = (void*)pData;
-    int ch, dummy;
+    int ch, i, dummy;
     
     /* time-frequency transform + buffers */
     pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_INPUTS*sizeof(complexVector));
-    pData->STFTOutputFrameTF = malloc1d(MAX_NUM_OUTPUTS*sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_INPUTS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    for(ch=0; ch< MAX_NUM_OUTPUTS; ch++) {
-        pData->STFTOutputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTOutputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
-    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_INPUTS, MAX_NUM_OUTPUTS), HOP_SIZE, sizeof(float));
     
     /* flags and gain table */
     pData->progressBar0_1 = 0.0f;
@@ -73,7 +92,31 @@ void panner_create
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
     for(ch=0; ch<MAX_NUM_INPUTS; ch++)
         pData->recalc_gainsFLAG[ch] = 1;
-    pData->vbap_gtable = NULL;
+    pData->hVbapTrk2D = NULL;
+    pData->hVbapTable = NULL;
+    pData->vbapTable_nLoudpkrs = 0;
+    pData->vbap_gtableComp = NULL;
+    pData->vbap_gtableIdx = NULL;
+    pData->vbap_nGains = 0;
+    pData->G_srcComp = NULL;
+    pData->G_srcIdx = NULL;
+    pData->G_srcMaxGains = 0;
+    pData->G_srcPrev = NULL;
+    pData->G_srcPrevIdx = NULL;
+    pData->G_clusComp = NULL;
+    pData->G_clusIdx = NULL;
+    pData->G_clusPrev = NULL;
+    pData->G_clusPrevIdx = NULL;
+    pData->nCH_STFT = 0;
+    pData->clus_nClusters = 0;
+    pData->recalc_clusGainsFLAG = 1;
+    panner_resetClusters(pData);
+    for(i=0; i<2*TIME_SLOTS; i++)
+        pData->rampTF[i] = (float)(i/2+1)/(float)TIME_SLOTS;
+    pData->enableTDpanning = 0;
+    memset(pData->inputDelayTD, 0, MAX_NUM_INPUTS*(TD_DELAY+FRAME_SIZE)*sizeof(float));
+    for(i=0; i<FRAME_SIZE; i++)
+        pData->rampTD[i] = (float)(i+1)/(float)FRAME_SIZE;
     pData->recalc_M_rotFLAG = 1;
     pData->reInitGainTables = 1;
     
@@ -90,6 +133,21 @@ void panner_create
     pData->bFlipYaw = 0;
     pData->bFlipPitch = 0;
     pData->bFlipRoll = 0;
+    pData->enableClustering = 0;
+    pData->maxNumClusters = 32;
+    pData->clusterThreshold_deg = 10.0f;
+    pData->nSceneSources = 0;
+    
+    /* parameter updates are handed over to the processing loop via a queue */
+    saf_paramQueue_create(&(pData->hParamQueue), PANNER_NUM_PARAMS, 3);
+    memcpy(pData->src_dirs_proc_deg, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+    pData->ypr_proc[0] = pData->yaw;
+    pData->ypr_proc[1] = pData->pitch;
+    pData->ypr_proc[2] = pData->roll;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_INPUTS, MAX_NUM_OUTPUTS);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void panner_destroy
@@ -98,7 +156,6 @@ void panner_destroy
 )
 {
     panner_data *pData = (panner_data*)(*phPan);
-    int ch;
 
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -110,21 +167,22 @@ void panner_destroy
         /* free afSTFT and buffers */
         if(pData->hSTFT !=NULL)
             afSTFTfree(pData->hSTFT);
-        for(ch=0; ch< MAX_NUM_INPUTS; ch++) {
-            free(pData->STFTInputFrameTF[ch].re);
-            free(pData->STFTInputFrameTF[ch].im);
-        }
     
-        for (ch = 0; ch< MAX_NUM_OUTPUTS; ch++) {
-            free(pData->STFTOutputFrameTF[ch].re);
-            free(pData->STFTOutputFrameTF[ch].im);
-        }
-        free(pData->STFTInputFrameTF);
-        free(pData->STFTOutputFrameTF);
-        free(pData->tempHopFrameTD);
-        free1d((void**)&(pData->vbap_gtable));
+        vbapTracker2D_destroy(&(pData->hVbapTrk2D));
+        vbapTable3D_destroy(&(pData->hVbapTable));
+        free(pData->G_srcComp);
+        free(pData->G_srcIdx);
+        free(pData->G_srcPrev);
+        free(pData->G_srcPrevIdx);
+        free(pData->G_clusComp);
+        free(pData->G_clusIdx);
+        free(pData->G_clusPrev);
+        free(pData->G_clusPrevIdx);
         free(pData->progressBarText);
         
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        saf_paramQueue_destroy(&(pData->hParamQueue));
         free(pData);
         pData = NULL;
     }
@@ -161,6 +219,7 @@ void panner_initCodec
 )
 {
     panner_data *pData = (panner_data*)(hPan);
+    int band, enableTDpanning;
     
     if (pData->codecStatus != CODEC_STATUS_NOT_INITIALISED)
         return; /* re-init not required, or already happening */
@@ -174,6 +233,7 @@ void panner_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
     
     /* reinit TFT if needed */
     panner_initTFT(hPan);
@@ -182,7 +242,23 @@ void panner_initCodec
     if(pData->reInitGainTables){
         panner_initGainTables(hPan);
         pData->reInitGainTables = 0;
+        
+        /* (whether the sources may be clustered depends on the dimensionality
+         * of the layout, which is only known now) */
+        panner_initTFT(hPan);
+    }
+    
+    /* the panning gains are frequency-independent if no pValue
+     * normalisation is applied, in which case the sources are panned in the
+     * time-domain; the state of the other path is cleared when switching */
+    for(band=0, enableTDpanning = 1; band<HYBRID_BANDS; band++)
+        enableTDpanning = enableTDpanning && pData->pValue[band]==2.0f;
+    if(enableTDpanning != pData->enableTDpanning){
+        afSTFTclearBuffers(pData->hSTFT);
+        memset(pData->inputDelayTD, 0, MAX_NUM_INPUTS*(TD_DELAY+FRAME_SIZE)*sizeof(float));
+        pData->enableTDpanning = enableTDpanning;
     }
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -191,32 +267,526 @@ void panner_initCodec
     
 }
 
-void panner_process
+void panner_prepareToPlay
+(
+    void* const hPan,
+    int nInputs,
+    int nOutputs,
+    int blockSize
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+
+    panner_initCodec(hPan);
+    saf_fifo_setHostBlockSize(pData->hFIFO, blockSize);
+
+    /* pre-fault the VBAP gain tables */
+    if(pData->vbap_gtableComp!=NULL){
+        saf_warmUp_touch(pData->vbap_gtableComp, (pData->N_vbap_gtable)*(pData->vbap_nGains)*sizeof(float), 0);
+        saf_warmUp_touch(pData->vbap_gtableIdx, (pData->N_vbap_gtable)*(pData->vbap_nGains)*sizeof(int), 0);
+    }
+    saf_warmUp_run(hPan, &panner_process, nInputs, nOutputs, blockSize, SAF_WARMUP_NUM_SAMPLES);
+}
+
+/** Rotates the direction of one source, and flags its gains for recalculation */
+static void panner_rotateSource
+(
+    panner_data* pData,
+    int ch
+)
+{
+    float hypotxy;
+    
+    pData->src_dirs_xyz[ch][0] = cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][1])) * cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][0]));
+    pData->src_dirs_xyz[ch][1] = cosf(DEG2RAD(pData->src_dirs_proc_deg[ch][1])) * sinf(DEG2RAD(pData->src_dirs_proc_deg[ch][0]));
+    pData->src_dirs_xyz[ch][2] = sinf(DEG2RAD(pData->src_dirs_proc_deg[ch][1]));
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 3, 3, 1.0f,
+                pData->src_dirs_xyz[ch], 3,
+                (float*)pData->Rxyz, 3, 0.0f,
+                pData->src_dirs_rot_xyz[ch], 3);
+    hypotxy = sqrtf(powf(pData->src_dirs_rot_xyz[ch][0], 2.0f) + powf(pData->src_dirs_rot_xyz[ch][1], 2.0f));
+    pData->src_dirs_rot_deg[ch][0] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[ch][1], pData->src_dirs_rot_xyz[ch][0]));
+    pData->src_dirs_rot_deg[ch][1] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[ch][2], hypotxy));
+    pData->recalc_gainsFLAG[ch] = 1;
+}
+
+/**
+ * Applies the parameter updates handed over by the setters. A new source
+ * direction only requires that source to be rotated (unless the rotation
+ * matrix changed too, in which case all sources are rotated anyway)
+ */
+static void panner_applyParamUpdates
+(
+    panner_data* pData,
+    int nSources
+)
+{
+    int param, ch;
+    float values[3];
+    
+    while(saf_paramQueue_pop(pData->hParamQueue, &param, values, NULL)){
+        if(param==PANNER_PARAM_ORIENTATION){
+            memcpy(pData->ypr_proc, values, 3*sizeof(float));
+            pData->recalc_M_rotFLAG = 1;
+        }
+        else{
+            ch = param - PANNER_PARAM_SOURCE_DIR(0);
+            memcpy(pData->src_dirs_proc_deg[ch], values, 2*sizeof(float));
+            if(ch<nSources && !pData->recalc_M_rotFLAG)
+                panner_rotateSource(pData, ch);
+        }
+    }
+}
+
+/** Rotates the source directions, if needed */
+static void panner_rotateSources
+(
+    panner_data* pData,
+    int nSources
+)
+{
+    int i;
+#ifdef SAF_ENABLE_FAST_MATH
+    float azi[MAX_NUM_INPUTS], elev[MAX_NUM_INPUTS], x[MAX_NUM_INPUTS], y[MAX_NUM_INPUTS], z[MAX_NUM_INPUTS];
+#endif
+    
+    if(pData->recalc_M_rotFLAG){
+        pData->recalc_M_rotFLAG = 0;
+        yawPitchRoll2Rzyx (pData->ypr_proc[0], pData->ypr_proc[1], pData->ypr_proc[2], 0, pData->Rxyz);
+#ifdef SAF_ENABLE_FAST_MATH
+        /* as panner_rotateSource(), but with the batched coordinate conversions
+         * over all of the sources (and one matrix multiplication) */
+        for(i=0; i<nSources; i++){
+            azi[i] = DEG2RAD(pData->src_dirs_proc_deg[i][0]);
+            elev[i] = DEG2RAD(pData->src_dirs_proc_deg[i][1]);
+        }
+        unitSph2CartBatch(azi, elev, nSources, x, y, z);
+        for(i=0; i<nSources; i++){
+            pData->src_dirs_xyz[i][0] = x[i];
+            pData->src_dirs_xyz[i][1] = y[i];
+            pData->src_dirs_xyz[i][2] = z[i];
+        }
+        if(nSources>0)
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSources, 3, 3, 1.0f,
+                        (float*)pData->src_dirs_xyz, 3,
+                        (float*)pData->Rxyz, 3, 0.0f,
+                        (float*)pData->src_dirs_rot_xyz, 3);
+        for(i=0; i<nSources; i++){
+            x[i] = pData->src_dirs_rot_xyz[i][0];
+            y[i] = pData->src_dirs_rot_xyz[i][1];
+            z[i] = pData->src_dirs_rot_xyz[i][2];
+        }
+        unitCart2SphBatch(x, y, z, nSources, azi, elev);
+        for(i=0; i<nSources; i++){
+            pData->src_dirs_rot_deg[i][0] = RAD2DEG(azi[i]);
+            pData->src_dirs_rot_deg[i][1] = RAD2DEG(elev[i]);
+            pData->recalc_gainsFLAG[i] = 1;
+        }
+#else
+        for(i=0; i<nSources; i++)
+            panner_rotateSource(pData, i);
+#endif
+    }
+}
+
+/**
+ * Applies the pValue normalisation of each band to the (non-zero) panning
+ * gains of one direction
+ *
+ * @param[in]  pData  panner data
+ * @param[in]  gains  Panning gains; nGains x 1
+ * @param[in]  nGains Number of gains
+ * @param[out] G_comp Gains of the first band; the gains of band 'b' are
+ *                    written at G_comp[b*MAX_NUM_INPUTS*G_srcMaxGains]
+ */
+static void panner_applyPValues
+(
+    panner_data* pData,
+    const float* gains,
+    int nGains,
+    float* G_comp
+)
+{
+    int k, band, maxGains;
+    float pv_f, gains_sum_pvf;
+    float* G_srcComp;
+
+    maxGains = pData->G_srcMaxGains;
+    for (band = 0; band < HYBRID_BANDS; band++){
+        G_srcComp = &(G_comp[band*MAX_NUM_INPUTS*maxGains]);
+        /* apply pValue per frequency */
+        pv_f = pData->pValue[band];
+        if(pv_f != 2.0f){
+            gains_sum_pvf = 0.0f;
+            for (k = 0; k < nGains; k++)
+                gains_sum_pvf += powf(MAX(gains[k], 0.0f), pv_f);
+            gains_sum_pvf = powf(gains_sum_pvf, 1.0f/(pv_f+2.23e-9f));
+            for (k = 0; k < nGains; k++)
+                G_srcComp[k] = gains[k] / (gains_sum_pvf+2.23e-9f);
+        }
+        else
+            memcpy(G_srcComp, gains, nGains*sizeof(float));
+    }
+}
+
+/**
+ * Computes the frequency dependent 3-D panning gains for one direction of the
+ * VBAP table (only the non-zero gains are stored). The table holds the VBAP
+ * gains, whereas the MDAP gains are computed for the table direction using the
+ * current spread, so that the spread may be changed without regenerating the
+ * table
+ *
+ * @param[in]  pData  panner data
+ * @param[in]  idx3d  Index of the direction in the VBAP table
+ * @param[out] G_comp Gains of the first band; the gains of band 'b' are
+ *                    written at G_comp[b*MAX_NUM_INPUTS*G_srcMaxGains]
+ * @param[out] G_idx  Loudspeaker indices of the gains; G_srcMaxGains x 1
+ * @returns Number of gains
+ */
+static int panner_calcGains3DtableIdx
+(
+    panner_data* pData,
+    int idx3d,
+    float* G_comp,
+    int* G_idx
+)
+{
+    int nGains;
+    float gains3D[MAX_NUM_OUTPUTS];
+    
+    nGains = vbapTable3D_getSpreadGains(pData->hVbapTable, idx3d, pData->spread_deg, pData->G_srcMaxGains, gains3D, G_idx);
+    panner_applyPValues(pData, gains3D, nGains, G_comp);
+    return nGains;
+}
+
+/**
+ * Recalculates the frequency dependent panning gains of a source, if needed;
+ * from the 3-D VBAP table, or (2-D layouts) with the pair tracker, which
+ * starts its search from the pair that enclosed the source previously
+ */
+static void panner_calcGains
+(
+    panner_data* pData,
+    int ch
+)
+{
+    int maxGains, idx3d;
+    float gains2D[2];
+    
+    if(!pData->recalc_gainsFLAG[ch])
+        return;
+    maxGains = pData->G_srcMaxGains;
+    if(pData->hVbapTrk2D!=NULL){
+        pData->G_srcNumGains[ch] = vbapTracker2D_getGains(pData->hVbapTrk2D, ch, pData->src_dirs_rot_deg[ch][0], gains2D,
+                                                          &(pData->G_srcIdx[ch*maxGains]));
+        panner_applyPValues(pData, gains2D, pData->G_srcNumGains[ch], &(pData->G_srcComp[ch*maxGains]));
+    }
+    else{
+        idx3d = getVBAPgainTableIdx3D(pData->src_dirs_rot_deg[ch][0], pData->src_dirs_rot_deg[ch][1],
+                                      pData->vbapTableRes[0], pData->vbapTableRes[1]);
+        pData->G_srcNumGains[ch] = panner_calcGains3DtableIdx(pData, idx3d, &(pData->G_srcComp[ch*maxGains]),
+                                                              &(pData->G_srcIdx[ch*maxGains]));
+    }
+    pData->recalc_gainsFLAG[ch] = 0;
+}
+
+/**
+ * Pans one frame in the time-domain (frequency-independent gains); only
+ * the (at most G_srcNumGains) loudspeakers of each source are touched, and
+ * when the gains of a source change, the previous and new gains are
+ * cross-faded over the frame
+ */
+static void panner_processFrameTD
+(
+    panner_data* pData,
+    float ** const inputs,
+    float ** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSources,
+    int nLoudspeakers
+)
+{
+    int i, ch, k, maxGains, nGains, nPrev;
+    float scale;
+    float* x, *x_ramp, *x_rampInv, *G_src, *G_prev;
+    int* G_idx, *G_prevIdx;
+    
+    /* delay the input signals to match the filterbank path */
+    for(i=0; i < MIN(nSources,nInputs); i++)
+        utility_svvcopy(inputs[i], FRAME_SIZE, &(pData->inputDelayTD[i][TD_DELAY]));
+    for(; i<nSources; i++)
+        memset(&(pData->inputDelayTD[i][TD_DELAY]), 0, FRAME_SIZE * sizeof(float));
+    memset(pData->outputFrameTD, 0, MAX_NUM_OUTPUTS*FRAME_SIZE*sizeof(float));
+    
+    panner_rotateSources(pData, nSources);
+    maxGains = pData->G_srcMaxGains;
+    x_ramp = pData->tmpFrameTD[0];
+    x_rampInv = pData->tmpFrameTD[1];
+    for (ch = 0; ch < nSources; ch++) {
+        /* keep the gains of the previous frame, in case they change */
+        if(pData->recalc_gainsFLAG[ch]){
+            nPrev = pData->G_srcNumGains[ch];
+            memcpy(&(pData->G_srcPrev[ch*maxGains]), &(pData->G_srcComp[ch*maxGains]), nPrev*sizeof(float));
+            memcpy(&(pData->G_srcPrevIdx[ch*maxGains]), &(pData->G_srcIdx[ch*maxGains]), nPrev*sizeof(int));
+            pData->G_srcPrevNumGains[ch] = nPrev;
+            panner_calcGains(pData, ch);
+            pData->G_srcRampFLAG[ch] = nPrev>0 && (nPrev!=pData->G_srcNumGains[ch] ||
+                memcmp(&(pData->G_srcPrev[ch*maxGains]), &(pData->G_srcComp[ch*maxGains]), nPrev*sizeof(float)) ||
+                memcmp(&(pData->G_srcPrevIdx[ch*maxGains]), &(pData->G_srcIdx[ch*maxGains]), nPrev*sizeof(int)));
+        }
+        
+        /* (the gains are the same for all bands, so those of the first band are used) */
+        x = pData->inputDelayTD[ch];
+        nGains = pData->G_srcNumGains[ch];
+        G_src = &(pData->G_srcComp[ch*maxGains]);
+        G_idx = &(pData->G_srcIdx[ch*maxGains]);
+        if(pData->G_srcRampFLAG[ch]){
+            utility_svvmul(x, pData->rampTD, FRAME_SIZE, x_ramp);
+            utility_svvsub(x, x_ramp, FRAME_SIZE, x_rampInv);
+            G_prev = &(pData->G_srcPrev[ch*maxGains]);
+            G_prevIdx = &(pData->G_srcPrevIdx[ch*maxGains]);
+            for (k = 0; k < pData->G_srcPrevNumGains[ch]; k++)
+                if(G_prev[k] != 0.0f)
+                    cblas_saxpy(FRAME_SIZE, G_prev[k], x_rampInv, 1, pData->outputFrameTD[G_prevIdx[k]], 1);
+            for (k = 0; k < nGains; k++)
+                if(G_src[k] != 0.0f)
+                    cblas_saxpy(FRAME_SIZE, G_src[k], x_ramp, 1, pData->outputFrameTD[G_idx[k]], 1);
+            pData->G_srcRampFLAG[ch] = 0;
+        }
+        else{
+            for (k = 0; k < nGains; k++)
+                if(G_src[k] != 0.0f)
+                    cblas_saxpy(FRAME_SIZE, G_src[k], x, 1, pData->outputFrameTD[G_idx[k]], 1);
+        }
+        
+        /* shift the delay line */
+        memmove(x, &x[FRAME_SIZE], TD_DELAY*sizeof(float));
+    }
+    
+    /* scale by sqrt(number of sources; i.e. of the whole scene, when only a part
+     * of it is rendered by this instance) */
+    scale = 1.0f/sqrtf((float)(pData->nSceneSources > 0 ? pData->nSceneSources : nSources));
+    for (ch = 0; ch < MIN(nLoudspeakers, nOutputs); ch++)
+        utility_svsmul(pData->outputFrameTD[ch], &scale, FRAME_SIZE, outputs[ch]);
+    for (; ch < nOutputs; ch++)
+        memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+}
+
+/**
+ * Merges the sources into (at most clus_nClusters) clusters, and mixes their
+ * signals into clusFrameTD.
+ *
+ * The assignments are kept from frame to frame: a source stays in its cluster
+ * for as long as it remains within the threshold (plus a hysteresis) of the
+ * centroid; otherwise it joins the nearest cluster within the threshold, or
+ * opens a free one (if all are in use, it joins the nearest cluster). A source
+ * that changes cluster is cross-faded from the old one to the new one over
+ * the frame. The centroids are the mean directions of the sources in each
+ * cluster, and the gains of a cluster are only re-computed (and then
+ * cross-faded, see panner_panClustersTF()) when its centroid moves to another
+ * direction of the VBAP table
+ */
+static void panner_clusterSources
+(
+    panner_data* pData,
+    int nSources
+)
+{
+    int ch, c, best, band, maxGains, nClusters, idx3d, recalcAll;
+    float cosKeep, cosJoin, dot, bestDot, norm, hypotxy;
+    float* x_ramp, *x_rampInv, *x;
+    
+    nClusters = pData->clus_nClusters;
+    maxGains = pData->G_srcMaxGains;
+    cosJoin = cosf(DEG2RAD(pData->clusterThreshold_deg));
+    cosKeep = cosf(DEG2RAD(MIN(pData->clusterThreshold_deg+CLUSTER_HYSTERESIS_DEG, 180.0f)));
+    
+    /* sources stay in their cluster while they remain close to its centroid */
+    for(c=0; c<nClusters; c++){
+        pData->clus_nMembersPrev[c] = pData->clus_nMembers[c];
+        pData->clus_nMembers[c] = 0;
+    }
+    for(ch=0; ch<nSources; ch++){
+        pData->clus_prevOf[ch] = c = pData->clus_of[ch];
+        if(c>=0 && cblas_sdot(3, pData->src_dirs_rot_xyz[ch], 1, pData->clus_xyz[c], 1) >= cosKeep)
+            pData->clus_nMembers[c]++;
+        else
+            pData->clus_of[ch] = -1;
+    }
+    
+    /* the others join the nearest cluster, or open a new one (preferably one
+     * that was also empty in the previous frame, so that no fading-out source
+     * shares it) */
+    for(ch=0; ch<nSources; ch++){
+        if(pData->clus_of[ch]>=0)
+            continue;
+        best = -1;
+        bestDot = -2.0f;
+        for(c=0; c<nClusters; c++){
+            if(pData->clus_nMembers[c]==0)
+                continue;
+            dot = cblas_sdot(3, pData->src_dirs_rot_xyz[ch], 1, pData->clus_xyz[c], 1);
+            if(dot>bestDot){
+                bestDot = dot;
+                best = c;
+            }
+        }
+        if(best<0 || bestDot<cosJoin){
+            for(c=0; c<nClusters; c++)
+                if(pData->clus_nMembers[c]==0 && pData->clus_nMembersPrev[c]==0)
+                    break;
+            if(c==nClusters)
+                for(c=0; c<nClusters; c++)
+                    if(pData->clus_nMembers[c]==0)
+                        break;
+            if(c<nClusters){
+                best = c;
+                memcpy(pData->clus_xyz[c], pData->src_dirs_rot_xyz[ch], 3*sizeof(float));
+            }
+        }
+        pData->clus_of[ch] = best;
+        pData->clus_nMembers[best]++;
+    }
+    
+    /* centroids */
+    memset(pData->clus_xyz, 0, nClusters*3*sizeof(float));
+    for(ch=0; ch<nSources; ch++)
+        cblas_saxpy(3, 1.0f, pData->src_dirs_rot_xyz[ch], 1, pData->clus_xyz[pData->clus_of[ch]], 1);
+    
+    /* cluster gains (only for the directions that changed) */
+    recalcAll = pData->recalc_clusGainsFLAG;
+    pData->recalc_clusGainsFLAG = 0;
+    pData->clus_nActive = 0;
+    for(c=0; c<nClusters; c++){
+        if(pData->clus_nMembers[c]==0)
+            continue;
+        pData->clus_nActive++;
+        norm = cblas_snrm2(3, pData->clus_xyz[c], 1);
+        if(norm<1e-6f){ /* (opposing sources in one cluster) */
+            for(ch=0; ch<nSources && pData->clus_of[ch]!=c; ch++);
+            memcpy(pData->clus_xyz[c], pData->src_dirs_rot_xyz[ch], 3*sizeof(float));
+        }
+        else
+            cblas_sscal(3, 1.0f/norm, pData->clus_xyz[c], 1);
+        hypotxy = sqrtf(powf(pData->clus_xyz[c][0], 2.0f) + powf(pData->clus_xyz[c][1], 2.0f));
+        pData->clus_dirs_deg[c][0] = RAD2DEG(atan2f(pData->clus_xyz[c][1], pData->clus_xyz[c][0]));
+        pData->clus_dirs_deg[c][1] = RAD2DEG(atan2f(pData->clus_xyz[c][2], hypotxy));
+        idx3d = getVBAPgainTableIdx3D(pData->clus_dirs_deg[c][0], pData->clus_dirs_deg[c][1],
+                                      pData->vbapTableRes[0], pData->vbapTableRes[1]);
+        if(idx3d!=pData->clus_idx3d[c] || recalcAll){
+            /* keep the previous gains, if the cluster was in use */
+            pData->G_clusPrevNumGains[c] = pData->clus_nMembersPrev[c]>0 ? pData->G_clusNumGains[c] : 0;
+            if(pData->G_clusPrevNumGains[c]>0){
+                for(band=0; band<HYBRID_BANDS; band++)
+                    memcpy(&(pData->G_clusPrev[(band*MAX_NUM_INPUTS + c)*maxGains]),
+                           &(pData->G_clusComp[(band*MAX_NUM_INPUTS + c)*maxGains]), maxGains*sizeof(float));
+                memcpy(&(pData->G_clusPrevIdx[c*maxGains]), &(pData->G_clusIdx[c*maxGains]), maxGains*sizeof(int));
+            }
+            pData->G_clusNumGains[c] = panner_calcGains3DtableIdx(pData, idx3d, &(pData->G_clusComp[c*maxGains]),
+                                                                  &(pData->G_clusIdx[c*maxGains]));
+            pData->G_clusRampFLAG[c] = pData->G_clusPrevNumGains[c]>0;
+            pData->clus_idx3d[c] = idx3d;
+        }
+    }
+    
+    /* mix the source signals into their clusters */
+    memset(pData->clusFrameTD, 0, nClusters*FRAME_SIZE*sizeof(float));
+    x_ramp = pData->tmpFrameTD[0];
+    x_rampInv = pData->tmpFrameTD[1];
+    for(ch=0; ch<nSources; ch++){
+        x = pData->inputFrameTD[ch];
+        c = pData->clus_prevOf[ch];
+        if(c>=0 && c!=pData->clus_of[ch]){
+            utility_svvmul(x, pData->rampTD, FRAME_SIZE, x_ramp);
+            utility_svvsub(x, x_ramp, FRAME_SIZE, x_rampInv);
+            cblas_saxpy(FRAME_SIZE, 1.0f, x_rampInv, 1, pData->clusFrameTD[c], 1);
+            cblas_saxpy(FRAME_SIZE, 1.0f, x_ramp, 1, pData->clusFrameTD[pData->clus_of[ch]], 1);
+        }
+        else
+            cblas_saxpy(FRAME_SIZE, 1.0f, x, 1, pData->clusFrameTD[pData->clus_of[ch]], 1);
+    }
+}
+
+/**
+ * Applies the 3-D panning gains of the clusters to their TF-domain signals;
+ * when the gains of a cluster change, the previous and new gains are
+ * cross-faded over the time slots of the frame
+ */
+static void panner_panClustersTF
+(
+    panner_data* pData
+)
+{
+    int c, k, band, maxGains;
+    float x_ramp[2*TIME_SLOTS], x_rampInv[2*TIME_SLOTS];
+    float* x, *G_comp, *G_prev;
+    
+    maxGains = pData->G_srcMaxGains;
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        for (c = 0; c < pData->clus_nClusters; c++) {
+            if(pData->clus_nMembers[c]==0 && pData->clus_nMembersPrev[c]==0)
+                continue; /* (silent) */
+            x = (float*)pData->inputframeTF[band][c];
+            G_comp = &(pData->G_clusComp[(band*MAX_NUM_INPUTS + c)*maxGains]);
+            if(pData->G_clusRampFLAG[c]){
+                utility_svvmul(x, pData->rampTF, 2*TIME_SLOTS, x_ramp);
+                utility_svvsub(x, x_ramp, 2*TIME_SLOTS, x_rampInv);
+                G_prev = &(pData->G_clusPrev[(band*MAX_NUM_INPUTS + c)*maxGains]);
+                for (k = 0; k < pData->G_clusPrevNumGains[c]; k++)
+                    if(G_prev[k] != 0.0f)
+                        cblas_saxpy(2*TIME_SLOTS, G_prev[k], x_rampInv, 1,
+                                    (float*)pData->outputframeTF[band][pData->G_clusPrevIdx[c*maxGains+k]], 1);
+                x = x_ramp;
+            }
+            for (k = 0; k < pData->G_clusNumGains[c]; k++)
+                if(G_comp[k] != 0.0f)
+                    cblas_saxpy(2*TIME_SLOTS, G_comp[k], x, 1,
+                                (float*)pData->outputframeTF[band][pData->G_clusIdx[c*maxGains+k]], 1);
+        }
+    }
+    for (c = 0; c < pData->clus_nClusters; c++)
+        pData->G_clusRampFLAG[c] = 0;
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void panner_processFrame
 (
     void  *  const hPan,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     panner_data *pData = (panner_data*)(hPan);
-    int t, ch, ls, i, band, nSources, nLoudspeakers, N_azi, aziIndex, elevIndex, idx3d, idx2D;
-    float aziRes, elevRes, pv_f, gains3D_sum_pvf, gains2D_sum_pvf, Rxyz[3][3], hypotxy;
-    float src_dirs[MAX_NUM_INPUTS][2], pValue[HYBRID_BANDS], gains3D[MAX_NUM_OUTPUTS], gains2D[MAX_NUM_OUTPUTS];
-	const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-	float_complex outputTemp[MAX_NUM_OUTPUTS][TIME_SLOTS];
+    int t, ch, ls, i, k, band, nSources, nLoudspeakers, maxGains, clustered;
+    float scale;
+    float pValue[HYBRID_BANDS];
+    float* G_srcComp;
+    float* pInputFrameTD[MAX_NUM_INPUTS], *pOutputFrameTD[MAX_NUM_OUTPUTS];
 
     /* apply panner */
-    if ((nSamples == FRAME_SIZE) && (pData->vbap_gtable != NULL) && (pData->codecStatus == CODEC_STATUS_INITIALISED) ) {
+    if ((pData->hVbapTrk2D != NULL || pData->vbap_gtableComp != NULL) && (pData->codecStatus == CODEC_STATUS_INITIALISED) ) {
         pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
         
         /* copy user parameters to local variables */
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
         memcpy(pValue, pData->pValue, HYBRID_BANDS*sizeof(float));
         nSources = pData->nSources;
         nLoudspeakers = pData->nLoudpkrs;
+        panner_applyParamUpdates(pData, nSources);
+        
+        /* frequency-independent panning is applied directly in the time-domain */
+        if(pData->enableTDpanning){
+            panner_processFrameTD(pData, inputs, outputs, nInputs, nOutputs, nSources, nLoudspeakers);
+            saf_telemetry_frameEnd(pData->hTelemetry);
+            pData->procStatus = PROC_STATUS_NOT_ONGOING;
+            return;
+        }
         
         /* Load time-domain data */
         for(i=0; i < MIN(nSources,nInputs); i++)
@@ -224,146 +794,116 @@ void panner_process
         for(; i<MAX_NUM_INPUTS; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
-        /* Apply time-frequency transform (TFT) */
-        for(t=0; t< TIME_SLOTS; t++) {
-            for(ch = 0; ch < nSources; ch++)
-                utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < nSources; ch++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+        /* Rotate source directions */
+        panner_rotateSources(pData, nSources);
+        
+        /* Apply time-frequency transform (TFT); to the clusters of sources,
+         * if there are more sources than clusters */
+        clustered = pData->clus_nClusters>0 && pData->output_nDims == 3;
+        if(clustered){
+            panner_clusterSources(pData, nSources);
+            for(ch = 0; ch < pData->clus_nClusters; ch++)
+                pInputFrameTD[ch] = pData->clusFrameTD[ch];
         }
+        else
+            for(ch = 0; ch < nSources; ch++)
+                pInputFrameTD[ch] = pData->inputFrameTD[ch];
+        afSTFTforwardFrame(pData->hSTFT, pInputFrameTD, TIME_SLOTS, &(pData->inputframeTF[0][0][0]), MAX_NUM_INPUTS*TIME_SLOTS, TIME_SLOTS);
         memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
-		memset(outputTemp, 0, MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
         
         /* Main processing: */
-        /* Rotate source directions */
-        if(pData->recalc_M_rotFLAG){
-            yawPitchRoll2Rzyx (pData->yaw, pData->pitch, pData->roll, 0, Rxyz);
-            for(i=0; i<nSources; i++){
-                pData->src_dirs_xyz[i][0] = cosf(DEG2RAD(pData->src_dirs_deg[i][1])) * cosf(DEG2RAD(pData->src_dirs_deg[i][0]));
-                pData->src_dirs_xyz[i][1] = cosf(DEG2RAD(pData->src_dirs_deg[i][1])) * sinf(DEG2RAD(pData->src_dirs_deg[i][0]));
-                pData->src_dirs_xyz[i][2] = sinf(DEG2RAD(pData->src_dirs_deg[i][1]));
-                pData->recalc_gainsFLAG[i] = 1;
-            }
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSources, 3, 3, 1.0f,
-                        (float*)(pData->src_dirs_xyz), 3,
-                        (float*)Rxyz, 3, 0.0f,
-                        (float*)(pData->src_dirs_rot_xyz), 3);
-            for(i=0; i<nSources; i++){
-                hypotxy = sqrtf(powf(pData->src_dirs_rot_xyz[i][0], 2.0f) + powf(pData->src_dirs_rot_xyz[i][1], 2.0f));
-                pData->src_dirs_rot_deg[i][0] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[i][1], pData->src_dirs_rot_xyz[i][0]));
-                pData->src_dirs_rot_deg[i][1] = RAD2DEG(atan2f(pData->src_dirs_rot_xyz[i][2], hypotxy));
-            }
-            pData->recalc_M_rotFLAG = 0;
-        }
-            
         /* Apply VBAP Panning */
-        if(pData->output_nDims == 3){/* 3-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            elevRes = (float)pData->vbapTableRes[1];
-            N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-            for (ch = 0; ch < nSources; ch++) {
-                /* recalculate frequency dependent panning gains */
-                if(pData->recalc_gainsFLAG[ch]){
-                    //aziIndex = (int)(matlab_fmodf(pData->src_dirs_deg[ch][0] + 180.0f, 360.0f) / aziRes + 0.5f);
-                    //elevIndex = (int)((pData->src_dirs_deg[ch][1] + 90.0f) / elevRes + 0.5f);
-                    aziIndex = (int)(matlab_fmodf(pData->src_dirs_rot_deg[ch][0] + 180.0f, 360.0f) / aziRes + 0.5f);
-                    elevIndex = (int)((pData->src_dirs_rot_deg[ch][1] + 90.0f) / elevRes + 0.5f);
-                    idx3d = elevIndex * N_azi + aziIndex;
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains3D[ls] =  pData->vbap_gtable[idx3d*nLoudspeakers+ls];
-                    for (band = 0; band < HYBRID_BANDS; band++){
-                        /* apply pValue per frequency */
-                        pv_f = pData->pValue[band];
-                        if(pv_f != 2.0f){
-                            gains3D_sum_pvf = 0.0f;
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                gains3D_sum_pvf += powf(MAX(gains3D[ls], 0.0f), pv_f);
-                            gains3D_sum_pvf = powf(gains3D_sum_pvf, 1.0f/(pv_f+2.23e-9f));
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains3D[ls] / (gains3D_sum_pvf+2.23e-9f), 0.0f);
-                        }
-                        else
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains3D[ls], 0.0f);
-                    }
-                    pData->recalc_gainsFLAG[ch] = 0;
-                } 
-            }
-			/* apply panning gains */
-			for (band = 0; band < HYBRID_BANDS; band++) {
-				cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSources, &calpha,
-					pData->G_src[band], MAX_NUM_OUTPUTS,
-					pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-					outputTemp, TIME_SLOTS);
-				for (i = 0; i < nLoudspeakers; i++)
-					for (t = 0; t < TIME_SLOTS; t++)
-						pData->outputframeTF[band][i][t] = ccaddf(pData->outputframeTF[band][i][t], outputTemp[i][t]);
-			}
-        }
-        else{/* 2-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            for (ch = 0; ch < nSources; ch++) {
-                /* recalculate frequency dependent panning gains */
-                if(pData->recalc_gainsFLAG[ch]){
-                    //idx2D = (int)((matlab_fmodf(pData->src_dirs_deg[ch][0]+180.0f,360.0f)/aziRes)+0.5f);
-                    idx2D = (int)((matlab_fmodf(pData->src_dirs_rot_deg[ch][0]+180.0f,360.0f)/aziRes)+0.5f);
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D[ls] = pData->vbap_gtable[idx2D*nLoudspeakers+ls];
-                    for (band = 0; band < HYBRID_BANDS; band++){
-                        /* apply pValue per frequency */
-                        pv_f = pData->pValue[band];
-                        if(pv_f != 2.0f){
-                            gains2D_sum_pvf = 0.0f;
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                gains2D_sum_pvf += powf(MAX(gains2D[ls], 0.0f), pv_f);
-                            gains2D_sum_pvf = powf(gains2D_sum_pvf, 1.0f/(pv_f+2.23e-9f));
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains2D[ls] / (gains2D_sum_pvf+2.23e-9f), 0.0f);
-                        }
-                        else
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains2D[ls], 0.0f);
-                    }
-                    pData->recalc_gainsFLAG[ch] = 0;
-                }
-                /* apply panning gains */
-                for (band = 0; band < HYBRID_BANDS; band++){
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t], ccmulf(pData->inputframeTF[band][ch][t], pData->G_src[band][ch][ls]));
+        if(clustered)
+            panner_panClustersTF(pData);
+        else{
+            maxGains = pData->G_srcMaxGains;
+            for (ch = 0; ch < nSources; ch++)
+                panner_calcGains(pData, ch);
+            /* apply panning gains; the gains are real-valued, so each source
+             * is added to its (at most nGains) loudspeakers by treating the
+             * complex time slots as interleaved real vectors */
+            for (band = 0; band < HYBRID_BANDS; band++) {
+                for (ch = 0; ch < nSources; ch++) {
+                    G_srcComp = &(pData->G_srcComp[(band*MAX_NUM_INPUTS + ch)*maxGains]);
+                    for (k = 0; k < pData->G_srcNumGains[ch]; k++)
+                        if(G_srcComp[k] != 0.0f)
+                            cblas_saxpy(2*TIME_SLOTS, G_srcComp[k], (float*)pData->inputframeTF[band][ch], 1,
+                                        (float*)pData->outputframeTF[band][pData->G_srcIdx[ch*maxGains+k]], 1);
                 }
             }
         }
-        /* scale by sqrt(number of sources) */
+        /* scale by sqrt(number of sources; see panner_setNumSceneSources()) */
+        scale = 1.0f/sqrtf((float)(pData->nSceneSources > 0 ? pData->nSceneSources : nSources));
         for (band = 0; band < HYBRID_BANDS; band++)
             for (ls = 0; ls < nLoudspeakers; ls++)
                 for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ls][t] = crmulf(pData->outputframeTF[band][ls][t], 1.0f/sqrtf((float)nSources));
+                    pData->outputframeTF[band][ls][t] = crmulf(pData->outputframeTF[band][ls][t], scale);
          
         /* inverse-TFT */
-        for(t = 0; t < TIME_SLOTS; t++) {
-            for(band = 0; band < HYBRID_BANDS; band++) {
-                for(ch = 0; ch < nLoudspeakers; ch++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
-                }
-            }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(nLoudspeakers, nOutputs); ch++)
-                utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
-            for (; ch < nOutputs; ch++)
-                memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
-        }
+        for(ch = 0; ch < nLoudspeakers; ch++)
+            pOutputFrameTD[ch] = pData->outputFrameTD[ch];
+        afSTFTinverseFrame(pData->hSTFT, &(pData->outputframeTF[0][0][0]), MAX_NUM_OUTPUTS*TIME_SLOTS, TIME_SLOTS, TIME_SLOTS, pOutputFrameTD);
+        for (ch = 0; ch < MIN(nLoudspeakers, nOutputs); ch++)
+            utility_svvcopy(pData->outputFrameTD[ch], FRAME_SIZE, outputs[ch]);
+        for (; ch < nOutputs; ch++)
+            memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
-    else 
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    }
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+void panner_process
+(
+    void  *  const hPan,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &panner_processFrame, hPan);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void panner_processInterleaved
+(
+    void  *  const hPan,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &panner_processFrame, hPan);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
 
 /* Set Functions */
 
@@ -386,8 +926,7 @@ void panner_setSourceAzi_deg(void* const hPan, int index, float newAzi_deg)
     newAzi_deg = MIN(newAzi_deg, 180.0f);
     if(pData->src_dirs_deg[index][0] != newAzi_deg){
         pData->src_dirs_deg[index][0] = newAzi_deg;
-        pData->recalc_gainsFLAG[index] = 1;
-        pData->recalc_M_rotFLAG = 1;
+        panner_pushSourceDir(pData, index);
     }
 }
 
@@ -398,8 +937,7 @@ void panner_setSourceElev_deg(void* const hPan, int index, float newElev_deg)
     newElev_deg = MIN(newElev_deg, 90.0f);
     if(pData->src_dirs_deg[index][1] != newElev_deg){
         pData->src_dirs_deg[index][1] = newElev_deg;
-        pData->recalc_gainsFLAG[index] = 1;
-        pData->recalc_M_rotFLAG = 1;
+        panner_pushSourceDir(pData, index);
     }
 }
 
@@ -485,8 +1023,8 @@ void panner_setInputConfigPreset(void* const hPan, int newPresetID)
     panner_data *pData = (panner_data*)(hPan);
     int ch, dummy;
     panner_loadPreset(newPresetID, pData->src_dirs_deg, &(pData->new_nSources), &dummy);
-    for(ch=0; ch<pData->new_nSources; ch++)
-        pData->recalc_gainsFLAG[ch] = 1;
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+        panner_pushSourceDir(pData, ch);
     pData->recalc_M_rotFLAG = 1;
     panner_setCodecStatus(hPan, CODEC_STATUS_NOT_INITIALISED);
 }
@@ -500,6 +1038,7 @@ void panner_setDTT(void* const hPan, float newValue)
         getPvalues(pData->DTT, pData->freqVector, HYBRID_BANDS, pData->pValue);
         for(ch=0; ch<pData->new_nSources; ch++)
             pData->recalc_gainsFLAG[ch] = 1;
+        pData->recalc_clusGainsFLAG = 1;
         pData->recalc_M_rotFLAG = 1;
         panner_setCodecStatus(hPan, CODEC_STATUS_NOT_INITIALISED);
     }
@@ -511,11 +1050,11 @@ void panner_setSpread(void* const hPan, float newValue)
     int ch;
     if(pData->spread_deg!=newValue){
         pData->spread_deg = CLAMP(newValue, PANNER_SPREAD_MIN_VALUE, PANNER_SPREAD_MAX_VALUE);
-        pData->reInitGainTables=1;
+        /* the gain table does not depend on the spread, so only the panning
+         * gains of the sources need to be re-computed */
         for(ch=0; ch<MAX_NUM_INPUTS; ch++)
             pData->recalc_gainsFLAG[ch] = 1;
-        pData->recalc_M_rotFLAG = 1;
-        panner_setCodecStatus(hPan, CODEC_STATUS_NOT_INITIALISED);
+        pData->recalc_clusGainsFLAG = 1;
     }
 }
 
@@ -523,21 +1062,21 @@ void panner_setYaw(void  * const hBin, float newYaw)
 {
     panner_data *pData = (panner_data*)(hBin);
     pData->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
-    pData->recalc_M_rotFLAG = 1;
+    panner_pushOrientation(pData);
 }
 
 void panner_setPitch(void* const hBin, float newPitch)
 {
     panner_data *pData = (panner_data*)(hBin);
     pData->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
-    pData->recalc_M_rotFLAG = 1;
+    panner_pushOrientation(pData);
 }
 
 void panner_setRoll(void* const hBin, float newRoll)
 {
     panner_data *pData = (panner_data*)(hBin);
     pData->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
-    pData->recalc_M_rotFLAG = 1;
+    panner_pushOrientation(pData);
 }
 
 void panner_setFlipYaw(void* const hBin, int newState)
@@ -567,6 +1106,37 @@ void panner_setFlipRoll(void* const hBin, int newState)
     }
 }
 
+void panner_setEnableClustering(void* const hPan, int newState)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    if(pData->enableClustering != newState){
+        pData->enableClustering = newState;
+        panner_setCodecStatus(hPan, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void panner_setMaxNumClusters(void* const hPan, int newValue)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    newValue = CLAMP(newValue, 1, MAX_NUM_INPUTS);
+    if(pData->maxNumClusters != newValue){
+        pData->maxNumClusters = newValue;
+        panner_setCodecStatus(hPan, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void panner_setClusterThreshold(void* const hPan, float newValue_deg)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    pData->clusterThreshold_deg = CLAMP(newValue_deg, PANNER_CLUSTER_THRESHOLD_MIN_VALUE, PANNER_CLUSTER_THRESHOLD_MAX_VALUE);
+}
+
+void panner_setNumSceneSources(void* const hPan, int newValue)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    pData->nSceneSources = MAX(newValue, 0);
+}
+
 
 /* Get Functions */
 
@@ -688,9 +1258,46 @@ int panner_getFlipRoll(void* const hBin)
     return pData->bFlipRoll;
 }
 
-int panner_getProcessingDelay()
+int panner_getEnableClustering(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->enableClustering;
+}
+
+int panner_getMaxNumClusters(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->maxNumClusters;
+}
+
+float panner_getClusterThreshold(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->clusterThreshold_deg;
+}
+
+int panner_getNumActiveClusters(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->clus_nClusters>0 && !pData->enableTDpanning ? pData->clus_nActive : 0;
+}
+
+int panner_getNumSceneSources(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->nSceneSources;
+}
+
+int panner_getProcessingDelay(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return saf_fifo_getLatency(pData->hFIFO) + 12*HOP_SIZE;
+}
+
+void* panner_getTelemetry(void* const hPan)
 {
-    return 12*HOP_SIZE;
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->hTelemetry;
 }
 
 
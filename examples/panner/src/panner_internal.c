@@ -57,8 +57,8 @@ void panner_setCodecStatus(void* const hPan, PANNER_CODEC_STATUS newStatus)
 void panner_initGainTables(void* const hPan)
 {
     panner_data *pData = (panner_data*)(hPan);
-#ifndef FORCE_3D_LAYOUT
     int i;
+#ifndef FORCE_3D_LAYOUT
     float sum_elev;
     
     /* determine dimensionality */
@@ -71,28 +71,73 @@ void panner_initGainTables(void* const hPan)
         pData->output_nDims = 3;
 #endif
     
-    /* generate VBAP gain table */
-    free(pData->vbap_gtable);
+    /* generate VBAP gain table (the 3-D table is generated directly in its
+     * compressed form, as dense tables for large loudspeaker arrays are huge).
+     * 2-D layouts do not use a gain table, but a tracker of the loudspeaker
+     * pair enclosing each source */
+    pData->vbap_gtableComp = NULL;
+    pData->vbap_gtableIdx = NULL;
+    pData->vbap_nGains = 0;
     pData->vbapTableRes[0] = 1;
     pData->vbapTableRes[1] = 1;
 #ifdef FORCE_3D_LAYOUT
     pData->output_nDims = 3;
-    generateVBAPgainTable3D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1, pData->spread_deg,
-                            &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
-#else
-    if(pData->output_nDims==2)
-        generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0],
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
+#endif
+    if(pData->output_nDims==2){
+        vbapTable3D_destroy(&(pData->hVbapTable));
+        vbapTracker2D_destroy(&(pData->hVbapTrk2D));
+        vbapTracker2D_create(&(pData->hVbapTrk2D), (float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, MAX_NUM_INPUTS);
+        pData->N_vbap_gtable = 0;
+        pData->nTriangles = vbapTracker2D_getNumPairs(pData->hVbapTrk2D);
+    }
     else{
-        generateVBAPgainTable3D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1, pData->spread_deg,
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
-        if(pData->vbap_gtable==NULL){
+        vbapTracker2D_destroy(&(pData->hVbapTrk2D));
+        /* if only the loudspeaker directions have changed, the existing 3-D
+         * table is updated (incrementally, where possible). The table holds
+         * the VBAP gains; the spread is applied per source, when processing */
+        if(pData->hVbapTable!=NULL && pData->vbapTable_nLoudpkrs==pData->nLoudpkrs)
+            vbapTable3D_update(pData->hVbapTable, (float*)pData->loudpkrs_dirs_deg, 0.0f);
+        else{
+            void* hPar;
+            vbapTable3D_destroy(&(pData->hVbapTable));
+            saf_parfor_create(&hPar, SAF_PARFOR_NUM_THREADS_AUTO); /* (split over the grid directions) */
+            vbapTable3D_createParallel(&(pData->hVbapTable), hPar, (float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs,
+                                       pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1, 0.0f);
+            saf_parfor_destroy(&hPar);
+            pData->vbapTable_nLoudpkrs = pData->nLoudpkrs;
+        }
+        vbapTable3D_getTable(pData->hVbapTable, &(pData->vbap_gtableComp), &(pData->vbap_gtableIdx), &(pData->vbap_nGains),
+                             &(pData->N_vbap_gtable), &(pData->nTriangles));
+#ifndef FORCE_3D_LAYOUT
+        if(pData->vbap_gtableComp==NULL){
             /* if generating vbap gain tabled failed, re-calculate with 2D VBAP */
             pData->output_nDims = 2;
             panner_initGainTables(hPan);
+            return;
         }
-    }
 #endif
+    }
+
+    /* the panning gains of all sources must be re-computed from the new table
+     * (with spread, each source may use any of the loudspeakers) */
+    pData->G_srcMaxGains = MAX(pData->nLoudpkrs, 2);
+    pData->G_srcComp = realloc1d(pData->G_srcComp, HYBRID_BANDS*MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(float));
+    pData->G_srcIdx = realloc1d(pData->G_srcIdx, MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(int));
+    pData->G_srcPrev = realloc1d(pData->G_srcPrev, MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(float));
+    pData->G_srcPrevIdx = realloc1d(pData->G_srcPrevIdx, MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(int));
+    pData->G_clusComp = realloc1d(pData->G_clusComp, HYBRID_BANDS*MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(float));
+    pData->G_clusIdx = realloc1d(pData->G_clusIdx, MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(int));
+    pData->G_clusPrev = realloc1d(pData->G_clusPrev, HYBRID_BANDS*MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(float));
+    pData->G_clusPrevIdx = realloc1d(pData->G_clusPrevIdx, MAX_NUM_INPUTS*pData->G_srcMaxGains*sizeof(int));
+    for(i=0; i<MAX_NUM_INPUTS; i++){
+        pData->G_srcNumGains[i] = 0;
+        pData->G_srcPrevNumGains[i] = 0;
+        pData->G_srcRampFLAG[i] = 0;
+        pData->recalc_gainsFLAG[i] = 1;
+        pData->G_clusNumGains[i] = 0;
+        pData->G_clusRampFLAG[i] = 0;
+    }
+    pData->recalc_clusGainsFLAG = 1;
 }
 
 void panner_initTFT
@@ -101,17 +146,42 @@ void panner_initTFT
 )
 {
     panner_data *pData = (panner_data*)(hPan);
+    int nClusters, nCH;
     
+    /* sources are only clustered (3-D case) if there are more of them than
+     * clusters, in which case the clusters are transformed instead */
+    nClusters = pData->enableClustering && pData->output_nDims==3 &&
+                pData->maxNumClusters<pData->new_nSources ? pData->maxNumClusters : 0;
+    nCH = nClusters>0 ? nClusters : pData->new_nSources;
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSources, pData->new_nLoudpkrs, 0, 1);
-    else if (pData->new_nSources!=pData->nSources || pData->new_nLoudpkrs!=pData->nLoudpkrs){
-        afSTFTchannelChange(pData->hSTFT, pData->new_nSources, pData->new_nLoudpkrs);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, nCH, pData->new_nLoudpkrs, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+    else if (nCH!=pData->nCH_STFT || pData->new_nLoudpkrs!=pData->nLoudpkrs){
+        afSTFTchannelChange(pData->hSTFT, nCH, pData->new_nLoudpkrs);
         afSTFTclearBuffers(pData->hSTFT); 
     }
+    if(nClusters!=pData->clus_nClusters || pData->new_nSources!=pData->nSources)
+        panner_resetClusters(hPan);
+    pData->nCH_STFT = nCH;
+    pData->clus_nClusters = nClusters;
     pData->nSources = pData->new_nSources;
     pData->nLoudpkrs = pData->new_nLoudpkrs;
 }
 
+void panner_resetClusters(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    int i;
+    
+    for(i=0; i<MAX_NUM_INPUTS; i++){
+        pData->clus_of[i] = pData->clus_prevOf[i] = -1;
+        pData->clus_nMembers[i] = pData->clus_nMembersPrev[i] = 0;
+        pData->clus_idx3d[i] = -1;
+        pData->G_clusNumGains[i] = 0;
+        pData->G_clusRampFLAG[i] = 0;
+    }
+    pData->clus_nActive = 0;
+}
+
 void panner_loadPreset
 (
     PANNER_PRESETS preset,
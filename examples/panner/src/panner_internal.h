@@ -73,13 +73,20 @@ typedef enum _PANNER_PROC_STATUS{
 /*                            Internal Parameters                             */
 /* ========================================================================== */
 
-#define FORCE_3D_LAYOUT /* Even 2D loudspeaker setups will use 3D VBAP, with 2 virtual loudspeakers on the top/bottom */
+/* Horizontal loudspeaker setups are panned with 2-D VBAP, between pairs of
+ * neighbouring loudspeakers. Define FORCE_3D_LAYOUT, in order to pan them with
+ * 3-D VBAP instead (with 2 virtual loudspeakers on the top/bottom) */
     
 #define HOP_SIZE ( 128 )                            /* STFT hop size = nBands */
 #define HYBRID_BANDS ( HOP_SIZE + 5 )               /* hybrid mode incurs an additional 5 bands  */
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )        /* 4/8/16 */
 #define MAX_NUM_INPUTS ( PANNER_MAX_NUM_INPUTS )    /* Maximum permited channels for the VST standard */
 #define MAX_NUM_OUTPUTS ( PANNER_MAX_NUM_OUTPUTS )  /* Maximum permited channels for the VST standard */
+#define TD_DELAY ( 12*HOP_SIZE )                   /* delay of the time-domain path, to match that of the filterbank */
+#define PANNER_PARAM_ORIENTATION ( 0 )              /* yaw, pitch, roll (in radians) */
+#define PANNER_PARAM_SOURCE_DIR(i) ( 1 + (i) )      /* azimuth and elevation of source 'i' (in degrees) */
+#define PANNER_NUM_PARAMS ( 1 + MAX_NUM_INPUTS )    /* number of parameters handed over via the parameter queue */
+#define CLUSTER_HYSTERESIS_DEG ( 2.0f )             /* a source only leaves its cluster beyond the threshold plus this many degrees */
 #ifndef DEG2RAD
 # define DEG2RAD(x) (x * PI / 180.0f)
 #endif
@@ -99,12 +106,11 @@ typedef enum _PANNER_PROC_STATUS{
 typedef struct _panner
 {
     /* audio buffers */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
     float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUTS][TIME_SLOTS];
     float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_OUTPUTS][TIME_SLOTS];
-    complexVector* STFTInputFrameTF;
-    complexVector* STFTOutputFrameTF;
-    float** tempHopFrameTD;
     int fs;
     
     /* time-frequency transform */
@@ -113,9 +119,50 @@ typedef struct _panner
     
     /* Internal */
     int vbapTableRes[2];
-    float* vbap_gtable; /**< N_hrtf_vbap_gtable x nLoudpkrs */
+    void* hVbapTrk2D;    /**< 2-D VBAP tracker (see vbapTracker2D_create()); NULL for 3-D layouts */
+    void* hVbapTable;    /**< 3-D VBAP gain table handle (owns vbap_gtableComp and vbap_gtableIdx) */
+    int vbapTable_nLoudpkrs; /**< number of loudspeakers hVbapTable was created for */
+    float* vbap_gtableComp; /**< compressed 3-D VBAP gain table; FLAT: N_vbap_gtable x vbap_nGains */
+    int* vbap_gtableIdx; /**< loudspeaker indices for vbap_gtableComp; FLAT: N_vbap_gtable x vbap_nGains */
+    int vbap_nGains;     /**< number of (non-zero) gains per direction in the compressed table */
     int N_vbap_gtable;
-    float_complex G_src[HYBRID_BANDS][MAX_NUM_INPUTS][MAX_NUM_OUTPUTS];
+    float* G_srcComp;    /**< panning gains; FLAT: HYBRID_BANDS x MAX_NUM_INPUTS x G_srcMaxGains */
+    int* G_srcIdx;       /**< loudspeaker indices for G_srcComp; FLAT: MAX_NUM_INPUTS x G_srcMaxGains */
+    int G_srcMaxGains;   /**< maximum number of panning gains per source (2-D: 2, VBAP: 3, MDAP: up to nLoudpkrs) */
+    int G_srcNumGains[MAX_NUM_INPUTS]; /**< number of panning gains of each source */
+    
+    /* time-domain panning (frequency-independent case) */
+    int enableTDpanning;  /**< 1: the sources are panned in the time-domain (all pValues == 2) */
+    float inputDelayTD[MAX_NUM_INPUTS][TD_DELAY+FRAME_SIZE]; /**< delay lines; the oldest FRAME_SIZE samples are panned */
+    float outputFrameTD[MAX_NUM_OUTPUTS][FRAME_SIZE];
+    float rampTD[FRAME_SIZE];     /**< linear ramp 1/FRAME_SIZE..1, over which gains are interpolated */
+    float tmpFrameTD[2][FRAME_SIZE];
+    float* G_srcPrev;    /**< gains of each source in the previous frame; FLAT: MAX_NUM_INPUTS x G_srcMaxGains */
+    int* G_srcPrevIdx;   /**< loudspeaker indices for G_srcPrev; FLAT: MAX_NUM_INPUTS x G_srcMaxGains */
+    int G_srcPrevNumGains[MAX_NUM_INPUTS]; /**< number of previous gains (0: no ramp) */
+    int G_srcRampFLAG[MAX_NUM_INPUTS]; /**< 1: ramp from the previous gains over the current frame */
+    
+    /* source clustering (the clusters are panned in place of the sources) */
+    int nCH_STFT;         /**< current number of afSTFT input channels (nSources, or clus_nClusters) */
+    int clus_nClusters;   /**< number of cluster slots in use by the processing loop (0: sources are not clustered) */
+    int clus_nActive;     /**< number of clusters with at least one source, in the current frame */
+    float clusFrameTD[MAX_NUM_INPUTS][FRAME_SIZE]; /**< sum of the source signals of each cluster */
+    float clus_xyz[MAX_NUM_INPUTS][3];     /**< centroid of each cluster (unit vector) */
+    float clus_dirs_deg[MAX_NUM_INPUTS][2]; /**< centroid of each cluster, in degrees */
+    int clus_of[MAX_NUM_INPUTS];           /**< cluster of each source (-1: none) */
+    int clus_prevOf[MAX_NUM_INPUTS];       /**< cluster of each source in the previous frame (-1: none) */
+    int clus_nMembers[MAX_NUM_INPUTS];     /**< number of sources in each cluster */
+    int clus_nMembersPrev[MAX_NUM_INPUTS]; /**< number of sources in each cluster in the previous frame */
+    int clus_idx3d[MAX_NUM_INPUTS];        /**< VBAP table index of the current cluster gains (-1: none) */
+    float rampTF[2*TIME_SLOTS];  /**< linear ramp 1/TIME_SLOTS..1, for the interleaved time slots of one band */
+    float* G_clusComp;   /**< 3-D panning gains of the clusters; FLAT: HYBRID_BANDS x MAX_NUM_INPUTS x G_srcMaxGains */
+    int* G_clusIdx;      /**< loudspeaker indices for G_clusComp; FLAT: MAX_NUM_INPUTS x G_srcMaxGains */
+    float* G_clusPrev;   /**< gains of each cluster in the previous frame; FLAT: HYBRID_BANDS x MAX_NUM_INPUTS x G_srcMaxGains */
+    int* G_clusPrevIdx;  /**< loudspeaker indices for G_clusPrev; FLAT: MAX_NUM_INPUTS x G_srcMaxGains */
+    int G_clusNumGains[MAX_NUM_INPUTS];     /**< number of 3-D panning gains of each cluster */
+    int G_clusPrevNumGains[MAX_NUM_INPUTS]; /**< number of previous gains of each cluster */
+    int G_clusRampFLAG[MAX_NUM_INPUTS];     /**< 1: ramp from the previous cluster gains over the current frame */
+    int recalc_clusGainsFLAG; /**< 1: the gains of all clusters must be re-computed */
     
     /* flags */
     PANNER_CODEC_STATUS codecStatus;
@@ -126,11 +173,17 @@ typedef struct _panner
     int recalc_M_rotFLAG;
     int reInitGainTables;
     
+    /* parameters in use by the processing loop */
+    void* hParamQueue;                          /**< parameter updates for the processing loop (see saf_paramQueue.h) */
+    float src_dirs_proc_deg[MAX_NUM_INPUTS][2]; /**< source directions in use by the processing loop */
+    float ypr_proc[3];                          /**< yaw, pitch, roll (in radians) in use by the processing loop */
+    float Rxyz[3][3];                           /**< rotation matrix corresponding to ypr_proc */
+    
     /* misc. */
     float src_dirs_rot_deg[MAX_NUM_INPUTS][2];
     float src_dirs_rot_xyz[MAX_NUM_INPUTS][3];
     float src_dirs_xyz[MAX_NUM_INPUTS][3]; 
-    int nTriangles;
+    int nTriangles;   /**< number of loudspeaker triangles (3-D), or pairs (2-D) */
     int output_nDims; /**< 2: 2-D, 3: 3-D */
     
     /* pValue */
@@ -144,6 +197,10 @@ typedef struct _panner
     float loudpkrs_dirs_deg[MAX_NUM_OUTPUTS][2];
     float yaw, roll, pitch;                  /**< rotation angles in degrees */
     int bFlipYaw, bFlipPitch, bFlipRoll;     /**< flag to flip the sign of the individual rotation angles */
+    int enableClustering;                    /**< 1: sources are merged into clusters, if there are more than maxNumClusters */
+    int maxNumClusters;                      /**< maximum number of clusters */
+    float clusterThreshold_deg;              /**< sources within this angle of a cluster centroid are merged into it */
+    int nSceneSources;                       /**< number of sources the output is normalised by (0: nSources), see panner_setNumSceneSources() */
     
 } panner_data;
      
@@ -170,6 +227,11 @@ void panner_initGainTables(void* const hPan);
  * @note Call this function before panner_initGainTables()
  */
 void panner_initTFT(void* const hPan);
+
+/**
+ * Clears the source to cluster assignments, and the cluster gains
+ */
+void panner_resetClusters(void* const hPan);
     
 /**
  * Loads source/loudspeaker directions from preset
@@ -124,6 +124,18 @@ typedef enum _POWERMAP_MODES {
     PM_MODE_MINNORM_LOG  /**< Same as PM_MODE_MINNORM, but log(out_values) */
     
 } POWERMAP_MODES;
+
+/**
+ * Available compute back-ends for the scanning stage of the PWD, MVDR and
+ * CroPaC activity-maps
+ */
+typedef enum _POWERMAP_BACKENDS {
+    PM_BACKEND_CPU = 1, /**< CBLAS, on the processing thread (default) */
+    PM_BACKEND_OPENCL   /**< OpenCL device (requires the framework to be built
+                         *   with SAF_ENABLE_OPENCL); the CPU is used instead
+                         *   if no device is available */
+    
+} POWERMAP_BACKENDS;
     
 /**
  * Available horizontal feild-of-view (FOV) options
@@ -155,6 +167,7 @@ typedef enum _POWERMAP_CODEC_STATUS{
 }POWERMAP_CODEC_STATUS;
     
 #define POWERMAP_PROGRESSBARTEXT_CHAR_LENGTH 256
+#define POWERMAP_QUALITY_MAX_LEVEL ( 3 ) /**< see powermap_setQualityLevel() */
     
 
 /* ========================================================================== */
@@ -196,6 +209,9 @@ void powermap_initCodec(void* const hPm);
  * --------------------------
  * Analyses the input spherical harmonic signals to generate an activity-map
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples
+ *
  * @param[in] hPm       powermap handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] nInputs   Number of input channels
@@ -209,6 +225,56 @@ void powermap_analysis(void* const hPm,
                        int nSamples,
                        int isPlaying);
 
+/**
+ * Same as powermap_analysis(), but using the covariance matrices computed by a
+ * shared analysis front-end (see shFrontEnd_create()); which may serve several
+ * analysers of the same spherical harmonic signals
+ *
+ * This function is subscribed to the front-end with needsCov = 1, e.g.: \code
+ *   shFrontEnd_subscribe(hFE, &powermap_analysisFrontEnd, hPm, 1);
+ * \endcode
+ * The front-end must use the same frame size (powermap_getFrameSize()) and
+ * sampling rate as powermap. Its input format is used instead of the channel
+ * order and normalisation settings of powermap; and the master order of
+ * powermap applies, if it is the lower of the two.
+ *
+ * @param[in] hPm    powermap handle
+ * @param[in] hFrame Current frame of the front-end (see shFrontEnd_subscriber)
+ */
+void powermap_analysisFrontEnd(void* const hPm,
+                               const void* hFrame);
+
+/**
+ * Generates the activity-maps of an entire (e.g. recorded, or memory-mapped)
+ * buffer of input signals, with the current configuration; one map over the
+ * scanning grid (see powermap_getScanningGrid()) after every frame of
+ * powermap_getFrameSize() samples
+ *
+ * The frames are split into one contiguous share per thread, and each thread
+ * uses its own powermap instance; the state of 'hPm' is not altered. Each share
+ * is preceded by a few "pre-roll" frames, long enough for the covariance and
+ * activity-map averaging to forget their initial state; so the results match
+ * those of a single sequential pass up to a negligible (<-60dB) difference.
+ *
+ * @note powermap_init() must have been called beforehand (to set the sampling
+ *       rate). The maps are not normalised.
+ *
+ * @param[in]  hPm      powermap handle
+ * @param[in]  inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nSamples Number of samples per channel
+ * @param[in]  nThreads Number of threads ('0': one per CPU core)
+ * @param[out] pmaps    Activity-maps; FLAT: nFrames x nDirs (see
+ *                      powermap_getScanningGrid())
+ * @returns Number of maps generated: nFrames = nSamples/powermap_getFrameSize()
+ */
+int powermap_analyseOffline(void* const hPm,
+                            const float* const* inputs,
+                            int nInputs,
+                            int nSamples,
+                            int nThreads,
+                            float* pmaps);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -225,6 +291,34 @@ void powermap_refreshSettings(void* const hPm);
  */
 void powermap_setPowermapMode(void* const hPm, int newMode);
 
+/**
+ * Sets the compute back-end to request for the activity-map scanning stage
+ * (see 'POWERMAP_BACKENDS' enum); which is applied upon re-initialisation
+ */
+void powermap_setComputeBackend(void* const hPm, int newBackend);
+
+/**
+ * Sets the number of threads over which the activity-map generation is split
+ * ('1' single-threaded, or '0' for one thread per CPU core); which is applied
+ * upon re-initialisation
+ */
+void powermap_setNumThreads(void* const hPm, int newValue);
+
+/**
+ * Enables/Disables coarse-to-fine scanning: '1' the activity-map is first
+ * computed over a coarse grid, and then only re-computed over the directions of
+ * the dense grid that surround its peaks (elsewhere, the coarse map is
+ * interpolated); '0' the whole dense grid is scanned (default)
+ */
+void powermap_setGridRefinement(void* const hPm, int newState);
+
+/**
+ * Sets the threshold above which the directions of the coarse activity-map are
+ * refined, relative to its dynamic range, 0..1 (see
+ * powermap_setGridRefinement())
+ */
+void powermap_setRefinementThreshold(void* const hPm, float newValue);
+
 /**
  * Sets the maximum input/analysis order (see 'POWERMAP_MASTER_ORDERS' enum)
  */
@@ -243,6 +337,11 @@ void powermap_setAnaOrderAllBands(void* const hPm, int newValue);
 /**
  * Sets the weighting coefficient for a particular frequency band, allowing
  * one to "equalise" the activity-map.
+ *
+ * @note Bands with a weight of 0 are not analysed at all (their covariance
+ *       matrices are neither updated nor grouped); so limiting the analysis to
+ *       a frequency range (e.g. 200Hz-8kHz for speech) also saves the cost of
+ *       the other bands.
  */
 void powermap_setPowermapEQ(void* const hPm,  float newValue, int bandIdx);
 
@@ -298,12 +397,33 @@ void powermap_setAspectRatio(void* const hPm, int newOption);
  */
 void powermap_setPowermapAvgCoeff(void* const hPm, float newValue);
 
+/**
+ * Sets the maximum number of activity-maps generated per second ('0': one per
+ * frame); the covariance matrices are still updated every frame
+ */
+void powermap_setMaxUpdateRate(void* const hPm, float newValue);
+
 /**
  * Informs powermap that it should compute a new activity-map at its own
  * convenience, if it would be so kind; thank you, God bless.
  */
 void powermap_requestPmapUpdate(void* const hPm);
 
+/**
+ * Sets the quality level (0..POWERMAP_QUALITY_MAX_LEVEL), with which the cost
+ * of the analysis may be reduced when the CPU is overloaded (see also
+ * saf_qualityControl.h); the user parameters are left untouched
+ *  - 0: full quality
+ *  - 1: the activity-map update rate is halved
+ *  - 2: also, the coarse-to-fine scanning (powermap_setGridRefinement()) is
+ *       used, regardless of its setting
+ *  - 3: also, the analysis order is reduced by one (down to first-order)
+ *
+ * @note May be called from any thread; the level takes effect from the next
+ *       activity-map, without re-initialising the codec.
+ */
+void powermap_setQualityLevel(void* const hPm, int newLevel);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -340,6 +460,31 @@ int powermap_getMasterOrder(void* const hPm);
  */
 int powermap_getPowermapMode(void* const hPm);
 
+/**
+ * Returns the compute back-end that is actually in use for the activity-map
+ * scanning stage (see 'POWERMAP_BACKENDS' enum); which may differ from the one
+ * requested, if it was unavailable
+ */
+int powermap_getComputeBackend(void* const hPm);
+
+/**
+ * Returns the number of threads that are actually in use for the activity-map
+ * generation
+ */
+int powermap_getNumThreads(void* const hPm);
+
+/**
+ * Returns '1' if coarse-to-fine scanning is enabled, '0' if disabled (see
+ * powermap_setGridRefinement())
+ */
+int powermap_getGridRefinement(void* const hPm);
+
+/**
+ * Returns the threshold above which the directions of the coarse activity-map
+ * are refined, relative to its dynamic range, 0..1
+ */
+float powermap_getRefinementThreshold(void* const hPm);
+
 /**
  * Returns the current sampling rate, in Hz
  */
@@ -354,6 +499,24 @@ float powermap_getCovAvgCoeff(void* const hPm);
  * Returns the number of frequency bands used for the analysis
  */
 int powermap_getNumberOfBands(void);
+
+/**
+ * Returns the number of samples per analysis frame
+ */
+int powermap_getFrameSize(void);
+
+/**
+ * Returns the scanning grid, over which the activity-maps are generated (see
+ * powermap_analyseOffline())
+ *
+ * @param[in]  hPm       powermap handle
+ * @param[out] grid_dirs (&) scanning grid directions [azimuth elevation], in
+ *                       DEGREES; FLAT: nDirs x 2
+ * @param[out] nDirs     (&) number of directions
+ */
+void powermap_getScanningGrid(void* const hPm,
+                              float** grid_dirs,
+                              int* nDirs);
     
 /**
  * Returns the number of spherical harmonic signals required by the current
@@ -444,10 +607,26 @@ int powermap_getAspectRatio(void* const hPm);
  */
 float powermap_getPowermapAvgCoeff(void* const hPm);
 
+/**
+ * Returns the maximum number of activity-maps generated per second ('0': one
+ * per frame)
+ */
+float powermap_getMaxUpdateRate(void* const hPm);
+
+/**
+ * Returns the current quality level (0: full quality)
+ */
+int powermap_getQualityLevel(void* const hPm);
+
 /**
  * Returns the latest computed activity-map if it is ready. Otherwise it returns
  * 0, and you'll just have to wait a bit
  *
+ * The activity-maps are handed over from the processing thread via a lock-free
+ * ring buffer, and the returned map is not written to until the next call to
+ * this function; so it may be read at the caller's own rate. If this function
+ * is not called for a while, then no new maps are generated.
+ *
  * @param[in]  hPm         powermap handle
  * @param[out] grid_dirs   (&) scanning grid directions, in DEGREES; nDirs x 1
  * @param[out] pmap        (&) activity-map values; nDirs x 1
@@ -465,6 +644,27 @@ int powermap_getPmap(void* const hPm,
                      int* hfov,
                      int* aspectRatio);
 
+/**
+ * Returns the time (in seconds of processed audio) at which the activity-map
+ * last returned by powermap_getPmap() was generated
+ */
+double powermap_getPmapTimestamp(void* const hPm);
+
+/**
+ * Returns the delay of the analysis in samples, i.e. by how much the
+ * activity-maps lag behind the input signals (the latency of the FIFO, if the
+ * host block size is not a multiple of FRAME_SIZE, plus the group delay of the
+ * forward afSTFT)
+ */
+int powermap_getProcessingDelay(void* const hPm);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* powermap_getTelemetry(void* const hPm);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
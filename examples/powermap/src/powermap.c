@@ -38,14 +38,9 @@ void powermap_create
 {
     powermap_data* pData = (powermap_data*)malloc1d(sizeof(powermap_data));
     *phPm = (void*)pData;
-    int n, i, ch, band;
+    int n, band;
     
-    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1);
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS*sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
+    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     pData->tempHopFrameTD = (float**)malloc2d(MAX_NUM_SH_SIGNALS, HOP_SIZE, sizeof(float));
     
     /* codec data */
@@ -53,12 +48,15 @@ void powermap_create
     powermap_codecPars* pars = pData->pars;
     pars->interp_dirs_deg = NULL;
     for(n=0; n<MAX_SH_ORDER; n++){
-        pars->Y_grid[n] = NULL;
         pars->Y_grid_cmplx[n] = NULL;
+        pars->Y_coarse_cmplx[n] = NULL;
     }
     pars->interp_table = NULL;
+    pars->coarse2grid_gains = NULL;
+    pars->coarse2grid_idx = NULL;
     
     /* internal */
+    pData->hPmapWork = NULL;
     pData->progressBar0_1 = 0.0f;
     pData->progressBarText = malloc1d(POWERMAP_PROGRESSBARTEXT_CHAR_LENGTH*sizeof(char));
     strcpy(pData->progressBarText,"");
@@ -69,10 +67,15 @@ void powermap_create
     /* display */
     pData->pmap = NULL;
     pData->prev_pmap = NULL;
-    for(i=0; i<NUM_DISP_SLOTS; i++)
-        pData->pmap_grid[i] = NULL;
-    pData->pmapReady = 0;
+    pData->hPmapRing = NULL;
+    pData->frameTime_s = 0.0;
+    pData->pmapTimestamp_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
     pData->recalcPmap = 1;
+    pData->pmap_coarse = NULL;
+    pData->Y_sub = NULL;
+    pData->pmap_sub = NULL;
+    pData->refine_idx = NULL;
     
     /* Default user parameters */
     pData->masterOrder = pData->new_masterOrder = MASTER_ORDER_FIRST;
@@ -82,12 +85,24 @@ void powermap_create
     }
     pData->covAvgCoeff = 0.0f;
     pData->pmapAvgCoeff = 0.666f;
+    pData->maxUpdateRate = 0.0f;
     pData->nSources = 1;
     pData->pmap_mode = PM_MODE_MUSIC;
+    pData->backend = pData->backendInUse = PM_BACKEND_CPU;
+    pData->nThreads = SAF_PARFOR_NUM_THREADS_AUTO;
+    pData->nThreadsInUse = 1;
+    pData->gridRefinement = 0;
+    pData->refineThreshold = 0.5f;
+    pData->qualityLevel = 0;
     pData->HFOVoption = HFOV_360;
     pData->aspectRatioOption = ASPECT_RATIO_2_1;
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, 0);
+    saf_telemetry_create(&(pData->hTelemetry));
+    shOrderDetector_create(&(pData->hOrderDet), MAX_SH_ORDER, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*48000.0f));
 }
 
 void powermap_destroy
@@ -97,7 +112,7 @@ void powermap_destroy
 {
     powermap_data *pData = (powermap_data*)(*phPm);
     powermap_codecPars* pars = pData->pars;
-    int i, ch;
+    int i;
     
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -108,25 +123,29 @@ void powermap_destroy
         
         /* free afSTFT and buffers */
         afSTFTfree(pData->hSTFT);
-        for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-            free(pData->STFTInputFrameTF[ch].re);
-            free(pData->STFTInputFrameTF[ch].im);
-        }
-        free(pData->STFTInputFrameTF);
         free(pData->tempHopFrameTD);
         
         free1d((void**)&(pData->pmap));
         free1d((void**)&(pData->prev_pmap));
-        for(i=0; i<NUM_DISP_SLOTS; i++)
-            free1d((void**)&(pData->pmap_grid[i]));
+        saf_frameRing_destroy(&(pData->hPmapRing));
+        free1d((void**)&(pData->pmap_coarse));
+        free1d((void**)&(pData->Y_sub));
+        free1d((void**)&(pData->pmap_sub));
+        free1d((void**)&(pData->refine_idx));
         free1d((void**)&(pars->interp_dirs_deg));
         for(i=0; i<MAX_SH_ORDER; i++){
-            free1d((void**)&(pars->Y_grid[i]));
-            free1d((void**)&(pars->Y_grid_cmplx[i]));
+            steeringMtxCache_release((void**)&(pars->Y_grid_cmplx[i]));
+            steeringMtxCache_release((void**)&(pars->Y_coarse_cmplx[i]));
         }
         free1d((void**)&(pars->interp_table));
+        free1d((void**)&(pars->coarse2grid_gains));
+        free1d((void**)&(pars->coarse2grid_idx));
+        pmapWorkspace_destroy(&(pData->hPmapWork));
         free(pData->pars);
         free(pData->progressBarText);
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        shOrderDetector_destroy(&(pData->hOrderDet));
         free(pData);
         pData = NULL;
     }
@@ -156,13 +175,16 @@ void powermap_init
                 pData->freqVector[band] = (float)__afCenterFreq48e3[band];
             break;
     }
+    shOrderDetector_reset(pData->hOrderDet, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*sampleRate));
     
     /* intialise parameters */
-    memset(pData->Cx, 0 , MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*HYBRID_BANDS*sizeof(float_complex));
+    memset(pData->Cx, 0 , PACKED_COV_LEN*HYBRID_BANDS*sizeof(float_complex));
+    for(band=0; band<HYBRID_BANDS; band++)
+        pData->bandAnalysed[band] = 1;
     if(pData->prev_pmap!=NULL)
         memset(pData->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
-    pData->pmapReady = 0;
-    pData->dispSlotIdx = 0;
+    pData->frameTime_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
 }
 
 void powermap_initCodec
@@ -184,9 +206,11 @@ void powermap_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
     
     powermap_initTFT(hPm);
     powermap_initAna(hPm);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -194,228 +218,592 @@ void powermap_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISED;
 }
 
-void powermap_analysis
+/**
+ * Generates an activity-map (using the current mode) from the grouped
+ * covariance matrix, for the given scanning directions
+ *
+ * @param[in]  pData     powermap internal data
+ * @param[in]  pmap_mode Activity-map approach (see 'POWERMAP_MODES' enum)
+ * @param[in]  order     Analysis order
+ * @param[in]  C_grp     Grouped covariance matrix; FLAT: nSH x nSH
+ * @param[in]  nSources  Number of sources (for the sub-space approaches)
+ * @param[in]  Y         Steering vectors; FLAT: nSH x nDirs
+ * @param[in]  nDirs     Number of scanning directions
+ * @param[out] pmap      Activity-map; nDirs x 1
+ */
+static void powermap_generateMap
 (
-    void  *  const hPm,
-    float ** const inputs,
-    int            nInputs,
-    int            nSamples,
-    int            isPlaying
+    powermap_data* pData,
+    POWERMAP_MODES pmap_mode,
+    int order,
+    float_complex* C_grp,
+    int nSources,
+    float_complex* Y,
+    int nDirs,
+    float* pmap
+)
+{
+    int i, nSH;
+    float C_grp_trace;
+
+    nSH = (order+1)*(order+1);
+    C_grp_trace = 0.0f;
+    for(i=0; i<nSH; i++)
+        C_grp_trace+=crealf(C_grp[i*nSH+ i]);
+    switch(pmap_mode){
+        default:
+        case PM_MODE_PWD:
+            generatePWDmap(pData->hPmapWork, order, C_grp, Y, nDirs, pmap);
+            break;
+
+        case PM_MODE_MVDR:
+            if(C_grp_trace>1e-8f)
+                generateMVDRmap(pData->hPmapWork, order, C_grp, Y, nDirs, 8.0f, pmap, NULL);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+
+        case PM_MODE_CROPAC_LCMV:
+            if(C_grp_trace>1e-8f)
+                generateCroPaCLCMVmap(pData->hPmapWork, order, C_grp, Y, nDirs, 8.0f, 0.0f, pmap);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+
+        case PM_MODE_MUSIC:
+            if(C_grp_trace>1e-8f)
+                generateMUSICmap(pData->hPmapWork, order, C_grp, Y, nSources, nDirs, 0, pmap);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+
+        case PM_MODE_MUSIC_LOG:
+            if(C_grp_trace>1e-8f)
+                generateMUSICmap(pData->hPmapWork, order, C_grp, Y, nSources, nDirs, 1, pmap);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+
+        case PM_MODE_MINNORM:
+            if(C_grp_trace>1e-8f)
+                generateMinNormMap(pData->hPmapWork, order, C_grp, Y, nSources, nDirs, 0, pmap);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+
+        case PM_MODE_MINNORM_LOG:
+            if(C_grp_trace>1e-8f)
+                generateMinNormMap(pData->hPmapWork, order, C_grp, Y, nSources, nDirs, 1, pmap);
+            else
+                memset(pmap, 0, nDirs*sizeof(float));
+            break;
+    }
+}
+
+/**
+ * Generates the activity-map over the dense grid in a coarse-to-fine manner:
+ * the map is first computed over the coarse grid and interpolated onto the
+ * dense grid; after which, the dense grid directions that lie within the
+ * triangles surrounding the coarse grid peaks (i.e. those above 'threshold',
+ * relative to the coarse map's range) are computed again directly
+ *
+ * @param[in] pData     powermap internal data
+ * @param[in] pmap_mode Activity-map approach (see 'POWERMAP_MODES' enum)
+ * @param[in] order     Analysis order
+ * @param[in] C_grp     Grouped covariance matrix; FLAT: nSH x nSH
+ * @param[in] nSources  Number of sources (for the sub-space approaches)
+ * @param[in] threshold Refinement threshold, 0..1
+ */
+static void powermap_generateRefinedMap
+(
+    powermap_data* pData,
+    POWERMAP_MODES pmap_mode,
+    int order,
+    float_complex* C_grp,
+    int nSources,
+    float threshold
 )
 {
-    powermap_data *pData = (powermap_data*)(hPm);
     powermap_codecPars* pars = pData->pars;
-    int i, j, t, n, ch, band, nSH_order, order_band, nSH_maxOrder, maxOrder;
-    float C_grp_trace, covScale, pmapEQ_band;
+    int i, j, k, nSH, nSub, ind, refine;
+    float minVal, maxVal, thresh, gain;
+    float_complex* Y;
+
+    nSH = (order+1)*(order+1);
+
+    /* scan the coarse grid, and find its range */
+    powermap_generateMap(pData, pmap_mode, order, C_grp, nSources, pars->Y_coarse_cmplx[order-1], pars->coarse_nDirs, pData->pmap_coarse);
+    utility_siminv(pData->pmap_coarse, pars->coarse_nDirs, &ind);
+    minVal = pData->pmap_coarse[ind];
+    utility_simaxv(pData->pmap_coarse, pars->coarse_nDirs, &ind);
+    maxVal = pData->pmap_coarse[ind];
+    thresh = minVal + threshold*(maxVal-minVal);
+
+    /* interpolate onto the dense grid, and find the directions to refine */
+    nSub = 0;
+    for(j=0; j<pars->grid_nDirs; j++){
+        pData->pmap[j] = 0.0f;
+        refine = 0;
+        for(k=0; k<3; k++){
+            gain = pars->coarse2grid_gains[j*3+k];
+            ind = pars->coarse2grid_idx[j*3+k];
+            pData->pmap[j] += gain * pData->pmap_coarse[ind];
+            if(gain>0.0f && pData->pmap_coarse[ind]>=thresh)
+                refine = 1;
+        }
+        if(refine && maxVal>minVal)
+            pData->refine_idx[nSub++] = j;
+    }
+
+    /* scan these directions of the dense grid directly */
+    if(nSub>0){
+        Y = pars->Y_grid_cmplx[order-1];
+        for(i=0; i<nSH; i++)
+            for(j=0; j<nSub; j++)
+                pData->Y_sub[i*nSub+j] = Y[i*(pars->grid_nDirs)+pData->refine_idx[j]];
+        pmapWorkspace_invalidateCache(pData->hPmapWork); /* (Y_sub changes every frame) */
+        powermap_generateMap(pData, pmap_mode, order, C_grp, nSources, pData->Y_sub, nSub, pData->pmap_sub);
+        for(j=0; j<nSub; j++)
+            pData->pmap[pData->refine_idx[j]] = pData->pmap_sub[j];
+    }
+}
+
+/**
+ * Returns 1 if the covariance matrix of a band should be updated, or 0 if the
+ * band has a zero EQ weight (and so would not contribute to the activity-map);
+ * the covariance matrix of a skipped band is cleared (once), so that it is
+ * averaged from scratch if the band is analysed again later
+ */
+static int powermap_isBandAnalysed
+(
+    powermap_data* pData,
+    int band
+)
+{
+    if(pData->pmapEQ[band] <= 0.0f){
+        if(pData->bandAnalysed[band]){
+            memset(pData->Cx[band], 0, PACKED_COV_LEN*sizeof(float_complex));
+            pData->bandAnalysed[band] = 0;
+        }
+        return 0;
+    }
+    pData->bandAnalysed[band] = 1;
+    return 1;
+}
+
+/**
+ * Loads one frame of FRAME_SIZE input samples, applies the time-frequency
+ * transform, and updates the (time-averaged) covariance matrices per band
+ */
+static void powermap_updateCovariance
+(
+    powermap_data* pData,
+    float ** const inputs,
+    int            nInputs
+)
+{
+    int i, t, n, ch, band, nSH_active, nPacked, nPacked_active;
+    float covScale;
     int o[MAX_SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    float_complex new_Cx[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    float* pSHframeTD[MAX_NUM_SH_SIGNALS];
+    
+    /* local parameters */
+    int masterOrder, nSH;
+    float covAvgCoeff;
+    POWERMAP_NORM_TYPES norm;
+    POWERMAP_CH_ORDER chOrdering;
+    
+    /* copy current parameters to be thread safe */
+    norm = pData->norm;
+    chOrdering = pData->chOrdering;
+    covAvgCoeff = MIN(pData->covAvgCoeff, MAX_COV_AVG_COEFF);
+    masterOrder = pData->masterOrder;
+    nSH = (masterOrder+1)*(masterOrder+1);
+    
+    /* Load time-domain data */
+    switch(chOrdering){
+        case CH_ACN:
+            for(i=0; i < MIN(nSH, nInputs); i++)
+                utility_svvcopy(inputs[i], FRAME_SIZE, pData->SHframeTD[i]);
+            for(; i<nSH; i++)
+                memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
+            break;
+        case CH_FUMA:   /* only for first-order, convert to ACN */
+            if(nInputs>=4){
+                utility_svvcopy(inputs[0], FRAME_SIZE, pData->SHframeTD[0]);
+                utility_svvcopy(inputs[1], FRAME_SIZE, pData->SHframeTD[3]);
+                utility_svvcopy(inputs[2], FRAME_SIZE, pData->SHframeTD[1]);
+                utility_svvcopy(inputs[3], FRAME_SIZE, pData->SHframeTD[2]);
+                for(i=4; i<nSH; i++)
+                    memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
+            }
+            else
+                for(i=0; i<nSH; i++)
+                    memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float));
+            break;
+    }
+    
+    /* account for input normalisation scheme */
+    switch(norm){
+        case NORM_N3D:  /* already in N3D, do nothing */
+            break;
+        case NORM_SN3D: /* convert to N3D */
+            for(n=0; n<masterOrder+2; n++){  o[n] = n*n;  };
+            for (n = 0; n<masterOrder+1; n++)
+                for (ch = o[n]; ch<o[n+1]; ch++)
+                    for(i = 0; i<FRAME_SIZE; i++)
+                        pData->SHframeTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
+            break;
+        case NORM_FUMA: /* only for first-order, convert to N3D */
+            for(i = 0; i<FRAME_SIZE; i++)
+                pData->SHframeTD[0][i] *= sqrtf(2.0f);
+            for (ch = 1; ch<4; ch++)
+                for(i = 0; i<FRAME_SIZE; i++)
+                    pData->SHframeTD[ch][i] *= sqrtf(3.0f);
+            break;
+    }
+    
+    /* apply the time-frequency transform */
+    for(t = 0; t < TIME_SLOTS; t++) {
+        for(ch = 0; ch < nSH; ch++)
+            utility_svvcopy(&(pData->SHframeTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
+        afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD, &(pData->SHframeTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS);
+    }
+
+    /* Update covarience matrix per band (scaled with nSH, and averaged over time).
+     * The components above the effective order of the input carry no content,
+     * so their rows/columns would only be scaled by covAvgCoeff. Since the
+     * leading block is stored first (see utility_chpherk()), the rank-k update
+     * is restricted to that block, and the remaining elements are just scaled */
+    for(ch=0; ch<nSH; ch++)
+        pSHframeTD[ch] = pData->SHframeTD[ch];
+    nSH_active = ORDER2NSH(shOrderDetector_apply(pData->hOrderDet, pSHframeTD, masterOrder, FRAME_SIZE));
+    nPacked = nSH*(nSH+1)/2;
+    nPacked_active = nSH_active*(nSH_active+1)/2;
+    covScale = 1.0f/(float)(nSH);
+    for(band=0; band<HYBRID_BANDS; band++){
+        if(!powermap_isBandAnalysed(pData, band))
+            continue;
+        utility_chpherk((float_complex*)pData->SHframeTF[band], nSH_active, TIME_SLOTS, (1.0f-covAvgCoeff)*covScale, covAvgCoeff, pData->Cx[band]);
+        if(nPacked > nPacked_active)
+            cblas_sscal(2*(nPacked-nPacked_active), covAvgCoeff, (float*)&(pData->Cx[band][nPacked_active]), 1);
+    }
+}
+
+/**
+ * Groups the covariance matrices over the bands, and generates the
+ * (time-averaged) activity-map over the scanning grid; pData->pmap
+ */
+static void powermap_updateGridMap
+(
+    powermap_data* pData
+)
+{
+    powermap_codecPars* pars = pData->pars;
+    int i, band, nSH_order, order_band, nSH_maxOrder, maxOrder;
+    float pmapEQ_band;
     float_complex* C_grp;
     
     /* local parameters */
     int analysisOrderPerBand[HYBRID_BANDS];
-    int nSources, masterOrder, nSH;
-    float covAvgCoeff, pmapAvgCoeff;
+    int nSources, masterOrder, gridRefinement, qualityLevel;
+    float pmapAvgCoeff, refineThreshold;
     float pmapEQ[HYBRID_BANDS];
-    POWERMAP_NORM_TYPES norm;
-    POWERMAP_CH_ORDER chOrdering;
     POWERMAP_MODES pmap_mode;
     
-    /* The main processing: */
-    if (nSamples == FRAME_SIZE && (pData->codecStatus == CODEC_STATUS_INITIALISED) && isPlaying ) {
-        pData->procStatus = PROC_STATUS_ONGOING;
+    /* copy current parameters to be thread safe (at reduced quality levels,
+     * the coarse-to-fine scanning is forced, and then the order reduced) */
+    qualityLevel = pData->qualityLevel;
+    memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
+    memcpy(pmapEQ, pData->pmapEQ, HYBRID_BANDS*sizeof(float));
+    nSources = pData->nSources;
+    pmapAvgCoeff = pData->pmapAvgCoeff;
+    pmap_mode = pData->pmap_mode;
+    gridRefinement = pData->gridRefinement || qualityLevel>=2;
+    refineThreshold = pData->refineThreshold;
+    masterOrder = qualityLevel>=3 ? MAX(pData->masterOrder-1, 1) : pData->masterOrder;
+    
+    /* determine maximum analysis order */
+    maxOrder = 1;
+    for(i=0; i<HYBRID_BANDS; i++)
+        maxOrder = MAX(maxOrder, MIN(analysisOrderPerBand[i], masterOrder));
+    nSH_maxOrder = (maxOrder+1)*(maxOrder+1);
+
+    /* group covarience matrices (of the bands with a non-zero EQ weight) */
+    C_grp = pData->C_grp;
+    memset(C_grp, 0, nSH_maxOrder*nSH_maxOrder*sizeof(float_complex));
+    for (band=0; band<HYBRID_BANDS; band++){
+        order_band = MAX(MIN(analysisOrderPerBand[band], masterOrder),1);
+        nSH_order = (order_band+1)*(order_band+1);
+        pmapEQ_band = MIN(MAX(pmapEQ[band], 0.0f), 2.0f);
+        if(pmapEQ_band==0.0f)
+            continue;
+        utility_chpaxpy(pData->Cx[band], nSH_order, 1e3f*pmapEQ_band, nSH_maxOrder, C_grp);
+    }
+
+    /* generate powermap */
+    if(gridRefinement)
+        powermap_generateRefinedMap(pData, pmap_mode, maxOrder, C_grp, nSources, refineThreshold);
+    else
+        powermap_generateMap(pData, pmap_mode, maxOrder, C_grp, nSources, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, pData->pmap);
+    /* average powermap over time */
+    for(i=0; i<pars->grid_nDirs; i++)
+        pData->pmap[i] =  (1.0f-pmapAvgCoeff) * (pData->pmap[i] )+ pmapAvgCoeff * (pData->prev_pmap[i]);
+    utility_svvcopy(pData->pmap, pars->grid_nDirs, pData->prev_pmap);
+}
+
+/**
+ * Advances the frame time, and updates and publishes the powermap for plotting
+ * (unless nobody has been looking at them lately, or this would exceed the
+ * maximum update rate)
+ */
+static void powermap_publishMap
+(
+    powermap_data* pData
+)
+{
+    powermap_codecPars* pars = pData->pars;
+    int i, ind;
+    float maxUpdateRate;
+    float* pmap_grid;
+    
+    maxUpdateRate = pData->maxUpdateRate;
+    if(pData->qualityLevel>=1) /* (halved at reduced quality levels) */
+        maxUpdateRate = 0.5f*(maxUpdateRate>0.0f ? maxUpdateRate : (float)pData->fs/(float)FRAME_SIZE);
+    pData->frameTime_s += (double)FRAME_SIZE/(double)pData->fs;
+    if(pData->recalcPmap==1 &&
+       (maxUpdateRate<=0.0f || pData->frameTime_s-pData->lastUpdateTime_s >= 1.0/(double)maxUpdateRate - 1e-9) &&
+       saf_frameRing_hasConsumer(pData->hPmapRing, pData->frameTime_s)){
+        pData->recalcPmap = 0;
+        pData->lastUpdateTime_s = pData->frameTime_s;
+        pmap_grid = saf_frameRing_beginWrite(pData->hPmapRing);
         
-        /* copy current parameters to be thread safe */
-        memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
-        memcpy(pmapEQ, pData->pmapEQ, HYBRID_BANDS*sizeof(float));
-        norm = pData->norm;
-        chOrdering = pData->chOrdering;
-        nSources = pData->nSources;
-        covAvgCoeff = MIN(pData->covAvgCoeff, MAX_COV_AVG_COEFF);
-        pmapAvgCoeff = pData->pmapAvgCoeff;
-        pmap_mode = pData->pmap_mode;
-        masterOrder = pData->masterOrder;
-        nSH = (masterOrder+1)*(masterOrder+1);
+        /* generate the powermap over the scanning grid */
+        powermap_updateGridMap(pData);
         
-        /* Load time-domain data */
-        switch(chOrdering){
-            case CH_ACN:
-                for(i=0; i < MIN(nSH, nInputs); i++)
-                    utility_svvcopy(inputs[i], FRAME_SIZE, pData->SHframeTD[i]);
-                for(; i<nSH; i++)
-                    memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                break;
-            case CH_FUMA:   /* only for first-order, convert to ACN */
-                if(nInputs>=4){
-                    utility_svvcopy(inputs[0], FRAME_SIZE, pData->SHframeTD[0]);
-                    utility_svvcopy(inputs[1], FRAME_SIZE, pData->SHframeTD[3]);
-                    utility_svvcopy(inputs[2], FRAME_SIZE, pData->SHframeTD[1]);
-                    utility_svvcopy(inputs[3], FRAME_SIZE, pData->SHframeTD[2]);
-                    for(i=4; i<nSH; i++)
-                        memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                }
-                else
-                    for(i=0; i<nSH; i++)
-                        memset(pData->SHframeTD[i], 0, FRAME_SIZE * sizeof(float));
-                break;
-        }
+        /* interpolate powermap */
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
+                    pars->interp_table, pars->grid_nDirs,
+                    pData->pmap, 1, 0.0f,
+                    pmap_grid, 1);
         
-        /* account for input normalisation scheme */
-        switch(norm){
-            case NORM_N3D:  /* already in N3D, do nothing */
-                break;
-            case NORM_SN3D: /* convert to N3D */
-                for(n=0; n<masterOrder+2; n++){  o[n] = n*n;  };
-                for (n = 0; n<masterOrder+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->SHframeTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
-                break;
-            case NORM_FUMA: /* only for first-order, convert to N3D */
-                for(i = 0; i<FRAME_SIZE; i++)
-                    pData->SHframeTD[0][i] *= sqrtf(2.0f);
-                for (ch = 1; ch<4; ch++)
-                    for(i = 0; i<FRAME_SIZE; i++)
-                        pData->SHframeTD[ch][i] *= sqrtf(3.0f);
-                break;
-        }
+        /* ascertain minimum and maximum values for powermap colour scaling */
+        utility_siminv(pmap_grid, pars->interp_nDirs, &ind);
+        pData->pmap_grid_minVal = pmap_grid[ind];
+        utility_simaxv(pmap_grid, pars->interp_nDirs, &ind);
+        pData->pmap_grid_maxVal = pmap_grid[ind];
         
-        /* apply the time-frequency transform */
-        for(t = 0; t < TIME_SLOTS; t++) {
-            for(ch = 0; ch < nSH; ch++)
-                utility_svvcopy(&(pData->SHframeTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ch = 0; ch < nSH; ch++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
-        }
+        /* normalise the powermap to 0..1 */
+        for(i=0; i<pars->interp_nDirs; i++)
+            pmap_grid[i] = (pmap_grid[i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
+        
+        /* publish the powermap for plotting */
+        saf_frameRing_endWrite(pData->hPmapRing, pData->frameTime_s);
+    }
+}
 
-        /* Update covarience matrix per band */
-        covScale = 1.0f/(float)(nSH);
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, nSH, TIME_SLOTS, &calpha,
-                        pData->SHframeTF[band], TIME_SLOTS,
-                        pData->SHframeTF[band], TIME_SLOTS, &cbeta,
-                        new_Cx, MAX_NUM_SH_SIGNALS);
-
-            /* scale with nSH */
-            for(i=0; i<nSH; i++)
-                for(j=0; j<nSH; j++)
-                    new_Cx[i][j] = crmulf(new_Cx[i][j], covScale);
-
-            /* average over time */
-            for(i=0; i<nSH; i++)
-                for(j=0; j<nSH; j++)
-                    pData->Cx[band][i][j] = ccaddf( crmulf(new_Cx[i][j], 1.0f-covAvgCoeff), crmulf(pData->Cx[band][i][j], covAvgCoeff));
-        }
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void powermap_analysisFrame
+(
+    void  *  const hPm,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    
+    /* The main processing: */
+    if (pData->codecStatus == CODEC_STATUS_INITIALISED) {
+        pData->procStatus = PROC_STATUS_ONGOING;
+        saf_telemetry_frameBegin(pData->hTelemetry);
+        
+        /* transform, and update the covariance matrices (every frame) */
+        powermap_updateCovariance(pData, inputs, nInputs);
         
         /* update the powermap */
-        if(pData->recalcPmap==1){
-            pData->recalcPmap = 0;
-            pData->pmapReady = 0;
-
-            /* determine maximum analysis order */
-            maxOrder = 1;
-            for(i=0; i<HYBRID_BANDS; i++)
-                maxOrder = MAX(maxOrder, MIN(analysisOrderPerBand[i], masterOrder));
-            nSH_maxOrder = (maxOrder+1)*(maxOrder+1);
-
-            /* group covarience matrices */
-            C_grp = calloc1d(nSH_maxOrder*nSH_maxOrder, sizeof(float_complex));
-            for (band=0; band<HYBRID_BANDS; band++){
-                order_band = MAX(MIN(pData->analysisOrderPerBand[band], masterOrder),1);
-                nSH_order = (order_band+1)*(order_band+1);
-                pmapEQ_band = MIN(MAX(pmapEQ[band], 0.0f), 2.0f);
-                for(i=0; i<nSH_order; i++)
-                    for(j=0; j<nSH_order; j++)
-                        C_grp[i*nSH_maxOrder+j] = ccaddf(C_grp[i*nSH_maxOrder+j], crmulf(pData->Cx[band][i][j], 1e3f*pmapEQ_band));
-            }
+        powermap_publishMap(pData);
+        saf_telemetry_frameEnd(pData->hTelemetry);
+    }
+    else
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+}
 
-            /* generate powermap */
-            C_grp_trace = 0.0f;
-            for(i=0; i<nSH_maxOrder; i++)
-                C_grp_trace+=crealf(C_grp[i*nSH_maxOrder+ i]);
-            switch(pmap_mode){
-                default:
-                case PM_MODE_PWD:
-                    generatePWDmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, pData->pmap);
-                    break;
-
-                case PM_MODE_MVDR:
-                    if(C_grp_trace>1e-8f)
-                        generateMVDRmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, pData->pmap, NULL);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break;
-
-                case PM_MODE_CROPAC_LCMV:
-                    if(C_grp_trace>1e-8f)
-                        generateCroPaCLCMVmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, 0.0f, pData->pmap);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break;
-
-                case PM_MODE_MUSIC:
-                    if(C_grp_trace>1e-8f)
-                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pData->pmap);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break;
-                    
-                case PM_MODE_MUSIC_LOG:
-                    if(C_grp_trace>1e-8f)
-                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pData->pmap);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break; 
-                    
-                case PM_MODE_MINNORM:
-                    if(C_grp_trace>1e-8f)
-                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pData->pmap);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break;
-                    
-                case PM_MODE_MINNORM_LOG:
-                    if(C_grp_trace>1e-8f)
-                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pData->pmap);
-                    else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
-                    break;
-            }
-            free(C_grp);
-            
-            /* average powermap over time */
-            for(i=0; i<pars->grid_nDirs; i++)
-                pData->pmap[i] =  (1.0f-pmapAvgCoeff) * (pData->pmap[i] )+ pmapAvgCoeff * (pData->prev_pmap[i]);
-            utility_svvcopy(pData->pmap, pars->grid_nDirs, pData->prev_pmap);
-
-            /* interpolate powermap */
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
-                        pars->interp_table, pars->grid_nDirs,
-                        pData->pmap, 1, 0.0f,
-                        pData->pmap_grid[pData->dispSlotIdx], 1);
-
-            /* ascertain minimum and maximum values for powermap colour scaling */
-            int ind;
-            utility_siminv(pData->pmap_grid[pData->dispSlotIdx], pars->interp_nDirs, &ind);
-            pData->pmap_grid_minVal = pData->pmap_grid[pData->dispSlotIdx][ind];
-            utility_simaxv(pData->pmap_grid[pData->dispSlotIdx], pars->interp_nDirs, &ind);
-            pData->pmap_grid_maxVal = pData->pmap_grid[pData->dispSlotIdx][ind];
-
-            /* normalise the powermap to 0..1 */
-            for(i=0; i<pars->interp_nDirs; i++)
-                pData->pmap_grid[pData->dispSlotIdx][i] = (pData->pmap_grid[pData->dispSlotIdx][i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
-
-            /* signify that the powermap in current slot is ready for plotting */
-            pData->dispSlotIdx++;
-            if(pData->dispSlotIdx>=NUM_DISP_SLOTS)
-                pData->dispSlotIdx = 0;
-            pData->pmapReady = 1;
-        }
+void powermap_analysisFrontEnd
+(
+    void  *  const hPm,
+    const void *   hFrame
+)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    const shFrontEnd_frame* frame = (const shFrontEnd_frame*)hFrame;
+    int band, nSH, nSH_active, nPacked, nPacked_active;
+    float covAvgCoeff, covScale;
+    unsigned int fpState;
+    int blasState;
+    
+    if (pData->codecStatus != CODEC_STATUS_INITIALISED){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return;
+    }
+    if (frame->frameSize != FRAME_SIZE){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_BLOCK_SIZE);
+        return;
+    }
+    if (frame->Cx == NULL || frame->nBands != HYBRID_BANDS)
+        return;
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    pData->procStatus = PROC_STATUS_ONGOING;
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* update the covariance matrices (with those of the front-end, which are
+     * neither scaled nor averaged); as in powermap_updateCovariance() */
+    covAvgCoeff = MIN(pData->covAvgCoeff, MAX_COV_AVG_COEFF);
+    nSH = ORDER2NSH(pData->masterOrder);
+    nSH_active = MIN(frame->nSH_active, nSH);
+    nPacked = nSH*(nSH+1)/2;
+    nPacked_active = nSH_active*(nSH_active+1)/2;
+    covScale = 1.0f/(float)(nSH);
+    for(band=0; band<HYBRID_BANDS; band++){
+        if(!powermap_isBandAnalysed(pData, band))
+            continue;
+        cblas_sscal(2*nPacked, covAvgCoeff, (float*)pData->Cx[band], 1);
+        cblas_saxpy(2*nPacked_active, (1.0f-covAvgCoeff)*covScale, (const float*)frame->Cx[band], 1, (float*)pData->Cx[band], 1);
     }
     
+    /* update the powermap */
+    powermap_publishMap(pData);
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void powermap_analysis
+(
+    void  *  const hPm,
+    float ** const inputs,
+    int            nInputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    if(isPlaying)
+        saf_fifo_process(pData->hFIFO, inputs, NULL, nInputs, 0, nSamples, &powermap_analysisFrame, hPm);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Generates the maps of the frames [first, last) of an offline job, using the
+ * instance of the calling thread; called via saf_parfor_run()
+ */
+static void powermap_offlineRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    powermap_offlineJob* job = (powermap_offlineJob*)(hCtx);
+    powermap_data *pW = (powermap_data*)(job->hWorkers[threadIndex]);
+    float* frameIn[POWERMAP_MAX_NUM_INPUT_CHANNELS];
+    int f, ch, nDirs;
+    
+    /* the pre-roll frames are only analysed to settle the averaging */
+    nDirs = pW->pars->grid_nDirs;
+    for(f=MAX(first-job->nPreRollFrames, 0); f<last; f++){
+        for(ch=0; ch<job->nInputs; ch++)
+            frameIn[ch] = (float*)&(job->inputs[ch][(size_t)f*FRAME_SIZE]);
+        powermap_updateCovariance(pW, frameIn, job->nInputs);
+        powermap_updateGridMap(pW);
+        if(f>=first)
+            memcpy(&(job->pmaps[(size_t)f*nDirs]), pW->pmap, nDirs*sizeof(float));
+    }
+}
+
+int powermap_analyseOffline
+(
+    void  *  const hPm,
+    const float* const* inputs,
+    int            nInputs,
+    int            nSamples,
+    int            nThreads,
+    float*         pmaps
+)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    powermap_data *pW;
+    powermap_offlineJob job;
+    void* hParFor;
+    int i, nFrames, nThreadsInUse;
+    float maxAvgCoeff;
+    
+    nFrames = nSamples/FRAME_SIZE;
+    if(nFrames<1)
+        return 0;
+    
+    /* pre-roll long enough for the initial state to decay below -60dB, plus
+     * one frame for the filterbank */
+    maxAvgCoeff = MAX(MIN(pData->covAvgCoeff, MAX_COV_AVG_COEFF), pData->pmapAvgCoeff);
+    job.nPreRollFrames = 1;
+    if(maxAvgCoeff>0.0f)
+        job.nPreRollFrames += (int)ceilf(logf(1e-3f)/logf(maxAvgCoeff));
+    
+    /* one single-threaded instance per thread, with the current configuration */
+    saf_parfor_create(&hParFor, nThreads);
+    nThreadsInUse = saf_parfor_getNumThreads(hParFor);
+    job.hWorkers = (void**)malloc1d(nThreadsInUse*sizeof(void*));
+    for(i=0; i<nThreadsInUse; i++){
+        powermap_create(&(job.hWorkers[i]));
+        pW = (powermap_data*)(job.hWorkers[i]);
+        afSTFTfree(pW->hSTFT); /* (the threads are already taken) */
+        afSTFTinit(&(pW->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1, 1);
+        pW->new_masterOrder = pData->new_masterOrder;
+        memcpy(pW->analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
+        memcpy(pW->pmapEQ, pData->pmapEQ, HYBRID_BANDS*sizeof(float));
+        pW->covAvgCoeff = pData->covAvgCoeff;
+        pW->pmapAvgCoeff = pData->pmapAvgCoeff;
+        pW->nSources = pData->nSources;
+        pW->pmap_mode = pData->pmap_mode;
+        pW->gridRefinement = pData->gridRefinement;
+        pW->refineThreshold = pData->refineThreshold;
+        pW->nThreads = 1;
+        pW->chOrdering = pData->chOrdering;
+        pW->norm = pData->norm;
+        powermap_init(job.hWorkers[i], pData->fs);
+        powermap_initCodec(job.hWorkers[i]);
+    }
+    
+    /* analyse */
+    job.inputs = inputs;
+    job.nInputs = MIN(nInputs, POWERMAP_MAX_NUM_INPUT_CHANNELS);
+    job.pmaps = pmaps;
+    saf_parfor_run(hParFor, &powermap_offlineRange, (void*)&job, nFrames);
+    
+    for(i=0; i<nThreadsInUse; i++)
+        powermap_destroy(&(job.hWorkers[i]));
+    free(job.hWorkers);
+    saf_parfor_destroy(&hParFor);
+    return nFrames;
 }
 
 /* SETS */
@@ -434,6 +822,25 @@ void powermap_setPowermapMode(void* const hPm, int newMode)
         memset(pData->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
 }
 
+void powermap_setComputeBackend(void* const hPm, int newBackend)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    if(pData->backend != (POWERMAP_BACKENDS)newBackend){
+        pData->backend = (POWERMAP_BACKENDS)newBackend;
+        powermap_setCodecStatus(hPm, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void powermap_setNumThreads(void* const hPm, int newValue)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    newValue = newValue < 0 ? 0 : newValue;
+    if(pData->nThreads != newValue){
+        pData->nThreads = newValue;
+        powermap_setCodecStatus(hPm, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
 void powermap_setMasterOrder(void* const hPm,  int newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
@@ -599,18 +1006,42 @@ void powermap_setAspectRatio(void* const hPm, int newOption)
     }
 }
 
+void powermap_setGridRefinement(void* const hPm, int newState)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    pData->gridRefinement = newState ? 1 : 0;
+}
+
+void powermap_setRefinementThreshold(void* const hPm, float newValue)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    pData->refineThreshold = MIN(MAX(0.0f, newValue), 1.0f);
+}
+
 void powermap_setPowermapAvgCoeff(void* const hPm, float newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
     pData->pmapAvgCoeff = MIN(MAX(0.0f, newValue), 0.99999999f);
 }
 
+void powermap_setMaxUpdateRate(void* const hPm, float newValue)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    pData->maxUpdateRate = MAX(0.0f, newValue);
+}
+
 void powermap_requestPmapUpdate(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
     pData->recalcPmap = 1;
 }
 
+void powermap_setQualityLevel(void* const hPm, int newLevel)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    pData->qualityLevel = CLAMP(newLevel, 0, POWERMAP_QUALITY_MAX_LEVEL);
+}
+
 /* GETS */
 
 POWERMAP_CODEC_STATUS powermap_getCodecStatus(void* const hPm)
@@ -643,6 +1074,18 @@ int powermap_getPowermapMode(void* const hPm)
     return (int)pData->pmap_mode;
 }
 
+int powermap_getComputeBackend(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return (int)pData->backendInUse;
+}
+
+int powermap_getNumThreads(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->nThreadsInUse;
+}
+
 int powermap_getSamplingRate(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
@@ -712,6 +1155,17 @@ int powermap_getNumberOfBands(void)
     return HYBRID_BANDS;
 }
 
+int powermap_getFrameSize(void)
+{
+    return FRAME_SIZE;
+}
+
+void powermap_getScanningGrid(void* const hPm, float** grid_dirs, int* nDirs)
+{
+    (*grid_dirs) = (float*)__HANDLES_geosphere_ico_dirs_deg[SCAN_GRID_ICO_FREQ];
+    (*nDirs) = __geosphere_ico_nPoints[SCAN_GRID_ICO_FREQ];
+}
+
 int powermap_getNSHrequired(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
@@ -748,19 +1202,47 @@ int powermap_getAspectRatio(void* const hPm)
     return (int)pData->aspectRatioOption;
 }
 
+int powermap_getGridRefinement(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->gridRefinement;
+}
+
+float powermap_getRefinementThreshold(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->refineThreshold;
+}
+
 float powermap_getPowermapAvgCoeff(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
     return pData->pmapAvgCoeff;
 }
 
+float powermap_getMaxUpdateRate(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->maxUpdateRate;
+}
+
+int powermap_getQualityLevel(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->qualityLevel;
+}
+
 int powermap_getPmap(void* const hPm, float** grid_dirs, float** pmap, int* nDirs,int* pmapWidth, int* hfov, int* aspectRatio) //TODO: hfov and aspectRatio should be float, if 16:9 etc options are added
 {
     powermap_data *pData = (powermap_data*)(hPm);
     powermap_codecPars* pars = pData->pars;
-    if((pData->codecStatus == CODEC_STATUS_INITIALISED) && pData->pmapReady){
+    int pmapReady;
+    
+    pmapReady = 0;
+    if((pData->codecStatus == CODEC_STATUS_INITIALISED) &&
+       saf_frameRing_acquire(pData->hPmapRing, pmap, &(pData->pmapTimestamp_s))){
+        pmapReady = 1;
         (*grid_dirs) = pars->interp_dirs_deg;
-        (*pmap) = pData->pmap_grid[pData->dispSlotIdx-1 < 0 ? NUM_DISP_SLOTS-1 : pData->dispSlotIdx-1];
         (*nDirs) = pars->interp_nDirs;
         (*pmapWidth) = pData->dispWidth;
         switch(pData->HFOVoption){
@@ -776,5 +1258,23 @@ int powermap_getPmap(void* const hPm, float** grid_dirs, float** pmap, int* nDir
                 break;
         }
     }
-    return pData->pmapReady;
+    return pmapReady;
+}
+
+double powermap_getPmapTimestamp(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->pmapTimestamp_s;
+}
+
+int powermap_getProcessingDelay(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return saf_fifo_getLatency(pData->hFIFO) + 7*HOP_SIZE;
+}
+
+void* powermap_getTelemetry(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->hTelemetry;
 }
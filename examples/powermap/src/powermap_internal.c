@@ -47,31 +47,42 @@ void powermap_initAna(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
     powermap_codecPars* pars = pData->pars;
-    int i, j, n, N_azi, N_ele, nSH_order, order;
+    int i, j, n, N_azi, N_ele, nSH_order, order, nTable, nTri;
     float scaleY, hfov, vfov, fi, aspectRatio;
-    float* Y_grid_N, *grid_x_axis, *grid_y_axis;
+    float *grid_x_axis, *grid_y_axis, *coarse2grid_table;
     
     order = pData->new_masterOrder;
     
     /* Store Y_grid per order */
-    int geosphere_ico_freq = 9;
-    pars->grid_dirs_deg = (float*)__HANDLES_geosphere_ico_dirs_deg[geosphere_ico_freq];
-    pars->grid_nDirs = __geosphere_ico_nPoints[geosphere_ico_freq];
-    Y_grid_N = malloc1d(((order+1)*(order+1))*(pars->grid_nDirs)*sizeof(float));
-    getRSH(order, pars->grid_dirs_deg, pars->grid_nDirs, Y_grid_N);
+    pars->grid_dirs_deg = (float*)__HANDLES_geosphere_ico_dirs_deg[SCAN_GRID_ICO_FREQ];
+    pars->grid_nDirs = __geosphere_ico_nPoints[SCAN_GRID_ICO_FREQ];
+    for(n=1; n<=MAX_SH_ORDER; n++){
+        steeringMtxCache_release((void**)&(pars->Y_grid_cmplx[n-1]));
+        steeringMtxCache_release((void**)&(pars->Y_coarse_cmplx[n-1]));
+    }
+    for(n=1; n<=order; n++){ /* (shared with any other instances scanning the same grid) */
+        nSH_order = (n+1)*(n+1);
+        scaleY = 1.0f/(float)nSH_order;
+        pars->Y_grid_cmplx[n-1] = steeringMtxCache_acquireComplex(n, pars->grid_dirs_deg, pars->grid_nDirs, scaleY);
+    }
+    
+    /* Store Y_coarse per order, and the table for interpolating the coarse grid
+     * onto the dense grid (for the grid refinement) */
+    pars->coarse_dirs_deg = (float*)__HANDLES_geosphere_ico_dirs_deg[COARSE_GRID_ICO_FREQ];
+    pars->coarse_nDirs = __geosphere_ico_nPoints[COARSE_GRID_ICO_FREQ];
     for(n=1; n<=order; n++){
         nSH_order = (n+1)*(n+1);
         scaleY = 1.0f/(float)nSH_order;
-        free(pars->Y_grid[n-1]);
-        free(pars->Y_grid_cmplx[n-1]);
-        pars->Y_grid[n-1] = malloc1d(nSH_order * (pars->grid_nDirs)*sizeof(float));
-        pars->Y_grid_cmplx[n-1] = malloc1d(nSH_order * (pars->grid_nDirs)*sizeof(float_complex));
-        memcpy(pars->Y_grid[n-1], Y_grid_N, nSH_order * (pars->grid_nDirs)*sizeof(float));
-        utility_svsmul(pars->Y_grid[n-1], &scaleY, nSH_order * (pars->grid_nDirs), NULL);
-        for(i=0; i<nSH_order; i++)
-            for(j=0; j<pars->grid_nDirs; j++)
-                pars->Y_grid_cmplx[n-1][i*(pars->grid_nDirs)+j] = cmplxf(pars->Y_grid[n-1][i*(pars->grid_nDirs)+j], 0.0f);
+        pars->Y_coarse_cmplx[n-1] = steeringMtxCache_acquireComplex(n, pars->coarse_dirs_deg, pars->coarse_nDirs, scaleY);
     }
+    coarse2grid_table = NULL;
+    generateVBAPgainTable3D_srcs(pars->grid_dirs_deg, pars->grid_nDirs, pars->coarse_dirs_deg, pars->coarse_nDirs, 0, 0, 0.0f, &coarse2grid_table, &nTable, &nTri);
+    assert(nTable==pars->grid_nDirs);
+    free(pars->coarse2grid_gains);
+    free(pars->coarse2grid_idx);
+    pars->coarse2grid_gains = malloc1d(pars->grid_nDirs*3*sizeof(float));
+    pars->coarse2grid_idx = malloc1d(pars->grid_nDirs*3*sizeof(int));
+    compressVBAPgainTable3D(coarse2grid_table, pars->grid_nDirs, pars->coarse_nDirs, pars->coarse2grid_gains, pars->coarse2grid_idx);
 
     /* generate interpolation table for current display settings */
     switch(pData->HFOVoption){
@@ -108,14 +119,35 @@ void powermap_initAna(void* const hPm)
     pData->pmap = malloc1d(pars->grid_nDirs*sizeof(float));
     free(pData->prev_pmap);
     pData->prev_pmap = calloc1d(pars->grid_nDirs, sizeof(float));
-    for(i=0; i<NUM_DISP_SLOTS; i++){
-        free(pData->pmap_grid[i]);
-        pData->pmap_grid[i] = calloc1d(pars->interp_nDirs,sizeof(float));
+    free(pData->pmap_coarse);
+    pData->pmap_coarse = malloc1d(pars->coarse_nDirs*sizeof(float));
+    free(pData->Y_sub);
+    pData->Y_sub = malloc1d(MAX_NUM_SH_SIGNALS*(pars->grid_nDirs)*sizeof(float_complex));
+    free(pData->pmap_sub);
+    pData->pmap_sub = malloc1d(pars->grid_nDirs*sizeof(float));
+    free(pData->refine_idx);
+    pData->refine_idx = malloc1d(pars->grid_nDirs*sizeof(int));
+    saf_frameRing_destroy(&(pData->hPmapRing));
+    saf_frameRing_create(&(pData->hPmapRing), NUM_DISP_SLOTS, pars->interp_nDirs, DISP_CONSUMER_TIMEOUT_S);
+    
+    /* so that no memory is allocated when generating the powermaps */
+    pmapWorkspace_destroy(&(pData->hPmapWork));
+    pmapWorkspace_create(&(pData->hPmapWork), order, pars->grid_nDirs);
+    switch(pData->backend){
+        default:
+        case PM_BACKEND_CPU:
+            pData->backendInUse = PM_BACKEND_CPU;
+            break;
+        case PM_BACKEND_OPENCL:
+            pData->backendInUse = pmapWorkspace_setBackend(pData->hPmapWork, PMAP_BACKEND_OPENCL)==PMAP_BACKEND_OPENCL ?
+                                  PM_BACKEND_OPENCL : PM_BACKEND_CPU;
+            break;
     }
+    pData->nThreadsInUse = pmapWorkspace_setNumThreads(pData->hPmapWork, pData->nThreads);
     
     pData->masterOrder = order;
     
-    free(Y_grid_N);
+    free(coarse2grid_table);
     free(grid_x_axis);
     free(grid_y_axis);
 }
@@ -131,10 +163,10 @@ void powermap_initTFT
     nSH = (pData->masterOrder+1)*(pData->masterOrder+1);
     new_nSH = (pData->new_masterOrder+1)*(pData->new_masterOrder+1);
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, new_nSH, 0, 0, 1);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, new_nSH, 0, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     else if(nSH!=new_nSH){
         afSTFTchannelChange(pData->hSTFT, new_nSH, 0);
         afSTFTclearBuffers(pData->hSTFT);
-        memset(pData->Cx, 0 , MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*HYBRID_BANDS*sizeof(float_complex));
+        memset(pData->Cx, 0 , PACKED_COV_LEN*HYBRID_BANDS*sizeof(float_complex));
     }
 }
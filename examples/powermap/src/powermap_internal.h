@@ -67,8 +67,12 @@ typedef enum _POWERMAP_PROC_STATUS{
 #define HYBRID_BANDS ( HOP_SIZE + 5 )      /* hybrid mode incurs an additional 5 bands  */
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE ) /* Processing relies on fdHop = 16 */
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER+1)*(MAX_SH_ORDER+1) )
-#define NUM_DISP_SLOTS ( 2 )
+#define PACKED_COV_LEN ( MAX_NUM_SH_SIGNALS*(MAX_NUM_SH_SIGNALS+1)/2 ) /* upper triangle only */
+#define NUM_DISP_SLOTS ( 4 )             /* number of frames in the display ring (see saf_frameRing.h) */
+#define DISP_CONSUMER_TIMEOUT_S ( 1.0 )  /* no maps are generated if none have been read for this long */
 #define MAX_COV_AVG_COEFF ( 0.45f )    /*  */
+#define SCAN_GRID_ICO_FREQ ( 9 )       /* dense scanning grid (812 points) */
+#define COARSE_GRID_ICO_FREQ ( 4 )     /* coarse scanning grid, for grid refinement (162 points) */
 #ifndef M_PI
 # define M_PI ( 3.14159265359f )
 #endif
@@ -90,8 +94,14 @@ typedef struct _powermap_codecPars
     int interp_nDirs;
     int interp_nTri;
     
-    float* Y_grid[MAX_SH_ORDER];                 /* MAX_NUM_SH_SIGNALS x grid_nDirs */
-    float_complex* Y_grid_cmplx[MAX_SH_ORDER];   /* MAX_NUM_SH_SIGNALS x grid_nDirs */
+    float_complex* Y_grid_cmplx[MAX_SH_ORDER];   /* (n+1)^2 x grid_nDirs, per order n; see steeringMtxCache_acquireComplex() */
+    
+    /* grid refinement */
+    float* coarse_dirs_deg;                      /* coarse_nDirs x 2 */
+    int coarse_nDirs;
+    float_complex* Y_coarse_cmplx[MAX_SH_ORDER]; /* (n+1)^2 x coarse_nDirs, per order n; see steeringMtxCache_acquireComplex() */
+    float* coarse2grid_gains;                    /* grid_nDirs x 3; interpolation gains of the coarse grid, for each direction of the dense grid */
+    int* coarse2grid_idx;                        /* grid_nDirs x 3; corresponding coarse grid indices */
     
 }powermap_codecPars;
     
@@ -102,16 +112,21 @@ typedef struct _powermap_codecPars
 typedef struct _powermap
 {
     /* TFT */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float SHframeTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];        
     void* hSTFT;
-    complexVector* STFTInputFrameTF;
     float** tempHopFrameTD;
     float freqVector[HYBRID_BANDS];
     float fs;
     
     /* internal */
-    float_complex Cx[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];     /* cov matrices */
+    float_complex Cx[HYBRID_BANDS][PACKED_COV_LEN];                              /* cov matrices (packed; see utility_chpherk()) */
+    int bandAnalysed[HYBRID_BANDS]; /**< 0: the band is skipped (zero EQ weight), and Cx[band] has been cleared; 1: Cx[band] is updated */
+    float_complex C_grp[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS];                 /* grouped cov matrix */
+    void* hPmapWork;  /**< powermap generator workspace (see pmapWorkspace_create()) */
+    void* hOrderDet;  /**< effective input order detector; only the orders carrying content enter the covariance updates */
     int new_masterOrder;
     int dispWidth;
     
@@ -125,12 +140,19 @@ typedef struct _powermap
     /* display */
     float* pmap;                           /* grid_nDirs x 1 */
     float* prev_pmap;                      /* grid_nDirs x 1 */
-    float* pmap_grid[NUM_DISP_SLOTS];      /* powermap interpolated to grid; interp_nDirs x 1 */
-    int dispSlotIdx;
+    void* hPmapRing;                       /* ring of powermaps interpolated to grid (see saf_frameRing.h); NUM_DISP_SLOTS x interp_nDirs */
+    double frameTime_s;                    /* time of the current frame, in seconds */
+    double pmapTimestamp_s;                /* time of the powermap last returned by powermap_getPmap(), in seconds */
+    double lastUpdateTime_s;               /* time of the last generated powermap, in seconds */
     float pmap_grid_minVal;
     float pmap_grid_maxVal;
     int recalcPmap;   /* set this to 1 to generate a new powermap */
-    int pmapReady;    /* 0: powermap not started yet, 1: powermap is ready for plotting*/
+    
+    /* grid refinement */
+    float* pmap_coarse;                    /* coarse_nDirs x 1 */
+    float_complex* Y_sub;                  /* MAX_NUM_SH_SIGNALS x nSub; steering vectors of the directions to refine */
+    float* pmap_sub;                       /* nSub x 1 */
+    int* refine_idx;                       /* nSub x 1; indices of the directions to refine */
     
     /* User parameters */
     int masterOrder;
@@ -140,13 +162,34 @@ typedef struct _powermap
     POWERMAP_ASPECT_RATIO_OPTIONS aspectRatioOption;
     float covAvgCoeff;
     float pmapAvgCoeff;
+    float maxUpdateRate;              /**< maximum number of powermaps per second (0: every frame) */
     int nSources;
     POWERMAP_MODES pmap_mode;
+    POWERMAP_BACKENDS backend;        /**< requested compute back-end */
+    POWERMAP_BACKENDS backendInUse;   /**< compute back-end actually in use */
+    int nThreads;                     /**< requested number of threads (0: one per CPU core) */
+    int nThreadsInUse;                /**< number of threads actually in use */
+    int gridRefinement;               /**< '1' coarse-to-fine scanning, '0' scan the whole grid */
+    float refineThreshold;            /**< peaks above this (relative to the coarse map's range) are refined, 0..1 */
+    int qualityLevel;                 /**< 0: full quality, see powermap_setQualityLevel() */
     POWERMAP_CH_ORDER chOrdering;
     POWERMAP_NORM_TYPES norm;
     
 } powermap_data;
 
+/**
+ * Offline analysis job, shared by the threads (see powermap_analyseOffline())
+ */
+typedef struct _powermap_offlineJob
+{
+    void** hWorkers;             /* one powermap instance per thread */
+    const float* const* inputs;  /* input signals; nInputs x (nFrames*FRAME_SIZE) */
+    int nInputs;                 /* number of input signals */
+    int nPreRollFrames;          /* frames analysed before each share, for the averaging to settle */
+    float* pmaps;                /* output maps; FLAT: nFrames x grid_nDirs */
+    
+} powermap_offlineJob;
+
 
 /* ========================================================================== */
 /*                             Internal Functions                             */
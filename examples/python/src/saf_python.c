@@ -0,0 +1,954 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_python.c
+ * @brief Thin Python (CPython) bindings for some of the framework functions
+ *        and the example processors, for batch processing from e.g. NumPy
+ *
+ * All signals and matrices are passed as objects supporting the buffer
+ * protocol (e.g. NumPy arrays), which must be C-contiguous, of type float32
+ * (or complex64, where complex data is expected), and of the shapes given in
+ * the doc-strings below. The data is accessed in place (i.e. without copying),
+ * and outputs are written into arrays preallocated by the caller; therefore,
+ * the same arrays may be reused for every call. The global interpreter lock
+ * (GIL) is released while processing, such that several instances may be run
+ * concurrently from different Python threads (calls to the same instance are
+ * serialised).
+ *
+ * The set/get functions of the examples are not wrapped; however, since the
+ * module is linked with the framework and the examples, they may be called
+ * via ctypes, e.g. ctypes.CDLL(saf.__file__).rotator_setYaw(p.handle, ...),
+ * where p.handle is the address of the instance of a saf.Processor.
+ *
+ * Usage example:
+ * @code{.py}
+ * import numpy as np, saf
+ * p = saf.Processor("rotator", 48000)
+ * x = np.zeros((16, 48000), np.float32)
+ * y = np.empty_like(x)
+ * p.process(x, y)
+ * @endcode
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "saf_python_internal.h"
+
+/** Maximum number of dimensions of the arrays passed to the bindings */
+#define SAF_PY_MAX_NDIM ( 3 )
+/** Placeholder for a dimension of any size (see safpy_getBuffer()) */
+#define SAF_PY_ANY ( -1 )
+
+
+/* ========================================================================== */
+/*                               Internal Helpers                             */
+/* ========================================================================== */
+
+/**
+ * Acquires a view of the data of a buffer-protocol object (without copying),
+ * checking that it is C-contiguous, of the expected type, and of the expected
+ * shape
+ *
+ * @param[in]  obj      Object (e.g. a NumPy array)
+ * @param[in]  name     Name of the argument (for the error messages)
+ * @param[in]  isCmplx  '0' float32, '1' complex64
+ * @param[in]  writable '0' read-only, '1' writable (i.e. an output)
+ * @param[in]  ndim     Expected number of dimensions
+ * @param[in]  shape    Expected shape (SAF_PY_ANY: any size); ndim x 1
+ * @param[out] view     View; release with PyBuffer_Release()
+ * @param[out] outShape Actual shape (may be NULL); ndim x 1
+ * @returns    0 on success, -1 otherwise (with the Python exception set)
+ */
+static int safpy_getBuffer
+(
+    PyObject* obj,
+    const char* name,
+    int isCmplx,
+    int writable,
+    int ndim,
+    const Py_ssize_t* shape,
+    Py_buffer* view,
+    Py_ssize_t* outShape
+)
+{
+    const char* fmt;
+    int i;
+
+    if(PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0))!=0){
+        PyErr_Format(PyExc_TypeError, "'%s' must be a C-contiguous%s array", name, writable ? ", writable" : "");
+        return -1;
+    }
+
+    /* (the byte order is that of the host; NumPy omits the prefix) */
+    fmt = view->format==NULL ? "B" : view->format;
+    if(fmt[0]=='@' || fmt[0]=='=' || fmt[0]=='<')
+        fmt++;
+    if(strcmp(fmt, isCmplx ? "Zf" : "f")!=0 || view->itemsize!=(isCmplx ? (Py_ssize_t)sizeof(float_complex) : (Py_ssize_t)sizeof(float))){
+        PyErr_Format(PyExc_TypeError, "'%s' must be of type %s", name, isCmplx ? "complex64" : "float32");
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if(view->ndim!=ndim){
+        PyErr_Format(PyExc_ValueError, "'%s' must have %d dimension(s)", name, ndim);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    for(i=0; i<ndim; i++){
+        if(shape!=NULL && shape[i]!=SAF_PY_ANY && view->shape[i]!=shape[i]){
+            PyErr_Format(PyExc_ValueError, "dimension %d of '%s' must be of size %zd (not %zd)", i, name, shape[i], view->shape[i]);
+            PyBuffer_Release(view);
+            return -1;
+        }
+        if(outShape!=NULL)
+            outShape[i] = view->shape[i];
+    }
+    return 0;
+}
+
+/**
+ * Points the channel pointers to the rows of a (C-contiguous) nCH x nSamples
+ * signal buffer, (re-)allocating the pointer array if needed
+ *
+ * @note May be called without holding the GIL; returns -1 if out of memory
+ */
+static int safpy_setChannelPtrs
+(
+    float* data,
+    int nCH,
+    int nSamples,
+    float*** ptrs,
+    int* capacity
+)
+{
+    int ch;
+
+    if(nCH>(*capacity)){
+        float** tmp = (float**)realloc((*ptrs), nCH*sizeof(float*));
+        if(tmp==NULL)
+            return -1;
+        (*ptrs) = tmp;
+        (*capacity) = nCH;
+    }
+    for(ch=0; ch<nCH; ch++)
+        (*ptrs)[ch] = &data[ch*nSamples];
+    return 0;
+}
+
+
+/* ========================================================================== */
+/*                       saf.Array (memory owned by SAF)                      */
+/* ========================================================================== */
+
+/** A float32 array allocated by the framework, exposed via the buffer protocol */
+typedef struct _safpy_Array {
+    PyObject_HEAD
+    float* data;                           /**< data (malloc'd); FLAT */
+    int ndim;                              /**< number of dimensions */
+    Py_ssize_t shape[SAF_PY_MAX_NDIM];     /**< shape; ndim x 1 */
+    Py_ssize_t strides[SAF_PY_MAX_NDIM];   /**< strides, in bytes; ndim x 1 */
+
+}safpy_Array;
+
+static void safpy_Array_dealloc(safpy_Array* self)
+{
+    free(self->data);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int safpy_Array_getbuffer(safpy_Array* self, Py_buffer* view, int flags)
+{
+    int i;
+
+    view->obj = (PyObject*)self;
+    Py_INCREF(self);
+    view->buf = (void*)self->data;
+    view->itemsize = sizeof(float);
+    view->len = sizeof(float);
+    for(i=0; i<self->ndim; i++)
+        view->len *= self->shape[i];
+    view->readonly = 0;
+    view->format = (flags & PyBUF_FORMAT) ? "f" : NULL;
+    view->ndim = self->ndim;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES)==PyBUF_STRIDES ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs safpy_Array_bufferProcs = {
+    (getbufferproc)safpy_Array_getbuffer,
+    NULL
+};
+
+static PyTypeObject safpy_ArrayType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "saf.Array",
+    .tp_basicsize = sizeof(safpy_Array),
+    .tp_dealloc = (destructor)safpy_Array_dealloc,
+    .tp_as_buffer = &safpy_Array_bufferProcs,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "float32 array allocated by SAF; view with numpy.asarray() (no copy)",
+};
+
+/** Wraps a malloc'd rows x cols float array (the array is then owned by it) */
+static PyObject* safpy_Array_wrap(float* data, Py_ssize_t rows, Py_ssize_t cols)
+{
+    safpy_Array* self;
+
+    self = PyObject_New(safpy_Array, &safpy_ArrayType);
+    if(self==NULL){
+        free(data);
+        return NULL;
+    }
+    self->data = data;
+    self->ndim = 2;
+    self->shape[0] = rows;
+    self->shape[1] = cols;
+    self->strides[0] = cols*sizeof(float);
+    self->strides[1] = sizeof(float);
+    return (PyObject*)self;
+}
+
+
+/* ========================================================================== */
+/*                               Module Functions                             */
+/* ========================================================================== */
+
+PyDoc_STRVAR(safpy_getRSH_doc,
+"getRSH(order, dirs_deg, Y)\n--\n\n"
+"Real spherical harmonics (N3D) for the given directions (see getRSH()).\n\n"
+"dirs_deg: float32, nDirs x 2 ([azimuth, elevation] in degrees)\n"
+"Y:        float32, (order+1)^2 x nDirs (output)");
+
+static PyObject* safpy_getRSH(PyObject* self, PyObject* args)
+{
+    PyObject *dirsObj, *YObj;
+    Py_buffer dirs, Y;
+    Py_ssize_t dirsShape[2] = {SAF_PY_ANY, 2};
+    Py_ssize_t YShape[2], dirsSize[2];
+    int order;
+
+    (void)self;
+    if(!PyArg_ParseTuple(args, "iOO:getRSH", &order, &dirsObj, &YObj))
+        return NULL;
+    if(order<0){
+        PyErr_SetString(PyExc_ValueError, "'order' must be positive");
+        return NULL;
+    }
+    if(safpy_getBuffer(dirsObj, "dirs_deg", 0, 0, 2, dirsShape, &dirs, dirsSize)!=0)
+        return NULL;
+    YShape[0] = (order+1)*(order+1);
+    YShape[1] = dirsSize[0];
+    if(safpy_getBuffer(YObj, "Y", 0, 1, 2, YShape, &Y, NULL)!=0){
+        PyBuffer_Release(&dirs);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    getRSH(order, (float*)dirs.buf, (int)dirsSize[0], (float*)Y.buf);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&dirs);
+    PyBuffer_Release(&Y);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(safpy_generateVBAPgainTable3D_doc,
+"generateVBAPgainTable3D(ls_dirs_deg, az_res_deg, el_res_deg,\n"
+"                        omitLargeTriangles=0, enableDummies=0, spread=0.0)\n--\n\n"
+"3D VBAP gain table (see generateVBAPgainTable3D()).\n\n"
+"ls_dirs_deg: float32, L x 2 ([azimuth, elevation] in degrees)\n"
+"Returns (gtable, nTriangles), where gtable is a saf.Array of N_gtable x L\n"
+"gains (view it with numpy.asarray(), without copying).");
+
+static PyObject* safpy_generateVBAPgainTable3D(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = {"ls_dirs_deg", "az_res_deg", "el_res_deg", "omitLargeTriangles", "enableDummies", "spread", NULL};
+    PyObject *lsObj, *gtableObj;
+    Py_buffer ls;
+    Py_ssize_t lsShape[2] = {SAF_PY_ANY, 2};
+    Py_ssize_t lsSize[2];
+    int az_res_deg, el_res_deg, omitLargeTriangles, enableDummies, N_gtable, nTriangles;
+    float spread;
+    float* gtable;
+
+    (void)self;
+    omitLargeTriangles = enableDummies = 0;
+    spread = 0.0f;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "Oii|iif:generateVBAPgainTable3D", kwlist,
+                                    &lsObj, &az_res_deg, &el_res_deg, &omitLargeTriangles, &enableDummies, &spread))
+        return NULL;
+    if(az_res_deg<1 || el_res_deg<1){
+        PyErr_SetString(PyExc_ValueError, "the resolutions must be at least 1 degree");
+        return NULL;
+    }
+    if(safpy_getBuffer(lsObj, "ls_dirs_deg", 0, 0, 2, lsShape, &ls, lsSize)!=0)
+        return NULL;
+    if(lsSize[0]<3){
+        PyErr_SetString(PyExc_ValueError, "at least 3 loudspeakers are required");
+        PyBuffer_Release(&ls);
+        return NULL;
+    }
+
+    gtable = NULL;
+    N_gtable = nTriangles = 0;
+    Py_BEGIN_ALLOW_THREADS
+    generateVBAPgainTable3D((float*)ls.buf, (int)lsSize[0], az_res_deg, el_res_deg, omitLargeTriangles,
+                            enableDummies, spread, &gtable, &N_gtable, &nTriangles);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&ls);
+    if(gtable==NULL){
+        PyErr_SetString(PyExc_RuntimeError, "the loudspeaker set could not be triangulated");
+        return NULL;
+    }
+    gtableObj = safpy_Array_wrap(gtable, N_gtable, lsSize[0]);
+    if(gtableObj==NULL)
+        return NULL;
+    return Py_BuildValue("(Ni)", gtableObj, nTriangles);
+}
+
+PyDoc_STRVAR(safpy_generateMUSICmap_doc,
+"generateMUSICmap(order, Cx, Y_grid, nSources, pmap, logScaleFlag=0)\n--\n\n"
+"MUSIC pseudo-spectrum (see generateMUSICmap()).\n\n"
+"Cx:     complex64, (order+1)^2 x (order+1)^2\n"
+"Y_grid: complex64, (order+1)^2 x nGrid_dirs\n"
+"pmap:   float32, nGrid_dirs (output)");
+
+static PyObject* safpy_generateMUSICmap(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = {"order", "Cx", "Y_grid", "nSources", "pmap", "logScaleFlag", NULL};
+    PyObject *CxObj, *YObj, *pmapObj;
+    Py_buffer Cx, Y, pmap;
+    Py_ssize_t CxShape[2], YShape[2], pmapShape[1], YSize[2];
+    int order, nSH, nSources, logScaleFlag;
+
+    (void)self;
+    logScaleFlag = 0;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "iOOiO|i:generateMUSICmap", kwlist,
+                                    &order, &CxObj, &YObj, &nSources, &pmapObj, &logScaleFlag))
+        return NULL;
+    if(order<0){
+        PyErr_SetString(PyExc_ValueError, "'order' must be positive");
+        return NULL;
+    }
+    nSH = (order+1)*(order+1);
+    if(nSources<1 || nSources>=nSH){
+        PyErr_Format(PyExc_ValueError, "'nSources' must be between 1 and %d", nSH-1);
+        return NULL;
+    }
+    CxShape[0] = CxShape[1] = nSH;
+    YShape[0] = nSH;
+    YShape[1] = SAF_PY_ANY;
+    if(safpy_getBuffer(CxObj, "Cx", 1, 0, 2, CxShape, &Cx, NULL)!=0)
+        return NULL;
+    if(safpy_getBuffer(YObj, "Y_grid", 1, 0, 2, YShape, &Y, YSize)!=0){
+        PyBuffer_Release(&Cx);
+        return NULL;
+    }
+    pmapShape[0] = YSize[1];
+    if(safpy_getBuffer(pmapObj, "pmap", 0, 1, 1, pmapShape, &pmap, NULL)!=0){
+        PyBuffer_Release(&Cx);
+        PyBuffer_Release(&Y);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    generateMUSICmap(NULL, order, (float_complex*)Cx.buf, (float_complex*)Y.buf, nSources,
+                     (int)YSize[1], logScaleFlag, (float*)pmap.buf);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&Cx);
+    PyBuffer_Release(&Y);
+    PyBuffer_Release(&pmap);
+    Py_RETURN_NONE;
+}
+
+
+/* ========================================================================== */
+/*                               saf.MatrixConv                               */
+/* ========================================================================== */
+
+/** Python wrapper of saf_matrixConv */
+typedef struct _safpy_MatrixConv {
+    PyObject_HEAD
+    void* hMC;                  /**< saf_matrixConv handle */
+    PyThread_type_lock lock;    /**< serialises calls to apply() */
+    int hopSize;                /**< hop size, in samples */
+    int nCHin;                  /**< number of input channels */
+    int nCHout;                 /**< number of output channels */
+
+}safpy_MatrixConv;
+
+static int safpy_MatrixConv_init(safpy_MatrixConv* self, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = {"hopSize", "H", "usePartFLAG", NULL};
+    PyObject* HObj;
+    Py_buffer H;
+    Py_ssize_t HSize[3];
+    int hopSize, usePartFLAG;
+
+    usePartFLAG = 0;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "iO|i:MatrixConv", kwlist, &hopSize, &HObj, &usePartFLAG))
+        return -1;
+    if(hopSize<1){
+        PyErr_SetString(PyExc_ValueError, "'hopSize' must be positive");
+        return -1;
+    }
+    if(safpy_getBuffer(HObj, "H", 0, 0, 3, NULL, &H, HSize)!=0)
+        return -1;
+    if(HSize[0]<1 || HSize[1]<1 || HSize[2]<1){
+        PyErr_SetString(PyExc_ValueError, "'H' must not be empty");
+        PyBuffer_Release(&H);
+        return -1;
+    }
+    if(self->lock==NULL && (self->lock = PyThread_allocate_lock())==NULL){
+        PyErr_NoMemory();
+        PyBuffer_Release(&H);
+        return -1;
+    }
+    self->hopSize = hopSize;
+    self->nCHout = (int)HSize[0];
+    self->nCHin = (int)HSize[1];
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    saf_matrixConv_destroy(&(self->hMC));
+    saf_matrixConv_create(&(self->hMC), hopSize, (float*)H.buf, (int)HSize[2], self->nCHin, self->nCHout, usePartFLAG);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&H);
+    return 0;
+}
+
+static void safpy_MatrixConv_dealloc(safpy_MatrixConv* self)
+{
+    saf_matrixConv_destroy(&(self->hMC));
+    if(self->lock!=NULL)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyDoc_STRVAR(safpy_MatrixConv_apply_doc,
+"apply(inputSigs, outputSigs)\n--\n\n"
+"Convolves one or more consecutive hops (see saf_matrixConv_apply()).\n\n"
+"inputSigs:  float32, [nHops x] nCHin x hopSize\n"
+"outputSigs: float32, [nHops x] nCHout x hopSize (output)");
+
+static PyObject* safpy_MatrixConv_apply(safpy_MatrixConv* self, PyObject* args)
+{
+    PyObject *inObj, *outObj;
+    Py_buffer in, out;
+    Py_ssize_t inShape[3], outShape[3], inSize[3];
+    int t, ndim, nHops;
+
+    if(!PyArg_ParseTuple(args, "OO:apply", &inObj, &outObj))
+        return NULL;
+    if(self->hMC==NULL){
+        PyErr_SetString(PyExc_RuntimeError, "MatrixConv is not initialised");
+        return NULL;
+    }
+
+    /* (a 3-D array is processed as a batch of nHops consecutive hops) */
+    ndim = 2;
+    if(PyObject_GetBuffer(inObj, &in, PyBUF_STRIDES)==0){
+        ndim = in.ndim==3 ? 3 : 2;
+        PyBuffer_Release(&in);
+    }
+    else
+        PyErr_Clear(); /* (reported below) */
+    inShape[0] = outShape[0] = SAF_PY_ANY;
+    inShape[ndim-2] = self->nCHin;
+    outShape[ndim-2] = self->nCHout;
+    inShape[ndim-1] = outShape[ndim-1] = self->hopSize;
+    if(safpy_getBuffer(inObj, "inputSigs", 0, 0, ndim, inShape, &in, inSize)!=0)
+        return NULL;
+    nHops = ndim==3 ? (int)inSize[0] : 1;
+    outShape[0] = ndim==3 ? nHops : outShape[0];
+    if(safpy_getBuffer(outObj, "outputSigs", 0, 1, ndim, outShape, &out, NULL)!=0){
+        PyBuffer_Release(&in);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    for(t=0; t<nHops; t++)
+        saf_matrixConv_apply(self->hMC, &((float*)in.buf)[t*self->nCHin*self->hopSize],
+                             &((float*)out.buf)[t*self->nCHout*self->hopSize]);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in);
+    PyBuffer_Release(&out);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef safpy_MatrixConv_methods[] = {
+    {"apply", (PyCFunction)safpy_MatrixConv_apply, METH_VARARGS, safpy_MatrixConv_apply_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject safpy_MatrixConvType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "saf.MatrixConv",
+    .tp_basicsize = sizeof(safpy_MatrixConv),
+    .tp_dealloc = (destructor)safpy_MatrixConv_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "MatrixConv(hopSize, H, usePartFLAG=0)\n--\n\n"
+              "Matrix convolver (see saf_matrixConv_create()).\n\n"
+              "H: float32, nCHout x nCHin x length_h",
+    .tp_methods = safpy_MatrixConv_methods,
+    .tp_init = (initproc)safpy_MatrixConv_init,
+    .tp_new = PyType_GenericNew,
+};
+
+
+/* ========================================================================== */
+/*                                 saf.AfSTFT                                 */
+/* ========================================================================== */
+
+/** Python wrapper of afSTFTlib */
+typedef struct _safpy_AfSTFT {
+    PyObject_HEAD
+    void* hSTFT;                /**< afSTFTlib handle */
+    PyThread_type_lock lock;    /**< serialises calls to forward()/inverse() */
+    int hopSize;                /**< hop size, in samples */
+    int nCHin;                  /**< number of input channels */
+    int nCHout;                 /**< number of output channels */
+    int nBands;                 /**< number of bands */
+    float** ptrs;               /**< channel pointers; capacity x 1 */
+    int capacity;               /**< number of channel pointers allocated */
+
+}safpy_AfSTFT;
+
+static int safpy_AfSTFT_init(safpy_AfSTFT* self, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = {"hopSize", "nCHin", "nCHout", "hybridMode", "LDmode", "nThreads", NULL};
+    int hopSize, nCHin, nCHout, hybridMode, LDmode, nThreads;
+
+    hybridMode = LDmode = 0;
+    nThreads = 1;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "iii|iii:AfSTFT", kwlist, &hopSize, &nCHin, &nCHout,
+                                    &hybridMode, &LDmode, &nThreads))
+        return -1;
+    if(hopSize<1 || nCHin<1 || nCHout<1 || nThreads<1){
+        PyErr_SetString(PyExc_ValueError, "'hopSize', 'nCHin', 'nCHout' and 'nThreads' must be positive");
+        return -1;
+    }
+    if(self->lock==NULL && (self->lock = PyThread_allocate_lock())==NULL){
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->hopSize = hopSize;
+    self->nCHin = nCHin;
+    self->nCHout = nCHout;
+    self->nBands = hybridMode ? hopSize+5 : hopSize+1;
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    if(self->hSTFT!=NULL)
+        afSTFTfree(self->hSTFT);
+    afSTFTinit(&(self->hSTFT), hopSize, nCHin, nCHout, LDmode, hybridMode, nThreads);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    return 0;
+}
+
+static void safpy_AfSTFT_dealloc(safpy_AfSTFT* self)
+{
+    if(self->hSTFT!=NULL)
+        afSTFTfree(self->hSTFT);
+    free(self->ptrs);
+    if(self->lock!=NULL)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyDoc_STRVAR(safpy_AfSTFT_forward_doc,
+"forward(inTD, outFD)\n--\n\n"
+"Forward transform of nHops consecutive hops (see afSTFTforwardFrame()).\n\n"
+"inTD:  float32, nCHin x (nHops*hopSize)\n"
+"outFD: complex64, nBands x nCHin x nHops (output)");
+
+static PyObject* safpy_AfSTFT_forward(safpy_AfSTFT* self, PyObject* args)
+{
+    PyObject *inObj, *outObj;
+    Py_buffer in, out;
+    Py_ssize_t inShape[2], outShape[3], inSize[2];
+    int nHops, err;
+
+    if(!PyArg_ParseTuple(args, "OO:forward", &inObj, &outObj))
+        return NULL;
+    inShape[0] = self->nCHin;
+    inShape[1] = SAF_PY_ANY;
+    if(safpy_getBuffer(inObj, "inTD", 0, 0, 2, inShape, &in, inSize)!=0)
+        return NULL;
+    if(inSize[1]%self->hopSize!=0){
+        PyErr_Format(PyExc_ValueError, "the length of 'inTD' must be a multiple of the hop size (%d)", self->hopSize);
+        PyBuffer_Release(&in);
+        return NULL;
+    }
+    nHops = (int)(inSize[1]/self->hopSize);
+    outShape[0] = self->nBands;
+    outShape[1] = self->nCHin;
+    outShape[2] = nHops;
+    if(safpy_getBuffer(outObj, "outFD", 1, 1, 3, outShape, &out, NULL)!=0){
+        PyBuffer_Release(&in);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    err = safpy_setChannelPtrs((float*)in.buf, self->nCHin, (int)inSize[1], &(self->ptrs), &(self->capacity));
+    if(err==0 && nHops>0)
+        afSTFTforwardFrame(self->hSTFT, self->ptrs, nHops, (float_complex*)out.buf, self->nCHin*nHops, nHops);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in);
+    PyBuffer_Release(&out);
+    if(err!=0)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(safpy_AfSTFT_inverse_doc,
+"inverse(inFD, outTD)\n--\n\n"
+"Backward transform of nHops consecutive hops (see afSTFTinverseFrame()).\n\n"
+"inFD:  complex64, nBands x nCHout x nHops\n"
+"outTD: float32, nCHout x (nHops*hopSize) (output)");
+
+static PyObject* safpy_AfSTFT_inverse(safpy_AfSTFT* self, PyObject* args)
+{
+    PyObject *inObj, *outObj;
+    Py_buffer in, out;
+    Py_ssize_t inShape[3], outShape[2], inSize[3];
+    int nHops, err;
+
+    if(!PyArg_ParseTuple(args, "OO:inverse", &inObj, &outObj))
+        return NULL;
+    inShape[0] = self->nBands;
+    inShape[1] = self->nCHout;
+    inShape[2] = SAF_PY_ANY;
+    if(safpy_getBuffer(inObj, "inFD", 1, 0, 3, inShape, &in, inSize)!=0)
+        return NULL;
+    nHops = (int)inSize[2];
+    outShape[0] = self->nCHout;
+    outShape[1] = nHops*self->hopSize;
+    if(safpy_getBuffer(outObj, "outTD", 0, 1, 2, outShape, &out, NULL)!=0){
+        PyBuffer_Release(&in);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    err = safpy_setChannelPtrs((float*)out.buf, self->nCHout, nHops*self->hopSize, &(self->ptrs), &(self->capacity));
+    if(err==0 && nHops>0)
+        afSTFTinverseFrame(self->hSTFT, (float_complex*)in.buf, self->nCHout*nHops, nHops, nHops, self->ptrs);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in);
+    PyBuffer_Release(&out);
+    if(err!=0)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+}
+
+static PyObject* safpy_AfSTFT_getNumBands(safpy_AfSTFT* self, PyObject* noargs)
+{
+    (void)noargs;
+    return PyLong_FromLong(self->nBands);
+}
+
+static PyObject* safpy_AfSTFT_getProcessingDelay(safpy_AfSTFT* self, PyObject* noargs)
+{
+    (void)noargs;
+    if(self->hSTFT==NULL){
+        PyErr_SetString(PyExc_RuntimeError, "AfSTFT is not initialised");
+        return NULL;
+    }
+    return PyLong_FromLong(afSTFTgetProcessingDelay(self->hSTFT));
+}
+
+static PyMethodDef safpy_AfSTFT_methods[] = {
+    {"forward", (PyCFunction)safpy_AfSTFT_forward, METH_VARARGS, safpy_AfSTFT_forward_doc},
+    {"inverse", (PyCFunction)safpy_AfSTFT_inverse, METH_VARARGS, safpy_AfSTFT_inverse_doc},
+    {"getNumBands", (PyCFunction)safpy_AfSTFT_getNumBands, METH_NOARGS, "Returns the number of bands"},
+    {"getProcessingDelay", (PyCFunction)safpy_AfSTFT_getProcessingDelay, METH_NOARGS,
+     "Returns the delay of the forward and backward transforms combined, in samples"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject safpy_AfSTFTType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "saf.AfSTFT",
+    .tp_basicsize = sizeof(safpy_AfSTFT),
+    .tp_dealloc = (destructor)safpy_AfSTFT_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "AfSTFT(hopSize, nCHin, nCHout, hybridMode=0, LDmode=0, nThreads=1)\n--\n\n"
+              "Alias-free STFT filterbank (see afSTFTinit()).",
+    .tp_methods = safpy_AfSTFT_methods,
+    .tp_init = (initproc)safpy_AfSTFT_init,
+    .tp_new = PyType_GenericNew,
+};
+
+
+/* ========================================================================== */
+/*                                saf.Processor                               */
+/* ========================================================================== */
+
+/** Examples that may be instantiated via saf.Processor */
+static const safpy_example* const safpy_examples[] = {
+    &safpy_ambi_bin,
+    &safpy_ambi_dec,
+    &safpy_ambi_enc,
+    &safpy_array2sh,
+    &safpy_beamformer,
+    &safpy_binauraliser,
+    &safpy_panner,
+    &safpy_rotator
+};
+/** Number of entries in safpy_examples */
+#define SAF_PY_NUM_EXAMPLES ( (int)(sizeof(safpy_examples)/sizeof(safpy_examples[0])) )
+
+/** Python wrapper of an example processor */
+typedef struct _safpy_Processor {
+    PyObject_HEAD
+    const safpy_example* ex;    /**< functions of the example */
+    void* hEx;                  /**< example handle */
+    PyThread_type_lock lock;    /**< serialises calls to process() */
+    float** inPtrs;             /**< input channel pointers; inCapacity x 1 */
+    float** outPtrs;            /**< output channel pointers; outCapacity x 1 */
+    int inCapacity;             /**< number of input pointers allocated */
+    int outCapacity;            /**< number of output pointers allocated */
+
+}safpy_Processor;
+
+static void safpy_Processor_release(safpy_Processor* self)
+{
+    if(self->ex!=NULL && self->hEx!=NULL)
+        self->ex->destroy(&(self->hEx));
+    self->ex = NULL;
+}
+
+static int safpy_Processor_init(safpy_Processor* self, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = {"name", "samplerate", NULL};
+    const safpy_example* ex;
+    const char* name;
+    int i, samplerate;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "si:Processor", kwlist, &name, &samplerate))
+        return -1;
+    for(i=0, ex=NULL; i<SAF_PY_NUM_EXAMPLES; i++)
+        if(strcmp(name, safpy_examples[i]->name)==0)
+            ex = safpy_examples[i];
+    if(ex==NULL){
+        PyErr_Format(PyExc_ValueError, "unknown example '%s'", name);
+        return -1;
+    }
+    if(samplerate<1){
+        PyErr_SetString(PyExc_ValueError, "'samplerate' must be positive");
+        return -1;
+    }
+    if(self->lock==NULL && (self->lock = PyThread_allocate_lock())==NULL){
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    safpy_Processor_release(self);
+    self->ex = ex;
+    ex->create(&(self->hEx));
+    ex->init(self->hEx, samplerate);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    return 0;
+}
+
+static void safpy_Processor_dealloc(safpy_Processor* self)
+{
+    safpy_Processor_release(self);
+    free(self->inPtrs);
+    free(self->outPtrs);
+    if(self->lock!=NULL)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyDoc_STRVAR(safpy_Processor_process_doc,
+"process(inputs, outputs)\n--\n\n"
+"Processes a block of any length (see e.g. rotator_process()). The codec of\n"
+"the example is first (re-)initialised if needed, i.e. synchronously, rather\n"
+"than on a background thread as by a host.\n\n"
+"inputs:  float32, nInputs x nSamples\n"
+"outputs: float32, nOutputs x nSamples (output)");
+
+static PyObject* safpy_Processor_process(safpy_Processor* self, PyObject* args)
+{
+    PyObject *inObj, *outObj;
+    Py_buffer in, out;
+    Py_ssize_t outShape[2], inSize[2], outSize[2];
+    int err;
+
+    if(!PyArg_ParseTuple(args, "OO:process", &inObj, &outObj))
+        return NULL;
+    if(self->ex==NULL){
+        PyErr_SetString(PyExc_RuntimeError, "Processor is not initialised");
+        return NULL;
+    }
+    if(safpy_getBuffer(inObj, "inputs", 0, 0, 2, NULL, &in, inSize)!=0)
+        return NULL;
+    outShape[0] = SAF_PY_ANY;
+    outShape[1] = inSize[1];
+    if(safpy_getBuffer(outObj, "outputs", 0, 1, 2, outShape, &out, outSize)!=0){
+        PyBuffer_Release(&in);
+        return NULL;
+    }
+    if(inSize[0]>INT_MAX || outSize[0]>INT_MAX || inSize[1]>INT_MAX){
+        PyErr_SetString(PyExc_ValueError, "the arrays are too large");
+        PyBuffer_Release(&in);
+        PyBuffer_Release(&out);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    err = safpy_setChannelPtrs((float*)in.buf, (int)inSize[0], (int)inSize[1], &(self->inPtrs), &(self->inCapacity));
+    if(err==0)
+        err = safpy_setChannelPtrs((float*)out.buf, (int)outSize[0], (int)inSize[1], &(self->outPtrs), &(self->outCapacity));
+    if(err==0 && self->ex->initCodec!=NULL)
+        self->ex->initCodec(self->hEx); /* (returns at once, if already initialised) */
+    if(err==0)
+        self->ex->process(self->hEx, self->inPtrs, self->outPtrs, (int)inSize[0], (int)outSize[0], (int)inSize[1]);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in);
+    PyBuffer_Release(&out);
+    if(err!=0)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+}
+
+static PyObject* safpy_Processor_getProcessingDelay(safpy_Processor* self, PyObject* noargs)
+{
+    (void)noargs;
+    if(self->ex==NULL){
+        PyErr_SetString(PyExc_RuntimeError, "Processor is not initialised");
+        return NULL;
+    }
+    return PyLong_FromLong(self->ex->getProcessingDelay(self->hEx));
+}
+
+static PyObject* safpy_Processor_getHandle(safpy_Processor* self, void* closure)
+{
+    (void)closure;
+    return PyLong_FromVoidPtr(self->hEx);
+}
+
+static PyObject* safpy_Processor_getName(safpy_Processor* self, void* closure)
+{
+    (void)closure;
+    if(self->ex==NULL)
+        Py_RETURN_NONE;
+    return PyUnicode_FromString(self->ex->name);
+}
+
+static PyMethodDef safpy_Processor_methods[] = {
+    {"process", (PyCFunction)safpy_Processor_process, METH_VARARGS, safpy_Processor_process_doc},
+    {"getProcessingDelay", (PyCFunction)safpy_Processor_getProcessingDelay, METH_NOARGS,
+     "Returns the current processing delay of the example, in samples"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef safpy_Processor_getset[] = {
+    {"handle", (getter)safpy_Processor_getHandle, NULL, "address of the example instance (for ctypes)", NULL},
+    {"name", (getter)safpy_Processor_getName, NULL, "name of the example", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyTypeObject safpy_ProcessorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "saf.Processor",
+    .tp_basicsize = sizeof(safpy_Processor),
+    .tp_dealloc = (destructor)safpy_Processor_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Processor(name, samplerate)\n--\n\n"
+              "An example processor, with its default settings: 'ambi_bin', 'ambi_dec',\n"
+              "'ambi_enc', 'array2sh', 'beamformer', 'binauraliser', 'panner', or 'rotator'.",
+    .tp_methods = safpy_Processor_methods,
+    .tp_getset = safpy_Processor_getset,
+    .tp_init = (initproc)safpy_Processor_init,
+    .tp_new = PyType_GenericNew,
+};
+
+
+/* ========================================================================== */
+/*                                   Module                                   */
+/* ========================================================================== */
+
+static PyMethodDef safpy_methods[] = {
+    {"getRSH", (PyCFunction)safpy_getRSH, METH_VARARGS, safpy_getRSH_doc},
+    {"generateVBAPgainTable3D", (PyCFunction)(void(*)(void))safpy_generateVBAPgainTable3D,
+     METH_VARARGS | METH_KEYWORDS, safpy_generateVBAPgainTable3D_doc},
+    {"generateMUSICmap", (PyCFunction)(void(*)(void))safpy_generateMUSICmap,
+     METH_VARARGS | METH_KEYWORDS, safpy_generateMUSICmap_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef safpy_module = {
+    PyModuleDef_HEAD_INIT,
+    "saf",
+    "Thin bindings for the Spatial_Audio_Framework (zero-copy, via the buffer protocol)",
+    -1,
+    safpy_methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit_saf(void)
+{
+    PyObject* m;
+    PyTypeObject* types[] = {&safpy_ArrayType, &safpy_MatrixConvType, &safpy_AfSTFTType, &safpy_ProcessorType};
+    const char* names[] = {"Array", "MatrixConv", "AfSTFT", "Processor"};
+    int i;
+
+    for(i=0; i<4; i++)
+        if(PyType_Ready(types[i])<0)
+            return NULL;
+    m = PyModule_Create(&safpy_module);
+    if(m==NULL)
+        return NULL;
+    for(i=0; i<4; i++){
+        Py_INCREF(types[i]);
+        if(PyModule_AddObject(m, names[i], (PyObject*)types[i])<0){
+            Py_DECREF(types[i]);
+            Py_DECREF(m);
+            return NULL;
+        }
+    }
+    return m;
+}
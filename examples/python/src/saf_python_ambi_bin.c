@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_python_ambi_bin.c
+ * @brief Python bindings of the ambi_bin example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_python_internal.h"
+#include "../../ambi_bin/include/ambi_bin.h"
+
+const safpy_example safpy_ambi_bin = {
+    "ambi_bin", ambi_bin_create, ambi_bin_destroy, ambi_bin_init, ambi_bin_initCodec, ambi_bin_process, ambi_bin_getProcessingDelay };
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_python_ambi_dec.c
+ * @brief Python bindings of the ambi_dec example
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_python_internal.h"
+#include "../../ambi_dec/include/ambi_dec.h"
+
+const safpy_example safpy_ambi_dec = {
+    "ambi_dec", ambi_dec_create, ambi_dec_destroy, ambi_dec_init, ambi_dec_initCodec, ambi_dec_process, ambi_dec_getProcessingDelay };
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_python_internal.h
+ * @brief Thin Python (CPython) bindings for some of the framework functions
+ *        and the example processors
+ *
+ * Each example is described by a safpy_example (one per source file, since
+ * the example headers cannot all be included in the same translation unit).
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef __SAF_PYTHON_INTERNAL_H_INCLUDED__
+#define __SAF_PYTHON_INTERNAL_H_INCLUDED__
+
+#include "saf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Describes one example processor, with the standard create/init/process API
+ */
+typedef struct _safpy_example {
+    const char* name;                            /**< name of the example */
+    void (*create)(void** const);                /**< e.g. rotator_create() */
+    void (*destroy)(void** const);               /**< e.g. rotator_destroy() */
+    void (*init)(void* const, int);              /**< e.g. rotator_init() */
+    void (*initCodec)(void* const);              /**< e.g. ambi_dec_initCodec()
+                                                  *   (NULL: not required) */
+    void (*process)(void* const, float** const, float** const,
+                    int, int, int);              /**< e.g. rotator_process() */
+    int (*getProcessingDelay)(void* const);      /**< e.g.
+                                                  *   rotator_getProcessingDelay() */
+
+}safpy_example;
+
+
+/* ========================================================================== */
+/*                               Processors                                   */
+/* ========================================================================== */
+
+extern const safpy_example safpy_ambi_bin;
+extern const safpy_example safpy_ambi_dec;
+extern const safpy_example safpy_ambi_enc;
+extern const safpy_example safpy_array2sh;
+extern const safpy_example safpy_beamformer;
+extern const safpy_example safpy_binauraliser;
+extern const safpy_example safpy_panner;
+extern const safpy_example safpy_rotator;
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __SAF_PYTHON_INTERNAL_H_INCLUDED__ */
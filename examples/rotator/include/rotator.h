@@ -53,8 +53,19 @@ typedef enum _ROTATOR_INPUT_ORDERS {
     
 } ROTATOR_INPUT_ORDERS;
     
-/** Maximum supported Ambisonic order */
-#define ROTATOR_MAX_SH_ORDER ( 7 )
+/**
+ * Maximum supported Ambisonic order; which sizes the (static) buffers of each
+ * instance. With the embedded profile (see SAF_EMBEDDED_PROFILE), it is
+ * SAF_EMBEDDED_MAX_SH_ORDER instead (default: 3), and higher orders are
+ * clamped to it
+ */
+#if !defined(SAF_EMBEDDED_PROFILE)
+# define ROTATOR_MAX_SH_ORDER ( 7 )
+#elif defined(SAF_EMBEDDED_MAX_SH_ORDER)
+# define ROTATOR_MAX_SH_ORDER ( SAF_EMBEDDED_MAX_SH_ORDER )
+#else
+# define ROTATOR_MAX_SH_ORDER ( 3 )
+#endif
 
 /**
  * Available Ambisonic channel ordering conventions
@@ -119,6 +130,11 @@ void rotator_init(void* const hRot,
 /**
  * Rotates the input spherical harmonic signals.
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples. Unless the block size is a multiple of
+ *       FRAME_SIZE, this adds FRAME_SIZE samples of latency, which is included
+ *       in rotator_getProcessingDelay()
+ *
  * @param[in] hRot     rotator handle
  * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] outputs  Output channel buffers; 2-D array: nOutputs x nSamples
@@ -133,6 +149,51 @@ void rotator_process(void* const hRot,
                      int nOutputs,
                      int nSamples);
 
+/**
+ * Same as rotator_process(), but for interleaved input/output buffers
+ *
+ * @param[in] hRot     rotator handle
+ * @param[in] inputs   Interleaved input buffer; FLAT: nSamples x nInputs
+ * @param[in] outputs  Interleaved output buffer; FLAT: nSamples x nOutputs
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nOutputs Number of output channels
+ * @param[in] nSamples Number of samples per channel
+ */
+void rotator_processInterleaved(void* const hRot,
+                                const float* inputs,
+                                float* outputs,
+                                int nInputs,
+                                int nOutputs,
+                                int nSamples);
+
+/**
+ * Rotates one afSTFT-domain (or any other time-frequency domain) frame, for use
+ * as a stage of a saf_tfGraph (see saf_tfGraph_stageProcessor)
+ *
+ * Since the rotation is frequency-independent, the same matrix is applied to
+ * every band; and a change in orientation is crossfaded over the time slots of
+ * the frame. This avoids a separate filterbank round-trip when the rotator is
+ * followed by a time-frequency domain processor (e.g. ambi_drc or ambi_bin).
+ *
+ * @param[in]  hRot          rotator handle
+ * @param[in]  inTF          Input frame (complex); FLAT: nBands x nInputs x
+ *                           nTimeSlots
+ * @param[out] outTF         Output frame (complex); FLAT: nBands x nSH x
+ *                           nTimeSlots
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels
+ * @param[in]  nBands        Number of bands
+ * @param[in]  nTimeSlots    Number of time slots
+ * @returns Number of output channels (nSH)
+ */
+int rotator_processTF(void* const hRot,
+                      const float* inTF,
+                      float* outTF,
+                      int nInputs,
+                      int maxNumOutputs,
+                      int nBands,
+                      int nTimeSlots);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -153,6 +214,47 @@ void rotator_setPitch(void* const hRot, float newPitch);
  */
 void rotator_setRoll(void* const hRot, float newRoll);
 
+/**
+ * Sets the orientation as a quaternion (e.g. as received from a head-tracker),
+ * in place of the 'yaw', 'pitch' and 'roll' angles
+ *
+ * The processing loop estimates the angular velocity from consecutive
+ * quaternions, and extrapolates the latest one to the time at which the frame
+ * being processed is heard (plus the time set with
+ * rotator_setPredictionTime()); which compensates for the latency of the
+ * tracker and of the processing. The quaternion is converted into the
+ * yaw-pitch-roll rotation order, and the "flip" flags are applied to the
+ * resulting angles. Setting an angle returns to using the angles, until the
+ * next quaternion is set.
+ *
+ * @param[in] hRot        rotator handle
+ * @param[in] quat        Quaternion [w x y z]; the rotation from looking
+ *                        towards +x (with +z up) to the current orientation
+ * @param[in] timestamp_s Time at which the tracker measured the orientation,
+ *                        in seconds, of the monotonic clock of SAF (i.e.
+ *                        saf_benchmark_getTime()), or a negative value to use
+ *                        the time of this call
+ */
+void rotator_setQuaternion(void* const hRot,
+                           const float quat[4],
+                           double timestamp_s);
+
+/**
+ * Sets the additional time, in milliseconds, that the orientations given by
+ * rotator_setQuaternion() are predicted ahead (e.g. the output latency of the
+ * audio device); 0..100
+ */
+void rotator_setPredictionTime(void* const hRot, float newTime_ms);
+
+/**
+ * Sets the flag to enable/disable (1 or 0) the interpolation of the
+ * orientation every 64 samples (slerp), rather than crossfading between the
+ * rotation matrices of consecutive frames; so that fast head turns are not
+ * smeared with a large FRAME_SIZE (the cost of the rotation then roughly
+ * doubles, while the orientation is changing)
+ */
+void rotator_setEnableSubFrameInterp(void* const hRot, int newState);
+
 /**
  * Sets a flag as to whether to "flip" the sign of the current 'yaw' angle
  * (0: do not flip sign, 1: flip the sign)
@@ -216,6 +318,18 @@ float rotator_getPitch(void* const hRot);
  */
 float rotator_getRoll(void* const hRot);
 
+/**
+ * Returns the additional time, in milliseconds, that the orientations given by
+ * rotator_setQuaternion() are predicted ahead
+ */
+float rotator_getPredictionTime(void* const hRot);
+
+/**
+ * Returns the flag indicating whether the orientation is interpolated every 64
+ * samples (1), or only once per frame (0)
+ */
+int rotator_getEnableSubFrameInterp(void* const hRot);
+
 /**
  * Returns a flag as to whether to "flip" the sign of the current 'yaw' angle
  * (0: do not flip sign, 1: flip the sign)
@@ -265,6 +379,19 @@ int rotator_getOrder(void* const hRot);
  */
 int rotator_getNSHrequired(void* const hRot);
     
+/**
+ * Returns the processing delay in samples (may be used for delay compensation
+ * features), which includes the latency of the internal FIFO, if any (i.e. if
+ * the host block size is not a multiple of FRAME_SIZE)
+ */
+int rotator_getProcessingDelay(void* const hRot);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed, and time taken per frame); see
+ * saf_telemetry_getSnapshot()
+ */
+void* rotator_getTelemetry(void* const hRot);
     
 #ifdef __cplusplus
 } /* extern "C" { */
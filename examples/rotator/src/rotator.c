@@ -31,6 +31,56 @@
 #include "rotator.h"
 #include "rotator_internal.h"
 
+/**
+ * Hands the current orientation over to the processing loop, which applies it
+ * at the start of the next frame
+ */
+static void rotator_pushOrientation
+(
+    rotator_data* pData
+)
+{
+    float values[4];
+
+    values[0] = pData->yaw;
+    values[1] = pData->pitch;
+    values[2] = pData->roll;
+    values[3] = (float)pData->useRollPitchYawFlag;
+    saf_paramQueue_push(pData->hParamQueue, ROTATOR_PARAM_ORIENTATION, values, 4);
+}
+
+/**
+ * Predicts the orientation (if it is given as quaternions) at 'lookAhead_s'
+ * seconds from now, plus the user prediction time; and flags the rotation
+ * matrix for recalculation if it has changed. The quaternion is used directly,
+ * unless any of the angles are to be "flipped"
+ */
+static void rotator_predictOrientation
+(
+    rotator_data* pData,
+    double lookAhead_s
+)
+{
+    float quat[4], ypr[3];
+
+    if(!pData->useQuaternion_proc)
+        return;
+    if(!saf_orientationPredictor_predict(pData->hOrientPred, saf_benchmark_getTime() + lookAhead_s +
+                                         (double)pData->predictionTime_ms/1000.0, quat))
+        return;
+    if(pData->bFlipYaw || pData->bFlipPitch || pData->bFlipRoll){
+        quaternion2yawPitchRoll(quat, &ypr[0], &ypr[1], &ypr[2]);
+        ypr[0] = pData->bFlipYaw == 1 ? -ypr[0] : ypr[0];
+        ypr[1] = pData->bFlipPitch == 1 ? -ypr[1] : ypr[1];
+        ypr[2] = pData->bFlipRoll == 1 ? -ypr[2] : ypr[2];
+        yawPitchRoll2quaternion(ypr[0], ypr[1], ypr[2], quat);
+    }
+    if(memcmp(quat, pData->quat_proc, 4*sizeof(float)) != 0){
+        memcpy(pData->quat_proc, quat, 4*sizeof(float));
+        pData->recalc_M_rotFLAG = 1;
+    }
+}
+
 void rotator_create
 (
     void ** const phRot
@@ -51,7 +101,30 @@ void rotator_create
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
     pData->useRollPitchYawFlag = 0;
+    pData->predictionTime_ms = 0.0f;
+    pData->enableSubFrameInterp = 0;
     rotator_setOrder(*phRot, INPUT_ORDER_FIRST);
+    
+    /* parameter updates are handed over to the processing loop via a queue */
+    saf_paramQueue_create(&(pData->hParamQueue), ROTATOR_NUM_PARAMS, ROTATOR_NUM_PARAM_VALUES);
+    pData->ypr_proc[0] = pData->yaw;
+    pData->ypr_proc[1] = pData->pitch;
+    pData->ypr_proc[2] = pData->roll;
+    pData->useRollPitchYawFlag_proc = pData->useRollPitchYawFlag;
+    saf_orientationPredictor_create(&(pData->hOrientPred));
+    pData->useQuaternion_proc = 0;
+    yawPitchRoll2quaternion(0.0f, 0.0f, 0.0f, pData->quat_proc);
+    memcpy(pData->quat_target, pData->quat_proc, 4*sizeof(float));
+    memcpy(pData->prev_quat, pData->quat_proc, 4*sizeof(float));
+    pData->fs = 48000.0f;
+    
+    /* rotation matrix generator (allocation-free, so it may be used in the processing loop) */
+    shRotMtxReal_create(&(pData->hSHrot), MAX_SH_ORDER);
+    shOrderDetector_create(&(pData->hOrderDet), MAX_SH_ORDER, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*48000.0f));
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, MAX_NUM_SH_SIGNALS);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void rotator_destroy
@@ -62,6 +135,12 @@ void rotator_destroy
     rotator_data *pData = (rotator_data*)(*phRot);
 
     if (pData != NULL) {
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        shRotMtxReal_destroy(&(pData->hSHrot));
+        shOrderDetector_destroy(&(pData->hOrderDet));
+        saf_paramQueue_destroy(&(pData->hParamQueue));
+        saf_orientationPredictor_destroy(&(pData->hOrientPred));
         free(pData);
         pData = NULL;
     }
@@ -77,192 +156,431 @@ void rotator_init
     int i;
     
     /* starting values */
+    pData->fs = (float)sampleRate;
     for(i=1; i<=FRAME_SIZE; i++)
         pData->interpolator[i-1] = (float)i*1.0f/(float)FRAME_SIZE;
     memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float));
     memset(pData->prev_M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float));
     memset(pData->prev_inputFrameTD, 0, MAX_NUM_SH_SIGNALS*FRAME_SIZE*sizeof(float));
     pData->recalc_M_rotFLAG = 1;
+    shOrderDetector_reset(pData->hOrderDet, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*(float)sampleRate));
 }
 
-void rotator_process
+/** Applies any parameter updates that have been pushed to the queue */
+static void rotator_applyParamUpdates
+(
+    rotator_data* pData
+)
+{
+    int param;
+    float values[ROTATOR_NUM_PARAM_VALUES];
+    
+    while(saf_paramQueue_pop(pData->hParamQueue, &param, values, NULL)){
+        if(param==ROTATOR_PARAM_ORIENTATION){
+            memcpy(pData->ypr_proc, values, 3*sizeof(float));
+            pData->useRollPitchYawFlag_proc = (int)values[3];
+            pData->useQuaternion_proc = 0;
+            pData->recalc_M_rotFLAG = 1;
+        }
+        else if(param==ROTATOR_PARAM_QUATERNION){
+            saf_orientationPredictor_addSample(pData->hOrientPred, values, (double)values[4] + (double)values[5]);
+            if(!pData->useQuaternion_proc)
+                pData->recalc_M_rotFLAG = 1;
+            pData->useQuaternion_proc = 1;
+        }
+    }
+}
+
+/**
+ * Recomputes 'M_rot' (and 'quat_target') if the orientation has changed, or
+ * otherwise copies over 'prev_M_rot'
+ */
+static void rotator_updateRotationMatrix
+(
+    rotator_data* pData,
+    int order
+)
+{
+    int i, j, nSH;
+    float Rxyz[3][3];
+    float* M_rot_tmp;
+    
+    nSH = (order+1)*(order+1);
+    if(pData->recalc_M_rotFLAG){
+        pData->recalc_M_rotFLAG = 0;
+        memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float));
+        M_rot_tmp = pData->M_rot_tmp;
+        if(pData->useQuaternion_proc){
+            quaternion2rotationMatrix(pData->quat_proc, Rxyz);
+            memcpy(pData->quat_target, pData->quat_proc, 4*sizeof(float));
+        }
+        else{
+            yawPitchRoll2Rzyx (pData->ypr_proc[0], pData->ypr_proc[1], pData->ypr_proc[2], pData->useRollPitchYawFlag_proc, Rxyz);
+            rotationMatrix2quaternion(Rxyz, pData->quat_target);
+        }
+        shRotMtxReal_compute(pData->hSHrot, Rxyz, order, M_rot_tmp);
+        for(i=0; i<nSH; i++)
+            for(j=0; j<nSH; j++)
+                pData->M_rot[i][j] = M_rot_tmp[i*nSH+j];
+    }
+    else
+        utility_svvcopy((const float*)pData->prev_M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->M_rot);
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void rotator_processFrame
 (
     void  *  const hRot,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples
+    int            nOutputs
 )
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    int i, j, n, order, nSH;
+    int i, n, order, nSH, activeOrder;
     int o[MAX_SH_ORDER+2];
-    float Rxyz[3][3];
-    float* M_rot_tmp;
+    float* pInputFrameTD[MAX_NUM_SH_SIGNALS];
     ROTATOR_CH_ORDER chOrdering;
     ROTATOR_NORM_TYPES norm;
  
-    if (nSamples == FRAME_SIZE) {
-        /* prep */
-        for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
-        order = (int)pData->inputOrder;
-        nSH = (order+1)*(order+1);
-        
-        /* Load time-domain data */
-        switch(chOrdering){
-            case CH_ACN:
-                for(i=0; i < MIN(nSH, nInputs); i++)
-                    utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
-                for(; i<nSH; i++)
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* prep */
+    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    chOrdering = pData->chOrdering;
+    norm = pData->norm;
+    order = (int)pData->inputOrder;
+    nSH = (order+1)*(order+1);
+    
+    /* apply any parameter updates; a head-tracker orientation is predicted for
+     * the end of the frame, since that is when the crossfade to the new
+     * rotation matrix completes */
+    rotator_applyParamUpdates(pData);
+    rotator_predictOrientation(pData, (double)FRAME_SIZE/(double)pData->fs);
+    
+    /* Load time-domain data */
+    switch(chOrdering){
+        case CH_ACN:
+            for(i=0; i < MIN(nSH, nInputs); i++)
+                utility_svvcopy(inputs[i], FRAME_SIZE, pData->inputFrameTD[i]);
+            for(; i<nSH; i++)
+                memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
+            break;
+        case CH_FUMA:   /* only for first-order, convert to ACN */
+            if(nInputs>=4){
+                utility_svvcopy(inputs[0], FRAME_SIZE, pData->inputFrameTD[0]);
+                utility_svvcopy(inputs[1], FRAME_SIZE, pData->inputFrameTD[3]);
+                utility_svvcopy(inputs[2], FRAME_SIZE, pData->inputFrameTD[1]);
+                utility_svvcopy(inputs[3], FRAME_SIZE, pData->inputFrameTD[2]);
+                for(i=4; i<nSH; i++)
                     memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                break;
-            case CH_FUMA:   /* only for first-order, convert to ACN */
-                if(nInputs>=4){
-                    utility_svvcopy(inputs[0], FRAME_SIZE, pData->inputFrameTD[0]);
-                    utility_svvcopy(inputs[1], FRAME_SIZE, pData->inputFrameTD[3]);
-                    utility_svvcopy(inputs[2], FRAME_SIZE, pData->inputFrameTD[1]);
-                    utility_svvcopy(inputs[3], FRAME_SIZE, pData->inputFrameTD[2]);
-                    for(i=4; i<nSH; i++)
-                        memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros */
-                }
-                else
-                    for(i=0; i<nSH; i++)
-                        memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
-                break;
-        }
-        
-        /* account for norm scheme */
-        switch(norm){
-            case NORM_N3D: /* already N3D */
-                break;
-            case NORM_SN3D: /* convert to N3D before rotation */
+            }
+            else
+                for(i=0; i<nSH; i++)
+                    memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+            break;
+    }
+    
+    /* account for norm scheme */
+    switch(norm){
+        case NORM_N3D: /* already N3D */
+            break;
+        case NORM_SN3D: /* convert to N3D before rotation */
 #if 0 /* actually doesn't matter, since only components of the same order are used to rotate a given order of component
 * i.e, dipoles are used to rotate dipoles, quadrapoles-qaudrapoles etc.. so this scaling doesn't matter */
-                for (n = 0; n<order+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->inputFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
+            for (n = 0; n<order+1; n++)
+                for (ch = o[n]; ch<o[n+1]; ch++)
+                    for(i = 0; i<FRAME_SIZE; i++)
+                        pData->inputFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
 #endif
-                break;
-            case NORM_FUMA: /* only for first-order, convert to N3D */
+            break;
+        case NORM_FUMA: /* only for first-order, convert to N3D */
 #if 0 /* actually doesn't matter */
+            for(i = 0; i<FRAME_SIZE; i++)
+                pData->inputFrameTD[0][i] *= sqrtf(2.0f);
+            for (ch = 1; ch<4; ch++)
                 for(i = 0; i<FRAME_SIZE; i++)
-                    pData->inputFrameTD[0][i] *= sqrtf(2.0f);
-                for (ch = 1; ch<4; ch++)
-                    for(i = 0; i<FRAME_SIZE; i++)
-                        pData->inputFrameTD[ch][i] *= sqrtf(3.0f);
+                    pData->inputFrameTD[ch][i] *= sqrtf(3.0f);
 #endif
-                break;
-        }
+            break;
+    }
+    
+    if (order>0){
+        /* calculate rotation matrix */
+        rotator_updateRotationMatrix(pData, order);
         
-        if (order>0){
-            /* calculate rotation matrix */
-            if(pData->recalc_M_rotFLAG){
-                memset(pData->M_rot, 0, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*sizeof(float));
-                M_rot_tmp = malloc1d(nSH*nSH*sizeof(float));
-                yawPitchRoll2Rzyx (pData->yaw, pData->pitch, pData->roll, pData->useRollPitchYawFlag, Rxyz);
-                getSHrotMtxReal(Rxyz, M_rot_tmp, order);
-                for(i=0; i<nSH; i++)
-                    for(j=0; j<nSH; j++)
-                        pData->M_rot[i][j] = M_rot_tmp[i*nSH+j];
-                free(M_rot_tmp);
-                pData->recalc_M_rotFLAG = 0;
-            }
-            else
-                utility_svvcopy((const float*)pData->prev_M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->M_rot);
-            
-            /* apply rotation */
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
-                        (float*)(pData->prev_M_rot), MAX_NUM_SH_SIGNALS,
-                        (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                        (float*)pData->tempFrame, FRAME_SIZE);
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
-                        (float*)(pData->M_rot), MAX_NUM_SH_SIGNALS,
-                        (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                        (float*)pData->outputFrameTD, FRAME_SIZE);
-            for (i=0; i < nSH; i++)
-                for(j=0; j<FRAME_SIZE; j++)
-                    pData->outputFrameTD[i][j] = pData->interpolator[j] * pData->outputFrameTD[i][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
-            
-            /* for next frame */
-            utility_svvcopy((const float*)pData->inputFrameTD, nSH*FRAME_SIZE, (float*)pData->prev_inputFrameTD);
-            utility_svvcopy((const float*)pData->M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_M_rot);
-        }
+        /* apply rotation (order-wise, crossfading only the blocks that changed,
+         * and skipping the orders that carry no content). Note that the
+         * previous frame is rotated; which is fine, since the effective order
+         * rises immediately and only falls after a hold time of many frames */
+        for(i=0; i<nSH; i++)
+            pInputFrameTD[i] = pData->inputFrameTD[i];
+        activeOrder = shOrderDetector_apply(pData->hOrderDet, pInputFrameTD, order, FRAME_SIZE);
+        if(pData->enableSubFrameInterp && memcmp(pData->prev_quat, pData->quat_target, 4*sizeof(float)) != 0)
+            rotator_applyRotationSubFrames(hRot, order, activeOrder);
         else
-            utility_svvcopy((const float*)pData->inputFrameTD[0], FRAME_SIZE, (float*)pData->outputFrameTD[0]);
+            rotator_applyRotation(hRot, order, activeOrder);
         
-        /* account for norm scheme */
-        switch(norm){
-            case NORM_N3D: /* already N3D */
-                break;
-            case NORM_SN3D: /* convert back to SN3D after rotation */
+        /* for next frame */
+        memcpy(pData->prev_quat, pData->quat_target, 4*sizeof(float));
+        utility_svvcopy((const float*)pData->inputFrameTD, nSH*FRAME_SIZE, (float*)pData->prev_inputFrameTD);
+        utility_svvcopy((const float*)pData->M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_M_rot);
+    }
+    else
+        utility_svvcopy((const float*)pData->inputFrameTD[0], FRAME_SIZE, (float*)pData->outputFrameTD[0]);
+    
+    /* account for norm scheme */
+    switch(norm){
+        case NORM_N3D: /* already N3D */
+            break;
+        case NORM_SN3D: /* convert back to SN3D after rotation */
 #if 0 /* actually doesn't matter */
-                for (n = 0; n<order+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->outputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
+            for (n = 0; n<order+1; n++)
+                for (ch = o[n]; ch<o[n+1]; ch++)
+                    for(i = 0; i<FRAME_SIZE; i++)
+                        pData->outputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
 #endif
-                break;
-            case NORM_FUMA: /* only for first-order */
+            break;
+        case NORM_FUMA: /* only for first-order */
 #if 0 /* actually doesn't matter */
+            for(i = 0; i<FRAME_SIZE; i++)
+                pData->outputFrameTD[0][i] /= sqrtf(2.0f);
+            for (ch = 1; ch<4; ch++)
                 for(i = 0; i<FRAME_SIZE; i++)
-                    pData->outputFrameTD[0][i] /= sqrtf(2.0f);
-                for (ch = 1; ch<4; ch++)
-                    for(i = 0; i<FRAME_SIZE; i++)
-                        pData->outputFrameTD[ch][i] /= sqrtf(3.0f);
+                    pData->outputFrameTD[ch][i] /= sqrtf(3.0f);
 #endif
-                break;
+            break;
+    }
+    
+    /* copy rotated signals to output buffer */
+    switch(chOrdering){
+        case CH_ACN:
+            for (i = 0; i < MIN(nSH, nOutputs); i++)
+                utility_svvcopy(pData->outputFrameTD[i], FRAME_SIZE, outputs[i]);
+            for (; i < nOutputs; i++)
+                memset(outputs[i], 0, FRAME_SIZE*sizeof(float));
+            break;
+        case CH_FUMA: /* only for first-order */
+            if(nOutputs>=4){
+                utility_svvcopy(pData->outputFrameTD[0], FRAME_SIZE, outputs[0]);
+                utility_svvcopy(pData->outputFrameTD[1], FRAME_SIZE, outputs[2]);
+                utility_svvcopy(pData->outputFrameTD[2], FRAME_SIZE, outputs[3]);
+                utility_svvcopy(pData->outputFrameTD[3], FRAME_SIZE, outputs[1]);
+            }
+            else
+                for(i=0; i<nOutputs; i++)
+                    memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
+            break;
+    }
+    saf_telemetry_frameEnd(pData->hTelemetry);
+}
+
+void rotator_process
+(
+    void  *  const hRot,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &rotator_processFrame, hRot);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+int rotator_processTF
+(
+    void  *  const hRot,
+    const float *  inTF,
+    float *        outTF,
+    int            nInputs,
+    int            maxNumOutputs,
+    int            nBands,
+    int            nTimeSlots
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    int i, j, n, o_n, len, nRows, nCols, band, order, nSH_out, rowLen, ldM;
+    int changed[MAX_SH_ORDER+1];
+    const int fuma2acn[4] = {0, 3, 1, 2};
+    float M_fuma[4][4], prev_M_fuma[4][4];
+    float w;
+    const float* M, *prev_M, *in_b;
+    float* out_b, *tmp;
+    
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    rotator_applyParamUpdates(pData);
+    rotator_predictOrientation(pData, 0.0); /* (the hop size is not known here) */
+    order = (int)pData->inputOrder;
+    nSH_out = MIN((order+1)*(order+1), maxNumOutputs);
+    rowLen = 2*nTimeSlots; /* (interleaved complex) */
+    if(nSH_out<=0)
+        return 0;
+    if(pData->chOrdering==CH_FUMA && nInputs<4){
+        memset(outTF, 0, nBands*nSH_out*rowLen*sizeof(float));
+        return nSH_out;
+    }
+    
+    if(order>0){
+        rotator_updateRotationMatrix(pData, order);
+        for(n=1; n<=order; n++){
+            o_n = n*n;
+            len = 2*n+1;
+            changed[n] = 0;
+            for(i=o_n; i<o_n+len && !changed[n]; i++)
+                changed[n] = memcmp(&(pData->M_rot[i][o_n]), &(pData->prev_M_rot[i][o_n]), len*sizeof(float)) != 0;
         }
         
-        /* copy rotated signals to output buffer */
-        switch(chOrdering){
-            case CH_ACN:
-                for (i = 0; i < MIN(nSH, nOutputs); i++)
-                    utility_svvcopy(pData->outputFrameTD[i], FRAME_SIZE, outputs[i]);
-                for (; i < nOutputs; i++)
-                    memset(outputs[i], 0, FRAME_SIZE*sizeof(float));
-                break;
-            case CH_FUMA: /* only for first-order */
-                if(nOutputs>=4){
-                    utility_svvcopy(pData->outputFrameTD[0], FRAME_SIZE, outputs[0]);
-                    utility_svvcopy(pData->outputFrameTD[1], FRAME_SIZE, outputs[2]);
-                    utility_svvcopy(pData->outputFrameTD[2], FRAME_SIZE, outputs[3]);
-                    utility_svvcopy(pData->outputFrameTD[3], FRAME_SIZE, outputs[1]);
+        /* the rotation is frequency-independent; FuMa (first-order only) is
+         * handled by equally permuting the rows and columns of the matrices */
+        M = (const float*)pData->M_rot;
+        prev_M = (const float*)pData->prev_M_rot;
+        ldM = MAX_NUM_SH_SIGNALS;
+        if(pData->chOrdering==CH_FUMA){
+            for(i=0; i<4; i++){
+                for(j=0; j<4; j++){
+                    M_fuma[i][j] = pData->M_rot[fuma2acn[i]][fuma2acn[j]];
+                    prev_M_fuma[i][j] = pData->prev_M_rot[fuma2acn[i]][fuma2acn[j]];
                 }
-                else
-                    for(i=0; i<nOutputs; i++)
-                        memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
-                break;
+            }
+            M = (const float*)M_fuma;
+            prev_M = (const float*)prev_M_fuma;
+            ldM = 4;
         }
+        
+        /* apply rotation (order-wise, crossfading over the time slots only the
+         * blocks that changed) */
+        tmp = (float*)pData->tempFrame;
+        for(band=0; band<nBands; band++){
+            in_b = &inTF[band*nInputs*rowLen];
+            out_b = &outTF[band*nSH_out*rowLen];
+            utility_svvcopy(in_b, rowLen, out_b); /* the zeroth order component is invariant to rotation */
+            for(n=1; n<=order; n++){
+                o_n = n*n;
+                len = 2*n+1;
+                nRows = MIN(len, nSH_out-o_n);
+                nCols = MIN(len, nInputs-o_n);
+                if(nRows<=0)
+                    break;
+                if(nCols<=0){
+                    memset(&out_b[o_n*rowLen], 0, nRows*rowLen*sizeof(float));
+                    continue;
+                }
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nRows, rowLen, nCols, 1.0f,
+                            &M[o_n*ldM+o_n], ldM, &in_b[o_n*rowLen], rowLen, 0.0f,
+                            &out_b[o_n*rowLen], rowLen);
+                if(changed[n]){
+                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nRows, rowLen, nCols, 1.0f,
+                                &prev_M[o_n*ldM+o_n], ldM, &in_b[o_n*rowLen], rowLen, 0.0f,
+                                tmp, rowLen);
+                    for(i=0; i<nRows; i++){
+                        for(j=0; j<rowLen; j++){
+                            w = (float)(j/2+1)/(float)nTimeSlots;
+                            out_b[(o_n+i)*rowLen+j] = w * out_b[(o_n+i)*rowLen+j] + (1.0f-w) * tmp[i*rowLen+j];
+                        }
+                    }
+                }
+            }
+        }
+        utility_svvcopy((const float*)pData->M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->prev_M_rot);
+        memcpy(pData->prev_quat, pData->quat_target, 4*sizeof(float));
     }
-    else{
-        for (i = 0; i < nOutputs; i++)
-            memset(outputs[i], 0, FRAME_SIZE*sizeof(float));
-    }
+    else
+        for(band=0; band<nBands; band++)
+            utility_svvcopy(&inTF[band*nInputs*rowLen], rowLen, &outTF[band*nSH_out*rowLen]);
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    return nSH_out;
+}
+
+void rotator_processInterleaved
+(
+    void  *  const hRot,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &rotator_processFrame, hRot);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
 }
 
 void rotator_setYaw(void  * const hRot, float newYaw)
 {
     rotator_data *pData = (rotator_data*)(hRot);
     pData->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
-    pData->recalc_M_rotFLAG = 1;
+    rotator_pushOrientation(pData);
 }
 
 void rotator_setPitch(void* const hRot, float newPitch)
 {
     rotator_data *pData = (rotator_data*)(hRot);
     pData->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
-    pData->recalc_M_rotFLAG = 1;
+    rotator_pushOrientation(pData);
 }
 
 void rotator_setRoll(void* const hRot, float newRoll)
 {
     rotator_data *pData = (rotator_data*)(hRot);
     pData->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
-    pData->recalc_M_rotFLAG = 1;
+    rotator_pushOrientation(pData);
+}
+
+void rotator_setQuaternion(void* const hRot, const float quat[4], double timestamp_s)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    float yaw, pitch, roll;
+    float values[ROTATOR_NUM_PARAM_VALUES];
+    
+    /* (for the get functions) */
+    quaternion2yawPitchRoll(quat, &yaw, &pitch, &roll);
+    pData->yaw = pData->bFlipYaw == 1 ? -yaw : yaw;
+    pData->pitch = pData->bFlipPitch == 1 ? -pitch : pitch;
+    pData->roll = pData->bFlipRoll == 1 ? -roll : roll;
+    
+    /* the timestamp is split into two floats, so that its precision is kept */
+    if(timestamp_s < 0.0)
+        timestamp_s = saf_benchmark_getTime();
+    memcpy(values, quat, 4*sizeof(float));
+    values[4] = (float)timestamp_s;
+    values[5] = (float)(timestamp_s - (double)values[4]);
+    saf_paramQueue_push(pData->hParamQueue, ROTATOR_PARAM_QUATERNION, values, 6);
+}
+
+void rotator_setEnableSubFrameInterp(void* const hRot, int newState)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    pData->enableSubFrameInterp = newState;
+}
+
+void rotator_setPredictionTime(void* const hRot, float newTime_ms)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    pData->predictionTime_ms = CLAMP(newTime_ms, 0.0f, ROTATOR_MAX_PREDICTION_TIME_MS);
 }
 
 void rotator_setFlipYaw(void* const hRot, int newState)
@@ -296,6 +614,7 @@ void rotator_setRPYflag(void* const hRot, int newState)
 {
     rotator_data *pData = (rotator_data*)(hRot);
     pData->useRollPitchYawFlag = newState;
+    rotator_pushOrientation(pData);
 }
 
 void rotator_setChOrder(void* const hRot, int newOrder)
@@ -315,7 +634,7 @@ void rotator_setNormType(void* const hRot, int newType)
 void rotator_setOrder(void* const hRot, int newOrder)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->inputOrder = (ROTATOR_INPUT_ORDERS)newOrder;
+    pData->inputOrder = (ROTATOR_INPUT_ORDERS)CLAMP(newOrder, 1, MAX_SH_ORDER);
     pData->recalc_M_rotFLAG = 1;
     /* FUMA only supports 1st order */
     if(pData->inputOrder!=INPUT_ORDER_FIRST && pData->chOrdering == CH_FUMA)
@@ -345,6 +664,18 @@ float rotator_getRoll(void* const hRot)
     return pData->bFlipRoll == 1 ? -RAD2DEG(pData->roll) : RAD2DEG(pData->roll);
 }
 
+int rotator_getEnableSubFrameInterp(void* const hRot)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    return pData->enableSubFrameInterp;
+}
+
+float rotator_getPredictionTime(void* const hRot)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    return pData->predictionTime_ms;
+}
+
 int rotator_getFlipYaw(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
@@ -393,5 +724,14 @@ int rotator_getNSHrequired(void* const hRot)
     return (pData->inputOrder+1)*(pData->inputOrder+1);
 }
 
+int rotator_getProcessingDelay(void* const hRot)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    return saf_fifo_getLatency(pData->hFIFO);
+}
 
-
+void* rotator_getTelemetry(void* const hRot)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    return pData->hTelemetry;
+}
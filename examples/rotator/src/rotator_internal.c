@@ -31,4 +31,110 @@
 #include "rotator.h"
 #include "rotator_internal.h"
 
+void rotator_applyRotation
+(
+    void* const hRot,
+    int order,
+    int activeOrder
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    int i, j, n, o_n, len, changed;
+    
+    /* the zeroth order component is invariant to rotation */
+    utility_svvcopy((const float*)pData->prev_inputFrameTD[0], FRAME_SIZE, (float*)pData->outputFrameTD[0]);
+    
+    for(n=activeOrder+1; n<=order; n++)
+        memset(pData->outputFrameTD[n*n], 0, (2*n+1)*FRAME_SIZE*sizeof(float));
+    for(n=1; n<=activeOrder; n++){
+        o_n = n*n;      /* index of the first component of this order */
+        len = 2*n+1;    /* number of components of this order */
+        
+        /* has the block for this order changed since the previous frame? */
+        changed = 0;
+        for(i=o_n; i<o_n+len && !changed; i++)
+            changed = memcmp(&(pData->M_rot[i][o_n]), &(pData->prev_M_rot[i][o_n]), len*sizeof(float)) != 0;
+        
+        /* apply rotation */
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, len, FRAME_SIZE, len, 1.0f,
+                    &(pData->M_rot[o_n][o_n]), MAX_NUM_SH_SIGNALS,
+                    (float*)pData->prev_inputFrameTD[o_n], FRAME_SIZE, 0.0f,
+                    (float*)pData->outputFrameTD[o_n], FRAME_SIZE);
+        if(changed){
+            /* crossfade from the previous rotation */
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, len, FRAME_SIZE, len, 1.0f,
+                        &(pData->prev_M_rot[o_n][o_n]), MAX_NUM_SH_SIGNALS,
+                        (float*)pData->prev_inputFrameTD[o_n], FRAME_SIZE, 0.0f,
+                        (float*)pData->tempFrame[o_n], FRAME_SIZE);
+            for (i=o_n; i < o_n+len; i++)
+                for(j=0; j<FRAME_SIZE; j++)
+                    pData->outputFrameTD[i][j] = pData->interpolator[j] * pData->outputFrameTD[i][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
+        }
+    }
+}
+
+void rotator_applyRotationSubFrames
+(
+    void* const hRot,
+    int order,
+    int activeOrder
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    int i, j, k, n, o_n, len, nSH, nSubFrames, offset, subLen;
+    float w;
+    float quat[4], Rxyz[3][3];
+    float (*M_from)[MAX_NUM_SH_SIGNALS], (*M_to)[MAX_NUM_SH_SIGNALS];
+    
+    nSH = (order+1)*(order+1);
+    nSubFrames = MAX(FRAME_SIZE/ROTATOR_SUBFRAME_SIZE, 1);
+    
+    /* the zeroth order component is invariant to rotation */
+    utility_svvcopy((const float*)pData->prev_inputFrameTD[0], FRAME_SIZE, (float*)pData->outputFrameTD[0]);
+    
+    for(n=activeOrder+1; n<=order; n++)
+        memset(pData->outputFrameTD[n*n], 0, (2*n+1)*FRAME_SIZE*sizeof(float));
+    M_from = pData->prev_M_rot;
+    for(k=0; k<nSubFrames; k++){
+        offset = k*FRAME_SIZE/nSubFrames;
+        subLen = (k+1)*FRAME_SIZE/nSubFrames - offset;
+        
+        /* rotation matrix at the end of this sub-frame (which, for the last
+         * one, is M_rot itself) */
+        if(k==nSubFrames-1)
+            M_to = pData->M_rot;
+        else{
+            quaternionSlerp(pData->prev_quat, pData->quat_target, (float)(k+1)/(float)nSubFrames, quat);
+            quaternion2rotationMatrix(quat, Rxyz);
+            shRotMtxReal_compute(pData->hSHrot, Rxyz, order, pData->M_rot_tmp);
+            M_to = pData->M_subFrame[k%2];
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    M_to[i][j] = pData->M_rot_tmp[i*nSH+j];
+        }
+        
+        /* apply rotation, crossfading from the matrix of the previous
+         * sub-frame (order-wise) */
+        for(n=1; n<=activeOrder; n++){
+            o_n = n*n;
+            len = 2*n+1;
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, len, subLen, len, 1.0f,
+                        &(M_to[o_n][o_n]), MAX_NUM_SH_SIGNALS,
+                        &(pData->prev_inputFrameTD[o_n][offset]), FRAME_SIZE, 0.0f,
+                        &(pData->outputFrameTD[o_n][offset]), FRAME_SIZE);
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, len, subLen, len, 1.0f,
+                        &(M_from[o_n][o_n]), MAX_NUM_SH_SIGNALS,
+                        &(pData->prev_inputFrameTD[o_n][offset]), FRAME_SIZE, 0.0f,
+                        &(pData->tempFrame[o_n][offset]), FRAME_SIZE);
+            for (i=o_n; i < o_n+len; i++){
+                for(j=0; j<subLen; j++){
+                    w = (float)(j+1)/(float)subLen;
+                    pData->outputFrameTD[i][offset+j] = w * pData->outputFrameTD[i][offset+j] + (1.0f-w) * pData->tempFrame[i][offset+j];
+                }
+            }
+        }
+        M_from = M_to;
+    }
+}
+
 
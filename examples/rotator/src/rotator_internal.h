@@ -47,6 +47,15 @@ extern "C" {
 
 #define MAX_SH_ORDER ( ROTATOR_MAX_SH_ORDER )
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER + 1)*(MAX_SH_ORDER + 1)  )    /* (L+1)^2 */
+#if MAX_SH_ORDER < 1 || MAX_SH_ORDER > 7
+# error "ROTATOR_MAX_SH_ORDER must be between 1 and 7"
+#endif
+#define ROTATOR_PARAM_ORIENTATION ( 0 )  /* yaw, pitch, roll (in radians), and the rotation order flag */
+#define ROTATOR_PARAM_QUATERNION ( 1 )   /* quaternion (w,x,y,z), and its timestamp (split into two floats) */
+#define ROTATOR_NUM_PARAMS ( 2 )         /* number of parameters handed over via the parameter queue */
+#define ROTATOR_NUM_PARAM_VALUES ( 6 )   /* maximum number of values per parameter */
+#define ROTATOR_MAX_PREDICTION_TIME_MS ( 100.0f ) /* maximum of the user prediction time */
+#define ROTATOR_SUBFRAME_SIZE ( 64 )     /* granularity of the sub-frame rotation interpolation, in samples */
 #ifndef DEG2RAD
   #define DEG2RAD(x) (x * PI / 180.0f)
 #endif
@@ -64,6 +73,8 @@ extern "C" {
  */
 typedef struct _rotator
 {
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float inputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float prev_inputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float tempFrame[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
@@ -73,7 +84,20 @@ typedef struct _rotator
     float interpolator[FRAME_SIZE];
     float M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
     float prev_M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    float M_rot_tmp[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS]; /**< packed nSH x nSH rotation matrix */
+    float M_subFrame[2][MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS]; /**< rotation matrices at the ends of consecutive sub-frames */
+    float quat_target[4];                 /**< orientation of M_rot (quaternion) */
+    float prev_quat[4];                   /**< orientation of prev_M_rot (quaternion) */
+    void* hSHrot;                         /**< SH rotation matrix generator handle */
+    void* hOrderDet;                      /**< effective input order detector; only the orders carrying content are rotated */
     int recalc_M_rotFLAG;
+    void* hParamQueue;                    /**< parameter updates for the processing loop (see saf_paramQueue.h) */
+    float ypr_proc[3];                    /**< yaw, pitch, roll (in radians) in use by the processing loop */
+    int useRollPitchYawFlag_proc;         /**< rotation order flag in use by the processing loop */
+    void* hOrientPred;                    /**< predicts the orientation from the quaternions (see saf_orientation.h) */
+    int useQuaternion_proc;               /**< 1: the orientation is predicted from the quaternions, 0: yaw-pitch-roll are used */
+    float quat_proc[4];                   /**< predicted orientation in use by the processing loop (if useQuaternion_proc) */
+    float fs;                             /**< host samplerate */
 
     /* user parameters */
     float yaw, roll, pitch;               /**< rotation angles in degrees */
@@ -82,10 +106,54 @@ typedef struct _rotator
     ROTATOR_NORM_TYPES norm;              /**< N3D or SN3D */
     ROTATOR_INPUT_ORDERS inputOrder;      /**< current input/output order int order;*/
     int useRollPitchYawFlag;              /**< rotation order flag, 1: r-p-y, 0: y-p-r */
+    float predictionTime_ms;              /**< additional time the quaternions are predicted ahead (e.g. output latency) */
+    int enableSubFrameInterp;             /**< 1: the orientation is interpolated every ROTATOR_SUBFRAME_SIZE samples, 0: once per frame */
     
 } rotator_data;
     
     
+/* ========================================================================== */
+/*                             Internal Functions                             */
+/* ========================================================================== */
+
+/**
+ * Rotates 'prev_inputFrameTD' into 'outputFrameTD', crossfading from
+ * 'prev_M_rot' to 'M_rot' over the frame
+ *
+ * Since the real SH rotation matrices are block-diagonal (one (2l+1)x(2l+1)
+ * block per order l), each order is processed with its own small matrix
+ * multiplication, rather than one dense nSH x nSH product. Only the blocks
+ * that have changed since the previous frame are computed twice and
+ * crossfaded; the others require only one product. The orders above
+ * 'activeOrder' carry no content, and are simply zeroed.
+ *
+ * @param[in] hRot        rotator handle
+ * @param[in] order       Current input/output order (>0)
+ * @param[in] activeOrder Effective order of the input (see
+ *                        shOrderDetector_apply()); activeOrder <= order
+ */
+void rotator_applyRotation(void* const hRot,
+                           int order,
+                           int activeOrder);
+
+/**
+ * As rotator_applyRotation(), but the orientation is interpolated (slerp) from
+ * 'prev_quat' to 'quat_target' over the frame, and a rotation matrix is
+ * computed for the end of every sub-frame of ROTATOR_SUBFRAME_SIZE samples;
+ * the matrices are then crossfaded over each sub-frame, rather than over the
+ * whole frame. This way, a fast head turn follows the arc of the rotation even
+ * with a large FRAME_SIZE, rather than the chord between the two rotation
+ * matrices (which also loses energy, when the angle between them is large).
+ *
+ * @param[in] hRot        rotator handle
+ * @param[in] order       Current input/output order (>0)
+ * @param[in] activeOrder Effective order of the input; activeOrder <= order
+ */
+void rotator_applyRotationSubFrames(void* const hRot,
+                                    int order,
+                                    int activeOrder);
+    
+
 #ifdef __cplusplus
 } /* extern "C" { */
 #endif /* __cplusplus */
@@ -179,6 +179,9 @@ void sldoa_initCodec(void* const hSld);
  * Applies the spatially-localised active-intensity based direction-of-arrival
  * estimator (SLDoA) onto the input signals [1,2].
  *
+ * @note Any block size may be used, as the signals are buffered internally into
+ *       frames of FRAME_SIZE samples
+ *
  * @param[in] hSld      sldoa handle
  * @param[in] inputs    Input channel buffers; 2-D array: nInputs x nSamples
  * @param[in] nInputs   Number of input channels
@@ -203,6 +206,62 @@ void sldoa_analysis(void* const hSld,
                     int nSamples,
                     int isPlaying);
 
+/**
+ * Same as sldoa_analysis(), but using the TF-domain frames computed by a
+ * shared analysis front-end (see shFrontEnd_create()); which may serve several
+ * analysers of the same spherical harmonic signals
+ *
+ * This function is subscribed to the front-end with needsCov = 0, e.g.: \code
+ *   shFrontEnd_subscribe(hFE, &sldoa_analysisFrontEnd, hSld, 0);
+ * \endcode
+ * The front-end must use the same frame size (sldoa_getFrameSize()) and
+ * sampling rate as sldoa. Its input format is used instead of the channel
+ * order and normalisation settings of sldoa; and the master order of sldoa
+ * applies, if it is the lower of the two.
+ *
+ * @param[in] hSld   sldoa handle
+ * @param[in] hFrame Current frame of the front-end (see shFrontEnd_subscriber)
+ */
+void sldoa_analysisFrontEnd(void* const hSld,
+                            const void* hFrame);
+
+/**
+ * Applies the SLDoA estimator onto an entire (e.g. recorded, or memory-mapped)
+ * buffer of input signals, with the current configuration, and returns the
+ * (averaged) DoA and energy estimates after every frame of
+ * sldoa_getFrameSize() samples
+ *
+ * The frames are split into one contiguous share per thread, and each thread
+ * uses its own sldoa instance; the state of 'hSld' is not altered. Each share
+ * is preceded by a few "pre-roll" frames, long enough for the averaging
+ * (see sldoa_setAvg()) to forget its initial state; so the results match those
+ * of a single sequential pass up to a negligible (<-60dB) difference.
+ *
+ * @note sldoa_init() must have been called beforehand (to set the sampling
+ *       rate). The estimates of band 'b' are valid for the first
+ *       sldoa_getAnaOrder(hSld,b)^2 sectors, and for the bands within the
+ *       analysis frequency range (see sldoa_setMinFreq(), sldoa_setMaxFreq())
+ *
+ * @param[in]  hSld     sldoa handle
+ * @param[in]  inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nSamples Number of samples per channel
+ * @param[in]  nThreads Number of threads ('0': one per CPU core)
+ * @param[out] doa_rad  DoA estimates [azimuth elevation], in radians;
+ *                      FLAT: nFrames x sldoa_getNumberOfBands() x
+ *                      sldoa_getMaxNumSectors() x 2
+ * @param[out] energy   Sector energies; FLAT: nFrames x
+ *                      sldoa_getNumberOfBands() x sldoa_getMaxNumSectors()
+ * @returns Number of frames analysed: nFrames = nSamples/sldoa_getFrameSize()
+ */
+int sldoa_analyseOffline(void* const hSld,
+                         const float* const* inputs,
+                         int nInputs,
+                         int nSamples,
+                         int nThreads,
+                         float* doa_rad,
+                         float* energy);
+
 
 /* ========================================================================== */
 /*                                Set Functions                               */
@@ -221,6 +280,10 @@ void sldoa_refreshSettings(void* const hSld);
    
 /**
  * Sets the maximum analysis frequency, in Hz
+ *
+ * @note The DoA estimation (and, with sldoa_analysisFrontEnd(), the copying of
+ *       the TF-domain frame) is skipped for bands outside of the analysis
+ *       frequency range; so narrowing it also reduces the cost of the analysis
  */
 void sldoa_setMaxFreq(void* const hSld, float newFreq);
 
@@ -234,6 +297,26 @@ void sldoa_setMinFreq(void* const hSld, float newFreq);
  */
 void sldoa_setAvg(void* const hSld, float newAvg);
 
+/**
+ * Sets the maximum number of DoA analysis updates per second ('0': every
+ * frame); the frames in between are only transformed, and the averaging is
+ * adjusted so that its time constant stays the same
+ */
+void sldoa_setMaxUpdateRate(void* const hSld, float newValue);
+
+/**
+ * Sets the crossover frequency of the multi-resolution analysis, in Hz ('0':
+ * disabled, the default)
+ *
+ * The bands below the crossover are analysed for every time slot, whereas
+ * those above it are analysed for every 2nd time slot in the first octave,
+ * every 3rd in the second, and every 4th beyond that; with the averaging
+ * adjusted so that its time constant stays the same. Since most of the bands
+ * lie at high frequencies, where the temporal resolution of spatial hearing is
+ * coarser, this saves much of the cost of the analysis (e.g. with 1.5e3f)
+ */
+void sldoa_setMultiResolutionFreq(void* const hSld, float newFreq);
+
 /**
  * Sets the input/analysis order for one specific frequency band.
  */
@@ -314,11 +397,33 @@ float sldoa_getMinFreq(void* const hSld);
  */
 float sldoa_getAvg(void* const hSld);
 
+/**
+ * Returns the maximum number of DoA analysis updates per second ('0': every
+ * frame)
+ */
+float sldoa_getMaxUpdateRate(void* const hSld);
+
+/**
+ * Returns the crossover frequency of the multi-resolution analysis, in Hz
+ * ('0': disabled)
+ */
+float sldoa_getMultiResolutionFreq(void* const hSld);
+
 /**
  * Returns the number frequency bands employed by sldoa
  */
 int sldoa_getNumberOfBands(void);
 
+/**
+ * Returns the number of samples per analysis frame
+ */
+int sldoa_getFrameSize(void);
+
+/**
+ * Returns the maximum number of sectors per frequency band
+ */
+int sldoa_getMaxNumSectors(void);
+
 /**
  * Returns the number of spherical harmonic signals required by the current
  * analysis order: (current_order + 1)^2
@@ -393,6 +498,20 @@ int sldoa_getChOrder(void* const hSld);
  */
 int sldoa_getNormType(void* const hSld);
 
+/**
+ * Returns the delay of the analysis in samples, i.e. by how much the estimates
+ * lag behind the input signals (the latency of the FIFO, if the host block size
+ * is not a multiple of FRAME_SIZE, plus the group delay of the forward afSTFT)
+ */
+int sldoa_getProcessingDelay(void* const hSld);
+
+/**
+ * Returns the handle of the telemetry, i.e. the health metrics of this
+ * instance (frames processed/dropped, time taken per frame, and time spent
+ * re-initialising the codec); see saf_telemetry_getSnapshot()
+ */
+void* sldoa_getTelemetry(void* const hSld);
+
     
 #ifdef __cplusplus
 } /* extern "C" */
@@ -53,14 +53,9 @@ void sldoa_create
 {
     sldoa_data* pData = (sldoa_data*)malloc1d(sizeof(sldoa_data));
     *phSld = (void*)pData;
-    int i, j, ch, band;
+    int i, j, band;
     
-    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1);
-    pData->STFTInputFrameTF = malloc1d(MAX_NUM_SH_SIGNALS*sizeof(complexVector));
-    for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-        pData->STFTInputFrameTF[ch].re = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-        pData->STFTInputFrameTF[ch].im = (float*)calloc1d(HYBRID_BANDS, sizeof(float));
-    }
+    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     pData->tempHopFrameTD = (float**)malloc2d(MAX_NUM_SH_SIGNALS, HOP_SIZE, sizeof(float));
     
     /* internal */
@@ -69,18 +64,20 @@ void sldoa_create
     strcpy(pData->progressBarText,"");
     pData->codecStatus = CODEC_STATUS_NOT_INITIALISED;
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
-    for(i=0; i<MAX_SH_ORDER; i++)
+    for(i=0; i<MAX_SH_ORDER-1; i++)
         pData->secCoeffs[i] = NULL;
-    for(i=0; i<64; i++)
-        for(j=0; j<NUM_GRID_DIRS; j++)
-            pData->grid_Y[i][j] = (float)__grid_Y[i][j] * sqrtf(4.0*M_PI);
-    for(i=0; i<3; i++)
-        for(j=0; j<NUM_GRID_DIRS; j++)
-            pData->grid_Y_dipoles_norm[i][j] = pData->grid_Y[i+1][j]/sqrtf(3); /* scale to [0..1] */
     for(i=0; i<NUM_GRID_DIRS; i++)
         for(j=0; j<2; j++)
             pData->grid_dirs_deg[i][j] = (float)__grid_dirs_deg[i][j];
     
+    /* spherical harmonics (up to 7th order) for the scanning grid; computed
+     * here, rather than stored in the database, to keep the binary size down.
+     * The matrix is shared between all instances (including the workers) */
+    pData->grid_Y = steeringMtxCache_acquire(7, (float*)pData->grid_dirs_deg, NUM_GRID_DIRS, 1.0f);
+    for(i=0; i<3; i++)
+        for(j=0; j<NUM_GRID_DIRS; j++)
+            pData->grid_Y_dipoles_norm[i][j] = pData->grid_Y[(i+1)*NUM_GRID_DIRS+j]/sqrtf(3); /* scale to [0..1] */
+    
     /* display */
     for(i=0; i<NUM_DISP_SLOTS; i++){
         pData->azi_deg[i] = malloc1d(HYBRID_BANDS*MAX_NUM_SECTORS * sizeof(float));
@@ -88,6 +85,9 @@ void sldoa_create
         pData->colourScale[i] = malloc1d(HYBRID_BANDS*MAX_NUM_SECTORS * sizeof(float));
         pData->alphaScale[i] = malloc1d(HYBRID_BANDS*MAX_NUM_SECTORS * sizeof(float));
     }
+    pData->frameTime_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
+    pData->nFramesSinceUpdate = 0;
     
     /* Default user parameters */
     pData->new_masterOrder = pData->masterOrder = 1;
@@ -98,8 +98,14 @@ void sldoa_create
     pData->minFreq = 500.0f;
     pData->maxFreq = 5e3f;
     pData->avg_ms = 500.0f;
+    pData->maxUpdateRate = 0.0f;
+    pData->multiResFreq = 0.0f;
     pData->chOrdering = CH_ACN;
     pData->norm = NORM_SN3D;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_SH_SIGNALS, 0);
+    saf_telemetry_create(&(pData->hTelemetry));
 }
 
 void sldoa_destroy
@@ -108,7 +114,7 @@ void sldoa_destroy
 )
 {
     sldoa_data *pData = (sldoa_data*)(*phSld);
-    int i, ch;
+    int i;
 
     if (pData != NULL) {
         /* not safe to free memory during intialisation/processing loop */
@@ -119,11 +125,6 @@ void sldoa_destroy
         
         /* free afSTFT and buffers */
         afSTFTfree(pData->hSTFT);
-        for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-            free(pData->STFTInputFrameTF[ch].re);
-            free(pData->STFTInputFrameTF[ch].im);
-        }
-        free(pData->STFTInputFrameTF);
         free(pData->tempHopFrameTD);
         for(i=0; i<NUM_DISP_SLOTS; i++){
             free(pData->azi_deg[i]);
@@ -131,7 +132,12 @@ void sldoa_destroy
             free(pData->colourScale[i]);
             free(pData->alphaScale[i]);
         }
+        for(i=0; i<MAX_SH_ORDER-1; i++)
+            free(pData->secCoeffs[i]);
+        steeringMtxCache_release((void**)&(pData->grid_Y));
         free(pData->progressBarText);
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
         free(pData);
         pData = NULL;
     }
@@ -163,6 +169,9 @@ void sldoa_init
     
     /* intialise display parameters */
     pData->current_disp_idx = 0;
+    pData->frameTime_s = 0.0;
+    pData->lastUpdateTime_s = 0.0;
+    pData->nFramesSinceUpdate = 0;
     memset(pData->doa_rad, 0, HYBRID_BANDS*MAX_NUM_SECTORS*2* sizeof(float));
     memset(pData->energy, 0, HYBRID_BANDS*MAX_NUM_SECTORS* sizeof(float));
     for(i=0; i<NUM_DISP_SLOTS; i++){
@@ -192,9 +201,11 @@ void sldoa_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISING;
     strcpy(pData->progressBarText,"Initialising");
     pData->progressBar0_1 = 0.0f;
+    saf_telemetry_reinitBegin(pData->hTelemetry);
     
     sldoa_initTFT(hSld);
     sldoa_initAna(hSld);
+    saf_telemetry_reinitEnd(pData->hTelemetry);
     
     /* done! */
     strcpy(pData->progressBarText,"Done!");
@@ -202,40 +213,170 @@ void sldoa_initCodec
     pData->codecStatus = CODEC_STATUS_INITIALISED;
 }
 
-void sldoa_analysis
+/**
+ * Returns the step between the analysed time slots of a band centred at 'freq';
+ * every slot below the crossover frequency, and then one more slot per octave
+ * above it (see sldoa_setMultiResolutionFreq())
+ */
+static int sldoa_slotStep
+(
+    float freq,
+    float crossoverFreq
+)
+{
+    if(crossoverFreq<=0.0f || freq<crossoverFreq)
+        return 1;
+    return MIN(MIN(2 + (int)log2f(freq/crossoverFreq), SLDOA_MAX_SLOT_STEP), TIME_SLOTS);
+}
+
+/**
+ * Applies the sector-based DoA analysis to the current TF-domain frame
+ * (SHframeTF), and updates the data for plotting; i.e. the main processing of
+ * sldoa_analysisFrame(), which is shared with sldoa_analysisFrontEnd()
+ */
+static void sldoa_analyseFrameTF
+(
+    sldoa_data* pData
+)
+{
+    int i, j, t, band, nSectors, min_band, numAnalysisBands, current_disp_idx, nFramesSinceUpdate, slotStep, nSlots;
+    float avgCoeff, max_en[HYBRID_BANDS], min_en[HYBRID_BANDS];
+    float new_doa[MAX_NUM_SECTORS][TIME_SLOTS][2], new_doa_xyz[3], doa_xyz[3], avg_xyz[3];
+    float new_energy[MAX_NUM_SECTORS][TIME_SLOTS];
+    
+    /* local parameters */
+    int analysisOrderPerBand[HYBRID_BANDS];
+    int nSectorsPerBand[HYBRID_BANDS];
+    float minFreq, maxFreq, avg_ms, maxUpdateRate, multiResFreq;
+    
+    /* copy current parameters to be thread safe */
+    current_disp_idx = pData->current_disp_idx;
+    memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
+    memcpy(nSectorsPerBand, pData->nSectorsPerBand, HYBRID_BANDS*sizeof(int));
+    minFreq = pData->minFreq;
+    maxFreq = pData->maxFreq;
+    avg_ms = pData->avg_ms;
+    maxUpdateRate = pData->maxUpdateRate;
+    multiResFreq = pData->multiResFreq;
+    
+    /* skip the analysis of this frame, if it would exceed the maximum update rate */
+    pData->frameTime_s += (double)FRAME_SIZE/(double)pData->fs;
+    pData->nFramesSinceUpdate++;
+    if(maxUpdateRate>0.0f && pData->frameTime_s-pData->lastUpdateTime_s < 1.0/(double)maxUpdateRate - 1e-9)
+        return;
+    pData->lastUpdateTime_s = pData->frameTime_s;
+    nFramesSinceUpdate = pData->nFramesSinceUpdate;
+    pData->nFramesSinceUpdate = 0;
+    
+    /* apply sector-based, frequency-dependent DOA analysis */
+    numAnalysisBands = 0;
+    min_band = 0;
+    for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
+        if(pData->freqVector[band] <= minFreq)
+            min_band = band;
+        if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
+            nSectors = nSectorsPerBand[band];
+            avgCoeff = avg_ms < 10.0f ? 1.0f : 1.0f / ((avg_ms/1e3f) / (1.0f/(float)HOP_SIZE) + 2.23e-9f);
+            avgCoeff = MAX(MIN(avgCoeff, 0.99999f), 0.0f); /* ensures stability */
+            if(nFramesSinceUpdate>1) /* same time constant, over the skipped frames */
+                avgCoeff = 1.0f - powf(1.0f-avgCoeff, (float)nFramesSinceUpdate);
+            slotStep = sldoa_slotStep(pData->freqVector[band], multiResFreq);
+            nSlots = sldoa_estimateDoA(pData->SHframeTF[band],
+                                       analysisOrderPerBand[band],
+                                       pData->secCoeffs[analysisOrderPerBand[band]-2], /* -2, as first order is skipped */
+                                       slotStep,
+                                       new_doa,
+                                       new_energy);
+            if(nSlots<TIME_SLOTS) /* same time constant, over the skipped time slots */
+                avgCoeff = 1.0f - powf(1.0f-avgCoeff, (float)TIME_SLOTS/(float)nSlots);
+            
+            /* average the raw data over time */
+            for(i=0; i<nSectors; i++){
+                for( t = 0; t<nSlots; t++){
+                    /* avg doa estimate */
+                    unitSph2Cart(new_doa[i][t][0], new_doa[i][t][1], new_doa_xyz);
+                    unitSph2Cart(pData->doa_rad[band][i][0],
+                                 pData->doa_rad[band][i][1],
+                                 doa_xyz);
+                    for(j=0; j<3; j++)
+                        avg_xyz[j] = new_doa_xyz[j]*avgCoeff + doa_xyz[j] * (1.0f-avgCoeff);
+                    unitCart2Sph_aziElev(avg_xyz, &(pData->doa_rad[band][i][0]), &(pData->doa_rad[band][i][1]));
+                    
+                    /* avg energy */
+                    pData->energy[band][i] = new_energy[i][t]*avgCoeff + pData->energy[band][i] * (1.0f-avgCoeff);
+                }
+            }
+            numAnalysisBands++;
+        }
+    }
+    
+    /* determine the minimum and maximum sector energies per frequency (to scale them 0..1) */
+    for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
+        if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
+            nSectors = nSectorsPerBand[band];
+            max_en[band] = 2.3e-13f; min_en[band] = 2.3e13f; /* starting values */
+            for(i=0; i<nSectors; i++){
+                max_en[band] = pData->energy[band][i] > max_en[band] ? pData->energy[band][i] : max_en[band];
+                min_en[band] = pData->energy[band][i] < min_en[band] ? pData->energy[band][i] : min_en[band];
+            }
+        }
+    }
+    
+    /* prep data for plotting */
+    for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
+        if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
+            nSectors = nSectorsPerBand[band];
+            /* store averaged values */
+            for(i=0; i<nSectors; i++){
+                pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][0]*180.0f/M_PI;
+                pData->elev_deg[current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][1]*180.0f/M_PI;
+                
+                /* colour should indicate the different frequencies */
+                pData->colourScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = (float)(band-min_band)/(float)(numAnalysisBands+1);
+                
+                /* transparancy should indicate the energy of the sector for each DoA estimate, for each frequency */
+                if( analysisOrderPerBand[band]==1  )
+                    pData->alphaScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = 1.0f;
+                else
+                    pData->alphaScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = MIN(MAX((pData->energy[band][i]-min_en[band])/(max_en[band]-min_en[band]+2.3e-10f), 0.05f),1.0f);
+            }
+        }
+        else{
+            memset(&(pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
+            memset(&(pData->elev_deg [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
+            memset(&(pData->colourScale [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
+            memset(&(pData->alphaScale [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
+        }
+    }
+}
+
+/**
+ * Processes one frame of FRAME_SIZE samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void sldoa_analysisFrame
 (
     void  *  const hSld,
     float ** const inputs,
+    float ** const outputs,
     int            nInputs,
-    int            nSamples,
-    int            isPlaying 
+    int            nOutputs
 )
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    int i, j, t, n, ch, band, nSectors, min_band, numAnalysisBands, current_disp_idx;
-    float avgCoeff, max_en[HYBRID_BANDS], min_en[HYBRID_BANDS];
-    float new_doa[MAX_NUM_SECTORS][TIME_SLOTS][2], new_doa_xyz[3], doa_xyz[3], avg_xyz[3];
-    float new_energy[MAX_NUM_SECTORS][TIME_SLOTS];
+    int i, t, n, ch;
     int o[MAX_SH_ORDER+2];
     
     /* local parameters */
     int nSH, masterOrder;
-    int analysisOrderPerBand[HYBRID_BANDS];
-    int nSectorsPerBand[HYBRID_BANDS];
-    float minFreq, maxFreq, avg_ms;
     SLDOA_CH_ORDER chOrdering;
     SLDOA_NORM_TYPES norm;
     
-    if (nSamples == FRAME_SIZE && (pData->codecStatus == CODEC_STATUS_INITIALISED) && isPlaying) {
+    if (pData->codecStatus == CODEC_STATUS_INITIALISED) {
         pData->procStatus = PROC_STATUS_ONGOING;
-        current_disp_idx = pData->current_disp_idx;
+        saf_telemetry_frameBegin(pData->hTelemetry);
         
         /* copy current parameters to be thread safe */
-        memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
-        memcpy(nSectorsPerBand, pData->nSectorsPerBand, HYBRID_BANDS*sizeof(int));
-        minFreq = pData->minFreq;
-        maxFreq = pData->maxFreq;
-        avg_ms = pData->avg_ms;
         chOrdering = pData->chOrdering;
         norm = pData->norm;
         masterOrder = pData->masterOrder;
@@ -288,91 +429,192 @@ void sldoa_analysis
         for(t = 0; t < TIME_SLOTS; t++) {
             for(ch = 0; ch < nSH; ch++)
                 utility_svvcopy(&(pData->SHframeTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for(band = 0; band < HYBRID_BANDS; band++)
-                for(ch = 0; ch < nSH; ch++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
+            afSTFTforwardPlanar(pData->hSTFT, pData->tempHopFrameTD, &(pData->SHframeTF[0][0][t]), MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS);
         }
         
-        /* apply sector-based, frequency-dependent DOA analysis */
-        numAnalysisBands = 0;
-        min_band = 0;
-        for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
-            if(pData->freqVector[band] <= minFreq)
-                min_band = band;
-            if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
-                nSectors = nSectorsPerBand[band];
-                avgCoeff = avg_ms < 10.0f ? 1.0f : 1.0f / ((avg_ms/1e3f) / (1.0f/(float)HOP_SIZE) + 2.23e-9f);
-                avgCoeff = MAX(MIN(avgCoeff, 0.99999f), 0.0f); /* ensures stability */
-                sldoa_estimateDoA(pData->SHframeTF[band],
-                                  analysisOrderPerBand[band],
-                                  pData->secCoeffs[analysisOrderPerBand[band]-2], /* -2, as first order is skipped */
-                                  new_doa,
-                                  new_energy);
-                
-                /* average the raw data over time */
-                for(i=0; i<nSectors; i++){
-                    for( t = 0; t<TIME_SLOTS; t++){
-                        /* avg doa estimate */
-                        unitSph2Cart(new_doa[i][t][0], new_doa[i][t][1], new_doa_xyz);
-                        unitSph2Cart(pData->doa_rad[band][i][0],
-                                     pData->doa_rad[band][i][1],
-                                     doa_xyz);
-                        for(j=0; j<3; j++)
-                            avg_xyz[j] = new_doa_xyz[j]*avgCoeff + doa_xyz[j] * (1.0f-avgCoeff);
-                        unitCart2Sph_aziElev(avg_xyz, &(pData->doa_rad[band][i][0]), &(pData->doa_rad[band][i][1]));
-                        
-                        /* avg energy */
-                        pData->energy[band][i] = new_energy[i][t]*avgCoeff + pData->energy[band][i] * (1.0f-avgCoeff);
-                    }
-                }
-                numAnalysisBands++;
-            }
-        }
-        
-        /* determine the minimum and maximum sector energies per frequency (to scale them 0..1) */
-        for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
-            if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
-                nSectors = nSectorsPerBand[band];
-                max_en[band] = 2.3e-13f; min_en[band] = 2.3e13f; /* starting values */
-                for(i=0; i<nSectors; i++){
-                    max_en[band] = pData->energy[band][i] > max_en[band] ? pData->energy[band][i] : max_en[band];
-                    min_en[band] = pData->energy[band][i] < min_en[band] ? pData->energy[band][i] : min_en[band];
-                }
-            }
-        }
-        
-        /* prep data for plotting */
-        for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
-            if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
-                nSectors = nSectorsPerBand[band];
-                /* store averaged values */
-                for(i=0; i<nSectors; i++){
-                    pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][0]*180.0f/M_PI;
-                    pData->elev_deg[current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][1]*180.0f/M_PI;
-                    
-                    /* colour should indicate the different frequencies */
-                    pData->colourScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = (float)(band-min_band)/(float)(numAnalysisBands+1);
-                    
-                    /* transparancy should indicate the energy of the sector for each DoA estimate, for each frequency */
-                    if( analysisOrderPerBand[band]==1  )
-                        pData->alphaScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = 1.0f;
-                    else
-                        pData->alphaScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = MIN(MAX((pData->energy[band][i]-min_en[band])/(max_en[band]-min_en[band]+2.3e-10f), 0.05f),1.0f);
-                }
-            }
-            else{
-                memset(&(pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
-                memset(&(pData->elev_deg [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
-                memset(&(pData->colourScale [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
-                memset(&(pData->alphaScale [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
-            }
-        }
+        /* Main processing: */
+        sldoa_analyseFrameTF(pData);
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
+    else
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
 }
 
+void sldoa_analysisFrontEnd
+(
+    void  *  const hSld,
+    const void *   hFrame
+)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    const shFrontEnd_frame* frame = (const shFrontEnd_frame*)hFrame;
+    int band, nSH, nSH_frame;
+    float minFreq, maxFreq;
+    unsigned int fpState;
+    int blasState;
+    
+    if (pData->codecStatus != CODEC_STATUS_INITIALISED){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
+        return;
+    }
+    if (frame->nTimeSlots != TIME_SLOTS){
+        saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_BLOCK_SIZE);
+        return;
+    }
+    if (frame->nBands != HYBRID_BANDS)
+        return;
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    pData->procStatus = PROC_STATUS_ONGOING;
+    saf_telemetry_frameBegin(pData->hTelemetry);
+    
+    /* copy the TF-domain frame of the front-end (zeroing any components above
+     * its order), for the bands within the analysis frequency range (the
+     * others are not analysed; see sldoa_analyseFrameTF()) */
+    minFreq = pData->minFreq;
+    maxFreq = pData->maxFreq;
+    nSH = ORDER2NSH(pData->masterOrder);
+    nSH_frame = MIN(ORDER2NSH(frame->order), nSH);
+    for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
+        if(pData->freqVector[band] < minFreq || pData->freqVector[band] > maxFreq)
+            continue;
+        utility_cvvcopy(&(frame->TF[band*ORDER2NSH(frame->order)*TIME_SLOTS]), nSH_frame*TIME_SLOTS, pData->SHframeTF[band][0]);
+        if(nSH_frame<nSH)
+            memset(pData->SHframeTF[band][nSH_frame], 0, (nSH-nSH_frame)*TIME_SLOTS*sizeof(float_complex));
+    }
+    
+    /* Main processing: */
+    sldoa_analyseFrameTF(pData);
+    saf_telemetry_frameEnd(pData->hTelemetry);
+    
+    pData->procStatus = PROC_STATUS_NOT_ONGOING;
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void sldoa_analysis
+(
+    void  *  const hSld,
+    float ** const inputs,
+    int            nInputs,
+    int            nSamples,
+    int            isPlaying 
+)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    if(isPlaying)
+        saf_fifo_process(pData->hFIFO, inputs, NULL, nInputs, 0, nSamples, &sldoa_analysisFrame, hSld);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+/**
+ * Analyses the frames [first, last) of an offline job, using the instance of
+ * the calling thread; called via saf_parfor_run()
+ */
+static void sldoa_offlineRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    sldoa_offlineJob* job = (sldoa_offlineJob*)(hCtx);
+    sldoa_data *pW = (sldoa_data*)(job->hWorkers[threadIndex]);
+    float* frameIn[SLDOA_MAX_NUM_INPUT_CHANNELS];
+    int f, ch;
+    
+    /* the pre-roll frames are only analysed to settle the averaging */
+    for(f=MAX(first-job->nPreRollFrames, 0); f<last; f++){
+        for(ch=0; ch<job->nInputs; ch++)
+            frameIn[ch] = (float*)&(job->inputs[ch][(size_t)f*FRAME_SIZE]);
+        sldoa_analysisFrame((void*)pW, frameIn, NULL, job->nInputs, 0);
+        if(f>=first){
+            memcpy(&(job->doa_rad[(size_t)f*HYBRID_BANDS*MAX_NUM_SECTORS*2]), pW->doa_rad, HYBRID_BANDS*MAX_NUM_SECTORS*2*sizeof(float));
+            memcpy(&(job->energy[(size_t)f*HYBRID_BANDS*MAX_NUM_SECTORS]), pW->energy, HYBRID_BANDS*MAX_NUM_SECTORS*sizeof(float));
+        }
+    }
+}
+
+int sldoa_analyseOffline
+(
+    void  *  const hSld,
+    const float* const* inputs,
+    int            nInputs,
+    int            nSamples,
+    int            nThreads,
+    float*         doa_rad,
+    float*         energy
+)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    sldoa_data *pW;
+    sldoa_offlineJob job;
+    void* hParFor;
+    int i, nFrames, nThreadsInUse;
+    float avgCoeff;
+    
+    nFrames = nSamples/FRAME_SIZE;
+    if(nFrames<1)
+        return 0;
+    
+    /* pre-roll long enough for the initial state to decay below -60dB (see
+     * the averaging coefficient in sldoa_analysisFrame()), plus one frame for
+     * the filterbank */
+    avgCoeff = pData->avg_ms < 10.0f ? 1.0f : 1.0f / ((pData->avg_ms/1e3f) / (1.0f/(float)HOP_SIZE) + 2.23e-9f);
+    avgCoeff = MAX(MIN(avgCoeff, 0.99999f), 0.0f);
+    job.nPreRollFrames = 1;
+    if(avgCoeff<1.0f)
+        job.nPreRollFrames += (int)ceilf(logf(1e-3f)/logf(1.0f-avgCoeff)/(float)TIME_SLOTS);
+    
+    /* one instance per thread, with the current configuration */
+    saf_parfor_create(&hParFor, nThreads);
+    nThreadsInUse = saf_parfor_getNumThreads(hParFor);
+    job.hWorkers = (void**)malloc1d(nThreadsInUse*sizeof(void*));
+    for(i=0; i<nThreadsInUse; i++){
+        sldoa_create(&(job.hWorkers[i]));
+        pW = (sldoa_data*)(job.hWorkers[i]);
+        afSTFTfree(pW->hSTFT); /* (the threads are already taken) */
+        afSTFTinit(&(pW->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1, 1);
+        pW->new_masterOrder = pData->new_masterOrder;
+        memcpy(pW->analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
+        memcpy(pW->nSectorsPerBand, pData->nSectorsPerBand, HYBRID_BANDS*sizeof(int));
+        pW->minFreq = pData->minFreq;
+        pW->maxFreq = pData->maxFreq;
+        pW->avg_ms = pData->avg_ms;
+        pW->maxUpdateRate = 0.0f;
+        pW->multiResFreq = pData->multiResFreq;
+        pW->chOrdering = pData->chOrdering;
+        pW->norm = pData->norm;
+        sldoa_init(job.hWorkers[i], pData->fs);
+        sldoa_initCodec(job.hWorkers[i]);
+    }
+    
+    /* analyse */
+    job.inputs = inputs;
+    job.nInputs = MIN(nInputs, SLDOA_MAX_NUM_INPUT_CHANNELS);
+    job.doa_rad = doa_rad;
+    job.energy = energy;
+    saf_parfor_run(hParFor, &sldoa_offlineRange, (void*)&job, nFrames);
+    
+    for(i=0; i<nThreadsInUse; i++)
+        sldoa_destroy(&(job.hWorkers[i]));
+    free(job.hWorkers);
+    saf_parfor_destroy(&hParFor);
+    return nFrames;
+}
+
 /* SETS */
 
 void sldoa_setMasterOrder(void* const hSld,  int newValue)
@@ -418,6 +660,18 @@ void sldoa_setAvg(void* const hSld, float newAvg)
     pData->avg_ms = newAvg;
 }
 
+void sldoa_setMaxUpdateRate(void* const hSld, float newValue)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    pData->maxUpdateRate = MAX(0.0f, newValue);
+}
+
+void sldoa_setMultiResolutionFreq(void* const hSld, float newFreq)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    pData->multiResFreq = MAX(0.0f, newFreq);
+}
+
 void sldoa_setSourcePreset(void* const hSld, int newPresetID)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
@@ -573,6 +827,18 @@ float sldoa_getAvg(void* const hSld)
     return pData->avg_ms;
 }
 
+float sldoa_getMaxUpdateRate(void* const hSld)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    return pData->maxUpdateRate;
+}
+
+float sldoa_getMultiResolutionFreq(void* const hSld)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    return pData->multiResFreq;
+}
+
 /* Not very elegent, but does the job */
 void sldoa_getDisplayData
 (
@@ -641,6 +907,16 @@ int sldoa_getNumberOfBands(void)
     return HYBRID_BANDS;
 }
 
+int sldoa_getFrameSize(void)
+{
+    return FRAME_SIZE;
+}
+
+int sldoa_getMaxNumSectors(void)
+{
+    return MAX_NUM_SECTORS;
+}
+
 int sldoa_getNSHrequired(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
@@ -659,3 +935,15 @@ int sldoa_getNormType(void* const hSld)
     return (int)pData->norm;
 }
 
+int sldoa_getProcessingDelay(void* const hSld)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    return saf_fifo_getLatency(pData->hFIFO) + 7*HOP_SIZE;
+}
+
+void* sldoa_getTelemetry(void* const hSld)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    return pData->hTelemetry;
+}
+
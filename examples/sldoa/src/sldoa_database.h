@@ -9,7 +9,6 @@
 
 #define NUM_GRID_DIRS ( 2562 )
  
-extern const double __grid_Y[64][2562];
 extern const double __grid_dirs_deg[2562][2];
 
 #endif /* __SLDOA_DATABASE_INCLUDED__ */
@@ -94,11 +94,11 @@ void sldoa_initAna(void* const hSld)
         pData->secCoeffs[i] = malloc1d(4 * (nSH*nSectors) * sizeof(float_complex));
         w_SG = malloc1d(4 * (nSH) * sizeof(float));
         pinv_Y = malloc1d(NUM_GRID_DIRS*nSH*sizeof(float));
+        utility_spinv(NULL, pData->grid_Y, nSH, NUM_GRID_DIRS, pinv_Y); /* (the same for all sectors) */
         for(n=0; n<nSectors; n++){ 
-            utility_svvmul(&(grid_vbap_gtable_T[n*NUM_GRID_DIRS]), pData->grid_Y[0], NUM_GRID_DIRS, secPatterns[0]);
+            utility_svvmul(&(grid_vbap_gtable_T[n*NUM_GRID_DIRS]), pData->grid_Y, NUM_GRID_DIRS, secPatterns[0]);
             for(j=0; j<3; j++)
                 utility_svvmul(&(grid_vbap_gtable_T[n*NUM_GRID_DIRS]), pData->grid_Y_dipoles_norm[j], NUM_GRID_DIRS, secPatterns[j+1]);
-            utility_spinv(&(pData->grid_Y[0][0]), nSH, NUM_GRID_DIRS, pinv_Y);
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4, nSH, NUM_GRID_DIRS, 1.0f,
                         &(secPatterns[0][0]), NUM_GRID_DIRS,
                         pinv_Y, nSH, 0.0f,
@@ -131,7 +131,7 @@ void sldoa_initTFT
     nSH = (pData->masterOrder+1)*(pData->masterOrder+1);
     new_nSH = (pData->new_masterOrder+1)*(pData->new_masterOrder+1);
     if(pData->hSTFT==NULL)
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, new_nSH, 0, 0, 1);
+        afSTFTinit(&(pData->hSTFT), HOP_SIZE, new_nSH, 0, 0, 1, AFSTFT_NUM_THREADS_AUTO);
     else if(nSH!=new_nSH){
         afSTFTchannelChange(pData->hSTFT, new_nSH, 0);
         afSTFTclearBuffers(pData->hSTFT);
@@ -139,22 +139,25 @@ void sldoa_initTFT
 }
 
 
-void sldoa_estimateDoA
+int sldoa_estimateDoA
 (
     float_complex SHframeTF[MAX_NUM_SH_SIGNALS][TIME_SLOTS],
     int anaOrder,
     float_complex* secCoeffs,
+    int slotStep,
     float doa[MAX_NUM_SECTORS][TIME_SLOTS][2],
     float energy[MAX_NUM_SECTORS][TIME_SLOTS]
 )
 {
-    int n, ch, i, j, nSectors, analysisOrder, nSH;
-    float_complex secSig[4][TIME_SLOTS];
-    float_complex* sec_c;
-    float secEnergy[TIME_SLOTS], secIntensity[3][TIME_SLOTS], secAzi[TIME_SLOTS], secElev[TIME_SLOTS];
+    int n, i, j, k, kc, nSectors, analysisOrder, nSH, len, nSlots;
+    float_complex secSig[4*MAX_NUM_SECTORS][TIME_SLOTS]; /* [W; Y; Z; X] signals of all sectors; 4 x nSectors x TIME_SLOTS */
+    float_complex SHslots[MAX_NUM_SH_SIGNALS][TIME_SLOTS];
+    float_complex (*SHin)[TIME_SLOTS];
+    float secEnergy[MAX_NUM_SECTORS*TIME_SLOTS], secIntensity[3][MAX_NUM_SECTORS*TIME_SLOTS];
+    float secAzi[MAX_NUM_SECTORS*TIME_SLOTS], secElev[MAX_NUM_SECTORS*TIME_SLOTS], secXZ[MAX_NUM_SECTORS*TIME_SLOTS];
+    float_complex *W, *Y, *Z, *X;
     const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f);
-    int o[MAX_SH_ORDER+2];
-    for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
+    const float n3d2sn3d = 1.0f/sqrtf(3.0f);
     
     /* prep */
     memset(doa,0,MAX_NUM_SECTORS*TIME_SLOTS*2*sizeof(float));
@@ -162,51 +165,65 @@ void sldoa_estimateDoA
     analysisOrder = MAX(MIN(MAX_SH_ORDER, anaOrder),1);
     nSectors = ORDER2NUMSECTORS(analysisOrder);
     nSH = (analysisOrder+1)*(analysisOrder+1);
-    sec_c = malloc1d(4*nSH*sizeof(float_complex));
+    slotStep = MAX(MIN(slotStep, TIME_SLOTS), 1);
+    nSlots = (TIME_SLOTS + slotStep - 1)/slotStep;
+    len = nSectors*nSlots;
     
-    /* calculate energy and DoA for each sector */
-    for( n=0; n<nSectors; n++){
-        if(anaOrder==1 || secCoeffs == NULL) /* standard first order active-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                memcpy(secSig[i], SHframeTF[i], TIME_SLOTS * sizeof(float_complex));
-        else{ /* spatially localised active-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                for (j=0; j<nSH; j++)
-                    sec_c[i*nSH+j] = secCoeffs[i*(nSectors*nSH)+n*nSH+j];
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4, TIME_SLOTS, nSH, &calpha,
-                        sec_c, nSH,
-                        SHframeTF, TIME_SLOTS, &cbeta,
-                        secSig, TIME_SLOTS);
-        }
-        
-        /* convert N3D to SN3D */
-        for (ch = 1; ch<4; ch++)
-            for(i = 0; i<TIME_SLOTS; i++)
-                secSig[ch][i] = crmulf(secSig[ch][i], 1.0f/sqrtf(3.0f));
-        
-        /* calculate sector energy and intensity vector */
-        memset(secEnergy, 0, TIME_SLOTS*sizeof(float));
+    /* time slots to analyse (packed at the start of each row) */
+    SHin = SHframeTF;
+    if(nSlots<TIME_SLOTS){
+        for (i=0; i<nSH; i++)
+            for (j=0; j<nSlots; j++)
+                SHslots[i][j] = SHframeTF[i][j*slotStep];
+        SHin = SHslots;
+    }
+    
+    /* pressure and velocity signals of all sectors */
+    if(anaOrder==1 || secCoeffs == NULL) /* standard first order active-intensity based DoA estimation */
         for (i=0; i<4; i++)
-            for (j=0; j<TIME_SLOTS; j++)
-                secEnergy[j] += 0.5f*powf(cabsf(secSig[i][j]), 2.0f);
-        for (i=0; i<3; i++)
-            for (j=0; j<TIME_SLOTS; j++)
-                secIntensity[i][j] = crealf(ccmulf(conjf(secSig[0][j]), secSig[1+i][j]));
-        
-        /* extract DoA */
-        for (j=0; j<TIME_SLOTS; j++){
-            secAzi[j]  = atan2f( secIntensity[0][j], secIntensity[2][j] );
-            secElev[j] = atan2f( secIntensity[1][j], sqrtf( powf(secIntensity[2][j], 2.0f) + powf(secIntensity[0][j], 2.0f)) );
-        }
-        
-        /* store energy and DoA estimate */
-        for (j=0; j<TIME_SLOTS; j++){
-            doa[n][j][0] = secAzi[j];
-            doa[n][j][1] = secElev[j];
-            energy[n][j] = secEnergy[j]*1e6f;
+            for (n=0; n<nSectors; n++)
+                memcpy(secSig[i*nSectors+n], SHin[i], nSlots * sizeof(float_complex));
+    else{ /* spatially localised active-intensity based DoA estimation; the
+           * sector coefficients are already stacked as (4 x nSectors) x nSH, so
+           * all of the sector signals are obtained with a single product */
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4*nSectors, nSlots, nSH, &calpha,
+                    secCoeffs, nSH,
+                    SHin, TIME_SLOTS, &cbeta,
+                    secSig, TIME_SLOTS);
+    }
+    W = secSig[0];
+    Y = secSig[nSectors];
+    Z = secSig[2*nSectors];
+    X = secSig[3*nSectors];
+    
+    /* calculate sector energy and intensity vectors (converting N3D to SN3D) */
+    for (n=0; n<nSectors; n++){
+        for (j=0; j<nSlots; j++){
+            k = n*TIME_SLOTS+j;
+            kc = n*nSlots+j;
+            secEnergy[kc] = 0.5f*(crealf(W[k])*crealf(W[k]) + cimagf(W[k])*cimagf(W[k]) +
+                                  (crealf(Y[k])*crealf(Y[k]) + cimagf(Y[k])*cimagf(Y[k]) +
+                                   crealf(Z[k])*crealf(Z[k]) + cimagf(Z[k])*cimagf(Z[k]) +
+                                   crealf(X[k])*crealf(X[k]) + cimagf(X[k])*cimagf(X[k])) * (n3d2sn3d*n3d2sn3d));
+            secIntensity[0][kc] = (crealf(W[k])*crealf(Y[k]) + cimagf(W[k])*cimagf(Y[k])) * n3d2sn3d;
+            secIntensity[1][kc] = (crealf(W[k])*crealf(Z[k]) + cimagf(W[k])*cimagf(Z[k])) * n3d2sn3d;
+            secIntensity[2][kc] = (crealf(W[k])*crealf(X[k]) + cimagf(W[k])*cimagf(X[k])) * n3d2sn3d;
+            secXZ[kc] = sqrtf(secIntensity[2][kc]*secIntensity[2][kc] + secIntensity[0][kc]*secIntensity[0][kc]);
         }
     }
     
-    free(sec_c);
+    /* extract DoA */
+    utility_svatan2(secIntensity[0], secIntensity[2], len, secAzi);
+    utility_svatan2(secIntensity[1], secXZ, len, secElev);
+    
+    /* store energy and DoA estimate */
+    for( n=0; n<nSectors; n++){
+        for (j=0; j<nSlots; j++){
+            doa[n][j][0] = secAzi[n*nSlots+j];
+            doa[n][j][1] = secElev[n*nSlots+j];
+            energy[n][j] = secEnergy[n*nSlots+j]*1e6f;
+        }
+    }
+    return nSlots;
 }
 
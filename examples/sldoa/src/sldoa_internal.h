@@ -87,6 +87,7 @@ typedef enum _SLDOA_PROC_STATUS{
 #define HYBRID_BANDS ( HOP_SIZE + 5 )                       /* hybrid mode incurs an additional 5 bands  */
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* Processing relies on fdHop = 16 */
 #define MAX_NUM_SECTORS ( ORDER2NUMSECTORS(MAX_SH_ORDER) )      /* maximum number of sectors */
+#define SLDOA_MAX_SLOT_STEP ( 4 )                           /* maximum step between analysed time slots (multi-resolution) */
 #define NUM_DISP_SLOTS ( 2 )                                /* needs to be at least 2. On slower systems that skip frames, consider more slots.  */
 #ifndef M_PI
 # define M_PI ( 3.14159265359f )
@@ -103,10 +104,11 @@ typedef enum _SLDOA_PROC_STATUS{
 typedef struct _sldoa
 {
     /* TFT */
+    void* hFIFO;  /**< FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry; /**< health metrics (see saf_telemetry.h) */
     float SHframeTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
     void* hSTFT;
-    complexVector* STFTInputFrameTF;
     float** tempHopFrameTD;
     float freqVector[HYBRID_BANDS];
     float fs;
@@ -118,7 +120,7 @@ typedef struct _sldoa
     char* progressBarText;
     
     /* internal */
-    float grid_Y[64][NUM_GRID_DIRS];
+    float* grid_Y;                     /**< shared (see steeringMtxCache_acquire()); FLAT: 64 x NUM_GRID_DIRS */
     float grid_Y_dipoles_norm[3][NUM_GRID_DIRS];
     float grid_dirs_deg[NUM_GRID_DIRS][2];
     float_complex* secCoeffs[MAX_SH_ORDER-1];
@@ -133,6 +135,9 @@ typedef struct _sldoa
     float* colourScale[NUM_DISP_SLOTS];
     float* alphaScale[NUM_DISP_SLOTS]; 
     int current_disp_idx;
+    double frameTime_s;        /**< time of the current frame, in seconds */
+    double lastUpdateTime_s;   /**< time of the last analysed frame, in seconds */
+    int nFramesSinceUpdate;    /**< number of frames since the last analysed frame (including the current one) */
     
     /* User parameters */
     int masterOrder;
@@ -140,10 +145,26 @@ typedef struct _sldoa
     float maxFreq;
     float minFreq;
     float avg_ms;
+    float maxUpdateRate;       /**< maximum number of analysis updates per second (0: every frame) */
+    float multiResFreq;        /**< crossover frequency of the multi-resolution analysis, in Hz (0: disabled) */
     SLDOA_CH_ORDER chOrdering;
     SLDOA_NORM_TYPES norm;
 
 } sldoa_data;
+
+/**
+ * Offline analysis job, shared by the threads (see sldoa_analyseOffline())
+ */
+typedef struct _sldoa_offlineJob
+{
+    void** hWorkers;             /**< one sldoa instance per thread */
+    const float* const* inputs;  /**< input signals; nInputs x (nFrames*FRAME_SIZE) */
+    int nInputs;                 /**< number of input signals */
+    int nPreRollFrames;          /**< frames analysed before each share, for the averaging to settle */
+    float* doa_rad;              /**< output DoAs; FLAT: nFrames x HYBRID_BANDS x MAX_NUM_SECTORS x 2 */
+    float* energy;               /**< output energies; FLAT: nFrames x HYBRID_BANDS x MAX_NUM_SECTORS */
+    
+} sldoa_offlineJob;
      
 
 /* ========================================================================== */
@@ -193,8 +214,11 @@ void sldoa_initTFT(void* const hSld);
  * @param[in]  SHframeTF Input SH frame
  * @param[in]  anaOrder  Analysis order (1:AI, 2+: SLAI)
  * @param[in]  secCoeffs Sector coefficients for this order
+ * @param[in]  slotStep  Only every slotStep'th time slot is analysed (1: all)
  * @param[out] doa       Resulting DoA estimates per timeslot and sector
  * @param[out] energy    Resulting sector energies per time slot
+ * @returns    Number of analysed time slots, the estimates of which are
+ *             returned in the first entries of 'doa' and 'energy'
  *
  * @see [1] McCormack, L., Delikaris-Manias, S., Farina, A., Pinardi, D., and
  *          Pulkki, V., “Real-time conversion of sensor array signals into
@@ -207,9 +231,10 @@ void sldoa_initTFT(void* const hSld);
  *          Visualization. Journal of the Audio Engineering Society, 67(11),
  *          pp.840-854.
  */
-void sldoa_estimateDoA(float_complex SHframeTF[MAX_NUM_SH_SIGNALS][TIME_SLOTS],
+int sldoa_estimateDoA(float_complex SHframeTF[MAX_NUM_SH_SIGNALS][TIME_SLOTS],
                        int anaOrder,
                        float_complex* secCoeffs,
+                       int slotStep,
                        float doa[MAX_NUM_SECTORS][TIME_SLOTS][2],
                        float energy[MAX_NUM_SECTORS][TIME_SLOTS]);
     
@@ -12,18 +12,18 @@
  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
  OR PERFORMANCE OF THIS SOFTWARE.
 */
-/*
- * Filename:
- *     upmix.h (include header)
- * Description:
- *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
- *     5.x is supported, utilising a modified version of the direct-ambient decomposition
- *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
- *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
- * Dependencies:
- *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
- * Author, date created:
- *     Leo McCormack, 04.04.2018
+/*
+ * Filename:
+ *     upmix.h (include header)
+ * Description:
+ *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
+ *     5.x is supported, utilising a modified version of the direct-ambient decomposition
+ *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
+ *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
+ * Author, date created:
+ *     Leo McCormack, 04.04.2018
  */
 
 #ifndef __UPMIX_H_INCLUDED__
@@ -33,6 +33,21 @@
 extern "C" {
 #endif
 
+/***********/
+/* Presets */
+/***********/
+
+/* available band groupings, for the parameter estimation */
+typedef enum _UPMIX_BAND_GROUPINGS{
+    UPMIX_BAND_GROUPING_ERB = 1,                       /* equivalent rectangular bandwidths (default) */
+    UPMIX_BAND_GROUPING_BARK,                          /* Bark scale */
+    UPMIX_BAND_GROUPING_OCTAVE                         /* octave bands; the fewest parameter estimates per frame */
+    
+}UPMIX_BAND_GROUPINGS;
+
+#define UPMIX_NUM_BAND_GROUPINGS ( 3 )
+
+    
 /******************/
 /* Main Functions */
 /******************/
@@ -47,7 +62,8 @@ void upmix_destroy(void** const phUpmx);               /* address of upmix handl
 void upmix_init(void* const hUpmx,                     /* upmix handle */
                 int samplerate);                       /* host sample rate */
     
-/* Apply upmixing */
+/* Apply upmixing (any block size may be used, since the signals are buffered
+ * internally into frames of FRAME_SIZE samples; see upmix_getProcessingDelay) */
 void upmix_process(void* const hUpmx,                  /* upmix handle */
                    float** const inputs,               /* input channels; nInputs x nSamples */
                    float** const outputs,              /* output channels; nOutputs x nSamples */
@@ -55,32 +71,125 @@ void upmix_process(void* const hUpmx,                  /* upmix handle */
                    int nOutputs,                       /* number of channels in 'outputs' matrix */
                    int nSamples,                       /* number of samples in 'inputs' and 'outputs' matrices */
                    int isPlaying);                     /* flag; set to 1 if there really is audio */
+
+/* Same as upmix_process, but for interleaved input/output buffers */
+void upmix_processInterleaved(void* const hUpmx,       /* upmix handle */
+                              const float* inputs,     /* interleaved input channels; FLAT: nSamples x nInputs */
+                              float* outputs,          /* interleaved output channels; FLAT: nSamples x nOutputs */
+                              int nInputs,             /* number of channels in 'inputs' */
+                              int nOutputs,            /* number of channels in 'outputs' */
+                              int nSamples,            /* number of samples per channel */
+                              int isPlaying);          /* flag; set to 1 if there really is audio */
     
     
 /*****************/
 /* Set Functions */
 /*****************/
-    
-void upmix_setPValueCoeff(void* const hUpmx, float newValue);
-    
-void upmix_setParamAvgCoeff(void* const hUpmx, float newValue);
-
-void upmix_setScaleDoAwidth(void* const hUpmx, float newValue);
-
-void upmix_setCovAvg(void* const hUpmx, float newValue);
+    
+void upmix_setPValueCoeff(void* const hUpmx, float newValue);
+    
+void upmix_setParamAvgCoeff(void* const hUpmx, float newValue);
+
+void upmix_setScaleDoAwidth(void* const hUpmx, float newValue);
+
+void upmix_setCovAvg(void* const hUpmx, float newValue);
+
+/* sets the band grouping used for the parameter estimation (see 'UPMIX_BAND_GROUPINGS' enum). The source direction
+ * and mixing weights are estimated once per group, and interpolated back to full frequency resolution */
+void upmix_setBandGrouping(void* const hUpmx, int newType);
 
     
 /*****************/
 /* Get Functions */
 /*****************/
     
-float upmix_getPValueCoeff(void* const hUpmx);
-
-float upmix_getParamAvgCoeff(void* const hUpmx);
-
-float upmix_getScaleDoAwidth(void* const hUpmx);
-
+float upmix_getPValueCoeff(void* const hUpmx);
+
+float upmix_getParamAvgCoeff(void* const hUpmx);
+
+float upmix_getScaleDoAwidth(void* const hUpmx);
+
 float upmix_getCovAvg(void* const hUpmx);
+
+int upmix_getBandGrouping(void* const hUpmx);
+
+/* returns the number of groups for which the parameters are estimated, with the current band grouping */
+int upmix_getNumBandGroups(void* const hUpmx);
+
+/* returns the processing delay in samples (including the latency of the FIFO, if the host block size is not a multiple
+ * of FRAME_SIZE) */
+int upmix_getProcessingDelay(void* const hUpmx);
+
+/* returns the handle of the telemetry, i.e. the health metrics of this instance (frames processed/dropped, time taken
+ * per frame, and time spent re-initialising the codec); see saf_telemetry_getSnapshot() */
+void* upmix_getTelemetry(void* const hUpmx);
+    
+
+/********************************/
+/* General (N to M) upmix engine */
+/********************************/
+
+/* The engine upmixes any input loudspeaker layout (e.g. stereo, 5.x) to any output loudspeaker layout (e.g. 7.1.4), or
+ * to spherical harmonic (ACN/SN3D) signals. For each ERB band group, the principal direction and the direct/diffuse
+ * energies are estimated from the input covariance matrix; and the target covariance (direct part panned to the
+ * estimated direction, plus a diffuse part) is then attained with the optimal mixing solution of 'saf_cdf4sap', using
+ * the input channels panned to the output format as the prototype. The layouts are fixed when the engine is created
+ * (create one engine per format pair), and the LFE channels should be routed around the engine by the host. */
+
+#define UPMIX_ENGINE_MAX_NUM_INPUTS ( 16 )             /* maximum number of input channels */
+#define UPMIX_ENGINE_MAX_NUM_OUTPUTS ( 64 )            /* maximum number of output channels (i.e. up to 7th order) */
+
+/* creates an instance of the upmix engine */
+void upmix_engine_create(void** const phEng,           /* address of upmix engine handle */
+                         const float* in_dirs_deg,     /* input loudspeaker directions in degrees; FLAT: nInputs x 2 */
+                         int nInputs,                  /* number of input channels; 2..UPMIX_ENGINE_MAX_NUM_INPUTS */
+                         const float* out_dirs_deg,    /* output loudspeaker directions in degrees; FLAT: nOutputs x 2,
+                                                        * or NULL, for spherical harmonic output of order 'outOrder' */
+                         int nOutputs,                 /* number of output loudspeakers (ignored for SH output) */
+                         int outOrder,                 /* SH output order (ignored for loudspeaker output) */
+                         int samplerate,               /* host sample rate */
+                         int nThreads);                /* number of threads for the parameter estimation (1: single-
+                                                        * threaded, or SAF_PARFOR_NUM_THREADS_AUTO) */
+
+/* destroys an instance of the upmix engine */
+void upmix_engine_destroy(void** const phEng);         /* address of upmix engine handle */
+
+/* Apply upmixing (any block size may be used; see upmix_engine_getProcessingDelay). Any missing input channels are
+ * treated as silent, and any surplus output channels are zeroed */
+void upmix_engine_process(void* const hEng,            /* upmix engine handle */
+                          float** const inputs,        /* input channels; nInputs x nSamples */
+                          float** const outputs,       /* output channels; nOutputs x nSamples */
+                          int nInputs,                 /* number of channels in 'inputs' matrix */
+                          int nOutputs,                /* number of channels in 'outputs' matrix */
+                          int nSamples);               /* number of samples in 'inputs' and 'outputs' matrices */
+
+void upmix_engine_setCovAvg(void* const hEng, float newValue);
+
+float upmix_engine_getCovAvg(void* const hEng);
+
+/* Sets the crossover frequency of the multi-resolution parameter estimation, in Hz ('0': disabled, the default). The
+ * band groups below the crossover are updated every frame, whereas those above it are updated every 2nd frame in the
+ * first octave, every 3rd in the second, and every 4th beyond that (with the updates of neighbouring groups staggered
+ * over the frames); and their mixing matrices are interpolated towards each new solution over the frames in between.
+ * Since most of the groups lie at high frequencies, this saves much of the cost of solving for the mixing matrices;
+ * e.g. 3e3f, past which the temporal resolution of spatial hearing is coarser */
+void upmix_engine_setMultiResolutionFreq(void* const hEng, float newFreq);
+
+float upmix_engine_getMultiResolutionFreq(void* const hEng);
+
+/* returns the number of input channels expected by the engine */
+int upmix_engine_getNumInputs(void* const hEng);
+
+/* returns the number of output channels produced by the engine */
+int upmix_engine_getNumOutputs(void* const hEng);
+
+/* returns the processing delay in samples (including the latency of the FIFO, if the host block size is not a multiple
+ * of FRAME_SIZE) */
+int upmix_engine_getProcessingDelay(void* const hEng);
+
+/* returns the handle of the telemetry, i.e. the health metrics of this engine (frames processed, and time taken per
+ * frame); see saf_telemetry_getSnapshot() */
+void* upmix_engine_getTelemetry(void* const hEng);
     
 
 #ifdef __cplusplus
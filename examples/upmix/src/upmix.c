@@ -12,26 +12,21 @@
  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
  OR PERFORMANCE OF THIS SOFTWARE.
 */
-/*
- * Filename:
- *     upmix.c
- * Description:
- *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
- *     5.x is supported, utilising a modified version of the direct-ambient decomposition
- *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
- *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
- * Dependencies:
- *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
- * Author, date created:
- *     Leo McCormack, 04.04.2018
+/*
+ * Filename:
+ *     upmix.c
+ * Description:
+ *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
+ *     5.x is supported, utilising a modified version of the direct-ambient decomposition
+ *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
+ *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
+ * Author, date created:
+ *     Leo McCormack, 04.04.2018
  */
  
-#include "upmix_internal.h"
-
-static inline float matlab_fmodf(float x, float y) {
-    float tmp = fmodf(x, y);
-    return tmp >= 0 ? tmp : tmp + y;
-}
+#include "upmix_internal.h"
 
 void upmix_create
 (
@@ -44,7 +39,7 @@ void upmix_create
     int t, ch;
     
     /* time-frequency transform + buffers */
-    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_INPUT_CHANNELS, MAX_NUM_OUTPUT_CHANNELS, 0, 1);
+    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_INPUT_CHANNELS, MAX_NUM_OUTPUT_CHANNELS, 0, 1, 1);
     pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, sizeof(complexVector));
     pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_OUTPUT_CHANNELS, sizeof(complexVector));
     for(t=0; t<TIME_SLOTS; t++) {
@@ -67,12 +62,21 @@ void upmix_create
     pars->grp_freqs = NULL;
     pars->grp_idx = NULL;
     pars->prev_est_dir = NULL; 
+    pars->grp_dir_xy = NULL;
+    pars->grp_w_src = NULL;
+    pars->grp_w_diff = NULL;
      
     /* user parameters */
     pData->pValueCoeff = 0.5f;
     pData->paramAvgCoeff = 0.0f;
     pData->scaleDoAwidth = 1.0f;
     pData->covAvg = 0.85f;
+    pData->bandGrouping = UPMIX_BAND_GROUPING_ERB;
+    
+    /* FIFO, so that any host block size may be used */
+    saf_fifo_create(&(pData->hFIFO), FRAME_SIZE, MAX_NUM_INPUT_CHANNELS, MAX_NUM_OUTPUT_CHANNELS);
+    saf_telemetry_create(&(pData->hTelemetry));
+    pData->isPlaying = 0;
 }
 
 
@@ -96,9 +100,19 @@ void upmix_destroy
                 free(pData->STFTOutputFrameTF[t][ch].im);
             }
         }
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_INPUT_CHANNELS, MAX_NUM_OUTPUT_CHANNELS));
+        free(pData->STFTInputFrameTF);
+        free(pData->STFTOutputFrameTF);
+        free(pData->tempHopFrameTD);
+        saf_fifo_destroy(&(pData->hFIFO));
+        saf_telemetry_destroy(&(pData->hTelemetry));
+        free(pData->pars->grid_vbap_gtable);
+        free(pData->pars->grp_idx);
+        free(pData->pars->grp_freqs);
+        free(pData->pars->prev_est_dir);
+        free(pData->pars->grp_dir_xy);
+        free(pData->pars->grp_w_src);
+        free(pData->pars->grp_w_diff);
+        free(pData->pars);
  
         free(pData);
         pData = NULL;
@@ -127,43 +141,39 @@ void upmix_init
     getPvalues(pData->pValueCoeff, (float*)pData->freqVector, HYBRID_BANDS, (float*)pData->pValues);
     
     /* default starting values */
-    memset(pData->Cx, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
-    memset(pData->inputframeTF_buffer, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*DIFFUSE_DELAY_TIME_SLOTS*sizeof(float_complex));
-    pData->buffer_rIdx = 1;
+    memset(pData->Cx, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
+    memset(pData->inputframeTF_buffer, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*DIFFUSE_DELAY_TIME_SLOTS*sizeof(float_complex));
+    pData->buffer_rIdx = 1;
     pData->buffer_wIdx = 0;
 }
 
-void upmix_process
+/* processes one frame of FRAME_SIZE samples; called by the FIFO */
+static void upmix_processFrame
 (
     void  *  const hUpmx,
     float ** const inputs,
     float ** const outputs,
     int            nInputs,
-    int            nOutputs,
-    int            nSamples,
-    int            isPlaying
+    int            nOutputs
 )
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
     codecPars* pars = pData->pars;
-    int t, sample, ch, i, j, k, band, grpband, num_grpBands, idx2D, ls;
-    int* grp_bands;
+    int t, sample, ch, i, j, k, band, grp, nGrps, g0, g1, idx2D, ls;
     float est_dir, dummy;
-    double Cx_grp00, Cx_grp11, ICC_01, A1, A2, B, C, src_en, diff_en, src_diff_en, w_denom;
-    double pv_f, gains2D_sum_pvf;
-    float est_dir_xyz[3], prev_est_dir_xyz[3], est_dir_xyz_avg[3];
-    double gains2D[MAX_NUM_OUTPUT_CHANNELS];
-    double w_src[1][2], w_diff[2][2];
-    double Ms_S[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    double Ms_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    double Md_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    double Cx_grp00, Cx_grp11, ICC_01, A1, A2, B, C, src_en, diff_en, src_diff_en, w_denom;
+    double pv_f, gains2D_sum_pvf, w0, w1, Ms_ij, Md_ij;
+    float est_dir_xyz[3], prev_est_dir_xyz[3], est_dir_xyz_avg[3];
+    double gains2D[MAX_NUM_OUTPUT_CHANNELS];
+    double w_src[1][2], w_diff[2][2];
+    float_complex XL, XR;
     float_complex new_Cx[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
     float_complex Cx_grp[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    const double mix_LR[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}, {0.0, 0.0f}, {0.0, 0.0}, {0.0, 0.0}};
-    const double mix_LsRs[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { { 0.0, 0.0}, {0.0,  0.0}, {0.0, 0.0}, {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}};
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    const double mix_LR[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}, {0.0, 0.0f}, {0.0, 0.0}, {0.0, 0.0}};
+    const double mix_LsRs[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { { 0.0, 0.0}, {0.0,  0.0}, {0.0, 0.0}, {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}};
     
-    /* local copies of user parameters */
+    /* local copies of user parameters */
     int nLoudspeakers;
     float paramAvgCoeff, scaleDoAwidth, covAvg;
     
@@ -173,7 +183,8 @@ void upmix_process
         upmix_initCodec(hUpmx);
         pData->reInitCodec = 0;
     }
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->reInitCodec == 0) ) {
+    if ((pData->isPlaying == 1) && (pData->reInitCodec == 0) ) {
+        saf_telemetry_frameBegin(pData->hTelemetry);
         nLoudspeakers = pData->nLoudspeakers;
         paramAvgCoeff = pData->paramAvgCoeff;
         scaleDoAwidth = pData->scaleDoAwidth;
@@ -183,7 +194,7 @@ void upmix_process
         for(i=0; i < MIN(MAX_NUM_INPUT_CHANNELS,nInputs); i++)
             memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
         for(; i<MAX_NUM_INPUT_CHANNELS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
         /* Apply time-frequency transform (TFT) */
         for ( t=0; t< TIME_SLOTS; t++) {
@@ -197,38 +208,32 @@ void upmix_process
                 for ( t=0; t<TIME_SLOTS; t++)
                     pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
    
-        /* update covarience matrix per band */
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, TIME_SLOTS, &calpha,
-                        pData->inputframeTF[band], TIME_SLOTS,
-                        pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-                        new_Cx, MAX_NUM_INPUT_CHANNELS);
-            
-            /* average over time */
-            for(i=0; i<MAX_NUM_INPUT_CHANNELS; i++)
-                for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                    pData->Cx[band][i][j] = new_Cx[i][j]*(1.0f-covAvg) + pData->Cx[band][i][j] * covAvg;
-        }
-        
-        /* Calculate mixing matrices for upmixing */
-        for (grpband = 0; grpband < pars->nGrpBands-1; grpband++) {
-            /* define which bands make up the bark/erb scale grouping */
-            num_grpBands = pars->grp_idx[grpband+1] - pars->grp_idx[grpband];
-            grp_bands = (int*)malloc(num_grpBands*sizeof(int));
-            for(i=pars->grp_idx[grpband], j=0; i<pars->grp_idx[grpband+1]; i++, j++)
-                grp_bands[j] = i-1; /* -1 as the indices start from 1 */
+        /* Estimate the source direction and the mixing weights per grouped band */
+        nGrps = pars->nGrpBands-1;
+        for (grp = 0; grp < nGrps; grp++) {
+            /* update the covarience matrix of this bark/erb/octave group (i.e. summed over its bands), and calculate ICC
+             * between left and right channels */
+            memset(new_Cx, 0, MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
+            for(band=pars->grp_idx[grp]-1; band<pars->grp_idx[grp+1]-1; band++){ /* -1 as the indices start from 1 */
+                for ( t=0; t<TIME_SLOTS; t++){
+                    XL = pData->inputframeTF[band][0][t];
+                    XR = pData->inputframeTF[band][1][t];
+                    new_Cx[0][0] = ccaddf(new_Cx[0][0], cmplxf(crealf(XL)*crealf(XL) + cimagf(XL)*cimagf(XL), 0.0f));
+                    new_Cx[0][1] = ccaddf(new_Cx[0][1], ccmulf(XL, conjf(XR)));
+                    new_Cx[1][1] = ccaddf(new_Cx[1][1], cmplxf(crealf(XR)*crealf(XR) + cimagf(XR)*cimagf(XR), 0.0f));
+                }
+            }
+            new_Cx[1][0] = conjf(new_Cx[0][1]);
             
-            /* sum the covarience matrices for these grouped bands and calculate ICC between left and right channels */
-            memset(Cx_grp, 0, MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
-            for(i=0; i<num_grpBands; i++)
-                for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                    for(k=0; k<MAX_NUM_INPUT_CHANNELS; k++)
-                        Cx_grp[j][k] = ccaddf(Cx_grp[j][k], pData->Cx[grp_bands[i]][j][k]);
+            /* average over time */
+            for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
+                for(k=0; k<MAX_NUM_INPUT_CHANNELS; k++)
+                    Cx_grp[j][k] = pData->Cx[grp][j][k] = new_Cx[j][k]*(1.0f-covAvg) + pData->Cx[grp][j][k] * covAvg;
             Cx_grp00 = creal((double)Cx_grp[0][0]);
             Cx_grp11 = creal((double)Cx_grp[1][1]);
             ICC_01 = creal((double)Cx_grp[0][1])/(sqrt(Cx_grp00*Cx_grp11)+2.23e-9);
             
-            /* estimate the short-time energy of the source and diffuse signals */
+            /* estimate the short-time energy of the source and diffuse signals */
             /* Faller, C. (2006). Multiple-loudspeaker playback of stereo signals. Journal of the Audio Engineering Society, 54(11), 1051-1064. */
             C = crealf(Cx_grp[0][1]);
             B = Cx_grp11 - Cx_grp00 + sqrt( pow(Cx_grp00-Cx_grp11, 2.0) + 4.0 * Cx_grp00*Cx_grp11 * pow(ICC_01, 2.0));
@@ -242,102 +247,110 @@ void upmix_process
             if (A1<=1.0 && A1>=-1.0)
                 est_dir = A1<0.0 ? 150.0*A1 - 30.0f : 30.0*A1 - 30.0;
             else if (A2<=1.0 && A2>=-1.0)
-                est_dir = A2<0.0 ? -(150.0*A2 - 30.0f) : -(30.0*A2 - 30.0);
-            else
+                est_dir = A2<0.0 ? -(150.0*A2 - 30.0f) : -(30.0*A2 - 30.0);
+            else
                 est_dir = 0.0;
             est_dir = est_dir*scaleDoAwidth; /* manipulate the width by scaling this estimate */
             
             /* Average source DoA over time */
             unitSph2Cart(est_dir*M_PI/180.0f, 0.0f, est_dir_xyz);
-            unitSph2Cart(pars->prev_est_dir[grpband]*M_PI/180.0f, 0.0f, prev_est_dir_xyz);
+            unitSph2Cart(pars->prev_est_dir[grp]*M_PI/180.0f, 0.0f, prev_est_dir_xyz);
             for(i=0; i<3; i++)
                 est_dir_xyz_avg[i] = (1.0f-paramAvgCoeff)*est_dir_xyz[i] + paramAvgCoeff*prev_est_dir_xyz[i];
             unitCart2Sph_aziElev( est_dir_xyz_avg, &est_dir, &dummy);
+            pars->grp_dir_xy[grp*2+0] = cosf(est_dir);
+            pars->grp_dir_xy[grp*2+1] = sinf(est_dir);
             est_dir *= 180.0f/M_PI;
-            pars->prev_est_dir[grpband] = est_dir;
+            pars->prev_est_dir[grp] = est_dir;
             
             /* estimate the mixing weights reqiured to obtain source and diffuse components via a least-square approximation */
             w_denom = (A1*A1+1.0)*src_diff_en + diff_en*diff_en + 2.23e-9;
-            w_src[0][0] = (src_diff_en)/w_denom;
-            w_src[0][1] = w_src[0][0]*A1;
-            w_diff[0][0] = ((A1*A1)*src_diff_en + diff_en*diff_en)/w_denom;
-            w_diff[0][1] = (-A1*src_diff_en + diff_en*diff_en)/w_denom;
+            pars->grp_w_src[grp*2+0] = (src_diff_en)/w_denom;
+            pars->grp_w_src[grp*2+1] = pars->grp_w_src[grp*2+0]*A1;
+            pars->grp_w_diff[grp*3+0] = ((A1*A1)*src_diff_en + diff_en*diff_en)/w_denom;
+            pars->grp_w_diff[grp*3+1] = (-A1*src_diff_en + diff_en*diff_en)/w_denom;
+            pars->grp_w_diff[grp*3+2] = (src_diff_en + diff_en*diff_en)/w_denom;
+        }
+        
+        /* Calculate mixing matrices for upmixing, with the parameters interpolated to each band */
+        for(band=0; band<HYBRID_BANDS; band++){
+            g0 = pars->interp_grpIdx[band];
+            g1 = MIN(g0+1, nGrps-1);
+            w1 = (double)pars->interp_w[band];
+            w0 = 1.0 - w1;
+            w_src[0][0] = w0*pars->grp_w_src[g0*2+0] + w1*pars->grp_w_src[g1*2+0];
+            w_src[0][1] = w0*pars->grp_w_src[g0*2+1] + w1*pars->grp_w_src[g1*2+1];
+            w_diff[0][0] = w0*pars->grp_w_diff[g0*3+0] + w1*pars->grp_w_diff[g1*3+0];
+            w_diff[0][1] = w0*pars->grp_w_diff[g0*3+1] + w1*pars->grp_w_diff[g1*3+1];
             w_diff[1][0] = w_diff[0][1];
-            w_diff[1][1] = (src_diff_en + diff_en*diff_en)/w_denom;
+            w_diff[1][1] = w0*pars->grp_w_diff[g0*3+2] + w1*pars->grp_w_diff[g1*3+2];
+            
+            /* (the direction is interpolated via its unit vector, so that it is also continuous across -180/180) */
+            if(w1 > 0.0)
+                est_dir = atan2f((float)w0*pars->grp_dir_xy[g0*2+1] + (float)w1*pars->grp_dir_xy[g1*2+1],
+                                 (float)w0*pars->grp_dir_xy[g0*2+0] + (float)w1*pars->grp_dir_xy[g1*2+0]) * 180.0f/M_PI;
+            else
+                est_dir = pars->prev_est_dir[g0];
             
-            for(band=0; band<num_grpBands; band++){
-                /* Pull loudspeaker gains from vbap table */
-                idx2D = (int)((matlab_fmodf(est_dir+180.0f,360.0f)/pars->vbap_azi_res)+0.5f);
-                for (ls = 0; ls < nLoudspeakers; ls++)
-                    gains2D[ls] = (double)pars->grid_vbap_gtable[idx2D*nLoudspeakers+ls];
-                 
-                /* apply pValue normalisation (i.e. amplitude normalises the VBAP gains for low frequencies depending on room) */
-                pv_f = pData->pValues[grp_bands[band]];
-                if(pv_f != 2.0f){
-                    gains2D_sum_pvf = 0.0f;
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D_sum_pvf += pow(MAX(gains2D[ls], 0.0), pv_f);
-                    gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9));
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-9);
-                }
-
-                /* formulate direct mixing matrix */
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1, 1.0,
-                            (const double*)gains2D, 1,
-                            (const double*)w_src, MAX_NUM_INPUT_CHANNELS, 0.0,
-                            (double*)Ms_S, MAX_NUM_INPUT_CHANNELS);
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
-                            (const double*)mix_LR, MAX_NUM_INPUT_CHANNELS,
-                            (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0,
-                            (double*)Ms_N, MAX_NUM_INPUT_CHANNELS);
-                for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
-                    for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                        pData->new_Ms[grp_bands[band]][i][j] = cmplxf((float)Ms_S[i][j] + (float)Ms_N[i][j], 0.0f);
-                
-                /* formulate diffuse mixing matrix */
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
-                            (const double*)mix_LsRs, MAX_NUM_INPUT_CHANNELS,
-                            (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0f,
-                            (double*)Md_N, MAX_NUM_INPUT_CHANNELS);
-                for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
-                    for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                        pData->new_Md[grp_bands[band]][i][j] = cmplxf(pars->diff_lpf[grp_bands[band]] * (float)Md_N[i][j], 0.0f);
-            }
-            free(grp_bands);
-        }
-        
-        /* obtain delayed inputframe */
-        for(t=0; t<TIME_SLOTS; t++){
-            for(band=0; band<HYBRID_BANDS; band++){
-                for(ch=0; ch<MAX_NUM_INPUT_CHANNELS; ch++){
-                    pData->inputframeTF_buffer[band][ch][pData->buffer_wIdx] = pData->inputframeTF[band][ch][t];
-                    pData->inputframeTF_del[band][ch][t] = pData->inputframeTF_buffer[band][ch][pData->buffer_rIdx];
-                }
-            }
-            /* increment circular buffer indices */
-            pData->buffer_wIdx++;
-            pData->buffer_rIdx++;
-            if(pData->buffer_wIdx==DIFFUSE_DELAY_TIME_SLOTS)
-                pData->buffer_wIdx = 0;
-            if(pData->buffer_rIdx==DIFFUSE_DELAY_TIME_SLOTS)
-                pData->buffer_rIdx = 0;
-        }
-        
-        /* Apply mixing matrices to current and delayed intputframe */
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
-                        (const float*)pData->new_Ms[band], MAX_NUM_INPUT_CHANNELS,
-                        (const float*)pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-                        (float*)pData->directframeTF[band], TIME_SLOTS);
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
-                        (const float*)pData->new_Md[band], MAX_NUM_INPUT_CHANNELS,
-                        (const float*)pData->inputframeTF_del[band], TIME_SLOTS, &cbeta,
-                        (float*)pData->diffuseframeTF[band], TIME_SLOTS);
-            /* combine */
-            for(ch=0; ch<MAX_NUM_OUTPUT_CHANNELS; ch++)
-                for(t=0; t<TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ch][t] = ccaddf(pData->directframeTF[band][ch][t], pData->diffuseframeTF[band][ch][t]);
+            /* Pull loudspeaker gains from vbap table */
+            idx2D = (int)((matlab_fmodf(est_dir+180.0f,360.0f)/pars->vbap_azi_res)+0.5f);
+            for (ls = 0; ls < nLoudspeakers; ls++)
+                gains2D[ls] = (double)pars->grid_vbap_gtable[idx2D*nLoudspeakers+ls];
+             
+            /* apply pValue normalisation (i.e. amplitude normalises the VBAP gains for low frequencies depending on room) */
+            pv_f = pData->pValues[band];
+            if(pv_f != 2.0f){
+                gains2D_sum_pvf = 0.0f;
+                for (ls = 0; ls < nLoudspeakers; ls++)
+                    gains2D_sum_pvf += pow(MAX(gains2D[ls], 0.0), pv_f);
+                gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9));
+                for (ls = 0; ls < nLoudspeakers; ls++)
+                    gains2D[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-9);
+            }
+
+            /* formulate the direct (gains2D*w_src + mix_LR*w_diff) and diffuse (mix_LsRs*w_diff) mixing matrices; these
+             * are too small to be worth passing to BLAS */
+            for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++){
+                for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++){
+                    Ms_ij = gains2D[i]*w_src[0][j] + mix_LR[i][0]*w_diff[0][j] + mix_LR[i][1]*w_diff[1][j];
+                    Md_ij = mix_LsRs[i][0]*w_diff[0][j] + mix_LsRs[i][1]*w_diff[1][j];
+                    pData->new_Ms[band][i][j] = cmplxf((float)Ms_ij, 0.0f);
+                    pData->new_Md[band][i][j] = cmplxf(pars->diff_lpf[band] * (float)Md_ij, 0.0f);
+                }
+            }
+        }
+        
+        /* obtain delayed inputframe */
+        for(t=0; t<TIME_SLOTS; t++){
+            for(band=0; band<HYBRID_BANDS; band++){
+                for(ch=0; ch<MAX_NUM_INPUT_CHANNELS; ch++){
+                    pData->inputframeTF_buffer[band][ch][pData->buffer_wIdx] = pData->inputframeTF[band][ch][t];
+                    pData->inputframeTF_del[band][ch][t] = pData->inputframeTF_buffer[band][ch][pData->buffer_rIdx];
+                }
+            }
+            /* increment circular buffer indices */
+            pData->buffer_wIdx++;
+            pData->buffer_rIdx++;
+            if(pData->buffer_wIdx==DIFFUSE_DELAY_TIME_SLOTS)
+                pData->buffer_wIdx = 0;
+            if(pData->buffer_rIdx==DIFFUSE_DELAY_TIME_SLOTS)
+                pData->buffer_rIdx = 0;
+        }
+        
+        /* Apply mixing matrices to current and delayed intputframe */
+        for(band=0; band<HYBRID_BANDS; band++){
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
+                        (const float*)pData->new_Ms[band], MAX_NUM_INPUT_CHANNELS,
+                        (const float*)pData->inputframeTF[band], TIME_SLOTS, &cbeta,
+                        (float*)pData->directframeTF[band], TIME_SLOTS);
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
+                        (const float*)pData->new_Md[band], MAX_NUM_INPUT_CHANNELS,
+                        (const float*)pData->inputframeTF_del[band], TIME_SLOTS, &cbeta,
+                        (float*)pData->diffuseframeTF[band], TIME_SLOTS);
+            /* combine */
+            for(ch=0; ch<MAX_NUM_OUTPUT_CHANNELS; ch++)
+                for(t=0; t<TIME_SLOTS; t++)
+                    pData->outputframeTF[band][ch][t] = ccaddf(pData->directframeTF[band][ch][t], pData->diffuseframeTF[band][ch][t]);
         }
         
         /* inverse-TFT */
@@ -358,13 +371,66 @@ void upmix_process
                 for (sample = 0; sample < HOP_SIZE; sample++)
                     outputs[ch][sample + t* HOP_SIZE] = 0.0f;
         }
+        saf_telemetry_frameEnd(pData->hTelemetry);
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        if(pData->reInitCodec != 0)
+            saf_telemetry_frameDropped(pData->hTelemetry, SAF_TELEMETRY_DROP_NOT_INITIALISED);
     } 
 }
 
+void upmix_process
+(
+    void  *  const hUpmx,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    pData->isPlaying = isPlaying;
+    saf_fifo_process(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &upmix_processFrame, hUpmx);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+void upmix_processInterleaved
+(
+    void  *  const hUpmx,
+    const float *  inputs,
+    float *        outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    unsigned int fpState;
+    int blasState;
+    
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+    
+    pData->isPlaying = isPlaying;
+    saf_fifo_processInterleaved(pData->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &upmix_processFrame, hUpmx);
+    
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
 
 /* Set Functions */
 
@@ -394,6 +460,16 @@ void upmix_setCovAvg(void* const hUpmx, float newValue)
 }
 
 
+void upmix_setBandGrouping(void* const hUpmx, int newType)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    if(newType>=UPMIX_BAND_GROUPING_ERB && newType<=UPMIX_NUM_BAND_GROUPINGS && (UPMIX_BAND_GROUPINGS)newType!=pData->bandGrouping){
+        pData->bandGrouping = (UPMIX_BAND_GROUPINGS)newType;
+        pData->reInitCodec = 1;
+    }
+}
+
+
 /* Get Functions */
 
 float upmix_getPValueCoeff(void* const hUpmx)
@@ -420,6 +496,32 @@ float upmix_getCovAvg(void* const hUpmx)
     return pData->covAvg;
 }
 
+int upmix_getBandGrouping(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    return (int)pData->bandGrouping;
+}
+
+int upmix_getNumBandGroups(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    if(pData->reInitCodec!=0 || pData->pars->grp_idx==NULL)
+        return 0;
+    return pData->pars->nGrpBands-1;
+}
+
+int upmix_getProcessingDelay(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    return saf_fifo_getLatency(pData->hFIFO) + 12*HOP_SIZE;
+}
+
+void* upmix_getTelemetry(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    return pData->hTelemetry;
+}
+
 
 
 
@@ -1,13 +0,0 @@
-/*
-    Leo McCormack 
-    ../database/upmix_database/upmix_database.h
-    Generated using MatLab on: 05-Apr-2018
-*/
-
-#ifndef __UPMIX_DATABASE_INCLUDED__
-#define __UPMIX_DATABASE_INCLUDED__
-
-extern const double __afCenterFreq48e3[133];
-extern const double __afCenterFreq44100[133];
-
-#endif /* __UPMIX_DATABASE_INCLUDED__ */
@@ -0,0 +1,579 @@
+/*
+ Copyright 2026 agent
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     upmix_engine.c
+ * Description:
+ *     A general (N to M) upmixing engine, for arbitrary input loudspeaker layouts and
+ *     arbitrary output loudspeaker layouts or spherical harmonic signals. For each band
+ *     group, the principal direction and the direct/diffuse energies are estimated from
+ *     the input covariance matrix, and the resulting target covariance matrix is attained
+ *     using the optimal mixing solution described in: Vilkamo, J., Ba"ckstro"m, T., &
+ *     Kuntz, A. (2013). Optimized covariance domain framework for time-frequency processing
+ *     of spatial audio. Journal of the Audio Engineering Society, 61(6), 403-411.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, saf_vbap, saf_sh, saf_cdf4sap
+ * Author, date created:
+ *     agent, 14.10.2026
+ */
+
+#include "upmix_internal.h"
+
+#define ENGINE_NUM_POWER_ITERATIONS ( 8 )     /* iterations used to find the principal eigenvector of each group */
+#define ENGINE_GRID_GEOSPHERE_DEGREE ( 9 )    /* geosphere grid used for non-planar input layouts (812 points) */
+#define ENGINE_CDF4SAP_REG ( 0.2f )           /* regularisation of the optimal mixing solution */
+#define ENGINE_CDF4SAP_MAX_CHANGE ( 0.1f )    /* change in the covariances, beyond which the mixing is solved from scratch */
+#define ENGINE_MAX_UPDATE_INTERVAL ( 4 )      /* maximum number of frames between parameter updates (multi-resolution) */
+
+/* returns the number of frames between the parameter updates of a band group centred at 'freq'; every frame below the
+ * crossover frequency, and then one more frame per octave above it (see upmix_engine_setMultiResolutionFreq) */
+static int upmix_engine_updateInterval
+(
+    float freq,                        /* centre frequency of the group, in Hz */
+    float crossoverFreq                /* crossover frequency, in Hz (0: disabled) */
+)
+{
+    if(crossoverFreq<=0.0f || freq<crossoverFreq)
+        return 1;
+    return MIN(2 + (int)log2f(freq/crossoverFreq), ENGINE_MAX_UPDATE_INTERVAL);
+}
+
+/* returns 1 if all of the directions lie on the horizontal plane */
+static int upmix_engine_isPlanar
+(
+    const float* dirs_deg,             /* directions in degrees; FLAT: nDirs x 2 */
+    int nDirs                          /* number of directions */
+)
+{
+    int i;
+
+    for(i=0; i<nDirs; i++)
+        if(fabsf(dirs_deg[i*2+1]) > 0.1f)
+            return 0;
+    return 1;
+}
+
+/* computes the ENERGY normalised VBAP gains for each source direction, falling back to the nearest loudspeaker for any
+ * directions that cannot be panned (e.g. those behind a stereo pair), or if the layout cannot be triangulated */
+static void upmix_engine_vbapGains
+(
+    const float* src_dirs_deg,         /* source directions in degrees; FLAT: S x 2 */
+    int S,                             /* number of sources */
+    const float* ls_dirs_deg,          /* loudspeaker directions in degrees; FLAT: L x 2 */
+    int L,                             /* number of loudspeakers */
+    float* gains                       /* VBAP gains; FLAT: S x L */
+)
+{
+    int i, j, N_gtable, nGroups, nearest;
+    float dot, maxDot, en;
+    float* gtable;
+    float src_xyz[3], ls_xyz[3];
+
+    gtable = NULL;
+    if(upmix_engine_isPlanar(ls_dirs_deg, L))
+        generateVBAPgainTable2D_srcs((float*)src_dirs_deg, S, (float*)ls_dirs_deg, L, &gtable, &N_gtable, &nGroups);
+    else
+        generateVBAPgainTable3D_srcs((float*)src_dirs_deg, S, (float*)ls_dirs_deg, L, 0, 1, 0.0f, &gtable, &N_gtable, &nGroups);
+    if(gtable!=NULL){
+        memcpy(gains, gtable, S*L*sizeof(float));
+        free(gtable);
+    }
+    else
+        memset(gains, 0, S*L*sizeof(float));
+
+    for(i=0; i<S; i++){
+        for(j=0, en=0.0f; j<L; j++)
+            en += gains[i*L+j]*gains[i*L+j];
+        if(en > 0.5f)
+            continue;
+        memset(&(gains[i*L]), 0, L*sizeof(float));
+        unitSph2Cart(src_dirs_deg[i*2]*M_PI/180.0f, src_dirs_deg[i*2+1]*M_PI/180.0f, src_xyz);
+        nearest = 0;
+        maxDot = -FLT_MAX;
+        for(j=0; j<L; j++){
+            unitSph2Cart(ls_dirs_deg[j*2]*M_PI/180.0f, ls_dirs_deg[j*2+1]*M_PI/180.0f, ls_xyz);
+            dot = src_xyz[0]*ls_xyz[0] + src_xyz[1]*ls_xyz[1] + src_xyz[2]*ls_xyz[2];
+            if(dot > maxDot){
+                maxDot = dot;
+                nearest = j;
+            }
+        }
+        gains[i*L+nearest] = 1.0f;
+    }
+}
+
+/* computes the gains required to pan each source direction to the output format of the engine */
+static void upmix_engine_outputGains
+(
+    upmix_engine_data* pEng,           /* upmix engine handle */
+    const float* out_dirs_deg,         /* output loudspeaker directions (NULL for SH output); FLAT: nOutputs x 2 */
+    const float* src_dirs_deg,         /* source directions in degrees; FLAT: S x 2 */
+    int S,                             /* number of sources */
+    float* gains                       /* output gains; FLAT: S x nOutputs */
+)
+{
+    int i, n, m, order;
+    float scale;
+    float* src_dirs_rad, *Y;
+
+    if(!pEng->isSHoutput){
+        upmix_engine_vbapGains(src_dirs_deg, S, out_dirs_deg, pEng->nOutputs, gains);
+        return;
+    }
+
+    /* ACN/SN3D real spherical harmonics (i.e. the omni has unity gain) */
+    order = (int)(sqrtf((float)pEng->nOutputs) + 0.5f) - 1;
+    src_dirs_rad = malloc(S*2*sizeof(float));
+    Y = malloc(pEng->nOutputs*S*sizeof(float));
+    for(i=0; i<S; i++){
+        src_dirs_rad[i*2+0] = src_dirs_deg[i*2+0]*M_PI/180.0f;
+        src_dirs_rad[i*2+1] = M_PI/2.0f - src_dirs_deg[i*2+1]*M_PI/180.0f; /* elevation to inclination */
+    }
+    getSHreal(order, src_dirs_rad, S, Y);
+    for(n=0; n<=order; n++){
+        scale = sqrtf(4.0f*M_PI/(2.0f*(float)n+1.0f)); /* N3D to SN3D */
+        for(m=n*n; m<(n+1)*(n+1); m++)
+            for(i=0; i<S; i++)
+                gains[i*pEng->nOutputs+m] = scale * Y[m*S+i];
+    }
+    free(src_dirs_rad);
+    free(Y);
+}
+
+/* estimates the parameters, and formulates the target covariance matrix, of each band group (the covariance matrices of
+ * all groups are updated, but the parameters only of those flagged in 'isUpdated') */
+static void upmix_engine_analyseGroups
+(
+    upmix_engine_data* pEng            /* upmix engine handle */
+)
+{
+    int i, j, k, it, g, band, band_start, band_end, nIn, nOut, maxIdx;
+    float trace, maxDiag, norm, lambda1, lambdaDiff, srcEn, diffEn, score, maxScore;
+    float* gOut;
+    float_complex* Cx, *Cy, *v, *w;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    float_complex alpha, beta;
+
+    nIn = pEng->nInputs;
+    nOut = pEng->nOutputs;
+    v = pEng->v;
+    w = &(pEng->v[nIn]);
+    for(g=0; g<pEng->nGrps; g++){
+        Cx = &(pEng->Cx[g*nIn*nIn]);
+        Cy = &(pEng->Cy[g*nOut*nOut]);
+
+        /* update the time-averaged covariance matrix of this group */
+        band_start = pEng->grp_idx[g]-1;
+        band_end = MIN(pEng->grp_idx[g+1]-1, HYBRID_BANDS);
+        alpha = cmplxf((1.0f-pEng->covAvg)/(float)((band_end-band_start)*TIME_SLOTS), 0.0f);
+        beta = cmplxf(pEng->covAvg, 0.0f);
+        for(band=band_start; band<band_end; band++){
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nIn, nIn, TIME_SLOTS, &alpha,
+                        &(pEng->inputFrameTF[band*nIn*TIME_SLOTS]), TIME_SLOTS,
+                        &(pEng->inputFrameTF[band*nIn*TIME_SLOTS]), TIME_SLOTS, band==band_start ? &beta : &calpha,
+                        Cx, nIn);
+        }
+        if(!pEng->isUpdated[g])
+            continue;
+        trace = 0.0f;
+        maxDiag = 0.0f;
+        maxIdx = 0;
+        for(i=0; i<nIn; i++){
+            trace += crealf(Cx[i*nIn+i]);
+            if(crealf(Cx[i*nIn+i]) > maxDiag){
+                maxDiag = crealf(Cx[i*nIn+i]);
+                maxIdx = i;
+            }
+        }
+        pEng->isSilent[g] = trace < 1e-12f ? 1 : 0;
+        if(pEng->isSilent[g]){
+            /* (the mixing matrix is not needed, so the solver is given something well-conditioned instead) */
+            for(i=0; i<nOut*nOut; i++)
+                Cy[i] = cmplxf(i%(nOut+1)==0 ? 1.0f : 0.0f, 0.0f);
+            for(i=0; i<nIn*nIn; i++)
+                Cx[i] = cmplxf(i%(nIn+1)==0 ? 1e-12f : 0.0f, 0.0f);
+            continue;
+        }
+
+        /* principal eigenvector, via power iteration (starting from the column of the loudest channel) */
+        for(i=0; i<nIn; i++)
+            v[i] = crmulf(Cx[i*nIn+maxIdx], 1.0f/maxDiag);
+        lambda1 = 0.0f;
+        for(it=0; it<ENGINE_NUM_POWER_ITERATIONS; it++){
+            cblas_cgemv(CblasRowMajor, CblasNoTrans, nIn, nIn, &calpha, Cx, nIn, v, 1, &cbeta, w, 1);
+            norm = 0.0f;
+            for(i=0; i<nIn; i++)
+                norm += crealf(w[i])*crealf(w[i]) + cimagf(w[i])*cimagf(w[i]);
+            norm = sqrtf(norm);
+            if(norm < 1e-20f)
+                break;
+            lambda1 = norm; /* (since ||v||=1 from the second iteration onwards) */
+            for(i=0; i<nIn; i++)
+                v[i] = crmulf(w[i], 1.0f/norm);
+        }
+
+        /* direct and diffuse energies; the remaining eigenvalues are assumed to be those of the diffuse part */
+        lambda1 = MIN(lambda1, trace);
+        lambdaDiff = nIn > 1 ? (trace-lambda1)/(float)(nIn-1) : 0.0f;
+        srcEn = MAX(lambda1-lambdaDiff, 0.0f);
+        diffEn = trace-srcEn;
+
+        /* principal direction; i.e. that for which the input panning gains best match the eigenvector */
+        maxScore = -FLT_MAX;
+        maxIdx = 0;
+        for(k=0; k<pEng->nGrid; k++){
+            score = 0.0f;
+            for(i=0; i<nIn; i++)
+                score += pEng->grid_gIn[k*nIn+i] * cabsf(v[i]);
+            if(score > maxScore){
+                maxScore = score;
+                maxIdx = k;
+            }
+        }
+
+        /* target covariance matrix; direct part panned to the principal direction, plus the diffuse part */
+        gOut = &(pEng->grid_gOut[maxIdx*nOut]);
+        for(i=0; i<nOut; i++){
+            for(j=0; j<nOut; j++)
+                Cy[i*nOut+j] = cmplxf(srcEn * gOut[i] * gOut[j], 0.0f);
+            Cy[i*nOut+i] = craddf(Cy[i*nOut+i], diffEn * pEng->diffGains[i]);
+        }
+    }
+}
+
+static void upmix_engine_processFrame
+(
+    void  *  const hEng,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    int i, t, ch, band, g, nIn, nOut, nUpdated, interval;
+    float multiResFreq, w;
+    float_complex* M, *M_app;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+
+    nIn = pEng->nInputs;
+    nOut = pEng->nOutputs;
+    multiResFreq = pEng->multiResFreq;
+    saf_telemetry_frameBegin(pEng->hTelemetry);
+
+    /* Load time-domain data (missing channels are treated as silent) */
+    for(ch=0; ch<nIn; ch++)
+        pEng->inPtrs[ch] = ch < nInputs ? inputs[ch] : pEng->zeros;
+
+    /* Apply time-frequency transform */
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch<nIn; ch++)
+            memcpy(pEng->tempHopFrameTD[ch], &(pEng->inPtrs[ch][t*HOP_SIZE]), HOP_SIZE*sizeof(float));
+        afSTFTforwardPlanar(pEng->hSTFT, pEng->tempHopFrameTD, &(pEng->inputFrameTF[t]), nIn*TIME_SLOTS, TIME_SLOTS);
+    }
+
+    /* Groups to update in this frame (all of them, unless the multi-resolution estimation is enabled) */
+    nUpdated = 0;
+    for(g=0; g<pEng->nGrps; g++){
+        band = (pEng->grp_idx[g]-1 + MIN(pEng->grp_idx[g+1]-1, HYBRID_BANDS)-1)/2;
+        interval = upmix_engine_updateInterval(pEng->freqVector[band], multiResFreq);
+        pEng->isUpdated[g] = (pEng->frameCount + (unsigned int)g) % (unsigned int)interval == 0 ? 1 : 0;
+        if(pEng->isUpdated[g]){
+            pEng->updatedGrps[nUpdated++] = g;
+            pEng->nFramesToTarget[g] = interval;
+        }
+    }
+    pEng->frameCount++;
+
+    /* Estimate the parameters of the band groups, and solve for their optimal mixing matrices (in parallel). The
+     * energy compensation is applied to the mixing matrices, rather than to a decorrelated stream */
+    upmix_engine_analyseGroups(pEng);
+    formulate_M_and_Cr_cmplx_batchSubset(pEng->hCdf, pEng->Cx, pEng->Cy, pEng->Q, 1, ENGINE_CDF4SAP_REG,
+                                         pEng->updatedGrps, nUpdated, pEng->M, NULL);
+    for(g=0; g<pEng->nGrps; g++)
+        if(pEng->isUpdated[g] && pEng->isSilent[g]) /* pass the prototype signals through */
+            memcpy(&(pEng->M[g*nOut*nIn]), pEng->Q, nOut*nIn*sizeof(float_complex));
+
+    /* Mixing matrices to apply; interpolated towards the latest solution over the frames until the next update */
+    for(g=0; g<pEng->nGrps; g++){
+        M = &(pEng->M[g*nOut*nIn]);
+        M_app = &(pEng->M_applied[g*nOut*nIn]);
+        if(pEng->nFramesToTarget[g]<=1)
+            memcpy(M_app, M, nOut*nIn*sizeof(float_complex));
+        else{
+            w = 1.0f/(float)pEng->nFramesToTarget[g];
+            for(i=0; i<nOut*nIn; i++)
+                M_app[i] = craddf(M_app[i], crmulf(ccsubf(M[i], M_app[i]), w));
+            pEng->nFramesToTarget[g]--;
+        }
+    }
+
+    /* Apply the mixing matrix of each group to its bands */
+    for(g=0; g<pEng->nGrps; g++){
+        for(band=pEng->grp_idx[g]-1; band<MIN(pEng->grp_idx[g+1]-1, HYBRID_BANDS); band++){
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nOut, TIME_SLOTS, nIn, &calpha,
+                        &(pEng->M_applied[g*nOut*nIn]), nIn,
+                        &(pEng->inputFrameTF[band*nIn*TIME_SLOTS]), TIME_SLOTS, &cbeta,
+                        &(pEng->outputFrameTF[band*nOut*TIME_SLOTS]), TIME_SLOTS);
+        }
+    }
+
+    /* inverse time-frequency transform */
+    for(t=0; t<TIME_SLOTS; t++) {
+        afSTFTinversePlanar(pEng->hSTFT, &(pEng->outputFrameTF[t]), nOut*TIME_SLOTS, TIME_SLOTS, pEng->tempHopFrameTD);
+        for(ch=0; ch<MIN(nOut, nOutputs); ch++)
+            memcpy(&(outputs[ch][t*HOP_SIZE]), pEng->tempHopFrameTD[ch], HOP_SIZE*sizeof(float));
+    }
+    saf_telemetry_frameEnd(pEng->hTelemetry);
+}
+
+void upmix_engine_create
+(
+    void ** const phEng,
+    const float*  in_dirs_deg,
+    int           nInputs,
+    const float*  out_dirs_deg,
+    int           nOutputs,
+    int           outOrder,
+    int           sampleRate,
+    int           nThreads
+)
+{
+    upmix_engine_data* pEng = (upmix_engine_data*)malloc(sizeof(upmix_engine_data));
+    if (pEng == NULL) { return;/*error*/ }
+    *phEng = (void*)pEng;
+    int i, j, band, nIn, nOut, order;
+    float minAzi, maxAzi, norm;
+    float* grid_dirs_deg, *gains;
+
+    /* configuration */
+    nIn = pEng->nInputs = CLAMP(nInputs, 2, UPMIX_ENGINE_MAX_NUM_INPUTS);
+    pEng->isSHoutput = out_dirs_deg == NULL ? 1 : 0;
+    if(pEng->isSHoutput){
+        order = CLAMP(outOrder, 1, (int)(sqrtf((float)UPMIX_ENGINE_MAX_NUM_OUTPUTS)+0.5f)-1);
+        nOut = pEng->nOutputs = (order+1)*(order+1);
+    }
+    else
+        nOut = pEng->nOutputs = CLAMP(nOutputs, 1, UPMIX_ENGINE_MAX_NUM_OUTPUTS);
+    if(sampleRate==44100)
+        for(band=0; band <HYBRID_BANDS; band++)
+            pEng->freqVector[band] = (float)__afCenterFreq44100[band];
+    else
+        for(band=0; band <HYBRID_BANDS; band++)
+            pEng->freqVector[band] = (float)__afCenterFreq48e3[band];
+
+    /* time-frequency transform + buffers */
+    saf_fifo_create(&(pEng->hFIFO), FRAME_SIZE, nIn, nOut);
+    saf_telemetry_create(&(pEng->hTelemetry));
+    afSTFTinit(&(pEng->hSTFT), HOP_SIZE, nIn, nOut, 0, 1, 1);
+    pEng->tempHopFrameTD = (float**)malloc2d(MAX(nIn, nOut), HOP_SIZE, sizeof(float));
+    pEng->zeros = calloc(FRAME_SIZE, sizeof(float));
+    pEng->inputFrameTF = calloc(HYBRID_BANDS*nIn*TIME_SLOTS, sizeof(float_complex));
+    pEng->outputFrameTF = calloc(HYBRID_BANDS*nOut*TIME_SLOTS, sizeof(float_complex));
+
+    /* direction grid; a 1 degree ring for planar input layouts (only the frontal arc between the loudspeakers for
+     * stereo, since the two are indistinguishable from the back), or a geosphere otherwise */
+    if(upmix_engine_isPlanar(in_dirs_deg, nIn)){
+        if(nIn==2){
+            minAzi = MIN(in_dirs_deg[0], in_dirs_deg[2]);
+            maxAzi = MAX(in_dirs_deg[0], in_dirs_deg[2]);
+            pEng->nGrid = (int)(maxAzi-minAzi+0.5f)+1;
+        }
+        else{
+            minAzi = -180.0f;
+            pEng->nGrid = 360;
+        }
+        grid_dirs_deg = malloc(pEng->nGrid*2*sizeof(float));
+        for(i=0; i<pEng->nGrid; i++){
+            grid_dirs_deg[i*2+0] = minAzi + (float)i;
+            grid_dirs_deg[i*2+1] = 0.0f;
+        }
+    }
+    else{
+        pEng->nGrid = __geosphere_ico_nPoints[ENGINE_GRID_GEOSPHERE_DEGREE];
+        grid_dirs_deg = malloc(pEng->nGrid*2*sizeof(float));
+        memcpy(grid_dirs_deg, __HANDLES_geosphere_ico_dirs_deg[ENGINE_GRID_GEOSPHERE_DEGREE], pEng->nGrid*2*sizeof(float));
+    }
+    pEng->grid_gIn = malloc(pEng->nGrid*nIn*sizeof(float));
+    pEng->grid_gOut = malloc(pEng->nGrid*nOut*sizeof(float));
+    upmix_engine_vbapGains(grid_dirs_deg, pEng->nGrid, in_dirs_deg, nIn, pEng->grid_gIn);
+    upmix_engine_outputGains(pEng, out_dirs_deg, grid_dirs_deg, pEng->nGrid, pEng->grid_gOut);
+    free(grid_dirs_deg);
+
+    /* diffuse covariance matrix (unit energy in total for loudspeakers, or in the omni for SN3D) and prototype */
+    pEng->diffGains = malloc(nOut*sizeof(float));
+    for(i=0; i<nOut; i++)
+        pEng->diffGains[i] = pEng->isSHoutput ? 1.0f/(2.0f*floorf(sqrtf((float)i))+1.0f) : 1.0f/(float)nOut;
+    gains = malloc(MAX(nIn*nOut, nIn)*sizeof(float));
+    upmix_engine_outputGains(pEng, out_dirs_deg, in_dirs_deg, nIn, gains);
+    pEng->Q = malloc(nOut*nIn*sizeof(float_complex));
+    for(i=0; i<nOut*nIn; i++)
+        pEng->Q[i] = cmplxf(gains[(i%nIn)*nOut + i/nIn], 0.0f);
+    if(!pEng->isSHoutput){
+        /* loudspeakers that none of the inputs are panned to (e.g. height channels) would otherwise remain silent, so
+         * their prototypes are instead the input channels nearest to them */
+        for(i=0; i<nOut; i++){
+            for(j=0, norm=0.0f; j<nIn; j++)
+                norm += crealf(pEng->Q[i*nIn+j])*crealf(pEng->Q[i*nIn+j]);
+            if(norm < 1e-3f){
+                upmix_engine_vbapGains(&(out_dirs_deg[i*2]), 1, in_dirs_deg, nIn, gains);
+                for(j=0; j<nIn; j++)
+                    pEng->Q[i*nIn+j] = cmplxf(gains[j], 0.0f);
+            }
+        }
+    }
+    free(gains);
+
+    /* band grouping */
+    pEng->grp_idx = NULL;
+    pEng->grp_freqs = NULL;
+    findERBpartitions(pEng->freqVector, HYBRID_BANDS, MAX_GROUP_FREQ, &(pEng->grp_idx), &(pEng->grp_freqs), &(pEng->nGrps));
+    pEng->nGrps--;
+    pEng->grp_idx[pEng->nGrps] = HYBRID_BANDS+1; /* so that the last group also includes the last band */
+    pEng->Cx = calloc(pEng->nGrps*nIn*nIn, sizeof(float_complex));
+    pEng->M = calloc(pEng->nGrps*nOut*nIn, sizeof(float_complex));
+
+    pEng->Cy = calloc(pEng->nGrps*nOut*nOut, sizeof(float_complex));
+    pEng->isSilent = calloc(pEng->nGrps, sizeof(int));
+    pEng->M_applied = calloc(pEng->nGrps*nOut*nIn, sizeof(float_complex));
+    pEng->isUpdated = calloc(pEng->nGrps, sizeof(int));
+    pEng->updatedGrps = calloc(pEng->nGrps, sizeof(int));
+    pEng->nFramesToTarget = calloc(pEng->nGrps, sizeof(int));
+    pEng->frameCount = 0;
+    pEng->v = malloc(2*nIn*sizeof(float_complex));
+
+    /* optimal mixing solvers (one per thread); the (averaged) covariances vary
+     * slowly, so each group is warm-started from its previous solution */
+    cdf4sap_cmplx_batch_create(&(pEng->hCdf), nIn, nOut, nThreads);
+    cdf4sap_cmplx_batch_setIncrementalMode(pEng->hCdf, 1, ENGINE_CDF4SAP_MAX_CHANGE, pEng->nGrps);
+
+    /* user parameters */
+    pEng->covAvg = 0.85f;
+    pEng->multiResFreq = 0.0f;
+}
+
+void upmix_engine_destroy
+(
+    void ** const phEng
+)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(*phEng);
+
+    if (pEng != NULL) {
+        saf_fifo_destroy(&(pEng->hFIFO));
+        saf_telemetry_destroy(&(pEng->hTelemetry));
+        afSTFTfree(pEng->hSTFT);
+        cdf4sap_cmplx_batch_destroy(&(pEng->hCdf));
+        free(pEng->tempHopFrameTD);
+        free(pEng->zeros);
+        free(pEng->inputFrameTF);
+        free(pEng->outputFrameTF);
+        free(pEng->grid_gIn);
+        free(pEng->grid_gOut);
+        free(pEng->diffGains);
+        free(pEng->Q);
+        free(pEng->grp_idx);
+        free(pEng->grp_freqs);
+        free(pEng->Cx);
+        free(pEng->M);
+        free(pEng->Cy);
+        free(pEng->isSilent);
+        free(pEng->M_applied);
+        free(pEng->isUpdated);
+        free(pEng->updatedGrps);
+        free(pEng->nFramesToTarget);
+        free(pEng->v);
+        free(pEng);
+        pEng = NULL;
+        *phEng = NULL;
+    }
+}
+
+void upmix_engine_process
+(
+    void  *  const hEng,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples
+)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    unsigned int fpState;
+    int blasState;
+
+    fpState = saf_denormals_guardBegin();
+    blasState = saf_blasThreads_beginProcessing();
+
+    saf_fifo_process(pEng->hFIFO, inputs, outputs, nInputs, nOutputs, nSamples, &upmix_engine_processFrame, hEng);
+
+    saf_blasThreads_end(blasState);
+    saf_denormals_guardEnd(fpState);
+}
+
+
+/* Set Functions */
+
+void upmix_engine_setCovAvg(void* const hEng, float newValue)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    pEng->covAvg = CLAMP(newValue, 0.0f, 0.99f);
+}
+
+void upmix_engine_setMultiResolutionFreq(void* const hEng, float newFreq)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    pEng->multiResFreq = MAX(newFreq, 0.0f);
+}
+
+
+/* Get Functions */
+
+float upmix_engine_getCovAvg(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return pEng->covAvg;
+}
+
+float upmix_engine_getMultiResolutionFreq(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return pEng->multiResFreq;
+}
+
+int upmix_engine_getNumInputs(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return pEng->nInputs;
+}
+
+int upmix_engine_getNumOutputs(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return pEng->nOutputs;
+}
+
+int upmix_engine_getProcessingDelay(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return saf_fifo_getLatency(pEng->hFIFO) + 12*HOP_SIZE;
+}
+
+void* upmix_engine_getTelemetry(void* const hEng)
+{
+    upmix_engine_data *pEng = (upmix_engine_data*)(hEng);
+    return pEng->hTelemetry;
+}
@@ -12,18 +12,18 @@
  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
  OR PERFORMANCE OF THIS SOFTWARE.
 */
-/*
- * Filename:
- *     upmix_internal.h
- * Description:
- *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
- *     5.x is supported, utilising a modified version of the direct-ambient decomposition
- *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
- *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
- * Dependencies:
- *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
- * Author, date created:
- *     Leo McCormack, 04.04.2018
+/*
+ * Filename:
+ *     upmix_internal.h
+ * Description:
+ *     A (soon to be) collection of upmixing algorithms. However, currently, only stereo to
+ *     5.x is supported, utilising a modified version of the direct-ambient decomposition
+ *     approach described in: Faller, C. (2006). Multiple-loudspeaker playback of stereo
+ *     signals. Journal of the Audio Engineering Society, 54(11), 1051-1064.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, saf_vbap, saf_sh
+ * Author, date created:
+ *     Leo McCormack, 04.04.2018
  */
 
 #ifndef __UPMIX_INTERNAL_H_INCLUDED__
@@ -34,7 +34,6 @@
 #include <math.h>
 #include <string.h>
 #include "upmix.h"
-#include "upmix_database.h"
 #define SAF_ENABLE_VBAP     /* for VBAP gains */
 #define SAF_ENABLE_SH       /* for cart2sph and sph2cart */
 #define SAF_ENABLE_AFSTFT   /* for time-frequency transform */
@@ -54,7 +53,7 @@ extern "C" {
 #define MAX_NUM_INPUT_CHANNELS ( 2 )                 /* Currently, only stereo to 5.x is supported. more in future! */
 #define MAX_NUM_OUTPUT_CHANNELS ( 5 )                /* Currently, only stereo to 5.x is supported. more in future! */
 #define MAX_GROUP_FREQ ( 18000 )                     /* Hz, past this point bands are grouped into 1 */
-#define DIFFUSE_DELAY_MS ( 30.0f )                   /* diffuse stream delay in ms */
+#define DIFFUSE_DELAY_MS ( 30.0f )                   /* diffuse stream delay in ms */
 #define DIFFUSE_DELAY_TIME_SLOTS ( 11 )              /* diffuse stream delay in time slots (11==30ms approx). (bit lazy I know..) */
     
 /***********/
@@ -73,7 +72,14 @@ typedef struct _codecPars
     float maxGrpFreq;                                  /* maximum frequency in Hz, past this, all bands are grouped into one band */
     int* grp_idx;                                      /* the indices that define the band grouping; nGrpBands x 1 */
     float* grp_freqs;                                  /* the group frequencies; nGrpBands x 1 */
-    int nGrpBands;                                     /* number of grouped bands */
+    int nGrpBands;                                     /* number of grouped bands (the number of groups is nGrpBands-1) */
+    int interp_grpIdx[HYBRID_BANDS];                   /* group below each band, from which the parameters are interpolated */
+    float interp_w[HYBRID_BANDS];                      /* interpolation weight of the group above (interp_grpIdx+1) */
+    
+    /* parameters estimated per group; interpolated to each band */
+    float* grp_dir_xy;                                 /* unit vector of the estimated source direction; (nGrpBands-1) x 2 */
+    double* grp_w_src;                                 /* source mixing weights; (nGrpBands-1) x 2 */
+    double* grp_w_diff;                                /* diffuse mixing weights [00 01 11]; (nGrpBands-1) x 3 */
     
     /* low-pass filter */
     float diff_lpf[HYBRID_BANDS];                      /* low-pass filter applied to the diffuse stream */
@@ -86,6 +92,8 @@ typedef struct _codecPars
 typedef struct _upmix
 {
     /* temporary audio buffers */
+    void* hFIFO;                        /* FIFO handle, for arbitrary host block sizes */
+    void* hTelemetry;                   /* health metrics (see saf_telemetry.h) */
     float inputFrameTD[MAX_NUM_INPUT_CHANNELS][FRAME_SIZE];
     float outframeTD[MAX_NUM_OUTPUT_CHANNELS][FRAME_SIZE];
     float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][TIME_SLOTS];
@@ -93,11 +101,11 @@ typedef struct _upmix
     complexVector** STFTInputFrameTF;
     complexVector** STFTOutputFrameTF;
     float** tempHopFrameTD;
-    int fs;
-    
-    /* circular buffer for delaying input signal */
-    float_complex inputframeTF_del[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][TIME_SLOTS];
-    float_complex inputframeTF_buffer[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][DIFFUSE_DELAY_TIME_SLOTS];
+    int fs;
+    
+    /* circular buffer for delaying input signal */
+    float_complex inputframeTF_del[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][TIME_SLOTS];
+    float_complex inputframeTF_buffer[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][DIFFUSE_DELAY_TIME_SLOTS];
     int buffer_rIdx, buffer_wIdx;       /* circular buffer read and write indices */
     
     /* time-frequency transform */
@@ -108,11 +116,12 @@ typedef struct _upmix
     float pValues[HYBRID_BANDS];        /* VBAP normalisation coefficients per band */
     float freqVector[HYBRID_BANDS];     /* frequency vector for processing */ 
     int reInitCodec;                    /* flag. 0: no init required, 1: init required, 2: init ongoing */
-    float_complex Cx[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    float_complex new_Ms[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    float_complex new_Md[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    float_complex directframeTF[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][TIME_SLOTS];
-    float_complex diffuseframeTF[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][TIME_SLOTS];
+    int isPlaying;                      /* flag; copied from upmix_process(), for the current frame */
+    float_complex Cx[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS]; /* covariance matrix per group; only the first nGrpBands-1 are used */
+    float_complex new_Ms[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    float_complex new_Md[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    float_complex directframeTF[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][TIME_SLOTS];
+    float_complex diffuseframeTF[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][TIME_SLOTS];
     
     /* user parameters */
     float loudpkrs_dirs_deg[MAX_NUM_OUTPUT_CHANNELS][2]; /* currently only stereo to 5.x is supported */
@@ -121,8 +130,57 @@ typedef struct _upmix
     float paramAvgCoeff;     /* coefficient for the one-pole filter that smooths the estimated parameters over time; 0..1 */
     float scaleDoAwidth;     /* influences the stage width. 0: only centre, 0.5: -90..90 azimuth, 1: -180..180 azimuth */
     float covAvg;            /* coefficient for the one-pole filter that smooths the covarience matrix over time; 0..1 */
+    UPMIX_BAND_GROUPINGS bandGrouping; /* band grouping used for the parameter estimation */
     
 } upmix_data;
+
+/* main structure for the general upmix engine (see upmix_engine_create) */
+typedef struct _upmix_engine_data
+{
+    /* configuration (fixed upon creation) */
+    int nInputs;             /* number of input channels */
+    int nOutputs;            /* number of output channels */
+    int isSHoutput;          /* 1: the outputs are ACN/SN3D spherical harmonic signals, 0: loudspeaker signals */
+    float freqVector[HYBRID_BANDS];
+    
+    /* audio buffers + afSTFT time-frequency transform handle */
+    void* hFIFO;             /* FIFO handle */
+    void* hTelemetry;        /* health metrics (see saf_telemetry.h) */
+    void* hSTFT;             /* afSTFT handle */
+    float** tempHopFrameTD;  /* MAX(nInputs, nOutputs) x HOP_SIZE */
+    float* zeros;            /* FRAME_SIZE x 1; stands in for any missing input channels */
+    float* inPtrs[UPMIX_ENGINE_MAX_NUM_INPUTS];
+    float_complex* inputFrameTF;  /* FLAT: HYBRID_BANDS x nInputs x TIME_SLOTS */
+    float_complex* outputFrameTF; /* FLAT: HYBRID_BANDS x nOutputs x TIME_SLOTS */
+    
+    /* direction grid, over which the principal direction of each band group is searched for */
+    int nGrid;               /* number of grid directions */
+    float* grid_gIn;         /* energy normalised panning gains of the input layout; FLAT: nGrid x nInputs */
+    float* grid_gOut;        /* panning gains (or SN3D SH weights) of the output format; FLAT: nGrid x nOutputs */
+    float* diffGains;        /* diagonal of the (unit energy) diffuse covariance matrix of the output format; nOutputs x 1 */
+    float_complex* Q;        /* prototype matrix (the inputs panned to the output format); FLAT: nOutputs x nInputs */
+    
+    /* band grouping */
+    int* grp_idx;            /* grouped band indices (start from 1); (nGrps+1) x 1 */
+    float* grp_freqs;        /* group frequencies; (nGrps+1) x 1 */
+    int nGrps;               /* number of band groups */
+    float_complex* Cx;       /* time-averaged input covariance matrix of each group; FLAT: nGrps x nInputs x nInputs */
+    float_complex* Cy;       /* target covariance matrix of each group; FLAT: nGrps x nOutputs x nOutputs */
+    float_complex* M;        /* mixing matrix of each group; FLAT: nGrps x nOutputs x nInputs */
+    int* isSilent;           /* 1: the group is silent (and its mixing matrix is the prototype); nGrps x 1 */
+    float_complex* M_applied; /* mixing matrix applied to each group (interpolated towards 'M'); FLAT: nGrps x nOutputs x nInputs */
+    int* isUpdated;          /* 1: the parameters of the group are updated in the current frame; nGrps x 1 */
+    int* updatedGrps;        /* indices of the groups updated in the current frame; nGrps x 1 */
+    int* nFramesToTarget;    /* number of frames over which 'M_applied' is still interpolated towards 'M'; nGrps x 1 */
+    unsigned int frameCount; /* number of processed frames (for staggering the updates of the groups) */
+    float_complex* v;        /* power iteration vectors; FLAT: 2 x nInputs */
+    void* hCdf;              /* batched saf_cdf4sap (complex) handle, which solves all of the groups in parallel */
+    
+    /* user parameters */
+    float covAvg;            /* coefficient for the one-pole filter that smooths the covarience matrix over time; 0..1 */
+    float multiResFreq;      /* crossover frequency of the multi-resolution parameter estimation, in Hz (0: disabled) */
+    
+} upmix_engine_data;
      
 
 /**********************/
@@ -54,11 +54,36 @@
  *       to enable ATLAS BLAS routines and ATLAS's CLAPACK interface
  *   - SAF_USE_OPENBLAS_WITH_LAPACKE:
  *       to enable OpenBLAS with LAPACKE interface
+ *   - SAF_USE_BUILTIN_BLAS_AND_LAPACK:
+ *       to employ the minimal built-in subset of CBLAS and LAPACKE (see
+ *       saf_builtinBlas.h), which requires no library; e.g. for WebAssembly
+ *       builds (the default for Emscripten, and for SAF_EMBEDDED_PROFILE, if
+ *       none of the above are defined)
  *
  * @see More information can be found here:
  *      https://github.com/leomccormack/Spatial_Audio_Framework
  * @note MacOSX users only: saf_utilities will employ Apple's Accelerate library
  *       by default, if none of the above FLAGS are defined.
+ * ## Embedded profile
+ *   Add SAF_EMBEDDED_PROFILE to your project's preprocessor definitions, for
+ *   a low-footprint build of the rotator and ambi_bin examples on embedded
+ *   (e.g. ARM Cortex-A) targets:
+ *   - their maximum order, which sizes their buffers, is
+ *     SAF_EMBEDDED_MAX_SH_ORDER (default: 3), rather than 7
+ *   - ambi_bin allocates its buffers from one arena at creation (see
+ *     arena_create()), and only applies prebaked decoders (see
+ *     ambi_bin_setPrebakedDecoder()); so neither the HRIRs, nor the decoder
+ *     design (and thus LAPACK) are required by it
+ *   - the built-in CBLAS/LAPACKE subset is used, unless a performance library
+ *     is defined above; and the NEON kernels of saf_veclib are selected
+ *     whenever the compiler targets NEON
+ * ## Optional
+ *   Add SAF_ENABLE_FAST_MATH to your project's preprocessor definitions, in
+ *   order for the processing loops of the examples (e.g. the HRTF interpolation
+ *   of the binauraliser, and the source rotation of the binauraliser and
+ *   panner) to use the approximate vector
+ *   functions of saf_veclib.h (utility_svsincosapprox() etc.), instead of the
+ *   C library's transcendental functions
  */
 #define SAF_MODULE_UTILITIES
 #include "../modules/saf_utilities/saf_utilities.h"
@@ -115,6 +140,11 @@
  *
  * ## Dependencies
  *   saf_utilities, afSTFTlib
+ * ## Optional
+ *   Add SAF_DEFAULT_HRIRS_EXTERNAL to your project's preprocessor definitions,
+ *   in order to leave the default HRIR set (~14 MB) out of the binary. It is
+ *   then loaded from a SOFA file at run-time instead (requires the SOFA
+ *   reader); see setDefaultHRIRsSofaFile() and SAF_DEFAULT_HRIRS_PATH
  */
 #define SAF_MODULE_HRIR
 #include "../modules/saf_hrir/saf_hrir.h"
@@ -130,6 +160,10 @@
  *
  * ## Dependencies
  *   saf_utilities
+ * ## Optional
+ *   Add SAF_ENABLE_OPENCL to your project's preprocessor definitions (and link
+ *   an OpenCL runtime), in order to enable the OpenCL back-end for the
+ *   activity-map generators (see pmapWorkspace_setBackend())
  */
 #define SAF_MODULE_SH
 #include "../modules/saf_sh/saf_sh.h"
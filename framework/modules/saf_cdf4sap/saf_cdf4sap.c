@@ -37,6 +37,13 @@
 #include "saf_cdf4sap.h"
 #include "../saf_utilities/saf_utilities.h"
 
+/** Maximum number of Jacobi sweeps of a warm-started decomposition */
+#define CDF4SAP_MAX_NUM_JACOBI_SWEEPS ( 4 )
+/** Relative off-diagonal norm, below which a matrix is deemed diagonalised */
+#define CDF4SAP_JACOBI_TOL ( 1e-6f )
+/** Gram matrices more ill-conditioned than this are decomposed in full */
+#define CDF4SAP_GRAM_MIN_RCOND ( 1e-8f )
+
 /**
  * Main data structure for the Covariance Domain Framework for Spatial Audio
  * Processing (CDF4SAP), for real-valued matrices.
@@ -52,6 +59,9 @@ typedef struct _cdf4sap_data {
     float* P_Kxreginverse;
     float* Cx_MH, *Cy_tilde;
     float* G_M;
+
+    /* SVD workspace (sized for all three decompositions) */
+    void* hSVD;
     
 }cdf4sap_data;
 
@@ -72,9 +82,54 @@ typedef struct _cdf4sap_cmplx_data {
     float_complex *P_Kxreginverse;
     float_complex *Cx_MH, *Cy_tilde;
     float_complex* G_M;
+
+    /* SVD workspace (sized for all three decompositions) */
+    void* hSVD;
+
+    /* incremental mode (see cdf4sap_cmplx_setIncrementalMode()) */
+    int incremental;              /**< 1: warm-start from the previous call */
+    float maxChange;              /**< fall back to a full solve beyond this */
+    float_complex* own_U_Cy;      /**< eigenvectors of the previous Cy */
+    float_complex* own_U_Cx;      /**< eigenvectors of the previous Cx */
+    float_complex* own_U_G;       /**< eigenvectors of the previous Gram matrix */
+    int own_isValid;              /**< 1: the above hold a previous solution */
+    float_complex* warm_U_Cy, *warm_U_Cx, *warm_U_G; /**< state in use */
+    int* warm_isValid;            /**< state in use */
+    float_complex* jac_A, *jac_T, *jac_V, *jac_G; /**< Jacobi workspace */
+    float* jac_eig;               /**< Jacobi eigenvalues */
     
 }cdf4sap_cmplx_data;
 
+/**
+ * Data structure for the batched Covariance Domain Framework, which holds one
+ * solver (and residual scratch matrix) per thread, and the arguments of the
+ * current call to formulate_M_and_Cr_batch()/formulate_M_and_Cr_cmplx_batch()
+ */
+typedef struct _cdf4sap_batch_data {
+    int nXcols, nYcols;
+    int isComplex;                /**< 1: complex-valued solvers, 0: real */
+    void* hParFor;                /**< saf_parfor handle */
+    int nThreads;                 /**< number of threads of hParFor */
+    void** hCdf;                  /**< one solver per thread; nThreads x 1 */
+    float* Cr_scratch;            /**< FLAT: nThreads x nYcols x nYcols */
+
+    /* incremental mode; per-batch states (see
+     * cdf4sap_cmplx_batch_setIncrementalMode()) */
+    int maxNumStates;
+    float_complex* state_U_Cy;    /**< FLAT: maxNumStates x nYcols x nYcols */
+    float_complex* state_U_Cx;    /**< FLAT: maxNumStates x nXcols x nXcols */
+    float_complex* state_U_G;     /**< FLAT: maxNumStates x nG x nG */
+    int* state_isValid;           /**< maxNumStates x 1 */
+
+    /* arguments of the current call */
+    void* Cx, *Cy, *Q, *M;
+    float* Cr;
+    const int* batchIdx;          /**< indices of the batches to solve (NULL: all, in order) */
+    int useEnergyFLAG;
+    float reg;
+
+}cdf4sap_batch_data;
+
 void cdf4sap_create
 (
     void ** const phCdf,
@@ -125,6 +180,9 @@ void cdf4sap_create
     
     /* For using energy compensation instead of residuals */
     h->G_M = malloc1d(nYcols*nXcols*sizeof(float));
+
+    /* So that the decompositions do not allocate memory in the processing loop */
+    utility_ssvd_create(&(h->hSVD), MAX(nXcols, nYcols), MAX(nXcols, nYcols));
 }
 
 void cdf4sap_cmplx_create
@@ -178,6 +236,26 @@ void cdf4sap_cmplx_create
     
     /* For using energy compensation instead of residuals */
     h->G_M = malloc1d(nYcols*nXcols*sizeof(float_complex));
+
+    /* So that the decompositions do not allocate memory in the processing loop */
+    utility_csvd_create(&(h->hSVD), MAX(nXcols, nYcols), MAX(nXcols, nYcols));
+
+    /* For the incremental mode (disabled by default) */
+    h->incremental = 0;
+    h->maxChange = 0.0f;
+    h->own_U_Cy = malloc1d(nYcols*nYcols*sizeof(float_complex));
+    h->own_U_Cx = malloc1d(nXcols*nXcols*sizeof(float_complex));
+    h->own_U_G = malloc1d(MIN(nXcols,nYcols)*MIN(nXcols,nYcols)*sizeof(float_complex));
+    h->own_isValid = 0;
+    h->warm_U_Cy = h->own_U_Cy;
+    h->warm_U_Cx = h->own_U_Cx;
+    h->warm_U_G = h->own_U_G;
+    h->warm_isValid = &(h->own_isValid);
+    h->jac_A = malloc1d(MAX(nXcols,nYcols)*MAX(nXcols,nYcols)*sizeof(float_complex));
+    h->jac_T = malloc1d(MAX(nXcols,nYcols)*MAX(nXcols,nYcols)*sizeof(float_complex));
+    h->jac_V = malloc1d(MAX(nXcols,nYcols)*MAX(nXcols,nYcols)*sizeof(float_complex));
+    h->jac_G = malloc1d(MAX(nXcols,nYcols)*MAX(nXcols,nYcols)*sizeof(float_complex));
+    h->jac_eig = malloc1d(MAX(nXcols,nYcols)*sizeof(float));
 }
 
 void cdf4sap_destroy
@@ -210,6 +288,7 @@ void cdf4sap_destroy
         free(h->Cx_MH);
         free(h->Cy_tilde);
         free(h->G_M);
+        utility_ssvd_destroy(&(h->hSVD));
         free(h);
         h = NULL;
     }
@@ -246,6 +325,15 @@ void cdf4sap_cmplx_destroy
         free(h->Cx_MH);
         free(h->Cy_tilde);
         free(h->G_M);
+        utility_csvd_destroy(&(h->hSVD));
+        free(h->own_U_Cy);
+        free(h->own_U_Cx);
+        free(h->own_U_G);
+        free(h->jac_A);
+        free(h->jac_T);
+        free(h->jac_V);
+        free(h->jac_G);
+        free(h->jac_eig);
         free(h);
         h = NULL;
     }
@@ -274,7 +362,7 @@ void formulate_M_and_Cr
         h->lambda[i*nXcols + i] = 1.0f;
 
     /* Decomposition of Cy */
-    utility_ssvd(Cy, nYcols, nYcols, h->U_Cy, h->S_Cy, NULL, NULL);
+    utility_ssvd(h->hSVD, Cy, nYcols, nYcols, h->U_Cy, h->S_Cy, NULL, NULL);
     for(i=0; i< nYcols; i++)
         h->S_Cy[i*nYcols+i] = sqrtf(MAX(h->S_Cy[i*nYcols+i], 2.23e-20f));
     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nYcols, nYcols, nYcols, 1.0f,
@@ -283,7 +371,7 @@ void formulate_M_and_Cr
                 h->Ky, nYcols);
 
     /* Decomposition of Cx */
-    utility_ssvd(Cx, nXcols, nXcols, h->U_Cx, h->S_Cx, NULL, h->s_Cx);
+    utility_ssvd(h->hSVD, Cx, nXcols, nXcols, h->U_Cx, h->S_Cx, NULL, h->s_Cx);
     for(i=0; i< nXcols; i++){
         h->S_Cx[i*nXcols+i] = sqrtf(MAX(h->S_Cx[i*nXcols+i], 2.23e-20f));
         h->s_Cx[i] = sqrtf(MAX(h->s_Cx[i], 2.23e-20f));
@@ -337,7 +425,7 @@ void formulate_M_and_Cr
                 h->Kx, nXcols,
                 h->QH_GhatH_Ky, nYcols, 0.0f,
                 h->KxH_QH_GhatH_Ky, nYcols);
-    utility_ssvd(h->KxH_QH_GhatH_Ky, nXcols, nYcols, h->U, NULL, h->V, NULL);
+    utility_ssvd(h->hSVD, h->KxH_QH_GhatH_Ky, nXcols, nYcols, h->U, NULL, h->V, NULL);
     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nYcols, nXcols, nXcols, 1.0f,
                 h->lambda, nXcols,
                 h->U, nXcols, 0.0f,
@@ -383,6 +471,136 @@ void formulate_M_and_Cr
     }
 }
 
+/**
+ * Warm-started eigenvalue decomposition of a Hermitian matrix, for the
+ * incremental mode: the matrix is first rotated by the eigenvectors of the
+ * previous call, which (for slowly-varying matrices) leaves it nearly diagonal,
+ * and is then diagonalised with a few cyclic Jacobi sweeps.
+ *
+ * @param[in]     h    CDF4SAP handle (for the workspace)
+ * @param[in]     C    Hermitian matrix; FLAT: n x n
+ * @param[in]     n    Dimensions of C
+ * @param[in,out] U    In: previous eigenvectors, out: new eigenvectors (only
+ *                     written if successful); FLAT: n x n
+ * @param[out]    eigs Eigenvalues, in descending order; n x 1
+ * @returns 1 if successful, or 0 if C has changed too much (in which case a
+ *          full decomposition should be carried out instead)
+ */
+static int cdf4sap_cmplx_warmEig
+(
+    cdf4sap_cmplx_data* h,
+    float_complex* C,
+    int n,
+    float_complex* U,
+    float* eigs
+)
+{
+    int i, k, p, q, sweep, maxIdx;
+    float normA, off, thresh, mag2, mag, tau, t, c, s, pr, pi, re, im, xr, xi, tmp;
+    float_complex ph;
+    float_complex* A, *V;
+    float* a, *v;
+    const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f);
+
+    A = h->jac_A;
+    V = h->jac_V;
+
+    /* A = U^H C U */
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n, n, &calpha,
+                C, n,
+                U, n, &cbeta,
+                h->jac_T, n);
+    cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, n, n, n, &calpha,
+                U, n,
+                h->jac_T, n, &cbeta,
+                A, n);
+    normA = off = 0.0f;
+    for(i=0; i<n*n; i++){
+        tmp = crealf(A[i])*crealf(A[i]) + cimagf(A[i])*cimagf(A[i]);
+        normA += tmp;
+        off += i%(n+1)==0 ? 0.0f : tmp;
+    }
+    if(normA < 2.23e-20f || off > h->maxChange*h->maxChange*normA)
+        return 0;
+
+    /* cyclic Jacobi sweeps; each (complex) rotation zeros A(p,q). Elements
+     * small enough not to affect the convergence test are skipped, so that the
+     * sweeps are cheap when U already (nearly) diagonalises C */
+    memcpy(V, U, n*n*sizeof(float_complex));
+    a = (float*)A;
+    v = (float*)V;
+    thresh = CDF4SAP_JACOBI_TOL*CDF4SAP_JACOBI_TOL*normA/(float)(n*n);
+    for(sweep=0; sweep<CDF4SAP_MAX_NUM_JACOBI_SWEEPS && off > CDF4SAP_JACOBI_TOL*CDF4SAP_JACOBI_TOL*normA; sweep++){
+        for(p=0; p<n-1; p++){
+            for(q=p+1; q<n; q++){
+                mag2 = a[2*(p*n+q)]*a[2*(p*n+q)] + a[2*(p*n+q)+1]*a[2*(p*n+q)+1];
+                if(mag2 <= thresh)
+                    continue;
+                mag = sqrtf(mag2);
+                pr = a[2*(p*n+q)]/mag;
+                pi = a[2*(p*n+q)+1]/mag;
+                tau = (a[2*(q*n+q)] - a[2*(p*n+p)])/(2.0f*mag);
+                t = (tau >= 0.0f ? 1.0f : -1.0f)/(fabsf(tau) + sqrtf(1.0f + tau*tau));
+                c = 1.0f/sqrtf(1.0f + t*t);
+                s = t*c;
+
+                /* A = A*G and V = V*G, with G = [c, s; -s*conj(ph), c*conj(ph)],
+                 * ph = A(p,q)/|A(p,q)|. (Written out in real arithmetic, on
+                 * the interleaved real/imaginary parts, as this is the inner
+                 * loop) */
+                for(k=0; k<n; k++){
+                    xr = a[2*(k*n+p)]; xi = a[2*(k*n+p)+1];
+                    re = a[2*(k*n+q)]*pr + a[2*(k*n+q)+1]*pi;
+                    im = a[2*(k*n+q)+1]*pr - a[2*(k*n+q)]*pi;
+                    a[2*(k*n+p)] = c*xr - s*re; a[2*(k*n+p)+1] = c*xi - s*im;
+                    a[2*(k*n+q)] = s*xr + c*re; a[2*(k*n+q)+1] = s*xi + c*im;
+                    xr = v[2*(k*n+p)]; xi = v[2*(k*n+p)+1];
+                    re = v[2*(k*n+q)]*pr + v[2*(k*n+q)+1]*pi;
+                    im = v[2*(k*n+q)+1]*pr - v[2*(k*n+q)]*pi;
+                    v[2*(k*n+p)] = c*xr - s*re; v[2*(k*n+p)+1] = c*xi - s*im;
+                    v[2*(k*n+q)] = s*xr + c*re; v[2*(k*n+q)+1] = s*xi + c*im;
+                }
+                /* A = G^H*A */
+                for(k=0; k<n; k++){
+                    xr = a[2*(p*n+k)]; xi = a[2*(p*n+k)+1];
+                    re = a[2*(q*n+k)]*pr - a[2*(q*n+k)+1]*pi;
+                    im = a[2*(q*n+k)]*pi + a[2*(q*n+k)+1]*pr;
+                    a[2*(p*n+k)] = c*xr - s*re; a[2*(p*n+k)+1] = c*xi - s*im;
+                    a[2*(q*n+k)] = s*xr + c*re; a[2*(q*n+k)+1] = s*xi + c*im;
+                }
+                a[2*(p*n+q)] = a[2*(p*n+q)+1] = a[2*(q*n+p)] = a[2*(q*n+p)+1] = 0.0f;
+            }
+        }
+        off = 0.0f;
+        for(i=0; i<n*n; i++)
+            off += i%(n+1)==0 ? 0.0f : a[2*i]*a[2*i] + a[2*i+1]*a[2*i+1];
+    }
+    if(off > CDF4SAP_JACOBI_TOL*CDF4SAP_JACOBI_TOL*normA)
+        return 0; /* did not converge */
+
+    /* singular values (|eigenvalues|) in descending order, as returned by
+     * utility_csvd(); so that the (numerically) rank-deficient matrices are
+     * treated in the same way as with a full decomposition. (The eigenvector
+     * of a negative eigenvalue is then a left singular vector, and a right
+     * singular vector after flipping its sign, which is irrelevant here.) */
+    for(i=0; i<n; i++)
+        eigs[i] = fabsf(a[2*(i*n+i)]);
+    for(i=0; i<n-1; i++){
+        maxIdx = i;
+        for(k=i+1; k<n; k++)
+            if(eigs[k] > eigs[maxIdx])
+                maxIdx = k;
+        if(maxIdx!=i){
+            tmp = eigs[i]; eigs[i] = eigs[maxIdx]; eigs[maxIdx] = tmp;
+            for(k=0; k<n; k++){
+                ph = V[k*n+i]; V[k*n+i] = V[k*n+maxIdx]; V[k*n+maxIdx] = ph;
+            }
+        }
+    }
+    memcpy(U, V, n*n*sizeof(float_complex));
+    return 1;
+}
+
 void formulate_M_and_Cr_cmplx
 (
     void * const hCdf,
@@ -396,18 +614,29 @@ void formulate_M_and_Cr_cmplx
 )
 {
     cdf4sap_cmplx_data *h = (cdf4sap_cmplx_data*)(hCdf);
-    int i, j, nXcols, nYcols;
+    int i, j, nXcols, nYcols, nG, warm;
     const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f);
 
     nXcols = h->nXcols;
     nYcols = h->nYcols;
+    warm = h->incremental && *(h->warm_isValid);
     
     memset(h->lambda, 0, nYcols * nXcols * sizeof(float_complex));
     for(i = 0; i<MIN(nXcols,nYcols); i++)
         h->lambda[i*nXcols + i] = cmplxf(1.0f, 0.0f);
     
     /* Decomposition of Cy */
-    utility_csvd(Cy, nYcols, nYcols, h->U_Cy, h->S_Cy, NULL, NULL);
+    if(warm && cdf4sap_cmplx_warmEig(h, Cy, nYcols, h->warm_U_Cy, h->jac_eig)){
+        memcpy(h->U_Cy, h->warm_U_Cy, nYcols*nYcols*sizeof(float_complex));
+        memset(h->S_Cy, 0, nYcols*nYcols*sizeof(float_complex));
+        for(i=0; i< nYcols; i++)
+            h->S_Cy[i*nYcols+i] = cmplxf(h->jac_eig[i], 0.0f);
+    }
+    else{
+        utility_csvd(h->hSVD, Cy, nYcols, nYcols, h->U_Cy, h->S_Cy, NULL, NULL);
+        if(h->incremental)
+            memcpy(h->warm_U_Cy, h->U_Cy, nYcols*nYcols*sizeof(float_complex));
+    }
     for(i=0; i< nYcols; i++)
         h->S_Cy[i*nYcols+i] = cmplxf(sqrtf(MAX(crealf(h->S_Cy[i*nYcols+i]), 2.23e-20f)), 0.0f);
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nYcols, nYcols, nYcols, &calpha,
@@ -416,7 +645,15 @@ void formulate_M_and_Cr_cmplx
                 h->Ky, nYcols);
     
     /* Decomposition of Cx */
-    utility_csvd(Cx, nXcols, nXcols, h->U_Cx, h->S_Cx, NULL, h->s_Cx);
+    if(warm && cdf4sap_cmplx_warmEig(h, Cx, nXcols, h->warm_U_Cx, h->s_Cx)){
+        memcpy(h->U_Cx, h->warm_U_Cx, nXcols*nXcols*sizeof(float_complex));
+        memset(h->S_Cx, 0, nXcols*nXcols*sizeof(float_complex));
+    }
+    else{
+        utility_csvd(h->hSVD, Cx, nXcols, nXcols, h->U_Cx, h->S_Cx, NULL, h->s_Cx);
+        if(h->incremental)
+            memcpy(h->warm_U_Cx, h->U_Cx, nXcols*nXcols*sizeof(float_complex));
+    }
     for(i=0; i< nXcols; i++){
         h->s_Cx[i] = sqrtf(MAX(h->s_Cx[i], 2.23e-13f));
         h->S_Cx[i*nXcols+i] = cmplxf(h->s_Cx[i], 0.0f);
@@ -473,15 +710,63 @@ void formulate_M_and_Cr_cmplx
                 h->Kx, nXcols,
                 h->QH_GhatH_Ky, nYcols, &cbeta,
                 h->KxH_QH_GhatH_Ky, nYcols);
-    utility_csvd(h->KxH_QH_GhatH_Ky, nXcols, nYcols, h->U, NULL, h->V, NULL);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nYcols, nXcols, nXcols, &calpha,
-                h->lambda, nXcols,
-                h->U, nXcols, &cbeta,
-                h->lambda_UH, nXcols);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nYcols, nXcols, nYcols, &calpha,
-                h->V, nYcols,
-                h->lambda_UH, nXcols, &cbeta,
-                h->P, nXcols);
+    /* (P=V*lambda*U^H is the polar factor of A^H, A=KxH_QH_GhatH_Ky; which, in
+     * the incremental mode, is obtained from the warm-started decomposition of
+     * the smaller Gram matrix, W*E*W^H, as: A^H*W*E^-1/2*W^H if nX<=nY, or as:
+     * W*E^-1/2*W^H*A^H otherwise) */
+    nG = MIN(nXcols, nYcols);
+    if(warm){
+        if(nXcols<=nYcols)
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nG, nG, nYcols, &calpha,
+                        h->KxH_QH_GhatH_Ky, nYcols,
+                        h->KxH_QH_GhatH_Ky, nYcols, &cbeta,
+                        h->jac_G, nG);
+        else
+            cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, nG, nG, nXcols, &calpha,
+                        h->KxH_QH_GhatH_Ky, nYcols,
+                        h->KxH_QH_GhatH_Ky, nYcols, &cbeta,
+                        h->jac_G, nG);
+        warm = cdf4sap_cmplx_warmEig(h, h->jac_G, nG, h->warm_U_G, h->jac_eig) &&
+               h->jac_eig[nG-1] > CDF4SAP_GRAM_MIN_RCOND*h->jac_eig[0];
+    }
+    if(warm){
+        for(i=0; i<nG; i++)
+            for(j=0; j<nG; j++)
+                h->jac_T[i*nG+j] = crmulf(h->warm_U_G[i*nG+j], 1.0f/sqrtf(h->jac_eig[j]));
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nG, nG, nG, &calpha,
+                    h->jac_T, nG,
+                    h->warm_U_G, nG, &cbeta,
+                    h->jac_A, nG);
+        if(nXcols<=nYcols)
+            cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, nYcols, nXcols, nXcols, &calpha,
+                        h->KxH_QH_GhatH_Ky, nYcols,
+                        h->jac_A, nXcols, &cbeta,
+                        h->P, nXcols);
+        else
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nYcols, nXcols, nYcols, &calpha,
+                        h->jac_A, nYcols,
+                        h->KxH_QH_GhatH_Ky, nYcols, &cbeta,
+                        h->P, nXcols);
+    }
+    else{
+        utility_csvd(h->hSVD, h->KxH_QH_GhatH_Ky, nXcols, nYcols, h->U, NULL, h->V, NULL);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nYcols, nXcols, nXcols, &calpha,
+                    h->lambda, nXcols,
+                    h->U, nXcols, &cbeta,
+                    h->lambda_UH, nXcols);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nYcols, nXcols, nYcols, &calpha,
+                    h->V, nYcols,
+                    h->lambda_UH, nXcols, &cbeta,
+                    h->P, nXcols);
+        if(h->incremental){
+            /* the eigenvectors of the Gram matrix are the left (nX<=nY) or right (nX>nY) singular vectors of A */
+            for(i=0; i<nG; i++)
+                for(j=0; j<nG; j++)
+                    h->warm_U_G[i*nG+j] = nXcols<=nYcols ? h->U[i*nXcols+j] : h->V[i*nYcols+j];
+        }
+    }
+    if(h->incremental)
+        *(h->warm_isValid) = 1;
     
     /* Formulate M */
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nYcols, nXcols, nXcols, &calpha,
@@ -526,3 +811,262 @@ void formulate_M_and_Cr_cmplx
     } 
 }
 
+void cdf4sap_cmplx_setIncrementalMode
+(
+    void * const hCdf,
+    int enableFLAG,
+    float maxChange
+)
+{
+    cdf4sap_cmplx_data *h = (cdf4sap_cmplx_data*)(hCdf);
+
+    h->incremental = enableFLAG ? 1 : 0;
+    h->maxChange = maxChange;
+    h->warm_U_Cy = h->own_U_Cy;
+    h->warm_U_Cx = h->own_U_Cx;
+    h->warm_U_G = h->own_U_G;
+    h->warm_isValid = &(h->own_isValid);
+    h->own_isValid = 0;
+}
+
+static void cdf4sap_batch_createCommon
+(
+    void ** const phBatch,
+    int nXcols,
+    int nYcols,
+    int nThreads,
+    int isComplex
+)
+{
+    cdf4sap_batch_data *h;
+    int th;
+
+    *phBatch = malloc1d(sizeof(cdf4sap_batch_data));
+    h = (cdf4sap_batch_data*)(*phBatch);
+    h->nXcols = nXcols;
+    h->nYcols = nYcols;
+    h->isComplex = isComplex;
+    saf_parfor_create(&(h->hParFor), nThreads);
+    h->nThreads = saf_parfor_getNumThreads(h->hParFor);
+    h->hCdf = malloc1d(h->nThreads*sizeof(void*));
+    for(th=0; th<h->nThreads; th++){
+        if(isComplex)
+            cdf4sap_cmplx_create(&(h->hCdf[th]), nXcols, nYcols);
+        else
+            cdf4sap_create(&(h->hCdf[th]), nXcols, nYcols);
+    }
+    h->Cr_scratch = malloc1d(h->nThreads*nYcols*nYcols*sizeof(float));
+    h->maxNumStates = 0;
+    h->state_U_Cy = h->state_U_Cx = h->state_U_G = NULL;
+    h->state_isValid = NULL;
+}
+
+static void cdf4sap_batch_destroyCommon
+(
+    void ** const phBatch
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(*phBatch);
+    int th;
+
+    if(h!=NULL){
+        saf_parfor_destroy(&(h->hParFor));
+        for(th=0; th<h->nThreads; th++){
+            if(h->isComplex)
+                cdf4sap_cmplx_destroy(&(h->hCdf[th]));
+            else
+                cdf4sap_destroy(&(h->hCdf[th]));
+        }
+        free(h->hCdf);
+        free(h->Cr_scratch);
+        free(h->state_U_Cy);
+        free(h->state_U_Cx);
+        free(h->state_U_G);
+        free(h->state_isValid);
+        free(h);
+        *phBatch = NULL;
+    }
+}
+
+/** Loop body of the batched functions; solves the batches [first, last) */
+static void cdf4sap_batch_solve
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(hCtx);
+    cdf4sap_cmplx_data *hc;
+    int i, b, nX, nY, nG;
+    float* Cr;
+
+    nX = h->nXcols;
+    nY = h->nYcols;
+    nG = MIN(nX, nY);
+    for(i=first; i<last; i++){
+        b = h->batchIdx != NULL ? h->batchIdx[i] : i;
+        Cr = h->Cr != NULL ? &(h->Cr[b*nY*nY]) : &(h->Cr_scratch[threadIndex*nY*nY]);
+        if(h->isComplex){
+            /* point the solver of this thread to the incremental state of this batch (if there is one) */
+            hc = (cdf4sap_cmplx_data*)(h->hCdf[threadIndex]);
+            hc->warm_U_Cy = b<h->maxNumStates ? &(h->state_U_Cy[b*nY*nY]) : hc->own_U_Cy;
+            hc->warm_U_Cx = b<h->maxNumStates ? &(h->state_U_Cx[b*nX*nX]) : hc->own_U_Cx;
+            hc->warm_U_G = b<h->maxNumStates ? &(h->state_U_G[b*nG*nG]) : hc->own_U_G;
+            hc->warm_isValid = b<h->maxNumStates ? &(h->state_isValid[b]) : &(hc->own_isValid);
+        }
+        if(h->isComplex)
+            formulate_M_and_Cr_cmplx(h->hCdf[threadIndex], &(((float_complex*)h->Cx)[b*nX*nX]),
+                                     &(((float_complex*)h->Cy)[b*nY*nY]), (float_complex*)h->Q,
+                                     h->useEnergyFLAG, h->reg, &(((float_complex*)h->M)[b*nY*nX]), Cr);
+        else
+            formulate_M_and_Cr(h->hCdf[threadIndex], &(((float*)h->Cx)[b*nX*nX]), &(((float*)h->Cy)[b*nY*nY]),
+                               (float*)h->Q, h->useEnergyFLAG, h->reg, &(((float*)h->M)[b*nY*nX]), Cr);
+    }
+}
+
+void cdf4sap_batch_create
+(
+    void ** const phBatch,
+    int nXcols,
+    int nYcols,
+    int nThreads
+)
+{
+    cdf4sap_batch_createCommon(phBatch, nXcols, nYcols, nThreads, 0);
+}
+
+void cdf4sap_cmplx_batch_create
+(
+    void ** const phBatch,
+    int nXcols,
+    int nYcols,
+    int nThreads
+)
+{
+    cdf4sap_batch_createCommon(phBatch, nXcols, nYcols, nThreads, 1);
+}
+
+void cdf4sap_batch_destroy
+(
+    void ** const phBatch
+)
+{
+    cdf4sap_batch_destroyCommon(phBatch);
+}
+
+void cdf4sap_cmplx_batch_destroy
+(
+    void ** const phBatch
+)
+{
+    cdf4sap_batch_destroyCommon(phBatch);
+}
+
+void cdf4sap_cmplx_batch_setIncrementalMode
+(
+    void * const hBatch,
+    int enableFLAG,
+    float maxChange,
+    int maxNumBatches
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(hBatch);
+    int th, nG;
+
+    assert(h->isComplex);
+    nG = MIN(h->nXcols, h->nYcols);
+    for(th=0; th<h->nThreads; th++)
+        cdf4sap_cmplx_setIncrementalMode(h->hCdf[th], enableFLAG, maxChange);
+    h->maxNumStates = enableFLAG ? maxNumBatches : 0;
+    h->state_U_Cy = realloc1d(h->state_U_Cy, MAX(h->maxNumStates,1)*(h->nYcols)*(h->nYcols)*sizeof(float_complex));
+    h->state_U_Cx = realloc1d(h->state_U_Cx, MAX(h->maxNumStates,1)*(h->nXcols)*(h->nXcols)*sizeof(float_complex));
+    h->state_U_G = realloc1d(h->state_U_G, MAX(h->maxNumStates,1)*nG*nG*sizeof(float_complex));
+    h->state_isValid = realloc1d(h->state_isValid, MAX(h->maxNumStates,1)*sizeof(int));
+    memset(h->state_isValid, 0, MAX(h->maxNumStates,1)*sizeof(int));
+}
+
+void formulate_M_and_Cr_batch
+(
+    void * const hBatch,
+    float* Cx,
+    float* Cy,
+    float* Q,
+    int useEnergyFLAG,
+    float reg,
+    int nBatches,
+    float* M,
+    float* Cr
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(hBatch);
+
+    assert(!h->isComplex && (Cr!=NULL || useEnergyFLAG));
+    h->Cx = (void*)Cx;
+    h->Cy = (void*)Cy;
+    h->Q = (void*)Q;
+    h->M = (void*)M;
+    h->Cr = Cr;
+    h->batchIdx = NULL;
+    h->useEnergyFLAG = useEnergyFLAG;
+    h->reg = reg;
+    saf_parfor_run(h->hParFor, &cdf4sap_batch_solve, hBatch, nBatches);
+}
+
+void formulate_M_and_Cr_cmplx_batch
+(
+    void * const hBatch,
+    float_complex* Cx,
+    float_complex* Cy,
+    float_complex* Q,
+    int useEnergyFLAG,
+    float reg,
+    int nBatches,
+    float_complex* M,
+    float* Cr
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(hBatch);
+
+    assert(h->isComplex && (Cr!=NULL || useEnergyFLAG));
+    h->Cx = (void*)Cx;
+    h->Cy = (void*)Cy;
+    h->Q = (void*)Q;
+    h->M = (void*)M;
+    h->Cr = Cr;
+    h->batchIdx = NULL;
+    h->useEnergyFLAG = useEnergyFLAG;
+    h->reg = reg;
+    saf_parfor_run(h->hParFor, &cdf4sap_batch_solve, hBatch, nBatches);
+}
+
+void formulate_M_and_Cr_cmplx_batchSubset
+(
+    void * const hBatch,
+    float_complex* Cx,
+    float_complex* Cy,
+    float_complex* Q,
+    int useEnergyFLAG,
+    float reg,
+    const int* batchIdx,
+    int nIdx,
+    float_complex* M,
+    float* Cr
+)
+{
+    cdf4sap_batch_data *h = (cdf4sap_batch_data*)(hBatch);
+
+    assert(h->isComplex && (Cr!=NULL || useEnergyFLAG));
+    if(nIdx<1)
+        return;
+    h->Cx = (void*)Cx;
+    h->Cy = (void*)Cy;
+    h->Q = (void*)Q;
+    h->M = (void*)M;
+    h->Cr = Cr;
+    h->batchIdx = batchIdx;
+    h->useEnergyFLAG = useEnergyFLAG;
+    h->reg = reg;
+    saf_parfor_run(h->hParFor, &cdf4sap_batch_solve, hBatch, nIdx);
+}
@@ -134,8 +134,9 @@ void cdf4sap_cmplx_destroy(/* Input Arguments */
  *                           FLAT: nXcols x nXcols
  * @param[in]  Cy            Target covariance matrix; FLAT: nXcols x nXcols
  * @param[in]  Q             Prototype matrix; FLAT: nYcols x nXcols
- * @param[in]  useEnergyFLAG Set to '0' to apply energy compensation to 'M'
- *                           instead of outputing 'Cr'. Set to '1' to output 'Cr'
+ * @param[in]  useEnergyFLAG Set to '1' to apply energy compensation to 'M'
+ *                           instead of outputing 'Cr' (which is then zeroed).
+ *                           Set to '0' to output 'Cr'
  * @param[in]  reg           Regularisation term (suggested: 0.2f)
  * @param[out] M             Mixing matrix; FLAT: nYcols x nXcols
  * @param[out] Cr            Mixing matrix residual; FLAT: nYcols x nYcols
@@ -186,9 +187,9 @@ void formulate_M_and_Cr(/* Input Arguments */
  *                           FLAT: nXcols x nXcols
  * @param[in]  Cy            Target covariance matrix; FLAT: nXcols x nXcols
  * @param[in]  Q             Prototype matrix; FLAT: nYcols x nXcols
- * @param[in]  useEnergyFLAG Set to '0' to apply energy compensation to 'M'
- *                           instead of outputing 'Cr'. Set to '1' to output
- *                           'Cr'
+ * @param[in]  useEnergyFLAG Set to '1' to apply energy compensation to 'M'
+ *                           instead of outputing 'Cr' (which is then zeroed).
+ *                           Set to '0' to output 'Cr'
  * @param[in]  reg           Regularisation term (suggested: 0.2f)
  * @param[out] M             Mixing matrix; FLAT: nYcols x nXcols
  * @param[out] Cr            Mixing matrix residual; FLAT: nYcols x nYcols
@@ -216,6 +217,231 @@ void formulate_M_and_Cr_cmplx(/* Input Arguments */
                               float_complex* M,
                               float* Cr);
 
+/**
+ * Enables/disables the incremental mode of formulate_M_and_Cr_cmplx()
+ *
+ * Successive (e.g. frame-to-frame) covariance matrices are often very similar.
+ * In the incremental mode, the decompositions of each call are warm-started
+ * from those of the previous call: the matrices are rotated by the previous
+ * eigenvectors, and the (then nearly diagonal) results are diagonalised with a
+ * few Jacobi sweeps. If a rotated matrix is further from diagonal than
+ * 'maxChange', or the sweeps do not converge, then the full decomposition is
+ * carried out instead. Therefore, the solution is equally valid either way.
+ *
+ * @note Since the warm-start uses the previous call, a handle should be used
+ *       for only one band in this mode; see also
+ *       cdf4sap_cmplx_batch_setIncrementalMode(). (Re-)enabling discards the
+ *       previous decompositions.
+ *
+ * @param[in] hCdf       Covariance Domain Framework handle
+ * @param[in] enableFLAG '1' incremental mode, '0' full solves (default)
+ * @param[in] maxChange  Maximum relative off-diagonal norm of the rotated
+ *                       matrices, for the warm-start to be used
+ *                       (suggested: 0.1f)
+ */
+void cdf4sap_cmplx_setIncrementalMode(/* Input Arguments */
+                                      void * const hCdf,
+                                      int enableFLAG,
+                                      float maxChange);
+
+
+/* ========================================================================== */
+/*                              Batched Functions                             */
+/* ========================================================================== */
+
+/**
+ * Creates an instance of the batched Covariance Domain Framework (REAL)
+ *
+ * The batch handle holds one (pre-allocated) solver per thread, such that the
+ * mixing matrices of many bands may be computed with a single call to
+ * formulate_M_and_Cr_batch(), without allocating any memory.
+ *
+ * @param[in] phBatch  The address (&) of the batched CDF4SAP handle
+ * @param[in] nXcols   Number of columns/rows in square input matrices 'Cx'
+ * @param[in] nYcols   Number of columns/rows in square input matrices 'Cy'
+ * @param[in] nThreads Number of threads to split the batches over; '1'
+ *                     single-threaded, or SAF_PARFOR_NUM_THREADS_AUTO
+ */
+void cdf4sap_batch_create(/* Input Arguments */
+                          void ** const phBatch,
+                          int nXcols,
+                          int nYcols,
+                          int nThreads);
+
+/**
+ * Creates an instance of the batched Covariance Domain Framework (COMPLEX)
+ *
+ * @param[in] phBatch  The address (&) of the batched CDF4SAP handle
+ * @param[in] nXcols   Number of columns/rows in square input matrices 'Cx'
+ * @param[in] nYcols   Number of columns/rows in square input matrices 'Cy'
+ * @param[in] nThreads Number of threads to split the batches over; '1'
+ *                     single-threaded, or SAF_PARFOR_NUM_THREADS_AUTO
+ */
+void cdf4sap_cmplx_batch_create(/* Input Arguments */
+                                void ** const phBatch,
+                                int nXcols,
+                                int nYcols,
+                                int nThreads);
+
+/**
+ * Destroys an instance of the batched Covariance Domain Framework (REAL)
+ *
+ * @param[in] phBatch The address (&) of the batched CDF4SAP handle
+ */
+void cdf4sap_batch_destroy(/* Input Arguments */
+                           void ** const phBatch);
+
+/**
+ * Destroys an instance of the batched Covariance Domain Framework (COMPLEX)
+ *
+ * @param[in] phBatch The address (&) of the batched CDF4SAP handle
+ */
+void cdf4sap_cmplx_batch_destroy(/* Input Arguments */
+                                 void ** const phBatch);
+
+/**
+ * Enables/disables the incremental mode (see
+ * cdf4sap_cmplx_setIncrementalMode()) for the batched solver (COMPLEX)
+ *
+ * The previous decompositions are kept separately for each of the first
+ * 'maxNumBatches' batches, so that each batch (e.g. band) is warm-started from
+ * its own previous solution.
+ *
+ * @note This function allocates memory, so it should not be called from the
+ *       audio thread.
+ *
+ * @param[in] hBatch        Batched Covariance Domain Framework handle
+ * @param[in] enableFLAG    '1' incremental mode, '0' full solves (default)
+ * @param[in] maxChange     Maximum relative off-diagonal norm of the rotated
+ *                          matrices, for the warm-start to be used
+ *                          (suggested: 0.1f)
+ * @param[in] maxNumBatches Number of batches to keep the states of
+ */
+void cdf4sap_cmplx_batch_setIncrementalMode(/* Input Arguments */
+                                            void * const hBatch,
+                                            int enableFLAG,
+                                            float maxChange,
+                                            int maxNumBatches);
+
+/**
+ * Computes the optimal mixing matrices for a batch of (e.g. frequency bands)
+ * covariance matrices (REAL); see formulate_M_and_Cr()
+ *
+ * The batches are split over the threads of the handle, and the results are
+ * identical to calling formulate_M_and_Cr() for each batch in turn.
+ *
+ * @note Does not allocate memory, so it may be called from the audio thread.
+ *
+ * @param[in]  hBatch        Batched Covariance Domain Framework handle
+ * @param[in]  Cx            Covariance matrices of input 'x';
+ *                           FLAT: nBatches x nXcols x nXcols
+ * @param[in]  Cy            Target covariance matrices;
+ *                           FLAT: nBatches x nYcols x nYcols
+ * @param[in]  Q             Prototype matrix (shared by all batches);
+ *                           FLAT: nYcols x nXcols
+ * @param[in]  useEnergyFLAG Set to '1' to apply energy compensation to 'M'
+ *                           instead of outputing 'Cr'. Set to '0' to output
+ *                           'Cr'
+ * @param[in]  reg           Regularisation term (suggested: 0.2f)
+ * @param[in]  nBatches      Number of batches
+ * @param[out] M             Mixing matrices; FLAT: nBatches x nYcols x nXcols
+ * @param[out] Cr            Mixing matrix residuals;
+ *                           FLAT: nBatches x nYcols x nYcols (may be NULL if
+ *                           useEnergyFLAG is '1')
+ */
+void formulate_M_and_Cr_batch(/* Input Arguments */
+                              void * const hBatch,
+                              float* Cx,
+                              float* Cy,
+                              float* Q,
+                              int useEnergyFLAG,
+                              float reg,
+                              int nBatches,
+                              /* Output Arguments */
+                              float* M,
+                              float* Cr);
+
+/**
+ * Computes the optimal mixing matrices for a batch of (e.g. frequency bands)
+ * covariance matrices (COMPLEX); see formulate_M_and_Cr_cmplx()
+ *
+ * The batches are split over the threads of the handle, and the results are
+ * identical to calling formulate_M_and_Cr_cmplx() for each batch in turn.
+ *
+ * @note Does not allocate memory, so it may be called from the audio thread.
+ *
+ * @param[in]  hBatch        Batched Covariance Domain Framework handle
+ * @param[in]  Cx            Covariance matrices of input 'x';
+ *                           FLAT: nBatches x nXcols x nXcols
+ * @param[in]  Cy            Target covariance matrices;
+ *                           FLAT: nBatches x nYcols x nYcols
+ * @param[in]  Q             Prototype matrix (shared by all batches);
+ *                           FLAT: nYcols x nXcols
+ * @param[in]  useEnergyFLAG Set to '1' to apply energy compensation to 'M'
+ *                           instead of outputing 'Cr'. Set to '0' to output
+ *                           'Cr'
+ * @param[in]  reg           Regularisation term (suggested: 0.2f)
+ * @param[in]  nBatches      Number of batches
+ * @param[out] M             Mixing matrices; FLAT: nBatches x nYcols x nXcols
+ * @param[out] Cr            Mixing matrix residuals;
+ *                           FLAT: nBatches x nYcols x nYcols (may be NULL if
+ *                           useEnergyFLAG is '1')
+ */
+void formulate_M_and_Cr_cmplx_batch(/* Input Arguments */
+                                    void * const hBatch,
+                                    float_complex* Cx,
+                                    float_complex* Cy,
+                                    float_complex* Q,
+                                    int useEnergyFLAG,
+                                    float reg,
+                                    int nBatches,
+                                    /* Output Arguments */
+                                    float_complex* M,
+                                    float* Cr);
+
+/**
+ * Computes the optimal mixing matrices (COMPLEX) for only some of the batches
+ * of formulate_M_and_Cr_cmplx_batch(); e.g. for those bands whose parameters
+ * are updated in the current frame
+ *
+ * The matrices are indexed as with formulate_M_and_Cr_cmplx_batch(), and the
+ * matrices of the batches that are not listed are left untouched. In the
+ * incremental mode, each batch is warm-started from its own previous solution,
+ * regardless of how often it is solved.
+ *
+ * @note Does not allocate memory, so it may be called from the audio thread.
+ *
+ * @param[in]  hBatch        Batched Covariance Domain Framework handle
+ * @param[in]  Cx            Covariance matrices of input 'x';
+ *                           FLAT: nBatches x nXcols x nXcols
+ * @param[in]  Cy            Target covariance matrices;
+ *                           FLAT: nBatches x nYcols x nYcols
+ * @param[in]  Q             Prototype matrix (shared by all batches);
+ *                           FLAT: nYcols x nXcols
+ * @param[in]  useEnergyFLAG Set to '1' to apply energy compensation to 'M'
+ *                           instead of outputing 'Cr'. Set to '0' to output
+ *                           'Cr'
+ * @param[in]  reg           Regularisation term (suggested: 0.2f)
+ * @param[in]  batchIdx      Indices of the batches to solve; nIdx x 1
+ * @param[in]  nIdx          Number of batches to solve
+ * @param[out] M             Mixing matrices; FLAT: nBatches x nYcols x nXcols
+ * @param[out] Cr            Mixing matrix residuals;
+ *                           FLAT: nBatches x nYcols x nYcols (may be NULL if
+ *                           useEnergyFLAG is '1')
+ */
+void formulate_M_and_Cr_cmplx_batchSubset(/* Input Arguments */
+                                          void * const hBatch,
+                                          float_complex* Cx,
+                                          float_complex* Cy,
+                                          float_complex* Q,
+                                          int useEnergyFLAG,
+                                          float reg,
+                                          const int* batchIdx,
+                                          int nIdx,
+                                          /* Output Arguments */
+                                          float_complex* M,
+                                          float* Cr);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -29,6 +29,12 @@
 
 #include "saf_hoa.h"
 #include "saf_hoa_internal.h"
+#include <stdint.h>
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
 
 void getRSH
 (
@@ -69,21 +75,18 @@ void getRSH_recur
     float* Y
 )
 {
-    int n, m, i, dir, index_n;
-    float Nn0, Nnm;
-    float* factorials_n, *leg_n, *leg_n_1, *leg_n_2, *sin_el;
+    int n, m, dir, index_n;
+    float Nnm;
+    float* leg_n, *leg_n_1, *leg_n_2, *sin_el;
+    double* norm_n;
     
-    factorials_n = malloc1d((2*N+1)*sizeof(float));
+    norm_n = malloc1d((N+1)*sizeof(double));
     leg_n = malloc1d((N+1)*nDirs * sizeof(float));
     leg_n_1 = calloc1d((N+1)*nDirs, sizeof(float));
     leg_n_2 = calloc1d((N+1)*nDirs, sizeof(float));
     sin_el = malloc1d(nDirs * sizeof(float));
     index_n = 0;
     
-    /* precompute factorials */
-    for (i = 0; i < 2*N+1; i++)
-        factorials_n[i] = (float)factorial(i);
-    
     /* cos(inclination) = sin(elevation) */
     for (dir = 0; dir<nDirs; dir++)
         sin_el[dir] = sinf(dirs_deg[dir*2+1] * M_PI/180.0f);
@@ -98,16 +101,16 @@ void getRSH_recur
         else {
             unnorm_legendreP_recur(n, sin_el, nDirs, leg_n_1, leg_n_2, leg_n); /* does NOT include Condon-Shortley phase term */
             
-            Nn0 = sqrtf(2.0f*(float)n+1.0f);
-            for (dir = 0; dir<nDirs; dir++){
-                for (m = 0; m<n+1; m++) {
-                    if (m==0)
-                        Y[(index_n+n)*nDirs+dir] = Nn0  * leg_n[m*nDirs+dir];
-                    else {
-                        Nnm = Nn0* sqrtf( 2.0f * factorials_n[n-m]/factorials_n[n+m] );
-                        Y[(index_n+n-m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * sinf((float)m * (dirs_deg[dir*2])*M_PI/180.0f);
-                        Y[(index_n+n+m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * cosf((float)m * (dirs_deg[dir*2])*M_PI/180.0f);
-                    }
+            /* (getSHnorm() includes the 1/sqrt(4*pi) term, which is removed here) */
+            getSHnorm(n, norm_n);
+            Nnm = (float)(sqrt(4.0*M_PI)*norm_n[0]);
+            for (dir = 0; dir<nDirs; dir++)
+                Y[(index_n+n)*nDirs+dir] = Nnm * leg_n[dir];
+            for (m = 1; m<n+1; m++) {
+                Nnm = (float)(sqrt(8.0*M_PI)*norm_n[m]);
+                for (dir = 0; dir<nDirs; dir++){
+                    Y[(index_n+n-m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * sinf((float)m * (dirs_deg[dir*2])*M_PI/180.0f);
+                    Y[(index_n+n+m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * cosf((float)m * (dirs_deg[dir*2])*M_PI/180.0f);
                 }
             }
             index_n += 2*n+1;
@@ -116,13 +119,153 @@ void getRSH_recur
         utility_svvcopy(leg_n,   (N+1)*nDirs, leg_n_1);
     }
     
-    free(factorials_n);
+    free(norm_n);
     free(leg_n);
     free(leg_n_1);
     free(leg_n_2);
     free(sin_el);
 }
 
+/**
+ * An entry of the shared steering matrix cache; keyed by the contents of the
+ * grid (rather than its address), the order, scaling, and type
+ */
+typedef struct _steeringMtxCache_entry {
+    int order;
+    int nDirs;
+    float scale;
+    int isComplex;
+    float* dirs_deg;                       /**< copy of the grid; FLAT: nDirs x 2 */
+    void* Y;                               /**< FLAT: (order+1)^2 x nDirs */
+    int refCount;
+    struct _steeringMtxCache_entry* next;
+}steeringMtxCache_entry;
+
+static steeringMtxCache_entry* steeringMtxCache_head = NULL;
+#if defined(_WIN32)
+static SRWLOCK steeringMtxCache_lock = SRWLOCK_INIT;
+# define STEERING_CACHE_LOCK()   AcquireSRWLockExclusive(&steeringMtxCache_lock)
+# define STEERING_CACHE_UNLOCK() ReleaseSRWLockExclusive(&steeringMtxCache_lock)
+#else
+static pthread_mutex_t steeringMtxCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define STEERING_CACHE_LOCK()   pthread_mutex_lock(&steeringMtxCache_lock)
+# define STEERING_CACHE_UNLOCK() pthread_mutex_unlock(&steeringMtxCache_lock)
+#endif
+
+/** Returns a shared (real or complex) steering matrix, creating it if needed */
+static void* steeringMtxCache_acquireType
+(
+    int order,
+    float* dirs_deg,
+    int nDirs,
+    float scale,
+    int isComplex
+)
+{
+    steeringMtxCache_entry* e;
+    int i, nSH;
+    float* Y_real;
+    float_complex* Y_cmplx;
+
+    STEERING_CACHE_LOCK();
+    for(e = steeringMtxCache_head; e!=NULL; e = e->next){
+        if(e->order==order && e->nDirs==nDirs && e->scale==scale && e->isComplex==isComplex &&
+           !memcmp(e->dirs_deg, dirs_deg, nDirs*2*sizeof(float))){
+            e->refCount++;
+            STEERING_CACHE_UNLOCK();
+            return e->Y;
+        }
+    }
+
+    /* not cached yet; (the lock is held while computing, so that two instances
+     * initialising at the same time do not both compute the same matrix) */
+    nSH = (order+1)*(order+1);
+    e = (steeringMtxCache_entry*)malloc1d(sizeof(steeringMtxCache_entry));
+    e->order = order;
+    e->nDirs = nDirs;
+    e->scale = scale;
+    e->isComplex = isComplex;
+    e->dirs_deg = malloc1d(nDirs*2*sizeof(float));
+    memcpy(e->dirs_deg, dirs_deg, nDirs*2*sizeof(float));
+    Y_real = malloc1d(nSH*nDirs*sizeof(float));
+    getRSH(order, dirs_deg, nDirs, Y_real);
+    utility_svsmul(Y_real, &scale, nSH*nDirs, NULL);
+    if(isComplex){
+        Y_cmplx = malloc1d(nSH*nDirs*sizeof(float_complex));
+        for(i=0; i<nSH*nDirs; i++)
+            Y_cmplx[i] = cmplxf(Y_real[i], 0.0f);
+        free(Y_real);
+        e->Y = (void*)Y_cmplx;
+    }
+    else
+        e->Y = (void*)Y_real;
+    e->refCount = 1;
+    e->next = steeringMtxCache_head;
+    steeringMtxCache_head = e;
+    STEERING_CACHE_UNLOCK();
+    return e->Y;
+}
+
+float* steeringMtxCache_acquire
+(
+    int order,
+    float* dirs_deg,
+    int nDirs,
+    float scale
+)
+{
+    return (float*)steeringMtxCache_acquireType(order, dirs_deg, nDirs, scale, 0);
+}
+
+float_complex* steeringMtxCache_acquireComplex
+(
+    int order,
+    float* dirs_deg,
+    int nDirs,
+    float scale
+)
+{
+    return (float_complex*)steeringMtxCache_acquireType(order, dirs_deg, nDirs, scale, 1);
+}
+
+void steeringMtxCache_release
+(
+    void** pY
+)
+{
+    steeringMtxCache_entry* e, **prev;
+
+    if(*pY==NULL)
+        return;
+    STEERING_CACHE_LOCK();
+    for(prev = &steeringMtxCache_head, e = steeringMtxCache_head; e!=NULL; prev = &(e->next), e = e->next){
+        if(e->Y==(*pY)){
+            if(--(e->refCount)==0){
+                *prev = e->next;
+                free(e->dirs_deg);
+                free(e->Y);
+                free(e);
+            }
+            break;
+        }
+    }
+    STEERING_CACHE_UNLOCK();
+    assert(e!=NULL); /* not acquired from the cache */
+    *pY = NULL;
+}
+
+int steeringMtxCache_getNumEntries(void)
+{
+    steeringMtxCache_entry* e;
+    int n;
+
+    STEERING_CACHE_LOCK();
+    for(n=0, e = steeringMtxCache_head; e!=NULL; e = e->next)
+        n++;
+    STEERING_CACHE_UNLOCK();
+    return n;
+}
+
 void getMaxREweights
 (
     int order,
@@ -192,7 +335,7 @@ void getLoudspeakerAmbiDecoderMtx
              * loudspeaker spherical harmonic matrix. */
             Y_ls = malloc1d(nSH*nLS*sizeof(float));
             getRSH(order, ls_dirs_deg, nLS, Y_ls);
-            utility_spinv(Y_ls, nSH, nLS, decMtx);
+            utility_spinv(NULL, Y_ls, nSH, nLS, decMtx);
             free(Y_ls);
             break;
             
@@ -221,6 +364,515 @@ void getLoudspeakerAmbiDecoderMtx
     }
 }
 
+/**
+ * An entry of the loudspeaker decoder cache; keyed by the contents of the
+ * layout, the method, order and maxrE option
+ */
+typedef struct _lsDecoderCache_entry {
+    int nLS, method, order, enableMaxrE;
+    float* ls_dirs_deg;                    /**< copy of the layout; FLAT: nLS x 2 */
+    float* decMtx;                         /**< FLAT: nLS x (order+1)^2 */
+    struct _lsDecoderCache_entry* next;
+}lsDecoderCache_entry;
+
+/* Most recently used first */
+static lsDecoderCache_entry* lsDecoderCache_head = NULL;
+static char* lsDecoderCache_diskDir = NULL;
+#if defined(_WIN32)
+static SRWLOCK lsDecoderCache_lock = SRWLOCK_INIT;
+# define LS_DECODER_CACHE_LOCK()   AcquireSRWLockExclusive(&lsDecoderCache_lock)
+# define LS_DECODER_CACHE_UNLOCK() ReleaseSRWLockExclusive(&lsDecoderCache_lock)
+#else
+static pthread_mutex_t lsDecoderCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define LS_DECODER_CACHE_LOCK()   pthread_mutex_lock(&lsDecoderCache_lock)
+# define LS_DECODER_CACHE_UNLOCK() pthread_mutex_unlock(&lsDecoderCache_lock)
+#endif
+
+/* Current version of the on-disk cache file format */
+#define LS_DECODER_CACHE_FILE_VERSION ( 1 )
+/* Maximum length of an on-disk cache file path */
+#define LS_DECODER_CACHE_MAX_PATH_LENGTH ( 4096 )
+
+/**
+ * Header of an on-disk cache file, which is followed by: ls_dirs_deg and
+ * decMtx (stored in native byte order)
+ */
+typedef struct _lsDecoderCache_fileHeader {
+    char magic[8];           /**< "SAFLSDC" */
+    uint32_t version;        /**< LS_DECODER_CACHE_FILE_VERSION */
+    int32_t nLS, method, order, enableMaxrE;
+    uint32_t reserved;
+    uint64_t key;            /**< hash of the layout and the settings */
+    uint64_t checksum;       /**< hash of the data following the header */
+
+}lsDecoderCache_fileHeader;
+
+/** Updates a 64-bit FNV-1a hash with 'nBytes' of data */
+static uint64_t lsDecoderCache_hash
+(
+    uint64_t hash,
+    const void* data,
+    size_t nBytes
+)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i;
+
+    for(i=0; i<nBytes; i++){
+        hash ^= (uint64_t)bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/** Returns the key of an entry, which is also used for its cache file name */
+static uint64_t lsDecoderCache_getKey
+(
+    lsDecoderCache_entry* e
+)
+{
+    uint64_t key;
+    int version;
+
+    version = LS_DECODER_CACHE_FILE_VERSION;
+    key = 14695981039346656037ULL; /* FNV offset basis */
+    key = lsDecoderCache_hash(key, &version, sizeof(int));
+    key = lsDecoderCache_hash(key, &(e->nLS), sizeof(int));
+    key = lsDecoderCache_hash(key, &(e->method), sizeof(int));
+    key = lsDecoderCache_hash(key, &(e->order), sizeof(int));
+    key = lsDecoderCache_hash(key, &(e->enableMaxrE), sizeof(int));
+    key = lsDecoderCache_hash(key, e->ls_dirs_deg, e->nLS*2*sizeof(float));
+    return key;
+}
+
+/** Returns the path of the on-disk cache file for a given key */
+static void lsDecoderCache_getFilePath
+(
+    uint64_t key,
+    char* path
+)
+{
+    snprintf(path, LS_DECODER_CACHE_MAX_PATH_LENGTH, "%s/saf_lsdec_%016llx.bin",
+             lsDecoderCache_diskDir, (unsigned long long)key);
+}
+
+/**
+ * Loads the decoder of an entry from an on-disk cache file
+ *
+ * @returns 1 if the file exists and is valid, 0 otherwise
+ */
+static int lsDecoderCache_readFile
+(
+    lsDecoderCache_entry* e,
+    uint64_t key
+)
+{
+    lsDecoderCache_fileHeader header;
+    char path[LS_DECODER_CACHE_MAX_PATH_LENGTH];
+    FILE* file;
+    float* ls_dirs_deg;
+    size_t nDec;
+    int ok;
+
+    lsDecoderCache_getFilePath(key, path);
+    if((file = fopen(path, "rb"))==NULL)
+        return 0;
+    ok = fread(&header, sizeof(lsDecoderCache_fileHeader), 1, file) == 1 &&
+         !memcmp(header.magic, "SAFLSDC", 8) &&
+         header.version == LS_DECODER_CACHE_FILE_VERSION &&
+         header.key == key && header.nLS == e->nLS && header.method == e->method &&
+         header.order == e->order && header.enableMaxrE == e->enableMaxrE;
+    if(!ok){
+        fclose(file);
+        return 0;
+    }
+    nDec = (size_t)e->nLS * (e->order+1)*(e->order+1);
+    ls_dirs_deg = malloc1d(e->nLS*2*sizeof(float));
+    ok = fread(ls_dirs_deg, sizeof(float), e->nLS*2, file) == (size_t)(e->nLS*2) &&
+         fread(e->decMtx, sizeof(float), nDec, file) == nDec;
+    fclose(file);
+    ok = ok && !memcmp(ls_dirs_deg, e->ls_dirs_deg, e->nLS*2*sizeof(float)) &&
+         lsDecoderCache_hash(lsDecoderCache_hash(14695981039346656037ULL, ls_dirs_deg, e->nLS*2*sizeof(float)),
+                             e->decMtx, nDec*sizeof(float)) == header.checksum;
+    free(ls_dirs_deg);
+    return ok;
+}
+
+/**
+ * Saves the decoder of an entry to an on-disk cache file (failures are
+ * ignored, since the cache file is only an optimisation)
+ */
+static void lsDecoderCache_writeFile
+(
+    lsDecoderCache_entry* e,
+    uint64_t key
+)
+{
+    lsDecoderCache_fileHeader header;
+    char path[LS_DECODER_CACHE_MAX_PATH_LENGTH], tmpPath[LS_DECODER_CACHE_MAX_PATH_LENGTH+8];
+    FILE* file;
+    size_t nDec;
+    int ok;
+
+    nDec = (size_t)e->nLS * (e->order+1)*(e->order+1);
+    memset(&header, 0, sizeof(lsDecoderCache_fileHeader));
+    memcpy(header.magic, "SAFLSDC", 8);
+    header.version = LS_DECODER_CACHE_FILE_VERSION;
+    header.nLS = e->nLS;
+    header.method = e->method;
+    header.order = e->order;
+    header.enableMaxrE = e->enableMaxrE;
+    header.key = key;
+    header.checksum = lsDecoderCache_hash(14695981039346656037ULL, e->ls_dirs_deg, e->nLS*2*sizeof(float));
+    header.checksum = lsDecoderCache_hash(header.checksum, e->decMtx, nDec*sizeof(float));
+
+    /* write to a temporary file first, and then rename it; such that other
+     * processes never read a partially written file */
+    lsDecoderCache_getFilePath(key, path);
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    if((file = fopen(tmpPath, "wb"))==NULL)
+        return;
+    ok = fwrite(&header, sizeof(lsDecoderCache_fileHeader), 1, file) == 1 &&
+         fwrite(e->ls_dirs_deg, sizeof(float), e->nLS*2, file) == (size_t)(e->nLS*2) &&
+         fwrite(e->decMtx, sizeof(float), nDec, file) == nDec;
+    ok = fclose(file) == 0 && ok;
+    remove(path);
+    if(!ok || rename(tmpPath, path)!=0)
+        remove(tmpPath);
+}
+
+/** Frees an entry of the loudspeaker decoder cache */
+static void lsDecoderCache_freeEntry
+(
+    lsDecoderCache_entry* e
+)
+{
+    free(e->ls_dirs_deg);
+    free(e->decMtx);
+    free(e);
+}
+
+void getLoudspeakerAmbiDecoderMtxCached
+(
+    float* ls_dirs_deg,
+    int nLS,
+    LOUDSPEAKER_AMBI_DECODER_METHODS method,
+    int order,
+    int enableMaxReWeighting,
+    float* decMtx
+)
+{
+    lsDecoderCache_entry* e, *tail, **prev;
+    int n, nSH;
+    uint64_t key;
+
+    nSH = (order+1)*(order+1);
+    enableMaxReWeighting = enableMaxReWeighting ? 1 : 0;
+    LS_DECODER_CACHE_LOCK();
+    for(prev = &lsDecoderCache_head, e = lsDecoderCache_head; e!=NULL; prev = &(e->next), e = e->next){
+        if(e->nLS==nLS && e->method==(int)method && e->order==order && e->enableMaxrE==enableMaxReWeighting &&
+           !memcmp(e->ls_dirs_deg, ls_dirs_deg, nLS*2*sizeof(float))){
+            /* move to the front */
+            *prev = e->next;
+            e->next = lsDecoderCache_head;
+            lsDecoderCache_head = e;
+            memcpy(decMtx, e->decMtx, nLS*nSH*sizeof(float));
+            LS_DECODER_CACHE_UNLOCK();
+            return;
+        }
+    }
+
+    /* not cached yet; (the lock is held while computing, so that two instances
+     * initialising at the same time do not both compute the same decoder) */
+    e = (lsDecoderCache_entry*)malloc1d(sizeof(lsDecoderCache_entry));
+    e->nLS = nLS;
+    e->method = (int)method;
+    e->order = order;
+    e->enableMaxrE = enableMaxReWeighting;
+    e->ls_dirs_deg = malloc1d(nLS*2*sizeof(float));
+    memcpy(e->ls_dirs_deg, ls_dirs_deg, nLS*2*sizeof(float));
+    e->decMtx = malloc1d(nLS*nSH*sizeof(float));
+    key = lsDecoderCache_getKey(e);
+    if(lsDecoderCache_diskDir==NULL || !lsDecoderCache_readFile(e, key)){
+        getLoudspeakerAmbiDecoderMtx(ls_dirs_deg, nLS, method, order, enableMaxReWeighting, e->decMtx);
+        if(lsDecoderCache_diskDir!=NULL)
+            lsDecoderCache_writeFile(e, key);
+    }
+    memcpy(decMtx, e->decMtx, nLS*nSH*sizeof(float));
+    e->next = lsDecoderCache_head;
+    lsDecoderCache_head = e;
+
+    /* discard the least recently used decoder(s) */
+    for(n=1, e = lsDecoderCache_head; e!=NULL && n<LOUDSPEAKER_DECODER_CACHE_MAX_ENTRIES; n++)
+        e = e->next;
+    if(e!=NULL){
+        tail = e->next;
+        e->next = NULL;
+        while(tail!=NULL){
+            e = tail;
+            tail = tail->next;
+            lsDecoderCache_freeEntry(e);
+        }
+    }
+    LS_DECODER_CACHE_UNLOCK();
+}
+
+void loudspeakerDecoderCache_setDiskCacheDirectory
+(
+    char* directory
+)
+{
+    LS_DECODER_CACHE_LOCK();
+    free(lsDecoderCache_diskDir);
+    lsDecoderCache_diskDir = NULL;
+    if(directory!=NULL){
+        lsDecoderCache_diskDir = malloc1d((strlen(directory)+1)*sizeof(char));
+        strcpy(lsDecoderCache_diskDir, directory);
+    }
+    LS_DECODER_CACHE_UNLOCK();
+}
+
+void loudspeakerDecoderCache_clear(void)
+{
+    lsDecoderCache_entry* e;
+
+    LS_DECODER_CACHE_LOCK();
+    while(lsDecoderCache_head!=NULL){
+        e = lsDecoderCache_head;
+        lsDecoderCache_head = e->next;
+        lsDecoderCache_freeEntry(e);
+    }
+    LS_DECODER_CACHE_UNLOCK();
+}
+
+int loudspeakerDecoderCache_getNumEntries(void)
+{
+    lsDecoderCache_entry* e;
+    int n;
+
+    LS_DECODER_CACHE_LOCK();
+    for(n=0, e = lsDecoderCache_head; e!=NULL; e = e->next)
+        n++;
+    LS_DECODER_CACHE_UNLOCK();
+    return n;
+}
+
+/**
+ * Job shared by the threads of diffCovMatching_run(); each thread allocates its
+ * own scratch and linear algebra workspaces, which it then reuses for all of
+ * its bands
+ */
+typedef struct _diffCovMatching_job {
+    int N_dirs, nSH;
+    const float_complex* hrtfs;  /**< FLAT: N_bands x NUM_EARS x N_dirs */
+    const float* w;              /**< integration weights; N_dirs x 1 */
+    const float_complex* Y_na;   /**< FLAT: nSH x N_dirs */
+    float_complex* decMtx;       /**< FLAT: N_bands x NUM_EARS x nSH */
+
+}diffCovMatching_job;
+
+/**
+ * Upper Cholesky factor of a 2x2 Hermitian matrix, in closed form; returns the
+ * same factor as utility_cchol() (and zeros if C is not positive definite)
+ */
+static void diffCovMatching_chol
+(
+    float_complex C[NUM_EARS][NUM_EARS],
+    float_complex X[NUM_EARS][NUM_EARS]
+)
+{
+    float a, d, s;
+    
+    a = crealf(C[0][0]);
+    d = a>0.0f ? crealf(C[1][1]) - (crealf(C[0][1])*crealf(C[0][1]) + cimagf(C[0][1])*cimagf(C[0][1]))/a : 0.0f;
+    X[1][0] = cmplxf(0.0f, 0.0f);
+    if(a>0.0f && d>0.0f){
+        s = sqrtf(a);
+        X[0][0] = cmplxf(s, 0.0f);
+        X[0][1] = crmulf(C[0][1], 1.0f/s);
+        X[1][1] = cmplxf(sqrtf(d), 0.0f);
+    }
+    else{
+        X[0][0] = X[0][1] = X[1][1] = cmplxf(0.0f, 0.0f);
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_CHOL);
+#endif
+    }
+}
+
+/** H_W = H diag(w), for both ears; FLAT: NUM_EARS x N_dirs */
+static void diffCovMatching_applyWeights
+(
+    const float_complex* H,
+    const float* w,
+    int N_dirs,
+    float_complex* H_W
+)
+{
+    int i, j;
+    const float* h = (const float*)H;
+    float* h_w = (float*)H_W;
+    
+    for(i=0; i<NUM_EARS; i++){
+        for(j=0; j<N_dirs; j++){
+            h_w[2*(i*N_dirs+j)]   = h[2*(i*N_dirs+j)]   * w[j];
+            h_w[2*(i*N_dirs+j)+1] = h[2*(i*N_dirs+j)+1] * w[j];
+        }
+    }
+}
+
+/**
+ * Applies the diffuse-field coherence matching to the bands [first, last)
+ *
+ * All of the decompositions are of 2x2 matrices, and are therefore done in
+ * closed form: the Cholesky factors X and X_ambi of the reference and ambisonic
+ * diffuse covariance matrices; and the unitary factor V U^H of the SVD of
+ * X_ambi^H X = U S V^H, which is the unitary polar factor of B = X^H X_ambi:
+ *     Q = (B + e^(i arg(det B)) adj(B)^H) / sqrt(||B||_F^2 + 2|det B|).
+ * The mixing matrix is then M = X_ambi^-1 Q X.
+ */
+static void diffCovMatching_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    diffCovMatching_job* job = (diffCovMatching_job*)(hCtx);
+    int i, j, k, nSH, N_dirs, band;
+    float nrm, absDet;
+    float_complex* H_W, *H_ambi, *D;
+    float_complex C_ref[NUM_EARS][NUM_EARS], C_ambi[NUM_EARS][NUM_EARS];
+    float_complex X[NUM_EARS][NUM_EARS], X_ambi[NUM_EARS][NUM_EARS];
+    float_complex B[NUM_EARS][NUM_EARS], Q[NUM_EARS][NUM_EARS];
+    float_complex QX[NUM_EARS][NUM_EARS], M[NUM_EARS][NUM_EARS];
+    float_complex det, phase, d0, d1;
+    const float_complex* H;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    (void)threadIndex;
+
+    nSH = job->nSH;
+    N_dirs = job->N_dirs;
+    H_W = malloc1d(NUM_EARS*N_dirs*sizeof(float_complex));
+    H_ambi = malloc1d(NUM_EARS*N_dirs*sizeof(float_complex));
+    for(band=first; band<last; band++){
+        H = &(job->hrtfs[band*NUM_EARS*N_dirs]);
+        D = &(job->decMtx[band*NUM_EARS*nSH]);
+
+        /* Diffuse-field responses (W is diagonal; applied to the interleaved
+         * real and imaginary parts) */
+        diffCovMatching_applyWeights(H, job->w, N_dirs, H_W);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, NUM_EARS, NUM_EARS, N_dirs, &calpha,
+                    H_W, N_dirs,
+                    H, N_dirs, &cbeta,
+                    (float_complex*)C_ref, NUM_EARS);
+        diffCovMatching_chol(C_ref, X);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, N_dirs, nSH, &calpha,
+                    D, nSH,
+                    job->Y_na, N_dirs, &cbeta,
+                    H_ambi, N_dirs);
+        diffCovMatching_applyWeights(H_ambi, job->w, N_dirs, H_W);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, NUM_EARS, NUM_EARS, N_dirs, &calpha,
+                    H_W, N_dirs,
+                    H_ambi, N_dirs, &cbeta,
+                    (float_complex*)C_ambi, NUM_EARS);
+        diffCovMatching_chol(C_ambi, X_ambi);
+        
+        /* B = X^H X_ambi, and its unitary polar factor Q (= V U^H) */
+        for(i=0; i<NUM_EARS; i++)
+            for(j=0; j<NUM_EARS; j++)
+                B[i][j] = ccaddf(ccmulf(conjf(X[0][i]), X_ambi[0][j]), ccmulf(conjf(X[1][i]), X_ambi[1][j]));
+        det = ccsubf(ccmulf(B[0][0], B[1][1]), ccmulf(B[0][1], B[1][0]));
+        absDet = cabsf(det);
+        phase = absDet>0.0f ? crmulf(det, 1.0f/absDet) : cmplxf(1.0f, 0.0f);
+        for(i=0, nrm=0.0f; i<NUM_EARS; i++)
+            for(j=0; j<NUM_EARS; j++)
+                nrm += crealf(B[i][j])*crealf(B[i][j]) + cimagf(B[i][j])*cimagf(B[i][j]);
+        nrm = sqrtf(nrm + 2.0f*absDet);
+        if(nrm>0.0f){
+            Q[0][0] = crmulf(ccaddf(B[0][0], ccmulf(phase, conjf(B[1][1]))), 1.0f/nrm);
+            Q[0][1] = crmulf(ccsubf(B[0][1], ccmulf(phase, conjf(B[1][0]))), 1.0f/nrm);
+            Q[1][0] = crmulf(ccsubf(B[1][0], ccmulf(phase, conjf(B[0][1]))), 1.0f/nrm);
+            Q[1][1] = crmulf(ccaddf(B[1][1], ccmulf(phase, conjf(B[0][0]))), 1.0f/nrm);
+        }
+        else{
+            Q[0][0] = Q[1][1] = cmplxf(1.0f, 0.0f);
+            Q[0][1] = Q[1][0] = cmplxf(0.0f, 0.0f);
+        }
+        
+        /* M = X_ambi^-1 Q X (X_ambi is upper triangular) */
+        for(i=0; i<NUM_EARS; i++)
+            for(j=0; j<NUM_EARS; j++)
+                QX[i][j] = ccaddf(ccmulf(Q[i][0], X[0][j]), ccmulf(Q[i][1], X[1][j]));
+        if(crealf(X_ambi[0][0])>0.0f && crealf(X_ambi[1][1])>0.0f){
+            for(j=0; j<NUM_EARS; j++){
+                M[1][j] = crmulf(QX[1][j], 1.0f/crealf(X_ambi[1][1]));
+                M[0][j] = crmulf(ccsubf(QX[0][j], ccmulf(X_ambi[0][1], M[1][j])), 1.0f/crealf(X_ambi[0][0]));
+            }
+        }
+        else /* singular, as utility_cglslv() */
+            memset(M, 0, NUM_EARS*NUM_EARS*sizeof(float_complex));
+        
+        /* apply matching: D = M^H D */
+        for(k=0; k<nSH; k++){
+            d0 = D[0*nSH+k];
+            d1 = D[1*nSH+k];
+            D[0*nSH+k] = ccaddf(ccmulf(conjf(M[0][0]), d0), ccmulf(conjf(M[1][0]), d1));
+            D[1*nSH+k] = ccaddf(ccmulf(conjf(M[0][1]), d0), ccmulf(conjf(M[1][1]), d1));
+        }
+    }
+
+    free(H_W);
+    free(H_ambi);
+}
+
+/** applyDiffCovMatching(), with the bands split over the threads of 'hPar' */
+static void diffCovMatching_run
+(
+    void* const hPar,
+    float_complex* hrtfs,
+    float* hrtf_dirs_deg,
+    int N_dirs,
+    int N_bands,
+    int order,
+    float* weights,
+    float_complex* decMtx
+)
+{
+    int i, nSH;
+    float* Y_tmp, *w;
+    float_complex* Y_na;
+    diffCovMatching_job job;
+    
+    nSH = (order+1)*(order+1);
+    
+    /* integration weights */
+    w = malloc1d(N_dirs*sizeof(float));
+    for(i=0; i<N_dirs; i++)
+        w[i] = weights!=NULL ? weights[i] : 1.0f/(float)N_dirs;
+    
+    /* SH */
+    Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
+    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
+    for(i=0; i<nSH*N_dirs; i++)
+        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
+    free(Y_tmp);
+    
+    /* apply diffuse-field coherence matching per band */
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_na = Y_na;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &diffCovMatching_range, (void*)&job, N_bands-1 /* skip Nyquist */);
+    
+    free(w);
+    free(Y_na);
+}
+
 void getBinauralAmbiDecoderMtx
 (
     float_complex* hrtfs,
@@ -236,6 +888,28 @@ void getBinauralAmbiDecoderMtx
     int enableMaxReWeighting,
     float_complex* decMtx
 )
+{
+    getBinauralAmbiDecoderMtxParallel(NULL, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, method,
+                                      order, freqVector, itd_s, weights, enableDiffCovMatching,
+                                      enableMaxReWeighting, decMtx);
+}
+
+void getBinauralAmbiDecoderMtxParallel
+(
+    void* const hPar,
+    float_complex* hrtfs,
+    float* hrtf_dirs_deg,
+    int N_dirs,
+    int N_bands,
+    BINAURAL_AMBI_DECODER_METHODS method,
+    int order,
+    float* freqVector,
+    float* itd_s,
+    float* weights,
+    int enableDiffCovMatching,
+    int enableMaxReWeighting,
+    float_complex* decMtx
+)
 {
     int i, k, nSH;
     float *tmp;
@@ -248,23 +922,23 @@ void getBinauralAmbiDecoderMtx
         default:
         case BINAURAL_DECODER_DEFAULT:
         case BINAURAL_DECODER_LS:
-            getBinDecoder_LS(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
+            getBinDecoder_LS(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
             break;
             
         case BINAURAL_DECODER_LSDIFFEQ:
-            getBinDecoder_LSDIFFEQ(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
+            getBinDecoder_LSDIFFEQ(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
             break;
             
         case BINAURAL_DECODER_SPR:
-            getBinDecoder_SPR(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
+            getBinDecoder_SPR(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
             break;
             
         case BINAURAL_DECODER_TA:
-            getBinDecoder_TA(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, freqVector, itd_s, weights, decMtx);
+            getBinDecoder_TA(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, freqVector, itd_s, weights, decMtx);
             break;
             
         case BINAURAL_DECODER_MAGLS:
-            getBinDecoder_MAGLS(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, freqVector, weights, decMtx);
+            getBinDecoder_MAGLS(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, freqVector, weights, decMtx);
             break;
     }
     
@@ -290,7 +964,7 @@ void getBinauralAmbiDecoderMtx
     
     /* apply diffuse-field coherence matching per bin */
     if(enableDiffCovMatching)
-        applyDiffCovMatching(hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
+        diffCovMatching_run(hPar, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
 }
 
 void getBinauralAmbiDecoderFilters
@@ -354,96 +1028,6 @@ void applyDiffCovMatching
     float_complex* decMtx
 )
 {
-    int i, nSH, band;
-    float* Y_tmp;
-    float_complex* W, *Y_na, *H_W, *H_ambi, *decMtx_diffMatched;
-    float_complex C_ref[NUM_EARS][NUM_EARS], C_ambi[NUM_EARS][NUM_EARS];
-    float_complex X[NUM_EARS][NUM_EARS], X_ambi[NUM_EARS][NUM_EARS];
-    float_complex XH_Xambi[NUM_EARS][NUM_EARS], U[NUM_EARS][NUM_EARS];
-    float_complex V[NUM_EARS][NUM_EARS], UX[NUM_EARS][NUM_EARS];
-    float_complex VUX[NUM_EARS][NUM_EARS], M[NUM_EARS][NUM_EARS];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
-    nSH = (order+1)*(order+1);
-    
-    /* integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float_complex));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(weights[i], 0.0f);
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(1.0f/(float)N_dirs, 0.0f);
-    
-    /* SH */
-    Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
-    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
-    getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
-    for(i=0; i<nSH*N_dirs; i++)
-        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
-    free(Y_tmp);
-    
-    /* apply diffuse-field coherence matching per band */
-    H_W = malloc1d(NUM_EARS*N_dirs*sizeof(float_complex));
-    H_ambi = malloc1d(NUM_EARS*N_dirs*sizeof(float_complex));
-    decMtx_diffMatched = malloc1d(NUM_EARS*nSH*sizeof(float_complex));
-    for(band=0; band<N_bands-1 /* skip Nyquist */; band++){
-        /* Diffuse-field responses */
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, N_dirs, N_dirs, &calpha,
-                    &hrtfs[band*NUM_EARS*N_dirs], N_dirs,
-                    W, N_dirs, &cbeta,
-                    H_W, N_dirs);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, NUM_EARS, NUM_EARS, N_dirs, &calpha,
-                    H_W, N_dirs,
-                    &hrtfs[band*NUM_EARS*N_dirs], N_dirs, &cbeta,
-                    (float_complex*)C_ref, NUM_EARS);
-        for(i=0; i<NUM_EARS; i++)
-            C_ref[i][i] = cmplxf(crealf(C_ref[i][i]), 0.0f); /* force diagonal to be real */
-        utility_cchol((float_complex*)C_ref, NUM_EARS, (float_complex*)X);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, N_dirs, nSH, &calpha,
-                    &decMtx[band*NUM_EARS*nSH], nSH,
-                    Y_na, N_dirs, &cbeta,
-                    H_ambi, N_dirs);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, N_dirs, N_dirs, &calpha,
-                    H_ambi, N_dirs,
-                    W, N_dirs, &cbeta,
-                    H_W, N_dirs);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, NUM_EARS, NUM_EARS, N_dirs, &calpha,
-                    H_W, N_dirs,
-                    H_ambi, N_dirs, &cbeta,
-                    (float_complex*)C_ambi, NUM_EARS);
-        for(i=0; i<NUM_EARS; i++)
-            C_ambi[i][i] = cmplxf(crealf(C_ambi[i][i]), 0.0f); /* force diagonal to be real */
-        utility_cchol((float_complex*)C_ambi, NUM_EARS, (float_complex*)X_ambi);
-        
-        /* SVD */
-        cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, NUM_EARS, NUM_EARS, NUM_EARS, &calpha,
-                    (float_complex*)X_ambi, NUM_EARS,
-                    (float_complex*)X, NUM_EARS, &cbeta,
-                    (float_complex*)XH_Xambi, NUM_EARS);
-        utility_csvd((float_complex*)XH_Xambi, NUM_EARS, NUM_EARS, (float_complex*)U, NULL, (float_complex*)V, NULL);
-        
-        /* apply matching */
-        cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, NUM_EARS, NUM_EARS, NUM_EARS, &calpha,
-                    (float_complex*)U, NUM_EARS,
-                    (float_complex*)X, NUM_EARS, &cbeta,
-                    (float_complex*)UX, NUM_EARS);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, NUM_EARS, NUM_EARS, &calpha,
-                    (float_complex*)V, NUM_EARS,
-                    (float_complex*)UX, NUM_EARS, &cbeta,
-                    (float_complex*)VUX, NUM_EARS);
-        utility_cglslv((float_complex*)X_ambi, NUM_EARS, (float_complex*)VUX, NUM_EARS, (float_complex*)M);
-        cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, NUM_EARS, nSH, NUM_EARS, &calpha,
-                    (float_complex*)M, NUM_EARS,
-                    &decMtx[band*NUM_EARS*nSH], nSH, &cbeta,
-                    decMtx_diffMatched, nSH);
-        memcpy(&decMtx[band*NUM_EARS*nSH], decMtx_diffMatched, NUM_EARS*nSH*sizeof(float_complex));
-    }
-    
-    free(W);
-    free(Y_na);
-    free(H_W);
-    free(H_ambi);
-    free(decMtx_diffMatched);
+    diffCovMatching_run(NULL, hrtfs, hrtf_dirs_deg, N_dirs, N_bands, order, weights, decMtx);
 }
  
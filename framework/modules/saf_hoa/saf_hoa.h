@@ -212,6 +212,67 @@ void getRSH_recur(/* Input Arguments */
                   /* Output Arguments */
                   float* Y);
 
+/**
+ * Returns a REAL spherical harmonic steering matrix for a scanning grid (i.e.
+ * scale*getRSH()), which is shared by all callers requesting the same order,
+ * grid, and scaling (reference-counted)
+ *
+ * This is intended for e.g. several powermap instances scanning the same
+ * (dense) grid, which then hold only one copy of the matrix between them.
+ * Grids are compared by their contents, not their address.
+ *
+ * @note The matrix must not be modified, and must be returned with
+ *       steeringMtxCache_release() (it is freed once it has been released by
+ *       all of its users). This function is thread-safe, but may block while
+ *       another thread computes a new matrix; so do not call it from the audio
+ *       thread.
+ *
+ * @param[in] order    Order of spherical harmonic expansion
+ * @param[in] dirs_deg Grid directions [azi, ELEVATION] convention, in DEGREES;
+ *                     FLAT: nDirs x 2
+ * @param[in] nDirs    Number of grid directions
+ * @param[in] scale    Scaling applied to the SH weights (e.g. 1.0f for N3D)
+ * @returns   The shared steering matrix [WITHOUT the 1/sqrt(4*pi) term, and
+ *            multiplied by 'scale']; FLAT: (order+1)^2 x nDirs
+ */
+float* steeringMtxCache_acquire(/* Input Arguments */
+                                int order,
+                                float* dirs_deg,
+                                int nDirs,
+                                float scale);
+
+/**
+ * Returns a shared REAL spherical harmonic steering matrix, which is stored as
+ * a complex matrix (with zero imaginary parts); see steeringMtxCache_acquire()
+ *
+ * @param[in] order    Order of spherical harmonic expansion
+ * @param[in] dirs_deg Grid directions [azi, ELEVATION] convention, in DEGREES;
+ *                     FLAT: nDirs x 2
+ * @param[in] nDirs    Number of grid directions
+ * @param[in] scale    Scaling applied to the SH weights
+ * @returns   The shared steering matrix; FLAT: (order+1)^2 x nDirs
+ */
+float_complex* steeringMtxCache_acquireComplex(/* Input Arguments */
+                                               int order,
+                                               float* dirs_deg,
+                                               int nDirs,
+                                               float scale);
+
+/**
+ * Releases a steering matrix returned by steeringMtxCache_acquire() or
+ * steeringMtxCache_acquireComplex(); and sets the pointer to NULL
+ *
+ * @param[in] pY (&) address of the steering matrix (may point to NULL)
+ */
+void steeringMtxCache_release(/* Input Arguments */
+                              void** pY);
+
+/**
+ * Returns the number of distinct steering matrices currently held by the
+ * cache
+ */
+int steeringMtxCache_getNumEntries(void);
+
 /**
  * Computes the weights required to manipulate a hyper-cardioid beam-pattern,
  * such that it has maximum energy in the given look-direction
@@ -262,6 +323,67 @@ void getLoudspeakerAmbiDecoderMtx(/* Input Arguments */
                                   /* Output Arguments */
                                   float* decMtx);
 
+/**
+ * Returns an ambisonic decoding matrix (the same as
+ * getLoudspeakerAmbiDecoderMtx()), which is taken from a process-wide cache if
+ * the same loudspeaker directions, method, order and maxrE option have been
+ * requested before
+ *
+ * This is intended for e.g. when switching back and forth between loudspeaker
+ * presets, or reopening a session, since AllRAD and EPAD decoders of higher
+ * orders take a noticeable time to compute. Layouts are compared by their
+ * contents, not their address. The least recently used decoders are discarded
+ * once the cache holds LOUDSPEAKER_DECODER_CACHE_MAX_ENTRIES of them.
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       computes a new decoder; so do not call it from the audio thread.
+ *
+ * @param[in]  ls_dirs_deg Loudspeaker directions in DEGREES [azi elev];
+ *                         FLAT: nLS x 2
+ * @param[in]  nLS         Number of loudspeakers
+ * @param[in]  method      Decoding method
+ *                         (see "LOUDSPEAKER_AMBI_DECODER_METHODS" enum)
+ * @param[in]  order       Decoding order
+ * @param[in]  enableMaxrE Set to '0' to disable, '1' to enable
+ * @param[out] decMtx      Decoding matrix; FLAT: nLS x (order+1)^2
+ */
+void getLoudspeakerAmbiDecoderMtxCached(/* Input Arguments */
+                                        float* ls_dirs_deg,
+                                        int nLS,
+                                        LOUDSPEAKER_AMBI_DECODER_METHODS method,
+                                        int order,
+                                        int enableMaxrE,
+                                        /* Output Arguments */
+                                        float* decMtx);
+
+/** Maximum number of decoders held by getLoudspeakerAmbiDecoderMtxCached() */
+#define LOUDSPEAKER_DECODER_CACHE_MAX_ENTRIES ( 64 )
+
+/**
+ * Enables (or disables) the on-disk loudspeaker decoder cache
+ *
+ * When enabled, getLoudspeakerAmbiDecoderMtxCached() looks for a cache file in
+ * the given directory before computing a decoder that is not held in memory;
+ * and writes one after computing it. The files are keyed by a hash of the
+ * loudspeaker directions, method, order and maxrE option, and contain a
+ * version number and checksum; stale or corrupted files are ignored and
+ * recomputed.
+ *
+ * @note The files are stored in native byte order, and are therefore not
+ *       intended to be shared between machines of differing endianness.
+ *
+ * @param[in] directory Existing directory in which to store the cache files;
+ *                      or NULL to disable the on-disk cache (default)
+ */
+void loudspeakerDecoderCache_setDiskCacheDirectory(/* Input Arguments */
+                                                   char* directory);
+
+/** Frees all of the decoders held in memory (cache files are kept) */
+void loudspeakerDecoderCache_clear(void);
+
+/** Returns the number of decoders currently held in memory */
+int loudspeakerDecoderCache_getNumEntries(void);
+
 /**
  * Computes binaural ambisonic decoding matrices (one per frequency) at a
  * specific order, for a given HRTF set
@@ -302,6 +424,53 @@ void getBinauralAmbiDecoderMtx(/* Input Arguments */
                                /* Output Arguments */
                                float_complex* decMtx);
 
+/**
+ * Computes binaural ambisonic decoding matrices (the same as
+ * getBinauralAmbiDecoderMtx()), with the frequency bands split over the
+ * threads of a saf_parfor pool
+ *
+ * @note For BINAURAL_DECODER_MAGLS, only the bands up to the 1.5kHz cutoff are
+ *       independent; the bands above it are computed in series.
+ *
+ * @param[in]  hPar          saf_parfor handle (see saf_parfor_create()); or
+ *                           NULL, to run on the calling thread only
+ * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
+ * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
+ * @param[in]  N_dirs        Number of HRTF directions
+ * @param[in]  N_bands       Number of frequency bands/bins
+ * @param[in]  method        Decoding method (see BINAURAL_AMBI_DECODER_METHODS
+ *                           enum)
+ * @param[in]  order         Decoding order
+ * @param[in]  freqVector    Only needed for BINAURAL_DECODER_TA or
+ *                           BINAURAL_DECODER_MAGLS decoders (set to NULL if
+ *                           using a different method); N_bands x 1
+ * @param[in]  itd_s         Only needed for BINAURAL_DECODER_TA decoder (set
+ *                           to NULL if using different method); N_dirs x 1
+ * @param[in]  weights       Integration weights (set to NULL if not available);
+ *                           N_dirs x 1
+ * @param[in]  enableDiffCM  Set to '0' to disable diffuse correction, '1' to
+ *                           enable
+ * @param[in]  enableMaxrE   Set to '0' to disable maxRE weighting, '1' to
+ *                           enable
+ * @param[out] decMtx        Decoding matrices (one per frequency);
+ *                           FLAT: N_bands x NUM_EARS x (order+1)^2
+ */
+void getBinauralAmbiDecoderMtxParallel(/* Input Arguments */
+                                       void * const hPar,
+                                       float_complex* hrtfs,
+                                       float* hrtf_dirs_deg,
+                                       int N_dirs,
+                                       int N_bands,
+                                       BINAURAL_AMBI_DECODER_METHODS method,
+                                       int order,
+                                       float* freqVector,
+                                       float* itd_s,
+                                       float* weights,
+                                       int enableDiffCM,
+                                       int enableMaxrE,
+                                       /* Output Arguments */
+                                       float_complex* decMtx);
+
 /**
  * Computes ambisonic decoding filters for a given HRTF set
  *
@@ -371,6 +540,315 @@ void applyDiffCovMatching(/* Input Arguments */
                           float_complex* decMtx);
 
 
+/* ========================================================================== */
+/*                          Ambisonic Reverb (FDN)                            */
+/* ========================================================================== */
+
+/** Minimum number of delay lines of the ambisonic reverb */
+#define AMBI_REVERB_MIN_NUM_LINES ( 8 )
+/** Maximum number of delay lines of the ambisonic reverb */
+#define AMBI_REVERB_MAX_NUM_LINES ( 128 )
+
+/**
+ * Creates an instance of a feedback delay network (FDN) reverb, which takes
+ * spherical harmonic input signals and outputs a diffuse reverberant tail
+ * directly in the spherical harmonic domain (or for a loudspeaker layout, see
+ * ambiReverb_setLoudspeakers())
+ *
+ * Each delay line is assigned a direction (spread uniformly over the sphere):
+ * the lines are fed by the input sound-field sampled in their directions, and
+ * the line outputs are encoded back into spherical harmonics as though they
+ * were plane waves from those directions. The lines are coupled via a
+ * Hadamard feedback matrix [1], which is applied with a fast Walsh-Hadamard
+ * transform (i.e. nLines*log2(nLines) additions per sample, rather than
+ * nLines^2 multiply-adds), and each line has a one-pole absorption filter [2]
+ * that sets its decay (see ambiReverb_setT60()).
+ *
+ * All lines are processed together per sample, across the lines (which the
+ * compiler may vectorise), for sub-blocks no longer than the shortest delay;
+ * while the input sampling and output encoding are matrix multiplications per
+ * sub-block. The cost therefore grows with nLines*(order+1)^2 rather than with
+ * the length of the tail, and is a small fraction of convolving the same
+ * number of channels with multi-second impulse responses (e.g. obtained with
+ * synthesiseNoiseReverb()) using saf_matrixConv. No memory is allocated while
+ * processing.
+ *
+ * @note The recursive filters decay towards denormal numbers once the input
+ *       falls silent; so wrap the processing with saf_denormals_guardBegin()
+ *       and saf_denormals_guardEnd(), as the SAF examples do.
+ *
+ * @param[in] phRev  (&) address of ambiReverb handle
+ * @param[in] order  Order of the input/output spherical harmonic signals
+ * @param[in] fs     Sampling rate
+ * @param[in] nLines Number of delay lines; rounded up to a power of 2, within
+ *                   AMBI_REVERB_MIN_NUM_LINES..AMBI_REVERB_MAX_NUM_LINES
+ *                   (0: the smallest power of 2 of at least (order+1)^2 and
+ *                   16)
+ *
+ * @see [1] Jot, J. M., & Chaigne, A. (1991). Digital delay networks for
+ *          designing artificial reverberators. In Audio Engineering Society
+ *          Convention 90.
+ * @see [2] Jot, J. M. (1992). An analysis/synthesis approach to real-time
+ *          artificial reverberation. In IEEE International Conference on
+ *          Acoustics, Speech, and Signal Processing (Vol. 2, pp. 221-224).
+ */
+void ambiReverb_create(/* Input Arguments */
+                       void ** const phRev,
+                       int order,
+                       float fs,
+                       int nLines);
+
+/**
+ * Destroys an instance of the ambisonic reverb
+ *
+ * @param[in] phRev (&) address of ambiReverb handle
+ */
+void ambiReverb_destroy(/* Input Arguments */
+                        void ** const phRev);
+
+/**
+ * Sets all delay lines and filter states to 0s
+ *
+ * @param[in] hRev ambiReverb handle
+ */
+void ambiReverb_reset(/* Input Arguments */
+                      void * const hRev);
+
+/**
+ * Sets the reverberation time (default: 1.5 s at DC, and 0.5 s at Nyquist)
+ *
+ * The absorption filter of each line attenuates it by the amount
+ * corresponding to its delay, such that the tail decays by 60 dB over 't60_lf'
+ * seconds at low frequencies and 't60_hf' seconds at high frequencies (with a
+ * smooth transition in between). May be called between calls to
+ * ambiReverb_apply().
+ *
+ * @param[in] hRev   ambiReverb handle
+ * @param[in] t60_lf T60 at DC, in seconds
+ * @param[in] t60_hf T60 at Nyquist, in seconds (at most t60_lf)
+ */
+void ambiReverb_setT60(/* Input Arguments */
+                       void * const hRev,
+                       float t60_lf,
+                       float t60_hf);
+
+/**
+ * Decodes the output to a loudspeaker layout (with
+ * getLoudspeakerAmbiDecoderMtx()), rather than outputting spherical harmonic
+ * signals; the decoder is folded into the output encoding of the lines, so
+ * this costs nothing extra while processing
+ *
+ * @note Computes the decoder, so do not call this from the audio thread. The
+ *       reverb is not reset.
+ *
+ * @param[in] hRev        ambiReverb handle
+ * @param[in] ls_dirs_deg Loudspeaker directions in DEGREES [azi elev];
+ *                        FLAT: nLS x 2 (NULL: revert to spherical harmonic
+ *                        output)
+ * @param[in] nLS         Number of loudspeakers (0: revert to spherical
+ *                        harmonic output)
+ * @param[in] method      Decoding method (see LOUDSPEAKER_AMBI_DECODER_METHODS)
+ * @param[in] enableMaxrE '0' disabled, '1' enabled
+ */
+void ambiReverb_setLoudspeakers(/* Input Arguments */
+                                void * const hRev,
+                                float* ls_dirs_deg,
+                                int nLS,
+                                LOUDSPEAKER_AMBI_DECODER_METHODS method,
+                                int enableMaxrE);
+
+/**
+ * Returns the number of delay lines
+ *
+ * @param[in] hRev ambiReverb handle
+ */
+int ambiReverb_getNumLines(/* Input Arguments */
+                           void * const hRev);
+
+/**
+ * Returns the number of output channels: (order+1)^2, or the number of
+ * loudspeakers (see ambiReverb_setLoudspeakers())
+ *
+ * @param[in] hRev ambiReverb handle
+ */
+int ambiReverb_getNumOutputs(/* Input Arguments */
+                             void * const hRev);
+
+/**
+ * Applies the reverb to a block of spherical harmonic signals
+ *
+ * @note The output is only the reverberant tail (i.e. it is not mixed with the
+ *       input); 'input' and 'output' must not be the same
+ *
+ * @param[in]  hRev      ambiReverb handle
+ * @param[in]  input     Input spherical harmonic signals; nInputs x nSamples
+ * @param[in]  nInputs   Number of input channels (at most (order+1)^2; missing
+ *                       channels are taken as zeros, e.g. '1' for an
+ *                       omnidirectional input)
+ * @param[in]  nSamples  Number of samples per channel (any)
+ * @param[out] output    Output signals; ambiReverb_getNumOutputs() x nSamples
+ */
+void ambiReverb_apply(/* Input Arguments */
+                      void * const hRev,
+                      float** input,
+                      int nInputs,
+                      int nSamples,
+                      /* Output Arguments */
+                      float** output);
+
+
+/* ========================================================================== */
+/*                   Shoebox Early Reflections (Image-Source)                 */
+/* ========================================================================== */
+
+/** Highest reflection order supported by the early reflections engine */
+#define AMBI_EARLY_REFL_MAX_ORDER ( 10 )
+
+/**
+ * Creates an instance of an image-source early reflections engine for a
+ * shoebox room, which encodes all of the reflections of a number of mono
+ * sources directly into spherical harmonic signals (ACN/N3D, as with getRSH())
+ *
+ * The image sources of each source are found up to the reflection order set
+ * with ambiEarlyRefl_setCulling(), and those that are weaker than the given
+ * threshold (relative to the direct path) are culled. The directions of all of
+ * the remaining reflections are evaluated together with getSHreal_fastCart(),
+ * and their gains (wall reflection coefficients and 1/r spreading) are folded
+ * into the encoding matrix. When processing, each reflection is read from the
+ * delay line of its source with a fractional delay (3rd order Lagrange
+ * interpolation), and all reflections are encoded with one matrix
+ * multiplication per sub-block; i.e. hundreds of reflections cost far less
+ * than the same number of individually encoded sources.
+ *
+ * The room spans [0, dims] in [x y z] metres, with x pointing forwards, y left
+ * and z up (azimuth 0 is along x). Defaults: a 6x5x3 m room with an absorption
+ * coefficient of 0.3 for all walls, the receiver at its centre, all sources
+ * 1.5 m in front of it, reflections up to 3rd order with a -60 dB threshold,
+ * and the direct path excluded.
+ *
+ * @param[in] phER          (&) address of ambiEarlyRefl handle
+ * @param[in] order         Order of the output spherical harmonic signals
+ * @param[in] fs            Sampling rate
+ * @param[in] maxNumSources Maximum number of sources
+ *
+ * @see [1] Allen, J. B., & Berkley, D. A. (1979). Image method for efficiently
+ *          simulating small-room acoustics. The Journal of the Acoustical
+ *          Society of America, 65(4), 943-950.
+ */
+void ambiEarlyRefl_create(/* Input Arguments */
+                          void ** const phER,
+                          int order,
+                          float fs,
+                          int maxNumSources);
+
+/**
+ * Destroys an instance of the early reflections engine
+ *
+ * @param[in] phER (&) address of ambiEarlyRefl handle
+ */
+void ambiEarlyRefl_destroy(/* Input Arguments */
+                           void ** const phER);
+
+/**
+ * Sets the delay lines to 0s
+ *
+ * @param[in] hER ambiEarlyRefl handle
+ */
+void ambiEarlyRefl_reset(/* Input Arguments */
+                         void * const hER);
+
+/**
+ * Sets the room dimensions and wall absorption coefficients
+ *
+ * @note May resize the delay lines, so do not call this from the audio thread
+ *       if the room grows. The source and receiver positions are clamped to
+ *       the inside of the room.
+ *
+ * @param[in] hER        ambiEarlyRefl handle
+ * @param[in] dims       Room dimensions [x y z], in metres; 3 x 1
+ * @param[in] absorption Absorption coefficients (0..1) of the walls at
+ *                       x=0, x=dims[0], y=0, y=dims[1], z=0, z=dims[2]; 6 x 1
+ */
+void ambiEarlyRefl_setRoom(/* Input Arguments */
+                           void * const hER,
+                           float dims[3],
+                           float absorption[6]);
+
+/**
+ * Sets the position of one source, in metres (see ambiEarlyRefl_create())
+ *
+ * @note The reflections are recomputed; call between calls to
+ *       ambiEarlyRefl_apply(). Changes take effect at the next call, without
+ *       interpolation.
+ *
+ * @param[in] hER ambiEarlyRefl handle
+ * @param[in] src Source index
+ * @param[in] pos Position [x y z]; 3 x 1
+ */
+void ambiEarlyRefl_setSourcePosition(/* Input Arguments */
+                                     void * const hER,
+                                     int src,
+                                     float pos[3]);
+
+/**
+ * Sets the position of the receiver, in metres (see
+ * ambiEarlyRefl_setSourcePosition())
+ *
+ * @param[in] hER ambiEarlyRefl handle
+ * @param[in] pos Position [x y z]; 3 x 1
+ */
+void ambiEarlyRefl_setReceiverPosition(/* Input Arguments */
+                                       void * const hER,
+                                       float pos[3]);
+
+/**
+ * Sets which reflections are rendered (see
+ * ambiEarlyRefl_setSourcePosition())
+ *
+ * @note May resize the delay lines (for a higher reflection order), so do not
+ *       call this from the audio thread
+ *
+ * @param[in] hER              ambiEarlyRefl handle
+ * @param[in] maxReflOrder     Highest reflection order; 0..
+ *                             AMBI_EARLY_REFL_MAX_ORDER
+ * @param[in] minGain_dB       Reflections weaker than this, relative to the
+ *                             direct path, are culled (e.g. -60)
+ * @param[in] includeDirectFLAG '0' reflections only, '1' also render the
+ *                             direct path
+ */
+void ambiEarlyRefl_setCulling(/* Input Arguments */
+                              void * const hER,
+                              int maxReflOrder,
+                              float minGain_dB,
+                              int includeDirectFLAG);
+
+/**
+ * Returns the number of rendered reflections (over all sources)
+ *
+ * @param[in] hER ambiEarlyRefl handle
+ */
+int ambiEarlyRefl_getNumReflections(/* Input Arguments */
+                                    void * const hER);
+
+/**
+ * Renders the early reflections of a block of source signals
+ *
+ * @param[in]  hER      ambiEarlyRefl handle
+ * @param[in]  input    Source signals; nInputs x nSamples
+ * @param[in]  nInputs  Number of sources (at most maxNumSources; missing
+ *                      sources are taken as silent)
+ * @param[in]  nSamples Number of samples per channel (any)
+ * @param[out] output   Spherical harmonic signals; (order+1)^2 x nSamples
+ */
+void ambiEarlyRefl_apply(/* Input Arguments */
+                         void * const hER,
+                         float** input,
+                         int nInputs,
+                         int nSamples,
+                         /* Output Arguments */
+                         float** output);
+
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
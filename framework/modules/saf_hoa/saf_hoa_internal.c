@@ -50,7 +50,7 @@ void getEPAD
     U = malloc1d(nSH*nSH*sizeof(float));
     V = malloc1d(nLS*nLS*sizeof(float));
     getRSH(order, ls_dirs_deg, nLS, Y_ls);
-    utility_ssvd(Y_ls, nSH, nLS, U, NULL, V, NULL);
+    utility_ssvd(NULL, Y_ls, nSH, nLS, U, NULL, V, NULL);
     if(nSH>nLS){
         /* truncate the U matrix */
         U_tr = malloc1d(nSH*nLS*sizeof(float));
@@ -133,178 +133,338 @@ void getAllRAD
     free(G_td);
 }
 
-void getBinDecoder_LS
+/**
+ * Returns the integration weights as a vector (1/N_dirs if weights==NULL), as
+ * the diagonal of the weighting matrices used by the getBinDecoder_* functions
+ */
+static void binDecoder_getWeights
 (
-    float_complex* hrtfs,  /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
-    float* hrtf_dirs_deg,
+    float* weights,
     int N_dirs,
-    int N_bands,
+    float* w /* N_dirs x 1 */
+)
+{
+    int i;
+
+    for(i=0; i<N_dirs; i++)
+        w[i] = weights!=NULL ? weights[i] : 1.0f/(float)N_dirs;
+}
+
+/**
+ * Computes the (band-independent) parts of the least-squares decoders; i.e.
+ * the SHs, Y_na, and: Yna_W = Y_na*W and Yna_W_Yna = Y_na*W*Y_na^T, where W is
+ * the diagonal matrix of integration weights
+ */
+static void binDecoder_prepLS
+(
     int order,
-    float* weights,
-    float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
+    float* hrtf_dirs_deg,
+    int N_dirs,
+    float* w,                 /* N_dirs x 1 */
+    float_complex* Y_na,      /* nSH x N_dirs */
+    float_complex* Yna_W,     /* nSH x N_dirs */
+    float_complex* Yna_W_Yna  /* nSH x nSH */
 )
 {
-    int i, j, nSH, band;
+    int i, j, nSH;
     float* Y_tmp;
-    float_complex* W, *Y_na, *Yna_W, *Yna_W_Yna, *Yna_W_H, *B;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
+
     nSH = (order+1)*(order+1);
-    
-    /* SH */
     Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
-    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
-    B = malloc1d(nSH * 2 * sizeof(float_complex));
     getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
-    for(i=0; i<nSH*N_dirs; i++)
-        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
+    for(i=0; i<nSH; i++){
+        for(j=0; j<N_dirs; j++){
+            Y_na[i*N_dirs+j] = cmplxf(Y_tmp[i*N_dirs+j], 0.0f);
+            Yna_W[i*N_dirs+j] = cmplxf(Y_tmp[i*N_dirs+j]*w[j], 0.0f);
+        }
+    }
     free(Y_tmp);
-    
-    /* compute decoding matrix, incorporating integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float_complex));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(weights[i], 0.0f);
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(1.0f/(float)N_dirs, 0.0f);
-
-    /* calculate decoding matrix per band */
-    Yna_W = malloc1d(nSH * N_dirs*sizeof(float_complex));
-    Yna_W_Yna = malloc1d(nSH * nSH * sizeof(float_complex));
-    Yna_W_H = malloc1d(nSH * 2 * sizeof(float_complex));
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, N_dirs, N_dirs, &calpha,
-                Y_na, N_dirs,
-                W, N_dirs, &cbeta,
-                Yna_W, N_dirs);
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, N_dirs, &calpha,
                 Yna_W, N_dirs,
                 Y_na, N_dirs, &cbeta,
                 Yna_W_Yna, nSH);
-    for(band=0; band<N_bands; band++){
+}
+
+/**
+ * Job shared by the threads of the getBinDecoder_* functions, which compute
+ * the decoding matrices for the bands [first, last) in parallel (see
+ * getBinauralAmbiDecoderMtxParallel()). Each thread allocates its own scratch
+ * and linear solver workspace, which it then reuses for all of its bands.
+ */
+typedef struct _binDecoder_job {
+    int N_dirs, nSH;
+    int K_td;                        /**< number of t-design points (SPR) */
+    int band_cutoff;                 /**< first band without ITDs (TA) */
+    const float_complex* hrtfs;      /**< FLAT: N_bands x 2 x N_dirs */
+    const float* w;                  /**< integration weights; N_dirs x 1 */
+    const float_complex* Y_na;       /**< FLAT: nSH x N_dirs */
+    const float_complex* Yna_W;      /**< FLAT: nSH x N_dirs */
+    const float_complex* Yna_W_Yna;  /**< FLAT: nSH x nSH */
+    const float_complex* Y_td;       /**< t-design SHs (SPR); FLAT: nSH x K_td */
+    const float_complex* W_Ynh_Ytd;  /**< (SPR); FLAT: N_dirs x K_td */
+    const float* itd_s;              /**< ITDs (TA), or NULL; N_dirs x 1 */
+    float_complex* decMtx;           /**< FLAT: N_bands x 2 x nSH */
+
+}binDecoder_job;
+
+/** Least-squares decoders (LS, TA and MagLS below the cutoff) for the bands [first, last) */
+static void binDecoderLS_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    binDecoder_job* job = (binDecoder_job*)(hCtx);
+    int i, j, band, nSH, N_dirs;
+    void* hSlv;
+    float_complex* Yna_W_H, *B, *hrtfs_mod;
+    const float_complex* H;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    (void)threadIndex;
+
+    nSH = job->nSH;
+    N_dirs = job->N_dirs;
+    Yna_W_H = malloc1d(nSH * 2 * sizeof(float_complex));
+    B = malloc1d(nSH * 2 * sizeof(float_complex));
+    hrtfs_mod = job->itd_s!=NULL ? malloc1d(2*N_dirs*sizeof(float_complex)) : NULL;
+    utility_cglslv_create(&hSlv, nSH, 2);
+    for(band=first; band<last; band++){
+        H = &(job->hrtfs[band*2*N_dirs]);
+
+        /* Remove itd from high frequency HRTFs (TA) */
+        if(job->itd_s!=NULL && band>=job->band_cutoff){
+            for(j=0; j<N_dirs; j++){
+                hrtfs_mod[0*N_dirs+j] = ccmulf(H[0*N_dirs + j],
+                                               cexpf( crmulf(cmplxf(0.0f, 0.0f), (job->itd_s[j]/2.0f))));
+                hrtfs_mod[1*N_dirs+j] = ccmulf(H[1*N_dirs + j],
+                                               cexpf( crmulf(cmplxf(0.0f, 0.0f), (-job->itd_s[j]/2.0f))));
+            }
+            H = hrtfs_mod;
+        }
         cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
-                    Yna_W, N_dirs,
-                    &hrtfs[band*2*N_dirs], N_dirs, &cbeta,
+                    job->Yna_W, N_dirs,
+                    H, N_dirs, &cbeta,
                     Yna_W_H, 2);
-        utility_cglslv(Yna_W_Yna, nSH, Yna_W_H, 2, B);
+        utility_cglslv(hSlv, job->Yna_W_Yna, nSH, Yna_W_H, 2, B);
         for(i=0; i<nSH; i++)
             for(j=0; j<2; j++)
-                decMtx[band*2*nSH + j*nSH + i] = conjf(B[i*2+j]); /* ^H */
+                job->decMtx[band*2*nSH + j*nSH + i] = conjf(B[i*2+j]); /* ^H */
     }
-    
-    /* clean-up */
-    free(W);
-    free(Yna_W);
-    free(Yna_W_Yna);
+
+    utility_cglslv_destroy(&hSlv);
     free(Yna_W_H);
-    free(Y_na);
     free(B);
+    free(hrtfs_mod);
 }
 
-void getBinDecoder_LSDIFFEQ
+/** LS decoders with diffuse-field equalisation, for the bands [first, last) */
+static void binDecoderLSDIFFEQ_range
 (
-    float_complex* hrtfs,  /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
-    float* hrtf_dirs_deg,
-    int N_dirs,
-    int N_bands,
-    int order,
-    float* weights,
-    float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
 )
 {
-    int i, j, nSH, band;
+    binDecoder_job* job = (binDecoder_job*)(hCtx);
+    int i, j, k, band, nSH, N_dirs;
     float Gh;
-    float* Y_tmp;
-    float_complex* W, *Y_na, *Yna_W, *Yna_W_Yna, *Yna_W_H, *B_ls, *hrtfs_ls, *H_W;
+    void* hSlv;
+    float_complex* Yna_W_H, *B_ls, *hrtfs_ls, *H_W;
     float_complex C_ref[2][2], C_ls[2][2];
+    const float_complex* H;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
-    nSH = (order+1)*(order+1);
-    
-    /* integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float_complex));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(weights[i], 0.0f);
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(1.0f/(float)N_dirs, 0.0f);
-    
-    /* SH */
-    Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
-    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
-    getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
-    for(i=0; i<nSH*N_dirs; i++)
-        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
-    free(Y_tmp);
-    
-    /* calculate decoding matrix per band */
-    Yna_W = malloc1d(nSH * N_dirs*sizeof(float_complex));
-    Yna_W_Yna = malloc1d(nSH * nSH * sizeof(float_complex));
+    (void)threadIndex;
+
+    nSH = job->nSH;
+    N_dirs = job->N_dirs;
     Yna_W_H = malloc1d(nSH * 2 * sizeof(float_complex));
     B_ls = malloc1d(nSH * 2 * sizeof(float_complex));
     hrtfs_ls = malloc1d(2*N_dirs*sizeof(float_complex));
     H_W = malloc1d(2*N_dirs*sizeof(float_complex));
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, N_dirs, N_dirs, &calpha,
-                Y_na, N_dirs,
-                W, N_dirs, &cbeta,
-                Yna_W, N_dirs);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, N_dirs, &calpha,
-                Yna_W, N_dirs,
-                Y_na, N_dirs, &cbeta,
-                Yna_W_Yna, nSH);
-    for(band=0; band<N_bands; band++){
+    utility_cglslv_create(&hSlv, nSH, 2);
+    for(band=first; band<last; band++){
+        H = &(job->hrtfs[band*2*N_dirs]);
+
         /* find least-squares decoding matrix */
         cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
-                    Yna_W, N_dirs,
-                    &hrtfs[band*2*N_dirs], N_dirs, &cbeta,
+                    job->Yna_W, N_dirs,
+                    H, N_dirs, &cbeta,
                     Yna_W_H, 2);
-        utility_cglslv(Yna_W_Yna, nSH, Yna_W_H, 2, B_ls);
+        utility_cglslv(hSlv, job->Yna_W_Yna, nSH, Yna_W_H, 2, B_ls);
         cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, 2, N_dirs, nSH, &calpha,
                     B_ls, 2,
-                    Y_na, N_dirs, &cbeta,
+                    job->Y_na, N_dirs, &cbeta,
                     hrtfs_ls, N_dirs);
-        
-        /* Diffuse-field responses */
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, N_dirs, N_dirs, &calpha,
-                    &hrtfs[band*2*N_dirs], N_dirs,
-                    W, N_dirs, &cbeta,
-                    H_W, N_dirs);
+
+        /* Diffuse-field responses (W is diagonal) */
+        for(k=0; k<2; k++)
+            for(j=0; j<N_dirs; j++)
+                H_W[k*N_dirs+j] = crmulf(H[k*N_dirs+j], job->w[j]);
         cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, 2, 2, N_dirs, &calpha,
                     H_W, N_dirs,
-                    &hrtfs[band*2*N_dirs], N_dirs, &cbeta,
+                    H, N_dirs, &cbeta,
                     (float_complex*)C_ref, 2);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, N_dirs, N_dirs, &calpha,
-                    hrtfs_ls, N_dirs,
-                    W, N_dirs, &cbeta,
-                    H_W, N_dirs);
+        for(k=0; k<2; k++)
+            for(j=0; j<N_dirs; j++)
+                H_W[k*N_dirs+j] = crmulf(hrtfs_ls[k*N_dirs+j], job->w[j]);
         cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, 2, 2, N_dirs, &calpha,
                     H_W, N_dirs,
                     hrtfs_ls, N_dirs, &cbeta,
                     (float_complex*)C_ls, 2);
-        
+
         /* Diffuse-Equalisation factor */
         Gh = (sqrtf(crealf(C_ref[0][0])/(crealf(C_ls[0][0])+2.23e-7f)) +
               sqrtf(crealf(C_ref[1][1])/(crealf(C_ls[1][1])+2.23e-7f))) /2.0f;
-        
+
         /* apply diff-EQ */
         for(i=0; i<nSH; i++)
             for(j=0; j<2; j++)
-                decMtx[band*2*nSH + j*nSH + i] = crmulf(conjf(B_ls[i*2+j]), Gh); /* ^H */
+                job->decMtx[band*2*nSH + j*nSH + i] = crmulf(conjf(B_ls[i*2+j]), Gh); /* ^H */
     }
-    
-    free(W);
-    free(Y_na);
-    free(Yna_W);
-    free(Yna_W_Yna);
+
+    utility_cglslv_destroy(&hSlv);
     free(Yna_W_H);
     free(B_ls);
     free(hrtfs_ls);
     free(H_W);
 }
 
+/** Spatial resampling decoders, for the bands [first, last) */
+static void binDecoderSPR_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    binDecoder_job* job = (binDecoder_job*)(hCtx);
+    int i, j, band, nSH, N_dirs, K_td;
+    float_complex* hrtfs_td, *B;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    (void)threadIndex;
+
+    nSH = job->nSH;
+    N_dirs = job->N_dirs;
+    K_td = job->K_td;
+    hrtfs_td = malloc1d(2*K_td*sizeof(float_complex));
+    B = malloc1d(nSH * 2 * sizeof(float_complex));
+    for(band=first; band<last; band++){
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, K_td, N_dirs, &calpha,
+                    &(job->hrtfs[band*2*N_dirs]), N_dirs,
+                    job->W_Ynh_Ytd, K_td, &cbeta,
+                    hrtfs_td, K_td);
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, K_td, &calpha,
+                    job->Y_td, K_td,
+                    hrtfs_td, K_td, &cbeta,
+                    B, 2);
+        for(i=0; i<nSH; i++)
+            for(j=0; j<2; j++)
+                job->decMtx[band*2*nSH + j*nSH + i] = crmulf(conjf(B[i*2+j]), 1.0f/(float)K_td); /* ^H */
+    }
+
+    free(hrtfs_td);
+    free(B);
+}
+
+void getBinDecoder_LS
+(
+    void* const hPar,
+    float_complex* hrtfs,  /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
+    float* hrtf_dirs_deg,
+    int N_dirs,
+    int N_bands,
+    int order,
+    float* weights,
+    float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
+)
+{
+    int nSH;
+    float* w;
+    float_complex* Y_na, *Yna_W, *Yna_W_Yna;
+    binDecoder_job job;
+
+    nSH = (order+1)*(order+1);
+
+    /* SH and integration weights */
+    w = malloc1d(N_dirs*sizeof(float));
+    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W_Yna = malloc1d(nSH*nSH*sizeof(float_complex));
+    binDecoder_getWeights(weights, N_dirs, w);
+    binDecoder_prepLS(order, hrtf_dirs_deg, N_dirs, w, Y_na, Yna_W, Yna_W_Yna);
+
+    /* calculate decoding matrix per band */
+    memset(&job, 0, sizeof(binDecoder_job));
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_na = Y_na;
+    job.Yna_W = Yna_W;
+    job.Yna_W_Yna = Yna_W_Yna;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &binDecoderLS_range, (void*)&job, N_bands);
+
+    /* clean-up */
+    free(w);
+    free(Y_na);
+    free(Yna_W);
+    free(Yna_W_Yna);
+}
+
+void getBinDecoder_LSDIFFEQ
+(
+    void* const hPar,
+    float_complex* hrtfs,  /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
+    float* hrtf_dirs_deg,
+    int N_dirs,
+    int N_bands,
+    int order,
+    float* weights,
+    float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
+)
+{
+    int nSH;
+    float* w;
+    float_complex* Y_na, *Yna_W, *Yna_W_Yna;
+    binDecoder_job job;
+
+    nSH = (order+1)*(order+1);
+
+    /* SH and integration weights */
+    w = malloc1d(N_dirs*sizeof(float));
+    Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W_Yna = malloc1d(nSH*nSH*sizeof(float_complex));
+    binDecoder_getWeights(weights, N_dirs, w);
+    binDecoder_prepLS(order, hrtf_dirs_deg, N_dirs, w, Y_na, Yna_W, Yna_W_Yna);
+
+    /* calculate decoding matrix per band */
+    memset(&job, 0, sizeof(binDecoder_job));
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_na = Y_na;
+    job.Yna_W = Yna_W;
+    job.Yna_W_Yna = Yna_W_Yna;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &binDecoderLSDIFFEQ_range, (void*)&job, N_bands);
+
+    free(w);
+    free(Y_na);
+    free(Yna_W);
+    free(Yna_W_Yna);
+}
+
 void getBinDecoder_SPR
 (
+    void* const hPar,
     float_complex* hrtfs, /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
     float* hrtf_dirs_deg,
     int N_dirs,
@@ -314,22 +474,17 @@ void getBinDecoder_SPR
     float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
 )
 {
-    int band, i, j, nSH, nSH_nh, Nh_max, Nh, K_td;
-    float* hrtf_dirs_rad, *W, *cnd_num, *Y_nh, *Y_na, *tdirs_deg, *Y_td, *Ynh_Ytd, *tmp;
-    float_complex* Y_td_cmplx, *W_Ynh_Ytd, *hrtfs_td, *B;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
+    int i, j, nSH, nSH_nh, Nh_max, Nh, K_td;
+    float* hrtf_dirs_rad, *w, *cnd_num, *Y_nh, *tdirs_deg, *Y_td, *Ynh_Ytd;
+    float_complex* Y_td_cmplx, *W_Ynh_Ytd;
+    binDecoder_job job;
+
     nSH = (order+1)*(order+1);
-    
+
     /* integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = weights[i];
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = 1.0f/(float)N_dirs;
-    
+    w = malloc1d(N_dirs*sizeof(float));
+    binDecoder_getWeights(weights, N_dirs, w);
+
     /* find SH-order for interpolation of the HRTF set */
     Nh_max = (int)(sqrtf((float)N_dirs)-1.0f);
     hrtf_dirs_rad = malloc1d(N_dirs*2*sizeof(float));
@@ -338,18 +493,14 @@ void getBinDecoder_SPR
         hrtf_dirs_rad[i*2]   = hrtf_dirs_deg[i*2]*(M_PI/180.0f);
         hrtf_dirs_rad[i*2+1] = M_PI/2.0f - hrtf_dirs_deg[i*2+1]*(M_PI/180.0f);
     }
-    checkCondNumberSHTReal(Nh_max, hrtf_dirs_rad, N_dirs, weights, cnd_num);
+    checkCondNumberSHTReal(NULL, Nh_max, hrtf_dirs_rad, N_dirs, weights, cnd_num);
     for(i=0, Nh=0; i<Nh_max+1; i++)
         Nh = cnd_num[i] < 100.0f ? i : Nh;
     assert(Nh>=order);
     nSH_nh = (Nh+1)*(Nh+1);
     Y_nh = malloc1d(nSH_nh*N_dirs*sizeof(float));
     getRSH(Nh, hrtf_dirs_deg, N_dirs, Y_nh);
-    Y_na = malloc1d(nSH * N_dirs *sizeof(float));
-    for(i=0; i<nSH; i++)
-        for(j=0; j<N_dirs; j++)
-            Y_na[i*N_dirs+j] = Y_nh[i*N_dirs+j]; 
-    
+
     /* Get t-design SH for ambisonic signals */
     tdirs_deg = (float*)__HANDLES_Tdesign_dirs_deg[2*order-1];
     K_td = __Tdesign_nPoints_per_degree[2*order-1];
@@ -358,53 +509,64 @@ void getBinDecoder_SPR
     Y_td_cmplx = malloc1d(nSH_nh*K_td*sizeof(float_complex));
     for(i=0; i<nSH_nh*K_td; i++)
         Y_td_cmplx[i] = cmplxf(Y_td[i], 0.0f);
-    
-    /* calculate decoding matrix per band */
+
+    /* W*Y_nh^T*Y_td is the same for all bands (W is diagonal) */
     Ynh_Ytd = malloc1d(N_dirs * K_td * sizeof(float));
-    tmp = malloc1d(N_dirs * K_td * sizeof(float));
     W_Ynh_Ytd = malloc1d(N_dirs * K_td * sizeof(float_complex));
-    hrtfs_td = malloc1d(2*K_td*sizeof(float_complex));
-    B = malloc1d(nSH * 2 * sizeof(float_complex));
-    for(band=0; band<N_bands; band++){
-        cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, N_dirs, K_td, nSH_nh, 1.0f,
-                    Y_nh, N_dirs,
-                    Y_td, K_td, 0.0f,
-                    Ynh_Ytd, K_td);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, N_dirs, K_td, N_dirs, 1.0f,
-                    W, N_dirs,
-                    Ynh_Ytd, K_td, 0.0f,
-                    tmp, K_td);
-        for(i=0; i<N_dirs*K_td; i++)
-            W_Ynh_Ytd[i] = cmplxf(tmp[i], 0.0f);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, K_td, N_dirs, &calpha,
-                    &hrtfs[band*2*N_dirs], N_dirs,
-                    W_Ynh_Ytd, K_td, &cbeta,
-                    hrtfs_td, K_td);
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, K_td, &calpha,
-                    Y_td_cmplx, K_td,
-                    hrtfs_td, K_td, &cbeta,
-                    B, 2);
-        for(i=0; i<nSH; i++)
-            for(j=0; j<2; j++)
-                decMtx[band*2*nSH + j*nSH + i] = crmulf(conjf(B[i*2+j]), 1.0f/(float)K_td); /* ^H */
-    }
-    
+    cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, N_dirs, K_td, nSH_nh, 1.0f,
+                Y_nh, N_dirs,
+                Y_td, K_td, 0.0f,
+                Ynh_Ytd, K_td);
+    for(i=0; i<N_dirs; i++)
+        for(j=0; j<K_td; j++)
+            W_Ynh_Ytd[i*K_td+j] = cmplxf(w[i]*Ynh_Ytd[i*K_td+j], 0.0f);
+
+    /* calculate decoding matrix per band */
+    memset(&job, 0, sizeof(binDecoder_job));
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.K_td = K_td;
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_td = Y_td_cmplx;
+    job.W_Ynh_Ytd = W_Ynh_Ytd;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &binDecoderSPR_range, (void*)&job, N_bands);
+
     free(hrtf_dirs_rad);
-    free(W);
+    free(w);
     free(cnd_num);
     free(Y_nh);
-    free(Y_na);
     free(Y_td);
     free(Y_td_cmplx);
     free(Ynh_Ytd);
-    free(tmp);
     free(W_Ynh_Ytd);
-    free(hrtfs_td);
-    free(B);
+}
+
+/** Returns the index of the band closest to 'cutoff' */
+static int binDecoder_findCutoffBand
+(
+    float* freqVector,
+    int N_bands,
+    float cutoff
+)
+{
+    int band, band_cutoff;
+    float minVal;
+
+    minVal = 2.23e10f;
+    for(band=0, band_cutoff=0; band<N_bands; band++){
+        if(minVal>fabsf(freqVector[band]-cutoff)){
+            minVal = fabsf(freqVector[band]-cutoff);
+            band_cutoff = band;
+        }
+    }
+    return band_cutoff;
 }
 
 void getBinDecoder_TA
 (
+    void* const hPar,
     float_complex* hrtfs, /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
     float* hrtf_dirs_deg,
     int N_dirs,
@@ -416,88 +578,44 @@ void getBinDecoder_TA
     float_complex* decMtx /* N_bands x 2 x (order+1)^2  */
 )
 {
-    int i, j, nSH, band, band_cutoff;
-    float cutoff, minVal;
-    float* Y_tmp;
-    float_complex* W, *Y_na, *hrtfs_mod, *Yna_W, *Yna_W_Yna, *Yna_W_H, *B;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
+    int nSH;
+    float* w;
+    float_complex* Y_na, *Yna_W, *Yna_W_Yna;
+    binDecoder_job job;
+
     nSH = (order+1)*(order+1);
-    
-    /* integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float_complex));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(weights[i], 0.0f);
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(1.0f/(float)N_dirs, 0.0f);
-    
-    /* SH */
-    Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
+
+    /* SH and integration weights */
+    w = malloc1d(N_dirs*sizeof(float));
     Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
-    getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
-    for(i=0; i<nSH*N_dirs; i++)
-        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
-    free(Y_tmp);
-    
-    /* find band index for cutoff frequency */
-    cutoff = 1.5e3f;
-    minVal = 2.23e10f;
-    for(band=0, band_cutoff=0; band<N_bands; band++){
-        if(minVal>fabsf(freqVector[band]-cutoff)){
-            minVal = fabsf(freqVector[band]-cutoff);
-            band_cutoff = band;
-        }
-    }
-    
-    /* calculate decoding matrix per band */
-    Yna_W = malloc1d(nSH * N_dirs*sizeof(float_complex));
-    Yna_W_Yna = malloc1d(nSH * nSH * sizeof(float_complex));
-    Yna_W_H = malloc1d(nSH * 2 * sizeof(float_complex));
-    B = malloc1d(nSH * 2 * sizeof(float_complex));
-    hrtfs_mod = malloc1d(2*N_dirs*sizeof(float_complex));
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, N_dirs, N_dirs, &calpha,
-                Y_na, N_dirs,
-                W, N_dirs, &cbeta,
-                Yna_W, N_dirs);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, N_dirs, &calpha,
-                Yna_W, N_dirs,
-                Y_na, N_dirs, &cbeta,
-                Yna_W_Yna, nSH);
-    for(band=0; band < N_bands; band++){
-        /* Remove itd from high frequency HRTFs */
-        if(band>=band_cutoff){
-            for(j=0; j<N_dirs; j++){
-                hrtfs_mod[0*N_dirs+j] = ccmulf(hrtfs[band*2*N_dirs + 0*N_dirs + j],
-                                               cexpf( crmulf(cmplxf(0.0f, 0.0f), (itd_s[j]/2.0f))));
-                hrtfs_mod[1*N_dirs+j] = ccmulf(hrtfs[band*2*N_dirs + 1*N_dirs + j],
-                                               cexpf( crmulf(cmplxf(0.0f, 0.0f), (-itd_s[j]/2.0f))));
-            }
-        }
-        else
-            memcpy(hrtfs_mod, &hrtfs[band*2*N_dirs], 2*N_dirs*sizeof(float_complex));
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
-                    Yna_W, N_dirs,
-                    hrtfs_mod, N_dirs, &cbeta,
-                    Yna_W_H, 2);
-        utility_cglslv(Yna_W_Yna, nSH, Yna_W_H, 2, B);
-        for(i=0; i<nSH; i++)
-            for(j=0; j<2; j++)
-                decMtx[band*2*nSH + j*nSH + i] = conjf(B[i*2+j]); /* ^H */
-    }
-    
+    Yna_W = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W_Yna = malloc1d(nSH*nSH*sizeof(float_complex));
+    binDecoder_getWeights(weights, N_dirs, w);
+    binDecoder_prepLS(order, hrtf_dirs_deg, N_dirs, w, Y_na, Yna_W, Yna_W_Yna);
+
+    /* calculate decoding matrix per band (with the ITDs removed above 1.5kHz) */
+    memset(&job, 0, sizeof(binDecoder_job));
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.band_cutoff = binDecoder_findCutoffBand(freqVector, N_bands, 1.5e3f);
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_na = Y_na;
+    job.Yna_W = Yna_W;
+    job.Yna_W_Yna = Yna_W_Yna;
+    job.itd_s = itd_s;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &binDecoderLS_range, (void*)&job, N_bands);
+
+    free(w);
     free(Y_na);
-    free(W);
     free(Yna_W);
     free(Yna_W_Yna);
-    free(Yna_W_H);
-    free(B);
-    free(hrtfs_mod);
 }
 
 void getBinDecoder_MAGLS
 (
+    void* const hPar,
     float_complex* hrtfs, /* the HRTFs; FLAT: N_bands x 2 x N_dirs */
     float* hrtf_dirs_deg,
     int N_dirs,
@@ -509,89 +627,70 @@ void getBinDecoder_MAGLS
 )
 {
     int i, j, nSH, band, band_cutoff;
-    float cutoff, minVal;
-    float* Y_tmp;
-    float_complex* W, *Y_na, *hrtfs_ls, *Yna_W, *Yna_W_Yna, *Yna_W_H, *H_mod, *B_magls;
+    float* w;
+    void* hSlv;
+    float_complex* Y_na, *Yna_W, *Yna_W_Yna, *Yna_W_H, *H_mod, *B_magls;
+    binDecoder_job job;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
+
     nSH = (order+1)*(order+1);
-    
-    /* integration weights */
-    W = calloc1d(N_dirs*N_dirs, sizeof(float_complex));
-    if(weights!=NULL)
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(weights[i], 0.0f);
-    else
-        for(i=0; i<N_dirs; i++)
-            W[i*N_dirs+i] = cmplxf(1.0f/(float)N_dirs, 0.0f);
-    
-    /* SH */
-    Y_tmp = malloc1d(nSH*N_dirs*sizeof(float));
+
+    /* SH and integration weights */
+    w = malloc1d(N_dirs*sizeof(float));
     Y_na = malloc1d(nSH*N_dirs*sizeof(float_complex));
-    getRSH(order, hrtf_dirs_deg, N_dirs, Y_tmp);
-    for(i=0; i<nSH*N_dirs; i++)
-        Y_na[i] = cmplxf(Y_tmp[i], 0.0f);
-    free(Y_tmp);
-    
+    Yna_W = malloc1d(nSH*N_dirs*sizeof(float_complex));
+    Yna_W_Yna = malloc1d(nSH*nSH*sizeof(float_complex));
+    binDecoder_getWeights(weights, N_dirs, w);
+    binDecoder_prepLS(order, hrtf_dirs_deg, N_dirs, w, Y_na, Yna_W, Yna_W_Yna);
+
     /* find band index for cutoff frequency */
-    cutoff = 1.5e3f;
-    minVal = 2.23e10f;
-    for(band=0, band_cutoff=0; band<N_bands; band++){
-        if(minVal>fabsf(freqVector[band]-cutoff)){
-            minVal = fabsf(freqVector[band]-cutoff);
-            band_cutoff = band;
-        }
-    }
-    
-    /* calculate decoding matrix per band */
-    Yna_W = malloc1d(nSH * N_dirs*sizeof(float_complex));
-    Yna_W_Yna = malloc1d(nSH * nSH * sizeof(float_complex));
+    band_cutoff = MIN(binDecoder_findCutoffBand(freqVector, N_bands, 1.5e3f), N_bands-1);
+
+    /* LS decoding matrices up to the cutoff; these bands are independent, and
+     * so they are computed in parallel */
+    memset(&job, 0, sizeof(binDecoder_job));
+    job.N_dirs = N_dirs;
+    job.nSH = nSH;
+    job.hrtfs = hrtfs;
+    job.w = w;
+    job.Y_na = Y_na;
+    job.Yna_W = Yna_W;
+    job.Yna_W_Yna = Yna_W_Yna;
+    job.decMtx = decMtx;
+    saf_parfor_run(hPar, &binDecoderLS_range, (void*)&job, band_cutoff+1);
+
+    /* Above the cutoff, the phase of each band is taken from the decoder of the
+     * previous band; so these are computed in series */
     Yna_W_H = malloc1d(nSH * 2 * sizeof(float_complex));
     B_magls = malloc1d(nSH * 2 * sizeof(float_complex));
-    hrtfs_ls = malloc1d(2*N_dirs*sizeof(float_complex));
     H_mod = malloc1d(2*N_dirs*sizeof(float_complex));
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, N_dirs, N_dirs, &calpha,
-                Y_na, N_dirs,
-                W, N_dirs, &cbeta,
-                Yna_W, N_dirs);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, N_dirs, &calpha,
-                Yna_W, N_dirs,
-                Y_na, N_dirs, &cbeta,
-                Yna_W_Yna, nSH);
-    for (band=0; band<N_bands; band++){
-        if(band<=band_cutoff){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
-                        Yna_W, N_dirs,
-                        &hrtfs[band*2*N_dirs], N_dirs, &cbeta,
-                        Yna_W_H, 2);
-            utility_cglslv(Yna_W_Yna, nSH, Yna_W_H, 2, B_magls);
-        }
-        else{
-            /* Remove itd from high frequency HRTFs */
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, N_dirs, nSH, &calpha,
-                        &decMtx[(band-1)*2*nSH] , nSH,
-                        Y_na, N_dirs, &cbeta,
-                        H_mod, N_dirs);
-            for(i=0; i<2*N_dirs; i++)
-                H_mod[i] = ccmulf(cmplxf(cabsf(hrtfs[band*2*N_dirs + i]), 0.0f), cexpf(cmplxf(0.0f, atan2f(cimagf(H_mod[i]), crealf(H_mod[i])))));
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
-                        Yna_W, N_dirs,
-                        H_mod, N_dirs, &cbeta,
-                        Yna_W_H, 2);
-            utility_cglslv(Yna_W_Yna, nSH, Yna_W_H, 2, B_magls);
-        }
-        
+    utility_cglslv_create(&hSlv, nSH, 2);
+    for (band=band_cutoff+1; band<N_bands; band++){
+        /* Remove itd from high frequency HRTFs */
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, N_dirs, nSH, &calpha,
+                    &decMtx[(band-1)*2*nSH] , nSH,
+                    Y_na, N_dirs, &cbeta,
+                    H_mod, N_dirs);
+        for(i=0; i<2*N_dirs; i++)
+            H_mod[i] = ccmulf(cmplxf(cabsf(hrtfs[band*2*N_dirs + i]), 0.0f), cexpf(cmplxf(0.0f, atan2f(cimagf(H_mod[i]), crealf(H_mod[i])))));
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 2, N_dirs, &calpha,
+                    Yna_W, N_dirs,
+                    H_mod, N_dirs, &cbeta,
+                    Yna_W_H, 2);
+        utility_cglslv(hSlv, Yna_W_Yna, nSH, Yna_W_H, 2, B_magls);
+
         for(i=0; i<nSH; i++)
             for(j=0; j<2; j++)
                 decMtx[band*2*nSH + j*nSH + i] = conjf(B_magls[i*2+j]); /* ^H */
     }
-    
-    free(W);
+
+    utility_cglslv_destroy(&hSlv);
+    free(w);
     free(Y_na);
+    free(Yna_W);
     free(Yna_W_Yna);
     free(Yna_W_H);
     free(B_magls);
-    free(hrtfs_ls);
     free(H_mod);
 }
 
@@ -113,6 +113,8 @@ void getAllRAD(/* Input Arguments */
  *       in the higher-order components. This actually gets worse the more HRTFs
  *       you have.
  *
+ * @param[in]  hPar          saf_parfor handle, over which the bands are split
+ *                           (see saf_parfor_create()); or NULL
  * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
  * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
  * @param[in]  N_dirs        Number of HRTF directions in set
@@ -124,6 +126,7 @@ void getAllRAD(/* Input Arguments */
  *                           FLAT: N_bands x NUM_EARS x (order+1)^2
  */
 void getBinDecoder_LS(/* Input Arguments */
+                      void* const hPar,
                       float_complex* hrtfs,
                       float* hrtf_dirs_deg,
                       int N_dirs,
@@ -144,6 +147,8 @@ void getBinDecoder_LS(/* Input Arguments */
  * @note This equalisation mitagates some of the timbral colourations exhibited
  *       by standard LS decoding; especially at lower input orders.
  *
+ * @param[in]  hPar          saf_parfor handle, over which the bands are split
+ *                           (see saf_parfor_create()); or NULL
  * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
  * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
  * @param[in]  N_dirs        Number of HRTF directions in set
@@ -160,6 +165,7 @@ void getBinDecoder_LS(/* Input Arguments */
  *          Society of America, vol. 141, no. 6, pp. 4087--4096, 2017.
  */
 void getBinDecoder_LSDIFFEQ(/* Input Arguments */
+                            void* const hPar,
                             float_complex* hrtfs,
                             float* hrtf_dirs_deg,
                             int N_dirs,
@@ -187,6 +193,8 @@ void getBinDecoder_LSDIFFEQ(/* Input Arguments */
  *       discarding it, due to order truncation, the energy is instead aliased
  *       back into the lower-order components and preserved.
  *
+ * @param[in]  hPar          saf_parfor handle, over which the bands are split
+ *                           (see saf_parfor_create()); or NULL
  * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
  * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
  * @param[in]  N_dirs        Number of HRTF directions in set
@@ -202,6 +210,7 @@ void getBinDecoder_LSDIFFEQ(/* Input Arguments */
  *          united with Acustica, vol. 100, no. 5, pp. 972--983, 2014.
  */
 void getBinDecoder_SPR(/* Input Arguments */
+                       void* const hPar,
                        float_complex* hrtfs,
                        float* hrtf_dirs_deg,
                        int N_dirs,
@@ -240,6 +249,8 @@ void getBinDecoder_SPR(/* Input Arguments */
  *       impose it on any binaural decoder using the applyDiffCovMatching()
  *       function.
  *
+ * @param[in]  hPar          saf_parfor handle, over which the bands are split
+ *                           (see saf_parfor_create()); or NULL
  * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
  * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
  * @param[in]  N_dirs        Number of HRTF directions in set
@@ -259,6 +270,7 @@ void getBinDecoder_SPR(/* Input Arguments */
  *          of America. 2018 Jun 19;143(6):3616--27
  */
 void getBinDecoder_TA(/* Input Arguments */
+                      void* const hPar,
                       float_complex* hrtfs,
                       float* hrtf_dirs_deg,
                       int N_dirs,
@@ -282,6 +294,8 @@ void getBinDecoder_TA(/* Input Arguments */
  *       differing in the manner in which the phase is neglected at frequencies
  *       above 1.5kHz.
  *
+ * @param[in]  hPar          saf_parfor handle, over which the bands are split
+ *                           (see saf_parfor_create()); or NULL
  * @param[in]  hrtfs         The HRTFs; FLAT: N_bands x NUM_EARS x N_dirs
  * @param[in]  hrtf_dirs_deg HRTF directions; FLAT: N_dirs x 2
  * @param[in]  N_dirs        Number of HRTF directions in set
@@ -299,6 +313,7 @@ void getBinDecoder_TA(/* Input Arguments */
  * @see [2] Zotter, F., & Frank, M. (2019). Ambisonics. Springer Open.
  */
 void getBinDecoder_MAGLS(/* Input Arguments */
+                         void* const hPar,
                          float_complex* hrtfs,
                          float* hrtf_dirs_deg,
                          int N_dirs,
@@ -0,0 +1,718 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_hoa_reverb.c
+ * @brief Feedback delay network (FDN) reverb, which outputs directly in the
+ *        spherical harmonic domain (or for a loudspeaker layout); and
+ *        image-source early reflections for shoebox rooms
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_hoa.h"
+#include "saf_hoa_internal.h"
+
+/** Shortest delay line, in seconds */
+#define AMBI_REVERB_MIN_DELAY_S ( 0.020f )
+/** Longest delay line, in seconds */
+#define AMBI_REVERB_MAX_DELAY_S ( 0.060f )
+/** Maximum number of samples processed at a time (also bounded by the shortest
+ *  delay line) */
+#define AMBI_REVERB_MAX_SUBBLOCK_SIZE ( 512 )
+/** Maximum number of samples processed at a time by the early reflections */
+#define AMBI_EARLY_REFL_SUBBLOCK_SIZE ( 256 )
+/** Speed of sound, m/s */
+#define AMBI_EARLY_REFL_SPEED_OF_SOUND ( 343.0f )
+/** Closest (image) source distance, in metres (avoids the 1/r singularity) */
+#define AMBI_EARLY_REFL_MIN_DISTANCE ( 0.1f )
+
+/** Data structure for the ambisonic reverb */
+typedef struct _ambiReverb_data {
+    int order, nSH, nLines, nOut;
+    float fs;
+    int* delay;         /**< delay of each line, in samples; nLines x 1 */
+    int* offset;        /**< start of each line in 'ring'; nLines x 1 */
+    int* wIdx;          /**< current read/write index of each line; nLines x 1 */
+    float* ring;        /**< all delay lines; sum(delay) x 1 */
+    int ringLen;        /**< total length of 'ring' */
+    int subBlockSize;   /**< number of samples processed at a time */
+    float* filtA;       /**< absorption filter feed-forward gains; nLines x 1 */
+    float* filtB;       /**< absorption filter feedback gains; nLines x 1 */
+    float* filtZ;       /**< absorption filter states; nLines x 1 */
+    float* Y;           /**< spherical harmonics of the line directions; FLAT: nSH x nLines */
+    float* Yin;         /**< input sampling matrix (scaled Y); FLAT: nSH x nLines */
+    float* Dout;        /**< output encoding/decoding matrix; FLAT: nOut x nLines */
+    float* inBuf;       /**< input sub-block; FLAT: nSH x subBlockSize */
+    float* lineIn;      /**< input to the lines; FLAT: subBlockSize x nLines */
+    float* work;        /**< line outputs, then line inputs; FLAT: subBlockSize x nLines */
+    float* filt;        /**< filtered line outputs; FLAT: subBlockSize x nLines */
+    float* outBuf;      /**< output sub-block; FLAT: nOut x subBlockSize */
+
+}ambiReverb_data;
+
+/** Data structure for the early reflections engine */
+typedef struct _ambiEarlyRefl_data {
+    int order, nSH, maxNumSources;
+    float fs;
+    float dims[3];       /**< room dimensions, in metres */
+    float beta[6];       /**< wall reflection coefficients */
+    float* srcPos;       /**< source positions; FLAT: maxNumSources x 3 */
+    float rcvPos[3];     /**< receiver position */
+    int maxReflOrder;    /**< highest reflection order */
+    float minGain_dB;    /**< culling threshold, relative to the direct path */
+    int includeDirect;   /**< 1: the direct path is also rendered */
+    int capacity;        /**< max number of reflections (for maxReflOrder) */
+    int nRefl;           /**< number of rendered reflections */
+    int* reflSrc;        /**< source of each reflection; capacity x 1 */
+    float* reflDelay;    /**< delay of each reflection, in samples; capacity x 1 */
+    float* reflGain;     /**< gain of each reflection; capacity x 1 */
+    float* cx, *cy, *cz; /**< unit vectors of the reflections; capacity x 1 */
+    float* Y;            /**< spherical harmonics; FLAT: nSH x nRefl */
+    float* Yg;           /**< encoding matrix (Y with the gains); FLAT: nSH x capacity */
+    float* ring;         /**< delay lines of the sources; FLAT: maxNumSources x ringLen */
+    int ringLen;         /**< length of each delay line (a power of 2) */
+    int wIdx;            /**< current write index of the delay lines */
+    float* R;            /**< delayed reflection signals; FLAT: nRefl x subBlockSize */
+    float* outBuf;       /**< output sub-block; FLAT: nSH x subBlockSize */
+
+}ambiEarlyRefl_data;
+
+/** Returns the smallest prime number of at least 'n' */
+static int ambiReverb_nextPrime(int n)
+{
+    int i, isPrime;
+
+    for(n = MAX(n, 2);; n++){
+        isPrime = 1;
+        for(i=2; i*i<=n && isPrime; i++)
+            isPrime = n%i != 0;
+        if(isPrime)
+            return n;
+    }
+}
+
+void ambiReverb_create
+(
+    void ** const phRev,
+    int order,
+    float fs,
+    int nLines
+)
+{
+    ambiReverb_data *h;
+    int i, k, minDelay, prevDelay;
+    float z, sqrtN;
+    float* dirs_deg;
+
+    h = (ambiReverb_data*)malloc1d(sizeof(ambiReverb_data));
+    *phRev = (void*)h;
+    h->order = MAX(order, 0);
+    h->nSH = ORDER2NSH(h->order);
+    h->fs = fs;
+    if(nLines<=0)
+        nLines = MAX(h->nSH, 16);
+    nLines = CLAMP(nLines, AMBI_REVERB_MIN_NUM_LINES, AMBI_REVERB_MAX_NUM_LINES);
+    for(h->nLines = AMBI_REVERB_MIN_NUM_LINES; h->nLines<nLines; h->nLines *= 2) {}
+    h->nOut = h->nSH;
+
+    /* mutually prime delays, spaced geometrically, and packed into one buffer;
+     * the delays are interleaved over the line directions, such that the
+     * shorter and longer lines are spread evenly over the sphere */
+    h->delay = malloc1d(h->nLines*sizeof(int));
+    h->offset = malloc1d(h->nLines*sizeof(int));
+    h->wIdx = malloc1d(h->nLines*sizeof(int));
+    prevDelay = 0;
+    for(i=0; i<h->nLines; i++){
+        k = (i*37) % h->nLines;
+        h->delay[k] = (int)(AMBI_REVERB_MIN_DELAY_S*fs*powf(AMBI_REVERB_MAX_DELAY_S/AMBI_REVERB_MIN_DELAY_S,
+                                                           (float)i/(float)(h->nLines-1)) + 0.5f);
+        h->delay[k] = ambiReverb_nextPrime(MAX(h->delay[k], prevDelay+1));
+        prevDelay = h->delay[k];
+    }
+    h->ringLen = 0;
+    minDelay = h->delay[0];
+    for(i=0; i<h->nLines; i++){
+        h->offset[i] = h->ringLen;
+        h->ringLen += h->delay[i];
+        minDelay = MIN(minDelay, h->delay[i]);
+    }
+    h->ring = malloc1d(h->ringLen*sizeof(float));
+    h->subBlockSize = MIN(minDelay, AMBI_REVERB_MAX_SUBBLOCK_SIZE);
+
+    /* line directions, spread uniformly over the sphere (Fibonacci lattice) */
+    dirs_deg = malloc1d(h->nLines*2*sizeof(float));
+    for(i=0; i<h->nLines; i++){
+        z = 1.0f - (2.0f*(float)i+1.0f)/(float)h->nLines;
+        dirs_deg[i*2]   = fmodf((float)i*180.0f*(3.0f-sqrtf(5.0f)), 360.0f);
+        dirs_deg[i*2]  -= dirs_deg[i*2] > 180.0f ? 360.0f : 0.0f;
+        dirs_deg[i*2+1] = asinf(z)*180.0f/M_PI;
+    }
+    h->Y = malloc1d(h->nSH*h->nLines*sizeof(float));
+    getRSH(h->order, dirs_deg, h->nLines, h->Y);
+    free(dirs_deg);
+
+    /* The lines sample the input sound-field in their directions; scaled such
+     * that a plane wave feeds the network with the energy of its omni
+     * component. The line outputs are encoded as plane waves, such that the
+     * omni component carries the mean energy of the lines. */
+    sqrtN = sqrtf((float)h->nLines);
+    h->Yin = malloc1d(h->nSH*h->nLines*sizeof(float));
+    h->Dout = malloc1d(h->nOut*h->nLines*sizeof(float));
+    for(i=0; i<h->nSH*h->nLines; i++){
+        h->Yin[i] = h->Y[i]/sqrtf((float)(h->nLines*h->nSH));
+        h->Dout[i] = h->Y[i]/sqrtN;
+    }
+
+    h->filtA = malloc1d(h->nLines*sizeof(float));
+    h->filtB = malloc1d(h->nLines*sizeof(float));
+    h->filtZ = malloc1d(h->nLines*sizeof(float));
+    h->inBuf = malloc1d(h->nSH*h->subBlockSize*sizeof(float));
+    h->lineIn = malloc1d(h->subBlockSize*h->nLines*sizeof(float));
+    h->work = malloc1d(h->subBlockSize*h->nLines*sizeof(float));
+    h->filt = malloc1d(h->subBlockSize*h->nLines*sizeof(float));
+    h->outBuf = malloc1d(h->nOut*h->subBlockSize*sizeof(float));
+    ambiReverb_setT60(*phRev, 1.5f, 0.5f);
+    ambiReverb_reset(*phRev);
+}
+
+void ambiReverb_destroy
+(
+    void ** const phRev
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(*phRev);
+
+    if(h!=NULL){
+        free(h->delay);
+        free(h->offset);
+        free(h->wIdx);
+        free(h->ring);
+        free(h->filtA);
+        free(h->filtB);
+        free(h->filtZ);
+        free(h->Y);
+        free(h->Yin);
+        free(h->Dout);
+        free(h->inBuf);
+        free(h->lineIn);
+        free(h->work);
+        free(h->filt);
+        free(h->outBuf);
+        free(h);
+        *phRev = NULL;
+    }
+}
+
+void ambiReverb_reset
+(
+    void * const hRev
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+
+    memset(h->wIdx, 0, h->nLines*sizeof(int));
+    memset(h->ring, 0, h->ringLen*sizeof(float));
+    memset(h->filtZ, 0, h->nLines*sizeof(float));
+}
+
+void ambiReverb_setT60
+(
+    void * const hRev,
+    float t60_lf,
+    float t60_hf
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+    int i;
+    float g_dc, g_nyq;
+
+    t60_lf = MAX(t60_lf, 0.01f);
+    t60_hf = CLAMP(t60_hf, 0.01f, t60_lf);
+    for(i=0; i<h->nLines; i++){
+        /* one-pole lowpass, a/(1-b*z^-1), with the (per line) gains at DC and
+         * Nyquist that give the requested T60s */
+        g_dc  = powf(10.0f, -3.0f*(float)h->delay[i]/(h->fs*t60_lf));
+        g_nyq = powf(10.0f, -3.0f*(float)h->delay[i]/(h->fs*t60_hf));
+        h->filtB[i] = (g_dc-g_nyq)/(g_dc+g_nyq);
+        h->filtA[i] = g_dc*(1.0f-h->filtB[i]);
+    }
+}
+
+void ambiReverb_setLoudspeakers
+(
+    void * const hRev,
+    float* ls_dirs_deg,
+    int nLS,
+    LOUDSPEAKER_AMBI_DECODER_METHODS method,
+    int enableMaxrE
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+    int i;
+    float* decMtx;
+
+    if(ls_dirs_deg==NULL || nLS<=0){
+        h->nOut = h->nSH;
+        h->Dout = realloc1d(h->Dout, h->nOut*h->nLines*sizeof(float));
+        for(i=0; i<h->nSH*h->nLines; i++)
+            h->Dout[i] = h->Y[i]/sqrtf((float)h->nLines);
+    }
+    else{
+        h->nOut = nLS;
+        h->Dout = realloc1d(h->Dout, h->nOut*h->nLines*sizeof(float));
+        decMtx = malloc1d(nLS*h->nSH*sizeof(float));
+        getLoudspeakerAmbiDecoderMtx(ls_dirs_deg, nLS, method, h->order, enableMaxrE, decMtx);
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLS, h->nLines, h->nSH, 1.0f/sqrtf((float)h->nLines),
+                    decMtx, h->nSH, h->Y, h->nLines, 0.0f, h->Dout, h->nLines);
+        free(decMtx);
+    }
+    h->outBuf = realloc1d(h->outBuf, h->nOut*h->subBlockSize*sizeof(float));
+}
+
+int ambiReverb_getNumLines
+(
+    void * const hRev
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+    return h->nLines;
+}
+
+int ambiReverb_getNumOutputs
+(
+    void * const hRev
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+    return h->nOut;
+}
+
+void ambiReverb_apply
+(
+    void * const hRev,
+    float** input,
+    int nInputs,
+    int nSamples,
+    float** output
+)
+{
+    ambiReverb_data *h = (ambiReverb_data*)(hRev);
+    int s, L, t, k, ch, i, j, hh, d, w, N;
+    float u, v, fbScale;
+    float *x, *y, *ring;
+
+    N = h->nLines;
+    fbScale = 1.0f/sqrtf((float)N); /* (normalises the Hadamard matrix) */
+    nInputs = MIN(nInputs, h->nSH);
+    for(s=0; s<nSamples; s+=L){
+        /* Since no line is shorter than the sub-block, the lines may be read
+         * for the whole sub-block before any of them are written */
+        L = MIN(h->subBlockSize, nSamples-s);
+
+        /* sample the input sound-field in the line directions */
+        if(nInputs>0){
+            for(ch=0; ch<nInputs; ch++)
+                memcpy(&(h->inBuf[ch*L]), &(input[ch][s]), L*sizeof(float));
+            cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, L, N, nInputs, 1.0f,
+                        h->inBuf, L, h->Yin, N, 0.0f, h->lineIn, N);
+        }
+        else
+            memset(h->lineIn, 0, L*N*sizeof(float));
+
+        /* read the line outputs (into time x line order) */
+        for(k=0; k<N; k++){
+            ring = &(h->ring[h->offset[k]]);
+            d = h->delay[k];
+            w = h->wIdx[k];
+            for(t=0; t<L; t++){
+                h->work[t*N+k] = ring[w];
+                if(++w==d)
+                    w = 0;
+            }
+        }
+
+        /* absorption filters and feedback, for all lines at once per sample */
+        for(t=0; t<L; t++){
+            x = &(h->work[t*N]);
+            y = &(h->filt[t*N]);
+            for(k=0; k<N; k++){
+                y[k] = h->filtA[k]*x[k] + h->filtB[k]*h->filtZ[k];
+                h->filtZ[k] = y[k];
+            }
+
+            /* fast Walsh-Hadamard transform (in place) */
+            memcpy(x, y, N*sizeof(float));
+            for(hh=1; hh<N; hh*=2){
+                for(i=0; i<N; i+=2*hh){
+                    for(j=i; j<i+hh; j++){
+                        u = x[j];
+                        v = x[j+hh];
+                        x[j] = u+v;
+                        x[j+hh] = u-v;
+                    }
+                }
+            }
+            for(k=0; k<N; k++)
+                x[k] = fbScale*x[k] + h->lineIn[t*N+k];
+        }
+
+        /* write the line inputs */
+        for(k=0; k<N; k++){
+            ring = &(h->ring[h->offset[k]]);
+            d = h->delay[k];
+            w = h->wIdx[k];
+            for(t=0; t<L; t++){
+                ring[w] = h->work[t*N+k];
+                if(++w==d)
+                    w = 0;
+            }
+            h->wIdx[k] = w;
+        }
+
+        /* encode (or decode) the filtered line outputs */
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, h->nOut, L, N, 1.0f,
+                    h->Dout, N, h->filt, N, 0.0f, h->outBuf, L);
+        for(ch=0; ch<h->nOut; ch++)
+            memcpy(&(output[ch][s]), &(h->outBuf[ch*L]), L*sizeof(float));
+    }
+}
+
+/** Returns the number of image sources of up to 'maxOrder' reflections */
+static int ambiEarlyRefl_numImages(int maxOrder)
+{
+    return (2*maxOrder+1)*(2*maxOrder*maxOrder+2*maxOrder+3)/3;
+}
+
+/** (Re)allocates the delay lines, if they are too short for the room and the
+ *  reflection order */
+static void ambiEarlyRefl_checkRingLength(ambiEarlyRefl_data* h)
+{
+    int len;
+    float maxDist;
+
+    /* (no image source of up to maxReflOrder reflections is further away than
+     * maxReflOrder+1 room dimensions along each axis) */
+    maxDist = (float)(h->maxReflOrder+1) * sqrtf(h->dims[0]*h->dims[0] + h->dims[1]*h->dims[1] + h->dims[2]*h->dims[2]);
+    for(len=1; len<(int)(maxDist/AMBI_EARLY_REFL_SPEED_OF_SOUND*h->fs)+4+AMBI_EARLY_REFL_SUBBLOCK_SIZE; len*=2) {}
+    if(len>h->ringLen){
+        h->ringLen = len;
+        h->ring = realloc1d(h->ring, h->maxNumSources*h->ringLen*sizeof(float));
+        ambiEarlyRefl_reset((void*)h);
+    }
+}
+
+/** Finds the image sources, culls them, and computes the encoding matrix */
+static void ambiEarlyRefl_update(ambiEarlyRefl_data* h)
+{
+    int s, i, j, k, r, n, n0, ord, hits[6];
+    float img[3], d[3], dist, gain, directGain, minGain, scale;
+    float* dirs_rad;
+    const float* src;
+
+    minGain = powf(10.0f, h->minGain_dB/20.0f);
+    h->nRefl = 0;
+    for(s=0; s<h->maxNumSources; s++){
+        src = &(h->srcPos[s*3]);
+        for(n=0; n<3; n++)
+            d[n] = src[n] - h->rcvPos[n];
+        directGain = 1.0f/MAX(sqrtf(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]), AMBI_EARLY_REFL_MIN_DISTANCE);
+        for(i=-h->maxReflOrder; i<=h->maxReflOrder; i++){
+            for(j=-h->maxReflOrder+abs(i); j<=h->maxReflOrder-abs(i); j++){
+                for(k=-h->maxReflOrder+abs(i)+abs(j); k<=h->maxReflOrder-abs(i)-abs(j); k++){
+                    ord = abs(i)+abs(j)+abs(k);
+                    if(ord==0 && !h->includeDirect)
+                        continue;
+
+                    /* image position along each axis: even indices are
+                     * translations of the source, odd indices mirror it; with
+                     * |index| reflections, split between the two walls */
+                    for(n=0; n<3; n++){
+                        n0 = n==0 ? i : (n==1 ? j : k);
+                        img[n] = (float)n0*h->dims[n] + (abs(n0)%2==0 ? src[n] : h->dims[n]-src[n]);
+                        hits[2*n]   = n0>=0 ? abs(n0)/2 : (abs(n0)+1)/2; /* (wall at 0) */
+                        hits[2*n+1] = n0>=0 ? (abs(n0)+1)/2 : abs(n0)/2; /* (wall at dims[n]) */
+                        d[n] = img[n] - h->rcvPos[n];
+                    }
+                    dist = MAX(sqrtf(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]), AMBI_EARLY_REFL_MIN_DISTANCE);
+                    gain = 1.0f/dist;
+                    for(n=0; n<6; n++)
+                        gain *= hits[n]==0 ? 1.0f : powf(h->beta[n], (float)hits[n]);
+                    if(ord>0 && gain<minGain*directGain)
+                        continue;
+
+                    r = h->nRefl++;
+                    h->reflSrc[r] = s;
+                    h->reflDelay[r] = MAX(dist/AMBI_EARLY_REFL_SPEED_OF_SOUND*h->fs, 1.0f);
+                    h->reflGain[r] = gain;
+                    h->cx[r] = d[0]/dist;
+                    h->cy[r] = d[1]/dist;
+                    h->cz[r] = d[2]/dist;
+                }
+            }
+        }
+    }
+    if(h->nRefl==0)
+        return;
+
+    /* spherical harmonics of all reflections at once */
+    if(h->order<=SH_FAST_MAX_ORDER)
+        getSHreal_fastCart(h->order, h->cx, h->cy, h->cz, h->nRefl, h->Y);
+    else{
+        dirs_rad = malloc1d(h->nRefl*2*sizeof(float));
+        for(r=0; r<h->nRefl; r++){
+            dirs_rad[r*2]   = atan2f(h->cy[r], h->cx[r]);
+            dirs_rad[r*2+1] = acosf(CLAMP(h->cz[r], -1.0f, 1.0f));
+        }
+        getSHreal_fast(h->order, dirs_rad, h->nRefl, h->Y);
+        free(dirs_rad);
+    }
+    scale = sqrtf(4.0f*M_PI); /* (N3D, i.e. without the 1/sqrt(4*pi) term) */
+    for(n=0; n<h->nSH; n++)
+        for(r=0; r<h->nRefl; r++)
+            h->Yg[n*h->capacity+r] = scale * h->Y[n*h->nRefl+r] * h->reflGain[r];
+}
+
+void ambiEarlyRefl_create
+(
+    void ** const phER,
+    int order,
+    float fs,
+    int maxNumSources
+)
+{
+    ambiEarlyRefl_data *h;
+    int s;
+    float dims[3] = {6.0f, 5.0f, 3.0f};
+    float absorption[6] = {0.3f, 0.3f, 0.3f, 0.3f, 0.3f, 0.3f};
+
+    h = (ambiEarlyRefl_data*)malloc1d(sizeof(ambiEarlyRefl_data));
+    *phER = (void*)h;
+    h->order = MAX(order, 0);
+    h->nSH = ORDER2NSH(h->order);
+    h->fs = fs;
+    h->maxNumSources = MAX(maxNumSources, 1);
+    h->srcPos = malloc1d(h->maxNumSources*3*sizeof(float));
+    h->capacity = 0;
+    h->nRefl = 0;
+    h->reflSrc = NULL;
+    h->reflDelay = h->reflGain = h->cx = h->cy = h->cz = h->Y = h->Yg = h->R = NULL;
+    h->ring = NULL;
+    h->ringLen = 0;
+    h->outBuf = malloc1d(h->nSH*AMBI_EARLY_REFL_SUBBLOCK_SIZE*sizeof(float));
+    h->maxReflOrder = 3;
+    h->minGain_dB = -60.0f;
+    h->includeDirect = 0;
+    memcpy(h->dims, dims, 3*sizeof(float));
+    h->rcvPos[0] = dims[0]/2.0f;
+    h->rcvPos[1] = dims[1]/2.0f;
+    h->rcvPos[2] = dims[2]/2.0f;
+    for(s=0; s<h->maxNumSources; s++){
+        h->srcPos[s*3]   = h->rcvPos[0] + 1.5f;
+        h->srcPos[s*3+1] = h->rcvPos[1];
+        h->srcPos[s*3+2] = h->rcvPos[2];
+    }
+    ambiEarlyRefl_setCulling(*phER, h->maxReflOrder, h->minGain_dB, h->includeDirect);
+    ambiEarlyRefl_setRoom(*phER, dims, absorption);
+}
+
+void ambiEarlyRefl_destroy
+(
+    void ** const phER
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(*phER);
+
+    if(h!=NULL){
+        free(h->srcPos);
+        free(h->reflSrc);
+        free(h->reflDelay);
+        free(h->reflGain);
+        free(h->cx);
+        free(h->cy);
+        free(h->cz);
+        free(h->Y);
+        free(h->Yg);
+        free(h->ring);
+        free(h->R);
+        free(h->outBuf);
+        free(h);
+        *phER = NULL;
+    }
+}
+
+void ambiEarlyRefl_reset
+(
+    void * const hER
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+
+    h->wIdx = 0;
+    if(h->ring!=NULL)
+        memset(h->ring, 0, h->maxNumSources*h->ringLen*sizeof(float));
+}
+
+void ambiEarlyRefl_setRoom
+(
+    void * const hER,
+    float dims[3],
+    float absorption[6]
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    int n, s;
+
+    for(n=0; n<3; n++)
+        h->dims[n] = MAX(dims[n], 0.1f);
+    for(n=0; n<6; n++)
+        h->beta[n] = sqrtf(1.0f - CLAMP(absorption[n], 0.0f, 1.0f));
+    for(n=0; n<3; n++){
+        h->rcvPos[n] = CLAMP(h->rcvPos[n], 0.0f, h->dims[n]);
+        for(s=0; s<h->maxNumSources; s++)
+            h->srcPos[s*3+n] = CLAMP(h->srcPos[s*3+n], 0.0f, h->dims[n]);
+    }
+    ambiEarlyRefl_checkRingLength(h);
+    ambiEarlyRefl_update(h);
+}
+
+void ambiEarlyRefl_setSourcePosition
+(
+    void * const hER,
+    int src,
+    float pos[3]
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    int n;
+
+    if(src<0 || src>=h->maxNumSources)
+        return;
+    for(n=0; n<3; n++)
+        h->srcPos[src*3+n] = CLAMP(pos[n], 0.0f, h->dims[n]);
+    ambiEarlyRefl_update(h);
+}
+
+void ambiEarlyRefl_setReceiverPosition
+(
+    void * const hER,
+    float pos[3]
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    int n;
+
+    for(n=0; n<3; n++)
+        h->rcvPos[n] = CLAMP(pos[n], 0.0f, h->dims[n]);
+    ambiEarlyRefl_update(h);
+}
+
+void ambiEarlyRefl_setCulling
+(
+    void * const hER,
+    int maxReflOrder,
+    float minGain_dB,
+    int includeDirectFLAG
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    int capacity;
+
+    h->maxReflOrder = CLAMP(maxReflOrder, 0, AMBI_EARLY_REFL_MAX_ORDER);
+    h->minGain_dB = minGain_dB;
+    h->includeDirect = includeDirectFLAG ? 1 : 0;
+    capacity = h->maxNumSources*ambiEarlyRefl_numImages(h->maxReflOrder);
+    if(capacity>h->capacity){
+        h->capacity = capacity;
+        h->reflSrc = realloc1d(h->reflSrc, h->capacity*sizeof(int));
+        h->reflDelay = realloc1d(h->reflDelay, h->capacity*sizeof(float));
+        h->reflGain = realloc1d(h->reflGain, h->capacity*sizeof(float));
+        h->cx = realloc1d(h->cx, h->capacity*sizeof(float));
+        h->cy = realloc1d(h->cy, h->capacity*sizeof(float));
+        h->cz = realloc1d(h->cz, h->capacity*sizeof(float));
+        h->Y = realloc1d(h->Y, h->nSH*h->capacity*sizeof(float));
+        h->Yg = realloc1d(h->Yg, h->nSH*h->capacity*sizeof(float));
+        h->R = realloc1d(h->R, h->capacity*AMBI_EARLY_REFL_SUBBLOCK_SIZE*sizeof(float));
+    }
+    if(h->ringLen>0){ /* (i.e. not while being created) */
+        ambiEarlyRefl_checkRingLength(h);
+        ambiEarlyRefl_update(h);
+    }
+}
+
+int ambiEarlyRefl_getNumReflections
+(
+    void * const hER
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    return h->nRefl;
+}
+
+void ambiEarlyRefl_apply
+(
+    void * const hER,
+    float** input,
+    int nInputs,
+    int nSamples,
+    float** output
+)
+{
+    ambiEarlyRefl_data *h = (ambiEarlyRefl_data*)(hER);
+    int s, L, t, r, ch, src, mask, idx;
+    float f, h0, h1, h2, h3;
+    float *ring, *Rr;
+
+    mask = h->ringLen-1;
+    nInputs = MIN(nInputs, h->maxNumSources);
+    for(s=0; s<nSamples; s+=L){
+        L = MIN(AMBI_EARLY_REFL_SUBBLOCK_SIZE, nSamples-s);
+
+        /* write the sub-block into the delay lines of the sources */
+        for(src=0; src<h->maxNumSources; src++){
+            ring = &(h->ring[src*h->ringLen]);
+            for(t=0; t<L; t++)
+                ring[(h->wIdx+t)&mask] = src<nInputs ? input[src][s+t] : 0.0f;
+        }
+
+        /* read each reflection, with a fractional delay (3rd order Lagrange,
+         * with the fractional part between the 2nd and 3rd taps) */
+        for(r=0; r<h->nRefl; r++){
+            ring = &(h->ring[h->reflSrc[r]*h->ringLen]);
+            Rr = &(h->R[r*L]);
+            idx = (int)h->reflDelay[r] - 1;
+            f = h->reflDelay[r] - (float)idx;
+            h0 = -(f-1.0f)*(f-2.0f)*(f-3.0f)/6.0f;
+            h1 =  f*(f-2.0f)*(f-3.0f)/2.0f;
+            h2 = -f*(f-1.0f)*(f-3.0f)/2.0f;
+            h3 =  f*(f-1.0f)*(f-2.0f)/6.0f;
+            idx = h->wIdx - idx + h->ringLen;
+            for(t=0; t<L; t++, idx++)
+                Rr[t] = h0*ring[idx&mask] + h1*ring[(idx-1)&mask] + h2*ring[(idx-2)&mask] + h3*ring[(idx-3)&mask];
+        }
+        h->wIdx = (h->wIdx+L)&mask;
+
+        /* encode all of the reflections at once */
+        if(h->nRefl>0)
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, h->nSH, L, h->nRefl, 1.0f,
+                        h->Yg, h->capacity, h->R, L, 0.0f, h->outBuf, L);
+        else
+            memset(h->outBuf, 0, h->nSH*L*sizeof(float));
+        for(ch=0; ch<h->nSH; ch++)
+            memcpy(&(output[ch][s]), &(h->outBuf[ch*L]), L*sizeof(float));
+    }
+}
@@ -27,6 +27,8 @@
 
 #include "saf_hrir.h"
 
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
+
 const double __default_hrirs[836][2][1024] = 
 {    
     { { -0.000019403, 0.000019010, -0.000025194, 0.000017182, -0.000023065, 0.000017931, -0.000019809, 0.000017858, -0.000014930, 0.000022881, -0.000016648, 0.000027626, -0.000023156, 0.000024934, -0.000027722, 0.000026520, -0.000024474, 0.000023762, -0.000022363, 0.000015843, -0.000021572, 0.000019656, -0.000021305, 0.000021765, -0.000016061, 0.000023059, -0.000016744, 0.000026372, -0.000024320, 0.000026290, -0.000031564, 0.000029747, -0.000025274, 0.000021778, -0.000023679, 0.000018527, -0.000028330, 0.000021941, -0.000030324, 0.000024161, -0.000021082, 0.000026713, -0.000013526, 0.000027636, -0.000018590, 0.000021597, -0.000021929, 0.000022213, -0.000022880, 0.000021016, -0.000024312, 0.000016927, -0.000025224, 0.000020887, -0.000019483, 0.000023441, -0.000022852, 0.000032150, -0.000020289, 0.000030490, -0.000017252, 0.000019865, -0.000027466, 0.000027085, -0.000029267, 0.000031017, -0.000039307, 0.000029276, -0.000036825, 0.000025043, -0.000032848, 0.000020042, -0.000019121, 0.000028326, -0.000014085, 0.000033985, -0.000018177, 0.000025995, -0.000024404, 0.000022634, -0.000024128, 0.000020971, -0.000028259, 0.000021206, -0.000027061, 0.000024938, -0.000028223, 0.000033512, -0.000027812, 0.000032370, -0.000016239, 0.000030576, -0.000020916, 0.000022279, -0.000024481, 0.000020729, -0.000022293, 0.000027536, -0.000039634, 0.000031569, -0.000045014, 0.000028420, -0.000040160, 0.000023209, -0.000031643, 0.000037694, -0.000016599, 0.000051808, -0.000021869, 0.000038180, -0.000029222, 0.000026344, -0.000035755, 0.000029146, -0.000047612, 0.000031836, -0.000038880, 0.000027879, -0.000028243, 0.000035675, -0.000032006, 0.000039593, -0.000025294, 0.000046504, -0.000024730, 0.000030040, -0.000029711, 0.000028344, -0.000031022, 0.000030347, -0.000040320, 0.000029615, -0.000047462, 0.000027239, -0.000051812, 0.000029403, -0.000042670, 0.000044134, -0.000010885, 0.000058933, -0.000009026, 0.000042861, -0.000033328, 0.000030948, -0.000051513, 0.000013784, -0.000047398, 0.000026773, -0.000034641, 0.000035885, -0.000040735, 0.000038719, -0.000038340, 0.000052103, -0.000023678, 0.000068603, -0.000018634, 0.000038910, -0.000030936, 0.000041389, -0.000044833, 0.000029897, -0.000058263, 0.000031651, -0.000058224, 0.000011980, -0.000065826, 0.000012238, -0.000049902, 0.000045411, -0.000005606, 0.000102383, -0.000001144, 0.000067806, -0.000042946, 0.000032718, -0.000066950, 0.000004435, -0.000080492, 0.000048856, -0.000045460, 0.000067730, -0.000047302, 0.000052435, -0.000055874, 0.000043088, -0.000019511, 0.000109770, 0.000005844, 0.000058357, -0.000039639, 0.000053474, -0.000058285, 0.000006701, -0.000070186, 0.000036288, -0.000093846, -0.000037039, -0.000164285, -0.000059895, -0.000155495, -0.000044982, -0.000032221, 0.000253103, 0.000295783, 0.000435021, 0.000109414, 0.000060139, -0.000180093, -0.000127179, -0.000311160, -0.000128759, -0.000158872, 0.000104660, 0.000018879, 0.000123995, -0.000018914, 0.000124728, -0.000103353, -0.000036362, -0.000141545, 0.000060713, 0.000013708, 0.000084015, -0.000087179, 0.000101279, -0.000002631, 0.000106833, -0.000056141, 0.000036604, -0.000009261, 0.000159132, -0.000052855, 0.000013721, -0.000129924, -0.000000997, -0.000161875, 0.000005407, -0.000112603, 0.000154902, 0.000022298, 0.000147560, -0.000076124, 0.000077421, -0.000106013, 0.000078065, -0.000082970, 0.000094150, -0.000069192, 0.000090771, -0.000108601, 0.000044588, -0.000138842, 0.000047356, -0.000093827, 0.000119673, -0.000077871, 0.000146529, -0.000132761, 0.000161802, -0.000106005, 0.000150667, -0.000079090, 0.000144906, -0.000084738, 0.000110429, -0.000198752, 0.000050845, -0.000201984, 0.000088505, -0.000149614, 0.000243946, -0.000090943, 0.000155219, -0.000072922, 0.000111215, -0.000155070, 0.000133698, -0.000114856, 0.000035807, -0.000121083, 0.000560962, -0.000801692, -0.000253121, 0.001536625, -0.003067430, 0.015318761, 0.080559033, 0.104714054, 0.059728974, 0.036382363, 0.050092865, 0.013658560, -0.008587799, -0.026826992, -0.033953076, -0.010140207, -0.043574071, -0.046630882, 0.048316797, 0.035780552, -0.013586595, 0.009352604, 0.022234109, -0.021279489, -0.012549864, -0.008391912, -0.006265640, 0.000241869, -0.000826564, -0.004180577, 0.001032742, 0.005693864, -0.005676127, 0.005786705, 0.005945598, -0.005816015, -0.008035899, 0.005327704, -0.001990214, -0.007299738, -0.001775647, 0.000834998, -0.000495082, -0.001343193, -0.002146691, -0.000507448, 0.002380365, -0.000350098, -0.002326052, 0.000900466, 0.000885127, -0.000655197, 0.000201040, 0.001405941, -0.000426239, 0.000974427, 0.001851156, 0.001442755, 0.000545942, 0.001047276, 0.000247867, 0.000122572, -0.000851649, -0.000982455, -0.000183461, 0.000734942, -0.000293087, -0.000338956, 0.000180338, 0.000491454, -0.000090825, 0.000193808, 0.000093285, 0.000242415, 0.000067813, 0.000132192, -0.000143860, 0.000204892, 0.000102943, 0.000273978, 0.000125387, 0.000259457, 0.000005575, 0.000344442, 0.000218762, 0.000210845, 0.000021765, 0.000313882, 0.000118577, 0.000162725, -0.000049703, 0.000143310, 0.000011202, 0.000168710, -0.000033891, 0.000117216, 0.000045677, 0.000177996, -0.000017663, 0.000147448, -0.000003764, 0.000124305, 0.000006179, 0.000127689, -0.000026512, 0.000106028, -0.000003185, 0.000130209, -0.000026205, 0.000105436, -0.000019273, 0.000094092, -0.000043347, 0.000045847, -0.000075626, 0.000068747, -0.000070003, 0.000052730, -0.000065625, 0.000058071, -0.000060756, 0.000036055, -0.000096949, 0.000022298, -0.000115837, 0.000018714, -0.000107755, 0.000001528, -0.000101602, 0.000000672, -0.000095411, -0.000011872, -0.000105269, -0.000013485, -0.000106331, -0.000007905, -0.000120107, -0.000010809, -0.000098081, 0.000000419, -0.000077145, 0.000019109, -0.000072302, 0.000027301, -0.000083983, 0.000020306, -0.000079639, 0.000019491, -0.000063758, 0.000025520, -0.000044032, 0.000045632, -0.000028739, 0.000047975, -0.000037813, 0.000046992, -0.000040518, 0.000046935, -0.000022153, 0.000044719, -0.000023537, 0.000047909, -0.000033868, 0.000054812, -0.000035423, 0.000060700, -0.000023005, 0.000053783, -0.000004466, 0.000047781, -0.000006608, 0.000064272, -0.000015823, 0.000073587, -0.000020131, 0.000056950, -0.000027450, 0.000037080, -0.000022538, 0.000035326, -0.000027299, 0.000043933, -0.000024361, 0.000047551, -0.000017540, 0.000040402, -0.000027723, 0.000033916, -0.000036576, 0.000044181, -0.000043833, 0.000044979, -0.000039268, 0.000035234, -0.000037064, 0.000022919, -0.000034257, 0.000030624, -0.000036804, 0.000040588, -0.000048053, 0.000049786, -0.000043375, 0.000040117, -0.000028809, 0.000032534, -0.000026335, 0.000024580, -0.000039448, 0.000023497, -0.000042952, 0.000025612, -0.000037769, 0.000030355, -0.000032409, 0.000031813, -0.000017755, 0.000028645, -0.000025732, 0.000027955, -0.000037955, 0.000036817, -0.000036725, 0.000036964, -0.000040790, 0.000035020, -0.000038397, 0.000027699, -0.000027956, 0.000022953, -0.000025234, 0.000027895, -0.000025428, 0.000032142, -0.000029970, 0.000035751, -0.000026539, 0.000031853, -0.000018590, 0.000014971, -0.000021747, 0.000017603, -0.000032711, 0.000025298, -0.000030586, 0.000032153, -0.000027739, 0.000028034, -0.000016366, 0.000027228, -0.000016226, 0.000013577, -0.000017855, 0.000026574, -0.000028657, 0.000033260, -0.000029822, 0.000027293, -0.000028864, 0.000024611, -0.000027187, 0.000030248, -0.000030157, 0.000028750, -0.000024172, 0.000028526, -0.000022172, 0.000026892, -0.000015757, 0.000025391, -0.000019770, 0.000024044, -0.000030468, 0.000025215, -0.000034239, 0.000026537, -0.000027190, 0.000024903, -0.000023071, 0.000025999, -0.000020846, 0.000031327, -0.000021579, 0.000025124, -0.000024769, 0.000024555, -0.000019797, 0.000017089, -0.000021962, 0.000026785, -0.000030672, 0.000025462, -0.000028171, 0.000029151, -0.000025651, 0.000021801, -0.000022560, 0.000023238, -0.000017808, 0.000020847, -0.000016326, 0.000025332, -0.000017925, 0.000021259, -0.000025671, 0.000021137, -0.000026981, 0.000018743, -0.000022167, 0.000019547, -0.000018066, 0.000017078, -0.000012573, 0.000022252, -0.000017820, 0.000022146, -0.000021544, 0.000024591, -0.000026188, 0.000027292, -0.000026142, 0.000022868, -0.000025536, 0.000020922, -0.000024543, 0.000025592, -0.000025855, 0.000022442, -0.000019590, 0.000023304, -0.000020267, 0.000024270, -0.000018976, 0.000026415, -0.000020387, 0.000020600, -0.000024806, 0.000019546, -0.000024552, 0.000022017, -0.000024340, 0.000024719, -0.000024078, 0.000023019, -0.000018583, 0.000019520, -0.000016078, 0.000019472, -0.000018613, 0.000022091, -0.000021450, 0.000022541, -0.000021705, 0.000022070, -0.000023102, 0.000018943, -0.000017815, 0.000016838, -0.000018940, 0.000018557, -0.000021597, 0.000022498, -0.000019091, 0.000021730, -0.000013992, 0.000018022, -0.000011947, 0.000016624, -0.000018123, 0.000016357, -0.000025723, 0.000023049, -0.000024937, 0.000021121, -0.000020596, 0.000020786, -0.000016489, 0.000018967, -0.000016219, 0.000020993, -0.000019663, 0.000023453, -0.000022218, 0.000025330, -0.000026335, 0.000025128, -0.000025007, 0.000021583, -0.000021926, 0.000019821, -0.000019481, 0.000019050, -0.000020783, 0.000022623, -0.000021635, 0.000025467, -0.000021567, 0.000026525, -0.000021776, 0.000022783, -0.000018747, 0.000014380, -0.000021046, 0.000018636, -0.000021637, 0.000020751, -0.000021687, 0.000022916, -0.000018500, 0.000021898, -0.000017888, 0.000019037, -0.000016109, 0.000019468, -0.000017535, 0.000018142, -0.000019108, 0.000019058, -0.000022747, 0.000020413, -0.000021654, 0.000022383, -0.000021463, 0.000021957, -0.000018854, 0.000018735, -0.000017812, 0.000021462, -0.000018463, 0.000024900, -0.000022557, 0.000023216, -0.000021721, 0.000016450, -0.000017687, 0.000013286, -0.000012317, 0.000015111, -0.000016051, 0.000017793, -0.000015108, 0.000017732, -0.000016158, 0.000017819, -0.000017728, 0.000021082, -0.000017575, 0.000017365, -0.000015764, 0.000017016, -0.000016855, 0.000016737, -0.000018123, 0.000019039, -0.000019725, 0.000021368, -0.000021339, 0.000019049, -0.000018302, 0.000014621, -0.000009704, 0.000015568, -0.000009288, 0.000014296, -0.000015136, 0.000017033, -0.000021250, 0.000018094, -0.000020205, 0.000017972, -0.000016507, 0.000016127, -0.000013016, 0.000016245, -0.000015086, 0.000019494, -0.000017885, 0.000019350, -0.000016511, 0.000013886, -0.000010515, 0.000013630, -0.000015793, 0.000018100, -0.000018647, 0.000018090, -0.000016847, 0.000016944, -0.000019269, 0.000019351, -0.000019930, 0.000019380, -0.000020223, 0.000021277, -0.000015481, 0.000018318, -0.000014319, 0.000016770, -0.000019105, 0.000015732, -0.000019125, 0.000019490, -0.000019479, 0.000020323, -0.000018803, 0.000021204, -0.000018837, 0.000018757, -0.000016968, 0.000020161, -0.000018311, 0.000019292, -0.000020059, 0.000023373, -0.000019728, 0.000016328, -0.000015077, 0.000015481, -0.000017559, 0.000019261, -0.000020126, 0.000017330, -0.000017009, 0.000013653, -0.000011821, 0.000010211, -0.000007256, 0.000013704, -0.000010266, 0.000012422, -0.000014502, 0.000015549, -0.000014348, 0.000011480, -0.000015476, 0.000017643, -0.000016680, 0.000019251, -0.000018884, 0.000020276, -0.000020445, 0.000018194, -0.000014854, 0.000016873, -0.000011747, 0.000010678, -0.000008867, 0.000015770, -0.000021457, 0.000017912, -0.000017673, 0.000017523, -0.000016529, 0.000014610, -0.000017481, 0.000016588, -0.000016749, 0.000016803, -0.000014011, 0.000021078, -0.000015588, 0.000014571, -0.000013907, 0.000016181, -0.000020145, 0.000017930, -0.000017828, 0.000017341, -0.000015820, 0.000019060, -0.000016121, 0.000014359, -0.000015051, 0.000016118, -0.000017344, 0.000022127, -0.000021330, 0.000021683, -0.000015832, 0.000015682, -0.000015303, 0.000015870, -0.000014474, 0.000014726, -0.000015140, 0.000014177, -0.000016621, 0.000014410, -0.000016469, 0.000014713, -0.000014782, 0.000021069, -0.000017658, 0.000021789, -0.000015471, 0.000015252, -0.000020343, 0.000019266, -0.000019414, 0.000022722, -0.000017661, 0.000018338, -0.000017881, 0.000016131, -0.000019170, 0.000020674, -0.000019411, 0.000022843, -0.000019150, 0.000022323, -0.000019101, 0.000022128, -0.000018869, 0.000018422, -0.000020439, 0.000021436, -0.000021202, 0.000019571, -0.000020056, 0.000017125, -0.000016993, 0.000012832, -0.000015087, 0.000016143, -0.000012057, 0.000019988, -0.000017168, 0.000022714, -0.000023035, 0.000018737, -0.000016905, 0.000019614, -0.000016138, 0.000016139, -0.000016724, 0.000013803, -0.000016631, 0.000015168, -0.000015834, 0.000021027, -0.000016893, 0.000020518, -0.000014856, 0.000020806, -0.000016696, 0.000014918, -0.000020054, 0.000021688, -0.000023535, 0.000022052, -0.000020928, 0.000014719, -0.000017648, 0.000014725, -0.000018984, 0.000021381, -0.000013838, 0.000019492, -0.000014918, 0.000018954, -0.000020506, 0.000022216, -0.000024091, 0.000025368, -0.000017540, 0.000020595, -0.000019526, 0.000016111, -0.000021874, 0.000020120, -0.000021696, 0.000022730, -0.000020010, 0.000024338, -0.000016661, 0.000025372, -0.000022284, 0.000020800, -0.000021893, 0.000021500, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000} , { 0.000016530, -0.000017824, 0.000013237, -0.000014363, 0.000013403, -0.000010176, 0.000015154, -0.000013682, 0.000018972, -0.000017527, 0.000020907, -0.000022160, 0.000019309, -0.000018948, 0.000014013, -0.000013582, 0.000011532, -0.000011733, 0.000012439, -0.000016288, 0.000015501, -0.000015718, 0.000016839, -0.000015130, 0.000015935, -0.000010284, 0.000009916, -0.000005948, 0.000003115, -0.000011814, 0.000006611, -0.000012453, 0.000004666, -0.000002607, 0.000001305, 0.000000157, 0.000004723, -0.000006913, 0.000014852, -0.000014287, 0.000019625, -0.000017977, 0.000014610, -0.000014135, 0.000011793, -0.000013060, 0.000008500, -0.000012440, 0.000012492, -0.000012132, 0.000011840, -0.000015681, 0.000021306, -0.000026041, 0.000026365, -0.000027257, 0.000031213, -0.000026772, 0.000033000, -0.000027971, 0.000030868, -0.000029376, 0.000019065, -0.000028290, 0.000011463, -0.000017833, 0.000014722, -0.000011288, 0.000010400, -0.000005208, 0.000013069, -0.000009624, 0.000020732, -0.000018515, 0.000018252, -0.000016784, 0.000012200, -0.000011874, 0.000009951, -0.000017383, 0.000015148, -0.000016015, 0.000015849, -0.000012920, 0.000012752, -0.000016015, 0.000015875, -0.000018024, 0.000022659, -0.000016487, 0.000030055, -0.000019432, 0.000030315, -0.000029447, 0.000022596, -0.000037477, 0.000010379, -0.000031069, 0.000016573, -0.000013663, 0.000011057, -0.000008680, 0.000022881, -0.000016825, 0.000037926, -0.000025033, 0.000034200, -0.000025319, 0.000014187, -0.000010395, 0.000000028, -0.000012654, 0.000007606, -0.000019627, 0.000022577, -0.000021504, 0.000025593, -0.000029656, 0.000024920, -0.000020615, 0.000024809, -0.000014430, 0.000025929, -0.000004894, 0.000025017, -0.000017748, 0.000016799, -0.000035827, 0.000004063, -0.000038054, 0.000004308, -0.000016173, 0.000017225, -0.000008481, 0.000024476, -0.000013771, 0.000040004, -0.000010893, 0.000031432, -0.000012723, 0.000008806, -0.000018843, 0.000000712, -0.000025213, 0.000016705, -0.000029853, 0.000018964, -0.000027183, 0.000027204, -0.000027027, 0.000030165, -0.000036086, 0.000043407, -0.000024264, 0.000059781, -0.000012951, 0.000043468, -0.000015158, 0.000018758, -0.000040110, 0.000003548, -0.000055031, -0.000012266, -0.000039649, -0.000008013, 0.000010037, 0.000003357, 0.000001462, 0.000029977, 0.000009828, 0.000064486, -0.000011565, 0.000046647, -0.000048083, 0.000015782, -0.000062949, -0.000007085, -0.000025046, 0.000027268, -0.000013498, 0.000032225, -0.000031269, 0.000040832, -0.000030499, 0.000011136, -0.000004817, 0.000063878, 0.000024129, 0.000083360, -0.000008695, 0.000047264, -0.000064722, -0.000045704, -0.000090579, -0.000039535, -0.000113291, -0.000043840, -0.000092129, 0.000037478, -0.000053371, 0.000038980, -0.000025277, 0.000175425, 0.000176340, 0.000308242, 0.000061440, 0.000067899, -0.000132238, -0.000144820, -0.000198030, -0.000059014, -0.000115748, 0.000055937, -0.000044082, 0.000107118, 0.000033465, 0.000124898, -0.000153983, -0.000040696, -0.000217537, 0.000038809, -0.000008891, 0.000042567, 0.000081630, 0.000125690, 0.000033562, 0.000104650, -0.000025855, 0.000114206, -0.000041560, 0.000079306, -0.000196355, 0.000048125, -0.000146479, 0.000029670, -0.000194744, 0.000021023, -0.000047198, 0.000190667, 0.000004514, 0.000129338, -0.000085690, 0.000088737, -0.000115953, 0.000059702, -0.000129320, 0.000117823, -0.000094893, 0.000135643, -0.000138795, 0.000140239, -0.000162507, 0.000095687, -0.000156046, 0.000105167, -0.000092826, 0.000143426, -0.000149857, 0.000191388, -0.000122976, 0.000205620, -0.000188002, 0.000260390, -0.000208323, 0.000224139, -0.000286172, 0.000214152, -0.000325199, 0.000171730, -0.000285512, 0.000330030, -0.000212180, 0.000281326, -0.000269628, 0.000484211, -0.000587599, 0.000581129, -0.000615851, 0.000653143, -0.000754818, 0.000804748, -0.000584436, 0.000289377, -0.000841251, 0.002124219, -0.004880872, 0.037210399, 0.100783841, 0.076909885, 0.054937843, 0.064108551, 0.036916359, 0.002501907, -0.014941172, -0.049388568, -0.008512449, -0.059980559, -0.037143852, 0.016637851, 0.007131425, 0.024568686, 0.038415865, -0.003487581, -0.018638229, -0.001164657, -0.004893839, -0.007125117, -0.011646692, -0.003922786, 0.004704787, -0.002552244, -0.008183636, 0.008194661, 0.001595860, 0.001126967, -0.000037107, 0.000110467, -0.004133715, 0.000447304, -0.001576217, -0.000483831, -0.003400870, -0.000389941, 0.000328711, -0.000631920, -0.002808701, 0.000784023, 0.000369302, -0.000428510, -0.000735205, 0.000024687, 0.000274596, 0.000200656, 0.000337687, 0.000397607, 0.000603550, 0.000697506, 0.001405925, 0.001100031, 0.001227761, 0.000942547, 0.000794256, -0.000307662, -0.000468965, -0.000684791, -0.000106556, -0.000247407, -0.000028479, -0.000023580, 0.000204022, -0.000068281, 0.000212615, 0.000032491, 0.000151797, 0.000015198, 0.000114593, -0.000082670, 0.000071107, -0.000017939, 0.000227964, 0.000100290, 0.000177862, 0.000169720, 0.000184778, 0.000179678, 0.000143760, 0.000175032, 0.000178703, 0.000126156, 0.000177596, 0.000067996, 0.000126741, 0.000060259, 0.000084822, 0.000059307, 0.000071230, 0.000057545, 0.000100178, 0.000044259, 0.000091887, 0.000048650, 0.000076478, 0.000044676, 0.000081701, 0.000029944, 0.000079725, 0.000019491, 0.000074446, 0.000013877, 0.000053428, 0.000040132, 0.000046298, 0.000028028, 0.000032682, 0.000000065, 0.000014782, -0.000032072, -0.000000478, -0.000026820, -0.000006231, -0.000015440, -0.000001562, -0.000014149, -0.000009075, -0.000027964, -0.000018888, -0.000048652, -0.000024453, -0.000053052, -0.000027451, -0.000051018, -0.000023327, -0.000059489, -0.000024016, -0.000072406, -0.000038845, -0.000066962, -0.000051988, -0.000059506, -0.000047935, -0.000056064, -0.000032679, -0.000055562, -0.000002300, -0.000058768, 0.000010276, -0.000057503, -0.000001479, -0.000042022, -0.000015751, -0.000033737, 0.000001818, -0.000032554, 0.000024535, -0.000026643, 0.000038899, -0.000023391, 0.000039682, -0.000022844, 0.000028540, -0.000014972, 0.000022437, -0.000006453, 0.000021500, -0.000002291, 0.000028828, 0.000000339, 0.000018240, 0.000020421, 0.000013866, 0.000029534, 0.000009831, 0.000027992, 0.000022048, 0.000014925, 0.000023558, 0.000017261, 0.000020013, 0.000017343, 0.000012044, 0.000008778, 0.000007897, 0.000001044, 0.000004515, -0.000002434, 0.000009452, -0.000001944, 0.000015247, -0.000000576, 0.000010572, -0.000000671, 0.000013523, -0.000015171, 0.000016875, -0.000024743, 0.000018844, -0.000024733, 0.000013653, -0.000013599, 0.000005369, -0.000004971, 0.000001096, -0.000007740, 0.000012100, -0.000016915, 0.000016660, -0.000016558, 0.000011733, -0.000010083, 0.000010170, -0.000016212, 0.000013698, -0.000017836, 0.000006587, -0.000014272, 0.000008432, -0.000023382, 0.000016512, -0.000021932, 0.000022144, -0.000018588, 0.000021049, -0.000019776, 0.000019724, -0.000018351, 0.000016494, -0.000022291, 0.000017781, -0.000025908, 0.000020349, -0.000020496, 0.000012606, -0.000005454, 0.000002130, -0.000001625, 0.000006347, -0.000008339, 0.000013283, -0.000009361, 0.000007828, -0.000000891, -0.000003324, 0.000007568, -0.000006046, -0.000000515, 0.000006754, -0.000016885, 0.000020632, -0.000023147, 0.000016455, -0.000010443, 0.000001637, 0.000005136, -0.000000710, -0.000001535, 0.000014069, -0.000019532, 0.000026696, -0.000028171, 0.000020535, -0.000016984, 0.000008043, -0.000006089, 0.000004949, -0.000003508, 0.000010182, -0.000009305, 0.000010446, -0.000005435, 0.000008384, -0.000004129, 0.000003046, 0.000001230, -0.000002189, -0.000000434, 0.000003608, -0.000007497, 0.000008568, -0.000012813, 0.000014462, -0.000013671, 0.000016106, -0.000017641, 0.000015742, -0.000012465, 0.000010024, -0.000011021, 0.000015142, -0.000016104, 0.000017297, -0.000018163, 0.000018028, -0.000017639, 0.000014109, -0.000014770, 0.000011745, -0.000006804, 0.000003576, 0.000000875, -0.000000422, -0.000002363, 0.000003154, -0.000002621, 0.000001013, 0.000002482, -0.000002005, 0.000002477, 0.000001743, -0.000007211, 0.000008531, -0.000011839, 0.000011000, -0.000012778, 0.000006674, -0.000002787, -0.000001475, -0.000000165, -0.000000523, -0.000003372, 0.000010049, -0.000011475, 0.000013205, -0.000008421, 0.000003852, 0.000001055, -0.000006967, 0.000002613, 0.000000567, -0.000010927, 0.000014605, -0.000016714, 0.000016754, -0.000012007, 0.000008607, -0.000003524, 0.000001253, 0.000003097, 0.000002357, -0.000009249, 0.000011253, -0.000015568, 0.000012127, -0.000012478, 0.000004887, -0.000001675, -0.000000314, 0.000000204, 0.000009165, -0.000013310, 0.000018948, -0.000018915, 0.000015713, -0.000012506, 0.000006525, -0.000004563, 0.000002274, -0.000003119, 0.000005045, -0.000012599, 0.000017257, -0.000023411, 0.000023838, -0.000022070, 0.000018341, -0.000011976, 0.000010576, -0.000005054, 0.000005484, -0.000009427, 0.000011131, -0.000013096, 0.000012037, -0.000012990, 0.000004889, -0.000001281, -0.000001389, 0.000000505, 0.000005359, -0.000009587, 0.000013579, -0.000012505, 0.000011926, -0.000008078, 0.000004022, -0.000005594, 0.000003661, -0.000009023, 0.000013121, -0.000022247, 0.000024637, -0.000020973, 0.000018175, -0.000012256, 0.000004615, -0.000003088, 0.000004301, -0.000009332, 0.000016098, -0.000019858, 0.000020541, -0.000017961, 0.000013890, -0.000009372, 0.000005530, -0.000003291, 0.000007141, -0.000010154, 0.000012542, -0.000013527, 0.000013286, -0.000012808, 0.000011049, -0.000009470, 0.000008068, -0.000008771, 0.000010602, -0.000011282, 0.000006371, -0.000003784, -0.000000180, 0.000003680, -0.000004194, 0.000002745, 0.000002364, -0.000009310, 0.000014233, -0.000016281, 0.000010819, -0.000008623, 0.000008132, -0.000006791, 0.000009169, -0.000008365, 0.000014674, -0.000016122, 0.000013406, -0.000009326, 0.000006792, -0.000003912, -0.000001400, 0.000002816, -0.000004533, -0.000001564, 0.000007574, -0.000013873, 0.000016780, -0.000015651, 0.000013260, -0.000008636, 0.000008709, -0.000010053, 0.000012471, -0.000020085, 0.000023014, -0.000024942, 0.000021046, -0.000016126, 0.000010656, -0.000004835, 0.000004497, -0.000005433, 0.000011346, -0.000016617, 0.000022512, -0.000021513, 0.000018020, -0.000010049, 0.000002587, 0.000000903, -0.000003576, 0.000001836, 0.000003958, -0.000008806, 0.000010457, -0.000010110, 0.000007296, -0.000004928, 0.000003853, -0.000005170, 0.000005120, -0.000006059, 0.000006656, -0.000007608, 0.000008786, -0.000010840, 0.000010527, -0.000011690, 0.000009436, -0.000008290, 0.000005635, -0.000003778, 0.000003990, -0.000004736, 0.000005769, -0.000005647, 0.000009110, -0.000008009, 0.000004253, -0.000002462, -0.000000105, -0.000000506, -0.000000159, -0.000006510, 0.000011965, -0.000011963, 0.000011220, -0.000007908, 0.000007251, -0.000005876, 0.000004551, -0.000007142, 0.000003574, -0.000005582, 0.000002106, -0.000003473, 0.000006209, -0.000005604, 0.000007291, -0.000003195, 0.000003161, -0.000002435, 0.000002756, -0.000003835, 0.000002208, -0.000006395, 0.000007329, -0.000008170, 0.000008132, -0.000009849, 0.000013277, -0.000014276, 0.000016641, -0.000016808, 0.000016671, -0.000013763, 0.000007808, -0.000004993, 0.000005988, -0.000009954, 0.000011126, -0.000016625, 0.000017676, -0.000018041, 0.000012737, -0.000011131, 0.000008242, -0.000007953, 0.000008930, -0.000010933, 0.000013610, -0.000010904, 0.000007629, -0.000005169, -0.000000515, 0.000001464, -0.000001434, -0.000001047, 0.000003653, -0.000010970, 0.000017506, -0.000021106, 0.000020169, -0.000016305, 0.000012567, -0.000003649, 0.000000996, -0.000002872, 0.000006518, -0.000011201, 0.000012367, -0.000014006, 0.000012900, -0.000012474, 0.000010103, -0.000009669, 0.000009376, -0.000008837, 0.000008577, -0.000010370, 0.000012497, -0.000013700, 0.000015445, -0.000011073, 0.000008318, -0.000005724, 0.000003937, -0.000006722, 0.000005509, -0.000007697, 0.000009109, -0.000009189, 0.000006843, -0.000004875, 0.000006147, -0.000005282, 0.000005118, -0.000006834, 0.000008762, -0.000011263, 0.000015332, -0.000019305, 0.000016466, -0.000008962, 0.000003372, 0.000001415, -0.000005073, 0.000005063, -0.000000432, -0.000005630, 0.000009930, -0.000014300, 0.000014555, -0.000018325, 0.000013936, -0.000005851, 0.000000320, 0.000003433, -0.000003370, 0.000000873, 0.000004728, -0.000011561, 0.000017261, -0.000022394, 0.000025128, -0.000023340, 0.000018563, -0.000015580, 0.000012119, -0.000010865, 0.000014437, -0.000016945, 0.000024396, -0.000021175, 0.000021233, -0.000015810, 0.000010714, -0.000007392, 0.000003394, -0.000005442, 0.000004079, -0.000006457, 0.000010237, -0.000010412, 0.000009122, -0.000012063, 0.000012140, -0.000010338, 0.000009248, -0.000005276, 0.000004592, -0.000006992, 0.000004829, -0.000009638, 0.000009845, -0.000009914, 0.000009477, -0.000008746, 0.000010604, -0.000011372, 0.000017177, -0.000018132, 0.000017049, -0.000015137, 0.000014402, -0.000010798, 0.000010095, -0.000010580, 0.000012503, -0.000016075, 0.000011858, -0.000014994, 0.000013154, -0.000007474, 0.000000876, 0.000007665, -0.000010251, 0.000012866, -0.000012865, 0.000000308, 0.000005576, -0.000015008, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000, 0.000000000} } , 
@@ -1711,3 +1713,5 @@ const int __default_hrir_len = 1024;
 
 const int __default_hrir_fs = 48000;
 
+#endif /* SAF_DEFAULT_HRIRS_EXTERNAL */
+
@@ -39,9 +39,9 @@ void estimateITDs
     float* itds_s
 )
 {
-    int i, n, j, k, maxIdx, xcorr_len;
+    int i, n, j, d, nBlock, maxIdx, xcorr_len;
     float maxVal, itd_bounds, fc, Q, K, KK, D, wn, Wz1[2], Wz2[2], b[3], a[3];
-    float* xcorr_LR, *ir_L, *ir_R, *hrir_lpf;
+    float* xcorr_LR, *ir_lpf[NUM_EARS];
 
     /* calculate LPF coefficients, 2nd order IIR design equations from DAFX (2nd ed) p50 */
     fc = 750.0f;
@@ -52,52 +52,55 @@ void estimateITDs
 	b[0] = (KK * Q) / D; b[1] = (2.0f * KK * Q) / D; b[2] = (KK * Q) / D;
 	a[0] = 1.0f; a[1] = (2.0f * Q * (KK - 1.0f)) / D; a[2] = (KK * Q - K + Q) / D;
     
-    /* determine the ITD via the cross-correlation between the LPF'd left and right HRIR signals */
+    /* determine the ITD via the cross-correlation between the LPF'd left and
+     * right HRIR signals; the cross-correlations are computed in blocks of
+     * directions, using the FFT */
     xcorr_len = 2*(hrir_len)-1;
     itd_bounds = sqrtf(2.0f)/2e3f;
-    xcorr_LR = (float*)malloc1d(xcorr_len*sizeof(float));
-    ir_L = (float*)malloc1d(hrir_len*sizeof(float));
-    ir_R = (float*)malloc1d(hrir_len*sizeof(float));
-    hrir_lpf = (float*)malloc1d(hrir_len*2*sizeof(float));
-    for(i=0; i<N_dirs; i++){
+    nBlock = MIN(N_dirs, ITD_XCORR_BLOCK_SIZE);
+    xcorr_LR = (float*)malloc1d(nBlock*xcorr_len*sizeof(float));
+    for(j=0; j<NUM_EARS; j++)
+        ir_lpf[j] = (float*)malloc1d(nBlock*hrir_len*sizeof(float));
+    for(i=0; i<N_dirs; i+=nBlock){
+        nBlock = MIN(N_dirs-i, ITD_XCORR_BLOCK_SIZE);
+        
         /* apply lpf */
-        memset(Wz1, 0, 2*sizeof(float));
-        memset(Wz2, 0, 2*sizeof(float));
-        for (n=0; n<hrir_len; n++){
-            for(j=0; j<NUM_EARS; j++){
-                /* biquad difference equation (Direct form 2) */
-                wn = hrirs[i*NUM_EARS*hrir_len + j*hrir_len + n] - a[1] * Wz1[j] - a[2] * Wz2[j];
-                hrir_lpf[n*2+j]  = b[0] * wn + b[1]*Wz1[j] + b[2]*Wz2[j];
-                
-                /* shuffle delays */
-                Wz2[j] = Wz1[j];
-                Wz1[j] = wn;
+        for(d=0; d<nBlock; d++){
+            memset(Wz1, 0, 2*sizeof(float));
+            memset(Wz2, 0, 2*sizeof(float));
+            for (n=0; n<hrir_len; n++){
+                for(j=0; j<NUM_EARS; j++){
+                    /* biquad difference equation (Direct form 2) */
+                    wn = hrirs[(i+d)*NUM_EARS*hrir_len + j*hrir_len + n] - a[1] * Wz1[j] - a[2] * Wz2[j];
+                    ir_lpf[j][d*hrir_len+n] = b[0] * wn + b[1]*Wz1[j] + b[2]*Wz2[j];
+                    
+                    /* shuffle delays */
+                    Wz2[j] = Wz1[j];
+                    Wz1[j] = wn;
+                }
             }
         }
         
         /* xcorr between L and R */
-        for(k=0; k<hrir_len; k++){
-            ir_L[k] = hrir_lpf[k*2+0];
-            ir_R[k] = hrir_lpf[k*2+1];
-        }
-        cxcorr(ir_L, ir_R, xcorr_LR, hrir_len, hrir_len);
-        maxIdx = 0;
-        maxVal = 0.0f;
-        for(j=0; j<xcorr_len; j++){
-            if(xcorr_LR[j] > maxVal){
-                maxIdx = j;
-                maxVal = xcorr_LR[j];
+        fftxcorr(ir_lpf[0], ir_lpf[1], hrir_len, hrir_len, nBlock, xcorr_LR);
+        for(d=0; d<nBlock; d++){
+            maxIdx = 0;
+            maxVal = 0.0f;
+            for(j=0; j<xcorr_len; j++){
+                if(xcorr_LR[d*xcorr_len+j] > maxVal){
+                    maxIdx = j;
+                    maxVal = xcorr_LR[d*xcorr_len+j];
+                }
             }
+            itds_s[i+d] = ((float)hrir_len-(float)maxIdx-1.0f)/(float)fs;
+            itds_s[i+d] = itds_s[i+d] >  itd_bounds ?  itd_bounds : itds_s[i+d];
+            itds_s[i+d] = itds_s[i+d] < -itd_bounds ? -itd_bounds : itds_s[i+d];
         }
-        itds_s[i] = ((float)hrir_len-(float)maxIdx-1.0f)/(float)fs;
-        itds_s[i] = itds_s[i] >  itd_bounds ?  itd_bounds : itds_s[i];
-        itds_s[i] = itds_s[i] < -itd_bounds ? -itd_bounds : itds_s[i];
     }
     
     free(xcorr_LR);
-    free(ir_L);
-    free(ir_R);
-    free(hrir_lpf);
+    for(j=0; j<NUM_EARS; j++)
+        free(ir_lpf[j]);
 }
 
 void HRIRs2FilterbankHRTFs
@@ -210,17 +213,15 @@ void interpHRTFs
     float* itd_interp, *mags_interp, *ipd_interp;
     float** mags;
     
-    mags = (float**)malloc1d(N_bands*sizeof(float*));
+    mags = (float**)malloc2d(N_bands, NUM_EARS * N_hrtf_dirs, sizeof(float));
     itd_interp = malloc1d(N_interp_dirs*sizeof(float));
     mags_interp = malloc1d(N_interp_dirs*NUM_EARS*sizeof(float));
     ipd_interp = malloc1d(N_interp_dirs*sizeof(float));
     
     /* calculate HRTF magnitudes */
-    for(band=0; band<N_bands; band++){
-        mags[band] = malloc1d(NUM_EARS * N_hrtf_dirs*sizeof(float));
+    for(band=0; band<N_bands; band++)
         for(i=0; i< NUM_EARS * N_hrtf_dirs ; i++)
             mags[band][i] = cabsf(hrtfs[band*NUM_EARS * N_hrtf_dirs + i]);
-    }
     
     /* interpolate ITDs */
     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, N_interp_dirs, 1, N_hrtf_dirs, 1.0f,
@@ -246,13 +247,142 @@ void interpHRTFs
     }
 
     free(itd_interp);
-    for(band=0; band<N_bands; band++)
-        free(mags[band]);
     free(mags);
     free(mags_interp);
     free(ipd_interp);
 }
 
+/**
+ * Data structure for the prepared HRTF interpolator.
+ *
+ * The magnitudes are stored direction-major, so that the 3 HRTFs visited per
+ * query are each contiguous in memory.
+ */
+typedef struct _interpHRTFs_data {
+    int N_hrtf_dirs, N_bands, N_interp_dirs;
+    SAF_STORAGE_PRECISION precision; /**< storage format of 'mags' and 'gtableComp' */
+    size_t nBytes;     /**< bytes per stored value */
+    void* mags;        /**< HRTF magnitudes; FLAT: N_hrtf_dirs x N_bands x 2 */
+    float* itds;       /**< HRIR ITDs; N_hrtf_dirs x 1 */
+    float* freqVector; /**< frequency vector; N_bands x 1 */
+    void* gtableComp;  /**< compressed table gains; FLAT: N_interp_dirs x 3 */
+    int* gtableIdx;    /**< compressed table indices; FLAT: N_interp_dirs x 3 */
+
+}interpHRTFs_data;
+
+void interpHRTFs_create
+(
+    void ** const phInterp,
+    float_complex* hrtfs, /* N_bands x 2 x N_hrtf_dirs */
+    float* itds,
+    float* freqVector,
+    float* vbap_gtable,
+    int N_hrtf_dirs,
+    int N_bands,
+    int N_interp_dirs,
+    SAF_STORAGE_PRECISION precision
+)
+{
+    *phInterp = malloc1d(sizeof(interpHRTFs_data));
+    interpHRTFs_data *h = (interpHRTFs_data*)(*phInterp);
+    int i, j, nd, band;
+    float* mags, *gtableComp;
+    
+    h->N_hrtf_dirs = N_hrtf_dirs;
+    h->N_bands = N_bands;
+    h->N_interp_dirs = N_interp_dirs;
+    h->precision = precision;
+    h->nBytes = utility_storagePrecisionBytes(precision);
+    
+    /* calculate HRTF magnitudes */
+    mags = malloc1d(N_bands*NUM_EARS*sizeof(float));
+    h->mags = malloc1d(N_hrtf_dirs*N_bands*NUM_EARS*(h->nBytes));
+    for(nd=0; nd<N_hrtf_dirs; nd++){
+        for(band=0; band<N_bands; band++)
+            for(i=0; i<NUM_EARS; i++)
+                mags[band*NUM_EARS + i] = cabsf(hrtfs[band*NUM_EARS*N_hrtf_dirs + i*N_hrtf_dirs + nd]);
+        utility_svpack(mags, N_bands*NUM_EARS, precision, (char*)h->mags + nd*N_bands*NUM_EARS*(h->nBytes));
+    }
+    free(mags);
+    h->itds = malloc1d(N_hrtf_dirs*sizeof(float));
+    memcpy(h->itds, itds, N_hrtf_dirs*sizeof(float));
+    h->freqVector = malloc1d(N_bands*sizeof(float));
+    memcpy(h->freqVector, freqVector, N_bands*sizeof(float));
+    
+    /* compress the table by keeping only the non-zero gains and their indices
+     * (zero gain entries point to the first HRTF, and have no effect) */
+    gtableComp = calloc1d(N_interp_dirs*3, sizeof(float));
+    h->gtableIdx = calloc1d(N_interp_dirs*3, sizeof(int));
+    for(i=0; i<N_interp_dirs; i++){
+        for(nd=0, j=0; nd<N_hrtf_dirs && j<3; nd++){
+            if(vbap_gtable[i*N_hrtf_dirs+nd]>0.0000001f){
+                gtableComp[i*3+j] = vbap_gtable[i*N_hrtf_dirs+nd];
+                h->gtableIdx[i*3+j] = nd;
+                j++;
+            }
+        }
+    }
+    h->gtableComp = malloc1d(N_interp_dirs*3*(h->nBytes));
+    utility_svpack(gtableComp, N_interp_dirs*3, precision, h->gtableComp);
+    free(gtableComp);
+}
+
+void interpHRTFs_destroy
+(
+    void ** const phInterp
+)
+{
+    interpHRTFs_data *h = (interpHRTFs_data*)(*phInterp);
+    
+    if(h!=NULL){
+        free(h->mags);
+        free(h->itds);
+        free(h->freqVector);
+        free(h->gtableComp);
+        free(h->gtableIdx);
+        free(h);
+        *phInterp = NULL;
+    }
+}
+
+void interpHRTFs_query
+(
+    void * const hInterp,
+    int interpDirIdx,
+    float_complex* hrtf_interp /* N_bands x 2 */
+)
+{
+    interpHRTFs_data *h = (interpHRTFs_data*)(hInterp);
+    int i, band, N_bands;
+    float itd_interp, ipd_interp, mags_interp[NUM_EARS], weights[3], mags_band[3][NUM_EARS];
+    void* mags3[3];
+    
+    N_bands = h->N_bands;
+    utility_svunpack((char*)h->gtableComp + interpDirIdx*3*(h->nBytes), 3, h->precision, weights);
+    itd_interp = 0.0f;
+    for(i=0; i<3; i++){
+        mags3[i] = (char*)h->mags + h->gtableIdx[interpDirIdx*3+i]*N_bands*NUM_EARS*(h->nBytes);
+        itd_interp += weights[i] * h->itds[h->gtableIdx[interpDirIdx*3+i]];
+    }
+    
+    for(band=0; band<N_bands; band++){
+        /* interpolate HRTF magnitudes (converted from the storage format on the
+         * fly, one band at a time) */
+        for(i=0; i<3; i++)
+            utility_svunpack((char*)mags3[i] + band*NUM_EARS*(h->nBytes), NUM_EARS, h->precision, mags_band[i]);
+        mags_interp[0] = mags_interp[1] = 0.0f;
+        for(i=0; i<3; i++){
+            mags_interp[0] += weights[i] * mags_band[i][0];
+            mags_interp[1] += weights[i] * mags_band[i][1];
+        }
+        
+        /* convert ITD to phase difference -pi..pi, and reintroduce it */
+        ipd_interp = (matlab_fmodf(2.0f*M_PI*h->freqVector[band]*itd_interp + M_PI, 2.0f*M_PI) - M_PI)/2.0f; /* /2 here, not later */
+        hrtf_interp[band*NUM_EARS+0] = ccmulf( cmplxf(mags_interp[0],0.0f), cexpf(cmplxf(0.0f, ipd_interp)) );
+        hrtf_interp[band*NUM_EARS+1] = ccmulf( cmplxf(mags_interp[1],0.0f), cexpf(cmplxf(0.0f,-ipd_interp)) );
+    }
+}
+
 void binauralDiffuseCoherence
 (
     float_complex* hrtfs, /* N_bands x 2 x N_hrtf_dirs */
@@ -264,35 +394,245 @@ void binauralDiffuseCoherence
 )
 {
     int i, j;
-    float* ipd;
-    float_complex *hrtf_ipd_lr;
+    float coh;
+    float* cos_ipd, *mag_lr;
     
-    /* convert ITDs to phase differences -pi..pi */
-    ipd = malloc1d(N_bands*N_hrtf_dirs*sizeof(float));
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, N_bands, N_hrtf_dirs, 1, 1.0,
-                freqVector, 1,
-                itds, 1, 0.0,
-                ipd, N_hrtf_dirs);
-    for(i=0; i<N_bands; i++)
-        for(j=0; j<N_hrtf_dirs; j++)
-            ipd[i*N_hrtf_dirs+j] = (matlab_fmodf(2.0f*M_PI*ipd[i*N_hrtf_dirs+j] + M_PI, 2.0f*M_PI) - M_PI);
-    
-    /* compute complex coherence */
-    hrtf_ipd_lr = calloc1d(N_bands, sizeof(float_complex));
+    /* Due to almost axisymmetry of ITD, the coherence is almost real; so only
+     * the real part, sum_j |H_l||H_r| cos(ipd_j)/N_hrtf_dirs, is computed.
+     * (cos() is periodic, so the phase differences need not be wrapped) */
+    cos_ipd = malloc1d(N_hrtf_dirs*sizeof(float));
+    mag_lr = malloc1d(N_hrtf_dirs*sizeof(float));
     for(i=0; i<N_bands; i++){
         for(j=0; j<N_hrtf_dirs; j++)
-            hrtf_ipd_lr[i] = ccaddf(hrtf_ipd_lr[i], crmulf(cexpf(crmulf(cmplxf(0.0f, 1.0f), ipd[i*N_hrtf_dirs+j])),
-                                                    cabsf(hrtfs[i*NUM_EARS*N_hrtf_dirs + 0*N_hrtf_dirs + j])*
-                                                    cabsf(hrtfs[i*NUM_EARS*N_hrtf_dirs + 1*N_hrtf_dirs + j])));
-        hrtf_ipd_lr[i] = ccdivf(hrtf_ipd_lr[i], cmplxf((float)N_hrtf_dirs, 0.0f));
+            cos_ipd[j] = cosf(2.0f*M_PI*freqVector[i]*itds[j]);
+        for(j=0; j<N_hrtf_dirs; j++)
+            mag_lr[j] = cabsf(hrtfs[i*NUM_EARS*N_hrtf_dirs + 0*N_hrtf_dirs + j]) *
+                        cabsf(hrtfs[i*NUM_EARS*N_hrtf_dirs + 1*N_hrtf_dirs + j]);
+        utility_svvdot(cos_ipd, mag_lr, N_hrtf_dirs, &coh);
+        coh /= (float)N_hrtf_dirs;
+        HRTFcoh[i] = coh < 0.0f ? 0.0f : coh;
     }
-    
-    /* due to almost axisymmetry of ITD, the coherence is almost real */
-    for(i=0; i<N_bands; i++)
-        HRTFcoh[i] = crealf(hrtf_ipd_lr[i]) < 0.0f ? 0.0f : crealf(hrtf_ipd_lr[i]);
     HRTFcoh[0] = 1.0f; /* force 1 at DC */
     
-    free(ipd);
-    free(hrtf_ipd_lr);
+    free(cos_ipd);
+    free(mag_lr);
 }
 
+/* ========================================================================== */
+/*                        Near-Field HRTF Compensation                        */
+/* ========================================================================== */
+
+/** Maximum number of terms of the rigid sphere series */
+#define NEAR_FIELD_MAX_NUM_TERMS ( 200 )
+
+/** Data structure for the near-field table */
+typedef struct _nearFieldHRTFs_data {
+    int N_bands, N_distances, N_angles;
+    float refDistance, minDistance;
+    float logDistRange;  /**< log(refDistance/minDistance) */
+    float_complex* nfc;  /**< filters; FLAT: N_distances x N_angles x N_bands */
+
+}nearFieldHRTFs_data;
+
+/**
+ * Returns the response of a rigid sphere at a point on its surface, to a point
+ * source at distance rho (relative to the radius) and angle theta (from that
+ * point), normalised by the free-field response at the centre of the sphere
+ * [Duda & Martens, 1998]; mu is the wavenumber times the radius
+ */
+static double_complex nearFieldHRTFs_sphere
+(
+    double rho,
+    double mu,
+    double cosTheta
+)
+{
+    int m;
+    double x, P, P_prev, P_next;
+    double_complex hx, hx_prev, hx_next, hmu, hmu_prev, hmu_next, dhmu, ratio, sum;
+
+    mu = MAX(mu, 1e-3); /* (the response is flat towards DC) */
+    x = mu*rho;
+
+    /* spherical Hankel functions of the first kind (upward recurrence is
+     * stable for these), and the Legendre polynomials */
+    hx_prev = cmplx(sin(x)/x, -cos(x)/x);             /* h_0(x) */
+    hx = cmplx(sin(x)/(x*x) - cos(x)/x, -cos(x)/(x*x) - sin(x)/x); /* h_1(x) */
+    hmu_prev = cmplx(sin(mu)/mu, -cos(mu)/mu);
+    hmu = cmplx(sin(mu)/(mu*mu) - cos(mu)/mu, -cos(mu)/(mu*mu) - sin(mu)/mu);
+    P_prev = 1.0;
+    P = cosTheta;
+
+    /* m = 0 term (h_0' = -h_1) */
+    sum = ccdiv(hx_prev, crmul(hmu, -1.0));
+    for(m=1; m<NEAR_FIELD_MAX_NUM_TERMS; m++){
+        dhmu = ccsub(hmu_prev, crmul(hmu, (double)(m+1)/mu)); /* h_m' = h_{m-1} - (m+1)/mu h_m */
+        ratio = ccdiv(hx, dhmu);
+        if(!isfinite(creal(ratio)) || !isfinite(cimag(ratio)))
+            break;
+        sum = ccadd(sum, crmul(ratio, (double)(2*m+1)*P));
+        if((double)m>mu && (double)(2*m+1)*cabs(ratio) < 1e-9*cabs(sum))
+            break;
+
+        /* next order */
+        hx_next = ccsub(crmul(hx, (double)(2*m+1)/x), hx_prev);
+        hmu_next = ccsub(crmul(hmu, (double)(2*m+1)/mu), hmu_prev);
+        hx_prev = hx;   hx = hx_next;
+        hmu_prev = hmu; hmu = hmu_next;
+        P_next = ((double)(2*m+1)*cosTheta*P - (double)m*P_prev)/(double)(m+1);
+        P_prev = P;     P = P_next;
+    }
+
+    /* H = -(rho/mu) exp(-i mu rho) sum */
+    return ccmul(cmplx(-rho/mu*cos(x), rho/mu*sin(x)), sum);
+}
+
+void nearFieldHRTFs_create
+(
+    void ** const phNF,
+    float* freqVector,
+    int N_bands,
+    float headRadius,
+    float refDistance,
+    float minDistance,
+    int N_distances,
+    int N_angles
+)
+{
+    nearFieldHRTFs_data *h;
+    int i, j, band;
+    double dist, cosTheta, mu;
+    double_complex H, H_ref;
+
+    h = (nearFieldHRTFs_data*)malloc1d(sizeof(nearFieldHRTFs_data));
+    *phNF = (void*)h;
+    h->N_bands = N_bands;
+    h->N_distances = MAX(N_distances, 2);
+    h->N_angles = MAX(N_angles, 2);
+    h->minDistance = MAX(minDistance, 1.1f*headRadius);
+    h->refDistance = MAX(refDistance, 1.01f*(h->minDistance));
+    h->logDistRange = logf(h->refDistance/h->minDistance);
+    h->nfc = malloc1d(h->N_distances*(h->N_angles)*N_bands*sizeof(float_complex));
+
+    for(j=0; j<h->N_angles; j++){
+        cosTheta = cos(M_PI*(double)j/(double)(h->N_angles-1));
+        for(band=0; band<N_bands; band++){
+            mu = 2.0*M_PI*(double)freqVector[band]*(double)headRadius/343.0;
+            H_ref = nearFieldHRTFs_sphere((double)h->refDistance/(double)headRadius, mu, cosTheta);
+            for(i=0; i<h->N_distances; i++){
+                dist = (double)h->minDistance * exp((double)h->logDistRange*(double)i/(double)(h->N_distances-1));
+                H = i==h->N_distances-1 ? H_ref : nearFieldHRTFs_sphere(dist/(double)headRadius, mu, cosTheta);
+                H = ccdiv(H, H_ref);
+                h->nfc[(i*(h->N_angles)+j)*N_bands+band] = cmplxf((float)creal(H), (float)cimag(H));
+            }
+        }
+    }
+}
+
+void nearFieldHRTFs_destroy
+(
+    void ** const phNF
+)
+{
+    nearFieldHRTFs_data *h = (nearFieldHRTFs_data*)(*phNF);
+
+    if(h!=NULL){
+        free(h->nfc);
+        free(h);
+        *phNF = NULL;
+    }
+}
+
+void nearFieldHRTFs_query
+(
+    void * const hNF,
+    float azi_deg,
+    float elev_deg,
+    float distance,
+    float_complex* nfc
+)
+{
+    nearFieldHRTFs_data *h = (nearFieldHRTFs_data*)(hNF);
+    int ear, band, i, j;
+    float fi, fj, cosTheta, w00, w01, w10, w11;
+    float* out;
+    const float *t00, *t01, *t10, *t11;
+
+    /* (fractional) distance index */
+    distance = CLAMP(distance, h->minDistance, h->refDistance);
+    fi = logf(distance/(h->minDistance))/(h->logDistRange)*(float)(h->N_distances-1);
+    i = MIN((int)fi, h->N_distances-2);
+    fi -= (float)i;
+
+    out = (float*)nfc;
+    for(ear=0; ear<NUM_EARS; ear++){
+        /* angle between the source and the ear axis (left ear at +90 degrees) */
+        cosTheta = cosf(elev_deg*M_PI/180.0f)*sinf(azi_deg*M_PI/180.0f);
+        cosTheta = ear==0 ? cosTheta : -cosTheta;
+        fj = acosf(CLAMP(cosTheta, -1.0f, 1.0f))/M_PI*(float)(h->N_angles-1);
+        j = MIN((int)fj, h->N_angles-2);
+        fj -= (float)j;
+
+        /* bilinear interpolation of the four closest entries */
+        w00 = (1.0f-fi)*(1.0f-fj);
+        w01 = (1.0f-fi)*fj;
+        w10 = fi*(1.0f-fj);
+        w11 = fi*fj;
+        t00 = (const float*)&(h->nfc[(i*(h->N_angles)+j)*(h->N_bands)]);
+        t01 = (const float*)&(h->nfc[(i*(h->N_angles)+j+1)*(h->N_bands)]);
+        t10 = (const float*)&(h->nfc[((i+1)*(h->N_angles)+j)*(h->N_bands)]);
+        t11 = (const float*)&(h->nfc[((i+1)*(h->N_angles)+j+1)*(h->N_bands)]);
+        for(band=0; band<h->N_bands; band++){
+            out[(band*NUM_EARS+ear)*2]   = w00*t00[2*band]   + w01*t01[2*band]   + w10*t10[2*band]   + w11*t11[2*band];
+            out[(band*NUM_EARS+ear)*2+1] = w00*t00[2*band+1] + w01*t01[2*band+1] + w10*t10[2*band+1] + w11*t11[2*band+1];
+        }
+    }
+}
+
+void nearFieldHRTFs_apply
+(
+    void * const hNF,
+    float azi_deg,
+    float elev_deg,
+    float distance,
+    float_complex* hrtf
+)
+{
+    nearFieldHRTFs_data *h = (nearFieldHRTFs_data*)(hNF);
+    int ear, band, i, j;
+    float fi, fj, cosTheta, w00, w01, w10, w11, re, im, hr, hi;
+    float* io;
+    const float *t00, *t01, *t10, *t11;
+
+    if(distance>=h->refDistance)
+        return;
+    distance = MAX(distance, h->minDistance);
+    fi = logf(distance/(h->minDistance))/(h->logDistRange)*(float)(h->N_distances-1);
+    i = MIN((int)fi, h->N_distances-2);
+    fi -= (float)i;
+
+    io = (float*)hrtf;
+    for(ear=0; ear<NUM_EARS; ear++){
+        cosTheta = cosf(elev_deg*M_PI/180.0f)*sinf(azi_deg*M_PI/180.0f);
+        cosTheta = ear==0 ? cosTheta : -cosTheta;
+        fj = acosf(CLAMP(cosTheta, -1.0f, 1.0f))/M_PI*(float)(h->N_angles-1);
+        j = MIN((int)fj, h->N_angles-2);
+        fj -= (float)j;
+        w00 = (1.0f-fi)*(1.0f-fj);
+        w01 = (1.0f-fi)*fj;
+        w10 = fi*(1.0f-fj);
+        w11 = fi*fj;
+        t00 = (const float*)&(h->nfc[(i*(h->N_angles)+j)*(h->N_bands)]);
+        t01 = (const float*)&(h->nfc[(i*(h->N_angles)+j+1)*(h->N_bands)]);
+        t10 = (const float*)&(h->nfc[((i+1)*(h->N_angles)+j)*(h->N_bands)]);
+        t11 = (const float*)&(h->nfc[((i+1)*(h->N_angles)+j+1)*(h->N_bands)]);
+        for(band=0; band<h->N_bands; band++){
+            re = w00*t00[2*band]   + w01*t01[2*band]   + w10*t10[2*band]   + w11*t11[2*band];
+            im = w00*t00[2*band+1] + w01*t01[2*band+1] + w10*t10[2*band+1] + w11*t11[2*band+1];
+            hr = io[(band*NUM_EARS+ear)*2];
+            hi = io[(band*NUM_EARS+ear)*2+1];
+            io[(band*NUM_EARS+ear)*2]   = hr*re - hi*im;
+            io[(band*NUM_EARS+ear)*2+1] = hr*im + hi*re;
+        }
+    }
+}
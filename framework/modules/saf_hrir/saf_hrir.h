@@ -41,12 +41,22 @@ extern "C" {
 /* ========================================================================== */
 
 /* Default HRIRs: Genelec Aural ID of a KEMAR Dummy Head. (@48kHz)
- * Kindly provided by Aki Mäkivirta and Jaan Johansson */
+ * Kindly provided by Aki Mäkivirta and Jaan Johansson
+ * (not compiled in, if SAF_DEFAULT_HRIRS_EXTERNAL is defined) */
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
 extern const double __default_hrirs[836][2][1024];
 extern const double __default_hrir_dirs_deg[836][2];
 extern const int __default_N_hrir_dirs;
 extern const int __default_hrir_len;
 extern const int __default_hrir_fs;
+/* ITDs, and filterbank HRTFs (before diffuse-field equalisation; i.e. the
+ * outputs of estimateITDs() and HRIRs2FilterbankHRTFs()) of the default HRIRs;
+ * stored as [band][ear][direction][real, imag] */
+extern const float __default_hrir_itds_s[836];
+extern const float __default_hrtf_fb[133][2][836][2];
+#elif !defined(SAF_ENABLE_SOFA_READER)
+# error "SAF_DEFAULT_HRIRS_EXTERNAL requires SAF_ENABLE_SOFA_READER"
+#endif /* SAF_DEFAULT_HRIRS_EXTERNAL */
 
 
 /* ========================================================================== */
@@ -171,6 +181,75 @@ void interpHRTFs(/* Input Arguments */
                  /* Output Arguments */
                  float_complex* hrtf_interp);
 
+/**
+ * Creates an instance of a prepared HRTF interpolator, which stores the HRTF
+ * magnitudes, ITDs and the (compressed) interpolation table, so that
+ * interpHRTFs_query() may be called repeatedly without any memory allocation
+ *
+ * Unlike interpHRTFs(), which applies the full interpolation table to all of
+ * the measured HRTFs, the query function only visits the (up to) 3 HRTFs that
+ * have non-zero interpolation gains for the requested direction. This makes it
+ * suitable for dynamic binaural rendering, where the source directions change
+ * every frame.
+ *
+ * @note Only the first 3 non-zero gains of each table entry are retained, as is
+ *       the case for any VBAP-derived interpolation table.
+ * @note With SAF_STORAGE_FLOAT16 or SAF_STORAGE_BFLOAT16, the stored magnitudes
+ *       and gains take half of the memory, and are converted back to single-
+ *       precision on the fly; with a relative error of at most 2^-11
+ *       (FLOAT16; for values above 6.1e-5) or 2^-8 (BFLOAT16).
+ *
+ * @param[in] phInterp      (&) address of the HRTF interpolator handle
+ * @param[in] hrtfs         HRTFs as filterbank coeffs;
+ *                          FLAT: N_bands x 2 x N_hrtf_dirs
+ * @param[in] itds          The inter-aural time difference (ITD) for each
+ *                          HRIR; N_hrtf_dirs x 1
+ * @param[in] freqVector    Frequency vector; N_bands x 1
+ * @param[in] vbap_gtable   Amplitude-Normalised VBAP gain table;
+ *                          FLAT: N_interp_dirs x N_hrtf_dirs
+ * @param[in] N_hrtf_dirs   Number of HRTF directions
+ * @param[in] N_bands       Number of frequency bands
+ * @param[in] N_interp_dirs Number of interpolated hrtf positions
+ * @param[in] precision     Storage format for the HRTF magnitudes and the
+ *                          interpolation gains; see #SAF_STORAGE_PRECISION
+ */
+void interpHRTFs_create(/* Input Arguments */
+                        void ** const phInterp,
+                        float_complex* hrtfs,
+                        float* itds,
+                        float* freqVector,
+                        float* vbap_gtable,
+                        int N_hrtf_dirs,
+                        int N_bands,
+                        int N_interp_dirs,
+                        SAF_STORAGE_PRECISION precision);
+
+/**
+ * Destroys an instance of a prepared HRTF interpolator
+ *
+ * @param[in] phInterp (&) address of the HRTF interpolator handle
+ */
+void interpHRTFs_destroy(/* Input Arguments */
+                         void ** const phInterp);
+
+/**
+ * Returns the interpolated HRTFs for one entry of the interpolation table
+ * (see interpHRTFs_create()), with no memory allocation
+ *
+ * The output is identical to the corresponding direction returned by
+ * interpHRTFs(), if the interpolator was created with SAF_STORAGE_FLOAT32.
+ *
+ * @param[in]  hInterp      HRTF interpolator handle
+ * @param[in]  interpDirIdx Index of the interpolated hrtf position (i.e. the
+ *                          row of 'vbap_gtable'); 0..N_interp_dirs-1
+ * @param[out] hrtf_interp  Interpolated HRTFs; FLAT: N_bands x 2
+ */
+void interpHRTFs_query(/* Input Arguments */
+                       void * const hInterp,
+                       int interpDirIdx,
+                       /* Output Arguments */
+                       float_complex* hrtf_interp);
+
 /**
  * Computes the binaural diffuse coherence per frequency for a given HRTF set,
  * as in [1]
@@ -197,6 +276,106 @@ void binauralDiffuseCoherence(/* Input Arguments */
                               float* HRTFcoh);
 
 
+/* ========================================================================== */
+/*                        Near-Field HRTF Compensation                        */
+/* ========================================================================== */
+
+/** Default head radius used for the near-field compensation, in metres */
+#define NEAR_FIELD_DEFAULT_HEAD_RADIUS ( 0.0875f )
+
+/**
+ * Creates a table of near-field compensation filters, for rendering sources
+ * closer than the measurement distance of a (far-field) HRTF set
+ *
+ * The filters are the responses of a rigid sphere (the head) at the ears to a
+ * point source at a distance r, relative to those at the reference distance
+ * [1]; i.e. they capture the boost of the ipsilateral ear (at low
+ * frequencies in particular) and the added head shadowing of the contralateral
+ * ear, as a source approaches the head. They are computed once per band, for
+ * 'N_distances' distances (spaced logarithmically between 'minDistance' and
+ * 'refDistance') and 'N_angles' angles between the source and the ear axis
+ * (0..180 degrees), such that nearFieldHRTFs_query() only interpolates
+ * between the four closest table entries; at a cost of O(N_bands) per source.
+ *
+ * @note The distance attenuation (1/r) and the propagation delay, which are
+ *       common to both ears, are not included. The ears are taken to be at
+ *       +/-90 degrees azimuth.
+ *
+ * @param[in] phNF         (&) address of the near-field table handle
+ * @param[in] freqVector   Frequency vector; N_bands x 1
+ * @param[in] N_bands      Number of frequency bands
+ * @param[in] headRadius   Head radius, in metres (e.g.
+ *                         NEAR_FIELD_DEFAULT_HEAD_RADIUS)
+ * @param[in] refDistance  Reference distance (the measurement distance of the
+ *                         HRTFs), in metres; the filters are unity at and
+ *                         beyond it
+ * @param[in] minDistance  Closest distance, in metres (clamped to at least
+ *                         1.1 x headRadius); closer sources are treated as
+ *                         being at this distance
+ * @param[in] N_distances  Number of distances in the table (e.g. 32)
+ * @param[in] N_angles     Number of angles in the table (e.g. 37, i.e. 5
+ *                         degree steps)
+ *
+ * @see [1] Duda, R. O., & Martens, W. L. (1998). Range dependence of the
+ *          response of a spherical head model. The Journal of the Acoustical
+ *          Society of America, 104(5), 3048-3058.
+ */
+void nearFieldHRTFs_create(/* Input Arguments */
+                           void ** const phNF,
+                           float* freqVector,
+                           int N_bands,
+                           float headRadius,
+                           float refDistance,
+                           float minDistance,
+                           int N_distances,
+                           int N_angles);
+
+/**
+ * Destroys an instance of the near-field table
+ *
+ * @param[in] phNF (&) address of the near-field table handle
+ */
+void nearFieldHRTFs_destroy(/* Input Arguments */
+                            void ** const phNF);
+
+/**
+ * Returns the near-field compensation filters for a source direction and
+ * distance, interpolated from the table (with no memory allocation)
+ *
+ * @param[in]  hNF      Near-field table handle
+ * @param[in]  azi_deg  Source azimuth, in DEGREES
+ * @param[in]  elev_deg Source elevation, in DEGREES
+ * @param[in]  distance Source distance, in metres
+ * @param[out] nfc      Filters for the left and right ears; FLAT: N_bands x 2
+ */
+void nearFieldHRTFs_query(/* Input Arguments */
+                          void * const hNF,
+                          float azi_deg,
+                          float elev_deg,
+                          float distance,
+                          /* Output Arguments */
+                          float_complex* nfc);
+
+/**
+ * Applies the near-field compensation filters (see nearFieldHRTFs_query()) to
+ * a pair of interpolated HRTFs, in place; nothing is done for sources at or
+ * beyond the reference distance
+ *
+ * @param[in]     hNF      Near-field table handle
+ * @param[in]     azi_deg  Source azimuth, in DEGREES
+ * @param[in]     elev_deg Source elevation, in DEGREES
+ * @param[in]     distance Source distance, in metres
+ * @param[in,out] hrtf     HRTFs of the left and right ears; FLAT: N_bands x 2
+ */
+void nearFieldHRTFs_apply(/* Input Arguments */
+                          void * const hNF,
+                          float azi_deg,
+                          float elev_deg,
+                          float distance,
+                          /* Input/Output Arguments */
+                          float_complex* hrtf);
+
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif  /* __cplusplus */
@@ -55,7 +55,7 @@ static void afAnalyse
     nTimeSlots = nSamplesTD/hopSize;
     
     /* allocate memory */
-    afSTFTinit(&(hSTFT), hopSize, nCH, 1, 0, 1);
+    afSTFTinit(&(hSTFT), hopSize, nCH, 1, 0, 1, 1);
     FrameTF = (complexVector**)malloc2d(nTimeSlots, nCH, sizeof(complexVector));
     for(t=0; t<nTimeSlots; t++) {
         for(ch=0; ch< nCH; ch++) {
@@ -45,6 +45,10 @@ extern "C" {
 # define NUM_EARS 2
 #endif
 
+/** Number of directions for which the ITD cross-correlations are computed at
+ *  once (bounds the memory used by estimateITDs()) */
+#define ITD_XCORR_BLOCK_SIZE ( 64 )
+
 /* ========================================================================== */
 /*                             Internal Functions                             */
 /* ========================================================================== */
@@ -29,6 +29,127 @@
 
 #ifdef SAF_ENABLE_SOFA_READER
 
+#include <stdint.h>
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+/** SOFA file holding the default HRIRs (NULL: the built-in set, if any) */
+static char* sofa_defaultFilePath = NULL;
+/** Lock for 'sofa_defaultFilePath' */
+#if defined(_WIN32)
+static SRWLOCK sofa_defaultFileLock = SRWLOCK_INIT;
+# define SOFA_DEFAULT_FILE_LOCK()   AcquireSRWLockExclusive(&sofa_defaultFileLock)
+# define SOFA_DEFAULT_FILE_UNLOCK() ReleaseSRWLockExclusive(&sofa_defaultFileLock)
+#else
+static pthread_mutex_t sofa_defaultFileLock = PTHREAD_MUTEX_INITIALIZER;
+# define SOFA_DEFAULT_FILE_LOCK()   pthread_mutex_lock(&sofa_defaultFileLock)
+# define SOFA_DEFAULT_FILE_UNLOCK() pthread_mutex_unlock(&sofa_defaultFileLock)
+#endif
+
+/**
+ * Returns a copy of the path of the SOFA file holding the default HRIRs; or
+ * NULL if the built-in set is to be used (the copy must be freed)
+ */
+static char* sofa_getDefaultFilePath(void)
+{
+    const char* path;
+    char* copy;
+
+    SOFA_DEFAULT_FILE_LOCK();
+    path = sofa_defaultFilePath;
+#ifdef SAF_DEFAULT_HRIRS_EXTERNAL
+    if(path==NULL)
+        path = SAF_DEFAULT_HRIRS_PATH;
+#endif
+    copy = NULL;
+    if(path!=NULL){
+        copy = malloc1d((strlen(path)+1)*sizeof(char));
+        strcpy(copy, path);
+    }
+    SOFA_DEFAULT_FILE_UNLOCK();
+    return copy;
+}
+
+/**
+ * Returns the dimension lengths of a netcdf variable (up to 'maxNdims')
+ *
+ * @returns the number of dimensions of the variable, or -1 if it was not found
+ */
+static int sofa_getVarDims
+(
+    int ncid,
+    const char* varName,
+    int* varid,
+    size_t* dims,
+    int maxNdims
+)
+{
+    int i, ndims, dimids[NC_MAX_VAR_DIMS];
+
+    if(nc_inq_varid(ncid, varName, varid) != NC_NOERR)
+        return -1;
+    if(nc_inq_varndims(ncid, *varid, &ndims) != NC_NOERR || ndims>NC_MAX_VAR_DIMS)
+        return -1;
+    if(nc_inq_vardimid(ncid, *varid, dimids) != NC_NOERR)
+        return -1;
+    for(i=0; i<MIN(ndims, maxNdims); i++)
+        if(nc_inq_dimlen(ncid, dimids[i], &dims[i]) != NC_NOERR)
+            return -1;
+    return ndims;
+}
+
+/**
+ * Opens a SOFA file, and determines the dimensions of its IR and positional
+ * data
+ *
+ * @returns NC_NOERR if the file was opened and contains usable HRIR data (in
+ *          which case, it must be closed by the caller), or an error value
+ */
+static int sofa_openFile
+(
+    const char* sofa_filepath,
+    int* ncid,
+    size_t IR_dims[3],
+    size_t SourcePosition_dims[2]
+)
+{
+    int varid;
+
+    if(sofa_filepath==NULL || nc_open(sofa_filepath, NC_NOWRITE, ncid) != NC_NOERR)
+        return NC_FATAL;
+    if( sofa_getVarDims(*ncid, "Data.IR", &varid, IR_dims, 3) != 3 ||
+        sofa_getVarDims(*ncid, "SourcePosition", &varid, SourcePosition_dims, 2) != 2 ||
+        SourcePosition_dims[0]!=IR_dims[0] || SourcePosition_dims[1]<2 ){
+        nc_close(*ncid);
+        return NC_FATAL;
+    }
+    return NC_NOERR;
+}
+
+/**
+ * Converts the azimuths of the HRIR directions to the -180..180 range, if they
+ * are given in the 0..360 range
+ */
+static void sofa_wrapAzimuths
+(
+    float* hrir_dirs_deg,
+    int N_hrir_dirs
+)
+{
+    int i, is0_360;
+
+    is0_360 = 0;
+    for(i=0; i<N_hrir_dirs; i++)
+        if(hrir_dirs_deg[2*i+0]>=181.0f)
+            is0_360 = 1;
+    if(is0_360)
+        for(i=0; i<N_hrir_dirs; i++)
+            hrir_dirs_deg[2*i+0] = hrir_dirs_deg[2*i+0]>180.0f ? hrir_dirs_deg[2*i+0] -360.0f : hrir_dirs_deg[2*i+0];
+}
+
 void loadSofaFile
 (
     char* sofa_filepath,
@@ -39,50 +160,84 @@ void loadSofaFile
     int* hrir_fs
 )
 {
-    int i, j, k, retval,dimid[6], *dimids, ndimsp,ncid, varid, is0_360;
-    size_t dimlength[6], IR_dims[3], SourcePosition_dims[2];
-    size_t hrir_dims[3], hrir_pos_dims[2];
-    char dimname[6];
+    loadSofaFile_partial(sofa_filepath, NULL, 0, 0, hrirs, hrir_dirs_deg,
+                         N_hrir_dirs, hrir_len, hrir_fs);
+}
+
+void loadSofaFile_partial
+(
+    char* sofa_filepath,
+    int* dirIdx,
+    int nDirIdx,
+    int maxLen,
+    float** hrirs,
+    float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs
+)
+{
+    int i, k, ncid, varid, allDirs, retval, nIR_dirs, nDirs, nEars, len;
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
+    int j, n;
+#endif
+    size_t IR_dims[3], SourcePosition_dims[2], start[3], count[3];
     const char* errorMessage;
-    double* IR, *SourcePosition, IR_fs;
+    char* defaultFilePath;
+    double IR_fs;
+    float* SourcePosition;
     
     /* free any existing memory */
     free1d((void**)&(*hrirs));
     free1d((void**)&(*hrir_dirs_deg));
     
-    /* open sofa file */
+    /* open sofa file, and determine the dimensions of the IR and positional data */
     /* (retval is set to error value if sofa_filepath==NULL (intentional), or if the file
      * path/name was not found (unintentional). */
-    if(sofa_filepath!=NULL){
-        if ((retval = nc_open(sofa_filepath, NC_NOWRITE, &ncid)))
-            errorMessage = nc_strerror(retval);
+    retval = sofa_openFile(sofa_filepath, &ncid, IR_dims, SourcePosition_dims);
+    
+    /* if error, try the SOFA file holding the default HRIRs (if there is one): */
+    if(retval!=NC_NOERR && (defaultFilePath = sofa_getDefaultFilePath())!=NULL){
+        retval = sofa_openFile(defaultFilePath, &ncid, IR_dims, SourcePosition_dims);
+        free(defaultFilePath);
+#ifndef NDEBUG
+        if(retval==NC_NOERR && sofa_filepath!=NULL)
+            saf_error_print(SAF_WARNING__SOFA_FILE_NOT_FOUND);
+#endif
     }
-    else
-        retval = NC_FATAL;
     
     /* if error: */
+#ifdef SAF_DEFAULT_HRIRS_EXTERNAL
+    if(retval!=NC_NOERR){
+        /* there is no built-in set to fall back on */
+        (*N_hrir_dirs) = (*hrir_len) = (*hrir_fs) = 0;
+# ifndef NDEBUG
+        saf_error_print(SAF_ERROR__DEFAULT_HRIRS_NOT_FOUND);
+# endif
+        return;
+    }
+#else
     if(retval!=NC_NOERR){
-        is0_360 = 0;
         /* return default HRIR data */
-        (*N_hrir_dirs) = __default_N_hrir_dirs;
-        (*hrir_len) = __default_hrir_len;
+        nIR_dirs = __default_N_hrir_dirs;
+        nEars = 2;
+        len = maxLen>0 ? MIN(maxLen, __default_hrir_len) : __default_hrir_len;
+        allDirs = dirIdx==NULL || nDirIdx<=0;
+        nDirs = allDirs ? nIR_dirs : nDirIdx;
+        (*N_hrir_dirs) = nDirs;
+        (*hrir_len) = len;
         (*hrir_fs) = __default_hrir_fs;
-        (*hrirs) = malloc1d((*N_hrir_dirs) * 2 * (*hrir_len)*sizeof(float));
-        for(i=0; i<(*N_hrir_dirs); i++)
-            for(j=0; j<2; j++)
-                for(k=0; k< (*hrir_len); k++)
-                    (*hrirs)[i*2*(*hrir_len) + j*(*hrir_len) + k] = (float)__default_hrirs[i][j][k];
-        (*hrir_dirs_deg) = malloc1d((*N_hrir_dirs) * 2 * sizeof(float));
-        for(i=0; i<(*N_hrir_dirs); i++){
+        (*hrirs) = malloc1d(nDirs * nEars * len * sizeof(float));
+        (*hrir_dirs_deg) = malloc1d(nDirs * 2 * sizeof(float));
+        for(i=0; i<nDirs; i++){
+            k = allDirs ? i : CLAMP(dirIdx[i], 0, nIR_dirs-1);
+            for(j=0; j<nEars; j++)
+                for(n=0; n<len; n++)
+                    (*hrirs)[i*nEars*len + j*len + n] = (float)__default_hrirs[k][j][n];
             for(j=0; j<2; j++)
-                (*hrir_dirs_deg)[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
-            if((*hrir_dirs_deg)[2*i+0]>=181.0f)
-                is0_360 = 1;
+                (*hrir_dirs_deg)[i*2+j] = (float)__default_hrir_dirs_deg[k][j];
         }
-        /* convert to -180..180, if azi is 0..360 */
-        if(is0_360)
-            for(i=0; i<(*N_hrir_dirs); i++)
-                (*hrir_dirs_deg)[2*i+0] = (*hrir_dirs_deg)[2*i+0]>180.0f ? (*hrir_dirs_deg)[2*i+0] -360.0f : (*hrir_dirs_deg)[2*i+0];
+        sofa_wrapAzimuths((*hrir_dirs_deg), nDirs);
         
 #ifndef NDEBUG
         /* also output warning message, if encountering this error value was
@@ -92,91 +247,658 @@ void loadSofaFile
 #endif
         return;
     }
- 
-    /* Determine dimension IDs and lengths */
-    /* Note: there are 6 possible dimension lengths in the sofa standard */
-    for (i=0; i<6; i++){
-        retval = nc_inq_dim(ncid, i, &dimname[i], &dimlength[i]);
-        errorMessage = nc_strerror(retval);
-        retval = nc_inq_dimid(ncid, &dimname[i], &dimid[i]);
-        errorMessage = nc_strerror(retval);
-    }
+#endif /* SAF_DEFAULT_HRIRS_EXTERNAL */
     
-    /* Extract IR data */
-    if ((retval = nc_inq_varid(ncid, "Data.IR", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc1d(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<3; i++)
-        IR_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    IR = malloc1d(IR_dims[0]*IR_dims[1]*IR_dims[2]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, IR)))
-        errorMessage = nc_strerror(retval);
+    /* Allocate memory in its final layout */
+    nIR_dirs = (int)IR_dims[0];
+    nEars = (int)IR_dims[1];
+    len = maxLen>0 ? MIN(maxLen, (int)IR_dims[2]) : (int)IR_dims[2];
+    allDirs = dirIdx==NULL || nDirIdx<=0;
+    nDirs = allDirs ? nIR_dirs : nDirIdx;
+    (*N_hrir_dirs) = nDirs;
+    (*hrir_len) = len;
+    (*hrirs) = malloc1d(nDirs * nEars * len * sizeof(float));
+    (*hrir_dirs_deg) = malloc1d(nDirs * 2 * sizeof(float));
+    
+    /* Extract IR data; read directly into the output (netcdf converts to
+     * float), one hyperslab per measurement, such that only the requested
+     * directions and samples are ever loaded into memory */
+    nc_inq_varid(ncid, "Data.IR", &varid);
+    start[1] = start[2] = 0;
+    count[0] = 1;
+    count[1] = (size_t)nEars;
+    count[2] = (size_t)len;
+    if(allDirs){
+        start[0] = 0;
+        count[0] = (size_t)nDirs;
+        if ((retval = nc_get_vara_float(ncid, varid, start, count, (*hrirs))))
+            errorMessage = nc_strerror(retval);
+    }
+    else{
+        for(i=0; i<nDirs; i++){
+            start[0] = (size_t)CLAMP(dirIdx[i], 0, nIR_dirs-1);
+            if ((retval = nc_get_vara_float(ncid, varid, start, count, &(*hrirs)[i*nEars*len])))
+                errorMessage = nc_strerror(retval);
+        }
+    }
     if ((retval = nc_inq_varid(ncid, "Data.SamplingRate", &varid)))
         errorMessage = nc_strerror(retval);
-    if ((retval = nc_get_var(ncid, varid, &IR_fs)))
+    if ((retval = nc_get_var_double(ncid, varid, &IR_fs)))
         errorMessage = nc_strerror(retval);
+    (*hrir_fs) = (int)(IR_fs+0.5);
     
-    /* Extract positional data */
-    if ((retval = nc_inq_varid(ncid, "SourcePosition", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc1d(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<2; i++)
-        SourcePosition_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    SourcePosition = malloc1d(SourcePosition_dims[0]*SourcePosition_dims[1]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, SourcePosition)))
+    /* Extract positional data (only azimuth and elevation) */
+    SourcePosition = malloc1d(nIR_dirs*2*sizeof(float));
+    nc_inq_varid(ncid, "SourcePosition", &varid);
+    start[0] = start[1] = 0;
+    count[0] = (size_t)nIR_dirs;
+    count[1] = 2;
+    if ((retval = nc_get_vara_float(ncid, varid, start, count, SourcePosition)))
         errorMessage = nc_strerror(retval);
+    for(i=0; i<nDirs; i++){
+        k = allDirs ? i : CLAMP(dirIdx[i], 0, nIR_dirs-1);
+        (*hrir_dirs_deg)[2*i+0] = SourcePosition[2*k+0];
+        (*hrir_dirs_deg)[2*i+1] = SourcePosition[2*k+1];
+    }
+    free(SourcePosition);
     
     /* Close the file, freeing all resources. */
     if ((retval = nc_close(ncid)))
         errorMessage = nc_strerror(retval);
     
-    /* Allocate memory */
-    (*hrir_len) = (int)IR_dims[2]; 
-    (*hrirs) = malloc1d(IR_dims[0]*IR_dims[1]*(*hrir_len) *sizeof(float));
-    (*hrir_dirs_deg) = malloc1d(SourcePosition_dims[0]*2*sizeof(float));
-    
-    /* Store relevent info in handle */
-    (*hrir_fs) = (int)(IR_fs+0.5);
-    hrir_dims[0] = IR_dims[0];
-    hrir_dims[1] = IR_dims[1];
-    hrir_dims[2] = (size_t)(*hrir_len);
-    (*N_hrir_dirs) = (int)hrir_dims[0];
-    for(i=0; i<2; i++)
-        hrir_pos_dims[i] = SourcePosition_dims[i];
-    for(i=0; i<hrir_dims[0]; i++){
-        for(j=0; j<hrir_dims[1]; j++){
-            for(k=0; k<hrir_dims[2]; k++){
-                /* trunctate IRs and store in floating point precision */
-                (*hrirs)[i*hrir_dims[1]*hrir_dims[2] + j*hrir_dims[2] + k] = (float)IR[i*IR_dims[1]*IR_dims[2] + j*IR_dims[2] + k];
+    /* convert to -180..180, if azi is 0..360 */
+    sofa_wrapAzimuths((*hrir_dirs_deg), nDirs);
+}
+
+/* ========================================================================== */
+/*                                 HRTF Cache                                 */
+/* ========================================================================== */
+
+/**
+ * Data structure for a cached (immutable) HRIR set and its derived HRTF data.
+ *
+ * Entries are shared by all instances requesting the same SOFA file, number of
+ * bands and band centre frequencies, and are kept in a process-wide cache.
+ */
+typedef struct _hrtfCache_entry {
+    char* sofa_filepath;     /**< NULL for the default HRIR set */
+    int N_bands;
+    float* centreFreq;       /**< band centre frequencies; N_bands x 1 */
+    int refCount;            /**< number of instances currently using the entry */
+    unsigned int lastUsed;   /**< value of 'hrtfCache_clock' when last released */
+    float* hrirs;            /**< FLAT: N_hrir_dirs x 2 x hrir_len */
+    float* hrir_dirs_deg;    /**< FLAT: N_hrir_dirs x 2 */
+    int N_hrir_dirs, hrir_len, hrir_fs;
+    float* itds_s;           /**< N_hrir_dirs x 1 */
+    float_complex* hrtf_fb;  /**< FLAT: N_bands x 2 x N_hrir_dirs */
+    float* hrtf_fb_mag;      /**< FLAT: N_bands x 2 x N_hrir_dirs */
+    void* hrtf_mags[SAF_STORAGE_BFLOAT16]; /**< 'hrtf_fb_mag' per storage format (created on request); FLAT: N_hrir_dirs x N_bands x 2 */
+    struct _hrtfCache_entry* next;
+
+}hrtfCache_entry;
+
+/** Head of the linked-list of cached entries */
+static hrtfCache_entry* hrtfCache = NULL;
+/** Incremented each time an entry is released (orders the unused entries) */
+static unsigned int hrtfCache_clock = 0;
+/** Directory for the on-disk cache (NULL if disabled) */
+static char* hrtfCache_diskDir = NULL;
+/** Lock for the HRTF cache */
+#if defined(_WIN32)
+static SRWLOCK hrtfCacheLock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t hrtfCacheLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void lockHrtfCache(void)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&hrtfCacheLock);
+#else
+    pthread_mutex_lock(&hrtfCacheLock);
+#endif
+}
+
+static void unlockHrtfCache(void)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&hrtfCacheLock);
+#else
+    pthread_mutex_unlock(&hrtfCacheLock);
+#endif
+}
+
+/* Current version of the on-disk cache file format */
+#define HRTF_CACHE_FILE_VERSION ( 1 )
+/* Maximum length of an on-disk cache file path */
+#define HRTF_CACHE_MAX_PATH_LENGTH ( 4096 )
+
+/**
+ * Header of an on-disk cache file, which is followed by: centreFreq, hrirs,
+ * hrir_dirs_deg, itds_s, and hrtf_fb (all stored in native byte order)
+ */
+typedef struct _hrtfCache_fileHeader {
+    char magic[8];           /**< "SAFHRTF" */
+    uint32_t version;        /**< HRTF_CACHE_FILE_VERSION */
+    uint32_t N_bands;
+    uint64_t key;            /**< hash of the HRIR data and the settings */
+    int32_t N_hrir_dirs, hrir_len, hrir_fs;
+    uint32_t reserved;
+    uint64_t checksum;       /**< hash of the data following the header */
+
+}hrtfCache_fileHeader;
+
+/** Updates a 64-bit FNV-1a hash with 'nBytes' of data */
+static uint64_t hrtfCache_hash
+(
+    uint64_t hash,
+    const void* data,
+    size_t nBytes
+)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i;
+
+    for(i=0; i<nBytes; i++){
+        hash ^= (uint64_t)bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Returns the key for an entry; a hash of the contents of the SOFA file (or
+ * of the default HRIR data, if the file cannot be read), the number of bands,
+ * the band centre frequencies, and the file format version
+ */
+static uint64_t hrtfCache_getKey
+(
+    char* sofa_filepath,
+    float* centreFreq,
+    int N_bands
+)
+{
+    uint64_t key;
+    FILE* file;
+    size_t nRead;
+    unsigned char buffer[65536];
+    char* defaultFilePath;
+    int version;
+
+    key = 14695981039346656037ULL; /* FNV offset basis */
+    file = sofa_filepath!=NULL ? fopen(sofa_filepath, "rb") : NULL;
+    if(file==NULL && (defaultFilePath = sofa_getDefaultFilePath())!=NULL){
+        file = fopen(defaultFilePath, "rb");
+        free(defaultFilePath);
+    }
+    if(file!=NULL){
+        while((nRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            key = hrtfCache_hash(key, buffer, nRead);
+        fclose(file);
+    }
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
+    else{
+        key = hrtfCache_hash(key, __default_hrirs, sizeof(__default_hrirs));
+        key = hrtfCache_hash(key, __default_hrir_dirs_deg, sizeof(__default_hrir_dirs_deg));
+        key = hrtfCache_hash(key, &__default_hrir_fs, sizeof(int));
+    }
+#endif
+    version = HRTF_CACHE_FILE_VERSION;
+    key = hrtfCache_hash(key, &version, sizeof(int));
+    key = hrtfCache_hash(key, &N_bands, sizeof(int));
+    key = hrtfCache_hash(key, centreFreq, N_bands*sizeof(float));
+    return key;
+}
+
+/** Returns the path of the on-disk cache file for a given key */
+static void hrtfCache_getFilePath
+(
+    uint64_t key,
+    char* path
+)
+{
+    snprintf(path, HRTF_CACHE_MAX_PATH_LENGTH, "%s/saf_hrtf_%016llx.bin",
+             hrtfCache_diskDir, (unsigned long long)key);
+}
+
+/**
+ * Loads the data of an entry from an on-disk cache file
+ *
+ * @returns 1 if the file exists and is valid, 0 otherwise (in which case, the
+ *          entry is left empty)
+ */
+static int hrtfCache_readFile
+(
+    hrtfCache_entry* e,
+    uint64_t key
+)
+{
+    hrtfCache_fileHeader header;
+    char path[HRTF_CACHE_MAX_PATH_LENGTH];
+    FILE* file;
+    uint64_t checksum;
+    float* centreFreq;
+    int ok;
+    size_t nDirs, nIR, nFB;
+
+    hrtfCache_getFilePath(key, path);
+    if((file = fopen(path, "rb"))==NULL)
+        return 0;
+    ok = fread(&header, sizeof(hrtfCache_fileHeader), 1, file) == 1 &&
+         !memcmp(header.magic, "SAFHRTF", 8) &&
+         header.version == HRTF_CACHE_FILE_VERSION &&
+         header.key == key && (int)header.N_bands == e->N_bands &&
+         header.N_hrir_dirs > 0 && header.hrir_len > 0;
+    if(!ok){
+        fclose(file);
+        return 0;
+    }
+    nDirs = (size_t)header.N_hrir_dirs;
+    nIR = nDirs * 2 * (size_t)header.hrir_len;
+    nFB = (size_t)e->N_bands * 2 * nDirs;
+    centreFreq = malloc1d(e->N_bands*sizeof(float));
+    e->hrirs = malloc1d(nIR*sizeof(float));
+    e->hrir_dirs_deg = malloc1d(nDirs*2*sizeof(float));
+    e->itds_s = malloc1d(nDirs*sizeof(float));
+    e->hrtf_fb = malloc1d(nFB*sizeof(float_complex));
+    ok = fread(centreFreq, sizeof(float), e->N_bands, file) == (size_t)e->N_bands &&
+         fread(e->hrirs, sizeof(float), nIR, file) == nIR &&
+         fread(e->hrir_dirs_deg, sizeof(float), nDirs*2, file) == nDirs*2 &&
+         fread(e->itds_s, sizeof(float), nDirs, file) == nDirs &&
+         fread(e->hrtf_fb, sizeof(float_complex), nFB, file) == nFB;
+    fclose(file);
+    if(ok){
+        checksum = hrtfCache_hash(14695981039346656037ULL, centreFreq, e->N_bands*sizeof(float));
+        checksum = hrtfCache_hash(checksum, e->hrirs, nIR*sizeof(float));
+        checksum = hrtfCache_hash(checksum, e->hrir_dirs_deg, nDirs*2*sizeof(float));
+        checksum = hrtfCache_hash(checksum, e->itds_s, nDirs*sizeof(float));
+        checksum = hrtfCache_hash(checksum, e->hrtf_fb, nFB*sizeof(float_complex));
+        ok = checksum == header.checksum &&
+             !memcmp(centreFreq, e->centreFreq, e->N_bands*sizeof(float));
+    }
+    free(centreFreq);
+    if(!ok){
+        free1d((void**)&(e->hrirs));
+        free1d((void**)&(e->hrir_dirs_deg));
+        free1d((void**)&(e->itds_s));
+        free1d((void**)&(e->hrtf_fb));
+        return 0;
+    }
+    e->N_hrir_dirs = header.N_hrir_dirs;
+    e->hrir_len = header.hrir_len;
+    e->hrir_fs = header.hrir_fs;
+    return 1;
+}
+
+/**
+ * Saves the data of an entry to an on-disk cache file (failures are ignored,
+ * since the cache file is only an optimisation)
+ */
+static void hrtfCache_writeFile
+(
+    hrtfCache_entry* e,
+    uint64_t key
+)
+{
+    hrtfCache_fileHeader header;
+    char path[HRTF_CACHE_MAX_PATH_LENGTH], tmpPath[HRTF_CACHE_MAX_PATH_LENGTH+8];
+    FILE* file;
+    int ok;
+    size_t nDirs, nIR, nFB;
+
+    nDirs = (size_t)e->N_hrir_dirs;
+    nIR = nDirs * 2 * (size_t)e->hrir_len;
+    nFB = (size_t)e->N_bands * 2 * nDirs;
+    memset(&header, 0, sizeof(hrtfCache_fileHeader));
+    memcpy(header.magic, "SAFHRTF", 8);
+    header.version = HRTF_CACHE_FILE_VERSION;
+    header.N_bands = (uint32_t)e->N_bands;
+    header.key = key;
+    header.N_hrir_dirs = e->N_hrir_dirs;
+    header.hrir_len = e->hrir_len;
+    header.hrir_fs = e->hrir_fs;
+    header.checksum = hrtfCache_hash(14695981039346656037ULL, e->centreFreq, e->N_bands*sizeof(float));
+    header.checksum = hrtfCache_hash(header.checksum, e->hrirs, nIR*sizeof(float));
+    header.checksum = hrtfCache_hash(header.checksum, e->hrir_dirs_deg, nDirs*2*sizeof(float));
+    header.checksum = hrtfCache_hash(header.checksum, e->itds_s, nDirs*sizeof(float));
+    header.checksum = hrtfCache_hash(header.checksum, e->hrtf_fb, nFB*sizeof(float_complex));
+
+    /* write to a temporary file first, and then rename it; such that other
+     * processes never read a partially written file */
+    hrtfCache_getFilePath(key, path);
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    if((file = fopen(tmpPath, "wb"))==NULL)
+        return;
+    ok = fwrite(&header, sizeof(hrtfCache_fileHeader), 1, file) == 1 &&
+         fwrite(e->centreFreq, sizeof(float), e->N_bands, file) == (size_t)e->N_bands &&
+         fwrite(e->hrirs, sizeof(float), nIR, file) == nIR &&
+         fwrite(e->hrir_dirs_deg, sizeof(float), nDirs*2, file) == nDirs*2 &&
+         fwrite(e->itds_s, sizeof(float), nDirs, file) == nDirs &&
+         fwrite(e->hrtf_fb, sizeof(float_complex), nFB, file) == nFB;
+    ok = fclose(file) == 0 && ok;
+    remove(path);
+    if(!ok || rename(tmpPath, path)!=0)
+        remove(tmpPath);
+}
+
+/**
+ * Loads the HRIRs and computes the derived HRTF data for a new entry (the cache
+ * must be locked); or loads them from the on-disk cache, if enabled
+ */
+static hrtfCache_entry* createHrtfCacheEntry
+(
+    char* sofa_filepath,
+    float* centreFreq,
+    int N_bands
+)
+{
+    hrtfCache_entry* e;
+    int i, nCoeffs, loaded;
+    uint64_t key;
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
+    char* defaultFilePath;
+#endif
+
+    e = malloc1d(sizeof(hrtfCache_entry));
+    e->sofa_filepath = NULL;
+    for(i=0; i<SAF_STORAGE_BFLOAT16; i++)
+        e->hrtf_mags[i] = NULL;
+    if(sofa_filepath!=NULL){
+        e->sofa_filepath = malloc1d((strlen(sofa_filepath)+1)*sizeof(char));
+        strcpy(e->sofa_filepath, sofa_filepath);
+    }
+    e->N_bands = N_bands;
+    e->centreFreq = malloc1d(N_bands*sizeof(float));
+    memcpy(e->centreFreq, centreFreq, N_bands*sizeof(float));
+    e->refCount = 0;
+    e->lastUsed = 0;
+    e->hrirs = e->hrir_dirs_deg = e->itds_s = NULL;
+    e->hrtf_fb = NULL;
+
+    /* try the on-disk cache first */
+    loaded = 0;
+    key = 0;
+    if(hrtfCache_diskDir!=NULL){
+        saf_initReport_beginStage("hrtfCache_readFile");
+        key = hrtfCache_getKey(sofa_filepath, centreFreq, N_bands);
+        loaded = hrtfCache_readFile(e, key);
+        saf_initReport_endStage();
+    }
+
+    if(!loaded){
+        /* load sofa file or default hrir data */
+        saf_initReport_beginStage("loadSofaFile");
+        loadSofaFile(sofa_filepath, &(e->hrirs), &(e->hrir_dirs_deg),
+                     &(e->N_hrir_dirs), &(e->hrir_len), &(e->hrir_fs));
+        saf_initReport_endStage();
+
+#ifndef SAF_DEFAULT_HRIRS_EXTERNAL
+        /* the ITDs and filterbank coefficients of the built-in set are
+         * precomputed (only the diffuse-field EQ depends on the bands) */
+        defaultFilePath = sofa_filepath==NULL ? sofa_getDefaultFilePath() : NULL;
+        if(sofa_filepath==NULL && defaultFilePath==NULL && N_bands==133){
+            saf_initReport_beginStage("copyDefaultHRTFs");
+            e->itds_s = malloc1d(e->N_hrir_dirs*sizeof(float));
+            memcpy(e->itds_s, __default_hrir_itds_s, e->N_hrir_dirs*sizeof(float));
+            e->hrtf_fb = malloc1d(N_bands * 2 * (e->N_hrir_dirs)*sizeof(float_complex));
+            memcpy(e->hrtf_fb, __default_hrtf_fb, N_bands * 2 * (e->N_hrir_dirs)*sizeof(float_complex));
+            saf_initReport_endStage();
+        }
+        free(defaultFilePath);
+#endif
+        if(e->hrtf_fb==NULL){
+            /* estimate the ITDs for each HRIR */
+            saf_initReport_beginStage("estimateITDs");
+            e->itds_s = malloc1d(e->N_hrir_dirs*sizeof(float));
+            estimateITDs(e->hrirs, e->N_hrir_dirs, e->hrir_len, e->hrir_fs, e->itds_s);
+            saf_initReport_endStage();
+
+            /* convert hrirs to filterbank coefficients */
+            saf_initReport_beginStage("HRIRs2FilterbankHRTFs");
+            e->hrtf_fb = malloc1d(N_bands * 2 * (e->N_hrir_dirs)*sizeof(float_complex));
+            HRIRs2FilterbankHRTFs(e->hrirs, e->N_hrir_dirs, e->hrir_len, e->hrtf_fb);
+            saf_initReport_endStage();
+        }
+
+        /* apply diffuse-field EQ */
+        saf_initReport_beginStage("diffuseFieldEqualiseHRTFs");
+        diffuseFieldEqualiseHRTFs(e->N_hrir_dirs, e->itds_s, e->centreFreq, N_bands, e->hrtf_fb);
+        saf_initReport_endStage();
+
+        if(hrtfCache_diskDir!=NULL){
+            saf_initReport_beginStage("hrtfCache_writeFile");
+            hrtfCache_writeFile(e, key);
+            saf_initReport_endStage();
+        }
+    }
+
+    /* calculate magnitude responses */
+    nCoeffs = N_bands * 2 * (e->N_hrir_dirs);
+    e->hrtf_fb_mag = malloc1d(nCoeffs*sizeof(float));
+    for(i=0; i<nCoeffs; i++)
+        e->hrtf_fb_mag[i] = cabsf(e->hrtf_fb[i]);
+
+    return e;
+}
+
+/** Destroys an entry (the cache must be locked) */
+static void destroyHrtfCacheEntry
+(
+    hrtfCache_entry* e
+)
+{
+    int i;
+
+    for(i=0; i<SAF_STORAGE_BFLOAT16; i++)
+        free(e->hrtf_mags[i]);
+    free(e->sofa_filepath);
+    free(e->centreFreq);
+    free(e->hrirs);
+    free(e->hrir_dirs_deg);
+    free(e->itds_s);
+    free(e->hrtf_fb);
+    free(e->hrtf_fb_mag);
+    free(e);
+}
+
+void hrtfCache_acquire
+(
+    void ** const phHRTFs,
+    char* sofa_filepath,
+    float* centreFreq,
+    int N_bands
+)
+{
+    hrtfCache_entry* e;
+
+    lockHrtfCache();
+    for(e = hrtfCache; e != NULL; e = e->next){
+        if(e->N_bands == N_bands &&
+           !memcmp(e->centreFreq, centreFreq, N_bands*sizeof(float)) &&
+           ((e->sofa_filepath==NULL && sofa_filepath==NULL) ||
+            (e->sofa_filepath!=NULL && sofa_filepath!=NULL && !strcmp(e->sofa_filepath, sofa_filepath))))
+            break;
+    }
+    if(e == NULL){
+        /* (the lock is held while loading, so that instances requesting the
+         * same data at the same time only compute it once) */
+        e = createHrtfCacheEntry(sofa_filepath, centreFreq, N_bands);
+        e->next = hrtfCache;
+        hrtfCache = e;
+    }
+    e->refCount++;
+    unlockHrtfCache();
+    *phHRTFs = (void*)e;
+}
+
+void hrtfCache_retain
+(
+    void * const hHRTFs
+)
+{
+    hrtfCache_entry* e = (hrtfCache_entry*)(hHRTFs);
+
+    if(e == NULL)
+        return;
+    lockHrtfCache();
+    assert(e->refCount>0);
+    e->refCount++;
+    unlockHrtfCache();
+}
+
+void hrtfCache_release
+(
+    void ** const phHRTFs
+)
+{
+    hrtfCache_entry* e, **pp, **ppOldest;
+    int nUnused;
+
+    e = (hrtfCache_entry*)(*phHRTFs);
+    if(e == NULL)
+        return;
+    lockHrtfCache();
+    e->refCount--;
+    assert(e->refCount>=0);
+    if(e->refCount == 0){
+        /* keep the entry, in case it is requested again (e.g. when switching
+         * back to a previous sampling rate), but discard the least recently
+         * used of the unused entries beyond HRTF_CACHE_MAX_UNUSED_ENTRIES */
+        e->lastUsed = ++hrtfCache_clock;
+        do{
+            nUnused = 0;
+            ppOldest = NULL;
+            for(pp = &hrtfCache; *pp != NULL; pp = &((*pp)->next)){
+                if((*pp)->refCount == 0){
+                    nUnused++;
+                    if(ppOldest==NULL || (*pp)->lastUsed < (*ppOldest)->lastUsed)
+                        ppOldest = pp;
+                }
             }
+            if(nUnused > HRTF_CACHE_MAX_UNUSED_ENTRIES){
+                e = *ppOldest;
+                *ppOldest = e->next;
+                destroyHrtfCacheEntry(e);
+            }
+        } while(nUnused > HRTF_CACHE_MAX_UNUSED_ENTRIES);
+    }
+    unlockHrtfCache();
+    *phHRTFs = NULL;
+}
+
+void hrtfCache_getData
+(
+    void * const hHRTFs,
+    float** hrirs,
+    float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs,
+    float** itds_s,
+    float_complex** hrtf_fb,
+    float** hrtf_fb_mag
+)
+{
+    hrtfCache_entry* e = (hrtfCache_entry*)(hHRTFs);
+
+    if(hrirs!=NULL)         (*hrirs) = e->hrirs;
+    if(hrir_dirs_deg!=NULL) (*hrir_dirs_deg) = e->hrir_dirs_deg;
+    if(N_hrir_dirs!=NULL)   (*N_hrir_dirs) = e->N_hrir_dirs;
+    if(hrir_len!=NULL)      (*hrir_len) = e->hrir_len;
+    if(hrir_fs!=NULL)       (*hrir_fs) = e->hrir_fs;
+    if(itds_s!=NULL)        (*itds_s) = e->itds_s;
+    if(hrtf_fb!=NULL)       (*hrtf_fb) = e->hrtf_fb;
+    if(hrtf_fb_mag!=NULL)   (*hrtf_fb_mag) = e->hrtf_fb_mag;
+}
+
+void* hrtfCache_getMagnitudes
+(
+    void * const hHRTFs,
+    SAF_STORAGE_PRECISION precision
+)
+{
+    hrtfCache_entry* e = (hrtfCache_entry*)(hHRTFs);
+    int nd, band, ear;
+    size_t nBytes;
+    float* mags;
+    void* out;
+
+    assert(precision>=SAF_STORAGE_FLOAT32 && precision<=SAF_STORAGE_BFLOAT16);
+    lockHrtfCache();
+    if(e->hrtf_mags[precision-1] == NULL){
+        /* transpose to one contiguous row per direction, and convert */
+        nBytes = utility_storagePrecisionBytes(precision);
+        mags = malloc1d(e->N_bands*2*sizeof(float));
+        e->hrtf_mags[precision-1] = malloc1d((size_t)e->N_hrir_dirs*e->N_bands*2*nBytes);
+        for(nd=0; nd<e->N_hrir_dirs; nd++){
+            for(band=0; band<e->N_bands; band++)
+                for(ear=0; ear<2; ear++)
+                    mags[band*2+ear] = e->hrtf_fb_mag[band*2*(e->N_hrir_dirs) + ear*(e->N_hrir_dirs) + nd];
+            utility_svpack(mags, e->N_bands*2, precision,
+                           (char*)e->hrtf_mags[precision-1] + (size_t)nd*e->N_bands*2*nBytes);
         }
+        free(mags);
     }
-    
-    /* store in floating point precision */
-    is0_360 = 0;
-    for(i=0; i<SourcePosition_dims[0]; i++){
-        (*hrir_dirs_deg)[2*i+0] = (float)SourcePosition[i*SourcePosition_dims[1]+0];
-        (*hrir_dirs_deg)[2*i+1] = (float)SourcePosition[i*SourcePosition_dims[1]+1];
-        if((*hrir_dirs_deg)[2*i+0]>=181.0f)
-            is0_360 = 1;
+    out = e->hrtf_mags[precision-1];
+    unlockHrtfCache();
+    return out;
+}
+
+void hrtfCache_setDiskCacheDirectory
+(
+    char* directory
+)
+{
+    lockHrtfCache();
+    free1d((void**)&hrtfCache_diskDir);
+    if(directory!=NULL){
+        hrtfCache_diskDir = malloc1d((strlen(directory)+1)*sizeof(char));
+        strcpy(hrtfCache_diskDir, directory);
     }
-    
-    /* convert to -180..180, if azi is 0..360 */
-    if(is0_360)
-        for(i=0; i<SourcePosition_dims[0]; i++)
-            (*hrir_dirs_deg)[2*i+0] = (*hrir_dirs_deg)[2*i+0]>180.0f ? (*hrir_dirs_deg)[2*i+0] -360.0f : (*hrir_dirs_deg)[2*i+0];
-            
-    free(IR);
-    free(SourcePosition);
+    unlockHrtfCache();
+}
+
+void setDefaultHRIRsSofaFile
+(
+    char* sofa_filepath
+)
+{
+    SOFA_DEFAULT_FILE_LOCK();
+    free1d((void**)&sofa_defaultFilePath);
+    if(sofa_filepath!=NULL){
+        sofa_defaultFilePath = malloc1d((strlen(sofa_filepath)+1)*sizeof(char));
+        strcpy(sofa_defaultFilePath, sofa_filepath);
+    }
+    SOFA_DEFAULT_FILE_UNLOCK();
+}
+
+void hrtfCache_clearUnused(void)
+{
+    hrtfCache_entry** pp, *e;
+
+    lockHrtfCache();
+    pp = &hrtfCache;
+    while(*pp != NULL){
+        e = *pp;
+        if(e->refCount == 0){
+            *pp = e->next;
+            destroyHrtfCacheEntry(e);
+        }
+        else
+            pp = &(e->next);
+    }
+    unlockHrtfCache();
+}
+
+int hrtfCache_getNumEntries(void)
+{
+    hrtfCache_entry* e;
+    int n;
+
+    lockHrtfCache();
+    for(n=0, e = hrtfCache; e != NULL; e = e->next)
+        n++;
+    unlockHrtfCache();
+    return n;
 }
 #endif /* SAF_ENABLE_SOFA_READER */
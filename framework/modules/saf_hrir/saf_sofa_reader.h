@@ -45,6 +45,16 @@
 extern "C" {
 #endif /* __cplusplus */
 
+#ifndef SAF_DEFAULT_HRIRS_PATH
+/**
+ * SOFA file from which the default HRIRs are loaded, if they are not compiled
+ * in (i.e. if SAF_DEFAULT_HRIRS_EXTERNAL is defined) and no other file has been
+ * set with setDefaultHRIRsSofaFile(); may be overridden via the preprocessor
+ */
+# define SAF_DEFAULT_HRIRS_PATH "saf_default_hrirs.sofa"
+#endif
+
+
 /* ========================================================================== */
 /*                               Main Functions                               */
 /* ========================================================================== */
@@ -76,6 +86,205 @@ void loadSofaFile(/* Input Arguments */
                   int* hrir_len,
                   int* hrir_fs );
 
+/**
+ * A bare-bones SOFA file reader, which loads only a subset of the measurements
+ * and/or truncates the IRs
+ *
+ * The IR data is read directly into the output buffer (as floats), one
+ * measurement at a time; therefore, only the requested directions and samples
+ * are ever held in memory.
+ *
+ * @note The default HRIR data is returned (with the same subset/truncation
+ *       applied) if the file does not exist. Indices beyond the number of
+ *       measurements in the file are clamped.
+ *
+ * @param[in]  sofa_filepath Directory/file_name of the SOFA file you wish to
+ *                           load. Optionally, you may set this as NULL, and the
+ *                           function will return the default HRIR data.
+ * @param[in]  dirIdx        Indices of the measurements to load; nDirIdx x 1,
+ *                           or NULL to load all of them
+ * @param[in]  nDirIdx       Number of indices in 'dirIdx'
+ * @param[in]  maxLen        Maximum HRIR length, in samples (longer HRIRs are
+ *                           truncated); set to 0 to load the full length
+ * @param[out] hrirs         (&) the HRIR data;
+ *                           FLAT: N_hrir_dirs x 2 x hrir_len
+ * @param[out] hrir_dirs_deg (&) the HRIR positions; FLAT: N_hrir_dirs x 2
+ * @param[out] N_hrir_dirs   (&) number of HRIR positions
+ * @param[out] hrir_len      (&) length of the HRIRs, in samples
+ * @param[out] hrir_fs       (&) sampling rate of the HRIRs
+ */
+void loadSofaFile_partial(/* Input Arguments */
+                          char* sofa_filepath,
+                          int* dirIdx,
+                          int nDirIdx,
+                          int maxLen,
+                          /* Output Arguments */
+                          float** hrirs,
+                          float** hrir_dirs_deg,
+                          int* N_hrir_dirs,
+                          int* hrir_len,
+                          int* hrir_fs );
+
+
+/**
+ * Sets the SOFA file from which the default HRIR data is loaded
+ *
+ * The default data is returned by loadSofaFile() and loadSofaFile_partial()
+ * (and used by the HRTF cache) whenever no SOFA file is given, or the given
+ * file cannot be read. If the default file cannot be read either, then the
+ * built-in HRIR set is returned instead; or, if the built-in set has been left
+ * out of the build (SAF_DEFAULT_HRIRS_EXTERNAL), no HRIRs are returned
+ * (N_hrir_dirs=0) and an error is printed in debug builds.
+ *
+ * @note The HRTF cache identifies the default data by a NULL file path; so call
+ *       this before creating any instances that use the default HRIRs.
+ *
+ * @param[in] sofa_filepath Directory/file_name of the SOFA file; or NULL to use
+ *                          the built-in set (default), or SAF_DEFAULT_HRIRS_PATH
+ *                          if SAF_DEFAULT_HRIRS_EXTERNAL is defined
+ */
+void setDefaultHRIRsSofaFile(/* Input Arguments */
+                             char* sofa_filepath);
+
+
+/* ========================================================================== */
+/*                                 HRTF Cache                                 */
+/* ========================================================================== */
+
+/**
+ * Returns a handle to a (new or cached) HRIR set, along with its ITDs and
+ * diffuse-field equalised filterbank HRTFs
+ *
+ * The data is kept in a process-wide cache, and shared (read-only) by all
+ * instances that request the same SOFA file, number of bands and band centre
+ * frequencies. Therefore, loadSofaFile(), estimateITDs(),
+ * HRIRs2FilterbankHRTFs() and diffuseFieldEqualiseHRTFs() are only called once
+ * for each unique request. If the data is not yet cached, this function blocks
+ * until it has been computed.
+ *
+ * @note Each call must be paired with a call to hrtfCache_release(). When
+ *       switching to a different HRIR set, acquire the new handle before
+ *       releasing the old one, such that shared data is not recomputed.
+ *
+ * @param[out] phHRTFs       (&) address of the HRTF data handle
+ * @param[in]  sofa_filepath Directory/file_name of the SOFA file; or NULL, to
+ *                           use the default HRIR data
+ * @param[in]  centreFreq    Centre frequencies of the filterbank bands, in Hz;
+ *                           N_bands x 1
+ * @param[in]  N_bands       Number of filterbank bands
+ */
+void hrtfCache_acquire(/* Output Arguments */
+                       void ** const phHRTFs,
+                       /* Input Arguments */
+                       char* sofa_filepath,
+                       float* centreFreq,
+                       int N_bands);
+
+/**
+ * Adds a user to a handle returned by hrtfCache_acquire() (e.g. when copying an
+ * instance), which must also be paired with a call to hrtfCache_release()
+ *
+ * @param[in] hHRTFs HRTF data handle (may be NULL)
+ */
+void hrtfCache_retain(/* Input Arguments */
+                      void * const hHRTFs);
+
+/**
+ * Releases a handle returned by hrtfCache_acquire()
+ *
+ * Data that is no longer used by any instance is kept in the cache, such that
+ * requesting it again (e.g. after switching back to a previous sampling rate,
+ * or SOFA file) does not recompute it; up to HRTF_CACHE_MAX_UNUSED_ENTRIES
+ * unused sets are kept, beyond which the least recently used are freed.
+ *
+ * @param[in] phHRTFs (&) address of the HRTF data handle (set to NULL)
+ */
+void hrtfCache_release(/* Input Arguments */
+                       void ** const phHRTFs);
+
+/**
+ * Returns pointers to the (shared) data of a cached HRIR set
+ *
+ * @warning The returned arrays are shared with other instances, and so must not
+ *          be modified or freed. They remain valid until the handle is released.
+ *
+ * @param[in]  hHRTFs        HRTF data handle
+ * @param[out] hrirs         (&) HRIR data; FLAT: N_hrir_dirs x 2 x hrir_len
+ * @param[out] hrir_dirs_deg (&) HRIR positions; FLAT: N_hrir_dirs x 2
+ * @param[out] N_hrir_dirs   (&) number of HRIR positions
+ * @param[out] hrir_len      (&) length of the HRIRs, in samples
+ * @param[out] hrir_fs       (&) sampling rate of the HRIRs
+ * @param[out] itds_s        (&) ITDs for each HRIR, in seconds; N_hrir_dirs x 1
+ * @param[out] hrtf_fb       (&) diffuse-field equalised filterbank HRTFs;
+ *                           FLAT: N_bands x 2 x N_hrir_dirs
+ * @param[out] hrtf_fb_mag   (&) magnitudes of 'hrtf_fb';
+ *                           FLAT: N_bands x 2 x N_hrir_dirs
+ *
+ * @note Any of the output arguments may be NULL, if they are not needed.
+ */
+void hrtfCache_getData(/* Input Arguments */
+                       void * const hHRTFs,
+                       /* Output Arguments */
+                       float** hrirs,
+                       float** hrir_dirs_deg,
+                       int* N_hrir_dirs,
+                       int* hrir_len,
+                       int* hrir_fs,
+                       float** itds_s,
+                       float_complex** hrtf_fb,
+                       float** hrtf_fb_mag);
+
+/**
+ * Returns the (shared) HRTF magnitudes of a cached HRIR set, stored with one
+ * contiguous row per direction and in the requested storage format
+ *
+ * This layout places the magnitudes of all bands for one direction within a
+ * few cache lines, and the reduced-precision formats halve the memory
+ * footprint; which favours HRTF interpolation (where only the 3 HRTFs
+ * surrounding a direction are read). Each format is converted on its first
+ * request, and is then shared by all of the instances using the set.
+ *
+ * @warning As with hrtfCache_getData(), the returned array must not be modified
+ *          or freed, and remains valid until the handle is released.
+ *
+ * @param[in] hHRTFs    HRTF data handle
+ * @param[in] precision Storage format; see #SAF_STORAGE_PRECISION
+ * @returns   The magnitudes of 'hrtf_fb' (see hrtfCache_getData()), converted
+ *            using utility_svpack(); FLAT: N_hrir_dirs x N_bands x 2
+ */
+void* hrtfCache_getMagnitudes(/* Input Arguments */
+                              void * const hHRTFs,
+                              SAF_STORAGE_PRECISION precision);
+
+/**
+ * Enables (or disables) the on-disk HRTF cache
+ *
+ * When enabled, hrtfCache_acquire() first looks for a cache file in the given
+ * directory, before loading the SOFA file and computing the HRTF data; and
+ * writes one after computing it. The files are keyed by a hash of the SOFA file
+ * contents, the number of bands and the band centre frequencies, and contain a
+ * version number and checksum; stale or corrupted files are ignored and
+ * recomputed.
+ *
+ * @note The files are stored in native byte order, and are therefore not
+ *       intended to be shared between machines of differing endianness.
+ *
+ * @param[in] directory Existing directory in which to store the cache files;
+ *                      or NULL to disable the on-disk cache (default)
+ */
+void hrtfCache_setDiskCacheDirectory(/* Input Arguments */
+                                     char* directory);
+
+/** Maximum number of unused HRIR sets kept by hrtfCache_release() */
+#define HRTF_CACHE_MAX_UNUSED_ENTRIES ( 4 )
+
+/** Frees all HRIR sets that are held in the cache, but no longer used */
+void hrtfCache_clearUnused(void);
+
+/** Returns the number of HRIR sets currently held in the cache (including
+ *  those that are no longer used; see hrtfCache_release()) */
+int hrtfCache_getNumEntries(void);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
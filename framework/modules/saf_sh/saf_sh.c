@@ -32,6 +32,11 @@
 
 #include "saf_sh.h"
 #include "saf_sh_internal.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
 
 /**
  * First-order ACN/N3D to WXYZ conversion matrix
@@ -156,6 +161,117 @@ void unitCart2Sph_aziElev
     (*elev_rad) = atan2f(xyz[2], hypotxy);
 }
 
+/** Number of directions converted at a time by the batched conversions */
+#define SPH_CART_BLOCK_SIZE ( 64 )
+
+void unitSph2CartBatch
+(
+    float* azi_rad,
+    float* elev_rad,
+    int nDirs,
+    float* x,
+    float* y,
+    float* z
+)
+{
+    int i, j, blockSize;
+    float cosElev[SPH_CART_BLOCK_SIZE];
+
+    /* sin/cos of the azimuths straight into y/x, which are then scaled by the
+     * cos of the elevations */
+    utility_svsincosapprox(azi_rad, nDirs, y, x);
+    for(i=0; i<nDirs; i+=SPH_CART_BLOCK_SIZE){
+        blockSize = MIN(SPH_CART_BLOCK_SIZE, nDirs-i);
+        utility_svsincosapprox(&elev_rad[i], blockSize, &z[i], cosElev);
+        for(j=0; j<blockSize; j++){
+            x[i+j] *= cosElev[j];
+            y[i+j] *= cosElev[j];
+        }
+    }
+}
+
+void unitCart2SphBatch
+(
+    float* x,
+    float* y,
+    float* z,
+    int nDirs,
+    float* azi_rad,
+    float* elev_rad
+)
+{
+    int i, j, blockSize;
+    float hypotxy[SPH_CART_BLOCK_SIZE];
+
+    utility_svatan2approx(y, x, nDirs, azi_rad);
+    for(i=0; i<nDirs; i+=SPH_CART_BLOCK_SIZE){
+        blockSize = MIN(SPH_CART_BLOCK_SIZE, nDirs-i);
+        for(j=0; j<blockSize; j++)
+            hypotxy[j] = sqrtf(x[i+j]*x[i+j] + y[i+j]*y[i+j]);
+        utility_svatan2approx(&z[i], hypotxy, blockSize, &elev_rad[i]);
+    }
+}
+
+/** Table of the SH normalisation factors; [n*(n+1)/2 + m] */
+static double __SH_norm_table[(SH_NORM_TABLE_MAX_ORDER+1)*(SH_NORM_TABLE_MAX_ORDER+2)/2];
+#if defined(_WIN32)
+static INIT_ONCE __SH_norm_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t __SH_norm_once = PTHREAD_ONCE_INIT;
+#endif
+
+/** Computes the normalisation factors of degree n; (n+1) x 1 */
+static void getSHnorm_compute
+(
+    int n,
+    double* norm
+)
+{
+    int m;
+    double ratio; /* (n-m)!/(n+m)! */
+
+    ratio = 1.0;
+    norm[0] = sqrt((2.0*(double)n+1.0)/(4.0*M_PI));
+    for(m=1; m<=n; m++){
+        ratio /= (double)(n-m+1)*(double)(n+m);
+        norm[m] = sqrt((2.0*(double)n+1.0)/(4.0*M_PI) * ratio);
+    }
+}
+
+/** Fills the table of normalisation factors (called only once) */
+#if defined(_WIN32)
+static BOOL CALLBACK getSHnorm_initTable(PINIT_ONCE once, PVOID param, PVOID* ctx)
+#else
+static void getSHnorm_initTable(void)
+#endif
+{
+    int n;
+    for(n=0; n<=SH_NORM_TABLE_MAX_ORDER; n++)
+        getSHnorm_compute(n, &__SH_norm_table[n*(n+1)/2]);
+#if defined(_WIN32)
+    (void)once; (void)param; (void)ctx;
+    return TRUE;
+#endif
+}
+
+void getSHnorm
+(
+    int n,
+    double* norm
+)
+{
+    if(n>SH_NORM_TABLE_MAX_ORDER){
+        getSHnorm_compute(n, norm);
+        return;
+    }
+#if defined(_WIN32)
+    InitOnceExecuteOnce(&__SH_norm_once, getSHnorm_initTable, NULL, NULL);
+#else
+    pthread_once(&__SH_norm_once, getSHnorm_initTable);
+#endif
+    memcpy(norm, &__SH_norm_table[n*(n+1)/2], (n+1)*sizeof(double));
+}
+
 void unnorm_legendreP
 (
     int n,
@@ -243,48 +359,66 @@ void unnorm_legendreP_recur
 )
 {
     int i, m, k, kk;
-    float x2, one_min_x2, dfact_k;
-    
-    if(n==0){
-        for(i=0; i<lenX; i++)
-            Pnm[i] = 1.0f;
-        return;
-    }
+    float x2, dfact_k, pw, a, b, c;
+    float* Pm;
+    const float* Pm1, *Pm2;
     
-    for(i=0; i<lenX; i++){
-        x2 = (x[i])*(x[i]);
-        switch(n) {
-            case 1:
+    /* Each row of the (n+1) x lenX arrays is processed with a separate loop
+     * over x, so that these loops may be vectorised */
+    switch(n) {
+        case 0:
+            for(i=0; i<lenX; i++)
+                Pnm[i] = 1.0f;
+            break;
+        case 1:
+            for(i=0; i<lenX; i++){
                 Pnm[0*lenX+i] = x[i];
-                Pnm[1*lenX+i] = sqrtf(1.0f-x2);
-                break;
-            case 2:
+                Pnm[1*lenX+i] = sqrtf(1.0f-(x[i])*(x[i]));
+            }
+            break;
+        case 2:
+            for(i=0; i<lenX; i++){
+                x2 = (x[i])*(x[i]);
                 Pnm[0*lenX+i] = (3.0f*x2-1.0f)/2.0f;
                 Pnm[1*lenX+i] = (x[i])*3.0f*sqrtf(1.0f-x2);
                 Pnm[2*lenX+i] = 3.0f*(1.0f-x2);
-                break;
-            default:
-                one_min_x2 = 1.0f-x2;
-                /* last term m=n */
-                k = 2*n-1;
-                dfact_k = 1.0f;
-                if ((k % 2) == 0)
-                    for (kk=1; kk<k/2+1; kk++)
-                        dfact_k *= 2.0f*(float)kk;
-                else
-                    for (kk=1; kk<(k+1)/2+1; kk++)
-                        dfact_k *= (2.0f*(float)kk-1.0f);
-                
-                Pnm[n*lenX+i] = dfact_k * powf(one_min_x2, (float)n/2.0f);
-                /* before last term */
-                /* P_{n(n-1)} = (2*n-1)*x*P_{(n-1)(n-1)} */
-                Pnm[(n-1)*lenX+i] = (float)k * (x[i]) *Pnm_minus1[(n-1)*lenX+i];
-                /* three term recurence for the rest */
-                for (m=0; m<n-1; m++)
-                    /* P_l = ( (2l-1)xP_(l-1) - (l+m-1)P_(l-2) )/(l-m) */
-                    Pnm[m*lenX+i] = ( ((float)k * (x[i]) *Pnm_minus1[m*lenX+i]) - ((float)(n+m-1) * Pnm_minus2[m*lenX+i])) / (float)(n-m);
-                break;
-        }
+            }
+            break;
+        default:
+            /* last term m=n */
+            k = 2*n-1;
+            dfact_k = 1.0f;
+            if ((k % 2) == 0)
+                for (kk=1; kk<k/2+1; kk++)
+                    dfact_k *= 2.0f*(float)kk;
+            else
+                for (kk=1; kk<(k+1)/2+1; kk++)
+                    dfact_k *= (2.0f*(float)kk-1.0f);
+            pw = (float)n/2.0f;
+            Pm = &Pnm[n*lenX];
+            for(i=0; i<lenX; i++)
+                Pm[i] = dfact_k * powf(1.0f-(x[i])*(x[i]), pw);
+            
+            /* before last term */
+            /* P_{n(n-1)} = (2*n-1)*x*P_{(n-1)(n-1)} */
+            Pm = &Pnm[(n-1)*lenX];
+            Pm1 = &Pnm_minus1[(n-1)*lenX];
+            for(i=0; i<lenX; i++)
+                Pm[i] = (float)k * (x[i]) * Pm1[i];
+            
+            /* three term recurence for the rest */
+            for (m=0; m<n-1; m++){
+                /* P_l = ( (2l-1)xP_(l-1) - (l+m-1)P_(l-2) )/(l-m) */
+                a = (float)k;
+                b = (float)(n+m-1);
+                c = (float)(n-m);
+                Pm = &Pnm[m*lenX];
+                Pm1 = &Pnm_minus1[m*lenX];
+                Pm2 = &Pnm_minus2[m*lenX];
+                for(i=0; i<lenX; i++)
+                    Pm[i] = ((a * (x[i]) * Pm1[i]) - (b * Pm2[i])) / c;
+            }
+            break;
     }
 }
 
@@ -299,10 +433,11 @@ void getSHreal
     int dir, j, n, m, idx_Y;
     double* Lnm, *CosSin;
     double *p_nm, *cos_incl;
-    double *norm_real;
+    double *norm_real, *norm_n;
     
     Lnm = malloc1d((2*order+1)*nDirs*sizeof(double));
     norm_real = malloc1d((2*order+1)*sizeof(double));
+    norm_n = malloc1d((order+1)*sizeof(double));
     CosSin = malloc1d((2*order+1)*sizeof(double));
     cos_incl = malloc1d(nDirs*sizeof(double));
     p_nm = malloc1d((order+1)*nDirs * sizeof(double));
@@ -324,8 +459,9 @@ void getSHreal
         }
         
         /* normalisation */
+        getSHnorm(n, norm_n);
         for(m=-n, j=0; m<=n; m++, j++)
-            norm_real[j] = sqrt( (2.0*(double)n+1.0) * (double)factorial(n-abs(m)) / (4.0*M_PI*(double)factorial(n+abs(m))) );
+            norm_real[j] = norm_n[abs(m)];
         
         /* norm_real * Lnm_real .* CosSin; */
         for(dir=0; dir<nDirs; dir++){
@@ -346,6 +482,7 @@ void getSHreal
     free(p_nm);
     free(Lnm);
     free(norm_real);
+    free(norm_n);
     free(CosSin);
     free(cos_incl);
 }
@@ -358,20 +495,17 @@ void getSHreal_recur
     float* Y
 )
 {
-    int n, m, i, dir, index_n;
-    float Nn0, Nnm;
-    float* leg_n, *leg_n_1, *leg_n_2, *cos_incl, *factorials_n;
+    int n, m, dir, index_n;
+    float Nnm;
+    float* leg_n, *leg_n_1, *leg_n_2, *cos_incl;
+    double* norm_n;
     
-    factorials_n = malloc1d((2*N+1)*sizeof(float));
+    norm_n = malloc1d((N+1)*sizeof(double));
     leg_n = malloc1d((N+1)*nDirs * sizeof(float));
     leg_n_1 = calloc1d((N+1)*nDirs, sizeof(float));
     leg_n_2 = calloc1d((N+1)*nDirs, sizeof(float));
     cos_incl = malloc1d(nDirs * sizeof(float));
     index_n = 0;
-
-    /* precompute factorials */
-    for (i = 0; i < 2*N+1; i++)
-        factorials_n[i] = (float)factorial(i);
     
     /* cos(inclination) = sin(elevation) */
     for (dir = 0; dir<nDirs; dir++)
@@ -387,16 +521,15 @@ void getSHreal_recur
         else {
             unnorm_legendreP_recur(n, cos_incl, nDirs, leg_n_1, leg_n_2, leg_n); /* does NOT include Condon-Shortley phase term */
             
-            Nn0 = sqrtf(2.0f*(float)n+1.0f);
-            for (dir = 0; dir<nDirs; dir++){
-                for (m = 0; m<n+1; m++) {
-                    if (m==0)
-                        Y[(index_n+n)*nDirs+dir] = Nn0/sqrtf(4.0f*M_PI)  * leg_n[m*nDirs+dir];
-                    else {
-                        Nnm = Nn0* sqrtf( 2.0f * factorials_n[n-m]/factorials_n[n+m] );
-                        Y[(index_n+n-m)*nDirs+dir] = Nnm/sqrtf(4.0f*M_PI) * leg_n[m*nDirs+dir] * sinf((float)m * (dirs_rad[dir*2]));
-                        Y[(index_n+n+m)*nDirs+dir] = Nnm/sqrtf(4.0f*M_PI) * leg_n[m*nDirs+dir] * cosf((float)m * (dirs_rad[dir*2]));
-                    }
+            getSHnorm(n, norm_n);
+            Nnm = (float)norm_n[0];
+            for (dir = 0; dir<nDirs; dir++)
+                Y[(index_n+n)*nDirs+dir] = Nnm * leg_n[dir];
+            for (m = 1; m<n+1; m++) {
+                Nnm = (float)(sqrt(2.0)*norm_n[m]);
+                for (dir = 0; dir<nDirs; dir++){
+                    Y[(index_n+n-m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * sinf((float)m * (dirs_rad[dir*2]));
+                    Y[(index_n+n+m)*nDirs+dir] = Nnm * leg_n[m*nDirs+dir] * cosf((float)m * (dirs_rad[dir*2]));
                 }
             }
             index_n += 2*n+1;
@@ -405,13 +538,175 @@ void getSHreal_recur
         utility_svvcopy(leg_n,   (N+1)*nDirs, leg_n_1);  
     }
     
-    free(factorials_n);
+    free(norm_n);
     free(leg_n);
     free(leg_n_1);
     free(leg_n_2);
     free(cos_incl);
 }
 
+/** Number of directions processed at a time by the getSHreal_fast() kernels */
+#define SH_FAST_BLOCK_SIZE ( 64 )
+
+/**
+ * sqrt((2n+1)/(4pi) * (n-m)!/(n+m)!), multiplied by sqrt(2) for m>0; indexed
+ * [n][m]
+ */
+static const float __SH_fast_norm[SH_FAST_MAX_ORDER+1][SH_FAST_MAX_ORDER+1] = {
+    {2.820947918e-01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {4.886025119e-01f, 4.886025119e-01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {6.307831305e-01f, 3.641828102e-01f, 1.820914051e-01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {7.463526652e-01f, 3.046971996e-01f, 9.635371475e-02f, 3.933623933e-02f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {8.462843753e-01f, 2.676186174e-01f, 6.307831305e-02f, 1.685838828e-02f, 5.960340338e-03f, 0.0f, 0.0f, 0.0f},
+    {9.356025796e-01f, 2.415715473e-01f, 4.565273129e-02f, 9.318824751e-03f, 2.196468058e-03f, 6.945841871e-04f, 0.0f, 0.0f},
+    {1.017107236e+00f, 2.219509952e-01f, 3.509353370e-02f, 5.848922283e-03f, 1.067862224e-03f, 2.276689911e-04f, 6.572237664e-05f, 0.0f},
+    {1.092548431e+00f, 2.064722459e-01f, 2.809731381e-02f, 3.973560225e-03f, 5.990367431e-04f, 9.983945719e-05f, 1.958012848e-05f, 5.233009454e-06f}
+};
+
+/**
+ * Generic real SH kernel for one block of (len <= SH_FAST_BLOCK_SIZE)
+ * directions; 'order' is a compile-time constant in each of the specialised
+ * kernels below, so that the compiler may fully unroll the loops over n and m
+ *
+ * With sin(incl)^m factored out of the associated Legendre functions, i.e.
+ * P_n^m(z) = sin(incl)^m Q_n^m(z), the remaining terms sin(incl)^m cos(m azi)
+ * and sin(incl)^m sin(m azi) are the real and imaginary parts of (x+iy)^m.
+ * Both Q_n^m(z) and (x+iy)^m are computed with simple recursions over n and m.
+ */
+static inline void getSHreal_fastKernel
+(
+    const int order,
+    const float* x,
+    const float* y,
+    const float* z,
+    int len,
+    int stride, /* number of columns of Y */
+    float* Y
+)
+{
+    int i, n, m;
+    float C[SH_FAST_BLOCK_SIZE], S[SH_FAST_BLOCK_SIZE], tmp;
+    float Qmm[SH_FAST_BLOCK_SIZE], Q_nm1[SH_FAST_BLOCK_SIZE], Q_nm2[SH_FAST_BLOCK_SIZE], Q_n;
+    float a, b, norm;
+    
+    for(i=0; i<len; i++){
+        C[i] = 1.0f; /* real((x+iy)^0) */
+        S[i] = 0.0f; /* imag((x+iy)^0) */
+        Qmm[i] = 1.0f; /* Q_0^0 */
+    }
+    for(m=0; m<=order; m++){
+        if(m>0){
+            /* (x+iy)^m = (x+iy)^(m-1) (x+iy), and Q_m^m = (2m-1) Q_(m-1)^(m-1) */
+            for(i=0; i<len; i++){
+                tmp  = x[i]*C[i] - y[i]*S[i];
+                S[i] = x[i]*S[i] + y[i]*C[i];
+                C[i] = tmp;
+                Qmm[i] *= (float)(2*m-1);
+            }
+        }
+        
+        /* n = m */
+        norm = __SH_fast_norm[m][m];
+        for(i=0; i<len; i++){
+            Q_nm1[i] = Qmm[i];
+            Y[(m*m+m+m)*stride + i] = norm * Qmm[i] * C[i];
+        }
+        if(m>0)
+            for(i=0; i<len; i++)
+                Y[(m*m+m-m)*stride + i] = norm * Qmm[i] * S[i];
+        
+        /* n = m+1: Q_(m+1)^m = (2m+1) z Q_m^m */
+        if(m+1<=order){
+            n = m+1;
+            norm = __SH_fast_norm[n][m];
+            for(i=0; i<len; i++){
+                Q_nm2[i] = Q_nm1[i];
+                Q_nm1[i] = (float)(2*m+1) * z[i] * Q_nm1[i];
+                Y[(n*n+n+m)*stride + i] = norm * Q_nm1[i] * C[i];
+            }
+            if(m>0)
+                for(i=0; i<len; i++)
+                    Y[(n*n+n-m)*stride + i] = norm * Q_nm1[i] * S[i];
+        }
+        
+        /* n > m+1: Q_n^m = ((2n-1) z Q_(n-1)^m - (n+m-1) Q_(n-2)^m) / (n-m) */
+        for(n=m+2; n<=order; n++){
+            a = (float)(2*n-1)/(float)(n-m);
+            b = (float)(n+m-1)/(float)(n-m);
+            norm = __SH_fast_norm[n][m];
+            for(i=0; i<len; i++){
+                Q_n = a * z[i] * Q_nm1[i] - b * Q_nm2[i];
+                Q_nm2[i] = Q_nm1[i];
+                Q_nm1[i] = Q_n;
+                Y[(n*n+n+m)*stride + i] = norm * Q_n * C[i];
+            }
+            if(m>0)
+                for(i=0; i<len; i++)
+                    Y[(n*n+n-m)*stride + i] = norm * Q_nm1[i] * S[i];
+        }
+    }
+}
+
+/* order-specialised kernels */
+static void getSHreal_fastKernel0(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(0, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel1(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(1, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel2(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(2, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel3(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(3, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel4(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(4, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel5(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(5, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel6(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(6, x, y, z, len, stride, Y); }
+static void getSHreal_fastKernel7(const float* x, const float* y, const float* z, int len, int stride, float* Y) { getSHreal_fastKernel(7, x, y, z, len, stride, Y); }
+
+typedef void (*getSHreal_fastKernelFn)(const float*, const float*, const float*, int, int, float*);
+static const getSHreal_fastKernelFn __SH_fast_kernels[SH_FAST_MAX_ORDER+1] = {
+    getSHreal_fastKernel0, getSHreal_fastKernel1, getSHreal_fastKernel2, getSHreal_fastKernel3,
+    getSHreal_fastKernel4, getSHreal_fastKernel5, getSHreal_fastKernel6, getSHreal_fastKernel7
+};
+
+void getSHreal_fast
+(
+    int order,
+    float* dirs_rad,
+    int nDirs,
+    float* Y
+)
+{
+    int i, d0, len;
+    float x[SH_FAST_BLOCK_SIZE], y[SH_FAST_BLOCK_SIZE], z[SH_FAST_BLOCK_SIZE], sin_incl;
+    
+    if(order > SH_FAST_MAX_ORDER){
+        getSHreal_recur(order, dirs_rad, nDirs, Y);
+        return;
+    }
+    for(d0=0; d0<nDirs; d0+=SH_FAST_BLOCK_SIZE){
+        len = MIN(SH_FAST_BLOCK_SIZE, nDirs-d0);
+        for(i=0; i<len; i++){
+            sin_incl = sinf(dirs_rad[(d0+i)*2+1]);
+            x[i] = sin_incl * cosf(dirs_rad[(d0+i)*2]);
+            y[i] = sin_incl * sinf(dirs_rad[(d0+i)*2]);
+            z[i] = cosf(dirs_rad[(d0+i)*2+1]);
+        }
+        __SH_fast_kernels[order](x, y, z, len, nDirs, &Y[d0]);
+    }
+}
+
+void getSHreal_fastCart
+(
+    int order,
+    float* x,
+    float* y,
+    float* z,
+    int nDirs,
+    float* Y
+)
+{
+    int d0;
+    
+    assert(order <= SH_FAST_MAX_ORDER);
+    for(d0=0; d0<nDirs; d0+=SH_FAST_BLOCK_SIZE)
+        __SH_fast_kernels[order](&x[d0], &y[d0], &z[d0], MIN(SH_FAST_BLOCK_SIZE, nDirs-d0), nDirs, &Y[d0]);
+}
+
 void getSHcomplex
 (
     int order,
@@ -437,8 +732,7 @@ void getSHcomplex
         unnorm_legendreP(n, cos_incl, nDirs, Lnm); /* includes Condon-Shortley phase term */
         
         /* normalisation */
-        for(m=0; m<=n; m++)
-            norm_real[m] = sqrt( (2.0*(double)n+1.0)*(double)factorial(n-m) / (4.0*M_PI*(double)factorial(n+m)) );
+        getSHnorm(n, norm_real);
         
         /* norm_real .* Lnm_real .* CosSin; */
         for(dir=0; dir<nDirs; dir++){
@@ -535,25 +829,33 @@ void complex2realCoeffs
     float* R_N
 )
 {
-    int i, nSH;
-    float_complex* T_c2r, *R_N_c;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    
-    nSH = (order+1)*(order+1);
-    T_c2r = malloc1d(nSH*nSH*sizeof(float_complex));
-    R_N_c = malloc1d(nSH*K*sizeof(float_complex));
-    complex2realSHMtx(order, T_c2r);
-    for(i=0; i<nSH*nSH; i++)
-        T_c2r[i] = conjf(T_c2r[i]);
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, K, nSH, &calpha,
-                T_c2r, nSH,
-                C_N, K, &cbeta,
-                R_N_c, K);
-    for(i=0; i<nSH*K; i++)
-        R_N[i] = crealf(R_N_c[i]);
-    
-    free(T_c2r);
-    free(R_N_c);
+    int n, m, k, q, q_neg, q_pos;
+    float sgn;
+    const float inv_sqrt2 = 1.0f/sqrtf(2.0f);
+
+    /* Equivalent to R_N = real(conj(T_c2r) * C_N), with T_c2r as returned by
+     * complex2realSHMtx(); although, since each real coefficient of order m
+     * depends only on the complex coefficients of orders m and -m (of the same
+     * degree), the two non-zero elements per row are applied directly */
+    for(n=0, q=0; n<=order; n++){
+        for(m=-n; m<=n; m++, q++){
+            q_neg = n*n+n-abs(m);
+            q_pos = n*n+n+abs(m);
+            sgn = abs(m)%2 ? -1.0f : 1.0f;
+            if(m<0){
+                for(k=0; k<K; k++)
+                    R_N[q*K+k] = inv_sqrt2 * (cimagf(C_N[q_neg*K+k]) - sgn*cimagf(C_N[q_pos*K+k]));
+            }
+            else if(m==0){
+                for(k=0; k<K; k++)
+                    R_N[q*K+k] = crealf(C_N[q*K+k]);
+            }
+            else{
+                for(k=0; k<K; k++)
+                    R_N[q*K+k] = inv_sqrt2 * (sgn*crealf(C_N[q_pos*K+k]) + crealf(C_N[q_neg*K+k]));
+            }
+        }
+    }
 }
 
 /* Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real Spherical Harmonics. Direct Determination
@@ -634,398 +936,2080 @@ void getSHrotMtxReal
     free(R_l);
 }
 
-void computeVelCoeffsMtx
+/**
+ * Data structure for the SH rotation matrix generator.
+ *
+ * The rotation matrix of each band is kept flat, with a row stride equal to
+ * the number of components of that band (2l+1).
+ */
+typedef struct _shRotMtxReal_data {
+    int maxL;
+    float* uvw;   /**< u,v,w coefficients; FLAT: sum_{l=2}^{maxL} (2l+1)^2 x 3 */
+    float* R_lm1; /**< rotation matrix of the previous band; FLAT: (2maxL+1)^2 */
+    float* R_l;   /**< rotation matrix of the current band; FLAT: (2maxL+1)^2 */
+    
+}shRotMtxReal_data;
+
+/** Flat version of getP(), where the previous band has a row stride of 2l-1 */
+static float shRotMtxReal_getP
 (
-    int sectorOrder,
-    float_complex* A_xyz
+    int i,
+    int l,
+    int a,
+    int b,
+    const float R_1[3][3],
+    const float* R_lm1
 )
 {
-    int i, j, Nxyz, Ns, nC_xyz, nC_s;
-    float x1, x3, z2, y1, y3;
-    float* G_mtx;
+    int lm1_len;
+    float ri1, rim1, ri0;
     
-    Ns = sectorOrder;
-    Nxyz = Ns+1;
-    nC_xyz = (Nxyz+1)*(Nxyz+1);
-    nC_s = (Ns+1)*(Ns+1);
-    x1 = sqrtf(2.0f*M_PI/3.0f);
-    x3 = -x1;
-    y1 = y3 = sqrtf(2.0f*M_PI/3.0f);
-    z2 = sqrtf(4.0f*M_PI/3.0f); 
-    G_mtx = malloc1d(nC_s*4*nC_xyz*sizeof(float));
-    gaunt_mtx(Ns, 1, Nxyz, G_mtx);
+    lm1_len = 2*l-1;
+    ri1 = R_1[i + 1][1 + 1];
+    rim1 = R_1[i + 1][-1 + 1];
+    ri0 = R_1[i + 1][0 + 1];
     
-    for (i=0; i<nC_xyz; i++){
-        for (j=0; j<nC_s; j++){
-            A_xyz[i*nC_s*3 + j*3 + 0] = cmplxf(x1*G_mtx[j*4*nC_xyz + 1*nC_xyz + i] + x3*G_mtx[j*4*nC_xyz + 3*nC_xyz + i], 0.0f);
-            A_xyz[i*nC_s*3 + j*3 + 1] = cmplxf(0.0f, y1*G_mtx[j*4*nC_xyz + 1*nC_xyz + i] + y3*G_mtx[j*4*nC_xyz + 3*nC_xyz + i]);
-            A_xyz[i*nC_s*3 + j*3 + 2] = cmplxf(z2*G_mtx[j*4*nC_xyz + 2*nC_xyz + i], 0.0f);
-        }
-    }
-     
-    free(G_mtx);
+    if (b == -l)
+        return ri1 * R_lm1[(a + l - 1)*lm1_len] + rim1 * R_lm1[(a + l - 1)*lm1_len + 2 * l - 2];
+    else if (b == l)
+        return ri1 * R_lm1[(a + l - 1)*lm1_len + 2 * l - 2] - rim1 * R_lm1[(a + l - 1)*lm1_len];
+    else
+        return ri0 * R_lm1[(a + l - 1)*lm1_len + b + l - 1];
 }
 
-float computeSectorCoeffsEP
+void shRotMtxReal_create
 (
-    int orderSec,
-    float_complex* A_xyz, /* FLAT: (sectorOrder+2)^2 x (sectorOrder+1)^2 x 3 */
-    SECTOR_PATTERNS pattern,
-    float* sec_dirs_deg,
-    int nSecDirs,
-    float* sectorCoeffs /* FLAT: (nSecDirs*4) x (orderSec+2)^2 */
+    void ** const phRot,
+    int maxL
 )
 {
-    int i, j, ns, orderVel, nSH;
-    float normSec, azi_sec, elev_sec, Q;
-    float* b_n, *c_nm, *xyz_nm;
+    *phRot = malloc1d(sizeof(shRotMtxReal_data));
+    shRotMtxReal_data *h = (shRotMtxReal_data*)(*phRot);
+    int l, m, n, d, denom, nCoeffs;
+    float* uvw;
     
-    if(orderSec==0){
-        memcpy(sectorCoeffs, wxyzCoeffs, 16*sizeof(float)); /* ACN/N3D to WXYZ */
-        normSec = 1.0f;
-    }
-    else{
-        orderVel = orderSec+1;
-        nSH = (orderSec+2)*(orderSec+2);
-        b_n = malloc1d((orderSec+1)*sizeof(float));
-        c_nm = calloc1d((orderVel+1)*(orderVel+1), sizeof(float)); /* pad with zeros */
-        xyz_nm = malloc1d((orderVel+1)*(orderVel+1)*3*sizeof(float));
-        switch(pattern){
-            case SECTOR_PATTERN_PWD:
-                beamWeightsHypercardioid2Spherical(orderSec, b_n);
-                Q = (float)((orderSec+1) * (orderSec+1));
-                break;
-            case SECTOR_PATTERN_MAXRE:
-                beamWeightsMaxEV(orderSec, b_n);
-                cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, 1, 1, orderSec+1, 1.0f,
-                            b_n, 1,
-                            b_n, 1, 0.0f,
-                            &Q, 1);
-                Q = 4.0f*M_PI/(Q);
-                break;
-            case SECTOR_PATTERN_CARDIOID:
-                beamWeightsCardioid2Spherical(orderSec, b_n);
-                Q = 2.0f*(float)orderSec + 1.0f;
-                break;
-        }
-        normSec = Q/(float)nSecDirs; /* directivity factor / number of sectors */
-        
-        for(ns=0; ns<nSecDirs; ns++){
-            /* rotate the pattern by rotating the coefficients */
-            azi_sec = sec_dirs_deg[ns*2] * M_PI/180.0f;
-            elev_sec = sec_dirs_deg[ns*2+1] * M_PI/180.0f; /* from elevation to inclination */
-            rotateAxisCoeffsReal(orderSec, b_n, M_PI/2.0f-elev_sec, azi_sec, c_nm);
-            beamWeightsVelocityPatternsReal(orderSec, b_n, azi_sec, elev_sec, A_xyz, xyz_nm);
-     
-            /* store coefficients */
-            for(j=0; j<nSH; j++){
-                sectorCoeffs[ns*4*nSH + 0*nSH +j] = sqrtf(normSec) * c_nm[j];
-                for(i=0; i<3; i++)
-                    sectorCoeffs[ns*4*nSH + (i+1)*nSH +j] = sqrtf(normSec) * xyz_nm[j*3+i];
+    h->maxL = maxL;
+    nCoeffs = 0;
+    for(l=2; l<=maxL; l++)
+        nCoeffs += (2*l+1)*(2*l+1);
+    h->uvw = malloc1d(MAX(nCoeffs,1)*3*sizeof(float));
+    h->R_lm1 = malloc1d((2*maxL+1)*(2*maxL+1)*sizeof(float));
+    h->R_l = malloc1d((2*maxL+1)*(2*maxL+1)*sizeof(float));
+    
+    /* u,v,w terms of Eq.8.1 (Table I) */
+    uvw = h->uvw;
+    for(l=2; l<=maxL; l++){
+        for(m=-l; m<=l; m++){
+            for(n=-l; n<=l; n++){
+                d = m == 0 ? 1 : 0; /* the delta function d_m0 */
+                denom = abs(n) == l ? (2*l)*(2*l-1) : (l*l-n*n);
+                uvw[0] = sqrtf( (float)((l*l-m*m)) /  (float)denom);
+                uvw[1] = sqrtf( (float)((1+d)*(l+abs(m)-1)*(l+abs(m))) /  (float)denom) * (float)(1-2*d)*0.5f;
+                uvw[2] = sqrtf( (float)((l-abs(m)-1)*(l-abs(m))) / (float)denom) * (float)(1-d)*(-0.5f);
+                uvw += 3;
             }
         }
-        
-        free(b_n);
-        free(c_nm);
-        free(xyz_nm);
     }
-    return normSec;
 }
 
-float computeSectorCoeffsAP
+void shRotMtxReal_destroy
 (
-    int orderSec,
-    float_complex* A_xyz,
-    SECTOR_PATTERNS pattern,
-    float* sec_dirs_deg,
-    int nSecDirs,
-    float* sectorCoeffs
+    void ** const phRot
 )
 {
-    int i, j, ns, orderVel, nSH;
-    float normSec, azi_sec, elev_sec;
-    float* b_n, *c_nm, *xyz_nm;
+    shRotMtxReal_data *h = (shRotMtxReal_data*)(*phRot);
     
-    if(orderSec==0){
-        memcpy(sectorCoeffs, wxyzCoeffs, 16*sizeof(float)); /* ACN/N3D to WXYZ */
-        normSec = 1.0f;
+    if(h!=NULL){
+        free(h->uvw);
+        free(h->R_lm1);
+        free(h->R_l);
+        free(h);
+        *phRot = NULL;
     }
-    else{
-        orderVel = orderSec+1;
-        nSH = (orderSec+2)*(orderSec+2);
-        b_n = malloc1d((orderSec+1)*sizeof(float));
-        c_nm = calloc1d((orderVel+1)*(orderVel+1), sizeof(float)); /* pad with zeros */
-        xyz_nm = malloc1d((orderVel+1)*(orderVel+1)*3*sizeof(float));
-        switch(pattern){
-            case SECTOR_PATTERN_PWD: beamWeightsHypercardioid2Spherical(orderSec, b_n); break;
-            case SECTOR_PATTERN_MAXRE: beamWeightsMaxEV(orderSec, b_n); break;
-            case SECTOR_PATTERN_CARDIOID: beamWeightsCardioid2Spherical(orderSec, b_n); break;
-        }
-        normSec = (float)(orderSec+1)/(float)nSecDirs;
-        
-        for(ns=0; ns<nSecDirs; ns++){
-            /* rotate the pattern by rotating the coefficients */
-            azi_sec = sec_dirs_deg[ns*2] * M_PI/180.0f;
-            elev_sec = sec_dirs_deg[ns*2+1] * M_PI/180.0f;
-            rotateAxisCoeffsReal(orderSec, b_n, M_PI/2.0f-elev_sec, azi_sec, c_nm);
-            beamWeightsVelocityPatternsReal(orderSec, b_n, azi_sec, elev_sec, A_xyz, xyz_nm);
-            
-            /* store coefficients */
-            for(j=0; j<nSH; j++){
-                sectorCoeffs[ns*4*nSH + 0*nSH +j] = normSec * c_nm[j];
-                for(i=0; i<3; i++)
-                    sectorCoeffs[ns*4*nSH + (i+1)*nSH +j] = normSec * xyz_nm[j*3+i];
+}
+
+void shRotMtxReal_compute
+(
+    void * const hRot,
+    float Rxyz[3][3],
+    int L,
+    float* RotMtx /* (L+1)^2 x (L+1)^2 */
+)
+{
+    shRotMtxReal_data *h = (shRotMtxReal_data*)(hRot);
+    int i, j, M, l, m, n, d, bandIdx, len;
+    float u, v, w, p0, p1;
+    float R_1[3][3];
+    float* R_lm1, *R_l, *tmp;
+    const float* uvw;
+    
+    assert(L<=h->maxL);
+    M = (L+1) * (L+1);
+    R_lm1 = h->R_lm1;
+    R_l = h->R_l;
+    memset(RotMtx, 0, M*M*sizeof(float));
+    
+    /* zeroth-band (l=0) is invariant to rotation */
+    RotMtx[0] = 1;
+    if(L<1)
+        return;
+    
+    /* the first band (l=1) is directly related to the rotation matrix */
+    R_1[-1+1][-1+1] = Rxyz[1][1];
+    R_1[-1+1][0+1] = Rxyz[1][2];
+    R_1[-1+1][1+1] = Rxyz[1][0];
+    R_1[ 0+1][-1+1] = Rxyz[2][1];
+    R_1[ 0+1][0+1] = Rxyz[2][2];
+    R_1[ 0+1][1+1] = Rxyz[2][0];
+    R_1[ 1+1][-1+1] = Rxyz[0][1];
+    R_1[ 1+1][0+1] = Rxyz[0][2];
+    R_1[ 1+1][1+1] = Rxyz[0][0];
+    for (i=1; i<4; i++){
+        memcpy(&R_lm1[(i-1)*3], R_1[i-1], 3*sizeof(float));
+        for (j=1; j<4; j++)
+            RotMtx[i*M+j] = R_1[i-1][j-1];
+    }
+    
+    /* compute rotation matrix of each subsequent band recursively */
+    bandIdx = 4;
+    uvw = h->uvw;
+    for(l = 2; l<=L; l++){
+        len = 2*l+1;
+        for(m=-l; m<=l; m++){
+            for(n=-l; n<=l; n++){
+                u = uvw[0];
+                v = uvw[1];
+                w = uvw[2];
+                uvw += 3;
+                
+                /* computes Eq.8.1 (see getU(), getV() and getW()) */
+                if (u!=0)
+                    u = u * shRotMtxReal_getP(0, l, m, n, R_1, R_lm1);
+                if (v!=0){
+                    if (m == 0) {
+                        p0 = shRotMtxReal_getP(1, l, 1, n, R_1, R_lm1);
+                        p1 = shRotMtxReal_getP(-1, l, -1, n, R_1, R_lm1);
+                        v = v * (p0 + p1);
+                    }
+                    else if (m>0) {
+                        d = m == 1 ? 1 : 0;
+                        p0 = shRotMtxReal_getP(1, l, m - 1, n, R_1, R_lm1);
+                        p1 = shRotMtxReal_getP(-1, l, -m + 1, n, R_1, R_lm1);
+                        v = v * (p0*sqrtf(1.0f + d) - p1*(1.0f - d));
+                    }
+                    else {
+                        d = m == -1 ? 1 : 0;
+                        p0 = shRotMtxReal_getP(1, l, m + 1, n, R_1, R_lm1);
+                        p1 = shRotMtxReal_getP(-1, l, -m - 1, n, R_1, R_lm1);
+                        v = v * (p0*(1.0f - (float)d) + p1*sqrtf(1.0f + (float)d));
+                    }
+                }
+                if (w!=0){
+                    if (m>0) {
+                        p0 = shRotMtxReal_getP(1, l, m + 1, n, R_1, R_lm1);
+                        p1 = shRotMtxReal_getP(-1, l, -m - 1, n, R_1, R_lm1);
+                        w = w * (p0 + p1);
+                    }
+                    else {
+                        p0 = shRotMtxReal_getP(1, l, m - 1, n, R_1, R_lm1);
+                        p1 = shRotMtxReal_getP(-1, l, -m + 1, n, R_1, R_lm1);
+                        w = w * (p0 - p1);
+                    }
+                }
+                
+                R_l[(m+l)*len + n+l] = u+v+w;
             }
         }
         
-        free(b_n);
-        free(c_nm);
-        free(xyz_nm);
+        for(i=0; i<len; i++)
+            memcpy(&RotMtx[(bandIdx + i)*M + bandIdx], &R_l[i*len], len*sizeof(float));
+        
+        /* this band is the previous band of the next iteration */
+        tmp = R_lm1;
+        R_lm1 = R_l;
+        R_l = tmp;
+        bandIdx += len;
     }
-    return normSec;
 }
 
-void beamWeightsCardioid2Spherical
+void shRotMtxReal_computeBatch
 (
-    int N,
-    float* b_n
+    void * const hRot,
+    float* Rxyz,  /* nRot x 3 x 3 */
+    int nRot,
+    int L,
+    float* RotMtx /* nRot x (L+1)^2 x (L+1)^2 */
 )
 {
-    int n;
+    int i, M;
     
-    /* The coefficients can be derived by the binomial expansion of the cardioid function */
-    for(n=0; n<N+1; n++) {
-        b_n[n] = sqrtf(4.0f*M_PI*(2.0f*(float)n+1.0f)) *
-                 (float)factorial(N)* (float)factorial(N+1)/
-                 ((float)factorial(N+n+1)*(float)factorial(N-n))/
-                 ((float)N+1.0f);
-    }
+    M = (L+1) * (L+1);
+    for(i=0; i<nRot; i++)
+        shRotMtxReal_compute(hRot, (float(*)[3])&(Rxyz[i*9]), L, &(RotMtx[i*M*M]));
 }
 
-void beamWeightsHypercardioid2Spherical
+/** Data structure for the effective order detector */
+typedef struct _shOrderDetector_data {
+    int maxOrder;
+    int holdLength;
+    int* inactiveLength; /**< samples each order has been inactive for (capped at holdLength); (maxOrder+1) x 1 */
+    float* energy;       /**< energy of each order in the current block; (maxOrder+1) x 1 */
+    
+}shOrderDetector_data;
+
+void shOrderDetector_create
 (
-    int N,
-    float* b_n
+    void ** const phDet,
+    int maxOrder,
+    int holdLength
 )
 {
-    int n;
-    float* c_n;
-    float dirs_rad[2] = {0.0f, 0.0f};
-    
-    c_n = malloc1d((N+1)*(N+1)*sizeof(float));
-    getSHreal(N, dirs_rad, 1, c_n);
-    for(n=0; n<N+1; n++)
-        b_n[n] = c_n[(n+1)*(n+1)-n-1] * 4.0f * M_PI/(powf((float)N+1.0f, 2.0f));
+    *phDet = malloc1d(sizeof(shOrderDetector_data));
+    shOrderDetector_data *h = (shOrderDetector_data*)(*phDet);
     
-    free(c_n);
+    h->maxOrder = maxOrder;
+    h->inactiveLength = malloc1d((maxOrder+1)*sizeof(int));
+    h->energy = malloc1d((maxOrder+1)*sizeof(float));
+    shOrderDetector_reset(*phDet, holdLength);
 }
 
-void beamWeightsMaxEV
+void shOrderDetector_destroy
 (
-    int N,
-    float* b_n
+    void ** const phDet
 )
 {
-    int n;
-    float norm;
-    double temp_i;
-    double* temp_o;
+    shOrderDetector_data *h = (shOrderDetector_data*)(*phDet);
     
-    temp_o = malloc1d( (N+1)*sizeof(double));
-    norm = 0.0f;
-    for (n=0; n<=N; n++) {
-        temp_i = cos(2.4068f/((double)N+1.51));
-        unnorm_legendreP(n, &temp_i, 1, temp_o);
-        b_n[n] = sqrtf((2.0f*(float)n+1.0f)/(4.0f*M_PI))*(float)temp_o[0];
-        norm +=  sqrtf((2.0f*(float)n+1.0f)/(4.0f*M_PI))*b_n[n];
+    if(h!=NULL){
+        free(h->inactiveLength);
+        free(h->energy);
+        free(h);
+        *phDet = NULL;
     }
+}
+
+void shOrderDetector_reset
+(
+    void * const hDet,
+    int holdLength
+)
+{
+    shOrderDetector_data *h = (shOrderDetector_data*)(hDet);
     
-    /* normalise to unity response on look-direction */
-    for (n=0; n<=N; n++)
-        b_n[n] /= norm;
-    
-    free(temp_o);
+    h->holdLength = MAX(holdLength, 0);
+    memset(h->inactiveLength, 0, (h->maxOrder+1)*sizeof(int));
 }
 
-void beamWeightsVelocityPatternsReal
+int shOrderDetector_apply
 (
+    void * const hDet,
+    float** inSH,
     int order,
-    float* b_n,
-    float azi_rad,
-    float elev_rad,
-    float_complex* A_xyz,
-    float* velCoeffs
+    int len
 )
 {
-    int nSH;
-    float_complex* velCoeffs_c;
+    shOrderDetector_data *h = (shOrderDetector_data*)(hDet);
+    int n, ch, effOrder;
+    float totalEnergy;
     
-    nSH = (order+2)*(order+2);
-    velCoeffs_c = malloc1d(nSH*3*sizeof(float_complex));
-    beamWeightsVelocityPatternsComplex(order, b_n, azi_rad, elev_rad, A_xyz, velCoeffs_c);
-    complex2realCoeffs(order+1, velCoeffs_c, 3, velCoeffs);
-      
-    free(velCoeffs_c);
+    order = MIN(order, h->maxOrder);
+    
+    /* energy per order */
+    totalEnergy = 0.0f;
+    for(n=0; n<=order; n++){
+        h->energy[n] = 0.0f;
+        for(ch=n*n; ch<(n+1)*(n+1); ch++)
+            h->energy[n] += cblas_sdot(len, inSH[ch], 1, inSH[ch], 1);
+        totalEnergy += h->energy[n];
+    }
+    
+    /* active orders reset their hold, inactive ones count towards it */
+    effOrder = 0;
+    for(n=1; n<=order; n++){
+        if(h->energy[n] > SH_ORDER_DETECTOR_THRESHOLD*totalEnergy)
+            h->inactiveLength[n] = 0;
+        else
+            h->inactiveLength[n] = MIN(h->inactiveLength[n]+len, h->holdLength);
+        if(h->inactiveLength[n] < h->holdLength)
+            effOrder = n;
+    }
+    
+    return effOrder;
 }
 
-void beamWeightsVelocityPatternsComplex
+/** Data structure for the SH bus mixer */
+typedef struct _shBusMixer_data {
+    int nInputs;
+    int outOrder;
+    int maxBlockSize;
+    int* order;      /**< order of each input (-1: disabled); nInputs x 1 */
+    float* gain;     /**< gain of each input; nInputs x 1 */
+    int* rotated;    /**< '1' if the input is rotated; nInputs x 1 */
+    float* Rzyx;     /**< zyx rotation matrix of each input; FLAT: nInputs x 3 x 3 */
+    float* RotMtx;   /**< SH rotation matrix of each input, up to order min(order, outOrder); FLAT: nInputs x (outOrder+1)^2 x (outOrder+1)^2 */
+    float* inBlock;  /**< input order block; FLAT: (2outOrder+1) x maxBlockSize */
+    float* outBlock; /**< rotated order block; FLAT: (2outOrder+1) x maxBlockSize */
+    void* hRot;      /**< SH rotation matrix generator */
+    
+}shBusMixer_data;
+
+/** Computes the SH rotation matrix of an input, for its current order */
+static void shBusMixer_computeRotMtx
 (
-    int order,
-    float* b_n,
-    float azi_rad,
-    float elev_rad,
-    float_complex* A_xyz,
-    float_complex* velCoeffs
+    shBusMixer_data* h,
+    int input
 )
 {
-    int i, j, d3, nSH_l, nSH;
-    float_complex* c_nm, *A_1, *velCoeffs_T;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    int nSH_out;
     
-    nSH_l = (order+1)*(order+1);
-    nSH = (order+2)*(order+2);
-    c_nm = malloc1d(nSH_l*sizeof(float_complex));
-    A_1 = malloc1d(nSH*nSH_l*sizeof(float_complex));
-    velCoeffs_T = malloc1d(3*nSH*sizeof(float_complex));
-    rotateAxisCoeffsComplex(order, b_n, M_PI/2.0f-elev_rad, azi_rad, c_nm);
+    nSH_out = (h->outOrder+1)*(h->outOrder+1);
+    if(h->order[input]>=0)
+        shRotMtxReal_compute(h->hRot, (float(*)[3])&(h->Rzyx[input*9]), MIN(h->order[input], h->outOrder),
+                             &(h->RotMtx[input*nSH_out*nSH_out]));
+}
+
+void shBusMixer_create
+(
+    void ** const phMix,
+    int nInputs,
+    int outOrder,
+    int maxBlockSize
+)
+{
+    *phMix = malloc1d(sizeof(shBusMixer_data));
+    shBusMixer_data *h = (shBusMixer_data*)(*phMix);
+    int i, nSH_out;
     
-    /* x_nm, y_nm, z_nm */
-    for(d3 = 0; d3<3; d3++){
-        for(i=0; i<nSH; i++)
-            for(j=0; j<nSH_l; j++)
-                A_1[i*nSH_l+j] = A_xyz[i*nSH_l*3 + j*3 + d3];
-        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, 1, nSH_l, &calpha,
-                    A_1, nSH_l,
-                    c_nm, 1, &cbeta,
-                    &velCoeffs_T[d3*nSH], 1);
+    h->nInputs = nInputs;
+    h->outOrder = outOrder;
+    h->maxBlockSize = maxBlockSize;
+    nSH_out = (outOrder+1)*(outOrder+1);
+    h->order = malloc1d(nInputs*sizeof(int));
+    h->gain = malloc1d(nInputs*sizeof(float));
+    h->rotated = calloc1d(nInputs, sizeof(int));
+    h->Rzyx = calloc1d(nInputs*9, sizeof(float));
+    h->RotMtx = calloc1d(nInputs*nSH_out*nSH_out, sizeof(float));
+    h->inBlock = malloc1d((2*outOrder+1)*maxBlockSize*sizeof(float));
+    h->outBlock = malloc1d((2*outOrder+1)*maxBlockSize*sizeof(float));
+    shRotMtxReal_create(&(h->hRot), outOrder);
+    for(i=0; i<nInputs; i++){
+        h->order[i] = -1;
+        h->gain[i] = 1.0f;
     }
-    for(d3 = 0; d3<3; d3++)
-        for(i=0; i<nSH; i++)
-            velCoeffs[i*3+d3] = velCoeffs_T[d3*nSH+i]; /* transpose */
+}
 
-    free(c_nm);
-    free(A_1);
-    free(velCoeffs_T);
+void shBusMixer_destroy
+(
+    void ** const phMix
+)
+{
+    shBusMixer_data *h = (shBusMixer_data*)(*phMix);
+    
+    if(h!=NULL){
+        free(h->order);
+        free(h->gain);
+        free(h->rotated);
+        free(h->Rzyx);
+        free(h->RotMtx);
+        free(h->inBlock);
+        free(h->outBlock);
+        shRotMtxReal_destroy(&(h->hRot));
+        free(h);
+        *phMix = NULL;
+    }
 }
 
-void rotateAxisCoeffsReal
+void shBusMixer_setInput
 (
+    void * const hMix,
+    int input,
     int order,
-    float* c_n,
-    float theta_0, /* inclination*/
-    float phi_0,  /* azimuth */
-    float* c_nm
+    float gain
 )
 {
-    int nSH;
-    float_complex* c_nm_c;
+    shBusMixer_data *h = (shBusMixer_data*)(hMix);
+    int prevOrder;
+    
+    assert(input>=0 && input<h->nInputs);
+    prevOrder = h->order[input];
+    h->order[input] = MAX(order, -1);
+    h->gain[input] = gain;
+    
+    /* the rotation matrix only spans the orders of the input */
+    if(h->rotated[input] && MIN(h->order[input], h->outOrder) != MIN(prevOrder, h->outOrder))
+        shBusMixer_computeRotMtx(h, input);
+}
 
-    nSH = (order+1)*(order+1);
-    c_nm_c = malloc1d(nSH*sizeof(float_complex));
-    rotateAxisCoeffsComplex(order, c_n, theta_0, phi_0, c_nm_c);
-    complex2realCoeffs(order, c_nm_c, 1, c_nm);
+void shBusMixer_setInputRotation
+(
+    void * const hMix,
+    int input,
+    float R[3][3]
+)
+{
+    shBusMixer_data *h = (shBusMixer_data*)(hMix);
+    int i;
     
-    free(c_nm_c);
+    assert(input>=0 && input<h->nInputs);
+    if(R==NULL){
+        h->rotated[input] = 0;
+        return;
+    }
+    for(i=0; i<3; i++)
+        memcpy(&(h->Rzyx[input*9 + i*3]), R[i], 3*sizeof(float));
+    h->rotated[input] = 1;
+    shBusMixer_computeRotMtx(h, input);
 }
 
-void rotateAxisCoeffsComplex
+void shBusMixer_apply
 (
-    int order,
-    float* c_n,
-    float theta_0,  /* inclination*/
-    float phi_0,    /* azimuth */
-    float_complex* c_nm
+    void * const hMix,
+    float*** inSH,
+    int len,
+    float** outSH
 )
 {
-    int n, m, q, nSH;
-    float phi_theta[2];
-    float_complex* Y_N;
+    shBusMixer_data *h = (shBusMixer_data*)(hMix);
+    int i, ch, l, L, nSH, nSH_out, bandIdx, bandLen;
+    float gain;
+    float* RotMtx;
     
-    phi_theta[0] = phi_0;
-    phi_theta[1] = theta_0;
-    nSH = (order+1)*(order+1);
-    Y_N = malloc1d(nSH*sizeof(float_complex));
-    getSHcomplex(order, (float*)phi_theta, 1, Y_N);
-    for(n=0, q = 0; n<=order; n++)
-        for(m=-n; m<=n; m++, q++)
-            c_nm[q] = crmulf(conjf(Y_N[q]), sqrtf(4.0f*M_PI/(2.0f*(float)n+1.0f)) * c_n[n]);
+    assert(len<=h->maxBlockSize);
+    nSH_out = (h->outOrder+1)*(h->outOrder+1);
+    for(ch=0; ch<nSH_out; ch++)
+        memset(outSH[ch], 0, len*sizeof(float));
     
-    free(Y_N);
+    for(i=0; i<h->nInputs; i++){
+        gain = h->gain[i];
+        if(inSH[i]==NULL || h->order[i]<0 || gain==0.0f)
+            continue;
+        
+        /* only the orders of the input which reach the output */
+        L = MIN(h->order[i], h->outOrder);
+        nSH = (L+1)*(L+1);
+        if(!h->rotated[i]){
+            for(ch=0; ch<nSH; ch++)
+                cblas_saxpy(len, gain, inSH[i][ch], 1, outSH[ch], 1);
+            continue;
+        }
+        
+        /* zeroth-band is invariant to rotation, the others are rotated per block */
+        cblas_saxpy(len, gain, inSH[i][0], 1, outSH[0], 1);
+        RotMtx = &(h->RotMtx[i*nSH_out*nSH_out]);
+        for(l=1; l<=L; l++){
+            bandIdx = l*l;
+            bandLen = 2*l+1;
+            for(ch=0; ch<bandLen; ch++)
+                memcpy(&(h->inBlock[ch*len]), inSH[i][bandIdx+ch], len*sizeof(float));
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, bandLen, len, bandLen, gain,
+                        &RotMtx[bandIdx*nSH+bandIdx], nSH,
+                        h->inBlock, len, 0.0f,
+                        h->outBlock, len);
+            for(ch=0; ch<bandLen; ch++)
+                cblas_saxpy(len, 1.0f, &(h->outBlock[ch*len]), 1, outSH[bandIdx+ch], 1);
+        }
+    }
 }
 
-void checkCondNumberSHTReal
+void computeVelCoeffsMtx
 (
-    int order,
-    float* dirs_rad,
-    int nDirs,
-    float* w,
-    float* cond_N
+    int sectorOrder,
+    float_complex* A_xyz
+)
+{
+    int i, j, Nxyz, Ns, nC_xyz, nC_s;
+    float x1, x3, z2, y1, y3;
+    float* G_mtx;
+    
+    Ns = sectorOrder;
+    Nxyz = Ns+1;
+    nC_xyz = (Nxyz+1)*(Nxyz+1);
+    nC_s = (Ns+1)*(Ns+1);
+    x1 = sqrtf(2.0f*M_PI/3.0f);
+    x3 = -x1;
+    y1 = y3 = sqrtf(2.0f*M_PI/3.0f);
+    z2 = sqrtf(4.0f*M_PI/3.0f); 
+    G_mtx = malloc1d(nC_s*4*nC_xyz*sizeof(float));
+    gaunt_mtx(Ns, 1, Nxyz, G_mtx);
+    
+    for (i=0; i<nC_xyz; i++){
+        for (j=0; j<nC_s; j++){
+            A_xyz[i*nC_s*3 + j*3 + 0] = cmplxf(x1*G_mtx[j*4*nC_xyz + 1*nC_xyz + i] + x3*G_mtx[j*4*nC_xyz + 3*nC_xyz + i], 0.0f);
+            A_xyz[i*nC_s*3 + j*3 + 1] = cmplxf(0.0f, y1*G_mtx[j*4*nC_xyz + 1*nC_xyz + i] + y3*G_mtx[j*4*nC_xyz + 3*nC_xyz + i]);
+            A_xyz[i*nC_s*3 + j*3 + 2] = cmplxf(z2*G_mtx[j*4*nC_xyz + 2*nC_xyz + i], 0.0f);
+        }
+    }
+     
+    free(G_mtx);
+}
+
+/** Data structure for the sparse velocity coefficients matrices */
+typedef struct _velCoeffsMtx_data {
+    int sectorOrder;
+    int nnz;                   /**< number of nonzero coefficients */
+    int* rowPtr;               /**< start of each row, (i*3+d) for velocity coefficient i along axis d; ((sectorOrder+2)^2*3+1) x 1 */
+    int* colIdx;               /**< index of the pattern coefficient; nnz x 1 */
+    float_complex* val;        /**< velocity coefficients; nnz x 1 */
+
+}velCoeffsMtx_data;
+
+void velCoeffsMtx_create
+(
+    void** const phVel,
+    int sectorOrder
+)
+{
+    velCoeffsMtx_data* h;
+    int i, j, d, nC_xyz, nC_s;
+    float_complex* A_xyz;
+
+    h = malloc1d(sizeof(velCoeffsMtx_data));
+    *phVel = (void*)h;
+    h->sectorOrder = sectorOrder;
+    nC_xyz = (sectorOrder+2)*(sectorOrder+2);
+    nC_s = (sectorOrder+1)*(sectorOrder+1);
+    A_xyz = malloc1d(nC_xyz*nC_s*3*sizeof(float_complex));
+    computeVelCoeffsMtx(sectorOrder, A_xyz);
+
+    /* retain only the nonzero entries; the Gaunt coefficients of the product
+     * with a dipole couple each degree n only to degrees n-1 and n+1, so there
+     * are at most a few entries per row */
+    h->nnz = 0;
+    for(i=0; i<nC_xyz*nC_s*3; i++)
+        if(crealf(A_xyz[i])!=0.0f || cimagf(A_xyz[i])!=0.0f)
+            h->nnz++;
+    h->rowPtr = malloc1d((nC_xyz*3+1)*sizeof(int));
+    h->colIdx = malloc1d(MAX(h->nnz,1)*sizeof(int));
+    h->val = malloc1d(MAX(h->nnz,1)*sizeof(float_complex));
+    h->nnz = 0;
+    for(i=0; i<nC_xyz; i++){
+        for(d=0; d<3; d++){
+            h->rowPtr[i*3+d] = h->nnz;
+            for(j=0; j<nC_s; j++){
+                if(crealf(A_xyz[i*nC_s*3 + j*3 + d])!=0.0f || cimagf(A_xyz[i*nC_s*3 + j*3 + d])!=0.0f){
+                    h->colIdx[h->nnz] = j;
+                    h->val[h->nnz] = A_xyz[i*nC_s*3 + j*3 + d];
+                    h->nnz++;
+                }
+            }
+        }
+    }
+    h->rowPtr[nC_xyz*3] = h->nnz;
+
+    free(A_xyz);
+}
+
+void velCoeffsMtx_destroy
+(
+    void** const phVel
+)
+{
+    velCoeffsMtx_data *h = (velCoeffsMtx_data*)(*phVel);
+
+    if (h != NULL) {
+        free(h->rowPtr);
+        free(h->colIdx);
+        free(h->val);
+        free(h);
+        h = NULL;
+        *phVel = NULL;
+    }
+}
+
+int velCoeffsMtx_getNumNonZeros
+(
+    void* const hVel
+)
+{
+    velCoeffsMtx_data *h = (velCoeffsMtx_data*)(hVel);
+    return h->nnz;
+}
+
+void velCoeffsMtx_apply
+(
+    void* const hVel,
+    float_complex* c_nm,
+    int K,
+    float_complex* velCoeffs
+)
+{
+    velCoeffsMtx_data *h = (velCoeffsMtx_data*)(hVel);
+    int r, e, k, nRows;
+    float_complex* out;
+
+    nRows = (h->sectorOrder+2)*(h->sectorOrder+2)*3;
+    for(r=0; r<nRows; r++){
+        out = &velCoeffs[r*K];
+        for(k=0; k<K; k++)
+            out[k] = cmplxf(0.0f, 0.0f);
+        for(e=h->rowPtr[r]; e<h->rowPtr[r+1]; e++)
+            for(k=0; k<K; k++)
+                out[k] = ccaddf(out[k], ccmulf(h->val[e], c_nm[h->colIdx[e]*K+k]));
+    }
+}
+
+float computeSectorCoeffsEP
+(
+    int orderSec,
+    float_complex* A_xyz, /* FLAT: (sectorOrder+2)^2 x (sectorOrder+1)^2 x 3 */
+    SECTOR_PATTERNS pattern,
+    float* sec_dirs_deg,
+    int nSecDirs,
+    float* sectorCoeffs /* FLAT: (nSecDirs*4) x (orderSec+2)^2 */
+)
+{
+    int i, j, ns, orderVel, nSH;
+    float normSec, azi_sec, elev_sec, Q;
+    float* b_n, *c_nm, *xyz_nm;
+    
+    if(orderSec==0){
+        memcpy(sectorCoeffs, wxyzCoeffs, 16*sizeof(float)); /* ACN/N3D to WXYZ */
+        normSec = 1.0f;
+    }
+    else{
+        orderVel = orderSec+1;
+        nSH = (orderSec+2)*(orderSec+2);
+        b_n = malloc1d((orderSec+1)*sizeof(float));
+        c_nm = calloc1d((orderVel+1)*(orderVel+1), sizeof(float)); /* pad with zeros */
+        xyz_nm = malloc1d((orderVel+1)*(orderVel+1)*3*sizeof(float));
+        switch(pattern){
+            case SECTOR_PATTERN_PWD:
+                beamWeightsHypercardioid2Spherical(orderSec, b_n);
+                Q = (float)((orderSec+1) * (orderSec+1));
+                break;
+            case SECTOR_PATTERN_MAXRE:
+                beamWeightsMaxEV(orderSec, b_n);
+                cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, 1, 1, orderSec+1, 1.0f,
+                            b_n, 1,
+                            b_n, 1, 0.0f,
+                            &Q, 1);
+                Q = 4.0f*M_PI/(Q);
+                break;
+            case SECTOR_PATTERN_CARDIOID:
+                beamWeightsCardioid2Spherical(orderSec, b_n);
+                Q = 2.0f*(float)orderSec + 1.0f;
+                break;
+        }
+        normSec = Q/(float)nSecDirs; /* directivity factor / number of sectors */
+        
+        for(ns=0; ns<nSecDirs; ns++){
+            /* rotate the pattern by rotating the coefficients */
+            azi_sec = sec_dirs_deg[ns*2] * M_PI/180.0f;
+            elev_sec = sec_dirs_deg[ns*2+1] * M_PI/180.0f; /* from elevation to inclination */
+            rotateAxisCoeffsReal(orderSec, b_n, M_PI/2.0f-elev_sec, azi_sec, c_nm);
+            beamWeightsVelocityPatternsReal(orderSec, b_n, azi_sec, elev_sec, A_xyz, xyz_nm);
+     
+            /* store coefficients */
+            for(j=0; j<nSH; j++){
+                sectorCoeffs[ns*4*nSH + 0*nSH +j] = sqrtf(normSec) * c_nm[j];
+                for(i=0; i<3; i++)
+                    sectorCoeffs[ns*4*nSH + (i+1)*nSH +j] = sqrtf(normSec) * xyz_nm[j*3+i];
+            }
+        }
+        
+        free(b_n);
+        free(c_nm);
+        free(xyz_nm);
+    }
+    return normSec;
+}
+
+float computeSectorCoeffsAP
+(
+    int orderSec,
+    float_complex* A_xyz,
+    SECTOR_PATTERNS pattern,
+    float* sec_dirs_deg,
+    int nSecDirs,
+    float* sectorCoeffs
+)
+{
+    int i, j, ns, orderVel, nSH;
+    float normSec, azi_sec, elev_sec;
+    float* b_n, *c_nm, *xyz_nm;
+    
+    if(orderSec==0){
+        memcpy(sectorCoeffs, wxyzCoeffs, 16*sizeof(float)); /* ACN/N3D to WXYZ */
+        normSec = 1.0f;
+    }
+    else{
+        orderVel = orderSec+1;
+        nSH = (orderSec+2)*(orderSec+2);
+        b_n = malloc1d((orderSec+1)*sizeof(float));
+        c_nm = calloc1d((orderVel+1)*(orderVel+1), sizeof(float)); /* pad with zeros */
+        xyz_nm = malloc1d((orderVel+1)*(orderVel+1)*3*sizeof(float));
+        switch(pattern){
+            case SECTOR_PATTERN_PWD: beamWeightsHypercardioid2Spherical(orderSec, b_n); break;
+            case SECTOR_PATTERN_MAXRE: beamWeightsMaxEV(orderSec, b_n); break;
+            case SECTOR_PATTERN_CARDIOID: beamWeightsCardioid2Spherical(orderSec, b_n); break;
+        }
+        normSec = (float)(orderSec+1)/(float)nSecDirs;
+        
+        for(ns=0; ns<nSecDirs; ns++){
+            /* rotate the pattern by rotating the coefficients */
+            azi_sec = sec_dirs_deg[ns*2] * M_PI/180.0f;
+            elev_sec = sec_dirs_deg[ns*2+1] * M_PI/180.0f;
+            rotateAxisCoeffsReal(orderSec, b_n, M_PI/2.0f-elev_sec, azi_sec, c_nm);
+            beamWeightsVelocityPatternsReal(orderSec, b_n, azi_sec, elev_sec, A_xyz, xyz_nm);
+            
+            /* store coefficients */
+            for(j=0; j<nSH; j++){
+                sectorCoeffs[ns*4*nSH + 0*nSH +j] = normSec * c_nm[j];
+                for(i=0; i<3; i++)
+                    sectorCoeffs[ns*4*nSH + (i+1)*nSH +j] = normSec * xyz_nm[j*3+i];
+            }
+        }
+        
+        free(b_n);
+        free(c_nm);
+        free(xyz_nm);
+    }
+    return normSec;
+}
+
+void beamWeightsCardioid2Spherical
+(
+    int N,
+    float* b_n
+)
+{
+    int n;
+    
+    /* The coefficients can be derived by the binomial expansion of the cardioid function */
+    for(n=0; n<N+1; n++) {
+        b_n[n] = sqrtf(4.0f*M_PI*(2.0f*(float)n+1.0f)) *
+                 (float)factorial(N)* (float)factorial(N+1)/
+                 ((float)factorial(N+n+1)*(float)factorial(N-n))/
+                 ((float)N+1.0f);
+    }
+}
+
+void beamWeightsHypercardioid2Spherical
+(
+    int N,
+    float* b_n
+)
+{
+    int n;
+    float* c_n;
+    float dirs_rad[2] = {0.0f, 0.0f};
+    
+    c_n = malloc1d((N+1)*(N+1)*sizeof(float));
+    getSHreal(N, dirs_rad, 1, c_n);
+    for(n=0; n<N+1; n++)
+        b_n[n] = c_n[(n+1)*(n+1)-n-1] * 4.0f * M_PI/(powf((float)N+1.0f, 2.0f));
+    
+    free(c_n);
+}
+
+void beamWeightsMaxEV
+(
+    int N,
+    float* b_n
+)
+{
+    int n;
+    float norm;
+    double temp_i;
+    double* temp_o;
+    
+    temp_o = malloc1d( (N+1)*sizeof(double));
+    norm = 0.0f;
+    for (n=0; n<=N; n++) {
+        temp_i = cos(2.4068f/((double)N+1.51));
+        unnorm_legendreP(n, &temp_i, 1, temp_o);
+        b_n[n] = sqrtf((2.0f*(float)n+1.0f)/(4.0f*M_PI))*(float)temp_o[0];
+        norm +=  sqrtf((2.0f*(float)n+1.0f)/(4.0f*M_PI))*b_n[n];
+    }
+    
+    /* normalise to unity response on look-direction */
+    for (n=0; n<=N; n++)
+        b_n[n] /= norm;
+    
+    free(temp_o);
+}
+
+/* Types of coefficient sets held by the SH coefficient cache */
+#define SH_COEFFS_TYPE_BEAM_WEIGHTS ( 0 ) /* beamWeightsCached() */
+#define SH_COEFFS_TYPE_SECTORS_EP   ( 1 ) /* computeSectorCoeffsEPCached() */
+#define SH_COEFFS_TYPE_SECTORS_AP   ( 2 ) /* computeSectorCoeffsAPCached() */
+
+/**
+ * An entry of the SH coefficient cache; keyed by the type of coefficients, the
+ * order and pattern, and by the contents of the (sector) directions
+ */
+typedef struct _shCoeffsCache_entry {
+    int type, order, pattern, nDirs;
+    float* dirs_deg;                   /**< copy of the directions, or NULL; FLAT: nDirs x 2 */
+    int nCoeffs;
+    float* coeffs;                     /**< nCoeffs x 1 */
+    float norm;                        /**< normalisation coefficient (sectors only) */
+    struct _shCoeffsCache_entry* next;
+}shCoeffsCache_entry;
+
+/* Most recently used first */
+static shCoeffsCache_entry* shCoeffsCache_head = NULL;
+#if defined(_WIN32)
+static SRWLOCK shCoeffsCache_lock = SRWLOCK_INIT;
+# define SH_COEFFS_CACHE_LOCK()   AcquireSRWLockExclusive(&shCoeffsCache_lock)
+# define SH_COEFFS_CACHE_UNLOCK() ReleaseSRWLockExclusive(&shCoeffsCache_lock)
+#else
+static pthread_mutex_t shCoeffsCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define SH_COEFFS_CACHE_LOCK()   pthread_mutex_lock(&shCoeffsCache_lock)
+# define SH_COEFFS_CACHE_UNLOCK() pthread_mutex_unlock(&shCoeffsCache_lock)
+#endif
+
+/** Frees an entry of the SH coefficient cache */
+static void shCoeffsCache_freeEntry
+(
+    shCoeffsCache_entry* e
+)
+{
+    free(e->dirs_deg);
+    free(e->coeffs);
+    free(e);
+}
+
+/**
+ * Copies a set of coefficients out of the SH coefficient cache; computing
+ * them first, if they are not cached yet (the lock is held while computing)
+ *
+ * @returns Normalisation coefficient (sectors only)
+ */
+static float shCoeffsCache_get
+(
+    int type,
+    int order,
+    SECTOR_PATTERNS pattern,
+    float* dirs_deg,
+    int nDirs,
+    int nCoeffs,
+    float* coeffs
+)
+{
+    shCoeffsCache_entry* e, *tail, **prev;
+    float_complex* A_xyz;
+    float norm;
+    int n;
+
+    SH_COEFFS_CACHE_LOCK();
+    for(prev = &shCoeffsCache_head, e = shCoeffsCache_head; e!=NULL; prev = &(e->next), e = e->next){
+        if(e->type==type && e->order==order && e->pattern==(int)pattern && e->nDirs==nDirs &&
+           (nDirs==0 || !memcmp(e->dirs_deg, dirs_deg, nDirs*2*sizeof(float)))){
+            /* move to the front */
+            *prev = e->next;
+            e->next = shCoeffsCache_head;
+            shCoeffsCache_head = e;
+            memcpy(coeffs, e->coeffs, nCoeffs*sizeof(float));
+            norm = e->norm;
+            SH_COEFFS_CACHE_UNLOCK();
+            return norm;
+        }
+    }
+
+    /* not cached yet */
+    e = (shCoeffsCache_entry*)malloc1d(sizeof(shCoeffsCache_entry));
+    e->type = type;
+    e->order = order;
+    e->pattern = (int)pattern;
+    e->nDirs = nDirs;
+    e->dirs_deg = NULL;
+    if(nDirs>0){
+        e->dirs_deg = malloc1d(nDirs*2*sizeof(float));
+        memcpy(e->dirs_deg, dirs_deg, nDirs*2*sizeof(float));
+    }
+    e->nCoeffs = nCoeffs;
+    e->coeffs = malloc1d(nCoeffs*sizeof(float));
+    e->norm = 1.0f;
+    if(type==SH_COEFFS_TYPE_BEAM_WEIGHTS){
+        switch(pattern){
+            case SECTOR_PATTERN_PWD: beamWeightsHypercardioid2Spherical(order, e->coeffs); break;
+            case SECTOR_PATTERN_MAXRE: beamWeightsMaxEV(order, e->coeffs); break;
+            case SECTOR_PATTERN_CARDIOID: beamWeightsCardioid2Spherical(order, e->coeffs); break;
+        }
+    }
+    else{
+        A_xyz = malloc1d((order+2)*(order+2)*(order+1)*(order+1)*3*sizeof(float_complex));
+        computeVelCoeffsMtx(order, A_xyz);
+        if(type==SH_COEFFS_TYPE_SECTORS_EP)
+            e->norm = computeSectorCoeffsEP(order, A_xyz, pattern, dirs_deg, nDirs, e->coeffs);
+        else
+            e->norm = computeSectorCoeffsAP(order, A_xyz, pattern, dirs_deg, nDirs, e->coeffs);
+        free(A_xyz);
+    }
+    memcpy(coeffs, e->coeffs, nCoeffs*sizeof(float));
+    norm = e->norm;
+    e->next = shCoeffsCache_head;
+    shCoeffsCache_head = e;
+
+    /* discard the least recently used coefficients */
+    for(n=1, e = shCoeffsCache_head; e!=NULL && n<SH_COEFFS_CACHE_MAX_ENTRIES; n++)
+        e = e->next;
+    if(e!=NULL){
+        tail = e->next;
+        e->next = NULL;
+        while(tail!=NULL){
+            e = tail;
+            tail = tail->next;
+            shCoeffsCache_freeEntry(e);
+        }
+    }
+    SH_COEFFS_CACHE_UNLOCK();
+    return norm;
+}
+
+void beamWeightsCached
+(
+    SECTOR_PATTERNS pattern,
+    int N,
+    float* b_n
+)
+{
+    shCoeffsCache_get(SH_COEFFS_TYPE_BEAM_WEIGHTS, N, pattern, NULL, 0, N+1, b_n);
+}
+
+float computeSectorCoeffsEPCached
+(
+    int orderSec,
+    SECTOR_PATTERNS pattern,
+    float* sec_dirs_deg,
+    int nSecDirs,
+    float* sectorCoeffs
+)
+{
+    int nCoeffs;
+
+    nCoeffs = orderSec==0 ? 16 : nSecDirs*4*(orderSec+2)*(orderSec+2);
+    return shCoeffsCache_get(SH_COEFFS_TYPE_SECTORS_EP, orderSec, pattern, sec_dirs_deg, nSecDirs, nCoeffs, sectorCoeffs);
+}
+
+float computeSectorCoeffsAPCached
+(
+    int orderSec,
+    SECTOR_PATTERNS pattern,
+    float* sec_dirs_deg,
+    int nSecDirs,
+    float* sectorCoeffs
+)
+{
+    int nCoeffs;
+
+    nCoeffs = orderSec==0 ? 16 : nSecDirs*4*(orderSec+2)*(orderSec+2);
+    return shCoeffsCache_get(SH_COEFFS_TYPE_SECTORS_AP, orderSec, pattern, sec_dirs_deg, nSecDirs, nCoeffs, sectorCoeffs);
+}
+
+void shCoeffsCache_clear(void)
+{
+    shCoeffsCache_entry* e;
+
+    SH_COEFFS_CACHE_LOCK();
+    while(shCoeffsCache_head!=NULL){
+        e = shCoeffsCache_head;
+        shCoeffsCache_head = e->next;
+        shCoeffsCache_freeEntry(e);
+    }
+    SH_COEFFS_CACHE_UNLOCK();
+}
+
+int shCoeffsCache_getNumEntries(void)
+{
+    shCoeffsCache_entry* e;
+    int n;
+
+    SH_COEFFS_CACHE_LOCK();
+    for(n=0, e = shCoeffsCache_head; e!=NULL; e = e->next)
+        n++;
+    SH_COEFFS_CACHE_UNLOCK();
+    return n;
+}
+
+void beamWeightsVelocityPatternsReal
+(
+    int order,
+    float* b_n,
+    float azi_rad,
+    float elev_rad,
+    float_complex* A_xyz,
+    float* velCoeffs
+)
+{
+    int nSH;
+    float_complex* velCoeffs_c;
+    
+    nSH = (order+2)*(order+2);
+    velCoeffs_c = malloc1d(nSH*3*sizeof(float_complex));
+    beamWeightsVelocityPatternsComplex(order, b_n, azi_rad, elev_rad, A_xyz, velCoeffs_c);
+    complex2realCoeffs(order+1, velCoeffs_c, 3, velCoeffs);
+      
+    free(velCoeffs_c);
+}
+
+void beamWeightsVelocityPatternsRealSparse
+(
+    void* const hVel,
+    float* b_n,
+    float azi_rad,
+    float elev_rad,
+    float* velCoeffs
+)
+{
+    velCoeffsMtx_data *h = (velCoeffsMtx_data*)(hVel);
+    int nSH;
+    float_complex* velCoeffs_c;
+
+    nSH = (h->sectorOrder+2)*(h->sectorOrder+2);
+    velCoeffs_c = malloc1d(nSH*3*sizeof(float_complex));
+    beamWeightsVelocityPatternsComplexSparse(hVel, b_n, azi_rad, elev_rad, velCoeffs_c);
+    complex2realCoeffs(h->sectorOrder+1, velCoeffs_c, 3, velCoeffs);
+
+    free(velCoeffs_c);
+}
+
+void beamWeightsVelocityPatternsComplexSparse
+(
+    void* const hVel,
+    float* b_n,
+    float azi_rad,
+    float elev_rad,
+    float_complex* velCoeffs
+)
+{
+    velCoeffsMtx_data *h = (velCoeffsMtx_data*)(hVel);
+    float_complex* c_nm;
+
+    c_nm = malloc1d((h->sectorOrder+1)*(h->sectorOrder+1)*sizeof(float_complex));
+    rotateAxisCoeffsComplex(h->sectorOrder, b_n, M_PI/2.0f-elev_rad, azi_rad, c_nm);
+    velCoeffsMtx_apply(hVel, c_nm, 1, velCoeffs); /* x_nm, y_nm, z_nm */
+
+    free(c_nm);
+}
+
+void beamWeightsVelocityPatternsComplex
+(
+    int order,
+    float* b_n,
+    float azi_rad,
+    float elev_rad,
+    float_complex* A_xyz,
+    float_complex* velCoeffs
+)
+{
+    int i, j, d3, nSH_l, nSH;
+    float_complex* c_nm, *A_1, *velCoeffs_T;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    
+    nSH_l = (order+1)*(order+1);
+    nSH = (order+2)*(order+2);
+    c_nm = malloc1d(nSH_l*sizeof(float_complex));
+    A_1 = malloc1d(nSH*nSH_l*sizeof(float_complex));
+    velCoeffs_T = malloc1d(3*nSH*sizeof(float_complex));
+    rotateAxisCoeffsComplex(order, b_n, M_PI/2.0f-elev_rad, azi_rad, c_nm);
+    
+    /* x_nm, y_nm, z_nm */
+    for(d3 = 0; d3<3; d3++){
+        for(i=0; i<nSH; i++)
+            for(j=0; j<nSH_l; j++)
+                A_1[i*nSH_l+j] = A_xyz[i*nSH_l*3 + j*3 + d3];
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, 1, nSH_l, &calpha,
+                    A_1, nSH_l,
+                    c_nm, 1, &cbeta,
+                    &velCoeffs_T[d3*nSH], 1);
+    }
+    for(d3 = 0; d3<3; d3++)
+        for(i=0; i<nSH; i++)
+            velCoeffs[i*3+d3] = velCoeffs_T[d3*nSH+i]; /* transpose */
+
+    free(c_nm);
+    free(A_1);
+    free(velCoeffs_T);
+}
+
+void rotateAxisCoeffsReal
+(
+    int order,
+    float* c_n,
+    float theta_0, /* inclination*/
+    float phi_0,  /* azimuth */
+    float* c_nm
+)
+{
+    int nSH;
+    float_complex* c_nm_c;
+
+    nSH = (order+1)*(order+1);
+    c_nm_c = malloc1d(nSH*sizeof(float_complex));
+    rotateAxisCoeffsComplex(order, c_n, theta_0, phi_0, c_nm_c);
+    complex2realCoeffs(order, c_nm_c, 1, c_nm);
+    
+    free(c_nm_c);
+}
+
+void rotateAxisCoeffsComplex
+(
+    int order,
+    float* c_n,
+    float theta_0,  /* inclination*/
+    float phi_0,    /* azimuth */
+    float_complex* c_nm
+)
+{
+    int n, m, q, nSH;
+    float phi_theta[2];
+    float_complex* Y_N;
+    
+    phi_theta[0] = phi_0;
+    phi_theta[1] = theta_0;
+    nSH = (order+1)*(order+1);
+    Y_N = malloc1d(nSH*sizeof(float_complex));
+    getSHcomplex(order, (float*)phi_theta, 1, Y_N);
+    for(n=0, q = 0; n<=order; n++)
+        for(m=-n; m<=n; m++, q++)
+            c_nm[q] = crmulf(conjf(Y_N[q]), sqrtf(4.0f*M_PI/(2.0f*(float)n+1.0f)) * c_n[n]);
+    
+    free(Y_N);
+}
+
+void rotateAxisCoeffsRealBatch
+(
+    int order,
+    float* c_n,
+    float* theta_0,
+    float* phi_0,
+    int nDirs,
+    float* c_nm
+)
+{
+    int i, j, n, m, q, nSH, nBlock;
+    float x[SH_FAST_BLOCK_SIZE], y[SH_FAST_BLOCK_SIZE], z[SH_FAST_BLOCK_SIZE];
+    float Y_fast[(SH_FAST_MAX_ORDER+1)*(SH_FAST_MAX_ORDER+1)*SH_FAST_BLOCK_SIZE];
+    float* w_nm, *Y, *dirs_rad;
+    
+    nSH = (order+1)*(order+1);
+    w_nm = malloc1d(nSH*sizeof(float));
+    for(n=0, q=0; n<=order; n++)
+        for(m=-n; m<=n; m++, q++)
+            w_nm[q] = sqrtf(4.0f*M_PI/(2.0f*(float)n+1.0f)) * c_n[n];
+    if(order<=SH_FAST_MAX_ORDER){
+        Y = Y_fast;
+        dirs_rad = NULL;
+    }
+    else{
+        Y = malloc1d(nSH*SH_FAST_BLOCK_SIZE*sizeof(float));
+        dirs_rad = malloc1d(SH_FAST_BLOCK_SIZE*2*sizeof(float));
+    }
+    
+    /* the rotated coefficients are simply the real SHs of the look directions,
+     * scaled per order (the conjugation in rotateAxisCoeffsComplex() cancels
+     * out in the real basis) */
+    for(i=0; i<nDirs; i+=SH_FAST_BLOCK_SIZE){
+        nBlock = MIN(SH_FAST_BLOCK_SIZE, nDirs-i);
+        if(dirs_rad==NULL){
+            for(j=0; j<nBlock; j++){
+                x[j] = sinf(theta_0[i+j])*cosf(phi_0[i+j]);
+                y[j] = sinf(theta_0[i+j])*sinf(phi_0[i+j]);
+                z[j] = cosf(theta_0[i+j]);
+            }
+            getSHreal_fastCart(order, x, y, z, nBlock, Y);
+        }
+        else{
+            for(j=0; j<nBlock; j++){
+                dirs_rad[j*2] = phi_0[i+j];
+                dirs_rad[j*2+1] = theta_0[i+j];
+            }
+            getSHreal_recur(order, dirs_rad, nBlock, Y);
+        }
+        for(j=0; j<nBlock; j++)
+            for(q=0; q<nSH; q++)
+                c_nm[(i+j)*nSH+q] = w_nm[q] * Y[q*nBlock+j];
+    }
+    
+    free(w_nm);
+    if(dirs_rad!=NULL){
+        free(Y);
+        free(dirs_rad);
+    }
+}
+
+/** Data structure for the rotated axisymmetric coefficients cache */
+typedef struct _rotateAxisCoeffsCache_data {
+    int maxOrder, order, nEntries;
+    float* c_n;                /**< pattern currently cached; (maxOrder+1) x 1 */
+    float* theta_0, *phi_0;    /**< direction of each entry; nEntries x 1 */
+    int* valid;                /**< 1: entry holds the coefficients for its direction */
+    float* c_nm;               /**< FLAT: nEntries x (maxOrder+1)^2 */
+    /* scratch, for the directions that are not in the cache */
+    int missIdx[SH_FAST_BLOCK_SIZE];
+    int missEntry[SH_FAST_BLOCK_SIZE];
+    float missTheta[SH_FAST_BLOCK_SIZE];
+    float missPhi[SH_FAST_BLOCK_SIZE];
+    float* miss_c_nm;          /**< FLAT: SH_FAST_BLOCK_SIZE x (maxOrder+1)^2 */
+
+}rotateAxisCoeffsCache_data;
+
+/** Returns the (direct-mapped) entry of a direction in the cache */
+static int rotateAxisCoeffsCache_entry
+(
+    rotateAxisCoeffsCache_data* h,
+    float theta_0,
+    float phi_0
+)
+{
+    union { float f; unsigned int u; } a, b;
+    a.f = theta_0;
+    b.f = phi_0;
+    return (int)(((a.u * 2654435761u) ^ (b.u * 2246822519u)) % (unsigned int)h->nEntries);
+}
+
+/** Computes the pending misses, and stores them in both the cache and c_nm */
+static void rotateAxisCoeffsCache_flush
+(
+    rotateAxisCoeffsCache_data* h,
+    int nMiss,
+    float* c_nm
+)
+{
+    int i, e, nSH, maxNSH;
+    
+    if(nMiss==0)
+        return;
+    nSH = (h->order+1)*(h->order+1);
+    maxNSH = (h->maxOrder+1)*(h->maxOrder+1);
+    rotateAxisCoeffsRealBatch(h->order, h->c_n, h->missTheta, h->missPhi, nMiss, h->miss_c_nm);
+    for(i=0; i<nMiss; i++){
+        e = h->missEntry[i];
+        memcpy(&c_nm[h->missIdx[i]*nSH], &h->miss_c_nm[i*nSH], nSH*sizeof(float));
+        memcpy(&h->c_nm[e*maxNSH], &h->miss_c_nm[i*nSH], nSH*sizeof(float));
+        h->theta_0[e] = h->missTheta[i];
+        h->phi_0[e] = h->missPhi[i];
+        h->valid[e] = 1;
+    }
+}
+
+void rotateAxisCoeffsCache_create
+(
+    void** const phCache,
+    int maxOrder,
+    int nEntries
+)
+{
+    rotateAxisCoeffsCache_data* h;
+    
+    h = (rotateAxisCoeffsCache_data*)malloc1d(sizeof(rotateAxisCoeffsCache_data));
+    *phCache = (void*)h;
+    h->maxOrder = maxOrder;
+    h->order = -1; /* (no pattern set yet) */
+    h->nEntries = MAX(nEntries, 1);
+    h->c_n = calloc1d(maxOrder+1, sizeof(float));
+    h->theta_0 = malloc1d(h->nEntries*sizeof(float));
+    h->phi_0 = malloc1d(h->nEntries*sizeof(float));
+    h->valid = calloc1d(h->nEntries, sizeof(int));
+    h->c_nm = malloc1d(h->nEntries*(maxOrder+1)*(maxOrder+1)*sizeof(float));
+    h->miss_c_nm = malloc1d(SH_FAST_BLOCK_SIZE*(maxOrder+1)*(maxOrder+1)*sizeof(float));
+}
+
+void rotateAxisCoeffsCache_destroy
+(
+    void** const phCache
+)
+{
+    rotateAxisCoeffsCache_data* h = (rotateAxisCoeffsCache_data*)(*phCache);
+    
+    if(h!=NULL){
+        free(h->c_n);
+        free(h->theta_0);
+        free(h->phi_0);
+        free(h->valid);
+        free(h->c_nm);
+        free(h->miss_c_nm);
+        free(h);
+        *phCache = NULL;
+    }
+}
+
+void rotateAxisCoeffsCache_setPattern
+(
+    void* const hCache,
+    int order,
+    float* c_n
+)
+{
+    rotateAxisCoeffsCache_data* h = (rotateAxisCoeffsCache_data*)(hCache);
+    
+    assert(order<=h->maxOrder);
+    if(order==h->order && !memcmp(c_n, h->c_n, (order+1)*sizeof(float)))
+        return; /* same pattern; keep the cached entries */
+    h->order = order;
+    memcpy(h->c_n, c_n, (order+1)*sizeof(float));
+    memset(h->valid, 0, h->nEntries*sizeof(int));
+}
+
+void rotateAxisCoeffsCache_get
+(
+    void* const hCache,
+    float* theta_0,
+    float* phi_0,
+    int nDirs,
+    float* c_nm
+)
+{
+    rotateAxisCoeffsCache_data* h = (rotateAxisCoeffsCache_data*)(hCache);
+    int i, e, nSH, maxNSH, nMiss;
+    
+    assert(h->order>=0); /* rotateAxisCoeffsCache_setPattern() must be called first */
+    nSH = (h->order+1)*(h->order+1);
+    maxNSH = (h->maxOrder+1)*(h->maxOrder+1);
+    nMiss = 0;
+    for(i=0; i<nDirs; i++){
+        e = rotateAxisCoeffsCache_entry(h, theta_0[i], phi_0[i]);
+        if(h->valid[e] && h->theta_0[e]==theta_0[i] && h->phi_0[e]==phi_0[i])
+            memcpy(&c_nm[i*nSH], &h->c_nm[e*maxNSH], nSH*sizeof(float));
+        else{
+            h->missIdx[nMiss] = i;
+            h->missEntry[nMiss] = e;
+            h->missTheta[nMiss] = theta_0[i];
+            h->missPhi[nMiss] = phi_0[i];
+            if(++nMiss==SH_FAST_BLOCK_SIZE){
+                rotateAxisCoeffsCache_flush(h, nMiss, c_nm);
+                nMiss = 0;
+            }
+        }
+    }
+    rotateAxisCoeffsCache_flush(h, nMiss, c_nm);
+}
+
+/** Data structure for the SH product (sparse Gaunt coefficients) table */
+typedef struct _shProduct_data {
+    int N1, N2, N;
+    int nnz;                   /**< number of nonzero Gaunt coefficients */
+    int* rowPtr;               /**< start of each output coefficient; ((N+1)^2+1) x 1 */
+    int* q1Idx;                /**< index into the first expansion; nnz x 1 */
+    int* q2Idx;                /**< index into the second expansion; nnz x 1 */
+    float* val;                /**< Gaunt coefficients; nnz x 1 */
+
+}shProduct_data;
+
+void shProduct_create
+(
+    void** const phProd,
+    int N1,
+    int N2,
+    int N
+)
+{
+    shProduct_data* h;
+    int i, k, t, K, n, m, n1, m1, n2, m2, q, q1, q2, nc, c, maxN, maxNSH, nnzMax, dup;
+    int m2c[4];
+    float* dirs_rad, *Y;
+    const float* tdesign_dirs_deg;
+    double G;
+
+    assert(N1>=0 && N2>=0 && N>=0 && N1+N2+N<=100);
+    h = malloc1d(sizeof(shProduct_data));
+    *phProd = (void*)h;
+    h->N1 = N1;
+    h->N2 = N2;
+    h->N = N;
+
+    /* uniform quadrature, exact for the product of all three expansions */
+    t = N1+N2+N;
+    if(t<=21){
+        t = MAX(t, 1);
+        tdesign_dirs_deg = __HANDLES_Tdesign_dirs_deg[t-1];
+        K = __Tdesign_nPoints_per_degree[t-1];
+    }
+    else if(t<=30){ tdesign_dirs_deg = (const float*)__Tdesign_degree_30_dirs_deg; K = 480; }
+    else if(t<=40){ tdesign_dirs_deg = (const float*)__Tdesign_degree_40_dirs_deg; K = 840; }
+    else if(t<=50){ tdesign_dirs_deg = (const float*)__Tdesign_degree_50_dirs_deg; K = 1296; }
+    else          { tdesign_dirs_deg = (const float*)__Tdesign_degree_100_dirs_deg; K = 5100; }
+    maxN = MAX(MAX(N1, N2), N);
+    maxNSH = ORDER2NSH(maxN);
+    dirs_rad = malloc1d(K*2*sizeof(float));
+    for(k=0; k<K; k++){
+        dirs_rad[k*2]   = tdesign_dirs_deg[k*2]*M_PI/180.0f;
+        dirs_rad[k*2+1] = M_PI/2.0f - tdesign_dirs_deg[k*2+1]*M_PI/180.0f;
+    }
+    Y = malloc1d(maxNSH*K*sizeof(float));
+    getSHreal(maxN, dirs_rad, K, Y);
+
+    /* Only the entries which satisfy the selection rules are integrated: the
+     * triangle rule and even parity over the degrees, and
+     * |m2| = |m|+|m1| or ||m|-|m1|| over the (real) orders */
+    nnzMax = 1024;
+    h->nnz = 0;
+    h->rowPtr = malloc1d((ORDER2NSH(N)+1)*sizeof(int));
+    h->q1Idx = malloc1d(nnzMax*sizeof(int));
+    h->q2Idx = malloc1d(nnzMax*sizeof(int));
+    h->val = malloc1d(nnzMax*sizeof(float));
+    for(n=0, q=0; n<=N; n++){
+        for(m=-n; m<=n; m++, q++){
+            h->rowPtr[q] = h->nnz;
+            for(n1=0, q1=0; n1<=N1; n1++){
+                for(m1=-n1; m1<=n1; m1++, q1++){
+                    for(n2=abs(n-n1); n2<=MIN(n+n1, N2); n2+=2){
+                        nc = 0;
+                        m2c[nc++] = abs(m)+abs(m1);
+                        m2c[nc++] = -(abs(m)+abs(m1));
+                        m2c[nc++] = abs(abs(m)-abs(m1));
+                        m2c[nc++] = -abs(abs(m)-abs(m1));
+                        for(c=0; c<nc; c++){
+                            m2 = m2c[c];
+                            for(i=0, dup=0; i<c; i++)
+                                dup |= m2c[i]==m2;
+                            if(dup || abs(m2)>n2)
+                                continue;
+                            q2 = n2*n2+n2+m2;
+                            for(k=0, G=0.0; k<K; k++)
+                                G += (double)Y[q*K+k] * (double)Y[q1*K+k] * (double)Y[q2*K+k];
+                            G *= 4.0*M_PI/(double)K;
+                            if(fabs(G)<1e-6)
+                                continue;
+                            if(h->nnz==nnzMax){
+                                nnzMax *= 2;
+                                h->q1Idx = realloc1d(h->q1Idx, nnzMax*sizeof(int));
+                                h->q2Idx = realloc1d(h->q2Idx, nnzMax*sizeof(int));
+                                h->val = realloc1d(h->val, nnzMax*sizeof(float));
+                            }
+                            h->q1Idx[h->nnz] = q1;
+                            h->q2Idx[h->nnz] = q2;
+                            h->val[h->nnz] = (float)G;
+                            h->nnz++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    h->rowPtr[q] = h->nnz;
+
+    free(dirs_rad);
+    free(Y);
+}
+
+void shProduct_destroy
+(
+    void** const phProd
+)
+{
+    shProduct_data *h = (shProduct_data*)(*phProd);
+
+    if (h != NULL) {
+        free(h->rowPtr);
+        free(h->q1Idx);
+        free(h->q2Idx);
+        free(h->val);
+        free(h);
+        h = NULL;
+        *phProd = NULL;
+    }
+}
+
+int shProduct_getNumNonZeros
+(
+    void* const hProd
+)
+{
+    shProduct_data *h = (shProduct_data*)(hProd);
+    return h->nnz;
+}
+
+void shProduct_apply
+(
+    void* const hProd,
+    float* a,
+    float* b,
+    float* c
+)
+{
+    shProduct_data *h = (shProduct_data*)(hProd);
+    int q, e;
+    float sum;
+
+    for(q=0; q<ORDER2NSH(h->N); q++){
+        sum = 0.0f;
+        for(e=h->rowPtr[q]; e<h->rowPtr[q+1]; e++)
+            sum += h->val[e] * a[h->q1Idx[e]] * b[h->q2Idx[e]];
+        c[q] = sum;
+    }
+}
+
+void shProduct_getMtx
+(
+    void* const hProd,
+    float* a,
+    float* M
+)
+{
+    shProduct_data *h = (shProduct_data*)(hProd);
+    int q, e, nSH2;
+
+    nSH2 = ORDER2NSH(h->N2);
+    memset(M, 0, ORDER2NSH(h->N)*nSH2*sizeof(float));
+    for(q=0; q<ORDER2NSH(h->N); q++)
+        for(e=h->rowPtr[q]; e<h->rowPtr[q+1]; e++)
+            M[q*nSH2 + h->q2Idx[e]] += h->val[e] * a[h->q1Idx[e]];
+}
+
+/** Per-thread scratch of checkCondNumberSHTReal() */
+typedef struct _condNumberWorkspace_thread {
+    float* G_n;   /**< leading block of the Gram matrix; FLAT: nSH x nSH */
+    float* s;     /**< singular values; nSH x 1 */
+    void* hSvd;   /**< SVD workspace (up to nSH x nSH) */
+
+}condNumberWorkspace_thread;
+
+/** Workspace for checkCondNumberSHTReal() */
+typedef struct _condNumberWorkspace_data {
+    int maxOrder, maxNumDirs;
+    float* Y;     /**< SH; FLAT: nSH x nDirs */
+    float* Yw;    /**< weighted SH; FLAT: nSH x nDirs */
+    float* G;     /**< Gram matrix of the highest order; FLAT: nSH x nSH */
+
+    /* multi-threading (see condNumberWorkspace_setNumThreads()) */
+    int nThreads;
+    void* hParFor;                   /**< thread pool (NULL if single-threaded) */
+    condNumberWorkspace_thread* thr; /**< nThreads */
+    int job_order;                   /**< order of the current job */
+    float* job_cond_N;               /**< output of the current job */
+
+}condNumberWorkspace_data;
+
+/** Allocates the scratch of one thread */
+static void condNumberWorkspace_createThread
+(
+    condNumberWorkspace_thread* t,
+    int nSH
+)
+{
+    t->G_n = malloc1d(nSH*nSH*sizeof(float));
+    t->s = malloc1d(nSH*sizeof(float));
+    utility_ssvd_create(&(t->hSvd), nSH, nSH);
+}
+
+/** Frees the scratch of one thread */
+static void condNumberWorkspace_destroyThread
+(
+    condNumberWorkspace_thread* t
+)
+{
+    free(t->G_n);
+    free(t->s);
+    utility_ssvd_destroy(&(t->hSvd));
+}
+
+void condNumberWorkspace_create
+(
+    void ** const phWork,
+    int maxOrder,
+    int maxNumDirs
+)
+{
+    condNumberWorkspace_data* h;
+    int nSH;
+
+    h = (condNumberWorkspace_data*)malloc1d(sizeof(condNumberWorkspace_data));
+    *phWork = (void*)h;
+    h->maxOrder = maxOrder;
+    h->maxNumDirs = maxNumDirs;
+    nSH = (maxOrder+1)*(maxOrder+1);
+    h->Y = malloc1d(nSH*maxNumDirs*sizeof(float));
+    h->Yw = malloc1d(nSH*maxNumDirs*sizeof(float));
+    h->G = malloc1d(nSH*nSH*sizeof(float));
+    h->nThreads = 1;
+    h->hParFor = NULL;
+    h->thr = (condNumberWorkspace_thread*)malloc1d(sizeof(condNumberWorkspace_thread));
+    condNumberWorkspace_createThread(&(h->thr[0]), nSH);
+}
+
+void condNumberWorkspace_destroy
+(
+    void ** const phWork
+)
+{
+    condNumberWorkspace_data* h = (condNumberWorkspace_data*)(*phWork);
+    int i;
+
+    if(h!=NULL){
+        saf_parfor_destroy(&(h->hParFor));
+        for(i=0; i<h->nThreads; i++)
+            condNumberWorkspace_destroyThread(&(h->thr[i]));
+        free(h->thr);
+        free(h->Y);
+        free(h->Yw);
+        free(h->G);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+int condNumberWorkspace_setNumThreads
+(
+    void* const hWork,
+    int nThreads
+)
+{
+    condNumberWorkspace_data* h = (condNumberWorkspace_data*)(hWork);
+    int i, nSH;
+
+    nSH = (h->maxOrder+1)*(h->maxOrder+1);
+    saf_parfor_destroy(&(h->hParFor));
+    for(i=1; i<h->nThreads; i++)
+        condNumberWorkspace_destroyThread(&(h->thr[i]));
+    if(nThreads!=1){
+        saf_parfor_create(&(h->hParFor), nThreads);
+        h->nThreads = saf_parfor_getNumThreads(h->hParFor);
+        if(h->nThreads==1)
+            saf_parfor_destroy(&(h->hParFor));
+    }
+    else
+        h->nThreads = 1;
+    h->thr = (condNumberWorkspace_thread*)realloc1d(h->thr, h->nThreads*sizeof(condNumberWorkspace_thread));
+    for(i=1; i<h->nThreads; i++)
+        condNumberWorkspace_createThread(&(h->thr[i]), nSH);
+    return h->nThreads;
+}
+
+/**
+ * Computes the condition numbers of a range of orders (a saf_parfor_func);
+ * index 0 being the highest order, such that the most costly SVDs are taken
+ * first
+ */
+static void checkCondNumberSHTReal_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    condNumberWorkspace_data* h = (condNumberWorkspace_data*)(hCtx);
+    condNumberWorkspace_thread* t = &(h->thr[threadIndex]);
+    int k, n, i, nSH, nSH_n, ind;
+    float minVal, maxVal;
+
+    nSH = (h->job_order+1)*(h->job_order+1);
+    for(k=first; k<last; k++){
+        n = h->job_order - k;
+        nSH_n = (n+1)*(n+1);
+        for(i=0; i<nSH_n; i++)
+            memcpy(&(t->G_n[i*nSH_n]), &(h->G[i*nSH]), nSH_n*sizeof(float)); /* leading block */
+
+        /* condition number = max(singularValues)/min(singularValues) */
+        utility_ssvd(t->hSvd, t->G_n, nSH_n, nSH_n, NULL, NULL, NULL, t->s);
+        utility_simaxv(t->s, nSH_n, &ind);
+        maxVal = t->s[ind];
+        utility_siminv(t->s, nSH_n, &ind);
+        minVal = t->s[ind];
+        h->job_cond_N[n] = maxVal/(minVal+2.23e-7f);
+    }
+}
+
+void checkCondNumberSHTReal
+(
+    void* const hWork,
+    int order,
+    float* dirs_rad,
+    int nDirs,
+    float* w,
+    float* cond_N
+)
+{
+    condNumberWorkspace_data* h;
+    int i, j, nSH;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        condNumberWorkspace_create((void**)&h, order, nDirs);
+    else{
+        h = (condNumberWorkspace_data*)(hWork);
+        assert(order<=h->maxOrder && nDirs<=h->maxNumDirs);
+    }
+
+    /* Gram matrix of the (weighted) SH of the highest order, G = Y*diag(w)*Y^T */
+    nSH = (order+1)*(order+1);
+    getSHreal(order, dirs_rad, nDirs, h->Y);
+    if(w!=NULL){
+        for(i=0; i<nSH; i++)
+            for(j=0; j<nDirs; j++)
+                h->Yw[i*nDirs+j] = h->Y[i*nDirs+j] * w[j];
+    }
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nSH, nSH, nDirs, 1.0f,
+                h->Y, nDirs,
+                w!=NULL ? h->Yw : h->Y, nDirs, 0.0f,
+                h->G, nSH);
+
+    /* the condition number of each order, from the leading blocks */
+    h->job_order = order;
+    h->job_cond_N = cond_N;
+    if(h->hParFor!=NULL)
+        saf_parfor_runDynamic(h->hParFor, &checkCondNumberSHTReal_range, (void*)h, order+1, 1);
+    else
+        checkCondNumberSHTReal_range((void*)h, 0, 0, order+1);
+
+    if(hWork==NULL)
+        condNumberWorkspace_destroy((void**)&h);
+}
+
+/**
+ * Per-thread scratch of the powermap/activity-map generators (see
+ * pmapWorkspace_setNumThreads())
+ */
+typedef struct _pmapWorkspace_thread {
+    /* pmapWorkspace_scan() */
+    float_complex* pwd_Cx_Y_s, *pwd_Y_grid_s;
+
+    /* generateMVDRmap() */
+    float_complex* mvdr_Y_grid_t, *mvdr_invCx_Ygrid_t, *mvdr_invCx_Ygrid_s, *mvdr_Y_grid_s;
+
+    /* generateCroPaCLCMVmap() */
+    float_complex* lcmv_A, *lcmv_invCxd_A, *lcmv_invCxd_A_tmp, *lcmv_w_LCMV_s, *lcmv_wo, *lcmv_Cx_Y_s;
+
+    /* linear algebra workspaces */
+    void* hSlslv;  /**< for the Cx^-1 solves (up to nGrid_dirs columns) */
+    void* hGlslv;  /**< for the 2x2 LCMV solves (nSH columns) */
+
+}pmapWorkspace_thread;
+
+/**
+ * Arguments of the current parallel-for loop (see saf_parfor_run()), which
+ * processes a range of grid directions
+ */
+typedef struct _pmapWorkspace_job {
+    int nSH, nGrid_dirs, nSub, logScaleFlag;
+    float lambda;
+    float_complex* Cx, *W;
+    float* pmap;
+
+}pmapWorkspace_job;
+
+/**
+ * Workspace for the powermap/activity-map generators (generatePWDmap(),
+ * generateMVDRmap(), generateCroPaCLCMVmap(), generateMUSICmap() and
+ * generateMinNormMap()). Each generator has its own buffers, since the MVDR
+ * and CroPaC generators call the PWD generator (and CroPaC calls MVDR).
+ *
+ * The work over the grid directions is split into one contiguous range per
+ * thread; each thread using its own scratch, and writing only to its own
+ * columns/elements of the shared buffers and of the output map.
+ */
+typedef struct _pmapWorkspace_data {
+    int maxOrder, maxNumGridDirs;
+
+    /* generatePWDmap() */
+    float_complex* pwd_Cx_Y;
+
+    /* generateMVDRmap() */
+    float_complex* mvdr_w, *mvdr_Cx_d;
+
+    /* generateCroPaCLCMVmap() */
+    float* lcmv_mvdr_map;
+    float_complex* lcmv_Cx_Y, *lcmv_Cx_d, *lcmv_w_CroPaC;
+
+    /* generateMUSICmap() and generateMinNormMap() */
+    float_complex* sub_Vn, *sub_Vn_Y, *sub_Vn1, *sub_Un, *sub_Un_Y;
+    void* hSeigr;  /**< for the MUSIC/MinNorm noise sub-space decompositions */
+
+    /* multi-threading (see pmapWorkspace_setNumThreads()) */
+    int nThreads;
+    void* hParFor;              /**< thread pool (NULL if single-threaded) */
+    pmapWorkspace_thread* thr;  /**< nThreads */
+    pmapWorkspace_job job;      /**< current job */
+
+    /* scanning stage back-end (see pmapWorkspace_setBackend()) */
+    PMAP_BACKENDS backend;
+    void* hCL;     /**< OpenCL back-end handle (NULL if not in use) */
+
+}pmapWorkspace_data;
+
+/** Allocates the scratch of one thread */
+static void pmapWorkspace_createThread
+(
+    pmapWorkspace_thread* t,
+    int nSH,
+    int nGrid
+)
+{
+    t->pwd_Cx_Y_s = malloc1d(nSH*sizeof(float_complex));
+    t->pwd_Y_grid_s = malloc1d(nSH*sizeof(float_complex));
+    t->mvdr_Y_grid_t = malloc1d(nSH*nGrid*sizeof(float_complex));
+    t->mvdr_invCx_Ygrid_t = malloc1d(nSH*nGrid*sizeof(float_complex));
+    t->mvdr_invCx_Ygrid_s = malloc1d(nSH*sizeof(float_complex));
+    t->mvdr_Y_grid_s = malloc1d(nSH*sizeof(float_complex));
+    t->lcmv_A = malloc1d(nSH*2*sizeof(float_complex));
+    t->lcmv_invCxd_A = malloc1d(nSH*2*sizeof(float_complex));
+    t->lcmv_invCxd_A_tmp = malloc1d(nSH*2*sizeof(float_complex));
+    t->lcmv_w_LCMV_s = malloc1d(2*nSH*sizeof(float_complex));
+    t->lcmv_wo = malloc1d(nSH*sizeof(float_complex));
+    t->lcmv_Cx_Y_s = malloc1d(nSH*sizeof(float_complex));
+    utility_cslslv_create(&(t->hSlslv), nSH, MAX(nGrid, 2));
+    utility_cglslv_create(&(t->hGlslv), 2, nSH);
+}
+
+/** Frees the scratch of one thread */
+static void pmapWorkspace_destroyThread
+(
+    pmapWorkspace_thread* t
+)
+{
+    free(t->pwd_Cx_Y_s);
+    free(t->pwd_Y_grid_s);
+    free(t->mvdr_Y_grid_t);
+    free(t->mvdr_invCx_Ygrid_t);
+    free(t->mvdr_invCx_Ygrid_s);
+    free(t->mvdr_Y_grid_s);
+    free(t->lcmv_A);
+    free(t->lcmv_invCxd_A);
+    free(t->lcmv_invCxd_A_tmp);
+    free(t->lcmv_w_LCMV_s);
+    free(t->lcmv_wo);
+    free(t->lcmv_Cx_Y_s);
+    utility_cslslv_destroy(&(t->hSlslv));
+    utility_cglslv_destroy(&(t->hGlslv));
+}
+
+void pmapWorkspace_create
+(
+    void ** const phWork,
+    int maxOrder,
+    int maxNumGridDirs
+)
+{
+    *phWork = malloc1d(sizeof(pmapWorkspace_data));
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(*phWork);
+    int nSH, nGrid;
+
+    h->maxOrder = maxOrder;
+    h->maxNumGridDirs = maxNumGridDirs;
+    nSH = (maxOrder+1)*(maxOrder+1);
+    nGrid = maxNumGridDirs;
+
+    /* generatePWDmap() */
+    h->pwd_Cx_Y = malloc1d(nSH*nGrid*sizeof(float_complex));
+
+    /* generateMVDRmap() */
+    h->mvdr_w = malloc1d(nSH*nGrid*sizeof(float_complex));
+    h->mvdr_Cx_d = malloc1d(nSH*nSH*sizeof(float_complex));
+
+    /* generateCroPaCLCMVmap() */
+    h->lcmv_mvdr_map = malloc1d(nGrid*sizeof(float));
+    h->lcmv_Cx_Y = malloc1d(nSH*nGrid*sizeof(float_complex));
+    h->lcmv_Cx_d = malloc1d(nSH*nSH*sizeof(float_complex));
+    h->lcmv_w_CroPaC = malloc1d(nSH*nGrid*sizeof(float_complex));
+
+    /* generateMUSICmap() and generateMinNormMap() */
+    h->sub_Vn = malloc1d(nSH*nSH*sizeof(float_complex));
+    h->sub_Vn_Y = malloc1d(nSH*nGrid*sizeof(float_complex));
+    h->sub_Vn1 = malloc1d(nSH*sizeof(float_complex));
+    h->sub_Un = malloc1d(nSH*sizeof(float_complex));
+    h->sub_Un_Y = malloc1d(nGrid*sizeof(float_complex));
+    utility_cseigr_create(&(h->hSeigr), nSH);
+
+    /* single-threaded by default */
+    h->nThreads = 1;
+    h->hParFor = NULL;
+    h->thr = (pmapWorkspace_thread*)malloc1d(sizeof(pmapWorkspace_thread));
+    pmapWorkspace_createThread(&(h->thr[0]), nSH, nGrid);
+
+    /* scanning stage back-end */
+    h->backend = PMAP_BACKEND_CPU;
+    h->hCL = NULL;
+}
+
+void pmapWorkspace_destroy
+(
+    void ** const phWork
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(*phWork);
+    int i;
+
+    if(h!=NULL){
+        free(h->pwd_Cx_Y);
+        free(h->mvdr_w);
+        free(h->mvdr_Cx_d);
+        free(h->lcmv_mvdr_map);
+        free(h->lcmv_Cx_Y);
+        free(h->lcmv_Cx_d);
+        free(h->lcmv_w_CroPaC);
+        free(h->sub_Vn);
+        free(h->sub_Vn_Y);
+        free(h->sub_Vn1);
+        free(h->sub_Un);
+        free(h->sub_Un_Y);
+        utility_cseigr_destroy(&(h->hSeigr));
+        saf_parfor_destroy(&(h->hParFor));
+        for(i=0; i<h->nThreads; i++)
+            pmapWorkspace_destroyThread(&(h->thr[i]));
+        free(h->thr);
+#ifdef SAF_ENABLE_OPENCL
+        pmapOpenCL_destroy(&(h->hCL));
+#endif
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+int pmapWorkspace_setNumThreads
+(
+    void* const hWork,
+    int nThreads
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hWork);
+    int i, nSH;
+
+    nSH = (h->maxOrder+1)*(h->maxOrder+1);
+    saf_parfor_destroy(&(h->hParFor));
+    for(i=1; i<h->nThreads; i++)
+        pmapWorkspace_destroyThread(&(h->thr[i]));
+    if(nThreads!=1){
+        saf_parfor_create(&(h->hParFor), nThreads);
+        h->nThreads = saf_parfor_getNumThreads(h->hParFor);
+        if(h->nThreads==1)
+            saf_parfor_destroy(&(h->hParFor));
+    }
+    else
+        h->nThreads = 1;
+    h->thr = (pmapWorkspace_thread*)realloc1d(h->thr, h->nThreads*sizeof(pmapWorkspace_thread));
+    for(i=1; i<h->nThreads; i++)
+        pmapWorkspace_createThread(&(h->thr[i]), nSH, h->maxNumGridDirs);
+    return h->nThreads;
+}
+
+PMAP_BACKENDS pmapWorkspace_setBackend
+(
+    void* const hWork,
+    PMAP_BACKENDS backend
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hWork);
+
+#ifdef SAF_ENABLE_OPENCL
+    pmapOpenCL_destroy(&(h->hCL));
+    if(backend==PMAP_BACKEND_OPENCL &&
+       pmapOpenCL_create(&(h->hCL), (h->maxOrder+1)*(h->maxOrder+1), h->maxNumGridDirs)==0)
+        h->backend = PMAP_BACKEND_OPENCL;
+    else
+        h->backend = PMAP_BACKEND_CPU;
+#else
+    h->backend = PMAP_BACKEND_CPU; /* (OpenCL support was not compiled) */
+#endif
+    return h->backend;
+}
+
+void pmapWorkspace_invalidateCache
+(
+    void* const hWork
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hWork);
+
+#ifdef SAF_ENABLE_OPENCL
+    if(h->hCL!=NULL)
+        pmapOpenCL_invalidateCache(h->hCL);
+#else
+    (void)h;
+#endif
+}
+
+/**
+ * Returns the workspace to use: either the one provided (after checking that
+ * it is large enough), or a temporary one, which must be destroyed by the
+ * caller if hWork is NULL
+ */
+static pmapWorkspace_data* pmapWorkspace_get
+(
+    void* const hWork,
+    int order,
+    int nGrid_dirs
+)
+{
+    pmapWorkspace_data *h;
+
+    if(hWork==NULL)
+        pmapWorkspace_create((void**)&h, order, nGrid_dirs);
+    else{
+        h = (pmapWorkspace_data*)(hWork);
+        assert(order<=h->maxOrder && nGrid_dirs<=h->maxNumGridDirs);
+    }
+    return h;
+}
+
+/** pmapWorkspace_scan() over the grid directions [first, last) */
+static void pmapWorkspace_scanRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hCtx);
+    pmapWorkspace_thread* t = &(h->thr[threadIndex]);
+    int i, j, nSH, nGrid_dirs;
+    float_complex* Cx, *W, *Cx_Y;
+    float_complex Y_Cx_Y;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+
+    nSH = h->job.nSH;
+    nGrid_dirs = h->job.nGrid_dirs;
+    Cx = h->job.Cx;
+    W = h->job.W;
+    Cx_Y = h->pwd_Cx_Y;
+
+    /* Calculate PWD powermap: real(diag(Y_grid.'*C_x*Y_grid)) */
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, last-first, nSH, &calpha,
+                Cx, nSH,
+                &W[first], nGrid_dirs, &cbeta,
+                &Cx_Y[first], nGrid_dirs);
+    for(i=first; i<last; i++){
+        for(j=0; j<nSH; j++){
+            t->pwd_Cx_Y_s[j] = Cx_Y[j*nGrid_dirs+i];
+            t->pwd_Y_grid_s[j] = W[j*nGrid_dirs+i];
+        }
+        /* faster to perform the dot-product for each vector seperately */
+        utility_cvvdot(t->pwd_Y_grid_s, t->pwd_Cx_Y_s, nSH, NO_CONJ, &Y_Cx_Y);
+        h->job.pmap[i] = crealf(Y_Cx_Y);
+    }
+}
+
+/**
+ * The scanning stage shared by the map generators: pmap = real(diag(W.'*Cx*W)).
+ * If 'cacheW' is set, then 'W' is the (static) steering matrix, which the
+ * OpenCL back-end need not upload again
+ */
+static void pmapWorkspace_scan
+(
+    pmapWorkspace_data* h,
+    int order,
+    float_complex* Cx,
+    float_complex* W,
+    int cacheW,
+    int nGrid_dirs,
+    float* pmap
 )
 {
-    int n, i, j, nSH, nSH_n, ind;
-    float minVal, maxVal;
-    float* Y_N, *Y_n, *YY_n, *W, *W_Yn, *s;
+    int nSH;
     
-    /* get SH */
     nSH = (order+1)*(order+1);
-    Y_N = malloc1d(nSH * nDirs *sizeof(float));
-    Y_n = malloc1d(nDirs * nSH* sizeof(float));
-    YY_n = malloc1d(nSH*nSH*sizeof(float));
-    getSHreal(order, dirs_rad, nDirs, Y_N);
-    
-    /* diagonalise the integration weights, if available */
-    if(w!=NULL){
-        W = calloc1d(nDirs*nDirs, sizeof(float));
-        W_Yn = malloc1d(nDirs*nSH*sizeof(float));
-        for(i=0; i<nDirs; i++)
-            W[i*nDirs+i] = w[i]; 
-    }
-    
-    /* compute the condition number for each order up to N */
-    s = malloc1d(nSH*sizeof(float));
-    for(n=0; n<=order; n++){
-        nSH_n = (n+1)*(n+1);
-        for(i=0; i<nDirs; i++)
-            for(j=0; j<nSH_n; j++)
-                Y_n[i*nSH_n+j] = Y_N[j*nDirs+i]; /* truncate to current order and transpose */
-        if(w==NULL){
-            cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH_n, nSH_n, nDirs, 1.0f,
-                        Y_n, nSH_n,
-                        Y_n, nSH_n, 0.0f,
-                        YY_n, nSH_n);
-        }
-        else{
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nDirs, nSH_n, nDirs, 1.0f,
-                        W, nDirs,
-                        Y_n, nSH_n, 0.0f,
-                        W_Yn, nSH_n);
-            cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH_n, nSH_n, nDirs, 1.0f,
-                        Y_n, nSH_n,
-                        W_Yn, nSH_n, 0.0f,
-                        YY_n, nSH_n);
-        }
-        
-        /* condition number = max(singularValues)/min(singularValues) */
-        utility_ssvd(YY_n, nSH_n, nSH_n, NULL, NULL, NULL, s);
-        utility_simaxv(s, nSH_n, &ind);
-        maxVal = s[ind];
-        utility_siminv(s, nSH_n, &ind);
-        minVal = s[ind];
-        cond_N[n] = maxVal/(minVal+2.23e-7f);
-    }
-    
-    free(Y_N);
-    free(Y_n);
-    free(YY_n);
-    if(w!=NULL){
-        free(W);
-        free(W_Yn);
-    }
-    free(s);
+#ifdef SAF_ENABLE_OPENCL
+    if(h->backend==PMAP_BACKEND_OPENCL && h->hCL!=NULL)
+        if(pmapOpenCL_scan(h->hCL, Cx, W, cacheW, nSH, nGrid_dirs, pmap)==0)
+            return;
+    /* (otherwise, fall back to the CPU) */
+#else
+    (void)cacheW;
+#endif
+    h->job.nSH = nSH;
+    h->job.nGrid_dirs = nGrid_dirs;
+    h->job.Cx = Cx;
+    h->job.W = W;
+    h->job.pmap = pmap;
+    saf_parfor_run(h->hParFor, &pmapWorkspace_scanRange, (void*)h, nGrid_dirs);
 }
 
 void generatePWDmap
 (
+    void* const hWork,
     int order,
     float_complex* Cx,
     float_complex* Y_grid,
@@ -1033,41 +3017,59 @@ void generatePWDmap
     float* pmap
 )
 {
-    int i, j, nSH;
-    float_complex* Cx_Y, *Y_Cx_Y, *Cx_Y_s, *Y_grid_s;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    pmapWorkspace_data *h;
     
-    nSH = (order+1)*(order+1);
-    Cx_Y = malloc1d(nSH * nGrid_dirs * sizeof(float_complex));
-    Y_Cx_Y = malloc1d(nGrid_dirs*sizeof(float_complex));
-    Cx_Y_s = malloc1d(nSH*sizeof(float_complex));
-    Y_grid_s = malloc1d(nSH*sizeof(float_complex));
+    h = pmapWorkspace_get(hWork, order, nGrid_dirs);
+    pmapWorkspace_scan(h, order, Cx, Y_grid, 1, nGrid_dirs, pmap);
     
-    /* Calculate PWD powermap: real(diag(Y_grid.'*C_x*Y_grid)) */
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nGrid_dirs, nSH, &calpha,
-                Cx, nSH,
-                Y_grid, nGrid_dirs, &cbeta,
-                Cx_Y, nGrid_dirs);
-    for(i=0; i<nGrid_dirs; i++){
+    if(hWork==NULL)
+        pmapWorkspace_destroy((void**)&h);
+}
+
+/** The MVDR weights for the grid directions [first, last) */
+static void generateMVDRmap_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hCtx);
+    pmapWorkspace_thread* t = &(h->thr[threadIndex]);
+    int i, j, nSH, nGrid_dirs, nCol;
+    float_complex* Y_grid, *Y_grid_t, *invCx_Ygrid_t;
+    float_complex denum;
+
+    nSH = h->job.nSH;
+    nGrid_dirs = h->job.nGrid_dirs;
+    nCol = last-first;
+    Y_grid = h->job.W;
+    Y_grid_t = t->mvdr_Y_grid_t;
+    invCx_Ygrid_t = t->mvdr_invCx_Ygrid_t;
+
+    /* solve the numerator part of the MVDR weights for these grid directions: Cx^-1 * Y */
+    for(j=0; j<nSH; j++)
+        memcpy(&Y_grid_t[j*nCol], &Y_grid[j*nGrid_dirs+first], nCol*sizeof(float_complex));
+    utility_cslslv(t->hSlslv, h->mvdr_Cx_d, nSH, Y_grid_t, nCol, invCx_Ygrid_t);
+    for(i=first; i<last; i++){
+        /* solve the denumerator part of the MVDR weights for each grid direction: Y^T * Cx^-1 * Y */
         for(j=0; j<nSH; j++){
-            Cx_Y_s[j] = Cx_Y[j*nGrid_dirs+i];
-            Y_grid_s[j] = Y_grid[j*nGrid_dirs+i];
+            t->mvdr_invCx_Ygrid_s[j] = conjf(invCx_Ygrid_t[j*nCol+i-first]);
+            t->mvdr_Y_grid_s[j] = Y_grid[j*nGrid_dirs+i];
         }
         /* faster to perform the dot-product for each vector seperately */
-        utility_cvvdot(Y_grid_s, Cx_Y_s, nSH, NO_CONJ, &Y_Cx_Y[i]);
+        utility_cvvdot(t->mvdr_Y_grid_s, t->mvdr_invCx_Ygrid_s, nSH, NO_CONJ, &denum);
+        
+        /* calculate the MVDR weights per grid direction: (Cx^-1 * Y) * (Y^T * Cx^-1 * Y)^-1 */
+        for(j=0; j<nSH; j++)
+            h->mvdr_w[j*nGrid_dirs +i] = ccdivf(invCx_Ygrid_t[j*nCol+i-first], denum);
     }
-    
-    for(i=0; i<nGrid_dirs; i++)
-        pmap[i] = crealf(Y_Cx_Y[i]);
-    
-    free(Cx_Y);
-    free(Y_Cx_Y);
-    free(Cx_Y_s);
-    free(Y_grid_s);
 }
 
 void generateMVDRmap
 (
+    void* const hWork,
     int order,
     float_complex* Cx,
     float_complex* Y_grid,
@@ -1077,17 +3079,14 @@ void generateMVDRmap
     float_complex* w_MVDR_out
 )
 {
-    int i, j, nSH;
+    pmapWorkspace_data *h;
+    int i, nSH;
     float Cx_trace;
-    float_complex *Cx_d, *invCx_Ygrid, *w_MVDR, *invCx_Ygrid_s, *Y_grid_s;
-    float_complex denum;
+    float_complex *Cx_d;
     
     nSH = (order+1)*(order+1);
-    w_MVDR = malloc1d(nSH * nGrid_dirs*sizeof(float_complex));
-    Cx_d = malloc1d(nSH*nSH*sizeof(float_complex));
-    invCx_Ygrid = malloc1d(nSH*nGrid_dirs*sizeof(float_complex));
-    invCx_Ygrid_s = malloc1d(nSH*sizeof(float_complex));
-    Y_grid_s = malloc1d(nSH*sizeof(float_complex));
+    h = pmapWorkspace_get(hWork, order, nGrid_dirs);
+    Cx_d = h->mvdr_Cx_d;
     
     /* apply diagonal loading */
     Cx_trace = 0.0f;
@@ -1098,101 +3097,75 @@ void generateMVDRmap
     for(i=0; i<nSH; i++)
         Cx_d[i*nSH+i] = craddf(Cx_d[i*nSH+i], regPar*Cx_trace);
     
-    /* solve the numerator part of the MVDR weights for all grid directions: Cx^-1 * Y */
-    utility_cslslv(Cx_d, nSH, Y_grid, nGrid_dirs, invCx_Ygrid);
-    for(i=0; i<nGrid_dirs; i++){
-        /* solve the denumerator part of the MVDR weights for each grid direction: Y^T * Cx^-1 * Y */
-        for(j=0; j<nSH; j++){
-            invCx_Ygrid_s[j] = conjf(invCx_Ygrid[j*nGrid_dirs+i]);
-            Y_grid_s[j] = Y_grid[j*nGrid_dirs+i];
-        }
-        /* faster to perform the dot-product for each vector seperately */
-        utility_cvvdot(Y_grid_s, invCx_Ygrid_s, nSH, NO_CONJ, &denum);
-        
-        /* calculate the MVDR weights per grid direction: (Cx^-1 * Y) * (Y^T * Cx^-1 * Y)^-1 */
-        for(j=0; j<nSH; j++)
-            w_MVDR[j*nGrid_dirs +i] = ccdivf(invCx_Ygrid[j*nGrid_dirs +i], denum);
-    }
+    /* calculate the MVDR weights for all grid directions */
+    h->job.nSH = nSH;
+    h->job.nGrid_dirs = nGrid_dirs;
+    h->job.W = Y_grid;
+    saf_parfor_run(h->hParFor, &generateMVDRmap_range, (void*)h, nGrid_dirs);
     
-    /* generate MVDR powermap, by using the generatePWDmap function with the MVDR weights instead */
-    generatePWDmap(order, Cx, w_MVDR, nGrid_dirs, pmap);
+    /* generate MVDR powermap, by using the PWD scanning stage with the MVDR weights instead */
+    pmapWorkspace_scan(h, order, Cx, h->mvdr_w, 0, nGrid_dirs, pmap);
     
     /* optional output of the beamforming weights */
     if (w_MVDR_out!=NULL)
-        memcpy(w_MVDR_out, w_MVDR, nSH * nGrid_dirs*sizeof(float_complex));
+        memcpy(w_MVDR_out, h->mvdr_w, nSH * nGrid_dirs*sizeof(float_complex));
     
-    free(w_MVDR);
-    free(Cx_d);
-    free(invCx_Ygrid);
-    free(invCx_Ygrid_s);
-    free(Y_grid_s);
+    if(hWork==NULL)
+        pmapWorkspace_destroy((void**)&h);
 }
 
-/* EXPERIMENTAL
- * Delikaris-Manias, S., Vilkamo, J., & Pulkki, V. (2016). Signal-dependent spatial filtering based on
- * weighted-orthogonal beamformers in the spherical harmonic domain. IEEE/ACM Transactions on Audio,
- * Speech and Language Processing (TASLP), 24(9), 1507-1519. */
-void generateCroPaCLCMVmap
+/** The CroPaC weights for the grid directions [first, last) */
+static void generateCroPaCLCMVmap_range
 (
-    int order,
-    float_complex* Cx,
-    float_complex* Y_grid,
-    int nGrid_dirs,
-    float regPar,
-    float lambda,
-    float* pmap  
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
 )
 {
-    int i, j, k, nSH;
-    float Cx_trace, S, G;
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hCtx);
+    pmapWorkspace_thread* t = &(h->thr[threadIndex]);
+    int i, j, k, nSH, nGrid_dirs;
+    float S, G, lambda;
     float* mvdr_map;
-    float_complex* Cx_d, *A, *invCxd_A, *invCxd_A_tmp, *w_LCMV_s, *w_CroPaC, *wo, *Cx_Y, *Cx_Y_s;
-    float_complex b[2]; 
+    float_complex* Cx, *Y_grid, *A, *invCxd_A, *invCxd_A_tmp, *w_LCMV_s, *w_CroPaC, *wo, *Cx_Y, *Cx_Y_s;
+    float_complex b[2];
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float_complex A_invCxd_A[2][2];
     float_complex Y_wo_xspec;
-    
+
     b[0] = cmplxf(1.0f, 0.0f);
     b[1] = cmplxf(0.0f, 0.0f);
-    nSH = (order+1)*(order+1);
-    Cx_Y = malloc1d(nSH * nGrid_dirs * sizeof(float_complex));
-    Cx_d = malloc1d(nSH*nSH*sizeof(float_complex));
-    A = malloc1d(nSH*2*sizeof(float_complex));
-    invCxd_A = malloc1d(nSH*2*sizeof(float_complex));
-    invCxd_A_tmp = malloc1d(nSH*2*sizeof(float_complex));
-    w_LCMV_s = malloc1d(2*nGrid_dirs*sizeof(float_complex));
-    w_CroPaC = malloc1d(nSH*nGrid_dirs*sizeof(float_complex));
-    wo = malloc1d(nSH*sizeof(float_complex));
-    mvdr_map = malloc1d(nGrid_dirs*sizeof(float));
-    Cx_Y_s = malloc1d(nSH*sizeof(float_complex));
-    
-    /* generate MVDR map and weights to use as a basis */
-    generateMVDRmap(order, Cx, Y_grid, nGrid_dirs, regPar, mvdr_map, w_CroPaC);
-    
+    nSH = h->job.nSH;
+    nGrid_dirs = h->job.nGrid_dirs;
+    lambda = h->job.lambda;
+    Cx = h->job.Cx;
+    Y_grid = h->job.W;
+    Cx_Y = h->lcmv_Cx_Y;
+    w_CroPaC = h->lcmv_w_CroPaC;
+    mvdr_map = h->lcmv_mvdr_map;
+    A = t->lcmv_A;
+    invCxd_A = t->lcmv_invCxd_A;
+    invCxd_A_tmp = t->lcmv_invCxd_A_tmp;
+    w_LCMV_s = t->lcmv_w_LCMV_s;
+    wo = t->lcmv_wo;
+    Cx_Y_s = t->lcmv_Cx_Y_s;
+
     /* first half of the cross-spectrum */
-    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nGrid_dirs, nSH, &calpha,
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, last-first, nSH, &calpha,
                 Cx, nSH,
-                Y_grid, nGrid_dirs, &cbeta,
-                Cx_Y, nGrid_dirs);
-    
-    /* apply diagonal loading to cov matrix */
-    Cx_trace = 0.0f;
-    for(i=0; i<nSH; i++)
-        Cx_trace += crealf(Cx[i*nSH+i]);
-    Cx_trace /= (float)nSH;
-    memcpy(Cx_d, Cx, nSH*nSH*sizeof(float_complex));
-    for(i=0; i<nSH; i++)
-        Cx_d[i*nSH+i] = craddf(Cx_d[i*nSH+i], regPar*Cx_trace);
+                &Y_grid[first], nGrid_dirs, &cbeta,
+                &Cx_Y[first], nGrid_dirs);
     
     /* calculate CroPaC beamforming weights for each grid direction */
-    for(i=0; i<nGrid_dirs; i++){
+    for(i=first; i<last; i++){
         for(j=0; j<nSH; j++){
             A[j*2] = Y_grid[j*nGrid_dirs+i];
             A[j*2+1] = ccmulf(A[j*2], Cx[j*nSH+j]);
         }
         
         /* solve for minimisation problem for LCMV weights: (Cx^-1 * A) * (A^H * Cx^-1 * A)^-1 * b */
-        utility_cslslv(Cx_d, nSH, A, 2, invCxd_A);
+        utility_cslslv(t->hSlslv, h->lcmv_Cx_d, nSH, A, 2, invCxd_A);
         for(j=0; j<nSH*2; j++)
             invCxd_A_tmp[j] = conjf(invCxd_A[j]);
         cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, 2, 2, nSH, &calpha,
@@ -1202,7 +3175,7 @@ void generateCroPaCLCMVmap
         for(j=0; j<nSH; j++)
             for(k=0; k<2; k++)
                 invCxd_A_tmp[k*nSH+j] = invCxd_A[j*2+k];
-        utility_cglslv((float_complex*)A_invCxd_A, 2, invCxd_A_tmp, nSH, w_LCMV_s);
+        utility_cglslv(t->hGlslv, (float_complex*)A_invCxd_A, 2, invCxd_A_tmp, nSH, w_LCMV_s);
         cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH, 1, 2, &calpha,
                     w_LCMV_s, nSH,
                     b, 1, &cbeta,
@@ -1220,25 +3193,95 @@ void generateCroPaCLCMVmap
         for(j=0; j<nSH; j++)
             w_CroPaC[j*nGrid_dirs + i] = crmulf(w_CroPaC[j*nGrid_dirs + i], G);
     }
+}
+
+/* EXPERIMENTAL
+ * Delikaris-Manias, S., Vilkamo, J., & Pulkki, V. (2016). Signal-dependent spatial filtering based on
+ * weighted-orthogonal beamformers in the spherical harmonic domain. IEEE/ACM Transactions on Audio,
+ * Speech and Language Processing (TASLP), 24(9), 1507-1519. */
+void generateCroPaCLCMVmap
+(
+    void* const hWork,
+    int order,
+    float_complex* Cx,
+    float_complex* Y_grid,
+    int nGrid_dirs,
+    float regPar,
+    float lambda,
+    float* pmap  
+)
+{
+    pmapWorkspace_data *h;
+    int i, nSH;
+    float Cx_trace;
+    float_complex* Cx_d;
+    
+    nSH = (order+1)*(order+1);
+    h = pmapWorkspace_get(hWork, order, nGrid_dirs);
+    Cx_d = h->lcmv_Cx_d;
+    
+    /* generate MVDR map and weights to use as a basis */
+    generateMVDRmap(h, order, Cx, Y_grid, nGrid_dirs, regPar, h->lcmv_mvdr_map, h->lcmv_w_CroPaC);
+    
+    /* apply diagonal loading to cov matrix */
+    Cx_trace = 0.0f;
+    for(i=0; i<nSH; i++)
+        Cx_trace += crealf(Cx[i*nSH+i]);
+    Cx_trace /= (float)nSH;
+    memcpy(Cx_d, Cx, nSH*nSH*sizeof(float_complex));
+    for(i=0; i<nSH; i++)
+        Cx_d[i*nSH+i] = craddf(Cx_d[i*nSH+i], regPar*Cx_trace);
+    
+    /* calculate CroPaC beamforming weights for all grid directions */
+    h->job.nSH = nSH;
+    h->job.nGrid_dirs = nGrid_dirs;
+    h->job.lambda = lambda;
+    h->job.Cx = Cx;
+    h->job.W = Y_grid;
+    saf_parfor_run(h->hParFor, &generateCroPaCLCMVmap_range, (void*)h, nGrid_dirs);
     
-    /* generate CroPaC powermap, by using the generatePWDmap function with the CroPaC weights instead */
-    generatePWDmap(order, Cx, w_CroPaC, nGrid_dirs, pmap);
+    /* generate CroPaC powermap, by using the PWD scanning stage with the CroPaC weights instead */
+    pmapWorkspace_scan(h, order, Cx, h->lcmv_w_CroPaC, 0, nGrid_dirs, pmap);
     
-    free(mvdr_map);
-    free(Cx_d);
-    free(A);
-    free(invCxd_A);
-    free(invCxd_A_tmp);
-    free(w_LCMV_s);
-    free(w_CroPaC);
-    free(wo);
-    free(Cx_Y);
-    free(Cx_Y_s);
+    if(hWork==NULL)
+        pmapWorkspace_destroy((void**)&h);
 }
 
+/** The MUSIC pseudo-spectrum for the grid directions [first, last) */
+static void generateMUSICmap_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hCtx);
+    int i, j, nSH, nSub, nGrid_dirs;
+    float_complex* Vn_Y;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    float_complex tmp;
+
+    (void)threadIndex;
+    nSH = h->job.nSH;
+    nSub = h->job.nSub;
+    nGrid_dirs = h->job.nGrid_dirs;
+    Vn_Y = h->sub_Vn_Y;
+    cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSub, last-first, nSH, &calpha,
+                h->sub_Vn, nSub,
+                &(h->job.W[first]), nGrid_dirs, &cbeta,
+                &Vn_Y[first], nGrid_dirs);
+    for(i=first; i<last; i++){
+        tmp = cmplxf(0.0f,0.0f);
+        for(j=0; j<nSub; j++)
+            tmp = ccaddf(tmp, ccmulf(conjf(Vn_Y[j*nGrid_dirs+i]),Vn_Y[j*nGrid_dirs+i]));
+        h->job.pmap[i] = h->job.logScaleFlag ? logf(1.0f/(crealf(tmp)+2.23e-10f)) : 1.0f/(crealf(tmp)+2.23e-10f);
+    }
+}
 
 void generateMUSICmap
 (
+    void* const hWork,
     int order,
     float_complex* Cx,
     float_complex* Y_grid,
@@ -1248,46 +3291,59 @@ void generateMUSICmap
     float* pmap
 )
 {
-    int i, j, nSH;
-    float_complex* V, *Vn, *Vn_Y;
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    float_complex tmp;
+    pmapWorkspace_data *h;
+    int nSH;
     
     nSH = (order+1)*(order+1);
     nSources = MIN(nSources, nSH/2);
-    V = malloc1d(nSH*nSH*sizeof(float_complex));
-    Vn = malloc1d(nSH*(nSH-nSources)*sizeof(float_complex));
-    Vn_Y = malloc1d((nSH-nSources)*nGrid_dirs*sizeof(float_complex));
+    h = pmapWorkspace_get(hWork, order, nGrid_dirs);
     
-    /* obtain eigenvectors */
-    //utility_ceig(Cx, nSH, 1, NULL, V, NULL, NULL);
-	utility_cseig(Cx, nSH, 1, V, NULL, NULL);
-    
-    /* truncate, to obtain noise sub-space */
-	for (i = 0; i < nSH; i++)
-		for (j = 0; j < nSH - nSources; j++)
-			Vn[i*(nSH - nSources) + j] = V[i*nSH + j + nSources];
+    /* obtain the noise sub-space directly (i.e. only the eigenvectors
+     * corresponding to the nSH-nSources smallest eigenvalues) */
+    utility_cseigr(h->hSeigr, Cx, nSH, 0, nSH-nSources-1, 1, h->sub_Vn, NULL);
     
     /* derive the pseudo-spectrum value for each grid direction */
-    cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH-nSources, nGrid_dirs, nSH, &calpha,
-                Vn, nSH-nSources,
-                Y_grid, nGrid_dirs, &cbeta,
-                Vn_Y, nGrid_dirs);
-    for(i=0; i<nGrid_dirs; i++){
-        tmp = cmplxf(0.0f,0.0f);
-        for(j=0; j<nSH-nSources; j++)
-            tmp = ccaddf(tmp, ccmulf(conjf(Vn_Y[j*nGrid_dirs+i]),Vn_Y[j*nGrid_dirs+i]));
-        pmap[i] = logScaleFlag ? logf(1.0f/(crealf(tmp)+2.23e-10f)) : 1.0f/(crealf(tmp)+2.23e-10f);
-    }
+    h->job.nSH = nSH;
+    h->job.nSub = nSH-nSources;
+    h->job.nGrid_dirs = nGrid_dirs;
+    h->job.logScaleFlag = logScaleFlag;
+    h->job.W = Y_grid;
+    h->job.pmap = pmap;
+    saf_parfor_run(h->hParFor, &generateMUSICmap_range, (void*)h, nGrid_dirs);
     
-    free(V);
-    free(Vn);
-    free(Vn_Y);
+    if(hWork==NULL)
+        pmapWorkspace_destroy((void**)&h);
 }
 
+/** The MinNorm pseudo-spectrum for the grid directions [first, last) */
+static void generateMinNormMap_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    pmapWorkspace_data *h = (pmapWorkspace_data*)(hCtx);
+    int i, nSH, nGrid_dirs;
+    float_complex* Un_Y;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+
+    (void)threadIndex;
+    nSH = h->job.nSH;
+    nGrid_dirs = h->job.nGrid_dirs;
+    Un_Y = h->sub_Un_Y;
+    cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, 1, last-first, nSH, &calpha,
+                h->sub_Un, 1,
+                &(h->job.W[first]), nGrid_dirs, &cbeta,
+                &Un_Y[first], nGrid_dirs);
+    for(i=first; i<last; i++)
+        h->job.pmap[i] = h->job.logScaleFlag ? logf(1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f)) : 1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f);
+}
 
 void generateMinNormMap
 (
+    void* const hWork,
     int order,
     float_complex* Cx,
     float_complex* Y_grid,
@@ -1297,49 +3353,41 @@ void generateMinNormMap
     float* pmap
 )
 {
+    pmapWorkspace_data *h;
     int i, j, nSH;
-    float_complex* V, *Vn, *Vn1, *Un, *Un_Y;
+    float_complex* Vn, *Vn1, *Un;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float_complex Vn1_Vn1H;
     
     nSH = (order+1)*(order+1);
     nSources = MIN(nSources, nSH/2);
-    V = malloc1d(nSH*nSH*sizeof(float_complex));
-    Vn = malloc1d(nSH*(nSH-nSources)*sizeof(float_complex));
-    Vn1 = malloc1d((nSH-nSources)*sizeof(float_complex));
-    Un = malloc1d(nSH*sizeof(float_complex));
-    Un_Y = malloc1d(nGrid_dirs*sizeof(float_complex));
-    
-    /* obtain eigenvectors */
-    utility_ceig(Cx, nSH, 1, NULL, V, NULL, NULL);
+    h = pmapWorkspace_get(hWork, order, nGrid_dirs);
+    Vn = h->sub_Vn;
+    Vn1 = h->sub_Vn1;
+    Un = h->sub_Un;
     
-    /* truncate, to obtain noise sub-space */
-    for(i=0; i<nSH; i++)
-        for(j=0; j<nSH-nSources; j++)
-            Vn[i*(nSH-nSources)+j] = V[i*nSH + j + nSources];
+    /* obtain the noise sub-space directly (Cx is Hermitian) */
+    utility_cseigr(h->hSeigr, Cx, nSH, 0, nSH-nSources-1, 1, Vn, NULL);
     for(j=0; j<nSH-nSources; j++)
-        Vn1[j] = V[j + nSources];
+        Vn1[j] = Vn[j];
     
     /* derive the pseudo-spectrum value for each grid direction */
-    utility_cvvdot(Vn1, Vn1, nSH-nSources, NO_CONJ, &Vn1_Vn1H);
+    utility_cvvdot(Vn1, Vn1, nSH-nSources, CONJ, &Vn1_Vn1H);
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 1, nSH-nSources, &calpha,
                 Vn, nSH-nSources,
                 Vn1, nSH-nSources, &cbeta,
                 Un, 1);
     for(i=0; i<nSH; i++)
         Un[i] = ccdivf(Un[i], craddf(Vn1_Vn1H, 2.23e-9f));
-    cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, 1, nGrid_dirs, nSH, &calpha,
-                Un, 1,
-                Y_grid, nGrid_dirs, &cbeta,
-                Un_Y, nGrid_dirs);
-    for(i=0; i<nGrid_dirs; i++)
-        pmap[i] = logScaleFlag ? logf(1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f)) : 1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f);
+    h->job.nSH = nSH;
+    h->job.nGrid_dirs = nGrid_dirs;
+    h->job.logScaleFlag = logScaleFlag;
+    h->job.W = Y_grid;
+    h->job.pmap = pmap;
+    saf_parfor_run(h->hParFor, &generateMinNormMap_range, (void*)h, nGrid_dirs);
     
-    free(V);
-    free(Vn);
-    free(Vn1);
-    free(Un);
-    free(Un_Y);
+    if(hWork==NULL)
+        pmapWorkspace_destroy((void**)&h);
 }
 
 void bessel_Jn /* untested */
@@ -1483,13 +3531,13 @@ void bessel_jn
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(j_n!=NULL){
-                memset(&j_n[0], 0, (N+1)*sizeof(double));
-                j_n[0] = 1.0f;
+                memset(&j_n[i*(N+1)], 0, (N+1)*sizeof(double));
+                j_n[i*(N+1)] = 1.0f;
             }
             if(dj_n!=NULL){
-                memset(&dj_n[0], 0, (N+1)*sizeof(double));
+                memset(&dj_n[i*(N+1)], 0, (N+1)*sizeof(double));
                 if(N>0)
-                    dj_n[1] = 1.0/3.0;
+                    dj_n[i*(N+1)+1] = 1.0/3.0;
             }
         }
         else{
@@ -1538,11 +3586,11 @@ void bessel_in /* untested */
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(i_n!=NULL){
-                memset(&i_n[0], 0, (N+1)*sizeof(double));
-                i_n[0] = 1.0f;
+                memset(&i_n[i*(N+1)], 0, (N+1)*sizeof(double));
+                i_n[i*(N+1)] = 1.0f;
             }
             if(di_n!=NULL){
-                memset(&di_n[0], 0, (N+1)*sizeof(double));
+                memset(&di_n[i*(N+1)], 0, (N+1)*sizeof(double));
                 if(N>0)
                     di_n[1] = 1.0/3.0;
             }
@@ -1593,9 +3641,9 @@ void bessel_yn
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(y_n!=NULL)
-                memset(&y_n[0], 0, (N+1)*sizeof(double));
+                memset(&y_n[i*(N+1)], 0, (N+1)*sizeof(double));
             if(dy_n!=NULL)
-                memset(&dy_n[0], 0, (N+1)*sizeof(double));
+                memset(&dy_n[i*(N+1)], 0, (N+1)*sizeof(double));
         }
         else{
             SPHY(N, z[i], &NM, y_n_tmp, dy_n_tmp);
@@ -1643,9 +3691,9 @@ void bessel_kn /* untested */
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(k_n!=NULL)
-                memset(&k_n[0], 0, (N+1)*sizeof(double));
+                memset(&k_n[i*(N+1)], 0, (N+1)*sizeof(double));
             if(dk_n!=NULL)
-                memset(&dk_n[0], 0, (N+1)*sizeof(double));
+                memset(&dk_n[i*(N+1)], 0, (N+1)*sizeof(double));
         }
         else{
             SPHK(N, z[i], &NM, k_n_tmp, dk_n_tmp);
@@ -1695,11 +3743,11 @@ void hankel_hn1
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(h_n1!=NULL){
-                memset(&h_n1[0], 0, (N+1)*sizeof(double_complex));
-                h_n1[0] = cmplx(1.0, 0.0);
+                memset(&h_n1[i*(N+1)], 0, (N+1)*sizeof(double_complex));
+                h_n1[i*(N+1)] = cmplx(1.0, 0.0);
             }
             if(dh_n1!=NULL)
-                memset(&dh_n1[0], 0, (N+1)*sizeof(double_complex));
+                memset(&dh_n1[i*(N+1)], 0, (N+1)*sizeof(double_complex));
         }
         else{
             SPHJ(N, z[i], &NM1, j_n_tmp, dj_n_tmp);
@@ -1753,11 +3801,11 @@ void hankel_hn2
     for(i=0; i<nZ; i++){
         if(z[i] <= 1e-15){
             if(h_n2!=NULL){
-                memset(&h_n2[0], 0, (N+1)*sizeof(double_complex));
-                h_n2[0] = cmplx(1.0, 0.0);
+                memset(&h_n2[i*(N+1)], 0, (N+1)*sizeof(double_complex));
+                h_n2[i*(N+1)] = cmplx(1.0, 0.0);
             }
             if(dh_n2!=NULL)
-                memset(&dh_n2[0], 0, (N+1)*sizeof(double_complex));
+                memset(&dh_n2[i*(N+1)], 0, (N+1)*sizeof(double_complex));
         }
         else{
             SPHJ(N, z[i], &NM1, j_n_tmp, dj_n_tmp);
@@ -1778,16 +3826,343 @@ void hankel_hn2
             }
         }
     }
-    *maxN = *maxN==1e8 ? 0 : *maxN; /* maximum order that could be computed */
-#ifndef NDEBUG
-    if(*maxN<N)
-        saf_error_print(SAF_WARNING__UNABLE_TO_COMPUTE_BESSEL_FUNCTION_AT_SPECIFIED_ORDER);
-#endif
+    *maxN = *maxN==1e8 ? 0 : *maxN; /* maximum order that could be computed */
+#ifndef NDEBUG
+    if(*maxN<N)
+        saf_error_print(SAF_WARNING__UNABLE_TO_COMPUTE_BESSEL_FUNCTION_AT_SPECIFIED_ORDER);
+#endif
+    
+    free(j_n_tmp);
+    free(dj_n_tmp);
+    free(y_n_tmp);
+    free(dy_n_tmp);
+}
+
+/** Number of values stored per grid point and order: [jn jn' jn'' yn yn' yn''] */
+#define SPH_BESSEL_TABLE_NVALS ( 6 )
+
+/**
+ * Table values are only used for z >= SPH_BESSEL_TABLE_MIN_Z_FACTOR*(N+4)*step;
+ * below which the functions vary too rapidly (relative to their magnitude)
+ * for the interpolation to retain ~1e-9 relative accuracy
+ */
+#define SPH_BESSEL_TABLE_MIN_Z_FACTOR ( 5.0 )
+
+/**
+ * Data structure for the spherical Bessel function look-up table.
+ *
+ * Grid point k corresponds to z = k*step; and holds SPH_BESSEL_TABLE_NVALS
+ * values per order. The second derivatives are obtained from the spherical
+ * Bessel differential equation, f'' = -(2/z)f' + (n(n+1)/z^2 - 1)f, so that
+ * quintic Hermite interpolation may be used between grid points.
+ */
+typedef struct _sphBesselTable_data {
+    int maxN;
+    int nNodes;     /**< number of grid points */
+    int firstNode;  /**< first grid point from which all orders are held */
+    double step;    /**< grid spacing */
+    double maxZ;    /**< value of z at the last grid point */
+    double* vals;   /**< FLAT: nNodes x (maxN+1) x SPH_BESSEL_TABLE_NVALS */
+    
+}sphBesselTable_data;
+
+void sphBesselTable_create
+(
+    void ** const phTable,
+    int maxN,
+    double maxZ,
+    double step
+)
+{
+    *phTable = malloc1d(sizeof(sphBesselTable_data));
+    sphBesselTable_data *h = (sphBesselTable_data*)(*phTable);
+    int k, n, NMj, NMy;
+    double z, nn1;
+    double* sj, *dj, *sy, *dy, *v;
+    
+    h->maxN = maxN;
+    h->step = step;
+    h->nNodes = (int)ceil(maxZ/step) + 2;
+    h->maxZ = (double)(h->nNodes-1)*step;
+    h->vals = calloc1d(h->nNodes*(maxN+1)*SPH_BESSEL_TABLE_NVALS, sizeof(double));
+    sj = malloc1d((maxN+2)*sizeof(double)); /* (the recurrences write up to order 1) */
+    dj = malloc1d((maxN+2)*sizeof(double));
+    sy = malloc1d((maxN+2)*sizeof(double));
+    dy = malloc1d((maxN+2)*sizeof(double));
+    
+    /* tabulate the functions and their first two derivatives (z=0 is never used) */
+    h->firstNode = 1;
+    for(k=1; k<h->nNodes; k++){
+        z = (double)k*step;
+        SPHJ(maxN, z, &NMj, sj, dj);
+        SPHY(maxN, z, &NMy, sy, dy);
+        if(NMj<maxN || NMy<maxN){
+            h->firstNode = k+1; /* not all orders could be computed */
+            continue;
+        }
+        v = &(h->vals[k*(maxN+1)*SPH_BESSEL_TABLE_NVALS]);
+        for(n=0; n<=maxN; n++){
+            nn1 = (double)(n*(n+1));
+            v[0] = sj[n];
+            v[1] = dj[n];
+            v[2] = -2.0*dj[n]/z + (nn1/(z*z) - 1.0)*sj[n];
+            v[3] = sy[n];
+            v[4] = dy[n];
+            v[5] = -2.0*dy[n]/z + (nn1/(z*z) - 1.0)*sy[n];
+            v += SPH_BESSEL_TABLE_NVALS;
+        }
+    }
+    
+    free(sj);
+    free(dj);
+    free(sy);
+    free(dy);
+}
+
+void sphBesselTable_destroy
+(
+    void ** const phTable
+)
+{
+    sphBesselTable_data *h = (sphBesselTable_data*)(*phTable);
+    
+    if(h!=NULL){
+        free(h->vals);
+        free(h);
+        *phTable = NULL;
+    }
+}
+
+void sphBesselTable_getRange
+(
+    void * const hTable,
+    int* maxN,
+    double* maxZ
+)
+{
+    sphBesselTable_data *h = (sphBesselTable_data*)(hTable);
+    
+    (*maxN) = h->maxN;
+    (*maxZ) = h->maxZ;
+}
+
+/**
+ * Interpolates jn, yn and/or their derivatives for orders 0..N at z (any
+ * output may be NULL; each is (N+1) x 1)
+ *
+ * @returns 1 if the values were obtained from the table, or 0 if z or N are
+ *          outside of the range where the table is accurate (in which case,
+ *          nothing is written)
+ */
+static int sphBesselTable_lookup
+(
+    sphBesselTable_data* h,
+    int N,
+    double z,
+    double* j_n,
+    double* dj_n,
+    double* y_n,
+    double* dy_n
+)
+{
+    int k, n;
+    double x, t, t2, t3, t4, t5, s, s2;
+    double H0, H1, H2, H3, H4, H5, dH0, dH1, dH2, dH3, dH4, dH5;
+    const double* v0, *v1;
+    
+    if(h==NULL || N>h->maxN || z>=h->maxZ || z<SPH_BESSEL_TABLE_MIN_Z_FACTOR*(double)(N+4)*h->step)
+        return 0;
+    x = z/h->step;
+    k = (int)x;
+    if(k<h->firstNode)
+        return 0;
+    
+    /* quintic Hermite basis functions (and their derivatives), for the values
+     * (H0,H5), first derivatives (H1,H4) and second derivatives (H2,H3) at
+     * grid points k and k+1 */
+    t = x-(double)k;  t2 = t*t;  t3 = t2*t;  t4 = t3*t;  t5 = t4*t;
+    s = h->step;
+    s2 = s*s;
+    H0 = 1.0 - 10.0*t3 + 15.0*t4 - 6.0*t5;
+    H1 = s*(t - 6.0*t3 + 8.0*t4 - 3.0*t5);
+    H2 = s2*0.5*(t2 - 3.0*t3 + 3.0*t4 - t5);
+    H3 = s2*0.5*(t3 - 2.0*t4 + t5);
+    H4 = s*(-4.0*t3 + 7.0*t4 - 3.0*t5);
+    H5 = 10.0*t3 - 15.0*t4 + 6.0*t5;
+    dH0 = (-30.0*t2 + 60.0*t3 - 30.0*t4)/s;
+    dH1 = 1.0 - 18.0*t2 + 32.0*t3 - 15.0*t4;
+    dH2 = s*0.5*(2.0*t - 9.0*t2 + 12.0*t3 - 5.0*t4);
+    dH3 = s*0.5*(3.0*t2 - 8.0*t3 + 5.0*t4);
+    dH4 = -12.0*t2 + 28.0*t3 - 15.0*t4;
+    dH5 = (30.0*t2 - 60.0*t3 + 30.0*t4)/s;
+    
+    v0 = &(h->vals[k*(h->maxN+1)*SPH_BESSEL_TABLE_NVALS]);
+    v1 = v0 + (h->maxN+1)*SPH_BESSEL_TABLE_NVALS;
+    for(n=0; n<=N; n++){
+        if(j_n!=NULL)
+            j_n[n]  = H0*v0[0] + H1*v0[1] + H2*v0[2] + H5*v1[0] + H4*v1[1] + H3*v1[2];
+        if(dj_n!=NULL)
+            dj_n[n] = dH0*v0[0] + dH1*v0[1] + dH2*v0[2] + dH5*v1[0] + dH4*v1[1] + dH3*v1[2];
+        if(y_n!=NULL)
+            y_n[n]  = H0*v0[3] + H1*v0[4] + H2*v0[5] + H5*v1[3] + H4*v1[4] + H3*v1[5];
+        if(dy_n!=NULL)
+            dy_n[n] = dH0*v0[3] + dH1*v0[4] + dH2*v0[5] + dH5*v1[3] + dH4*v1[4] + dH3*v1[5];
+        v0 += SPH_BESSEL_TABLE_NVALS;
+        v1 += SPH_BESSEL_TABLE_NVALS;
+    }
+    return 1;
+}
+
+void sphBesselTable_jn
+(
+    void * const hTable,
+    int N,
+    double* z,
+    int nZ,
+    int* maxN,
+    double* j_n,
+    double* dj_n
+)
+{
+    sphBesselTable_data *h = (sphBesselTable_data*)(hTable);
+    int i, nMiss;
+    int* missIdx;
+    double* z_miss, *j_n_miss, *dj_n_miss;
+    
+    if(h==NULL){
+        bessel_jn(N, z, nZ, maxN, j_n, dj_n);
+        return;
+    }
+    *maxN = N;
+    missIdx = malloc1d(nZ*sizeof(int));
+    for(i=0, nMiss=0; i<nZ; i++)
+        if(!sphBesselTable_lookup(h, N, z[i], j_n==NULL ? NULL : &j_n[i*(N+1)], dj_n==NULL ? NULL : &dj_n[i*(N+1)], NULL, NULL))
+            missIdx[nMiss++] = i;
+    
+    /* any values outside of the table are computed directly (in one go) */
+    if(nMiss>0){
+        z_miss = malloc1d(nMiss*(2*N+3)*sizeof(double));
+        j_n_miss = &z_miss[nMiss];
+        dj_n_miss = &z_miss[nMiss*(N+2)];
+        for(i=0; i<nMiss; i++)
+            z_miss[i] = z[missIdx[i]];
+        bessel_jn(N, z_miss, nMiss, maxN, j_n==NULL ? NULL : j_n_miss, dj_n==NULL ? NULL : dj_n_miss);
+        for(i=0; i<nMiss; i++){
+            if(j_n!=NULL)
+                memcpy(&j_n[missIdx[i]*(N+1)], &j_n_miss[i*(N+1)], (N+1)*sizeof(double));
+            if(dj_n!=NULL)
+                memcpy(&dj_n[missIdx[i]*(N+1)], &dj_n_miss[i*(N+1)], (N+1)*sizeof(double));
+        }
+        free(z_miss);
+    }
+    free(missIdx);
+}
+
+void sphBesselTable_yn
+(
+    void * const hTable,
+    int N,
+    double* z,
+    int nZ,
+    int* maxN,
+    double* y_n,
+    double* dy_n
+)
+{
+    sphBesselTable_data *h = (sphBesselTable_data*)(hTable);
+    int i, nMiss;
+    int* missIdx;
+    double* z_miss, *y_n_miss, *dy_n_miss;
+    
+    if(h==NULL){
+        bessel_yn(N, z, nZ, maxN, y_n, dy_n);
+        return;
+    }
+    *maxN = N;
+    missIdx = malloc1d(nZ*sizeof(int));
+    for(i=0, nMiss=0; i<nZ; i++)
+        if(!sphBesselTable_lookup(h, N, z[i], NULL, NULL, y_n==NULL ? NULL : &y_n[i*(N+1)], dy_n==NULL ? NULL : &dy_n[i*(N+1)]))
+            missIdx[nMiss++] = i;
+    
+    /* any values outside of the table are computed directly (in one go) */
+    if(nMiss>0){
+        z_miss = malloc1d(nMiss*(2*N+3)*sizeof(double));
+        y_n_miss = &z_miss[nMiss];
+        dy_n_miss = &z_miss[nMiss*(N+2)];
+        for(i=0; i<nMiss; i++)
+            z_miss[i] = z[missIdx[i]];
+        bessel_yn(N, z_miss, nMiss, maxN, y_n==NULL ? NULL : y_n_miss, dy_n==NULL ? NULL : dy_n_miss);
+        for(i=0; i<nMiss; i++){
+            if(y_n!=NULL)
+                memcpy(&y_n[missIdx[i]*(N+1)], &y_n_miss[i*(N+1)], (N+1)*sizeof(double));
+            if(dy_n!=NULL)
+                memcpy(&dy_n[missIdx[i]*(N+1)], &dy_n_miss[i*(N+1)], (N+1)*sizeof(double));
+        }
+        free(z_miss);
+    }
+    free(missIdx);
+}
+
+void sphBesselTable_hn2
+(
+    void * const hTable,
+    int N,
+    double* z,
+    int nZ,
+    int* maxN,
+    double_complex* h_n2,
+    double_complex* dh_n2
+)
+{
+    sphBesselTable_data *h = (sphBesselTable_data*)(hTable);
+    int i, n, nMiss;
+    int* missIdx;
+    double* j_n, *dj_n, *y_n, *dy_n, *z_miss;
+    double_complex* h_n2_miss, *dh_n2_miss;
+    
+    if(h==NULL){
+        hankel_hn2(N, z, nZ, maxN, h_n2, dh_n2);
+        return;
+    }
+    *maxN = N;
+    missIdx = malloc1d(nZ*sizeof(int));
+    j_n = malloc1d(4*(N+1)*sizeof(double));
+    dj_n = &j_n[N+1];
+    y_n = &j_n[2*(N+1)];
+    dy_n = &j_n[3*(N+1)];
+    for(i=0, nMiss=0; i<nZ; i++){
+        if(sphBesselTable_lookup(h, N, z[i], h_n2==NULL ? NULL : j_n, dh_n2==NULL ? NULL : dj_n,
+                                 h_n2==NULL ? NULL : y_n, dh_n2==NULL ? NULL : dy_n)){
+            for(n=0; n<N+1; n++){
+                if(h_n2!=NULL)
+                    h_n2 [i*(N+1)+n] = cmplx(j_n[n], -y_n[n]);
+                if(dh_n2!=NULL)
+                    dh_n2[i*(N+1)+n] = cmplx(dj_n[n], -dy_n[n]);
+            }
+        }
+        else
+            missIdx[nMiss++] = i;
+    }
     
-    free(j_n_tmp);
-    free(dj_n_tmp);
-    free(y_n_tmp);
-    free(dy_n_tmp);
+    /* any values outside of the table are computed directly (in one go) */
+    if(nMiss>0){
+        z_miss = malloc1d(nMiss*sizeof(double));
+        h_n2_miss = malloc1d(2*nMiss*(N+1)*sizeof(double_complex));
+        dh_n2_miss = &h_n2_miss[nMiss*(N+1)];
+        for(i=0; i<nMiss; i++)
+            z_miss[i] = z[missIdx[i]];
+        hankel_hn2(N, z_miss, nMiss, maxN, h_n2==NULL ? NULL : h_n2_miss, dh_n2==NULL ? NULL : dh_n2_miss);
+        for(i=0; i<nMiss; i++){
+            if(h_n2!=NULL)
+                memcpy(&h_n2[missIdx[i]*(N+1)], &h_n2_miss[i*(N+1)], (N+1)*sizeof(double_complex));
+            if(dh_n2!=NULL)
+                memcpy(&dh_n2[missIdx[i]*(N+1)], &dh_n2_miss[i*(N+1)], (N+1)*sizeof(double_complex));
+        }
+        free(z_miss);
+        free(h_n2_miss);
+    }
+    free(missIdx);
+    free(j_n);
 }
 
 void cylModalCoeffs
@@ -1893,8 +4268,21 @@ void sphArrayNoiseThreshold
     }
 }
 
-void sphModalCoeffs
+/** Returns 1i^n */
+static double_complex sph_i_pow(int n)
+{
+    switch(n%4){
+        default:
+        case 0: return cmplx(1.0, 0.0);
+        case 1: return cmplx(0.0, 1.0);
+        case 2: return cmplx(-1.0, 0.0);
+        case 3: return cmplx(0.0, -1.0);
+    }
+}
+
+static void sphModalCoeffs_internal
 (
+    void* const hTable,
     int order,
     double* kr,
     int nBands,
@@ -1913,12 +4301,12 @@ void sphModalCoeffs
         case ARRAY_CONSTRUCTION_OPEN:
             /* compute spherical Bessels of the first kind */
             jn = malloc1d(nBands*(order+1)*sizeof(double));
-            bessel_jn(order, kr, nBands, &maxN, jn, NULL);
+            sphBesselTable_jn(hTable, order, kr, nBands, &maxN, jn, NULL);
             
             /* modal coefficients for open spherical array (omni sensors): 4*pi*1i^n * jn; */
             for(n=0; n<maxN+1; n++)
                 for(i=0; i<nBands; i++)
-                    b_N[i*(order+1)+n] = crmul(crmul(cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)), 4.0*M_PI), jn[i*(order+1)+n]);
+                    b_N[i*(order+1)+n] = crmul(crmul(sph_i_pow(n), 4.0*M_PI), jn[i*(order+1)+n]);
             
             free(jn);
             break;
@@ -1927,12 +4315,12 @@ void sphModalCoeffs
             /* compute spherical Bessels of the first kind + derivatives */
             jn = malloc1d(nBands*(order+1)*sizeof(double));
             jnprime = malloc1d(nBands*(order+1)*sizeof(double));
-            bessel_jn(order, kr, nBands, &maxN, jn, jnprime);
+            sphBesselTable_jn(hTable, order, kr, nBands, &maxN, jn, jnprime);
             
             /* modal coefficients for open spherical array (directional sensors): 4*pi*1i^n * (dirCoeff*jn - 1i*(1-dirCoeff)*jnprime); */
             for(n=0; n<maxN+1; n++)
                 for(i=0; i<nBands; i++)
-                    b_N[i*(order+1)+n] = ccmul(crmul(cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)), 4.0*M_PI), ccsub(cmplx(dirCoeff*jn[i*(order+1)+n], 0.0),
+                    b_N[i*(order+1)+n] = ccmul(crmul(sph_i_pow(n), 4.0*M_PI), ccsub(cmplx(dirCoeff*jn[i*(order+1)+n], 0.0),
                                          cmplx(0.0, (1.0-dirCoeff)*jnprime[i*(order+1)+n]))  );
             
             free(jn);
@@ -1950,9 +4338,9 @@ void sphModalCoeffs
             hn2 = malloc1d(nBands*(order+1)*sizeof(double_complex));
             hn2prime = malloc1d(nBands*(order+1)*sizeof(double_complex));
             maxN = 1000000000;
-            bessel_jn(order, kr, nBands, &maxN_tmp, jn, jnprime);
+            sphBesselTable_jn(hTable, order, kr, nBands, &maxN_tmp, jn, jnprime);
             maxN = MIN(maxN_tmp, maxN);
-            hankel_hn2(order, kr, nBands, &maxN_tmp, hn2, hn2prime);
+            sphBesselTable_hn2(hTable, order, kr, nBands, &maxN_tmp, hn2, hn2prime);
             maxN = MIN(maxN_tmp, maxN); /* maxN being the minimum highest order that was computed for all values in kr */
             
             /* modal coefficients for rigid spherical array: 4*pi*1i^n * (jn-(jnprime./hn2prime).*hn2); */
@@ -1963,7 +4351,7 @@ void sphModalCoeffs
                     else if(kr[i] <= 1e-20)
                         b_N[i*(order+1)+n] = cmplx(0.0, 0.0);
                     else{
-                        b_N[i*(order+1)+n] = ccmul(crmul(cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)), 4.0*M_PI), ( ccsub(cmplx(jn[i*(order+1)+n], 0.0),
+                        b_N[i*(order+1)+n] = ccmul(crmul(sph_i_pow(n), 4.0*M_PI), ( ccsub(cmplx(jn[i*(order+1)+n], 0.0),
                                              ccmul(ccdiv(cmplx(jnprime[i*(order+1)+n],0.0), hn2prime[i*(order+1)+n]), hn2[i*(order+1)+n]))));
                     }
                 }
@@ -1977,8 +4365,9 @@ void sphModalCoeffs
     }
 }
 
-void sphScattererModalCoeffs
+static void sphScattererModalCoeffs_internal
 (
+    void* const hTable,
     int order,
     double* kr,
     double* kR,
@@ -1996,13 +4385,13 @@ void sphScattererModalCoeffs
     hn2 = malloc1d(nBands*(order+1)*sizeof(double_complex));
     hn2prime = malloc1d(nBands*(order+1)*sizeof(double_complex));
     maxN = 1000000000;
-    bessel_jn(order, kr, nBands, &maxN_tmp, jn, NULL);
+    sphBesselTable_jn(hTable, order, kr, nBands, &maxN_tmp, jn, NULL);
     maxN = MIN(maxN_tmp, maxN);
-    bessel_jn(order, kR, nBands, &maxN_tmp, NULL, jnprime);
+    sphBesselTable_jn(hTable, order, kR, nBands, &maxN_tmp, NULL, jnprime);
     maxN = MIN(maxN_tmp, maxN);
-    hankel_hn2(order, kr, nBands, &maxN_tmp, hn2, NULL);
+    sphBesselTable_hn2(hTable, order, kr, nBands, &maxN_tmp, hn2, NULL);
     maxN = MIN(maxN_tmp, maxN);
-    hankel_hn2(order, kR, nBands, &maxN_tmp, NULL, hn2prime);
+    sphBesselTable_hn2(hTable, order, kR, nBands, &maxN_tmp, NULL, hn2prime);
     maxN = MIN(maxN_tmp, maxN); /* maxN being the minimum highest order that was computed for all values in kr */
     
     /* modal coefficients for rigid spherical array (OMNI): 4*pi*1i^n * (jn_kr-(jnprime_kr./hn2prime_kr).*hn2_kr); */
@@ -2014,7 +4403,7 @@ void sphScattererModalCoeffs
             else if(kr[i] <= 1e-20)
                 b_N[i*(order+1)+n] = cmplx(0.0, 0.0);
             else{
-                b_N[i*(order+1)+n] = ccmul(crmul(cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)), 4.0*M_PI), ( ccsub(cmplx(jn[i*(order+1)+n], 0.0),
+                b_N[i*(order+1)+n] = ccmul(crmul(sph_i_pow(n), 4.0*M_PI), ( ccsub(cmplx(jn[i*(order+1)+n], 0.0),
                                      ccmul(ccdiv(cmplx(jnprime[i*(order+1)+n],0.0), hn2prime[i*(order+1)+n]), hn2[i*(order+1)+n]))));
             }
         }
@@ -2026,8 +4415,9 @@ void sphScattererModalCoeffs
     free(hn2prime);
 }
 
-void sphScattererDirModalCoeffs
+static void sphScattererDirModalCoeffs_internal
 (
+    void* const hTable,
     int order,
     double* kr,
     double* kR,
@@ -2048,13 +4438,13 @@ void sphScattererDirModalCoeffs
     hn2prime_kr = malloc1d(nBands*(order+1)*sizeof(double_complex));
     hn2prime_kR = malloc1d(nBands*(order+1)*sizeof(double_complex));
     maxN = 1000000000;
-    bessel_jn(order, kr, nBands, &maxN_tmp, jn_kr, jnprime_kr);
+    sphBesselTable_jn(hTable, order, kr, nBands, &maxN_tmp, jn_kr, jnprime_kr);
     maxN = MIN(maxN_tmp, maxN);
-    bessel_jn(order, kR, nBands, &maxN_tmp, NULL, jnprime_kR);
+    sphBesselTable_jn(hTable, order, kR, nBands, &maxN_tmp, NULL, jnprime_kR);
     maxN = MIN(maxN_tmp, maxN);
-    hankel_hn2(order, kr, nBands, &maxN_tmp, hn2_kr, hn2prime_kr);
+    sphBesselTable_hn2(hTable, order, kr, nBands, &maxN_tmp, hn2_kr, hn2prime_kr);
     maxN = MIN(maxN_tmp, maxN);
-    hankel_hn2(order, kR, nBands, &maxN_tmp, NULL, hn2prime_kR);
+    sphBesselTable_hn2(hTable, order, kR, nBands, &maxN_tmp, NULL, hn2prime_kR);
     maxN = MIN(maxN_tmp, maxN); /* maxN being the minimum highest order that was computed for all values in kr */
     
     /* modal coefficients for rigid spherical array (OMNI): 4*pi*1i^n * (jn_kr-(jnprime_kr./hn2prime_kr).*hn2_kr); */
@@ -2076,10 +4466,10 @@ void sphScattererDirModalCoeffs
                 b_N[i*(order+1)+n] = cmplx(dirCoeff * jn_kr[i*(order+1)+n], -(1.0-dirCoeff)* jnprime_kr[i*(order+1)+n]);
                 b_N[i*(order+1)+n] = ccsub(b_N[i*(order+1)+n], ccmul(ccdiv(cmplx(jnprime_kR[i*(order+1)+n], 0.0), hn2prime_kR[i*(order+1)+n]),
                                     (ccsub(crmul(hn2_kr[i*(order+1)+n], dirCoeff), ccmul(cmplx(0.0f,1.0-dirCoeff), hn2prime_kr[i*(order+1)+n])))));
-                b_N[i*(order+1)+n] = crmul(ccmul(cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)), b_N[i*(order+1)+n]), 4.0*M_PI/dirCoeff); /* had to scale by directivity to preserve amplitude? */ 
+                b_N[i*(order+1)+n] = crmul(ccmul(sph_i_pow(n), b_N[i*(order+1)+n]), 4.0*M_PI/dirCoeff); /* had to scale by directivity to preserve amplitude? */ 
 //                b_N[i*(order+1)+n] = dirCoeff * jn_kr[i*(order+1)+n] - I*(1.0-dirCoeff)* jnprime_kr[i*(order+1)+n];
 //                b_N[i*(order+1)+n] = b_N[i*(order+1)+n] - (jnprime_kR[i*(order+1)+n]/hn2prime_kR[i*(order+1)+n])*(dirCoeff*hn2_kr[i*(order+1)+n] - I*(1.0-dirCoeff)*hn2prime_kr[i*(order+1)+n]);
-//                b_N[i*(order+1)+n] = cpow(cmplx(0.0,1.0), cmplx((double)n,0.0)) * b_N[i*(order+1)+n] * 4.0*M_PI/dirCoeff; /* had to scale by directivity to preserve amplitude? */
+//                b_N[i*(order+1)+n] = sph_i_pow(n) * b_N[i*(order+1)+n] * 4.0*M_PI/dirCoeff; /* had to scale by directivity to preserve amplitude? */
 //#endif
             }
         }
@@ -2093,6 +4483,85 @@ void sphScattererDirModalCoeffs
     free(hn2prime_kR);
 }
 
+void sphModalCoeffs
+(
+    int order,
+    double* kr,
+    int nBands,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    double dirCoeff,
+    double_complex* b_N
+)
+{
+    sphModalCoeffs_internal(NULL, order, kr, nBands, arrayType, dirCoeff, b_N);
+}
+
+void sphModalCoeffsTable
+(
+    void* const hTable,
+    int order,
+    double* kr,
+    int nBands,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    double dirCoeff,
+    double_complex* b_N
+)
+{
+    sphModalCoeffs_internal(hTable, order, kr, nBands, arrayType, dirCoeff, b_N);
+}
+
+void sphScattererModalCoeffs
+(
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    double_complex* b_N
+)
+{
+    sphScattererModalCoeffs_internal(NULL, order, kr, kR, nBands, b_N);
+}
+
+void sphScattererModalCoeffsTable
+(
+    void* const hTable,
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    double_complex* b_N
+)
+{
+    sphScattererModalCoeffs_internal(hTable, order, kr, kR, nBands, b_N);
+}
+
+void sphScattererDirModalCoeffs
+(
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    double dirCoeff,
+    double_complex* b_N
+)
+{
+    sphScattererDirModalCoeffs_internal(NULL, order, kr, kR, nBands, dirCoeff, b_N);
+}
+
+void sphScattererDirModalCoeffsTable
+(
+    void* const hTable,
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    double dirCoeff,
+    double_complex* b_N
+)
+{
+    sphScattererDirModalCoeffs_internal(hTable, order, kr, kR, nBands, dirCoeff, b_N);
+}
+
 void sphDiffCohMtxTheory
 (
     int order,
@@ -2106,10 +4575,10 @@ void sphDiffCohMtxTheory
     double* M_diffcoh
 )
 {
-    int i, j, k, n;
+    int i, j, k, n, p, nPairs;
     float cosangle;
-    float* sensor_dirs_xyz, *ppm, *ppm_z1, *ppm_z2;
-    double* b_N2, *Pn;
+    float* sensor_dirs_xyz;
+    double* b_N2, *Pn, *M_pairs;
     double_complex* b_N;
     
     /* sph->cart */
@@ -2136,28 +4605,40 @@ void sphDiffCohMtxTheory
     for(i=0; i<nBands * (order+1); i++)
         b_N2[i] = pow(cabs(ccdiv(b_N[i], cmplx(4.0*M_PI, 0.0))), 2.0);
     
-    /* determine theoretical diffuse-coherence matrix for sensor array */
-    ppm = malloc1d((order+1)*sizeof(float));
-    ppm_z1 = malloc1d((order+1)*sizeof(float));
-    ppm_z2 = malloc1d((order+1)*sizeof(float));
-    Pn = malloc1d((order+1)*sizeof(double));
-    for(i=0; i<N_sensors; i++){
-        for(j=i; j<N_sensors; j++){
+    /* Legendre polynomials of the angle between each pair of sensors, for all
+     * pairs at once: P_n(x) = ((2n-1) x P_(n-1)(x) - (n-1) P_(n-2)(x))/n */
+    nPairs = N_sensors*(N_sensors+1)/2;
+    Pn = malloc1d((order+1)*nPairs*sizeof(double));
+    for(i=0, p=0; i<N_sensors; i++){
+        for(j=i; j<N_sensors; j++, p++){
             cosangle = 0.0f;
             for(k=0; k<3; k++)
                 cosangle += sensor_dirs_xyz[j*3+k] * sensor_dirs_xyz[i*3+k];
             cosangle = cosangle>1.0f ? 1.0f : (cosangle<-1.0f ? -1.0f : cosangle);
-            for(n=0; n<order+1; n++){
-                unnorm_legendreP_recur(n, &cosangle, 1, ppm_z1, ppm_z2, ppm);  
-                Pn[n] =  (2.0*(double)n+1.0) * 4.0f*M_PI * (double)ppm[0];
-                memcpy(ppm_z2, ppm_z1, (order+1)*sizeof(float));
-                memcpy(ppm_z1, ppm, (order+1)*sizeof(float));
-            }
-            cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBands, 1, order+1, 1.0,
-                        b_N2, order+1,
-                        Pn, 1, 0.0,
-                        &M_diffcoh[j*N_sensors*nBands + i*nBands], 1);
-
+            Pn[p] = 1.0;
+            if(order>0)
+                Pn[nPairs+p] = (double)cosangle;
+        }
+    }
+    for(n=2; n<order+1; n++)
+        for(p=0; p<nPairs; p++)
+            Pn[n*nPairs+p] = ((2.0*(double)n-1.0) * Pn[nPairs+p] * Pn[(n-1)*nPairs+p]
+                              - ((double)n-1.0) * Pn[(n-2)*nPairs+p]) / (double)n;
+    for(n=0; n<order+1; n++)
+        for(p=0; p<nPairs; p++)
+            Pn[n*nPairs+p] *= (2.0*(double)n+1.0) * 4.0*M_PI;
+    
+    /* determine theoretical diffuse-coherence matrix for sensor array (all
+     * bands and pairs with a single matrix product) */
+    M_pairs = malloc1d(nBands*nPairs*sizeof(double));
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBands, nPairs, order+1, 1.0,
+                b_N2, order+1,
+                Pn, nPairs, 0.0,
+                M_pairs, nPairs);
+    for(i=0, p=0; i<N_sensors; i++){
+        for(j=i; j<N_sensors; j++, p++){
+            for(k=0; k<nBands; k++)
+                M_diffcoh[j*N_sensors*nBands + i*nBands + k] = M_pairs[k*nPairs+p];
             memcpy(&M_diffcoh[i*N_sensors*nBands + j*nBands], &M_diffcoh[j*N_sensors*nBands + i*nBands], nBands*sizeof(double));
         }
     }
@@ -2165,10 +4646,231 @@ void sphDiffCohMtxTheory
     free(b_N);
     free(b_N2);
     free(sensor_dirs_xyz);
-    free(ppm);
-    free(ppm_z1);
-    free(ppm_z2);
     free(Pn);
+    free(M_pairs);
+}
+
+/**
+ * An entry of the diffuse coherence matrix cache; keyed by the contents of the
+ * sensor directions and wavenumbers, and by the array settings
+ */
+typedef struct _sphDiffCohCache_entry {
+    int order, N_sensors, arrayType, nBands, hasKR;
+    double dirCoeff;
+    float* sensor_dirs_rad;            /**< copy of the directions; FLAT: N_sensors x 2 */
+    double* kr;                        /**< copy of kr; nBands x 1 */
+    double* kR;                        /**< copy of kR, or NULL; nBands x 1 */
+    double* M_diffcoh;                 /**< FLAT: N_sensors x N_sensors x nBands */
+    struct _sphDiffCohCache_entry* next;
+}sphDiffCohCache_entry;
+
+/* Most recently used first */
+static sphDiffCohCache_entry* sphDiffCohCache_head = NULL;
+#if defined(_WIN32)
+static SRWLOCK sphDiffCohCache_lock = SRWLOCK_INIT;
+# define SPH_DIFFCOH_CACHE_LOCK()   AcquireSRWLockExclusive(&sphDiffCohCache_lock)
+# define SPH_DIFFCOH_CACHE_UNLOCK() ReleaseSRWLockExclusive(&sphDiffCohCache_lock)
+#else
+static pthread_mutex_t sphDiffCohCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define SPH_DIFFCOH_CACHE_LOCK()   pthread_mutex_lock(&sphDiffCohCache_lock)
+# define SPH_DIFFCOH_CACHE_UNLOCK() pthread_mutex_unlock(&sphDiffCohCache_lock)
+#endif
+
+/** Frees an entry of the diffuse coherence matrix cache */
+static void sphDiffCohCache_freeEntry
+(
+    sphDiffCohCache_entry* e
+)
+{
+    free(e->sensor_dirs_rad);
+    free(e->kr);
+    free(e->kR);
+    free(e->M_diffcoh);
+    free(e);
+}
+
+void sphDiffCohMtxTheoryCached
+(
+    int order,
+    float* sensor_dirs_rad,
+    int N_sensors,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    double dirCoeff,
+    double* kr,
+    double* kR,
+    int nBands,
+    double* M_diffcoh
+)
+{
+    sphDiffCohCache_entry* e, *tail, **prev;
+    int n, hasKR;
+    size_t nBytes;
+
+    hasKR = kR!=NULL ? 1 : 0;
+    nBytes = N_sensors*N_sensors*nBands*sizeof(double);
+    SPH_DIFFCOH_CACHE_LOCK();
+    for(prev = &sphDiffCohCache_head, e = sphDiffCohCache_head; e!=NULL; prev = &(e->next), e = e->next){
+        if(e->order==order && e->N_sensors==N_sensors && e->arrayType==(int)arrayType && e->nBands==nBands &&
+           e->dirCoeff==dirCoeff && e->hasKR==hasKR &&
+           !memcmp(e->sensor_dirs_rad, sensor_dirs_rad, N_sensors*2*sizeof(float)) &&
+           !memcmp(e->kr, kr, nBands*sizeof(double)) &&
+           (!hasKR || !memcmp(e->kR, kR, nBands*sizeof(double)))){
+            /* move to the front */
+            *prev = e->next;
+            e->next = sphDiffCohCache_head;
+            sphDiffCohCache_head = e;
+            memcpy(M_diffcoh, e->M_diffcoh, nBytes);
+            SPH_DIFFCOH_CACHE_UNLOCK();
+            return;
+        }
+    }
+
+    /* not cached yet; (the lock is held while computing) */
+    e = (sphDiffCohCache_entry*)malloc1d(sizeof(sphDiffCohCache_entry));
+    e->order = order;
+    e->N_sensors = N_sensors;
+    e->arrayType = (int)arrayType;
+    e->nBands = nBands;
+    e->dirCoeff = dirCoeff;
+    e->hasKR = hasKR;
+    e->sensor_dirs_rad = malloc1d(N_sensors*2*sizeof(float));
+    memcpy(e->sensor_dirs_rad, sensor_dirs_rad, N_sensors*2*sizeof(float));
+    e->kr = malloc1d(nBands*sizeof(double));
+    memcpy(e->kr, kr, nBands*sizeof(double));
+    e->kR = NULL;
+    if(hasKR){
+        e->kR = malloc1d(nBands*sizeof(double));
+        memcpy(e->kR, kR, nBands*sizeof(double));
+    }
+    e->M_diffcoh = malloc1d(nBytes);
+    sphDiffCohMtxTheory(order, sensor_dirs_rad, N_sensors, arrayType, dirCoeff, kr, kR, nBands, e->M_diffcoh);
+    memcpy(M_diffcoh, e->M_diffcoh, nBytes);
+    e->next = sphDiffCohCache_head;
+    sphDiffCohCache_head = e;
+
+    /* discard the least recently used matrices */
+    for(n=1, e = sphDiffCohCache_head; e!=NULL && n<SPH_DIFFCOH_CACHE_MAX_ENTRIES; n++)
+        e = e->next;
+    if(e!=NULL){
+        tail = e->next;
+        e->next = NULL;
+        while(tail!=NULL){
+            e = tail;
+            tail = tail->next;
+            sphDiffCohCache_freeEntry(e);
+        }
+    }
+    SPH_DIFFCOH_CACHE_UNLOCK();
+}
+
+void sphDiffCohMtxCache_clear(void)
+{
+    sphDiffCohCache_entry* e;
+
+    SPH_DIFFCOH_CACHE_LOCK();
+    while(sphDiffCohCache_head!=NULL){
+        e = sphDiffCohCache_head;
+        sphDiffCohCache_head = e->next;
+        sphDiffCohCache_freeEntry(e);
+    }
+    SPH_DIFFCOH_CACHE_UNLOCK();
+}
+
+int sphDiffCohMtxCache_getNumEntries(void)
+{
+    sphDiffCohCache_entry* e;
+    int n;
+
+    SPH_DIFFCOH_CACHE_LOCK();
+    for(n=0, e = sphDiffCohCache_head; e!=NULL; e = e->next)
+        n++;
+    SPH_DIFFCOH_CACHE_UNLOCK();
+    return n;
+}
+
+/** Maximum number of bands processed at once by each thread of the simulators */
+#define SIM_ARRAY_BAND_BLOCK ( 8 )
+
+/**
+ * Job shared by the threads of simulateSphArrayParallel() and
+ * simulateCylArrayParallel(). The array responses are given by
+ * H(band, j*N_srcs+i) = sum_n b_N(band,n) * A(n, j*N_srcs+i), where A is the
+ * (real-valued) angular-dependent part; and are computed as two real matrix
+ * products (for the real and imaginary parts of the modal coefficients), per
+ * block of bands, and per thread.
+ */
+typedef struct _simArray_job {
+    int order, nCols;           /**< nCols = N_sensors*N_srcs */
+    const double_complex* b_N;  /**< modal coefficients; FLAT: nBands x (order+1) */
+    const double* A;            /**< angular-dependent part; FLAT: (order+1) x nCols */
+    double** b_re, **b_im;      /**< per-thread scratch; SIM_ARRAY_BAND_BLOCK*(order+1) */
+    double** H_re, **H_im;      /**< per-thread scratch; SIM_ARRAY_BAND_BLOCK*nCols */
+    float_complex* H_array;     /**< FLAT: nBands x nCols */
+    
+}simArray_job;
+
+/** Computes the array responses for the bands [first, last) */
+static void simArray_bandRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    simArray_job* job = (simArray_job*)(hCtx);
+    int band, b0, nb, n, k, nCols;
+    double* b_re, *b_im, *H_re, *H_im;
+    
+    nCols = job->nCols;
+    b_re = job->b_re[threadIndex];
+    b_im = job->b_im[threadIndex];
+    H_re = job->H_re[threadIndex];
+    H_im = job->H_im[threadIndex];
+    for(b0=first; b0<last; b0+=SIM_ARRAY_BAND_BLOCK){
+        nb = MIN(SIM_ARRAY_BAND_BLOCK, last-b0);
+        for(band=0; band<nb; band++){
+            for(n=0; n<job->order+1; n++){
+                b_re[band*(job->order+1)+n] = creal(job->b_N[(b0+band)*(job->order+1)+n]);
+                b_im[band*(job->order+1)+n] = cimag(job->b_N[(b0+band)*(job->order+1)+n]);
+            }
+        }
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nb, nCols, job->order+1, 1.0,
+                    b_re, job->order+1,
+                    job->A, nCols, 0.0,
+                    H_re, nCols);
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nb, nCols, job->order+1, 1.0,
+                    b_im, job->order+1,
+                    job->A, nCols, 0.0,
+                    H_im, nCols);
+        
+        /* store array response per frequency, sensors and plane wave dirs */
+        for(band=0; band<nb; band++)
+            for(k=0; k<nCols; k++)
+                job->H_array[(b0+band)*nCols + k] = cmplxf((float)H_re[band*nCols+k], (float)H_im[band*nCols+k]);
+    }
+}
+
+/** Runs a simArray_job over all bands, with (temporary) per-thread scratch */
+static void simArray_run
+(
+    void* const hPar,
+    simArray_job* job,
+    int nBands
+)
+{
+    int nThreads;
+    
+    nThreads = saf_parfor_getNumThreads(hPar);
+    job->b_re = (double**)malloc2d(nThreads, SIM_ARRAY_BAND_BLOCK*(job->order+1), sizeof(double));
+    job->b_im = (double**)malloc2d(nThreads, SIM_ARRAY_BAND_BLOCK*(job->order+1), sizeof(double));
+    job->H_re = (double**)malloc2d(nThreads, SIM_ARRAY_BAND_BLOCK*(job->nCols), sizeof(double));
+    job->H_im = (double**)malloc2d(nThreads, SIM_ARRAY_BAND_BLOCK*(job->nCols), sizeof(double));
+    saf_parfor_run(hPar, &simArray_bandRange, (void*)job, nBands);
+    free(job->b_re);
+    free(job->b_im);
+    free(job->H_re);
+    free(job->H_im);
 }
 
 void simulateCylArray /*untested*/
@@ -2184,43 +4886,60 @@ void simulateCylArray /*untested*/
     float_complex* H_array
 )
 {
-    int i, j, n, band;
+    simulateCylArrayParallel(NULL, order, kr, nBands, sensor_dirs_rad, N_sensors,
+                             src_dirs_deg, N_srcs, arrayType, H_array);
+}
+
+void simulateCylArrayParallel /*untested*/
+(
+    void* const hPar,
+    int order,
+    double* kr,
+    int nBands,
+    float* sensor_dirs_rad,
+    int N_sensors,
+    float* src_dirs_deg,
+    int N_srcs,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    float_complex* H_array
+)
+{
+    int i, j, n, nCols;
     double angle;
-    double_complex* b_N, *C, *b_NC;
-    const double_complex calpha = cmplx(1.0, 0.0), cbeta = cmplx(0.0, 0.0);
+    double_complex* b_N;
+    double* C;
+    simArray_job job;
     
     /* calculate modal coefficients */
     b_N = malloc1d(nBands * (order+1) * sizeof(double_complex));
     cylModalCoeffs(order, kr, nBands, arrayType, b_N);
     
     /* Compute angular-dependent part of the array responses */
-    C = malloc1d((order+1)*N_sensors*sizeof(double_complex));
-    b_NC = malloc1d(nBands*N_sensors*sizeof(double_complex));
-    for(i=0; i<N_srcs; i++){
-        for(j=0; j<N_sensors; j++){
-            angle = sensor_dirs_rad[i*2] - src_dirs_deg[i*2]*M_PI/180.0;
+    nCols = N_sensors*N_srcs;
+    C = malloc1d((order+1)*nCols*sizeof(double));
+    for(j=0; j<N_sensors; j++){
+        for(i=0; i<N_srcs; i++){
+            angle = sensor_dirs_rad[j*2] - src_dirs_deg[i*2]*M_PI/180.0;
             for(n=0; n<order+1; n++){
                 /* Jacobi-Anger expansion */
                 if(n==0)
-                    C[n*N_sensors+j] = cmplx(1.0, 0.0);
+                    C[n*nCols + j*N_srcs+i] = 1.0;
                 else
-                    C[n*N_sensors+j] = cmplx(2.0*cos((double)n*angle), 0.0);
+                    C[n*nCols + j*N_srcs+i] = 2.0*cos((double)n*angle);
             }
         }
-        cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBands, N_sensors, order+1, &calpha,
-                    b_N, order+1,
-                    C, N_sensors, &cbeta,
-                    b_NC, N_sensors);
-        
-        /* store array response per frequency, sensors and plane wave dirs */
-        for(band=0; band<nBands; band++)
-            for(j=0; j<N_sensors; j++)
-                H_array[band*N_sensors*N_srcs + j*N_srcs + i] = cmplxf((float)creal(b_NC[band*N_sensors+j]), (float)cimag(b_NC[band*N_sensors+j]));
     }
     
+    /* array responses, split over the bands */
+    job.order = order;
+    job.nCols = nCols;
+    job.b_N = b_N;
+    job.A = C;
+    job.H_array = H_array;
+    simArray_run(hPar, &job, nBands);
+    
     free(b_N);
     free(C);
-    free(b_NC);
 }
 
 void simulateSphArray
@@ -2238,27 +4957,68 @@ void simulateSphArray
     float_complex* H_array
 )
 {
-    int i, j, n, band;
-    double dcosangle;
-    double *ppm;
+    simulateSphArrayParallel(NULL, NULL, order, kr, kR, nBands, sensor_dirs_rad, N_sensors,
+                             src_dirs_deg, N_srcs, arrayType, dirCoeff, H_array);
+}
+
+void simulateSphArrayTable
+(
+    void* const hTable,
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    float* sensor_dirs_rad,
+    int N_sensors,
+    float* src_dirs_deg,
+    int N_srcs,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    double dirCoeff,
+    float_complex* H_array
+)
+{
+    simulateSphArrayParallel(NULL, hTable, order, kr, kR, nBands, sensor_dirs_rad, N_sensors,
+                             src_dirs_deg, N_srcs, arrayType, dirCoeff, H_array);
+}
+
+void simulateSphArrayParallel
+(
+    void* const hPar,
+    void* const hTable,
+    int order,
+    double* kr,
+    double* kR,
+    int nBands,
+    float* sensor_dirs_rad,
+    int N_sensors,
+    float* src_dirs_deg,
+    int N_srcs,
+    ARRAY_CONSTRUCTION_TYPES arrayType,
+    double dirCoeff,
+    float_complex* H_array
+)
+{
+    int i, j, n, nCols;
+    double x, p_nm1, p_n, p_np1;
     float cosangle;
     float* U_sensors, *U_srcs;
-    double_complex* b_N, *P, *b_NP;
-    const double_complex calpha = cmplx(1.0, 0.0), cbeta = cmplx(0.0, 0.0);
+    double* P;
+    double_complex* b_N;
+    simArray_job job;
     
     /* calculate modal coefficients */
     b_N = malloc1d(nBands * (order+1) * sizeof(double_complex));
     switch (arrayType){
         case ARRAY_CONSTRUCTION_OPEN:
-            sphModalCoeffs(order, kr, nBands, ARRAY_CONSTRUCTION_OPEN, 1.0, b_N); break;
+            sphModalCoeffs_internal(hTable, order, kr, nBands, ARRAY_CONSTRUCTION_OPEN, 1.0, b_N); break;
         case ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL:
-            sphModalCoeffs(order, kr, nBands, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, dirCoeff, b_N); break;
+            sphModalCoeffs_internal(hTable, order, kr, nBands, ARRAY_CONSTRUCTION_OPEN_DIRECTIONAL, dirCoeff, b_N); break;
         case ARRAY_CONSTRUCTION_RIGID:
         case ARRAY_CONSTRUCTION_RIGID_DIRECTIONAL:
             if(kR==NULL)
-                sphModalCoeffs(order, kr, nBands, ARRAY_CONSTRUCTION_RIGID, 1.0, b_N); /* if kr==kR, dirCoeff is irrelevant */
+                sphModalCoeffs_internal(hTable, order, kr, nBands, ARRAY_CONSTRUCTION_RIGID, 1.0, b_N); /* if kr==kR, dirCoeff is irrelevant */
             else
-                sphScattererDirModalCoeffs(order, kr, kR, nBands, dirCoeff, b_N);
+                sphScattererDirModalCoeffs_internal(hTable, order, kr, kR, nBands, dirCoeff, b_N);
             break;
     }
     
@@ -2270,37 +5030,38 @@ void simulateSphArray
     for(i=0; i<N_srcs; i++)
         unitSph2Cart(src_dirs_deg[i*2]*M_PI/180.0f, src_dirs_deg[i*2+1]*M_PI/180.0f, (float*)&U_srcs[i*3]);
     
-    /* Compute angular-dependent part of the array responses */
-    ppm = malloc1d((order+1)*sizeof(double));
-    P = malloc1d((order+1)*N_sensors*sizeof(double_complex));
-    b_NP = malloc1d(nBands*N_sensors*sizeof(double_complex));
-    for(i=0; i<N_srcs; i++){
-        for(j=0; j<N_sensors; j++){
+    /* Compute angular-dependent part of the array responses; the Legendre
+     * polynomials of the angles between the sensors and plane waves, obtained
+     * via Bonnet's recursion: (n+1)P_{n+1}(x) = (2n+1)xP_n(x) - nP_{n-1}(x) */
+    nCols = N_sensors*N_srcs;
+    P = malloc1d((order+1)*nCols*sizeof(double));
+    for(j=0; j<N_sensors; j++){
+        for(i=0; i<N_srcs; i++){
             utility_svvdot((const float*)&U_sensors[j*3], (const float*)&U_srcs[i*3], 3, &cosangle);
+            x = (double)cosangle;
+            p_nm1 = 0.0;
+            p_n = 1.0;
             for(n=0; n<order+1; n++){
-                /* Legendre polynomials correspond to the angular dependency */
-                dcosangle = (double)cosangle;
-                unnorm_legendreP(n, &dcosangle, 1, ppm);
-                P[n*N_sensors+j] = cmplx((2.0*(double)n+1.0)/(4.0*M_PI) * ppm[0], 0.0);
+                P[n*nCols + j*N_srcs+i] = (2.0*(double)n+1.0)/(4.0*M_PI) * p_n;
+                p_np1 = ((2.0*(double)n+1.0)*x*p_n - (double)n*p_nm1)/((double)n+1.0);
+                p_nm1 = p_n;
+                p_n = p_np1;
             }
         }
-        cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBands, N_sensors, order+1, &calpha,
-                    b_N, order+1,
-                    P, N_sensors, &cbeta,
-                    b_NP, N_sensors);
-        
-        /* store array response per frequency, sensors and plane wave dirs */
-        for(band=0; band<nBands; band++)
-            for(j=0; j<N_sensors; j++)
-                H_array[band*N_sensors*N_srcs + j*N_srcs + i] = cmplxf((float)creal(b_NP[band*N_sensors+j]), (float)cimag(b_NP[band*N_sensors+j]));
     }
     
+    /* array responses, split over the bands */
+    job.order = order;
+    job.nCols = nCols;
+    job.b_N = b_N;
+    job.A = P;
+    job.H_array = H_array;
+    simArray_run(hPar, &job, nBands);
+    
     free(U_sensors);
     free(U_srcs);
     free(b_N);
-    free(ppm);
     free(P);
-    free(b_NP);
 }
 
 void evaluateSHTfilters
@@ -2319,20 +5080,22 @@ void evaluateSHTfilters
 #endif
 )
 {
-    int band, i, n, m, nSH, q;
+    int band, n, m, nSH, q;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float w_uni_grid, lSH_n, lSH_nm;
     float_complex cSH_n, cSH_nm, yre_yre_dot, yre_yid_dot;
-    float_complex *y_recon_kk, *y_recon_nm, *w_y_recon_nm, *y_ideal_nm, *MH_M, *EigV;
+    float_complex *y_recon_kk;
+#if 0
+    float_complex *MH_M, *EigV;
+#endif
     
     nSH = (order+1)*(order+1);
     w_uni_grid = 1.0f/(float)nDirs;
     y_recon_kk = malloc1d(nSH*nDirs*sizeof(float_complex));
-    y_recon_nm = malloc1d(nDirs*sizeof(float_complex));
-    w_y_recon_nm = malloc1d(nDirs*sizeof(float_complex));
-    y_ideal_nm = malloc1d(nDirs*sizeof(float_complex));
+#if 0
     MH_M = malloc1d(nSensors*nSensors*sizeof(float_complex));
     EigV = malloc1d(nSensors*nSensors*sizeof(float_complex));
+#endif
     for(band=0; band<nBands; band++){
         cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nDirs, nSensors, &calpha,
                     &M_array2SH[band*nSH*nSensors], nSensors,
@@ -2343,13 +5106,11 @@ void evaluateSHTfilters
             lSH_n = 0.0f;
             for(m=-n; m<=n; m++){
                 q = n*n+n+m;
-                for(i=0; i<nDirs; i++){
-                    y_recon_nm[i] = y_recon_kk[q*nDirs+i];
-                    w_y_recon_nm[i] = crmulf(y_recon_nm[i], w_uni_grid);
-                    y_ideal_nm[i] = Y_grid[q*nDirs+i];
-                }
-                utility_cvvdot(w_y_recon_nm, y_recon_nm, nDirs, CONJ, &yre_yre_dot);
-                utility_cvvdot(w_y_recon_nm, y_ideal_nm, nDirs, CONJ, &yre_yid_dot);
+                /* (the uniform grid weight is applied after the dot products) */
+                utility_cvvdot(&y_recon_kk[q*nDirs], &y_recon_kk[q*nDirs], nDirs, CONJ, &yre_yre_dot);
+                utility_cvvdot(&y_recon_kk[q*nDirs], &Y_grid[q*nDirs], nDirs, CONJ, &yre_yid_dot);
+                yre_yre_dot = crmulf(yre_yre_dot, w_uni_grid);
+                yre_yid_dot = crmulf(yre_yid_dot, w_uni_grid);
                 cSH_nm = ccdivf(yre_yid_dot, ccaddf(csqrtf(yre_yre_dot), cmplxf(2.23e-9f, 0.0f)));
                 cSH_n = ccaddf(cSH_n, cSH_nm);
                 lSH_nm = crealf(yre_yre_dot);
@@ -2367,16 +5128,128 @@ void evaluateSHTfilters
                     &M_array2SH[band*nSH*nSensors], nSensors,
                     &M_array2SH[band*nSH*nSensors], nSensors, &cbeta,
                     MH_M, nSensors);
-        utility_ceig(MH_M, nSensors, 1, NULL, NULL, EigV); /* eigenvalues in decending order */
+        utility_ceig(NULL, MH_M, nSensors, 1, NULL, NULL, EigV); /* eigenvalues in decending order */
         WNG[band] = 10.0f*log10f(crealf(EigV[0])+2.23e-9f);
     }
 #endif
     
     free(y_recon_kk);
-    free(y_recon_nm);
-    free(w_y_recon_nm);
-    free(y_ideal_nm);
+#if 0
     free(MH_M);
     free(EigV);
+#endif
+}
+
+/** Workspace for measuredArrayEncodingFilters() */
+typedef struct _measuredArrayWorkspace_data {
+    int order, nSH, nSensors, nDirs;
+    float_complex* Y;   /**< SH of the measurement directions; FLAT: nSH x nDirs */
+    float_complex* A;   /**< H*H' + lambda*I; FLAT: nSensors x nSensors */
+    float_complex* B;   /**< H*Y'; FLAT: nSensors x nSH */
+    float_complex* X;   /**< A\\B, i.e. W'; FLAT: nSensors x nSH */
+    void* hSolver;      /**< utility_cslslv() workspace */
+
+}measuredArrayWorkspace_data;
+
+void measuredArrayWorkspace_create
+(
+    void ** const phWork,
+    int order,
+    int nSensors,
+    const float* dirs_deg,
+    int nDirs
+)
+{
+    measuredArrayWorkspace_data* h;
+    float* Y_real, *dirs_rad;
+    int i;
+
+    h = (measuredArrayWorkspace_data*)malloc1d(sizeof(measuredArrayWorkspace_data));
+    *phWork = (void*)h;
+    h->order = order;
+    h->nSH = (order+1)*(order+1);
+    h->nSensors = nSensors;
+    h->nDirs = nDirs;
+
+    /* N3D real SH (without the 1/sqrt(4*pi) term) of the measurement directions */
+    dirs_rad = malloc1d(nDirs*2*sizeof(float));
+    for(i=0; i<nDirs; i++){
+        dirs_rad[i*2+0] = dirs_deg[i*2+0] * M_PI/180.0f;
+        dirs_rad[i*2+1] = M_PI/2.0f - (dirs_deg[i*2+1] * M_PI/180.0f);
+    }
+    Y_real = malloc1d(h->nSH*nDirs*sizeof(float));
+    getSHreal(order, dirs_rad, nDirs, Y_real);
+    h->Y = malloc1d(h->nSH*nDirs*sizeof(float_complex));
+    for(i=0; i<h->nSH*nDirs; i++)
+        h->Y[i] = cmplxf(sqrtf(4.0f*M_PI)*Y_real[i], 0.0f);
+    free(dirs_rad);
+    free(Y_real);
+    h->A = malloc1d(nSensors*nSensors*sizeof(float_complex));
+    h->B = malloc1d(nSensors*(h->nSH)*sizeof(float_complex));
+    h->X = malloc1d(nSensors*(h->nSH)*sizeof(float_complex));
+    utility_cslslv_create(&(h->hSolver), nSensors, h->nSH);
+}
+
+void measuredArrayWorkspace_destroy
+(
+    void ** const phWork
+)
+{
+    measuredArrayWorkspace_data* h = (measuredArrayWorkspace_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->Y);
+        free(h->A);
+        free(h->B);
+        free(h->X);
+        utility_cslslv_destroy(&(h->hSolver));
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void measuredArrayEncodingFilters
+(
+    void* const hWork,
+    const float_complex* const* H,
+    int nBands,
+    float regPar,
+    int ldW,
+    int strideW,
+    float_complex* W
+)
+{
+    measuredArrayWorkspace_data* h = (measuredArrayWorkspace_data*)(hWork);
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    int band, i, q, Q, nSH;
+    float trace, lambda, regScale;
+
+    Q = h->nSensors;
+    nSH = h->nSH;
+    regScale = powf(10.0f, -regPar/10.0f);
+    for(band=0; band<nBands; band++){
+        /* A = H*H' + lambda*I, with lambda relative to the mean sensor energy */
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, Q, Q, h->nDirs, &calpha,
+                    H[band], h->nDirs,
+                    H[band], h->nDirs, &cbeta,
+                    h->A, Q);
+        for(q=0, trace=0.0f; q<Q; q++)
+            trace += crealf(h->A[q*Q+q]);
+        lambda = regScale*trace/(float)Q + 2.23e-9f;
+        for(q=0; q<Q; q++)
+            h->A[q*Q+q] = ccaddf(h->A[q*Q+q], cmplxf(lambda, 0.0f));
+
+        /* B = H*Y' (the SH are real) */
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasTrans, Q, nSH, h->nDirs, &calpha,
+                    H[band], h->nDirs,
+                    h->Y, h->nDirs, &cbeta,
+                    h->B, nSH);
+
+        /* W = (A\\B)' */
+        utility_cslslv(h->hSolver, h->A, Q, h->B, nSH, h->X);
+        for(i=0; i<nSH; i++)
+            for(q=0; q<Q; q++)
+                W[band*strideW + i*ldW + q] = conjf(h->X[q*nSH+i]);
+    }
 }
 
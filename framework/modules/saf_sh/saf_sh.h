@@ -41,6 +41,19 @@ extern "C" {
 
 #define ORDER2NSH(order) ((order+1)*(order+1))
 
+/**
+ * Components of an order with less than this fraction of the total energy of
+ * a block of SH signals (i.e. -120dB) are considered inactive by
+ * shOrderDetector_apply()
+ */
+#define SH_ORDER_DETECTOR_THRESHOLD ( 1e-12f )
+
+/**
+ * Recommended hold time (in seconds) of shOrderDetector_apply(), before an
+ * order found to be inactive is actually dropped
+ */
+#define SH_ORDER_DETECTOR_HOLD_TIME_S ( 0.5f )
+
 /* ========================================================================== */
 /*                                    Enums                                   */
 /* ========================================================================== */
@@ -74,6 +87,37 @@ typedef enum _SECTOR_PATTERNS{
     
 }SECTOR_PATTERNS;
 
+/**
+ * Compute back-ends for the scanning stage of the powermap/activity-map
+ * generators (see pmapWorkspace_setBackend())
+ */
+typedef enum _PMAP_BACKENDS{
+    PMAP_BACKEND_CPU = 1, /**< CBLAS, on the calling thread (default) */
+    PMAP_BACKEND_OPENCL   /**< OpenCL device (requires SAF_ENABLE_OPENCL) */
+    
+}PMAP_BACKENDS;
+
+/**
+ * Channel ordering conventions of the input of the shared analysis front-end
+ * (the values match the CH_ORDER enums of the SAF examples)
+ */
+typedef enum _SH_CH_ORDER{
+    SH_CH_ACN = 1, /**< Ambisonic Channel Numbering (ACN) */
+    SH_CH_FUMA     /**< (Legacy) Furse-Malham/B-format (WXYZ); first-order only */
+    
+}SH_CH_ORDER;
+
+/**
+ * Normalisation conventions of the input of the shared analysis front-end
+ * (the values match the NORM_TYPES enums of the SAF examples)
+ */
+typedef enum _SH_NORM_TYPES{
+    SH_NORM_N3D = 1, /**< orthonormalised (N3D) */
+    SH_NORM_SN3D,    /**< Schmidt semi-normalisation (SN3D) */
+    SH_NORM_FUMA     /**< (Legacy) Furse-Malham scaling; first-order only */
+    
+}SH_NORM_TYPES;
+
 
 /* ========================================================================== */
 /*                               Misc. Functions                              */
@@ -135,6 +179,52 @@ void unitCart2Sph_aziElev(/* Input Arguments */
                           float* azi_rad,
                           float* elev_rad);
 
+/**
+ * Converts many spherical coordinates to cartesian coordinates of unit length,
+ * as in unitSph2Cart(), but with the coordinates stored as separate vectors
+ * and the sines/cosines computed with utility_svsincosapprox() (accurate to
+ * ~1e-7)
+ *
+ * @param[in]  azi_rad  Azimuths in radians (|azi_rad| < 1e5); nDirs x 1
+ * @param[in]  elev_rad Elevations in radians (|elev_rad| < 1e5); nDirs x 1
+ * @param[in]  nDirs    Number of directions
+ * @param[out] x        x-coordinates (not the same as the inputs); nDirs x 1
+ * @param[out] y        y-coordinates (not the same as the inputs); nDirs x 1
+ * @param[out] z        z-coordinates (not the same as the inputs); nDirs x 1
+ */
+void unitSph2CartBatch(/* Input Arguments */
+                       float* azi_rad,
+                       float* elev_rad,
+                       int nDirs,
+                       /* Output Arguments */
+                       float* x,
+                       float* y,
+                       float* z);
+
+/**
+ * Converts many cartesian coordinates of unit length to spherical coordinates,
+ * as in unitCart2Sph(), but with the coordinates stored as separate vectors
+ * and the inverse tangents computed with utility_svatan2approx() (accurate to
+ * ~3e-7 radians)
+ *
+ * @param[in]  x        x-coordinates; nDirs x 1
+ * @param[in]  y        y-coordinates; nDirs x 1
+ * @param[in]  z        z-coordinates; nDirs x 1
+ * @param[in]  nDirs    Number of directions
+ * @param[out] azi_rad  Azimuths in radians (not the same as the inputs);
+ *                      nDirs x 1
+ * @param[out] elev_rad Elevations in radians (may be the same as 'z');
+ *                      nDirs x 1
+ */
+void unitCart2SphBatch(/* Input Arguments */
+                       float* x,
+                       float* y,
+                       float* z,
+                       int nDirs,
+                       /* Output Arguments */
+                       float* azi_rad,
+                       float* elev_rad);
+
 /**
  * Calculates unnormalised legendre polynomials up to order N, for all values in
  * vector x [1]
@@ -186,11 +276,35 @@ void unnorm_legendreP_recur(/* Input Arguments */
                             /* Output Arguments */
                             float* Pnm);
 
+/** Highest degree held by the table of SH normalisation factors */
+#define SH_NORM_TABLE_MAX_ORDER ( 64 )
+
+/**
+ * Returns the normalisation factors of the associated Legendre functions of
+ * degree n, for the orthonormal SH (WITH the 1/sqrt(4*pi) term), i.e.:
+ *     sqrt( (2n+1)/(4*pi) * (n-m)!/(n+m)! ),  for m = 0..n
+ *
+ * The factors for degrees up to SH_NORM_TABLE_MAX_ORDER are computed once (in
+ * a thread-safe manner) and then copied from a table; higher degrees are
+ * computed on each call. The ratio of factorials is accumulated term-by-term,
+ * so it does not overflow for high degrees.
+ *
+ * @param[in]  n    Degree
+ * @param[out] norm Normalisation factors; (n+1) x 1
+ */
+void getSHnorm(/* Input Arguments */
+               int n,
+               /* Output Arguments */
+               double* norm);
+
 
 /* ========================================================================== */
 /*                    SH and Beamforming related Functions                    */
 /* ========================================================================== */
 
+/** Maximum order supported by the order-specialised getSHreal_fast() kernels */
+#define SH_FAST_MAX_ORDER ( 7 )
+
 /**
  * Computes REAL spherical harmonics [1] for each direction on the sphere
  *
@@ -241,6 +355,56 @@ void getSHreal_recur(/* Input Arguments */
                      /* Output Arguments */
                      float* Y);
 
+/**
+ * Computes REAL spherical harmonics for each direction on the sphere, using
+ * order-specialised kernels (orders 0..SH_FAST_MAX_ORDER)
+ *
+ * The output is the same as getSHreal_recur(). However, the associated Legendre
+ * functions and the sin/cos azimuthal terms are computed together as
+ * polynomials of the unit Cartesian coordinates (i.e. no trigonometric
+ * functions are evaluated per order), and a separate kernel is compiled for
+ * each order, so that all of the loops over the degrees and orders are
+ * unrolled and the loop over the directions may be vectorised. The directions
+ * are processed in blocks, so no memory is allocated.
+ *
+ * @note Orders above SH_FAST_MAX_ORDER are passed to getSHreal_recur().
+ *
+ * @param[in]  order    Order of spherical harmonic expansion
+ * @param[in]  dirs_rad Directions on the sphere [azi, INCLINATION] convention,
+ *                      in RADIANS; FLAT: nDirs x 2
+ * @param[in]  nDirs    Number of directions
+ * @param[out] Y        The SH weights [WITH the 1/sqrt(4*pi)];
+ *                      FLAT: (order+1)^2 x nDirs
+ */
+void getSHreal_fast(/* Input Arguments */
+                    int order,
+                    float* dirs_rad,
+                    int nDirs,
+                    /* Output Arguments */
+                    float* Y);
+
+/**
+ * Computes REAL spherical harmonics for each direction on the sphere, given
+ * the directions as unit Cartesian coordinates in structure-of-arrays layout
+ * (see getSHreal_fast())
+ *
+ * @param[in]  order Order of spherical harmonic expansion; 0..SH_FAST_MAX_ORDER
+ * @param[in]  x     x coordinates (sin(incl)cos(azi)); nDirs x 1
+ * @param[in]  y     y coordinates (sin(incl)sin(azi)); nDirs x 1
+ * @param[in]  z     z coordinates (cos(incl)); nDirs x 1
+ * @param[in]  nDirs Number of directions
+ * @param[out] Y     The SH weights [WITH the 1/sqrt(4*pi)];
+ *                   FLAT: (order+1)^2 x nDirs
+ */
+void getSHreal_fastCart(/* Input Arguments */
+                        int order,
+                        float* x,
+                        float* y,
+                        float* z,
+                        int nDirs,
+                        /* Output Arguments */
+                        float* Y);
+
 /**
  * Computes COMPLEX spherical harmonics [1] for each direction on the sphere
  *
@@ -333,6 +497,208 @@ void getSHrotMtxReal(float R[3][3],
                      float* RotMtx,
                      int L);
 
+/**
+ * Creates an instance of a real-valued spherical harmonic rotation matrix
+ * generator, for repeated (allocation-free) use of the recursion employed by
+ * getSHrotMtxReal()
+ *
+ * The u, v, w coefficients of the recursion (Table I in [1]) depend only on the
+ * degree and order indices, and are therefore computed here once, for all
+ * orders up to 'maxL'. All scratch memory is also allocated here.
+ *
+ * @param[in] phRot (&) address of the rotation matrix generator handle
+ * @param[in] maxL  Maximum order of spherical harmonic expansion
+ *
+ * @see [1] Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real
+ *          Spherical Harmonics. Direct Determination by Recursion Page:
+ *          Additions and Corrections. Journal of Physical Chemistry A, 102(45),
+ *          9099?9100.
+ */
+void shRotMtxReal_create(void ** const phRot,
+                         int maxL);
+
+/**
+ * Destroys an instance of the spherical harmonic rotation matrix generator
+ *
+ * @param[in] phRot (&) address of the rotation matrix generator handle
+ */
+void shRotMtxReal_destroy(void ** const phRot);
+
+/**
+ * Generates a real-valued spherical harmonic rotation matrix (the same as
+ * getSHrotMtxReal()), without any memory allocation
+ *
+ * @param[in]  hRot   rotation matrix generator handle
+ * @param[in]  R      zyx rotation matrix; 3 x 3
+ * @param[in]  L      Order of spherical harmonic expansion; L <= maxL
+ * @param[out] RotMtx SH domain rotation matrix; FLAT: (L+1)^2 x (L+1)^2
+ */
+void shRotMtxReal_compute(void * const hRot,
+                          float R[3][3],
+                          int L,
+                          float* RotMtx);
+
+/**
+ * Generates a batch of real-valued spherical harmonic rotation matrices (e.g.
+ * for all of the orientations of a head-tracking trajectory), without any
+ * memory allocation
+ *
+ * @param[in]  hRot   rotation matrix generator handle
+ * @param[in]  R      zyx rotation matrices; FLAT: nRot x 3 x 3
+ * @param[in]  nRot   Number of rotation matrices
+ * @param[in]  L      Order of spherical harmonic expansion; L <= maxL
+ * @param[out] RotMtx SH domain rotation matrices;
+ *                    FLAT: nRot x (L+1)^2 x (L+1)^2
+ */
+void shRotMtxReal_computeBatch(void * const hRot,
+                               float* R,
+                               int nRot,
+                               int L,
+                               float* RotMtx);
+
+/**
+ * Creates an instance of an effective order detector, which finds the highest
+ * order of spherical harmonic signals that actually carries any content (e.g.
+ * for first-order material played through a higher-order bus, where the
+ * higher-order channels are silent)
+ *
+ * @param[in] phDet      (&) address of the order detector handle
+ * @param[in] maxOrder   Maximum order of spherical harmonic expansion
+ * @param[in] holdLength Number of samples that an order must be inactive for
+ *                       (consecutively), before it is dropped
+ */
+void shOrderDetector_create(void ** const phDet,
+                            int maxOrder,
+                            int holdLength);
+
+/**
+ * Destroys an instance of the effective order detector
+ *
+ * @param[in] phDet (&) address of the order detector handle
+ */
+void shOrderDetector_destroy(void ** const phDet);
+
+/**
+ * Resets the effective order detector, such that all orders are active again
+ * (until they have been inactive for the new hold length)
+ *
+ * @param[in] hDet       order detector handle
+ * @param[in] holdLength Number of samples that an order must be inactive for,
+ *                       before it is dropped
+ */
+void shOrderDetector_reset(void * const hDet,
+                           int holdLength);
+
+/**
+ * Returns the effective order of a block of spherical harmonic signals
+ *
+ * An order is active if its components hold more than
+ * SH_ORDER_DETECTOR_THRESHOLD of the energy of the block. The effective order
+ * rises immediately (so no content is ever discarded), but only falls once the
+ * orders above have been inactive for the hold length; which should therefore
+ * also exceed the memory of any downstream processing (e.g. the filterbank
+ * tail, if the signals are then transformed into the time-frequency domain).
+ * All orders up to the returned order may then be processed as usual, while
+ * the components above may be taken to be zero.
+ *
+ * @param[in] hDet  order detector handle
+ * @param[in] inSH  Input SH signals; (order+1)^2 x len
+ * @param[in] order Order of the input signals; order <= maxOrder
+ * @param[in] len   Number of samples
+ * @returns Effective order; 0..order
+ */
+int shOrderDetector_apply(void * const hDet,
+                          float** inSH,
+                          int order,
+                          int len);
+
+/**
+ * Creates an instance of a spherical harmonic bus mixer, which sums a number of
+ * SH input streams of (possibly) different orders into one SH output stream,
+ * with a gain and an optional rotation per input
+ *
+ * Inputs of lower order than the output are upscaled (i.e. their higher-order
+ * components are taken to be zero) and inputs of higher order are truncated.
+ * Only the min(inputOrder, outOrder) orders of each input are processed, and
+ * the rotation is applied per order block (i.e. only dipoles are mixed with
+ * dipoles, quadrapoles with quadrapoles etc.), so the cost of an input scales
+ * with its own order rather than with the output order. The channel ordering
+ * (ACN) and normalisation conventions of the inputs and output must match.
+ *
+ * All inputs are initially disabled (order: -1) and unrotated; see
+ * shBusMixer_setInput() and shBusMixer_setInputRotation().
+ *
+ * @param[in] phMix        (&) address of the SH bus mixer handle
+ * @param[in] nInputs      Number of inputs
+ * @param[in] outOrder     Order of the output
+ * @param[in] maxBlockSize Maximum number of samples passed to
+ *                         shBusMixer_apply()
+ */
+void shBusMixer_create(void ** const phMix,
+                       int nInputs,
+                       int outOrder,
+                       int maxBlockSize);
+
+/**
+ * Destroys an instance of the SH bus mixer
+ *
+ * @param[in] phMix (&) address of the SH bus mixer handle
+ */
+void shBusMixer_destroy(void ** const phMix);
+
+/**
+ * Sets the order and gain of an input of the SH bus mixer
+ *
+ * @note Not thread-safe with respect to shBusMixer_apply().
+ *
+ * @param[in] hMix  SH bus mixer handle
+ * @param[in] input Input index; 0..nInputs-1
+ * @param[in] order Order of the input signals; -1 to disable the input
+ * @param[in] gain  Linear gain of the input; inputs with a gain of 0 are
+ *                  skipped
+ */
+void shBusMixer_setInput(void * const hMix,
+                         int input,
+                         int order,
+                         float gain);
+
+/**
+ * Sets the rotation of an input of the SH bus mixer
+ *
+ * The SH rotation matrix is computed here (without memory allocation), up to
+ * the orders of the input which reach the output. The rotation is therefore
+ * applied instantly, i.e. any smoothing of time-varying rotations is left to
+ * the caller.
+ *
+ * @note Not thread-safe with respect to shBusMixer_apply().
+ *
+ * @param[in] hMix  SH bus mixer handle
+ * @param[in] input Input index; 0..nInputs-1
+ * @param[in] R     zyx rotation matrix; 3 x 3 (see yawPitchRoll2Rzyx()), or
+ *                  NULL to disable the rotation of this input
+ */
+void shBusMixer_setInputRotation(void * const hMix,
+                                 int input,
+                                 float R[3][3]);
+
+/**
+ * Mixes the inputs of the SH bus mixer into the output
+ *
+ * The output is overwritten (not accumulated); and its components above the
+ * highest order of the enabled inputs are zero.
+ *
+ * @param[in]  hMix  SH bus mixer handle
+ * @param[in]  inSH  Input SH signals; nInputs x ((order+1)^2 x len), where
+ *                   'order' is the order set for each input (see
+ *                   shBusMixer_setInput()); NULL entries are skipped
+ * @param[in]  len   Number of samples; len <= maxBlockSize
+ * @param[out] outSH Output SH signals; (outOrder+1)^2 x len
+ */
+void shBusMixer_apply(void * const hMix,
+                      float*** inSH,
+                      int len,
+                      float** outSH);
+
 /**
  * Computes the matrices that generate the coefficients of the beampattern of
  * order (sectorOrder+1) that is essentially the product of a pattern of
@@ -354,6 +720,50 @@ void computeVelCoeffsMtx(/* Input Arguments */
                          /* Output Arguments */
                          float_complex* A_xyz);
 
+/**
+ * Creates the matrices of computeVelCoeffsMtx() in a sparse form, where only
+ * the nonzero coefficients are retained (stored row-wise, CSR-style)
+ *
+ * Since the product with a dipole couples each degree only to the adjacent
+ * degrees, there are only O((sectorOrder+1)^2) nonzero coefficients, rather
+ * than the O((sectorOrder+1)^4) of the dense matrices.
+ *
+ * @param[in] phVel       (&) address of the velocity coefficients handle
+ * @param[in] sectorOrder Order of patterns
+ */
+void velCoeffsMtx_create(/* Input Arguments */
+                         void** const phVel,
+                         int sectorOrder);
+
+/**
+ * Destroys an instance of the sparse velocity coefficients matrices
+ *
+ * @param[in] phVel (&) address of the velocity coefficients handle
+ */
+void velCoeffsMtx_destroy(/* Input Arguments */
+                          void** const phVel);
+
+/** Returns the number of nonzero velocity coefficients (of all three axes) */
+int velCoeffsMtx_getNumNonZeros(/* Input Arguments */
+                                void* const hVel);
+
+/**
+ * Applies the velocity coefficients matrices to K sets of (complex) pattern
+ * coefficients; i.e. velCoeffs(i*3+d,k) = sum_j A_xyz(i,j,d) c_nm(j,k)
+ *
+ * @param[in]  hVel      Velocity coefficients handle
+ * @param[in]  c_nm      Pattern coefficients; FLAT: (sectorOrder+1)^2 x K
+ * @param[in]  K         Number of columns
+ * @param[out] velCoeffs Velocity coefficients;
+ *                       FLAT: (sectorOrder+2)^2 x 3 x K
+ */
+void velCoeffsMtx_apply(/* Input Arguments */
+                        void* const hVel,
+                        float_complex* c_nm,
+                        int K,
+                        /* Output Arguments */
+                        float_complex* velCoeffs);
+
 /**
  * Computes the beamforming matrices of sector and velocity coefficients for
  * ENERGY-preserving (EP) sectors for real SH
@@ -522,6 +932,91 @@ void beamWeightsMaxEV(/* Input Arguments */
                       /* Output Arguments */
                       float* b_n);
 
+/**
+ * Returns the axisymmetric beamweights of a pattern (as
+ * beamWeightsHypercardioid2Spherical(), beamWeightsMaxEV() or
+ * beamWeightsCardioid2Spherical()); taken from a process-wide cache, which is
+ * shared with computeSectorCoeffsEPCached() and computeSectorCoeffsAPCached()
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       computes new coefficients; so do not call it from the audio thread.
+ *
+ * @param[in]  pattern SECTOR_PATTERN_PWD: hypercardioid, SECTOR_PATTERN_MAXRE:
+ *                     max energy-vector, SECTOR_PATTERN_CARDIOID: cardioid
+ * @param[in]  N       Order of spherical harmonic expansion
+ * @param[out] b_n     Beamformer weights; (N+1) x 1
+ */
+void beamWeightsCached(/* Input Arguments */
+                       SECTOR_PATTERNS pattern,
+                       int N,
+                       /* Output Arguments */
+                       float* b_n);
+
+/**
+ * Computes the sector coefficients for ENERGY-preserving sectors (as
+ * computeSectorCoeffsEP()); taken from a process-wide cache if they have
+ * already been computed for the same order, pattern and sector directions
+ *
+ * The sector directions are compared by their contents, not their address;
+ * and the velocity coefficients are computed internally (see
+ * computeVelCoeffsMtx()), if the sectors are not cached yet. The least
+ * recently used coefficients are discarded once the cache holds
+ * SH_COEFFS_CACHE_MAX_ENTRIES sets of them.
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       computes new coefficients; so do not call it from the audio thread.
+ *
+ * @param[in]  orderSec     Order of sector patterns
+ * @param[in]  pattern      See "SECTOR_PATTERNS" enum for the options
+ * @param[in]  sec_dirs_deg Sector directions [azi elev], in DEGREES;
+ *                          FLAT: nSecDirs x 2
+ * @param[in]  nSecDirs     Number of sectors
+ * @param[out] sectorCoeffs The sector coefficients;
+ *                          FLAT: (nSecDirs*4) x (orderSec+2)^2
+ * @returns                 Normalisation coefficient
+ */
+float computeSectorCoeffsEPCached(/* Input Arguments */
+                                  int orderSec,
+                                  SECTOR_PATTERNS pattern,
+                                  float* sec_dirs_deg,
+                                  int nSecDirs,
+                                  /* Output Arguments */
+                                  float* sectorCoeffs);
+
+/**
+ * Computes the sector coefficients for AMPLITUDE-preserving sectors (as
+ * computeSectorCoeffsAP()); taken from a process-wide cache if they have
+ * already been computed for the same order, pattern and sector directions
+ *
+ * @note See computeSectorCoeffsEPCached()
+ *
+ * @param[in]  orderSec     Order of sector patterns
+ * @param[in]  pattern      See "SECTOR_PATTERNS" enum for the options
+ * @param[in]  sec_dirs_deg Sector directions [azi elev], in DEGREES;
+ *                          FLAT: nSecDirs x 2
+ * @param[in]  nSecDirs     Number of sectors
+ * @param[out] sectorCoeffs The sector coefficients;
+ *                          FLAT: (nSecDirs*4) x (orderSec+2)^2
+ * @returns                 Normalisation coefficient
+ */
+float computeSectorCoeffsAPCached(/* Input Arguments */
+                                  int orderSec,
+                                  SECTOR_PATTERNS pattern,
+                                  float* sec_dirs_deg,
+                                  int nSecDirs,
+                                  /* Output Arguments */
+                                  float* sectorCoeffs);
+
+/** Maximum number of coefficient sets held by beamWeightsCached(),
+ *  computeSectorCoeffsEPCached() and computeSectorCoeffsAPCached() */
+#define SH_COEFFS_CACHE_MAX_ENTRIES ( 32 )
+
+/** Frees all of the beamweights and sector coefficients held by the cache */
+void shCoeffsCache_clear(void);
+
+/** Returns the number of coefficient sets currently cached */
+int shCoeffsCache_getNumEntries(void);
+
 /**
  * Generates beamforming coefficients for velocity patterns (REAL)
  *
@@ -586,6 +1081,46 @@ void beamWeightsVelocityPatternsComplex(/* Input Arguments */
                                         /* Output Arguments */
                                         float_complex* velCoeffs);
 
+/**
+ * Generates beamforming coefficients for velocity patterns (REAL), the same as
+ * beamWeightsVelocityPatternsReal(), but with the sparse velocity coefficients
+ * matrices of velCoeffsMtx_create()
+ *
+ * @param[in]  hVel      Velocity coefficients handle (of order=sectorOrder)
+ * @param[in]  b_n       Axisymmetric beamformer weights; (order+1) x 1
+ * @param[in]  azi_rad   Orientation, azimuth in RADIANS
+ * @param[in]  elev_rad  Orientation, ELEVATION in RADIANS
+ * @param[out] velCoeffs Beamforming coefficients for velocity patterns;
+ *                       FLAT: (order+2)^2 x 3
+ */
+void beamWeightsVelocityPatternsRealSparse(/* Input Arguments */
+                                           void* const hVel,
+                                           float* b_n,
+                                           float azi_rad,
+                                           float elev_rad,
+                                           /* Output Arguments */
+                                           float* velCoeffs);
+
+/**
+ * Generates beamforming coefficients for velocity patterns (COMPLEX), the same
+ * as beamWeightsVelocityPatternsComplex(), but with the sparse velocity
+ * coefficients matrices of velCoeffsMtx_create()
+ *
+ * @param[in]  hVel      Velocity coefficients handle (of order=sectorOrder)
+ * @param[in]  b_n       Axisymmetric beamformer weights; (order+1) x 1
+ * @param[in]  azi_rad   Orientation, azimuth in RADIANS
+ * @param[in]  elev_rad  Orientation, ELEVATION in RADIANS
+ * @param[out] velCoeffs Beamforming coefficients for velocity patterns;
+ *                       FLAT: (order+2)^2 x 3
+ */
+void beamWeightsVelocityPatternsComplexSparse(/* Input Arguments */
+                                              void* const hVel,
+                                              float* b_n,
+                                              float azi_rad,
+                                              float elev_rad,
+                                              /* Output Arguments */
+                                              float_complex* velCoeffs);
+
 /**
  * Generates spherical coefficients for a rotated axisymmetric pattern (REAL)
  *
@@ -626,17 +1161,234 @@ void rotateAxisCoeffsComplex(/* Input arguments */
                              /* Output arguments */
                              float_complex* c_nm);
 
+/**
+ * Generates spherical coefficients for a rotated axisymmetric pattern (REAL),
+ * for many look directions at once
+ *
+ * The output is the same as calling rotateAxisCoeffsReal() for each direction.
+ * However, the rotated coefficients are obtained directly as scaled real SHs of
+ * the look directions, which are computed in blocks using the order-specialised
+ * kernels of getSHreal_fastCart() (for orders up to SH_FAST_MAX_ORDER).
+ *
+ * @param[in]  order   Order of spherical harmonic expansion
+ * @param[in]  c_n     Coefficients describing a rotationally symmetric pattern
+ *                     order N, expressed as a sum of spherical harmonics of
+ *                     degree m=0; (N+1) x 1
+ * @param[in]  theta_0 POLAR rotation for each pattern, in RADIANS; nDirs x 1
+ * @param[in]  phi_0   Azimuthal rotation for each pattern, in RADIANS;
+ *                     nDirs x 1
+ * @param[in]  nDirs   Number of look directions
+ * @param[out] c_nm    Coefficients of the rotated patterns expressed as sums of
+ *                     SHs (one row per direction); FLAT: nDirs x (N+1)^2
+ */
+void rotateAxisCoeffsRealBatch(/* Input arguments */
+                               int order,
+                               float* c_n,
+                               float* theta_0,
+                               float* phi_0,
+                               int nDirs,
+                               /* Output arguments */
+                               float* c_nm);
+
+/**
+ * Creates a small cache of rotated axisymmetric pattern coefficients (REAL);
+ * intended for e.g. beams that are steered back and forth between the same
+ * directions
+ *
+ * The cache is direct-mapped, and directions are only matched exactly; so the
+ * output is always the same as rotateAxisCoeffsRealBatch().
+ *
+ * @param[in] phCache  (&) address of the cache handle
+ * @param[in] maxOrder Maximum order of the patterns
+ * @param[in] nEntries Number of directions that may be held
+ */
+void rotateAxisCoeffsCache_create(/* Input arguments */
+                                  void** const phCache,
+                                  int maxOrder,
+                                  int nEntries);
+
+/**
+ * Destroys an instance of the rotated axisymmetric pattern coefficients cache
+ *
+ * @param[in] phCache (&) address of the cache handle
+ */
+void rotateAxisCoeffsCache_destroy(/* Input arguments */
+                                   void** const phCache);
+
+/**
+ * Sets the pattern to be rotated; the cache is cleared if either the order or
+ * the coefficients differ from those currently set
+ *
+ * @param[in] hCache Cache handle
+ * @param[in] order  Order of the pattern; at most 'maxOrder'
+ * @param[in] c_n    Coefficients describing the rotationally symmetric
+ *                   pattern (see rotateAxisCoeffsReal()); (order+1) x 1
+ */
+void rotateAxisCoeffsCache_setPattern(/* Input arguments */
+                                      void* const hCache,
+                                      int order,
+                                      float* c_n);
+
+/**
+ * Returns the coefficients of the pattern rotated towards each look direction;
+ * taken from the cache if present, or otherwise computed (in blocks, with
+ * rotateAxisCoeffsRealBatch()) and then cached
+ *
+ * @note No memory is allocated for orders up to SH_FAST_MAX_ORDER.
+ *
+ * @param[in]  hCache  Cache handle
+ * @param[in]  theta_0 POLAR rotation for each pattern, in RADIANS; nDirs x 1
+ * @param[in]  phi_0   Azimuthal rotation for each pattern, in RADIANS;
+ *                     nDirs x 1
+ * @param[in]  nDirs   Number of look directions
+ * @param[out] c_nm    Coefficients of the rotated patterns (one row per
+ *                     direction); FLAT: nDirs x (order+1)^2
+ */
+void rotateAxisCoeffsCache_get(/* Input arguments */
+                               void* const hCache,
+                               float* theta_0,
+                               float* phi_0,
+                               int nDirs,
+                               /* Output arguments */
+                               float* c_nm);
+
+/**
+ * Creates a table of the (REAL) Gaunt coefficients, for taking the product of
+ * two spherical harmonic expansions
+ *
+ * The Gaunt coefficients,
+ *     G(q1,q2,q) = int Y_q1(x) Y_q2(x) Y_q(x) dx,
+ * are obtained (once) with a t-design of degree N1+N2+N, and only the nonzero
+ * entries are retained; stored row-wise (CSR-style) per output coefficient q.
+ * Therefore, applying the table costs only the nonzero entries of the tensor,
+ * rather than evaluating wigner_3j() for every (q1,q2,q) on each call.
+ *
+ * @note The SH are orthonormal and with the 1/sqrt(4*pi) term (see
+ *       getSHreal()). Hence, a = [sqrt(4*pi) 0 0 ...] is the unit function.
+ *       The orders are limited by N1+N2+N <= 100.
+ *
+ * @param[in] phProd (&) address of the SH product table handle
+ * @param[in] N1     Order of the first input expansion
+ * @param[in] N2     Order of the second input expansion
+ * @param[in] N      Order of the output (product) expansion; the product is
+ *                   truncated if N < N1+N2
+ */
+void shProduct_create(/* Input arguments */
+                      void** const phProd,
+                      int N1,
+                      int N2,
+                      int N);
+
+/**
+ * Destroys an instance of the SH product table
+ *
+ * @param[in] phProd (&) address of the SH product table handle
+ */
+void shProduct_destroy(/* Input arguments */
+                       void** const phProd);
+
+/**
+ * Returns the number of nonzero Gaunt coefficients held in the table
+ *
+ * @param[in] hProd SH product table handle
+ * @returns Number of nonzero entries
+ */
+int shProduct_getNumNonZeros(/* Input arguments */
+                             void* const hProd);
+
+/**
+ * Computes the SH coefficients of the product of two functions on the sphere,
+ * given their SH coefficients (REAL)
+ *
+ * @param[in]  hProd SH product table handle
+ * @param[in]  a     SH coefficients of the first function; (N1+1)^2 x 1
+ * @param[in]  b     SH coefficients of the second function; (N2+1)^2 x 1
+ * @param[out] c     SH coefficients of the product; (N+1)^2 x 1
+ */
+void shProduct_apply(/* Input arguments */
+                     void* const hProd,
+                     float* a,
+                     float* b,
+                     /* Output arguments */
+                     float* c);
+
+/**
+ * Returns the matrix which applies a spatial weighting (given by its SH
+ * coefficients), to SH signals (REAL)
+ *
+ * i.e. M*b == shProduct_apply(a, b). It holds for any number of signals, so
+ * frames of SH signals (e.g. for sector processing or SH-domain spatial
+ * filtering) may be weighted with a single cblas_sgemm() call.
+ *
+ * @param[in]  hProd SH product table handle
+ * @param[in]  a     SH coefficients of the weighting function; (N1+1)^2 x 1
+ * @param[out] M     Weighting matrix; FLAT: (N+1)^2 x (N2+1)^2
+ */
+void shProduct_getMtx(/* Input arguments */
+                      void* const hProd,
+                      float* a,
+                      /* Output arguments */
+                      float* M);
+
+/**
+ * Creates a workspace for checkCondNumberSHTReal()
+ *
+ * All intermediate buffers (and the SVD workspaces) are allocated here, so
+ * that the condition numbers may be evaluated repeatedly (e.g. within the
+ * loop of a grid or array optimisation) without allocating memory for each
+ * evaluation. New workspaces are single-threaded.
+ *
+ * @param[in] phWork     (&) address of workspace handle
+ * @param[in] maxOrder   Maximum order of spherical harmonic expansion
+ * @param[in] maxNumDirs Maximum number of directions
+ */
+void condNumberWorkspace_create(/* Input arguments */
+                                void ** const phWork,
+                                int maxOrder,
+                                int maxNumDirs);
+
+/**
+ * Destroys a workspace created with condNumberWorkspace_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void condNumberWorkspace_destroy(/* Input arguments */
+                                 void ** const phWork);
+
+/**
+ * Sets the number of threads over which the orders are split by
+ * checkCondNumberSHTReal() (each thread being given its own SVD workspace)
+ *
+ * @note This starts/stops worker threads and allocates memory
+ *
+ * @param[in] hWork    Workspace handle; see condNumberWorkspace_create()
+ * @param[in] nThreads Number of threads, including the calling thread; '1'
+ *                     single-threaded, or SAF_PARFOR_NUM_THREADS_AUTO
+ * @returns The number of threads that are actually in use
+ */
+int condNumberWorkspace_setNumThreads(/* Input arguments */
+                                      void* const hWork,
+                                      int nThreads);
+
 /**
  * Computes the condition numbers for a least-squares SHT
  *
+ * The (weighted) Gram matrix of the spherical harmonics is computed once, for
+ * the highest order; since, with the ACN ordering, the Gram matrix of each
+ * lower order is its leading (n+1)^2 x (n+1)^2 block. Only the SVDs of these
+ * blocks are then computed for each order.
+ *
+ * @param[in]  hWork    Workspace handle (see condNumberWorkspace_create()), or
+ *                      NULL to create a temporary one within the call
  * @param[in]  order    Order of spherical harmonic expansion
  * @param[in]  dirs_rad Directions on the sphere [azi, INCLINATION] convention,
  *                      in RADIANS; FLAT: nDirs x 2
  * @param[in]  nDirs    Number of directions
- * @param[in]  w        Integration weights; nDirs x 1
+ * @param[in]  w        Integration weights (or NULL); nDirs x 1
  * @param[out] cond_N   Condition numbers; (order+1) x 1
  */
 void checkCondNumberSHTReal(/* Input arguments */
+                            void* const hWork,
                             int order,
                             float* dirs_rad,
                             int nDirs,
@@ -649,10 +1401,93 @@ void checkCondNumberSHTReal(/* Input arguments */
 /*                     Localisation Functions in the  SHD                     */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for the powermap/activity-map generators below
+ *
+ * All intermediate buffers (and the workspaces of the linear solvers and
+ * eigen decompositions) are allocated here, so that the map generators may be
+ * called every frame without allocating memory. Passing NULL to the generators
+ * instead creates (and destroys) a temporary workspace within each call.
+ *
+ * @param[in] phWork         (&) address of workspace handle
+ * @param[in] maxOrder       Maximum analysis order
+ * @param[in] maxNumGridDirs Maximum number of grid directions
+ */
+void pmapWorkspace_create(/* Input arguments */
+                          void ** const phWork,
+                          int maxOrder,
+                          int maxNumGridDirs);
+
+/**
+ * Destroys a workspace created with pmapWorkspace_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void pmapWorkspace_destroy(/* Input arguments */
+                           void ** const phWork);
+
+/**
+ * Sets the number of threads over which the generators split their work
+ *
+ * The grid directions are divided into one contiguous range per thread (the
+ * calling thread taking the first), and each thread is given its own
+ * intermediate buffers and linear solver workspaces. The maps are therefore
+ * identical for any given number of threads. New workspaces are single-
+ * threaded.
+ *
+ * @note This starts/stops worker threads and allocates memory, so it should
+ *       not be called from the audio thread
+ *
+ * @param[in] hWork    Workspace handle; see pmapWorkspace_create()
+ * @param[in] nThreads Number of threads, including the calling thread; '1'
+ *                     single-threaded, or SAF_PARFOR_NUM_THREADS_AUTO
+ * @returns The number of threads that are actually in use
+ */
+int pmapWorkspace_setNumThreads(/* Input arguments */
+                                void* const hWork,
+                                int nThreads);
+
+/**
+ * Selects the compute back-end for the scanning stage of the generators, i.e.
+ * the quadratic form real(diag(W.'*Cx*W)) evaluated over all grid directions,
+ * which is shared by generatePWDmap(), generateMVDRmap() and
+ * generateCroPaCLCMVmap()
+ *
+ * With PMAP_BACKEND_OPENCL, the device buffers are allocated here for the
+ * workspace's maximum dimensions. The steering vectors given to
+ * generatePWDmap() are then uploaded only when a different 'Y_grid' pointer is
+ * passed (i.e. it is assumed that its contents do not change while it is in
+ * use); whereas the per-frame covariance matrix, and any MVDR/CroPaC weights,
+ * are uploaded with each call. If SAF_ENABLE_OPENCL is not defined, or no
+ * suitable OpenCL device could be initialised, then the CPU back-end is
+ * retained.
+ *
+ * @note This allocates (device) memory, so it should not be called from the
+ *       audio thread
+ *
+ * @param[in] hWork   Workspace handle; see pmapWorkspace_create()
+ * @param[in] backend Requested back-end (see "PMAP_BACKENDS" enum)
+ * @returns The back-end that is actually in use (see "PMAP_BACKENDS" enum)
+ */
+PMAP_BACKENDS pmapWorkspace_setBackend(/* Input arguments */
+                                       void* const hWork,
+                                       PMAP_BACKENDS backend);
+
+/**
+ * Informs the workspace that the contents of the 'Y_grid' matrix last passed
+ * to generatePWDmap() have changed; i.e. that any copy held by the compute
+ * back-end (see pmapWorkspace_setBackend()) must be uploaded again
+ *
+ * @param[in] hWork Workspace handle; see pmapWorkspace_create()
+ */
+void pmapWorkspace_invalidateCache(/* Input arguments */
+                                   void* const hWork);
+
 /**
  * Generates a powermap based on the energy of plane-wave decomposition (PWD)/
  * hyper-cardioid beamformers
  *
+ * @param[in]  hWork      Workspace handle (or NULL); see pmapWorkspace_create()
  * @param[in]  order      Analysis order
  * @param[in]  Cx         Correlation/covarience matrix;
  *                        FLAT: (order+1)^2 x (order+1)^2
@@ -662,6 +1497,7 @@ void checkCondNumberSHTReal(/* Input arguments */
  * @param[out] pmap       Resulting PWD powermap; nGrid_dirs x 1
  */
 void generatePWDmap(/* Input arguments */
+                    void* const hWork,
                     int order,
                     float_complex* Cx,
                     float_complex* Y_grid,
@@ -673,6 +1509,7 @@ void generatePWDmap(/* Input arguments */
  * Generates a powermap based on the energy of adaptive minimum variance
  * distortion-less response (MVDR) beamformers
  *
+ * @param[in]  hWork      Workspace handle (or NULL); see pmapWorkspace_create()
  * @param[in]  order      Analysis order
  * @param[in]  Cx         Correlation/covarience matrix;
  *                        FLAT: (order+1)^2 x (order+1)^2
@@ -685,6 +1522,7 @@ void generatePWDmap(/* Input arguments */
  *                        it's NULL; FLAT: nSH x nGrid_dirs || NULL
  */
 void generateMVDRmap(/* Input arguments */
+                     void* const hWork,
                      int order,
                      float_complex* Cx,
                      float_complex* Y_grid,
@@ -707,6 +1545,7 @@ void generateMVDRmap(/* Input arguments */
  * microphone array signal domain, like in the paper. Otherwise, the algorithm
  * is the same.
  *
+ * @param[in]  hWork      Workspace handle (or NULL); see pmapWorkspace_create()
  * @param[in]  order      Analysis order
  * @param[in]  Cx         Correlation/covarience matrix;
  *                        FLAT: (order+1)^2 x (order+1)^2
@@ -724,6 +1563,7 @@ void generateMVDRmap(/* Input arguments */
  *          Speech and Language Processing (TASLP), 24(9), 1507-1519.
  */
 void generateCroPaCLCMVmap(/* Input arguments */
+                           void* const hWork,
                            int order,
                            float_complex* Cx,
                            float_complex* Y_grid,
@@ -737,6 +1577,7 @@ void generateCroPaCLCMVmap(/* Input arguments */
  * Generates an activity-map based on the sub-space multiple-signal
  * classification (MUSIC) method
  *
+ * @param[in]  hWork        Workspace handle (or NULL); see pmapWorkspace_create()
  * @param[in]  order        Analysis order
  * @param[in]  Cx           Correlation/covarience matrix;
  *                          FLAT: (order+1)^2 x (order+1)^2
@@ -748,6 +1589,7 @@ void generateCroPaCLCMVmap(/* Input arguments */
  * @param[out] pmap         Resulting MUSIC pseudo-spectrum; nGrid_dirs x 1
  */
 void generateMUSICmap(/* Input arguments */
+                      void* const hWork,
                       int order,
                       float_complex* Cx,
                       float_complex* Y_grid,
@@ -761,6 +1603,7 @@ void generateMUSICmap(/* Input arguments */
  * Generates an activity-map based on the sub-space minimum-norm (MinNorm)
  * method
  *
+ * @param[in]  hWork        Workspace handle (or NULL); see pmapWorkspace_create()
  * @param[in]  order        Analysis order
  * @param[in]  Cx           Correlation/covarience matrix;
  *                          FLAT: (order+1)^2 x (order+1)^2
@@ -772,6 +1615,7 @@ void generateMUSICmap(/* Input arguments */
  * @param[out] pmap         Resulting MinNorm pseudo-spectrum; nGrid_dirs x 1
  */
 void generateMinNormMap(/* Input arguments */
+                        void* const hWork,
                         int order,
                         float_complex* Cx,
                         float_complex* Y_grid,
@@ -782,6 +1626,145 @@ void generateMinNormMap(/* Input arguments */
                         float* pmap);
 
 
+/* ========================================================================== */
+/*                       Shared Analysis Front-end (SHD)                      */
+/* ========================================================================== */
+
+/** Maximum number of analysers that may subscribe to one front-end */
+#define SH_FRONTEND_MAX_NUM_SUBSCRIBERS ( 8 )
+
+/**
+ * One analysed frame of spherical harmonic signals, as passed to the
+ * subscribers of the shared analysis front-end
+ *
+ * All signals are in ACN/N3D. Only the first nSH_active components carry
+ * content (see shOrderDetector_apply()); the others are zero.
+ */
+typedef struct _shFrontEnd_frame{
+    int order;            /**< Order of the frame; nSH = (order+1)^2 */
+    int nSH_active;       /**< Number of active SH components */
+    int frameSize;        /**< Number of samples in the frame */
+    int nBands;           /**< Number of afSTFT bands (hybrid-mode) */
+    int nTimeSlots;       /**< Number of time slots (hops) in the frame */
+    float** TD;           /**< Time-domain signals; nSH x frameSize */
+    float_complex* TF;    /**< TF-domain signals; FLAT: nBands x nSH x
+                           *   nTimeSlots */
+    float_complex** Cx;   /**< Covariance matrices over the frame (X*X', not
+                           *   scaled or averaged), in packed format (see
+                           *   utility_chpherk()); nBands x nSH*(nSH+1)/2;
+                           *   NULL if no subscriber asked for them */
+}shFrontEnd_frame;
+
+/**
+ * Prototype of a subscriber of the shared analysis front-end; called once per
+ * frame, in the order in which the subscribers were added
+ *
+ * The frame is passed as a void pointer, so that the headers of the analysers
+ * need not depend on saf_sh.h.
+ *
+ * @param[in] hAnalyser Handle of the analyser
+ * @param[in] hFrame    The current frame; a (const shFrontEnd_frame*), which is
+ *                      only valid during the call
+ */
+typedef void (*shFrontEnd_subscriber)(void* const hAnalyser,
+                                      const void* hFrame);
+
+/**
+ * Creates an instance of the shared analysis front-end
+ *
+ * When several analysers (e.g. powermap, sldoa and dirass) are given the same
+ * spherical harmonic signals, the front-end applies the channel/normalisation
+ * conversion, the effective order detection, the afSTFT and the covariance
+ * matrix computation only once per frame, and passes the results to each of
+ * its subscribers (each of which then applies its own temporal averaging and
+ * analysis). The input signals are buffered internally into frames of
+ * frameSize samples, so that any host block size may be used.
+ *
+ * @param[in] phFE      (&) address of front-end handle
+ * @param[in] hopSize   Hop size of the afSTFT (hybrid-mode), in samples
+ * @param[in] frameSize Frame size, in samples (multiple of hopSize)
+ * @param[in] maxOrder  Maximum order of the input signals
+ * @param[in] fs        Sampling rate, in Hz (for the order detector hold time)
+ */
+void shFrontEnd_create(/* Input arguments */
+                       void ** const phFE,
+                       int hopSize,
+                       int frameSize,
+                       int maxOrder,
+                       float fs);
+
+/**
+ * Destroys an instance of the shared analysis front-end (the subscribers are
+ * not destroyed)
+ *
+ * @param[in] phFE (&) address of front-end handle
+ */
+void shFrontEnd_destroy(/* Input arguments */
+                        void ** const phFE);
+
+/**
+ * Sets the order and the channel/normalisation conventions of the input signals
+ *
+ * @note Not thread safe; only change while the front-end is not analysing.
+ *
+ * @param[in] hFE        Front-end handle
+ * @param[in] order      Order of the input signals; 1..maxOrder
+ * @param[in] chOrdering Channel ordering convention (see SH_CH_ORDER)
+ * @param[in] norm       Normalisation convention (see SH_NORM_TYPES)
+ */
+void shFrontEnd_setInputFormat(/* Input arguments */
+                               void * const hFE,
+                               int order,
+                               SH_CH_ORDER chOrdering,
+                               SH_NORM_TYPES norm);
+
+/**
+ * Adds a subscriber, which is then called once per analysed frame
+ *
+ * @note Not thread safe; only add subscribers while the front-end is not
+ *       analysing.
+ *
+ * @param[in] hFE       Front-end handle
+ * @param[in] proc      Analysis function of the subscriber
+ * @param[in] hAnalyser Handle passed to the analysis function
+ * @param[in] needsCov  1: the subscriber uses the covariance matrices, 0: it
+ *                      does not (they are only computed if any subscriber
+ *                      needs them)
+ * @returns Index of the subscriber, or -1 if SH_FRONTEND_MAX_NUM_SUBSCRIBERS
+ *          has been reached
+ */
+int shFrontEnd_subscribe(/* Input arguments */
+                         void * const hFE,
+                         shFrontEnd_subscriber proc,
+                         void * const hAnalyser,
+                         int needsCov);
+
+/**
+ * Removes all subscriptions of an analyser
+ *
+ * @param[in] hFE       Front-end handle
+ * @param[in] hAnalyser Handle of the analyser
+ */
+void shFrontEnd_unsubscribe(/* Input arguments */
+                            void * const hFE,
+                            void * const hAnalyser);
+
+/**
+ * Analyses a block of spherical harmonic signals (any block size), calling
+ * the subscribers for each complete frame
+ *
+ * @param[in] hFE      Front-end handle
+ * @param[in] inputs   Input channel buffers; 2-D array: nInputs x nSamples
+ * @param[in] nInputs  Number of input channels
+ * @param[in] nSamples Number of samples in 'inputs'
+ */
+void shFrontEnd_analysis(/* Input arguments */
+                         void * const hFE,
+                         float ** const inputs,
+                         int nInputs,
+                         int nSamples);
+
+
 /* ========================================================================== */
 /*                   Cylindrical/Spherical Bessel Functions                   */
 /* ========================================================================== */
@@ -1018,6 +2001,125 @@ void hankel_hn2(/* Input arguments */
                 double_complex* h_n2,
                 double_complex* dh_n2);
 
+/**
+ * Creates a look-up table of the spherical Bessel functions of the first and
+ * second kind (jn and yn), and their derivatives, for orders 0..maxN on a
+ * uniform grid of z values spanning 0..maxZ
+ *
+ * The tabulated values are then used by e.g. sphBesselTable_jn(), which
+ * interpolate between the two nearest grid points with a quintic Hermite
+ * polynomial (the second derivatives being given by the spherical Bessel
+ * differential equation). This is accurate to roughly step^6/46080 (relative
+ * to the function magnitudes), and far cheaper to evaluate than the series/
+ * recurrences employed by bessel_jn() and bessel_yn(). Any orders or values of
+ * z for which the table would be inaccurate (i.e. z > maxZ, or small z where
+ * the functions vary rapidly relative to 'step', roughly z < 5*(N+4)*step)
+ * are computed directly instead.
+ *
+ * @param[in] phTable (&) address of the Bessel table handle
+ * @param[in] maxN    Highest function order in the table
+ * @param[in] maxZ    Highest value of z in the table
+ * @param[in] step    Grid spacing (e.g. 0.05)
+ */
+void sphBesselTable_create(void ** const phTable,
+                           int maxN,
+                           double maxZ,
+                           double step);
+
+/**
+ * Destroys an instance of the spherical Bessel function look-up table
+ *
+ * @param[in] phTable (&) address of the Bessel table handle
+ */
+void sphBesselTable_destroy(void ** const phTable);
+
+/**
+ * Returns the highest order and value of z held by a spherical Bessel function
+ * look-up table
+ *
+ * @param[in]  hTable Bessel table handle
+ * @param[out] maxN   (&) highest function order in the table
+ * @param[out] maxZ   (&) highest value of z in the table
+ */
+void sphBesselTable_getRange(void * const hTable,
+                             int* maxN,
+                             double* maxZ);
+
+/**
+ * Computes the spherical Bessel function of the first kind (the same as
+ * bessel_jn()), using a look-up table where possible
+ *
+ * @param[in]  hTable Bessel table handle (see sphBesselTable_create()); set to
+ *                    NULL to compute all values directly via bessel_jn()
+ * @param[in]  N      Function order (highest is ~30 given numerical precision)
+ * @param[in]  z      Input values; nZ x 1
+ * @param[in]  nZ     Number of input values
+ * @param[out] maxN   (&) maximum function order that could be computed <=N
+ * @param[out] j_n    Bessel values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ * @param[out] dj_n   Bessel derivative values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ */
+void sphBesselTable_jn(/* Input arguments */
+                       void * const hTable,
+                       int N,
+                       double* z,
+                       int nZ,
+                       /* Output arguments */
+                       int* maxN,
+                       double* j_n,
+                       double* dj_n);
+
+/**
+ * Computes the spherical Bessel function of the second kind (the same as
+ * bessel_yn()), using a look-up table where possible
+ *
+ * @param[in]  hTable Bessel table handle (see sphBesselTable_create()); set to
+ *                    NULL to compute all values directly via bessel_yn()
+ * @param[in]  N      Function order (highest is ~30 given numerical precision)
+ * @param[in]  z      Input values; nZ x 1
+ * @param[in]  nZ     Number of input values
+ * @param[out] maxN   (&) maximum function order that could be computed <=N
+ * @param[out] y_n    Bessel values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ * @param[out] dy_n   Bessel derivative values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ */
+void sphBesselTable_yn(/* Input arguments */
+                       void * const hTable,
+                       int N,
+                       double* z,
+                       int nZ,
+                       /* Output arguments */
+                       int* maxN,
+                       double* y_n,
+                       double* dy_n);
+
+/**
+ * Computes the spherical Hankel function of the second kind (the same as
+ * hankel_hn2()), using a look-up table where possible
+ *
+ * @param[in]  hTable Bessel table handle (see sphBesselTable_create()); set to
+ *                    NULL to compute all values directly via hankel_hn2()
+ * @param[in]  N      Function order (highest is ~30 given numerical precision)
+ * @param[in]  z      Input values; nZ x 1
+ * @param[in]  nZ     Number of input values
+ * @param[out] maxN   (&) maximum function order that could be computed <=N
+ * @param[out] h_n2   Hankel values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ * @param[out] dh_n2  Hankel derivative values (set as NULL if not required);
+ *                    FLAT: nZ x (N+1)
+ */
+void sphBesselTable_hn2(/* Input arguments */
+                        void * const hTable,
+                        int N,
+                        double* z,
+                        int nZ,
+                        /* Output arguments */
+                        int* maxN,
+                        double_complex* h_n2,
+                        double_complex* dh_n2);
+
 
 /* ========================================================================== */
 /*              Microphone/Hydrophone array processing functions              */
@@ -1159,6 +2261,77 @@ void sphScattererDirModalCoeffs(/* Input arguments */
                                 double dirCoeff,
                                 /* Output arguments */
                                 double_complex* b_N);
+
+/**
+ * Calculates the modal coefficients for open/rigid spherical arrays (the same
+ * as sphModalCoeffs()), with the spherical Bessel/Hankel functions taken from
+ * a look-up table where possible
+ *
+ * @param[in]  hTable    Bessel table handle (see sphBesselTable_create())
+ * @param[in]  order     Max order (highest is ~30 given numerical precision)
+ * @param[in]  kr        wavenumber*radius; nBands x 1
+ * @param[in]  nBands    Number of frequency bands/bins
+ * @param[in]  arrayType See 'ARRAY_CONSTRUCTION_TYPES' enum
+ * @param[in]  dirCoeff  Only for directional (open) arrays, 1: omni, 0.5: card,
+ *                       0:dipole
+ * @param[out] b_N       Modal coefficients per kr and 0:order;
+ *                       FLAT: nBands x (order+1)
+ */
+void sphModalCoeffsTable(/* Input arguments */
+                         void * const hTable,
+                         int order,
+                         double* kr,
+                         int nBands,
+                         ARRAY_CONSTRUCTION_TYPES arrayType,
+                         double dirCoeff,
+                         /* Output arguments */
+                         double_complex* b_N);
+
+/**
+ * Calculates the modal coefficients for a rigid spherical scatterer with
+ * omni-directional sensors (the same as sphScattererModalCoeffs()), with the
+ * spherical Bessel/Hankel functions taken from a look-up table where possible
+ *
+ * @param[in]  hTable Bessel table handle (see sphBesselTable_create())
+ * @param[in]  order  Max order (highest is ~30 given numerical precision)
+ * @param[in]  kr     wavenumber*array_radius; nBands x 1
+ * @param[in]  kR     wavenumber*scatterer_radius; nBands x 1
+ * @param[in]  nBands Number of frequency bands/bins
+ * @param[out] b_N    Modal coefficients per kr and 0:order;
+ *                    FLAT: nBands x (order+1)
+ */
+void sphScattererModalCoeffsTable(/* Input arguments */
+                                  void * const hTable,
+                                  int order,
+                                  double* kr,
+                                  double* kR,
+                                  int nBands,
+                                  /* Output arguments */
+                                  double_complex* b_N);
+
+/**
+ * Calculates the modal coefficients for a rigid spherical scatterer with
+ * directional sensors (the same as sphScattererDirModalCoeffs()), with the
+ * spherical Bessel/Hankel functions taken from a look-up table where possible
+ *
+ * @param[in]  hTable   Bessel table handle (see sphBesselTable_create())
+ * @param[in]  order    Max order (highest is ~30 given numerical precision)
+ * @param[in]  kr       wavenumber*array_radius; nBands x 1
+ * @param[in]  kR       wavenumber*scatterer_radius; nBands x 1
+ * @param[in]  nBands   Number of frequency bands/bins
+ * @param[in]  dirCoeff Directivity coefficient, 1: omni, 0.5: card, 0:dipole
+ * @param[out] b_N      Modal coefficients per kr and 0:order;
+ *                      FLAT: nBands x (order+1)
+ */
+void sphScattererDirModalCoeffsTable(/* Input arguments */
+                                     void * const hTable,
+                                     int order,
+                                     double* kr,
+                                     double* kR,
+                                     int nBands,
+                                     double dirCoeff,
+                                     /* Output arguments */
+                                     double_complex* b_N);
     
 /**
  * Calculates the theoretical diffuse coherence matrix for a spherical array
@@ -1190,6 +2363,56 @@ void sphDiffCohMtxTheory(/* Input arguments */
                          /* Output arguments */
                          double* M_diffcoh);
 
+/**
+ * Returns the theoretical diffuse coherence matrix for a spherical array (as
+ * sphDiffCohMtxTheory()); taken from a process-wide cache if it has already
+ * been computed for the same configuration
+ *
+ * This avoids recomputing the modal coefficients and sensor-pair Legendre
+ * polynomials each time an array is (re)configured. Sensor directions and
+ * wavenumbers are compared by their contents, not their address. The least
+ * recently used matrices are discarded once the cache holds
+ * SPH_DIFFCOH_CACHE_MAX_ENTRIES of them.
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       computes a new matrix; so do not call it from the audio thread.
+ *
+ * @param[in]  order           Max order (highest is ~30 given numerical
+ *                             precision)
+ * @param[in]  sensor_dirs_rad Spherical coords of the sensors in RADIANS,
+ *                             [azi ELEV]; FLAT: N_sensors x 2
+ * @param[in]  N_sensors       Number of sensors
+ * @param[in]  arrayType       See 'ARRAY_CONSTRUCTION_TYPES' enum
+ * @param[in]  dirCoeff        Only for directional (open) arrays, 1: omni,
+ *                             0.5: card, 0:dipole
+ * @param[in]  kr              wavenumber*sensor_radius; nBands x 1
+ * @param[in]  kR              wavenumber*scatterer_radius, set to NULL if not
+ *                             applicable; nBands x 1
+ * @param[in]  nBands          Number of frequency bands/bins
+ * @param[out] M_diffcoh       Theoretical diffuse coherence matrix per
+ *                             frequency; FLAT: N_sensors x N_sensors x nBands
+ */
+void sphDiffCohMtxTheoryCached(/* Input arguments */
+                               int order,
+                               float* sensor_dirs_rad,
+                               int N_sensors,
+                               ARRAY_CONSTRUCTION_TYPES arrayType,
+                               double dirCoeff,
+                               double* kr,
+                               double* kR,
+                               int nBands,
+                               /* Output arguments */
+                               double* M_diffcoh);
+
+/** Maximum number of matrices held by sphDiffCohMtxTheoryCached() */
+#define SPH_DIFFCOH_CACHE_MAX_ENTRIES ( 8 )
+
+/** Frees all of the diffuse coherence matrices held by the cache */
+void sphDiffCohMtxCache_clear(void);
+
+/** Returns the number of diffuse coherence matrices currently cached */
+int sphDiffCohMtxCache_getNumEntries(void);
+
 /**
  * Simulates a cylindrical microphone array, returning the transfer functions
  * for each (plane wave) source direction on the surface of the cylinder
@@ -1220,6 +2443,39 @@ void simulateCylArray(/* Input arguments */
                       /* Output arguments */
                       float_complex* H_array);
 
+/**
+ * Simulates a cylindrical microphone array (the same as simulateCylArray()),
+ * with the frequency bands split over the threads of a saf_parfor pool
+ *
+ * @param[in]  hPar            saf_parfor handle (see saf_parfor_create()); or
+ *                             NULL, to run on the calling thread only
+ * @param[in]  order           Max order (highest is ~30 given numerical
+ *                             precision)
+ * @param[in]  kr              wavenumber*radius; nBands x 1
+ * @param[in]  nBands          Number of frequency bands/bins
+ * @param[in]  sensor_dirs_rad Spherical coords of the sensors in RADIANS,
+ *                             [azi ELEV]; FLAT: N_sensors x 2
+ * @param[in]  N_sensors       Number of sensors
+ * @param[in]  src_dirs_deg    Spherical coords of the plane waves in DEGREES,
+ *                             [azi ELEV]; FLAT: N_srcs x 2
+ * @param[in]  N_srcs          Number sources (DoAs of plane waves)
+ * @param[in]  arrayType       See 'ARRAY_CONSTRUCTION_TYPES' enum
+ * @param[out] H_array         Simulated array response for each plane wave;
+ *                             FLAT: nBands x N_sensors x N_srcs
+ */
+void simulateCylArrayParallel(/* Input arguments */
+                              void * const hPar,
+                              int order,
+                              double* kr,
+                              int nBands,
+                              float* sensor_dirs_rad,
+                              int N_sensors,
+                              float* src_dirs_deg,
+                              int N_srcs,
+                              ARRAY_CONSTRUCTION_TYPES arrayType,
+                              /* Output arguments */
+                              float_complex* H_array);
+
 /**
  * Simulates a spherical microphone array, returning the transfer functions for
  * each (plane wave) source direction on the surface of the sphere
@@ -1256,6 +2512,89 @@ void simulateSphArray(/* Input arguments */
                       /* Output arguments */
                       float_complex* H_array);
 
+/**
+ * Simulates a spherical microphone array (the same as simulateSphArray()),
+ * with the spherical Bessel/Hankel functions taken from a look-up table where
+ * possible; e.g. for array design sweeps over many radii/frequencies
+ *
+ * @param[in]  hTable          Bessel table handle (see sphBesselTable_create())
+ * @param[in]  order           Max order (highest is ~30 given numerical
+ *                             precision)
+ * @param[in]  kr              wavenumber*array_radius; nBands x 1
+ * @param[in]  kR              wavenumber*scatterer_radius, set to NULL if not
+ *                             needed
+ * @param[in]  nBands          Number of frequency bands/bins
+ * @param[in]  sensor_dirs_rad Spherical coords of the sensors in RADIANS,
+ *                             [azi ELEV]; FLAT: N_sensors x 2
+ * @param[in]  N_sensors       Number of sensors
+ * @param[in]  src_dirs_deg    Spherical coords of the plane waves in DEGREES,
+ *                             [azi ELEV]; FLAT: N_srcs x 2
+ * @param[in]  N_srcs          Number sources (DoAs of plane waves)
+ * @param[in]  arrayType       See 'ARRAY_CONSTRUCTION_TYPES' enum
+ * @param[in]  dirCoeff        Only for directional (open) arrays, 1: omni,
+ *                             0.5: card, 0:dipole
+ * @param[out]  H_array        Simulated array response for each plane wave;
+ *                             FLAT: nBands x N_sensors x N_srcs
+ */
+void simulateSphArrayTable(/* Input arguments */
+                           void * const hTable,
+                           int order,
+                           double* kr,
+                           double* kR,
+                           int nBands,
+                           float* sensor_dirs_rad,
+                           int N_sensors,
+                           float* src_dirs_deg,
+                           int N_srcs,
+                           ARRAY_CONSTRUCTION_TYPES arrayType,
+                           double dirCoeff,
+                           /* Output arguments */
+                           float_complex* H_array);
+
+/**
+ * Simulates a spherical microphone array (the same as simulateSphArray()),
+ * with the frequency bands split over the threads of a saf_parfor pool, and
+ * (optionally) the spherical Bessel/Hankel functions taken from a look-up
+ * table
+ *
+ * @param[in]  hPar            saf_parfor handle (see saf_parfor_create()); or
+ *                             NULL, to run on the calling thread only
+ * @param[in]  hTable          Bessel table handle (see sphBesselTable_create());
+ *                             or NULL, to compute them directly
+ * @param[in]  order           Max order (highest is ~30 given numerical
+ *                             precision)
+ * @param[in]  kr              wavenumber*array_radius; nBands x 1
+ * @param[in]  kR              wavenumber*scatterer_radius, set to NULL if not
+ *                             needed
+ * @param[in]  nBands          Number of frequency bands/bins
+ * @param[in]  sensor_dirs_rad Spherical coords of the sensors in RADIANS,
+ *                             [azi ELEV]; FLAT: N_sensors x 2
+ * @param[in]  N_sensors       Number of sensors
+ * @param[in]  src_dirs_deg    Spherical coords of the plane waves in DEGREES,
+ *                             [azi ELEV]; FLAT: N_srcs x 2
+ * @param[in]  N_srcs          Number sources (DoAs of plane waves)
+ * @param[in]  arrayType       See 'ARRAY_CONSTRUCTION_TYPES' enum
+ * @param[in]  dirCoeff        Only for directional (open) arrays, 1: omni,
+ *                             0.5: card, 0:dipole
+ * @param[out]  H_array        Simulated array response for each plane wave;
+ *                             FLAT: nBands x N_sensors x N_srcs
+ */
+void simulateSphArrayParallel(/* Input arguments */
+                              void * const hPar,
+                              void * const hTable,
+                              int order,
+                              double* kr,
+                              double* kR,
+                              int nBands,
+                              float* sensor_dirs_rad,
+                              int N_sensors,
+                              float* src_dirs_deg,
+                              int N_srcs,
+                              ARRAY_CONSTRUCTION_TYPES arrayType,
+                              double dirCoeff,
+                              /* Output arguments */
+                              float_complex* H_array);
+
 /**
  * Generates some objective measures, which evaluate the performance of the
  * spatial encoding filters
@@ -1300,6 +2639,75 @@ void evaluateSHTfilters(/* Input arguments */
                         float* cSH,
                         float* lSH);
 
+/**
+ * Creates a workspace for measuredArrayEncodingFilters(), for a given order,
+ * number of sensors and set of measurement directions
+ *
+ * @param[in] phWork   (&) address of the workspace handle
+ * @param[in] order    Encoding order
+ * @param[in] nSensors Number of sensors
+ * @param[in] dirs_deg Measurement directions, [azi elev] in degrees;
+ *                     FLAT: nDirs x 2
+ * @param[in] nDirs    Number of measurement directions
+ */
+void measuredArrayWorkspace_create(/* Input arguments */
+                                   void ** const phWork,
+                                   int order,
+                                   int nSensors,
+                                   const float* dirs_deg,
+                                   int nDirs);
+
+/**
+ * Destroys a workspace created with measuredArrayWorkspace_create()
+ *
+ * @param[in] phWork (&) address of the workspace handle
+ */
+void measuredArrayWorkspace_destroy(/* Input arguments */
+                                    void ** const phWork);
+
+/**
+ * Computes spherical harmonic encoding matrices from measured array
+ * responses, by a regularised least-squares fit of the encoded responses to
+ * the real N3D spherical harmonics (without the 1/sqrt(4*pi) term) of the
+ * measurement directions [1], i.e.
+ * \code{.m}
+ *     W(:,:,band) = Y * H' / (H*H' + lambda*eye(nSensors));
+ *     lambda = 10^(-regPar/10) * trace(H*H')/nSensors;
+ * \endcode
+ * where H = H(:,:,band) are the responses of all sensors for all directions
+ *
+ * The Hermitian system of each band is solved via a Cholesky factorisation;
+ * all bands reuse the buffers of the workspace. The responses of each band
+ * are passed as a separate pointer, such that they may be views into a
+ * memory-mapped file (see saf_arrayResponses_getBin()), and bands may share
+ * the same responses.
+ *
+ * @param[in]  hWork   Workspace; see measuredArrayWorkspace_create()
+ * @param[in]  H       Array responses of each band; nBands x
+ *                     (FLAT: nSensors x nDirs)
+ * @param[in]  nBands  Number of frequency bands
+ * @param[in]  regPar  Regularisation, in dB; the larger, the less regularised
+ * @param[in]  ldW     Leading dimension of each matrix in 'W' (>= nSensors)
+ * @param[in]  strideW Distance between the matrices of 'W'
+ *                     (>= (order+1)^2 x ldW)
+ * @param[out] W       Encoding matrices; FLAT: nBands x strideW, each
+ *                     (order+1)^2 x nSensors
+ *
+ * @see [1] Politis, A., Gamper, H. (2017). "Comparing Modelled And Measurement-
+ *          Based Spherical Harmonic Encoding Filters For Spherical Microphone
+ *          Arrays. In IEEE Workshop on Applications of Signal Processing to
+ *          Audio and Acoustics (WASPAA).
+ */
+void measuredArrayEncodingFilters(/* Input arguments */
+                                  void* const hWork,
+                                  const float_complex* const* H,
+                                  int nBands,
+                                  float regPar,
+                                  int ldW,
+                                  int strideW,
+                                  /* Output arguments */
+                                  float_complex* W);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
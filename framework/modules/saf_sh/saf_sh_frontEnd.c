@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_sh_frontEnd.c
+ * @brief Shared analysis front-end, which transforms one bus of spherical
+ *        harmonic signals (and computes their covariance matrices) once for
+ *        any number of analysers
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_sh.h"
+#include "saf_sh_internal.h"
+#include "../../resources/afSTFT/afSTFTlib.h"
+
+/** One subscriber of the front-end */
+typedef struct _shFrontEnd_sub {
+    shFrontEnd_subscriber proc;
+    void* hAnalyser;
+    int needsCov;
+
+}shFrontEnd_sub;
+
+/** Data structure for the shared analysis front-end */
+typedef struct _shFrontEnd_data {
+    int hopSize, frameSize, nTimeSlots, nBands;
+    int maxOrder, order;
+    SH_CH_ORDER chOrdering;
+    SH_NORM_TYPES norm;
+    int nCH_STFT;           /**< current number of afSTFT input channels */
+    void* hSTFT;
+    void* hFIFO;
+    void* hOrderDet;
+    int nSubs;
+    shFrontEnd_sub subs[SH_FRONTEND_MAX_NUM_SUBSCRIBERS];
+    float** frameTD;        /**< ACN/N3D signals; (maxOrder+1)^2 x frameSize */
+    float_complex* frameTF; /**< FLAT: nBands x nSH x nTimeSlots */
+    float_complex** Cx;     /**< packed covariance matrices; nBands x nPacked(maxOrder) */
+    shFrontEnd_frame frame;
+
+}shFrontEnd_data;
+
+void shFrontEnd_create
+(
+    void ** const phFE,
+    int hopSize,
+    int frameSize,
+    int maxOrder,
+    float fs
+)
+{
+    *phFE = malloc1d(sizeof(shFrontEnd_data));
+    shFrontEnd_data *h = (shFrontEnd_data*)(*phFE);
+    int maxNSH;
+
+    assert(frameSize % hopSize == 0);
+    maxNSH = ORDER2NSH(maxOrder);
+    h->hopSize = hopSize;
+    h->frameSize = frameSize;
+    h->nTimeSlots = frameSize/hopSize;
+    h->nBands = hopSize + 5; /* (hybrid-mode) */
+    h->maxOrder = h->order = maxOrder;
+    h->chOrdering = SH_CH_ACN;
+    h->norm = SH_NORM_N3D;
+    h->nCH_STFT = maxNSH;
+    afSTFTinit(&(h->hSTFT), hopSize, maxNSH, 0, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+    saf_fifo_create(&(h->hFIFO), frameSize, maxNSH, 0);
+    shOrderDetector_create(&(h->hOrderDet), maxOrder, (int)(SH_ORDER_DETECTOR_HOLD_TIME_S*fs));
+    h->nSubs = 0;
+    h->frameTD = (float**)malloc2d(maxNSH, frameSize, sizeof(float));
+    h->frameTF = calloc1d((h->nBands)*maxNSH*(h->nTimeSlots), sizeof(float_complex));
+    h->Cx = (float_complex**)calloc2d(h->nBands, maxNSH*(maxNSH+1)/2, sizeof(float_complex));
+}
+
+void shFrontEnd_destroy
+(
+    void ** const phFE
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(*phFE);
+
+    if(h!=NULL){
+        afSTFTfree(h->hSTFT);
+        saf_fifo_destroy(&(h->hFIFO));
+        shOrderDetector_destroy(&(h->hOrderDet));
+        free(h->frameTD);
+        free(h->frameTF);
+        free(h->Cx);
+        free(h);
+        *phFE = NULL;
+    }
+}
+
+void shFrontEnd_setInputFormat
+(
+    void * const hFE,
+    int order,
+    SH_CH_ORDER chOrdering,
+    SH_NORM_TYPES norm
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(hFE);
+
+    h->order = CLAMP(order, 1, h->maxOrder);
+    h->chOrdering = chOrdering;
+    h->norm = norm;
+}
+
+int shFrontEnd_subscribe
+(
+    void * const hFE,
+    shFrontEnd_subscriber proc,
+    void * const hAnalyser,
+    int needsCov
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(hFE);
+
+    if(h->nSubs>=SH_FRONTEND_MAX_NUM_SUBSCRIBERS)
+        return -1;
+    h->subs[h->nSubs].proc = proc;
+    h->subs[h->nSubs].hAnalyser = hAnalyser;
+    h->subs[h->nSubs].needsCov = needsCov;
+    return h->nSubs++;
+}
+
+void shFrontEnd_unsubscribe
+(
+    void * const hFE,
+    void * const hAnalyser
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(hFE);
+    int i, j;
+
+    for(i=j=0; i<h->nSubs; i++)
+        if(h->subs[i].hAnalyser!=hAnalyser)
+            h->subs[j++] = h->subs[i];
+    h->nSubs = j;
+}
+
+/**
+ * Analyses one frame of frameSize samples; called by the FIFO once a full
+ * frame of input samples has been collected
+ */
+static void shFrontEnd_analysisFrame
+(
+    void  *  const hFE,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(hFE);
+    int i, n, ch, band, order, nSH, nSH_active, needsCov;
+    float scale;
+    const int fuma2acn[4] = {0, 3, 1, 2};
+
+    order = h->order;
+    nSH = ORDER2NSH(order);
+
+    /* Load time-domain data (converting to ACN/N3D) */
+    if(h->chOrdering==SH_CH_FUMA){ /* only for first-order */
+        for(ch=0; ch<4; ch++){
+            if(nInputs>=4)
+                utility_svvcopy(inputs[ch], h->frameSize, h->frameTD[fuma2acn[ch]]);
+            else
+                memset(h->frameTD[ch], 0, h->frameSize*sizeof(float));
+        }
+        ch = 4;
+    }
+    else
+        for(ch=0; ch<MIN(nSH, nInputs); ch++)
+            utility_svvcopy(inputs[ch], h->frameSize, h->frameTD[ch]);
+    for(; ch<nSH; ch++)
+        memset(h->frameTD[ch], 0, h->frameSize*sizeof(float)); /* fill remaining channels with zeros */
+    for(n=0; n<order+1 && h->norm!=SH_NORM_N3D && (h->norm!=SH_NORM_FUMA || n<2); n++){
+        scale = h->norm==SH_NORM_SN3D ? sqrtf(2.0f*(float)n+1.0f) : (n==0 ? sqrtf(2.0f) : sqrtf(3.0f));
+        for(ch=ORDER2NSH(n-1); ch<ORDER2NSH(n); ch++)
+            utility_svsmul(h->frameTD[ch], &scale, h->frameSize, NULL);
+    }
+    nSH_active = ORDER2NSH(shOrderDetector_apply(h->hOrderDet, h->frameTD, order, h->frameSize));
+
+    /* Apply the time-frequency transform */
+    if(nSH!=h->nCH_STFT){
+        afSTFTchannelChange(h->hSTFT, nSH, 0);
+        h->nCH_STFT = nSH;
+    }
+    afSTFTforwardFrame(h->hSTFT, h->frameTD, h->nTimeSlots, h->frameTF, nSH*(h->nTimeSlots), h->nTimeSlots);
+
+    /* Covariance matrices per band (only the leading nSH_active block carries
+     * content, see utility_chpherk()), if any subscriber needs them */
+    needsCov = 0;
+    for(i=0; i<h->nSubs; i++)
+        needsCov |= h->subs[i].needsCov;
+    if(needsCov){
+        for(band=0; band<h->nBands; band++){
+            utility_chpherk(&(h->frameTF[band*nSH*(h->nTimeSlots)]), nSH_active, h->nTimeSlots, 1.0f, 0.0f, h->Cx[band]);
+            if(nSH>nSH_active)
+                memset(&(h->Cx[band][nSH_active*(nSH_active+1)/2]), 0, (nSH*(nSH+1)/2 - nSH_active*(nSH_active+1)/2)*sizeof(float_complex));
+        }
+    }
+
+    /* Pass the frame to the subscribers */
+    h->frame.order = order;
+    h->frame.nSH_active = nSH_active;
+    h->frame.frameSize = h->frameSize;
+    h->frame.nBands = h->nBands;
+    h->frame.nTimeSlots = h->nTimeSlots;
+    h->frame.TD = h->frameTD;
+    h->frame.TF = h->frameTF;
+    h->frame.Cx = needsCov ? h->Cx : NULL;
+    for(i=0; i<h->nSubs; i++)
+        h->subs[i].proc(h->subs[i].hAnalyser, (const void*)&(h->frame));
+}
+
+void shFrontEnd_analysis
+(
+    void * const hFE,
+    float ** const inputs,
+    int nInputs,
+    int nSamples
+)
+{
+    shFrontEnd_data *h = (shFrontEnd_data*)(hFE);
+    unsigned int fpState;
+
+    fpState = saf_denormals_guardBegin();
+    saf_fifo_process(h->hFIFO, inputs, NULL, MIN(nInputs, ORDER2NSH(h->maxOrder)), 0, nSamples, &shFrontEnd_analysisFrame, hFE);
+    saf_denormals_guardEnd(fpState);
+}
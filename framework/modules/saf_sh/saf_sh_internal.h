@@ -171,6 +171,69 @@ float getW(int l, int m, int n, float** R_1, float** R_lm1);
 float getW(int l, int m, int n, float** R_1, float** R_lm1);
 
 
+/* ========================================================================== */
+/*              OpenCL Back-end for the Activity-Map Generators               */
+/* ========================================================================== */
+
+#ifdef SAF_ENABLE_OPENCL
+
+/**
+ * Initialises an OpenCL device (a GPU is preferred) for evaluating the
+ * activity-map quadratic form: real(diag(W.'*Cx*W)), and allocates the device
+ * buffers for the maximum dimensions given here
+ *
+ * @param[in] phCL           (&) address of OpenCL back-end handle
+ * @param[in] maxNSH         Maximum number of SH components
+ * @param[in] maxNumGridDirs Maximum number of grid directions
+ * @returns 0 on success, or -1 if no device could be initialised (in which case
+ *          *phCL is set to NULL)
+ */
+int pmapOpenCL_create(void** const phCL,
+                      int maxNSH,
+                      int maxNumGridDirs);
+
+/**
+ * Releases the OpenCL device objects created with pmapOpenCL_create()
+ *
+ * @param[in] phCL (&) address of OpenCL back-end handle
+ */
+void pmapOpenCL_destroy(void** const phCL);
+
+/**
+ * Forgets the 'W' cached on the device, so that it is uploaded again with the
+ * next call to pmapOpenCL_scan()
+ *
+ * @param[in] hCL OpenCL back-end handle
+ */
+void pmapOpenCL_invalidateCache(void* const hCL);
+
+/**
+ * Evaluates pmap = real(diag(W.'*Cx*W)) on the OpenCL device
+ *
+ * @param[in]  hCL        OpenCL back-end handle
+ * @param[in]  Cx         Covariance matrix; FLAT: nSH x nSH
+ * @param[in]  W          Steering vectors/beamforming weights;
+ *                        FLAT: nSH x nGrid_dirs
+ * @param[in]  cacheW     '1' 'W' is only uploaded if the pointer (or 'nSH')
+ *                        differs from that of the previous cached call, '0'
+ *                        always upload 'W'
+ * @param[in]  nSH        Number of SH components
+ * @param[in]  nGrid_dirs Number of grid directions
+ * @param[out] pmap       Resulting map; nGrid_dirs x 1
+ * @returns 0 on success, or -1 if the device failed (so that the caller may
+ *          fall back to the CPU)
+ */
+int pmapOpenCL_scan(void* const hCL,
+                    const float_complex* Cx,
+                    const float_complex* W,
+                    int cacheW,
+                    int nSH,
+                    int nGrid_dirs,
+                    float* pmap);
+
+#endif /* SAF_ENABLE_OPENCL */
+
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_sh_opencl.c
+ * @brief Optional OpenCL back-end for the scanning stage of the powermap/
+ *        activity-map generators (see pmapWorkspace_setBackend())
+ *
+ * @note This (optional) back-end requires an OpenCL (1.1 or later) runtime to
+ *       be linked, and SAF_ENABLE_OPENCL to be defined.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_sh.h"
+#include "saf_sh_internal.h"
+
+#ifdef SAF_ENABLE_OPENCL
+
+#define CL_TARGET_OPENCL_VERSION 110
+#define CL_USE_DEPRECATED_OPENCL_1_1_APIS
+#ifdef __APPLE__
+# include <OpenCL/opencl.h>
+#else
+# include <CL/cl.h>
+#endif
+
+/**
+ * Kernel evaluating pmap = real(diag(W.'*Cx*W)), with one work-item per grid
+ * direction. 'W' is stored nSH x nGrid_dirs (row-major), so that neighbouring
+ * work-items read neighbouring elements
+ */
+static const char* pmapOpenCL_kernelSrc =
+"__kernel void pmap_scan(__global const float2* Cx,                         \n"
+"                        __global const float2* W,                          \n"
+"                        const int nSH,                                     \n"
+"                        const int nGrid_dirs,                              \n"
+"                        __global float* pmap)                              \n"
+"{                                                                          \n"
+"    int i, r, c;                                                           \n"
+"    float2 w_r, w_c, cx, Cx_w;                                             \n"
+"    float acc;                                                             \n"
+"    i = get_global_id(0);                                                  \n"
+"    if(i>=nGrid_dirs)                                                      \n"
+"        return;                                                            \n"
+"    acc = 0.0f;                                                            \n"
+"    for(r=0; r<nSH; r++){                                                  \n"
+"        /* Cx_w = Cx(r,:)*W(:,i) */                                        \n"
+"        Cx_w = (float2)(0.0f, 0.0f);                                       \n"
+"        for(c=0; c<nSH; c++){                                              \n"
+"            cx = Cx[r*nSH+c];                                              \n"
+"            w_c = W[c*nGrid_dirs+i];                                       \n"
+"            Cx_w += (float2)(cx.x*w_c.x - cx.y*w_c.y, cx.x*w_c.y + cx.y*w_c.x);\n"
+"        }                                                                  \n"
+"        /* acc += real(W(r,i)*Cx_w) */                                     \n"
+"        w_r = W[r*nGrid_dirs+i];                                           \n"
+"        acc += w_r.x*Cx_w.x - w_r.y*Cx_w.y;                                \n"
+"    }                                                                      \n"
+"    pmap[i] = acc;                                                         \n"
+"}                                                                          \n";
+
+/** Data structure for the OpenCL back-end */
+typedef struct _pmapOpenCL_data {
+    int maxNSH, maxNumGridDirs;
+    cl_context context;
+    cl_command_queue queue;
+    cl_program program;
+    cl_kernel kernel;
+    cl_mem Cx_buf, W_buf, pmap_buf;
+    const float_complex* cachedW; /**< host pointer of the 'W' currently on the device (NULL if none) */
+    int cachedW_nSH;              /**< nSH of the cached 'W' */
+
+}pmapOpenCL_data;
+
+int pmapOpenCL_create
+(
+    void** const phCL,
+    int maxNSH,
+    int maxNumGridDirs
+)
+{
+    pmapOpenCL_data *h;
+    cl_platform_id platforms[8];
+    cl_device_id device;
+    cl_uint i, nPlatforms;
+    cl_int err;
+    int foundDevice;
+
+    *phCL = NULL;
+
+    /* find a device, preferring GPUs over anything else */
+    if(clGetPlatformIDs(8, platforms, &nPlatforms)!=CL_SUCCESS || nPlatforms==0)
+        return -1;
+    nPlatforms = nPlatforms > 8 ? 8 : nPlatforms;
+    foundDevice = 0;
+    for(i=0; i<nPlatforms && !foundDevice; i++)
+        foundDevice = clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_GPU, 1, &device, NULL)==CL_SUCCESS;
+    for(i=0; i<nPlatforms && !foundDevice; i++)
+        foundDevice = clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_ALL, 1, &device, NULL)==CL_SUCCESS;
+    if(!foundDevice)
+        return -1;
+
+    h = (pmapOpenCL_data*)calloc1d(1, sizeof(pmapOpenCL_data));
+    h->maxNSH = maxNSH;
+    h->maxNumGridDirs = maxNumGridDirs;
+    h->cachedW = NULL;
+    h->cachedW_nSH = 0;
+    *phCL = (void*)h;
+
+    /* context, queue and kernel */
+    h->context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    h->queue = clCreateCommandQueue(h->context, device, 0, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    h->program = clCreateProgramWithSource(h->context, 1, &pmapOpenCL_kernelSrc, NULL, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    if(clBuildProgram(h->program, 1, &device, "-cl-mad-enable", NULL, NULL)!=CL_SUCCESS) goto fail;
+    h->kernel = clCreateKernel(h->program, "pmap_scan", &err);
+    if(err!=CL_SUCCESS) goto fail;
+
+    /* device buffers, for the maximum dimensions */
+    h->Cx_buf = clCreateBuffer(h->context, CL_MEM_READ_ONLY, maxNSH*maxNSH*sizeof(float_complex), NULL, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    h->W_buf = clCreateBuffer(h->context, CL_MEM_READ_ONLY, maxNSH*maxNumGridDirs*sizeof(float_complex), NULL, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    h->pmap_buf = clCreateBuffer(h->context, CL_MEM_WRITE_ONLY, maxNumGridDirs*sizeof(float), NULL, &err);
+    if(err!=CL_SUCCESS) goto fail;
+    return 0;
+
+fail:
+    pmapOpenCL_destroy(phCL);
+    return -1;
+}
+
+void pmapOpenCL_destroy
+(
+    void** const phCL
+)
+{
+    pmapOpenCL_data *h = (pmapOpenCL_data*)(*phCL);
+
+    if(h!=NULL){
+        if(h->queue!=NULL)
+            clFinish(h->queue);
+        if(h->pmap_buf!=NULL)
+            clReleaseMemObject(h->pmap_buf);
+        if(h->W_buf!=NULL)
+            clReleaseMemObject(h->W_buf);
+        if(h->Cx_buf!=NULL)
+            clReleaseMemObject(h->Cx_buf);
+        if(h->kernel!=NULL)
+            clReleaseKernel(h->kernel);
+        if(h->program!=NULL)
+            clReleaseProgram(h->program);
+        if(h->queue!=NULL)
+            clReleaseCommandQueue(h->queue);
+        if(h->context!=NULL)
+            clReleaseContext(h->context);
+        free(h);
+        *phCL = NULL;
+    }
+}
+
+void pmapOpenCL_invalidateCache
+(
+    void* const hCL
+)
+{
+    pmapOpenCL_data *h = (pmapOpenCL_data*)(hCL);
+    h->cachedW = NULL;
+}
+
+int pmapOpenCL_scan
+(
+    void* const hCL,
+    const float_complex* Cx,
+    const float_complex* W,
+    int cacheW,
+    int nSH,
+    int nGrid_dirs,
+    float* pmap
+)
+{
+    pmapOpenCL_data *h = (pmapOpenCL_data*)(hCL);
+    size_t globalSize;
+    cl_int err;
+
+    assert(nSH<=h->maxNSH && nGrid_dirs<=h->maxNumGridDirs);
+
+    /* upload the covariance matrix, and the steering vectors/weights (if needed) */
+    err = clEnqueueWriteBuffer(h->queue, h->Cx_buf, CL_FALSE, 0, nSH*nSH*sizeof(float_complex), Cx, 0, NULL, NULL);
+    if(!cacheW || W!=h->cachedW || nSH!=h->cachedW_nSH){
+        err |= clEnqueueWriteBuffer(h->queue, h->W_buf, CL_FALSE, 0, nSH*nGrid_dirs*sizeof(float_complex), W, 0, NULL, NULL);
+        h->cachedW = cacheW ? W : NULL;
+        h->cachedW_nSH = cacheW ? nSH : 0;
+    }
+
+    /* evaluate the quadratic form for all grid directions, and read back the map */
+    err |= clSetKernelArg(h->kernel, 0, sizeof(cl_mem), &(h->Cx_buf));
+    err |= clSetKernelArg(h->kernel, 1, sizeof(cl_mem), &(h->W_buf));
+    err |= clSetKernelArg(h->kernel, 2, sizeof(cl_int), &nSH);
+    err |= clSetKernelArg(h->kernel, 3, sizeof(cl_int), &nGrid_dirs);
+    err |= clSetKernelArg(h->kernel, 4, sizeof(cl_mem), &(h->pmap_buf));
+    globalSize = (size_t)nGrid_dirs;
+    err |= clEnqueueNDRangeKernel(h->queue, h->kernel, 1, NULL, &globalSize, NULL, 0, NULL, NULL);
+    err |= clEnqueueReadBuffer(h->queue, h->pmap_buf, CL_TRUE, 0, nGrid_dirs*sizeof(float), pmap, 0, NULL, NULL);
+    if(err!=CL_SUCCESS){
+        h->cachedW = NULL; /* (the device contents are unknown) */
+        return -1;
+    }
+    return 0;
+}
+
+#endif /* SAF_ENABLE_OPENCL */
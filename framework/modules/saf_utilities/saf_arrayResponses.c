@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_arrayResponses.c
+ * @brief Memory-mapped reading (and writing) of measured microphone array
+ *        responses, for computing encoding filters from calibration data
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_arrayResponses.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+/** Identifier at the start of the file */
+#define ARESP_MAGIC "SAFARESP"
+/** Version of the file layout */
+#define ARESP_VERSION ( 1 )
+/** Size of the header, in bytes */
+#define ARESP_HEADER_SIZE ( 32 )
+
+/** Data structure for the array responses */
+typedef struct _safArrayResponses_data {
+#if defined(_WIN32)
+    HANDLE hFile, hMap;
+#endif
+    const unsigned char* base;  /**< mapped file */
+    size_t nBytes;              /**< size of the mapped file, in bytes */
+    int nSensors, nDirs, nBins;
+    float fs;
+    const float* dirs_deg;      /**< nDirs x 2 (view into the mapping) */
+    const float_complex* H;     /**< nBins x nSensors x nDirs (view into the mapping) */
+
+}safArrayResponses_data;
+
+/** Little-endian unsigned 32-bit integer */
+static unsigned int aresp_uint(const unsigned char* b)
+{
+    return (unsigned int)b[0] | ((unsigned int)b[1]<<8) | ((unsigned int)b[2]<<16) | ((unsigned int)b[3]<<24);
+}
+
+/** Writes a little-endian unsigned 32-bit integer */
+static void aresp_putUint(unsigned char* b, unsigned int val)
+{
+    b[0] = (unsigned char)(val & 0xFF);
+    b[1] = (unsigned char)((val>>8) & 0xFF);
+    b[2] = (unsigned char)((val>>16) & 0xFF);
+    b[3] = (unsigned char)((val>>24) & 0xFF);
+}
+
+/** Returns 1 if the host is little-endian (the float data are viewed as is) */
+static int aresp_isLittleEndian(void)
+{
+    const unsigned int one = 1;
+    return *((const unsigned char*)&one)==1;
+}
+
+/** Unmaps the file */
+static void arrayResponses_unmap(safArrayResponses_data* h)
+{
+#if defined(_WIN32)
+    if(h->base!=NULL)
+        UnmapViewOfFile((LPCVOID)h->base);
+    if(h->hMap!=NULL)
+        CloseHandle(h->hMap);
+    if(h->hFile!=INVALID_HANDLE_VALUE)
+        CloseHandle(h->hFile);
+    h->hMap = NULL;
+    h->hFile = INVALID_HANDLE_VALUE;
+#else
+    if(h->base!=NULL)
+        munmap((void*)h->base, h->nBytes);
+#endif
+    h->base = NULL;
+}
+
+/** Maps the whole file, read-only; returns 1 if successful */
+static int arrayResponses_map(safArrayResponses_data* h, const char* path)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER size;
+
+    h->hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if(h->hFile==INVALID_HANDLE_VALUE || !GetFileSizeEx(h->hFile, &size) || size.QuadPart<ARESP_HEADER_SIZE)
+        return 0;
+    h->nBytes = (size_t)size.QuadPart;
+    h->hMap = CreateFileMappingA(h->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(h->hMap!=NULL)
+        h->base = (const unsigned char*)MapViewOfFile(h->hMap, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd;
+    struct stat st;
+
+    fd = open(path, O_RDONLY);
+    if(fd<0)
+        return 0;
+    if(fstat(fd, &st)==0 && st.st_size>=ARESP_HEADER_SIZE){
+        h->nBytes = (size_t)st.st_size;
+        h->base = (const unsigned char*)mmap(NULL, h->nBytes, PROT_READ, MAP_SHARED, fd, 0);
+        if(h->base==(const unsigned char*)MAP_FAILED)
+            h->base = NULL;
+# ifdef MADV_RANDOM
+        /* (only a few bins are usually accessed; so no read-ahead) */
+        if(h->base!=NULL)
+            madvise((void*)h->base, h->nBytes, MADV_RANDOM);
+# endif
+    }
+    close(fd);
+#endif
+    return h->base!=NULL ? 1 : 0;
+}
+
+int saf_arrayResponses_open
+(
+    void ** const phResp,
+    const char* path
+)
+{
+    safArrayResponses_data* h;
+    const unsigned char* b;
+    unsigned long long expectedSize;
+
+    *phResp = NULL;
+    if(!aresp_isLittleEndian())
+        return 0;
+    h = (safArrayResponses_data*)malloc1d(sizeof(safArrayResponses_data));
+    memset(h, 0, sizeof(safArrayResponses_data));
+#if defined(_WIN32)
+    h->hFile = INVALID_HANDLE_VALUE;
+#endif
+    if(!arrayResponses_map(h, path)){
+        arrayResponses_unmap(h);
+        free(h);
+        return 0;
+    }
+
+    /* parse the header, and check that the file holds all of the data */
+    b = h->base;
+    h->nSensors = (int)aresp_uint(&b[12]);
+    h->nDirs = (int)aresp_uint(&b[16]);
+    h->nBins = (int)aresp_uint(&b[20]);
+    memcpy(&(h->fs), &b[24], sizeof(float));
+    expectedSize = ARESP_HEADER_SIZE + (unsigned long long)(h->nDirs)*2*sizeof(float) +
+                   (unsigned long long)(h->nBins)*(unsigned long long)(h->nSensors)*(unsigned long long)(h->nDirs)*sizeof(float_complex);
+    if(memcmp(b, ARESP_MAGIC, 8)!=0 || aresp_uint(&b[8])!=ARESP_VERSION ||
+       h->nSensors<1 || h->nDirs<1 || h->nBins<2 || !(h->fs>0.0f) ||
+       (unsigned long long)(h->nBytes)<expectedSize){
+        arrayResponses_unmap(h);
+        free(h);
+        return 0;
+    }
+    h->dirs_deg = (const float*)&b[ARESP_HEADER_SIZE];
+    h->H = (const float_complex*)&b[ARESP_HEADER_SIZE + (h->nDirs)*2*sizeof(float)];
+    *phResp = (void*)h;
+    return 1;
+}
+
+void saf_arrayResponses_close
+(
+    void ** const phResp
+)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(*phResp);
+
+    if(h!=NULL){
+        arrayResponses_unmap(h);
+        free(h);
+        *phResp = NULL;
+    }
+}
+
+int saf_arrayResponses_getNumSensors(void * const hResp)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    return h->nSensors;
+}
+
+int saf_arrayResponses_getNumDirs(void * const hResp)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    return h->nDirs;
+}
+
+int saf_arrayResponses_getNumBins(void * const hResp)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    return h->nBins;
+}
+
+float saf_arrayResponses_getSampleRate(void * const hResp)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    return h->fs;
+}
+
+const float* saf_arrayResponses_getDirs_deg(void * const hResp)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    return h->dirs_deg;
+}
+
+int saf_arrayResponses_findBin
+(
+    void * const hResp,
+    float freq
+)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+    float binWidth;
+
+    binWidth = h->fs/(2.0f*(float)(h->nBins-1));
+    return CLAMP((int)(freq/binWidth + 0.5f), 0, h->nBins-1);
+}
+
+const float_complex* saf_arrayResponses_getBin
+(
+    void * const hResp,
+    int bin
+)
+{
+    safArrayResponses_data* h = (safArrayResponses_data*)(hResp);
+
+    assert(bin>=0 && bin<h->nBins);
+    return &(h->H[(size_t)bin*(size_t)(h->nSensors)*(size_t)(h->nDirs)]);
+}
+
+int saf_arrayResponses_write
+(
+    const char* path,
+    const float_complex* H,
+    int nBins,
+    int nSensors,
+    const float* dirs_deg,
+    int nDirs,
+    float fs
+)
+{
+    FILE* file;
+    unsigned char header[ARESP_HEADER_SIZE];
+    size_t nH;
+    int success;
+
+    if(!aresp_isLittleEndian() || nBins<2 || nSensors<1 || nDirs<1)
+        return 0;
+    file = fopen(path, "wb");
+    if(file==NULL)
+        return 0;
+    memset(header, 0, ARESP_HEADER_SIZE);
+    memcpy(header, ARESP_MAGIC, 8);
+    aresp_putUint(&header[8], ARESP_VERSION);
+    aresp_putUint(&header[12], (unsigned int)nSensors);
+    aresp_putUint(&header[16], (unsigned int)nDirs);
+    aresp_putUint(&header[20], (unsigned int)nBins);
+    memcpy(&header[24], &fs, sizeof(float));
+    nH = (size_t)nBins*(size_t)nSensors*(size_t)nDirs;
+    success = fwrite(header, 1, ARESP_HEADER_SIZE, file)==ARESP_HEADER_SIZE &&
+              fwrite(dirs_deg, sizeof(float), 2*nDirs, file)==(size_t)(2*nDirs) &&
+              fwrite(H, sizeof(float_complex), nH, file)==nH;
+    if(fclose(file)!=0)
+        success = 0;
+    return success;
+}
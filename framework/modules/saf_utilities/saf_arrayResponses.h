@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_arrayResponses.h
+ * @brief Memory-mapped reading (and writing) of measured microphone array
+ *        responses, for computing encoding filters from calibration data
+ *
+ * The responses of large arrays (e.g. 64 capsules, measured for thousands of
+ * directions and hundreds of frequencies) may occupy several hundred MB, of
+ * which only the frequencies nearest to the bands of the caller are usually
+ * required. Therefore, the file is memory-mapped, and each frequency (bin) is
+ * returned as a direct (zero-copy) view into the mapping; only the pages of
+ * the bins that are actually accessed are then loaded by the operating system.
+ *
+ * File layout ("SAFARESP", version 1; little-endian):
+ *   - header (32 bytes): "SAFARESP", version, nSensors, nDirs, nBins (uint32)
+ *     sampling rate (float32), and 4 reserved bytes
+ *   - measurement directions, [azimuth elevation] in degrees; FLAT: nDirs x 2
+ *     (float32)
+ *   - responses, as interleaved complex float32 values; FLAT:
+ *     nBins x nSensors x nDirs, where bin 'k' lies at k*fs/(2*(nBins-1)) Hz
+ *
+ * @note Only little-endian hosts are supported. Files larger than 2GB require
+ *       a 64-bit address space.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_ARRAYRESPONSES_H_INCLUDED
+#define SAF_ARRAYRESPONSES_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Opens (memory-maps) a file of measured array responses
+ *
+ * @param[in] phResp (&) address of arrayResponses handle (NULL if the file
+ *                   could not be opened)
+ * @param[in] path   File path
+ * @returns   1 if the file was opened, 0 if it is missing, truncated or is
+ *            not a valid "SAFARESP" file
+ */
+int saf_arrayResponses_open(/* Input Arguments */
+                            void ** const phResp,
+                            const char* path);
+
+/**
+ * Closes (unmaps) a file of measured array responses
+ *
+ * @param[in] phResp (&) address of arrayResponses handle
+ */
+void saf_arrayResponses_close(/* Input Arguments */
+                              void ** const phResp);
+
+/** Returns the number of sensors */
+int saf_arrayResponses_getNumSensors(/* Input Arguments */
+                                     void * const hResp);
+
+/** Returns the number of measurement directions */
+int saf_arrayResponses_getNumDirs(/* Input Arguments */
+                                  void * const hResp);
+
+/** Returns the number of frequency bins */
+int saf_arrayResponses_getNumBins(/* Input Arguments */
+                                  void * const hResp);
+
+/** Returns the sampling rate of the measurements, in Hz */
+float saf_arrayResponses_getSampleRate(/* Input Arguments */
+                                       void * const hResp);
+
+/**
+ * Returns the measurement directions
+ *
+ * @returns Directions, [azimuth elevation] in degrees (a view into the
+ *          mapping); FLAT: nDirs x 2
+ */
+const float* saf_arrayResponses_getDirs_deg(/* Input Arguments */
+                                            void * const hResp);
+
+/**
+ * Returns the index of the frequency bin nearest to a given frequency
+ *
+ * @param[in] hResp arrayResponses handle
+ * @param[in] freq  Frequency, in Hz
+ * @returns   Bin index (0..nBins-1)
+ */
+int saf_arrayResponses_findBin(/* Input Arguments */
+                               void * const hResp,
+                               float freq);
+
+/**
+ * Returns the responses of one frequency bin
+ *
+ * @param[in] hResp arrayResponses handle
+ * @param[in] bin   Bin index (0..nBins-1)
+ * @returns   Responses of all sensors for all directions (a view into the
+ *            mapping, valid until the file is closed); FLAT: nSensors x nDirs
+ */
+const float_complex* saf_arrayResponses_getBin(/* Input Arguments */
+                                               void * const hResp,
+                                               int bin);
+
+/**
+ * Writes array responses into a file, which may then be opened with
+ * saf_arrayResponses_open(); e.g. for converting measurements that were made
+ * available in another format
+ *
+ * @param[in] path     File path
+ * @param[in] H        Responses; FLAT: nBins x nSensors x nDirs
+ * @param[in] nBins    Number of frequency bins (>=2), spanning 0..fs/2
+ * @param[in] nSensors Number of sensors
+ * @param[in] dirs_deg Measurement directions, [azimuth elevation] in degrees;
+ *                     FLAT: nDirs x 2
+ * @param[in] nDirs    Number of measurement directions
+ * @param[in] fs       Sampling rate of the measurements, in Hz
+ * @returns   1 if the file was written, 0 otherwise
+ */
+int saf_arrayResponses_write(/* Input Arguments */
+                             const char* path,
+                             const float_complex* H,
+                             int nBins,
+                             int nSensors,
+                             const float* dirs_deg,
+                             int nDirs,
+                             float fs);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_ARRAYRESPONSES_H_INCLUDED */
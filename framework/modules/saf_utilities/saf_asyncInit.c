@@ -0,0 +1,368 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_asyncInit.c
+ * @brief Background (re)initialisation service, which prepares new objects
+ *        (e.g. codec data) on a worker thread, with cancellation, and hands
+ *        them over to the audio thread once they are ready
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_asyncInit.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+/**
+ * Data structure for the service.
+ *
+ * The lock is only ever held briefly (never while building or destroying an
+ * object), so that saf_asyncInit_fetch() and saf_asyncInit_retire() may be
+ * called from the audio thread.
+ */
+typedef struct _safAsyncInit_data {
+    saf_asyncInit_buildFunc buildFunc;
+    saf_asyncInit_destroyFunc destroyFunc;
+    saf_asyncInit_doneFunc doneFunc;
+    void* hOwner;
+    void* ready;                /**< built object, not yet fetched */
+    void* retired;              /**< object waiting to be destroyed */
+    int fetched;                /**< 1 if an object was fetched, but not retired */
+    int requestPending;         /**< 1 if a (new) build has been requested */
+    int building;               /**< 1 while the build function is running */
+    volatile int cancelFlag;    /**< 1 if the current build has been cancelled */
+    int threadRunning, exitFlag;
+#if defined(_WIN32)
+    HANDLE thread;
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+
+}safAsyncInit_data;
+
+static void asyncInit_lock(safAsyncInit_data* h)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(&(h->mutex));
+#else
+    pthread_mutex_lock(&(h->mutex));
+#endif
+}
+
+static void asyncInit_unlock(safAsyncInit_data* h)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(&(h->mutex));
+#else
+    pthread_mutex_unlock(&(h->mutex));
+#endif
+}
+
+/** Waits on the condition variable (the lock must be held) */
+static void asyncInit_wait(safAsyncInit_data* h)
+{
+#if defined(_WIN32)
+    SleepConditionVariableCS(&(h->cond), &(h->mutex), INFINITE);
+#else
+    pthread_cond_wait(&(h->cond), &(h->mutex));
+#endif
+}
+
+/** Wakes all threads waiting on the condition variable */
+static void asyncInit_signal(safAsyncInit_data* h)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(&(h->cond));
+#else
+    pthread_cond_broadcast(&(h->cond));
+#endif
+}
+
+/**
+ * Runs one build (the lock must be held, and is held again on return); the
+ * result is published, unless the build was cancelled in the meantime
+ */
+static void asyncInit_runBuild(safAsyncInit_data* h)
+{
+    void* object, *discarded;
+    int published;
+
+    h->requestPending = 0;
+    h->cancelFlag = 0;
+    h->building = 1;
+    asyncInit_unlock(h);
+    object = h->buildFunc(h->hOwner, (void*)h);
+
+    asyncInit_lock(h);
+    h->building = 0;
+    discarded = NULL;
+    published = 0;
+    if(object!=NULL){
+        if(h->cancelFlag)
+            discarded = object;
+        else{
+            discarded = h->ready;
+            h->ready = object;
+            published = 1;
+        }
+    }
+    asyncInit_signal(h);
+    asyncInit_unlock(h);
+    if(discarded!=NULL)
+        h->destroyFunc(h->hOwner, discarded);
+    if(published && h->doneFunc!=NULL)
+        h->doneFunc(h->hOwner);
+    asyncInit_lock(h);
+}
+
+/** Worker thread, which carries out the builds and destroys retired objects */
+#if defined(_WIN32)
+static DWORD WINAPI asyncInit_worker(LPVOID arg)
+#else
+static void* asyncInit_worker(void* arg)
+#endif
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)arg;
+    void* retired;
+
+    asyncInit_lock(h);
+    while(1){
+        /* wait for the next request, retired object, or the request to exit */
+        while(!h->requestPending && h->retired==NULL && !h->exitFlag)
+            asyncInit_wait(h);
+        if(h->exitFlag)
+            break;
+
+        /* destroy retired objects first, to free their memory */
+        if(h->retired!=NULL){
+            retired = h->retired;
+            h->retired = NULL;
+            asyncInit_unlock(h);
+            h->destroyFunc(h->hOwner, retired);
+            asyncInit_lock(h);
+            continue;
+        }
+
+        /* build */
+        asyncInit_runBuild(h);
+    }
+    asyncInit_unlock(h);
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+void saf_asyncInit_create
+(
+    void ** const phAsync,
+    saf_asyncInit_buildFunc buildFunc,
+    saf_asyncInit_destroyFunc destroyFunc,
+    saf_asyncInit_doneFunc doneFunc,
+    void * const hOwner
+)
+{
+    *phAsync = malloc1d(sizeof(safAsyncInit_data));
+    safAsyncInit_data *h = (safAsyncInit_data*)(*phAsync);
+
+    h->buildFunc = buildFunc;
+    h->destroyFunc = destroyFunc;
+    h->doneFunc = doneFunc;
+    h->hOwner = hOwner;
+    h->ready = h->retired = NULL;
+    h->fetched = 0;
+    h->requestPending = 0;
+    h->building = 0;
+    h->cancelFlag = 0;
+    h->exitFlag = 0;
+
+    /* start worker thread */
+#if defined(_WIN32)
+    InitializeCriticalSection(&(h->mutex));
+    InitializeConditionVariable(&(h->cond));
+    h->thread = CreateThread(NULL, 0, asyncInit_worker, (LPVOID)h, 0, NULL);
+    h->threadRunning = h->thread != NULL ? 1 : 0;
+#else
+    pthread_mutex_init(&(h->mutex), NULL);
+    pthread_cond_init(&(h->cond), NULL);
+    h->threadRunning = pthread_create(&(h->thread), NULL, asyncInit_worker, (void*)h) == 0 ? 1 : 0;
+#endif
+}
+
+void saf_asyncInit_destroy
+(
+    void ** const phAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(*phAsync);
+
+    if(h!=NULL){
+        /* cancel the current build, and stop the worker thread */
+        asyncInit_lock(h);
+        h->cancelFlag = 1;
+        h->requestPending = 0;
+        h->exitFlag = 1;
+        asyncInit_signal(h);
+        asyncInit_unlock(h);
+        if(h->threadRunning){
+#if defined(_WIN32)
+            WaitForSingleObject(h->thread, INFINITE);
+            CloseHandle(h->thread);
+#else
+            pthread_join(h->thread, NULL);
+#endif
+        }
+#if defined(_WIN32)
+        DeleteCriticalSection(&(h->mutex));
+#else
+        pthread_mutex_destroy(&(h->mutex));
+        pthread_cond_destroy(&(h->cond));
+#endif
+        if(h->ready!=NULL)
+            h->destroyFunc(h->hOwner, h->ready);
+        if(h->retired!=NULL)
+            h->destroyFunc(h->hOwner, h->retired);
+        free(h);
+        (*phAsync) = NULL;
+    }
+}
+
+void saf_asyncInit_request
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+    void* discarded;
+
+    asyncInit_lock(h);
+    h->cancelFlag = 1; /* (the next build resets this) */
+    h->requestPending = 1;
+    discarded = h->ready;
+    h->ready = NULL;
+    if(h->threadRunning)
+        asyncInit_signal(h);
+    else{
+        /* no worker thread, build in the calling thread */
+        while(h->requestPending)
+            asyncInit_runBuild(h);
+    }
+    asyncInit_unlock(h);
+    if(discarded!=NULL)
+        h->destroyFunc(h->hOwner, discarded);
+}
+
+void saf_asyncInit_cancel
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+    void* discarded;
+
+    asyncInit_lock(h);
+    h->cancelFlag = 1;
+    h->requestPending = 0;
+    discarded = h->ready;
+    h->ready = NULL;
+    asyncInit_signal(h);
+    asyncInit_unlock(h);
+    if(discarded!=NULL)
+        h->destroyFunc(h->hOwner, discarded);
+}
+
+int saf_asyncInit_isCancelled
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+
+    return h->cancelFlag;
+}
+
+int saf_asyncInit_isBusy
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+    int busy;
+
+    asyncInit_lock(h);
+    busy = h->requestPending || h->building;
+    asyncInit_unlock(h);
+    return busy;
+}
+
+void saf_asyncInit_wait
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+
+    asyncInit_lock(h);
+    while(h->requestPending || h->building)
+        asyncInit_wait(h);
+    asyncInit_unlock(h);
+}
+
+void* saf_asyncInit_fetch
+(
+    void * const hAsync
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+    void* object;
+
+    object = NULL;
+    asyncInit_lock(h);
+    if(h->ready!=NULL && !h->fetched && h->retired==NULL){
+        object = h->ready;
+        h->ready = NULL;
+        h->fetched = 1;
+    }
+    asyncInit_unlock(h);
+    return object;
+}
+
+void saf_asyncInit_retire
+(
+    void * const hAsync,
+    void * object
+)
+{
+    safAsyncInit_data *h = (safAsyncInit_data*)(hAsync);
+
+    asyncInit_lock(h);
+    h->fetched = 0;
+    h->retired = object;
+    if(object!=NULL && h->threadRunning)
+        asyncInit_signal(h);
+    asyncInit_unlock(h);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_asyncInit.h
+ * @brief Background (re)initialisation service, which prepares new objects
+ *        (e.g. codec data) on a worker thread, with cancellation, and hands
+ *        them over to the audio thread once they are ready
+ *
+ * A typical use is as follows:
+ *  - saf_asyncInit_request() is called whenever a parameter change requires
+ *    the object to be rebuilt; any rebuild that is still in progress is
+ *    cancelled (the build function should poll saf_asyncInit_isCancelled()),
+ *    and a new one is started with the latest parameters.
+ *  - At the start of each frame, the audio thread calls saf_asyncInit_fetch().
+ *    If a new object is ready, it swaps it in (e.g. crossfading from the old
+ *    one), and passes the old object to saf_asyncInit_retire(), such that it is
+ *    destroyed on the worker thread.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_ASYNCINIT_H_INCLUDED
+#define SAF_ASYNCINIT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Prototype of a build function, which is called on the worker thread
+ *
+ * @param[in] hOwner Handle passed to saf_asyncInit_create()
+ * @param[in] hAsync saf_asyncInit handle (for saf_asyncInit_isCancelled())
+ * @returns   The new object; or NULL, if the build was cancelled (or failed)
+ */
+typedef void* (*saf_asyncInit_buildFunc)(void* const hOwner,
+                                         void* const hAsync);
+
+/**
+ * Prototype of a function which destroys an object returned by the build
+ * function
+ *
+ * @param[in] hOwner Handle passed to saf_asyncInit_create()
+ * @param[in] object Object to destroy
+ */
+typedef void (*saf_asyncInit_destroyFunc)(void* const hOwner,
+                                          void* object);
+
+/**
+ * Prototype of a completion callback, which is called on the worker thread
+ * after a new object has been built (and not cancelled)
+ *
+ * @param[in] hOwner Handle passed to saf_asyncInit_create()
+ */
+typedef void (*saf_asyncInit_doneFunc)(void* const hOwner);
+
+/**
+ * Creates an instance of the service, and starts its worker thread
+ *
+ * @note If the worker thread cannot be started, saf_asyncInit_request() builds
+ *       the object in the calling thread instead.
+ *
+ * @param[in] phAsync   (&) address of saf_asyncInit handle
+ * @param[in] buildFunc Build function
+ * @param[in] destroyFunc Destroy function
+ * @param[in] doneFunc  Completion callback (optional; may be NULL)
+ * @param[in] hOwner    Handle passed to the functions above
+ */
+void saf_asyncInit_create(/* Input Arguments */
+                          void ** const phAsync,
+                          saf_asyncInit_buildFunc buildFunc,
+                          saf_asyncInit_destroyFunc destroyFunc,
+                          saf_asyncInit_doneFunc doneFunc,
+                          void * const hOwner);
+
+/**
+ * Destroys an instance of the service; any build in progress is cancelled,
+ * and any objects that were not yet fetched or destroyed are destroyed
+ *
+ * @param[in] phAsync (&) address of saf_asyncInit handle
+ */
+void saf_asyncInit_destroy(/* Input Arguments */
+                           void ** const phAsync);
+
+/**
+ * Requests that a new object is built; cancelling the build currently in
+ * progress (if any), and discarding any built object that was not yet fetched
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ */
+void saf_asyncInit_request(/* Input Arguments */
+                           void * const hAsync);
+
+/**
+ * Cancels the build currently in progress (if any), as well as any pending
+ * request, and discards any built object that was not yet fetched
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ */
+void saf_asyncInit_cancel(/* Input Arguments */
+                          void * const hAsync);
+
+/**
+ * Returns 1 if the current build has been cancelled, 0 otherwise; to be polled
+ * by the build function, which should then return NULL as soon as possible
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ */
+int saf_asyncInit_isCancelled(/* Input Arguments */
+                              void * const hAsync);
+
+/**
+ * Returns 1 if a build is requested or in progress, 0 otherwise
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ */
+int saf_asyncInit_isBusy(/* Input Arguments */
+                         void * const hAsync);
+
+/**
+ * Blocks until no build is requested or in progress
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ */
+void saf_asyncInit_wait(/* Input Arguments */
+                        void * const hAsync);
+
+/**
+ * Returns the most recently built object, if it is ready and has not yet been
+ * fetched; or NULL otherwise
+ *
+ * @note This does not allocate or free memory, and only holds the internal
+ *       lock very briefly, so it may be called from the audio thread. Each
+ *       fetched object must be followed by a call to saf_asyncInit_retire()
+ *       before the next one can be fetched.
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ * @returns   The new object, or NULL
+ */
+void* saf_asyncInit_fetch(/* Input Arguments */
+                          void * const hAsync);
+
+/**
+ * Passes an object (i.e. the one replaced after saf_asyncInit_fetch()) to the
+ * worker thread, to be destroyed there
+ *
+ * @note Like saf_asyncInit_fetch(), this may be called from the audio thread.
+ *
+ * @param[in] hAsync saf_asyncInit handle
+ * @param[in] object Object to destroy (may be NULL)
+ */
+void saf_asyncInit_retire(/* Input Arguments */
+                          void * const hAsync,
+                          void * object);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_ASYNCINIT_H_INCLUDED */
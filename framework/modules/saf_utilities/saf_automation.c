@@ -0,0 +1,265 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_automation.c
+ * @brief Recording and replaying of time-stamped parameter changes
+ *        (automation), for reproducing the workload of a session offline
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_automation.h"
+#if defined(_WIN32)
+# include <windows.h>
+# define AUTOMATION_ATOMIC_LOAD(p)  InterlockedCompareExchange64((volatile LONGLONG*)(p), 0, 0)
+# define AUTOMATION_ATOMIC_ADD(p,v) InterlockedExchangeAdd64((volatile LONGLONG*)(p), (LONGLONG)(v))
+#else
+# define AUTOMATION_ATOMIC_LOAD(p)  __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define AUTOMATION_ATOMIC_ADD(p,v) __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#endif
+
+/** First line of an automation file */
+#define AUTOMATION_FILE_HEADER "# saf_automation 1"
+/** Initial capacity of the event list */
+#define AUTOMATION_INITIAL_CAPACITY ( 256 )
+
+/** One recorded parameter change */
+typedef struct _automation_event {
+    long long position;                         /**< in samples */
+    int param;                                  /**< parameter index */
+    int nValues;                                /**< number of values */
+    float values[SAF_AUTOMATION_MAX_NUM_VALUES]; /**< values */
+
+}automation_event;
+
+/** Data structure for the automation recording */
+typedef struct _safAutomation_data {
+    automation_event* events;   /**< in order of position; nEvents x 1 */
+    int nEvents;                /**< number of events */
+    int capacity;               /**< allocated number of events */
+    int replayIdx;              /**< next event to replay */
+    volatile long long position; /**< recording position, in samples */
+
+}safAutomation_data;
+
+void saf_automation_create
+(
+    void ** const phAuto
+)
+{
+    safAutomation_data* h;
+
+    h = (safAutomation_data*)malloc1d(sizeof(safAutomation_data));
+    *phAuto = (void*)h;
+    h->capacity = AUTOMATION_INITIAL_CAPACITY;
+    h->events = (automation_event*)malloc1d(h->capacity*sizeof(automation_event));
+    saf_automation_clear(*phAuto);
+}
+
+void saf_automation_destroy
+(
+    void ** const phAuto
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(*phAuto);
+
+    if(h!=NULL){
+        free(h->events);
+        free(h);
+        *phAuto = NULL;
+    }
+}
+
+void saf_automation_clear
+(
+    void * const hAuto
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+
+    h->nEvents = 0;
+    h->replayIdx = 0;
+    h->position = 0;
+}
+
+void saf_automation_record
+(
+    void * const hAuto,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    saf_automation_recordAt(hAuto, AUTOMATION_ATOMIC_LOAD(&(h->position)), param, values, nValues);
+}
+
+void saf_automation_recordAt
+(
+    void * const hAuto,
+    long long position,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    automation_event* e;
+    int i;
+
+    if(h->nEvents==h->capacity){
+        h->capacity *= 2;
+        h->events = (automation_event*)realloc1d(h->events, h->capacity*sizeof(automation_event));
+    }
+
+    /* (events at the same position are kept in the order they were recorded) */
+    for(i=h->nEvents; i>0 && h->events[i-1].position>position; i--) {}
+    if(i<h->nEvents)
+        memmove(&(h->events[i+1]), &(h->events[i]), (h->nEvents-i)*sizeof(automation_event));
+    h->nEvents++;
+    e = &(h->events[i]);
+    e->position = position;
+    e->param = param;
+    e->nValues = CLAMP(nValues, 0, SAF_AUTOMATION_MAX_NUM_VALUES);
+    memset(e->values, 0, SAF_AUTOMATION_MAX_NUM_VALUES*sizeof(float));
+    if(e->nValues>0)
+        memcpy(e->values, values, e->nValues*sizeof(float));
+}
+
+void saf_automation_advance
+(
+    void * const hAuto,
+    int nSamples
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    AUTOMATION_ATOMIC_ADD(&(h->position), (long long)nSamples);
+}
+
+int saf_automation_getNumEvents
+(
+    void * const hAuto
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    return h->nEvents;
+}
+
+long long saf_automation_getLastPosition
+(
+    void * const hAuto
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    return h->nEvents>0 ? h->events[h->nEvents-1].position : -1;
+}
+
+void saf_automation_rewind
+(
+    void * const hAuto
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    h->replayIdx = 0;
+}
+
+int saf_automation_getNextEvent
+(
+    void * const hAuto,
+    long long upTo,
+    long long* position,
+    int* param,
+    float* values,
+    int* nValues
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    automation_event* e;
+
+    if(h->replayIdx>=h->nEvents || h->events[h->replayIdx].position>upTo)
+        return 0;
+    e = &(h->events[h->replayIdx++]);
+    if(position!=NULL)
+        (*position) = e->position;
+    (*param) = e->param;
+    (*nValues) = e->nValues;
+    memcpy(values, e->values, SAF_AUTOMATION_MAX_NUM_VALUES*sizeof(float));
+    return 1;
+}
+
+int saf_automation_save
+(
+    void * const hAuto,
+    const char* path
+)
+{
+    safAutomation_data* h = (safAutomation_data*)(hAuto);
+    FILE* file;
+    int i, j, success;
+
+    file = fopen(path, "w");
+    if(file==NULL)
+        return 0;
+    success = fprintf(file, "%s\n", AUTOMATION_FILE_HEADER) > 0;
+    for(i=0; i<h->nEvents && success; i++){
+        success = fprintf(file, "%lld %d %d", h->events[i].position, h->events[i].param, h->events[i].nValues) > 0;
+        for(j=0; j<h->events[i].nValues && success; j++)
+            success = fprintf(file, " %.9g", h->events[i].values[j]) > 0;
+        if(success)
+            success = fprintf(file, "\n") > 0;
+    }
+    if(fclose(file)!=0)
+        success = 0;
+    return success;
+}
+
+int saf_automation_load
+(
+    void * const hAuto,
+    const char* path
+)
+{
+    FILE* file;
+    char line[512];
+    long long position;
+    int j, param, nValues, success;
+    float values[SAF_AUTOMATION_MAX_NUM_VALUES];
+
+    saf_automation_clear(hAuto);
+    file = fopen(path, "r");
+    if(file==NULL)
+        return 0;
+    success = fgets(line, sizeof(line), file)!=NULL && strncmp(line, AUTOMATION_FILE_HEADER, strlen(AUTOMATION_FILE_HEADER))==0;
+    while(success && fscanf(file, "%lld %d %d", &position, &param, &nValues)==3){
+        if(nValues<0 || nValues>SAF_AUTOMATION_MAX_NUM_VALUES){
+            success = 0;
+            break;
+        }
+        for(j=0; j<nValues && success; j++)
+            success = fscanf(file, "%f", &(values[j]))==1;
+        if(success)
+            saf_automation_recordAt(hAuto, position, param, values, nValues);
+    }
+    if(success && !feof(file))
+        success = 0; /* (a malformed line) */
+    fclose(file);
+    if(!success)
+        saf_automation_clear(hAuto);
+    return success;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_automation.h
+ * @brief Recording and replaying of time-stamped parameter changes
+ *        (automation), for reproducing the workload of a session offline
+ *
+ * While recording, each parameter change (e.g. a call to a "set" function of
+ * one of the SAF examples) is passed to saf_automation_record(), as a
+ * parameter index and a small vector of values; and the audio thread calls
+ * saf_automation_advance() after processing each block, such that every event
+ * is stamped with the position (in samples) of the block it preceded. The
+ * meaning of the parameter indices is up to the caller (e.g. the
+ * BENCHMARK_AUTOMATION_PARAMS of the benchmark example).
+ *
+ * The events may be saved into a text file (one event per line:
+ * "position param nValues value0 value1 ..."), and loaded again; and are
+ * replayed in order with saf_automation_getNextEvent(), by asking for all
+ * events up to the position of the next block, before it is processed.
+ *
+ * @note Recording may be carried out from one control thread while the audio
+ *       thread advances the position; all other functions should be called
+ *       from one thread at a time.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_AUTOMATION_H_INCLUDED
+#define SAF_AUTOMATION_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Maximum number of values per event */
+#define SAF_AUTOMATION_MAX_NUM_VALUES ( 8 )
+
+/**
+ * Creates an (empty) automation recording
+ *
+ * @param[in] phAuto (&) address of saf_automation handle
+ */
+void saf_automation_create(/* Input Arguments */
+                           void ** const phAuto);
+
+/**
+ * Destroys an automation recording
+ *
+ * @param[in] phAuto (&) address of saf_automation handle
+ */
+void saf_automation_destroy(/* Input Arguments */
+                            void ** const phAuto);
+
+/**
+ * Removes all events, and rewinds the recording and replay positions to 0
+ */
+void saf_automation_clear(/* Input Arguments */
+                          void * const hAuto);
+
+/**
+ * Records a parameter change, at the current recording position
+ *
+ * @param[in] hAuto   saf_automation handle
+ * @param[in] param   Parameter index
+ * @param[in] values  Values of the parameter; nValues x 1
+ * @param[in] nValues Number of values (at most SAF_AUTOMATION_MAX_NUM_VALUES;
+ *                    any further values are dropped)
+ */
+void saf_automation_record(/* Input Arguments */
+                           void * const hAuto,
+                           int param,
+                           const float* values,
+                           int nValues);
+
+/**
+ * Records a parameter change, at the given position (e.g. for generating
+ * automation programmatically); the events need not be recorded in order
+ *
+ * @param[in] hAuto    saf_automation handle
+ * @param[in] position Position, in samples
+ * @param[in] param    Parameter index
+ * @param[in] values   Values of the parameter; nValues x 1
+ * @param[in] nValues  Number of values (at most SAF_AUTOMATION_MAX_NUM_VALUES)
+ */
+void saf_automation_recordAt(/* Input Arguments */
+                             void * const hAuto,
+                             long long position,
+                             int param,
+                             const float* values,
+                             int nValues);
+
+/**
+ * Advances the recording position by the number of samples of a processed
+ * block (i.e. call after each call to the processing function)
+ */
+void saf_automation_advance(/* Input Arguments */
+                            void * const hAuto,
+                            int nSamples);
+
+/** Returns the number of events */
+int saf_automation_getNumEvents(/* Input Arguments */
+                                void * const hAuto);
+
+/** Returns the position of the last event, in samples (-1: no events) */
+long long saf_automation_getLastPosition(/* Input Arguments */
+                                         void * const hAuto);
+
+/**
+ * Rewinds the replay to the first event
+ */
+void saf_automation_rewind(/* Input Arguments */
+                           void * const hAuto);
+
+/**
+ * Returns the next event to replay, if it is positioned at or before the
+ * given position (i.e. call until it returns 0, before processing each block,
+ * with the position of the first sample of the block)
+ *
+ * @param[in]  hAuto    saf_automation handle
+ * @param[in]  upTo     Position, in samples
+ * @param[out] position (&) position of the event (may be NULL)
+ * @param[out] param    (&) parameter index
+ * @param[out] values   Values; SAF_AUTOMATION_MAX_NUM_VALUES x 1
+ * @param[out] nValues  (&) number of values
+ * @returns    1 if an event was returned, 0 if there are no more events
+ *             up to 'upTo'
+ */
+int saf_automation_getNextEvent(/* Input Arguments */
+                                void * const hAuto,
+                                long long upTo,
+                                /* Output Arguments */
+                                long long* position,
+                                int* param,
+                                float* values,
+                                int* nValues);
+
+/**
+ * Saves the events into a text file
+ *
+ * @returns 1 if the file was written, 0 otherwise
+ */
+int saf_automation_save(/* Input Arguments */
+                        void * const hAuto,
+                        const char* path);
+
+/**
+ * Loads the events of a text file (see saf_automation_save()), replacing any
+ * existing events
+ *
+ * @returns 1 if the file was read, 0 otherwise (the events are then cleared)
+ */
+int saf_automation_load(/* Input Arguments */
+                        void * const hAuto,
+                        const char* path);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_AUTOMATION_H_INCLUDED */
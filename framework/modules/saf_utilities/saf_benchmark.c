@@ -0,0 +1,354 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_benchmark.c
+ * @brief Micro-benchmarks for the main saf_utilities kernels
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_benchmark.h"
+#include "../../resources/afSTFT/afSTFTlib.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+/** Length of the filters used for the convolver benchmarks */
+#define BENCHMARK_FILTER_LENGTH ( 1024 )
+/** Number of output channels used for the matrixConv benchmarks (binaural) */
+#define BENCHMARK_MATRIXCONV_NCH_OUT ( 2 )
+/** Upper limit on the number of calls per timing run */
+#define BENCHMARK_MAX_NUM_ITERATIONS ( 1<<24 )
+
+/** Data structure shared by the benchmarks (only what is needed is used) */
+typedef struct _benchmark_data {
+    void* h;                 /**< handle of the kernel under test */
+    int n, nCH, dim1, dim2;  /**< dimensions */
+    float* in, *out;         /**< real buffers */
+    float** in2d, **out2d;   /**< real buffers; nCH x n */
+    float_complex* cin, *cout, *cout2; /**< complex buffers */
+    complexVector* fd;       /**< afSTFT time-frequency buffers; nCH x 1 */
+    float b[3], a[3];        /**< biQuad coefficients */
+    float** wz;              /**< biQuad states; nCH x 2 */
+
+}benchmark_data;
+
+/** Prototype for the kernel under test (called once per iteration) */
+typedef void (*benchmark_func)(benchmark_data* d);
+
+static void bench_rfft_forward(benchmark_data* d)  { saf_rfft_forward(d->h, d->in, d->cout); }
+static void bench_rfft_backward(benchmark_data* d) { saf_rfft_backward(d->h, d->cout, d->out); }
+static void bench_matrixConv(benchmark_data* d)    { saf_matrixConv_apply(d->h, d->in, d->out); }
+static void bench_multiConv(benchmark_data* d)     { saf_multiConv_apply(d->h, d->in, d->out); }
+static void bench_afSTFT_forward(benchmark_data* d){ afSTFTforward(d->h, d->in2d, d->fd); }
+static void bench_afSTFT_inverse(benchmark_data* d){ afSTFTinverse(d->h, d->fd, d->out2d); }
+static void bench_cseig(benchmark_data* d)         { utility_cseig(d->h, d->cin, d->dim1, 1, d->cout, d->cout2, d->out); }
+static void bench_cpinv(benchmark_data* d)         { utility_cpinv(d->h, d->cin, d->dim1, d->dim2, d->cout); }
+static void bench_biQuad(benchmark_data* d)
+{
+    int ch;
+    for(ch=0; ch<d->nCH; ch++)
+        applyBiQuadFilter(d->b, d->a, d->wz[ch], d->in2d[ch], d->n);
+}
+
+/** Returns a uniformly distributed random number between -1 and 1 */
+static float benchmark_rand(void)
+{
+    return 2.0f*((float)rand()/(float)RAND_MAX) - 1.0f;
+}
+
+/** Fills a buffer with uniformly distributed random numbers */
+static void benchmark_fillRand(float* x, int len)
+{
+    int i;
+    for(i=0; i<len; i++)
+        x[i] = benchmark_rand();
+}
+
+/**
+ * Returns the time (in seconds) taken per call of 'func', by doubling the
+ * number of calls until a single timing run lasts at least 'minTime'
+ */
+static double benchmark_time
+(
+    benchmark_func func,
+    benchmark_data* d,
+    double minTime
+)
+{
+    int i, nIter;
+    double t0, elapsed;
+
+    func(d); /* warm-up (caches, lazily initialised tables, etc.) */
+    for(nIter = 1; ; nIter *= 2){
+        t0 = saf_benchmark_getTime();
+        for(i=0; i<nIter; i++)
+            func(d);
+        elapsed = saf_benchmark_getTime() - t0;
+        if(elapsed>=minTime || nIter>=BENCHMARK_MAX_NUM_ITERATIONS)
+            break;
+    }
+    return elapsed/(double)nIter;
+}
+
+/**
+ * Times 'func' and prints one line of the report; 'nSamples' is the number of
+ * samples processed per call (0 if not applicable)
+ */
+static void benchmark_report
+(
+    FILE* stream,
+    const char* kernel,
+    const char* config,
+    benchmark_func func,
+    benchmark_data* d,
+    int nSamples,
+    double minTime
+)
+{
+    double tPerCall;
+
+    tPerCall = benchmark_time(func, d, minTime);
+    if(nSamples>0)
+        fprintf(stream, "%-22s %-26s %12.1f %12.3f %12.2f\n", kernel, config, tPerCall*1e9,
+                tPerCall*1e9/(double)nSamples, (double)nSamples/(tPerCall*1e6));
+    else
+        fprintf(stream, "%-22s %-26s %12.1f %12s %12s\n", kernel, config, tPerCall*1e9, "-", "-");
+    fflush(stream);
+}
+
+const char* saf_benchmark_getBackendName(void)
+{
+#if defined(SAF_USE_INTEL_MKL)
+    return "Intel MKL (BLAS/LAPACK), Intel MKL (FFT)";
+#elif defined(SAF_USE_ATLAS)
+    return "ATLAS (BLAS/LAPACK), KissFFT (FFT)";
+#elif defined(SAF_USE_OPEN_BLAS_AND_LAPACKE)
+# if defined(__APPLE__)
+    return "OpenBLAS + LAPACKE (BLAS/LAPACK), Apple Accelerate (FFT)";
+# else
+    return "OpenBLAS + LAPACKE (BLAS/LAPACK), KissFFT (FFT)";
+# endif
+#elif defined(SAF_USE_BUILTIN_BLAS_AND_LAPACK)
+    return "built-in (BLAS/LAPACK), KissFFT (FFT)";
+#elif defined(__APPLE__)
+    return "Apple Accelerate (BLAS/LAPACK), Apple Accelerate (FFT)";
+#else
+    return "unknown";
+#endif
+}
+
+double saf_benchmark_getTime(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart/(double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+#endif
+}
+
+void saf_benchmark_run
+(
+    FILE* stream,
+    int quickFLAG
+)
+{
+    const int hopsFull[6] = {64, 128, 256, 512, 1024, 2048};
+    const int hopsQuick[2] = {128, 1024};
+    const int nCHFull[4] = {1, 4, 16, 64};
+    const int nCHQuick[2] = {1, 16};
+    const int eigDimsFull[7] = {4, 9, 16, 25, 36, 49, 64}; /* (N+1)^2, N = 1..7 */
+    const int eigDimsQuick[3] = {4, 16, 64};
+    const int pinvDims[4][2] = {{8, 4}, {22, 16}, {64, 25}, {64, 64}}; /* nLS x nSH */
+    const int* hops, *nCHs, *eigDims;
+    int i, j, k, ch, nHops, nNCHs, nEigDims, nPinvDims, hop, nCH, dim1, dim2, maxNCH;
+    double minTime;
+    char config[64];
+    float* H;
+    benchmark_data d;
+
+    hops = quickFLAG ? hopsQuick : hopsFull;
+    nHops = quickFLAG ? 2 : 6;
+    nCHs = quickFLAG ? nCHQuick : nCHFull;
+    nNCHs = quickFLAG ? 2 : 4;
+    eigDims = quickFLAG ? eigDimsQuick : eigDimsFull;
+    nEigDims = quickFLAG ? 3 : 7;
+    nPinvDims = quickFLAG ? 2 : 4;
+    minTime = quickFLAG ? 0.02 : 0.2;
+    maxNCH = nCHs[nNCHs-1];
+    srand(1);
+    memset(&d, 0, sizeof(benchmark_data));
+
+    fprintf(stream, "SAF micro-benchmarks; back-ends: %s\n", saf_benchmark_getBackendName());
+    fprintf(stream, "%-22s %-26s %12s %12s %12s\n", "kernel", "configuration", "ns/call", "ns/sample", "Msamples/s");
+
+    /* Real FFT (N = 2 x hop) */
+    for(i=0; i<nHops; i++){
+        hop = hops[i];
+        saf_rfft_create(&(d.h), 2*hop);
+        d.in = malloc1d(2*hop*sizeof(float));
+        d.out = malloc1d(2*hop*sizeof(float));
+        d.cout = malloc1d((hop+1)*sizeof(float_complex));
+        benchmark_fillRand(d.in, 2*hop);
+        sprintf(config, "N=%d", 2*hop);
+        benchmark_report(stream, "saf_rfft_forward", config, bench_rfft_forward, &d, 2*hop, minTime);
+        benchmark_report(stream, "saf_rfft_backward", config, bench_rfft_backward, &d, 2*hop, minTime);
+        saf_rfft_destroy(&(d.h));
+        free(d.in);
+        free(d.out);
+        free(d.cout);
+    }
+
+    /* Matrix convolver (nCHin -> 2, partitioned) */
+    H = malloc1d(maxNCH*BENCHMARK_MATRIXCONV_NCH_OUT*BENCHMARK_FILTER_LENGTH*sizeof(float));
+    benchmark_fillRand(H, maxNCH*BENCHMARK_MATRIXCONV_NCH_OUT*BENCHMARK_FILTER_LENGTH);
+    for(i=0; i<nHops; i++){
+        for(j=0; j<nNCHs; j++){
+            hop = hops[i];
+            nCH = nCHs[j];
+            saf_matrixConv_create(&(d.h), hop, H, BENCHMARK_FILTER_LENGTH, nCH, BENCHMARK_MATRIXCONV_NCH_OUT, 1);
+            d.in = malloc1d(nCH*hop*sizeof(float));
+            d.out = malloc1d(BENCHMARK_MATRIXCONV_NCH_OUT*hop*sizeof(float));
+            benchmark_fillRand(d.in, nCH*hop);
+            sprintf(config, "hop=%d %dx%d L=%d", hop, nCH, BENCHMARK_MATRIXCONV_NCH_OUT, BENCHMARK_FILTER_LENGTH);
+            benchmark_report(stream, "saf_matrixConv_apply", config, bench_matrixConv, &d, nCH*hop, minTime);
+            saf_matrixConv_destroy(&(d.h));
+            free(d.in);
+            free(d.out);
+        }
+    }
+
+    /* Multi-channel convolver (partitioned) */
+    for(i=0; i<nHops; i++){
+        for(j=0; j<nNCHs; j++){
+            hop = hops[i];
+            nCH = nCHs[j];
+            saf_multiConv_create(&(d.h), hop, H, BENCHMARK_FILTER_LENGTH, nCH, 1);
+            d.in = malloc1d(nCH*hop*sizeof(float));
+            d.out = malloc1d(nCH*hop*sizeof(float));
+            benchmark_fillRand(d.in, nCH*hop);
+            sprintf(config, "hop=%d nCH=%d L=%d", hop, nCH, BENCHMARK_FILTER_LENGTH);
+            benchmark_report(stream, "saf_multiConv_apply", config, bench_multiConv, &d, nCH*hop, minTime);
+            saf_multiConv_destroy(&(d.h));
+            free(d.in);
+            free(d.out);
+        }
+    }
+    free(H);
+
+    /* afSTFT (single-threaded, hybrid-mode disabled; supports hops up to 1024) */
+    for(i=0; i<nHops; i++){
+        if(hops[i]>1024)
+            continue;
+        for(j=0; j<nNCHs; j++){
+            hop = hops[i];
+            nCH = nCHs[j];
+            afSTFTinit(&(d.h), hop, nCH, nCH, 0, 0, 1);
+            d.in2d = (float**)malloc2d(nCH, hop, sizeof(float));
+            d.out2d = (float**)malloc2d(nCH, hop, sizeof(float));
+            d.fd = malloc1d(nCH*sizeof(complexVector));
+            for(ch=0; ch<nCH; ch++){
+                d.fd[ch].re = calloc1d(hop+1, sizeof(float));
+                d.fd[ch].im = calloc1d(hop+1, sizeof(float));
+                benchmark_fillRand(d.in2d[ch], hop);
+            }
+            sprintf(config, "hop=%d nCH=%d", hop, nCH);
+            benchmark_report(stream, "afSTFTforward", config, bench_afSTFT_forward, &d, nCH*hop, minTime);
+            benchmark_report(stream, "afSTFTinverse", config, bench_afSTFT_inverse, &d, nCH*hop, minTime);
+            afSTFTfree(d.h);
+            d.h = NULL;
+            for(ch=0; ch<nCH; ch++){
+                free(d.fd[ch].re);
+                free(d.fd[ch].im);
+            }
+            free(d.fd);
+            free(d.in2d);
+            free(d.out2d);
+        }
+    }
+
+    /* Hermitian eigen-decomposition (of a random spatial covariance matrix) */
+    for(i=0; i<nEigDims; i++){
+        dim1 = eigDims[i];
+        utility_cseig_create(&(d.h), dim1);
+        d.dim1 = dim1;
+        d.cin = malloc1d(dim1*dim1*sizeof(float_complex));
+        d.cout = malloc1d(dim1*dim1*sizeof(float_complex));
+        d.cout2 = malloc1d(dim1*dim1*sizeof(float_complex));
+        d.out = malloc1d(dim1*sizeof(float));
+        for(j=0; j<dim1; j++){
+            d.cin[j*dim1+j] = cmplxf(2.0f + benchmark_rand(), 0.0f);
+            for(k=j+1; k<dim1; k++){
+                d.cin[j*dim1+k] = cmplxf(0.5f*benchmark_rand(), 0.5f*benchmark_rand());
+                d.cin[k*dim1+j] = conjf(d.cin[j*dim1+k]);
+            }
+        }
+        sprintf(config, "%dx%d", dim1, dim1);
+        benchmark_report(stream, "utility_cseig", config, bench_cseig, &d, 0, minTime);
+        utility_cseig_destroy(&(d.h));
+        free(d.cin);
+        free(d.cout);
+        free(d.cout2);
+        free(d.out);
+    }
+
+    /* Pseudo-inverse (e.g. of a loudspeaker x spherical harmonic matrix) */
+    for(i=0; i<nPinvDims; i++){
+        dim1 = pinvDims[quickFLAG ? i+1 : i][0];
+        dim2 = pinvDims[quickFLAG ? i+1 : i][1];
+        utility_cpinv_create(&(d.h), dim1, dim2);
+        d.dim1 = dim1;
+        d.dim2 = dim2;
+        d.cin = malloc1d(dim1*dim2*sizeof(float_complex));
+        d.cout = malloc1d(dim2*dim1*sizeof(float_complex));
+        for(j=0; j<dim1*dim2; j++)
+            d.cin[j] = cmplxf(benchmark_rand(), benchmark_rand());
+        sprintf(config, "%dx%d", dim1, dim2);
+        benchmark_report(stream, "utility_cpinv", config, bench_cpinv, &d, 0, minTime);
+        utility_cpinv_destroy(&(d.h));
+        free(d.cin);
+        free(d.cout);
+    }
+
+    /* biQuad filter (one filter per channel) */
+    biQuadCoeffs(BIQUAD_FILTER_PEAK, 1e3f, 48e3f, 0.7071f, 6.0f, d.b, d.a);
+    for(i=0; i<nHops; i++){
+        for(j=0; j<nNCHs; j++){
+            hop = hops[i];
+            nCH = nCHs[j];
+            d.n = hop;
+            d.nCH = nCH;
+            d.in2d = (float**)malloc2d(nCH, hop, sizeof(float));
+            d.wz = (float**)calloc2d(nCH, 2, sizeof(float));
+            for(ch=0; ch<nCH; ch++)
+                benchmark_fillRand(d.in2d[ch], hop);
+            sprintf(config, "hop=%d nCH=%d", hop, nCH);
+            benchmark_report(stream, "applyBiQuadFilter", config, bench_biQuad, &d, nCH*hop, minTime);
+            free(d.in2d);
+            free(d.wz);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_benchmark.h
+ * @brief Micro-benchmarks for the main saf_utilities kernels
+ *
+ * saf_benchmark_run() times the real FFT, the matrix/multi-channel convolvers,
+ * afSTFT, the complex eigen-decomposition and pseudo-inverse, and the biQuad
+ * filter, over a range of hop sizes (64..2048) and channel counts (1..64);
+ * printing one line per configuration, with the time per call, the time per
+ * sample (where applicable) and the throughput. The first line of the report
+ * names the back-ends that SAF was built with, so that reports obtained with
+ * different builds (e.g. Intel MKL, Apple Accelerate, OpenBLAS + KissFFT) may
+ * be compared directly, or against an earlier report to detect regressions.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_BENCHMARK_H_INCLUDED
+#define SAF_BENCHMARK_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdio.h>
+
+/**
+ * Returns a description of the BLAS/LAPACK and FFT back-ends that SAF was
+ * built with (e.g. "Intel MKL (BLAS/LAPACK), Intel MKL (FFT)")
+ */
+const char* saf_benchmark_getBackendName(void);
+
+/**
+ * Returns the value of a monotonic clock, in seconds
+ */
+double saf_benchmark_getTime(void);
+
+/**
+ * Runs all of the micro-benchmarks and prints the results
+ *
+ * @param[in] stream    Stream to print the report to (e.g. stdout)
+ * @param[in] quickFLAG '1' fewer configurations and shorter timing runs (e.g.
+ *                      for a quick regression check), '0' everything
+ */
+void saf_benchmark_run(/* Input Arguments */
+                       FILE* stream,
+                       int quickFLAG);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_BENCHMARK_H_INCLUDED */
@@ -0,0 +1,2190 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_builtinBlas.c
+ * @brief A minimal, dependency-free subset of CBLAS and LAPACKE, for builds
+ *        without a performance library (e.g. WebAssembly builds for the
+ *        browser)
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+
+#ifdef SAF_BUILTINBLAS_H_INCLUDED
+
+/** Index of the first element of a strided vector (BLAS convention) */
+#define BUILTIN_BLAS_START(N, inc) ( (inc)>0 ? 0 : (1-(N))*(inc) )
+
+
+/* ========================================================================== */
+/*                              Level 1 (Vectors)                             */
+/* ========================================================================== */
+
+void cblas_saxpy(const int N, const float alpha, const float* X, const int incX, float* Y, const int incY)
+{
+    int i, ix, iy;
+    if(N<1 || alpha==0.0f)
+        return;
+    if(incX==1 && incY==1){
+        for(i=0; i<N; i++)
+            Y[i] += alpha*X[i];
+        return;
+    }
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY)
+        Y[iy] += alpha*X[ix];
+}
+
+float cblas_sdot(const int N, const float* X, const int incX, const float* Y, const int incY)
+{
+    int i, ix, iy;
+    float sum;
+    sum = 0.0f;
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY)
+        sum += X[ix]*Y[iy];
+    return sum;
+}
+
+double cblas_ddot(const int N, const double* X, const int incX, const double* Y, const int incY)
+{
+    int i, ix, iy;
+    double sum;
+    sum = 0.0;
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY)
+        sum += X[ix]*Y[iy];
+    return sum;
+}
+
+/** dot = x^T*y, or x^H*y if 'conjX' (interleaved complex vectors) */
+static void builtin_cdot(const int N, const float* X, const int incX, const float* Y, const int incY, const int conjX, float* dot)
+{
+    int i, ix, iy;
+    float re, im, xi;
+    re = im = 0.0f;
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY){
+        xi = conjX ? -X[2*ix+1] : X[2*ix+1];
+        re += X[2*ix]*Y[2*iy] - xi*Y[2*iy+1];
+        im += X[2*ix]*Y[2*iy+1] + xi*Y[2*iy];
+    }
+    dot[0] = re;
+    dot[1] = im;
+}
+
+void cblas_cdotu_sub(const int N, const void* X, const int incX, const void* Y, const int incY, void* dotu)
+{
+    builtin_cdot(N, (const float*)X, incX, (const float*)Y, incY, 0, (float*)dotu);
+}
+
+void cblas_cdotc_sub(const int N, const void* X, const int incX, const void* Y, const int incY, void* dotc)
+{
+    builtin_cdot(N, (const float*)X, incX, (const float*)Y, incY, 1, (float*)dotc);
+}
+
+void cblas_scopy(const int N, const float* X, const int incX, float* Y, const int incY)
+{
+    int i, ix, iy;
+    if(N<1)
+        return;
+    if(incX==1 && incY==1){
+        memcpy(Y, X, N*sizeof(float));
+        return;
+    }
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY)
+        Y[iy] = X[ix];
+}
+
+void cblas_dcopy(const int N, const double* X, const int incX, double* Y, const int incY)
+{
+    int i, ix, iy;
+    if(N<1)
+        return;
+    if(incX==1 && incY==1){
+        memcpy(Y, X, N*sizeof(double));
+        return;
+    }
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY)
+        Y[iy] = X[ix];
+}
+
+void cblas_ccopy(const int N, const void* X, const int incX, void* Y, const int incY)
+{
+    int i, ix, iy;
+    const float* x;
+    float* y;
+    if(N<1)
+        return;
+    if(incX==1 && incY==1){
+        memcpy(Y, X, N*2*sizeof(float));
+        return;
+    }
+    x = (const float*)X;
+    y = (float*)Y;
+    ix = BUILTIN_BLAS_START(N, incX);
+    iy = BUILTIN_BLAS_START(N, incY);
+    for(i=0; i<N; i++, ix+=incX, iy+=incY){
+        y[2*iy] = x[2*ix];
+        y[2*iy+1] = x[2*ix+1];
+    }
+}
+
+void cblas_sscal(const int N, const float alpha, float* X, const int incX)
+{
+    int i;
+    if(incX<1)
+        return; /* (as the reference BLAS) */
+    for(i=0; i<N; i++)
+        X[i*incX] *= alpha;
+}
+
+void cblas_dscal(const int N, const double alpha, double* X, const int incX)
+{
+    int i;
+    if(incX<1)
+        return;
+    for(i=0; i<N; i++)
+        X[i*incX] *= alpha;
+}
+
+void cblas_cscal(const int N, const void* alpha, void* X, const int incX)
+{
+    int i;
+    float ar, ai, re, *x;
+    if(incX<1)
+        return;
+    ar = ((const float*)alpha)[0];
+    ai = ((const float*)alpha)[1];
+    x = (float*)X;
+    for(i=0; i<N; i++){
+        re = ar*x[2*i*incX] - ai*x[2*i*incX+1];
+        x[2*i*incX+1] = ar*x[2*i*incX+1] + ai*x[2*i*incX];
+        x[2*i*incX] = re;
+    }
+}
+
+void cblas_zscal(const int N, const void* alpha, void* X, const int incX)
+{
+    int i;
+    double ar, ai, re, *x;
+    if(incX<1)
+        return;
+    ar = ((const double*)alpha)[0];
+    ai = ((const double*)alpha)[1];
+    x = (double*)X;
+    for(i=0; i<N; i++){
+        re = ar*x[2*i*incX] - ai*x[2*i*incX+1];
+        x[2*i*incX+1] = ar*x[2*i*incX+1] + ai*x[2*i*incX];
+        x[2*i*incX] = re;
+    }
+}
+
+float cblas_snrm2(const int N, const float* X, const int incX)
+{
+    int i;
+    double sum;
+    if(N<1 || incX<1)
+        return 0.0f;
+    sum = 0.0; /* (accumulated in double precision, which avoids the overflow of the squares) */
+    for(i=0; i<N; i++)
+        sum += (double)X[i*incX]*(double)X[i*incX];
+    return (float)sqrt(sum);
+}
+
+CBLAS_INDEX cblas_isamax(const int N, const float* X, const int incX)
+{
+    int i, ind;
+    float maxVal;
+    if(N<1 || incX<1)
+        return 0;
+    ind = 0;
+    maxVal = fabsf(X[0]);
+    for(i=1; i<N; i++){
+        if(fabsf(X[i*incX])>maxVal){
+            maxVal = fabsf(X[i*incX]);
+            ind = i;
+        }
+    }
+    return (CBLAS_INDEX)ind;
+}
+
+CBLAS_INDEX cblas_icamax(const int N, const void* X, const int incX)
+{
+    int i, ind;
+    float maxVal, val;
+    const float* x;
+    if(N<1 || incX<1)
+        return 0;
+    x = (const float*)X;
+    ind = 0;
+    maxVal = fabsf(x[0]) + fabsf(x[1]);
+    for(i=1; i<N; i++){
+        val = fabsf(x[2*i*incX]) + fabsf(x[2*i*incX+1]);
+        if(val>maxVal){
+            maxVal = val;
+            ind = i;
+        }
+    }
+    return (CBLAS_INDEX)ind;
+}
+
+
+/* ========================================================================== */
+/*                          Level 2 (Matrix-Vector)                           */
+/* ========================================================================== */
+
+/*
+ * The column-major cases are carried out as the row-major ones, with A viewed
+ * as its (row-major) transpose; i.e. M and N are swapped, and the
+ * transposition is flipped.
+ */
+
+void cblas_sgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA, const int M, const int N, const float alpha,
+                 const float* A, const int lda, const float* X, const int incX, const float beta, float* Y, const int incY)
+{
+    int i, j, nRows, nCols, trans, lenX, lenY, ix, iy;
+    float sum, ax;
+
+    nRows = order==CblasRowMajor ? M : N;
+    nCols = order==CblasRowMajor ? N : M;
+    trans = (TransA!=CblasNoTrans) == (order==CblasRowMajor);
+    lenX = trans ? nRows : nCols;
+    lenY = trans ? nCols : nRows;
+    if(lenY<1)
+        return;
+
+    /* y = beta*y */
+    iy = BUILTIN_BLAS_START(lenY, incY);
+    for(i=0; i<lenY; i++, iy+=incY)
+        Y[iy] = beta==0.0f ? 0.0f : beta*Y[iy];
+
+    if(!trans){
+        /* y(i) += alpha*A(i,:)*x */
+        iy = BUILTIN_BLAS_START(lenY, incY);
+        for(i=0; i<nRows; i++, iy+=incY){
+            sum = 0.0f;
+            ix = BUILTIN_BLAS_START(lenX, incX);
+            for(j=0; j<nCols; j++, ix+=incX)
+                sum += A[i*lda+j]*X[ix];
+            Y[iy] += alpha*sum;
+        }
+    }
+    else{
+        /* y += alpha*x(i)*A(i,:)^T */
+        ix = BUILTIN_BLAS_START(lenX, incX);
+        for(i=0; i<nRows; i++, ix+=incX){
+            ax = alpha*X[ix];
+            iy = BUILTIN_BLAS_START(lenY, incY);
+            for(j=0; j<nCols; j++, iy+=incY)
+                Y[iy] += ax*A[i*lda+j];
+        }
+    }
+}
+
+void cblas_dgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA, const int M, const int N, const double alpha,
+                 const double* A, const int lda, const double* X, const int incX, const double beta, double* Y, const int incY)
+{
+    int i, j, nRows, nCols, trans, lenX, lenY, ix, iy;
+    double sum, ax;
+
+    nRows = order==CblasRowMajor ? M : N;
+    nCols = order==CblasRowMajor ? N : M;
+    trans = (TransA!=CblasNoTrans) == (order==CblasRowMajor);
+    lenX = trans ? nRows : nCols;
+    lenY = trans ? nCols : nRows;
+    if(lenY<1)
+        return;
+
+    iy = BUILTIN_BLAS_START(lenY, incY);
+    for(i=0; i<lenY; i++, iy+=incY)
+        Y[iy] = beta==0.0 ? 0.0 : beta*Y[iy];
+
+    if(!trans){
+        iy = BUILTIN_BLAS_START(lenY, incY);
+        for(i=0; i<nRows; i++, iy+=incY){
+            sum = 0.0;
+            ix = BUILTIN_BLAS_START(lenX, incX);
+            for(j=0; j<nCols; j++, ix+=incX)
+                sum += A[i*lda+j]*X[ix];
+            Y[iy] += alpha*sum;
+        }
+    }
+    else{
+        ix = BUILTIN_BLAS_START(lenX, incX);
+        for(i=0; i<nRows; i++, ix+=incX){
+            ax = alpha*X[ix];
+            iy = BUILTIN_BLAS_START(lenY, incY);
+            for(j=0; j<nCols; j++, iy+=incY)
+                Y[iy] += ax*A[i*lda+j];
+        }
+    }
+}
+
+void cblas_cgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA, const int M, const int N, const void* alpha,
+                 const void* A, const int lda, const void* X, const int incX, const void* beta, void* Y, const int incY)
+{
+    int i, j, nRows, nCols, trans, conjA, lenX, lenY, ix, iy;
+    float ar, ai, br, bi, re, im, xr, xi, air, aii;
+    const float* a, *x;
+    float* y;
+
+    a = (const float*)A;
+    x = (const float*)X;
+    y = (float*)Y;
+    ar = ((const float*)alpha)[0];
+    ai = ((const float*)alpha)[1];
+    br = ((const float*)beta)[0];
+    bi = ((const float*)beta)[1];
+    nRows = order==CblasRowMajor ? M : N;
+    nCols = order==CblasRowMajor ? N : M;
+    trans = (TransA!=CblasNoTrans) == (order==CblasRowMajor);
+    conjA = TransA==CblasConjTrans;
+    lenX = trans ? nRows : nCols;
+    lenY = trans ? nCols : nRows;
+    if(lenY<1)
+        return;
+
+    iy = BUILTIN_BLAS_START(lenY, incY);
+    for(i=0; i<lenY; i++, iy+=incY){
+        re = br*y[2*iy] - bi*y[2*iy+1];
+        im = br*y[2*iy+1] + bi*y[2*iy];
+        y[2*iy] = br==0.0f && bi==0.0f ? 0.0f : re;
+        y[2*iy+1] = br==0.0f && bi==0.0f ? 0.0f : im;
+    }
+
+    if(!trans){
+        iy = BUILTIN_BLAS_START(lenY, incY);
+        for(i=0; i<nRows; i++, iy+=incY){
+            re = im = 0.0f;
+            ix = BUILTIN_BLAS_START(lenX, incX);
+            for(j=0; j<nCols; j++, ix+=incX){
+                air = a[2*(i*lda+j)];
+                aii = conjA ? -a[2*(i*lda+j)+1] : a[2*(i*lda+j)+1];
+                re += air*x[2*ix] - aii*x[2*ix+1];
+                im += air*x[2*ix+1] + aii*x[2*ix];
+            }
+            y[2*iy] += ar*re - ai*im;
+            y[2*iy+1] += ar*im + ai*re;
+        }
+    }
+    else{
+        ix = BUILTIN_BLAS_START(lenX, incX);
+        for(i=0; i<nRows; i++, ix+=incX){
+            xr = ar*x[2*ix] - ai*x[2*ix+1];
+            xi = ar*x[2*ix+1] + ai*x[2*ix];
+            iy = BUILTIN_BLAS_START(lenY, incY);
+            for(j=0; j<nCols; j++, iy+=incY){
+                air = a[2*(i*lda+j)];
+                aii = conjA ? -a[2*(i*lda+j)+1] : a[2*(i*lda+j)+1];
+                y[2*iy] += xr*air - xi*aii;
+                y[2*iy+1] += xr*aii + xi*air;
+            }
+        }
+    }
+}
+
+void cblas_dger(const enum CBLAS_ORDER order, const int M, const int N, const double alpha, const double* X, const int incX,
+                const double* Y, const int incY, double* A, const int lda)
+{
+    int i, j, nRows, nCols, ix, iy, incR, incC;
+    const double* r, *c;
+    double ar;
+
+    /* (the column-major case is A^T = alpha*y*x^T + A^T) */
+    nRows = order==CblasRowMajor ? M : N;
+    nCols = order==CblasRowMajor ? N : M;
+    r = order==CblasRowMajor ? X : Y;
+    c = order==CblasRowMajor ? Y : X;
+    incR = order==CblasRowMajor ? incX : incY;
+    incC = order==CblasRowMajor ? incY : incX;
+    ix = BUILTIN_BLAS_START(nRows, incR);
+    for(i=0; i<nRows; i++, ix+=incR){
+        ar = alpha*r[ix];
+        iy = BUILTIN_BLAS_START(nCols, incC);
+        for(j=0; j<nCols; j++, iy+=incC)
+            A[i*lda+j] += ar*c[iy];
+    }
+}
+
+
+/* ========================================================================== */
+/*                          Level 3 (Matrix-Matrix)                           */
+/* ========================================================================== */
+
+/*
+ * The kernels below are written for row-major storage; the column-major cases
+ * are carried out as C^T = op(B)^T*op(A)^T, i.e. with A and B (and M and N)
+ * swapped, since a column-major matrix is its own transpose in row-major
+ * storage. If B is not transposed, then each row of C is accumulated from
+ * whole rows of B (AXPYs over contiguous memory); otherwise, each element of C
+ * is the dot product of a row of op(A) and a row of B.
+ */
+
+/** Row-major C = alpha*op(A)*op(B) + beta*C */
+static void builtin_sgemm_rowMajor(const int transA, const int transB, const int M, const int N, const int K, const float alpha,
+                                   const float* A, const int lda, const float* B, const int ldb, const float beta, float* C, const int ldc)
+{
+    int i, j, p;
+    float aip, sum;
+    float* Ci;
+    const float* Ai, *Bp, *Bj;
+
+    for(i=0; i<M; i++){
+        Ci = &C[i*ldc];
+        if(!transB){
+            if(beta==0.0f)
+                memset(Ci, 0, N*sizeof(float));
+            else if(beta!=1.0f)
+                for(j=0; j<N; j++)
+                    Ci[j] *= beta;
+            for(p=0; p<K; p++){
+                aip = alpha*(transA ? A[p*lda+i] : A[i*lda+p]);
+                if(aip==0.0f)
+                    continue;
+                Bp = &B[p*ldb];
+                for(j=0; j<N; j++)
+                    Ci[j] += aip*Bp[j];
+            }
+        }
+        else{
+            Ai = &A[i*lda];
+            for(j=0; j<N; j++){
+                Bj = &B[j*ldb];
+                sum = 0.0f;
+                if(!transA)
+                    for(p=0; p<K; p++)
+                        sum += Ai[p]*Bj[p];
+                else
+                    for(p=0; p<K; p++)
+                        sum += A[p*lda+i]*Bj[p];
+                Ci[j] = beta==0.0f ? alpha*sum : alpha*sum + beta*Ci[j];
+            }
+        }
+    }
+}
+
+void cblas_sgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA, const enum CBLAS_TRANSPOSE TransB,
+                 const int M, const int N, const int K, const float alpha, const float* A, const int lda,
+                 const float* B, const int ldb, const float beta, float* C, const int ldc)
+{
+    if(M<1 || N<1)
+        return;
+    if(Order==CblasRowMajor)
+        builtin_sgemm_rowMajor(TransA!=CblasNoTrans, TransB!=CblasNoTrans, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    else
+        builtin_sgemm_rowMajor(TransB!=CblasNoTrans, TransA!=CblasNoTrans, N, M, K, alpha, B, ldb, A, lda, beta, C, ldc);
+}
+
+/** Row-major C = alpha*op(A)*op(B) + beta*C */
+static void builtin_dgemm_rowMajor(const int transA, const int transB, const int M, const int N, const int K, const double alpha,
+                                   const double* A, const int lda, const double* B, const int ldb, const double beta, double* C, const int ldc)
+{
+    int i, j, p;
+    double aip, sum;
+    double* Ci;
+    const double* Ai, *Bp, *Bj;
+
+    for(i=0; i<M; i++){
+        Ci = &C[i*ldc];
+        if(!transB){
+            if(beta==0.0)
+                memset(Ci, 0, N*sizeof(double));
+            else if(beta!=1.0)
+                for(j=0; j<N; j++)
+                    Ci[j] *= beta;
+            for(p=0; p<K; p++){
+                aip = alpha*(transA ? A[p*lda+i] : A[i*lda+p]);
+                if(aip==0.0)
+                    continue;
+                Bp = &B[p*ldb];
+                for(j=0; j<N; j++)
+                    Ci[j] += aip*Bp[j];
+            }
+        }
+        else{
+            Ai = &A[i*lda];
+            for(j=0; j<N; j++){
+                Bj = &B[j*ldb];
+                sum = 0.0;
+                if(!transA)
+                    for(p=0; p<K; p++)
+                        sum += Ai[p]*Bj[p];
+                else
+                    for(p=0; p<K; p++)
+                        sum += A[p*lda+i]*Bj[p];
+                Ci[j] = beta==0.0 ? alpha*sum : alpha*sum + beta*Ci[j];
+            }
+        }
+    }
+}
+
+void cblas_dgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA, const enum CBLAS_TRANSPOSE TransB,
+                 const int M, const int N, const int K, const double alpha, const double* A, const int lda,
+                 const double* B, const int ldb, const double beta, double* C, const int ldc)
+{
+    if(M<1 || N<1)
+        return;
+    if(Order==CblasRowMajor)
+        builtin_dgemm_rowMajor(TransA!=CblasNoTrans, TransB!=CblasNoTrans, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    else
+        builtin_dgemm_rowMajor(TransB!=CblasNoTrans, TransA!=CblasNoTrans, N, M, K, alpha, B, ldb, A, lda, beta, C, ldc);
+}
+
+/**
+ * Row-major C = alpha*op(A)*op(B) + beta*C, for interleaved complex matrices;
+ * 'transX' is 0 (no transpose), 1 (transpose) or 2 (conjugate transpose)
+ */
+static void builtin_cgemm_rowMajor(const int transA, const int transB, const int M, const int N, const int K, const float* alpha,
+                                   const float* A, const int lda, const float* B, const int ldb, const float* beta, float* C, const int ldc)
+{
+    int i, j, p, a_ip;
+    float ar, ai, br, bi, re, im, xr, xi, yi, cr;
+    float* Ci;
+    const float* Bp, *Bj;
+
+    ar = alpha[0]; ai = alpha[1];
+    br = beta[0];  bi = beta[1];
+    for(i=0; i<M; i++){
+        Ci = &C[2*i*ldc];
+
+        /* C(i,:) = beta*C(i,:) */
+        if(br==0.0f && bi==0.0f)
+            memset(Ci, 0, 2*N*sizeof(float));
+        else if(br!=1.0f || bi!=0.0f){
+            for(j=0; j<N; j++){
+                cr = br*Ci[2*j] - bi*Ci[2*j+1];
+                Ci[2*j+1] = br*Ci[2*j+1] + bi*Ci[2*j];
+                Ci[2*j] = cr;
+            }
+        }
+
+        if(!transB){
+            /* C(i,:) += (alpha*op(A)(i,p))*B(p,:) */
+            for(p=0; p<K; p++){
+                a_ip = transA ? p*lda+i : i*lda+p;
+                xi = transA==2 ? -A[2*a_ip+1] : A[2*a_ip+1];
+                re = ar*A[2*a_ip] - ai*xi;
+                im = ar*xi + ai*A[2*a_ip];
+                if(re==0.0f && im==0.0f)
+                    continue;
+                Bp = &B[2*p*ldb];
+                for(j=0; j<N; j++){
+                    Ci[2*j]   += re*Bp[2*j] - im*Bp[2*j+1];
+                    Ci[2*j+1] += re*Bp[2*j+1] + im*Bp[2*j];
+                }
+            }
+        }
+        else{
+            /* C(i,j) += alpha*(op(A)(i,:)*op(B)(:,j)) */
+            for(j=0; j<N; j++){
+                Bj = &B[2*j*ldb];
+                re = im = 0.0f;
+                for(p=0; p<K; p++){
+                    a_ip = transA ? p*lda+i : i*lda+p;
+                    xr = A[2*a_ip];
+                    xi = transA==2 ? -A[2*a_ip+1] : A[2*a_ip+1];
+                    yi = transB==2 ? -Bj[2*p+1] : Bj[2*p+1];
+                    re += xr*Bj[2*p] - xi*yi;
+                    im += xr*yi + xi*Bj[2*p];
+                }
+                Ci[2*j]   += ar*re - ai*im;
+                Ci[2*j+1] += ar*im + ai*re;
+            }
+        }
+    }
+}
+
+/** Maps a CBLAS_TRANSPOSE to the 'transX' argument of the complex kernels */
+static int builtin_transFlag(const enum CBLAS_TRANSPOSE trans)
+{
+    return trans==CblasNoTrans ? 0 : (trans==CblasTrans ? 1 : 2);
+}
+
+void cblas_cgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA, const enum CBLAS_TRANSPOSE TransB,
+                 const int M, const int N, const int K, const void* alpha, const void* A, const int lda,
+                 const void* B, const int ldb, const void* beta, void* C, const int ldc)
+{
+    if(M<1 || N<1)
+        return;
+    if(Order==CblasRowMajor)
+        builtin_cgemm_rowMajor(builtin_transFlag(TransA), builtin_transFlag(TransB), M, N, K, (const float*)alpha,
+                               (const float*)A, lda, (const float*)B, ldb, (const float*)beta, (float*)C, ldc);
+    else
+        builtin_cgemm_rowMajor(builtin_transFlag(TransB), builtin_transFlag(TransA), N, M, K, (const float*)alpha,
+                               (const float*)B, ldb, (const float*)A, lda, (const float*)beta, (float*)C, ldc);
+}
+
+/** Double precision version of builtin_cgemm_rowMajor() */
+static void builtin_zgemm_rowMajor(const int transA, const int transB, const int M, const int N, const int K, const double* alpha,
+                                   const double* A, const int lda, const double* B, const int ldb, const double* beta, double* C, const int ldc)
+{
+    int i, j, p, a_ip;
+    double ar, ai, br, bi, re, im, xr, xi, yi, cr;
+    double* Ci;
+    const double* Bp, *Bj;
+
+    ar = alpha[0]; ai = alpha[1];
+    br = beta[0];  bi = beta[1];
+    for(i=0; i<M; i++){
+        Ci = &C[2*i*ldc];
+        if(br==0.0 && bi==0.0)
+            memset(Ci, 0, 2*N*sizeof(double));
+        else if(br!=1.0 || bi!=0.0){
+            for(j=0; j<N; j++){
+                cr = br*Ci[2*j] - bi*Ci[2*j+1];
+                Ci[2*j+1] = br*Ci[2*j+1] + bi*Ci[2*j];
+                Ci[2*j] = cr;
+            }
+        }
+        if(!transB){
+            for(p=0; p<K; p++){
+                a_ip = transA ? p*lda+i : i*lda+p;
+                xi = transA==2 ? -A[2*a_ip+1] : A[2*a_ip+1];
+                re = ar*A[2*a_ip] - ai*xi;
+                im = ar*xi + ai*A[2*a_ip];
+                if(re==0.0 && im==0.0)
+                    continue;
+                Bp = &B[2*p*ldb];
+                for(j=0; j<N; j++){
+                    Ci[2*j]   += re*Bp[2*j] - im*Bp[2*j+1];
+                    Ci[2*j+1] += re*Bp[2*j+1] + im*Bp[2*j];
+                }
+            }
+        }
+        else{
+            for(j=0; j<N; j++){
+                Bj = &B[2*j*ldb];
+                re = im = 0.0;
+                for(p=0; p<K; p++){
+                    a_ip = transA ? p*lda+i : i*lda+p;
+                    xr = A[2*a_ip];
+                    xi = transA==2 ? -A[2*a_ip+1] : A[2*a_ip+1];
+                    yi = transB==2 ? -Bj[2*p+1] : Bj[2*p+1];
+                    re += xr*Bj[2*p] - xi*yi;
+                    im += xr*yi + xi*Bj[2*p];
+                }
+                Ci[2*j]   += ar*re - ai*im;
+                Ci[2*j+1] += ar*im + ai*re;
+            }
+        }
+    }
+}
+
+void cblas_zgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA, const enum CBLAS_TRANSPOSE TransB,
+                 const int M, const int N, const int K, const void* alpha, const void* A, const int lda,
+                 const void* B, const int ldb, const void* beta, void* C, const int ldc)
+{
+    if(M<1 || N<1)
+        return;
+    if(Order==CblasRowMajor)
+        builtin_zgemm_rowMajor(builtin_transFlag(TransA), builtin_transFlag(TransB), M, N, K, (const double*)alpha,
+                               (const double*)A, lda, (const double*)B, ldb, (const double*)beta, (double*)C, ldc);
+    else
+        builtin_zgemm_rowMajor(builtin_transFlag(TransB), builtin_transFlag(TransA), N, M, K, (const double*)alpha,
+                               (const double*)B, ldb, (const double*)A, lda, (const double*)beta, (double*)C, ldc);
+}
+
+
+/* ========================================================================== */
+/*                      LAPACK (General Linear Solvers)                       */
+/* ========================================================================== */
+
+/* All matrices are column-major, i.e. element (i,j) is a[j*lda+i], and the
+ * pivot indices are one-based; as in LAPACK. */
+
+lapack_int LAPACKE_sgetrf(int matrix_layout, lapack_int m, lapack_int n, float* a, lapack_int lda, lapack_int* ipiv)
+{
+    int i, j, c, p, info;
+    float maxVal, tmp, f;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    info = 0;
+    for(j=0; j<MIN(m,n); j++){
+        /* partial pivoting */
+        p = j;
+        maxVal = fabsf(a[j*lda+j]);
+        for(i=j+1; i<m; i++){
+            if(fabsf(a[j*lda+i])>maxVal){
+                maxVal = fabsf(a[j*lda+i]);
+                p = i;
+            }
+        }
+        ipiv[j] = p+1;
+        if(a[j*lda+p]!=0.0f){
+            if(p!=j){
+                for(c=0; c<n; c++){
+                    tmp = a[c*lda+j];
+                    a[c*lda+j] = a[c*lda+p];
+                    a[c*lda+p] = tmp;
+                }
+            }
+            for(i=j+1; i<m; i++)
+                a[j*lda+i] /= a[j*lda+j];
+        }
+        else if(info==0)
+            info = j+1; /* (U is singular; the factorisation is still completed) */
+
+        /* update of the trailing sub-matrix (down the columns) */
+        for(c=j+1; c<n; c++){
+            f = a[c*lda+j];
+            if(f!=0.0f)
+                for(i=j+1; i<m; i++)
+                    a[c*lda+i] -= a[j*lda+i]*f;
+        }
+    }
+    return info;
+}
+
+/** Solves A*X = B, given the LU decomposition of A (as ?getrs) */
+static void builtin_sgetrs(int n, int nrhs, const float* a, int lda, const int* ipiv, float* b, int ldb)
+{
+    int i, j, k;
+    float tmp, *bk;
+
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){
+            if(ipiv[i]-1!=i){
+                tmp = bk[i];
+                bk[i] = bk[ipiv[i]-1];
+                bk[ipiv[i]-1] = tmp;
+            }
+        }
+        for(j=0; j<n; j++) /* L (unit diagonal) */
+            for(i=j+1; i<n; i++)
+                bk[i] -= a[j*lda+i]*bk[j];
+        for(j=n-1; j>=0; j--){ /* U */
+            bk[j] /= a[j*lda+j];
+            for(i=0; i<j; i++)
+                bk[i] -= a[j*lda+i]*bk[j];
+        }
+    }
+}
+
+lapack_int LAPACKE_sgesv(int matrix_layout, lapack_int n, lapack_int nrhs, float* a, lapack_int lda, lapack_int* ipiv, float* b, lapack_int ldb)
+{
+    int info;
+    info = LAPACKE_sgetrf(matrix_layout, n, n, a, lda, ipiv);
+    if(info==0)
+        builtin_sgetrs(n, nrhs, a, lda, ipiv, b, ldb);
+    return info;
+}
+
+lapack_int LAPACKE_sgetri(int matrix_layout, lapack_int n, float* a, lapack_int lda, const lapack_int* ipiv)
+{
+    int i, j;
+    float* inv;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    for(i=0; i<n; i++)
+        if(a[i*lda+i]==0.0f)
+            return i+1;
+    /* (solves A*inv(A) = I) */
+    inv = calloc1d(n*n, sizeof(float));
+    for(i=0; i<n; i++)
+        inv[i*n+i] = 1.0f;
+    builtin_sgetrs(n, n, a, lda, ipiv, inv, n);
+    for(j=0; j<n; j++)
+        memcpy(&a[j*lda], &inv[j*n], n*sizeof(float));
+    free(inv);
+    return 0;
+}
+
+lapack_int LAPACKE_dgetrf(int matrix_layout, lapack_int m, lapack_int n, double* a, lapack_int lda, lapack_int* ipiv)
+{
+    int i, j, c, p, info;
+    double maxVal, tmp, f;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    info = 0;
+    for(j=0; j<MIN(m,n); j++){
+        p = j;
+        maxVal = fabs(a[j*lda+j]);
+        for(i=j+1; i<m; i++){
+            if(fabs(a[j*lda+i])>maxVal){
+                maxVal = fabs(a[j*lda+i]);
+                p = i;
+            }
+        }
+        ipiv[j] = p+1;
+        if(a[j*lda+p]!=0.0){
+            if(p!=j){
+                for(c=0; c<n; c++){
+                    tmp = a[c*lda+j];
+                    a[c*lda+j] = a[c*lda+p];
+                    a[c*lda+p] = tmp;
+                }
+            }
+            for(i=j+1; i<m; i++)
+                a[j*lda+i] /= a[j*lda+j];
+        }
+        else if(info==0)
+            info = j+1;
+        for(c=j+1; c<n; c++){
+            f = a[c*lda+j];
+            if(f!=0.0)
+                for(i=j+1; i<m; i++)
+                    a[c*lda+i] -= a[j*lda+i]*f;
+        }
+    }
+    return info;
+}
+
+/** Double precision version of builtin_sgetrs() */
+static void builtin_dgetrs(int n, int nrhs, const double* a, int lda, const int* ipiv, double* b, int ldb)
+{
+    int i, j, k;
+    double tmp, *bk;
+
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){
+            if(ipiv[i]-1!=i){
+                tmp = bk[i];
+                bk[i] = bk[ipiv[i]-1];
+                bk[ipiv[i]-1] = tmp;
+            }
+        }
+        for(j=0; j<n; j++)
+            for(i=j+1; i<n; i++)
+                bk[i] -= a[j*lda+i]*bk[j];
+        for(j=n-1; j>=0; j--){
+            bk[j] /= a[j*lda+j];
+            for(i=0; i<j; i++)
+                bk[i] -= a[j*lda+i]*bk[j];
+        }
+    }
+}
+
+lapack_int LAPACKE_dgesv(int matrix_layout, lapack_int n, lapack_int nrhs, double* a, lapack_int lda, lapack_int* ipiv, double* b, lapack_int ldb)
+{
+    int info;
+    info = LAPACKE_dgetrf(matrix_layout, n, n, a, lda, ipiv);
+    if(info==0)
+        builtin_dgetrs(n, nrhs, a, lda, ipiv, b, ldb);
+    return info;
+}
+
+lapack_int LAPACKE_dgetri(int matrix_layout, lapack_int n, double* a, lapack_int lda, const lapack_int* ipiv)
+{
+    int i, j;
+    double* inv;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    for(i=0; i<n; i++)
+        if(a[i*lda+i]==0.0)
+            return i+1;
+    inv = calloc1d(n*n, sizeof(double));
+    for(i=0; i<n; i++)
+        inv[i*n+i] = 1.0;
+    builtin_dgetrs(n, n, a, lda, ipiv, inv, n);
+    for(j=0; j<n; j++)
+        memcpy(&a[j*lda], &inv[j*n], n*sizeof(double));
+    free(inv);
+    return 0;
+}
+
+lapack_int LAPACKE_cgetrf(int matrix_layout, lapack_int m, lapack_int n, float_complex* a, lapack_int lda, lapack_int* ipiv)
+{
+    int i, j, c, p, info;
+    float maxVal;
+    float_complex tmp, f;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    info = 0;
+    for(j=0; j<MIN(m,n); j++){
+        p = j;
+        maxVal = cabsf(a[j*lda+j]);
+        for(i=j+1; i<m; i++){
+            if(cabsf(a[j*lda+i])>maxVal){
+                maxVal = cabsf(a[j*lda+i]);
+                p = i;
+            }
+        }
+        ipiv[j] = p+1;
+        if(maxVal!=0.0f){
+            if(p!=j){
+                for(c=0; c<n; c++){
+                    tmp = a[c*lda+j];
+                    a[c*lda+j] = a[c*lda+p];
+                    a[c*lda+p] = tmp;
+                }
+            }
+            for(i=j+1; i<m; i++)
+                a[j*lda+i] = ccdivf(a[j*lda+i], a[j*lda+j]);
+        }
+        else if(info==0)
+            info = j+1;
+        for(c=j+1; c<n; c++){
+            f = a[c*lda+j];
+            if(crealf(f)!=0.0f || cimagf(f)!=0.0f)
+                for(i=j+1; i<m; i++)
+                    a[c*lda+i] = ccsubf(a[c*lda+i], ccmulf(a[j*lda+i], f));
+        }
+    }
+    return info;
+}
+
+/** Complex version of builtin_sgetrs() */
+static void builtin_cgetrs(int n, int nrhs, const float_complex* a, int lda, const int* ipiv, float_complex* b, int ldb)
+{
+    int i, j, k;
+    float_complex tmp, *bk;
+
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){
+            if(ipiv[i]-1!=i){
+                tmp = bk[i];
+                bk[i] = bk[ipiv[i]-1];
+                bk[ipiv[i]-1] = tmp;
+            }
+        }
+        for(j=0; j<n; j++)
+            for(i=j+1; i<n; i++)
+                bk[i] = ccsubf(bk[i], ccmulf(a[j*lda+i], bk[j]));
+        for(j=n-1; j>=0; j--){
+            bk[j] = ccdivf(bk[j], a[j*lda+j]);
+            for(i=0; i<j; i++)
+                bk[i] = ccsubf(bk[i], ccmulf(a[j*lda+i], bk[j]));
+        }
+    }
+}
+
+lapack_int LAPACKE_cgesv(int matrix_layout, lapack_int n, lapack_int nrhs, float_complex* a, lapack_int lda, lapack_int* ipiv,
+                         float_complex* b, lapack_int ldb)
+{
+    int info;
+    info = LAPACKE_cgetrf(matrix_layout, n, n, a, lda, ipiv);
+    if(info==0)
+        builtin_cgetrs(n, nrhs, a, lda, ipiv, b, ldb);
+    return info;
+}
+
+lapack_int LAPACKE_cgetri(int matrix_layout, lapack_int n, float_complex* a, lapack_int lda, const lapack_int* ipiv)
+{
+    int i, j;
+    float_complex* inv;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    for(i=0; i<n; i++)
+        if(cabsf(a[i*lda+i])==0.0f)
+            return i+1;
+    inv = calloc1d(n*n, sizeof(float_complex));
+    for(i=0; i<n; i++)
+        inv[i*n+i] = cmplxf(1.0f, 0.0f);
+    builtin_cgetrs(n, n, a, lda, ipiv, inv, n);
+    for(j=0; j<n; j++)
+        memcpy(&a[j*lda], &inv[j*n], n*sizeof(float_complex));
+    free(inv);
+    return 0;
+}
+
+lapack_int LAPACKE_zgesv(int matrix_layout, lapack_int n, lapack_int nrhs, double_complex* a, lapack_int lda, lapack_int* ipiv,
+                         double_complex* b, lapack_int ldb)
+{
+    int i, j, c, p, k;
+    double maxVal;
+    double_complex tmp, f, *bk;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+
+    /* LU decomposition (as LAPACKE_cgetrf()), which stops if A is singular */
+    for(j=0; j<n; j++){
+        p = j;
+        maxVal = cabs(a[j*lda+j]);
+        for(i=j+1; i<n; i++){
+            if(cabs(a[j*lda+i])>maxVal){
+                maxVal = cabs(a[j*lda+i]);
+                p = i;
+            }
+        }
+        ipiv[j] = p+1;
+        if(maxVal==0.0)
+            return j+1;
+        if(p!=j){
+            for(c=0; c<n; c++){
+                tmp = a[c*lda+j];
+                a[c*lda+j] = a[c*lda+p];
+                a[c*lda+p] = tmp;
+            }
+        }
+        for(i=j+1; i<n; i++)
+            a[j*lda+i] = ccdiv(a[j*lda+i], a[j*lda+j]);
+        for(c=j+1; c<n; c++){
+            f = a[c*lda+j];
+            for(i=j+1; i<n; i++)
+                a[c*lda+i] = ccsub(a[c*lda+i], ccmul(a[j*lda+i], f));
+        }
+    }
+
+    /* and the solution for each column of B (as builtin_cgetrs()) */
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){
+            if(ipiv[i]-1!=i){
+                tmp = bk[i];
+                bk[i] = bk[ipiv[i]-1];
+                bk[ipiv[i]-1] = tmp;
+            }
+        }
+        for(j=0; j<n; j++)
+            for(i=j+1; i<n; i++)
+                bk[i] = ccsub(bk[i], ccmul(a[j*lda+i], bk[j]));
+        for(j=n-1; j>=0; j--){
+            bk[j] = ccdiv(bk[j], a[j*lda+j]);
+            for(i=0; i<j; i++)
+                bk[i] = ccsub(bk[i], ccmul(a[j*lda+i], bk[j]));
+        }
+    }
+    return 0;
+}
+
+
+/* ========================================================================== */
+/*                   LAPACK (Positive Definite Linear Solvers)                */
+/* ========================================================================== */
+
+/*
+ * Both triangles are handled by one code path, by accessing the factor as U
+ * (in A = U^H*U): for 'uplo' lower, U(i,j) is stored as conj(L(j,i)), i.e.
+ * at a[i*lda+j] rather than at a[j*lda+i].
+ */
+
+/** Returns 1 if 'uplo' refers to the upper triangle ('U', or CblasUpper) */
+static int builtin_isUpper(char uplo)
+{
+    return !(uplo=='L' || uplo=='l' || uplo==(char)CblasLower);
+}
+
+lapack_int LAPACKE_spotrf(int matrix_layout, char uplo, lapack_int n, float* a, lapack_int lda)
+{
+    int i, j, k, upper;
+    float d, s;
+#define BUILTIN_U(r,c) ( *(upper ? &a[(c)*lda+(r)] : &a[(r)*lda+(c)]) )
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    upper = builtin_isUpper(uplo);
+    for(j=0; j<n; j++){
+        d = BUILTIN_U(j,j);
+        for(k=0; k<j; k++)
+            d -= BUILTIN_U(k,j)*BUILTIN_U(k,j);
+        if(!(d>0.0f))
+            return j+1; /* (not positive definite, or NaN) */
+        d = sqrtf(d);
+        BUILTIN_U(j,j) = d;
+        for(i=j+1; i<n; i++){
+            s = BUILTIN_U(j,i);
+            for(k=0; k<j; k++)
+                s -= BUILTIN_U(k,j)*BUILTIN_U(k,i);
+            BUILTIN_U(j,i) = s/d;
+        }
+    }
+    return 0;
+#undef BUILTIN_U
+}
+
+lapack_int LAPACKE_sposv(int matrix_layout, char uplo, lapack_int n, lapack_int nrhs, float* a, lapack_int lda, float* b, lapack_int ldb)
+{
+    int i, k, m, info, upper;
+    float s, *bk;
+#define BUILTIN_U(r,c) ( *(upper ? &a[(c)*lda+(r)] : &a[(r)*lda+(c)]) )
+
+    info = LAPACKE_spotrf(matrix_layout, uplo, n, a, lda);
+    if(info!=0)
+        return info;
+    upper = builtin_isUpper(uplo);
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){ /* U^T*y = b */
+            s = bk[i];
+            for(m=0; m<i; m++)
+                s -= BUILTIN_U(m,i)*bk[m];
+            bk[i] = s/BUILTIN_U(i,i);
+        }
+        for(i=n-1; i>=0; i--){ /* U*x = y */
+            s = bk[i];
+            for(m=i+1; m<n; m++)
+                s -= BUILTIN_U(i,m)*bk[m];
+            bk[i] = s/BUILTIN_U(i,i);
+        }
+    }
+    return 0;
+#undef BUILTIN_U
+}
+
+/** Returns U(r,c) of the complex Cholesky factor (see above) */
+static float_complex builtin_cpotrf_getU(const float_complex* a, int lda, int upper, int r, int c)
+{
+    return upper ? a[c*lda+r] : conjf(a[r*lda+c]);
+}
+
+/** Sets U(r,c) of the complex Cholesky factor (see above) */
+static void builtin_cpotrf_setU(float_complex* a, int lda, int upper, int r, int c, float_complex val)
+{
+    if(upper)
+        a[c*lda+r] = val;
+    else
+        a[r*lda+c] = conjf(val);
+}
+
+lapack_int LAPACKE_cpotrf(int matrix_layout, char uplo, lapack_int n, float_complex* a, lapack_int lda)
+{
+    int i, j, k, upper;
+    float d;
+    float_complex s, ukj;
+
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    upper = builtin_isUpper(uplo);
+    for(j=0; j<n; j++){
+        d = crealf(a[j*lda+j]);
+        for(k=0; k<j; k++){
+            ukj = builtin_cpotrf_getU(a, lda, upper, k, j);
+            d -= crealf(ukj)*crealf(ukj) + cimagf(ukj)*cimagf(ukj);
+        }
+        if(!(d>0.0f))
+            return j+1;
+        d = sqrtf(d);
+        a[j*lda+j] = cmplxf(d, 0.0f);
+        for(i=j+1; i<n; i++){
+            s = builtin_cpotrf_getU(a, lda, upper, j, i);
+            for(k=0; k<j; k++)
+                s = ccsubf(s, ccmulf(conjf(builtin_cpotrf_getU(a, lda, upper, k, j)), builtin_cpotrf_getU(a, lda, upper, k, i)));
+            builtin_cpotrf_setU(a, lda, upper, j, i, crmulf(s, 1.0f/d));
+        }
+    }
+    return 0;
+}
+
+lapack_int LAPACKE_cposv(int matrix_layout, char uplo, lapack_int n, lapack_int nrhs, float_complex* a, lapack_int lda,
+                         float_complex* b, lapack_int ldb)
+{
+    int i, k, m, info, upper;
+    float_complex s, *bk;
+
+    info = LAPACKE_cpotrf(matrix_layout, uplo, n, a, lda);
+    if(info!=0)
+        return info;
+    upper = builtin_isUpper(uplo);
+    for(k=0; k<nrhs; k++){
+        bk = &b[k*ldb];
+        for(i=0; i<n; i++){ /* U^H*y = b */
+            s = bk[i];
+            for(m=0; m<i; m++)
+                s = ccsubf(s, ccmulf(conjf(builtin_cpotrf_getU(a, lda, upper, m, i)), bk[m]));
+            bk[i] = crmulf(s, 1.0f/crealf(a[i*lda+i]));
+        }
+        for(i=n-1; i>=0; i--){ /* U*x = y */
+            s = bk[i];
+            for(m=i+1; m<n; m++)
+                s = ccsubf(s, ccmulf(builtin_cpotrf_getU(a, lda, upper, i, m), bk[m]));
+            bk[i] = crmulf(s, 1.0f/crealf(a[i*lda+i]));
+        }
+    }
+    return 0;
+}
+
+
+/* ========================================================================== */
+/*                     LAPACK (SVD and Eigen-decompositions)                  */
+/* ========================================================================== */
+
+/*
+ * All of the decompositions are carried out in double-precision complex
+ * arithmetic, by one implementation per decomposition; the real and single
+ * precision routines convert their arguments to and from it. The workspace
+ * queries (lwork=-1) return the required workspace in work[0], which holds all
+ * of the intermediate matrices (i.e. the routines do not allocate memory).
+ */
+
+/** Maximum number of sweeps of the Jacobi methods */
+#define BUILTIN_LAPACK_MAX_SWEEPS ( 100 )
+
+/** Element types of the LAPACK routines */
+typedef enum _BUILTIN_LAPACK_TYPES {
+    BUILTIN_LAPACK_S = 0, /**< float */
+    BUILTIN_LAPACK_D,     /**< double */
+    BUILTIN_LAPACK_C,     /**< float_complex */
+    BUILTIN_LAPACK_Z      /**< double_complex */
+
+}BUILTIN_LAPACK_TYPES;
+
+/** Returns element 'i' of an array of the given type */
+static double_complex builtin_lapack_get(const void* x, BUILTIN_LAPACK_TYPES type, size_t i)
+{
+    switch(type){
+        case BUILTIN_LAPACK_S: return cmplx((double)((const float*)x)[i], 0.0);
+        case BUILTIN_LAPACK_D: return cmplx(((const double*)x)[i], 0.0);
+        case BUILTIN_LAPACK_C: return cmplx((double)crealf(((const float_complex*)x)[i]), (double)cimagf(((const float_complex*)x)[i]));
+        default:
+        case BUILTIN_LAPACK_Z: return ((const double_complex*)x)[i];
+    }
+}
+
+/** Sets element 'i' of an array of the given type (the real part, for the real types) */
+static void builtin_lapack_set(void* x, BUILTIN_LAPACK_TYPES type, size_t i, double_complex val)
+{
+    switch(type){
+        case BUILTIN_LAPACK_S: ((float*)x)[i] = (float)creal(val); break;
+        case BUILTIN_LAPACK_D: ((double*)x)[i] = creal(val); break;
+        case BUILTIN_LAPACK_C: ((float_complex*)x)[i] = cmplxf((float)creal(val), (float)cimag(val)); break;
+        default:
+        case BUILTIN_LAPACK_Z: ((double_complex*)x)[i] = val; break;
+    }
+}
+
+/** Sets element 'i' of a real array (e.g. of singular values), which is double for the D and Z types, and float otherwise */
+static void builtin_lapack_setReal(void* x, BUILTIN_LAPACK_TYPES type, size_t i, double val)
+{
+    if(type==BUILTIN_LAPACK_D || type==BUILTIN_LAPACK_Z)
+        ((double*)x)[i] = val;
+    else
+        ((float*)x)[i] = (float)val;
+}
+
+/** Returns the workspace length (in elements of the given type) which holds 'nElements' double_complex elements */
+static lapack_int builtin_lapack_getLwork(BUILTIN_LAPACK_TYPES type, size_t nElements)
+{
+    size_t elementSize;
+    elementSize = type==BUILTIN_LAPACK_S ? sizeof(float) : type==BUILTIN_LAPACK_D ? sizeof(double) :
+                  type==BUILTIN_LAPACK_C ? sizeof(float_complex) : sizeof(double_complex);
+    return (lapack_int)((nElements*sizeof(double_complex) + 16 + elementSize-1)/elementSize); /* (+alignment) */
+}
+
+/** Returns the workspace query result, which is rounded up when stored in single precision */
+static void builtin_lapack_setLwork(void* work, BUILTIN_LAPACK_TYPES type, lapack_int lwork)
+{
+    float lworkf;
+    if(type==BUILTIN_LAPACK_S || type==BUILTIN_LAPACK_C){
+        lworkf = (float)lwork;
+        while((double)lworkf < (double)lwork)
+            lworkf = nextafterf(lworkf, FLT_MAX);
+        builtin_lapack_set(work, type, 0, cmplx((double)lworkf, 0.0));
+    }
+    else
+        builtin_lapack_set(work, type, 0, cmplx((double)lwork, 0.0));
+}
+
+/** Returns the workspace as double_complex, aligned to 16 bytes */
+static double_complex* builtin_lapack_alignWork(void* work)
+{
+    return (double_complex*)(((size_t)work + 15) & ~(size_t)15);
+}
+
+/** Returns |x|^2 */
+static double builtin_zabs2(double_complex x)
+{
+    return creal(x)*creal(x) + cimag(x)*cimag(x);
+}
+
+/**
+ * Generates an elementary reflector H = I - tau*v*v^H, such that
+ * H^H*x = [beta; 0; ...; 0] with beta real (see ?larfg); where x is
+ * overwritten by [beta; v(2:n)], and v(1)=1
+ */
+static void builtin_zlarfg(int n, double_complex* x, double_complex* tau)
+{
+    int i;
+    double xnorm, alphr, alphi, beta;
+    double_complex scale;
+
+    xnorm = 0.0;
+    for(i=1; i<n; i++)
+        xnorm += builtin_zabs2(x[i]);
+    xnorm = sqrt(xnorm);
+    alphr = creal(x[0]);
+    alphi = cimag(x[0]);
+    if(xnorm==0.0 && alphi==0.0){
+        (*tau) = cmplx(0.0, 0.0);
+        return;
+    }
+    beta = -copysign(sqrt(alphr*alphr + alphi*alphi + xnorm*xnorm), alphr);
+    (*tau) = cmplx((beta-alphr)/beta, -alphi/beta);
+    scale = ccdiv(cmplx(1.0, 0.0), crsub(x[0], beta));
+    for(i=1; i<n; i++)
+        x[i] = ccmul(x[i], scale);
+    x[0] = cmplx(beta, 0.0);
+}
+
+/** A = (I - tau*v*v^H)*A; A: n x nCols (column-major), v: n x 1 */
+static void builtin_zlarfLeft(int n, int nCols, const double_complex* v, double_complex tau, double_complex* A, int lda)
+{
+    int i, j;
+    double_complex s;
+
+    for(j=0; j<nCols; j++){
+        s = cmplx(0.0, 0.0);
+        for(i=0; i<n; i++)
+            s = ccadd(s, ccmul(conj(v[i]), A[j*lda+i]));
+        s = ccmul(tau, s);
+        for(i=0; i<n; i++)
+            A[j*lda+i] = ccsub(A[j*lda+i], ccmul(v[i], s));
+    }
+}
+
+/** A = A*(I - tau*v*v^H); A: nRows x n (column-major), v: n x 1 */
+static void builtin_zlarfRight(int nRows, int n, const double_complex* v, double_complex tau, double_complex* A, int lda)
+{
+    int i, j;
+    double_complex s;
+
+    for(i=0; i<nRows; i++){
+        s = cmplx(0.0, 0.0);
+        for(j=0; j<n; j++)
+            s = ccadd(s, ccmul(A[j*lda+i], v[j]));
+        s = ccmul(tau, s);
+        for(j=0; j<n; j++)
+            A[j*lda+i] = ccsub(A[j*lda+i], ccmul(s, conj(v[j])));
+    }
+}
+
+/** Returns the cosine (c) and sine (s) of the rotation [c s; -s c], which diagonalises the 2 x 2 matrix [a g; g b] */
+static void builtin_jacobiRotation(double a, double b, double g, double* c, double* s)
+{
+    double zeta, t;
+
+    zeta = (b-a)/(2.0*g);
+    t = (zeta>=0.0 ? 1.0 : -1.0)/(fabs(zeta) + sqrt(1.0 + zeta*zeta));
+    (*c) = 1.0/sqrt(1.0 + t*t);
+    (*s) = (*c)*t;
+}
+
+/**
+ * Singular value decomposition of an m x n matrix, m >= n: G = Q*[U_R; 0]*S*V^H
+ *
+ * The matrix is first reduced to the triangular factor R of its QR
+ * decomposition (Householder), whose columns are then orthogonalised by the
+ * one-sided (Hestenes) Jacobi method; i.e. R*V = U_R*S. The singular values
+ * are in descending order, and the columns of U_R for (numerically) zero
+ * singular values are completed to an orthonormal basis.
+ *
+ * @param[in]  m   Number of rows
+ * @param[in]  n   Number of columns
+ * @param[in]  G   Matrix (column-major); m x n; overwritten by the
+ *                 Householder vectors of Q (below the diagonal)
+ * @param[out] tau Householder scalars of Q; n x 1
+ * @param[out] R   U_R; n x n
+ * @param[out] V   V; n x n
+ * @param[out] s   Singular values; n x 1
+ * @returns 0, or 1 if the method failed to converge
+ */
+static int builtin_zgesvdJacobi(int m, int n, double_complex* G, double_complex* tau, double_complex* R, double_complex* V, double* s)
+{
+    int i, j, k, p, q, sweep, rotated, cand;
+    double alpha, beta, absGamma, c, sn, tmp, norm;
+    double_complex gamma, e, rp, rq, beta_j;
+
+    /* QR decomposition */
+    for(j=0; j<n; j++){
+        builtin_zlarfg(m-j, &G[j*m+j], &tau[j]);
+        beta_j = G[j*m+j];
+        G[j*m+j] = cmplx(1.0, 0.0);
+        builtin_zlarfLeft(m-j, n-j-1, &G[j*m+j], conj(tau[j]), &G[(j+1)*m+j], m);
+        G[j*m+j] = beta_j;
+    }
+    for(j=0; j<n; j++){
+        for(i=0; i<n; i++){
+            R[j*n+i] = i<=j ? G[j*m+i] : cmplx(0.0, 0.0);
+            V[j*n+i] = cmplx(i==j ? 1.0 : 0.0, 0.0);
+        }
+    }
+
+    /* one-sided Jacobi sweeps, until all column pairs are orthogonal */
+    for(sweep=0, rotated=1; sweep<BUILTIN_LAPACK_MAX_SWEEPS && rotated; sweep++){
+        rotated = 0;
+        for(p=0; p<n-1; p++){
+            for(q=p+1; q<n; q++){
+                alpha = beta = 0.0;
+                gamma = cmplx(0.0, 0.0);
+                for(i=0; i<n; i++){
+                    alpha += builtin_zabs2(R[p*n+i]);
+                    beta += builtin_zabs2(R[q*n+i]);
+                    gamma = ccadd(gamma, ccmul(conj(R[p*n+i]), R[q*n+i]));
+                }
+                absGamma = cabs(gamma);
+                if(absGamma==0.0 || absGamma <= DBL_EPSILON*sqrt(alpha*beta))
+                    continue;
+                rotated = 1;
+
+                /* the phase of column q renders gamma real, and the rotation then orthogonalises the pair */
+                e = crdiv(conj(gamma), absGamma);
+                builtin_jacobiRotation(alpha, beta, absGamma, &c, &sn);
+                for(i=0; i<n; i++){
+                    rp = R[p*n+i];
+                    rq = ccmul(R[q*n+i], e);
+                    R[p*n+i] = ccsub(crmul(rp, c), crmul(rq, sn));
+                    R[q*n+i] = ccadd(crmul(rp, sn), crmul(rq, c));
+                    rp = V[p*n+i];
+                    rq = ccmul(V[q*n+i], e);
+                    V[p*n+i] = ccsub(crmul(rp, c), crmul(rq, sn));
+                    V[q*n+i] = ccadd(crmul(rp, sn), crmul(rq, c));
+                }
+            }
+        }
+    }
+    if(rotated)
+        return 1;
+
+    /* singular values (in descending order) */
+    for(j=0; j<n; j++){
+        s[j] = 0.0;
+        for(i=0; i<n; i++)
+            s[j] += builtin_zabs2(R[j*n+i]);
+        s[j] = sqrt(s[j]);
+    }
+    for(j=0; j<n; j++){
+        k = j;
+        for(i=j+1; i<n; i++)
+            if(s[i]>s[k])
+                k = i;
+        if(k!=j){
+            tmp = s[j]; s[j] = s[k]; s[k] = tmp;
+            for(i=0; i<n; i++){
+                rp = R[j*n+i]; R[j*n+i] = R[k*n+i]; R[k*n+i] = rp;
+                rp = V[j*n+i]; V[j*n+i] = V[k*n+i]; V[k*n+i] = rp;
+            }
+        }
+    }
+
+    /* U_R = R*V*S^-1, which is completed (Gram-Schmidt) for zero singular values */
+    for(j=0; j<n; j++){
+        if(s[j] > (double)n*DBL_EPSILON*s[0]){
+            for(i=0; i<n; i++)
+                R[j*n+i] = crdiv(R[j*n+i], s[j]);
+            continue;
+        }
+        for(cand=0; cand<n; cand++){
+            for(i=0; i<n; i++)
+                R[j*n+i] = cmplx(i==cand ? 1.0 : 0.0, 0.0);
+            for(k=0; k<2; k++){ /* (twice, for numerical orthogonality) */
+                for(p=0; p<j; p++){
+                    gamma = cmplx(0.0, 0.0);
+                    for(i=0; i<n; i++)
+                        gamma = ccadd(gamma, ccmul(conj(R[p*n+i]), R[j*n+i]));
+                    for(i=0; i<n; i++)
+                        R[j*n+i] = ccsub(R[j*n+i], ccmul(gamma, R[p*n+i]));
+                }
+            }
+            norm = 0.0;
+            for(i=0; i<n; i++)
+                norm += builtin_zabs2(R[j*n+i]);
+            norm = sqrt(norm);
+            if(norm>0.5){
+                for(i=0; i<n; i++)
+                    R[j*n+i] = crdiv(R[j*n+i], norm);
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns column 'j' of the left singular vectors Q*[U_R 0; 0 I] of
+ * builtin_zgesvdJacobi(); x: m x 1
+ */
+static void builtin_zgesvdGetU(int m, int n, const double_complex* G, const double_complex* tau, const double_complex* R, int j,
+                               double_complex* x)
+{
+    int i, k;
+    double_complex s;
+
+    for(i=0; i<m; i++)
+        x[i] = j<n ? (i<n ? R[j*n+i] : cmplx(0.0, 0.0)) : cmplx(i==j ? 1.0 : 0.0, 0.0);
+    for(k=n-1; k>=0; k--){ /* x = H_0*H_1*...*H_{n-1}*x, with v(1)=1 implied */
+        s = x[k];
+        for(i=k+1; i<m; i++)
+            s = ccadd(s, ccmul(conj(G[k*m+i]), x[i]));
+        s = ccmul(tau[k], s);
+        x[k] = ccsub(x[k], s);
+        for(i=k+1; i<m; i++)
+            x[i] = ccsub(x[i], ccmul(G[k*m+i], s));
+    }
+}
+
+/** Returns the number of double_complex elements needed by builtin_gesvd() */
+static size_t builtin_gesvd_getWorkSize(int m, int n)
+{
+    size_t r, c;
+    r = (size_t)MAX(m,n);
+    c = (size_t)MIN(m,n);
+    return r*c + 2*c*c + 2*c + r;
+}
+
+/** ?gesvd, for all types; jobu/jobvt: 'A', 'S' or 'N' */
+static lapack_int builtin_gesvd(BUILTIN_LAPACK_TYPES type, int matrix_layout, char jobu, char jobvt, lapack_int m, lapack_int n,
+                                const void* a, lapack_int lda, void* s, void* u, lapack_int ldu, void* vt, lapack_int ldvt,
+                                void* work, lapack_int lwork)
+{
+    int i, j, r, c, trans, nU, nVt, info, wantU, wantVt;
+    double_complex *G, *tau, *R, *V, *x;
+    double* sv;
+
+    if(lwork==-1){
+        builtin_lapack_setLwork(work, type, builtin_lapack_getLwork(type, builtin_gesvd_getWorkSize(m, n)));
+        return 0;
+    }
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    if(jobu!='A' && jobu!='S' && jobu!='N')
+        return -2;
+    if(jobvt!='A' && jobvt!='S' && jobvt!='N')
+        return -3;
+    if(lwork < builtin_lapack_getLwork(type, builtin_gesvd_getWorkSize(m, n)))
+        return -14;
+    if(m==0 || n==0)
+        return 0;
+
+    /* the decomposition is of A (m >= n), or of A^H (m < n) */
+    trans = m<n;
+    r = MAX(m,n);
+    c = MIN(m,n);
+    G = builtin_lapack_alignWork(work);
+    R = &G[r*c];
+    V = &R[c*c];
+    tau = &V[c*c];
+    sv = (double*)&tau[c];
+    x = &tau[2*c];
+    for(j=0; j<c; j++)
+        for(i=0; i<r; i++)
+            G[j*r+i] = trans ? conj(builtin_lapack_get(a, type, (size_t)i*lda+j)) : builtin_lapack_get(a, type, (size_t)j*lda+i);
+    info = builtin_zgesvdJacobi(r, c, G, tau, R, V, sv);
+    if(info!=0)
+        return info;
+    for(j=0; j<c; j++)
+        builtin_lapack_setReal(s, type, j, sv[j]);
+
+    /* A = Q*U_R*S*V^H (or A = V*S*(Q*U_R)^H) */
+    wantU = trans ? jobvt!='N' : jobu!='N';
+    wantVt = trans ? jobu!='N' : jobvt!='N';
+    nU = trans ? (jobvt=='A' ? n : m) : (jobu=='A' ? m : n);
+    nVt = c;
+    if(wantU){
+        for(j=0; j<nU; j++){
+            builtin_zgesvdGetU(r, c, G, tau, R, j, x);
+            for(i=0; i<r; i++){
+                if(trans)
+                    builtin_lapack_set(vt, type, (size_t)i*ldvt+j, conj(x[i]));
+                else
+                    builtin_lapack_set(u, type, (size_t)j*ldu+i, x[i]);
+            }
+        }
+    }
+    if(wantVt){
+        for(j=0; j<nVt; j++){
+            for(i=0; i<c; i++){
+                if(trans)
+                    builtin_lapack_set(u, type, (size_t)j*ldu+i, V[j*c+i]);
+                else
+                    builtin_lapack_set(vt, type, (size_t)i*ldvt+j, conj(V[j*c+i]));
+            }
+        }
+    }
+    return 0;
+}
+
+lapack_int LAPACKE_sgesvd_work(int matrix_layout, char jobu, char jobvt, lapack_int m, lapack_int n, float* a, lapack_int lda,
+                               float* s, float* u, lapack_int ldu, float* vt, lapack_int ldvt, float* work, lapack_int lwork)
+{
+    return builtin_gesvd(BUILTIN_LAPACK_S, matrix_layout, jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork);
+}
+
+lapack_int LAPACKE_dgesvd_work(int matrix_layout, char jobu, char jobvt, lapack_int m, lapack_int n, double* a, lapack_int lda,
+                               double* s, double* u, lapack_int ldu, double* vt, lapack_int ldvt, double* work, lapack_int lwork)
+{
+    return builtin_gesvd(BUILTIN_LAPACK_D, matrix_layout, jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork);
+}
+
+lapack_int LAPACKE_cgesvd_work(int matrix_layout, char jobu, char jobvt, lapack_int m, lapack_int n, float_complex* a, lapack_int lda,
+                               float* s, float_complex* u, lapack_int ldu, float_complex* vt, lapack_int ldvt, float_complex* work,
+                               lapack_int lwork, float* rwork)
+{
+    (void)rwork;
+    return builtin_gesvd(BUILTIN_LAPACK_C, matrix_layout, jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork);
+}
+
+lapack_int LAPACKE_zgesvd_work(int matrix_layout, char jobu, char jobvt, lapack_int m, lapack_int n, double_complex* a, lapack_int lda,
+                               double* s, double_complex* u, lapack_int ldu, double_complex* vt, lapack_int ldvt, double_complex* work,
+                               lapack_int lwork, double* rwork)
+{
+    (void)rwork;
+    return builtin_gesvd(BUILTIN_LAPACK_Z, matrix_layout, jobu, jobvt, m, n, a, lda, s, u, ldu, vt, ldvt, work, lwork);
+}
+
+/**
+ * Eigen-decomposition of a Hermitian matrix, A = V*diag(w)*V^H, by the cyclic
+ * Jacobi method; with the eigenvalues in ascending order
+ *
+ * @param[in]  n Dimension of the matrix
+ * @param[in]  A Matrix (column-major, both triangles); n x n; destroyed
+ * @param[out] V Eigenvectors (columns); n x n
+ * @param[out] w Eigenvalues; n x 1
+ * @returns 0, or 1 if the method failed to converge
+ */
+static int builtin_zheevJacobi(int n, double_complex* A, double_complex* V, double* w)
+{
+    int i, j, k, p, q, sweep, converged;
+    double off, fro, a, b, absH, c, s, tmp;
+    double_complex e, se, ap, aq;
+
+    for(j=0; j<n; j++)
+        for(i=0; i<n; i++)
+            V[j*n+i] = cmplx(i==j ? 1.0 : 0.0, 0.0);
+
+    converged = 0;
+    for(sweep=0; sweep<BUILTIN_LAPACK_MAX_SWEEPS; sweep++){
+        off = fro = 0.0;
+        for(j=0; j<n; j++){
+            for(i=0; i<n; i++){
+                tmp = builtin_zabs2(A[j*n+i]);
+                fro += tmp;
+                off += i!=j ? tmp : 0.0;
+            }
+        }
+        if(off <= DBL_EPSILON*DBL_EPSILON*fro){
+            converged = 1;
+            break;
+        }
+        for(p=0; p<n-1; p++){
+            for(q=p+1; q<n; q++){
+                absH = cabs(A[q*n+p]);
+                if(absH==0.0)
+                    continue;
+
+                /* J = diag(1, conj(e))*[c s; -s c], with e the phase of A(p,q); and A = J^H*A*J */
+                a = creal(A[p*n+p]);
+                b = creal(A[q*n+q]);
+                e = crdiv(A[q*n+p], absH);
+                builtin_jacobiRotation(a, b, absH, &c, &s);
+                for(k=0; k<n; k++){ /* columns */
+                    ap = A[p*n+k];
+                    aq = ccmul(conj(e), A[q*n+k]);
+                    A[p*n+k] = ccsub(crmul(ap, c), crmul(aq, s));
+                    A[q*n+k] = ccadd(crmul(ap, s), crmul(aq, c));
+                    ap = V[p*n+k];
+                    aq = ccmul(conj(e), V[q*n+k]);
+                    V[p*n+k] = ccsub(crmul(ap, c), crmul(aq, s));
+                    V[q*n+k] = ccadd(crmul(ap, s), crmul(aq, c));
+                }
+                for(k=0; k<n; k++){ /* rows */
+                    ap = A[k*n+p];
+                    se = ccmul(e, A[k*n+q]);
+                    A[k*n+p] = ccsub(crmul(ap, c), crmul(se, s));
+                    A[k*n+q] = ccadd(crmul(ap, s), crmul(se, c));
+                }
+                A[q*n+p] = A[p*n+q] = cmplx(0.0, 0.0);
+                A[p*n+p] = cmplx(creal(A[p*n+p]), 0.0);
+                A[q*n+q] = cmplx(creal(A[q*n+q]), 0.0);
+            }
+        }
+    }
+
+    /* eigenvalues in ascending order */
+    for(j=0; j<n; j++)
+        w[j] = creal(A[j*n+j]);
+    for(j=0; j<n; j++){
+        k = j;
+        for(i=j+1; i<n; i++)
+            if(w[i]<w[k])
+                k = i;
+        if(k!=j){
+            tmp = w[j]; w[j] = w[k]; w[k] = tmp;
+            for(i=0; i<n; i++){
+                ap = V[j*n+i]; V[j*n+i] = V[k*n+i]; V[k*n+i] = ap;
+            }
+        }
+    }
+    return converged ? 0 : 1;
+}
+
+/** Copies the referenced triangle of a Hermitian matrix into both triangles of A (n x n) */
+static void builtin_getHermitian(BUILTIN_LAPACK_TYPES type, char uplo, int n, const void* a, int lda, double_complex* A)
+{
+    int i, j, upper;
+
+    upper = builtin_isUpper(uplo);
+    for(j=0; j<n; j++){
+        for(i=0; i<=j; i++){
+            A[j*n+i] = upper ? builtin_lapack_get(a, type, (size_t)j*lda+i) : conj(builtin_lapack_get(a, type, (size_t)i*lda+j));
+            A[i*n+j] = conj(A[j*n+i]);
+        }
+        A[j*n+j] = cmplx(creal(A[j*n+j]), 0.0);
+    }
+}
+
+/** ?syev and ?heev, for all types */
+static lapack_int builtin_heev(BUILTIN_LAPACK_TYPES type, int matrix_layout, char jobz, char uplo, lapack_int n, void* a,
+                               lapack_int lda, void* w, void* work, lapack_int lwork)
+{
+    int i, j, info;
+    double_complex *A, *V;
+    double* wd;
+
+    if(lwork==-1){
+        builtin_lapack_setLwork(work, type, builtin_lapack_getLwork(type, 2*(size_t)n*n + n));
+        return 0;
+    }
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    if(lwork < builtin_lapack_getLwork(type, 2*(size_t)n*n + n))
+        return -9;
+    A = builtin_lapack_alignWork(work);
+    V = &A[n*n];
+    wd = (double*)&V[n*n];
+    builtin_getHermitian(type, uplo, n, a, lda, A);
+    info = builtin_zheevJacobi(n, A, V, wd);
+    if(info!=0)
+        return info;
+    for(i=0; i<n; i++)
+        builtin_lapack_setReal(w, type, i, wd[i]);
+    if(jobz=='V' || jobz=='v')
+        for(j=0; j<n; j++)
+            for(i=0; i<n; i++)
+                builtin_lapack_set(a, type, (size_t)j*lda+i, V[j*n+i]);
+    return 0;
+}
+
+lapack_int LAPACKE_ssyev_work(int matrix_layout, char jobz, char uplo, lapack_int n, float* a, lapack_int lda, float* w,
+                              float* work, lapack_int lwork)
+{
+    return builtin_heev(BUILTIN_LAPACK_S, matrix_layout, jobz, uplo, n, a, lda, w, work, lwork);
+}
+
+lapack_int LAPACKE_cheev_work(int matrix_layout, char jobz, char uplo, lapack_int n, float_complex* a, lapack_int lda, float* w,
+                              float_complex* work, lapack_int lwork, float* rwork)
+{
+    (void)rwork;
+    return builtin_heev(BUILTIN_LAPACK_C, matrix_layout, jobz, uplo, n, a, lda, w, work, lwork);
+}
+
+lapack_int LAPACKE_cheevr_work(int matrix_layout, char jobz, char range, char uplo, lapack_int n, float_complex* a, lapack_int lda,
+                               float vl, float vu, lapack_int il, lapack_int iu, float abstol, lapack_int* m, float* w,
+                               float_complex* z, lapack_int ldz, lapack_int* isuppz, float_complex* work, lapack_int lwork,
+                               float* rwork, lapack_int lrwork, lapack_int* iwork, lapack_int liwork)
+{
+    int i, j, first, last, info;
+    double_complex *A, *V;
+    double* wd;
+
+    (void)abstol; /* (Jacobi converges to full accuracy regardless) */
+    (*m) = 0;
+    if(lwork==-1 || lrwork==-1 || liwork==-1){
+        builtin_lapack_setLwork(work, BUILTIN_LAPACK_C, builtin_lapack_getLwork(BUILTIN_LAPACK_C, 2*(size_t)n*n + n));
+        rwork[0] = 1.0f;
+        iwork[0] = 1;
+        return 0;
+    }
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    if(lwork < builtin_lapack_getLwork(BUILTIN_LAPACK_C, 2*(size_t)n*n + n))
+        return -19;
+    A = builtin_lapack_alignWork(work);
+    V = &A[n*n];
+    wd = (double*)&V[n*n];
+    builtin_getHermitian(BUILTIN_LAPACK_C, uplo, n, a, lda, A);
+    info = builtin_zheevJacobi(n, A, V, wd);
+    if(info!=0)
+        return info;
+
+    /* the requested subset of the eigenvalues (all, the il-th to iu-th, or those in (vl,vu]) */
+    first = 0;
+    last = n-1;
+    if(range=='I' || range=='i'){
+        first = MAX(il, 1)-1;
+        last = MIN(iu, n)-1;
+    }
+    else if(range=='V' || range=='v'){
+        while(first<n && wd[first]<=(double)vl)
+            first++;
+        while(last>=first && wd[last]>(double)vu)
+            last--;
+    }
+    for(j=first; j<=last; j++){
+        w[*m] = (float)wd[j];
+        if(jobz=='V' || jobz=='v'){
+            for(i=0; i<n; i++)
+                z[(*m)*ldz+i] = cmplxf((float)creal(V[j*n+i]), (float)cimag(V[j*n+i]));
+            isuppz[2*(*m)] = 1;
+            isuppz[2*(*m)+1] = n;
+        }
+        (*m)++;
+    }
+    return 0;
+}
+
+/**
+ * Eigen-decomposition of a general matrix, by its Schur decomposition
+ * A = Z*T*Z^H (Householder reduction to upper Hessenberg form, followed by the
+ * shifted QR algorithm), and back-substitution for the eigenvectors of T
+ *
+ * @param[in]  n  Dimension of the matrix
+ * @param[in]  H  Matrix (column-major); n x n; overwritten by T
+ * @param[out] Z  Schur vectors; n x n
+ * @param[out] w  Eigenvalues; n x 1
+ * @param[out] VL Left eigenvectors (columns, unnormalised; NULL: not
+ *                computed), such that VL^H*A = diag(w)*VL^H; n x n
+ * @param[out] VR Right eigenvectors (columns, unnormalised; NULL: not
+ *                computed), such that A*VR = VR*diag(w); n x n
+ * @param[out] x  Scratch; n x 1
+ * @returns 0, or 1 if the QR algorithm failed to converge
+ */
+static int builtin_zgeevSchur(int n, double_complex* H, double_complex* Z, double_complex* w, double_complex* VL,
+                              double_complex* VR, double_complex* x)
+{
+    int i, j, k, l, hi, its, totalIts;
+    double anorm, tnorm, smin, s, c;
+    double_complex tau, mu, a, b, cc, d, half, disc, t1, t2, sn, den, beta_j;
+
+    for(j=0; j<n; j++)
+        for(i=0; i<n; i++)
+            Z[j*n+i] = cmplx(i==j ? 1.0 : 0.0, 0.0);
+    anorm = 0.0;
+    for(j=0; j<n*n; j++)
+        anorm = MAX(anorm, cabs(H[j]));
+    if(anorm==0.0)
+        anorm = 1.0;
+
+    /* reduction to upper Hessenberg form: H = Q^H*A*Q, with Z = Q */
+    for(j=0; j<n-2; j++){
+        builtin_zlarfg(n-j-1, &H[j*n+j+1], &tau);
+        beta_j = H[j*n+j+1];
+        x[0] = cmplx(1.0, 0.0);
+        for(i=1; i<n-j-1; i++){
+            x[i] = H[j*n+j+1+i];
+            H[j*n+j+1+i] = cmplx(0.0, 0.0);
+        }
+        builtin_zlarfLeft(n-j-1, n-j-1, x, conj(tau), &H[(j+1)*n+j+1], n);
+        builtin_zlarfRight(n, n-j-1, x, tau, &H[(j+1)*n], n);
+        builtin_zlarfRight(n, n-j-1, x, tau, &Z[(j+1)*n], n);
+        H[j*n+j+1] = beta_j;
+    }
+
+    /* shifted QR iterations, with deflation, until H is upper triangular */
+    hi = n-1;
+    its = totalIts = 0;
+    while(hi>0){
+        for(l=hi; l>0; l--){
+            s = cabs(H[(l-1)*n+l-1]) + cabs(H[l*n+l]);
+            if(cabs(H[(l-1)*n+l]) <= DBL_EPSILON*(s==0.0 ? anorm : s)){
+                H[(l-1)*n+l] = cmplx(0.0, 0.0);
+                break;
+            }
+        }
+        if(l==hi){
+            hi--;
+            its = 0;
+            continue;
+        }
+        if(totalIts++ > 30*n)
+            return 1;
+        its++;
+
+        /* Wilkinson shift (the eigenvalue of the trailing 2 x 2 block which is closer to its last element), or an
+         * exceptional shift every 10 iterations */
+        d = H[hi*n+hi];
+        if(its%10==0)
+            mu = cradd(d, cabs(H[(hi-1)*n+hi]) + (hi>1 ? cabs(H[(hi-2)*n+hi-1]) : 0.0));
+        else{
+            a = H[(hi-1)*n+hi-1];
+            b = H[hi*n+hi-1];
+            cc = H[(hi-1)*n+hi];
+            half = crmul(ccsub(a, d), 0.5);
+            disc = csqrt(ccadd(ccmul(half, half), ccmul(b, cc)));
+            mu = cabs(ccsub(half, disc)) < cabs(ccadd(half, disc)) ? ccadd(d, ccsub(half, disc)) : ccadd(d, ccadd(half, disc));
+        }
+
+        /* H - mu*I = Q*R, and H = R*Q + mu*I, with Q given by Givens rotations [c s; -conj(s) c] */
+        for(k=l; k<=hi; k++)
+            H[k*n+k] = ccsub(H[k*n+k], mu);
+        for(k=l; k<hi; k++){
+            t1 = H[k*n+k];
+            t2 = H[k*n+k+1];
+            s = sqrt(builtin_zabs2(t1) + builtin_zabs2(t2));
+            if(s==0.0){
+                c = 1.0;
+                sn = cmplx(0.0, 0.0);
+            }
+            else if(cabs(t1)==0.0){
+                c = 0.0;
+                sn = cmplx(1.0, 0.0);
+            }
+            else{
+                c = cabs(t1)/s;
+                sn = crdiv(ccmul(crdiv(t1, cabs(t1)), conj(t2)), s);
+            }
+            x[k] = cmplx(c, 0.0);
+            w[k] = sn; /* (w is used to hold the rotations) */
+            for(j=k; j<n; j++){
+                t1 = H[j*n+k];
+                t2 = H[j*n+k+1];
+                H[j*n+k] = ccadd(crmul(t1, c), ccmul(sn, t2));
+                H[j*n+k+1] = ccsub(crmul(t2, c), ccmul(conj(sn), t1));
+            }
+        }
+        for(k=l; k<hi; k++){
+            c = creal(x[k]);
+            sn = w[k];
+            for(i=0; i<=k+1; i++){
+                t1 = H[k*n+i];
+                t2 = H[(k+1)*n+i];
+                H[k*n+i] = ccadd(crmul(t1, c), ccmul(t2, conj(sn)));
+                H[(k+1)*n+i] = ccsub(crmul(t2, c), ccmul(t1, sn));
+            }
+            for(i=0; i<n; i++){
+                t1 = Z[k*n+i];
+                t2 = Z[(k+1)*n+i];
+                Z[k*n+i] = ccadd(crmul(t1, c), ccmul(t2, conj(sn)));
+                Z[(k+1)*n+i] = ccsub(crmul(t2, c), ccmul(t1, sn));
+            }
+        }
+        for(k=l; k<=hi; k++)
+            H[k*n+k] = ccadd(H[k*n+k], mu);
+    }
+    for(k=0; k<n; k++)
+        w[k] = H[k*n+k];
+
+    /* eigenvectors of T (back/forward substitution; see ?trevc), transformed by Z */
+    tnorm = 0.0;
+    for(j=0; j<n*n; j++)
+        tnorm = MAX(tnorm, cabs(H[j]));
+    smin = MAX(DBL_EPSILON*tnorm, DBL_MIN);
+    for(k=0; VR!=NULL && k<n; k++){
+        x[k] = cmplx(1.0, 0.0);
+        for(j=k-1; j>=0; j--){
+            t1 = cmplx(0.0, 0.0);
+            for(i=j+1; i<=k; i++)
+                t1 = ccadd(t1, ccmul(H[i*n+j], x[i]));
+            den = ccsub(H[j*n+j], w[k]);
+            if(cabs(den)<smin)
+                den = cmplx(smin, 0.0);
+            x[j] = ccdiv(cmplx(-creal(t1), -cimag(t1)), den);
+        }
+        for(i=0; i<n; i++){
+            t1 = cmplx(0.0, 0.0);
+            for(j=0; j<=k; j++)
+                t1 = ccadd(t1, ccmul(Z[j*n+i], x[j]));
+            VR[k*n+i] = t1;
+        }
+    }
+    for(k=0; VL!=NULL && k<n; k++){
+        x[k] = cmplx(1.0, 0.0);
+        for(j=k+1; j<n; j++){
+            t1 = cmplx(0.0, 0.0);
+            for(i=k; i<j; i++)
+                t1 = ccadd(t1, ccmul(conj(H[j*n+i]), x[i]));
+            den = conj(ccsub(H[j*n+j], w[k]));
+            if(cabs(den)<smin)
+                den = cmplx(smin, 0.0);
+            x[j] = ccdiv(cmplx(-creal(t1), -cimag(t1)), den);
+        }
+        for(i=0; i<n; i++){
+            t1 = cmplx(0.0, 0.0);
+            for(j=k; j<n; j++)
+                t1 = ccadd(t1, ccmul(Z[j*n+i], x[j]));
+            VL[k*n+i] = t1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Writes the (n x 1) vector v into column 'j' of 'out'; normalised to unit
+ * norm with the largest component real (?geev convention), or such that the
+ * largest component has |real|+|imag| = 1 (?ggev convention)
+ */
+static void builtin_setEigenvector(BUILTIN_LAPACK_TYPES type, int ggevNorm, int n, const double_complex* v, void* out, int ldo, int j)
+{
+    int i, iMax;
+    double norm, maxVal, val;
+    double_complex scale;
+
+    norm = maxVal = 0.0;
+    iMax = 0;
+    for(i=0; i<n; i++){
+        val = ggevNorm ? fabs(creal(v[i])) + fabs(cimag(v[i])) : builtin_zabs2(v[i]);
+        norm += builtin_zabs2(v[i]);
+        if(val>maxVal){
+            maxVal = val;
+            iMax = i;
+        }
+    }
+    if(maxVal==0.0)
+        scale = cmplx(0.0, 0.0);
+    else if(ggevNorm)
+        scale = cmplx(1.0/maxVal, 0.0);
+    else
+        scale = crdiv(conj(v[iMax]), cabs(v[iMax])*sqrt(norm));
+    for(i=0; i<n; i++)
+        builtin_lapack_set(out, type, (size_t)j*ldo+i, ccmul(v[i], scale));
+}
+
+lapack_int LAPACKE_cgeev_work(int matrix_layout, char jobvl, char jobvr, lapack_int n, float_complex* a, lapack_int lda,
+                              float_complex* w, float_complex* vl, lapack_int ldvl, float_complex* vr, lapack_int ldvr,
+                              float_complex* work, lapack_int lwork, float* rwork)
+{
+    int i, j, info, wantVL, wantVR;
+    double_complex *H, *Z, *VLd, *VRd, *wd, *x;
+
+    (void)rwork;
+    if(lwork==-1){
+        builtin_lapack_setLwork(work, BUILTIN_LAPACK_C, builtin_lapack_getLwork(BUILTIN_LAPACK_C, 4*(size_t)n*n + 2*n));
+        return 0;
+    }
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    if(lwork < builtin_lapack_getLwork(BUILTIN_LAPACK_C, 4*(size_t)n*n + 2*n))
+        return -13;
+    wantVL = jobvl=='V' || jobvl=='v';
+    wantVR = jobvr=='V' || jobvr=='v';
+    H = builtin_lapack_alignWork(work);
+    Z = &H[n*n];
+    VLd = &Z[n*n];
+    VRd = &VLd[n*n];
+    wd = &VRd[n*n];
+    x = &wd[n];
+    for(j=0; j<n; j++)
+        for(i=0; i<n; i++)
+            H[j*n+i] = builtin_lapack_get(a, BUILTIN_LAPACK_C, (size_t)j*lda+i);
+    info = builtin_zgeevSchur(n, H, Z, wd, wantVL ? VLd : NULL, wantVR ? VRd : NULL, x);
+    if(info!=0)
+        return info;
+    for(j=0; j<n; j++){
+        w[j] = cmplxf((float)creal(wd[j]), (float)cimag(wd[j]));
+        if(wantVL)
+            builtin_setEigenvector(BUILTIN_LAPACK_C, 0, n, &VLd[j*n], vl, ldvl, j);
+        if(wantVR)
+            builtin_setEigenvector(BUILTIN_LAPACK_C, 0, n, &VRd[j*n], vr, ldvr, j);
+    }
+    return 0;
+}
+
+/**
+ * ?ggev, for the complex types
+ *
+ * The pencil is reduced to the standard eigenproblem of B^-1*A, whose left
+ * eigenvectors y give those of the pencil as B^-H*y; beta is always 1. B must
+ * therefore be non-singular (n+1 is returned otherwise).
+ */
+static lapack_int builtin_ggev(BUILTIN_LAPACK_TYPES type, int matrix_layout, char jobvl, char jobvr, lapack_int n, const void* a,
+                               lapack_int lda, const void* b, lapack_int ldb, void* alpha, void* beta, void* vl, lapack_int ldvl,
+                               void* vr, lapack_int ldvr, void* work, lapack_int lwork)
+{
+    int i, j, k, info, wantVL, wantVR;
+    lapack_int* ipiv;
+    double_complex *Bf, *C, *Z, *VLd, *VRd, *wd, *x, *u, tmp;
+    size_t workSize;
+
+    workSize = 6*(size_t)n*n + 2*n + (n*sizeof(lapack_int) + sizeof(double_complex)-1)/sizeof(double_complex);
+    if(lwork==-1){
+        builtin_lapack_setLwork(work, type, builtin_lapack_getLwork(type, workSize));
+        return 0;
+    }
+    if(matrix_layout!=LAPACK_COL_MAJOR)
+        return -1;
+    if(lwork < builtin_lapack_getLwork(type, workSize))
+        return -16;
+    wantVL = jobvl=='V' || jobvl=='v';
+    wantVR = jobvr=='V' || jobvr=='v';
+    Bf = builtin_lapack_alignWork(work);
+    C = &Bf[n*n];
+    Z = &C[n*n];
+    VLd = &Z[n*n];
+    VRd = &VLd[n*n];
+    wd = &VRd[n*n];
+    x = &wd[n];
+    ipiv = (lapack_int*)&x[n];
+
+    /* C = B^-1*A (with the LU factors of B kept in Bf) */
+    for(j=0; j<n; j++){
+        for(i=0; i<n; i++){
+            Bf[j*n+i] = builtin_lapack_get(b, type, (size_t)j*ldb+i);
+            C[j*n+i] = builtin_lapack_get(a, type, (size_t)j*lda+i);
+        }
+    }
+    if(LAPACKE_zgesv(LAPACK_COL_MAJOR, n, n, Bf, n, ipiv, C, n)!=0)
+        return n+1;
+    info = builtin_zgeevSchur(n, C, Z, wd, wantVL ? VLd : NULL, wantVR ? VRd : NULL, x);
+    if(info!=0)
+        return info;
+
+    /* left eigenvectors of the pencil: B^H*u = y, with B = P^T*L*U */
+    for(k=0; wantVL && k<n; k++){
+        u = &VLd[k*n];
+        for(j=0; j<n; j++){ /* U^H*z = y */
+            for(i=0; i<j; i++)
+                u[j] = ccsub(u[j], ccmul(conj(Bf[j*n+i]), u[i]));
+            u[j] = ccdiv(u[j], conj(Bf[j*n+j]));
+        }
+        for(j=n-1; j>=0; j--) /* L^H*t = z */
+            for(i=j+1; i<n; i++)
+                u[j] = ccsub(u[j], ccmul(conj(Bf[j*n+i]), u[i]));
+        for(j=n-1; j>=0; j--){ /* u = P^T*t */
+            if(ipiv[j]-1!=j){
+                tmp = u[j];
+                u[j] = u[ipiv[j]-1];
+                u[ipiv[j]-1] = tmp;
+            }
+        }
+    }
+    for(j=0; j<n; j++){
+        builtin_lapack_set(alpha, type, j, wd[j]);
+        builtin_lapack_set(beta, type, j, cmplx(1.0, 0.0));
+        if(wantVL)
+            builtin_setEigenvector(type, 1, n, &VLd[j*n], vl, ldvl, j);
+        if(wantVR)
+            builtin_setEigenvector(type, 1, n, &VRd[j*n], vr, ldvr, j);
+    }
+    return 0;
+}
+
+lapack_int LAPACKE_cggev_work(int matrix_layout, char jobvl, char jobvr, lapack_int n, float_complex* a, lapack_int lda,
+                              float_complex* b, lapack_int ldb, float_complex* alpha, float_complex* beta, float_complex* vl,
+                              lapack_int ldvl, float_complex* vr, lapack_int ldvr, float_complex* work, lapack_int lwork, float* rwork)
+{
+    (void)rwork;
+    return builtin_ggev(BUILTIN_LAPACK_C, matrix_layout, jobvl, jobvr, n, a, lda, b, ldb, alpha, beta, vl, ldvl, vr, ldvr, work, lwork);
+}
+
+lapack_int LAPACKE_zggev_work(int matrix_layout, char jobvl, char jobvr, lapack_int n, double_complex* a, lapack_int lda,
+                              double_complex* b, lapack_int ldb, double_complex* alpha, double_complex* beta, double_complex* vl,
+                              lapack_int ldvl, double_complex* vr, lapack_int ldvr, double_complex* work, lapack_int lwork, double* rwork)
+{
+    (void)rwork;
+    return builtin_ggev(BUILTIN_LAPACK_Z, matrix_layout, jobvl, jobvr, n, a, lda, b, ldb, alpha, beta, vl, ldvl, vr, ldvr, work, lwork);
+}
+
+#endif /* SAF_BUILTINBLAS_H_INCLUDED */
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_builtinBlas.h
+ * @brief A minimal, dependency-free subset of CBLAS and LAPACKE, for builds
+ *        without a performance library (e.g. WebAssembly builds for the
+ *        browser)
+ *
+ * Enabled with SAF_USE_BUILTIN_BLAS_AND_LAPACK (and by default when compiling
+ * with Emscripten, if no other library is selected). Only the routines called
+ * by the framework are offered, with the standard CBLAS and LAPACKE
+ * signatures; such that saf_veclib employs them through its LAPACKE code
+ * paths. The BLAS routines are plain loops, ordered such that the innermost
+ * loops run over contiguous memory (which the compiler may then vectorise,
+ * e.g. with -msimd128); they are intended for the small matrices of the
+ * real-time processing loops (e.g. the SH rotation of the rotator, and the
+ * binaural decoding of ambi_bin), rather than for large problems.
+ *
+ * Of LAPACK, the general (?gesv, ?getrf, ?getri) and the positive definite
+ * (?posv, ?potrf) linear solvers are implemented, along with the SVD and
+ * eigenvalue routines employed by the framework (?gesvd, ?syev, ?heev,
+ * ?heevr, ?geev, ?ggev). The latter are computed in double complex precision
+ * using Jacobi methods (one-sided Jacobi for the SVD, cyclic Jacobi for the
+ * symmetric/Hermitian eigenproblems), and a Hessenberg reduction followed by
+ * shifted QR iterations for the general eigenproblem; which are robust and
+ * accurate, but scale poorly with the matrix size (they are intended for the
+ * initialisation of e.g. array2sh, sldoa, powermap and the EPAD decoder).
+ *
+ * @note The FFT employs KissFFT for such builds (see saf_fft.h), and the
+ *       element-wise kernels of saf_veclib employ WebAssembly SIMD128 if the
+ *       compiler targets it.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_BUILTINBLAS_H_INCLUDED
+#define SAF_BUILTINBLAS_H_INCLUDED
+
+#include <stddef.h>
+#include "saf_complex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ========================================================================== */
+/*                               CBLAS Subset                                 */
+/* ========================================================================== */
+
+/** Storage order of the matrices */
+typedef enum CBLAS_ORDER { CblasRowMajor=101, CblasColMajor=102 } CBLAS_ORDER;
+/** Transpose operation applied to a matrix */
+typedef enum CBLAS_TRANSPOSE { CblasNoTrans=111, CblasTrans=112, CblasConjTrans=113 } CBLAS_TRANSPOSE;
+/** Upper or lower triangle of a matrix */
+typedef enum CBLAS_UPLO { CblasUpper=121, CblasLower=122 } CBLAS_UPLO;
+/** Index type returned by the cblas_i?amax() functions */
+typedef size_t CBLAS_INDEX;
+
+/** y = alpha*x + y */
+void cblas_saxpy(const int N, const float alpha, const float* X, const int incX,
+                 float* Y, const int incY);
+
+/** Returns x^T*y */
+float cblas_sdot(const int N, const float* X, const int incX, const float* Y,
+                 const int incY);
+
+/** Returns x^T*y */
+double cblas_ddot(const int N, const double* X, const int incX, const double* Y,
+                  const int incY);
+
+/** dotu = x^T*y (complex) */
+void cblas_cdotu_sub(const int N, const void* X, const int incX, const void* Y,
+                     const int incY, void* dotu);
+
+/** dotc = x^H*y (complex) */
+void cblas_cdotc_sub(const int N, const void* X, const int incX, const void* Y,
+                     const int incY, void* dotc);
+
+/** y = x */
+void cblas_scopy(const int N, const float* X, const int incX, float* Y,
+                 const int incY);
+
+/** y = x */
+void cblas_dcopy(const int N, const double* X, const int incX, double* Y,
+                 const int incY);
+
+/** y = x (complex) */
+void cblas_ccopy(const int N, const void* X, const int incX, void* Y,
+                 const int incY);
+
+/** x = alpha*x */
+void cblas_sscal(const int N, const float alpha, float* X, const int incX);
+
+/** x = alpha*x */
+void cblas_dscal(const int N, const double alpha, double* X, const int incX);
+
+/** x = alpha*x (complex) */
+void cblas_cscal(const int N, const void* alpha, void* X, const int incX);
+
+/** x = alpha*x (double complex) */
+void cblas_zscal(const int N, const void* alpha, void* X, const int incX);
+
+/** Returns the 2-norm of x */
+float cblas_snrm2(const int N, const float* X, const int incX);
+
+/** Returns the index of the first element with the maximum absolute value */
+CBLAS_INDEX cblas_isamax(const int N, const float* X, const int incX);
+
+/**
+ * Returns the index of the first element with the maximum |re|+|im|
+ * (complex)
+ */
+CBLAS_INDEX cblas_icamax(const int N, const void* X, const int incX);
+
+/** y = alpha*op(A)*x + beta*y */
+void cblas_sgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA,
+                 const int M, const int N, const float alpha, const float* A,
+                 const int lda, const float* X, const int incX,
+                 const float beta, float* Y, const int incY);
+
+/** y = alpha*op(A)*x + beta*y */
+void cblas_dgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA,
+                 const int M, const int N, const double alpha, const double* A,
+                 const int lda, const double* X, const int incX,
+                 const double beta, double* Y, const int incY);
+
+/** y = alpha*op(A)*x + beta*y (complex) */
+void cblas_cgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE TransA,
+                 const int M, const int N, const void* alpha, const void* A,
+                 const int lda, const void* X, const int incX,
+                 const void* beta, void* Y, const int incY);
+
+/** A = alpha*x*y^T + A */
+void cblas_dger(const enum CBLAS_ORDER order, const int M, const int N,
+                const double alpha, const double* X, const int incX,
+                const double* Y, const int incY, double* A, const int lda);
+
+/** C = alpha*op(A)*op(B) + beta*C */
+void cblas_sgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+                 const enum CBLAS_TRANSPOSE TransB, const int M, const int N,
+                 const int K, const float alpha, const float* A, const int lda,
+                 const float* B, const int ldb, const float beta, float* C,
+                 const int ldc);
+
+/** C = alpha*op(A)*op(B) + beta*C */
+void cblas_dgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+                 const enum CBLAS_TRANSPOSE TransB, const int M, const int N,
+                 const int K, const double alpha, const double* A, const int lda,
+                 const double* B, const int ldb, const double beta, double* C,
+                 const int ldc);
+
+/** C = alpha*op(A)*op(B) + beta*C (complex) */
+void cblas_cgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+                 const enum CBLAS_TRANSPOSE TransB, const int M, const int N,
+                 const int K, const void* alpha, const void* A, const int lda,
+                 const void* B, const int ldb, const void* beta, void* C,
+                 const int ldc);
+
+/** C = alpha*op(A)*op(B) + beta*C (double complex) */
+void cblas_zgemm(const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+                 const enum CBLAS_TRANSPOSE TransB, const int M, const int N,
+                 const int K, const void* alpha, const void* A, const int lda,
+                 const void* B, const int ldb, const void* beta, void* C,
+                 const int ldc);
+
+
+/* ========================================================================== */
+/*                              LAPACKE Subset                                */
+/* ========================================================================== */
+
+/* Only column-major storage is supported (as used by saf_veclib), for which
+ * the routines return -1 otherwise. 'uplo' may also be given as CblasUpper or
+ * CblasLower. */
+
+#define LAPACK_ROW_MAJOR ( 101 )
+#define LAPACK_COL_MAJOR ( 102 )
+typedef int lapack_int;
+
+/** Solves A*X = B (LU decomposition with partial pivoting) */
+lapack_int LAPACKE_sgesv(int matrix_layout, lapack_int n, lapack_int nrhs,
+                         float* a, lapack_int lda, lapack_int* ipiv, float* b,
+                         lapack_int ldb);
+
+/** Solves A*X = B (LU decomposition with partial pivoting) */
+lapack_int LAPACKE_dgesv(int matrix_layout, lapack_int n, lapack_int nrhs,
+                         double* a, lapack_int lda, lapack_int* ipiv, double* b,
+                         lapack_int ldb);
+
+/** Solves A*X = B (LU decomposition with partial pivoting) */
+lapack_int LAPACKE_cgesv(int matrix_layout, lapack_int n, lapack_int nrhs,
+                         float_complex* a, lapack_int lda, lapack_int* ipiv,
+                         float_complex* b, lapack_int ldb);
+
+/** Solves A*X = B (LU decomposition with partial pivoting) */
+lapack_int LAPACKE_zgesv(int matrix_layout, lapack_int n, lapack_int nrhs,
+                         double_complex* a, lapack_int lda, lapack_int* ipiv,
+                         double_complex* b, lapack_int ldb);
+
+/** LU decomposition with partial pivoting: A = P*L*U */
+lapack_int LAPACKE_sgetrf(int matrix_layout, lapack_int m, lapack_int n,
+                          float* a, lapack_int lda, lapack_int* ipiv);
+
+/** LU decomposition with partial pivoting: A = P*L*U */
+lapack_int LAPACKE_dgetrf(int matrix_layout, lapack_int m, lapack_int n,
+                          double* a, lapack_int lda, lapack_int* ipiv);
+
+/** LU decomposition with partial pivoting: A = P*L*U */
+lapack_int LAPACKE_cgetrf(int matrix_layout, lapack_int m, lapack_int n,
+                          float_complex* a, lapack_int lda, lapack_int* ipiv);
+
+/** Inverse of A, from its LU decomposition (?getrf) */
+lapack_int LAPACKE_sgetri(int matrix_layout, lapack_int n, float* a,
+                          lapack_int lda, const lapack_int* ipiv);
+
+/** Inverse of A, from its LU decomposition (?getrf) */
+lapack_int LAPACKE_dgetri(int matrix_layout, lapack_int n, double* a,
+                          lapack_int lda, const lapack_int* ipiv);
+
+/** Inverse of A, from its LU decomposition (?getrf) */
+lapack_int LAPACKE_cgetri(int matrix_layout, lapack_int n, float_complex* a,
+                          lapack_int lda, const lapack_int* ipiv);
+
+/** Solves A*X = B, for symmetric positive definite A (Cholesky) */
+lapack_int LAPACKE_sposv(int matrix_layout, char uplo, lapack_int n,
+                         lapack_int nrhs, float* a, lapack_int lda, float* b,
+                         lapack_int ldb);
+
+/** Solves A*X = B, for Hermitian positive definite A (Cholesky) */
+lapack_int LAPACKE_cposv(int matrix_layout, char uplo, lapack_int n,
+                         lapack_int nrhs, float_complex* a, lapack_int lda,
+                         float_complex* b, lapack_int ldb);
+
+/** Cholesky factorisation of a symmetric positive definite matrix */
+lapack_int LAPACKE_spotrf(int matrix_layout, char uplo, lapack_int n, float* a,
+                          lapack_int lda);
+
+/** Cholesky factorisation of a Hermitian positive definite matrix */
+lapack_int LAPACKE_cpotrf(int matrix_layout, char uplo, lapack_int n,
+                          float_complex* a, lapack_int lda);
+
+/* The following support workspace queries (lwork=-1), and return the
+ * standard LAPACK error codes (negative for an invalid argument, e.g. an
+ * insufficient lwork). Note that no memory is allocated internally, so the
+ * workspace required may exceed that of a performance library */
+
+/** Singular value decomposition (one-sided Jacobi; jobu/jobvt: 'A','S','N') */
+lapack_int LAPACKE_sgesvd_work(int matrix_layout, char jobu, char jobvt,
+                               lapack_int m, lapack_int n, float* a,
+                               lapack_int lda, float* s, float* u,
+                               lapack_int ldu, float* vt, lapack_int ldvt,
+                               float* work, lapack_int lwork);
+
+/** Singular value decomposition (one-sided Jacobi; jobu/jobvt: 'A','S','N') */
+lapack_int LAPACKE_dgesvd_work(int matrix_layout, char jobu, char jobvt,
+                               lapack_int m, lapack_int n, double* a,
+                               lapack_int lda, double* s, double* u,
+                               lapack_int ldu, double* vt, lapack_int ldvt,
+                               double* work, lapack_int lwork);
+
+/** Singular value decomposition (one-sided Jacobi; jobu/jobvt: 'A','S','N') */
+lapack_int LAPACKE_cgesvd_work(int matrix_layout, char jobu, char jobvt,
+                               lapack_int m, lapack_int n, float_complex* a,
+                               lapack_int lda, float* s, float_complex* u,
+                               lapack_int ldu, float_complex* vt,
+                               lapack_int ldvt, float_complex* work,
+                               lapack_int lwork, float* rwork);
+
+/** Singular value decomposition (one-sided Jacobi; jobu/jobvt: 'A','S','N') */
+lapack_int LAPACKE_zgesvd_work(int matrix_layout, char jobu, char jobvt,
+                               lapack_int m, lapack_int n, double_complex* a,
+                               lapack_int lda, double* s, double_complex* u,
+                               lapack_int ldu, double_complex* vt,
+                               lapack_int ldvt, double_complex* work,
+                               lapack_int lwork, double* rwork);
+
+/** Eigenvalues (ascending) and vectors of a symmetric matrix (Jacobi) */
+lapack_int LAPACKE_ssyev_work(int matrix_layout, char jobz, char uplo,
+                              lapack_int n, float* a, lapack_int lda, float* w,
+                              float* work, lapack_int lwork);
+
+/** Eigenvalues (ascending) and vectors of a Hermitian matrix (Jacobi) */
+lapack_int LAPACKE_cheev_work(int matrix_layout, char jobz, char uplo,
+                              lapack_int n, float_complex* a, lapack_int lda,
+                              float* w, float_complex* work, lapack_int lwork,
+                              float* rwork);
+
+/** Selected eigenvalues/vectors of a Hermitian matrix (Jacobi; range: 'A',
+ *  'I','V'; isuppz is set to the full support) */
+lapack_int LAPACKE_cheevr_work(int matrix_layout, char jobz, char range,
+                               char uplo, lapack_int n, float_complex* a,
+                               lapack_int lda, float vl, float vu,
+                               lapack_int il, lapack_int iu, float abstol,
+                               lapack_int* m, float* w, float_complex* z,
+                               lapack_int ldz, lapack_int* isuppz,
+                               float_complex* work, lapack_int lwork,
+                               float* rwork, lapack_int lrwork,
+                               lapack_int* iwork, lapack_int liwork);
+
+/** Eigenvalues and left/right eigenvectors of a general matrix (Hessenberg
+ *  reduction and shifted QR) */
+lapack_int LAPACKE_cgeev_work(int matrix_layout, char jobvl, char jobvr,
+                              lapack_int n, float_complex* a, lapack_int lda,
+                              float_complex* w, float_complex* vl,
+                              lapack_int ldvl, float_complex* vr,
+                              lapack_int ldvr, float_complex* work,
+                              lapack_int lwork, float* rwork);
+
+/** Generalised eigenvalues/vectors, computed from B^-1 A (requires a
+ *  non-singular B; beta is returned as 1, and n+1 if B is singular) */
+lapack_int LAPACKE_cggev_work(int matrix_layout, char jobvl, char jobvr,
+                              lapack_int n, float_complex* a, lapack_int lda,
+                              float_complex* b, lapack_int ldb,
+                              float_complex* alpha, float_complex* beta,
+                              float_complex* vl, lapack_int ldvl,
+                              float_complex* vr, lapack_int ldvr,
+                              float_complex* work, lapack_int lwork,
+                              float* rwork);
+
+/** Generalised eigenvalues/vectors, computed from B^-1 A (requires a
+ *  non-singular B; beta is returned as 1, and n+1 if B is singular) */
+lapack_int LAPACKE_zggev_work(int matrix_layout, char jobvl, char jobvr,
+                              lapack_int n, double_complex* a, lapack_int lda,
+                              double_complex* b, lapack_int ldb,
+                              double_complex* alpha, double_complex* beta,
+                              double_complex* vl, lapack_int ldvl,
+                              double_complex* vr, lapack_int ldvr,
+                              double_complex* work, lapack_int lwork,
+                              double* rwork);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_BUILTINBLAS_H_INCLUDED */
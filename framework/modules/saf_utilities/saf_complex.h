@@ -226,4 +226,14 @@
 # error "SAF requires a compiler that supports the C99 standard, or MSVC version 1900 or newer"
 #endif
 
+/**
+ * Single-precision, split-complex vector; i.e. with the real and imaginary
+ * parts held in separate arrays (as preferred by vDSP, and as emitted by
+ * afSTFT, see complexVector)
+ */
+typedef struct _float_complex_split {
+    float* re;  /**< Real parts */
+    float* im;  /**< Imaginary parts */
+}float_complex_split;
+
 #endif /* SAF_COMPLEX_H_INCLUDED */
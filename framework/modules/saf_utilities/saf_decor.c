@@ -133,7 +133,7 @@ void synthesiseNoiseReverb
     fcut = malloc1d((nBands-1)*sizeof(float));
     h_filt = malloc1d(nBands*(filterOrder+1)*sizeof(float));
     getOctaveBandCutoffFreqs(fcen_oct, nBands, fcut);
-    FIRFilterbank(filterOrder, fcut, (nBands-1), fs, WINDOWING_FUNCTION_HAMMING, 1, h_filt);
+    FIRFilterbankCached(filterOrder, fcut, (nBands-1), fs, WINDOWING_FUNCTION_HAMMING, 1, h_filt);
     
     /* filter RIRs with filterbank */
     (*rir_filt) = realloc1d((*rir_filt), nCH*rir_filt_lout*sizeof(float));
@@ -150,8 +150,7 @@ void synthesiseNoiseReverb
     
     /* equalise, to force flat magnitude response */
     if(flattenFLAG)
-        for(i=0; i<nCH; i++)
-            flattenMinphase(&((*rir_filt)[i*rir_filt_lout]), rir_filt_lout);
+        flattenMinphaseBatch((*rir_filt), rir_filt_lout, nCH);
     
     /* remove filterbank delay */
     for(i=0; i<nCH; i++)
@@ -165,3 +164,408 @@ void synthesiseNoiseReverb
     free(rir_filt_tmp);
 }
 
+
+/** FFT size used by synthesiseNoiseReverbFD() (hop size is half of this) */
+#define NOISE_REVERB_FD_FFT_SIZE ( 1024 )
+
+/**
+ * Shared (read-only) data for the synthesiseNoiseReverbFD() workers
+ */
+typedef struct _noiseReverbFD_job {
+    int rir_len;          /**< output length, in samples */
+    int nFrames;          /**< number of STFT frames per channel */
+    int flattenFLAG;      /**< see synthesiseNoiseReverbFD() */
+    float* window;        /**< sqrt-Hann window; NOISE_REVERB_FD_FFT_SIZE x 1 */
+    float* env;           /**< bin amplitudes per frame; FLAT: nFrames x nBins */
+    unsigned int* seeds;  /**< noise seed per channel; nChannels x 1 */
+    float* rir_filt;      /**< output; FLAT: nChannels x rir_len */
+
+}noiseReverbFD_job;
+
+/** Uniform random number in [-1 1], from a per-channel xorshift state */
+static float noiseReverbFD_rand(unsigned int* state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (float)x/2147483648.0f - 1.0f;
+}
+
+/** Synthesises channels first..last-1 (see synthesiseNoiseReverbFD()) */
+static void noiseReverbFD_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    noiseReverbFD_job* job = (noiseReverbFD_job*)hCtx;
+    int ch, f, k, n, start, N, hop, nBins, bufLen;
+    unsigned int state;
+    float *frameTD, *buf;
+    float_complex* frameFD;
+    void* hFFT;
+    (void)threadIndex;
+
+    N = NOISE_REVERB_FD_FFT_SIZE;
+    hop = N/2;
+    nBins = N/2+1;
+    bufLen = job->nFrames*hop + N;
+    saf_rfft_create(&hFFT, N);
+    frameTD = malloc1d(N*sizeof(float));
+    frameFD = malloc1d(nBins*sizeof(float_complex));
+    buf = malloc1d(bufLen*sizeof(float));
+    for(ch=first; ch<last; ch++){
+        state = job->seeds[ch];
+        memset(buf, 0, bufLen*sizeof(float));
+        for(f=0; f<job->nFrames; f++){
+            /* decaying complex noise spectrum */
+            for(k=0; k<nBins; k++)
+                frameFD[k] = cmplxf(job->env[f*nBins+k]*noiseReverbFD_rand(&state),
+                                    k==0 || k==nBins-1 ? 0.0f : job->env[f*nBins+k]*noiseReverbFD_rand(&state));
+            saf_rfft_backward(hFFT, frameFD, frameTD);
+
+            /* overlap-add; frame 'f' is centred on sample f*hop (+ N/2 in buf) */
+            start = f*hop;
+            for(n=0; n<N; n++)
+                buf[start+n] += job->window[n]*frameTD[n];
+        }
+        memcpy(&(job->rir_filt[ch*job->rir_len]), &buf[N/2], job->rir_len*sizeof(float));
+    }
+    if(job->flattenFLAG && last>first)
+        flattenMinphaseBatch(&(job->rir_filt[first*job->rir_len]), job->rir_len, last-first);
+    saf_rfft_destroy(&hFFT);
+    free(frameTD);
+    free(frameFD);
+    free(buf);
+}
+
+void synthesiseNoiseReverbFD
+(
+    int nCH,
+    float fs,
+    float* t60,
+    float* fcen_oct,
+    int nBands,
+    int flattenFLAG,
+    int nThreads,
+    float** rir_filt,
+    int* rir_len
+)
+{
+    int i, k, f, N, hop, nBins;
+    float max_t60, freq, t60_k, t, binScale, u;
+    float* alpha_k;
+    noiseReverbFD_job job;
+    void* hPar;
+
+    N = NOISE_REVERB_FD_FFT_SIZE;
+    hop = N/2;
+    nBins = N/2+1;
+
+    /* find rir length */
+    max_t60 = 0.0f;
+    for(i=0; i<nBands; i++)
+        max_t60 = max_t60 < t60[i] ? t60[i] : max_t60;
+    job.rir_len = (int)(max_t60*fs+0.5f);
+    job.nFrames = (job.rir_len + hop - 1)/hop + 1;
+    job.flattenFLAG = flattenFLAG;
+
+    /* decay constant per bin, with t60 interpolated over log-frequency */
+    alpha_k = malloc1d(nBins*sizeof(float));
+    for(k=0; k<nBins; k++){
+        freq = MAX((float)k*fs/(float)N, fcen_oct[0]);
+        if(freq>=fcen_oct[nBands-1])
+            t60_k = t60[nBands-1];
+        else{
+            for(i=0; i<nBands-2 && freq>=fcen_oct[i+1]; i++){}
+            u = logf(freq/fcen_oct[i])/logf(fcen_oct[i+1]/fcen_oct[i]);
+            t60_k = (1.0f-u)*t60[i] + u*t60[i+1];
+        }
+        alpha_k[k] = 3.0f*logf(10.0f)/MAX(t60_k, 1e-4f);
+    }
+
+    /* Bin amplitudes per frame; scaled such that the output has the same
+     * variance as the uniform [-1 1] noise of synthesiseNoiseReverb() (1/3),
+     * given the 1/N scaling of the inverse FFT and that sum(window.^2)=1 */
+    binScale = sqrtf((float)N/2.0f);
+    job.env = malloc1d(job.nFrames*nBins*sizeof(float));
+    for(f=0; f<job.nFrames; f++){
+        t = (float)(f*hop)/fs;
+        for(k=0; k<nBins; k++)
+            job.env[f*nBins+k] = binScale*expf(-t*alpha_k[k]);
+    }
+    job.window = malloc1d(N*sizeof(float));
+    for(i=0; i<N; i++)
+        job.window[i] = sqrtf(0.5f - 0.5f*cosf(2.0f*M_PI*(float)i/(float)N));
+
+    /* seeds are drawn up-front, so that the result does not depend on the
+     * number of threads */
+    job.seeds = malloc1d(nCH*sizeof(unsigned int));
+    for(i=0; i<nCH; i++)
+        job.seeds[i] = (((unsigned int)rand() << 16) ^ (unsigned int)rand() ^ 0x9E3779B9u) | 1u;
+
+    (*rir_filt) = realloc1d((*rir_filt), nCH*job.rir_len*sizeof(float));
+    job.rir_filt = (*rir_filt);
+    nThreads = CLAMP(nThreads, 1, MAX(nCH, 1));
+    if(nThreads>1){
+        saf_parfor_create(&hPar, nThreads);
+        saf_parfor_run(hPar, noiseReverbFD_range, (void*)&job, nCH);
+        saf_parfor_destroy(&hPar);
+    }
+    else
+        noiseReverbFD_range((void*)&job, 0, 0, nCH);
+    (*rir_len) = job.rir_len;
+
+    /* clean-up */
+    free(alpha_k);
+    free(job.env);
+    free(job.window);
+    free(job.seeds);
+}
+
+
+/* ========================================================================== */
+/*                        Streaming Decorrelator Functions                    */
+/* ========================================================================== */
+
+/** Gain of the Schroeder all-pass sections used by decorrelatorTD */
+#define DECORRELATOR_TD_ALLPASS_GAIN ( 0.5f )
+
+/**
+ * Data structure for the time-frequency domain decorrelator
+ */
+typedef struct _decorrelatorTF_data {
+    int nChannels, nBands;
+    int* delayTF;        /**< delays per line, in time-slots; nBands x nChannels */
+    int* offset;         /**< start of each line in 'ring'; nBands x nChannels */
+    int* wIdx;           /**< current read/write index of each line; nBands x nChannels */
+    float_complex* ring; /**< all delay lines; sum(delayTF) x 1 */
+    int ringLen;         /**< total length of 'ring' */
+
+}decorrelatorTF_data;
+
+/**
+ * Data structure for the time-domain decorrelator
+ */
+typedef struct _decorrelatorTD_data {
+    int nChannels, nStages;
+    int* delay;          /**< delays per all-pass, in samples; nChannels x nStages */
+    int* offset;         /**< start of each line in 'ring'; nChannels x nStages */
+    int* wIdx;           /**< current read/write index of each line; nChannels x nStages */
+    float* ring;         /**< all delay lines; sum(delay) x 1 */
+    int ringLen;         /**< total length of 'ring' */
+
+}decorrelatorTD_data;
+
+void decorrelatorTF_create
+(
+    void ** const phDecor,
+    int nChannels,
+    float* freqs,
+    int nBands,
+    float fs,
+    int maxTFdelay,
+    int hopSize
+)
+{
+    decorrelatorTF_data *h;
+    int i, nLines;
+
+    h = (decorrelatorTF_data*)malloc1d(sizeof(decorrelatorTF_data));
+    *phDecor = (void*)h;
+    h->nChannels = MAX(nChannels, 1);
+    h->nBands = MAX(nBands, 1);
+    nLines = h->nBands * h->nChannels;
+    h->delayTF = malloc1d(nLines*sizeof(int));
+    h->offset = malloc1d(nLines*sizeof(int));
+    h->wIdx = malloc1d(nLines*sizeof(int));
+    getDecorrelationDelays(h->nChannels, freqs, h->nBands, fs, maxTFdelay, hopSize, h->delayTF);
+
+    /* pack all of the delay lines into one buffer */
+    h->ringLen = 0;
+    for(i=0; i<nLines; i++){
+        h->offset[i] = h->ringLen;
+        h->ringLen += h->delayTF[i];
+    }
+    h->ring = malloc1d(MAX(h->ringLen,1)*sizeof(float_complex));
+    decorrelatorTF_reset(*phDecor);
+}
+
+void decorrelatorTF_destroy
+(
+    void ** const phDecor
+)
+{
+    decorrelatorTF_data *h = (decorrelatorTF_data*)(*phDecor);
+
+    if(h!=NULL){
+        free(h->delayTF);
+        free(h->offset);
+        free(h->wIdx);
+        free(h->ring);
+        free(h);
+        *phDecor = NULL;
+    }
+}
+
+void decorrelatorTF_reset
+(
+    void * const hDecor
+)
+{
+    decorrelatorTF_data *h = (decorrelatorTF_data*)(hDecor);
+
+    memset(h->wIdx, 0, h->nBands*h->nChannels*sizeof(int));
+    memset(h->ring, 0, MAX(h->ringLen,1)*sizeof(float_complex));
+}
+
+const int* decorrelatorTF_getDelays
+(
+    void * const hDecor
+)
+{
+    decorrelatorTF_data *h = (decorrelatorTF_data*)(hDecor);
+
+    return (const int*)h->delayTF;
+}
+
+void decorrelatorTF_apply
+(
+    void * const hDecor,
+    float_complex*** inputTF,
+    int nChannels,
+    int nTimeSlots,
+    float_complex*** outputTF
+)
+{
+    decorrelatorTF_data *h = (decorrelatorTF_data*)(hDecor);
+    int band, ch, t, line, d, w;
+    float_complex x;
+    float_complex* ring;
+
+    nChannels = MIN(nChannels, h->nChannels);
+    for(band=0; band<h->nBands; band++){
+        for(ch=0; ch<nChannels; ch++){
+            line = band*h->nChannels+ch;
+            d = h->delayTF[line];
+            if(d==0){
+                if(outputTF[band][ch]!=inputTF[band][ch])
+                    memcpy(outputTF[band][ch], inputTF[band][ch], nTimeSlots*sizeof(float_complex));
+                continue;
+            }
+            ring = &(h->ring[h->offset[line]]);
+            w = h->wIdx[line];
+            for(t=0; t<nTimeSlots; t++){
+                x = inputTF[band][ch][t];
+                outputTF[band][ch][t] = ring[w];
+                ring[w] = x;
+                if(++w==d)
+                    w = 0;
+            }
+            h->wIdx[line] = w;
+        }
+    }
+}
+
+void decorrelatorTD_create
+(
+    void ** const phDecor,
+    int nChannels,
+    float fs,
+    int nStages
+)
+{
+    decorrelatorTD_data *h;
+    int i, nLines;
+    float delay_ms;
+
+    h = (decorrelatorTD_data*)malloc1d(sizeof(decorrelatorTD_data));
+    *phDecor = (void*)h;
+    h->nChannels = MAX(nChannels, 1);
+    h->nStages = MAX(nStages, 1);
+    nLines = h->nChannels * h->nStages;
+    h->delay = malloc1d(nLines*sizeof(int));
+    h->offset = malloc1d(nLines*sizeof(int));
+    h->wIdx = malloc1d(nLines*sizeof(int));
+
+    /* random delays between 1 and 8 ms, packed into one buffer */
+    h->ringLen = 0;
+    for(i=0; i<nLines; i++){
+        delay_ms = 1.0f + 7.0f*(float)rand()/(float)RAND_MAX;
+        h->delay[i] = MAX((int)(delay_ms/1000.0f*fs + 0.5f), 1);
+        h->offset[i] = h->ringLen;
+        h->ringLen += h->delay[i];
+    }
+    h->ring = malloc1d(h->ringLen*sizeof(float));
+    decorrelatorTD_reset(*phDecor);
+}
+
+void decorrelatorTD_destroy
+(
+    void ** const phDecor
+)
+{
+    decorrelatorTD_data *h = (decorrelatorTD_data*)(*phDecor);
+
+    if(h!=NULL){
+        free(h->delay);
+        free(h->offset);
+        free(h->wIdx);
+        free(h->ring);
+        free(h);
+        *phDecor = NULL;
+    }
+}
+
+void decorrelatorTD_reset
+(
+    void * const hDecor
+)
+{
+    decorrelatorTD_data *h = (decorrelatorTD_data*)(hDecor);
+
+    memset(h->wIdx, 0, h->nChannels*h->nStages*sizeof(int));
+    memset(h->ring, 0, h->ringLen*sizeof(float));
+}
+
+void decorrelatorTD_apply
+(
+    void * const hDecor,
+    float** input,
+    int nChannels,
+    int nSamples,
+    float** output
+)
+{
+    decorrelatorTD_data *h = (decorrelatorTD_data*)(hDecor);
+    int ch, s, n, line, d, w;
+    float g, v, vd;
+    float* ring;
+
+    g = DECORRELATOR_TD_ALLPASS_GAIN;
+    nChannels = MIN(nChannels, h->nChannels);
+    for(ch=0; ch<nChannels; ch++){
+        if(output[ch]!=input[ch])
+            memcpy(output[ch], input[ch], nSamples*sizeof(float));
+        for(s=0; s<h->nStages; s++){
+            /* y[n] = -g*v[n] + v[n-d], where v[n] = x[n] + g*v[n-d] */
+            line = ch*h->nStages+s;
+            d = h->delay[line];
+            ring = &(h->ring[h->offset[line]]);
+            w = h->wIdx[line];
+            for(n=0; n<nSamples; n++){
+                vd = ring[w];
+                v = output[ch][n] + g*vd;
+                output[ch][n] = vd - g*v;
+                ring[w] = v;
+                if(++w==d)
+                    w = 0;
+            }
+            h->wIdx[line] = w;
+        }
+    }
+}
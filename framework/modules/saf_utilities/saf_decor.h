@@ -33,6 +33,7 @@ extern "C" {
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include "saf_complex.h"
 
 /**
  * Returns delay values for multiple channels per frequency, such that once
@@ -87,6 +88,174 @@ void synthesiseNoiseReverb(int nChannels,
                            float** rir_filt,
                            int* rir_len);
 
+/**
+ * Frequency-domain alternative to synthesiseNoiseReverb(), which is much
+ * faster for many channels and/or long T60 times
+ *
+ * Rather than generating noise per band and passing it through an FIR
+ * filterbank, the noise is synthesised directly in the STFT domain (complex
+ * Gaussian bins, sqrt-Hann overlap-add with 50% overlap), with each bin decayed
+ * according to the T60 interpolated (over log-frequency) between the octave
+ * band centre frequencies. All channels share one FFT size, and therefore one
+ * cached FFT plan; and the channels may be generated over several threads.
+ *
+ * @note The output is statistically similar to that of synthesiseNoiseReverb()
+ *       (same length and envelopes), but it is not sample-identical.
+ *
+ * @param[in]  nChannels   Number of channels
+ * @param[in]  fs          Sampling rate
+ * @param[in]  t60         T60 times (in seconds) per octave band; nBands x 1
+ * @param[in]  fcen_oct    Octave band centre frequencies; nBands x 1
+ * @param[in]  nBands      Number of octave bands
+ * @param[in]  flattenFLAG '0' nothing, '1' flattens the magnitude response to
+ *                         unity
+ * @param[in]  nThreads    Number of threads to use (1: single-threaded)
+ * @param[out] rir_filt    (&) the shaped noise bursts;
+ *                         FLAT: nChannels x rir_len
+ * @param[out] rir_len     (&) length of filters, in samples
+ */
+void synthesiseNoiseReverbFD(int nChannels,
+                             float fs,
+                             float* t60,
+                             float* fcen_oct,
+                             int nBands,
+                             int flattenFLAG,
+                             int nThreads,
+                             float** rir_filt,
+                             int* rir_len);
+
+
+/* ========================================================================== */
+/*                        Streaming Decorrelator Functions                    */
+/* ========================================================================== */
+
+/**
+ * Creates an instance of a multi-channel time-frequency domain decorrelator,
+ * which applies the frequency-dependent delays of getDecorrelationDelays() to
+ * signals in the time-frequency domain (e.g. the afSTFT domain)
+ *
+ * The delay lines of all bands and channels are preallocated, as one
+ * contiguous ring buffer; so no memory is allocated while processing.
+ *
+ * @param[in] phDecor    (&) address of decorrelatorTF handle
+ * @param[in] nChannels  Number of channels
+ * @param[in] freqs      Centre frequencies; nBands x 1
+ * @param[in] nBands     Number of frequency bands
+ * @param[in] fs         Sampling rate
+ * @param[in] maxTFdelay Max number of time-slots to delay
+ * @param[in] hopSize    STFT hop size
+ */
+void decorrelatorTF_create(/* Input arguments */
+                           void ** const phDecor,
+                           int nChannels,
+                           float* freqs,
+                           int nBands,
+                           float fs,
+                           int maxTFdelay,
+                           int hopSize);
+
+/**
+ * Destroys an instance of the time-frequency domain decorrelator
+ *
+ * @param[in] phDecor (&) address of decorrelatorTF handle
+ */
+void decorrelatorTF_destroy(/* Input arguments */
+                            void ** const phDecor);
+
+/**
+ * Sets all delay lines to 0s
+ *
+ * @param[in] hDecor decorrelatorTF handle
+ */
+void decorrelatorTF_reset(/* Input arguments */
+                          void * const hDecor);
+
+/**
+ * Returns the delays (in time-slots) used for each band and channel
+ *
+ * @param[in] hDecor decorrelatorTF handle
+ * @returns          delays; FLAT: nBands x nChannels
+ */
+const int* decorrelatorTF_getDelays(/* Input arguments */
+                                    void * const hDecor);
+
+/**
+ * Decorrelates the first 'nChannels' channels of a time-frequency frame
+ *
+ * @note 'inputTF' and 'outputTF' may be the same (in-place processing)
+ *
+ * @param[in]  hDecor     decorrelatorTF handle
+ * @param[in]  inputTF    Input frame; nBands x nChannels x nTimeSlots
+ * @param[in]  nChannels  Number of channels (at most the number given to
+ *                        decorrelatorTF_create())
+ * @param[in]  nTimeSlots Number of time-slots in the frame
+ * @param[out] outputTF   Decorrelated frame; nBands x nChannels x nTimeSlots
+ */
+void decorrelatorTF_apply(/* Input arguments */
+                          void * const hDecor,
+                          float_complex*** inputTF,
+                          int nChannels,
+                          int nTimeSlots,
+                          /* Output arguments */
+                          float_complex*** outputTF);
+
+/**
+ * Creates an instance of a multi-channel time-domain decorrelator, where each
+ * channel is passed through its own cascade of 'nStages' Schroeder all-pass
+ * filters (with randomised delays of between 1 and 8 ms)
+ *
+ * This is intended for use cases where the signals are not already in the
+ * time-frequency domain. As with decorrelatorTF_create(), all of the delay
+ * lines are held in one contiguous ring buffer.
+ *
+ * @param[in] phDecor   (&) address of decorrelatorTD handle
+ * @param[in] nChannels Number of channels
+ * @param[in] fs        Sampling rate
+ * @param[in] nStages   Number of all-pass stages per channel (e.g. 4)
+ */
+void decorrelatorTD_create(/* Input arguments */
+                           void ** const phDecor,
+                           int nChannels,
+                           float fs,
+                           int nStages);
+
+/**
+ * Destroys an instance of the time-domain decorrelator
+ *
+ * @param[in] phDecor (&) address of decorrelatorTD handle
+ */
+void decorrelatorTD_destroy(/* Input arguments */
+                            void ** const phDecor);
+
+/**
+ * Sets all delay lines to 0s
+ *
+ * @param[in] hDecor decorrelatorTD handle
+ */
+void decorrelatorTD_reset(/* Input arguments */
+                          void * const hDecor);
+
+/**
+ * Decorrelates the first 'nChannels' channels of a block of time-domain
+ * signals
+ *
+ * @note 'input' and 'output' may be the same (in-place processing)
+ *
+ * @param[in]  hDecor    decorrelatorTD handle
+ * @param[in]  input     Input signals; nChannels x nSamples
+ * @param[in]  nChannels Number of channels (at most the number given to
+ *                       decorrelatorTD_create())
+ * @param[in]  nSamples  Number of samples per channel
+ * @param[out] output    Decorrelated signals; nChannels x nSamples
+ */
+void decorrelatorTD_apply(/* Input arguments */
+                          void * const hDecor,
+                          float** input,
+                          int nChannels,
+                          int nSamples,
+                          /* Output arguments */
+                          float** output);
+
 
 #ifdef __cplusplus
 }/* extern "C" */
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_denormals.c
+ * @brief Scoped flushing of denormal (subnormal) numbers to zero
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_denormals.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# include <xmmintrin.h>
+# define SAF_DENORMALS_SSE
+# define SAF_DENORMALS_FLUSH_BITS ( 0x8040 )     /* FTZ (bit 15) | DAZ (bit 6) */
+#elif defined(_M_ARM64)
+# include <intrin.h>
+# define SAF_DENORMALS_MSVC_ARM64
+# define SAF_DENORMALS_FLUSH_BITS ( 1u << 24 )   /* FZ */
+#elif defined(__aarch64__)
+# define SAF_DENORMALS_AARCH64
+# define SAF_DENORMALS_FLUSH_BITS ( 1u << 24 )   /* FZ */
+#elif defined(__arm__) && defined(__ARM_FP)
+# define SAF_DENORMALS_ARM
+# define SAF_DENORMALS_FLUSH_BITS ( 1u << 24 )   /* FZ */
+#else
+# define SAF_DENORMALS_FLUSH_BITS ( 0 )
+#endif
+
+/** 1: the guard is enabled (shared by all threads) */
+static volatile int saf_denormals_guardEnabled = 1;
+
+/** Returns the floating-point control register of the calling thread */
+static unsigned int saf_denormals_getState(void)
+{
+#if defined(SAF_DENORMALS_SSE)
+    return (unsigned int)_mm_getcsr();
+#elif defined(SAF_DENORMALS_MSVC_ARM64)
+    return (unsigned int)_ReadStatusReg(ARM64_FPCR);
+#elif defined(SAF_DENORMALS_AARCH64)
+    unsigned long long fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return (unsigned int)fpcr;
+#elif defined(SAF_DENORMALS_ARM)
+    unsigned int fpscr;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+/** Sets the floating-point control register of the calling thread */
+static void saf_denormals_setState(unsigned int state)
+{
+#if defined(SAF_DENORMALS_SSE)
+    _mm_setcsr(state);
+#elif defined(SAF_DENORMALS_MSVC_ARM64)
+    _WriteStatusReg(ARM64_FPCR, (__int64)state);
+#elif defined(SAF_DENORMALS_AARCH64)
+    unsigned long long fpcr = (unsigned long long)state;
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#elif defined(SAF_DENORMALS_ARM)
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(state));
+#else
+    (void)state;
+#endif
+}
+
+void saf_denormals_setGuardEnabled
+(
+    int enabled
+)
+{
+    saf_denormals_guardEnabled = enabled ? 1 : 0;
+}
+
+int saf_denormals_getGuardEnabled(void)
+{
+    return saf_denormals_guardEnabled;
+}
+
+unsigned int saf_denormals_guardBegin(void)
+{
+    unsigned int state;
+
+    state = saf_denormals_getState();
+    /* (writing the register is comparatively slow, so only if needed) */
+    if(saf_denormals_guardEnabled && (state & SAF_DENORMALS_FLUSH_BITS) != SAF_DENORMALS_FLUSH_BITS)
+        saf_denormals_setState(state | SAF_DENORMALS_FLUSH_BITS);
+    return state;
+}
+
+void saf_denormals_guardEnd
+(
+    unsigned int prevState
+)
+{
+    if(saf_denormals_getState() != prevState)
+        saf_denormals_setState(prevState);
+}
+
+int saf_denormals_areFlushed(void)
+{
+#if SAF_DENORMALS_FLUSH_BITS
+    return (saf_denormals_getState() & SAF_DENORMALS_FLUSH_BITS) == SAF_DENORMALS_FLUSH_BITS ? 1 : 0;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_denormals.h
+ * @brief Scoped flushing of denormal (subnormal) numbers to zero
+ *
+ * Recursive filters, envelope followers, averaged covariance matrices and the
+ * tails of the filterbanks all decay towards zero once the input falls silent;
+ * and arithmetic involving denormal numbers is many times slower on most CPUs.
+ * Therefore, the processing functions of the SAF examples wrap their body
+ * with saf_denormals_guardBegin() and saf_denormals_guardEnd(), which set the
+ * flush-to-zero (and denormals-are-zero) modes of the calling thread for the
+ * duration of the call, and then restore the previous modes of the host. These
+ * modes are per-thread; so the worker threads of the framework (saf_parfor,
+ * the multi-threaded afSTFT, and the matrixConv tail and binauraliser mixing
+ * threads) also wrap each job they run with the guard.
+ *
+ * The modes are set via: the MXCSR register (FTZ and DAZ) on x86 with SSE, and
+ * the FZ bit of the FPCR (AArch64) or FPSCR (32-bit ARM with VFP/NEON) on ARM.
+ * On other platforms, the guard does nothing.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_DENORMALS_H_INCLUDED
+#define SAF_DENORMALS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Enables/disables the guard for all threads (default: enabled); e.g. if the
+ * host already takes care of denormals, or bit-exact results are required
+ *
+ * @param[in] enabled '1' to enable, '0' to disable
+ */
+void saf_denormals_setGuardEnabled(/* Input Arguments */
+                                   int enabled);
+
+/** Returns 1 if the guard is enabled, 0 if not */
+int saf_denormals_getGuardEnabled(void);
+
+/**
+ * Enables flushing denormals to zero on the calling thread (unless the guard
+ * has been disabled), returning the previous floating-point modes
+ *
+ * @returns The previous modes, to be passed to saf_denormals_guardEnd()
+ */
+unsigned int saf_denormals_guardBegin(void);
+
+/**
+ * Restores the floating-point modes of the calling thread, as they were before
+ * the paired call to saf_denormals_guardBegin()
+ *
+ * @param[in] prevState Value returned by saf_denormals_guardBegin()
+ */
+void saf_denormals_guardEnd(/* Input Arguments */
+                            unsigned int prevState);
+
+/**
+ * Returns 1 if denormals are currently flushed to zero on the calling thread,
+ * 0 if not (or if this is not supported on the platform)
+ */
+int saf_denormals_areFlushed(void);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_DENORMALS_H_INCLUDED */
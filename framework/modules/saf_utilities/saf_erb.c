@@ -75,3 +75,84 @@ void findERBpartitions
     (*erb_freqs)[counter+1] = centerFreq[nBands-1];
     (*nERBBands) = counter+2;
 }
+
+void sumBandsOverGroups
+(
+    const float* bandData,
+    int nBands,
+    int blockLen,
+    const int* grp_idx,
+    int nGrps,
+    int normalise,
+    float* grpData
+)
+{
+    int g, band, band_start, band_end;
+    float scale;
+
+    for(g=0; g<nGrps; g++){
+        band_start = grp_idx[g]-1; /* -1 as the indices start from 1 */
+        band_end = MIN(grp_idx[g+1]-1, nBands);
+        if(band_end<=band_start){
+            memset(&grpData[g*blockLen], 0, blockLen*sizeof(float));
+            continue;
+        }
+        cblas_scopy(blockLen, &bandData[band_start*blockLen], 1, &grpData[g*blockLen], 1);
+        for(band=band_start+1; band<band_end; band++)
+            cblas_saxpy(blockLen, 1.0f, &bandData[band*blockLen], 1, &grpData[g*blockLen], 1);
+        if(normalise && band_end-band_start>1){
+            scale = 1.0f/(float)(band_end-band_start);
+            cblas_sscal(blockLen, scale, &grpData[g*blockLen], 1);
+        }
+    }
+}
+
+void getGroupInterpWeights
+(
+    const int* grp_idx,
+    int nGrps,
+    int nBands,
+    int* interpGrpIdx,
+    float* interpW
+)
+{
+    int band, grp;
+    float centre, next_centre;
+
+    /* (the centres are in band indices starting from 0, hence the -3) */
+    for(band=0, grp=0; band<nBands; band++){
+        while(grp < nGrps-1 && (float)band >= 0.5f*(float)(grp_idx[grp+1] + grp_idx[grp+2] - 3))
+            grp++;
+        centre = 0.5f*(float)(grp_idx[grp] + grp_idx[grp+1] - 3);
+        next_centre = grp < nGrps-1 ? 0.5f*(float)(grp_idx[grp+1] + grp_idx[grp+2] - 3) : centre;
+        interpGrpIdx[band] = grp;
+        interpW[band] = next_centre > centre && (float)band > centre ? ((float)band-centre)/(next_centre-centre) : 0.0f;
+    }
+}
+
+void interpGroupsToBands
+(
+    const float* grpData,
+    int nGrps,
+    int blockLen,
+    const int* interpGrpIdx,
+    const float* interpW,
+    int nBands,
+    float* bandData
+)
+{
+    int band, g0, g1;
+    float w0;
+
+    for(band=0; band<nBands; band++){
+        g0 = interpGrpIdx[band];
+        g1 = MIN(g0+1, nGrps-1);
+        if(interpW[band]==0.0f || g1==g0)
+            cblas_scopy(blockLen, &grpData[g0*blockLen], 1, &bandData[band*blockLen], 1);
+        else{
+            w0 = 1.0f-interpW[band];
+            utility_svsmul((float*)&grpData[g0*blockLen], &w0, blockLen, &bandData[band*blockLen]);
+            cblas_saxpy(blockLen, interpW[band], &grpData[g1*blockLen], 1, &bandData[band*blockLen], 1);
+        }
+    }
+}
@@ -17,7 +17,14 @@
 /**
  * @file saf_erb.h
  * @brief A function to ascertain frequencies that fall within critical bands.
- *        [Equivalent-Rectangular Bandwidth (ERB)]
+ *        [Equivalent-Rectangular Bandwidth (ERB)]; and helpers for estimating
+ *        parameters over such groups of bands, rather than per band
+ *
+ * The group indices follow the convention of findERBpartitions(): i.e. they
+ * start from 1, and group 'g' comprises bands grp_idx[g]-1 .. grp_idx[g+1]-2.
+ * Therefore, 'nGrps' groups are described by nGrps+1 indices (where the last
+ * index may be set to nBands+1, in order to also include the last band in the
+ * last group).
  *
  * @author Leo McCormack
  * @date 30.07.2018  
@@ -62,6 +69,80 @@ void findERBpartitions(/* Input Arguments */
                        float** erb_freqs,
                        int* nERBBands);  
 
+/**
+ * Sums (or averages) a block of data per band over the bands of each group
+ *
+ * This may be used to, for example, aggregate per-band covariance matrices
+ * (passing float_complex data as interleaved floats, with
+ * blockLen = 2*nCH*nCH) or band energies into groups; so that the parameters
+ * are then estimated only once per group.
+ *
+ * @param[in]  bandData  Data per band; FLAT: nBands x blockLen
+ * @param[in]  nBands    Number of bands
+ * @param[in]  blockLen  Number of floats per band
+ * @param[in]  grp_idx   Group indices (start from 1); (nGrps+1) x 1
+ * @param[in]  nGrps     Number of groups
+ * @param[in]  normalise 0: sum over the bands, 1: average over the bands
+ * @param[out] grpData   Data per group; FLAT: nGrps x blockLen
+ */
+void sumBandsOverGroups(/* Input Arguments */
+                        const float* bandData,
+                        int nBands,
+                        int blockLen,
+                        const int* grp_idx,
+                        int nGrps,
+                        int normalise,
+                        /* Output Arguments */
+                        float* grpData);
+
+/**
+ * Computes, for each band, the weights with which the parameters of the two
+ * nearest groups are interpolated to that band
+ *
+ * The parameters are interpolated linearly (over the band indices) between the
+ * centres of two neighbouring groups, and held constant below the centre of the
+ * first group, and above that of the last group. i.e.:
+ * \code{.m}
+ *     bandParam(band) = (1-w(band))*grpParam(g(band)) + w(band)*grpParam(g(band)+1)
+ * \endcode
+ *
+ * @param[in]  grp_idx      Group indices (start from 1); (nGrps+1) x 1
+ * @param[in]  nGrps        Number of groups
+ * @param[in]  nBands       Number of bands
+ * @param[out] interpGrpIdx Group below each band (starts from 0); nBands x 1
+ * @param[out] interpW      Weight of the group above (interpGrpIdx+1);
+ *                          nBands x 1
+ */
+void getGroupInterpWeights(/* Input Arguments */
+                           const int* grp_idx,
+                           int nGrps,
+                           int nBands,
+                           /* Output Arguments */
+                           int* interpGrpIdx,
+                           float* interpW);
+
+/**
+ * Expands a block of data per group back to the bands, via the weights
+ * returned by getGroupInterpWeights()
+ *
+ * @param[in]  grpData      Data per group; FLAT: nGrps x blockLen
+ * @param[in]  nGrps        Number of groups
+ * @param[in]  blockLen     Number of floats per group/band
+ * @param[in]  interpGrpIdx Group below each band (starts from 0); nBands x 1
+ * @param[in]  interpW      Weight of the group above; nBands x 1
+ * @param[in]  nBands       Number of bands
+ * @param[out] bandData     Data per band; FLAT: nBands x blockLen
+ */
+void interpGroupsToBands(/* Input Arguments */
+                         const float* grpData,
+                         int nGrps,
+                         int blockLen,
+                         const int* interpGrpIdx,
+                         const float* interpW,
+                         int nBands,
+                         /* Output Arguments */
+                         float* bandData);
+
 
 #ifdef __cplusplus
 }/* extern "C" */
@@ -46,6 +46,11 @@ SAF_ERRORS saf_error_print(SAF_ERRORS err)
             fprintf(stderr, "%s", "SAF Error: Failed to build Convex Hull.\n");
             break;
             
+        /* saf_hrir errors */
+        case SAF_ERROR__DEFAULT_HRIRS_NOT_FOUND:
+            fprintf(stderr, "%s", "SAF Error: Could not open SOFA file, or the default HRIR file.\n");
+            break;
+            
         /* saf_hrir warnings */
         case SAF_WARNING__SOFA_FILE_NOT_FOUND:
             fprintf(stdout, "%s", "SAF Warning: Could not open SOFA file. Loading default HRIR data. \n");
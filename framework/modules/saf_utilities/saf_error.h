@@ -58,6 +58,12 @@ typedef enum _SAF_ERRORS {
      * findLsTriplets - Failed to build Convex Hull.
      */
     SAF_ERROR__FAILED_TO_BUILD_CONVEX_HULL,
+    /**
+     * loadSofaFile(): the SOFA file was not found, and neither was the file
+     * holding the default HRIRs (which are not compiled in, since
+     * SAF_DEFAULT_HRIRS_EXTERNAL is defined). No HRIRs are returned.
+     */
+    SAF_ERROR__DEFAULT_HRIRS_NOT_FOUND,
     
     /* ---------------------------------------------------------------------- */
     /**
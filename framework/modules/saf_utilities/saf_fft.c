@@ -50,6 +50,50 @@
 
 #include "saf_utilities.h"
 #include "saf_fft.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+/** Plan types stored in the FFT plan cache */
+typedef enum _SAF_FFT_PLAN_TYPES{
+    SAF_FFT_PLAN_REAL = 1,   /**< real<->half-complex transform */
+    SAF_FFT_PLAN_COMPLEX     /**< complex<->complex transform */
+    
+}SAF_FFT_PLAN_TYPES;
+
+/**
+ * Data structure for a cached (immutable) FFT plan.
+ *
+ * Plans are shared by all saf_rfft/saf_fft instances of the same size and type,
+ * and are kept in a process-wide cache. Anything that is written to during the
+ * transforms (i.e. scratch memory) is instead held by the instances.
+ */
+typedef struct _saf_fft_plan {
+    int N;
+    SAF_FFT_PLAN_TYPES type;
+    int howMany;            /**< number of transforms (>1 for batched plans) */
+    int realDist;           /**< distance between real vectors (batched) */
+    int cplxDist;           /**< distance between complex vectors (batched) */
+    int refCount;           /**< number of instances currently using the plan */
+    int useKissFFT_flag;
+#if defined(__ACCELERATE__)
+    int log2n;
+    FFTSetup FFT;           /**< radix-2 setup (real plans with N=2^x) */
+    int useDFT_flag;        /**< 1: vDSP_DFT routines are used instead */
+    vDSP_DFT_Setup DFT_fwd; /**< vDSP_DFT_zrop (real) or vDSP_DFT_zop (complex) */
+    vDSP_DFT_Setup DFT_bkw;
+#elif defined(INTEL_MKL_VERSION)
+    DFTI_DESCRIPTOR_HANDLE MKL_FFT_Handle;
+    DFTI_DESCRIPTOR_HANDLE MKL_FFT_Handle_bkw; /**< batched plans only */
+    MKL_LONG input_strides[2], output_strides[2];
+#endif
+    void* kissFFThandle_fwd; /**< kiss_fftr_cfg (template) or kiss_fft_cfg */
+    void* kissFFThandle_bkw; /**< kiss_fftr_cfg (template) or kiss_fft_cfg */
+    struct _saf_fft_plan* next;
+    
+}saf_fft_plan;
 
 /**
  * Data structure for real-(half)complex FFT transforms.
@@ -57,17 +101,19 @@
 typedef struct _saf_rfft_data {
     int N;
     float  Scale;
+    saf_fft_plan* plan;
+    saf_fft_plan* batchPlan; /**< most recently used batched plan (MKL only) */
 #if defined(__ACCELERATE__)
-    int log2n;
-    FFTSetup FFT;
     DSPSplitComplex VDSP_split;
+    DSPSplitComplex VDSP_splitOut; /**< output of the vDSP_DFT routines */
 #elif defined(INTEL_MKL_VERSION)
-    DFTI_DESCRIPTOR_HANDLE MKL_FFT_Handle;
-    MKL_LONG input_strides[2], output_strides[2], Status;
+    MKL_LONG Status;
 #endif
     int useKissFFT_flag;
-    kiss_fftr_cfg kissFFThandle_fwd;
+    kiss_fftr_cfg kissFFThandle_fwd; /* per-instance copies (own scratch) */
     kiss_fftr_cfg kissFFThandle_bkw;
+    float* zpBuf;            /**< scratch for zero-padded/in-place transforms; N x 1 */
+    int zpLen;               /**< zpBuf is all zeros from this sample onwards */
     
 }saf_rfft_data;
 
@@ -77,20 +123,292 @@ typedef struct _saf_rfft_data {
 typedef struct _saf_fft_data {
     int N;
     float  Scale;
+    saf_fft_plan* plan;
 #if defined(__ACCELERATE__)
-    int log2n;
-    FFTSetup FFT;
     DSPSplitComplex VDSP_split;
+    DSPSplitComplex VDSP_splitOut; /**< output of the vDSP_DFT routines */
 #elif defined(INTEL_MKL_VERSION)
-    DFTI_DESCRIPTOR_HANDLE MKL_FFT_Handle;
     MKL_LONG Status;
 #endif
     int useKissFFT_flag;
-    kiss_fft_cfg kissFFThandle_fwd;
+    kiss_fft_cfg kissFFThandle_fwd; /* shared with the plan (stateless) */
     kiss_fft_cfg kissFFThandle_bkw;
     
 }saf_fft_data;
 
+
+/* ========================================================================== */
+/*                               FFT Plan Cache                               */
+/* ========================================================================== */
+
+/** Head of the linked-list of cached plans */
+static saf_fft_plan* planCache = NULL;
+/** Lock for the plan cache */
+#if defined(_WIN32)
+static SRWLOCK planCacheLock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t planCacheLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void lockPlanCache(void)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&planCacheLock);
+#else
+    pthread_mutex_lock(&planCacheLock);
+#endif
+}
+
+static void unlockPlanCache(void)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&planCacheLock);
+#else
+    pthread_mutex_unlock(&planCacheLock);
+#endif
+}
+
+#if defined(__ACCELERATE__)
+/**
+ * Returns 1 if the vDSP_DFT routines support a transform length of N; i.e.
+ * N = f*2^n, where f is 1, 3, 5 or 15, and n >= minLog2n
+ */
+static int vdspDFTsupportsLength
+(
+    int N,
+    int minLog2n
+)
+{
+    int n;
+    for(n=0; N>1 && N%2==0; n++)
+        N /= 2;
+    return (N==1 || N==3 || N==5 || N==15) && n>=minLog2n;
+}
+#endif
+
+/**
+ * Creates a new plan (the cache must be locked). For batched plans (howMany>1)
+ * the real/complex vectors are spaced realDist/cplxDist elements apart.
+ */
+static saf_fft_plan* createPlan
+(
+    int N,
+    SAF_FFT_PLAN_TYPES type,
+    int howMany,
+    int realDist,
+    int cplxDist
+)
+{
+    saf_fft_plan* p;
+#if defined(INTEL_MKL_VERSION)
+    MKL_LONG Status;
+#endif
+    
+    p = malloc1d(sizeof(saf_fft_plan));
+    p->N = N;
+    p->type = type;
+    p->howMany = howMany;
+    p->realDist = howMany > 1 ? realDist : 0;
+    p->cplxDist = howMany > 1 ? cplxDist : 0;
+    p->refCount = 0;
+    p->kissFFThandle_fwd = p->kissFFThandle_bkw = NULL;
+#if defined(__ACCELERATE__)
+    p->FFT = NULL;
+    p->useDFT_flag = 0;
+    p->DFT_fwd = p->DFT_bkw = NULL;
+    p->useKissFFT_flag = 1;
+    if(type==SAF_FFT_PLAN_REAL && ceilf(log2f(N)) == floorf(log2f(N))){ /* true if N is 2 to the power of some integer number */
+        p->useKissFFT_flag = 0;
+        p->log2n = (int)(log2f((float)N)+0.1f);
+        p->FFT = (void*)vDSP_create_fftsetup(p->log2n, FFT_RADIX2);
+    }
+    else if(vdspDFTsupportsLength(N, type==SAF_FFT_PLAN_REAL ? 4 : 3)){
+        /* Mixed-radix lengths (e.g. 480, 960, 1920), and all complex
+         * transforms, use the vDSP_DFT routines. The real ones (zrop) have the
+         * same packing and 2x scaling as vDSP_fft_zrip(); the backward setup
+         * shares the tables of the forward one */
+        if(type==SAF_FFT_PLAN_REAL){
+            p->DFT_fwd = vDSP_DFT_zrop_CreateSetup(NULL, (vDSP_Length)N, vDSP_DFT_FORWARD);
+            p->DFT_bkw = vDSP_DFT_zrop_CreateSetup(p->DFT_fwd, (vDSP_Length)N, vDSP_DFT_INVERSE);
+        }
+        else{
+            p->DFT_fwd = vDSP_DFT_zop_CreateSetup(NULL, (vDSP_Length)N, vDSP_DFT_FORWARD);
+            p->DFT_bkw = vDSP_DFT_zop_CreateSetup(p->DFT_fwd, (vDSP_Length)N, vDSP_DFT_INVERSE);
+        }
+        if(p->DFT_fwd!=NULL && p->DFT_bkw!=NULL){
+            p->useDFT_flag = 1;
+            p->useKissFFT_flag = 0;
+        }
+        else{
+            /* (sizes that vDSP unexpectedly rejects fall back to KissFFT) */
+            if(p->DFT_bkw!=NULL)
+                vDSP_DFT_DestroySetup(p->DFT_bkw);
+            if(p->DFT_fwd!=NULL)
+                vDSP_DFT_DestroySetup(p->DFT_fwd);
+            p->DFT_fwd = p->DFT_bkw = NULL;
+        }
+    }
+#elif defined(INTEL_MKL_VERSION)
+    p->useKissFFT_flag = 0;
+    p->MKL_FFT_Handle = 0;
+    p->MKL_FFT_Handle_bkw = 0;
+    if(type==SAF_FFT_PLAN_REAL && howMany > 1){
+        /* Batched plans require separate descriptors for the forward and
+         * backward transforms, since the input/output distances swap roles */
+        Status = DftiCreateDescriptor(&(p->MKL_FFT_Handle), DFTI_SINGLE, DFTI_REAL, 1, N);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_NUMBER_OF_TRANSFORMS, howMany);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_INPUT_DISTANCE, realDist);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_OUTPUT_DISTANCE, cplxDist);
+        Status = DftiCommitDescriptor(p->MKL_FFT_Handle);
+        Status = DftiCreateDescriptor(&(p->MKL_FFT_Handle_bkw), DFTI_SINGLE, DFTI_REAL, 1, N);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_PLACEMENT, DFTI_NOT_INPLACE);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_NUMBER_OF_TRANSFORMS, howMany);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_INPUT_DISTANCE, cplxDist);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_OUTPUT_DISTANCE, realDist);
+        Status = DftiSetValue(p->MKL_FFT_Handle_bkw, DFTI_BACKWARD_SCALE, 1.0f/(float)N);
+        Status = DftiCommitDescriptor(p->MKL_FFT_Handle_bkw);
+    }
+    else if(type==SAF_FFT_PLAN_REAL){
+        Status = DftiCreateDescriptor(&(p->MKL_FFT_Handle), DFTI_SINGLE, DFTI_REAL, 1, N); /* 1-D, single precision, real_input->fft->half_complex->ifft->real_output */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE); /* Not inplace, i.e. output has its own dedicated memory */
+        /* specify output format as complex conjugate-symmetric data. This is the same as MatLab, except only the
+         * first N/2+1 elements are returned. The inverse transform will automatically symmetrically+conjugate
+         * replicate these elements, in order to get the required N elements internally. */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX);
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_INPUT_DISTANCE, 1);  /* strides between samples (default=1) */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_OUTPUT_DISTANCE, 1); /* strides between samples (default=1) */
+        p->input_strides[0]  = 0; p->input_strides[1]  = 1; /* hard coded here for 1 channel */
+        p->output_strides[0] = 0; p->output_strides[1] = 1; /* hard coded here for 1 channel */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_INPUT_STRIDES, p->input_strides);   /* strides between channels (default=[0,1]) */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_OUTPUT_STRIDES, p->output_strides); /* strides between channels (default=[0,1]) */
+    }
+    else{
+        Status = DftiCreateDescriptor( &(p->MKL_FFT_Handle), DFTI_SINGLE,
+                                      DFTI_COMPLEX, 1, N); /* 1-D, single precision, complex_input_td->fft->complex_input_fd->ifft->complex_output_td */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE); /* Not inplace, i.e. output has its own dedicated memory */
+    }
+    if(howMany == 1){
+        /* Configuration parameters for backward-FFT */
+        Status = DftiSetValue(p->MKL_FFT_Handle, DFTI_BACKWARD_SCALE, 1.0f/(float)N); /* scalar applied after ifft */
+        /* commit these chosen parameters */
+        Status = DftiCommitDescriptor(p->MKL_FFT_Handle);
+    }
+    (void)Status;
+#else
+    p->useKissFFT_flag = 1;
+#endif
+    if(p->useKissFFT_flag){
+        if(type==SAF_FFT_PLAN_REAL){
+            p->kissFFThandle_fwd = (void*)kiss_fftr_alloc(N, 0, NULL, NULL);
+            p->kissFFThandle_bkw = (void*)kiss_fftr_alloc(N, 1, NULL, NULL);
+        }
+        else{
+            p->kissFFThandle_fwd = (void*)kiss_fft_alloc(N, 0, NULL, NULL);
+            p->kissFFThandle_bkw = (void*)kiss_fft_alloc(N, 1, NULL, NULL);
+        }
+    }
+    return p;
+}
+
+/** Destroys a plan (the cache must be locked) */
+static void destroyPlan
+(
+    saf_fft_plan* p
+)
+{
+#if defined(__ACCELERATE__)
+    if(p->FFT!=NULL)
+        vDSP_destroy_fftsetup(p->FFT);
+    if(p->useDFT_flag){
+        vDSP_DFT_DestroySetup(p->DFT_bkw);
+        vDSP_DFT_DestroySetup(p->DFT_fwd);
+    }
+#elif defined(INTEL_MKL_VERSION)
+    DftiFreeDescriptor(&(p->MKL_FFT_Handle));
+    if(p->MKL_FFT_Handle_bkw != 0)
+        DftiFreeDescriptor(&(p->MKL_FFT_Handle_bkw));
+#endif
+    if(p->useKissFFT_flag){
+        KISS_FFT_FREE(p->kissFFThandle_fwd);
+        KISS_FFT_FREE(p->kissFFThandle_bkw);
+    }
+    free(p);
+}
+
+/** Returns a (new or cached) plan for the given size, type and batch layout */
+static saf_fft_plan* acquirePlan
+(
+    int N,
+    SAF_FFT_PLAN_TYPES type,
+    int howMany,
+    int realDist,
+    int cplxDist
+)
+{
+    saf_fft_plan* p;
+    
+    if(howMany == 1)
+        realDist = cplxDist = 0;
+    lockPlanCache();
+    for(p = planCache; p != NULL; p = p->next)
+        if(p->N == N && p->type == type && p->howMany == howMany &&
+           p->realDist == realDist && p->cplxDist == cplxDist)
+            break;
+    if(p == NULL){
+        p = createPlan(N, type, howMany, realDist, cplxDist);
+        p->next = planCache;
+        planCache = p;
+    }
+    p->refCount++;
+    unlockPlanCache();
+    return p;
+}
+
+/** Signals that an instance no longer uses the plan */
+static void releasePlan
+(
+    saf_fft_plan* p
+)
+{
+    lockPlanCache();
+    p->refCount--;
+    assert(p->refCount>=0);
+    unlockPlanCache();
+}
+
+void saf_fft_clearPlanCache(void)
+{
+    saf_fft_plan** pp, *p;
+    
+    lockPlanCache();
+    pp = &planCache;
+    while(*pp != NULL){
+        p = *pp;
+        if(p->refCount == 0){
+            *pp = p->next;
+            destroyPlan(p);
+        }
+        else
+            pp = &(p->next);
+    }
+    unlockPlanCache();
+}
+
+int saf_fft_getNumCachedPlans(void)
+{
+    saf_fft_plan* p;
+    int n;
+    
+    lockPlanCache();
+    for(n=0, p = planCache; p != NULL; p = p->next)
+        n++;
+    unlockPlanCache();
+    return n;
+}
+
 /**
  * A simple function which returns the next power of 2, taken from:
  * https://github.com/amaggi/legacy-code
@@ -132,46 +450,36 @@ void fftconv
 )
 {
     int i, y_len, fftSize, nBins;
-    float* h0, *x0, *y0;
-    float_complex* H, *X, *Y;
+    float_complex* H, *X;
     void* hfft;
     
     /* prep */
     y_len = x_len + h_len - 1;
     fftSize =  (int)((float)nextpow2(y_len)+0.5f);
     nBins = fftSize/2+1;
-    h0 = calloc1d(fftSize, sizeof(float));
-    x0 = calloc1d(fftSize, sizeof(float));
-    y0 = malloc1d(fftSize * sizeof(float));
-    H = malloc1d(nBins*sizeof(float_complex));
-    X = malloc1d(nBins*sizeof(float_complex));
-    Y = malloc1d(nBins*sizeof(float_complex));
+    H = malloc1d(nCH*nBins*sizeof(float_complex));
+    X = malloc1d(nCH*nBins*sizeof(float_complex));
     saf_rfft_create(&hfft, fftSize);
     
-    /* apply convolution per channel */
+    /* fft with implicit zero padding (to avoid circular convolution artefacts) */
     for(i=0; i<nCH; i++){
-        /* zero pad to avoid circular convolution artefacts, prior to fft */
-        memcpy(h0, &h[i*h_len], h_len*sizeof(float));
-        memcpy(x0, &x[i*x_len], x_len*sizeof(float));
-        saf_rfft_forward(hfft, x0, X);
-        saf_rfft_forward(hfft, h0, H);
-        
-        /* multiply the two spectra */
-        utility_cvvmul(X, H, nBins, Y);
-        
-        /* ifft, truncate and store to output */
-        saf_rfft_backward(hfft, Y, y0);
-        memcpy(&y[i*y_len], y0, y_len*sizeof(float));
+        saf_rfft_forward_zp(hfft, &x[i*x_len], x_len, &X[i*nBins]);
+        saf_rfft_forward_zp(hfft, &h[i*h_len], h_len, &H[i*nBins]);
+    }
+    
+    /* multiply the two spectra */
+    utility_cvvmul(X, H, nCH*nBins, NULL);
+    
+    /* in-place ifft, truncate and store to output */
+    for(i=0; i<nCH; i++){
+        saf_rfft_backward_inplace(hfft, (float*)&X[i*nBins]);
+        memcpy(&y[i*y_len], (float*)&X[i*nBins], y_len*sizeof(float));
     }
     
     /* tidy up */
     saf_rfft_destroy(&hfft);
-    free(h0);
-    free(x0);
-    free(y0);
     free(H);
     free(X);
-    free(Y);
 }
 
 void fftfilt
@@ -194,26 +502,80 @@ void fftfilt
     free(y_tmp);
 }
 
+void fftxcorr
+(
+    float* a,
+    float* b,
+    int la,
+    int lb,
+    int nCH,
+    float* x_ab
+)
+{
+    int i, k, lag, x_len, fftSize, nBins;
+    float* a0, *b0, *r0;
+    float_complex* A, *B;
+    void* hfft;
+    
+    /* prep */
+    x_len = la + lb - 1;
+    fftSize =  (int)((float)nextpow2(x_len)+0.5f);
+    nBins = fftSize/2+1;
+    a0 = calloc1d(nCH*fftSize, sizeof(float));
+    b0 = calloc1d(nCH*fftSize, sizeof(float));
+    r0 = malloc1d(nCH*fftSize*sizeof(float));
+    A = malloc1d(nCH*nBins*sizeof(float_complex));
+    B = malloc1d(nCH*nBins*sizeof(float_complex));
+    saf_rfft_create(&hfft, fftSize);
+    
+    /* zero pad to avoid circular correlation artefacts, prior to fft */
+    for(i=0; i<nCH; i++){
+        memcpy(&a0[i*fftSize], &a[i*la], la*sizeof(float));
+        memcpy(&b0[i*fftSize], &b[i*lb], lb*sizeof(float));
+    }
+    saf_rfft_forward_batch(hfft, a0, fftSize, nCH, A, nBins);
+    saf_rfft_forward_batch(hfft, b0, fftSize, nCH, B, nBins);
+    
+    /* cross-spectra: A.*conj(B) */
+    for(k=0; k<nCH*nBins; k++)
+        A[k] = ccmulf(A[k], conjf(B[k]));
+    
+    /* ifft, and reorder the (circular) lags -(lb-1)..(la-1) into the output */
+    saf_rfft_backward_batch(hfft, A, nBins, nCH, r0, fftSize);
+    for(i=0; i<nCH; i++){
+        for(k=0; k<x_len; k++){
+            lag = k-lb+1;
+            x_ab[i*x_len+k] = r0[i*fftSize + (lag<0 ? lag+fftSize : lag)];
+        }
+    }
+    
+    /* tidy up */
+    saf_rfft_destroy(&hfft);
+    free(a0);
+    free(b0);
+    free(r0);
+    free(A);
+    free(B);
+}
+
 void hilbert
 (
     float_complex* x,
     int x_len,
     float_complex* y
 )
+{
+    hilbertBatch(x, x_len, 1, y);
+}
+
+void hilbertWeights
+(
+    int x_len,
+    float_complex* h
+)
 {
     int i;
-    float_complex *xfft, *h, *xhfft; 
-    void* hfft;
     
-    saf_fft_create(&hfft, x_len);
-    xfft = malloc1d(x_len*sizeof(float_complex));
-    h = malloc1d(x_len*sizeof(float_complex));
-    xhfft = malloc1d(x_len*sizeof(float_complex));
-    
-    /* Forward fft */
-    saf_fft_forward(hfft, x, xfft);
-    
-    /* define vector h */
     memset(h, 0, sizeof(float_complex)*x_len);
     if(x_len % 2 == 0){
         /* even */
@@ -223,16 +585,40 @@ void hilbert
             h[i] = cmplxf(2.0f, 0.0f);
     }
     else{
-        assert(0); // uneven lengths not actually supported by saf_fft
-        /* odd */
+        /* odd (the complex FFT supports any length) */
         h[0] = cmplxf(1.0f, 0.0f);
         for(i=1;i<(x_len+1)/2;i++)
             h[i] = cmplxf(2.0f, 0.0f);
     }
+}
+
+void hilbertBatch
+(
+    float_complex* x,
+    int x_len,
+    int nCH,
+    float_complex* y
+)
+{
+    int ch;
+    float_complex *xfft, *h, *xhfft; 
+    void* hfft;
     
-    /* apply h, and ifft */
-    utility_cvvmul(xfft, h, x_len, xhfft);
-    saf_fft_backward(hfft, xhfft, y);
+    /* the FFT, weights and scratch are shared by all of the signals */
+    saf_fft_create(&hfft, x_len);
+    xfft = malloc1d(x_len*sizeof(float_complex));
+    h = malloc1d(x_len*sizeof(float_complex));
+    xhfft = malloc1d(x_len*sizeof(float_complex));
+    hilbertWeights(x_len, h);
+    
+    for(ch=0; ch<nCH; ch++){
+        /* Forward fft */
+        saf_fft_forward(hfft, &x[ch*x_len], xfft);
+        
+        /* apply h, and ifft */
+        utility_cvvmul(xfft, h, x_len, xhfft);
+        saf_fft_backward(hfft, xhfft, &y[ch*x_len]);
+    }
     
     /* tidy up */
     saf_fft_destroy(&hfft); 
@@ -253,46 +639,26 @@ void saf_rfft_create
     h->N = N;
     h->Scale = 1.0f/(float)N; /* output scaling after ifft */
     assert(N>=2); /* only even (non zero) FFT sizes allowed */
+    h->plan = acquirePlan(N, SAF_FFT_PLAN_REAL, 1, 0, 0);
+    h->batchPlan = NULL;
+    h->useKissFFT_flag = h->plan->useKissFFT_flag;
+    h->zpBuf = calloc1d(N, sizeof(float));
+    h->zpLen = 0;
 #if defined(__ACCELERATE__)
-    if(ceilf(log2f(N)) == floorf(log2f(N))) /* true if N is 2 to the power of some integer number */
-        h->useKissFFT_flag = 0;
-    else
-        h->useKissFFT_flag = 1;
-    /* Apple Accelerate only supports 2^x FFT sizes */
+    h->VDSP_splitOut.realp = h->VDSP_splitOut.imagp = NULL;
     if(!h->useKissFFT_flag){
-        h->log2n = (int)(log2f((float)N)+0.1f);
-        h->FFT = (void*)vDSP_create_fftsetup(h->log2n, FFT_RADIX2);
         h->VDSP_split.realp = malloc1d((h->N/2)*sizeof(float));
         h->VDSP_split.imagp = malloc1d((h->N/2)*sizeof(float));
     }
-#elif defined(INTEL_MKL_VERSION)
-    h->useKissFFT_flag = 0;
-    h->MKL_FFT_Handle = 0;
-    h->Status = DftiCreateDescriptor(&(h->MKL_FFT_Handle), DFTI_SINGLE, DFTI_REAL, 1, h->N); /* 1-D, single precision, real_input->fft->half_complex->ifft->real_output */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE); /* Not inplace, i.e. output has its own dedicated memory */
-    /* specify output format as complex conjugate-symmetric data. This is the same as MatLab, except only the
-     * first N/2+1 elements are returned. The inverse transform will automatically symmetrically+conjugate
-     * replicate these elements, in order to get the required N elements internally. */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX);
-    const int number_of_channels = 1; /* hard coded here for 1 channel */
-    if(number_of_channels > 1) /* only required for multiple channels */
-        h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_NUMBER_OF_TRANSFORMS, number_of_channels);
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_INPUT_DISTANCE, 1);  /* strides between samples (default=1) */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_OUTPUT_DISTANCE, 1); /* strides between samples (default=1) */
-    h->input_strides[0]  = 0; h->input_strides[1]  = 1; /* hard coded here for 1 channel */
-    h->output_strides[0] = 0; h->output_strides[1] = 1; /* hard coded here for 1 channel */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_INPUT_STRIDES, h->input_strides);   /* strides between channels (default=[0,1]) */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_OUTPUT_STRIDES, h->output_strides); /* strides between channels (default=[0,1]) */
-    /* Configuration parameters for backward-FFT */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_BACKWARD_SCALE, h->Scale);      /* scalar applied after ifft */
-    /* commit these chosen parameters */
-    h->Status = DftiCommitDescriptor(h->MKL_FFT_Handle);
-#else
-    h->useKissFFT_flag = 1;
+    if(h->plan->useDFT_flag){
+        h->VDSP_splitOut.realp = malloc1d((h->N/2)*sizeof(float));
+        h->VDSP_splitOut.imagp = malloc1d((h->N/2)*sizeof(float));
+    }
 #endif
     if(h->useKissFFT_flag){
-       h->kissFFThandle_fwd = kiss_fftr_alloc(h->N, 0, NULL, NULL);
-       h->kissFFThandle_bkw = kiss_fftr_alloc(h->N, 1, NULL, NULL);
+        /* kiss_fftr_cfg contains scratch memory, so each instance gets a copy */
+        h->kissFFThandle_fwd = kiss_fftr_copy((kiss_fftr_cfg)h->plan->kissFFThandle_fwd);
+        h->kissFFThandle_bkw = kiss_fftr_copy((kiss_fftr_cfg)h->plan->kissFFThandle_bkw);
     }
 }
 
@@ -305,22 +671,60 @@ void saf_rfft_destroy
     if(h!=NULL){
 #if defined(__ACCELERATE__)
         if(!h->useKissFFT_flag){
-            vDSP_destroy_fftsetup(h->FFT);
             free(h->VDSP_split.realp);
             free(h->VDSP_split.imagp);
         }
-#elif defined(INTEL_MKL_VERSION)
-        h->Status = DftiFreeDescriptor(&(h->MKL_FFT_Handle));
+        free(h->VDSP_splitOut.realp);
+        free(h->VDSP_splitOut.imagp);
 #endif
         if(h->useKissFFT_flag){
             kiss_fftr_free(h->kissFFThandle_fwd);
             kiss_fftr_free(h->kissFFThandle_bkw);
         }
+        releasePlan(h->plan);
+        if(h->batchPlan != NULL)
+            releasePlan(h->batchPlan);
+        free(h->zpBuf);
         free(h);
         h=NULL;
     }
 }
 
+#if defined(__ACCELERATE__)
+/**
+ * Performs the forward transform on the input already in h->VDSP_split, and
+ * unpacks the result into outputFD (which may overlap the original input)
+ */
+static void rfft_vdspForward
+(
+    saf_rfft_data* h,
+    float_complex* outputFD
+)
+{
+    int i;
+    DSPSplitComplex* Z;
+    if(h->plan->useDFT_flag){
+        vDSP_DFT_Execute(h->plan->DFT_fwd, h->VDSP_split.realp, h->VDSP_split.imagp,
+                         h->VDSP_splitOut.realp, h->VDSP_splitOut.imagp);
+        Z = &(h->VDSP_splitOut);
+    }
+    else{
+        vDSP_fft_zrip((FFTSetup)(h->plan->FFT),&(h->VDSP_split), 1, h->plan->log2n, FFT_FORWARD);
+        Z = &(h->VDSP_split);
+    }
+    /* DC */
+    outputFD[0] = cmplxf(Z->realp[0]/2.0f, 0.0f);
+    /* Note: the output is scaled by 2, because vDSP_fft automatically compensates for the loss of energy
+     * when removing the symmetric/conjugate (N/2+2:N) bins. However, this is dumb... so the 2x scaling
+     * is removed here; so it has parity with the other FFT implementations supported by SAF. */
+    for(i=1; i<h->N/2; i++)
+        outputFD[i] = cmplxf(Z->realp[i]/2.0f, Z->imagp[i]/2.0f);
+    /* the real part of the Nyquist value is the imaginary part of DC. */
+    outputFD[h->N/2] = cmplxf(Z->imagp[0]/2.0f, 0.0f);
+    /* https://stackoverflow.com/questions/43289265/implementing-an-fft-using-vdsp */
+}
+#endif
+
 void saf_rfft_forward
 (
     void * const hFFT,
@@ -330,23 +734,12 @@ void saf_rfft_forward
 {
     saf_rfft_data *h = (saf_rfft_data*)(hFFT);
 #if defined(__ACCELERATE__)
-    int i;
     if(!h->useKissFFT_flag){
         vDSP_ctoz((DSPComplex*)inputTD, 2, &(h->VDSP_split), 1, (h->N)/2);
-        vDSP_fft_zrip((FFTSetup)(h->FFT),&(h->VDSP_split), 1, h->log2n, FFT_FORWARD);
-        /* DC */
-        outputFD[0] = cmplxf(h->VDSP_split.realp[0]/2.0f, 0.0f);
-        /* Note: the output is scaled by 2, because vDSP_fft automatically compensates for the loss of energy
-         * when removing the symmetric/conjugate (N/2+2:N) bins. However, this is dumb... so the 2x scaling
-         * is removed here; so it has parity with the other FFT implementations supported by SAF. */
-        for(i=1; i<h->N/2; i++)
-            outputFD[i] = cmplxf(h->VDSP_split.realp[i]/2.0f, h->VDSP_split.imagp[i]/2.0f);
-        /* the real part of the Nyquist value is the imaginary part of DC. */
-        outputFD[h->N/2] = cmplxf(h->VDSP_split.imagp[0]/2.0f, 0.0f);
-        /* https://stackoverflow.com/questions/43289265/implementing-an-fft-using-vdsp */
+        rfft_vdspForward(h, outputFD);
     }
 #elif defined(INTEL_MKL_VERSION)
-    h->Status = DftiComputeForward(h->MKL_FFT_Handle, inputTD, outputFD);
+    h->Status = DftiComputeForward(h->plan->MKL_FFT_Handle, inputTD, outputFD);
 #endif
     if(h->useKissFFT_flag)
         kiss_fftr(h->kissFFThandle_fwd, inputTD, (kiss_fft_cpx*)outputFD);
@@ -369,12 +762,19 @@ void saf_rfft_backward
             h->VDSP_split.realp[i] = crealf(inputFD[i]);
             h->VDSP_split.imagp[i] = cimagf(inputFD[i]);
         }
-        vDSP_fft_zrip(h->FFT, &(h->VDSP_split), 1, h->log2n, FFT_INVERSE);
-        vDSP_ztoc(&(h->VDSP_split), 1, (DSPComplex*)outputTD, 2, (h->N)/2);
+        if(h->plan->useDFT_flag){
+            vDSP_DFT_Execute(h->plan->DFT_bkw, h->VDSP_split.realp, h->VDSP_split.imagp,
+                             h->VDSP_splitOut.realp, h->VDSP_splitOut.imagp);
+            vDSP_ztoc(&(h->VDSP_splitOut), 1, (DSPComplex*)outputTD, 2, (h->N)/2);
+        }
+        else{
+            vDSP_fft_zrip(h->plan->FFT, &(h->VDSP_split), 1, h->plan->log2n, FFT_INVERSE);
+            vDSP_ztoc(&(h->VDSP_split), 1, (DSPComplex*)outputTD, 2, (h->N)/2);
+        }
         vDSP_vsmul(outputTD, 1, &(h->Scale), outputTD, 1, h->N);
     }
 #elif defined(INTEL_MKL_VERSION)
-    h->Status = DftiComputeBackward(h->MKL_FFT_Handle, inputFD, outputTD);
+    h->Status = DftiComputeBackward(h->plan->MKL_FFT_Handle, inputFD, outputTD);
 #endif
     if(h->useKissFFT_flag){
         kiss_fftri(h->kissFFThandle_bkw, (kiss_fft_cpx*)inputFD, outputTD);
@@ -383,6 +783,145 @@ void saf_rfft_backward
     }
 }
 
+void saf_rfft_forward_zp
+(
+    void * const hFFT,
+    float* inputTD,
+    int inputLen,
+    float_complex* outputFD
+)
+{
+    saf_rfft_data *h = (saf_rfft_data*)(hFFT);
+    
+    assert(inputLen>=0 && inputLen<=h->N);
+#if defined(__ACCELERATE__)
+    if(!h->useKissFFT_flag){
+        /* de-interleave the input directly, and zero the remaining pairs */
+        vDSP_ctoz((DSPComplex*)inputTD, 2, &(h->VDSP_split), 1, inputLen/2);
+        memset(&(h->VDSP_split.realp[inputLen/2]), 0, (h->N/2-inputLen/2)*sizeof(float));
+        memset(&(h->VDSP_split.imagp[inputLen/2]), 0, (h->N/2-inputLen/2)*sizeof(float));
+        if(inputLen%2)
+            h->VDSP_split.realp[inputLen/2] = inputTD[inputLen-1];
+        rfft_vdspForward(h, outputFD);
+        return;
+    }
+#endif
+    /* only the samples that were written by the previous call need clearing */
+    memcpy(h->zpBuf, inputTD, inputLen*sizeof(float));
+    if(h->zpLen > inputLen)
+        memset(&(h->zpBuf[inputLen]), 0, (h->zpLen-inputLen)*sizeof(float));
+    h->zpLen = inputLen;
+    saf_rfft_forward(hFFT, h->zpBuf, outputFD);
+}
+
+void saf_rfft_forward_inplace
+(
+    void * const hFFT,
+    float* data
+)
+{
+#if defined(INTEL_MKL_VERSION)
+    saf_rfft_data *h = (saf_rfft_data*)(hFFT);
+    /* (the plans are committed as not-in-place) */
+    utility_svvcopy(data, h->N, h->zpBuf);
+    h->zpLen = h->N;
+    h->Status = DftiComputeForward(h->plan->MKL_FFT_Handle, h->zpBuf, data);
+#else
+    /* vDSP and KissFFT both read the whole input before writing the output */
+    saf_rfft_forward(hFFT, data, (float_complex*)data);
+#endif
+}
+
+void saf_rfft_backward_inplace
+(
+    void * const hFFT,
+    float* data
+)
+{
+#if defined(INTEL_MKL_VERSION)
+    saf_rfft_data *h = (saf_rfft_data*)(hFFT);
+    h->Status = DftiComputeBackward(h->plan->MKL_FFT_Handle, data, h->zpBuf);
+    utility_svvcopy(h->zpBuf, h->N, data);
+    h->zpLen = h->N;
+#else
+    saf_rfft_backward(hFFT, (float_complex*)data, data);
+#endif
+}
+
+
+#if defined(INTEL_MKL_VERSION)
+/** Ensures that the batched plan held by 'h' matches the requested layout */
+static void rfft_prepareBatchPlan
+(
+    saf_rfft_data* h,
+    int nCH,
+    int realDist,
+    int cplxDist
+)
+{
+    saf_fft_plan* p = h->batchPlan;
+    if(p == NULL || p->howMany != nCH || p->realDist != realDist || p->cplxDist != cplxDist){
+        if(p != NULL)
+            releasePlan(p);
+        h->batchPlan = acquirePlan(h->N, SAF_FFT_PLAN_REAL, nCH, realDist, cplxDist);
+    }
+}
+#endif
+
+void saf_rfft_forward_batch
+(
+    void * const hFFT,
+    float* inputTD,
+    int inputStride,
+    int nCH,
+    float_complex* outputFD,
+    int outputStride
+)
+{
+    saf_rfft_data *h = (saf_rfft_data*)(hFFT);
+    int ch;
+    
+    inputStride = inputStride <= 0 ? h->N : inputStride;
+    outputStride = outputStride <= 0 ? h->N/2+1 : outputStride;
+#if defined(INTEL_MKL_VERSION)
+    if(nCH > 1){
+        rfft_prepareBatchPlan(h, nCH, inputStride, outputStride);
+        h->Status = DftiComputeForward(h->batchPlan->MKL_FFT_Handle, inputTD, outputFD);
+        return;
+    }
+#endif
+    /* looped fallback */
+    for(ch=0; ch<nCH; ch++)
+        saf_rfft_forward(hFFT, &inputTD[ch*inputStride], &outputFD[ch*outputStride]);
+}
+
+void saf_rfft_backward_batch
+(
+    void * const hFFT,
+    float_complex* inputFD,
+    int inputStride,
+    int nCH,
+    float* outputTD,
+    int outputStride
+)
+{
+    saf_rfft_data *h = (saf_rfft_data*)(hFFT);
+    int ch;
+    
+    inputStride = inputStride <= 0 ? h->N/2+1 : inputStride;
+    outputStride = outputStride <= 0 ? h->N : outputStride;
+#if defined(INTEL_MKL_VERSION)
+    if(nCH > 1){
+        rfft_prepareBatchPlan(h, nCH, outputStride, inputStride);
+        h->Status = DftiComputeBackward(h->batchPlan->MKL_FFT_Handle_bkw, inputFD, outputTD);
+        return;
+    }
+#endif
+    /* looped fallback */
+    for(ch=0; ch<nCH; ch++)
+        saf_rfft_backward(hFFT, &inputFD[ch*inputStride], &outputTD[ch*outputStride]);
+}
+
 
 void saf_fft_create
 (
@@ -396,34 +935,19 @@ void saf_fft_create
     h->N = N;
     h->Scale = 1.0f/(float)N; /* output scaling after ifft */
     assert(N>=2); /* only even (non zero) FFT sizes allowed */
+    h->plan = acquirePlan(N, SAF_FFT_PLAN_COMPLEX, 1, 0, 0);
+    h->useKissFFT_flag = h->plan->useKissFFT_flag;
 #if defined(__ACCELERATE__)
-    if(ceilf(log2f(N)) == floorf(log2f(N))) /* true if N is 2 to the power of some integer number */
-        h->useKissFFT_flag = 0;
-    else
-        h->useKissFFT_flag = 1;
-    /* Apple Accelerate only supports 2^x FFT sizes */
     if(!h->useKissFFT_flag){
-        h->log2n = (int)(log2f((float)N)+0.1f);
-        h->FFT = (void*)vDSP_create_fftsetup(h->log2n, FFT_RADIX2);
-        h->VDSP_split.realp = malloc1d((h->N/2)*sizeof(float));
-        h->VDSP_split.imagp = malloc1d((h->N/2)*sizeof(float));
+        h->VDSP_split.realp = malloc1d((h->N)*sizeof(float));
+        h->VDSP_split.imagp = malloc1d((h->N)*sizeof(float));
+        h->VDSP_splitOut.realp = malloc1d((h->N)*sizeof(float));
+        h->VDSP_splitOut.imagp = malloc1d((h->N)*sizeof(float));
     }
-#elif defined(INTEL_MKL_VERSION)
-    h->useKissFFT_flag = 0;
-    h->MKL_FFT_Handle = 0;
-    h->Status = DftiCreateDescriptor( &(h->MKL_FFT_Handle), DFTI_SINGLE,
-                                  DFTI_COMPLEX, 1, h->N); /* 1-D, single precision, complex_input_td->fft->complex_input_fd->ifft->complex_output_td */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE); /* Not inplace, i.e. output has its own dedicated memory */
-    /* Configuration parameters for backward-FFT */
-    h->Status = DftiSetValue(h->MKL_FFT_Handle, DFTI_BACKWARD_SCALE, h->Scale);      /* scalar applied after ifft */
-    /* commit these chosen parameters */
-    h->Status = DftiCommitDescriptor(h->MKL_FFT_Handle);
-#else
-    h->useKissFFT_flag = 1;
 #endif
     if(h->useKissFFT_flag){
-        h->kissFFThandle_fwd = kiss_fft_alloc(h->N, 0, NULL, NULL);
-        h->kissFFThandle_bkw = kiss_fft_alloc(h->N, 1, NULL, NULL);
+        h->kissFFThandle_fwd = (kiss_fft_cfg)h->plan->kissFFThandle_fwd;
+        h->kissFFThandle_bkw = (kiss_fft_cfg)h->plan->kissFFThandle_bkw;
     }
 }
 
@@ -437,17 +961,13 @@ void saf_fft_destroy
     if(h!=NULL){
 #if defined(__ACCELERATE__)
         if(!h->useKissFFT_flag){
-            vDSP_destroy_fftsetup(h->FFT);
             free(h->VDSP_split.realp);
             free(h->VDSP_split.imagp);
+            free(h->VDSP_splitOut.realp);
+            free(h->VDSP_splitOut.imagp);
         }
-#elif defined(INTEL_MKL_VERSION)
-        h->Status = DftiFreeDescriptor(&(h->MKL_FFT_Handle));
 #endif
-        if(h->useKissFFT_flag){
-            kiss_fft_free(h->kissFFThandle_fwd);
-            kiss_fft_free(h->kissFFThandle_bkw);
-        }
+        releasePlan(h->plan);
         free(h);
         h=NULL;
     }
@@ -463,24 +983,14 @@ void saf_fft_forward
     saf_fft_data *h = (saf_fft_data*)(hFFT);
     
 #if defined(__ACCELERATE__)
-    assert(0); // NOT IMPLEMENTED YET
-    int i;
     if(!h->useKissFFT_flag){
-        vDSP_ctoz((DSPComplex*)inputTD, 2, &(h->VDSP_split), 1, (h->N)/2);
-        vDSP_fft_zrip((FFTSetup)(h->FFT),&(h->VDSP_split), 1, h->log2n, FFT_FORWARD);
-        /* DC */
-        outputFD[0] = cmplxf(h->VDSP_split.realp[0]/2.0f, 0.0f);
-        /* Note: the output is scaled by 2, because vDSP_fft automatically compensates for the loss of energy
-         * when removing the symmetric/conjugate (N/2+2:N) bins. However, this is dumb... so the 2x scaling
-         * is removed here; so it has parity with the other FFT implementations supported by SAF. */
-        for(i=1; i<h->N/2; i++)
-            outputFD[i] = cmplxf(h->VDSP_split.realp[i]/2.0f, h->VDSP_split.imagp[i]/2.0f);
-        /* the real part of the Nyquist value is the imaginary part of DC. */
-        outputFD[h->N/2] = cmplxf(h->VDSP_split.imagp[0]/2.0f, 0.0f);
-        /* https://stackoverflow.com/questions/43289265/implementing-an-fft-using-vdsp */
+        vDSP_ctoz((DSPComplex*)inputTD, 2, &(h->VDSP_split), 1, h->N);
+        vDSP_DFT_Execute(h->plan->DFT_fwd, h->VDSP_split.realp, h->VDSP_split.imagp,
+                         h->VDSP_splitOut.realp, h->VDSP_splitOut.imagp);
+        vDSP_ztoc(&(h->VDSP_splitOut), 1, (DSPComplex*)outputFD, 2, h->N);
     }
 #elif defined(INTEL_MKL_VERSION)
-    h->Status = DftiComputeForward(h->MKL_FFT_Handle, inputTD, outputFD);
+    h->Status = DftiComputeForward(h->plan->MKL_FFT_Handle, inputTD, outputFD);
 #endif
     if(h->useKissFFT_flag)
         kiss_fft(h->kissFFThandle_fwd, (kiss_fft_cpx*)inputTD, (kiss_fft_cpx*)outputFD);
@@ -496,20 +1006,15 @@ void saf_fft_backward
     saf_fft_data *h = (saf_fft_data*)(hFFT);
     int i;
 #if defined(__ACCELERATE__)
-    assert(0); // NOT IMPLEMENTED YET
     if(!h->useKissFFT_flag){
-        h->VDSP_split.realp[0] = crealf(inputFD[0]);
-        h->VDSP_split.imagp[0] = crealf(inputFD[h->N/2]);
-        for(i=1; i<h->N/2; i++){
-            h->VDSP_split.realp[i] = crealf(inputFD[i]);
-            h->VDSP_split.imagp[i] = cimagf(inputFD[i]);
-        }
-        vDSP_fft_zrip(h->FFT, &(h->VDSP_split), 1, h->log2n, FFT_INVERSE);
-        vDSP_ztoc(&(h->VDSP_split), 1, (DSPComplex*)outputTD, 2, (h->N)/2);
-        vDSP_vsmul(outputTD, 1, &(h->Scale), outputTD, 1, h->N);
+        vDSP_ctoz((DSPComplex*)inputFD, 2, &(h->VDSP_split), 1, h->N);
+        vDSP_DFT_Execute(h->plan->DFT_bkw, h->VDSP_split.realp, h->VDSP_split.imagp,
+                         h->VDSP_splitOut.realp, h->VDSP_splitOut.imagp);
+        vDSP_ztoc(&(h->VDSP_splitOut), 1, (DSPComplex*)outputTD, 2, h->N);
+        vDSP_vsmul((float*)outputTD, 1, &(h->Scale), (float*)outputTD, 1, 2*(h->N));
     }
 #elif defined(INTEL_MKL_VERSION)
-    h->Status = DftiComputeBackward(h->MKL_FFT_Handle, inputFD, outputTD);
+    h->Status = DftiComputeBackward(h->plan->MKL_FFT_Handle, inputFD, outputTD);
 #endif
     if(h->useKissFFT_flag){
         kiss_fft(h->kissFFThandle_bkw, (kiss_fft_cpx*)inputFD, (kiss_fft_cpx*)outputTD);
@@ -22,8 +22,10 @@
  *       saf_fft employs the highly respectable KissFFT from here (BSD 3-Clause
  *       License): https://github.com/mborgerding/kissfft
  *
- * @note If linking Apple Accelerate: KissFFT is also used in cases where the
- *       FFT size is not 2^x.
+ * @note If linking Apple Accelerate: the real FFT uses vDSP_fft_zrip() for sizes
+ *       of 2^x, while the vDSP_DFT routines are used for the complex FFT, and
+ *       for real FFT sizes of f*2^x (where f is 3, 5 or 15); e.g. 480, 960 or
+ *       1920 for 48kHz broadcast framing. KissFFT is used for all other sizes.
  *
  * ## Dependencies
  *   Intel MKL, Apple Accelerate, or KissFFT (included in framework)
@@ -122,6 +124,29 @@ void fftfilt(float* x,
              int nCH,
              float* y);
 
+/**
+ * FFT-based cross-correlation between pairs of vectors.
+ *
+ * x_ab[k] = sum_n a[n+k-(lb-1)] b[n], for k = 0..la+lb-2; i.e. the zero-lag
+ * term is x_ab[lb-1]. For la==lb, this is the same as cxcorr() (Matlab 'xcorr'
+ * ordering), but computed in the frequency domain. All channels share one FFT
+ * plan and are transformed in batches.
+ *
+ * @param[in]  a     Vector(s) a; FLAT: nCH x la
+ * @param[in]  b     Vector(s) b; FLAT: nCH x lb
+ * @param[in]  la    Length of vector a
+ * @param[in]  lb    Length of vector b
+ * @param[in]  nCH   Number of channels
+ * @param[out] x_ab  Cross-correlation(s) between a and b;
+ *                   FLAT: nCH x (la+lb-1)
+ */
+void fftxcorr(float* a,
+              float* b,
+              int la,
+              int lb,
+              int nCH,
+              float* x_ab);
+
 /**
  * Computes the discrete-time analytic signal via the Hilbert transform.
  *
@@ -130,13 +155,64 @@ void fftfilt(float* x,
  * function)
  *
  * @param[in]  x     Input; x_len x 1
- * @param[in]  x_len Length of input signal, in samples
+ * @param[in]  x_len Length of input signal, in samples (even or odd)
  * @param[out] y     Output analytic signal; x_len x 1
  */
 void hilbert(float_complex* x,
              int x_len,
              float_complex* y);
 
+/**
+ * Computes the discrete-time analytic signals of a batch of signals of the
+ * same length via the Hilbert transform (as hilbert()); with one FFT instance
+ * and one set of scratch buffers shared by all of the signals
+ *
+ * @param[in]  x     Inputs; FLAT: nCH x x_len
+ * @param[in]  x_len Length of the input signals, in samples (even or odd)
+ * @param[in]  nCH   Number of signals
+ * @param[out] y     Output analytic signals; FLAT: nCH x x_len
+ */
+void hilbertBatch(float_complex* x,
+                  int x_len,
+                  int nCH,
+                  float_complex* y);
+
+/**
+ * Returns the spectral weights applied by the Hilbert transform; i.e. the
+ * analytic signal of 'x' is ifft(fft(x).*h)
+ *
+ * @param[in]  x_len Length of the signal, in samples (even or odd)
+ * @param[out] h     Weights; x_len x 1
+ */
+void hilbertWeights(int x_len,
+                    float_complex* h);
+
+
+/* ========================================================================== */
+/*                               FFT Plan Cache                               */
+/* ========================================================================== */
+
+/* The FFT plans (twiddle factors, MKL descriptors, vDSP setups etc.) are
+ * stored in a process-wide cache, keyed by FFT size and type (real/complex).
+ * Therefore, creating multiple saf_rfft/saf_fft instances of the same size
+ * (even across threads) only computes the plan once; each instance then holds
+ * only its own scratch memory. Plans remain cached after the last instance
+ * using them has been destroyed, so that repeated create/destroy calls (e.g.
+ * in fftconv, fftfilt and hilbert) are cheap. */
+
+/**
+ * Destroys all cached FFT plans that are not currently in use by any
+ * saf_rfft/saf_fft instance
+ *
+ * @note Thread-safe. It is safe to call this at any time.
+ */
+void saf_fft_clearPlanCache(void);
+
+/**
+ * Returns the number of FFT plans currently held in the cache (in use or not)
+ */
+int saf_fft_getNumCachedPlans(void);
+
 
 /* ========================================================================== */
 /*                Real<->Half-Complex (Conjugate-Symmetric) FFT               */
@@ -147,6 +223,8 @@ void hilbert(float_complex* x,
  * FFT.
  *
  * @note Only Even FFT sizes are supported.
+ * @note The plan is taken from the FFT plan cache (if available), and so
+ *       creating multiple instances of the same size is inexpensive.
  *
  * @param[in] phFFT (&) address of saf_rfft handle
  * @param[in] N     FFT size
@@ -189,6 +267,104 @@ void saf_rfft_backward(void * const hFFT,
                        float_complex* inputFD,
                        float* outputTD);
 
+/**
+ * Performs the forward-FFT operation on an input which is shorter than the FFT
+ * size, which is implicitly zero-padded to length N
+ *
+ * This avoids having to stage the input in a zero-padded buffer (e.g. for
+ * fast convolution). With Apple Accelerate, the input is read directly;
+ * otherwise, it is copied into a scratch buffer held by the instance, of which
+ * only the part that is not already zero is cleared.
+ *
+ * @param[in]  hFFT     saf_rfft handle
+ * @param[in]  inputTD  Time-domain input; inputLen x 1
+ * @param[in]  inputLen Length of the input (0..N)
+ * @param[out] outputFD Frequency-domain output; (N/2 + 1) x 1
+ */
+void saf_rfft_forward_zp(void * const hFFT,
+                         float* inputTD,
+                         int inputLen,
+                         float_complex* outputFD);
+
+/**
+ * Performs the forward-FFT operation in-place
+ *
+ * @note 'data' must hold N+2 floats. On input, the first N are the time-domain
+ *       signal; on output, they are all overwritten by (N/2 + 1) interleaved
+ *       complex bins (i.e. 'data' may then be cast to float_complex*).
+ *
+ * @param[in]     hFFT saf_rfft handle
+ * @param[in,out] data Time-domain input/frequency-domain output; (N+2) x 1
+ */
+void saf_rfft_forward_inplace(void * const hFFT,
+                              float* data);
+
+/**
+ * Performs the backward-FFT operation in-place
+ *
+ * @note 'data' must hold N+2 floats. On input, these are (N/2 + 1) interleaved
+ *       complex bins; on output, the first N are the time-domain signal.
+ *
+ * @param[in]     hFFT saf_rfft handle
+ * @param[in,out] data Frequency-domain input/time-domain output; (N+2) x 1
+ */
+void saf_rfft_backward_inplace(void * const hFFT,
+                               float* data);
+
+
+/**
+ * Performs the forward-FFT operation on multiple channels at once; use for
+ * real to complex (conjugate symmetric) transformations.
+ *
+ * The channels may be stored contiguously (pass 0 for the strides), or spaced
+ * by arbitrary strides (e.g. in order to operate on zero-padded buffers).
+ * Intel MKL performs all of the transforms with one call (using
+ * DFTI_NUMBER_OF_TRANSFORMS), whereas the other backends loop over the
+ * channels.
+ *
+ * @note With Intel MKL, the first call for a given nCH/stride combination
+ *       commits a new batched plan (which is then cached). Therefore, consider
+ *       calling this once during initialisation, if it is to be used in a
+ *       real-time loop.
+ *
+ * @param[in]  hFFT         saf_rfft handle
+ * @param[in]  inputTD      Time-domain input; FLAT: nCH x inputStride
+ * @param[in]  inputStride  Distance between the start of each input channel
+ *                          (>=N), or 0 for N
+ * @param[in]  nCH          Number of channels
+ * @param[out] outputFD     Frequency-domain output; FLAT: nCH x outputStride
+ * @param[in]  outputStride Distance between the start of each output channel
+ *                          (>=N/2+1), or 0 for N/2+1
+ */
+void saf_rfft_forward_batch(void * const hFFT,
+                            float* inputTD,
+                            int inputStride,
+                            int nCH,
+                            float_complex* outputFD,
+                            int outputStride);
+
+/**
+ * Performs the backward-FFT operation on multiple channels at once; use for
+ * complex (conjugate symmetric) to real transformations.
+ *
+ * @note See saf_rfft_forward_batch() for details.
+ *
+ * @param[in]  hFFT         saf_rfft handle
+ * @param[in]  inputFD      Frequency-domain input; FLAT: nCH x inputStride
+ * @param[in]  inputStride  Distance between the start of each input channel
+ *                          (>=N/2+1), or 0 for N/2+1
+ * @param[in]  nCH          Number of channels
+ * @param[out] outputTD     Time-domain output; FLAT: nCH x outputStride
+ * @param[in]  outputStride Distance between the start of each output channel
+ *                          (>=N), or 0 for N
+ */
+void saf_rfft_backward_batch(void * const hFFT,
+                             float_complex* inputFD,
+                             int inputStride,
+                             int nCH,
+                             float* outputTD,
+                             int outputStride);
+
 
 /* ========================================================================== */
 /*                            Complex<->Complex FFT                           */
@@ -198,6 +374,8 @@ void saf_rfft_backward(void * const hFFT,
  * Creates an instance of saf_fft; complex<->complex FFT.
  *
  * @note Only Even FFT sizes are supported.
+ * @note The plan is taken from the FFT plan cache (if available), and so
+ *       creating multiple instances of the same size is inexpensive.
  *
  * @param[in] phFFT (&) address of saf_fft handle
  * @param[in] N     FFT size
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_fifo.c
+ * @brief Input/output FIFO buffer, for driving fixed frame-size processing
+ *        functions with arbitrary (and possibly varying) host block sizes
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_fifo.h"
+
+/**
+ * Data structure for the FIFO.
+ *
+ * In the pass-through mode ('direct'), each frame of the host block is given
+ * to the processing function as it is, and only the output frame is copied
+ * (so that in-place processing remains safe).
+ *
+ * Otherwise, the input and output frames share one read/write position. Each
+ * incoming sample is written to the input frame and replaced in the output by
+ * the sample at the same position of the previously processed frame. Once the
+ * position reaches the end of the frame, the processing function is called and
+ * the position is wrapped back to zero. Therefore, the latency is exactly one
+ * frame.
+ *
+ * When the processing function is given the host buffers directly, the new
+ * output frame is written to 'outFrameSpare' instead; since the previous output
+ * frame is still to be passed to the host. The two are then swapped.
+ */
+typedef struct _safFIFO_data {
+    int frameSize;
+    int maxNumInputs, maxNumOutputs;
+    int hostBlockSize;     /**< as given to saf_fifo_setHostBlockSize() */
+    int direct;            /**< 1: pass-through (no latency), 0: buffered */
+    int pos;               /**< current read/write position in the frames */
+    float** inFrame;       /**< input frame; maxNumInputs x frameSize */
+    float** outFrame;      /**< output frame; maxNumOutputs x frameSize */
+    float** outFrameSpare; /**< spare output frame; maxNumOutputs x frameSize */
+    float** hostInPtrs;    /**< pointers into the host input buffers; maxNumInputs x 1 */
+
+}safFIFO_data;
+
+void saf_fifo_create
+(
+    void ** const phFIFO,
+    int frameSize,
+    int maxNumInputs,
+    int maxNumOutputs
+)
+{
+    *phFIFO = malloc1d(sizeof(safFIFO_data));
+    safFIFO_data *h = (safFIFO_data*)(*phFIFO);
+
+    h->frameSize = frameSize;
+    h->maxNumInputs = maxNumInputs;
+    h->maxNumOutputs = maxNumOutputs;
+    h->hostBlockSize = SAF_FIFO_BLOCKSIZE_AUTO;
+    h->direct = 1;
+    h->pos = 0;
+    h->inFrame = maxNumInputs > 0 ? (float**)calloc2d(maxNumInputs, frameSize, sizeof(float)) : NULL;
+    h->outFrame = maxNumOutputs > 0 ? (float**)calloc2d(maxNumOutputs, frameSize, sizeof(float)) : NULL;
+    h->outFrameSpare = maxNumOutputs > 0 ? (float**)calloc2d(maxNumOutputs, frameSize, sizeof(float)) : NULL;
+    h->hostInPtrs = maxNumInputs > 0 ? (float**)malloc1d(maxNumInputs*sizeof(float*)) : NULL;
+}
+
+void saf_fifo_destroy
+(
+    void ** const phFIFO
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(*phFIFO);
+
+    if(h!=NULL){
+        free(h->inFrame);
+        free(h->outFrame);
+        free(h->outFrameSpare);
+        free(h->hostInPtrs);
+        free(h);
+        *phFIFO = NULL;
+    }
+}
+
+void saf_fifo_flush
+(
+    void * const hFIFO
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(hFIFO);
+
+    if(h->inFrame!=NULL)
+        memset(ADR2D(h->inFrame), 0, h->maxNumInputs*h->frameSize*sizeof(float));
+    if(h->outFrame!=NULL)
+        memset(ADR2D(h->outFrame), 0, h->maxNumOutputs*h->frameSize*sizeof(float));
+    h->pos = 0;
+    h->direct = h->hostBlockSize < 1 || h->hostBlockSize % h->frameSize == 0;
+}
+
+void saf_fifo_setHostBlockSize
+(
+    void * const hFIFO,
+    int blockSize
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(hFIFO);
+
+    h->hostBlockSize = blockSize < 1 ? SAF_FIFO_BLOCKSIZE_AUTO : blockSize;
+    saf_fifo_flush(hFIFO);
+}
+
+int saf_fifo_getLatency
+(
+    void * const hFIFO
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(hFIFO);
+
+    return h->direct ? 0 : h->frameSize;
+}
+
+/** Switches from the pass-through to buffering, if this block requires it */
+static void saf_fifo_checkDirect
+(
+    safFIFO_data *h,
+    int nSamples
+)
+{
+    if(h->direct && nSamples % h->frameSize != 0){
+        /* (the previous output frame has already been passed to the host) */
+        if(h->outFrame!=NULL)
+            memset(ADR2D(h->outFrame), 0, h->maxNumOutputs*h->frameSize*sizeof(float));
+        h->pos = 0;
+        h->direct = 0;
+    }
+}
+
+void saf_fifo_process
+(
+    void * const hFIFO,
+    float ** const inputs,
+    float ** const outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples,
+    saf_fifo_frameProcessor frameProc,
+    void * const hProc
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(hFIFO);
+    int ch, s, len, nIn, nOut;
+    float** tmp;
+
+    nIn = MIN(nInputs, h->maxNumInputs);
+    nOut = MIN(nOutputs, h->maxNumOutputs);
+    saf_fifo_checkDirect(h, nSamples);
+
+    /* pass each frame straight through */
+    if(h->direct){
+        for(s=0; s<nSamples; s+=h->frameSize){
+            for(ch=0; ch<nIn; ch++)
+                h->hostInPtrs[ch] = &(inputs[ch][s]);
+            frameProc(hProc, h->hostInPtrs, h->outFrame, nIn, nOut);
+            for(ch=0; ch<nOut; ch++)
+                memcpy(&(outputs[ch][s]), h->outFrame[ch], h->frameSize*sizeof(float));
+            for(; ch<nOutputs; ch++)
+                memset(&(outputs[ch][s]), 0, h->frameSize*sizeof(float));
+        }
+        return;
+    }
+
+    /* copy as many samples as possible at a time (up to the end of the current
+     * frame). The inputs are always read before the outputs are written, in
+     * case the host is processing in-place. */
+    for(s=0; s<nSamples; s+=len){
+        /* a whole frame is available in the host buffers, so process it from
+         * there; the inputs have then been read before the outputs are written */
+        if(h->pos==0 && nSamples-s >= h->frameSize){
+            len = h->frameSize;
+            for(ch=0; ch<nIn; ch++)
+                h->hostInPtrs[ch] = &(inputs[ch][s]);
+            frameProc(hProc, h->hostInPtrs, h->outFrameSpare, nIn, nOut);
+            for(ch=0; ch<nOut; ch++)
+                memcpy(&(outputs[ch][s]), h->outFrame[ch], len*sizeof(float));
+            for(; ch<nOutputs; ch++)
+                memset(&(outputs[ch][s]), 0, len*sizeof(float));
+            tmp = h->outFrame;
+            h->outFrame = h->outFrameSpare;
+            h->outFrameSpare = tmp;
+            continue;
+        }
+
+        len = MIN(nSamples-s, h->frameSize-h->pos);
+        for(ch=0; ch<nIn; ch++)
+            memcpy(&(h->inFrame[ch][h->pos]), &(inputs[ch][s]), len*sizeof(float));
+        for(ch=0; ch<nOut; ch++)
+            memcpy(&(outputs[ch][s]), &(h->outFrame[ch][h->pos]), len*sizeof(float));
+        for(; ch<nOutputs; ch++)
+            memset(&(outputs[ch][s]), 0, len*sizeof(float));
+        h->pos += len;
+
+        /* frame is complete */
+        if(h->pos == h->frameSize){
+            frameProc(hProc, h->inFrame, h->outFrame, nIn, nOut);
+            h->pos = 0;
+        }
+    }
+}
+
+void saf_fifo_processInterleaved
+(
+    void * const hFIFO,
+    const float * inputs,
+    float * outputs,
+    int nInputs,
+    int nOutputs,
+    int nSamples,
+    saf_fifo_frameProcessor frameProc,
+    void * const hProc
+)
+{
+    safFIFO_data *h = (safFIFO_data*)(hFIFO);
+    int ch, s, t, len, nIn, nOut;
+
+    nIn = MIN(nInputs, h->maxNumInputs);
+    nOut = MIN(nOutputs, h->maxNumOutputs);
+    saf_fifo_checkDirect(h, nSamples);
+
+    /* as in saf_fifo_process(), but de-interleaving/interleaving on the fly */
+    if(h->direct){
+        for(s=0; s<nSamples; s+=h->frameSize){
+            for(t=0; t<h->frameSize; t++)
+                for(ch=0; ch<nIn; ch++)
+                    h->inFrame[ch][t] = inputs[(s+t)*nInputs+ch];
+            frameProc(hProc, h->inFrame, h->outFrame, nIn, nOut);
+            for(t=0; t<h->frameSize; t++){
+                for(ch=0; ch<nOut; ch++)
+                    outputs[(s+t)*nOutputs+ch] = h->outFrame[ch][t];
+                for(; ch<nOutputs; ch++)
+                    outputs[(s+t)*nOutputs+ch] = 0.0f;
+            }
+        }
+        return;
+    }
+    for(s=0; s<nSamples; s+=len){
+        len = MIN(nSamples-s, h->frameSize-h->pos);
+        for(t=0; t<len; t++){
+            for(ch=0; ch<nIn; ch++)
+                h->inFrame[ch][h->pos+t] = inputs[(s+t)*nInputs+ch];
+            for(ch=0; ch<nOut; ch++)
+                outputs[(s+t)*nOutputs+ch] = h->outFrame[ch][h->pos+t];
+            for(; ch<nOutputs; ch++)
+                outputs[(s+t)*nOutputs+ch] = 0.0f;
+        }
+        h->pos += len;
+
+        /* frame is complete */
+        if(h->pos == h->frameSize){
+            frameProc(hProc, h->inFrame, h->outFrame, nIn, nOut);
+            h->pos = 0;
+        }
+    }
+}
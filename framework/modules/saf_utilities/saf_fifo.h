@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_fifo.h
+ * @brief Input/output FIFO buffer, for driving fixed frame-size processing
+ *        functions with arbitrary (and possibly varying) host block sizes
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_FIFO_H_INCLUDED
+#define SAF_FIFO_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * Host block size to pass to saf_fifo_setHostBlockSize(), if it is not known
+ * in advance (this is also the default)
+ */
+#define SAF_FIFO_BLOCKSIZE_AUTO ( 0 )
+
+/**
+ * Prototype of a processing function, which is given one frame of input
+ * signals and must write one frame of output signals
+ *
+ * @note The input frame may point directly into the host buffers (see
+ *       saf_fifo_process()), and so it must not be written to.
+ *
+ * @param[in]  hProc    Handle of the processor
+ * @param[in]  inFrame  Input frame;  nInputs  x frameSize
+ * @param[out] outFrame Output frame; nOutputs x frameSize
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nOutputs Number of output channels
+ */
+typedef void (*saf_fifo_frameProcessor)(void* const hProc,
+                                        float** const inFrame,
+                                        float** const outFrame,
+                                        int nInputs,
+                                        int nOutputs);
+
+/**
+ * Creates an instance of the FIFO
+ *
+ * All memory is allocated here, and so saf_fifo_process() may be safely called
+ * from a real-time audio thread.
+ *
+ * @param[in] phFIFO        (&) address of FIFO handle
+ * @param[in] frameSize     Frame size of the processing function, in samples
+ * @param[in] maxNumInputs  Maximum number of input channels
+ * @param[in] maxNumOutputs Maximum number of output channels (may be 0 for
+ *                          analysis-only processors)
+ */
+void saf_fifo_create(/* Input Arguments */
+                     void ** const phFIFO,
+                     int frameSize,
+                     int maxNumInputs,
+                     int maxNumOutputs);
+
+/**
+ * Destroys an instance of the FIFO
+ *
+ * @param[in] phFIFO (&) address of FIFO handle
+ */
+void saf_fifo_destroy(/* Input Arguments */
+                      void ** const phFIFO);
+
+/**
+ * Flushes the FIFO (i.e. zeros its buffers)
+ *
+ * The mode is also selected again, based on the host block size given to
+ * saf_fifo_setHostBlockSize() (if any).
+ *
+ * @param[in] hFIFO FIFO handle
+ */
+void saf_fifo_flush(/* Input Arguments */
+                    void * const hFIFO);
+
+/**
+ * Tells the FIFO which block size the host will use, and flushes it
+ *
+ * If the block size is a multiple of the frame size, then the FIFO passes the
+ * frames straight through to the processing function, and adds no latency.
+ * Otherwise, the signals are buffered, which adds one frame of latency.
+ * With SAF_FIFO_BLOCKSIZE_AUTO (the default), the pass-through is used until the
+ * first block that is not a multiple of the frame size is encountered.
+ *
+ * @note If the FIFO has to switch to buffering after the pass-through has been
+ *       in use, then one frame of silence is inserted into the output. Hosts
+ *       that know their block size in advance should therefore call this
+ *       function before processing (e.g. in their prepare-to-play callback)
+ *
+ * @param[in] hFIFO     FIFO handle
+ * @param[in] blockSize Host block size, in samples; or SAF_FIFO_BLOCKSIZE_AUTO
+ */
+void saf_fifo_setHostBlockSize(/* Input Arguments */
+                               void * const hFIFO,
+                               int blockSize);
+
+/**
+ * Returns the latency currently introduced by the FIFO, in samples (0 when the
+ * frames are passed straight through, otherwise the frame size); see
+ * saf_fifo_setHostBlockSize()
+ */
+int saf_fifo_getLatency(/* Input Arguments */
+                        void * const hFIFO);
+
+/**
+ * Passes a block of any length through the FIFO
+ *
+ * If every block so far has been a multiple of the frame size (see
+ * saf_fifo_setHostBlockSize()), then the processing function is simply called
+ * for each frame of the block, and the output frames are written to the
+ * outputs straight away. Otherwise, the input samples are collected into frames of 'frameSize', and the
+ * processing function is called each time a frame is complete. The output
+ * samples are read from the most recently processed frame. The input and output
+ * buffers may be the same (i.e. in-place processing is supported).
+ *
+ * Whenever a whole frame of input samples is available in the host buffers
+ * (i.e. the FIFO is empty, and at least 'frameSize' samples remain), the
+ * processing function is instead given pointers into the host buffers
+ * directly; thus skipping the input copy. The latency remains the same.
+ *
+ * @note Channels beyond 'maxNumOutputs' are zeroed, and channels beyond
+ *       'maxNumInputs' are ignored.
+ *
+ * @param[in]  hFIFO     FIFO handle
+ * @param[in]  inputs    Input signals;  nInputs  x nSamples
+ * @param[out] outputs   Output signals; nOutputs x nSamples
+ * @param[in]  nInputs   Number of input channels
+ * @param[in]  nOutputs  Number of output channels
+ * @param[in]  nSamples  Number of samples in each channel (any value)
+ * @param[in]  frameProc Processing function to call for each complete frame
+ * @param[in]  hProc     Handle passed to the processing function
+ */
+void saf_fifo_process(/* Input Arguments */
+                      void * const hFIFO,
+                      float ** const inputs,
+                      /* Output Arguments */
+                      float ** const outputs,
+                      /* Input Arguments */
+                      int nInputs,
+                      int nOutputs,
+                      int nSamples,
+                      saf_fifo_frameProcessor frameProc,
+                      void * const hProc);
+
+/**
+ * Same as saf_fifo_process(), but for interleaved input/output buffers
+ *
+ * The input samples are de-interleaved directly into the input frame, and the
+ * output samples are interleaved directly from the output frame; so no
+ * intermediate planar buffers are required.
+ *
+ * @note The input and output buffers may only be the same if
+ *       nInputs==nOutputs.
+ *
+ * @param[in]  hFIFO     FIFO handle
+ * @param[in]  inputs    Interleaved input signals;  FLAT: nSamples x nInputs
+ * @param[out] outputs   Interleaved output signals; FLAT: nSamples x nOutputs
+ * @param[in]  nInputs   Number of input channels
+ * @param[in]  nOutputs  Number of output channels
+ * @param[in]  nSamples  Number of samples in each channel (any value)
+ * @param[in]  frameProc Processing function to call for each complete frame
+ * @param[in]  hProc     Handle passed to the processing function
+ */
+void saf_fifo_processInterleaved(/* Input Arguments */
+                                 void * const hFIFO,
+                                 const float * inputs,
+                                 /* Output Arguments */
+                                 float * outputs,
+                                 /* Input Arguments */
+                                 int nInputs,
+                                 int nOutputs,
+                                 int nSamples,
+                                 saf_fifo_frameProcessor frameProc,
+                                 void * const hProc);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_FIFO_H_INCLUDED */
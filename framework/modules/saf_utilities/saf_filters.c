@@ -24,6 +24,33 @@
 
 #include "saf_filters.h" 
 #include "saf_utilities.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+/*
+ * SIMD kernels for the bi-quad cascade (see biQuadCascade_create()); selected
+ * in the same way as for the saf_veclib element-wise ops. Define
+ * SAF_VECLIB_DISABLE_SIMD to only use the plain loops.
+ */
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(SAF_VECLIB_DISABLE_SIMD)
+# define SAF_FILTERS_SSE2
+# include <emmintrin.h>
+# if defined(__GNUC__) || defined(__clang__)
+#  define SAF_FILTERS_AVX2
+#  define SAF_FILTERS_AVX2_TARGET __attribute__((target("avx2,fma")))
+#  include <immintrin.h>
+# elif defined(_MSC_VER)
+#  define SAF_FILTERS_AVX2
+#  define SAF_FILTERS_AVX2_TARGET
+#  include <immintrin.h>
+# endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(SAF_VECLIB_DISABLE_SIMD)
+# define SAF_FILTERS_NEON
+# include <arm_neon.h>
+#endif
 
 /**
  * Applies a windowing function (see WINDOWING_FUNCTION_TYPES enum) of length
@@ -140,39 +167,59 @@ void flattenMinphase
     int len
 )
 {
-    int i;
-    float_complex* ctd_tmp, *tdi_f, *tdi_f_labs, *dt_min_f;
+    flattenMinphaseBatch(x, len, 1);
+}
+
+void flattenMinphaseBatch
+(
+    float* x,
+    int len,
+    int nCH
+)
+{
+    int i, ch;
+    float* xc;
+    float_complex* ctd_tmp, *tdi_f, *tdi_f_labs, *dt_min_f, *h_hilb;
     void* hFFT;
     
-    /* prep */
+    /* prep (the FFT and scratch are shared by all of the signals; the
+     * Hilbert transform is carried out with the same FFT) */
     ctd_tmp = malloc1d(len*sizeof(float_complex));
     tdi_f = malloc1d(len*sizeof(float_complex));
     tdi_f_labs = malloc1d(len*sizeof(float_complex));
     dt_min_f = malloc1d(len*sizeof(float_complex));
+    h_hilb = malloc1d(len*sizeof(float_complex));
     saf_fft_create(&hFFT, len);
+    hilbertWeights(len, h_hilb);
     
-    /* fft */
-    for(i=0; i<len; i++)
-        ctd_tmp[i] = cmplxf(x[i], 0.0f);
-    saf_fft_forward(hFFT, (float_complex*)ctd_tmp, (float_complex*)tdi_f);
-    
-    /* take log(cabs()) */
-    for(i=0; i<len; i++)
-        tdi_f_labs[i] = cmplxf(logf(cabsf(tdi_f[i])), 0.0f);
-    
-    /* Hilbert to acquire discrete-time analytic signal */
-    hilbert(tdi_f_labs, len, dt_min_f);
-    
-    /* compute minimum-phase response, and apply to tdi_f to flatten it to unity magnitude */
-    for(i=0; i<len; i++)
-        dt_min_f[i] = ccdivf(tdi_f[i], cexpf(conjf(dt_min_f[i])));
-    
-    /* ifft */
-    saf_fft_backward(hFFT, dt_min_f, ctd_tmp);
-    
-    /* overwrite input with EQ'd version */
-    for(i=0; i<len; i++)
-        x[i] = crealf(ctd_tmp[i]);
+    for(ch=0; ch<nCH; ch++){
+        xc = &x[ch*len];
+        
+        /* fft */
+        for(i=0; i<len; i++)
+            ctd_tmp[i] = cmplxf(xc[i], 0.0f);
+        saf_fft_forward(hFFT, (float_complex*)ctd_tmp, (float_complex*)tdi_f);
+        
+        /* take log(cabs()) */
+        for(i=0; i<len; i++)
+            tdi_f_labs[i] = cmplxf(logf(cabsf(tdi_f[i])), 0.0f);
+        
+        /* Hilbert to acquire discrete-time analytic signal */
+        saf_fft_forward(hFFT, tdi_f_labs, ctd_tmp);
+        utility_cvvmul(ctd_tmp, h_hilb, len, tdi_f_labs);
+        saf_fft_backward(hFFT, tdi_f_labs, dt_min_f);
+        
+        /* compute minimum-phase response, and apply to tdi_f to flatten it to unity magnitude */
+        for(i=0; i<len; i++)
+            dt_min_f[i] = ccdivf(tdi_f[i], cexpf(conjf(dt_min_f[i])));
+        
+        /* ifft */
+        saf_fft_backward(hFFT, dt_min_f, ctd_tmp);
+        
+        /* overwrite input with EQ'd version */
+        for(i=0; i<len; i++)
+            xc[i] = crealf(ctd_tmp[i]);
+    }
     
     /* tidy up */
     saf_fft_destroy(&hFFT);
@@ -180,6 +227,7 @@ void flattenMinphase
     free(tdi_f);
     free(tdi_f_labs);
     free(dt_min_f);
+    free(h_hilb);
 }
 
 void biQuadCoeffs
@@ -352,21 +400,489 @@ void evalBiQuadTransferFunction
     }
 }
 
-void FIRCoeffs
+/* ========================================================================== */
+/*                           Bi-Quad Cascade Functions                        */
+/* ========================================================================== */
+
+/** Number of samples transposed into the interleaved buffer at a time */
+#define BIQUADCASCADE_BLOCK_SIZE ( 64 )
+
+/** Number of coefficients stored per section: b0, b1, b2, a1, a2 */
+#define BIQUADCASCADE_NUM_COEFFS ( 5 )
+
+/**
+ * Data structure for the bi-quad cascade.
+ *
+ * The channels are split into groups of 'nLanes', and everything is stored
+ * lane-interleaved (structure-of-arrays), such that each coefficient and state
+ * is one aligned SIMD vector for the whole group.
+ */
+typedef struct _biQuadCascade_data {
+    int nChannels, nSections, nLanes, nGroups;
+    float* coeffs;  /**< nGroups x nSections x BIQUADCASCADE_NUM_COEFFS x nLanes */
+    float* state;   /**< nGroups x nSections x 2 x nLanes */
+    float* buffer;  /**< interleaved block of the current group; BIQUADCASCADE_BLOCK_SIZE x nLanes */
+    void* mem;      /**< (unaligned) memory holding all of the above */
+
+}biQuadCascade_data;
+
+#if !defined(SAF_FILTERS_AVX2) && !defined(SAF_FILTERS_SSE2) && !defined(SAF_FILTERS_NEON)
+/**
+ * Applies the sections of one group to its interleaved block (in place), using
+ * the transposed direct form II difference equation (plain loops)
+ */
+static void biQuadCascade_groupScalar
+(
+    const float* coeffs,
+    float* state,
+    int nSections,
+    int nLanes,
+    float* buffer,
+    int nSamples
+)
+{
+    int s, n, l;
+    float x, y;
+    const float* c;
+    float* z;
+
+    for(s=0; s<nSections; s++){
+        c = &coeffs[s*BIQUADCASCADE_NUM_COEFFS*nLanes];
+        z = &state[s*2*nLanes];
+        for(n=0; n<nSamples; n++){
+            for(l=0; l<nLanes; l++){
+                x = buffer[n*nLanes+l];
+                y = c[0*nLanes+l] * x + z[l];
+                z[l] = c[1*nLanes+l] * x - c[3*nLanes+l] * y + z[nLanes+l];
+                z[nLanes+l] = c[2*nLanes+l] * x - c[4*nLanes+l] * y;
+                buffer[n*nLanes+l] = y;
+            }
+        }
+    }
+}
+#endif /* !SAF_FILTERS_AVX2 && !SAF_FILTERS_SSE2 && !SAF_FILTERS_NEON */
+
+#ifdef SAF_FILTERS_AVX2
+/** AVX2 version of biQuadCascade_groupScalar(); nLanes=8 */
+SAF_FILTERS_AVX2_TARGET static void biQuadCascade_groupAVX2
+(
+    const float* coeffs,
+    float* state,
+    int nSections,
+    float* buffer,
+    int nSamples
+)
+{
+    int s, n;
+    __m256 b0, b1, b2, a1, a2, z1, z2, x, y;
+    const float* c;
+
+    for(s=0; s<nSections; s++){
+        /* the coefficients and states of this section stay in registers */
+        c = &coeffs[s*BIQUADCASCADE_NUM_COEFFS*8];
+        b0 = _mm256_load_ps(&c[0]);
+        b1 = _mm256_load_ps(&c[8]);
+        b2 = _mm256_load_ps(&c[16]);
+        a1 = _mm256_load_ps(&c[24]);
+        a2 = _mm256_load_ps(&c[32]);
+        z1 = _mm256_load_ps(&state[s*16]);
+        z2 = _mm256_load_ps(&state[s*16+8]);
+        for(n=0; n<nSamples; n++){
+            x = _mm256_load_ps(&buffer[n*8]);
+            y = _mm256_fmadd_ps(b0, x, z1);
+            z1 = _mm256_fnmadd_ps(a1, y, _mm256_fmadd_ps(b1, x, z2));
+            z2 = _mm256_fnmadd_ps(a2, y, _mm256_mul_ps(b2, x));
+            _mm256_store_ps(&buffer[n*8], y);
+        }
+        _mm256_store_ps(&state[s*16], z1);
+        _mm256_store_ps(&state[s*16+8], z2);
+    }
+    _mm256_zeroupper(); /* (avoids AVX-SSE transition penalties) */
+}
+#endif /* SAF_FILTERS_AVX2 */
+
+#ifdef SAF_FILTERS_SSE2
+/** SSE2 version of biQuadCascade_groupScalar(); nLanes=4 */
+static void biQuadCascade_groupSSE2
+(
+    const float* coeffs,
+    float* state,
+    int nSections,
+    float* buffer,
+    int nSamples
+)
+{
+    int s, n;
+    __m128 b0, b1, b2, a1, a2, z1, z2, x, y;
+    const float* c;
+
+    for(s=0; s<nSections; s++){
+        c = &coeffs[s*BIQUADCASCADE_NUM_COEFFS*4];
+        b0 = _mm_load_ps(&c[0]);
+        b1 = _mm_load_ps(&c[4]);
+        b2 = _mm_load_ps(&c[8]);
+        a1 = _mm_load_ps(&c[12]);
+        a2 = _mm_load_ps(&c[16]);
+        z1 = _mm_load_ps(&state[s*8]);
+        z2 = _mm_load_ps(&state[s*8+4]);
+        for(n=0; n<nSamples; n++){
+            x = _mm_load_ps(&buffer[n*4]);
+            y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+            z1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b1, x), z2), _mm_mul_ps(a1, y));
+            z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+            _mm_store_ps(&buffer[n*4], y);
+        }
+        _mm_store_ps(&state[s*8], z1);
+        _mm_store_ps(&state[s*8+4], z2);
+    }
+}
+#endif /* SAF_FILTERS_SSE2 */
+
+#ifdef SAF_FILTERS_NEON
+/** NEON version of biQuadCascade_groupScalar(); nLanes=4 */
+static void biQuadCascade_groupNEON
+(
+    const float* coeffs,
+    float* state,
+    int nSections,
+    float* buffer,
+    int nSamples
+)
+{
+    int s, n;
+    float32x4_t b0, b1, b2, a1, a2, z1, z2, x, y;
+    const float* c;
+
+    for(s=0; s<nSections; s++){
+        c = &coeffs[s*BIQUADCASCADE_NUM_COEFFS*4];
+        b0 = vld1q_f32(&c[0]);
+        b1 = vld1q_f32(&c[4]);
+        b2 = vld1q_f32(&c[8]);
+        a1 = vld1q_f32(&c[12]);
+        a2 = vld1q_f32(&c[16]);
+        z1 = vld1q_f32(&state[s*8]);
+        z2 = vld1q_f32(&state[s*8+4]);
+        for(n=0; n<nSamples; n++){
+            x = vld1q_f32(&buffer[n*4]);
+            y = vmlaq_f32(z1, b0, x);
+            z1 = vmlsq_f32(vmlaq_f32(z2, b1, x), a1, y);
+            z2 = vmlsq_f32(vmulq_f32(b2, x), a2, y);
+            vst1q_f32(&buffer[n*4], y);
+        }
+        vst1q_f32(&state[s*8], z1);
+        vst1q_f32(&state[s*8+4], z2);
+    }
+}
+#endif /* SAF_FILTERS_NEON */
+
+void biQuadCascade_create
+(
+    void ** const phBQ,
+    int nChannels,
+    int nSections
+)
+{
+    biQuadCascade_data *h;
+    size_t nCoeffs, nStates;
+    int g, s, l;
+
+    h = (biQuadCascade_data*)malloc1d(sizeof(biQuadCascade_data));
+    *phBQ = (void*)h;
+    h->nChannels = MAX(nChannels, 1);
+    h->nSections = MAX(nSections, 1);
+#ifdef SAF_FILTERS_AVX2
+    h->nLanes = utility_cpuHasAVX2() ? 8 : 4;
+#else
+    h->nLanes = 4;
+#endif
+    h->nGroups = (h->nChannels + h->nLanes - 1) / h->nLanes;
+
+    /* one allocation, aligned to 32 bytes (all of the parts are multiples of
+     * nLanes floats, so they are aligned too) */
+    nCoeffs = (size_t)h->nGroups*h->nSections*BIQUADCASCADE_NUM_COEFFS*h->nLanes;
+    nStates = (size_t)h->nGroups*h->nSections*2*h->nLanes;
+    h->mem = malloc1d((nCoeffs + nStates + BIQUADCASCADE_BLOCK_SIZE*h->nLanes)*sizeof(float) + 32);
+    h->coeffs = (float*)(((size_t)h->mem + 31) & ~(size_t)31);
+    h->state = &(h->coeffs[nCoeffs]);
+    h->buffer = &(h->state[nStates]);
+
+    /* pass-through */
+    memset(h->coeffs, 0, nCoeffs*sizeof(float));
+    for(g=0; g<h->nGroups; g++)
+        for(s=0; s<h->nSections; s++)
+            for(l=0; l<h->nLanes; l++)
+                h->coeffs[(g*h->nSections+s)*BIQUADCASCADE_NUM_COEFFS*h->nLanes + l] = 1.0f;
+    biQuadCascade_reset(*phBQ);
+}
+
+void biQuadCascade_destroy
+(
+    void ** const phBQ
+)
+{
+    biQuadCascade_data *h = (biQuadCascade_data*)(*phBQ);
+
+    if(h!=NULL){
+        free(h->mem);
+        free(h);
+        *phBQ = NULL;
+    }
+}
+
+void biQuadCascade_setCoeffs
+(
+    void * const hBQ,
+    int channel,
+    int section,
+    float b[3],
+    float a[3]
+)
+{
+    biQuadCascade_data *h = (biQuadCascade_data*)(hBQ);
+    int ch, first, last;
+    float coeffs[BIQUADCASCADE_NUM_COEFFS];
+    float* c;
+
+    assert(section>=0 && section<h->nSections && channel<h->nChannels);
+
+    /* normalised, such that a[0]=1 */
+    coeffs[0] = b[0]/a[0];
+    coeffs[1] = b[1]/a[0];
+    coeffs[2] = b[2]/a[0];
+    coeffs[3] = a[1]/a[0];
+    coeffs[4] = a[2]/a[0];
+    first = channel < 0 ? 0 : channel;
+    last = channel < 0 ? h->nChannels : channel+1;
+    for(ch=first; ch<last; ch++){
+        c = &(h->coeffs[((ch/h->nLanes)*h->nSections+section)*BIQUADCASCADE_NUM_COEFFS*h->nLanes + ch%h->nLanes]);
+        c[0*h->nLanes] = coeffs[0];
+        c[1*h->nLanes] = coeffs[1];
+        c[2*h->nLanes] = coeffs[2];
+        c[3*h->nLanes] = coeffs[3];
+        c[4*h->nLanes] = coeffs[4];
+    }
+}
+
+void biQuadCascade_reset
+(
+    void * const hBQ
+)
+{
+    biQuadCascade_data *h = (biQuadCascade_data*)(hBQ);
+    memset(h->state, 0, (size_t)h->nGroups*h->nSections*2*h->nLanes*sizeof(float));
+}
+
+void biQuadCascade_apply
+(
+    void * const hBQ,
+    float ** signals,
+    int nChannels,
+    int nSamples
+)
+{
+    biQuadCascade_data *h = (biQuadCascade_data*)(hBQ);
+    int g, l, n, t, ch0, nLanesInUse, blockSize, nLanes;
+    const float* coeffs;
+    float* state;
+
+    nLanes = h->nLanes;
+    nChannels = MIN(nChannels, h->nChannels);
+    for(g=0; g<nChannels; g+=nLanes){
+        ch0 = g;
+        nLanesInUse = MIN(nLanes, nChannels-ch0);
+        coeffs = &(h->coeffs[(g/nLanes)*h->nSections*BIQUADCASCADE_NUM_COEFFS*nLanes]);
+        state = &(h->state[(g/nLanes)*h->nSections*2*nLanes]);
+        if(nLanesInUse<nLanes)
+            memset(h->buffer, 0, BIQUADCASCADE_BLOCK_SIZE*nLanes*sizeof(float)); /* (unused lanes) */
+        for(t=0; t<nSamples; t+=BIQUADCASCADE_BLOCK_SIZE){
+            blockSize = MIN(BIQUADCASCADE_BLOCK_SIZE, nSamples-t);
+
+            /* interleave this block of the group's channels */
+            for(l=0; l<nLanesInUse; l++)
+                for(n=0; n<blockSize; n++)
+                    h->buffer[n*nLanes+l] = signals[ch0+l][t+n];
+
+            /* apply all sections */
+#if defined(SAF_FILTERS_AVX2)
+            if(nLanes==8)
+                biQuadCascade_groupAVX2(coeffs, state, h->nSections, h->buffer, blockSize);
+            else
+                biQuadCascade_groupSSE2(coeffs, state, h->nSections, h->buffer, blockSize);
+#elif defined(SAF_FILTERS_SSE2)
+            biQuadCascade_groupSSE2(coeffs, state, h->nSections, h->buffer, blockSize);
+#elif defined(SAF_FILTERS_NEON)
+            biQuadCascade_groupNEON(coeffs, state, h->nSections, h->buffer, blockSize);
+#else
+            biQuadCascade_groupScalar(coeffs, state, h->nSections, nLanes, h->buffer, blockSize);
+#endif
+
+            /* and de-interleave */
+            for(l=0; l<nLanesInUse; l++)
+                for(n=0; n<blockSize; n++)
+                    signals[ch0+l][t+n] = h->buffer[n*nLanes+l];
+        }
+    }
+}
+
+/* ========================================================================== */
+/*                          IIR Filterbank Functions                          */
+/* ========================================================================== */
+
+/**
+ * Data structure for the IIR filterbank. For each crossover 'k', there is one
+ * low-pass and one high-pass cascade (2 sections each), and one cascade of the
+ * all-pass responses of crossovers k+1..nCutoffFreqs-1 for the k-th band.
+ */
+typedef struct _IIRFilterbank_data {
+    int nChannels, nCutoffFreqs;
+    void** hLPF;  /**< low-pass cascades; nCutoffFreqs x 1 */
+    void** hHPF;  /**< high-pass cascades; nCutoffFreqs x 1 */
+    void** hAPF;  /**< all-pass cascades (NULL for the last crossover); nCutoffFreqs x 1 */
+
+}IIRFilterbank_data;
+
+void IIRFilterbank_create
+(
+    void ** const phFB,
+    int nChannels,
+    float* fc,
+    int nCutoffFreqs,
+    float sampleRate
+)
+{
+    IIRFilterbank_data *h;
+    int k;
+
+    assert(nCutoffFreqs>=1);
+    h = (IIRFilterbank_data*)malloc1d(sizeof(IIRFilterbank_data));
+    *phFB = (void*)h;
+    h->nChannels = nChannels;
+    h->nCutoffFreqs = nCutoffFreqs;
+    h->hLPF = (void**)malloc1d(nCutoffFreqs*sizeof(void*));
+    h->hHPF = (void**)malloc1d(nCutoffFreqs*sizeof(void*));
+    h->hAPF = (void**)malloc1d(nCutoffFreqs*sizeof(void*));
+    for(k=0; k<nCutoffFreqs; k++){
+        biQuadCascade_create(&(h->hLPF[k]), nChannels, 2);
+        biQuadCascade_create(&(h->hHPF[k]), nChannels, 2);
+        h->hAPF[k] = NULL;
+        if(k<nCutoffFreqs-1)
+            biQuadCascade_create(&(h->hAPF[k]), nChannels, nCutoffFreqs-1-k);
+    }
+    IIRFilterbank_setCutoffFreqs(*phFB, fc, sampleRate);
+}
+
+void IIRFilterbank_destroy
+(
+    void ** const phFB
+)
+{
+    IIRFilterbank_data *h = (IIRFilterbank_data*)(*phFB);
+    int k;
+
+    if(h!=NULL){
+        for(k=0; k<h->nCutoffFreqs; k++){
+            biQuadCascade_destroy(&(h->hLPF[k]));
+            biQuadCascade_destroy(&(h->hHPF[k]));
+            biQuadCascade_destroy(&(h->hAPF[k]));
+        }
+        free(h->hLPF);
+        free(h->hHPF);
+        free(h->hAPF);
+        free(h);
+        *phFB = NULL;
+    }
+}
+
+void IIRFilterbank_setCutoffFreqs
+(
+    void * const hFB,
+    float* fc,
+    float sampleRate
+)
+{
+    IIRFilterbank_data *h = (IIRFilterbank_data*)(hFB);
+    int k, j, s;
+    float b[3], a[3], b_ap[3];
+
+    for(k=0; k<h->nCutoffFreqs; k++){
+        /* Linkwitz-Riley: two Butterworth sections */
+        biQuadCoeffs(BIQUAD_FILTER_LPF, fc[k], sampleRate, 0.7071f, 0.0f, b, a);
+        for(s=0; s<2; s++)
+            biQuadCascade_setCoeffs(h->hLPF[k], -1, s, b, a);
+        biQuadCoeffs(BIQUAD_FILTER_HPF, fc[k], sampleRate, 0.7071f, 0.0f, b, a);
+        for(s=0; s<2; s++)
+            biQuadCascade_setCoeffs(h->hHPF[k], -1, s, b, a);
+
+        /* the sum of the low-pass and high-pass outputs is the 2nd order
+         * all-pass response, which shares the Butterworth poles */
+        b_ap[0] = a[2];
+        b_ap[1] = a[1];
+        b_ap[2] = a[0];
+        for(j=0; j<k; j++)
+            biQuadCascade_setCoeffs(h->hAPF[j], -1, k-1-j, b_ap, a);
+    }
+}
+
+void IIRFilterbank_reset
+(
+    void * const hFB
+)
+{
+    IIRFilterbank_data *h = (IIRFilterbank_data*)(hFB);
+    int k;
+
+    for(k=0; k<h->nCutoffFreqs; k++){
+        biQuadCascade_reset(h->hLPF[k]);
+        biQuadCascade_reset(h->hHPF[k]);
+        if(h->hAPF[k]!=NULL)
+            biQuadCascade_reset(h->hAPF[k]);
+    }
+}
+
+void IIRFilterbank_apply
+(
+    void * const hFB,
+    float ** inSigs,
+    float *** outBands,
+    int nChannels,
+    int nSamples
+)
+{
+    IIRFilterbank_data *h = (IIRFilterbank_data*)(hFB);
+    int k, ch, K;
+    float** hiSigs;
+
+    K = h->nCutoffFreqs;
+    nChannels = MIN(nChannels, h->nChannels);
+
+    /* the last band holds the high-passed remainder as it travels up the tree */
+    hiSigs = outBands[K];
+    for(ch=0; ch<nChannels; ch++)
+        memcpy(hiSigs[ch], inSigs[ch], nSamples*sizeof(float));
+    for(k=0; k<K; k++){
+        for(ch=0; ch<nChannels; ch++)
+            if(outBands[k][ch]!=(k==0 ? inSigs[ch] : hiSigs[ch]))
+                memcpy(outBands[k][ch], k==0 ? inSigs[ch] : hiSigs[ch], nSamples*sizeof(float));
+        biQuadCascade_apply(h->hLPF[k], outBands[k], nChannels, nSamples);
+        if(h->hAPF[k]!=NULL)
+            biQuadCascade_apply(h->hAPF[k], outBands[k], nChannels, nSamples);
+        biQuadCascade_apply(h->hHPF[k], hiSigs, nChannels, nSamples);
+    }
+}
+
+/** Computes the (unwindowed) weights of a FIR filter; see FIRCoeffs() */
+static void FIRCoeffs_unwindowed
 (
     FIR_FILTER_TYPES filterType,
     int order,
     float fc1,
     float fc2, /* only needed for band-pass/stop */
     float fs,
-    WINDOWING_FUNCTION_TYPES windowType,
-    int scalingFLAG,
     float* h_filt
 )
 {
     int i, h_len;
-    float ft1, ft2, h_sum, f0;
-    float_complex h_z_sum;
+    float ft1, ft2;
     
     h_len = order + 1;
     ft1 = fc1/(fs*2.0f);
@@ -404,46 +920,141 @@ void FIRCoeffs
     }
     else
         assert(0); /* please specify an even value for the filter 'order' argument */
+}
+
+/**
+ * Scales the (windowed) weights of a FIR filter, to ensure pass-band is truely
+ * at 1 (0dB): [1] "Programs for Digital Signal Processing", IEEE Press John
+ * Wiley & Sons, 1979, pg. 5.2-1.
+ */
+static void FIRCoeffs_scale
+(
+    FIR_FILTER_TYPES filterType,
+    int order,
+    float fc1,
+    float fc2,
+    float fs,
+    float* h_filt
+)
+{
+    int i, h_len;
+    float h_sum, f0;
+    float_complex h_z_sum;
+    
+    h_len = order + 1;
+    switch(filterType){
+        case FIR_FILTER_LPF:
+        case FIR_FILTER_BSF:
+            h_sum = 0.0f;
+            for(i=0; i<h_len; i++)
+                h_sum += h_filt[i];
+            for(i=0; i<h_len; i++)
+                h_filt[i] /= h_sum;
+            break;
+            
+        case FIR_FILTER_HPF:
+            f0 = 1.0f;
+            h_z_sum = cmplxf(0.0f, 0.0f);
+            for(i=0; i<h_len; i++)
+                h_z_sum = ccaddf(h_z_sum, crmulf(cexpf(cmplxf(0.0f, -2.0f*M_PI*(float)i*f0/2.0f)), h_filt[i]));
+            h_sum = cabsf(h_z_sum);
+            for(i=0; i<h_len; i++)
+                h_filt[i] /= h_sum;
+            break;
+            
+        case FIR_FILTER_BPF:
+            f0 = (fc1/fs+fc2/fs)/2.0f;
+            h_z_sum = cmplxf(0.0f, 0.0f);
+            for(i=0; i<h_len; i++)
+                h_z_sum = ccaddf(h_z_sum, crmulf(cexpf(cmplxf(0.0f, -2.0f*M_PI*(float)i*f0/2.0f)), h_filt[i]));
+            h_sum = cabsf(h_z_sum);
+            for(i=0; i<h_len; i++)
+                h_filt[i] /= h_sum;
+            break;
+    }
+}
+
+void FIRCoeffs
+(
+    FIR_FILTER_TYPES filterType,
+    int order,
+    float fc1,
+    float fc2, /* only needed for band-pass/stop */
+    float fs,
+    WINDOWING_FUNCTION_TYPES windowType,
+    int scalingFLAG,
+    float* h_filt
+)
+{
+    FIRCoeffs_unwindowed(filterType, order, fc1, fc2, fs, h_filt);
     
     /* Apply windowing function */
-    applyWindowingFunction(windowType, h_len, h_filt);
+    applyWindowingFunction(windowType, order+1, h_filt);
     
-    /* Scaling, to ensure pass-band is truely at 1 (0dB).
-     * [1] "Programs for Digital Signal Processing", IEEE Press John Wiley &
-     *     Sons, 1979, pg. 5.2-1.
-     */
-    if(scalingFLAG){ 
-        switch(filterType){
-            case FIR_FILTER_LPF:
-            case FIR_FILTER_BSF:
-                h_sum = 0.0f;
-                for(i=0; i<h_len; i++)
-                    h_sum += h_filt[i];
-                for(i=0; i<h_len; i++)
-                    h_filt[i] /= h_sum;
-                break;
-                
-            case FIR_FILTER_HPF:
-                f0 = 1.0f;
-                h_z_sum = cmplxf(0.0f, 0.0f);
-                for(i=0; i<h_len; i++)
-                    h_z_sum = ccaddf(h_z_sum, crmulf(cexpf(cmplxf(0.0f, -2.0f*M_PI*(float)i*f0/2.0f)), h_filt[i]));
-                h_sum = cabsf(h_z_sum);
-                for(i=0; i<h_len; i++)
-                    h_filt[i] /= h_sum;
-                break;
-                
-            case FIR_FILTER_BPF:
-                f0 = (fc1/fs+fc2/fs)/2.0f;
-                h_z_sum = cmplxf(0.0f, 0.0f);
-                for(i=0; i<h_len; i++)
-                    h_z_sum = ccaddf(h_z_sum, crmulf(cexpf(cmplxf(0.0f, -2.0f*M_PI*(float)i*f0/2.0f)), h_filt[i]));
-                h_sum = cabsf(h_z_sum);
-                for(i=0; i<h_len; i++)
-                    h_filt[i] /= h_sum;
-                break;
-        }
+    /* Scaling, to ensure pass-band is truely at 1 (0dB) */
+    if(scalingFLAG)
+        FIRCoeffs_scale(filterType, order, fc1, fc2, fs, h_filt);
+}
+
+void FIRCoeffsBatch
+(
+    int nFilters,
+    FIR_FILTER_TYPES* filterTypes,
+    int order,
+    float* fc1,
+    float* fc2,
+    float fs,
+    WINDOWING_FUNCTION_TYPES windowType,
+    int scalingFLAG,
+    float* filters
+)
+{
+    int k, i, h_len;
+    float* win, *h_filt;
+    
+    /* the window is the same for all of the filters */
+    h_len = order + 1;
+    win = malloc1d(h_len*sizeof(float));
+    getWindowingFunction(windowType, h_len, win);
+    for(k=0; k<nFilters; k++){
+        h_filt = &filters[k*h_len];
+        FIRCoeffs_unwindowed(filterTypes[k], order, fc1[k], fc2==NULL ? 0.0f : fc2[k], fs, h_filt);
+        for(i=0; i<h_len; i++)
+            h_filt[i] *= win[i];
+        if(scalingFLAG)
+            FIRCoeffs_scale(filterTypes[k], order, fc1[k], fc2==NULL ? 0.0f : fc2[k], fs, h_filt);
+    }
+    free(win);
+}
+
+/**
+ * Returns the type and cutoff frequencies of each band of FIRFilterbank():
+ * the first and last bands are low-pass and high pass filters, using the first
+ * and last cut-off frequencies in vector 'fc', respectively; and the
+ * inbetween bands are then band-pass filters
+ */
+static void FIRFilterbank_getBands
+(
+    float* fc,
+    int nCutoffFreq,
+    FIR_FILTER_TYPES* types, /* (nCutoffFreq+1) x 1 */
+    float* fc1,              /* (nCutoffFreq+1) x 1 */
+    float* fc2               /* (nCutoffFreq+1) x 1 */
+)
+{
+    int k;
+    
+    types[0] = FIR_FILTER_LPF;
+    fc1[0] = fc[0];
+    fc2[0] = 0.0f;
+    for(k=1; k<nCutoffFreq; k++){
+        types[k] = FIR_FILTER_BPF;
+        fc1[k] = fc[k-1];
+        fc2[k] = fc[k];
     }
+    types[nCutoffFreq] = FIR_FILTER_HPF;
+    fc1[nCutoffFreq] = fc[nCutoffFreq-1];
+    fc2[nCutoffFreq] = 0.0f;
 }
 
 void FIRFilterbank
@@ -457,19 +1068,217 @@ void FIRFilterbank
     float* filterbank /* (nCutoffFreq+1) x (order+1) */
 )
 {
-    int k, nFilt;
+    int nFilt;
+    FIR_FILTER_TYPES* types;
+    float* fc1, *fc2;
     
     /* Number of filters returned is always one more than the number of cut-off frequencies */
     nFilt = nCutoffFreq + 1;
+    types = malloc1d(nFilt*sizeof(FIR_FILTER_TYPES));
+    fc1 = malloc1d(nFilt*sizeof(float));
+    fc2 = malloc1d(nFilt*sizeof(float));
+    FIRFilterbank_getBands(fc, nCutoffFreq, types, fc1, fc2);
+    FIRCoeffsBatch(nFilt, types, order, fc1, fc2, sampleRate, windowType, scalingFLAG, filterbank);
+    free(types);
+    free(fc1);
+    free(fc2);
+}
+
+
+/* ========================================================================== */
+/*                              FIR Design Cache                              */
+/* ========================================================================== */
+
+/**
+ * An entry of the FIR design cache; keyed by the filter type, order, cutoff
+ * frequencies, sampling rate, windowing function and scaling
+ */
+typedef struct _firDesignCache_entry {
+    int filterType, order, windowType, scalingFLAG;
+    float fc1, fc2, fs;                 /**< fc2 is 0 for low/high-pass filters */
+    float* h_filt;                      /**< (order+1) x 1 */
+    struct _firDesignCache_entry* next;
+}firDesignCache_entry;
+
+/* Most recently used first */
+static firDesignCache_entry* firDesignCache_head = NULL;
+#if defined(_WIN32)
+static SRWLOCK firDesignCache_lock = SRWLOCK_INIT;
+# define FIR_DESIGN_CACHE_LOCK()   AcquireSRWLockExclusive(&firDesignCache_lock)
+# define FIR_DESIGN_CACHE_UNLOCK() ReleaseSRWLockExclusive(&firDesignCache_lock)
+#else
+static pthread_mutex_t firDesignCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define FIR_DESIGN_CACHE_LOCK()   pthread_mutex_lock(&firDesignCache_lock)
+# define FIR_DESIGN_CACHE_UNLOCK() pthread_mutex_unlock(&firDesignCache_lock)
+#endif
+
+/** Frees an entry of the FIR design cache */
+static void firDesignCache_freeEntry
+(
+    firDesignCache_entry* e
+)
+{
+    free(e->h_filt);
+    free(e);
+}
+
+/**
+ * Copies the designs of a batch of FIR filters out of the cache; the missing
+ * ones are designed together with FIRCoeffsBatch(), and then added to the
+ * cache (the lock is held while designing)
+ */
+static void FIRCoeffsBatchCached
+(
+    int nFilters,
+    FIR_FILTER_TYPES* filterTypes,
+    int order,
+    float* fc1,
+    float* fc2,
+    float fs,
+    WINDOWING_FUNCTION_TYPES windowType,
+    int scalingFLAG,
+    float* filters
+)
+{
+    firDesignCache_entry* e, *tail, **prev;
+    int k, n, nMiss, h_len;
+    int* missIdx;
+    FIR_FILTER_TYPES* missTypes;
+    float* missFc1, *missFc2, *missFilters;
+    float key_fc2;
     
-    /* first and last bands are low-pass and high pass filters, using the first
-     * and last cut-off frequencies in vector 'fc', respectively.  */
-    FIRCoeffs(FIR_FILTER_LPF, order, fc[0], 0.0f, sampleRate, windowType, scalingFLAG, filterbank);
-    FIRCoeffs(FIR_FILTER_HPF, order, fc[nCutoffFreq-1], 0.0f, sampleRate, windowType, scalingFLAG, &filterbank[(nFilt-1)*(order+1)]);
+    h_len = order + 1;
+    missIdx = malloc1d(nFilters*sizeof(int));
+    missTypes = malloc1d(nFilters*sizeof(FIR_FILTER_TYPES));
+    missFc1 = malloc1d(nFilters*sizeof(float));
+    missFc2 = malloc1d(nFilters*sizeof(float));
+    nMiss = 0;
+    FIR_DESIGN_CACHE_LOCK();
+    for(k=0; k<nFilters; k++){
+        key_fc2 = filterTypes[k]==FIR_FILTER_BPF || filterTypes[k]==FIR_FILTER_BSF ? fc2[k] : 0.0f;
+        for(prev = &firDesignCache_head, e = firDesignCache_head; e!=NULL; prev = &(e->next), e = e->next){
+            if(e->filterType==(int)filterTypes[k] && e->order==order && e->fc1==fc1[k] && e->fc2==key_fc2 &&
+               e->fs==fs && e->windowType==(int)windowType && e->scalingFLAG==scalingFLAG){
+                /* move to the front */
+                *prev = e->next;
+                e->next = firDesignCache_head;
+                firDesignCache_head = e;
+                memcpy(&filters[k*h_len], e->h_filt, h_len*sizeof(float));
+                break;
+            }
+        }
+        if(e==NULL){
+            missIdx[nMiss] = k;
+            missTypes[nMiss] = filterTypes[k];
+            missFc1[nMiss] = fc1[k];
+            missFc2[nMiss] = key_fc2;
+            nMiss++;
+        }
+    }
     
-    /* the inbetween bands are then band-pass filters: */
-    if(nCutoffFreq>1){
-        for(k=1; k<nFilt-1; k++)
-            FIRCoeffs(FIR_FILTER_BPF, order, fc[k-1], fc[k], sampleRate, windowType, scalingFLAG, &filterbank[k*(order+1)]);
+    /* design the filters which are not cached yet */
+    if(nMiss>0){
+        missFilters = malloc1d(nMiss*h_len*sizeof(float));
+        FIRCoeffsBatch(nMiss, missTypes, order, missFc1, missFc2, fs, windowType, scalingFLAG, missFilters);
+        for(k=0; k<nMiss; k++){
+            memcpy(&filters[missIdx[k]*h_len], &missFilters[k*h_len], h_len*sizeof(float));
+            e = (firDesignCache_entry*)malloc1d(sizeof(firDesignCache_entry));
+            e->filterType = (int)missTypes[k];
+            e->order = order;
+            e->fc1 = missFc1[k];
+            e->fc2 = missFc2[k];
+            e->fs = fs;
+            e->windowType = (int)windowType;
+            e->scalingFLAG = scalingFLAG;
+            e->h_filt = malloc1d(h_len*sizeof(float));
+            memcpy(e->h_filt, &missFilters[k*h_len], h_len*sizeof(float));
+            e->next = firDesignCache_head;
+            firDesignCache_head = e;
+        }
+        free(missFilters);
+        
+        /* discard the least recently used designs */
+        for(n=1, e = firDesignCache_head; e!=NULL && n<FIR_DESIGN_CACHE_MAX_ENTRIES; n++)
+            e = e->next;
+        if(e!=NULL){
+            tail = e->next;
+            e->next = NULL;
+            while(tail!=NULL){
+                e = tail;
+                tail = tail->next;
+                firDesignCache_freeEntry(e);
+            }
+        }
+    }
+    FIR_DESIGN_CACHE_UNLOCK();
+    free(missIdx);
+    free(missTypes);
+    free(missFc1);
+    free(missFc2);
+}
+
+void FIRCoeffsCached
+(
+    FIR_FILTER_TYPES filterType,
+    int order,
+    float fc1,
+    float fc2,
+    float fs,
+    WINDOWING_FUNCTION_TYPES windowType,
+    int scalingFLAG,
+    float* h_filt
+)
+{
+    FIRCoeffsBatchCached(1, &filterType, order, &fc1, &fc2, fs, windowType, scalingFLAG, h_filt);
+}
+
+void FIRFilterbankCached
+(
+    int order,
+    float* fc,
+    int nCutoffFreq,
+    float sampleRate,
+    WINDOWING_FUNCTION_TYPES windowType,
+    int scalingFLAG,
+    float* filterbank
+)
+{
+    int nFilt;
+    FIR_FILTER_TYPES* types;
+    float* fc1, *fc2;
+    
+    nFilt = nCutoffFreq + 1;
+    types = malloc1d(nFilt*sizeof(FIR_FILTER_TYPES));
+    fc1 = malloc1d(nFilt*sizeof(float));
+    fc2 = malloc1d(nFilt*sizeof(float));
+    FIRFilterbank_getBands(fc, nCutoffFreq, types, fc1, fc2);
+    FIRCoeffsBatchCached(nFilt, types, order, fc1, fc2, sampleRate, windowType, scalingFLAG, filterbank);
+    free(types);
+    free(fc1);
+    free(fc2);
+}
+
+void firDesignCache_clear(void)
+{
+    firDesignCache_entry* e;
+    
+    FIR_DESIGN_CACHE_LOCK();
+    while(firDesignCache_head!=NULL){
+        e = firDesignCache_head;
+        firDesignCache_head = e->next;
+        firDesignCache_freeEntry(e);
     }
+    FIR_DESIGN_CACHE_UNLOCK();
+}
+
+int firDesignCache_getNumEntries(void)
+{
+    firDesignCache_entry* e;
+    int n;
+    
+    FIR_DESIGN_CACHE_LOCK();
+    for(n=0, e = firDesignCache_head; e!=NULL; e = e->next)
+        n++;
+    FIR_DESIGN_CACHE_UNLOCK();
+    return n;
 }
@@ -149,6 +149,19 @@ void getOctaveBandCutoffFreqs(float* centreFreqs,
 void flattenMinphase(float* x,
                      int len);
 
+/**
+ * Equalises a batch of sequences of the same length by their minimum phase
+ * forms (as flattenMinphase()); with one FFT instance and one set of scratch
+ * buffers shared by all of the sequences
+ *
+ * @param[in,out] x   Inputs; FLAT: nCH x len
+ * @param[in]     len Length of each input (even or odd)
+ * @param[in]     nCH Number of inputs
+ */
+void flattenMinphaseBatch(float* x,
+                          int len,
+                          int nCH);
+
 
 /* ========================================================================== */
 /*                              Bi-Quad Functions                             */
@@ -222,6 +235,177 @@ void evalBiQuadTransferFunction(/* Input arguments */
                                 float* phase_rad);
 
 
+/* ========================================================================== */
+/*                           Bi-Quad Cascade Functions                        */
+/* ========================================================================== */
+
+/**
+ * Creates an instance of a multi-channel bi-quad cascade; where each channel
+ * is filtered by its own chain of 'nSections' 2nd order IIR filters (in series)
+ *
+ * The sections are realised using the transposed direct form II difference
+ * equation (which is numerically better behaved than applyBiQuadFilter() for
+ * low cutoff frequencies). The channels are processed in groups of 4 (SSE2,
+ * NEON) or 8 (AVX2, if supported by the CPU), with one channel per SIMD lane;
+ * so this is considerably faster than calling applyBiQuadFilter() for each
+ * channel and section, when there are many channels.
+ *
+ * @note All sections are initialised as pass-through (b=[1 0 0], a=[1 0 0]),
+ *       and the filter states as 0s.
+ *
+ * @param[in] phBQ      (&) address of biQuadCascade handle
+ * @param[in] nChannels Maximum number of channels
+ * @param[in] nSections Number of sections per channel
+ */
+void biQuadCascade_create(/* Input arguments */
+                          void ** const phBQ,
+                          int nChannels,
+                          int nSections);
+
+/**
+ * Destroys an instance of the bi-quad cascade
+ *
+ * @param[in] phBQ (&) address of biQuadCascade handle
+ */
+void biQuadCascade_destroy(/* Input arguments */
+                           void ** const phBQ);
+
+/**
+ * Sets the filter coefficients of one section (e.g. as designed using
+ * biQuadCoeffs()), for one or all channels
+ *
+ * @note The filter states are retained, so the coefficients may be changed
+ *       while processing (e.g. when the user moves an EQ control).
+ *
+ * @param[in] hBQ     biQuadCascade handle
+ * @param[in] channel Channel index (0..nChannels-1), or -1 for all channels
+ * @param[in] section Section index (0..nSections-1)
+ * @param[in] b       b filter coefficients; 3 x 1
+ * @param[in] a       a filter coefficients; 3 x 1
+ */
+void biQuadCascade_setCoeffs(/* Input arguments */
+                             void * const hBQ,
+                             int channel,
+                             int section,
+                             float b[3],
+                             float a[3]);
+
+/**
+ * Sets all filter states to 0s
+ *
+ * @param[in] hBQ biQuadCascade handle
+ */
+void biQuadCascade_reset(/* Input arguments */
+                         void * const hBQ);
+
+/**
+ * Applies the bi-quad cascade to the first 'nChannels' channels
+ *
+ * @note input 'signals' are filtered in place (i.e. they become the output
+ *       signals)
+ *
+ * @param[in]     hBQ       biQuadCascade handle
+ * @param[in,out] signals   Signals to be filtered/filtered signals;
+ *                          nChannels x nSamples
+ * @param[in]     nChannels Number of channels (at most the number given to
+ *                          biQuadCascade_create())
+ * @param[in]     nSamples  Number of samples per channel
+ */
+void biQuadCascade_apply(/* Input arguments */
+                         void * const hBQ,
+                         float ** signals,
+                         int nChannels,
+                         int nSamples);
+
+
+/* ========================================================================== */
+/*                          IIR Filterbank Functions                          */
+/* ========================================================================== */
+
+/**
+ * Creates an instance of a multi-channel IIR filterbank, which divides the
+ * signals into (nCutoffFreqs+1) frequency bands with minimal latency; e.g. as
+ * a low-latency alternative to the afSTFT, for applying per-band gains
+ *
+ * The bands are the outputs of a tree of 4th order Linkwitz-Riley crossovers
+ * (each being two cascaded 2nd order Butterworth sections); where each band is
+ * also passed through the all-pass responses of the higher crossovers, such
+ * that the sum of all bands is an all-pass response (i.e. the reconstruction is
+ * perfect in magnitude). e.g. fc[2] = { 500, 2000 }:
+ *  - Band1: LPF @ 500Hz, then AP @ 2kHz
+ *  - Band2: HPF @ 500Hz, then LPF @ 2kHz
+ *  - Band3: HPF @ 500Hz, then HPF @ 2kHz
+ *
+ * The filters are applied using biQuadCascade_apply().
+ *
+ * @param[in] phFB         (&) address of IIRFilterbank handle
+ * @param[in] nChannels    Maximum number of channels
+ * @param[in] fc           Cutoff frequencies, in ascending order, Hz;
+ *                         nCutoffFreqs x 1
+ * @param[in] nCutoffFreqs Number of cutoff frequencies
+ * @param[in] sampleRate   Sampling rate, Hz
+ */
+void IIRFilterbank_create(/* Input arguments */
+                          void ** const phFB,
+                          int nChannels,
+                          float* fc,
+                          int nCutoffFreqs,
+                          float sampleRate);
+
+/**
+ * Destroys an instance of the IIR filterbank
+ *
+ * @param[in] phFB (&) address of IIRFilterbank handle
+ */
+void IIRFilterbank_destroy(/* Input arguments */
+                           void ** const phFB);
+
+/**
+ * Re-designs the IIR filterbank for new cutoff frequencies and/or a new
+ * sampling rate (the number of cutoff frequencies must stay the same)
+ *
+ * @note The filter states are retained.
+ *
+ * @param[in] hFB        IIRFilterbank handle
+ * @param[in] fc         Cutoff frequencies, in ascending order, Hz;
+ *                       nCutoffFreqs x 1
+ * @param[in] sampleRate Sampling rate, Hz
+ */
+void IIRFilterbank_setCutoffFreqs(/* Input arguments */
+                                  void * const hFB,
+                                  float* fc,
+                                  float sampleRate);
+
+/**
+ * Sets all filter states to 0s
+ *
+ * @param[in] hFB IIRFilterbank handle
+ */
+void IIRFilterbank_reset(/* Input arguments */
+                         void * const hFB);
+
+/**
+ * Divides the first 'nChannels' input signals into frequency bands
+ *
+ * @note 'inSigs' may be the same as outBands[0] (i.e. the first band may be
+ *       computed in place), but must not be the same as any of the other bands.
+ *
+ * @param[in]  hFB       IIRFilterbank handle
+ * @param[in]  inSigs    Input signals; nChannels x nSamples
+ * @param[out] outBands  Band signals; (nCutoffFreqs+1) x nChannels x nSamples
+ * @param[in]  nChannels Number of channels (at most the number given to
+ *                       IIRFilterbank_create())
+ * @param[in]  nSamples  Number of samples per channel
+ */
+void IIRFilterbank_apply(/* Input arguments */
+                         void * const hFB,
+                         float ** inSigs,
+                         /* Output arguments */
+                         float *** outBands,
+                         int nChannels,
+                         int nSamples);
+
+
 /* ========================================================================== */
 /*                            FIR Filter Functions                            */
 /* ========================================================================== */
@@ -311,6 +495,111 @@ void FIRFilterbank(/* Input arguments */
                    /* Output arguments */
                    float* filterbank);
 
+/**
+ * Computes the coefficients of a batch of FIR filters of the same order (as
+ * FIRCoeffs()), which share the same windowing function
+ *
+ * The windowing function is only computed once for all of the filters.
+ *
+ * @param[in]  nFilters    Number of filters
+ * @param[in]  filterTypes See 'FIR_FILTER_TYPES' enum; nFilters x 1
+ * @param[in]  order       Filter order (N). Must be even.
+ * @param[in]  cutoffs1    Filter cutoffs in Hz, for LPF/HPF, and lower cutoffs
+ *                         for BPF/BSF; nFilters x 1
+ * @param[in]  cutoffs2    Upper cutoffs in Hz for BPF/BSF (ignored for
+ *                         LPF/HPF); nFilters x 1, or NULL if there are only
+ *                         low/high-pass filters
+ * @param[in]  sampleRate  Sampling rate in Hz
+ * @param[in]  windowType  See 'WINDOWING_FUNCTION_TYPES' enum
+ * @param[in]  scalingFLAG '0' none, '1' scaling applied to ensure passbands
+ *                         are at 0dB
+ * @param[out] filters     Filter coefficients/weights/taps;
+ *                         FLAT: nFilters x (order+1)
+ */
+void FIRCoeffsBatch(/* Input arguments */
+                    int nFilters,
+                    FIR_FILTER_TYPES* filterTypes,
+                    int order,
+                    float* cutoffs1,
+                    float* cutoffs2,
+                    float sampleRate,
+                    WINDOWING_FUNCTION_TYPES windowType,
+                    int scalingFLAG,
+                    /* Output arguments */
+                    float* filters);
+
+/**
+ * Computes the coefficients of a FIR filter (as FIRCoeffs()); taken from a
+ * process-wide cache if the filter has already been designed with the same
+ * type, order, cutoff frequencies, sampling rate, window and scaling
+ *
+ * The least recently used designs are discarded once the cache holds
+ * FIR_DESIGN_CACHE_MAX_ENTRIES of them.
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       designs new filters; so do not call it from the audio thread.
+ *
+ * @param[in]  filterType  See 'FIR_FILTER_TYPES' enum
+ * @param[in]  order       Filter order (N). Must be even.
+ * @param[in]  cutoff1     Filter1 cutoff in Hz, for LPF/HPF, and lower cutoff
+ *                         for BPF/BSF
+ * @param[in]  cutoff2     Filter2 cutoff in Hz, not needed for LPF/HPF, this is
+ *                         the upper cutoff for BPF/BSF
+ * @param[in]  sampleRate  Sampling rate in Hz
+ * @param[in]  windowType  See 'WINDOWING_FUNCTION_TYPES' enum
+ * @param[in]  scalingFLAG '0' none, '1' scaling applied to ensure passband is
+ *                         at 0dB
+ * @param[out] filter      Filter coefficients/weights/taps; (order+1) x 1
+ */
+void FIRCoeffsCached(/* Input arguments */
+                     FIR_FILTER_TYPES filterType,
+                     int order,
+                     float cutoff1,
+                     float cutoff2,
+                     float sampleRate,
+                     WINDOWING_FUNCTION_TYPES windowType,
+                     int scalingFLAG,
+                     /* Output arguments */
+                     float* filter);
+
+/**
+ * Computes a bank of FIR filter coefficients (as FIRFilterbank()); with each
+ * band taken from the cache of FIRCoeffsCached(), and the bands which are not
+ * cached yet designed together with FIRCoeffsBatch()
+ *
+ * @note This function is thread-safe, but may block while another thread
+ *       designs new filters; so do not call it from the audio thread.
+ *
+ * @param[in]  order        Filter order. Must be even.
+ * @param[in]  fc           Vector of cutoff frequencies; nCutoffFreqs x 1
+ * @param[in]  nCutoffFreqs Number of cutoff frequencies in vector 'fc'.
+ * @param[in]  sampleRate   Sampling rate in Hz
+ * @param[in]  windowType   See 'WINDOWING_FUNCTION_TYPES' enum
+ * @param[in]  scalingFLAG  '0' none, '1' scaling applied to ensure passbands
+ *                          are at 0dB
+ * @param[out] filterbank   Filter coefficients/weights/taps;
+ *                          FLAT: (nCutoffFreqs+1) x (order+1)
+ */
+void FIRFilterbankCached(/* Input arguments */
+                         int order,
+                         float* fc,
+                         int nCutoffFreqs,
+                         float sampleRate,
+                         WINDOWING_FUNCTION_TYPES windowType,
+                         int scalingFLAG,
+                         /* Output arguments */
+                         float* filterbank);
+
+/** Maximum number of filter designs held by FIRCoeffsCached() and
+ *  FIRFilterbankCached() */
+#define FIR_DESIGN_CACHE_MAX_ENTRIES ( 64 )
+
+/** Frees all of the filter designs held by the cache */
+void firDesignCache_clear(void);
+
+/** Returns the number of filter designs currently cached */
+int firDesignCache_getNumEntries(void);
+
 
 #ifdef __cplusplus
 }/* extern "C" */
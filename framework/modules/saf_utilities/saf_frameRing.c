@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_frameRing.c
+ * @brief Lock-free, single-producer/single-consumer ring of time-stamped
+ *        frames, for handing e.g. activity-maps from the audio thread over to
+ *        a GUI thread
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_frameRing.h"
+#if defined(_WIN32)
+# include <windows.h>
+# define FRAMERING_ATOMIC_LOAD(p)    InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define FRAMERING_ATOMIC_STORE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+# define FRAMERING_ATOMIC_INC(p)     InterlockedIncrement((volatile LONG*)(p))
+#else
+# define FRAMERING_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define FRAMERING_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define FRAMERING_ATOMIC_INC(p)     __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#endif
+
+/**
+ * Data structure for the frame ring.
+ *
+ * Only two indices are shared: 'latest' (written by the producer) and
+ * 'reading' (written by the consumer). The producer never writes to either of
+ * these two slots; and the consumer, after announcing the slot it is about to
+ * read, checks that it is still the latest one (retrying otherwise). Since the
+ * producer checks 'reading' before it starts writing to a slot, a frame which
+ * passes this check cannot be overwritten while it is held.
+ */
+typedef struct _safFrameRing_data {
+    int nSlots, frameLength;
+    float** frames;               /**< nSlots x frameLength */
+    double* timestamps;           /**< nSlots x 1 */
+    volatile long latest;         /**< most recently published slot (-1: none) */
+    volatile long reading;        /**< slot held by the consumer (-1: none) */
+    volatile long nAcquired;      /**< incremented by the consumer for each acquired frame */
+
+    /* producer only */
+    int writing;                  /**< slot returned by saf_frameRing_beginWrite() */
+    long lastNAcquired;           /**< value of nAcquired at the last check */
+    double lastActiveTime;        /**< time at which nAcquired last changed */
+    int activeTimeValid;          /**< 0 until the first saf_frameRing_hasConsumer() call */
+    double consumerTimeout;
+
+}safFrameRing_data;
+
+void saf_frameRing_create
+(
+    void ** const phRing,
+    int nSlots,
+    int frameLength,
+    double consumerTimeout
+)
+{
+    safFrameRing_data* h;
+
+    h = (safFrameRing_data*)malloc1d(sizeof(safFrameRing_data));
+    *phRing = (void*)h;
+    h->nSlots = nSlots < 3 ? 3 : nSlots;
+    h->frameLength = frameLength;
+    h->frames = (float**)calloc2d(h->nSlots, frameLength, sizeof(float));
+    h->timestamps = (double*)calloc1d(h->nSlots, sizeof(double));
+    h->latest = -1;
+    h->reading = -1;
+    h->nAcquired = 0;
+    h->writing = -1;
+    h->lastNAcquired = 0;
+    h->lastActiveTime = 0.0;
+    h->activeTimeValid = 0;
+    h->consumerTimeout = consumerTimeout;
+}
+
+void saf_frameRing_destroy
+(
+    void ** const phRing
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(*phRing);
+
+    if(h!=NULL){
+        free(h->frames);
+        free(h->timestamps);
+        free(h);
+        *phRing = NULL;
+    }
+}
+
+int saf_frameRing_getFrameLength
+(
+    void * const hRing
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+    return h->frameLength;
+}
+
+float* saf_frameRing_beginWrite
+(
+    void * const hRing
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+    long latest, reading;
+    int i, slot;
+
+    latest = FRAMERING_ATOMIC_LOAD(&(h->latest));
+    reading = FRAMERING_ATOMIC_LOAD(&(h->reading));
+
+    /* next slot (in order) that is neither the latest, nor held by the consumer */
+    slot = h->writing >= 0 ? h->writing : (int)latest;
+    for(i=0; i<h->nSlots; i++){
+        slot = (slot+1) % h->nSlots;
+        if(slot!=(int)latest && slot!=(int)reading)
+            break;
+    }
+    h->writing = slot;
+    return h->frames[slot];
+}
+
+void saf_frameRing_endWrite
+(
+    void * const hRing,
+    double timestamp
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+
+    if(h->writing<0)
+        return;
+    h->timestamps[h->writing] = timestamp;
+    FRAMERING_ATOMIC_STORE(&(h->latest), (long)h->writing);
+    h->writing = -1;
+}
+
+int saf_frameRing_hasConsumer
+(
+    void * const hRing,
+    double timestamp
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+    long nAcquired;
+
+    nAcquired = FRAMERING_ATOMIC_LOAD(&(h->nAcquired));
+    if(!h->activeTimeValid || nAcquired!=h->lastNAcquired){
+        h->lastNAcquired = nAcquired;
+        h->lastActiveTime = timestamp;
+        h->activeTimeValid = 1;
+        return 1;
+    }
+    return (timestamp - h->lastActiveTime) < h->consumerTimeout ? 1 : 0;
+}
+
+int saf_frameRing_acquire
+(
+    void * const hRing,
+    float ** frame,
+    double * timestamp
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+    long latest;
+
+    FRAMERING_ATOMIC_INC(&(h->nAcquired));
+    do {
+        latest = FRAMERING_ATOMIC_LOAD(&(h->latest));
+        FRAMERING_ATOMIC_STORE(&(h->reading), latest);
+        if(latest<0)
+            return 0; /* nothing published yet */
+    } while(FRAMERING_ATOMIC_LOAD(&(h->latest))!=latest);
+
+    (*frame) = h->frames[latest];
+    if(timestamp!=NULL)
+        (*timestamp) = h->timestamps[latest];
+    return 1;
+}
+
+void saf_frameRing_release
+(
+    void * const hRing
+)
+{
+    safFrameRing_data* h = (safFrameRing_data*)(hRing);
+    FRAMERING_ATOMIC_STORE(&(h->reading), -1L);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_frameRing.h
+ * @brief Lock-free, single-producer/single-consumer ring of time-stamped
+ *        frames, for handing e.g. activity-maps from the audio thread over to
+ *        a GUI thread
+ *
+ * The producer (audio thread) calls saf_frameRing_beginWrite(), fills in the
+ * returned frame, and publishes it with saf_frameRing_endWrite(). The consumer
+ * (GUI thread) calls saf_frameRing_acquire() at its own rate, to obtain the
+ * most recently published frame; which is then held, and never written to by
+ * the producer, until it is released (or the next frame is acquired).
+ * Therefore, the consumer never observes a partially written frame.
+ *
+ * The producer may also call saf_frameRing_hasConsumer() to determine whether
+ * any frames have been acquired recently, and skip generating frames that
+ * nobody is going to look at.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_FRAMERING_H_INCLUDED
+#define SAF_FRAMERING_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Creates an instance of the frame ring
+ *
+ * @param[in] phRing          (&) address of saf_frameRing handle
+ * @param[in] nSlots          Number of frames in the ring (at least 3; one is
+ *                            held by the consumer, one is the latest published
+ *                            frame, and the rest may be written to)
+ * @param[in] frameLength     Number of floats per frame
+ * @param[in] consumerTimeout Time (in the units of the timestamps) without any
+ *                            frames being acquired, after which
+ *                            saf_frameRing_hasConsumer() returns 0
+ */
+void saf_frameRing_create(/* Input Arguments */
+                          void ** const phRing,
+                          int nSlots,
+                          int frameLength,
+                          double consumerTimeout);
+
+/**
+ * Destroys an instance of the frame ring
+ *
+ * @param[in] phRing (&) address of saf_frameRing handle
+ */
+void saf_frameRing_destroy(/* Input Arguments */
+                           void ** const phRing);
+
+/**
+ * Returns the number of floats per frame
+ *
+ * @param[in] hRing saf_frameRing handle
+ */
+int saf_frameRing_getFrameLength(/* Input Arguments */
+                                 void * const hRing);
+
+/**
+ * (Producer) Returns a frame to write the next output into; which is neither
+ * the latest published frame, nor the frame held by the consumer
+ *
+ * @param[in] hRing saf_frameRing handle
+ * @returns   Frame to write to; frameLength x 1
+ */
+float* saf_frameRing_beginWrite(/* Input Arguments */
+                                void * const hRing);
+
+/**
+ * (Producer) Publishes the frame returned by saf_frameRing_beginWrite(), which
+ * then becomes the latest frame
+ *
+ * @param[in] hRing     saf_frameRing handle
+ * @param[in] timestamp Timestamp of the frame (e.g. in seconds of audio)
+ */
+void saf_frameRing_endWrite(/* Input Arguments */
+                            void * const hRing,
+                            double timestamp);
+
+/**
+ * (Producer) Returns 1 if a frame has been acquired within 'consumerTimeout'
+ * of the given time (or if no time-out has elapsed since the first call), and
+ * 0 otherwise
+ *
+ * @param[in] hRing     saf_frameRing handle
+ * @param[in] timestamp Current time (in the same units as the timestamps)
+ */
+int saf_frameRing_hasConsumer(/* Input Arguments */
+                              void * const hRing,
+                              double timestamp);
+
+/**
+ * (Consumer) Acquires the latest published frame, releasing any frame held
+ * previously
+ *
+ * @note The frame remains valid (and unchanged) until saf_frameRing_release()
+ *       or the next call to saf_frameRing_acquire().
+ *
+ * @param[in]  hRing     saf_frameRing handle
+ * @param[out] frame     (&) latest frame; frameLength x 1
+ * @param[out] timestamp (&) timestamp of the frame (may be NULL)
+ * @returns    1 if a frame was acquired, 0 if none have been published yet
+ */
+int saf_frameRing_acquire(/* Input Arguments */
+                          void * const hRing,
+                          /* Output Arguments */
+                          float ** frame,
+                          double * timestamp);
+
+/**
+ * (Consumer) Releases the frame held by the consumer (if any)
+ *
+ * @param[in] hRing saf_frameRing handle
+ */
+void saf_frameRing_release(/* Input Arguments */
+                           void * const hRing);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_FRAMERING_H_INCLUDED */
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_initDeps.c
+ * @brief Dependency tracking for the stages of an initialisation
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_initDeps.h"
+
+/** One stage; its inputs as described, and as of the last commit */
+typedef struct _initDeps_stage {
+    unsigned char* key;        /**< described inputs */
+    size_t keyLen, keyCap;
+    unsigned char* committed;  /**< inputs of the last commit */
+    size_t committedLen;
+    int valid;                 /**< 1: committed, and not invalidated since */
+    unsigned int version;
+
+}initDeps_stage;
+
+/** Data structure for the dependency tracker */
+typedef struct _safInitDeps_data {
+    int nStages;
+    initDeps_stage* stages;
+
+}safInitDeps_data;
+
+void saf_initDeps_create
+(
+    void ** const phDeps,
+    int nStages
+)
+{
+    safInitDeps_data* h;
+
+    h = (safInitDeps_data*)malloc1d(sizeof(safInitDeps_data));
+    *phDeps = (void*)h;
+    h->nStages = nStages;
+    h->stages = (initDeps_stage*)calloc1d(nStages, sizeof(initDeps_stage));
+}
+
+void saf_initDeps_destroy
+(
+    void ** const phDeps
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(*phDeps);
+    int i;
+
+    if(h!=NULL){
+        for(i=0; i<h->nStages; i++){
+            free(h->stages[i].key);
+            free(h->stages[i].committed);
+        }
+        free(h->stages);
+        free(h);
+        *phDeps = NULL;
+    }
+}
+
+void saf_initDeps_begin
+(
+    void * const hDeps,
+    int stage
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+
+    assert(stage>=0 && stage<h->nStages);
+    h->stages[stage].keyLen = 0;
+}
+
+void saf_initDeps_addInput
+(
+    void * const hDeps,
+    int stage,
+    const void* data,
+    size_t nBytes
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+    initDeps_stage* s;
+
+    assert(stage>=0 && stage<h->nStages);
+    s = &(h->stages[stage]);
+    if(s->keyLen+nBytes > s->keyCap){
+        s->keyCap = MAX(2*(s->keyCap), s->keyLen+nBytes);
+        s->key = realloc1d(s->key, s->keyCap);
+    }
+    if(nBytes>0)
+        memcpy(&(s->key[s->keyLen]), data, nBytes);
+    s->keyLen += nBytes;
+}
+
+void saf_initDeps_addString
+(
+    void * const hDeps,
+    int stage,
+    const char* string
+)
+{
+    int len;
+
+    /* (prefixed by its length, -1 for NULL, so that consecutive inputs
+     * cannot be confused) */
+    len = string==NULL ? -1 : (int)strlen(string);
+    saf_initDeps_addInput(hDeps, stage, &len, sizeof(int));
+    if(len>0)
+        saf_initDeps_addInput(hDeps, stage, string, (size_t)len);
+}
+
+void saf_initDeps_addDependency
+(
+    void * const hDeps,
+    int stage,
+    int upstream
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+
+    assert(upstream>=0 && upstream<h->nStages);
+    saf_initDeps_addInput(hDeps, stage, &(h->stages[upstream].version), sizeof(unsigned int));
+}
+
+int saf_initDeps_isStale
+(
+    void * const hDeps,
+    int stage
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+    initDeps_stage* s;
+
+    assert(stage>=0 && stage<h->nStages);
+    s = &(h->stages[stage]);
+    if(!s->valid || s->keyLen!=s->committedLen)
+        return 1;
+    return s->keyLen>0 && memcmp(s->key, s->committed, s->keyLen)!=0 ? 1 : 0;
+}
+
+void saf_initDeps_commit
+(
+    void * const hDeps,
+    int stage
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+    initDeps_stage* s;
+
+    assert(stage>=0 && stage<h->nStages);
+    s = &(h->stages[stage]);
+    s->committed = realloc1d(s->committed, MAX(s->keyLen, 1));
+    if(s->keyLen>0)
+        memcpy(s->committed, s->key, s->keyLen);
+    s->committedLen = s->keyLen;
+    s->valid = 1;
+    s->version++;
+}
+
+void saf_initDeps_invalidate
+(
+    void * const hDeps,
+    int stage
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+    int i;
+
+    if(stage<0){
+        for(i=0; i<h->nStages; i++)
+            h->stages[i].valid = 0;
+    }
+    else{
+        assert(stage<h->nStages);
+        h->stages[stage].valid = 0;
+    }
+}
+
+void saf_initDeps_copy
+(
+    void * const hDepsSrc,
+    void * const hDepsDst
+)
+{
+    safInitDeps_data* hSrc = (safInitDeps_data*)(hDepsSrc);
+    safInitDeps_data* hDst = (safInitDeps_data*)(hDepsDst);
+    initDeps_stage* s, *d;
+    int i;
+
+    assert(hSrc->nStages==hDst->nStages);
+    for(i=0; i<hSrc->nStages; i++){
+        s = &(hSrc->stages[i]);
+        d = &(hDst->stages[i]);
+        d->committed = realloc1d(d->committed, MAX(s->committedLen, 1));
+        if(s->committedLen>0)
+            memcpy(d->committed, s->committed, s->committedLen);
+        d->committedLen = s->committedLen;
+        d->valid = s->valid;
+        d->version = s->version;
+    }
+}
+
+unsigned int saf_initDeps_getVersion
+(
+    void * const hDeps,
+    int stage
+)
+{
+    safInitDeps_data* h = (safInitDeps_data*)(hDeps);
+
+    assert(stage>=0 && stage<h->nStages);
+    return h->stages[stage].version;
+}
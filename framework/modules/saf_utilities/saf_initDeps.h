@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_initDeps.h
+ * @brief Dependency tracking for the stages of an initialisation (e.g. a
+ *        processor's initCodec function), such that only the stages whose
+ *        inputs have changed are recomputed
+ *
+ * Each stage is identified by an index (0..nStages-1). Before a stage is
+ * (possibly) recomputed, its inputs are described with
+ * saf_initDeps_begin(), followed by any number of calls to
+ * saf_initDeps_addInput() (parameters, file paths etc.) and
+ * saf_initDeps_addDependency() (the stages it depends on). The inputs are
+ * compared byte for byte with those of the last commit by
+ * saf_initDeps_isStale(). If the stage is stale, it is recomputed and then
+ * committed with saf_initDeps_commit(); which also increments its version, so
+ * that any stages depending on it become stale in turn.
+ *
+ * A stage may be used by one thread at a time; whereas different stages may be
+ * described/committed by different threads.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_INITDEPS_H_INCLUDED
+#define SAF_INITDEPS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+
+/**
+ * Creates an instance of the dependency tracker, with all stages stale
+ *
+ * @param[in] phDeps  (&) address of saf_initDeps handle
+ * @param[in] nStages Number of stages
+ */
+void saf_initDeps_create(/* Input Arguments */
+                         void ** const phDeps,
+                         int nStages);
+
+/**
+ * Destroys an instance of the dependency tracker
+ *
+ * @param[in] phDeps (&) address of saf_initDeps handle
+ */
+void saf_initDeps_destroy(/* Input Arguments */
+                          void ** const phDeps);
+
+/**
+ * Begins describing the inputs of a stage (discarding any previous, not yet
+ * committed, description)
+ *
+ * @param[in] hDeps saf_initDeps handle
+ * @param[in] stage Index of the stage
+ */
+void saf_initDeps_begin(/* Input Arguments */
+                        void * const hDeps,
+                        int stage);
+
+/**
+ * Appends an input to the description of a stage
+ *
+ * @param[in] hDeps  saf_initDeps handle
+ * @param[in] stage  Index of the stage
+ * @param[in] data   Input (compared byte for byte)
+ * @param[in] nBytes Size of the input, in bytes
+ */
+void saf_initDeps_addInput(/* Input Arguments */
+                           void * const hDeps,
+                           int stage,
+                           const void* data,
+                           size_t nBytes);
+
+/**
+ * Appends a null-terminated string (NULL is allowed) to the description of a
+ * stage
+ */
+void saf_initDeps_addString(/* Input Arguments */
+                            void * const hDeps,
+                            int stage,
+                            const char* string);
+
+/**
+ * Appends the current version of another stage (i.e. an upstream stage) to the
+ * description of a stage
+ *
+ * @param[in] hDeps    saf_initDeps handle
+ * @param[in] stage    Index of the stage
+ * @param[in] upstream Index of the stage it depends on
+ */
+void saf_initDeps_addDependency(/* Input Arguments */
+                                void * const hDeps,
+                                int stage,
+                                int upstream);
+
+/**
+ * Returns 1 if the described inputs differ from those of the last commit (or
+ * if the stage was never committed, or has been invalidated), 0 otherwise
+ *
+ * @param[in] hDeps saf_initDeps handle
+ * @param[in] stage Index of the stage
+ */
+int saf_initDeps_isStale(/* Input Arguments */
+                         void * const hDeps,
+                         int stage);
+
+/**
+ * Marks the stage as recomputed with the described inputs, and increments its
+ * version
+ *
+ * @param[in] hDeps saf_initDeps handle
+ * @param[in] stage Index of the stage
+ */
+void saf_initDeps_commit(/* Input Arguments */
+                         void * const hDeps,
+                         int stage);
+
+/**
+ * Makes a stage stale, regardless of its inputs (e.g. if recomputing it
+ * failed, or its output has been discarded); a negative index invalidates all
+ * stages
+ */
+void saf_initDeps_invalidate(/* Input Arguments */
+                             void * const hDeps,
+                             int stage);
+
+/**
+ * Copies the committed inputs and versions of all stages to another tracker
+ * with the same number of stages (e.g. when cloning an instance, along with the
+ * outputs of the stages)
+ *
+ * @param[in] hDepsSrc saf_initDeps handle to copy from
+ * @param[in] hDepsDst saf_initDeps handle to copy to
+ */
+void saf_initDeps_copy(/* Input Arguments */
+                       void * const hDepsSrc,
+                       void * const hDepsDst);
+
+/** Returns the version of a stage (i.e. the number of commits) */
+unsigned int saf_initDeps_getVersion(/* Input Arguments */
+                                     void * const hDeps,
+                                     int stage);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_INITDEPS_H_INCLUDED */
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_initReport.c
+ * @brief Structured reports of the time and memory taken by each stage of an
+ *        initialisation (e.g. a processor's initCodec function)
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_initReport.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+#if defined(_MSC_VER)
+# define INITREPORT_THREAD_LOCAL __declspec(thread)
+#else
+# define INITREPORT_THREAD_LOCAL __thread
+#endif
+
+/**
+ * Data structure for the init report.
+ *
+ * The stages are only written by the thread which started the report, but the
+ * lock is held while doing so (briefly), so that the report may also be read
+ * while the initialisation is ongoing.
+ */
+typedef struct _safInitReport_data {
+    saf_initReport_stage stages[SAF_INITREPORT_MAX_NUM_STAGES];
+    int nStages;
+    int finished;                       /**< 1 once saf_initReport_finish() has been called */
+    double totalTime_s;
+    size_t totalBytes;
+
+    /* initialising thread only */
+    int openStages[SAF_INITREPORT_MAX_DEPTH]; /**< indices of the open stages (-1: not recorded) */
+    double openTimes[SAF_INITREPORT_MAX_DEPTH];
+    size_t openBytes[SAF_INITREPORT_MAX_DEPTH];
+    int depth;                          /**< number of open stages */
+    double startTime;
+    size_t startBytes;
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+
+}safInitReport_data;
+
+/** Report which the calling thread is currently recording to (if any) */
+static INITREPORT_THREAD_LOCAL safInitReport_data* initReport_current = NULL;
+
+static void initReport_lock(safInitReport_data* h)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&(h->lock));
+#else
+    pthread_mutex_lock(&(h->lock));
+#endif
+}
+
+static void initReport_unlock(safInitReport_data* h)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&(h->lock));
+#else
+    pthread_mutex_unlock(&(h->lock));
+#endif
+}
+
+void saf_initReport_create
+(
+    void ** const phReport
+)
+{
+    safInitReport_data* h;
+
+    h = (safInitReport_data*)calloc1d(1, sizeof(safInitReport_data));
+    *phReport = (void*)h;
+#if defined(_WIN32)
+    InitializeSRWLock(&(h->lock));
+#else
+    pthread_mutex_init(&(h->lock), NULL);
+#endif
+}
+
+void saf_initReport_destroy
+(
+    void ** const phReport
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(*phReport);
+
+    if(h!=NULL){
+        if(initReport_current==h)
+            initReport_current = NULL;
+#if !defined(_WIN32)
+        pthread_mutex_destroy(&(h->lock));
+#endif
+        free(h);
+        *phReport = NULL;
+    }
+}
+
+void saf_initReport_start
+(
+    void * const hReport
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(hReport);
+
+    initReport_lock(h);
+    h->nStages = 0;
+    h->finished = 0;
+    h->totalTime_s = 0.0;
+    h->totalBytes = 0;
+    initReport_unlock(h);
+    h->depth = 0;
+    h->startTime = saf_benchmark_getTime();
+    h->startBytes = md_getNumBytesRequested();
+    initReport_current = h;
+}
+
+void saf_initReport_finish
+(
+    void * const hReport
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(hReport);
+    double time_s;
+    size_t bytes;
+
+    if(initReport_current==h){
+        while(h->depth>0)
+            saf_initReport_endStage();
+        initReport_current = NULL;
+    }
+    time_s = saf_benchmark_getTime() - h->startTime;
+    bytes = md_getNumBytesRequested() - h->startBytes;
+    initReport_lock(h);
+    h->totalTime_s = time_s;
+    h->totalBytes = bytes;
+    h->finished = 1;
+    initReport_unlock(h);
+}
+
+void saf_initReport_beginStage
+(
+    const char* name
+)
+{
+    safInitReport_data* h = initReport_current;
+    saf_initReport_stage* s;
+    int idx;
+
+    if(h==NULL || h->depth>=SAF_INITREPORT_MAX_DEPTH)
+        return;
+
+    /* record the stage, if there is still room */
+    idx = -1;
+    initReport_lock(h);
+    if(h->nStages<SAF_INITREPORT_MAX_NUM_STAGES){
+        idx = h->nStages;
+        s = &(h->stages[idx]);
+        strncpy(s->name, name, SAF_INITREPORT_NAME_LENGTH-1);
+        s->name[SAF_INITREPORT_NAME_LENGTH-1] = '\0';
+        s->depth = h->depth;
+        s->finished = 0;
+        s->time_s = 0.0;
+        s->bytesAllocated = 0;
+        h->nStages++;
+    }
+    initReport_unlock(h);
+    h->openStages[h->depth] = idx;
+    h->openBytes[h->depth] = md_getNumBytesRequested();
+    h->openTimes[h->depth] = saf_benchmark_getTime();
+    h->depth++;
+}
+
+void saf_initReport_endStage(void)
+{
+    safInitReport_data* h = initReport_current;
+    saf_initReport_stage* s;
+    double time_s;
+    size_t bytes;
+    int idx;
+
+    if(h==NULL || h->depth==0)
+        return;
+    h->depth--;
+    time_s = saf_benchmark_getTime() - h->openTimes[h->depth];
+    bytes = md_getNumBytesRequested() - h->openBytes[h->depth];
+    idx = h->openStages[h->depth];
+    if(idx<0)
+        return;
+    initReport_lock(h);
+    s = &(h->stages[idx]);
+    s->time_s = time_s;
+    s->bytesAllocated = bytes;
+    s->finished = 1;
+    initReport_unlock(h);
+}
+
+int saf_initReport_getNumStages
+(
+    void * const hReport
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(hReport);
+    int nStages;
+
+    initReport_lock(h);
+    nStages = h->nStages;
+    initReport_unlock(h);
+    return nStages;
+}
+
+int saf_initReport_getStage
+(
+    void * const hReport,
+    int index,
+    saf_initReport_stage* stage
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(hReport);
+    int valid;
+
+    initReport_lock(h);
+    valid = index>=0 && index<h->nStages;
+    if(valid)
+        memcpy(stage, &(h->stages[index]), sizeof(saf_initReport_stage));
+    initReport_unlock(h);
+    return valid;
+}
+
+int saf_initReport_getTotal
+(
+    void * const hReport,
+    double* time_s,
+    size_t* bytesAllocated
+)
+{
+    safInitReport_data* h = (safInitReport_data*)(hReport);
+    int finished;
+
+    initReport_lock(h);
+    if(time_s!=NULL)
+        (*time_s) = h->totalTime_s;
+    if(bytesAllocated!=NULL)
+        (*bytesAllocated) = h->totalBytes;
+    finished = h->finished;
+    initReport_unlock(h);
+    return finished;
+}
+
+void saf_initReport_print
+(
+    void * const hReport,
+    FILE* stream
+)
+{
+    saf_initReport_stage stage;
+    double time_s;
+    size_t bytes;
+    int i, finished;
+
+    for(i=0; saf_initReport_getStage(hReport, i, &stage); i++){
+        if(stage.finished)
+            fprintf(stream, "%*s%-*s %10.3f ms %12zu bytes\n", 2*stage.depth, "", 40-2*stage.depth, stage.name,
+                    1e3*stage.time_s, stage.bytesAllocated);
+        else
+            fprintf(stream, "%*s%-*s    (ongoing)\n", 2*stage.depth, "", 40-2*stage.depth, stage.name);
+    }
+    finished = saf_initReport_getTotal(hReport, &time_s, &bytes);
+    if(finished)
+        fprintf(stream, "%-40s %10.3f ms %12zu bytes\n", "total", 1e3*time_s, bytes);
+}
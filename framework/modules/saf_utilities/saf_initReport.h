@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_initReport.h
+ * @brief Structured reports of the time and memory taken by each stage of an
+ *        initialisation (e.g. a processor's initCodec function)
+ *
+ * An initialisation starts a report with saf_initReport_start(), which also
+ * makes it the current report of the calling thread, and ends it with
+ * saf_initReport_finish(). In-between, any code running on that thread (i.e.
+ * including framework functions, such as hrtfCache_acquire()) may wrap its
+ * stages with saf_initReport_beginStage() and saf_initReport_endStage(); which
+ * do nothing if the thread has no current report. Stages may be nested, and
+ * are recorded in the order in which they begin. The wall time and the number
+ * of bytes requested through md_malloc are recorded for each stage.
+ *
+ * The report may be read (e.g. by a GUI thread) once the initialisation has
+ * finished, or also while it is ongoing.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_INITREPORT_H_INCLUDED
+#define SAF_INITREPORT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Maximum number of stages recorded per report (further stages are ignored) */
+#define SAF_INITREPORT_MAX_NUM_STAGES ( 32 )
+/** Maximum nesting depth of the stages */
+#define SAF_INITREPORT_MAX_DEPTH ( 8 )
+/** Maximum length of a stage name (including the terminating null) */
+#define SAF_INITREPORT_NAME_LENGTH ( 64 )
+
+/** One stage of an initialisation */
+typedef struct _saf_initReport_stage {
+    char name[SAF_INITREPORT_NAME_LENGTH]; /**< name of the stage */
+    int depth;                /**< nesting depth (0: top-level stage) */
+    int finished;             /**< 1 if the stage has ended, 0 if ongoing */
+    double time_s;            /**< wall time taken by the stage, in seconds */
+    size_t bytesAllocated;    /**< bytes requested through md_malloc */
+
+}saf_initReport_stage;
+
+/**
+ * Creates an instance of an (empty) init report
+ *
+ * @param[in] phReport (&) address of saf_initReport handle
+ */
+void saf_initReport_create(/* Input Arguments */
+                           void ** const phReport);
+
+/**
+ * Destroys an instance of an init report
+ *
+ * @param[in] phReport (&) address of saf_initReport handle
+ */
+void saf_initReport_destroy(/* Input Arguments */
+                            void ** const phReport);
+
+/**
+ * Clears the report, and makes it the current report of the calling thread
+ *
+ * @param[in] hReport saf_initReport handle
+ */
+void saf_initReport_start(/* Input Arguments */
+                          void * const hReport);
+
+/**
+ * Ends any stages which are still open, records the total time and memory,
+ * and detaches the report from the calling thread
+ *
+ * @param[in] hReport saf_initReport handle
+ */
+void saf_initReport_finish(/* Input Arguments */
+                           void * const hReport);
+
+/**
+ * Begins a stage of the current report of the calling thread (if any)
+ *
+ * @param[in] name Name of the stage (e.g. "loadSofaFile")
+ */
+void saf_initReport_beginStage(/* Input Arguments */
+                               const char* name);
+
+/**
+ * Ends the most recently begun stage of the current report of the calling
+ * thread (if any)
+ */
+void saf_initReport_endStage(void);
+
+/**
+ * Returns the number of recorded stages
+ *
+ * @param[in] hReport saf_initReport handle
+ */
+int saf_initReport_getNumStages(/* Input Arguments */
+                                void * const hReport);
+
+/**
+ * Returns a copy of a recorded stage
+ *
+ * @param[in]  hReport saf_initReport handle
+ * @param[in]  index   Index of the stage (in the order they began)
+ * @param[out] stage   (&) copy of the stage
+ * @returns    1 if 'index' is valid, 0 otherwise
+ */
+int saf_initReport_getStage(/* Input Arguments */
+                            void * const hReport,
+                            int index,
+                            /* Output Arguments */
+                            saf_initReport_stage* stage);
+
+/**
+ * Returns the total wall time and memory of the last (finished) report
+ *
+ * @param[in]  hReport        saf_initReport handle
+ * @param[out] time_s         (&) total time, in seconds (may be NULL)
+ * @param[out] bytesAllocated (&) total bytes requested (may be NULL)
+ * @returns    1 if the report has finished, 0 otherwise
+ */
+int saf_initReport_getTotal(/* Input Arguments */
+                            void * const hReport,
+                            /* Output Arguments */
+                            double* time_s,
+                            size_t* bytesAllocated);
+
+/**
+ * Prints the report (one stage per line, indented by depth) to a stream
+ *
+ * @param[in] hReport saf_initReport handle
+ * @param[in] stream  Stream to print to (e.g. stdout)
+ */
+void saf_initReport_print(/* Input Arguments */
+                          void * const hReport,
+                          FILE* stream);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_INITREPORT_H_INCLUDED */
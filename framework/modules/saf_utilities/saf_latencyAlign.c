@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * @file saf_latencyAlign.c
+ * @brief Delay lines for aligning the outputs of parallel processing chains
+ *        with different latencies
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_latencyAlign.h"
+
+/** Delay line of one chain */
+typedef struct _latencyAlign_chain {
+    int nChannels;
+    int delay;      /**< in samples */
+    int pos;        /**< current read/write position in the buffers */
+    float** buffer; /**< ring buffers; nChannels x delay (NULL if delay==0) */
+
+}latencyAlign_chain;
+
+/** Data structure for the latency alignment */
+typedef struct _safLatencyAlign_data {
+    int nChains;
+    int latency;                /**< largest latency of the chains */
+    latencyAlign_chain* chains; /**< nChains x 1 */
+
+}safLatencyAlign_data;
+
+void saf_latencyAlign_create
+(
+    void ** const phLA,
+    int nChains,
+    const int* nChannels,
+    const int* latencies
+)
+{
+    safLatencyAlign_data* h;
+    int i;
+
+    h = (safLatencyAlign_data*)malloc1d(sizeof(safLatencyAlign_data));
+    *phLA = (void*)h;
+    h->nChains = MAX(nChains, 0);
+    h->chains = (latencyAlign_chain*)malloc1d(MAX(h->nChains,1)*sizeof(latencyAlign_chain));
+    h->latency = 0;
+    for(i=0; i<h->nChains; i++)
+        h->latency = MAX(h->latency, latencies[i]);
+    for(i=0; i<h->nChains; i++){
+        h->chains[i].nChannels = MAX(nChannels[i], 0);
+        h->chains[i].delay = h->latency - MAX(latencies[i], 0);
+        h->chains[i].pos = 0;
+        if(h->chains[i].delay>0 && h->chains[i].nChannels>0)
+            h->chains[i].buffer = (float**)calloc2d(h->chains[i].nChannels, h->chains[i].delay, sizeof(float));
+        else
+            h->chains[i].buffer = NULL;
+    }
+}
+
+void saf_latencyAlign_destroy
+(
+    void ** const phLA
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(*phLA);
+    int i;
+
+    if(h!=NULL){
+        for(i=0; i<h->nChains; i++)
+            free(h->chains[i].buffer);
+        free(h->chains);
+        free(h);
+        *phLA = NULL;
+    }
+}
+
+void saf_latencyAlign_flush
+(
+    void * const hLA
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(hLA);
+    int i;
+
+    for(i=0; i<h->nChains; i++){
+        h->chains[i].pos = 0;
+        if(h->chains[i].buffer!=NULL)
+            memset(ADR2D(h->chains[i].buffer), 0, h->chains[i].nChannels*(h->chains[i].delay)*sizeof(float));
+    }
+}
+
+int saf_latencyAlign_getLatency
+(
+    void * const hLA
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(hLA);
+    return h->latency;
+}
+
+int saf_latencyAlign_getDelay
+(
+    void * const hLA,
+    int chain
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(hLA);
+    return h->chains[chain].delay;
+}
+
+size_t saf_latencyAlign_getMemoryUsage
+(
+    void * const hLA
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(hLA);
+    size_t bytes;
+    int i;
+
+    bytes = sizeof(safLatencyAlign_data) + h->nChains*sizeof(latencyAlign_chain);
+    for(i=0; i<h->nChains; i++)
+        if(h->chains[i].buffer!=NULL)
+            bytes += h->chains[i].nChannels*(sizeof(float*) + (size_t)h->chains[i].delay*sizeof(float));
+    return bytes;
+}
+
+void saf_latencyAlign_apply
+(
+    void * const hLA,
+    int chain,
+    float ** const data,
+    int nChannels,
+    int nSamples
+)
+{
+    safLatencyAlign_data* h = (safLatencyAlign_data*)(hLA);
+    latencyAlign_chain* c = &(h->chains[chain]);
+    int ch, i, n, pos, done;
+    float tmp;
+    float *x, *buf;
+
+    if(c->buffer==NULL || nSamples<=0)
+        return;
+    nChannels = MIN(nChannels, c->nChannels);
+
+    /* each sample is swapped with the one written 'delay' samples ago; in runs
+     * up to the end of the ring buffer */
+    for(ch=0; ch<nChannels; ch++){
+        x = data[ch];
+        buf = c->buffer[ch];
+        pos = c->pos;
+        for(done=0; done<nSamples; done+=n){
+            n = MIN(nSamples-done, c->delay-pos);
+            for(i=0; i<n; i++){
+                tmp = buf[pos+i];
+                buf[pos+i] = x[done+i];
+                x[done+i] = tmp;
+            }
+            pos += n;
+            if(pos==c->delay)
+                pos = 0;
+        }
+    }
+    c->pos = (int)(((long long)c->pos + nSamples) % c->delay);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * @file saf_latencyAlign.h
+ * @brief Delay lines for aligning the outputs of parallel processing chains
+ *        with different latencies
+ *
+ * For example, when a time-domain (dry/bypass) path is mixed with the output
+ * of a time-frequency domain processor, the former must be delayed by the
+ * processing delay of the latter (as returned by the "_getProcessingDelay()"
+ * functions of the SAF examples, plus saf_fifo_getLatency() of any FIFO layer
+ * in front of it). Given the latency of each chain, each one is delayed by the
+ * difference between its latency and that of the slowest chain; such that the
+ * aligned chains share the latency of the slowest one, and only the faster
+ * chains are buffered (i.e. by only as many samples as are needed).
+ *
+ * All memory is allocated when the instance is created, and so
+ * saf_latencyAlign_apply() may be called from a real-time audio thread.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_LATENCYALIGN_H_INCLUDED
+#define SAF_LATENCYALIGN_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Creates an instance of the latency alignment
+ *
+ * @param[in] phLA       (&) address of latencyAlign handle
+ * @param[in] nChains    Number of parallel chains
+ * @param[in] nChannels  Number of channels of each chain; nChains x 1
+ * @param[in] latencies  Latency of each chain, in samples; nChains x 1
+ */
+void saf_latencyAlign_create(/* Input Arguments */
+                             void ** const phLA,
+                             int nChains,
+                             const int* nChannels,
+                             const int* latencies);
+
+/**
+ * Destroys an instance of the latency alignment
+ *
+ * @param[in] phLA (&) address of latencyAlign handle
+ */
+void saf_latencyAlign_destroy(/* Input Arguments */
+                              void ** const phLA);
+
+/**
+ * Flushes the delay lines (i.e. zeros their buffers)
+ */
+void saf_latencyAlign_flush(/* Input Arguments */
+                            void * const hLA);
+
+/**
+ * Returns the latency of the aligned chains, in samples (i.e. the largest
+ * latency of the chains)
+ */
+int saf_latencyAlign_getLatency(/* Input Arguments */
+                                void * const hLA);
+
+/**
+ * Returns the delay applied to a chain, in samples (0 for the slowest chain)
+ */
+int saf_latencyAlign_getDelay(/* Input Arguments */
+                              void * const hLA,
+                              int chain);
+
+/**
+ * Returns the memory taken by the delay lines, in bytes
+ */
+size_t saf_latencyAlign_getMemoryUsage(/* Input Arguments */
+                                       void * const hLA);
+
+/**
+ * Delays a block of the output signals of one chain, in place
+ *
+ * @note Each chain must be given the same number of samples per block (in any
+ *       order); since the delay lines of the chains are advanced
+ *       independently.
+ *
+ * @param[in]     hLA       latencyAlign handle
+ * @param[in]     chain     Index of the chain
+ * @param[in,out] data      Signals of the chain; nChannels x nSamples
+ * @param[in]     nChannels Number of channels (channels beyond those given at
+ *                          creation are left as they are)
+ * @param[in]     nSamples  Number of samples in each channel (any value)
+ */
+void saf_latencyAlign_apply(/* Input Arguments */
+                            void * const hLA,
+                            int chain,
+                            /* Input/Output Arguments */
+                            float ** const data,
+                            /* Input Arguments */
+                            int nChannels,
+                            int nSamples);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_LATENCYALIGN_H_INCLUDED */
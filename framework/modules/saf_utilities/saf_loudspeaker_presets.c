@@ -24,6 +24,12 @@
  */
 
 #include "saf_loudspeaker_presets.h"
+#include "saf_utilities.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
  
 /* mono */
 const float __mono_dirs_deg[1][2] =
@@ -33646,3 +33652,130 @@ const int __geosphere_oct_nPoints[17] =
 
 
 
+
+
+/* ========================================================================== */
+/*                     Cached Conversions of the Presets                      */
+/* ========================================================================== */
+
+/**
+ * An entry of the preset conversion cache; keyed by the address of the preset
+ * table (the presets are constant, so their addresses do not change)
+ */
+typedef struct _presetDirsCache_entry {
+    const float* dirs_deg;                 /**< the preset table; FLAT: nDirs x 2 */
+    int nDirs;
+    float* dirs_rad;                       /**< NULL until needed; FLAT: 2 x nDirs */
+    float* xyz;                            /**< NULL until needed; FLAT: 3 x nDirs */
+    struct _presetDirsCache_entry* next;
+}presetDirsCache_entry;
+
+static presetDirsCache_entry* presetDirsCache_head = NULL;
+#if defined(_WIN32)
+static SRWLOCK presetDirsCache_lock = SRWLOCK_INIT;
+# define PRESET_CACHE_LOCK()   AcquireSRWLockExclusive(&presetDirsCache_lock)
+# define PRESET_CACHE_UNLOCK() ReleaseSRWLockExclusive(&presetDirsCache_lock)
+#else
+static pthread_mutex_t presetDirsCache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define PRESET_CACHE_LOCK()   pthread_mutex_lock(&presetDirsCache_lock)
+# define PRESET_CACHE_UNLOCK() pthread_mutex_unlock(&presetDirsCache_lock)
+#endif
+
+/** Returns the entry for a table (creating it if needed); lock must be held */
+static presetDirsCache_entry* presetDirsCache_find
+(
+    const float* dirs_deg,
+    int nDirs
+)
+{
+    presetDirsCache_entry* e;
+
+    for(e = presetDirsCache_head; e!=NULL; e = e->next)
+        if(e->dirs_deg==dirs_deg && e->nDirs==nDirs)
+            return e;
+    e = (presetDirsCache_entry*)malloc1d(sizeof(presetDirsCache_entry));
+    e->dirs_deg = dirs_deg;
+    e->nDirs = nDirs;
+    e->dirs_rad = NULL;
+    e->xyz = NULL;
+    e->next = presetDirsCache_head;
+    presetDirsCache_head = e;
+    return e;
+}
+
+/** Converts the table of an entry to radians, if not done so already */
+static void presetDirsCache_convertRad
+(
+    presetDirsCache_entry* e
+)
+{
+    int i;
+
+    if(e->dirs_rad!=NULL)
+        return;
+    e->dirs_rad = malloc1d(2*(e->nDirs)*sizeof(float));
+    for(i=0; i<e->nDirs; i++){
+        e->dirs_rad[i]          = e->dirs_deg[i*2]  *M_PI/180.0f;
+        e->dirs_rad[e->nDirs+i] = e->dirs_deg[i*2+1]*M_PI/180.0f;
+    }
+}
+
+const float* presetDirsCache_getRad
+(
+    const float* dirs_deg,
+    int nDirs
+)
+{
+    presetDirsCache_entry* e;
+
+    if(dirs_deg==NULL || nDirs<1)
+        return NULL;
+    PRESET_CACHE_LOCK();
+    e = presetDirsCache_find(dirs_deg, nDirs);
+    presetDirsCache_convertRad(e);
+    PRESET_CACHE_UNLOCK();
+    return (const float*)e->dirs_rad;
+}
+
+const float* presetDirsCache_getXYZ
+(
+    const float* dirs_deg,
+    int nDirs
+)
+{
+    presetDirsCache_entry* e;
+    int i;
+    float cos_elev;
+
+    if(dirs_deg==NULL || nDirs<1)
+        return NULL;
+    PRESET_CACHE_LOCK();
+    e = presetDirsCache_find(dirs_deg, nDirs);
+    if(e->xyz==NULL){
+        presetDirsCache_convertRad(e);
+        e->xyz = malloc1d(3*nDirs*sizeof(float));
+        for(i=0; i<nDirs; i++){
+            cos_elev = cosf(e->dirs_rad[nDirs+i]);
+            e->xyz[i]         = cos_elev * cosf(e->dirs_rad[i]);
+            e->xyz[nDirs+i]   = cos_elev * sinf(e->dirs_rad[i]);
+            e->xyz[2*nDirs+i] = sinf(e->dirs_rad[nDirs+i]);
+        }
+    }
+    PRESET_CACHE_UNLOCK();
+    return (const float*)e->xyz;
+}
+
+void presetDirsCache_clear(void)
+{
+    presetDirsCache_entry* e, *next;
+
+    PRESET_CACHE_LOCK();
+    for(e = presetDirsCache_head; e!=NULL; e = next){
+        next = e->next;
+        free(e->dirs_rad);
+        free(e->xyz);
+        free(e);
+    }
+    presetDirsCache_head = NULL;
+    PRESET_CACHE_UNLOCK();
+}
@@ -566,6 +566,65 @@ extern const int __geosphere_ico_nPoints[17];
  * \endcode
  */
 extern const int __geosphere_oct_nPoints[17];
+
+
+/* ========================================================================== */
+/*                     Cached Conversions of the Presets                      */
+/* ========================================================================== */
+
+/**
+ * Returns the directions of a preset in radians, in structure-of-arrays form;
+ * i.e. all azimuths followed by all elevations
+ *
+ * The conversion is carried out on the first request for a given table, and
+ * the result is then shared by all subsequent callers. Large grids (e.g. the
+ * higher degree t-designs) are therefore only ever converted if they are used.
+ * Tables are identified by their address, so this is intended for the
+ * (constant) preset tables in this file, e.g.:
+ * \code{.c}
+ *   const float* dirs_rad;
+ *   dirs_rad = presetDirsCache_getRad(__HANDLES_Tdesign_dirs_deg[9],
+ *                                     __Tdesign_nPoints_per_degree[9]);
+ *   // azimuth of direction i: dirs_rad[i]
+ *   // elevation of direction i: dirs_rad[__Tdesign_nPoints_per_degree[9]+i]
+ * \endcode
+ *
+ * @note The returned data must not be modified or freed. This function is
+ *       thread-safe, but may block while another thread converts a table; so
+ *       call it from initialisation code rather than the audio thread. Values
+ *       are identical to: dirs_deg[i*2+j]*M_PI/180.0f
+ *
+ * @param[in] dirs_deg Preset directions [azi, elev] in DEGREES; FLAT: nDirs x 2
+ * @param[in] nDirs    Number of directions
+ * @returns   Directions in radians; FLAT: 2 x nDirs
+ */
+const float* presetDirsCache_getRad(/* Input Arguments */
+                                    const float* dirs_deg,
+                                    int nDirs);
+
+/**
+ * Returns the directions of a preset as Cartesian unit vectors, in
+ * structure-of-arrays form; i.e. all x, followed by all y, then all z
+ *
+ * Same caching rules as presetDirsCache_getRad(). Values are identical to
+ * unitSph2Cart() of the radian directions.
+ *
+ * @param[in] dirs_deg Preset directions [azi, elev] in DEGREES; FLAT: nDirs x 2
+ * @param[in] nDirs    Number of directions
+ * @returns   Unit vectors; FLAT: 3 x nDirs
+ */
+const float* presetDirsCache_getXYZ(/* Input Arguments */
+                                    const float* dirs_deg,
+                                    int nDirs);
+
+/**
+ * Frees all conversions held by the preset cache
+ *
+ * @warning Any pointers previously returned by presetDirsCache_getRad() or
+ *          presetDirsCache_getXYZ() become invalid; only call this once no
+ *          instances are using them (e.g. when unloading the library).
+ */
+void presetDirsCache_clear(void);
     
 
 #ifdef __cplusplus
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_mapPeaks.c
+ * @brief Peak-picking and source tracking on maps over spherical grids
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_mapPeaks.h"
+
+/** One track; i.e. a source followed over consecutive maps */
+typedef struct _mapPeaks_track {
+    int id;
+    int gridIdx;     /**< grid point of its last peak */
+    int nMissed;     /**< number of consecutive maps without a peak */
+
+}mapPeaks_track;
+
+/** Data structure for the map peak-picker/tracker */
+typedef struct _safMapPeaks_data {
+    int nGrid, maxNumPeaks;
+    float* grid_dirs_deg;  /**< grid directions; FLAT: nGrid x 2 */
+    float* xyz;            /**< unit vectors of the grid directions; FLAT: nGrid x 3 */
+    int* nbr_offset;       /**< neighbours of grid point 'g' are nbr_idx[nbr_offset[g]..nbr_offset[g+1]-1]; (nGrid+1) x 1 */
+    int* nbr_idx;          /**< grid points within the neighbour angle of each grid point */
+
+    /* scratch */
+    int* candIdx;          /**< grid indices of all peaks; nGrid x 1 */
+    float* candVals;       /**< map values of all peaks; nGrid x 1 */
+    int* sortIdx;          /**< indices into the candidates; maxNumPeaks x 1 */
+    int* peakTrack;        /**< track assigned to each peak (-1: none); maxNumPeaks x 1 */
+
+    /* tracks */
+    int nTracks, nextID;
+    mapPeaks_track* tracks; /**< maxNumPeaks x 1 */
+
+}safMapPeaks_data;
+
+void saf_mapPeaks_create
+(
+    void ** const phMP,
+    float* grid_dirs_deg,
+    int nGrid,
+    float nbrAngle_deg,
+    int maxNumPeaks
+)
+{
+    safMapPeaks_data* h;
+    int i, j, nNbrs, pass;
+    float dot, maxDot, minMaxDot, cosMin, azi, elev;
+
+    h = (safMapPeaks_data*)malloc1d(sizeof(safMapPeaks_data));
+    *phMP = (void*)h;
+    h->nGrid = nGrid;
+    h->maxNumPeaks = MAX(maxNumPeaks, 1);
+    h->grid_dirs_deg = malloc1d(MAX(nGrid,1)*2*sizeof(float));
+    memcpy(h->grid_dirs_deg, grid_dirs_deg, nGrid*2*sizeof(float));
+    h->xyz = malloc1d(MAX(nGrid,1)*3*sizeof(float));
+    for(i=0; i<nGrid; i++){
+        azi = grid_dirs_deg[i*2]*M_PI/180.0f;
+        elev = grid_dirs_deg[i*2+1]*M_PI/180.0f;
+        h->xyz[i*3]   = cosf(elev)*cosf(azi);
+        h->xyz[i*3+1] = cosf(elev)*sinf(azi);
+        h->xyz[i*3+2] = sinf(elev);
+    }
+
+    /* default neighbour angle, from the sparsest part of the grid */
+    if(nbrAngle_deg<=0.0f){
+        minMaxDot = 1.0f;
+        for(i=0; i<nGrid; i++){
+            maxDot = -1.0f;
+            for(j=0; j<nGrid; j++)
+                if(j!=i)
+                    maxDot = MAX(maxDot, h->xyz[i*3]*h->xyz[j*3] + h->xyz[i*3+1]*h->xyz[j*3+1] + h->xyz[i*3+2]*h->xyz[j*3+2]);
+            minMaxDot = MIN(minMaxDot, maxDot);
+        }
+        nbrAngle_deg = 1.5f*acosf(MIN(MAX(minMaxDot, -1.0f), 1.0f))*180.0f/M_PI;
+    }
+    cosMin = nbrAngle_deg >= 180.0f ? -2.0f : cosf(nbrAngle_deg*M_PI/180.0f);
+
+    /* neighbour lists (counted in the first pass, and stored in the second) */
+    h->nbr_offset = malloc1d((nGrid+1)*sizeof(int));
+    h->nbr_idx = NULL;
+    for(pass=0; pass<2; pass++){
+        nNbrs = 0;
+        for(i=0; i<nGrid; i++){
+            h->nbr_offset[i] = nNbrs;
+            for(j=0; j<nGrid; j++){
+                if(j==i)
+                    continue;
+                dot = h->xyz[i*3]*h->xyz[j*3] + h->xyz[i*3+1]*h->xyz[j*3+1] + h->xyz[i*3+2]*h->xyz[j*3+2];
+                if(dot>=cosMin){
+                    if(pass==1)
+                        h->nbr_idx[nNbrs] = j;
+                    nNbrs++;
+                }
+            }
+        }
+        h->nbr_offset[nGrid] = nNbrs;
+        if(pass==0)
+            h->nbr_idx = malloc1d(MAX(nNbrs,1)*sizeof(int));
+    }
+
+    h->candIdx = malloc1d(MAX(nGrid,1)*sizeof(int));
+    h->candVals = malloc1d(MAX(nGrid,1)*sizeof(float));
+    h->sortIdx = malloc1d(h->maxNumPeaks*sizeof(int));
+    h->peakTrack = malloc1d(h->maxNumPeaks*sizeof(int));
+    h->tracks = malloc1d(h->maxNumPeaks*sizeof(mapPeaks_track));
+    h->nTracks = 0;
+    h->nextID = 0;
+}
+
+void saf_mapPeaks_destroy
+(
+    void ** const phMP
+)
+{
+    safMapPeaks_data* h = (safMapPeaks_data*)(*phMP);
+
+    if(h!=NULL){
+        free(h->grid_dirs_deg);
+        free(h->xyz);
+        free(h->nbr_offset);
+        free(h->nbr_idx);
+        free(h->candIdx);
+        free(h->candVals);
+        free(h->sortIdx);
+        free(h->peakTrack);
+        free(h->tracks);
+        free(h);
+        *phMP = NULL;
+    }
+}
+
+int saf_mapPeaks_find
+(
+    void * const hMP,
+    float* map,
+    int nPeaks,
+    float minRelLevel,
+    int* peakIdx,
+    float* peakVals
+)
+{
+    safMapPeaks_data* h = (safMapPeaks_data*)(hMP);
+    int i, j, n, nCand, isPeak, isFlat;
+    float thresh;
+
+    assert(nPeaks<=h->maxNumPeaks);
+
+    /* local maxima (plateaus are resolved in favour of the lowest index, while
+     * a point that is level with all of its neighbours is not a peak) */
+    nCand = 0;
+    for(i=0; i<h->nGrid; i++){
+        isPeak = 1;
+        isFlat = 1;
+        for(n=h->nbr_offset[i]; n<h->nbr_offset[i+1] && isPeak; n++){
+            j = h->nbr_idx[n];
+            isPeak = map[i] > map[j] || (map[i]==map[j] && i<j);
+            isFlat = isFlat && map[i]==map[j];
+        }
+        if(isPeak && !isFlat){
+            h->candIdx[nCand] = i;
+            h->candVals[nCand] = map[i];
+            nCand++;
+        }
+    }
+
+    /* the largest of them */
+    nPeaks = MIN(nPeaks, nCand);
+    if(nPeaks<=0)
+        return 0;
+    partialSortf(h->candVals, h->candVals, h->sortIdx, nCand, nPeaks, 1);
+    thresh = minRelLevel*h->candVals[0];
+    for(i=0; i<nPeaks; i++){
+        if(minRelLevel>0.0f && h->candVals[i]<thresh)
+            break;
+        peakIdx[i] = h->candIdx[h->sortIdx[i]];
+        if(peakVals!=NULL)
+            peakVals[i] = h->candVals[i];
+    }
+    return i;
+}
+
+int saf_mapPeaks_track
+(
+    void * const hMP,
+    float* map,
+    int nPeaks,
+    float minRelLevel,
+    float maxAngle_deg,
+    int holdMaps,
+    int* trackIDs,
+    float* track_dirs_deg,
+    float* trackVals
+)
+{
+    safMapPeaks_data* h = (safMapPeaks_data*)(hMP);
+    int i, k, t, p, bestT, bestP, nFound, matched;
+    float dot, bestDot, cosMax;
+    float* u, *v;
+
+    /* (the peak indices are held in trackIDs until they are replaced by IDs) */
+    nFound = saf_mapPeaks_find(hMP, map, nPeaks, minRelLevel, trackIDs, trackVals);
+    cosMax = maxAngle_deg >= 180.0f ? -2.0f : cosf(maxAngle_deg*M_PI/180.0f);
+    for(p=0; p<nFound; p++)
+        h->peakTrack[p] = -1;
+
+    /* associate the closest track/peak pairs first */
+    for(t=0; t<h->nTracks; t++)
+        h->tracks[t].nMissed++;
+    for(k=0; k<MIN(nFound, h->nTracks); k++){
+        bestDot = cosMax;
+        bestT = bestP = -1;
+        for(t=0; t<h->nTracks; t++){
+            if(h->tracks[t].nMissed==0)
+                continue; /* already matched */
+            u = &(h->xyz[h->tracks[t].gridIdx*3]);
+            for(p=0; p<nFound; p++){
+                if(h->peakTrack[p]>=0)
+                    continue;
+                v = &(h->xyz[trackIDs[p]*3]);
+                dot = u[0]*v[0] + u[1]*v[1] + u[2]*v[2];
+                if(dot>=bestDot){
+                    bestDot = dot;
+                    bestT = t;
+                    bestP = p;
+                }
+            }
+        }
+        if(bestT<0)
+            break;
+        h->peakTrack[bestP] = bestT;
+        h->tracks[bestT].nMissed = 0;
+        h->tracks[bestT].gridIdx = trackIDs[bestP];
+    }
+
+    /* release the tracks that have been missing for too long */
+    for(t=0, i=0; t<h->nTracks; t++){
+        if(h->tracks[t].nMissed<=holdMaps){
+            for(p=0; p<nFound; p++)
+                if(h->peakTrack[p]==t)
+                    h->peakTrack[p] = i;
+            h->tracks[i++] = h->tracks[t];
+        }
+    }
+    h->nTracks = i;
+
+    /* new tracks for the remaining peaks (the larger peaks first); if all
+     * tracks are taken, the one that has been missing the longest is reused */
+    for(p=0; p<nFound; p++){
+        if(h->peakTrack[p]>=0)
+            continue;
+        if(h->nTracks<h->maxNumPeaks)
+            t = h->nTracks++;
+        else{
+            for(t=-1, i=0, matched=0; i<h->nTracks; i++){
+                if(h->tracks[i].nMissed>matched){
+                    matched = h->tracks[i].nMissed;
+                    t = i;
+                }
+            }
+            if(t<0)
+                continue; /* (cannot happen with nPeaks<=maxNumPeaks) */
+        }
+        h->tracks[t].id = h->nextID++;
+        h->tracks[t].gridIdx = trackIDs[p];
+        h->tracks[t].nMissed = 0;
+        h->peakTrack[p] = t;
+    }
+
+    /* output */
+    for(p=0; p<nFound; p++){
+        t = h->peakTrack[p];
+        track_dirs_deg[p*2]   = h->grid_dirs_deg[h->tracks[t].gridIdx*2];
+        track_dirs_deg[p*2+1] = h->grid_dirs_deg[h->tracks[t].gridIdx*2+1];
+        trackIDs[p] = h->tracks[t].id;
+    }
+    return nFound;
+}
+
+void saf_mapPeaks_resetTracks
+(
+    void * const hMP
+)
+{
+    safMapPeaks_data* h = (safMapPeaks_data*)(hMP);
+    h->nTracks = 0;
+}
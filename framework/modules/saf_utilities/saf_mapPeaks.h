@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_mapPeaks.h
+ * @brief Peak-picking and source tracking on maps over spherical grids (e.g.
+ *        the activity-maps of powermap or dirass)
+ *
+ * The neighbours of each grid point (i.e. the grid points within a given
+ * angle) are found once, when the instance is created. A map value is then a
+ * peak if it exceeds the values of all of its neighbours; and only the largest
+ * of these peaks are kept, with partialSortf(), rather than sorting the whole
+ * map.
+ *
+ * The tracker associates the peaks of each map with those of the previous
+ * maps (the closest pairs first, up to a maximum angle), such that a source
+ * keeps the same ID while it moves. A track that is not matched is held for a
+ * number of maps, before its ID is released.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_MAPPEAKS_H_INCLUDED
+#define SAF_MAPPEAKS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Creates an instance of the map peak-picker/tracker
+ *
+ * @param[in] phMP          (&) address of the map peaks handle
+ * @param[in] grid_dirs_deg Grid directions [azi elev], in DEGREES;
+ *                          FLAT: nGrid x 2
+ * @param[in] nGrid         Number of grid directions
+ * @param[in] nbrAngle_deg  Angle within which grid points are neighbours, in
+ *                          DEGREES (i.e. the minimum separation of two peaks);
+ *                          <=0: 1.5 times the largest distance from a grid
+ *                          point to its closest neighbour
+ * @param[in] maxNumPeaks   Maximum number of peaks (and tracks)
+ */
+void saf_mapPeaks_create(/* Input Arguments */
+                         void ** const phMP,
+                         float* grid_dirs_deg,
+                         int nGrid,
+                         float nbrAngle_deg,
+                         int maxNumPeaks);
+
+/**
+ * Destroys an instance of the map peak-picker/tracker
+ *
+ * @param[in] phMP (&) address of the map peaks handle
+ */
+void saf_mapPeaks_destroy(/* Input Arguments */
+                          void ** const phMP);
+
+/**
+ * Finds the largest peaks of a map
+ *
+ * @param[in]  hMP         Map peaks handle
+ * @param[in]  map         Map values; nGrid x 1
+ * @param[in]  nPeaks      Number of peaks to find; <= maxNumPeaks
+ * @param[in]  minRelLevel Peaks below this fraction of the largest peak are
+ *                         discarded; 0..1 (0: keep all peaks)
+ * @param[out] peakIdx     Grid indices of the peaks, largest first; nPeaks x 1
+ * @param[out] peakVals    Map values of the peaks (set to NULL if you don't
+ *                         want them); nPeaks x 1
+ * @returns Number of peaks found; 0..nPeaks
+ */
+int saf_mapPeaks_find(/* Input Arguments */
+                      void * const hMP,
+                      float* map,
+                      int nPeaks,
+                      float minRelLevel,
+                      /* Output Arguments */
+                      int* peakIdx,
+                      float* peakVals);
+
+/**
+ * Finds the largest peaks of a map (as saf_mapPeaks_find()), and associates
+ * them with the tracks of the previous maps
+ *
+ * @param[in]  hMP           Map peaks handle
+ * @param[in]  map           Map values; nGrid x 1
+ * @param[in]  nPeaks        Number of peaks to find; <= maxNumPeaks
+ * @param[in]  minRelLevel   See saf_mapPeaks_find()
+ * @param[in]  maxAngle_deg  Maximum angle a source may move between two maps,
+ *                           in DEGREES
+ * @param[in]  holdMaps      Number of maps for which a track is held if no
+ *                           peak is associated with it
+ * @param[out] trackIDs      ID of the track of each peak, largest peak first
+ *                           (IDs are never reused); nPeaks x 1
+ * @param[out] track_dirs_deg Directions of the peaks, in DEGREES;
+ *                           FLAT: nPeaks x 2
+ * @param[out] trackVals     Map values of the peaks (set to NULL if you don't
+ *                           want them); nPeaks x 1
+ * @returns Number of peaks found (each with a track); 0..nPeaks
+ */
+int saf_mapPeaks_track(/* Input Arguments */
+                       void * const hMP,
+                       float* map,
+                       int nPeaks,
+                       float minRelLevel,
+                       float maxAngle_deg,
+                       int holdMaps,
+                       /* Output Arguments */
+                       int* trackIDs,
+                       float* track_dirs_deg,
+                       float* trackVals);
+
+/** Discards all tracks (the IDs continue to increase) */
+void saf_mapPeaks_resetTracks(/* Input Arguments */
+                              void * const hMP);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_MAPPEAKS_H_INCLUDED */
@@ -25,6 +25,11 @@
 
 #include "saf_utilities.h"
 #include "saf_matrixConv.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
 
 
 /* ========================================================================== */
@@ -33,20 +38,241 @@
 
 /**
  * Data structure for the matrix convolver.
+ *
+ * In partitioned mode, the input spectra are stored in a frequency-domain
+ * delay-line (FDL), which is a ring buffer of numFilterBlocks slots that each
+ * hold nCHin spectra. The spectrum of each input block is therefore computed
+ * only once and reused for every output channel and partition. The products
+ * are then accumulated in the frequency domain, so that only one inverse FFT is
+ * required per output channel (regardless of the number of inputs/partitions).
+ *
+ * Only the spectra of the filters (or partitions) that are not entirely below
+ * SAF_MATRIXCONV_SPARSITY_THRESHOLD_DB are kept, packed per output channel.
+ * Each is indexed by partition*nCHin+input; numFilterBlocks is 1 if
+ * non-partitioned.
+ *
+ * Silent input blocks are not transformed (their FDL slot is zeroed instead),
+ * and once an input has been silent for 'nb'+1 blocks, its partition 'nb' is
+ * skipped (since it would only be applied to zeros); i.e. inputs that are
+ * silent for longer than the filters cost nothing.
  */
 typedef struct _safMatConv_data {
     int hopSize, fftSize, nBins;
     int length_h, nCHin, nCHout;
     int numFilterBlocks, numOvrlpAddBlocks;
+    int* nActive;      /**< number of active filters/partitions per output channel; nCHout x 1 */
+    int** activeIdx;   /**< partition*nCHin+input index of each; nCHout x nActive[no] */
     int usePartFLAG;
-    void* hFFT;
-    float* x_pad, *y_pad, *hx_n, *z_n, *ovrlpAddBuffer, *y_n_overlap;
-    float_complex* H_f, *X_n, *HX_n;
-    float_complex** Hpart_f;
+    int fdl_idx;   /**< FDL slot holding the most recent input spectra */
+    int* silentBlocks; /**< number of consecutive silent blocks of each input (up to numFilterBlocks); nCHin x 1 */
+    void* hPar;    /**< thread pool (see saf_matrixConv_setThreadPool()); NULL if single-threaded */
+    int nThreads;  /**< number of threads that 'hFFT', 'pairH', 'pairX' and 'Z_n' are allocated for */
+    int nSplit;    /**< number of shares that the filters of each output channel are split into (1, unless there are fewer
+                    *   output channels than threads) */
+    float_complex* Zpart_n; /**< partial sums of each share; FLAT: nCHout x nSplit x nBins (only if nSplit>1) */
+    int maxPairs;  /**< length of 'pairH' and 'pairX', per thread */
+    void** hFFT;   /**< one per thread */
+    float* ovrlpAddBuffer, *y_n_overlap;
+    float_complex* X_n;
+    const float_complex** pairH; /**< filter spectra passed to utility_cvvmacsum(); FLAT: nThreads x maxPairs */
+    const float_complex** pairX; /**< corresponding input spectra; FLAT: nThreads x maxPairs */
+    float_complex* Z_n;     /**< FLAT: nThreads x nBins; also holds the output of the (in-place) ifft */
+    float_complex** Hpart_f; /**< active filter spectra; nCHout x (nActive[no] x nBins) */
+    float* inputSig, *outputSig; /**< arguments of the current saf_matrixConv_apply() call */
     
 }safMatConv_data;
+
+/**
+ * Sums 'nVectors' consecutive complex vectors (each of length 'len') found in
+ * 'A' and places the result in 'z'
+ */
+static void sumSpectra
+(
+    float_complex* A,
+    int nVectors,
+    int len,
+    float_complex* z
+)
+{
+    int i;
+    
+    utility_cvvcopy(A, len, z);
+    for(i=1; i<nVectors; i++)
+        utility_cvvadd(z, (const float_complex*)&(A[i*len]), len, z);
+}
+
+/**
+ * Applies the 'numParts' filter partitions 'H_f' to the FDL 'X_n' (partition
+ * 'nb' to slot fdl_idx+nb, wrapped), and sums them into 'z'; 'pairH' and
+ * 'pairX' (numParts x 1) are scratch for utility_cvvmacsum()
+ */
+static void fdlMacSum
+(
+    const float_complex* H_f, /* numParts x nBins */
+    const float_complex* X_n, /* numParts x nBins */
+    int numParts,
+    int fdl_idx,
+    int nBins,
+    const float_complex** pairH,
+    const float_complex** pairX,
+    float_complex* z
+)
+{
+    int nb, slot;
+    
+    for(nb=0; nb<numParts; nb++){
+        slot = fdl_idx + nb;
+        slot = slot >= numParts ? slot - numParts : slot;
+        pairH[nb] = &(H_f[nb*nBins]);
+        pairX[nb] = &(X_n[slot*nBins]);
+    }
+    utility_cvvmacsum(pairH, pairX, numParts, nBins, z); /* This is the bulk of the CPU work */
+}
+
+/** In-memory filters, as read by matrixConv_readMemory() */
+typedef struct _matrixConv_memReader {
+    float* H;         /**< FLAT: nCHout x nCHin x length_h */
+    int length_h, nCHin, nCHout;
+    
+}matrixConv_memReader;
+
+/** saf_matrixConv_readFunc for filters held in memory, in output-major order (saf_matrixConv_create()) */
+static void matrixConv_readMemory
+(
+    void* const hReader,
+    int ni,
+    int offset,
+    int len,
+    float* H_seg
+)
+{
+    matrixConv_memReader* r = (matrixConv_memReader*)hReader;
+    int no;
+    
+    for(no=0; no<r->nCHout; no++)
+        memcpy(&H_seg[no*len], &(r->H[(no*(r->nCHin)+ni)*(r->length_h)+offset]), len*sizeof(float));
+}
+
+/** saf_matrixConv_readFunc for filters held in memory, in input-major order (saf_matrixConv_createFromSources()) */
+static void matrixConv_readMemorySources
+(
+    void* const hReader,
+    int ni,
+    int offset,
+    int len,
+    float* H_seg
+)
+{
+    matrixConv_memReader* r = (matrixConv_memReader*)hReader;
+    int no;
+
+    for(no=0; no<r->nCHout; no++)
+        memcpy(&H_seg[no*len], &(r->H[(ni*(r->nCHout)+no)*(r->length_h)+offset]), len*sizeof(float));
+}
+
+/**
+ * Finds the peak absolute value of the filters, and their effective length
+ * (the last sample above the sparsity threshold, over all filters); reading
+ * them one hop at a time. Returns the threshold.
+ */
+static float matrixConv_scanFilters
+(
+    safMatConv_data* h,
+    saf_matrixConv_readFunc readFunc,
+    void* const hReader,
+    int length_h,
+    float* H_seg      /* nCHout x hopSize */
+)
+{
+    int ni, nb, i, j, len, nSeg, lastSeg;
+    float thresh, *segPeak;
+    
+    /* peak of each hop-sized segment, over all filters */
+    nSeg = (int)ceilf((float)length_h/(float)h->hopSize);
+    segPeak = calloc1d(nSeg, sizeof(float));
+    for(ni=0; ni<h->nCHin; ni++){
+        for(nb=0; nb<nSeg; nb++){
+            len = MIN(h->hopSize, length_h-nb*(h->hopSize));
+            readFunc(hReader, ni, nb*(h->hopSize), len, H_seg);
+            for(i=0; i<(h->nCHout)*len; i++)
+                segPeak[nb] = MAX(segPeak[nb], fabsf(H_seg[i]));
+        }
+    }
+    thresh = 0.0f;
+    for(nb=0; nb<nSeg; nb++)
+        thresh = MAX(thresh, segPeak[nb]);
+    thresh *= powf(10.0f, SAF_MATRIXCONV_SPARSITY_THRESHOLD_DB/20.0f);
+    
+    /* rescan the last segment above the threshold, for the exact length */
+    h->length_h = 1;
+    for(lastSeg=nSeg-1; lastSeg>=0 && !(segPeak[lastSeg] > thresh); lastSeg--);
+    if(lastSeg>=0){
+        len = MIN(h->hopSize, length_h-lastSeg*(h->hopSize));
+        for(ni=0; ni<h->nCHin; ni++){
+            readFunc(hReader, ni, lastSeg*(h->hopSize), len, H_seg);
+            for(i=0; i<h->nCHout; i++)
+                for(j=len-1; j>=0 && lastSeg*(h->hopSize)+j>=h->length_h; j--)
+                    if(fabsf(H_seg[i*len+j]) > thresh){
+                        h->length_h = lastSeg*(h->hopSize)+j+1;
+                        break;
+                    }
+        }
+    }
+    free(segPeak);
+    return thresh;
+}
+
+/**
+ * Transforms the filters (or their partitions of 'partSize' samples) that are
+ * above 'thresh', and packs them into Hpart_f (see safMatConv_data); reading
+ * one partition of all output channels at a time
+ */
+static void matrixConv_packFilters
+(
+    safMatConv_data* h,
+    saf_matrixConv_readFunc readFunc,
+    void* const hReader,
+    int partSize,
+    float thresh
+)
+{
+    int no, ni, nb, i, k, len, active;
+    float* H_seg, *h_part;
+    
+    H_seg = malloc1d((h->nCHout)*partSize*sizeof(float));
+    h->nActive = calloc1d(h->nCHout, sizeof(int));
+    h->activeIdx = malloc1d(h->nCHout*sizeof(int*));
+    h->Hpart_f = malloc1d(h->nCHout*sizeof(float_complex*));
+    for(no=0; no<h->nCHout; no++){
+        h->activeIdx[no] = malloc1d(h->numFilterBlocks*(h->nCHin)*sizeof(int));
+        h->Hpart_f[no] = malloc1d(h->numFilterBlocks*(h->nCHin)*(h->nBins)*sizeof(float_complex));
+    }
+    for(nb=0; nb<h->numFilterBlocks; nb++){
+        for(ni=0; ni<h->nCHin; ni++){
+            /* (the last partition is zero padded, if the filters are not a multiple of the hopsize) */
+            len = MIN(partSize, h->length_h-nb*partSize);
+            readFunc(hReader, ni, nb*partSize, len, H_seg);
+            for(no=0; no<h->nCHout; no++){
+                h_part = &H_seg[no*len];
+                for(i=0, active=0; i<len && !active; i++)
+                    active = fabsf(h_part[i]) > thresh;
+                if(active){
+                    k = h->nActive[no]++;
+                    saf_rfft_forward_zp(h->hFFT[0], h_part, len, &(h->Hpart_f[no][k*(h->nBins)]));
+                    h->activeIdx[no][k] = nb*(h->nCHin)+ni;
+                }
+            }
+        }
+    }
+    for(no=0; no<h->nCHout; no++){
+        k = h->nActive[no];
+        h->activeIdx[no] = realloc1d(h->activeIdx[no], MAX(k,1)*sizeof(int));
+        h->Hpart_f[no] = realloc1d(h->Hpart_f[no], MAX(k,1)*(h->nBins)*sizeof(float_complex));
+    }
+    free(H_seg);
+}
  
-void  saf_matrixConv_create
+void saf_matrixConv_create
 (
     void ** const phMC,
     int hopSize,
@@ -56,76 +282,107 @@ void  saf_matrixConv_create
     int nCHout,
     int usePartFLAG
 )
+{
+    matrixConv_memReader r;
+    
+    r.H = H;
+    r.length_h = length_h;
+    r.nCHin = nCHin;
+    r.nCHout = nCHout;
+    saf_matrixConv_createFromReader(phMC, hopSize, &matrixConv_readMemory, (void*)&r, length_h, nCHin, nCHout, usePartFLAG);
+}
+
+void saf_matrixConv_createFromSources
+(
+    void ** const phMC,
+    int hopSize,
+    float* H,         /* nCHin x nCHout x length_h */
+    int length_h,
+    int nCHin,
+    int nCHout,
+    int usePartFLAG
+)
+{
+    matrixConv_memReader r;
+
+    r.H = H;
+    r.length_h = length_h;
+    r.nCHin = nCHin;
+    r.nCHout = nCHout;
+    saf_matrixConv_createFromReader(phMC, hopSize, &matrixConv_readMemorySources, (void*)&r, length_h, nCHin, nCHout, usePartFLAG);
+}
+
+void saf_matrixConv_createFromReader
+(
+    void ** const phMC,
+    int hopSize,
+    saf_matrixConv_readFunc readFunc,
+    void * const hReader,
+    int length_h,
+    int nCHin,
+    int nCHout,
+    int usePartFLAG
+)
 {
     *phMC = malloc1d(sizeof(safMatConv_data));
     safMatConv_data *h = (safMatConv_data*)(*phMC);
-    int no, ni, nb;
-    float* h_pad, *h_pad_2hops;
+    float thresh;
+    float* H_seg;
     
+    /* truncate the filters to their effective length */
     h->hopSize = hopSize;
-    h->length_h = length_h;
     h->nCHin = nCHin;
     h->nCHout = nCHout;
+    H_seg = malloc1d(nCHout*hopSize*sizeof(float));
+    thresh = matrixConv_scanFilters(h, readFunc, hReader, length_h, H_seg);
+    free(H_seg);
+    
     h->usePartFLAG = usePartFLAG;
-    if(hopSize>length_h && h->usePartFLAG)
+    if(hopSize>h->length_h && h->usePartFLAG)
         h->usePartFLAG = 0; /* no benefit in partitioning in this case */
+    h->hPar = NULL;
+    h->nThreads = 1;
+    h->nSplit = 1;
+    h->Zpart_n = NULL;
+    h->hFFT = malloc1d(sizeof(void*));
+    h->silentBlocks = calloc1d(nCHin, sizeof(int));
     
     if(!h->usePartFLAG){
         /* intialise non-partitioned convolution mode */
-        h->numOvrlpAddBlocks = (int)(ceilf((float)(hopSize+length_h-1)/(float)hopSize)+0.1f);
+        h->numOvrlpAddBlocks = (int)(ceilf((float)(hopSize+h->length_h-1)/(float)hopSize)+0.1f);
         h->fftSize = (h->numOvrlpAddBlocks)*hopSize;
         h->nBins = h->fftSize/2 + 1;
+        h->numFilterBlocks = 1;
+        h->fdl_idx = 0;
         
         /* Allocate memory for buffers and perform fft on H */
         h->ovrlpAddBuffer = calloc1d(nCHout*(h->fftSize), sizeof(float));
-        h->x_pad = calloc1d((h->nCHin)*(h->fftSize), sizeof(float)); // CALLOC
-        h->y_pad = malloc1d((h->nCHout)*(h->fftSize)*sizeof(float));
-        h->hx_n = malloc1d((h->fftSize) * sizeof(float));
-        h->H_f = malloc1d((h->nCHout)*(h->nCHin)*(h->nBins)*sizeof(float_complex));
         h->X_n = malloc1d((h->nCHin)*(h->nBins)*sizeof(float_complex));
-        h->HX_n = malloc1d((h->nBins)*sizeof(float_complex));
-        h->z_n = malloc1d((h->fftSize) * sizeof(float));
-        saf_rfft_create(&(h->hFFT), h->fftSize);
-        h_pad = calloc1d(h->fftSize, sizeof(float));
-        for(no=0; no<nCHout; no++){
-            for(ni=0; ni<nCHin; ni++){
-                memcpy(h_pad, &(H[no*nCHin*length_h+ni*length_h]), length_h*sizeof(float));
-                saf_rfft_forward(h->hFFT, h_pad, &(h->H_f[no*nCHin*(h->nBins)+ni*(h->nBins)]));
-            }
-        }
-        free(h_pad);
+        h->maxPairs = h->nCHin;
+        h->pairH = malloc1d(h->maxPairs*sizeof(float_complex*));
+        h->pairX = malloc1d(h->maxPairs*sizeof(float_complex*));
+        h->Z_n = malloc1d((h->nBins)*sizeof(float_complex));
+        saf_rfft_create(&(h->hFFT[0]), h->fftSize);
+        matrixConv_packFilters(h, readFunc, hReader, h->length_h, thresh);
     }
     else{
-        /* intialise partitioned convolution mode */
+        /* intialise partitioned convolution mode. Note that the hopsize is not
+         * required to be a power of 2 (e.g. 480 or 960 are fine) */
         h->fftSize = 2*(h->hopSize);
         h->nBins = hopSize+1;
-        h->numFilterBlocks = (int)ceilf((float)length_h/(float)hopSize); /* number of partitions */
+        h->numFilterBlocks = (int)ceilf((float)h->length_h/(float)hopSize); /* number of partitions */
         assert(h->numFilterBlocks>=1);
+        h->fdl_idx = 0;
         
         /* Allocate memory for buffers and perform fft on partitioned H */
-        h_pad = calloc1d(h->numFilterBlocks * hopSize, sizeof(float));
-        h_pad_2hops = calloc1d(2 * hopSize, sizeof(float));
-        h->Hpart_f = malloc1d(nCHout*sizeof(float_complex*));
-        h->X_n = calloc1d(h->numFilterBlocks * nCHin * (h->nBins), sizeof(float_complex));
-        h->HX_n = malloc1d(h->numFilterBlocks * nCHin * (h->nBins) * sizeof(float_complex));
-        h->x_pad = calloc1d(2 * hopSize, sizeof(float));
-        h->hx_n = malloc1d(h->numFilterBlocks*nCHin*(h->fftSize)*sizeof(float));
+        h->X_n = calloc1d(h->numFilterBlocks * nCHin * (h->nBins), sizeof(float_complex)); /* FDL */
+        h->maxPairs = h->numFilterBlocks * nCHin;
+        h->pairH = malloc1d(h->maxPairs * sizeof(float_complex*));
+        h->pairX = malloc1d(h->maxPairs * sizeof(float_complex*));
+        h->Z_n = malloc1d((h->nBins) * sizeof(float_complex));
         h->y_n_overlap = calloc1d(nCHout*hopSize, sizeof(float));
-        h->z_n = malloc1d((h->fftSize) * sizeof(float));
-        saf_rfft_create(&(h->hFFT), h->fftSize);
-        for(no=0; no<nCHout; no++){
-            h->Hpart_f[no] = malloc1d(h->numFilterBlocks*nCHin*(h->nBins)*sizeof(float_complex));
-            for(ni=0; ni<nCHin; ni++){
-                memcpy(h_pad, &H[no*nCHin*length_h+ni*length_h], length_h*sizeof(float)); /* zero pad filter, to be multiple of hopsize */
-                for (nb=0; nb<h->numFilterBlocks; nb++){
-                    memcpy(h_pad_2hops, &(h_pad[nb*hopSize]), hopSize*sizeof(float));
-                    saf_rfft_forward(h->hFFT, h_pad_2hops, &(h->Hpart_f[no][nb*nCHin*(h->nBins)+ni*(h->nBins)]));
-                }
-            }
-        }
-        
-        free(h_pad);
-        free(h_pad_2hops);
+        saf_rfft_create(&(h->hFFT[0]), h->fftSize);
+        matrixConv_packFilters(h, readFunc, hReader, hopSize, thresh);
     }
 }
 
@@ -135,118 +392,625 @@ void saf_matrixConv_destroy
 )
 {
     safMatConv_data *h = (safMatConv_data*)(*phMC);
-    int no;
+    int no, t;
     
     if(h!=NULL){
-        saf_rfft_destroy(&(h->hFFT));
+        for(t=0; t<h->nThreads; t++)
+            saf_rfft_destroy(&(h->hFFT[t]));
+        free(h->hFFT);
         free(h->X_n);
-        free(h->x_pad);
-        free(h->z_n);
-        free(h->hx_n);
-        free(h->HX_n);
-        if(!h->usePartFLAG){
+        free(h->silentBlocks);
+        free(h->pairH);
+        free(h->pairX);
+        free(h->Z_n);
+        free(h->Zpart_n);
+        if(!h->usePartFLAG)
             free(h->ovrlpAddBuffer);
-            free(h->y_pad);
-            free(h->H_f);
-        }
-        else{
+        else
             free(h->y_n_overlap);
-            for(no=0; no<h->nCHout; no++)
-                free(h->Hpart_f[no]);
-            free(h->Hpart_f);
+        for(no=0; no<h->nCHout; no++){
+            free(h->Hpart_f[no]);
+            free(h->activeIdx[no]);
         }
+        free(h->Hpart_f);
+        free(h->activeIdx);
+        free(h->nActive);
         free(h);
         h=NULL;
     }
 }
 
-void saf_matrixConv_apply
+void saf_matrixConv_setThreadPool
 (
     void * const hMC,
-    float* inputSig,
-    float* outputSig
+    void * const hPar
 )
 {
     safMatConv_data *h = (safMatConv_data*)(hMC);
-    int ni, no, nb;
+    int t, no, nThreads, maxActive;
     
-    /* apply non-partitioned convolution */
-    if(!h->usePartFLAG){
-        /* zero-pad input signals and perform fft */
-        for(ni=0; ni<h->nCHin; ni++){
-            memcpy(&(h->x_pad[ni*(h->fftSize)]), &inputSig[ni*(h->hopSize)], h->hopSize *sizeof(float));
-            saf_rfft_forward(h->hFFT, &(h->x_pad[ni*(h->fftSize)]), &(h->X_n[ni*(h->nBins)]));
+    nThreads = saf_parfor_getNumThreads(hPar);
+    
+    /* if there are fewer output channels than threads, then the filters of each output channel are also split into
+     * shares (but no more shares than there are active filters/partitions) */
+    for(no=0, maxActive=1; no<h->nCHout; no++)
+        maxActive = MAX(maxActive, h->nActive[no]);
+    h->nSplit = h->nCHout < nThreads ? MIN((nThreads + h->nCHout - 1) / h->nCHout, maxActive) : 1;
+    free(h->Zpart_n);
+    h->Zpart_n = h->nSplit > 1 ? malloc1d((h->nCHout)*(h->nSplit)*(h->nBins)*sizeof(float_complex)) : NULL;
+    for(t=nThreads; t<h->nThreads; t++)
+        saf_rfft_destroy(&(h->hFFT[t]));
+    h->hFFT = realloc1d(h->hFFT, nThreads*sizeof(void*));
+    for(t=h->nThreads; t<nThreads; t++)
+        saf_rfft_create(&(h->hFFT[t]), h->fftSize);
+    h->pairH = realloc1d(h->pairH, nThreads*(h->maxPairs)*sizeof(float_complex*));
+    h->pairX = realloc1d(h->pairX, nThreads*(h->maxPairs)*sizeof(float_complex*));
+    h->Z_n = realloc1d(h->Z_n, nThreads*(h->nBins)*sizeof(float_complex));
+    h->nThreads = nThreads;
+    h->hPar = hPar;
+}
+
+/**
+ * Transforms the input channels [first, last) into the FDL slot 'fdl_idx' (or
+ * into X_n, if non-partitioned); called via saf_parfor_run()
+ */
+static void matrixConv_inputRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    safMatConv_data *h = (safMatConv_data*)(hCtx);
+    int ni, i, offset;
+    float* x;
+    
+    offset = h->usePartFLAG ? (h->fdl_idx)*(h->nCHin)*(h->nBins) : 0;
+    for(ni=first; ni<last; ni++){
+        x = &(h->inputSig[ni*(h->hopSize)]);
+        for(i=0; i<h->hopSize && x[i]==0.0f; i++);
+        if(i<h->hopSize){
+            h->silentBlocks[ni] = 0;
+            saf_rfft_forward_zp(h->hFFT[threadIndex], x, h->hopSize, &(h->X_n[offset + ni*(h->nBins)]));
         }
+        else if(h->silentBlocks[ni]<h->numFilterBlocks){
+            /* (once silent for numFilterBlocks blocks, the slots of this input are all zeros already) */
+            h->silentBlocks[ni]++;
+            memset(&(h->X_n[offset + ni*(h->nBins)]), 0, (h->nBins)*sizeof(float_complex));
+        }
+    }
+}
+
+/**
+ * Applies the active filters [kFirst, kLast) of output channel 'no'
+ * (partition 'nb' to FDL slot fdl_idx+nb, wrapped), and sums over the input
+ * channels and partitions in the frequency domain; placing the result in Z_n.
+ * 'threadIndex' selects the pairH/pairX scratch
+ */
+static void matrixConv_accumulate
+(
+    safMatConv_data *h,
+    int threadIndex,
+    int no,
+    int kFirst,
+    int kLast,
+    float_complex* Z_n
+)
+{
+    int k, nb, ni, slot, blockLen, nPairs;
+    const float_complex** pairH, **pairX;
+    
+    pairH = &(h->pairH[threadIndex*(h->maxPairs)]);
+    pairX = &(h->pairX[threadIndex*(h->maxPairs)]);
+    blockLen = (h->nCHin)*(h->nBins);
+    nPairs = 0;
+    for(k=kFirst; k<kLast; k++){
+        nb = h->activeIdx[no][k] / (h->nCHin);
+        ni = h->activeIdx[no][k] - nb*(h->nCHin);
+        if(h->silentBlocks[ni]>nb)
+            continue; /* (this partition would only be applied to zeros) */
+        slot = h->fdl_idx + nb;
+        slot = slot >= h->numFilterBlocks ? slot - h->numFilterBlocks : slot;
+        pairH[nPairs] = &(h->Hpart_f[no][k*(h->nBins)]);
+        pairX[nPairs] = &(h->X_n[slot*blockLen + ni*(h->nBins)]);
+        nPairs++;
+    }
+    utility_cvvmacsum(pairH, pairX, nPairs, h->nBins, Z_n); /* This is the bulk of the CPU work */
+}
+
+/**
+ * Computes the partial sums of the shares [first, last) of the filters of
+ * each output channel (share s of output no being index no*nSplit+s); called
+ * via saf_parfor_runDynamic()
+ */
+static void matrixConv_shareRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    safMatConv_data *h = (safMatConv_data*)(hCtx);
+    int i, no, s;
+    
+    for(i=first; i<last; i++){
+        no = i / (h->nSplit);
+        s = i - no*(h->nSplit);
+        matrixConv_accumulate(h, threadIndex, no, s*(h->nActive[no])/(h->nSplit), (s+1)*(h->nActive[no])/(h->nSplit),
+                              &(h->Zpart_n[i*(h->nBins)]));
+    }
+}
+
+/**
+ * Computes the output channels [first, last), using the scratch buffers of
+ * 'threadIndex'; called via saf_parfor_runDynamic() (or via saf_parfor_run(),
+ * to sum the partial sums of matrixConv_shareRange(), if nSplit>1)
+ */
+static void matrixConv_outputRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    safMatConv_data *h = (safMatConv_data*)(hCtx);
+    int no;
+    float* z_n;
+    float_complex* Z_n;
+    
+    Z_n = &(h->Z_n[threadIndex*(h->nBins)]);
+    z_n = (float*)Z_n;
+    
+    for(no=first; no<last; no++){
+        /* frequency-domain sum over the input channels and partitions, then perform ifft */
+        if(h->nActive[no]>0){
+            if(h->nSplit>1)
+                sumSpectra(&(h->Zpart_n[no*(h->nSplit)*(h->nBins)]), h->nSplit, h->nBins, Z_n);
+            else
+                matrixConv_accumulate(h, threadIndex, no, 0, h->nActive[no], Z_n);
+            saf_rfft_backward_inplace(h->hFFT[threadIndex], z_n);
+        }
+        else
+            memset(z_n, 0, h->fftSize*sizeof(float));
         
-        for(no=0; no<h->nCHout; no++){
-            /* Apply filter and perform ifft, and sum over input channels */
-            memset(h->z_n, 0, (h->fftSize) * sizeof(float));
-            for(ni=0; ni<h->nCHin; ni++){
-                utility_cvvmul(&(h->H_f[no*(h->nCHin)*(h->nBins)+ni*(h->nBins)]), &(h->X_n[ni*(h->nBins)]), h->nBins, h->HX_n); /* This is the bulk of the CPU work */
-                saf_rfft_backward(h->hFFT, h->HX_n, h->hx_n);
-                utility_svvadd(h->z_n,  h->hx_n, h->fftSize, h->z_n);
-            }
-            
+        /* non-partitioned: */
+        if(!h->usePartFLAG){
             /* over-lap add buffer */
-            memcpy(&(h->ovrlpAddBuffer[no*(h->fftSize)]), &(h->ovrlpAddBuffer[no*(h->fftSize)+(h->hopSize)]), (h->numOvrlpAddBlocks-1)*(h->hopSize)*sizeof(float));
+            memmove(&(h->ovrlpAddBuffer[no*(h->fftSize)]), &(h->ovrlpAddBuffer[no*(h->fftSize)+(h->hopSize)]), (h->numOvrlpAddBlocks-1)*(h->hopSize)*sizeof(float));
             memset(&(h->ovrlpAddBuffer[no*(h->fftSize)+(h->numOvrlpAddBlocks-1)*(h->hopSize)]), 0, (h->hopSize)*sizeof(float));
 
             /* sum with overlap buffer and copy the result to the output buffer */
-            utility_svvadd(&(h->ovrlpAddBuffer[no*(h->fftSize)]),  h->z_n, (h->fftSize), &(h->ovrlpAddBuffer[no*(h->fftSize)]));
+            utility_svvadd(&(h->ovrlpAddBuffer[no*(h->fftSize)]),  z_n, (h->fftSize), &(h->ovrlpAddBuffer[no*(h->fftSize)]));
 
             /* truncate buffer and output */
-            memcpy(&(outputSig[no*(h->hopSize)]), &(h->ovrlpAddBuffer[no*(h->fftSize)]), h->hopSize*sizeof(float));
-        }
-    }
-    /* apply partitioned convolution */
-    else{
-        /* zero-pad input signals and perform fft. Store in partition slot 1. */
-        memcpy(&(h->X_n[1*(h->nCHin)*(h->nBins)]), h->X_n, (h->numFilterBlocks-1)*(h->nCHin)*(h->nBins)*sizeof(float_complex)); /* shuffle */
-        for(ni=0; ni<h->nCHin; ni++){
-            memcpy(h->x_pad, &(inputSig[ni*(h->hopSize)]), h->hopSize *sizeof(float));
-            saf_rfft_forward(h->hFFT, h->x_pad, &(h->X_n[0*(h->nCHin)*(h->nBins)+ni*(h->nBins)]));
+            memcpy(&(h->outputSig[no*(h->hopSize)]), &(h->ovrlpAddBuffer[no*(h->fftSize)]), h->hopSize*sizeof(float));
         }
-        
-        /* apply convolution and inverse fft */
-        for(no=0; no<h->nCHout; no++){
-            utility_cvvmul(h->Hpart_f[no], h->X_n, h->numFilterBlocks * (h->nCHin) * (h->nBins), h->HX_n); /* This is the bulk of the CPU work */
-            for(nb=0; nb<h->numFilterBlocks; nb++)
-                for(ni=0; ni<h->nCHin; ni++)
-                    saf_rfft_backward(h->hFFT, &(h->HX_n[nb*(h->nCHin)*(h->nBins)+ni*(h->nBins)]), &(h->hx_n[nb*(h->nCHin)*(h->fftSize)+ni*(h->fftSize)]));
-            
-            /* output frame for this channel is the sum over all partitions and input channels */
-            memset(h->z_n, 0, (h->fftSize) * sizeof(float));
-            for(nb=0; nb<h->numFilterBlocks*(h->nCHin); nb++)
-                utility_svvadd(h->z_n, (const float*)&(h->hx_n[nb*(h->fftSize)]), h->fftSize, h->z_n);
-
+        /* partitioned: */
+        else{
             /* sum with overlap buffer and copy the result to the output buffer */
-            utility_svvadd(h->z_n, (const float*)&(h->y_n_overlap[no*(h->hopSize)]), h->hopSize, &(outputSig[no*(h->hopSize)]));
+            utility_svvadd(z_n, (const float*)&(h->y_n_overlap[no*(h->hopSize)]), h->hopSize, &(h->outputSig[no*(h->hopSize)]));
 
             /* for next iteration: */
-            memcpy(&(h->y_n_overlap[no*(h->hopSize)]), &(h->z_n[h->hopSize]), h->hopSize*sizeof(float));
+            memcpy(&(h->y_n_overlap[no*(h->hopSize)]), &(z_n[h->hopSize]), h->hopSize*sizeof(float));
         }
     }
 }
 
+void saf_matrixConv_apply
+(
+    void * const hMC,
+    float* inputSig,
+    float* outputSig
+)
+{
+    safMatConv_data *h = (safMatConv_data*)(hMC);
+    
+    h->inputSig = inputSig;
+    h->outputSig = outputSig;
+    
+    /* for partitioned convolution: move the FDL write position back by one
+     * slot (instead of shuffling the whole buffer) */
+    if(h->usePartFLAG)
+        h->fdl_idx = (h->fdl_idx + h->numFilterBlocks - 1) % h->numFilterBlocks;
+    
+    /* perform fft on the (implicitly) zero-padded input signals, and then
+     * compute the output channels; each spread over the threads (if any).
+     * Since the number of active filters may differ between the output
+     * channels, these are taken by whichever thread is free */
+    saf_parfor_run(h->hPar, &matrixConv_inputRange, hMC, h->nCHin);
+    if(h->nSplit>1){
+        saf_parfor_runDynamic(h->hPar, &matrixConv_shareRange, hMC, (h->nCHout)*(h->nSplit), 1);
+        saf_parfor_run(h->hPar, &matrixConv_outputRange, hMC, h->nCHout);
+    }
+    else
+        saf_parfor_runDynamic(h->hPar, &matrixConv_outputRange, hMC, h->nCHout, 1);
+}
+
 
 /* ========================================================================== */
 /*                           Multi-Channel Convolver                          */
 /* ========================================================================== */
 
+/** Growth factor of the partition size between successive tail levels */
+#define NUPOLS_GROWTH_FACTOR ( 4 )
+/** Partition sizes stop growing once they reach this many samples; the final
+ *  tail level then covers the remainder of the filters */
+#define NUPOLS_MAX_PART_SIZE ( 16384 )
+/** Maximum number of tail levels */
+#define NUPOLS_MAX_NUM_TAIL_LEVELS ( 8 )
+
+/**
+ * Data structure for one uniformly-partitioned convolution level.
+ *
+ * The level applies a segment of the filters (starting at some sample offset)
+ * using uniform partitions of 'blockSize' samples, and a frequency-domain
+ * delay-line (FDL) of input spectra. The output is the convolution with this
+ * segment alone (i.e. without the offset delay).
+ */
+typedef struct _safConvLevel {
+    int nCH, blockSize, fftSize, nBins;
+    int numParts; /**< number of partitions */
+    int fdl_idx;  /**< FDL slot holding the most recent input spectra */
+    void* hFFT;
+    float* y_n_overlap;
+    float_complex* Hpart_f; /**< FLAT: nCH x numParts x nBins */
+    float_complex* X_n;     /**< FDL; FLAT: nCH x numParts x nBins */
+    const float_complex** pairH, **pairX; /**< fdlMacSum() scratch; numParts x 1 */
+    float_complex* Z_n;     /**< also holds the output of the (in-place) ifft */
+    
+}safConvLevel;
+
+/**
+ * Data structure for a tail level of the non-uniform partitioned convolver.
+ *
+ * A tail level with partition size B only processes every B samples. The level
+ * is always placed at a filter offset of (at least) 2B samples, which means
+ * that its output is not required until one full period after the input block
+ * was submitted. Therefore, the computation may be carried out on a worker
+ * thread, while the audio thread only gathers input and reads out the previous
+ * result.
+ */
+typedef struct _safConvTail {
+    safConvLevel* level;
+    int period;   /**< number of hops per partition of this level */
+    int counter;  /**< current hop index within the period */
+    float* inBuf, *jobIn;   /**< input gathering / worker input; nCH x B */
+    float* outBuf, *jobOut; /**< output read-out / worker output; nCH x B */
+    /* worker thread */
+    int threadRunning, jobPending, exitFlag;
+#if defined(_WIN32)
+    HANDLE thread;
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+    
+}safConvTail;
+
 /**
  * Data structure for the multi-channel convolver.
  */
 typedef struct _safMulConv_data {
     int hopSize, fftSize, nBins;
     int length_h, nCH;
-    int numOvrlpAddBlocks, numFilterBlocks;
+    int numOvrlpAddBlocks;
     int usePartFLAG;
+    int useDirectForm;   /**< 1: direct-form FIR (see SAF_CONV_DIRECT_FORM_MAX_LENGTH), 0: fft-based */
+    float* H_td;         /**< direct-form: filters; FLAT: nCH x length_h */
+    float* x_hist;       /**< direct-form: last length_h-1 input samples followed by the current hop; FLAT: nCH x
+                          *   (length_h-1+hopSize) */
     void* hFFT;
-    float* x_pad, *z_n, *ovrlpAddBuffer, *hx_n, *y_n_overlap;
-    float_complex* X_n, *HX_n, *Z_n, *H_f, *Hpart_f;
+    float* ovrlpAddBuffer;
+    float_complex* X_n, *H_f;
+    float_complex* Z_n;  /**< also holds the output of the (in-place) iffts */
+    /* partitioned modes */
+    safConvLevel* head;  /**< head level (operates at the hop size) */
+    int numTailLevels;   /**< number of tail levels (non-uniform mode) */
+    safConvTail* tail[NUPOLS_MAX_NUM_TAIL_LEVELS]; /**< tail levels */
     
 }safMulConv_data;
 
+static void convLevel_create
+(
+    safConvLevel** const phCL,
+    int blockSize,
+    float* H,         /* nCH x length_h */
+    int length_h,
+    int nCH,
+    int offset,
+    int segLength
+)
+{
+    *phCL = malloc1d(sizeof(safConvLevel));
+    safConvLevel *h = (*phCL);
+    int nc, nb, len;
+    
+    h->nCH = nCH;
+    h->blockSize = blockSize;
+    h->fftSize = 2*blockSize;
+    h->nBins = blockSize+1;
+    h->numParts = (int)ceilf((float)segLength/(float)blockSize);
+    assert(h->numParts>=1);
+    h->fdl_idx = 0;
+    
+    /* Allocate memory for buffers and perform fft on partitioned H */
+    h->Hpart_f = calloc1d(nCH * (h->numParts) * (h->nBins), sizeof(float_complex));
+    h->X_n = calloc1d(nCH * (h->numParts) * (h->nBins), sizeof(float_complex));
+    h->pairH = malloc1d((h->numParts) * sizeof(float_complex*));
+    h->pairX = malloc1d((h->numParts) * sizeof(float_complex*));
+    h->Z_n = malloc1d((h->nBins) * sizeof(float_complex));
+    h->y_n_overlap = calloc1d(nCH * blockSize, sizeof(float));
+    saf_rfft_create(&(h->hFFT), h->fftSize);
+    for(nc=0; nc<nCH; nc++){
+        for (nb=0; nb<h->numParts; nb++){
+            /* zero pad the last partition, if the segment is not a multiple of the block size */
+            len = MIN(blockSize, MIN(segLength, length_h-offset) - nb*blockSize);
+            saf_rfft_forward_zp(h->hFFT, &(H[nc*length_h + offset + nb*blockSize]), MAX(len, 0),
+                                &(h->Hpart_f[nc*(h->numParts)*(h->nBins) + nb*(h->nBins)]));
+        }
+    }
+}
+
+static void convLevel_destroy
+(
+    safConvLevel** const phCL
+)
+{
+    safConvLevel *h = (*phCL);
+    
+    if(h!=NULL){
+        saf_rfft_destroy(&(h->hFFT));
+        free(h->Hpart_f);
+        free(h->X_n);
+        free(h->pairH);
+        free(h->pairX);
+        free(h->Z_n);
+        free(h->y_n_overlap);
+        free(h);
+        (*phCL) = NULL;
+    }
+}
+
+static void convLevel_apply
+(
+    safConvLevel* const h,
+    float* inputSig,  /* nCH x blockSize */
+    float* outputSig  /* nCH x blockSize */
+)
+{
+    int nc, chLen;
+    float* z_n;
+    float_complex* X_ch, *H_ch;
+    
+    z_n = (float*)h->Z_n;
+    chLen = (h->numParts)*(h->nBins);
+    h->fdl_idx = (h->fdl_idx + h->numParts - 1) % h->numParts;
+    for(nc=0; nc<h->nCH; nc++){
+        X_ch = &(h->X_n[nc*chLen]);
+        H_ch = &(h->Hpart_f[nc*chLen]);
+        
+        /* perform fft on the zero-padded input signal. Store in the current FDL slot */
+        saf_rfft_forward_zp(h->hFFT, &(inputSig[nc*(h->blockSize)]), h->blockSize, &(X_ch[(h->fdl_idx)*(h->nBins)]));
+        
+        /* apply convolution, sum over partitions, and inverse fft */
+        fdlMacSum(H_ch, X_ch, h->numParts, h->fdl_idx, h->nBins, h->pairH, h->pairX, h->Z_n);
+        saf_rfft_backward_inplace(h->hFFT, z_n);
+        
+        /* sum with overlap buffer and copy the result to the output buffer */
+        utility_svvadd(z_n, (const float*)&(h->y_n_overlap[nc*(h->blockSize)]), h->blockSize, &(outputSig[nc*(h->blockSize)]));
+        
+        /* for next iteration: */
+        memcpy(&(h->y_n_overlap[nc*(h->blockSize)]), &(z_n[h->blockSize]), h->blockSize*sizeof(float));
+    }
+}
+
+/** Worker thread, which processes the jobs submitted to a tail level */
+#if defined(_WIN32)
+static DWORD WINAPI convTail_worker(LPVOID arg)
+#else
+static void* convTail_worker(void* arg)
+#endif
+{
+    safConvTail *t = (safConvTail*)arg;
+    unsigned int fpState;
+    
+    while(1){
+        /* wait for the next job (or the request to exit) */
+#if defined(_WIN32)
+        EnterCriticalSection(&(t->mutex));
+        while(!t->jobPending && !t->exitFlag)
+            SleepConditionVariableCS(&(t->cond), &(t->mutex), INFINITE);
+#else
+        pthread_mutex_lock(&(t->mutex));
+        while(!t->jobPending && !t->exitFlag)
+            pthread_cond_wait(&(t->cond), &(t->mutex));
+#endif
+        if(t->exitFlag){
+#if defined(_WIN32)
+            LeaveCriticalSection(&(t->mutex));
+#else
+            pthread_mutex_unlock(&(t->mutex));
+#endif
+            break;
+        }
+#if defined(_WIN32)
+        LeaveCriticalSection(&(t->mutex));
+#else
+        pthread_mutex_unlock(&(t->mutex));
+#endif
+        
+        /* process (flushing denormals, as for the calling thread) */
+        fpState = saf_denormals_guardBegin();
+        convLevel_apply(t->level, t->jobIn, t->jobOut);
+        saf_denormals_guardEnd(fpState);
+        
+        /* flag that the job has been completed */
+#if defined(_WIN32)
+        EnterCriticalSection(&(t->mutex));
+        t->jobPending = 0;
+        WakeAllConditionVariable(&(t->cond));
+        LeaveCriticalSection(&(t->mutex));
+#else
+        pthread_mutex_lock(&(t->mutex));
+        t->jobPending = 0;
+        pthread_cond_broadcast(&(t->cond));
+        pthread_mutex_unlock(&(t->mutex));
+#endif
+    }
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static void convTail_create
+(
+    safConvTail** const phCT,
+    int hopSize,
+    int blockSize,
+    float* H,
+    int length_h,
+    int nCH,
+    int offset,
+    int segLength
+)
+{
+    *phCT = malloc1d(sizeof(safConvTail));
+    safConvTail *t = (*phCT);
+    
+    convLevel_create(&(t->level), blockSize, H, length_h, nCH, offset, segLength);
+    t->period = blockSize/hopSize;
+    t->counter = 0;
+    t->inBuf = calloc1d(nCH*blockSize, sizeof(float));
+    t->jobIn = calloc1d(nCH*blockSize, sizeof(float));
+    t->outBuf = calloc1d(nCH*blockSize, sizeof(float));
+    t->jobOut = calloc1d(nCH*blockSize, sizeof(float));
+    t->jobPending = 0;
+    t->exitFlag = 0;
+    
+    /* start worker thread; the tail is processed in the calling thread if this fails */
+#if defined(_WIN32)
+    InitializeCriticalSection(&(t->mutex));
+    InitializeConditionVariable(&(t->cond));
+    t->thread = CreateThread(NULL, 0, convTail_worker, (LPVOID)t, 0, NULL);
+    t->threadRunning = t->thread != NULL ? 1 : 0;
+#else
+    pthread_mutex_init(&(t->mutex), NULL);
+    pthread_cond_init(&(t->cond), NULL);
+    t->threadRunning = pthread_create(&(t->thread), NULL, convTail_worker, (void*)t) == 0 ? 1 : 0;
+#endif
+}
+
+static void convTail_destroy
+(
+    safConvTail** const phCT
+)
+{
+    safConvTail *t = (*phCT);
+    
+    if(t!=NULL){
+        if(t->threadRunning){
+#if defined(_WIN32)
+            EnterCriticalSection(&(t->mutex));
+            t->exitFlag = 1;
+            WakeAllConditionVariable(&(t->cond));
+            LeaveCriticalSection(&(t->mutex));
+            WaitForSingleObject(t->thread, INFINITE);
+            CloseHandle(t->thread);
+#else
+            pthread_mutex_lock(&(t->mutex));
+            t->exitFlag = 1;
+            pthread_cond_broadcast(&(t->cond));
+            pthread_mutex_unlock(&(t->mutex));
+            pthread_join(t->thread, NULL);
+#endif
+        }
+#if defined(_WIN32)
+        DeleteCriticalSection(&(t->mutex));
+#else
+        pthread_mutex_destroy(&(t->mutex));
+        pthread_cond_destroy(&(t->cond));
+#endif
+        convLevel_destroy(&(t->level));
+        free(t->inBuf);
+        free(t->jobIn);
+        free(t->outBuf);
+        free(t->jobOut);
+        free(t);
+        (*phCT) = NULL;
+    }
+}
+
+/**
+ * Gathers one hop of input for a tail level, adds the previously computed tail
+ * output to 'outputSig', and (once per period) collects the last job and
+ * submits a new one
+ */
+static void convTail_apply
+(
+    safConvTail* const t,
+    int hopSize,
+    float* inputSig,  /* nCH x hopSize */
+    float* outputSig  /* nCH x hopSize */
+)
+{
+    int nc, B;
+    float* tmp;
+    
+    B = t->level->blockSize;
+    for(nc=0; nc<t->level->nCH; nc++){
+        memcpy(&(t->inBuf[nc*B + (t->counter)*hopSize]), &(inputSig[nc*hopSize]), hopSize*sizeof(float));
+        utility_svvadd(&(outputSig[nc*hopSize]), (const float*)&(t->outBuf[nc*B + (t->counter)*hopSize]), hopSize, &(outputSig[nc*hopSize]));
+    }
+    t->counter++;
+    if(t->counter == t->period){
+        t->counter = 0;
+        
+        /* wait for the previous job to complete (it should already be done) */
+        if(t->threadRunning){
+#if defined(_WIN32)
+            EnterCriticalSection(&(t->mutex));
+            while(t->jobPending)
+                SleepConditionVariableCS(&(t->cond), &(t->mutex), INFINITE);
+            LeaveCriticalSection(&(t->mutex));
+#else
+            pthread_mutex_lock(&(t->mutex));
+            while(t->jobPending)
+                pthread_cond_wait(&(t->cond), &(t->mutex));
+            pthread_mutex_unlock(&(t->mutex));
+#endif
+        }
+        
+        /* its output is required over the coming period */
+        tmp = t->outBuf;   t->outBuf = t->jobOut; t->jobOut = tmp;
+        tmp = t->jobIn;    t->jobIn = t->inBuf;   t->inBuf = tmp;
+        
+        /* submit the new job */
+        if(t->threadRunning){
+#if defined(_WIN32)
+            EnterCriticalSection(&(t->mutex));
+            t->jobPending = 1;
+            WakeAllConditionVariable(&(t->cond));
+            LeaveCriticalSection(&(t->mutex));
+#else
+            pthread_mutex_lock(&(t->mutex));
+            t->jobPending = 1;
+            pthread_cond_broadcast(&(t->cond));
+            pthread_mutex_unlock(&(t->mutex));
+#endif
+        }
+        else
+            convLevel_apply(t->level, t->jobIn, t->jobOut);
+    }
+}
+
 void saf_multiConv_create
 (
     void ** const phMC,
@@ -259,17 +1023,26 @@ void saf_multiConv_create
 {
     *phMC = malloc1d(sizeof(safMulConv_data));
     safMulConv_data *h = (safMulConv_data*)(*phMC);
-    int nc, nb;
-    float* h_pad, *h_pad_2hops;
+    int nc, blockSize, offset, nextOffset;
     
     h->hopSize = hopSize;
     h->length_h = length_h;
     h->nCH = nCH;
     h->usePartFLAG = usePartFLAG;
+    h->head = NULL;
+    h->numTailLevels = 0;
+    h->useDirectForm = length_h <= SAF_CONV_DIRECT_FORM_MAX_LENGTH ? 1 : 0;
     if(hopSize>length_h && h->usePartFLAG)
         h->usePartFLAG = 0; /* no benefit in partitioning in this case */
     
-    if(!h->usePartFLAG){
+    if(h->useDirectForm){
+        /* intialise direct-form convolution mode */
+        h->usePartFLAG = 0;
+        h->H_td = malloc1d(nCH*length_h*sizeof(float));
+        h->x_hist = calloc1d(nCH*(length_h-1+hopSize), sizeof(float));
+        memcpy(h->H_td, H, nCH*length_h*sizeof(float));
+    }
+    else if(!h->usePartFLAG){
         /* intialise non-partitioned convolution mode */
         h->numOvrlpAddBlocks = (int)(ceilf((float)(hopSize+length_h-1)/(float)hopSize)+0.1f);
         h->fftSize = (h->numOvrlpAddBlocks*hopSize);
@@ -277,48 +1050,38 @@ void saf_multiConv_create
         
         /* Allocate memory for buffers and perform fft on partitioned H */
         h->ovrlpAddBuffer = calloc1d(nCH*h->fftSize, sizeof(float));
-        h_pad = calloc1d(h->fftSize, sizeof(float));
         h->H_f = malloc1d(nCH*(h->nBins)*sizeof(float_complex));
         h->X_n = calloc1d(nCH * (h->nBins), sizeof(float_complex));
         h->Z_n = malloc1d(nCH * (h->nBins) * sizeof(float_complex));
-        h->x_pad = calloc1d(h->fftSize, sizeof(float));
-        h->z_n = malloc1d(nCH*(h->fftSize)*sizeof(float));
         saf_rfft_create(&(h->hFFT), h->fftSize);
-        for(nc=0; nc<nCH; nc++){
-            memcpy(h_pad, &H[nc*length_h], length_h*sizeof(float)); /* zero pad filter, to be multiple of hopsize */
-            saf_rfft_forward(h->hFFT, h_pad, &(h->H_f[nc*(h->nBins)]));
+        for(nc=0; nc<nCH; nc++) /* (zero padded to be a multiple of the hopsize) */
+            saf_rfft_forward_zp(h->hFFT, &H[nc*length_h], length_h, &(h->H_f[nc*(h->nBins)]));
+    }
+    else if(h->usePartFLAG == SAF_CONV_NONUNIFORM_PARTITIONED &&
+            length_h > 2*NUPOLS_GROWTH_FACTOR*hopSize){
+        /* intialise non-uniformly partitioned convolution mode. The head
+         * operates at the hop size and covers the filters up until the offset
+         * of the first tail level. Each tail level k then employs partitions
+         * of hopSize*GROWTH^k samples, and starts at an offset of twice its
+         * partition size. */
+        offset = 2*NUPOLS_GROWTH_FACTOR*hopSize;
+        convLevel_create(&(h->head), hopSize, H, length_h, nCH, 0, offset);
+        blockSize = NUPOLS_GROWTH_FACTOR*hopSize;
+        while(offset < length_h && h->numTailLevels < NUPOLS_MAX_NUM_TAIL_LEVELS){
+            nextOffset = 2*NUPOLS_GROWTH_FACTOR*blockSize;
+            if(blockSize >= NUPOLS_MAX_PART_SIZE || h->numTailLevels == NUPOLS_MAX_NUM_TAIL_LEVELS-1)
+                nextOffset = length_h; /* final level covers the remainder */
+            nextOffset = MIN(nextOffset, length_h);
+            convTail_create(&(h->tail[h->numTailLevels]), hopSize, blockSize, H, length_h, nCH, offset, nextOffset-offset);
+            h->numTailLevels++;
+            offset = nextOffset;
+            blockSize *= NUPOLS_GROWTH_FACTOR;
         }
-        
-        free(h_pad);
     }
     else{
-        /* intialise partitioned convolution mode */
-        h->fftSize = 2*(h->hopSize);
-        h->nBins = hopSize+1;
-        h->numFilterBlocks = (int)ceilf((float)length_h/(float)hopSize); /* number of partitions */
-        assert(h->numFilterBlocks>=1);
-        
-        /* Allocate memory for buffers and perform fft on partitioned H */
-        h_pad = calloc1d(h->numFilterBlocks * hopSize, sizeof(float));
-        h_pad_2hops = calloc1d(2 * hopSize, sizeof(float));
-        h->Hpart_f = malloc1d(h->numFilterBlocks*nCH*(h->nBins)*sizeof(float_complex));
-        h->X_n = calloc1d(h->numFilterBlocks * nCH * (h->nBins), sizeof(float_complex));
-        h->HX_n = calloc1d(h->numFilterBlocks * nCH * (h->nBins), sizeof(float_complex));
-        h->x_pad = calloc1d(2 * hopSize, sizeof(float));
-        h->hx_n = malloc1d(h->numFilterBlocks*nCH*(h->fftSize)*sizeof(float));
-        h->z_n = calloc1d(h->fftSize, sizeof(float));
-        h->y_n_overlap = calloc1d(nCH*hopSize, sizeof(float));
-        saf_rfft_create(&(h->hFFT), h->fftSize);
-        for(nc=0; nc<nCH; nc++){
-            memcpy(h_pad, &H[nc*length_h], length_h*sizeof(float)); /* zero pad filter, to be multiple of hopsize */
-            for (nb=0; nb<h->numFilterBlocks; nb++){
-                memcpy(h_pad_2hops, &(h_pad[nb*hopSize]), hopSize*sizeof(float));
-                saf_rfft_forward(h->hFFT, h_pad_2hops, &(h->Hpart_f[nb*nCH*(h->nBins)+nc*(h->nBins)]));
-            }
-        }
-        
-        free(h_pad);
-        free(h_pad_2hops);
+        /* intialise uniformly partitioned convolution mode */
+        h->usePartFLAG = SAF_CONV_UNIFORM_PARTITIONED;
+        convLevel_create(&(h->head), hopSize, H, length_h, nCH, 0, length_h);
     }
 }
 
@@ -328,21 +1091,24 @@ void saf_multiConv_destroy
 )
 {
     safMulConv_data *h = (safMulConv_data*)(*phMC);
+    int i;
     
     if(h!=NULL){
-        saf_rfft_destroy(&(h->hFFT));
-        free(h->X_n);
-        free(h->x_pad);
-        free(h->z_n);
-        if(!h->usePartFLAG){
+        if(h->useDirectForm){
+            free(h->H_td);
+            free(h->x_hist);
+        }
+        else if(!h->usePartFLAG){
+            saf_rfft_destroy(&(h->hFFT));
+            free(h->X_n);
+            free(h->ovrlpAddBuffer);
             free(h->Z_n);
             free(h->H_f);
         }
         else{
-            free(h->HX_n);
-            free(h->hx_n);
-            free(h->y_n_overlap);
-            free(h->Hpart_f);
+            convLevel_destroy(&(h->head));
+            for(i=0; i<h->numTailLevels; i++)
+                convTail_destroy(&(h->tail[i]));
         }
         free(h);
         h=NULL;
@@ -357,54 +1123,234 @@ void saf_multiConv_apply
 )
 {
     safMulConv_data *h = (safMulConv_data*)(hMC);
-    int nc, nb;
+    int nc, i, histLen;
+    float* z_n, *x_nc, *y_nc;
     
-    /* apply non-partitioned convolution */
-    if(!h->usePartFLAG){
-        /* zero-pad input signals and perform fft. */
+    /* apply direct-form convolution; y[n] = sum_k h[k] x[n-k], carried out
+     * tap-by-tap over the whole hop (so that it vectorises) */
+    if(h->useDirectForm){
+        histLen = h->length_h-1;
         for(nc=0; nc<h->nCH; nc++){
-            memcpy(h->x_pad, &(inputSig[nc*(h->hopSize)]), h->hopSize *sizeof(float));
-            saf_rfft_forward(h->hFFT, h->x_pad, &(h->X_n[nc*(h->nBins)]));
+            x_nc = &(h->x_hist[nc*(histLen+h->hopSize)]);
+            y_nc = &(outputSig[nc*(h->hopSize)]);
+            memcpy(&(x_nc[histLen]), &(inputSig[nc*(h->hopSize)]), h->hopSize*sizeof(float));
+            utility_svsmul(&(x_nc[histLen]), &(h->H_td[nc*(h->length_h)]), h->hopSize, y_nc);
+            for(i=1; i<h->length_h; i++)
+                cblas_saxpy(h->hopSize, h->H_td[nc*(h->length_h)+i], &(x_nc[histLen-i]), 1, y_nc, 1);
+            
+            /* for next iteration: */
+            memmove(x_nc, &(x_nc[h->hopSize]), histLen*sizeof(float));
         }
+    }
+    /* apply non-partitioned convolution */
+    else if(!h->usePartFLAG){
+        /* perform fft on the (implicitly) zero-padded input signals */
+        for(nc=0; nc<h->nCH; nc++)
+            saf_rfft_forward_zp(h->hFFT, &(inputSig[nc*(h->hopSize)]), h->hopSize, &(h->X_n[nc*(h->nBins)]));
         
         /* apply convolution and inverse fft */
         utility_cvvmul(h->H_f, h->X_n, (h->nCH) * (h->nBins), h->Z_n); /* This is the bulk of the CPU work */
         for(nc=0; nc<h->nCH; nc++){
-            saf_rfft_backward(h->hFFT, &(h->Z_n[nc*(h->nBins)]), &(h->z_n[nc*(h->fftSize)]));
+            z_n = (float*)&(h->Z_n[nc*(h->nBins)]);
+            saf_rfft_backward_inplace(h->hFFT, z_n);
             
             /* sum with overlap buffer and copy the result to the output buffer */
-            utility_svvcopy(&(h->ovrlpAddBuffer[nc*(h->fftSize)+(h->hopSize)]), (h->numOvrlpAddBlocks-1)*(h->hopSize), &(h->ovrlpAddBuffer[nc*(h->fftSize)]));
+            memmove(&(h->ovrlpAddBuffer[nc*(h->fftSize)]), &(h->ovrlpAddBuffer[nc*(h->fftSize)+(h->hopSize)]), (h->numOvrlpAddBlocks-1)*(h->hopSize)*sizeof(float));
             memset(&(h->ovrlpAddBuffer[nc*(h->fftSize)+(h->numOvrlpAddBlocks-1)*(h->hopSize)]), 0, (h->hopSize)*sizeof(float));
-            utility_svvadd(&(h->ovrlpAddBuffer[nc*(h->fftSize)]),  &(h->z_n[nc*(h->fftSize)]), (h->fftSize), &(h->ovrlpAddBuffer[nc*(h->fftSize)]));
+            utility_svvadd(&(h->ovrlpAddBuffer[nc*(h->fftSize)]),  z_n, (h->fftSize), &(h->ovrlpAddBuffer[nc*(h->fftSize)]));
             utility_svvcopy(&(h->ovrlpAddBuffer[nc*(h->fftSize)]), h->hopSize, &(outputSig[nc*(h->hopSize)]));
         }
     }
-    /* apply partitioned convolution */
+    /* apply (uniformly or non-uniformly) partitioned convolution */
     else{
-        /* zero-pad input signals and perform fft. Store in partition slot 1. */
-        memcpy(&(h->X_n[1*(h->nCH)*(h->nBins)]), h->X_n, (h->numFilterBlocks-1)*(h->nCH)*(h->nBins)*sizeof(float_complex));
-        for(nc=0; nc<h->nCH; nc++){
-            memcpy(h->x_pad, &(inputSig[nc*(h->hopSize)]), h->hopSize * sizeof(float));
-            saf_rfft_forward(h->hFFT, h->x_pad, &(h->X_n[0*(h->nCH)*(h->nBins)+nc*(h->nBins)]));
-        }
+        convLevel_apply(h->head, inputSig, outputSig);
+        for(i=0; i<h->numTailLevels; i++)
+            convTail_apply(h->tail[i], h->hopSize, inputSig, outputSig);
+    }
+}
+
+
+/* ========================================================================== */
+/*                    Time-Varying Multi-Channel Convolver                    */
+/* ========================================================================== */
+
+/**
+ * Data structure for the time-varying multi-channel convolver.
+ *
+ * The FDL holds the spectra of the last numParts input windows, each spanning
+ * the previous and the current hop (i.e. overlap-save); so the output of a
+ * block depends only on the FDL and the filters in use.
+ */
+typedef struct _safTVConv_data {
+    int hopSize, fftSize, nBins;
+    int length_h, nCH;
+    int numParts;       /**< number of partitions */
+    int fdl_idx;        /**< FDL slot holding the most recent input spectra */
+    int newFiltersFLAG; /**< 1: H_new_f are to be crossfaded to in the next block */
+    void* hFFT;
+    float* x_prev;           /**< previous input hop; FLAT: nCH x hopSize */
+    float* x_win;            /**< input window; fftSize x 1 */
+    float* y_new;            /**< output of the new filters; hopSize x 1 */
+    float* fadeIn;           /**< crossfade window; hopSize x 1 */
+    float_complex* H_f;      /**< filters in use; FLAT: nCH x numParts x nBins */
+    float_complex* H_new_f;  /**< new filters; FLAT: nCH x numParts x nBins */
+    float_complex* X_n;      /**< FDL; FLAT: nCH x numParts x nBins */
+    const float_complex** pairH, **pairX; /**< fdlMacSum() scratch; numParts x 1 */
+    float_complex* Z_n;      /**< also holds the output of the (in-place) ifft */
+    
+}safTVConv_data;
+
+/** Transforms the partitions of the filters 'H' into 'H_f' */
+static void tvConv_transformFilters
+(
+    safTVConv_data* h,
+    float* H,                /* nCH x length_h */
+    float_complex* H_f       /* nCH x numParts x nBins */
+)
+{
+    int nc, nb;
+    
+    for(nc=0; nc<h->nCH; nc++)
+        for(nb=0; nb<h->numParts; nb++) /* (the last partition is zero padded, if the filters are not a multiple of the hopsize) */
+            saf_rfft_forward_zp(h->hFFT, &(H[nc*(h->length_h) + nb*(h->hopSize)]), MIN(h->hopSize, h->length_h-nb*(h->hopSize)),
+                                &(H_f[(nc*(h->numParts) + nb)*(h->nBins)]));
+}
+
+/**
+ * Applies the filters 'H_ch' of one channel to its FDL 'X_ch', and places the
+ * valid (i.e. last hopSize) samples of the circular convolution in 'y'
+ */
+static void tvConv_filter
+(
+    safTVConv_data* h,
+    float_complex* H_ch,
+    float_complex* X_ch,
+    float* y
+)
+{
+    float* z_n;
+    
+    z_n = (float*)h->Z_n;
+    fdlMacSum(H_ch, X_ch, h->numParts, h->fdl_idx, h->nBins, h->pairH, h->pairX, h->Z_n);
+    saf_rfft_backward_inplace(h->hFFT, z_n);
+    utility_svvcopy(&(z_n[h->hopSize]), h->hopSize, y);
+}
+
+void saf_TVConv_create
+(
+    void ** const phTVC,
+    int hopSize,
+    float* H,         /* nCH x length_h */
+    int length_h,
+    int nCH
+)
+{
+    *phTVC = malloc1d(sizeof(safTVConv_data));
+    safTVConv_data *h = (safTVConv_data*)(*phTVC);
+    int i;
+    
+    h->hopSize = hopSize;
+    h->length_h = length_h;
+    h->nCH = nCH;
+    h->fftSize = 2*hopSize;
+    h->nBins = hopSize+1;
+    h->numParts = (int)ceilf((float)length_h/(float)hopSize);
+    assert(h->numParts>=1);
+    h->fdl_idx = 0;
+    h->newFiltersFLAG = 0;
+    
+    /* Allocate memory for buffers and perform fft on partitioned H */
+    h->x_prev = calloc1d(nCH*hopSize, sizeof(float));
+    h->x_win = malloc1d(h->fftSize*sizeof(float));
+    h->y_new = malloc1d(hopSize*sizeof(float));
+    h->fadeIn = malloc1d(hopSize*sizeof(float));
+    for(i=0; i<hopSize; i++)
+        h->fadeIn[i] = (float)(i+1)/(float)hopSize;
+    h->H_f = malloc1d(nCH*(h->numParts)*(h->nBins)*sizeof(float_complex));
+    h->H_new_f = malloc1d(nCH*(h->numParts)*(h->nBins)*sizeof(float_complex));
+    h->X_n = calloc1d(nCH*(h->numParts)*(h->nBins), sizeof(float_complex));
+    h->pairH = malloc1d((h->numParts)*sizeof(float_complex*));
+    h->pairX = malloc1d((h->numParts)*sizeof(float_complex*));
+    h->Z_n = malloc1d((h->nBins)*sizeof(float_complex));
+    saf_rfft_create(&(h->hFFT), h->fftSize);
+    tvConv_transformFilters(h, H, h->H_f);
+}
+
+void saf_TVConv_destroy
+(
+    void ** const phTVC
+)
+{
+    safTVConv_data *h = (safTVConv_data*)(*phTVC);
+    
+    if(h!=NULL){
+        saf_rfft_destroy(&(h->hFFT));
+        free(h->x_prev);
+        free(h->x_win);
+        free(h->y_new);
+        free(h->fadeIn);
+        free(h->H_f);
+        free(h->H_new_f);
+        free(h->X_n);
+        free(h->pairH);
+        free(h->pairX);
+        free(h->Z_n);
+        free(h);
+        (*phTVC) = NULL;
+    }
+}
+
+void saf_TVConv_setFilters
+(
+    void * const hTVC,
+    float* H
+)
+{
+    safTVConv_data *h = (safTVConv_data*)(hTVC);
+    
+    tvConv_transformFilters(h, H, h->H_new_f);
+    h->newFiltersFLAG = 1;
+}
+
+void saf_TVConv_apply
+(
+    void * const hTVC,
+    float* inputSig,
+    float* outputSig
+)
+{
+    safTVConv_data *h = (safTVConv_data*)(hTVC);
+    int nc, chLen;
+    float* y;
+    float_complex* X_ch, *tmp;
+    
+    chLen = (h->numParts)*(h->nBins);
+    h->fdl_idx = (h->fdl_idx + h->numParts - 1) % h->numParts;
+    for(nc=0; nc<h->nCH; nc++){
+        X_ch = &(h->X_n[nc*chLen]);
+        y = &(outputSig[nc*(h->hopSize)]);
         
-        /* apply convolution and inverse fft */
-        utility_cvvmul(h->Hpart_f, h->X_n, h->numFilterBlocks * (h->nCH) * (h->nBins), h->HX_n); /* This is the bulk of the CPU work */
-        for(nc=0; nc<h->nCH; nc++){
-            for(nb=0; nb<h->numFilterBlocks; nb++)
-                saf_rfft_backward(h->hFFT, &(h->HX_n[nb*(h->nCH)*(h->nBins)+nc*(h->nBins)]), &(h->hx_n[nb*(h->nCH)*(h->fftSize)+nc*(h->fftSize)]));
-            
-            /* output frame for this channel is the sum over all partitions */
-            memset(h->z_n, 0, h->fftSize*sizeof(float));
-            for(nb=0; nb<h->numFilterBlocks; nb++)
-                utility_svvadd(h->z_n, (const float*)&(h->hx_n[nb*(h->nCH)*(h->fftSize)+nc*(h->fftSize)]), h->fftSize, h->z_n);
-            
-            /* sum with overlap buffer and copy the result to the output buffer */
-            utility_svvadd(h->z_n, (const float*)&(h->y_n_overlap[nc*(h->hopSize)]), h->hopSize, &(outputSig[nc* (h->hopSize)]));
-            
-            /* for next iteration: */
-            memcpy(&(h->y_n_overlap[nc*(h->hopSize)]), &(h->z_n[h->hopSize]), h->hopSize*sizeof(float));
+        /* perform fft on the input window (previous and current hop). Store in the current FDL slot */
+        utility_svvcopy(&(h->x_prev[nc*(h->hopSize)]), h->hopSize, h->x_win);
+        utility_svvcopy(&(inputSig[nc*(h->hopSize)]), h->hopSize, &(h->x_win[h->hopSize]));
+        utility_svvcopy(&(inputSig[nc*(h->hopSize)]), h->hopSize, &(h->x_prev[nc*(h->hopSize)]));
+        saf_rfft_forward(h->hFFT, h->x_win, &(X_ch[(h->fdl_idx)*(h->nBins)]));
+        
+        /* apply the filters in use */
+        tvConv_filter(h, &(h->H_f[nc*chLen]), X_ch, y);
+        
+        /* crossfade to the output of the new filters: y = y + fadeIn.*(y_new - y) */
+        if(h->newFiltersFLAG){
+            tvConv_filter(h, &(h->H_new_f[nc*chLen]), X_ch, h->y_new);
+            utility_svvsub(h->y_new, y, h->hopSize, h->y_new);
+            utility_svvmul(h->y_new, h->fadeIn, h->hopSize, h->y_new);
+            utility_svvadd(y, h->y_new, h->hopSize, y);
         }
     }
+    
+    /* the new filters are in use from now on */
+    if(h->newFiltersFLAG){
+        tmp = h->H_f; h->H_f = h->H_new_f; h->H_new_f = tmp;
+        h->newFiltersFLAG = 0;
+    }
 }
-
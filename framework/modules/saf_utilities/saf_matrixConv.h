@@ -49,8 +49,48 @@ extern "C" {
  *         y: nChannels x blockSize
  *         x: nChannels x blockSize
  *         H: nChannels x filterLength
+ *
+ *   Time-Varying Multi Convolver
+ *     As the Multi Convolver, except that H may be replaced every block
  */
 
+/* ========================================================================== */
+/*                            Partitioning Options                            */
+/* ========================================================================== */
+
+/** Normal fft-based convolution (one big FFT per hop) */
+#define SAF_CONV_NON_PARTITIONED ( 0 )
+/** Uniformly partitioned fft-based convolution (partitions of hopSize) */
+#define SAF_CONV_UNIFORM_PARTITIONED ( 1 )
+/**
+ * Non-uniformly partitioned fft-based convolution (saf_multiConv only).
+ *
+ * The first part of the filters (the head) is applied using partitions of
+ * hopSize samples. The remainder (the tail) is split into levels, where the
+ * partition size grows by a factor of 4 from one level to the next. Each tail
+ * level is processed on its own worker thread, and is given one full period
+ * (of its partition size) to complete. Therefore, the audio callback only pays
+ * for the head, while the latency remains at one hop.
+ */
+#define SAF_CONV_NONUNIFORM_PARTITIONED ( 2 )
+/**
+ * Filters of up to this many taps are applied by saf_multiConv using a
+ * direct-form (time-domain) FIR instead, regardless of the partitioning
+ * option; since, for such short filters, the FFTs would cost more than the
+ * convolution itself.
+ */
+#define SAF_CONV_DIRECT_FORM_MAX_LENGTH ( 64 )
+
+/**
+ * Level (in dB, relative to the peak absolute value of all of the filters)
+ * below which saf_matrixConv_create() regards filter samples as zero.
+ *
+ * Trailing samples below this level (in all filters) are truncated, and
+ * filters/partitions that lie entirely below it are skipped.
+ */
+#define SAF_MATRIXCONV_SPARSITY_THRESHOLD_DB ( -120.0f )
+
+
 /* ========================================================================== */
 /*                              Matrix Convolver                              */
 /* ========================================================================== */
@@ -60,6 +100,22 @@ extern "C" {
  *
  * This is a matrix convolver intended for block-by-block processing.
  *
+ * @note The partitioned mode employs a uniformly-partitioned frequency-domain
+ *       delay-line (FDL). The spectra of the input signals are computed once
+ *       per block and shared by all output channels, and the filtered spectra
+ *       are summed prior to the inverse transform. Therefore, the cost per
+ *       block is: nCHin FFTs + (nCHin x nCHout x numPartitions) complex
+ *       multiply-accumulates + nCHout IFFTs. The hop size does not need to be a
+ *       power of 2 (e.g. 480 or 960 samples are supported).
+ * @note Filters are truncated to their effective length, and the filters (or
+ *       partitions, if partitioned) that are entirely below
+ *       SAF_MATRIXCONV_SPARSITY_THRESHOLD_DB are neither stored nor applied;
+ *       so sparse filter matrices are proportionally cheaper.
+ * @note Silent input blocks are not transformed, and the partitions that
+ *       would only be applied to silent blocks are skipped; so inputs that
+ *       have been silent for longer than the filters cost (almost) nothing.
+ *       The output is the same.
+ *
  * @param[in] phMC        (&) address of matrixConv handle
  * @param[in] hopSize     Hop size in samples.
  * @param[in] H           Time-domain filters; FLAT: nCHout x nCHin x length_h
@@ -78,6 +134,88 @@ void saf_matrixConv_create(/* Input Arguments */
                            int nCHout,
                            int usePartFLAG);
 
+/**
+ * Creates an instance of matrixConv, with the filters given in input-major
+ * order; e.g. for spherical harmonic room impulse responses of a number of
+ * sources (nCHin: the sources, nCHout: (order+1)^2)
+ *
+ * Each source is transformed once per block, and the products with the
+ * spectra of its nCHout filters (partitions) are accumulated, over all of
+ * the sources, into the spectra of one bus of output channels; so only nCHout
+ * inverse FFTs are required per block, regardless of the number of sources.
+ * This is the same as saf_matrixConv_create(), with the filters permuted
+ * (without a copy being made). In comparison, convolving each source with its
+ * own saf_multiConv (with the source duplicated over the nCHout channels)
+ * costs nCHout FFTs and nCHout inverse FFTs per source.
+ *
+ * @param[in] phMC        (&) address of matrixConv handle
+ * @param[in] hopSize     Hop size in samples.
+ * @param[in] H           Time-domain filters; FLAT: nCHin x nCHout x length_h
+ * @param[in] length_h    Length of the filters
+ * @param[in] nCHin       Number of input channels (e.g. sources)
+ * @param[in] nCHout      Number of output channels (e.g. (order+1)^2)
+ * @param[in] usePartFLAG '0': normal fft-based convolution, '1': fft-based
+ *                        partitioned convolution
+ */
+void saf_matrixConv_createFromSources(/* Input Arguments */
+                                      void ** const phMC,
+                                      int hopSize,
+                                      float* H,
+                                      int length_h,
+                                      int nCHin,
+                                      int nCHout,
+                                      int usePartFLAG);
+
+/**
+ * Prototype of a function which reads a segment of the filters for
+ * saf_matrixConv_createFromReader()
+ *
+ * @param[in]  hReader Handle passed to saf_matrixConv_createFromReader()
+ * @param[in]  ni      Input channel index
+ * @param[in]  offset  First sample of the segment
+ * @param[in]  len     Length of the segment (offset+len <= length_h)
+ * @param[out] H_seg   Samples [offset, offset+len) of the filters from input
+ *                     channel 'ni' to each output channel; FLAT: nCHout x len
+ */
+typedef void (*saf_matrixConv_readFunc)(void* const hReader,
+                                        int ni,
+                                        int offset,
+                                        int len,
+                                        float* H_seg);
+
+/**
+ * Creates an instance of matrixConv, reading the filters segment-by-segment
+ * (e.g. straight from a file) instead of from memory
+ *
+ * The filters are transformed one partition at a time, and so the only
+ * time-domain memory required is nCHout x hopSize samples (or nCHout x
+ * length_h, if not partitioned). The result is the same as that of
+ * saf_matrixConv_create() with the same filters.
+ *
+ * @note The filters are read (up to) twice: once to find their peak level and
+ *       effective length (see SAF_MATRIXCONV_SPARSITY_THRESHOLD_DB), and once
+ *       to transform them.
+ *
+ * @param[in] phMC        (&) address of matrixConv handle
+ * @param[in] hopSize     Hop size in samples.
+ * @param[in] readFunc    Function reading a segment of the filters
+ * @param[in] hReader     Handle passed to readFunc
+ * @param[in] length_h    Length of the filters
+ * @param[in] nCHin       Number of input channels
+ * @param[in] nCHout      Number of output channels
+ * @param[in] usePartFLAG '0': normal fft-based convolution, '1': fft-based
+ *                        partitioned convolution
+ */
+void saf_matrixConv_createFromReader(/* Input Arguments */
+                                     void ** const phMC,
+                                     int hopSize,
+                                     saf_matrixConv_readFunc readFunc,
+                                     void * const hReader,
+                                     int length_h,
+                                     int nCHin,
+                                     int nCHout,
+                                     int usePartFLAG);
+
 /**
  * Destroys an instance of matrixConv
  *
@@ -86,6 +224,31 @@ void saf_matrixConv_create(/* Input Arguments */
 void saf_matrixConv_destroy(/* Input Arguments */
                             void ** const phMC);
 
+/**
+ * Spreads the transforms of the input and output channels of
+ * saf_matrixConv_apply() over the threads of a pool (see saf_parfor.h)
+ *
+ * The input spectra are computed first (once, and shared by all output
+ * channels), and the output channels are then taken by whichever thread is
+ * free. Each output channel is computed in full by a single thread, so the
+ * output is identical to that of the single-threaded convolver. However, if
+ * there are fewer output channels than threads, then the filters (partitions)
+ * of each output channel are also split into shares, which are summed in the
+ * frequency domain prior to the inverse FFT; so the output then differs only
+ * by the rounding of this sum.
+ *
+ * @warning Allocates the per-thread buffers, and so must not be called from
+ *          the audio thread. The pool must outlive its use by the convolver,
+ *          or be detached first (by passing NULL).
+ *
+ * @param[in] hMC  matrixConv handle
+ * @param[in] hPar saf_parfor handle; or NULL to return to single-threaded
+ *                 processing
+ */
+void saf_matrixConv_setThreadPool(/* Input Arguments */
+                                  void * const hMC,
+                                  void * const hPar);
+
 /**
  * Performs the matrix convolution.
  *
@@ -115,13 +278,21 @@ void saf_matrixConv_apply(/* Input Arguments */
  * @note nCH can just be 1, in which case this is simply a single-channel
  *       convolver.
  *
+ * @note If usePartFLAG is SAF_CONV_NONUNIFORM_PARTITIONED, but the filters
+ *       are no longer than 8 x hopSize, then uniform partitioning is used
+ *       instead (as there is no tail to speak of).
+ * @note Filters no longer than SAF_CONV_DIRECT_FORM_MAX_LENGTH are applied in
+ *       the time domain (for any usePartFLAG); the output is the same.
+ *
  * @param[in] phMC        (&) address of multiConv handle
  * @param[in] hopSize     Hop size in samples.
  * @param[in] H           Time-domain filters; FLAT: nCH x length_h
  * @param[in] length_h    Length of the filters
  * @param[in] nCH         Number of filters & input/output channels
  * @param[in] usePartFLAG '0': normal fft-based convolution, '1': fft-based
- *                        partitioned convolution
+ *                        uniformly partitioned convolution, '2': fft-based
+ *                        non-uniformly partitioned convolution (see
+ *                        #SAF_CONV_NONUNIFORM_PARTITIONED)
  */
 void saf_multiConv_create(/* Input Arguments */
                           void ** const phMC,
@@ -153,6 +324,78 @@ void saf_multiConv_apply(/* Input Arguments */
                          float* outputSigs);
 
 
+/* ========================================================================== */
+/*                      Time-Varying Multi-Channel Convolver                  */
+/* ========================================================================== */
+
+/**
+ * Creates an instance of TVConv
+ *
+ * This is a multi-channel convolver, for which the filters may be replaced as
+ * often as every block (e.g. HRIRs, updated at the rate of a head-tracker)
+ * without re-creating the instance.
+ *
+ * @note The convolution employs uniformly-partitioned overlap-save, which
+ *       retains only the spectra of past input blocks (and no output state).
+ *       Therefore, in the block following saf_TVConv_setFilters(), the output
+ *       of both the old and the new filters is computed exactly (from the
+ *       same input history), and the output crossfades linearly from the
+ *       former to the latter over the block. The cost per block is: nCH FFTs +
+ *       (nCH x numPartitions) complex multiply-accumulates + nCH IFFTs; and
+ *       twice the latter two in blocks where the filters change. There is no
+ *       added latency.
+ *
+ * @param[in] phTVC    (&) address of TVConv handle
+ * @param[in] hopSize  Hop size in samples.
+ * @param[in] H        Initial time-domain filters; FLAT: nCH x length_h
+ * @param[in] length_h Length of the filters
+ * @param[in] nCH      Number of filters & input/output channels
+ */
+void saf_TVConv_create(/* Input Arguments */
+                       void ** const phTVC,
+                       int hopSize,
+                       float* H,
+                       int length_h,
+                       int nCH);
+
+/**
+ * Destroys an instance of TVConv
+ *
+ * @param[in] phTVC (&) address of TVConv handle
+ */
+void saf_TVConv_destroy(/* Input Arguments */
+                        void ** const phTVC);
+
+/**
+ * Sets new filters, which are crossfaded to over the next call to
+ * saf_TVConv_apply()
+ *
+ * @note This transforms the filters, but does not allocate memory, so it may
+ *       be called from the audio thread (prior to saf_TVConv_apply()). If it
+ *       is called more than once between two blocks, then the most recent
+ *       filters are used.
+ *
+ * @param[in] hTVC TVConv handle
+ * @param[in] H    New time-domain filters; FLAT: nCH x length_h
+ */
+void saf_TVConv_setFilters(/* Input Arguments */
+                           void * const hTVC,
+                           float* H);
+
+/**
+ * Performs the time-varying multi-channel convolution
+ *
+ * @param[in]  hTVC       TVConv handle
+ * @param[in]  inputSigs  Input signals;  FLAT: nCH x hopSize
+ * @param[out] outputSigs Output signals; FLAT: nCH x hopSize
+ */
+void saf_TVConv_apply(/* Input Arguments */
+                      void * const hTVC,
+                      float* inputSigs,
+                      /* Output Arguments */
+                      float* outputSigs);
+
+
 #ifdef __cplusplus
 }/* extern "C" */
 #endif /* __cplusplus */
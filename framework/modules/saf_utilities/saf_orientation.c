@@ -0,0 +1,332 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_orientation.c
+ * @brief Quaternion orientations, and the prediction of a (head-tracker)
+ *        orientation a short time ahead
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_orientation.h"
+
+#define OP_MAX_SAMPLE_INTERVAL_S ( 0.25 )  /* orientations further apart than this give no velocity */
+#define OP_VELOCITY_SMOOTHING ( 0.5f )     /* one-pole smoothing of the angular velocity (tracker jitter) */
+
+/** Data structure for the orientation predictor */
+typedef struct _safOrientationPredictor_data {
+    int nSamples;      /**< number of orientations given (saturates at 2) */
+    float quat[4];     /**< latest orientation */
+    double time_s;     /**< time of the latest orientation */
+    float omega[3];    /**< smoothed angular velocity (axis*rad/s), world frame */
+
+}safOrientationPredictor_data;
+
+/** Normalises a quaternion (the identity is returned for a zero quaternion) */
+static void quaternion_normalise(float quat[4])
+{
+    int i;
+    float norm;
+
+    norm = sqrtf(quat[0]*quat[0] + quat[1]*quat[1] + quat[2]*quat[2] + quat[3]*quat[3]);
+    if(norm < 1e-12f){
+        quat[0] = 1.0f;
+        quat[1] = quat[2] = quat[3] = 0.0f;
+        return;
+    }
+    for(i=0; i<4; i++)
+        quat[i] /= norm;
+}
+
+/** Hamilton product: c = a*b */
+static void quaternion_multiply(const float a[4], const float b[4], float c[4])
+{
+    float tmp[4];
+
+    tmp[0] = a[0]*b[0] - a[1]*b[1] - a[2]*b[2] - a[3]*b[3];
+    tmp[1] = a[0]*b[1] + a[1]*b[0] + a[2]*b[3] - a[3]*b[2];
+    tmp[2] = a[0]*b[2] - a[1]*b[3] + a[2]*b[0] + a[3]*b[1];
+    tmp[3] = a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + a[3]*b[0];
+    memcpy(c, tmp, 4*sizeof(float));
+}
+
+void quaternion2yawPitchRoll
+(
+    const float quat[4],
+    float* yaw,
+    float* pitch,
+    float* roll
+)
+{
+    float q[4];
+
+    memcpy(q, quat, 4*sizeof(float));
+    quaternion_normalise(q);
+    (*yaw) = atan2f(2.0f*(q[0]*q[3] + q[1]*q[2]), 1.0f - 2.0f*(q[2]*q[2] + q[3]*q[3]));
+    (*pitch) = asinf(CLAMP(2.0f*(q[0]*q[2] - q[3]*q[1]), -1.0f, 1.0f));
+    (*roll) = atan2f(2.0f*(q[0]*q[1] + q[2]*q[3]), 1.0f - 2.0f*(q[1]*q[1] + q[2]*q[2]));
+}
+
+void yawPitchRoll2quaternion
+(
+    float yaw,
+    float pitch,
+    float roll,
+    float quat[4]
+)
+{
+    float cy, sy, cp, sp, cr, sr;
+
+    cy = cosf(yaw*0.5f);   sy = sinf(yaw*0.5f);
+    cp = cosf(pitch*0.5f); sp = sinf(pitch*0.5f);
+    cr = cosf(roll*0.5f);  sr = sinf(roll*0.5f);
+    quat[0] = cr*cp*cy + sr*sp*sy;
+    quat[1] = sr*cp*cy - cr*sp*sy;
+    quat[2] = cr*sp*cy + sr*cp*sy;
+    quat[3] = cr*cp*sy - sr*sp*cy;
+}
+
+void quaternion2rotationMatrix
+(
+    const float quat[4],
+    float R[3][3]
+)
+{
+    float q[4];
+    float w, x, y, z;
+
+    memcpy(q, quat, 4*sizeof(float));
+    quaternion_normalise(q);
+    w = q[0]; x = q[1]; y = q[2]; z = q[3];
+
+    /* (the transpose of the active rotation matrix of the quaternion, as
+     * yawPitchRoll2Rzyx() rotates row vectors) */
+    R[0][0] = 1.0f - 2.0f*(y*y + z*z);
+    R[0][1] = 2.0f*(x*y + w*z);
+    R[0][2] = 2.0f*(x*z - w*y);
+    R[1][0] = 2.0f*(x*y - w*z);
+    R[1][1] = 1.0f - 2.0f*(x*x + z*z);
+    R[1][2] = 2.0f*(y*z + w*x);
+    R[2][0] = 2.0f*(x*z + w*y);
+    R[2][1] = 2.0f*(y*z - w*x);
+    R[2][2] = 1.0f - 2.0f*(x*x + y*y);
+}
+
+void rotationMatrix2quaternion
+(
+    float R[3][3],
+    float quat[4]
+)
+{
+    int i;
+    float trace, s;
+
+    /* (Shepperd's method, on the active rotation matrix, i.e. R^T) */
+    trace = R[0][0] + R[1][1] + R[2][2];
+    if(trace > 0.0f){
+        s = 2.0f*sqrtf(1.0f + trace);
+        quat[0] = 0.25f*s;
+        quat[1] = (R[1][2] - R[2][1])/s;
+        quat[2] = (R[2][0] - R[0][2])/s;
+        quat[3] = (R[0][1] - R[1][0])/s;
+    }
+    else if(R[0][0] > R[1][1] && R[0][0] > R[2][2]){
+        s = 2.0f*sqrtf(MAX(1.0f + R[0][0] - R[1][1] - R[2][2], 0.0f));
+        quat[0] = (R[1][2] - R[2][1])/s;
+        quat[1] = 0.25f*s;
+        quat[2] = (R[1][0] + R[0][1])/s;
+        quat[3] = (R[2][0] + R[0][2])/s;
+    }
+    else if(R[1][1] > R[2][2]){
+        s = 2.0f*sqrtf(MAX(1.0f + R[1][1] - R[0][0] - R[2][2], 0.0f));
+        quat[0] = (R[2][0] - R[0][2])/s;
+        quat[1] = (R[1][0] + R[0][1])/s;
+        quat[2] = 0.25f*s;
+        quat[3] = (R[2][1] + R[1][2])/s;
+    }
+    else{
+        s = 2.0f*sqrtf(MAX(1.0f + R[2][2] - R[0][0] - R[1][1], 0.0f));
+        quat[0] = (R[0][1] - R[1][0])/s;
+        quat[1] = (R[2][0] + R[0][2])/s;
+        quat[2] = (R[2][1] + R[1][2])/s;
+        quat[3] = 0.25f*s;
+    }
+    if(quat[0] < 0.0f)
+        for(i=0; i<4; i++)
+            quat[i] = -quat[i];
+    quaternion_normalise(quat);
+}
+
+void quaternionSlerp
+(
+    const float quat0[4],
+    const float quat1[4],
+    float t,
+    float quat[4]
+)
+{
+    int i;
+    float cosTheta, theta, sinTheta, w0, w1, sign;
+
+    cosTheta = quat0[0]*quat1[0] + quat0[1]*quat1[1] + quat0[2]*quat1[2] + quat0[3]*quat1[3];
+    sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+    cosTheta = MIN(fabsf(cosTheta), 1.0f);
+
+    /* (nearly the same orientation: linear interpolation suffices) */
+    if(cosTheta > 0.9995f){
+        w0 = 1.0f - t;
+        w1 = t;
+    }
+    else{
+        theta = acosf(cosTheta);
+        sinTheta = sinf(theta);
+        w0 = sinf((1.0f-t)*theta)/sinTheta;
+        w1 = sinf(t*theta)/sinTheta;
+    }
+    for(i=0; i<4; i++)
+        quat[i] = w0*quat0[i] + sign*w1*quat1[i];
+    quaternion_normalise(quat);
+}
+
+void saf_orientationPredictor_create
+(
+    void ** const phOP
+)
+{
+    safOrientationPredictor_data* h;
+
+    h = (safOrientationPredictor_data*)malloc1d(sizeof(safOrientationPredictor_data));
+    *phOP = (void*)h;
+    saf_orientationPredictor_reset(*phOP);
+}
+
+void saf_orientationPredictor_destroy
+(
+    void ** const phOP
+)
+{
+    safOrientationPredictor_data* h = (safOrientationPredictor_data*)(*phOP);
+
+    if(h!=NULL){
+        free(h);
+        *phOP = NULL;
+    }
+}
+
+void saf_orientationPredictor_reset
+(
+    void * const hOP
+)
+{
+    safOrientationPredictor_data* h = (safOrientationPredictor_data*)(hOP);
+
+    h->nSamples = 0;
+    h->quat[0] = 1.0f;
+    h->quat[1] = h->quat[2] = h->quat[3] = 0.0f;
+    h->time_s = 0.0;
+    memset(h->omega, 0, 3*sizeof(float));
+}
+
+void saf_orientationPredictor_addSample
+(
+    void * const hOP,
+    const float quat[4],
+    double time_s
+)
+{
+    safOrientationPredictor_data* h = (safOrientationPredictor_data*)(hOP);
+    int i;
+    float dt, sinHalf, angle;
+    float q[4], qConj[4], dq[4], omega[3];
+
+    memcpy(q, quat, 4*sizeof(float));
+    quaternion_normalise(q);
+    if(h->nSamples==0){
+        memcpy(h->quat, q, 4*sizeof(float));
+        h->time_s = time_s;
+        h->nSamples = 1;
+        return;
+    }
+    if(time_s < h->time_s)
+        return;
+    dt = (float)(time_s - h->time_s);
+
+    /* the rotation since the latest orientation: dq = q*conj(q_latest), taken
+     * the short way round */
+    if(dt > 0.0f && dt <= OP_MAX_SAMPLE_INTERVAL_S){
+        qConj[0] = h->quat[0];
+        for(i=1; i<4; i++)
+            qConj[i] = -h->quat[i];
+        quaternion_multiply(q, qConj, dq);
+        if(dq[0] < 0.0f)
+            for(i=0; i<4; i++)
+                dq[i] = -dq[i];
+        sinHalf = sqrtf(dq[1]*dq[1] + dq[2]*dq[2] + dq[3]*dq[3]);
+        angle = 2.0f*atan2f(sinHalf, dq[0]);
+        for(i=0; i<3; i++)
+            omega[i] = sinHalf > 1e-9f ? dq[i+1]/sinHalf * angle/dt : 0.0f;
+        if(h->nSamples==1)
+            memcpy(h->omega, omega, 3*sizeof(float));
+        else
+            for(i=0; i<3; i++)
+                h->omega[i] = OP_VELOCITY_SMOOTHING*(h->omega[i]) + (1.0f-OP_VELOCITY_SMOOTHING)*omega[i];
+        h->nSamples = 2;
+    }
+    else if(dt > 0.0f){
+        /* (the tracker has paused) */
+        memset(h->omega, 0, 3*sizeof(float));
+        h->nSamples = 1;
+    }
+    memcpy(h->quat, q, 4*sizeof(float));
+    h->time_s = time_s;
+}
+
+int saf_orientationPredictor_predict
+(
+    void * const hOP,
+    double time_s,
+    float quat[4]
+)
+{
+    safOrientationPredictor_data* h = (safOrientationPredictor_data*)(hOP);
+    int i;
+    float dt, speed, angle, sinHalf;
+    float dq[4];
+
+    memcpy(quat, h->quat, 4*sizeof(float));
+    if(h->nSamples==0)
+        return 0;
+    if(h->nSamples<2)
+        return 1;
+
+    /* extrapolate the latest orientation with the angular velocity:
+     * q(t) = exp(omega*dt/2)*q_latest */
+    dt = (float)CLAMP(time_s - h->time_s, 0.0, SAF_ORIENTATION_PREDICTOR_MAX_HORIZON_S);
+    speed = sqrtf(h->omega[0]*h->omega[0] + h->omega[1]*h->omega[1] + h->omega[2]*h->omega[2]);
+    angle = speed*dt;
+    if(angle < 1e-9f)
+        return 1;
+    sinHalf = sinf(0.5f*angle);
+    dq[0] = cosf(0.5f*angle);
+    for(i=0; i<3; i++)
+        dq[i+1] = h->omega[i]/speed * sinHalf;
+    quaternion_multiply(dq, h->quat, quat);
+    quaternion_normalise(quat);
+    return 1;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_orientation.h
+ * @brief Quaternion orientations, and the prediction of a (head-tracker)
+ *        orientation a short time ahead
+ *
+ * The quaternions are stored as [w x y z], and describe the rotation from the
+ * reference orientation (looking towards +x, with +z up) to the current one.
+ * A quaternion corresponds to the yaw, pitch and roll angles that are passed
+ * to yawPitchRoll2Rzyx() with the yaw-pitch-roll rotation order, i.e.
+ * q = q_yaw * q_pitch * q_roll.
+ *
+ * The predictor is given timestamped orientations (e.g. as they are received
+ * from a head-tracker), from which it estimates the angular velocity. The
+ * orientation at a later time (e.g. the time at which the frame that is being
+ * processed will be heard) is then obtained by extrapolating the latest
+ * orientation with this angular velocity; which compensates for the latency of
+ * the tracker and of the processing, without shrinking the buffers. The
+ * extrapolation is limited to SAF_ORIENTATION_PREDICTOR_MAX_HORIZON_S, beyond
+ * which the errors of extrapolating head movements grow quickly.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_ORIENTATION_H_INCLUDED
+#define SAF_ORIENTATION_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Maximum time, in seconds, that an orientation is extrapolated ahead */
+#define SAF_ORIENTATION_PREDICTOR_MAX_HORIZON_S ( 0.1 )
+
+/**
+ * Converts a quaternion into Euler angles, for yawPitchRoll2Rzyx() with the
+ * yaw-pitch-roll rotation order (i.e. rollPitchYawFLAG=0)
+ *
+ * @param[in]  quat  Quaternion [w x y z] (need not be normalised)
+ * @param[out] yaw   (&) yaw angle in radians
+ * @param[out] pitch (&) pitch angle in radians
+ * @param[out] roll  (&) roll angle in radians
+ */
+void quaternion2yawPitchRoll(/* Input Arguments */
+                             const float quat[4],
+                             /* Output Arguments */
+                             float* yaw,
+                             float* pitch,
+                             float* roll);
+
+/**
+ * Converts Euler angles (in the yaw-pitch-roll rotation order) into a
+ * quaternion; the inverse of quaternion2yawPitchRoll()
+ *
+ * @param[in]  yaw   Yaw angle in radians
+ * @param[in]  pitch Pitch angle in radians
+ * @param[in]  roll  Roll angle in radians
+ * @param[out] quat  Quaternion [w x y z]
+ */
+void yawPitchRoll2quaternion(/* Input Arguments */
+                             float yaw,
+                             float pitch,
+                             float roll,
+                             /* Output Arguments */
+                             float quat[4]);
+
+/**
+ * Converts a quaternion into the rotation matrix that yawPitchRoll2Rzyx()
+ * returns for the corresponding yaw-pitch-roll angles (without the detour via
+ * the Euler angles, and thus without their singularity at +/-90 degrees pitch)
+ *
+ * @param[in]  quat Quaternion [w x y z] (need not be normalised)
+ * @param[out] R    Rotation matrix; 3 x 3
+ */
+void quaternion2rotationMatrix(/* Input Arguments */
+                               const float quat[4],
+                               /* Output Arguments */
+                               float R[3][3]);
+
+/**
+ * Converts a rotation matrix (as returned by yawPitchRoll2Rzyx(), with either
+ * rotation order) into a quaternion; the inverse of quaternion2rotationMatrix()
+ *
+ * @param[in]  R    Rotation matrix; 3 x 3
+ * @param[out] quat Quaternion [w x y z] (normalised, with w >= 0)
+ */
+void rotationMatrix2quaternion(/* Input Arguments */
+                               float R[3][3],
+                               /* Output Arguments */
+                               float quat[4]);
+
+/**
+ * Spherical linear interpolation between two orientations, taking the shorter
+ * way round
+ *
+ * @param[in]  quat0 Orientation at t=0 (normalised quaternion [w x y z])
+ * @param[in]  quat1 Orientation at t=1 (normalised quaternion [w x y z])
+ * @param[in]  t     Interpolation point, 0..1
+ * @param[out] quat  Interpolated orientation (normalised quaternion)
+ */
+void quaternionSlerp(/* Input Arguments */
+                     const float quat0[4],
+                     const float quat1[4],
+                     float t,
+                     /* Output Arguments */
+                     float quat[4]);
+
+/**
+ * Creates an instance of the orientation predictor
+ *
+ * @param[in] phOP (&) address of orientation predictor handle
+ */
+void saf_orientationPredictor_create(/* Input Arguments */
+                                     void ** const phOP);
+
+/**
+ * Destroys an instance of the orientation predictor
+ *
+ * @param[in] phOP (&) address of orientation predictor handle
+ */
+void saf_orientationPredictor_destroy(/* Input Arguments */
+                                      void ** const phOP);
+
+/** Discards all of the orientations given so far */
+void saf_orientationPredictor_reset(/* Input Arguments */
+                                    void * const hOP);
+
+/**
+ * Adds an orientation, and updates the estimate of the angular velocity
+ *
+ * @note Orientations that are older than the latest one are ignored. If
+ *       consecutive orientations are too far apart (i.e. the tracker has
+ *       paused), the angular velocity is taken to be zero until the next one.
+ *
+ * @param[in] hOP    Orientation predictor handle
+ * @param[in] quat   Orientation (quaternion [w x y z])
+ * @param[in] time_s Time at which the orientation was measured, in seconds
+ *                   (e.g. of the clock of saf_benchmark_getTime())
+ */
+void saf_orientationPredictor_addSample(/* Input Arguments */
+                                        void * const hOP,
+                                        const float quat[4],
+                                        double time_s);
+
+/**
+ * Predicts the orientation at a given time
+ *
+ * @param[in]  hOP    Orientation predictor handle
+ * @param[in]  time_s Time of the prediction, in seconds (same clock as for
+ *                    saf_orientationPredictor_addSample())
+ * @param[out] quat   Predicted orientation (normalised quaternion [w x y z])
+ * @returns    1 if an orientation has been given, 0 otherwise (in which case
+ *             'quat' is the identity)
+ */
+int saf_orientationPredictor_predict(/* Input Arguments */
+                                     void * const hOP,
+                                     double time_s,
+                                     /* Output Arguments */
+                                     float quat[4]);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_ORIENTATION_H_INCLUDED */
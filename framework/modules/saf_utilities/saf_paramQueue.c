@@ -0,0 +1,168 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_paramQueue.c
+ * @brief Lock-free, single-producer/single-consumer queue of parameter
+ *        updates, for handing e.g. source directions over from the control
+ *        (GUI/host) thread to the audio thread
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_paramQueue.h"
+#if defined(_WIN32)
+# include <windows.h>
+# define PARAMQUEUE_ATOMIC_LOAD(p)       InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define PARAMQUEUE_ATOMIC_STORE(p,v)    InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+# define PARAMQUEUE_ATOMIC_EXCHANGE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+# define PARAMQUEUE_ATOMIC_INC(p)        InterlockedIncrement((volatile LONG*)(p))
+#else
+# define PARAMQUEUE_ATOMIC_LOAD(p)       __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define PARAMQUEUE_ATOMIC_STORE(p,v)    __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define PARAMQUEUE_ATOMIC_EXCHANGE(p,v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+# define PARAMQUEUE_ATOMIC_INC(p)        __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#endif
+
+/**
+ * Data structure for the parameter queue.
+ *
+ * The values of each parameter are guarded by a sequence counter, which the
+ * producer increments before and after writing them (so it is odd while the
+ * values are being written). A parameter is queued only if it is not pending
+ * already; and the consumer clears the pending flag before reading the values,
+ * and discards the read if the sequence counter was odd or has changed since.
+ * Any write which overlaps a read therefore finishes by queueing the parameter
+ * again. Since each parameter is queued at most once, the ring never holds
+ * more than nParams entries.
+ */
+typedef struct _safParamQueue_data {
+    int nParams, maxNValues;
+    float** values;               /**< nParams x maxNValues */
+    int* nValues;                 /**< nParams x 1 */
+    volatile long* seq;           /**< sequence counters; nParams x 1 */
+    volatile long* pending;       /**< 1: queued and not popped yet; nParams x 1 */
+    volatile long* ring;          /**< queued parameter indices; nParams x 1 */
+    volatile long writePos;       /**< number of entries queued (written by the producer) */
+    volatile long readPos;        /**< number of entries popped (written by the consumer) */
+
+}safParamQueue_data;
+
+void saf_paramQueue_create
+(
+    void ** const phQueue,
+    int nParams,
+    int maxNValues
+)
+{
+    safParamQueue_data* h;
+
+    h = (safParamQueue_data*)malloc1d(sizeof(safParamQueue_data));
+    *phQueue = (void*)h;
+    h->nParams = nParams < 1 ? 1 : nParams;
+    h->maxNValues = maxNValues < 1 ? 1 : maxNValues;
+    h->values = (float**)calloc2d(h->nParams, h->maxNValues, sizeof(float));
+    h->nValues = (int*)calloc1d(h->nParams, sizeof(int));
+    h->seq = (volatile long*)calloc1d(h->nParams, sizeof(long));
+    h->pending = (volatile long*)calloc1d(h->nParams, sizeof(long));
+    h->ring = (volatile long*)calloc1d(h->nParams, sizeof(long));
+    h->writePos = 0;
+    h->readPos = 0;
+}
+
+void saf_paramQueue_destroy
+(
+    void ** const phQueue
+)
+{
+    safParamQueue_data* h = (safParamQueue_data*)(*phQueue);
+
+    if(h!=NULL){
+        free(h->values);
+        free(h->nValues);
+        free((void*)h->seq);
+        free((void*)h->pending);
+        free((void*)h->ring);
+        free(h);
+        *phQueue = NULL;
+    }
+}
+
+void saf_paramQueue_push
+(
+    void * const hQueue,
+    int param,
+    const float* values,
+    int nValues
+)
+{
+    safParamQueue_data* h = (safParamQueue_data*)(hQueue);
+    long writePos;
+
+    if(param<0 || param>=h->nParams)
+        return;
+    nValues = nValues > h->maxNValues ? h->maxNValues : nValues;
+
+    /* write the values */
+    PARAMQUEUE_ATOMIC_INC(&(h->seq[param]));
+    memcpy(h->values[param], values, nValues*sizeof(float));
+    h->nValues[param] = nValues;
+    PARAMQUEUE_ATOMIC_INC(&(h->seq[param]));
+
+    /* queue the parameter, unless it is still pending (coalescing the update) */
+    if(PARAMQUEUE_ATOMIC_EXCHANGE(&(h->pending[param]), 1L)==0){
+        writePos = h->writePos;
+        h->ring[writePos % h->nParams] = (long)param;
+        PARAMQUEUE_ATOMIC_STORE(&(h->writePos), writePos+1);
+    }
+}
+
+int saf_paramQueue_pop
+(
+    void * const hQueue,
+    int * param,
+    float * values,
+    int * nValues
+)
+{
+    safParamQueue_data* h = (safParamQueue_data*)(hQueue);
+    long readPos, seq;
+    int p, n;
+
+    while(1){
+        readPos = h->readPos;
+        if(readPos == PARAMQUEUE_ATOMIC_LOAD(&(h->writePos)))
+            return 0;
+        p = (int)h->ring[readPos % h->nParams];
+        PARAMQUEUE_ATOMIC_STORE(&(h->readPos), readPos+1);
+        PARAMQUEUE_ATOMIC_STORE(&(h->pending[p]), 0L);
+
+        /* read the values; skipping them if they are being (re)written */
+        seq = PARAMQUEUE_ATOMIC_LOAD(&(h->seq[p]));
+        if(seq & 1L)
+            continue;
+        n = h->nValues[p];
+        memcpy(values, h->values[p], n*sizeof(float));
+        if(PARAMQUEUE_ATOMIC_LOAD(&(h->seq[p]))!=seq)
+            continue;
+        (*param) = p;
+        if(nValues!=NULL)
+            (*nValues) = n;
+        return 1;
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_paramQueue.h
+ * @brief Lock-free, single-producer/single-consumer queue of parameter
+ *        updates, for handing e.g. source directions over from the control
+ *        (GUI/host) thread to the audio thread
+ *
+ * Each parameter is identified by an index (0..nParams-1), and holds a small
+ * vector of values (e.g. the azimuth and elevation of a source), which are
+ * written together by saf_paramQueue_push(). The audio thread calls
+ * saf_paramQueue_pop() at the start of each frame, until it returns 0, and
+ * applies the updates to its own copy of the parameters. Therefore, the audio
+ * thread never observes a half-written multi-value update, and only needs to
+ * recompute what is affected by the parameters that actually changed.
+ *
+ * Repeated updates of a parameter that has not been popped yet are coalesced
+ * (only the most recent values are delivered), so the queue can never
+ * overflow, and pushing never blocks or fails.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_PARAMQUEUE_H_INCLUDED
+#define SAF_PARAMQUEUE_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Creates an instance of the parameter queue
+ *
+ * @param[in] phQueue    (&) address of saf_paramQueue handle
+ * @param[in] nParams    Number of parameters
+ * @param[in] maxNValues Maximum number of values per parameter
+ */
+void saf_paramQueue_create(/* Input Arguments */
+                           void ** const phQueue,
+                           int nParams,
+                           int maxNValues);
+
+/**
+ * Destroys an instance of the parameter queue
+ *
+ * @param[in] phQueue (&) address of saf_paramQueue handle
+ */
+void saf_paramQueue_destroy(/* Input Arguments */
+                            void ** const phQueue);
+
+/**
+ * (Producer) Publishes new values for a parameter; which replace any values
+ * that have been pushed for this parameter but not popped yet
+ *
+ * @param[in] hQueue  saf_paramQueue handle
+ * @param[in] param   Parameter index (0..nParams-1)
+ * @param[in] values  New values; nValues x 1
+ * @param[in] nValues Number of values (at most maxNValues)
+ */
+void saf_paramQueue_push(/* Input Arguments */
+                         void * const hQueue,
+                         int param,
+                         const float* values,
+                         int nValues);
+
+/**
+ * (Consumer) Pops the next pending parameter update
+ *
+ * @note Updates which are being written by the producer while they are popped
+ *       are skipped, since the producer then queues them again.
+ *
+ * @param[in]  hQueue  saf_paramQueue handle
+ * @param[out] param   (&) parameter index
+ * @param[out] values  New values; maxNValues x 1
+ * @param[out] nValues (&) number of values (may be NULL)
+ * @returns    1 if an update was popped, 0 if there are none pending
+ */
+int saf_paramQueue_pop(/* Input Arguments */
+                       void * const hQueue,
+                       /* Output Arguments */
+                       int * param,
+                       float * values,
+                       int * nValues);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_PARAMQUEUE_H_INCLUDED */
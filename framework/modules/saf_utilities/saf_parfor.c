@@ -0,0 +1,452 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_parfor.c
+ * @brief A small pool of worker threads for running "parallel-for" loops,
+ *        e.g. over the bands or scanning directions of a frame
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_parfor.h"
+#if defined(_WIN32)
+# include <windows.h>
+# define PARFOR_ATOMIC_LOAD(p)    InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define PARFOR_ATOMIC_STORE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+# define PARFOR_ATOMIC_INC(p)     InterlockedIncrement((volatile LONG*)(p))
+# define PARFOR_ATOMIC_DEC(p)     InterlockedDecrement((volatile LONG*)(p))
+# define PARFOR_ATOMIC_FETCH_ADD(p,v) InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v))
+# define PARFOR_CPU_PAUSE()       YieldProcessor()
+# define PARFOR_THREAD_YIELD()    SwitchToThread()
+#else
+# include <pthread.h>
+# include <sched.h>
+# include <unistd.h>
+# define PARFOR_THREAD_YIELD()    sched_yield()
+# define PARFOR_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define PARFOR_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define PARFOR_ATOMIC_INC(p)     __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+# define PARFOR_ATOMIC_DEC(p)     __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+# define PARFOR_ATOMIC_FETCH_ADD(p,v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+# if defined(__x86_64__) || defined(__i386__)
+#  define PARFOR_CPU_PAUSE()      __builtin_ia32_pause()
+# elif defined(__aarch64__) || defined(__arm__)
+#  define PARFOR_CPU_PAUSE()      __asm__ __volatile__("yield")
+# else
+#  define PARFOR_CPU_PAUSE()      do{}while(0)
+# endif
+#endif
+
+/** Maximum number of threads selected by SAF_PARFOR_NUM_THREADS_AUTO */
+#define PARFOR_MAX_NUM_AUTO_THREADS ( 8 )
+/** Number of polling iterations before a worker thread goes to sleep */
+#define PARFOR_SPIN_COUNT ( 4096 )
+
+/**
+ * Data structure for the thread pool.
+ *
+ * Like in afSTFTlib, workers are woken by incrementing jobGeneration, and the
+ * calling thread waits for jobsRemaining to reach zero; i.e. a lock-free
+ * barrier per loop. The workers only go to sleep (on 'cond') if no loop has
+ * been issued for a while. For dynamically scheduled loops, the threads take
+ * chunks of the range by atomically advancing nextIndex.
+ */
+typedef struct _safParFor_data {
+    int nThreads;                   /**< number of threads, including the calling thread */
+    struct _safParFor_worker* workers; /**< nThreads-1 */
+    saf_parfor_func func;           /**< current loop body */
+    void* hCtx;                     /**< current loop context */
+    int n;                          /**< current number of indices */
+    int chunkSize;                  /**< current chunk size; 0 for one share per thread */
+    volatile long nextIndex;        /**< first index of the next chunk (dynamically scheduled loops) */
+    volatile long serialFLAG;       /**< set to run the loops on the calling thread alone */
+    volatile long jobGeneration;    /**< incremented for each new loop */
+    volatile long jobsRemaining;    /**< number of workers yet to finish */
+    volatile long nSleeping;        /**< number of workers waiting on 'cond' */
+    volatile long exitFlag;         /**< set to close the worker threads */
+#if defined(_WIN32)
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+
+}safParFor_data;
+
+/** Data structure for one worker thread */
+typedef struct _safParFor_worker {
+    safParFor_data* h; /**< parent pool */
+    int index;         /**< thread index; 1..nThreads-1 */
+    int threadRunning;
+#if defined(_WIN32)
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+
+}safParFor_worker;
+
+/** Returns the number of CPU cores available to the process */
+static int parfor_getNumCores(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+    return nCores > 0 ? (int)nCores : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Processes the share of the current loop belonging to thread 'index'; or, for
+ * dynamically scheduled loops, chunks of the range until none remain
+ */
+static void parfor_processShare(safParFor_data* h, int index)
+{
+    int first, last;
+
+    if(h->chunkSize>0){
+        while((first = (int)PARFOR_ATOMIC_FETCH_ADD(&(h->nextIndex), h->chunkSize)) < h->n){
+            last = MIN(first + h->chunkSize, h->n);
+            h->func(h->hCtx, index, first, last);
+        }
+        return;
+    }
+    first = (int)(((long long)index*h->n)/h->nThreads);
+    last = (int)(((long long)(index+1)*h->n)/h->nThreads);
+    if(first<last)
+        h->func(h->hCtx, index, first, last);
+}
+
+/** Worker thread, which processes its share of each loop */
+#if defined(_WIN32)
+static DWORD WINAPI parfor_workerThread(LPVOID arg)
+#else
+static void* parfor_workerThread(void* arg)
+#endif
+{
+    safParFor_worker* w = (safParFor_worker*)arg;
+    safParFor_data* h = w->h;
+    long lastGeneration;
+    int i;
+    unsigned int fpState;
+
+    /* the pool already shares out the work, so the BLAS/LAPACK backend is kept
+     * to one thread per worker (for the lifetime of the thread) */
+    saf_blasThreads_begin(1);
+
+    /* jobGeneration is zeroed before the workers are created, so a loop that
+     * is issued before this thread gets scheduled is not missed */
+    lastGeneration = 0;
+    while(1){
+        /* Poll for the next loop for a while, and then go to sleep */
+        for(i=0; i<PARFOR_SPIN_COUNT; i++){
+            if(PARFOR_ATOMIC_LOAD(&(h->jobGeneration))!=lastGeneration || PARFOR_ATOMIC_LOAD(&(h->exitFlag)))
+                break;
+            PARFOR_CPU_PAUSE();
+        }
+        if(i==PARFOR_SPIN_COUNT){
+#if defined(_WIN32)
+            EnterCriticalSection(&(h->mutex));
+            PARFOR_ATOMIC_INC(&(h->nSleeping));
+            while(PARFOR_ATOMIC_LOAD(&(h->jobGeneration))==lastGeneration && !PARFOR_ATOMIC_LOAD(&(h->exitFlag)))
+                SleepConditionVariableCS(&(h->cond), &(h->mutex), INFINITE);
+            PARFOR_ATOMIC_DEC(&(h->nSleeping));
+            LeaveCriticalSection(&(h->mutex));
+#else
+            pthread_mutex_lock(&(h->mutex));
+            PARFOR_ATOMIC_INC(&(h->nSleeping));
+            while(PARFOR_ATOMIC_LOAD(&(h->jobGeneration))==lastGeneration && !PARFOR_ATOMIC_LOAD(&(h->exitFlag)))
+                pthread_cond_wait(&(h->cond), &(h->mutex));
+            PARFOR_ATOMIC_DEC(&(h->nSleeping));
+            pthread_mutex_unlock(&(h->mutex));
+#endif
+        }
+        if(PARFOR_ATOMIC_LOAD(&(h->exitFlag)))
+            break;
+        lastGeneration = PARFOR_ATOMIC_LOAD(&(h->jobGeneration));
+
+        /* the denormals guard of the calling thread does not carry over to
+         * the workers, so it is applied to each share of the loop (and
+         * re-read every time, in case it has since been disabled) */
+        fpState = saf_denormals_guardBegin();
+        parfor_processShare(h, w->index);
+        saf_denormals_guardEnd(fpState);
+        PARFOR_ATOMIC_DEC(&(h->jobsRemaining));
+    }
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+/** Wakes all workers that are waiting on the condition variable */
+static void parfor_wakeWorkers(safParFor_data* h)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(&(h->mutex));
+    WakeAllConditionVariable(&(h->cond));
+    LeaveCriticalSection(&(h->mutex));
+#else
+    pthread_mutex_lock(&(h->mutex));
+    pthread_cond_broadcast(&(h->cond));
+    pthread_mutex_unlock(&(h->mutex));
+#endif
+}
+
+void saf_parfor_create
+(
+    void ** const phPar,
+    int nThreads
+)
+{
+    safParFor_data* h;
+    safParFor_worker* w;
+    int i;
+
+    h = (safParFor_data*)malloc1d(sizeof(safParFor_data));
+    *phPar = (void*)h;
+    if(nThreads==SAF_PARFOR_NUM_THREADS_AUTO)
+        nThreads = MIN(parfor_getNumCores(), PARFOR_MAX_NUM_AUTO_THREADS);
+    h->nThreads = nThreads < 1 ? 1 : nThreads;
+    h->func = NULL;
+    h->hCtx = NULL;
+    h->n = 0;
+    h->chunkSize = 0;
+    h->nextIndex = 0;
+    h->serialFLAG = 0;
+    h->jobGeneration = 0;
+    h->jobsRemaining = 0;
+    h->nSleeping = 0;
+    h->exitFlag = 0;
+#if defined(_WIN32)
+    InitializeCriticalSection(&(h->mutex));
+    InitializeConditionVariable(&(h->cond));
+#else
+    pthread_mutex_init(&(h->mutex), NULL);
+    pthread_cond_init(&(h->cond), NULL);
+#endif
+
+    /* start the worker threads */
+    h->workers = h->nThreads > 1 ? (safParFor_worker*)malloc1d((h->nThreads-1)*sizeof(safParFor_worker)) : NULL;
+    for(i=0; i<h->nThreads-1; i++){
+        w = &(h->workers[i]);
+        w->h = h;
+        w->index = i+1;
+#if defined(_WIN32)
+        w->thread = CreateThread(NULL, 0, parfor_workerThread, (LPVOID)w, 0, NULL);
+        w->threadRunning = w->thread != NULL ? 1 : 0;
+#else
+        w->threadRunning = pthread_create(&(w->thread), NULL, parfor_workerThread, (void*)w) == 0 ? 1 : 0;
+#endif
+        if(!w->threadRunning){
+            h->nThreads = i+1; /* carry on with the threads created so far */
+            break;
+        }
+    }
+}
+
+void saf_parfor_destroy
+(
+    void ** const phPar
+)
+{
+    safParFor_data* h = (safParFor_data*)(*phPar);
+    int i;
+
+    if(h!=NULL){
+        /* close the worker threads */
+        PARFOR_ATOMIC_STORE(&(h->exitFlag), 1);
+        parfor_wakeWorkers(h);
+        for(i=0; i<h->nThreads-1; i++){
+            if(h->workers[i].threadRunning){
+#if defined(_WIN32)
+                WaitForSingleObject(h->workers[i].thread, INFINITE);
+                CloseHandle(h->workers[i].thread);
+#else
+                pthread_join(h->workers[i].thread, NULL);
+#endif
+            }
+        }
+#if defined(_WIN32)
+        DeleteCriticalSection(&(h->mutex));
+#else
+        pthread_mutex_destroy(&(h->mutex));
+        pthread_cond_destroy(&(h->cond));
+#endif
+        free(h->workers);
+        free(h);
+        *phPar = NULL;
+    }
+}
+
+int saf_parfor_getNumThreads
+(
+    void * const hPar
+)
+{
+    safParFor_data* h = (safParFor_data*)(hPar);
+
+    return h==NULL ? 1 : h->nThreads;
+}
+
+/** Issues a loop to the workers, processes the share of the calling thread,
+ *  and waits for the workers to finish */
+static void parfor_runLoop
+(
+    safParFor_data* h,
+    saf_parfor_func func,
+    void * const hCtx,
+    int n,
+    int chunkSize
+)
+{
+    int i;
+
+    /* wake up the workers */
+    h->func = func;
+    h->hCtx = hCtx;
+    h->n = n;
+    h->chunkSize = chunkSize;
+    PARFOR_ATOMIC_STORE(&(h->nextIndex), 0);
+    PARFOR_ATOMIC_STORE(&(h->jobsRemaining), h->nThreads-1);
+    PARFOR_ATOMIC_INC(&(h->jobGeneration));
+    if(PARFOR_ATOMIC_LOAD(&(h->nSleeping))>0)
+        parfor_wakeWorkers(h);
+
+    /* the calling thread takes the first share, and then waits for the rest */
+    parfor_processShare(h, 0);
+    for(i=0; PARFOR_ATOMIC_LOAD(&(h->jobsRemaining))>0; i++){
+        if(i<PARFOR_SPIN_COUNT)
+            PARFOR_CPU_PAUSE();
+        else
+            PARFOR_THREAD_YIELD(); /* workers may be sharing this core */
+    }
+}
+
+void saf_parfor_run
+(
+    void * const hPar,
+    saf_parfor_func func,
+    void * const hCtx,
+    int n
+)
+{
+    safParFor_data* h = (safParFor_data*)(hPar);
+
+    if(n<1)
+        return;
+    if(h==NULL || h->nThreads<2 || n<2 || PARFOR_ATOMIC_LOAD(&(h->serialFLAG))){
+        func(hCtx, 0, 0, n);
+        return;
+    }
+    parfor_runLoop(h, func, hCtx, n, 0);
+}
+
+void saf_parfor_runDynamic
+(
+    void * const hPar,
+    saf_parfor_func func,
+    void * const hCtx,
+    int n,
+    int chunkSize
+)
+{
+    safParFor_data* h = (safParFor_data*)(hPar);
+
+    if(n<1)
+        return;
+    chunkSize = MAX(chunkSize, 1);
+    if(h==NULL || h->nThreads<2 || n<=chunkSize || PARFOR_ATOMIC_LOAD(&(h->serialFLAG))){
+        func(hCtx, 0, 0, n);
+        return;
+    }
+    parfor_runLoop(h, func, hCtx, n, chunkSize);
+}
+
+int saf_parfor_setPriority
+(
+    void * const hPar,
+    SAF_PARFOR_PRIORITY priority
+)
+{
+    safParFor_data* h = (safParFor_data*)(hPar);
+    int i, allApplied;
+#if defined(_WIN32)
+    int winPriority;
+
+    switch(priority){
+        default:
+        case SAF_PARFOR_PRIORITY_NORMAL:       winPriority = THREAD_PRIORITY_NORMAL; break;
+        case SAF_PARFOR_PRIORITY_MATCH_CALLER: winPriority = GetThreadPriority(GetCurrentThread()); break;
+        case SAF_PARFOR_PRIORITY_REALTIME:     winPriority = THREAD_PRIORITY_TIME_CRITICAL; break;
+    }
+#else
+    int policy;
+    struct sched_param param;
+
+    memset(&param, 0, sizeof(struct sched_param));
+    switch(priority){
+        default:
+        case SAF_PARFOR_PRIORITY_NORMAL:
+            policy = SCHED_OTHER;
+            break;
+        case SAF_PARFOR_PRIORITY_MATCH_CALLER:
+            if(pthread_getschedparam(pthread_self(), &policy, &param)!=0)
+                return 0;
+            break;
+        case SAF_PARFOR_PRIORITY_REALTIME:
+            policy = SCHED_FIFO;
+            param.sched_priority = MAX(sched_get_priority_max(SCHED_FIFO)-1, sched_get_priority_min(SCHED_FIFO));
+            break;
+    }
+#endif
+
+    if(h==NULL)
+        return 0;
+    allApplied = 1;
+    for(i=0; i<h->nThreads-1; i++){
+#if defined(_WIN32)
+        if(!SetThreadPriority(h->workers[i].thread, winPriority))
+            allApplied = 0;
+#else
+        if(pthread_setschedparam(h->workers[i].thread, policy, &param)!=0)
+            allApplied = 0;
+#endif
+    }
+    return allApplied;
+}
+
+void saf_parfor_setRunOnCallingThread
+(
+    void * const hPar,
+    int newState
+)
+{
+    safParFor_data* h = (safParFor_data*)(hPar);
+
+    if(h!=NULL)
+        PARFOR_ATOMIC_STORE(&(h->serialFLAG), newState ? 1 : 0);
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_parfor.h
+ * @brief A small pool of worker threads for running "parallel-for" loops,
+ *        e.g. over the bands or scanning directions of a frame
+ *
+ * With saf_parfor_run(), the index range of each loop is split into one
+ * contiguous share per thread; thread 'index' always processes
+ * [index*n/nThreads, (index+1)*n/nThreads), and the calling thread takes the
+ * first share. Therefore, each thread may be given its own (pre-allocated)
+ * scratch memory, and the results are deterministic, provided that each share
+ * only writes to its own part of the output.
+ *
+ * For loops where the cost per index varies, saf_parfor_runDynamic() instead
+ * hands out small chunks of the range to whichever thread is free, so that a
+ * thread that finishes early takes over the work that remains. The thread
+ * index passed to the loop body still identifies the calling thread (and so
+ * its scratch memory), although which thread processes which chunk varies.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_PARFOR_H_INCLUDED
+#define SAF_PARFOR_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Pass to saf_parfor_create() to use one thread per CPU core (up to 8) */
+#define SAF_PARFOR_NUM_THREADS_AUTO ( 0 )
+
+/** Scheduling priority options for the worker threads */
+typedef enum _SAF_PARFOR_PRIORITY{
+    SAF_PARFOR_PRIORITY_NORMAL = 1,   /**< Default priority of the OS */
+    SAF_PARFOR_PRIORITY_MATCH_CALLER, /**< Same scheduling policy and priority
+                                       *   as the thread calling
+                                       *   saf_parfor_setPriority() (e.g. the
+                                       *   audio thread) */
+    SAF_PARFOR_PRIORITY_REALTIME      /**< Real-time priority; SCHED_FIFO (at
+                                       *   one below the maximum priority), or
+                                       *   THREAD_PRIORITY_TIME_CRITICAL on
+                                       *   Windows */
+
+}SAF_PARFOR_PRIORITY;
+
+/**
+ * Prototype of a loop body, which processes the indices [first, last)
+ *
+ * @param[in] hCtx        Handle passed to saf_parfor_run()
+ * @param[in] threadIndex Index of the calling thread; 0..nThreads-1
+ * @param[in] first       First index to process
+ * @param[in] last        One past the last index to process
+ */
+typedef void (*saf_parfor_func)(void* const hCtx,
+                                int threadIndex,
+                                int first,
+                                int last);
+
+/**
+ * Creates an instance of the thread pool, and starts its worker threads
+ *
+ * @note If some of the worker threads cannot be started, then the pool
+ *       carries on with the threads that could be; see
+ *       saf_parfor_getNumThreads().
+ *
+ * @param[in] phPar    (&) address of saf_parfor handle
+ * @param[in] nThreads Number of threads, including the calling thread; '1'
+ *                     single-threaded, or SAF_PARFOR_NUM_THREADS_AUTO
+ */
+void saf_parfor_create(/* Input Arguments */
+                       void ** const phPar,
+                       int nThreads);
+
+/**
+ * Stops the worker threads, and destroys an instance of the thread pool
+ *
+ * @param[in] phPar (&) address of saf_parfor handle
+ */
+void saf_parfor_destroy(/* Input Arguments */
+                        void ** const phPar);
+
+/**
+ * Returns the number of threads (including the calling thread) used by
+ * saf_parfor_run(); i.e. the number of scratch buffers that the loop bodies
+ * may need
+ *
+ * @param[in] hPar saf_parfor handle (NULL is treated as single-threaded)
+ */
+int saf_parfor_getNumThreads(/* Input Arguments */
+                             void * const hPar);
+
+/**
+ * Calls 'func' for all indices 0..n-1, split over the threads of the pool, and
+ * returns once all of the shares have been processed
+ *
+ * @note Does not allocate memory, so it may be called from the audio thread.
+ *       Loops must not be nested, and only one thread at a time may call
+ *       saf_parfor_run() with the same pool.
+ *
+ * @param[in] hPar saf_parfor handle (if NULL, func(hCtx,0,0,n) is called)
+ * @param[in] func Loop body
+ * @param[in] hCtx Handle passed to the loop body
+ * @param[in] n    Number of indices
+ */
+void saf_parfor_run(/* Input Arguments */
+                    void * const hPar,
+                    saf_parfor_func func,
+                    void * const hCtx,
+                    int n);
+
+/**
+ * Calls 'func' for all indices 0..n-1, in chunks of (up to) 'chunkSize'
+ * indices, which are taken by each thread in turn as it becomes free; and
+ * returns once all of the chunks have been processed
+ *
+ * @note The same rules as for saf_parfor_run() apply.
+ *
+ * @param[in] hPar      saf_parfor handle (if NULL, func(hCtx,0,0,n) is called)
+ * @param[in] func      Loop body
+ * @param[in] hCtx      Handle passed to the loop body
+ * @param[in] n         Number of indices
+ * @param[in] chunkSize Number of indices per chunk; a smaller size balances
+ *                      the load better, but costs more synchronisation
+ */
+void saf_parfor_runDynamic(/* Input Arguments */
+                           void * const hPar,
+                           saf_parfor_func func,
+                           void * const hCtx,
+                           int n,
+                           int chunkSize);
+
+/**
+ * Sets the scheduling priority of the worker threads
+ *
+ * For real-time processing, the workers should run at the same priority as the
+ * audio thread; otherwise, the audio thread may end up waiting on a worker
+ * that has been pre-empted by a less urgent thread.
+ *
+ * @note Real-time priorities often require elevated privileges; in which case,
+ *       the workers carry on with their current priority.
+ *
+ * @param[in] hPar     saf_parfor handle
+ * @param[in] priority See #SAF_PARFOR_PRIORITY
+ * @returns   1 if the priority was applied to all worker threads, 0 otherwise
+ */
+int saf_parfor_setPriority(/* Input Arguments */
+                           void * const hPar,
+                           SAF_PARFOR_PRIORITY priority);
+
+/**
+ * Sets whether all loops should run on the calling thread alone
+ *
+ * This allows the host to switch off the multi-threading (e.g. when it already
+ * processes several instances in parallel) without destroying the pool, or
+ * reallocating the per-thread scratch memory of its users. The loop bodies are
+ * then always called with threadIndex 0, and the worker threads go to sleep.
+ *
+ * @param[in] hPar     saf_parfor handle
+ * @param[in] newState '1' run on the calling thread, '0' use the pool
+ */
+void saf_parfor_setRunOnCallingThread(/* Input Arguments */
+                                      void * const hPar,
+                                      int newState);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_PARFOR_H_INCLUDED */
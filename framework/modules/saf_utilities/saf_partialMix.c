@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_partialMix.c
+ * @brief Partial-output frames, and their aggregator, for rendering a scene
+ *        whose sources are partitioned over several nodes
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_partialMix.h"
+
+/** One frame of the mix */
+typedef struct _partialMix_slot {
+    long long frameIndex;  /**< frame being summed in the slot (-1: free) */
+    int nReceived;         /**< number of nodes that have delivered it */
+    char* received;        /**< whether each node has delivered it; nNodes x 1 */
+    float* sum;            /**< sum of the partial frames; nFloats x 1 */
+
+}partialMix_slot;
+
+/** Data structure for the aggregator of partial frames */
+typedef struct _safPartialMix_data {
+    int nNodes, domain, nChannels, frameSize, nBands, nTimeSlots, sampleRate;
+    int nFloats;           /**< number of floats per frame */
+    int processingDelay;   /**< of the first frame accepted (-1: none yet) */
+    int maxLatency;        /**< maximum number of frames a frame may be overtaken by */
+    int nSlots;            /**< maxLatency+2 (i.e. the frame that makes the oldest one overdue still fits) */
+    long long nextFrame;   /**< next frame to output (-1: none received yet) */
+    long long newestFrame; /**< latest frame received */
+    partialMix_slot* slots;
+
+}safPartialMix_data;
+
+/** Frees a slot of the mix */
+static void partialMix_clearSlot(safPartialMix_data* h, partialMix_slot* s)
+{
+    s->frameIndex = -1;
+    s->nReceived = 0;
+    memset(s->received, 0, h->nNodes*sizeof(char));
+}
+
+int saf_partialFrame_getNumFloats
+(
+    const saf_partialFrameHeader* header
+)
+{
+    if(header->domain==SAF_PARTIAL_FRAME_TF_DOMAIN)
+        return 2*header->nBands*header->nChannels*header->nTimeSlots;
+    return header->nChannels*header->frameSize;
+}
+
+size_t saf_partialFrame_getNumBytes
+(
+    const saf_partialFrameHeader* header
+)
+{
+    return sizeof(saf_partialFrameHeader) + (size_t)saf_partialFrame_getNumFloats(header)*sizeof(float);
+}
+
+void saf_partialFrame_pack
+(
+    const saf_partialFrameHeader* header,
+    const float* data,
+    void* packet
+)
+{
+    saf_partialFrameHeader hdr;
+
+    hdr = *header;
+    hdr.magic = SAF_PARTIAL_FRAME_MAGIC;
+    hdr.version = SAF_PARTIAL_FRAME_VERSION;
+    memcpy(packet, &hdr, sizeof(saf_partialFrameHeader));
+    memcpy((char*)packet + sizeof(saf_partialFrameHeader), data, saf_partialFrame_getNumFloats(&hdr)*sizeof(float));
+}
+
+void saf_partialFrame_packTD
+(
+    const saf_partialFrameHeader* header,
+    float** frame,
+    void* packet
+)
+{
+    saf_partialFrameHeader hdr;
+    char* data;
+    int ch;
+
+    hdr = *header;
+    hdr.magic = SAF_PARTIAL_FRAME_MAGIC;
+    hdr.version = SAF_PARTIAL_FRAME_VERSION;
+    hdr.domain = SAF_PARTIAL_FRAME_TIME_DOMAIN;
+    memcpy(packet, &hdr, sizeof(saf_partialFrameHeader));
+    data = (char*)packet + sizeof(saf_partialFrameHeader);
+    for(ch=0; ch<hdr.nChannels; ch++)
+        memcpy(data + (size_t)ch*hdr.frameSize*sizeof(float), frame[ch], hdr.frameSize*sizeof(float));
+}
+
+int saf_partialFrame_unpack
+(
+    const void* packet,
+    size_t nBytes,
+    saf_partialFrameHeader* header,
+    const float** data
+)
+{
+    if(packet==NULL || nBytes<sizeof(saf_partialFrameHeader))
+        return 0;
+    memcpy(header, packet, sizeof(saf_partialFrameHeader));
+    if(header->magic!=SAF_PARTIAL_FRAME_MAGIC || header->version!=SAF_PARTIAL_FRAME_VERSION)
+        return 0;
+    if((header->domain!=SAF_PARTIAL_FRAME_TIME_DOMAIN && header->domain!=SAF_PARTIAL_FRAME_TF_DOMAIN) ||
+       header->nChannels<0 || header->frameSize<0 || header->nBands<0 || header->nTimeSlots<0)
+        return 0;
+    if(nBytes<saf_partialFrame_getNumBytes(header))
+        return 0;
+    if(data!=NULL)
+        (*data) = (const float*)((const char*)packet + sizeof(saf_partialFrameHeader));
+    return 1;
+}
+
+void saf_partialMix_create
+(
+    void ** const phMix,
+    int nNodes,
+    int domain,
+    int nChannels,
+    int frameSize,
+    int nBands,
+    int nTimeSlots,
+    int sampleRate,
+    int maxLatencyFrames
+)
+{
+    safPartialMix_data* h;
+    saf_partialFrameHeader hdr;
+    int i;
+
+    h = (safPartialMix_data*)malloc1d(sizeof(safPartialMix_data));
+    *phMix = (void*)h;
+    h->nNodes = MAX(nNodes, 1);
+    h->domain = domain;
+    h->nChannels = nChannels;
+    h->frameSize = frameSize;
+    h->nBands = domain==SAF_PARTIAL_FRAME_TF_DOMAIN ? nBands : 0;
+    h->nTimeSlots = domain==SAF_PARTIAL_FRAME_TF_DOMAIN ? nTimeSlots : 0;
+    h->sampleRate = sampleRate;
+    memset(&hdr, 0, sizeof(saf_partialFrameHeader));
+    hdr.domain = h->domain;
+    hdr.nChannels = h->nChannels;
+    hdr.frameSize = h->frameSize;
+    hdr.nBands = h->nBands;
+    hdr.nTimeSlots = h->nTimeSlots;
+    h->nFloats = saf_partialFrame_getNumFloats(&hdr);
+    h->maxLatency = MAX(maxLatencyFrames, 0);
+    h->nSlots = h->maxLatency + 2;
+    h->slots = (partialMix_slot*)malloc1d(h->nSlots*sizeof(partialMix_slot));
+    for(i=0; i<h->nSlots; i++){
+        h->slots[i].received = malloc1d(h->nNodes*sizeof(char));
+        h->slots[i].sum = malloc1d(MAX(h->nFloats,1)*sizeof(float));
+    }
+    saf_partialMix_reset(*phMix);
+}
+
+void saf_partialMix_destroy
+(
+    void ** const phMix
+)
+{
+    safPartialMix_data* h = (safPartialMix_data*)(*phMix);
+    int i;
+
+    if(h!=NULL){
+        for(i=0; i<h->nSlots; i++){
+            free(h->slots[i].received);
+            free(h->slots[i].sum);
+        }
+        free(h->slots);
+        free(h);
+        *phMix = NULL;
+    }
+}
+
+void saf_partialMix_reset
+(
+    void * const hMix
+)
+{
+    safPartialMix_data* h = (safPartialMix_data*)(hMix);
+    int i;
+
+    for(i=0; i<h->nSlots; i++)
+        partialMix_clearSlot(h, &(h->slots[i]));
+    h->nextFrame = -1;
+    h->newestFrame = -1;
+    h->processingDelay = -1;
+}
+
+SAF_PARTIAL_MIX_STATUS saf_partialMix_push
+(
+    void * const hMix,
+    const void* packet,
+    size_t nBytes
+)
+{
+    safPartialMix_data* h = (safPartialMix_data*)(hMix);
+    SAF_PARTIAL_MIX_STATUS status;
+    saf_partialFrameHeader hdr;
+    partialMix_slot* s;
+    const float* data;
+    long long f;
+    int i;
+
+    /* check that the frame belongs to this mix */
+    if(!saf_partialFrame_unpack(packet, nBytes, &hdr, &data))
+        return SAF_PARTIAL_MIX_INVALID;
+    if(hdr.nNodes!=h->nNodes || hdr.nodeIndex<0 || hdr.nodeIndex>=h->nNodes || hdr.domain!=h->domain ||
+       hdr.nChannels!=h->nChannels || hdr.frameSize!=h->frameSize || hdr.nBands!=h->nBands ||
+       hdr.nTimeSlots!=h->nTimeSlots || hdr.sampleRate!=h->sampleRate || hdr.frameIndex<0)
+        return SAF_PARTIAL_MIX_INVALID;
+    if(h->processingDelay>=0 && hdr.processingDelay!=h->processingDelay)
+        return SAF_PARTIAL_MIX_INVALID; /* (the sum would be misaligned) */
+    h->processingDelay = hdr.processingDelay;
+    f = hdr.frameIndex;
+
+    /* the first frame received starts the mix */
+    if(h->nextFrame<0)
+        h->nextFrame = f;
+    if(f<h->nextFrame)
+        return SAF_PARTIAL_MIX_LATE;
+
+    /* make room for the frame (e.g. if the frames are not being pulled, or if
+     * the nodes have jumped ahead) */
+    status = SAF_PARTIAL_MIX_OK;
+    if(f>=h->nextFrame+h->nSlots){
+        if(f>=h->nextFrame+2*h->nSlots){
+            for(i=0; i<h->nSlots; i++)
+                partialMix_clearSlot(h, &(h->slots[i]));
+            h->nextFrame = f-h->nSlots+1;
+        }
+        for(; f>=h->nextFrame+h->nSlots; h->nextFrame++)
+            partialMix_clearSlot(h, &(h->slots[h->nextFrame % h->nSlots]));
+        status = SAF_PARTIAL_MIX_OVERRUN;
+    }
+
+    /* add it to the sum */
+    s = &(h->slots[f % h->nSlots]);
+    if(s->frameIndex!=f){
+        partialMix_clearSlot(h, s);
+        s->frameIndex = f;
+        memset(s->sum, 0, h->nFloats*sizeof(float));
+    }
+    if(s->received[hdr.nodeIndex])
+        return SAF_PARTIAL_MIX_DUPLICATE;
+    s->received[hdr.nodeIndex] = 1;
+    s->nReceived++;
+    utility_svvadd(s->sum, data, h->nFloats, s->sum);
+    h->newestFrame = MAX(h->newestFrame, f);
+    return status;
+}
+
+int saf_partialMix_pull
+(
+    void * const hMix,
+    float* out,
+    long long* frameIndex,
+    int* nMissing
+)
+{
+    safPartialMix_data* h = (safPartialMix_data*)(hMix);
+    partialMix_slot* s;
+    int isComplete, isOverdue;
+
+    if(h->nextFrame<0)
+        return 0;
+    s = &(h->slots[h->nextFrame % h->nSlots]);
+    isComplete = s->frameIndex==h->nextFrame && s->nReceived==h->nNodes;
+    isOverdue = h->newestFrame-h->nextFrame > h->maxLatency;
+    if(!isComplete && !isOverdue)
+        return 0;
+
+    /* output the frame, with any missing nodes treated as silent */
+    if(s->frameIndex==h->nextFrame){
+        memcpy(out, s->sum, h->nFloats*sizeof(float));
+        if(nMissing!=NULL)
+            (*nMissing) = h->nNodes - s->nReceived;
+    }
+    else{
+        memset(out, 0, h->nFloats*sizeof(float));
+        if(nMissing!=NULL)
+            (*nMissing) = h->nNodes;
+    }
+    if(frameIndex!=NULL)
+        (*frameIndex) = h->nextFrame;
+    partialMix_clearSlot(h, s);
+    h->nextFrame++;
+    return 1;
+}
+
+int saf_partialMix_getProcessingDelay
+(
+    void * const hMix
+)
+{
+    safPartialMix_data* h = (safPartialMix_data*)(hMix);
+    return h->processingDelay;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_partialMix.h
+ * @brief Partial-output frames, and their aggregator, for rendering a scene
+ *        whose sources are partitioned over several nodes (machines or
+ *        processes)
+ *
+ * Each node renders a subset of the sources of the scene (e.g. with
+ * binauraliser or panner, telling them the total number of sources in the
+ * scene, with binauraliser_setNumSceneSources() or panner_setNumSceneSources(),
+ * such that all nodes apply the same normalisation), and packs each of its
+ * output frames into a partial frame with saf_partialFrame_pack(). These are
+ * sent to the aggregator by whatever transport is available (e.g. a socket, or
+ * a saf_shmBus on the same machine), which sums them with saf_partialMix_push()
+ * and saf_partialMix_pull(). Since the rendering is linear in the sources, the
+ * summed partial outputs are the same as the output of rendering all of the
+ * sources on one node.
+ *
+ * A partial frame is a saf_partialFrameHeader, followed by the frame data, as
+ * floats. The data is either in the time-domain (FLAT: nChannels x frameSize),
+ * or in the time-frequency domain (FLAT: nBands x nChannels x nTimeSlots, as
+ * interleaved complex values); the latter allowing the aggregator to apply the
+ * inverse transform once, rather than each node.
+ *
+ * The frames are aligned by their frame index: i.e. the index of the block of
+ * input samples (of the scene clock, which is shared by all nodes) from which
+ * the frame was rendered. All nodes must therefore process the same blocks of
+ * the scene with the same frame size, and their processing delays must match
+ * (which is checked by the aggregator). A frame is output by the aggregator
+ * once all nodes have delivered it, or once a frame more than
+ * maxLatencyFrames later has arrived; in which case the missing nodes are
+ * treated as silent (and reported).
+ *
+ * @note The partial frames are in the native byte order, and hence the nodes
+ *       and the aggregator must be built for the same architecture. The
+ *       aggregator is not thread-safe; i.e. saf_partialMix_push() and
+ *       saf_partialMix_pull() should be called from the same thread (or
+ *       guarded by the caller).
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_PARTIALMIX_H_INCLUDED
+#define SAF_PARTIALMIX_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/** Identifies a partial frame ("SAFP") */
+#define SAF_PARTIAL_FRAME_MAGIC ( 0x50464153u )
+/** Version of the partial frame format */
+#define SAF_PARTIAL_FRAME_VERSION ( 1 )
+
+/** Domain of the data of a partial frame */
+typedef enum _SAF_PARTIAL_FRAME_DOMAINS {
+    SAF_PARTIAL_FRAME_TIME_DOMAIN = 1, /**< nChannels x frameSize (real) */
+    SAF_PARTIAL_FRAME_TF_DOMAIN        /**< nBands x nChannels x nTimeSlots (complex) */
+
+}SAF_PARTIAL_FRAME_DOMAINS;
+
+/** Status returned by saf_partialMix_push() */
+typedef enum _SAF_PARTIAL_MIX_STATUS {
+    SAF_PARTIAL_MIX_OK = 0,    /**< The frame was added to the mix */
+    SAF_PARTIAL_MIX_OVERRUN,   /**< The frame was added, but older frames
+                                *   that had not been pulled yet had to be
+                                *   discarded to make room for it */
+    SAF_PARTIAL_MIX_LATE,      /**< The frame arrived after its mix was
+                                *   output (it is discarded) */
+    SAF_PARTIAL_MIX_DUPLICATE, /**< The node has already delivered this frame
+                                *   (it is discarded) */
+    SAF_PARTIAL_MIX_INVALID    /**< The frame is not a partial frame, or does
+                                *   not match the configuration of the
+                                *   aggregator (it is discarded) */
+
+}SAF_PARTIAL_MIX_STATUS;
+
+/** Header of a partial frame */
+typedef struct _saf_partialFrameHeader {
+    unsigned int magic;      /**< SAF_PARTIAL_FRAME_MAGIC (set by
+                              *   saf_partialFrame_pack()) */
+    int version;             /**< SAF_PARTIAL_FRAME_VERSION (set by
+                              *   saf_partialFrame_pack()) */
+    int nodeIndex;           /**< Index of the node; 0..nNodes-1 */
+    int nNodes;              /**< Number of nodes rendering the scene */
+    int firstSource;         /**< First source rendered by the node (for
+                              *   information) */
+    int nSources;            /**< Number of sources rendered by the node (for
+                              *   information) */
+    int nSceneSources;       /**< Number of sources in the scene (for
+                              *   information) */
+    int domain;              /**< See SAF_PARTIAL_FRAME_DOMAINS */
+    int nChannels;           /**< Number of output channels */
+    int frameSize;           /**< Number of samples per frame (in both
+                              *   domains) */
+    int nBands;              /**< Number of bands (TF-domain; 0 otherwise) */
+    int nTimeSlots;          /**< Number of time slots (TF-domain; 0
+                              *   otherwise) */
+    int sampleRate;          /**< Sample rate of the scene, in Hz */
+    int processingDelay;     /**< Processing delay of the node's renderer, in
+                              *   samples */
+    long long frameIndex;    /**< Index of the block of the scene from which
+                              *   the frame was rendered; i.e. its first input
+                              *   sample is frameIndex*frameSize */
+    double timestamp;        /**< Time of the frame on the scene clock, in
+                              *   seconds (for information) */
+
+}saf_partialFrameHeader;
+
+/**
+ * Returns the number of floats of the data of a partial frame with the given
+ * header
+ */
+int saf_partialFrame_getNumFloats(/* Input Arguments */
+                                  const saf_partialFrameHeader* header);
+
+/**
+ * Returns the number of bytes of a partial frame with the given header (i.e.
+ * the size of the header and of its data)
+ */
+size_t saf_partialFrame_getNumBytes(/* Input Arguments */
+                                    const saf_partialFrameHeader* header);
+
+/**
+ * Packs a frame rendered by a node into a partial frame
+ *
+ * @param[in]  header Header of the frame (its magic and version are set
+ *                    automatically)
+ * @param[in]  data   Frame data; FLAT: nChannels x frameSize (time-domain), or
+ *                    nBands x nChannels x nTimeSlots complex values (TF-domain)
+ * @param[out] packet Partial frame; saf_partialFrame_getNumBytes() bytes
+ */
+void saf_partialFrame_pack(/* Input Arguments */
+                           const saf_partialFrameHeader* header,
+                           const float* data,
+                           /* Output Arguments */
+                           void* packet);
+
+/**
+ * Packs a planar time-domain frame rendered by a node (e.g. the outputs of
+ * binauraliser_process()) into a partial frame (see saf_partialFrame_pack())
+ *
+ * @param[in]  header Header of the frame (domain: SAF_PARTIAL_FRAME_TIME_DOMAIN)
+ * @param[in]  frame  Frame; nChannels x frameSize
+ * @param[out] packet Partial frame; saf_partialFrame_getNumBytes() bytes
+ */
+void saf_partialFrame_packTD(/* Input Arguments */
+                             const saf_partialFrameHeader* header,
+                             float** frame,
+                             /* Output Arguments */
+                             void* packet);
+
+/**
+ * Unpacks a partial frame (in place)
+ *
+ * @param[in]  packet Partial frame
+ * @param[in]  nBytes Number of bytes received
+ * @param[out] header (&) header of the frame
+ * @param[out] data   (&) frame data, pointing into the packet (may be NULL);
+ *                    saf_partialFrame_getNumFloats() floats
+ * @returns 1 if the packet is a complete partial frame, 0 otherwise
+ */
+int saf_partialFrame_unpack(/* Input Arguments */
+                            const void* packet,
+                            size_t nBytes,
+                            /* Output Arguments */
+                            saf_partialFrameHeader* header,
+                            const float** data);
+
+/**
+ * Creates an aggregator of partial frames
+ *
+ * @param[in] phMix            (&) address of the saf_partialMix handle
+ * @param[in] nNodes           Number of nodes rendering the scene
+ * @param[in] domain           See SAF_PARTIAL_FRAME_DOMAINS
+ * @param[in] nChannels        Number of output channels
+ * @param[in] frameSize        Number of samples per frame
+ * @param[in] nBands           Number of bands (TF-domain; 0 otherwise)
+ * @param[in] nTimeSlots       Number of time slots (TF-domain; 0 otherwise)
+ * @param[in] sampleRate       Sample rate of the scene, in Hz
+ * @param[in] maxLatencyFrames Number of later frames that may arrive, before
+ *                             a frame is output without the nodes that have
+ *                             not delivered it yet
+ */
+void saf_partialMix_create(/* Input Arguments */
+                           void ** const phMix,
+                           int nNodes,
+                           int domain,
+                           int nChannels,
+                           int frameSize,
+                           int nBands,
+                           int nTimeSlots,
+                           int sampleRate,
+                           int maxLatencyFrames);
+
+/**
+ * Destroys an aggregator of partial frames
+ *
+ * @param[in] phMix (&) address of the saf_partialMix handle
+ */
+void saf_partialMix_destroy(/* Input Arguments */
+                            void ** const phMix);
+
+/**
+ * Discards all pending frames; the next frame pushed restarts the mix
+ */
+void saf_partialMix_reset(/* Input Arguments */
+                          void * const hMix);
+
+/**
+ * Adds a partial frame received from a node to the mix
+ *
+ * @param[in] hMix   saf_partialMix handle
+ * @param[in] packet Partial frame
+ * @param[in] nBytes Number of bytes received
+ * @returns See SAF_PARTIAL_MIX_STATUS
+ */
+SAF_PARTIAL_MIX_STATUS saf_partialMix_push(/* Input Arguments */
+                                           void * const hMix,
+                                           const void* packet,
+                                           size_t nBytes);
+
+/**
+ * Outputs the next frame of the mix, if it is complete (or overdue)
+ *
+ * The frames are output in order, and without gaps; i.e. a frame that none of
+ * the nodes delivered in time is output as silence.
+ *
+ * @param[in]  hMix       saf_partialMix handle
+ * @param[out] out        Summed frame; FLAT: nChannels x frameSize
+ *                        (time-domain), or nBands x nChannels x nTimeSlots
+ *                        complex values (TF-domain)
+ * @param[out] frameIndex (&) frame index of the summed frame (may be NULL)
+ * @param[out] nMissing   (&) number of nodes that did not deliver the frame
+ *                        (may be NULL)
+ * @returns 1 if a frame was output, 0 if the next frame is not ready yet
+ */
+int saf_partialMix_pull(/* Input Arguments */
+                        void * const hMix,
+                        /* Output Arguments */
+                        float* out,
+                        long long* frameIndex,
+                        int* nMissing);
+
+/**
+ * Returns the processing delay of the nodes, in samples (i.e. of the first
+ * frame that was accepted), or -1 if no frame has been accepted yet
+ */
+int saf_partialMix_getProcessingDelay(/* Input Arguments */
+                                      void * const hMix);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_PARTIALMIX_H_INCLUDED */
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_profiler.c
+ * @brief Lightweight per-stage timing of the processing loops
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_profiler.h"
+#include <stdint.h>
+#if defined(_WIN32)
+# include <windows.h>
+# if defined(_M_X64) || defined(_M_IX86)
+#  include <intrin.h>
+#  define SAF_PROFILER_USE_TSC
+# endif
+# define PROFILER_ATOMIC_LOAD(p)    InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define PROFILER_ATOMIC_STORE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#else
+# if defined(__APPLE__)
+#  include <mach/mach_time.h>
+# elif defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define SAF_PROFILER_USE_TSC
+# endif
+# include <time.h>
+# define PROFILER_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define PROFILER_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#endif
+
+/** Statistics of one stage, in ticks (written by the processing thread only) */
+typedef struct _safProfiler_stage {
+    volatile long seq;            /**< odd while the statistics are being updated */
+    unsigned long nCalls;
+    uint64_t totalTicks, lastTicks, maxTicks;
+    uint64_t startTicks;          /**< tick count at the last saf_profiler_begin() */
+
+}safProfiler_stage;
+
+/**
+ * Data structure for the profiler.
+ *
+ * Each stage has a sequence counter, which the processing thread makes odd
+ * before it updates the statistics, and even again afterwards. A reader copies
+ * the statistics and retries if the counter was odd or has changed in the
+ * meantime, so the processing thread is never blocked.
+ */
+typedef struct _safProfiler_data {
+    safProfiler_stage stages[SAF_PROFILER_NUM_STAGES];
+    volatile long resetRequested; /**< set by saf_profiler_reset() */
+    uint64_t refTicks;            /**< tick count at creation */
+    double refTime;               /**< saf_profiler_getTime() at creation */
+
+}safProfiler_data;
+
+/** Returns the current tick count of the cheapest available clock */
+static uint64_t saf_profiler_getTicks(void)
+{
+#if defined(SAF_PROFILER_USE_TSC)
+    return (uint64_t)__rdtsc();
+#elif defined(__APPLE__)
+    return (uint64_t)mach_absolute_time();
+#elif defined(_WIN32)
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (uint64_t)t.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec*1000000000ULL + (uint64_t)t.tv_nsec;
+#endif
+}
+
+/** Returns the current (monotonic) time, in seconds */
+static double saf_profiler_getTime(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart/(double)f.QuadPart;
+#elif defined(__APPLE__)
+    mach_timebase_info_data_t tb;
+    mach_timebase_info(&tb);
+    return (double)mach_absolute_time()*(double)tb.numer/((double)tb.denom*1e9);
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+#endif
+}
+
+/**
+ * Returns the number of ticks per second; the time-stamp counter has no
+ * documented rate, so it is calibrated against the elapsed time since creation
+ */
+static double saf_profiler_getTicksPerSecond(safProfiler_data* h)
+{
+#if defined(SAF_PROFILER_USE_TSC)
+    double elapsed;
+    uint64_t ticks;
+    ticks = saf_profiler_getTicks();
+    elapsed = saf_profiler_getTime() - h->refTime;
+    return elapsed > 0.0 ? (double)(ticks - h->refTicks)/elapsed : 1.0e9;
+#elif defined(__APPLE__)
+    mach_timebase_info_data_t tb;
+    mach_timebase_info(&tb);
+    return 1.0e9*(double)tb.denom/(double)tb.numer;
+#elif defined(_WIN32)
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    return (double)f.QuadPart;
+#else
+    return 1.0e9;
+#endif
+}
+
+void saf_profiler_create
+(
+    void ** const phProf
+)
+{
+    safProfiler_data* h;
+
+    h = (safProfiler_data*)calloc1d(1, sizeof(safProfiler_data));
+    *phProf = (void*)h;
+    h->resetRequested = 0;
+    h->refTime = saf_profiler_getTime();
+    h->refTicks = saf_profiler_getTicks();
+}
+
+void saf_profiler_destroy
+(
+    void ** const phProf
+)
+{
+    safProfiler_data* h = (safProfiler_data*)(*phProf);
+
+    if(h!=NULL){
+        free(h);
+        *phProf = NULL;
+    }
+}
+
+void saf_profiler_begin
+(
+    void * const hProf,
+    SAF_PROFILER_STAGES stage
+)
+{
+    safProfiler_data* h = (safProfiler_data*)(hProf);
+    if(h==NULL)
+        return;
+    h->stages[stage].startTicks = saf_profiler_getTicks();
+}
+
+void saf_profiler_end
+(
+    void * const hProf,
+    SAF_PROFILER_STAGES stage
+)
+{
+    safProfiler_data* h = (safProfiler_data*)(hProf);
+    safProfiler_stage* s;
+    uint64_t ticks;
+    long seq;
+    int i;
+
+    if(h==NULL)
+        return;
+    ticks = saf_profiler_getTicks();
+
+    /* carry out any pending reset request */
+    if(PROFILER_ATOMIC_LOAD(&(h->resetRequested))){
+        PROFILER_ATOMIC_STORE(&(h->resetRequested), 0L);
+        for(i=0; i<SAF_PROFILER_NUM_STAGES; i++){
+            s = &(h->stages[i]);
+            seq = s->seq;
+            PROFILER_ATOMIC_STORE(&(s->seq), seq+1);
+            s->nCalls = 0;
+            s->totalTicks = s->lastTicks = s->maxTicks = 0;
+            PROFILER_ATOMIC_STORE(&(s->seq), seq+2);
+        }
+    }
+
+    /* update the statistics of this stage */
+    s = &(h->stages[stage]);
+    ticks = ticks > s->startTicks ? ticks - s->startTicks : 0;
+    seq = s->seq;
+    PROFILER_ATOMIC_STORE(&(s->seq), seq+1);
+    s->nCalls++;
+    s->totalTicks += ticks;
+    s->lastTicks = ticks;
+    s->maxTicks = ticks > s->maxTicks ? ticks : s->maxTicks;
+    PROFILER_ATOMIC_STORE(&(s->seq), seq+2);
+}
+
+void saf_profiler_getStats
+(
+    void * const hProf,
+    SAF_PROFILER_STAGES stage,
+    saf_profiler_stats* stats
+)
+{
+    safProfiler_data* h = (safProfiler_data*)(hProf);
+    safProfiler_stage* s;
+    unsigned long nCalls;
+    uint64_t totalTicks, lastTicks, maxTicks;
+    long seq0, seq1;
+    double ticksPerSecond;
+
+    memset(stats, 0, sizeof(saf_profiler_stats));
+    if(h==NULL)
+        return;
+
+    /* copy the statistics, retrying if they were updated in the meantime */
+    s = &(h->stages[stage]);
+    do {
+        seq0 = PROFILER_ATOMIC_LOAD(&(s->seq));
+        nCalls = s->nCalls;
+        totalTicks = s->totalTicks;
+        lastTicks = s->lastTicks;
+        maxTicks = s->maxTicks;
+        seq1 = PROFILER_ATOMIC_LOAD(&(s->seq));
+    } while((seq0 & 1) || seq0!=seq1);
+
+    if(nCalls==0)
+        return;
+    ticksPerSecond = saf_profiler_getTicksPerSecond(h);
+    stats->nCalls = nCalls;
+    stats->mean_s = ((double)totalTicks/(double)nCalls)/ticksPerSecond;
+    stats->last_s = (double)lastTicks/ticksPerSecond;
+    stats->max_s = (double)maxTicks/ticksPerSecond;
+}
+
+void saf_profiler_reset
+(
+    void * const hProf
+)
+{
+    safProfiler_data* h = (safProfiler_data*)(hProf);
+    if(h!=NULL)
+        PROFILER_ATOMIC_STORE(&(h->resetRequested), 1L);
+}
+
+const char* saf_profiler_getStageName(SAF_PROFILER_STAGES stage)
+{
+    switch(stage){
+        case SAF_PROFILER_STAGE_TFT_FORWARD:  return "TFT forward";
+        case SAF_PROFILER_STAGE_PARAM_UPDATE: return "parameter update";
+        case SAF_PROFILER_STAGE_PROCESSING:   return "processing";
+        case SAF_PROFILER_STAGE_TFT_INVERSE:  return "TFT inverse";
+        case SAF_PROFILER_STAGE_TOTAL:        return "total";
+        default: return "unknown";
+    }
+}
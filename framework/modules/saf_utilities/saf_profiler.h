@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_profiler.h
+ * @brief Lightweight per-stage timing of the processing loops
+ *
+ * A processor wraps each stage of its processing (e.g. the forward
+ * time-frequency transform, the parameter updates, the main processing, and
+ * the inverse transform) with SAF_PROFILER_BEGIN() and SAF_PROFILER_END(). The
+ * number of calls, and the mean/last/maximum time spent in each stage, may
+ * then be obtained from any thread with saf_profiler_getStats(); e.g. in order
+ * to find out which stage is to blame when the audio thread overruns.
+ *
+ * The stages are timed with the cheapest clock available: the time-stamp
+ * counter (rdtsc) on x86, mach_absolute_time() on Apple platforms, and
+ * clock_gettime()/QueryPerformanceCounter() otherwise.
+ *
+ * @note The two macros compile to nothing unless SAF_ENABLE_PROFILING is
+ *       defined; otherwise, the statistics simply remain zero.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_PROFILER_H_INCLUDED
+#define SAF_PROFILER_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Processing stages that may be timed */
+typedef enum _SAF_PROFILER_STAGES {
+    SAF_PROFILER_STAGE_TFT_FORWARD = 0, /**< forward time-frequency transform */
+    SAF_PROFILER_STAGE_PARAM_UPDATE,    /**< (re-)calculation of parameters */
+    SAF_PROFILER_STAGE_PROCESSING,      /**< main processing */
+    SAF_PROFILER_STAGE_TFT_INVERSE,     /**< inverse time-frequency transform */
+    SAF_PROFILER_STAGE_TOTAL,           /**< the whole frame */
+
+    SAF_PROFILER_NUM_STAGES
+
+}SAF_PROFILER_STAGES;
+
+/** Timing statistics of one stage */
+typedef struct _saf_profiler_stats {
+    unsigned long nCalls; /**< number of times the stage has been timed */
+    double mean_s;        /**< mean time spent in the stage, in seconds */
+    double last_s;        /**< time spent in the stage the last time, in seconds */
+    double max_s;         /**< maximum time spent in the stage, in seconds */
+
+}saf_profiler_stats;
+
+#ifdef SAF_ENABLE_PROFILING
+# define SAF_PROFILER_BEGIN(hProf, stage) saf_profiler_begin((hProf), (stage))
+# define SAF_PROFILER_END(hProf, stage)   saf_profiler_end((hProf), (stage))
+#else
+# define SAF_PROFILER_BEGIN(hProf, stage)
+# define SAF_PROFILER_END(hProf, stage)
+#endif
+
+/**
+ * Creates an instance of the profiler (one per processor instance)
+ *
+ * @param[in] phProf (&) address of saf_profiler handle
+ */
+void saf_profiler_create(/* Input Arguments */
+                         void ** const phProf);
+
+/**
+ * Destroys an instance of the profiler
+ *
+ * @param[in] phProf (&) address of saf_profiler handle
+ */
+void saf_profiler_destroy(/* Input Arguments */
+                          void ** const phProf);
+
+/**
+ * (Processing thread) Marks the start of a stage
+ *
+ * @param[in] hProf saf_profiler handle
+ * @param[in] stage See #SAF_PROFILER_STAGES
+ */
+void saf_profiler_begin(/* Input Arguments */
+                        void * const hProf,
+                        SAF_PROFILER_STAGES stage);
+
+/**
+ * (Processing thread) Marks the end of a stage, and updates its statistics
+ *
+ * @param[in] hProf saf_profiler handle
+ * @param[in] stage See #SAF_PROFILER_STAGES
+ */
+void saf_profiler_end(/* Input Arguments */
+                      void * const hProf,
+                      SAF_PROFILER_STAGES stage);
+
+/**
+ * (Any thread) Returns a consistent snapshot of the statistics of a stage
+ *
+ * @note This never blocks the processing thread.
+ *
+ * @param[in]  hProf saf_profiler handle
+ * @param[in]  stage See #SAF_PROFILER_STAGES
+ * @param[out] stats (&) statistics of the stage
+ */
+void saf_profiler_getStats(/* Input Arguments */
+                           void * const hProf,
+                           SAF_PROFILER_STAGES stage,
+                           /* Output Arguments */
+                           saf_profiler_stats* stats);
+
+/**
+ * (Any thread) Requests that the statistics of all stages are cleared; which
+ * is carried out by the processing thread, the next time it ends a stage
+ *
+ * @param[in] hProf saf_profiler handle
+ */
+void saf_profiler_reset(/* Input Arguments */
+                        void * const hProf);
+
+/**
+ * Returns the name of a stage (e.g. "TFT forward")
+ */
+const char* saf_profiler_getStageName(SAF_PROFILER_STAGES stage);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_PROFILER_H_INCLUDED */
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_qualityControl.c
+ * @brief Adapts the quality of the processing to the available CPU time
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_qualityControl.h"
+#if defined(_WIN32)
+# include <windows.h>
+#elif defined(__APPLE__)
+# include <mach/mach_time.h>
+#else
+# include <time.h>
+#endif
+
+#define QC_DEGRADE_FRAMES ( 2 )     /* consecutive overloaded frames before the level is raised */
+#define QC_SETTLE_FRAMES ( 4 )      /* frames after a change, during which the level is held */
+#define QC_LOAD_SMOOTHING ( 0.9f )  /* one-pole smoothing of the load (for restoring) */
+#define QC_MAX_BACKOFF ( 8 )        /* maximum multiplier of the restore time */
+
+/** Data structure for the quality controller */
+typedef struct _safQualityControl_data {
+    float budget_s;
+    int maxLevel;
+    float degradeLoad, restoreLoad;
+    int restoreFrames;           /**< frames below restoreLoad before the level is lowered */
+    saf_qualityControl_callback callback;
+    void* hUser;
+    double startTime;            /**< time at the last saf_qualityControl_frameBegin() */
+    volatile int level;
+    volatile float load;         /**< smoothed load */
+    int overCount, underCount, settleCount;
+    int backoff;                 /**< multiplier of restoreFrames (doubled if a restore did not last) */
+    int probation;               /**< frames left, during which a raise counts against the last restore */
+
+}safQualityControl_data;
+
+/** Returns the current (monotonic) time, in seconds */
+static double saf_qualityControl_getTime(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart/(double)f.QuadPart;
+#elif defined(__APPLE__)
+    mach_timebase_info_data_t tb;
+    mach_timebase_info(&tb);
+    return (double)mach_absolute_time()*(double)tb.numer/((double)tb.denom*1e9);
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+#endif
+}
+
+/** Changes the level, and informs the user */
+static void saf_qualityControl_setLevel
+(
+    safQualityControl_data* h,
+    int newLevel
+)
+{
+    h->level = newLevel;
+    h->overCount = h->underCount = 0;
+    h->settleCount = QC_SETTLE_FRAMES;
+    if(h->callback!=NULL)
+        h->callback(h->hUser, newLevel);
+}
+
+void saf_qualityControl_create
+(
+    void ** const phQC,
+    float budget_s,
+    int maxLevel
+)
+{
+    safQualityControl_data* h;
+
+    h = (safQualityControl_data*)malloc1d(sizeof(safQualityControl_data));
+    *phQC = (void*)h;
+    h->budget_s = MAX(budget_s, 1e-6f);
+    h->maxLevel = MAX(maxLevel, 0);
+    h->callback = NULL;
+    h->hUser = NULL;
+    h->startTime = 0.0;
+    h->level = 0;
+    h->load = 0.0f;
+    h->overCount = h->underCount = h->settleCount = 0;
+    h->backoff = 1;
+    h->probation = 0;
+    saf_qualityControl_setThresholds(*phQC, SAF_QUALITYCONTROL_DEFAULT_DEGRADE_LOAD, SAF_QUALITYCONTROL_DEFAULT_RESTORE_LOAD,
+                                     SAF_QUALITYCONTROL_DEFAULT_RESTORE_TIME);
+}
+
+void saf_qualityControl_destroy
+(
+    void ** const phQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(*phQC);
+
+    if(h!=NULL){
+        free(h);
+        *phQC = NULL;
+    }
+}
+
+void saf_qualityControl_setCallback
+(
+    void * const hQC,
+    saf_qualityControl_callback callback,
+    void * const hUser
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    h->callback = callback;
+    h->hUser = hUser;
+}
+
+void saf_qualityControl_setThresholds
+(
+    void * const hQC,
+    float degradeLoad,
+    float restoreLoad,
+    float restoreTime_s
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    h->degradeLoad = MAX(degradeLoad, 0.0f);
+    h->restoreLoad = CLAMP(restoreLoad, 0.0f, h->degradeLoad);
+    h->restoreFrames = MAX((int)(restoreTime_s/h->budget_s + 0.5f), 1);
+}
+
+void saf_qualityControl_frameBegin
+(
+    void * const hQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    h->startTime = saf_qualityControl_getTime();
+}
+
+void saf_qualityControl_frameEnd
+(
+    void * const hQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    saf_qualityControl_update(hQC, (float)(saf_qualityControl_getTime() - h->startTime));
+}
+
+void saf_qualityControl_update
+(
+    void * const hQC,
+    float frameTime_s
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+    float load;
+
+    load = frameTime_s/h->budget_s;
+    h->load = QC_LOAD_SMOOTHING*(h->load) + (1.0f-QC_LOAD_SMOOTHING)*load;
+    h->overCount = load > h->degradeLoad ? h->overCount+1 : 0;
+    h->underCount = h->load < h->restoreLoad ? h->underCount+1 : 0;
+    if(h->probation>0 && --(h->probation)==0)
+        h->backoff = MAX(h->backoff/2, 1); /* (the last restore lasted) */
+
+    /* hold the level for a few frames after a change, so that its effect on
+     * the load may be seen first */
+    if(h->settleCount>0){
+        h->settleCount--;
+        return;
+    }
+
+    /* overloaded: reduce the quality quickly */
+    if(h->overCount>=QC_DEGRADE_FRAMES && h->level<h->maxLevel){
+        if(h->probation>0){
+            h->backoff = MIN(2*(h->backoff), QC_MAX_BACKOFF);
+            h->probation = 0;
+        }
+        saf_qualityControl_setLevel(h, h->level+1);
+    }
+    /* plenty of headroom: restore the quality slowly */
+    else if(h->underCount>=(h->restoreFrames)*(h->backoff) && h->level>0){
+        h->probation = (h->restoreFrames)*(h->backoff);
+        saf_qualityControl_setLevel(h, h->level-1);
+    }
+}
+
+void saf_qualityControl_reset
+(
+    void * const hQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    h->backoff = 1;
+    h->probation = 0;
+    h->load = 0.0f;
+    if(h->level!=0)
+        saf_qualityControl_setLevel(h, 0);
+    h->overCount = h->underCount = 0;
+}
+
+int saf_qualityControl_getLevel
+(
+    void * const hQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    return h->level;
+}
+
+float saf_qualityControl_getLoad
+(
+    void * const hQC
+)
+{
+    safQualityControl_data* h = (safQualityControl_data*)(hQC);
+
+    return h->load;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_qualityControl.h
+ * @brief Adapts the quality of the processing to the available CPU time
+ *
+ * The controller is given the time taken to process each frame (either by
+ * wrapping the processing with saf_qualityControl_frameBegin() and
+ * saf_qualityControl_frameEnd(), or by passing a measured time to
+ * saf_qualityControl_update()), and compares it with the duration of the frame
+ * (i.e. the real-time budget). If the load exceeds the "degrade" threshold for
+ * a few consecutive frames, the quality level is raised by one (i.e. the
+ * quality is reduced); and if the smoothed load then stays below the "restore"
+ * threshold for long enough, the level is lowered again. A level that had to
+ * be raised again shortly after being lowered is held for twice as long the
+ * next time (up to 8 times), so that bursty loads do not make the quality
+ * oscillate.
+ *
+ * Whenever the level changes, the callback is invoked; typically to pass the
+ * new level to the "setQualityLevel" functions of the SAF examples, e.g.
+ * powermap_setQualityLevel(), dirass_setQualityLevel() or
+ * binauraliser_setQualityLevel(). Level 0 always refers to full quality.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_QUALITYCONTROL_H_INCLUDED
+#define SAF_QUALITYCONTROL_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Default load (processing time/frame duration) above which the level is raised */
+#define SAF_QUALITYCONTROL_DEFAULT_DEGRADE_LOAD ( 0.8f )
+/** Default (smoothed) load below which the level is lowered */
+#define SAF_QUALITYCONTROL_DEFAULT_RESTORE_LOAD ( 0.5f )
+/** Default time the load must remain below the restore load, in seconds */
+#define SAF_QUALITYCONTROL_DEFAULT_RESTORE_TIME ( 2.0f )
+
+/**
+ * Prototype of the function called whenever the quality level changes
+ *
+ * @note The callback is invoked by the thread that reports the frame times
+ *       (usually the processing thread), and should therefore not block.
+ *
+ * @param[in] hUser    User handle given to saf_qualityControl_setCallback()
+ * @param[in] newLevel New quality level (0: full quality)
+ */
+typedef void (*saf_qualityControl_callback)(void* const hUser,
+                                            int newLevel);
+
+/**
+ * Creates an instance of the quality controller
+ *
+ * @param[in] phQC     (&) address of quality controller handle
+ * @param[in] budget_s Real-time budget per frame (i.e. frameSize/fs), seconds
+ * @param[in] maxLevel Highest quality level (i.e. the lowest quality)
+ */
+void saf_qualityControl_create(/* Input Arguments */
+                               void ** const phQC,
+                               float budget_s,
+                               int maxLevel);
+
+/**
+ * Destroys an instance of the quality controller
+ *
+ * @param[in] phQC (&) address of quality controller handle
+ */
+void saf_qualityControl_destroy(/* Input Arguments */
+                                void ** const phQC);
+
+/**
+ * Sets the callback invoked whenever the quality level changes (NULL: none)
+ */
+void saf_qualityControl_setCallback(/* Input Arguments */
+                                    void * const hQC,
+                                    saf_qualityControl_callback callback,
+                                    void * const hUser);
+
+/**
+ * Sets the thresholds of the controller
+ *
+ * @param[in] hQC          Quality controller handle
+ * @param[in] degradeLoad  Load (0..1) above which the level is raised
+ * @param[in] restoreLoad  Smoothed load (0..degradeLoad) below which the level
+ *                         is lowered
+ * @param[in] restoreTime_s Time the load must remain below 'restoreLoad',
+ *                         before the level is lowered, in seconds
+ */
+void saf_qualityControl_setThresholds(/* Input Arguments */
+                                      void * const hQC,
+                                      float degradeLoad,
+                                      float restoreLoad,
+                                      float restoreTime_s);
+
+/** (Processing thread) Marks the start of processing a frame */
+void saf_qualityControl_frameBegin(/* Input Arguments */
+                                   void * const hQC);
+
+/**
+ * (Processing thread) Marks the end of processing a frame, and updates the
+ * quality level based on the time elapsed since saf_qualityControl_frameBegin()
+ */
+void saf_qualityControl_frameEnd(/* Input Arguments */
+                                 void * const hQC);
+
+/**
+ * (Processing thread) Updates the quality level based on an externally
+ * measured processing time of one frame (e.g. the last_s of the
+ * SAF_PROFILER_STAGE_TOTAL statistics of saf_profiler_getStats())
+ *
+ * @param[in] hQC          Quality controller handle
+ * @param[in] frameTime_s  Time taken to process the frame, in seconds
+ */
+void saf_qualityControl_update(/* Input Arguments */
+                               void * const hQC,
+                               float frameTime_s);
+
+/**
+ * Returns to full quality (level 0), invoking the callback if the level
+ * changes; e.g. after the host has changed the configuration
+ */
+void saf_qualityControl_reset(/* Input Arguments */
+                              void * const hQC);
+
+/** (Any thread) Returns the current quality level (0: full quality) */
+int saf_qualityControl_getLevel(/* Input Arguments */
+                                void * const hQC);
+
+/** (Any thread) Returns the smoothed load; processing time/frame duration */
+float saf_qualityControl_getLoad(/* Input Arguments */
+                                 void * const hQC);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_QUALITYCONTROL_H_INCLUDED */
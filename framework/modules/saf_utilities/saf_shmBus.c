@@ -0,0 +1,495 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_shmBus.c
+ * @brief Shared-memory ring of time-stamped multi-channel frames
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_shmBus.h"
+#if defined(_WIN32)
+# include <windows.h>
+/* (the consumers map the memory read-only, so loads must not be interlocked
+ * operations; aligned 64-bit reads are atomic on x64 and ARM64) */
+# define SHMBUS_ATOMIC_LOAD(p)    shmBus_atomicLoad((volatile LONGLONG*)(p))
+# define SHMBUS_ATOMIC_STORE(p,v) InterlockedExchange64((volatile LONGLONG*)(p), (LONGLONG)(v))
+# define SHMBUS_FENCE()           MemoryBarrier()
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define SHMBUS_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define SHMBUS_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define SHMBUS_FENCE()           __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#if defined(_WIN32)
+/** Atomic load that does not write to the memory */
+static LONGLONG shmBus_atomicLoad(volatile LONGLONG* p)
+{
+    LONGLONG v;
+    MemoryBarrier();
+    v = *p;
+    MemoryBarrier();
+    return v;
+}
+#endif
+
+/** Size of a cache line, in bytes; to which the headers and data are padded */
+#define SHMBUS_CACHE_LINE ( 64 )
+/** Written last by the producer, once the bus is ready (includes the layout version) */
+#define SHMBUS_MAGIC ( 0x53484201 )
+/** Rounds a number of bytes up to whole cache lines */
+#define SHMBUS_PAD(nBytes) ( (((nBytes)+SHMBUS_CACHE_LINE-1)/SHMBUS_CACHE_LINE)*SHMBUS_CACHE_LINE )
+
+/** Configuration of a bus; written once by the producer */
+typedef struct _shmBus_config {
+    volatile long long magic;  /**< SHMBUS_MAGIC once ready, 0 otherwise */
+    int nChannels, frameSize, nBands, nTimeSlots, nSlots;
+    long long slotBytes;       /**< size of each slot, including its header */
+
+}shmBus_config;
+
+/**
+ * Header at the start of the shared memory; the sequence number of the latest
+ * published frame (the only field written per frame) has its own cache line
+ */
+typedef struct _shmBus_header {
+    shmBus_config cfg;
+    char pad0[SHMBUS_CACHE_LINE-sizeof(shmBus_config)];
+    volatile long long latest;  /**< sequence number of the latest frame (0: none) */
+    char pad1[SHMBUS_CACHE_LINE-sizeof(long long)];
+
+}shmBus_header;
+
+/**
+ * Header of each slot, followed by its channels (FLAT: nChannels x frameSize)
+ * and by its TF frame (FLAT: nBands x nChannels x nTimeSlots), each padded to
+ * whole cache lines
+ */
+typedef struct _shmBus_slotHeader {
+    volatile long long seq;    /**< sequence number of the frame, 0 while it is written */
+    double timestamp;
+    char pad[SHMBUS_CACHE_LINE-sizeof(long long)-sizeof(double)];
+
+}shmBus_slotHeader;
+
+/** Data structure for a (local) handle of a bus */
+typedef struct _safShmBus_data {
+    int isProducer;
+    char name[SAF_SHMBUS_MAX_NAME_LENGTH+8]; /**< platform name of the shared memory */
+    size_t nBytes;
+    unsigned char* base;        /**< start of the mapped memory */
+    shmBus_header* hdr;
+#if defined(_WIN32)
+    HANDLE hMap;
+#endif
+    int nChannels, frameSize, nBands, nTimeSlots, nSlots;
+    size_t slotBytes;
+    float*** frames;            /**< channels of each slot; nSlots x nChannels */
+    float_complex**** framesTF; /**< TF frame of each slot (NULL: none); nSlots x nBands x nChannels */
+    long long seq;              /**< producer: last published frame, consumer: last frame read */
+    long long reading;          /**< consumer: frame obtained by beginRead (0: none) */
+
+}safShmBus_data;
+
+/** Returns the header of slot 'slot' */
+static shmBus_slotHeader* shmBus_getSlot(safShmBus_data* h, int slot)
+{
+    return (shmBus_slotHeader*)(h->base + SHMBUS_PAD(sizeof(shmBus_header)) + (size_t)slot*h->slotBytes);
+}
+
+/** Number of bytes of each slot (header, channels and TF frame) */
+static size_t shmBus_slotBytes(int nChannels, int frameSize, int nBands, int nTimeSlots)
+{
+    return SHMBUS_PAD(sizeof(shmBus_slotHeader)) +
+           SHMBUS_PAD((size_t)nChannels*(size_t)frameSize*sizeof(float)) +
+           SHMBUS_PAD((size_t)nBands*(size_t)nChannels*(size_t)nTimeSlots*sizeof(float_complex));
+}
+
+/**
+ * Sets up the (local) pointers into the channels and TF frames of each slot,
+ * once the memory has been mapped and the configuration is known
+ */
+static void shmBus_initPointers(safShmBus_data* h)
+{
+    int s, b, ch;
+    unsigned char* slotData;
+    float* data;
+    float_complex* dataTF;
+
+    h->frames = (float***)malloc2d(h->nSlots, MAX(h->nChannels,1), sizeof(float*));
+    h->framesTF = NULL;
+    if(h->nBands>0)
+        h->framesTF = (float_complex****)malloc3d(h->nSlots, h->nBands, MAX(h->nChannels,1), sizeof(float_complex*));
+    for(s=0; s<h->nSlots; s++){
+        slotData = (unsigned char*)shmBus_getSlot(h, s) + SHMBUS_PAD(sizeof(shmBus_slotHeader));
+        data = (float*)slotData;
+        for(ch=0; ch<h->nChannels; ch++)
+            h->frames[s][ch] = &data[ch*h->frameSize];
+        if(h->nBands>0){
+            dataTF = (float_complex*)(slotData + SHMBUS_PAD((size_t)h->nChannels*(size_t)h->frameSize*sizeof(float)));
+            for(b=0; b<h->nBands; b++)
+                for(ch=0; ch<h->nChannels; ch++)
+                    h->framesTF[s][b][ch] = &dataTF[(b*h->nChannels+ch)*h->nTimeSlots];
+        }
+    }
+}
+
+/** Unmaps the memory (and, for the producer, removes its name) */
+static void shmBus_unmap(safShmBus_data* h)
+{
+#if defined(_WIN32)
+    if(h->base!=NULL)
+        UnmapViewOfFile(h->base);
+    if(h->hMap!=NULL)
+        CloseHandle(h->hMap);
+#else
+    if(h->base!=NULL)
+        munmap(h->base, h->nBytes);
+    if(h->isProducer)
+        shm_unlink(h->name);
+#endif
+    h->base = NULL;
+    h->hdr = NULL;
+}
+
+/** Allocates a handle, and converts 'name' into the platform name */
+static safShmBus_data* shmBus_alloc(const char* name, int isProducer)
+{
+    safShmBus_data* h;
+
+    if(name==NULL || strlen(name)==0 || strlen(name)>=SAF_SHMBUS_MAX_NAME_LENGTH)
+        return NULL;
+    h = (safShmBus_data*)calloc1d(1, sizeof(safShmBus_data));
+    h->isProducer = isProducer;
+#if defined(_WIN32)
+    sprintf(h->name, "Local\\%s", name);
+#else
+    sprintf(h->name, "/%s", name);
+#endif
+    return h;
+}
+
+int saf_shmBus_create
+(
+    void ** const phBus,
+    const char* name,
+    int nChannels,
+    int frameSize,
+    int nBands,
+    int nTimeSlots,
+    int nSlots
+)
+{
+    safShmBus_data* h;
+    int s;
+#if !defined(_WIN32)
+    int fd;
+#endif
+
+    *phBus = NULL;
+    if(nChannels<1 || frameSize<1 || nBands<0 || (nBands>0 && nTimeSlots<1) || nSlots<3)
+        return 0;
+    if((h = shmBus_alloc(name, 1))==NULL)
+        return 0;
+    h->nChannels = nChannels;
+    h->frameSize = frameSize;
+    h->nBands = nBands;
+    h->nTimeSlots = nBands>0 ? nTimeSlots : 0;
+    h->nSlots = nSlots;
+    h->slotBytes = shmBus_slotBytes(nChannels, frameSize, h->nBands, h->nTimeSlots);
+    h->nBytes = SHMBUS_PAD(sizeof(shmBus_header)) + (size_t)nSlots*h->slotBytes;
+
+    /* create and map the shared memory (which starts zeroed) */
+#if defined(_WIN32)
+    h->hMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                 (DWORD)((unsigned long long)h->nBytes >> 32),
+                                 (DWORD)((unsigned long long)h->nBytes & 0xFFFFFFFF), h->name);
+    if(h->hMap!=NULL && GetLastError()==ERROR_ALREADY_EXISTS){
+        /* (cannot be replaced while it is still open elsewhere) */
+        CloseHandle(h->hMap);
+        h->hMap = NULL;
+    }
+    if(h->hMap!=NULL)
+        h->base = (unsigned char*)MapViewOfFile(h->hMap, FILE_MAP_ALL_ACCESS, 0, 0, h->nBytes);
+#else
+    shm_unlink(h->name); /* replace any previous bus */
+    fd = shm_open(h->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd>=0){
+        if(ftruncate(fd, (off_t)h->nBytes)==0){
+            h->base = (unsigned char*)mmap(NULL, h->nBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(h->base==(unsigned char*)MAP_FAILED)
+                h->base = NULL;
+        }
+        close(fd);
+    }
+#endif
+    if(h->base==NULL){
+        shmBus_unmap(h);
+        free(h);
+        return 0;
+    }
+    h->hdr = (shmBus_header*)h->base;
+
+    /* configuration, after which the bus is announced as ready */
+    h->hdr->cfg.nChannels = nChannels;
+    h->hdr->cfg.frameSize = frameSize;
+    h->hdr->cfg.nBands = h->nBands;
+    h->hdr->cfg.nTimeSlots = h->nTimeSlots;
+    h->hdr->cfg.nSlots = nSlots;
+    h->hdr->cfg.slotBytes = (long long)h->slotBytes;
+    SHMBUS_ATOMIC_STORE(&(h->hdr->latest), 0);
+    for(s=0; s<nSlots; s++)
+        SHMBUS_ATOMIC_STORE(&(shmBus_getSlot(h, s)->seq), 0);
+    shmBus_initPointers(h);
+    h->seq = 0;
+    SHMBUS_ATOMIC_STORE(&(h->hdr->cfg.magic), SHMBUS_MAGIC);
+
+    *phBus = (void*)h;
+    return 1;
+}
+
+int saf_shmBus_open
+(
+    void ** const phBus,
+    const char* name
+)
+{
+    safShmBus_data* h;
+    shmBus_config cfg;
+#if !defined(_WIN32)
+    int fd;
+    struct stat st;
+#endif
+
+    *phBus = NULL;
+    if((h = shmBus_alloc(name, 0))==NULL)
+        return 0;
+
+    /* map the whole (existing) memory, read-only */
+#if defined(_WIN32)
+    h->hMap = OpenFileMappingA(FILE_MAP_READ, FALSE, h->name);
+    if(h->hMap!=NULL)
+        h->base = (unsigned char*)MapViewOfFile(h->hMap, FILE_MAP_READ, 0, 0, 0);
+    if(h->base!=NULL){
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(h->base, &info, sizeof(info));
+        h->nBytes = (size_t)info.RegionSize;
+    }
+#else
+    fd = shm_open(h->name, O_RDONLY, 0);
+    if(fd>=0){
+        if(fstat(fd, &st)==0 && (size_t)st.st_size>=sizeof(shmBus_header)){
+            h->nBytes = (size_t)st.st_size;
+            h->base = (unsigned char*)mmap(NULL, h->nBytes, PROT_READ, MAP_SHARED, fd, 0);
+            if(h->base==(unsigned char*)MAP_FAILED)
+                h->base = NULL;
+        }
+        close(fd);
+    }
+#endif
+    if(h->base==NULL){
+        shmBus_unmap(h);
+        free(h);
+        return 0;
+    }
+    h->hdr = (shmBus_header*)h->base;
+
+    /* check that the bus is ready, and large enough for its configuration */
+    if(SHMBUS_ATOMIC_LOAD(&(h->hdr->cfg.magic))!=SHMBUS_MAGIC){
+        shmBus_unmap(h);
+        free(h);
+        return 0;
+    }
+    memcpy(&cfg, (const void*)&(h->hdr->cfg), sizeof(shmBus_config));
+    h->nChannels = cfg.nChannels;
+    h->frameSize = cfg.frameSize;
+    h->nBands = cfg.nBands;
+    h->nTimeSlots = cfg.nTimeSlots;
+    h->nSlots = cfg.nSlots;
+    h->slotBytes = shmBus_slotBytes(cfg.nChannels, cfg.frameSize, cfg.nBands, cfg.nTimeSlots);
+    if(h->nSlots<3 || (long long)h->slotBytes!=cfg.slotBytes ||
+       SHMBUS_PAD(sizeof(shmBus_header)) + (size_t)h->nSlots*h->slotBytes > h->nBytes){
+        shmBus_unmap(h);
+        free(h);
+        return 0;
+    }
+    shmBus_initPointers(h);
+    h->seq = SHMBUS_ATOMIC_LOAD(&(h->hdr->latest));
+    h->reading = 0;
+
+    *phBus = (void*)h;
+    return 1;
+}
+
+void saf_shmBus_destroy
+(
+    void ** const phBus
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(*phBus);
+
+    if(h!=NULL){
+        if(h->isProducer && h->hdr!=NULL)
+            SHMBUS_ATOMIC_STORE(&(h->hdr->cfg.magic), 0); /* tell the consumers it has gone */
+        shmBus_unmap(h);
+        free(h->frames);
+        free(h->framesTF);
+        free(h);
+        *phBus = NULL;
+    }
+}
+
+int saf_shmBus_getNumChannels
+(
+    void * const hBus
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    return h->nChannels;
+}
+
+int saf_shmBus_getFrameSize
+(
+    void * const hBus
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    return h->frameSize;
+}
+
+void saf_shmBus_getTFdims
+(
+    void * const hBus,
+    int* nBands,
+    int* nTimeSlots
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    (*nBands) = h->nBands;
+    (*nTimeSlots) = h->nTimeSlots;
+}
+
+float** saf_shmBus_beginWrite
+(
+    void * const hBus,
+    float_complex**** frameTF
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    int slot;
+
+    assert(h->isProducer);
+    slot = (int)((h->seq+1) % (long long)h->nSlots);
+
+    /* mark the slot as being written, before any of its data is touched */
+    SHMBUS_ATOMIC_STORE(&(shmBus_getSlot(h, slot)->seq), 0);
+    SHMBUS_FENCE();
+    if(frameTF!=NULL)
+        (*frameTF) = h->framesTF==NULL ? NULL : h->framesTF[slot];
+    return h->frames[slot];
+}
+
+void saf_shmBus_endWrite
+(
+    void * const hBus,
+    double timestamp
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    shmBus_slotHeader* slotHdr;
+    long long next;
+
+    assert(h->isProducer);
+    next = h->seq+1;
+    slotHdr = shmBus_getSlot(h, (int)(next % (long long)h->nSlots));
+    slotHdr->timestamp = timestamp;
+    SHMBUS_FENCE();
+    SHMBUS_ATOMIC_STORE(&(slotHdr->seq), next);
+    SHMBUS_ATOMIC_STORE(&(h->hdr->latest), next);
+    h->seq = next;
+}
+
+int saf_shmBus_beginRead
+(
+    void * const hBus,
+    float*** frame,
+    float_complex**** frameTF,
+    double* timestamp,
+    int* nSkipped
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    long long latest, next;
+    int slot, attempt;
+    shmBus_slotHeader* slotHdr;
+
+    assert(!h->isProducer);
+    h->reading = 0;
+    if(nSkipped!=NULL)
+        (*nSkipped) = 0;
+    if(SHMBUS_ATOMIC_LOAD(&(h->hdr->cfg.magic))!=SHMBUS_MAGIC)
+        return 0; /* the producer has closed the bus */
+
+    for(attempt=0; attempt<2; attempt++){
+        latest = SHMBUS_ATOMIC_LOAD(&(h->hdr->latest));
+        if(latest<=h->seq)
+            return 0; /* nothing new */
+
+        /* skip ahead if the next frame may already be overwritten */
+        next = h->seq+1;
+        if(latest-next > (long long)(h->nSlots-2) || attempt>0)
+            next = latest;
+        slot = (int)(next % (long long)h->nSlots);
+        slotHdr = shmBus_getSlot(h, slot);
+        if(SHMBUS_ATOMIC_LOAD(&(slotHdr->seq))!=next)
+            continue; /* overtaken in the meantime */
+        SHMBUS_FENCE();
+
+        if(nSkipped!=NULL)
+            (*nSkipped) = (int)(next-h->seq-1);
+        h->seq = next;
+        h->reading = next;
+        (*frame) = h->frames[slot];
+        if(frameTF!=NULL)
+            (*frameTF) = h->framesTF==NULL ? NULL : h->framesTF[slot];
+        if(timestamp!=NULL)
+            (*timestamp) = slotHdr->timestamp;
+        return 1;
+    }
+    return 0;
+}
+
+int saf_shmBus_endRead
+(
+    void * const hBus
+)
+{
+    safShmBus_data* h = (safShmBus_data*)(hBus);
+    shmBus_slotHeader* slotHdr;
+
+    if(h->reading<=0)
+        return 0;
+    SHMBUS_FENCE();
+    slotHdr = shmBus_getSlot(h, (int)(h->reading % (long long)h->nSlots));
+    return SHMBUS_ATOMIC_LOAD(&(slotHdr->seq))==h->reading ? 1 : 0;
+}
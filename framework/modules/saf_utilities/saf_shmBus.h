@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_shmBus.h
+ * @brief Shared-memory ring of time-stamped multi-channel frames, for passing
+ *        e.g. SH signals from a renderer to analysers running in other
+ *        processes, without copying or serialising them
+ *
+ * One process (the producer) creates the bus under a name, and writes its
+ * frames directly into the shared memory: saf_shmBus_beginWrite() returns the
+ * planar channels of the next slot (and optionally its time-frequency frame),
+ * which are then published with saf_shmBus_endWrite(). Any number of other
+ * processes (the consumers) open the bus by its name (read-only), and obtain
+ * the published frames with saf_shmBus_beginRead(), as float** planar frames
+ * pointing into the shared memory; which may be passed straight to e.g.
+ * powermap_analysis() or sldoa_analysis().
+ *
+ * The producer never waits for the consumers. Each consumer keeps track of
+ * the last frame it has read; if it falls more than (nSlots-2) frames behind,
+ * it skips ahead to the latest frame (and the skipped frames are reported).
+ * Since a frame is read in place, saf_shmBus_endRead() reports whether the
+ * producer has started to overwrite it in the meantime (in which case it
+ * should be discarded); which may be avoided by keeping enough slots in the
+ * ring for the slowest consumer.
+ *
+ * The headers of the bus and of each slot are padded to cache lines, such that
+ * the producer's and consumers' accesses do not share cache lines with the
+ * data. The time-frequency frames are stored as FLAT: nBands x nChannels x
+ * nTimeSlots, and are returned as float_complex*** pointing into the shared
+ * memory, the same as the TF frames used throughout SAF.
+ *
+ * @note POSIX shared memory (shm_open) is used on Linux/macOS, which may
+ *       require linking with -lrt on older Linux distributions; and named file
+ *       mappings are used on Windows. The producer and the consumers must be
+ *       built for the same architecture.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_SHMBUS_H_INCLUDED
+#define SAF_SHMBUS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "saf_complex.h"
+
+/** Maximum length of the name of a bus (including the terminating zero) */
+#define SAF_SHMBUS_MAX_NAME_LENGTH ( 64 )
+
+/**
+ * (Producer) Creates a bus, with the given name, in shared memory
+ *
+ * Any existing bus with the same name is replaced; consumers that still have
+ * it open must open the bus again.
+ *
+ * @param[in] phBus      (&) address of saf_shmBus handle (NULL on failure)
+ * @param[in] name       Name of the bus; e.g. "saf_sh_bus" (characters
+ *                       0-9, a-z, A-Z, and '_' are portable)
+ * @param[in] nChannels  Number of channels
+ * @param[in] frameSize  Number of samples per frame
+ * @param[in] nBands     Number of bands of the TF frames (0: none)
+ * @param[in] nTimeSlots Number of time slots of the TF frames
+ * @param[in] nSlots     Number of frames in the ring (at least 3)
+ * @returns 1 if the bus was created, 0 otherwise
+ */
+int saf_shmBus_create(/* Input Arguments */
+                      void ** const phBus,
+                      const char* name,
+                      int nChannels,
+                      int frameSize,
+                      int nBands,
+                      int nTimeSlots,
+                      int nSlots);
+
+/**
+ * (Consumer) Opens a bus that has been created by another (or the same)
+ * process, for reading
+ *
+ * @note The consumer starts from the latest frame published before it opened
+ *       the bus (i.e. the first saf_shmBus_beginRead() returns the next one).
+ *
+ * @param[in] phBus (&) address of saf_shmBus handle (NULL on failure)
+ * @param[in] name  Name of the bus
+ * @returns 1 if the bus was opened, 0 if it does not exist (yet)
+ */
+int saf_shmBus_open(/* Input Arguments */
+                    void ** const phBus,
+                    const char* name);
+
+/**
+ * Closes a bus; the producer also removes its name (the memory is freed once
+ * all consumers have closed it as well)
+ *
+ * @param[in] phBus (&) address of saf_shmBus handle
+ */
+void saf_shmBus_destroy(/* Input Arguments */
+                        void ** const phBus);
+
+/** Returns the number of channels of the bus */
+int saf_shmBus_getNumChannels(/* Input Arguments */
+                              void * const hBus);
+
+/** Returns the number of samples per frame of the bus */
+int saf_shmBus_getFrameSize(/* Input Arguments */
+                            void * const hBus);
+
+/**
+ * Returns the dimensions of the TF frames of the bus (0 bands: none)
+ *
+ * @param[in]  hBus       saf_shmBus handle
+ * @param[out] nBands     (&) number of bands
+ * @param[out] nTimeSlots (&) number of time slots
+ */
+void saf_shmBus_getTFdims(/* Input Arguments */
+                          void * const hBus,
+                          /* Output Arguments */
+                          int* nBands,
+                          int* nTimeSlots);
+
+/**
+ * (Producer) Returns the next slot to write a frame into
+ *
+ * @param[in]  hBus    saf_shmBus handle (created with saf_shmBus_create())
+ * @param[out] frameTF (&) TF frame of the slot (set to NULL if you don't need
+ *                     it; NULL is returned if the bus has no TF frames);
+ *                     nBands x nChannels x nTimeSlots
+ * @returns    Channels of the slot; nChannels x frameSize
+ */
+float** saf_shmBus_beginWrite(/* Input Arguments */
+                              void * const hBus,
+                              /* Output Arguments */
+                              float_complex**** frameTF);
+
+/**
+ * (Producer) Publishes the frame written into the slot returned by
+ * saf_shmBus_beginWrite()
+ *
+ * @param[in] hBus      saf_shmBus handle
+ * @param[in] timestamp Timestamp of the frame (e.g. in seconds of audio)
+ */
+void saf_shmBus_endWrite(/* Input Arguments */
+                         void * const hBus,
+                         double timestamp);
+
+/**
+ * (Consumer) Obtains the next published frame, which is read in place
+ *
+ * @param[in]  hBus      saf_shmBus handle (opened with saf_shmBus_open())
+ * @param[out] frame     (&) channels of the frame; nChannels x frameSize
+ * @param[out] frameTF   (&) TF frame (may be NULL); nBands x nChannels x
+ *                       nTimeSlots
+ * @param[out] timestamp (&) timestamp of the frame (may be NULL)
+ * @param[out] nSkipped  (&) number of frames that were skipped, since the
+ *                       consumer fell too far behind (may be NULL)
+ * @returns    1 if a frame was obtained, 0 if no new frames have been
+ *             published
+ */
+int saf_shmBus_beginRead(/* Input Arguments */
+                         void * const hBus,
+                         /* Output Arguments */
+                         float*** frame,
+                         float_complex**** frameTF,
+                         double* timestamp,
+                         int* nSkipped);
+
+/**
+ * (Consumer) Finishes reading the frame obtained with saf_shmBus_beginRead()
+ *
+ * @param[in] hBus saf_shmBus handle
+ * @returns   1 if the frame was intact while it was read, 0 if the producer has
+ *            started to overwrite it (and whatever was read should be
+ *            discarded)
+ */
+int saf_shmBus_endRead(/* Input Arguments */
+                       void * const hBus);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_SHMBUS_H_INCLUDED */
@@ -48,6 +48,208 @@ typedef struct saf_sort_double {
     int idx;
 }saf_sort_double;
 
+/**
+ * Maximum number of grid points in a leaf of the findClosestGridPoints index
+ * (leaves are searched by brute-force)
+ */
+#define FIND_CLOSEST_LEAF_SIZE ( 8 )
+
+/**
+ * The brute-force search is used by findClosestGridPoints() when
+ * nGrid x nTarget is below this value (building the index is not worth it)
+ */
+#define FIND_CLOSEST_INDEX_THRESH ( 4096 )
+
+/**
+ * Data structure for the findClosestGridPoints index
+ *
+ * The k-d tree is stored implicitly: the node spanning the grid points
+ * [lo, hi) in 'xyz' is split at position m = (lo+hi)/2 along axis 'axis[m]',
+ * with the points in [lo, m) lying below and [m+1, hi) lying above the split.
+ * Ranges of no more than FIND_CLOSEST_LEAF_SIZE points are leaves.
+ */
+typedef struct _findClosestIndex_data {
+    int nGrid;
+    float* grid_dirs; /**< copy of the grid directions; nGrid x 2 */
+    float* xyz;       /**< unit vectors of the grid, in tree order; nGrid x 3 */
+    int* idx;         /**< original grid index of each tree point; nGrid x 1 */
+    int* axis;        /**< split axis of each node (at its median); nGrid x 1 */
+
+}findClosestIndex_data;
+
+/** Number of directions converted at a time by sph2unitCart() */
+#define SPH2UNITCART_BLOCK_SIZE ( 64 )
+
+/**
+ * Helper function for converting [azi elev] pairs into unit Cartesian vectors
+ * (the directions are converted in blocks, with the vectorised sin/cos of
+ * saf_veclib, as in unitSph2CartBatch())
+ */
+static void sph2unitCart(float* dirs, int nDirs, int degFLAG, float* xyz)
+{
+    int i, j, blockSize;
+    float scale;
+    float azi[SPH2UNITCART_BLOCK_SIZE], elev[SPH2UNITCART_BLOCK_SIZE];
+    float sinAzi[SPH2UNITCART_BLOCK_SIZE], cosAzi[SPH2UNITCART_BLOCK_SIZE];
+    float sinElev[SPH2UNITCART_BLOCK_SIZE], cosElev[SPH2UNITCART_BLOCK_SIZE];
+
+    scale = degFLAG ? M_PI/180.0f : 1.0f;
+    for(i=0; i<nDirs; i+=SPH2UNITCART_BLOCK_SIZE){
+        blockSize = MIN(SPH2UNITCART_BLOCK_SIZE, nDirs-i);
+        for(j=0; j<blockSize; j++){
+            azi[j] = dirs[(i+j)*2]*scale;
+            elev[j] = dirs[(i+j)*2+1]*scale;
+        }
+        utility_svsincosapprox(azi, blockSize, sinAzi, cosAzi);
+        utility_svsincosapprox(elev, blockSize, sinElev, cosElev);
+        for(j=0; j<blockSize; j++){
+            xyz[(i+j)*3]   = cosElev[j] * cosAzi[j];
+            xyz[(i+j)*3+1] = cosElev[j] * sinAzi[j];
+            xyz[(i+j)*3+2] = sinElev[j];
+        }
+    }
+}
+
+/**
+ * Helper function for swapping two points of the findClosestGridPoints index
+ */
+static void findClosestIndex_swap(findClosestIndex_data* h, int a, int b)
+{
+    int k, itmp;
+    float ftmp;
+
+    for(k=0; k<3; k++){
+        ftmp = h->xyz[a*3+k];
+        h->xyz[a*3+k] = h->xyz[b*3+k];
+        h->xyz[b*3+k] = ftmp;
+    }
+    itmp = h->idx[a];
+    h->idx[a] = h->idx[b];
+    h->idx[b] = itmp;
+}
+
+/**
+ * Recursively builds the findClosestGridPoints index over the points [lo, hi),
+ * splitting each node at its median along the axis of largest extent
+ */
+static void findClosestIndex_build(findClosestIndex_data* h, int lo, int hi)
+{
+    int i, k, a, m, left, right, store;
+    float minv[3], maxv[3], pivot;
+
+    if(hi-lo <= FIND_CLOSEST_LEAF_SIZE)
+        return;
+
+    /* axis of largest extent */
+    for(k=0; k<3; k++)
+        minv[k] = maxv[k] = h->xyz[lo*3+k];
+    for(i=lo+1; i<hi; i++){
+        for(k=0; k<3; k++){
+            minv[k] = MIN(minv[k], h->xyz[i*3+k]);
+            maxv[k] = MAX(maxv[k], h->xyz[i*3+k]);
+        }
+    }
+    a = 0;
+    for(k=1; k<3; k++)
+        if(maxv[k]-minv[k] > maxv[a]-minv[a])
+            a = k;
+
+    /* quickselect, such that the median lies at m */
+    m = (lo+hi)/2;
+    left = lo;
+    right = hi-1;
+    while(right > left){
+        findClosestIndex_swap(h, (left+right)/2, right);
+        pivot = h->xyz[right*3+a];
+        store = left;
+        for(i=left; i<right; i++){
+            if(h->xyz[i*3+a] < pivot){
+                findClosestIndex_swap(h, i, store);
+                store++;
+            }
+        }
+        findClosestIndex_swap(h, store, right);
+        if(store == m)
+            break;
+        else if(store < m)
+            left = store+1;
+        else
+            right = store-1;
+    }
+    h->axis[m] = a;
+
+    findClosestIndex_build(h, lo, m);
+    findClosestIndex_build(h, m+1, hi);
+}
+
+/**
+ * Helper function for testing one grid point of the findClosestGridPoints index
+ * (ties are resolved in favour of the lowest grid index, as in the brute-force
+ * search)
+ */
+static void findClosestIndex_test
+(
+    findClosestIndex_data* h,
+    int i,
+    float* t,
+    float* best_val,
+    int* best_idx
+)
+{
+    float current_val;
+
+    current_val = h->xyz[i*3]   * t[0] +
+                  h->xyz[i*3+1] * t[1] +
+                  h->xyz[i*3+2] * t[2];
+    if(current_val > *best_val || (current_val == *best_val && h->idx[i] < *best_idx)){
+        *best_val = current_val;
+        *best_idx = h->idx[i];
+    }
+}
+
+/**
+ * Recursively searches the findClosestGridPoints index over the points [lo, hi)
+ * for the point with the largest dot product with unit vector 't'
+ */
+static void findClosestIndex_search
+(
+    findClosestIndex_data* h,
+    int lo,
+    int hi,
+    float* t,
+    float* best_val,
+    int* best_idx
+)
+{
+    int i, m, a;
+    float diff;
+
+    if(hi-lo <= FIND_CLOSEST_LEAF_SIZE){
+        for(i=lo; i<hi; i++)
+            findClosestIndex_test(h, i, t, best_val, best_idx);
+        return;
+    }
+    m = (lo+hi)/2;
+    a = h->axis[m];
+    diff = t[a] - h->xyz[m*3+a];
+    findClosestIndex_test(h, m, t, best_val, best_idx);
+
+    /* descend into the side containing the target first. The other side
+     * is only visited if the splitting plane is closer than the current best
+     * point; the squared chord length between unit vectors being 2-2*dot. A
+     * small tolerance ensures that equally close points are not pruned. */
+    if(diff < 0.0f){
+        findClosestIndex_search(h, lo, m, t, best_val, best_idx);
+        if(diff*diff <= 2.0f - 2.0f*(*best_val) + 1e-5f)
+            findClosestIndex_search(h, m+1, hi, t, best_val, best_idx);
+    }
+    else{
+        findClosestIndex_search(h, m+1, hi, t, best_val, best_idx);
+        if(diff*diff <= 2.0f - 2.0f*(*best_val) + 1e-5f)
+            findClosestIndex_search(h, lo, m, t, best_val, best_idx);
+    }
+}
+
 /**
  * Helper function for sorting a vector of integers using 'qsort' in ascending
  * order
@@ -184,6 +386,86 @@ void sortf
     free(data);
 }
 
+/**
+ * Helper function for partialSortf(); returns 1 if 'a' should come before 'b'
+ * (ties are broken by the lower index)
+ */
+static int partialSort_precedes(saf_sort_float* a, saf_sort_float* b, int descendFLAG)
+{
+    if(a->val!=b->val)
+        return descendFLAG ? a->val>b->val : a->val<b->val;
+    return a->idx<b->idx;
+}
+
+/**
+ * Helper function for partialSortf(); restores the heap property below node
+ * 'i', where the root holds the element that comes last
+ */
+static void partialSort_siftDown(saf_sort_float* heap, int n, int i, int descendFLAG)
+{
+    int c;
+    saf_sort_float tmp;
+
+    for(c=2*i+1; c<n; i=c, c=2*i+1){
+        if(c+1<n && partialSort_precedes(&heap[c], &heap[c+1], descendFLAG))
+            c++;
+        if(!partialSort_precedes(&heap[i], &heap[c], descendFLAG))
+            break;
+        tmp = heap[i]; heap[i] = heap[c]; heap[c] = tmp;
+    }
+}
+
+void partialSortf
+(
+    float* in_vec,
+    float* out_vec,
+    int* new_idices,
+    int len,
+    int K,
+    int descendFLAG
+)
+{
+    int i, n;
+    saf_sort_float *heap, tmp;
+
+    K = MIN(K, len);
+    if(K<=0)
+        return;
+
+    /* keep the K first elements in a heap, with the one that comes last at its
+     * root; so each further element costs O(log K) at most */
+    heap = malloc1d(K*sizeof(saf_sort_float));
+    for(i=0; i<K; i++){
+        heap[i].val = in_vec[i];
+        heap[i].idx = i;
+    }
+    for(i=K/2-1; i>=0; i--)
+        partialSort_siftDown(heap, K, i, descendFLAG);
+    for(i=K; i<len; i++){
+        tmp.val = in_vec[i];
+        tmp.idx = i;
+        if(partialSort_precedes(&tmp, &heap[0], descendFLAG)){
+            heap[0] = tmp;
+            partialSort_siftDown(heap, K, 0, descendFLAG);
+        }
+    }
+
+    /* heap-sort the K elements */
+    for(n=K-1; n>0; n--){
+        tmp = heap[0]; heap[0] = heap[n]; heap[n] = tmp;
+        partialSort_siftDown(heap, n, 0, descendFLAG);
+    }
+    for(i=0; i<K; i++){
+        if (out_vec!=NULL)
+            out_vec[i] = heap[i].val;
+        else
+            in_vec[i] = heap[i].val; /* overwrite input vector */
+        if(new_idices!=NULL)
+            new_idices[i] = heap[i].idx;
+    }
+    free(heap);
+}
+
 void sortd
 (
     double* in_vec,
@@ -230,39 +512,22 @@ void findClosestGridPoints
 {
     int i, j;
     float* grid_xyz, *target_xyz;
-    float rcoselev, max_val, current_val;
+    float max_val, current_val;
+    void* hIdx;
+
+    /* for larger problems, it is faster to build the search index first */
+    if(nGrid*nTarget >= FIND_CLOSEST_INDEX_THRESH && nGrid > FIND_CLOSEST_LEAF_SIZE){
+        findClosestGridPoints_createIndex(&hIdx, grid_dirs, nGrid, degFLAG);
+        findClosestGridPoints_query(hIdx, target_dirs, nTarget, degFLAG, idx_closest, dirs_closest, angle_diff);
+        findClosestGridPoints_destroyIndex(&hIdx);
+        return;
+    }
     
     /* convert sph coords into Cartesian coords */
     grid_xyz = malloc1d(nGrid*3*sizeof(float));
     target_xyz = malloc1d(nTarget*3*sizeof(float));
-    if(degFLAG){
-        for(i=0; i<nGrid; i++){
-            grid_xyz[i*3+2] = sinf(grid_dirs[i*2+1]*M_PI/180.0f);
-            rcoselev = cosf( grid_dirs[i*2+1]*M_PI/180.0f);
-            grid_xyz[i*3] = rcoselev * cosf(grid_dirs[i*2]*M_PI/180.0f);
-            grid_xyz[i*3+1] = rcoselev * sinf(grid_dirs[i*2]*M_PI/180.0f);
-        }
-        for(i=0; i<nTarget; i++){
-            target_xyz[i*3+2] = sinf(target_dirs[i*2+1]*M_PI/180.0f);
-            rcoselev = cosf(target_dirs[i*2+1]*M_PI/180.0f);
-            target_xyz[i*3] = rcoselev * cosf(target_dirs[i*2]*M_PI/180.0f);
-            target_xyz[i*3+1] = rcoselev * sinf(target_dirs[i*2]*M_PI/180.0f);
-        }
-    }
-    else{
-        for(i=0; i<nGrid; i++){
-            grid_xyz[i*3+2] = sinf(grid_dirs[i*2+1]);
-            rcoselev = cosf(grid_dirs[i*2+1]);
-            grid_xyz[i*3] = rcoselev * cosf(grid_dirs[i*2]);
-            grid_xyz[i*3+1] = rcoselev * sinf(grid_dirs[i*2]);
-        }
-        for(i=0; i<nTarget; i++){
-            target_xyz[i*3+2] = sinf(target_dirs[i*2+1]);
-            rcoselev = cosf(target_dirs[i*2+1]);
-            target_xyz[i*3] = rcoselev * cosf(target_dirs[i*2]);
-            target_xyz[i*3+1] = rcoselev * sinf(target_dirs[i*2]);
-        }
-    }
+    sph2unitCart(grid_dirs, nGrid, degFLAG, grid_xyz);
+    sph2unitCart(target_dirs, nTarget, degFLAG, target_xyz);
     
     /* determine which 'grid_dirs' indices are the closest to 'target_dirs' */
     for(i=0; i<nTarget; i++){
@@ -271,8 +536,6 @@ void findClosestGridPoints
             current_val = grid_xyz[j*3] * target_xyz[i*3] +
                           grid_xyz[j*3+1] * target_xyz[i*3+1] +
                           grid_xyz[j*3+2] * target_xyz[i*3+2];
-            if(current_val > max_val)
-                idx_closest[i] = j;
             if(current_val>max_val){
                 idx_closest[i] = j;
                 max_val = current_val;
@@ -294,6 +557,79 @@ void findClosestGridPoints
     free(target_xyz);
 }
 
+void findClosestGridPoints_createIndex
+(
+    void** const phIdx,
+    float* grid_dirs,
+    int nGrid,
+    int degFLAG
+)
+{
+    int i;
+    findClosestIndex_data* h;
+
+    *phIdx = malloc1d(sizeof(findClosestIndex_data));
+    h = (findClosestIndex_data*)(*phIdx);
+    h->nGrid = nGrid;
+    h->grid_dirs = malloc1d(nGrid*2*sizeof(float));
+    memcpy(h->grid_dirs, grid_dirs, nGrid*2*sizeof(float));
+    h->xyz = malloc1d(nGrid*3*sizeof(float));
+    h->idx = malloc1d(nGrid*sizeof(int));
+    h->axis = calloc1d(nGrid, sizeof(int));
+    sph2unitCart(grid_dirs, nGrid, degFLAG, h->xyz);
+    for(i=0; i<nGrid; i++)
+        h->idx[i] = i;
+    findClosestIndex_build(h, 0, nGrid);
+}
+
+void findClosestGridPoints_destroyIndex
+(
+    void** const phIdx
+)
+{
+    findClosestIndex_data* h = (findClosestIndex_data*)(*phIdx);
+
+    if(h!=NULL){
+        free(h->grid_dirs);
+        free(h->xyz);
+        free(h->idx);
+        free(h->axis);
+        free(h);
+        *phIdx = NULL;
+    }
+}
+
+void findClosestGridPoints_query
+(
+    void* const hIdx,
+    float* target_dirs,
+    int nTarget,
+    int degFLAG,
+    int* idx_closest,
+    float* dirs_closest,
+    float* angle_diff
+)
+{
+    findClosestIndex_data* h = (findClosestIndex_data*)(hIdx);
+    int i, best_idx;
+    float best_val, t[3];
+
+    for(i=0; i<nTarget; i++){
+        sph2unitCart(&target_dirs[i*2], 1, degFLAG, t);
+        best_val = -2.23e10f;
+        best_idx = 0;
+        findClosestIndex_search(h, 0, h->nGrid, t, &best_val, &best_idx);
+        if(idx_closest!=NULL)
+            idx_closest[i] = best_idx;
+        if(dirs_closest!=NULL){
+            dirs_closest[i*2] = h->grid_dirs[best_idx*2];
+            dirs_closest[i*2+1] = h->grid_dirs[best_idx*2+1];
+        }
+        if(angle_diff!=NULL)
+            angle_diff[i] = acosf(best_val);
+    }
+}
+
 
 
 
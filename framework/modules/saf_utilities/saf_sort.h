@@ -75,6 +75,32 @@ void sortf(float* in_vec,
            int len,
            int descendFLAG);
 
+/**
+ * Returns the K smallest/largest floating-point values of a vector, in
+ * ascending/decending order (optionally returning their indices as well)
+ *
+ * The result is the same as the first K elements of sortf(), except that ties
+ * are always broken by the lower index; but only the K elements are kept
+ * sorted (in a heap), which costs O(len log K), rather than the O(len log len)
+ * of sorting the whole vector.
+ *
+ * @param [in,out] in_vec      Vector to be searched; len x 1
+ * @param [out]    out_vec     Output vector; K x 1. If NULL, then the first K
+ *                             elements of 'in_vec' are overwritten
+ * @param [out]    new_idices  Indices of the K elements in 'in_vec' (set to
+ *                             NULL if you don't want them); K x 1
+ * @param [in]     len         Number of elements in 'in_vec'
+ * @param [in]     K           Number of elements to return (limited to len)
+ * @param [in]     descendFLAG '0' ascending (K smallest), '1' descending (K
+ *                             largest)
+ */
+void partialSortf(float* in_vec,
+                  float* out_vec,
+                  int* new_idices,
+                  int len,
+                  int K,
+                  int descendFLAG);
+
 /**
  * Sort a vector of double floating-point values into ascending/decending order
  * (optionally returning the new indices as well).
@@ -123,6 +149,59 @@ void findClosestGridPoints(float* grid_dirs,
                            float* dirs_closest,
                            float* angle_diff);
 
+/**
+ * Creates a nearest-neighbour search index for a spherical grid (a k-d tree
+ * built over the unit Cartesian vectors of the grid directions)
+ *
+ * The index should be created once per grid, after which each query costs
+ * roughly O(log nGrid), rather than the O(nGrid) of a brute-force scan
+ *
+ * @param [in] phIdx     (&) address of the index handle
+ * @param [in] grid_dirs Spherical coordinates of grid directions;
+ *                       FLAT: nGrid x 2
+ * @param [in] nGrid     Number of directions in grid
+ * @param [in] degFLAG   '0' coordinates are in RADIANS, '1' coords are in
+ *                       DEGREES
+ */
+void findClosestGridPoints_createIndex(void** const phIdx,
+                                       float* grid_dirs,
+                                       int nGrid,
+                                       int degFLAG);
+
+/**
+ * Destroys a nearest-neighbour search index
+ *
+ * @param [in] phIdx (&) address of the index handle
+ */
+void findClosestGridPoints_destroyIndex(void** const phIdx);
+
+/**
+ * Same as findClosestGridPoints(), but using a pre-computed search index
+ *
+ * The results are identical to those of the brute-force search (including the
+ * lowest index being returned if two grid points are equally close)
+ *
+ * @param [in]  hIdx         Index handle
+ * @param [in]  target_dirs  Spherical coordinates of target directions;
+ *                           FLAT: nTarget x 2
+ * @param [in]  nTarget      Number of target directions to find
+ * @param [in]  degFLAG      '0' coordinates are in RADIANS, '1' coords are in
+ *                           DEGREES
+ * @param [out] idx_closest  Resulting indices (set to NULL to ignore);
+ *                           nTarget x 1
+ * @param [out] dirs_closest grid_dirs(idx_closest); (set to NULL to ignore);
+ *                           nTarget x 1
+ * @param [out] angle_diff   Angle diff between target and grid dir, in radians
+ *                           (set to NULL to ignore); nTarget x 1
+ */
+void findClosestGridPoints_query(void* const hIdx,
+                                 float* target_dirs,
+                                 int nTarget,
+                                 int degFLAG,
+                                 int* idx_closest,
+                                 float* dirs_closest,
+                                 float* angle_diff);
+
 
 #ifdef __cplusplus
 }/* extern "C" */
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_telemetry.c
+ * @brief Always-on health metrics of a processor instance, for monitoring
+ *        the instances running in production
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_telemetry.h"
+#if defined(_WIN32)
+# include <windows.h>
+# define TELEMETRY_ATOMIC_LOAD(p)    InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define TELEMETRY_ATOMIC_STORE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#else
+# if defined(__APPLE__)
+#  include <mach/mach_time.h>
+# endif
+# include <time.h>
+# define TELEMETRY_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define TELEMETRY_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#endif
+
+/** Frame metrics (written by the audio thread only) */
+typedef struct _safTelemetry_frames {
+    volatile long seq;            /**< odd while the metrics are being updated */
+    unsigned long long nProcessed;
+    unsigned long long nDropped[SAF_TELEMETRY_NUM_DROP_REASONS];
+    double totalTime, lastTime, maxTime;
+    unsigned long long histogram[SAF_TELEMETRY_NUM_HIST_BINS];
+
+}safTelemetry_frames;
+
+/** Re-initialisation metrics (written by the initialisation thread only) */
+typedef struct _safTelemetry_reinits {
+    volatile long seq;            /**< odd while the metrics are being updated */
+    unsigned long long nReinits;
+    double totalTime, lastTime;
+    int ongoing;
+
+}safTelemetry_reinits;
+
+/** Data structure for the telemetry */
+typedef struct _safTelemetry_data {
+    safTelemetry_frames frames;
+    safTelemetry_reinits reinits;
+    double frameStartTime;        /**< time at the last saf_telemetry_frameBegin() */
+    double reinitStartTime;       /**< time at the last saf_telemetry_reinitBegin() */
+    volatile long resetFramesRequested;  /**< set by saf_telemetry_reset() */
+    volatile long resetReinitsRequested; /**< set by saf_telemetry_reset() */
+
+}safTelemetry_data;
+
+/** Returns the current (monotonic) time, in seconds */
+static double saf_telemetry_getTime(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart/(double)f.QuadPart;
+#elif defined(__APPLE__)
+    mach_timebase_info_data_t tb;
+    mach_timebase_info(&tb);
+    return (double)mach_absolute_time()*(double)tb.numer/((double)tb.denom*1e9);
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+#endif
+}
+
+/** Returns the bin of the frame time histogram for a given time */
+static int saf_telemetry_getHistogramBin(double time_s)
+{
+    unsigned long long us;
+    int bin;
+
+    us = time_s > 0.0 ? (unsigned long long)(time_s*1e6) : 0;
+    for(bin=0; us>1 && bin<SAF_TELEMETRY_NUM_HIST_BINS-1; bin++)
+        us >>= 1;
+    return bin;
+}
+
+/** (Audio thread) Begins an update of the frame metrics */
+static void saf_telemetry_beginFramesUpdate(safTelemetry_data* h)
+{
+    safTelemetry_frames* f = &(h->frames);
+    long seq;
+
+    seq = f->seq;
+    TELEMETRY_ATOMIC_STORE(&(f->seq), seq+1);
+    if(TELEMETRY_ATOMIC_LOAD(&(h->resetFramesRequested))){
+        TELEMETRY_ATOMIC_STORE(&(h->resetFramesRequested), 0L);
+        f->nProcessed = 0;
+        memset(f->nDropped, 0, SAF_TELEMETRY_NUM_DROP_REASONS*sizeof(unsigned long long));
+        f->totalTime = f->lastTime = f->maxTime = 0.0;
+        memset(f->histogram, 0, SAF_TELEMETRY_NUM_HIST_BINS*sizeof(unsigned long long));
+    }
+}
+
+/** (Audio thread) Ends an update of the frame metrics */
+static void saf_telemetry_endFramesUpdate(safTelemetry_data* h)
+{
+    safTelemetry_frames* f = &(h->frames);
+    TELEMETRY_ATOMIC_STORE(&(f->seq), f->seq+1);
+}
+
+void saf_telemetry_create
+(
+    void ** const phTel
+)
+{
+    safTelemetry_data* h;
+
+    h = (safTelemetry_data*)calloc1d(1, sizeof(safTelemetry_data));
+    *phTel = (void*)h;
+    h->resetFramesRequested = h->resetReinitsRequested = 0;
+}
+
+void saf_telemetry_destroy
+(
+    void ** const phTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(*phTel);
+
+    if(h!=NULL){
+        free(h);
+        *phTel = NULL;
+    }
+}
+
+void saf_telemetry_frameBegin
+(
+    void * const hTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    if(h==NULL)
+        return;
+    h->frameStartTime = saf_telemetry_getTime();
+}
+
+void saf_telemetry_frameEnd
+(
+    void * const hTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    safTelemetry_frames* f;
+    double elapsed;
+
+    if(h==NULL)
+        return;
+    elapsed = MAX(saf_telemetry_getTime() - h->frameStartTime, 0.0);
+    f = &(h->frames);
+    saf_telemetry_beginFramesUpdate(h);
+    f->nProcessed++;
+    f->totalTime += elapsed;
+    f->lastTime = elapsed;
+    f->maxTime = MAX(f->maxTime, elapsed);
+    f->histogram[saf_telemetry_getHistogramBin(elapsed)]++;
+    saf_telemetry_endFramesUpdate(h);
+}
+
+void saf_telemetry_frameDropped
+(
+    void * const hTel,
+    SAF_TELEMETRY_DROP_REASONS reason
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    if(h==NULL || (int)reason<0 || reason>=SAF_TELEMETRY_NUM_DROP_REASONS)
+        return;
+    saf_telemetry_beginFramesUpdate(h);
+    h->frames.nDropped[reason]++;
+    saf_telemetry_endFramesUpdate(h);
+}
+
+void saf_telemetry_reinitBegin
+(
+    void * const hTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    safTelemetry_reinits* r;
+    long seq;
+
+    if(h==NULL)
+        return;
+    r = &(h->reinits);
+    h->reinitStartTime = saf_telemetry_getTime();
+    seq = r->seq;
+    TELEMETRY_ATOMIC_STORE(&(r->seq), seq+1);
+    r->ongoing = 1;
+    TELEMETRY_ATOMIC_STORE(&(r->seq), seq+2);
+}
+
+void saf_telemetry_reinitEnd
+(
+    void * const hTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    safTelemetry_reinits* r;
+    double elapsed;
+    long seq;
+
+    if(h==NULL)
+        return;
+    r = &(h->reinits);
+    elapsed = MAX(saf_telemetry_getTime() - h->reinitStartTime, 0.0);
+    seq = r->seq;
+    TELEMETRY_ATOMIC_STORE(&(r->seq), seq+1);
+    if(TELEMETRY_ATOMIC_LOAD(&(h->resetReinitsRequested))){
+        TELEMETRY_ATOMIC_STORE(&(h->resetReinitsRequested), 0L);
+        r->nReinits = 0;
+        r->totalTime = 0.0;
+    }
+    r->nReinits++;
+    r->totalTime += elapsed;
+    r->lastTime = elapsed;
+    r->ongoing = 0;
+    TELEMETRY_ATOMIC_STORE(&(r->seq), seq+2);
+}
+
+void saf_telemetry_getSnapshot
+(
+    void * const hTel,
+    saf_telemetry_snapshot* snap
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    safTelemetry_frames f;
+    safTelemetry_reinits r;
+    long seq0, seq1;
+
+    memset(snap, 0, sizeof(saf_telemetry_snapshot));
+    if(h==NULL)
+        return;
+
+    /* copy the metrics, retrying if they were updated in the meantime */
+    do {
+        seq0 = TELEMETRY_ATOMIC_LOAD(&(h->frames.seq));
+        memcpy(&f, (const void*)&(h->frames), sizeof(safTelemetry_frames));
+        seq1 = TELEMETRY_ATOMIC_LOAD(&(h->frames.seq));
+    } while((seq0 & 1) || seq0!=seq1);
+    do {
+        seq0 = TELEMETRY_ATOMIC_LOAD(&(h->reinits.seq));
+        memcpy(&r, (const void*)&(h->reinits), sizeof(safTelemetry_reinits));
+        seq1 = TELEMETRY_ATOMIC_LOAD(&(h->reinits.seq));
+    } while((seq0 & 1) || seq0!=seq1);
+
+    snap->nFramesProcessed = f.nProcessed;
+    memcpy(snap->nFramesDropped, f.nDropped, SAF_TELEMETRY_NUM_DROP_REASONS*sizeof(unsigned long long));
+    snap->meanFrameTime_s = f.nProcessed>0 ? f.totalTime/(double)f.nProcessed : 0.0;
+    snap->lastFrameTime_s = f.lastTime;
+    snap->maxFrameTime_s = f.maxTime;
+    memcpy(snap->frameTimeHistogram, f.histogram, SAF_TELEMETRY_NUM_HIST_BINS*sizeof(unsigned long long));
+    snap->nReinits = r.nReinits;
+    snap->reinitTime_s = r.totalTime;
+    snap->lastReinitTime_s = r.lastTime;
+    snap->reinitOngoing = r.ongoing;
+}
+
+void saf_telemetry_reset
+(
+    void * const hTel
+)
+{
+    safTelemetry_data* h = (safTelemetry_data*)(hTel);
+    if(h!=NULL){
+        TELEMETRY_ATOMIC_STORE(&(h->resetFramesRequested), 1L);
+        TELEMETRY_ATOMIC_STORE(&(h->resetReinitsRequested), 1L);
+    }
+}
+
+double saf_telemetry_getHistogramBinEdge(int bin)
+{
+    bin = CLAMP(bin, 0, SAF_TELEMETRY_NUM_HIST_BINS-1);
+    return bin==0 ? 0.0 : (double)(1ULL<<bin)*1e-6;
+}
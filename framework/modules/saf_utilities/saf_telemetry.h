@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_telemetry.h
+ * @brief Always-on health metrics of a processor instance, for monitoring
+ *        the instances running in production
+ *
+ * The audio thread wraps the processing of each frame with
+ * saf_telemetry_frameBegin() and saf_telemetry_frameEnd(), or calls
+ * saf_telemetry_frameDropped() instead, whenever a frame is not processed
+ * (i.e. silence is output); e.g. because the codec is not (yet) initialised.
+ * The thread re-initialising the codec wraps it with
+ * saf_telemetry_reinitBegin() and saf_telemetry_reinitEnd(). A consistent
+ * snapshot of the metrics may then be obtained from any thread with
+ * saf_telemetry_getSnapshot():
+ *  - the number of frames processed, and dropped (per reason)
+ *  - the mean/last/maximum time taken per processed frame, and a histogram
+ *    of these times, with octave-wide bins (see
+ *    saf_telemetry_getHistogramBinEdge())
+ *  - the number of re-initialisations, and the time spent in them
+ *
+ * Unlike saf_profiler.h, the metrics are always collected (the cost is two
+ * clock readings per frame). The writers never wait: each of the two sets of
+ * metrics has a sequence counter, which its writer makes odd while updating
+ * it, and a reader copies the metrics and retries if the counter was odd or
+ * has changed in the meantime.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_TELEMETRY_H_INCLUDED
+#define SAF_TELEMETRY_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Number of bins of the frame time histogram */
+#define SAF_TELEMETRY_NUM_HIST_BINS ( 20 )
+
+/** Reasons for a frame to be dropped (i.e. for silence to be output) */
+typedef enum _SAF_TELEMETRY_DROP_REASONS {
+    SAF_TELEMETRY_DROP_NOT_INITIALISED = 0, /**< the codec (or the filters,
+                                             *   encoder, etc.) is not
+                                             *   initialised, or is being
+                                             *   re-initialised */
+    SAF_TELEMETRY_DROP_BLOCK_SIZE,          /**< the block size is not the one
+                                             *   the processor was initialised
+                                             *   for */
+
+    SAF_TELEMETRY_NUM_DROP_REASONS
+
+}SAF_TELEMETRY_DROP_REASONS;
+
+/** Snapshot of the metrics (see saf_telemetry_getSnapshot()) */
+typedef struct _saf_telemetry_snapshot {
+    unsigned long long nFramesProcessed;   /**< number of frames processed */
+    unsigned long long nFramesDropped[SAF_TELEMETRY_NUM_DROP_REASONS]; /**<
+                                            *   number of frames dropped, per
+                                            *   reason */
+    double meanFrameTime_s;                /**< mean time taken per processed
+                                            *   frame, in seconds */
+    double lastFrameTime_s;                /**< time taken by the last
+                                            *   processed frame, in seconds */
+    double maxFrameTime_s;                 /**< maximum time taken by a
+                                            *   processed frame, in seconds */
+    unsigned long long frameTimeHistogram[SAF_TELEMETRY_NUM_HIST_BINS]; /**<
+                                            *   number of processed frames per
+                                            *   bin of time taken */
+    unsigned long long nReinits;           /**< number of re-initialisations */
+    double reinitTime_s;                   /**< total time spent in
+                                            *   re-initialisations, in seconds */
+    double lastReinitTime_s;               /**< time taken by the last
+                                            *   re-initialisation, in seconds */
+    int reinitOngoing;                     /**< '1' a re-initialisation is
+                                            *   currently ongoing */
+
+}saf_telemetry_snapshot;
+
+/**
+ * Creates an instance of the telemetry (one per processor instance)
+ *
+ * @param[in] phTel (&) address of saf_telemetry handle
+ */
+void saf_telemetry_create(/* Input Arguments */
+                          void ** const phTel);
+
+/**
+ * Destroys an instance of the telemetry
+ *
+ * @param[in] phTel (&) address of saf_telemetry handle
+ */
+void saf_telemetry_destroy(/* Input Arguments */
+                           void ** const phTel);
+
+/**
+ * (Audio thread) Marks the start of the processing of a frame
+ *
+ * @param[in] hTel saf_telemetry handle (NULL: ignored)
+ */
+void saf_telemetry_frameBegin(/* Input Arguments */
+                              void * const hTel);
+
+/**
+ * (Audio thread) Marks the end of the processing of a frame, and records the
+ * time taken since saf_telemetry_frameBegin()
+ *
+ * @param[in] hTel saf_telemetry handle (NULL: ignored)
+ */
+void saf_telemetry_frameEnd(/* Input Arguments */
+                            void * const hTel);
+
+/**
+ * (Audio thread) Records a frame that was not processed
+ *
+ * @param[in] hTel   saf_telemetry handle (NULL: ignored)
+ * @param[in] reason See #SAF_TELEMETRY_DROP_REASONS
+ */
+void saf_telemetry_frameDropped(/* Input Arguments */
+                                void * const hTel,
+                                SAF_TELEMETRY_DROP_REASONS reason);
+
+/**
+ * (Initialisation thread) Marks the start of a re-initialisation
+ *
+ * @param[in] hTel saf_telemetry handle (NULL: ignored)
+ */
+void saf_telemetry_reinitBegin(/* Input Arguments */
+                               void * const hTel);
+
+/**
+ * (Initialisation thread) Marks the end of a re-initialisation, and records
+ * the time taken since saf_telemetry_reinitBegin()
+ *
+ * @param[in] hTel saf_telemetry handle (NULL: ignored)
+ */
+void saf_telemetry_reinitEnd(/* Input Arguments */
+                             void * const hTel);
+
+/**
+ * (Any thread) Returns a consistent snapshot of the metrics
+ *
+ * @note This never blocks the audio or initialisation threads.
+ *
+ * @param[in]  hTel saf_telemetry handle (NULL: all zeros)
+ * @param[out] snap (&) snapshot of the metrics
+ */
+void saf_telemetry_getSnapshot(/* Input Arguments */
+                               void * const hTel,
+                               /* Output Arguments */
+                               saf_telemetry_snapshot* snap);
+
+/**
+ * (Any thread) Requests that the metrics are cleared; which is carried out by
+ * the audio thread at the next frame (and by the initialisation thread at the
+ * end of the next re-initialisation, for the re-initialisation metrics)
+ *
+ * @param[in] hTel saf_telemetry handle
+ */
+void saf_telemetry_reset(/* Input Arguments */
+                         void * const hTel);
+
+/**
+ * Returns the lower edge of a bin of the frame time histogram, in seconds
+ *
+ * Bin 'i' holds the frames that took between 2^i and 2^(i+1) microseconds;
+ * except that the first bin also holds the frames that took less, and the
+ * last bin also those that took longer.
+ *
+ * @param[in] bin Bin index; 0..SAF_TELEMETRY_NUM_HIST_BINS-1
+ */
+double saf_telemetry_getHistogramBinEdge(int bin);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_TELEMETRY_H_INCLUDED */
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_tfGraph.c
+ * @brief Chains processors that operate on afSTFT-domain frames, with only
+ *        one forward and one inverse transform for the whole chain
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_tfGraph.h"
+#include "../../resources/afSTFT/afSTFTlib.h"
+
+/** One stage of the graph */
+typedef struct _safTFGraph_stage {
+    saf_tfGraph_stageProcessor proc;
+    void* hStage;
+
+}safTFGraph_stage;
+
+/**
+ * Data structure for the TF-domain processing graph.
+ *
+ * The stages ping-pong between two TF frames: the forward transform writes to
+ * frameTF[0], stage 0 reads it and writes to frameTF[1], stage 1 writes back to
+ * frameTF[0], and so on. The inverse transform then reads whichever frame the
+ * last stage wrote to.
+ */
+typedef struct _safTFGraph_data {
+    int hopSize, frameSize, nTimeSlots, nBands;
+    int maxNumChannels;
+    int nInCH_STFT, nOutCH_STFT; /**< current number of afSTFT input/output channels */
+    void* hSTFT;
+    int nStages;
+    safTFGraph_stage stages[SAF_TFGRAPH_MAX_NUM_STAGES];
+    float_complex* frameTF[2]; /**< FLAT: nBands x maxNumChannels x nTimeSlots */
+    float** outFrameTD;        /**< used if the last stage returns more channels than the host has; maxNumChannels x frameSize */
+
+}safTFGraph_data;
+
+void saf_tfGraph_create
+(
+    void ** const phG,
+    int hopSize,
+    int frameSize,
+    int maxNumChannels
+)
+{
+    *phG = malloc1d(sizeof(safTFGraph_data));
+    safTFGraph_data *h = (safTFGraph_data*)(*phG);
+
+    assert(frameSize % hopSize == 0);
+    h->hopSize = hopSize;
+    h->frameSize = frameSize;
+    h->nTimeSlots = frameSize/hopSize;
+    h->nBands = hopSize + 5; /* (hybrid-mode) */
+    h->maxNumChannels = maxNumChannels;
+    h->nInCH_STFT = h->nOutCH_STFT = maxNumChannels;
+    afSTFTinit(&(h->hSTFT), hopSize, maxNumChannels, maxNumChannels, 0, 1, AFSTFT_NUM_THREADS_AUTO);
+    h->nStages = 0;
+    h->frameTF[0] = calloc1d((h->nBands)*maxNumChannels*(h->nTimeSlots), sizeof(float_complex));
+    h->frameTF[1] = calloc1d((h->nBands)*maxNumChannels*(h->nTimeSlots), sizeof(float_complex));
+    h->outFrameTD = (float**)malloc2d(maxNumChannels, frameSize, sizeof(float));
+}
+
+void saf_tfGraph_destroy
+(
+    void ** const phG
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(*phG);
+
+    if(h!=NULL){
+        afSTFTfree(h->hSTFT);
+        free(h->frameTF[0]);
+        free(h->frameTF[1]);
+        free(h->outFrameTD);
+        free(h);
+        *phG = NULL;
+    }
+}
+
+int saf_tfGraph_addStage
+(
+    void * const hG,
+    saf_tfGraph_stageProcessor proc,
+    void * const hStage
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(hG);
+
+    if(h->nStages>=SAF_TFGRAPH_MAX_NUM_STAGES)
+        return -1;
+    h->stages[h->nStages].proc = proc;
+    h->stages[h->nStages].hStage = hStage;
+    return h->nStages++;
+}
+
+void saf_tfGraph_clearStages
+(
+    void * const hG
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(hG);
+
+    h->nStages = 0;
+}
+
+void saf_tfGraph_flush
+(
+    void * const hG
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(hG);
+
+    afSTFTclearBuffers(h->hSTFT);
+}
+
+int saf_tfGraph_getProcessingDelay
+(
+    void * const hG
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(hG);
+
+    return 12*(h->hopSize);
+}
+
+void saf_tfGraph_processFrame
+(
+    void * const hG,
+    float ** const inFrame,
+    float ** const outFrame,
+    int nInputs,
+    int nOutputs
+)
+{
+    safTFGraph_data *h = (safTFGraph_data*)(hG);
+    int s, ch, nCH, cur;
+    float** outTD;
+    unsigned int fpState;
+
+    fpState = saf_denormals_guardBegin();
+
+    /* forward transform */
+    nCH = MIN(nInputs, h->maxNumChannels);
+    if(nCH!=h->nInCH_STFT){
+        afSTFTchannelChange(h->hSTFT, nCH, h->nOutCH_STFT);
+        h->nInCH_STFT = nCH;
+    }
+    cur = 0;
+    afSTFTforwardFrame(h->hSTFT, inFrame, h->nTimeSlots, h->frameTF[cur], nCH*(h->nTimeSlots), h->nTimeSlots);
+
+    /* TF-domain stages */
+    for(s=0; s<h->nStages && nCH>0; s++){
+        nCH = h->stages[s].proc(h->stages[s].hStage, (const float*)h->frameTF[cur], (float*)h->frameTF[1-cur], nCH,
+                                h->maxNumChannels, h->nBands, h->nTimeSlots);
+        nCH = CLAMP(nCH, 0, h->maxNumChannels);
+        cur = 1-cur;
+    }
+
+    /* inverse transform (directly into the host buffers, if they are enough) */
+    if(nCH>0){
+        if(nCH!=h->nOutCH_STFT){
+            afSTFTchannelChange(h->hSTFT, h->nInCH_STFT, nCH);
+            h->nOutCH_STFT = nCH;
+        }
+        outTD = nCH<=nOutputs ? outFrame : h->outFrameTD;
+        afSTFTinverseFrame(h->hSTFT, h->frameTF[cur], nCH*(h->nTimeSlots), h->nTimeSlots, h->nTimeSlots, outTD);
+        if(outTD!=outFrame)
+            for(ch=0; ch<nOutputs; ch++)
+                utility_svvcopy(outTD[ch], h->frameSize, outFrame[ch]);
+    }
+    for(ch=MAX(nCH, 0); ch<nOutputs; ch++)
+        memset(outFrame[ch], 0, h->frameSize*sizeof(float));
+
+    saf_denormals_guardEnd(fpState);
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_tfGraph.h
+ * @brief Chains processors that operate on afSTFT-domain frames, with only
+ *        one forward and one inverse transform for the whole chain
+ *
+ * When e.g. a rotator, a dynamic range compressor and a binaural decoder are
+ * placed in series, each would otherwise apply its own forward and inverse
+ * afSTFT; multiplying the filterbank cost and latency by the number of
+ * processors. Instead, the graph transforms each frame once, passes the
+ * time-frequency (TF) frame through the stages in the order in which they were
+ * added, and transforms the output of the last stage back.
+ *
+ * The stages are typically the "processTF" functions of the SAF examples (e.g.
+ * ambi_drc_processTF(), ambi_bin_processTF()), which expect the afSTFT in
+ * hybrid-mode with a hop size of 128 samples. The TF frames are passed between
+ * the stages as FLAT: nBands x nChannels x nTimeSlots (i.e. the layout of
+ * afSTFTforwardFrame()), of interleaved real and imaginary parts; i.e. they may
+ * be cast to float_complex*. (Plain floats are used in the prototype so that
+ * the headers of the processors need not depend on saf_complex.h)
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_TFGRAPH_H_INCLUDED
+#define SAF_TFGRAPH_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Maximum number of stages in one graph */
+#define SAF_TFGRAPH_MAX_NUM_STAGES ( 16 )
+
+/**
+ * Prototype of a TF-domain stage, which is given one TF frame of input signals
+ * and must write one TF frame of output signals
+ *
+ * @param[in]  hStage        Handle of the processor
+ * @param[in]  inTF          Input frame (complex); FLAT: nBands x nInputs x
+ *                           nTimeSlots
+ * @param[out] outTF         Output frame (complex); FLAT: nBands x nOutputs x
+ *                           nTimeSlots (where nOutputs is the returned value)
+ * @param[in]  nInputs       Number of input channels
+ * @param[in]  maxNumOutputs Maximum number of output channels that fit 'outTF'
+ * @param[in]  nBands        Number of bands
+ * @param[in]  nTimeSlots    Number of time slots (hops)
+ * @returns Number of output channels written (nOutputs <= maxNumOutputs); 0 if
+ *          the processor is not ready (e.g. it is being initialised)
+ */
+typedef int (*saf_tfGraph_stageProcessor)(void* const hStage,
+                                          const float* inTF,
+                                          float* outTF,
+                                          int nInputs,
+                                          int maxNumOutputs,
+                                          int nBands,
+                                          int nTimeSlots);
+
+/**
+ * Creates an instance of the TF-domain processing graph (with no stages)
+ *
+ * All memory for the TF frames is allocated here. The afSTFT is only
+ * re-allocated if the number of input channels, or the number of channels
+ * returned by the last stage, changes.
+ *
+ * @param[in] phG            (&) address of graph handle
+ * @param[in] hopSize        Hop size of the afSTFT (hybrid-mode), in samples
+ * @param[in] frameSize      Frame size, in samples (multiple of hopSize)
+ * @param[in] maxNumChannels Maximum number of channels of any stage
+ */
+void saf_tfGraph_create(/* Input Arguments */
+                        void ** const phG,
+                        int hopSize,
+                        int frameSize,
+                        int maxNumChannels);
+
+/**
+ * Destroys an instance of the TF-domain processing graph (the processors of
+ * the stages are not destroyed)
+ *
+ * @param[in] phG (&) address of graph handle
+ */
+void saf_tfGraph_destroy(/* Input Arguments */
+                         void ** const phG);
+
+/**
+ * Appends a stage to the end of the chain
+ *
+ * @note Not thread safe; only add stages while the graph is not processing.
+ *
+ * @param[in] hG     Graph handle
+ * @param[in] proc   TF-domain processing function of the stage
+ * @param[in] hStage Handle passed to the processing function
+ * @returns Index of the stage, or -1 if SAF_TFGRAPH_MAX_NUM_STAGES has been
+ *          reached
+ */
+int saf_tfGraph_addStage(/* Input Arguments */
+                         void * const hG,
+                         saf_tfGraph_stageProcessor proc,
+                         void * const hStage);
+
+/** Removes all of the stages (i.e. the graph becomes a pass-through) */
+void saf_tfGraph_clearStages(/* Input Arguments */
+                             void * const hG);
+
+/** Flushes the afSTFT buffers with zeros */
+void saf_tfGraph_flush(/* Input Arguments */
+                       void * const hG);
+
+/**
+ * Returns the latency introduced by the graph, in samples (i.e. that of one
+ * afSTFT round-trip; the frame delay of a saf_fifo driving the graph is not
+ * included)
+ */
+int saf_tfGraph_getProcessingDelay(/* Input Arguments */
+                                   void * const hG);
+
+/**
+ * Processes one frame of frameSize samples through the chain
+ *
+ * The signature matches saf_fifo_frameProcessor, and so the graph may be
+ * driven with any host block size by passing this function (and the graph
+ * handle) to saf_fifo_process().
+ *
+ * @note Input channels beyond maxNumChannels are ignored, and output channels
+ *       beyond those returned by the last stage are zeroed.
+ *
+ * @param[in]  hG       Graph handle
+ * @param[in]  inFrame  Input frame;  nInputs  x frameSize
+ * @param[out] outFrame Output frame; nOutputs x frameSize
+ * @param[in]  nInputs  Number of input channels
+ * @param[in]  nOutputs Number of output channels
+ */
+void saf_tfGraph_processFrame(/* Input Arguments */
+                              void * const hG,
+                              float ** const inFrame,
+                              /* Output Arguments */
+                              float ** const outFrame,
+                              /* Input Arguments */
+                              int nInputs,
+                              int nOutputs);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_TFGRAPH_H_INCLUDED */
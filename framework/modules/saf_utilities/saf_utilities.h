@@ -32,11 +32,29 @@
  *       to enable ATLAS BLAS routines and ATLAS's CLAPACK interface
  *   - SAF_USE_OPENBLAS_WITH_LAPACKE:
  *       to enable OpenBLAS with LAPACKE interface
+ *   - SAF_USE_BUILTIN_BLAS_AND_LAPACK:
+ *       to employ the minimal built-in subset of CBLAS and LAPACKE (see
+ *       saf_builtinBlas.h), which requires no library; e.g. for WebAssembly
+ *       builds (the default for Emscripten, and for SAF_EMBEDDED_PROFILE, if
+ *       none of the above are defined)
  *
  * @see More information can be found here:
  *      https://github.com/leomccormack/Spatial_Audio_Framework
  * @note MacOSX users only: saf_utilities will employ Apple's Accelerate library
  *       by default, if none of the above FLAGS are defined.
+ * ## Embedded profile
+ *   Add SAF_EMBEDDED_PROFILE to your project's preprocessor definitions, for
+ *   a low-footprint build of the rotator and ambi_bin examples on embedded
+ *   (e.g. ARM Cortex-A) targets:
+ *   - their maximum order, which sizes their buffers, is
+ *     SAF_EMBEDDED_MAX_SH_ORDER (default: 3), rather than 7
+ *   - ambi_bin allocates its buffers from one arena at creation (see
+ *     arena_create()), and only applies prebaked decoders (see
+ *     ambi_bin_setPrebakedDecoder()); so neither the HRIRs, nor the decoder
+ *     design (and thus LAPACK) are required by it
+ *   - the built-in CBLAS/LAPACKE subset is used, unless a performance library
+ *     is defined above; and the NEON kernels of saf_veclib are selected
+ *     whenever the compiler targets NEON
  *
  * @author Leo McCormack
  * @date 11.07.2016
@@ -61,6 +79,12 @@
 # define VECLIB_USE_LAPACKE_INTERFACE
 # include "cblas.h"
 # include "lapacke.h"
+#elif defined(SAF_USE_BUILTIN_BLAS_AND_LAPACK) || defined(__EMSCRIPTEN__) || defined(SAF_EMBEDDED_PROFILE)
+# ifndef SAF_USE_BUILTIN_BLAS_AND_LAPACK
+#  define SAF_USE_BUILTIN_BLAS_AND_LAPACK
+# endif
+# define VECLIB_USE_LAPACKE_INTERFACE
+# include "../saf_utilities/saf_builtinBlas.h"
 #elif defined(__APPLE__)
 # define VECLIB_USE_LAPACK_FORTRAN_INTERFACE
 # include "Accelerate/Accelerate.h"
@@ -115,6 +139,49 @@
 #include "../saf_utilities/saf_fft.h"
 /* matrix convolver */
 #include "../saf_utilities/saf_matrixConv.h"
+/* for driving fixed frame-size processing with any host block size */
+#include "../saf_utilities/saf_fifo.h"
+/* for aligning the outputs of parallel chains with different latencies */
+#include "../saf_utilities/saf_latencyAlign.h"
+/* for streaming (long) multi-channel WAV files frame by frame */
+#include "../saf_utilities/saf_wavStream.h"
+/* for memory-mapped reading of measured microphone array responses */
+#include "../saf_utilities/saf_arrayResponses.h"
+/* for chaining afSTFT-domain processors with one forward/inverse transform */
+#include "../saf_utilities/saf_tfGraph.h"
+/* for (re)initialising codecs on a background thread */
+#include "../saf_utilities/saf_asyncInit.h"
+/* for running "parallel-for" loops over a pool of worker threads */
+#include "../saf_utilities/saf_parfor.h"
+/* for handing frames (e.g. activity-maps) over to a GUI thread */
+#include "../saf_utilities/saf_frameRing.h"
+/* for passing multi-channel frames to other processes via shared memory */
+#include "../saf_utilities/saf_shmBus.h"
+/* for summing the partial outputs of renderers running on several nodes */
+#include "../saf_utilities/saf_partialMix.h"
+/* for warming up a processor before its first audio callback */
+#include "../saf_utilities/saf_warmUp.h"
+/* for handing parameter updates over to the audio thread */
+#include "../saf_utilities/saf_paramQueue.h"
+#include "../saf_utilities/saf_benchmark.h"
+/* for recording and replaying automation (time-stamped parameter changes) */
+#include "../saf_utilities/saf_automation.h"
+/* for timing the stages of the processing loops */
+#include "../saf_utilities/saf_profiler.h"
+/* for monitoring the health of the processors (frames processed/dropped etc.) */
+#include "../saf_utilities/saf_telemetry.h"
+/* for reducing the quality of the processing when the CPU is overloaded */
+#include "../saf_utilities/saf_qualityControl.h"
+/* for reporting the time and memory taken by each stage of an initialisation */
+#include "../saf_utilities/saf_initReport.h"
+/* for recomputing only the stages of an initialisation whose inputs changed */
+#include "../saf_utilities/saf_initDeps.h"
+/* for flushing denormals to zero during the processing */
+#include "../saf_utilities/saf_denormals.h"
+/* for quaternion orientations, and predicting head-tracker orientations */
+#include "../saf_utilities/saf_orientation.h"
+/* for peak-picking and source tracking on maps over spherical grids */
+#include "../saf_utilities/saf_mapPeaks.h"
 /* for decorrelators */
 #include "../saf_utilities/saf_decor.h"
 /* for determining ERBs */
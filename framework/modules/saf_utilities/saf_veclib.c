@@ -31,6 +31,11 @@
  *       to enable ATLAS BLAS routines and ATLAS's CLAPACK interface
  *   - SAF_USE_OPENBLAS_WITH_LAPACKE:
  *       to enable OpenBLAS with LAPACKE interface
+ *   - SAF_USE_BUILTIN_BLAS_AND_LAPACK:
+ *       to employ the minimal built-in subset of CBLAS and LAPACKE (see
+ *       saf_builtinBlas.h), which requires no library; e.g. for WebAssembly
+ *       builds (the default for Emscripten, and for SAF_EMBEDDED_PROFILE, if
+ *       none of the above are defined)
  *
  * @see More information can be found here:
  *      https://github.com/leomccormack/Spatial_Audio_Framework
@@ -64,2010 +69,5741 @@
 
 
 /* ========================================================================== */
-/*                     Find Index of Min-Abs-Value (?iminv)                   */
+/*                     SIMD Kernels (for the element-wise ops)                */
 /* ========================================================================== */
 
-void utility_siminv
+/*
+ * These are employed by the element-wise routines below, for which the
+ * performance library offers no (vendor-specific) alternative. SSE2 is assumed
+ * for x86_64 builds, while AVX2 is also compiled (regardless of the compiler's
+ * target flags) and used if it is supported by the CPU at run-time. NEON is
+ * used if the compiler targets it (e.g. all aarch64 builds), as is
+ * WebAssembly SIMD128 (e.g. Emscripten builds with -msimd128). Otherwise, plain
+ * loops are used. The vectors may not be aligned, and 'c' may be the same as
+ * 'a' (in-place). Define SAF_VECLIB_DISABLE_SIMD to only use the plain loops.
+ */
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(SAF_VECLIB_DISABLE_SIMD)
+# define SAF_VECLIB_SSE2
+# include <emmintrin.h>
+# if defined(__GNUC__) || defined(__clang__)
+#  define SAF_VECLIB_AVX2
+#  define SAF_VECLIB_AVX2_TARGET __attribute__((target("avx2,fma")))
+#  include <immintrin.h>
+# elif defined(_MSC_VER)
+#  define SAF_VECLIB_AVX2
+#  define SAF_VECLIB_AVX2_TARGET
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(SAF_VECLIB_DISABLE_SIMD)
+# define SAF_VECLIB_NEON
+# include <arm_neon.h>
+#elif defined(__wasm_simd128__) && !defined(SAF_VECLIB_DISABLE_SIMD)
+# define SAF_VECLIB_WASM_SIMD128
+# include <wasm_simd128.h>
+#endif
+
+/** Element-wise operations carried out by the SIMD kernels */
+typedef enum _VECLIB_OP {
+    VECLIB_ADD,
+    VECLIB_SUB,
+    VECLIB_MUL,
+    VECLIB_DIV
+}VECLIB_OP;
+
+#if !defined(INTEL_MKL_VERSION) /* (MKL's vsAdd etc. are used instead) */
+/** c = a (op) b, for vectors 'a' and 'b' (plain loops) */
+static void veclib_svvop_scalar
 (
+    VECLIB_OP op,
     const float* a,
+    const float* b,
     const int len,
-    int* index
+    float* c
 )
 {
-#if defined(__ACCELERATE__)
-    float minVal;
-    vDSP_Length ind_tmp;
-    vDSP_minvi(a, 1, &minVal, &ind_tmp, len);
-    *index = (int)ind_tmp; 
-#elif defined(INTEL_MKL_VERSION)
-    *index = (int)cblas_isamin(len, a, 1);
-#else
     int i;
-    *index = 0;
-    float minVal=FLT_MAX;
-    for(i=0; i<len; i++){
-        if(fabsf(a[i])<minVal){
-            minVal = fabsf(a[i]);
-            *index = i;
-        } 
+    switch(op){
+        case VECLIB_ADD: for(i=0; i<len; i++) c[i] = a[i] + b[i]; break;
+        case VECLIB_SUB: for(i=0; i<len; i++) c[i] = a[i] - b[i]; break;
+        case VECLIB_MUL: for(i=0; i<len; i++) c[i] = a[i] * b[i]; break;
+        case VECLIB_DIV: for(i=0; i<len; i++) c[i] = a[i] / b[i]; break;
     }
-#endif
 }
+#endif /* !INTEL_MKL_VERSION */
 
-void utility_ciminv
+/** c = a (op) s, for vector 'a' and scalar 's' (plain loops) */
+static void veclib_svsop_scalar
 (
-    const float_complex* a,
+    VECLIB_OP op,
+    const float* a,
+    const float s,
     const int len,
-    int* index
+    float* c
 )
 {
-#if defined(__ACCELERATE__)
     int i;
-    float* abs_a;
-    float minVal;
-    abs_a = malloc1d(len*sizeof(float));
-    for(i=0; i<len; i++)
-        abs_a[i] = cabsf(a[i]);
-    vDSP_Length ind_tmp;
-    vDSP_minvi(abs_a, 1, &minVal, &ind_tmp, len);
-    *index = (int)ind_tmp;
-    free(abs_a);
-#elif defined(INTEL_MKL_VERSION)
-    *index = (int)cblas_icamin(len, a, 1);
-#else
-    int i;
-    *index = 0;
-    float minVal=FLT_MAX;
-    for(i=0; i<len; i++){
-        if(cabsf(a[i])<minVal){
-            minVal = cabsf(a[i]);
-            *index = i;
-        } 
+    switch(op){
+        case VECLIB_ADD: for(i=0; i<len; i++) c[i] = a[i] + s; break;
+        case VECLIB_SUB: for(i=0; i<len; i++) c[i] = a[i] - s; break;
+        case VECLIB_MUL: for(i=0; i<len; i++) c[i] = a[i] * s; break;
+        case VECLIB_DIV: for(i=0; i<len; i++) c[i] = a[i] / s; break;
     }
-#endif
 }
 
-
-/* ========================================================================== */
-/*                     Find Index of Max-Abs-Value (?imaxv)                   */
-/* ========================================================================== */
-
-void utility_simaxv
+/**
+ * c = a.*b, for complex vectors 'a' and 'b'; or c = a.*b[0], if 'scalarB'
+ * (plain loops)
+ */
+static void veclib_cvvmul_scalar
 (
-    const float* a,
+    const float_complex* a,
+    const float_complex* b,
+    const int scalarB,
     const int len,
-    int* index
+    float_complex* c
 )
 {
-    *index = (int)cblas_isamax(len, a, 1);
+    int i;
+    for(i=0; i<len; i++)
+        c[i] = ccmulf(a[i], b[scalarB ? 0 : i]);
 }
 
-void utility_cimaxv
+/**
+ * c = a.*b, for split-complex vectors 'a' and 'b'; or c = a.*b[0], if
+ * 'scalarB'. 'b' is conjugated if 'conjB', and the products are added to 'c'
+ * if 'accumulate' (plain loops)
+ */
+static void veclib_cvvmul_split_scalar
 (
-    const float_complex* a,
+    const float* a_re,
+    const float* a_im,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
     const int len,
-    int* index
+    float* c_re,
+    float* c_im
 )
 {
-    *index = (int)cblas_icamax(len, a, 1);
+    int i, j;
+    float br, bi, re, im;
+    for(i=0; i<len; i++){
+        j = scalarB ? 0 : i;
+        br = b_re[j];
+        bi = conjB ? -b_im[j] : b_im[j];
+        re = a_re[i]*br - a_im[i]*bi;
+        im = a_re[i]*bi + a_im[i]*br;
+        c_re[i] = accumulate ? c_re[i] + re : re;
+        c_im[i] = accumulate ? c_im[i] + im : im;
+    }
 }
 
-
-/* ========================================================================== */
-/*                              Vector-Abs (?vabs)                            */
-/* ========================================================================== */
-
-void utility_svabs
+/** c = c + a.*b, for complex vectors 'a' and 'b' (plain loops) */
+static void veclib_cvvmac_scalar
 (
-    const float* a,
+    const float_complex* a,
+    const float_complex* b,
     const int len,
-    float* c
+    float_complex* c
 )
 {
-#ifdef INTEL_MKL_VERSION
-    vsAbs(len, a, c);
-#else
     int i;
-    for(i=0; i<len; i++)
-        c[i] = fabsf(a[i]);
-#endif
+    const float* pa, *pb;
+    float* pc;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    for(i=0; i<len; i++){
+        pc[2*i]   += pa[2*i]*pb[2*i]   - pa[2*i+1]*pb[2*i+1];
+        pc[2*i+1] += pa[2*i]*pb[2*i+1] + pa[2*i+1]*pb[2*i];
+    }
 }
 
-void utility_cvabs
+#ifdef SAF_VECLIB_AVX2
+/** Returns 1 if the CPU (and OS) supports AVX2 and FMA, 0 otherwise */
+static int veclib_hasAVX2(void)
+{
+    static int hasAVX2 = -1; /* (the query is cached; any race is benign) */
+    if(hasAVX2<0){
+# if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        hasAVX2 = 0;
+        if(info[0]>=7){
+            __cpuid(info, 1);
+            /* OSXSAVE, AVX and FMA; and the OS saves the YMM registers */
+            if((info[2] & (1<<27)) && (info[2] & (1<<28)) && (info[2] & (1<<12)) && ((_xgetbv(0) & 6) == 6)){
+                __cpuidex(info, 7, 0);
+                hasAVX2 = (info[1] & (1<<5)) ? 1 : 0;
+            }
+        }
+# else
+        hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? 1 : 0;
+# endif
+    }
+    return hasAVX2;
+}
+
+#if !defined(INTEL_MKL_VERSION)
+/** c = a (op) b; AVX2 version of veclib_svvop_scalar() */
+SAF_VECLIB_AVX2_TARGET static void veclib_svvop_avx2
 (
-    const float_complex* a,
+    VECLIB_OP op,
+    const float* a,
+    const float* b,
     const int len,
     float* c
 )
 {
-#ifdef INTEL_MKL_VERSION
-    vcAbs(len, (MKL_Complex8*)a, c);
-#else
     int i;
-    for(i=0; i<len; i++)
-        c[i] = cabsf(a[i]);
-#endif
+    __m256 va, vb;
+    for(i=0; i<len-7; i+=8){
+        va = _mm256_loadu_ps(&a[i]);
+        vb = _mm256_loadu_ps(&b[i]);
+        switch(op){
+            case VECLIB_ADD: va = _mm256_add_ps(va, vb); break;
+            case VECLIB_SUB: va = _mm256_sub_ps(va, vb); break;
+            case VECLIB_MUL: va = _mm256_mul_ps(va, vb); break;
+            case VECLIB_DIV: va = _mm256_div_ps(va, vb); break;
+        }
+        _mm256_storeu_ps(&c[i], va);
+    }
+    _mm256_zeroupper(); /* (avoids AVX-SSE transition penalties) */
+    veclib_svvop_scalar(op, &a[i], &b[i], len-i, &c[i]);
 }
+#endif /* !INTEL_MKL_VERSION */
 
-
-/* ========================================================================== */
-/*                        Vector-Vector Copy (?vvcopy)                        */
-/* ========================================================================== */
-
-void utility_svvcopy
+/** c = a (op) s; AVX2 version of veclib_svsop_scalar() */
+SAF_VECLIB_AVX2_TARGET static void veclib_svsop_avx2
 (
+    VECLIB_OP op,
     const float* a,
+    const float s,
     const int len,
     float* c
 )
 {
-    cblas_scopy(len, a, 1, c, 1);
+    int i;
+    __m256 va, vs;
+    vs = _mm256_set1_ps(s);
+    for(i=0; i<len-7; i+=8){
+        va = _mm256_loadu_ps(&a[i]);
+        switch(op){
+            case VECLIB_ADD: va = _mm256_add_ps(va, vs); break;
+            case VECLIB_SUB: va = _mm256_sub_ps(va, vs); break;
+            case VECLIB_MUL: va = _mm256_mul_ps(va, vs); break;
+            case VECLIB_DIV: va = _mm256_div_ps(va, vs); break;
+        }
+        _mm256_storeu_ps(&c[i], va);
+    }
+    _mm256_zeroupper();
+    veclib_svsop_scalar(op, &a[i], s, len-i, &c[i]);
 }
 
-void utility_cvvcopy
+/** c = a.*b (or a.*b[0]); AVX2 version of veclib_cvvmul_scalar() */
+SAF_VECLIB_AVX2_TARGET static void veclib_cvvmul_avx2
 (
     const float_complex* a,
+    const float_complex* b,
+    const int scalarB,
     const int len,
     float_complex* c
 )
 {
-    cblas_ccopy(len, a, 1, c, 1);
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    __m256 va, vb, vb_re, vb_im, va_sw;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    vb = scalarB ? _mm256_setr_ps(pb[0], pb[1], pb[0], pb[1], pb[0], pb[1], pb[0], pb[1]) : _mm256_setzero_ps();
+    for(i=0; i<len-3; i+=4){
+        /* [ar ai] x [br bi] = [ar*br - ai*bi, ai*br + ar*bi] */
+        va = _mm256_loadu_ps(&pa[2*i]);
+        if(!scalarB)
+            vb = _mm256_loadu_ps(&pb[2*i]);
+        vb_re = _mm256_moveldup_ps(vb);
+        vb_im = _mm256_movehdup_ps(vb);
+        va_sw = _mm256_permute_ps(va, 0xB1);
+        _mm256_storeu_ps(&pc[2*i], _mm256_fmaddsub_ps(va, vb_re, _mm256_mul_ps(va_sw, vb_im)));
+    }
+    _mm256_zeroupper();
+    veclib_cvvmul_scalar(&a[i], scalarB ? b : &b[i], scalarB, len-i, &c[i]);
 }
 
-
-/* ========================================================================== */
-/*                       Vector-Vector Addition (?vvadd)                      */
-/* ========================================================================== */
-
-void utility_svvadd
+/** Split-complex c = (c+) a.*b; AVX2 version of veclib_cvvmul_split_scalar() */
+SAF_VECLIB_AVX2_TARGET static void veclib_cvvmul_split_avx2
 (
-    float* a,
-    const float* b,
+    const float* a_re,
+    const float* a_im,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
     const int len,
-    float* c
+    float* c_re,
+    float* c_im
 )
 {
-#ifdef __ACCELERATE__
-	if (c == NULL) {
-		float* tmp;
-		tmp = malloc1d(len * sizeof(float));
-		vDSP_vadd(a, 1, b, 1, tmp, 1, len);
-		utility_svvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vDSP_vadd(a, 1, b, 1, c, 1, len);
-#elif defined(INTEL_MKL_VERSION)
-	if (c == NULL) {
-		float* tmp;
-		tmp = malloc1d(len * sizeof(float));
-		vsAdd(len, a, b, tmp);
-		utility_svvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vsAdd(len, a, b, c);
-#else
-	int i;
-	for (i = 0; i < len; i++)
-		c[i] = a[i] + b[i];
-#endif
+    int i;
+    __m256 var, vai, vbr, vbi, vcr, vci, sign;
+    sign = conjB ? _mm256_set1_ps(-0.0f) : _mm256_setzero_ps();
+    vbr = _mm256_set1_ps(b_re[0]);
+    vbi = _mm256_xor_ps(_mm256_set1_ps(b_im[0]), sign);
+    for(i=0; i<len-7; i+=8){
+        var = _mm256_loadu_ps(&a_re[i]);
+        vai = _mm256_loadu_ps(&a_im[i]);
+        if(!scalarB){
+            vbr = _mm256_loadu_ps(&b_re[i]);
+            vbi = _mm256_xor_ps(_mm256_loadu_ps(&b_im[i]), sign);
+        }
+        vcr = accumulate ? _mm256_loadu_ps(&c_re[i]) : _mm256_setzero_ps();
+        vci = accumulate ? _mm256_loadu_ps(&c_im[i]) : _mm256_setzero_ps();
+        vcr = _mm256_fnmadd_ps(vai, vbi, _mm256_fmadd_ps(var, vbr, vcr));
+        vci = _mm256_fmadd_ps(vai, vbr, _mm256_fmadd_ps(var, vbi, vci));
+        _mm256_storeu_ps(&c_re[i], vcr);
+        _mm256_storeu_ps(&c_im[i], vci);
+    }
+    _mm256_zeroupper();
+    veclib_cvvmul_split_scalar(&a_re[i], &a_im[i], scalarB ? b_re : &b_re[i], scalarB ? b_im : &b_im[i],
+                               scalarB, conjB, accumulate, len-i, &c_re[i], &c_im[i]);
 }
 
-void utility_cvvadd
+/** c = c + a.*b; AVX2 version of veclib_cvvmac_scalar() */
+SAF_VECLIB_AVX2_TARGET static void veclib_cvvmac_avx2
 (
-    float_complex* a,
+    const float_complex* a,
     const float_complex* b,
     const int len,
     float_complex* c
 )
 {
-#ifdef INTEL_MKL_VERSION
-	if (c == NULL) {
-		float_complex* tmp;
-		tmp = malloc1d(len * sizeof(float_complex));
-		vcAdd(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
-		utility_cvvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vcAdd(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    __m256 va, vb, vc, sign;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    sign = _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f);
+    for(i=0; i<len-3; i+=4){
+        /* [cr ci] + [ar ai].*[br br] + [ai ar].*[-bi bi] */
+        va = _mm256_loadu_ps(&pa[2*i]);
+        vb = _mm256_loadu_ps(&pb[2*i]);
+        vc = _mm256_fmadd_ps(va, _mm256_moveldup_ps(vb), _mm256_loadu_ps(&pc[2*i]));
+        vc = _mm256_fmadd_ps(_mm256_permute_ps(va, 0xB1), _mm256_xor_ps(_mm256_movehdup_ps(vb), sign), vc);
+        _mm256_storeu_ps(&pc[2*i], vc);
+    }
+    _mm256_zeroupper();
+    veclib_cvvmac_scalar(&a[i], &b[i], len-i, &c[i]);
+}
+#endif /* SAF_VECLIB_AVX2 */
+
+int utility_cpuHasAVX2(void)
+{
+#ifdef SAF_VECLIB_AVX2
+    return veclib_hasAVX2();
 #else
-	int i;
-	for (i = 0; i < len; i++)
-		c[i] = ccaddf(a[i], b[i]);
+    return 0;
 #endif
 }
 
-
-/* ========================================================================== */
-/*                     Vector-Vector Subtraction (?vvsub)                     */
-/* ========================================================================== */
-
-void utility_svvsub
+#ifdef SAF_VECLIB_SSE2
+#if !defined(INTEL_MKL_VERSION)
+/** c = a (op) b; SSE2 version of veclib_svvop_scalar() */
+static void veclib_svvop_sse2
 (
-    float* a,
+    VECLIB_OP op,
+    const float* a,
     const float* b,
     const int len,
     float* c
 )
 {
-#ifdef __ACCELERATE__
-	if (c == NULL) {
-		float* tmp;
-		tmp = malloc1d(len * sizeof(float));
-		vDSP_vsub(a, 1, b, 1, tmp, 1, len);
-		utility_svvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vDSP_vsub(a, 1, b, 1, c, 1, len);
-#elif defined(INTEL_MKL_VERSION)
-	if (c == NULL) {
-		float* tmp;
-		tmp = malloc1d(len * sizeof(float));
-		vsSub(len, a, b, tmp);
-		utility_svvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vsSub(len, a, b, c);
-#else
-	int i;
-	for (i = 0; i < len; i++)
-		c[i] = a[i] + b[i];
-#endif
+    int i;
+    __m128 va, vb;
+    for(i=0; i<len-3; i+=4){
+        va = _mm_loadu_ps(&a[i]);
+        vb = _mm_loadu_ps(&b[i]);
+        switch(op){
+            case VECLIB_ADD: va = _mm_add_ps(va, vb); break;
+            case VECLIB_SUB: va = _mm_sub_ps(va, vb); break;
+            case VECLIB_MUL: va = _mm_mul_ps(va, vb); break;
+            case VECLIB_DIV: va = _mm_div_ps(va, vb); break;
+        }
+        _mm_storeu_ps(&c[i], va);
+    }
+    veclib_svvop_scalar(op, &a[i], &b[i], len-i, &c[i]);
 }
+#endif /* !INTEL_MKL_VERSION */
 
-void utility_cvvsub
+/** c = a (op) s; SSE2 version of veclib_svsop_scalar() */
+static void veclib_svsop_sse2
 (
-    float_complex* a,
+    VECLIB_OP op,
+    const float* a,
+    const float s,
+    const int len,
+    float* c
+)
+{
+    int i;
+    __m128 va, vs;
+    vs = _mm_set1_ps(s);
+    for(i=0; i<len-3; i+=4){
+        va = _mm_loadu_ps(&a[i]);
+        switch(op){
+            case VECLIB_ADD: va = _mm_add_ps(va, vs); break;
+            case VECLIB_SUB: va = _mm_sub_ps(va, vs); break;
+            case VECLIB_MUL: va = _mm_mul_ps(va, vs); break;
+            case VECLIB_DIV: va = _mm_div_ps(va, vs); break;
+        }
+        _mm_storeu_ps(&c[i], va);
+    }
+    veclib_svsop_scalar(op, &a[i], s, len-i, &c[i]);
+}
+
+/** c = a.*b (or a.*b[0]); SSE2 version of veclib_cvvmul_scalar() */
+static void veclib_cvvmul_sse2
+(
+    const float_complex* a,
     const float_complex* b,
+    const int scalarB,
     const int len,
     float_complex* c
 )
 {
-#ifdef INTEL_MKL_VERSION
-	if (c == NULL) {
-		float_complex* tmp;
-		tmp = malloc1d(len * sizeof(float_complex));
-		vcSub(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
-		utility_cvvcopy(tmp, len, a);
-		free(tmp);
-	}
-	else
-		vcSub(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
-#else
-	int i;
-    if (c == NULL) {
-        for (i = 0; i < len; i++)
-            a[i] = ccaddf(a[i], b[i]);
-    }
-    else{
-        for (i = 0; i < len; i++)
-            c[i] = ccaddf(a[i], b[i]);
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    __m128 va, vb, vb_re, vb_im, va_sw, sign;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    sign = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    vb = scalarB ? _mm_setr_ps(pb[0], pb[1], pb[0], pb[1]) : _mm_setzero_ps();
+    for(i=0; i<len-1; i+=2){
+        /* [ar ai] x [br bi] = [ar*br - ai*bi, ai*br + ar*bi] */
+        va = _mm_loadu_ps(&pa[2*i]);
+        if(!scalarB)
+            vb = _mm_loadu_ps(&pb[2*i]);
+        vb_re = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2,2,0,0));
+        vb_im = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3,3,1,1));
+        va_sw = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2,3,0,1));
+        _mm_storeu_ps(&pc[2*i], _mm_add_ps(_mm_mul_ps(va, vb_re), _mm_mul_ps(_mm_mul_ps(va_sw, vb_im), sign)));
     }
-#endif
+    veclib_cvvmul_scalar(&a[i], scalarB ? b : &b[i], scalarB, len-i, &c[i]);
 }
 
-
-/* ========================================================================== */
-/*                    Vector-Vector Multiplication (?vvmul)                   */
-/* ========================================================================== */
-
-void utility_svvmul
+/** Split-complex c = (c+) a.*b; SSE2 version of veclib_cvvmul_split_scalar() */
+static void veclib_cvvmul_split_sse2
 (
-    float* a,
-    const float* b,
+    const float* a_re,
+    const float* a_im,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
     const int len,
-    float* c
+    float* c_re,
+    float* c_im
 )
 {
-#ifdef __ACCELERATE__
-    if(c==NULL){
-        float* tmp;
-        tmp=malloc1d(len*sizeof(float));
-        vDSP_vmul(a, 1, b, 1, tmp, 1, len);
-        utility_svvcopy(tmp, len, a);
-        free(tmp);
-    }
-    else
-        vDSP_vmul(a, 1, b, 1, c, 1, len);
-#elif defined(INTEL_MKL_VERSION)
-    if (c == NULL) {
-        float* tmp;
-        tmp = malloc1d(len * sizeof(float));
-        vsMul(len, a, b, tmp);
-        utility_svvcopy(tmp, len, a);
-        free(tmp);
-    }
-    else
-        vsMul(len, a, b, c);
-#else
     int i;
-    for (i = 0; i < len; i++)
-        c[i] = a[i] * b[i];
-#endif
+    __m128 var, vai, vbr, vbi, vcr, vci, sign;
+    sign = conjB ? _mm_set1_ps(-0.0f) : _mm_setzero_ps();
+    vbr = _mm_set1_ps(b_re[0]);
+    vbi = _mm_xor_ps(_mm_set1_ps(b_im[0]), sign);
+    for(i=0; i<len-3; i+=4){
+        var = _mm_loadu_ps(&a_re[i]);
+        vai = _mm_loadu_ps(&a_im[i]);
+        if(!scalarB){
+            vbr = _mm_loadu_ps(&b_re[i]);
+            vbi = _mm_xor_ps(_mm_loadu_ps(&b_im[i]), sign);
+        }
+        vcr = _mm_sub_ps(_mm_mul_ps(var, vbr), _mm_mul_ps(vai, vbi));
+        vci = _mm_add_ps(_mm_mul_ps(var, vbi), _mm_mul_ps(vai, vbr));
+        if(accumulate){
+            vcr = _mm_add_ps(_mm_loadu_ps(&c_re[i]), vcr);
+            vci = _mm_add_ps(_mm_loadu_ps(&c_im[i]), vci);
+        }
+        _mm_storeu_ps(&c_re[i], vcr);
+        _mm_storeu_ps(&c_im[i], vci);
+    }
+    veclib_cvvmul_split_scalar(&a_re[i], &a_im[i], scalarB ? b_re : &b_re[i], scalarB ? b_im : &b_im[i],
+                               scalarB, conjB, accumulate, len-i, &c_re[i], &c_im[i]);
 }
 
-void utility_cvvmul
+/** c = c + a.*b; SSE2 version of veclib_cvvmac_scalar() */
+static void veclib_cvvmac_sse2
 (
-    float_complex* a,
+    const float_complex* a,
     const float_complex* b,
     const int len,
     float_complex* c
 )
 {
-#ifdef INTEL_MKL_VERSION
-    if (c == NULL) {
-        float_complex* tmp;
-        tmp = malloc1d(len * sizeof(float_complex));
-        vcMul(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
-        utility_cvvcopy(tmp, len, a);
-        free(tmp);
-    }
-    else
-        vcMul(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
-#else
-	int i;
-    if (c == NULL) {
-        for (i = 0; i < len; i++)
-            a[i] = ccmulf(a[i], b[i]);
-    }
-    else{
-        for (i = 0; i < len; i++)
-            c[i] = ccmulf(a[i], b[i]);
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    __m128 va, vb, vc, vb_re, vb_im, va_sw, sign;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    for(i=0; i<len-1; i+=2){
+        /* [cr ci] + [ar ai].*[br br] + [ai ar].*[-bi bi] */
+        va = _mm_loadu_ps(&pa[2*i]);
+        vb = _mm_loadu_ps(&pb[2*i]);
+        vb_re = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2,2,0,0));
+        vb_im = _mm_xor_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3,3,1,1)), sign);
+        va_sw = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2,3,0,1));
+        vc = _mm_add_ps(_mm_loadu_ps(&pc[2*i]), _mm_add_ps(_mm_mul_ps(va, vb_re), _mm_mul_ps(va_sw, vb_im)));
+        _mm_storeu_ps(&pc[2*i], vc);
     }
-#endif
+    veclib_cvvmac_scalar(&a[i], &b[i], len-i, &c[i]);
 }
+#endif /* SAF_VECLIB_SSE2 */
 
-
-/* ========================================================================== */
-/*                     Vector-Vector Dot Product (?vvdot)                     */
-/* ========================================================================== */
-
-void utility_svvdot
+#ifdef SAF_VECLIB_NEON
+/** c = a (op) b; NEON version of veclib_svvop_scalar() */
+static void veclib_svvop_neon
 (
+    VECLIB_OP op,
     const float* a,
     const float* b,
     const int len,
     float* c
 )
 {
-    c[0] = cblas_sdot (len, a, 1, b, 1);
+    int i;
+    float32x4_t va, vb;
+    for(i=0; i<len-3; i+=4){
+        va = vld1q_f32(&a[i]);
+        vb = vld1q_f32(&b[i]);
+        switch(op){
+            case VECLIB_ADD: va = vaddq_f32(va, vb); break;
+            case VECLIB_SUB: va = vsubq_f32(va, vb); break;
+            case VECLIB_MUL: va = vmulq_f32(va, vb); break;
+            case VECLIB_DIV: veclib_svvop_scalar(op, &a[i], &b[i], 4, &c[i]); continue; /* (no vdivq_f32 in ARMv7) */
+        }
+        vst1q_f32(&c[i], va);
+    }
+    veclib_svvop_scalar(op, &a[i], &b[i], len-i, &c[i]);
 }
 
-void utility_cvvdot
+/** c = a (op) s; NEON version of veclib_svsop_scalar() */
+static void veclib_svsop_neon
+(
+    VECLIB_OP op,
+    const float* a,
+    const float s,
+    const int len,
+    float* c
+)
+{
+    int i;
+    float32x4_t va, vs;
+    if(op==VECLIB_DIV){ /* (no vdivq_f32 in ARMv7) */
+        veclib_svsop_scalar(op, a, s, len, c);
+        return;
+    }
+    vs = vdupq_n_f32(s);
+    for(i=0; i<len-3; i+=4){
+        va = vld1q_f32(&a[i]);
+        switch(op){
+            case VECLIB_ADD: va = vaddq_f32(va, vs); break;
+            case VECLIB_SUB: va = vsubq_f32(va, vs); break;
+            case VECLIB_MUL: va = vmulq_f32(va, vs); break;
+            case VECLIB_DIV: break;
+        }
+        vst1q_f32(&c[i], va);
+    }
+    veclib_svsop_scalar(op, &a[i], s, len-i, &c[i]);
+}
+
+/** c = a.*b (or a.*b[0]); NEON version of veclib_cvvmul_scalar() */
+static void veclib_cvvmul_neon
 (
     const float_complex* a,
     const float_complex* b,
+    const int scalarB,
     const int len,
-    CONJ_FLAG flag,
     float_complex* c
 )
 {
-    switch(flag){
-        default:
-        case NO_CONJ:
-            cblas_cdotu_sub(len, a, 1, b, 1, c);
-            break;
-        case CONJ:
-            cblas_cdotc_sub(len, a, 1, b, 1, c);
-            break;
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    float32x4x2_t va, vb, vc;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    vb.val[0] = vdupq_n_f32(pb[0]);
+    vb.val[1] = vdupq_n_f32(pb[1]);
+    for(i=0; i<len-3; i+=4){
+        /* (de-interleaved into real and imaginary parts) */
+        va = vld2q_f32(&pa[2*i]);
+        if(!scalarB)
+            vb = vld2q_f32(&pb[2*i]);
+        vc.val[0] = vmlsq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        vc.val[1] = vmlaq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+        vst2q_f32(&pc[2*i], vc);
     }
+    veclib_cvvmul_scalar(&a[i], scalarB ? b : &b[i], scalarB, len-i, &c[i]);
 }
 
+/** Split-complex c = (c+) a.*b; NEON version of veclib_cvvmul_split_scalar() */
+static void veclib_cvvmul_split_neon
+(
+    const float* a_re,
+    const float* a_im,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
+    const int len,
+    float* c_re,
+    float* c_im
+)
+{
+    int i;
+    float32x4_t var, vai, vbr, vbi, vcr, vci;
+    vbr = vdupq_n_f32(b_re[0]);
+    vbi = vdupq_n_f32(conjB ? -b_im[0] : b_im[0]);
+    for(i=0; i<len-3; i+=4){
+        var = vld1q_f32(&a_re[i]);
+        vai = vld1q_f32(&a_im[i]);
+        if(!scalarB){
+            vbr = vld1q_f32(&b_re[i]);
+            vbi = vld1q_f32(&b_im[i]);
+            if(conjB)
+                vbi = vnegq_f32(vbi);
+        }
+        vcr = accumulate ? vld1q_f32(&c_re[i]) : vdupq_n_f32(0.0f);
+        vci = accumulate ? vld1q_f32(&c_im[i]) : vdupq_n_f32(0.0f);
+        vcr = vmlsq_f32(vmlaq_f32(vcr, var, vbr), vai, vbi);
+        vci = vmlaq_f32(vmlaq_f32(vci, var, vbi), vai, vbr);
+        vst1q_f32(&c_re[i], vcr);
+        vst1q_f32(&c_im[i], vci);
+    }
+    veclib_cvvmul_split_scalar(&a_re[i], &a_im[i], scalarB ? b_re : &b_re[i], scalarB ? b_im : &b_im[i],
+                               scalarB, conjB, accumulate, len-i, &c_re[i], &c_im[i]);
+}
 
-/* ========================================================================== */
-/*                       Vector-Scalar Product (?vsmul)                       */
-/* ========================================================================== */
+/** c = c + a.*b; NEON version of veclib_cvvmac_scalar() */
+static void veclib_cvvmac_neon
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int len,
+    float_complex* c
+)
+{
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    float32x4x2_t va, vb, vc;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    for(i=0; i<len-3; i+=4){
+        va = vld2q_f32(&pa[2*i]);
+        vb = vld2q_f32(&pb[2*i]);
+        vc = vld2q_f32(&pc[2*i]);
+        vc.val[0] = vmlsq_f32(vmlaq_f32(vc.val[0], va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        vc.val[1] = vmlaq_f32(vmlaq_f32(vc.val[1], va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+        vst2q_f32(&pc[2*i], vc);
+    }
+    veclib_cvvmac_scalar(&a[i], &b[i], len-i, &c[i]);
+}
+#endif /* SAF_VECLIB_NEON */
 
-void utility_svsmul
+#ifdef SAF_VECLIB_WASM_SIMD128
+/** c = a (op) b; WebAssembly SIMD128 version of veclib_svvop_scalar() */
+static void veclib_svvop_wasm
 (
-    float* a,
-    const float* s,
+    VECLIB_OP op,
+    const float* a,
+    const float* b,
     const int len,
     float* c
 )
 {
-#ifdef __ACCELERATE__
-    if(c==NULL)
-        cblas_sscal(len, s[0], a, 1);
-    else
-        vDSP_vsmul(a, 1, s, c, 1, len);
-#else
-    if (c == NULL)
-        cblas_sscal(len, s[0], a, 1);
-    else {
-        utility_svvcopy(a, len, c); 
-        cblas_sscal(len, s[0], c, 1);
+    int i;
+    v128_t va, vb;
+    for(i=0; i<len-3; i+=4){
+        va = wasm_v128_load(&a[i]);
+        vb = wasm_v128_load(&b[i]);
+        switch(op){
+            case VECLIB_ADD: va = wasm_f32x4_add(va, vb); break;
+            case VECLIB_SUB: va = wasm_f32x4_sub(va, vb); break;
+            case VECLIB_MUL: va = wasm_f32x4_mul(va, vb); break;
+            case VECLIB_DIV: va = wasm_f32x4_div(va, vb); break;
+        }
+        wasm_v128_store(&c[i], va);
     }
-#endif
+    veclib_svvop_scalar(op, &a[i], &b[i], len-i, &c[i]);
 }
 
-void utility_cvsmul
+/** c = a (op) s; WebAssembly SIMD128 version of veclib_svsop_scalar() */
+static void veclib_svsop_wasm
 (
-    float_complex* a,
-    const float_complex* s,
+    VECLIB_OP op,
+    const float* a,
+    const float s,
+    const int len,
+    float* c
+)
+{
+    int i;
+    v128_t va, vs;
+    vs = wasm_f32x4_splat(s);
+    for(i=0; i<len-3; i+=4){
+        va = wasm_v128_load(&a[i]);
+        switch(op){
+            case VECLIB_ADD: va = wasm_f32x4_add(va, vs); break;
+            case VECLIB_SUB: va = wasm_f32x4_sub(va, vs); break;
+            case VECLIB_MUL: va = wasm_f32x4_mul(va, vs); break;
+            case VECLIB_DIV: va = wasm_f32x4_div(va, vs); break;
+        }
+        wasm_v128_store(&c[i], va);
+    }
+    veclib_svsop_scalar(op, &a[i], s, len-i, &c[i]);
+}
+
+/** c = a.*b (or a.*b[0]); WebAssembly SIMD128 version of veclib_cvvmul_scalar() */
+static void veclib_cvvmul_wasm
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int scalarB,
     const int len,
     float_complex* c
 )
 {
-    if (c == NULL)
-        cblas_cscal(len, s, a, 1);
-    else {
-        int i;
-        for (i = 0; i<len; i++)
-            c[i] = ccmulf(a[i], s[0]);
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    v128_t va, vb, vb_re, vb_im, sign;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    sign = wasm_f32x4_make(-0.0f, 0.0f, -0.0f, 0.0f);
+    vb = wasm_f32x4_make(pb[0], pb[1], pb[0], pb[1]);
+    for(i=0; i<len-1; i+=2){
+        /* [ar ai] x [br bi] = [ar*br - ai*bi, ai*br + ar*bi] */
+        va = wasm_v128_load(&pa[2*i]);
+        if(!scalarB)
+            vb = wasm_v128_load(&pb[2*i]);
+        vb_re = wasm_i32x4_shuffle(vb, vb, 0, 0, 2, 2);
+        vb_im = wasm_v128_xor(wasm_i32x4_shuffle(vb, vb, 1, 1, 3, 3), sign);
+        wasm_v128_store(&pc[2*i], wasm_f32x4_add(wasm_f32x4_mul(va, vb_re),
+                                                 wasm_f32x4_mul(wasm_i32x4_shuffle(va, va, 1, 0, 3, 2), vb_im)));
     }
+    veclib_cvvmul_scalar(&a[i], scalarB ? b : &b[i], scalarB, len-i, &c[i]);
 }
 
+/** Split-complex c = (c+) a.*b; WebAssembly SIMD128 version of veclib_cvvmul_split_scalar() */
+static void veclib_cvvmul_split_wasm
+(
+    const float* a_re,
+    const float* a_im,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
+    const int len,
+    float* c_re,
+    float* c_im
+)
+{
+    int i;
+    v128_t var, vai, vbr, vbi, vcr, vci;
+    vbr = wasm_f32x4_splat(b_re[0]);
+    vbi = wasm_f32x4_splat(conjB ? -b_im[0] : b_im[0]);
+    for(i=0; i<len-3; i+=4){
+        var = wasm_v128_load(&a_re[i]);
+        vai = wasm_v128_load(&a_im[i]);
+        if(!scalarB){
+            vbr = wasm_v128_load(&b_re[i]);
+            vbi = wasm_v128_load(&b_im[i]);
+            if(conjB)
+                vbi = wasm_f32x4_neg(vbi);
+        }
+        vcr = wasm_f32x4_sub(wasm_f32x4_mul(var, vbr), wasm_f32x4_mul(vai, vbi));
+        vci = wasm_f32x4_add(wasm_f32x4_mul(var, vbi), wasm_f32x4_mul(vai, vbr));
+        if(accumulate){
+            vcr = wasm_f32x4_add(wasm_v128_load(&c_re[i]), vcr);
+            vci = wasm_f32x4_add(wasm_v128_load(&c_im[i]), vci);
+        }
+        wasm_v128_store(&c_re[i], vcr);
+        wasm_v128_store(&c_im[i], vci);
+    }
+    veclib_cvvmul_split_scalar(&a_re[i], &a_im[i], scalarB ? b_re : &b_re[i], scalarB ? b_im : &b_im[i],
+                               scalarB, conjB, accumulate, len-i, &c_re[i], &c_im[i]);
+}
 
-/* ========================================================================== */
-/*                       Vector-Scalar Division (?vsdiv)                      */
-/* ========================================================================== */
+/** c = c + a.*b; WebAssembly SIMD128 version of veclib_cvvmac_scalar() */
+static void veclib_cvvmac_wasm
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int len,
+    float_complex* c
+)
+{
+    int i;
+    const float* pa, *pb;
+    float* pc;
+    v128_t va0, va1, vb0, vb1, var, vai, vbr, vbi, vcr, vci;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    pc = (float*)c;
+    for(i=0; i<len-3; i+=4){
+        /* (de-interleaved into real and imaginary parts, and back) */
+        va0 = wasm_v128_load(&pa[2*i]);
+        va1 = wasm_v128_load(&pa[2*i+4]);
+        vb0 = wasm_v128_load(&pb[2*i]);
+        vb1 = wasm_v128_load(&pb[2*i+4]);
+        var = wasm_i32x4_shuffle(va0, va1, 0, 2, 4, 6);
+        vai = wasm_i32x4_shuffle(va0, va1, 1, 3, 5, 7);
+        vbr = wasm_i32x4_shuffle(vb0, vb1, 0, 2, 4, 6);
+        vbi = wasm_i32x4_shuffle(vb0, vb1, 1, 3, 5, 7);
+        vcr = wasm_f32x4_sub(wasm_f32x4_mul(var, vbr), wasm_f32x4_mul(vai, vbi));
+        vci = wasm_f32x4_add(wasm_f32x4_mul(var, vbi), wasm_f32x4_mul(vai, vbr));
+        wasm_v128_store(&pc[2*i],   wasm_f32x4_add(wasm_v128_load(&pc[2*i]),   wasm_i32x4_shuffle(vcr, vci, 0, 4, 1, 5)));
+        wasm_v128_store(&pc[2*i+4], wasm_f32x4_add(wasm_v128_load(&pc[2*i+4]), wasm_i32x4_shuffle(vcr, vci, 2, 6, 3, 7)));
+    }
+    veclib_cvvmac_scalar(&a[i], &b[i], len-i, &c[i]);
+}
+#endif /* SAF_VECLIB_WASM_SIMD128 */
 
-void utility_svsdiv
+#if !defined(INTEL_MKL_VERSION)
+/** c = a (op) b, for vectors 'a' and 'b' (dispatched to the best kernel) */
+static void veclib_svvop
 (
-    float* a,
-    const float* s,
+    VECLIB_OP op,
+    const float* a,
+    const float* b,
     const int len,
     float* c
 )
 {
-    if(s[0] == 0.0f){
-        memset(c, 0, len*sizeof(float));
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2()){
+        veclib_svvop_avx2(op, a, b, len, c);
         return;
     }
-#ifdef __ACCELERATE__
-    vDSP_vsdiv(a, 1, s, c, 1, len);
+#endif
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svvop_sse2(op, a, b, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svvop_neon(op, a, b, len, c);
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    veclib_svvop_wasm(op, a, b, len, c);
 #else
-    int i;
-    for(i=0; i<len; i++)
-        c[i] = a[i] / s[0];
+    veclib_svvop_scalar(op, a, b, len, c);
 #endif
 }
+#endif /* !INTEL_MKL_VERSION */
 
-
-/* ========================================================================== */
-/*                       Vector-Scalar Addition (?vsadd)                      */
-/* ========================================================================== */
-
-void utility_svsadd
+/** c = a (op) s, for vector 'a' and scalar 's' (dispatched to the best kernel) */
+static void veclib_svsop
 (
-    float* a,
-    const float* s,
+    VECLIB_OP op,
+    const float* a,
+    const float s,
     const int len,
     float* c
 )
 {
-#ifdef __ACCELERATE__
-    vDSP_vsadd(a, 1, s, c, 1, len);
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2()){
+        veclib_svsop_avx2(op, a, s, len, c);
+        return;
+    }
+#endif
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svsop_sse2(op, a, s, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svsop_neon(op, a, s, len, c);
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    veclib_svsop_wasm(op, a, s, len, c);
 #else
-    int i;
-    for(i=0; i<len; i++)
-        c[i] = a[i] + s[0];
+    veclib_svsop_scalar(op, a, s, len, c);
 #endif
 }
 
+/**
+ * c = a.*b, for complex vectors 'a' and 'b'; or c = a.*b[0], if 'scalarB'
+ * (dispatched to the best kernel)
+ */
+static void veclib_cvvmul
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int scalarB,
+    const int len,
+    float_complex* c
+)
+{
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2()){
+        veclib_cvvmul_avx2(a, b, scalarB, len, c);
+        return;
+    }
+#endif
+#if defined(SAF_VECLIB_SSE2)
+    veclib_cvvmul_sse2(a, b, scalarB, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_cvvmul_neon(a, b, scalarB, len, c);
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    veclib_cvvmul_wasm(a, b, scalarB, len, c);
+#else
+    veclib_cvvmul_scalar(a, b, scalarB, len, c);
+#endif
+}
 
-/* ========================================================================== */
-/*                     Vector-Scalar Subtraction (?vssub)                     */
-/* ========================================================================== */
-
-void utility_svssub
+/**
+ * c = a.*b, for split-complex vectors 'a' and 'b'; or c = a.*b[0], if
+ * 'scalarB'. 'b' is conjugated if 'conjB', and the products are added to 'c'
+ * if 'accumulate' (dispatched to the best kernel)
+ */
+static void veclib_cvvmul_split
 (
-    float* a,
-    const float* s,
+    const float_complex_split* a,
+    const float* b_re,
+    const float* b_im,
+    const int scalarB,
+    const int conjB,
+    const int accumulate,
     const int len,
-    float* c
+    float_complex_split* c
 )
 {
-    int i;
-    for(i=0; i<len; i++)
-        c[i] = a[i] - s[0];
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2()){
+        veclib_cvvmul_split_avx2(a->re, a->im, b_re, b_im, scalarB, conjB, accumulate, len, c->re, c->im);
+        return;
+    }
+#endif
+#if defined(SAF_VECLIB_SSE2)
+    veclib_cvvmul_split_sse2(a->re, a->im, b_re, b_im, scalarB, conjB, accumulate, len, c->re, c->im);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_cvvmul_split_neon(a->re, a->im, b_re, b_im, scalarB, conjB, accumulate, len, c->re, c->im);
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    veclib_cvvmul_split_wasm(a->re, a->im, b_re, b_im, scalarB, conjB, accumulate, len, c->re, c->im);
+#else
+    veclib_cvvmul_split_scalar(a->re, a->im, b_re, b_im, scalarB, conjB, accumulate, len, c->re, c->im);
+#endif
+}
+
+/** Signature of the veclib_cvvmac_* kernels */
+typedef void (*veclib_cvvmac_kernel)(const float_complex*, const float_complex*, const int, float_complex*);
+
+/** Returns the best c = c + a.*b kernel (complex vectors 'a' and 'b') */
+static veclib_cvvmac_kernel veclib_cvvmac_select(void)
+{
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2())
+        return veclib_cvvmac_avx2;
+#endif
+#if defined(SAF_VECLIB_SSE2)
+    return veclib_cvvmac_sse2;
+#elif defined(SAF_VECLIB_NEON)
+    return veclib_cvvmac_neon;
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    return veclib_cvvmac_wasm;
+#else
+    return veclib_cvvmac_scalar;
+#endif
 }
 
 
 /* ========================================================================== */
-/*                     Singular-Value Decomposition (?svd)                    */
+/*                     Find Index of Min-Abs-Value (?iminv)                   */
 /* ========================================================================== */
 
-void utility_ssvd
+void utility_siminv
 (
-    const float* A,
-    const int dim1,
-    const int dim2,
-    float* U,
-    float* S,
-    float* V,
-    float* sing
+    const float* a,
+    const int len,
+    int* index
 )
 {
-    int i, j, m, n, lda, ldu, ldvt, info;
-    m = dim1; n = dim2; lda = dim1; ldu = dim1; ldvt = dim2;
-    float* a, *s, *u, *vt;
-#ifdef VECLIB_USE_LAPACK_FORTRAN_INTERFACE
-    int lwork;
-    float wkopt;
-    float *work;
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    float* superb;
-#endif
-    
-    a = malloc1d(lda*n*sizeof(float));
-    s = malloc1d(MIN(n,m)*sizeof(float));
-    u = malloc1d(ldu*m*sizeof(float));
-    vt = malloc1d(ldvt*n*sizeof(float));
-    
-    /* store in column major order */
-    for(i=0; i<dim1; i++)
-        for(j=0; j<dim2; j++)
-            a[j*dim1+i] = A[i*dim2 +j];
-    
-    /* perform the singular value decomposition */
-#ifdef VECLIB_USE_CLAPACK_INTERFACE
-    /* no such implementation in altas-clapack */
-    assert(0);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(float));
-    info = LAPACKE_sgesvd(CblasColMajor, 'A', 'A', m, n, a, lda, s, u, ldu, vt, ldvt, superb);
-    free(superb);
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = -1;
-    sgesvd_( "A", "A", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, &wkopt, &lwork, &info );
-    lwork = (int)wkopt;
-    work = malloc1d( lwork*sizeof(float) );
-    sgesvd_( "A", "A", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, work, &lwork, &info );
-    free(work);
-#endif
+#if defined(__ACCELERATE__)
+    float minVal;
+    vDSP_Length ind_tmp;
+    vDSP_minvi(a, 1, &minVal, &ind_tmp, len);
+    *index = (int)ind_tmp; 
+#elif defined(INTEL_MKL_VERSION)
+    *index = (int)cblas_isamin(len, a, 1);
+#else
+    int i;
+    *index = 0;
+    float minVal=FLT_MAX;
+    for(i=0; i<len; i++){
+        if(fabsf(a[i])<minVal){
+            minVal = fabsf(a[i]);
+            *index = i;
+        } 
+    }
+#endif
+}
+
+void utility_ciminv
+(
+    const float_complex* a,
+    const int len,
+    int* index
+)
+{
+#if defined(__ACCELERATE__)
+    int i;
+    float* abs_a;
+    float minVal;
+    abs_a = malloc1d(len*sizeof(float));
+    for(i=0; i<len; i++)
+        abs_a[i] = cabsf(a[i]);
+    vDSP_Length ind_tmp;
+    vDSP_minvi(abs_a, 1, &minVal, &ind_tmp, len);
+    *index = (int)ind_tmp;
+    free(abs_a);
+#elif defined(INTEL_MKL_VERSION)
+    *index = (int)cblas_icamin(len, a, 1);
+#else
+    int i;
+    *index = 0;
+    float minVal=FLT_MAX;
+    for(i=0; i<len; i++){
+        if(cabsf(a[i])<minVal){
+            minVal = cabsf(a[i]);
+            *index = i;
+        } 
+    }
+#endif
+}
+
+
+/* ========================================================================== */
+/*                     Find Index of Max-Abs-Value (?imaxv)                   */
+/* ========================================================================== */
+
+void utility_simaxv
+(
+    const float* a,
+    const int len,
+    int* index
+)
+{
+    *index = (int)cblas_isamax(len, a, 1);
+}
+
+void utility_cimaxv
+(
+    const float_complex* a,
+    const int len,
+    int* index
+)
+{
+    *index = (int)cblas_icamax(len, a, 1);
+}
+
+
+/* ========================================================================== */
+/*                              Vector-Abs (?vabs)                            */
+/* ========================================================================== */
+
+void utility_svabs
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+#ifdef INTEL_MKL_VERSION
+    vsAbs(len, a, c);
+#else
+    int i;
+    for(i=0; i<len; i++)
+        c[i] = fabsf(a[i]);
+#endif
+}
+
+void utility_cvabs
+(
+    const float_complex* a,
+    const int len,
+    float* c
+)
+{
+#ifdef INTEL_MKL_VERSION
+    vcAbs(len, (MKL_Complex8*)a, c);
+#else
+    int i;
+    for(i=0; i<len; i++)
+        c[i] = cabsf(a[i]);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                            Vector-Atan2 (?vatan2)                          */
+/* ========================================================================== */
+
+void utility_svatan2
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+#if defined(__ACCELERATE__)
+    vvatan2f(c, a, b, &len);
+#elif defined(INTEL_MKL_VERSION)
+    vsAtan2(len, a, b, c);
+#else
+    int i;
+    for(i=0; i<len; i++)
+        c[i] = atan2f(a[i], b[i]);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                   Approximate Vector-Log2/Exp2 (?vlog2/?vexp2)             */
+/* ========================================================================== */
+
+/*
+ * log2(x) = e + log2(m), with x = m*2^e, and m in [sqrt(0.5), sqrt(2)); where
+ * log2(m) = 2/ln(2) * atanh(t), t = (m-1)/(m+1) (|t| < 0.172), is evaluated up
+ * to the t^7 term. 2^x = 2^n * sqrt(2) * exp(g*ln(2)), with n = floor(x) and
+ * g = x-n-0.5 (|g*ln(2)| < 0.347), where exp() is evaluated up to the 6th
+ * order term. The SIMD kernels evaluate the exact same expressions.
+ */
+#define VECLIB_LOG2_C1 ( 2.885390082f )   /* 2/ln(2) */
+#define VECLIB_EXP2_LN2 ( 0.693147181f )  /* ln(2) */
+#define VECLIB_SQRT2 ( 1.414213562f )
+
+/** Plain loop version of utility_svlog2approx() */
+static void veclib_svlog2approx_scalar
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    union { float f; int i; } u;
+    float e, m, t, t2;
+    for(i=0; i<len; i++){
+        u.f = a[i];
+        e = (float)(((u.i >> 23) & 0xFF) - 127);
+        u.i = (u.i & 0x007FFFFF) | 0x3F800000;
+        m = u.f;
+        if(m > VECLIB_SQRT2){
+            m *= 0.5f;
+            e += 1.0f;
+        }
+        t = (m - 1.0f) / (m + 1.0f);
+        t2 = t*t;
+        c[i] = e + VECLIB_LOG2_C1 * t * (1.0f + t2*(1.0f/3.0f + t2*(1.0f/5.0f + t2*(1.0f/7.0f))));
+    }
+}
+
+/** Plain loop version of utility_svexp2approx() */
+static void veclib_svexp2approx_scalar
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i, n;
+    union { float f; int i; } u;
+    float x, y;
+    for(i=0; i<len; i++){
+        x = a[i] < -126.0f ? -126.0f : (a[i] > 126.0f ? 126.0f : a[i]);
+        n = (int)x;
+        n -= (float)n > x ? 1 : 0; /* floor */
+        y = (x - (float)n - 0.5f) * VECLIB_EXP2_LN2;
+        u.i = (n + 127) << 23;
+        c[i] = u.f * VECLIB_SQRT2 * (1.0f + y*(1.0f + y*(0.5f + y*(1.0f/6.0f + y*(1.0f/24.0f + y*(1.0f/120.0f + y*(1.0f/720.0f)))))));
+    }
+}
+
+#if defined(SAF_VECLIB_SSE2)
+/** SSE2 version of veclib_svlog2approx_scalar() */
+static void veclib_svlog2approx_sse2
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    __m128i ui;
+    __m128 e, m, t, t2, big, p;
+    for(i=0; i<len-3; i+=4){
+        ui = _mm_castps_si128(_mm_loadu_ps(&a[i]));
+        e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(ui, 23), _mm_set1_epi32(0xFF)), _mm_set1_epi32(127)));
+        m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(ui, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+        big = _mm_cmpgt_ps(m, _mm_set1_ps(VECLIB_SQRT2));
+        m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+        e = _mm_add_ps(e, _mm_and_ps(big, _mm_set1_ps(1.0f)));
+        t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+        t2 = _mm_mul_ps(t, t);
+        p = _mm_add_ps(_mm_set1_ps(1.0f/5.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f/7.0f)));
+        p = _mm_add_ps(_mm_set1_ps(1.0f/3.0f), _mm_mul_ps(t2, p));
+        p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t2, p));
+        _mm_storeu_ps(&c[i], _mm_add_ps(e, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(VECLIB_LOG2_C1), t), p)));
+    }
+    veclib_svlog2approx_scalar(&a[i], len-i, &c[i]);
+}
+
+/** SSE2 version of veclib_svexp2approx_scalar() */
+static void veclib_svexp2approx_sse2
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    __m128i n;
+    __m128 x, nf, y, p;
+    for(i=0; i<len-3; i+=4){
+        x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&a[i]), _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+        n = _mm_cvttps_epi32(x);
+        n = _mm_add_epi32(n, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(n), x))); /* floor (the mask is -1) */
+        nf = _mm_cvtepi32_ps(n);
+        y = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(x, nf), _mm_set1_ps(0.5f)), _mm_set1_ps(VECLIB_EXP2_LN2));
+        p = _mm_add_ps(_mm_set1_ps(1.0f/120.0f), _mm_mul_ps(y, _mm_set1_ps(1.0f/720.0f)));
+        p = _mm_add_ps(_mm_set1_ps(1.0f/24.0f), _mm_mul_ps(y, p));
+        p = _mm_add_ps(_mm_set1_ps(1.0f/6.0f), _mm_mul_ps(y, p));
+        p = _mm_add_ps(_mm_set1_ps(0.5f), _mm_mul_ps(y, p));
+        p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y, p));
+        p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y, p));
+        x = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+        _mm_storeu_ps(&c[i], _mm_mul_ps(_mm_mul_ps(x, _mm_set1_ps(VECLIB_SQRT2)), p));
+    }
+    veclib_svexp2approx_scalar(&a[i], len-i, &c[i]);
+}
+#elif defined(SAF_VECLIB_NEON)
+/** NEON version of veclib_svlog2approx_scalar() */
+static void veclib_svlog2approx_neon
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    int32x4_t ui;
+    uint32x4_t big;
+    float32x4_t e, m, t, t2, p, den;
+    for(i=0; i<len-3; i+=4){
+        ui = vreinterpretq_s32_f32(vld1q_f32(&a[i]));
+        e = vcvtq_f32_s32(vsubq_s32(vandq_s32(vshrq_n_s32(ui, 23), vdupq_n_s32(0xFF)), vdupq_n_s32(127)));
+        m = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(ui, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3F800000)));
+        big = vcgtq_f32(m, vdupq_n_f32(VECLIB_SQRT2));
+        m = vbslq_f32(big, vmulq_f32(m, vdupq_n_f32(0.5f)), m);
+        e = vbslq_f32(big, vaddq_f32(e, vdupq_n_f32(1.0f)), e);
+        /* (no vdivq_f32 in ARMv7; two Newton-Raphson steps on the reciprocal) */
+        den = vaddq_f32(m, vdupq_n_f32(1.0f));
+        t = vrecpeq_f32(den);
+        t = vmulq_f32(vrecpsq_f32(den, t), t);
+        t = vmulq_f32(vrecpsq_f32(den, t), t);
+        t = vmulq_f32(vsubq_f32(m, vdupq_n_f32(1.0f)), t);
+        t2 = vmulq_f32(t, t);
+        p = vmlaq_f32(vdupq_n_f32(1.0f/5.0f), t2, vdupq_n_f32(1.0f/7.0f));
+        p = vmlaq_f32(vdupq_n_f32(1.0f/3.0f), t2, p);
+        p = vmlaq_f32(vdupq_n_f32(1.0f), t2, p);
+        vst1q_f32(&c[i], vmlaq_f32(e, vmulq_f32(vdupq_n_f32(VECLIB_LOG2_C1), t), p));
+    }
+    veclib_svlog2approx_scalar(&a[i], len-i, &c[i]);
+}
+
+/** NEON version of veclib_svexp2approx_scalar() */
+static void veclib_svexp2approx_neon
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    int32x4_t n;
+    float32x4_t x, nf, y, p;
+    for(i=0; i<len-3; i+=4){
+        x = vminq_f32(vmaxq_f32(vld1q_f32(&a[i]), vdupq_n_f32(-126.0f)), vdupq_n_f32(126.0f));
+        n = vcvtq_s32_f32(x);
+        n = vaddq_s32(n, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(n), x))); /* floor (the mask is -1) */
+        nf = vcvtq_f32_s32(n);
+        y = vmulq_f32(vsubq_f32(vsubq_f32(x, nf), vdupq_n_f32(0.5f)), vdupq_n_f32(VECLIB_EXP2_LN2));
+        p = vmlaq_f32(vdupq_n_f32(1.0f/120.0f), y, vdupq_n_f32(1.0f/720.0f));
+        p = vmlaq_f32(vdupq_n_f32(1.0f/24.0f), y, p);
+        p = vmlaq_f32(vdupq_n_f32(1.0f/6.0f), y, p);
+        p = vmlaq_f32(vdupq_n_f32(0.5f), y, p);
+        p = vmlaq_f32(vdupq_n_f32(1.0f), y, p);
+        p = vmlaq_f32(vdupq_n_f32(1.0f), y, p);
+        x = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23));
+        vst1q_f32(&c[i], vmulq_f32(vmulq_f32(x, vdupq_n_f32(VECLIB_SQRT2)), p));
+    }
+    veclib_svexp2approx_scalar(&a[i], len-i, &c[i]);
+}
+#endif
+
+void utility_svlog2approx
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svlog2approx_sse2(a, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svlog2approx_neon(a, len, c);
+#else
+    veclib_svlog2approx_scalar(a, len, c);
+#endif
+}
+
+void utility_svexp2approx
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svexp2approx_sse2(a, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svexp2approx_neon(a, len, c);
+#else
+    veclib_svexp2approx_scalar(a, len, c);
+#endif
+}
+
+
+/* ========================================================================== */
+/*        Approximate Vector-SinCos/Atan2/Exp/Log/Pow (?vsincos/?vatan2...)   */
+/* ========================================================================== */
+
+/*
+ * sin/cos: x is reduced to r = x - n*pi/2 (|r| <= pi/4), with n = round(2x/pi)
+ * and pi/2 split into four parts (Cody-Waite). The first three hold 8 bits each,
+ * such that n*PIO2_1..3 are exact for |n| < 2^16 (|x| < ~1e5); and the small
+ * n*PIO2_3 + n*PIO2_4 term is subtracted last, in a single rounding (with three
+ * parts, n*PIO2_2 is inexact, and the error grows with n to ~1e-6 at 1e5).
+ * sin(r) and cos(r) are then evaluated with the minimax polynomials
+ * of the Cephes library, and swapped/negated depending on the quadrant (n&3).
+ * atan2: the ratio t = min(|a|,|b|)/max(|a|,|b|) (in [0,1]) is reduced to
+ * [0, tan(pi/8)] with atan(t) = pi/4 + atan((t-1)/(t+1)), and atan() is again
+ * evaluated with the Cephes polynomial, before the octant is restored.
+ * exp/log/pow are built on utility_svexp2approx() and utility_svlog2approx().
+ */
+#define VECLIB_2OPI ( 0.636619772f )                  /* 2/pi */
+#define VECLIB_PIO2_1 ( 1.5703125f )                  /* pi/2 = PIO2_1 + PIO2_2 + PIO2_3 + PIO2_4 */
+#define VECLIB_PIO2_2 ( 4.825592041015625e-4f )
+#define VECLIB_PIO2_3 ( 1.2665987014770508e-6f )
+#define VECLIB_PIO2_4 ( 9.92093629470503e-10f )
+#define VECLIB_SIN_S1 ( -1.6666654611e-1f )
+#define VECLIB_SIN_S2 ( 8.3321608736e-3f )
+#define VECLIB_SIN_S3 ( -1.9515295891e-4f )
+#define VECLIB_COS_C1 ( 4.166664568298827e-2f )
+#define VECLIB_COS_C2 ( -1.388731625493765e-3f )
+#define VECLIB_COS_C3 ( 2.443315711809948e-5f )
+#define VECLIB_TANPIO8 ( 0.414213562f )               /* tan(pi/8) */
+#define VECLIB_ATAN_A1 ( -3.33329491539e-1f )
+#define VECLIB_ATAN_A2 ( 1.99777106478e-1f )
+#define VECLIB_ATAN_A3 ( -1.38776856032e-1f )
+#define VECLIB_ATAN_A4 ( 8.05374449538e-2f )
+#define VECLIB_PIO4 ( 0.785398163f )
+#define VECLIB_PIO2 ( 1.570796327f )
+#define VECLIB_PI ( 3.141592654f )
+#define VECLIB_LOG2E ( 1.442695041f )                 /* 1/ln(2) */
+#define VECLIB_APPROX_BLOCK ( 64 )                    /* block size of the composite functions */
+
+/** Plain loop version of utility_svsincosapprox() */
+static void veclib_svsincosapprox_scalar
+(
+    const float* a,
+    const int len,
+    float* s,
+    float* c
+)
+{
+    int i, n;
+    float x, q, r, r2, sr, cr;
+    for(i=0; i<len; i++){
+        x = a[i];
+        q = x * VECLIB_2OPI;
+        n = (int)(q + (q < 0.0f ? -0.5f : 0.5f)); /* round */
+        r = ((x - (float)n*VECLIB_PIO2_1) - (float)n*VECLIB_PIO2_2) - ((float)n*VECLIB_PIO2_3 + (float)n*VECLIB_PIO2_4);
+        r2 = r*r;
+        sr = r + r*r2*(VECLIB_SIN_S1 + r2*(VECLIB_SIN_S2 + r2*VECLIB_SIN_S3));
+        cr = 1.0f - 0.5f*r2 + r2*r2*(VECLIB_COS_C1 + r2*(VECLIB_COS_C2 + r2*VECLIB_COS_C3));
+        s[i] = n & 1 ? cr : sr;
+        c[i] = n & 1 ? sr : cr;
+        if(n & 2)       s[i] = -s[i];
+        if((n + 1) & 2) c[i] = -c[i];
+    }
+}
+
+/** Plain loop version of utility_svatan2approx() */
+static void veclib_svatan2approx_scalar
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+    int i;
+    float ay, ax, t, z, base, r;
+    for(i=0; i<len; i++){
+        ay = fabsf(a[i]);
+        ax = fabsf(b[i]);
+        t = (ay < ax ? ay : ax) / (ay < ax ? (ax > FLT_MIN ? ax : FLT_MIN) : (ay > FLT_MIN ? ay : FLT_MIN));
+        base = 0.0f;
+        if(t > VECLIB_TANPIO8){
+            t = (t - 1.0f) / (t + 1.0f);
+            base = VECLIB_PIO4;
+        }
+        z = t*t;
+        r = base + t + t*z*(VECLIB_ATAN_A1 + z*(VECLIB_ATAN_A2 + z*(VECLIB_ATAN_A3 + z*VECLIB_ATAN_A4)));
+        if(ay > ax)     r = VECLIB_PIO2 - r;
+        if(b[i] < 0.0f) r = VECLIB_PI - r;
+        c[i] = a[i] < 0.0f ? -r : r;
+    }
+}
+
+#if defined(SAF_VECLIB_SSE2)
+/** SSE2 version of veclib_svsincosapprox_scalar() */
+static void veclib_svsincosapprox_sse2
+(
+    const float* a,
+    const int len,
+    float* s,
+    float* c
+)
+{
+    int i;
+    __m128i n, swap;
+    __m128 x, q, nf, r, r2, sr, cr, half;
+    for(i=0; i<len-3; i+=4){
+        x = _mm_loadu_ps(&a[i]);
+        q = _mm_mul_ps(x, _mm_set1_ps(VECLIB_2OPI));
+        half = _mm_or_ps(_mm_and_ps(q, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f)); /* (0.5 with the sign of q) */
+        n = _mm_cvttps_epi32(_mm_add_ps(q, half));
+        nf = _mm_cvtepi32_ps(n);
+        r = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(VECLIB_PIO2_1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(nf, _mm_set1_ps(VECLIB_PIO2_2)));
+        r = _mm_sub_ps(r, _mm_add_ps(_mm_mul_ps(nf, _mm_set1_ps(VECLIB_PIO2_3)), _mm_mul_ps(nf, _mm_set1_ps(VECLIB_PIO2_4))));
+        r2 = _mm_mul_ps(r, r);
+        sr = _mm_add_ps(_mm_set1_ps(VECLIB_SIN_S2), _mm_mul_ps(r2, _mm_set1_ps(VECLIB_SIN_S3)));
+        sr = _mm_add_ps(_mm_set1_ps(VECLIB_SIN_S1), _mm_mul_ps(r2, sr));
+        sr = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sr));
+        cr = _mm_add_ps(_mm_set1_ps(VECLIB_COS_C2), _mm_mul_ps(r2, _mm_set1_ps(VECLIB_COS_C3)));
+        cr = _mm_add_ps(_mm_set1_ps(VECLIB_COS_C1), _mm_mul_ps(r2, cr));
+        cr = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), cr));
+        swap = _mm_cmpeq_epi32(_mm_and_si128(n, _mm_set1_epi32(1)), _mm_set1_epi32(1));
+        x = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(swap), cr), _mm_andnot_ps(_mm_castsi128_ps(swap), sr));
+        q = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(swap), sr), _mm_andnot_ps(_mm_castsi128_ps(swap), cr));
+        x = _mm_xor_ps(x, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(2)), 30)));
+        q = _mm_xor_ps(q, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(n, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30)));
+        _mm_storeu_ps(&s[i], x);
+        _mm_storeu_ps(&c[i], q);
+    }
+    veclib_svsincosapprox_scalar(&a[i], len-i, &s[i], &c[i]);
+}
+
+/** SSE2 version of veclib_svatan2approx_scalar() */
+static void veclib_svatan2approx_sse2
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+    int i;
+    __m128 y, x, ay, ax, t, z, big, base, r, absMask;
+    absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for(i=0; i<len-3; i+=4){
+        y = _mm_loadu_ps(&a[i]);
+        x = _mm_loadu_ps(&b[i]);
+        ay = _mm_and_ps(y, absMask);
+        ax = _mm_and_ps(x, absMask);
+        t = _mm_div_ps(_mm_min_ps(ay, ax), _mm_max_ps(_mm_max_ps(ay, ax), _mm_set1_ps(FLT_MIN)));
+        big = _mm_cmpgt_ps(t, _mm_set1_ps(VECLIB_TANPIO8));
+        t = _mm_or_ps(_mm_and_ps(big, _mm_div_ps(_mm_sub_ps(t, _mm_set1_ps(1.0f)), _mm_add_ps(t, _mm_set1_ps(1.0f)))), _mm_andnot_ps(big, t));
+        base = _mm_and_ps(big, _mm_set1_ps(VECLIB_PIO4));
+        z = _mm_mul_ps(t, t);
+        r = _mm_add_ps(_mm_set1_ps(VECLIB_ATAN_A3), _mm_mul_ps(z, _mm_set1_ps(VECLIB_ATAN_A4)));
+        r = _mm_add_ps(_mm_set1_ps(VECLIB_ATAN_A2), _mm_mul_ps(z, r));
+        r = _mm_add_ps(_mm_set1_ps(VECLIB_ATAN_A1), _mm_mul_ps(z, r));
+        r = _mm_add_ps(_mm_add_ps(base, t), _mm_mul_ps(_mm_mul_ps(t, z), r));
+        big = _mm_cmpgt_ps(ay, ax);
+        r = _mm_or_ps(_mm_and_ps(big, _mm_sub_ps(_mm_set1_ps(VECLIB_PIO2), r)), _mm_andnot_ps(big, r));
+        big = _mm_cmplt_ps(x, _mm_setzero_ps());
+        r = _mm_or_ps(_mm_and_ps(big, _mm_sub_ps(_mm_set1_ps(VECLIB_PI), r)), _mm_andnot_ps(big, r));
+        big = _mm_cmplt_ps(y, _mm_setzero_ps());
+        r = _mm_xor_ps(r, _mm_and_ps(big, _mm_set1_ps(-0.0f)));
+        _mm_storeu_ps(&c[i], r);
+    }
+    veclib_svatan2approx_scalar(&a[i], &b[i], len-i, &c[i]);
+}
+#elif defined(SAF_VECLIB_NEON)
+/** Returns the quotient n/d (no vdivq_f32 in ARMv7; two Newton-Raphson steps) */
+static float32x4_t veclib_divq_neon(float32x4_t n, float32x4_t d)
+{
+    float32x4_t inv;
+    inv = vrecpeq_f32(d);
+    inv = vmulq_f32(vrecpsq_f32(d, inv), inv);
+    inv = vmulq_f32(vrecpsq_f32(d, inv), inv);
+    return vmulq_f32(n, inv);
+}
+
+/** NEON version of veclib_svsincosapprox_scalar() */
+static void veclib_svsincosapprox_neon
+(
+    const float* a,
+    const int len,
+    float* s,
+    float* c
+)
+{
+    int i;
+    int32x4_t n;
+    uint32x4_t swap;
+    float32x4_t x, q, nf, r, r2, sr, cr, half;
+    for(i=0; i<len-3; i+=4){
+        x = vld1q_f32(&a[i]);
+        q = vmulq_f32(x, vdupq_n_f32(VECLIB_2OPI));
+        half = vbslq_f32(vcltq_f32(q, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+        n = vcvtq_s32_f32(vaddq_f32(q, half));
+        nf = vcvtq_f32_s32(n);
+        r = vmlsq_f32(x, nf, vdupq_n_f32(VECLIB_PIO2_1));
+        r = vmlsq_f32(r, nf, vdupq_n_f32(VECLIB_PIO2_2));
+        r = vsubq_f32(r, vmlaq_f32(vmulq_f32(nf, vdupq_n_f32(VECLIB_PIO2_4)), nf, vdupq_n_f32(VECLIB_PIO2_3)));
+        r2 = vmulq_f32(r, r);
+        sr = vmlaq_f32(vdupq_n_f32(VECLIB_SIN_S2), r2, vdupq_n_f32(VECLIB_SIN_S3));
+        sr = vmlaq_f32(vdupq_n_f32(VECLIB_SIN_S1), r2, sr);
+        sr = vmlaq_f32(r, vmulq_f32(r, r2), sr);
+        cr = vmlaq_f32(vdupq_n_f32(VECLIB_COS_C2), r2, vdupq_n_f32(VECLIB_COS_C3));
+        cr = vmlaq_f32(vdupq_n_f32(VECLIB_COS_C1), r2, cr);
+        cr = vmlaq_f32(vmlsq_f32(vdupq_n_f32(1.0f), vdupq_n_f32(0.5f), r2), vmulq_f32(r2, r2), cr);
+        swap = vtstq_s32(n, vdupq_n_s32(1));
+        x = vbslq_f32(swap, cr, sr);
+        q = vbslq_f32(swap, sr, cr);
+        x = vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(x), vshlq_n_s32(vandq_s32(n, vdupq_n_s32(2)), 30)));
+        q = vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(q), vshlq_n_s32(vandq_s32(vaddq_s32(n, vdupq_n_s32(1)), vdupq_n_s32(2)), 30)));
+        vst1q_f32(&s[i], x);
+        vst1q_f32(&c[i], q);
+    }
+    veclib_svsincosapprox_scalar(&a[i], len-i, &s[i], &c[i]);
+}
+
+/** NEON version of veclib_svatan2approx_scalar() */
+static void veclib_svatan2approx_neon
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+    int i;
+    uint32x4_t big;
+    float32x4_t y, x, ay, ax, t, z, base, r;
+    for(i=0; i<len-3; i+=4){
+        y = vld1q_f32(&a[i]);
+        x = vld1q_f32(&b[i]);
+        ay = vabsq_f32(y);
+        ax = vabsq_f32(x);
+        t = veclib_divq_neon(vminq_f32(ay, ax), vmaxq_f32(vmaxq_f32(ay, ax), vdupq_n_f32(FLT_MIN)));
+        big = vcgtq_f32(t, vdupq_n_f32(VECLIB_TANPIO8));
+        t = vbslq_f32(big, veclib_divq_neon(vsubq_f32(t, vdupq_n_f32(1.0f)), vaddq_f32(t, vdupq_n_f32(1.0f))), t);
+        base = vbslq_f32(big, vdupq_n_f32(VECLIB_PIO4), vdupq_n_f32(0.0f));
+        z = vmulq_f32(t, t);
+        r = vmlaq_f32(vdupq_n_f32(VECLIB_ATAN_A3), z, vdupq_n_f32(VECLIB_ATAN_A4));
+        r = vmlaq_f32(vdupq_n_f32(VECLIB_ATAN_A2), z, r);
+        r = vmlaq_f32(vdupq_n_f32(VECLIB_ATAN_A1), z, r);
+        r = vmlaq_f32(vaddq_f32(base, t), vmulq_f32(t, z), r);
+        r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(VECLIB_PIO2), r), r);
+        r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(VECLIB_PI), r), r);
+        r = vbslq_f32(vcltq_f32(y, vdupq_n_f32(0.0f)), vnegq_f32(r), r);
+        vst1q_f32(&c[i], r);
+    }
+    veclib_svatan2approx_scalar(&a[i], &b[i], len-i, &c[i]);
+}
+#endif
+
+void utility_svsincosapprox
+(
+    const float* a,
+    const int len,
+    float* s,
+    float* c
+)
+{
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svsincosapprox_sse2(a, len, s, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svsincosapprox_neon(a, len, s, c);
+#else
+    veclib_svsincosapprox_scalar(a, len, s, c);
+#endif
+}
+
+void utility_svatan2approx
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+#if defined(SAF_VECLIB_SSE2)
+    veclib_svatan2approx_sse2(a, b, len, c);
+#elif defined(SAF_VECLIB_NEON)
+    veclib_svatan2approx_neon(a, b, len, c);
+#else
+    veclib_svatan2approx_scalar(a, b, len, c);
+#endif
+}
+
+void utility_svexpapprox
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    for(i=0; i<len; i++)
+        c[i] = a[i] * VECLIB_LOG2E;
+    utility_svexp2approx(c, len, c);
+}
+
+void utility_svlogapprox
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    int i;
+    utility_svlog2approx(a, len, c);
+    for(i=0; i<len; i++)
+        c[i] *= VECLIB_EXP2_LN2;
+}
+
+void utility_svpowapprox
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+    int i;
+    utility_svlog2approx(a, len, c);
+    for(i=0; i<len; i++)
+        c[i] *= b[i];
+    utility_svexp2approx(c, len, c);
+}
+
+void utility_cvexpapprox
+(
+    const float_complex* a,
+    const int len,
+    float_complex* c
+)
+{
+    int i, j, blockLen;
+    float re[VECLIB_APPROX_BLOCK], im[VECLIB_APPROX_BLOCK], sn[VECLIB_APPROX_BLOCK], cs[VECLIB_APPROX_BLOCK];
+    for(i=0; i<len; i+=VECLIB_APPROX_BLOCK){
+        blockLen = len-i < VECLIB_APPROX_BLOCK ? len-i : VECLIB_APPROX_BLOCK;
+        for(j=0; j<blockLen; j++){
+            re[j] = crealf(a[i+j]);
+            im[j] = cimagf(a[i+j]);
+        }
+        utility_svexpapprox(re, blockLen, re);
+        utility_svsincosapprox(im, blockLen, sn, cs);
+        for(j=0; j<blockLen; j++)
+            c[i+j] = cmplxf(re[j]*cs[j], re[j]*sn[j]);
+    }
+}
+
+
+/* ========================================================================== */
+/*                        Vector-Vector Copy (?vvcopy)                        */
+/* ========================================================================== */
+
+void utility_svvcopy
+(
+    const float* a,
+    const int len,
+    float* c
+)
+{
+    cblas_scopy(len, a, 1, c, 1);
+}
+
+void utility_cvvcopy
+(
+    const float_complex* a,
+    const int len,
+    float_complex* c
+)
+{
+    cblas_ccopy(len, a, 1, c, 1);
+}
+
+
+/* ========================================================================== */
+/*                       Vector-Vector Addition (?vvadd)                      */
+/* ========================================================================== */
+
+void utility_svvadd
+(
+    float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+#ifdef __ACCELERATE__
+	if (c == NULL) {
+		float* tmp;
+		tmp = malloc1d(len * sizeof(float));
+		vDSP_vadd(a, 1, b, 1, tmp, 1, len);
+		utility_svvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vDSP_vadd(a, 1, b, 1, c, 1, len);
+#elif defined(INTEL_MKL_VERSION)
+	if (c == NULL) {
+		float* tmp;
+		tmp = malloc1d(len * sizeof(float));
+		vsAdd(len, a, b, tmp);
+		utility_svvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vsAdd(len, a, b, c);
+#else
+    veclib_svvop(VECLIB_ADD, a, b, len, c==NULL ? a : c);
+#endif
+}
+
+void utility_cvvadd
+(
+    float_complex* a,
+    const float_complex* b,
+    const int len,
+    float_complex* c
+)
+{
+#ifdef INTEL_MKL_VERSION
+	if (c == NULL) {
+		float_complex* tmp;
+		tmp = malloc1d(len * sizeof(float_complex));
+		vcAdd(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
+		utility_cvvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vcAdd(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
+#else
+    veclib_svvop(VECLIB_ADD, (const float*)a, (const float*)b, 2*len, c==NULL ? (float*)a : (float*)c);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                     Vector-Vector Subtraction (?vvsub)                     */
+/* ========================================================================== */
+
+void utility_svvsub
+(
+    float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+#ifdef __ACCELERATE__
+	if (c == NULL) {
+		float* tmp;
+		tmp = malloc1d(len * sizeof(float));
+		vDSP_vsub(a, 1, b, 1, tmp, 1, len);
+		utility_svvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vDSP_vsub(a, 1, b, 1, c, 1, len);
+#elif defined(INTEL_MKL_VERSION)
+	if (c == NULL) {
+		float* tmp;
+		tmp = malloc1d(len * sizeof(float));
+		vsSub(len, a, b, tmp);
+		utility_svvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vsSub(len, a, b, c);
+#else
+    veclib_svvop(VECLIB_SUB, a, b, len, c==NULL ? a : c);
+#endif
+}
+
+void utility_cvvsub
+(
+    float_complex* a,
+    const float_complex* b,
+    const int len,
+    float_complex* c
+)
+{
+#ifdef INTEL_MKL_VERSION
+	if (c == NULL) {
+		float_complex* tmp;
+		tmp = malloc1d(len * sizeof(float_complex));
+		vcSub(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
+		utility_cvvcopy(tmp, len, a);
+		free(tmp);
+	}
+	else
+		vcSub(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
+#else
+    veclib_svvop(VECLIB_SUB, (const float*)a, (const float*)b, 2*len, c==NULL ? (float*)a : (float*)c);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                    Vector-Vector Multiplication (?vvmul)                   */
+/* ========================================================================== */
+
+void utility_svvmul
+(
+    float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+#ifdef __ACCELERATE__
+    if(c==NULL){
+        float* tmp;
+        tmp=malloc1d(len*sizeof(float));
+        vDSP_vmul(a, 1, b, 1, tmp, 1, len);
+        utility_svvcopy(tmp, len, a);
+        free(tmp);
+    }
+    else
+        vDSP_vmul(a, 1, b, 1, c, 1, len);
+#elif defined(INTEL_MKL_VERSION)
+    if (c == NULL) {
+        float* tmp;
+        tmp = malloc1d(len * sizeof(float));
+        vsMul(len, a, b, tmp);
+        utility_svvcopy(tmp, len, a);
+        free(tmp);
+    }
+    else
+        vsMul(len, a, b, c);
+#else
+    veclib_svvop(VECLIB_MUL, a, b, len, c==NULL ? a : c);
+#endif
+}
+
+void utility_cvvmul
+(
+    float_complex* a,
+    const float_complex* b,
+    const int len,
+    float_complex* c
+)
+{
+#ifdef INTEL_MKL_VERSION
+    if (c == NULL) {
+        float_complex* tmp;
+        tmp = malloc1d(len * sizeof(float_complex));
+        vcMul(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)tmp);
+        utility_cvvcopy(tmp, len, a);
+        free(tmp);
+    }
+    else
+        vcMul(len, (MKL_Complex8*)a, (MKL_Complex8*)b, (MKL_Complex8*)c);
+#else
+    veclib_cvvmul(a, b, 0, len, c==NULL ? a : c);
+#endif
+}
+
+void utility_cvvmacsum
+(
+    const float_complex** a,
+    const float_complex** b,
+    const int nPairs,
+    const int len,
+    float_complex* c
+)
+{
+    int i, k, blockLen;
+    veclib_cvvmac_kernel cvvmac;
+
+    /* The bins are processed in blocks, over which all of the products are
+     * accumulated before moving on; so that the block of 'c' stays in L1 */
+    cvvmac = veclib_cvvmac_select();
+    for(i=0; i<len; i+=SAF_VECLIB_MACSUM_BLOCK_LENGTH){
+        blockLen = len-i < SAF_VECLIB_MACSUM_BLOCK_LENGTH ? len-i : SAF_VECLIB_MACSUM_BLOCK_LENGTH;
+        memset(&c[i], 0, blockLen*sizeof(float_complex));
+        for(k=0; k<nPairs; k++)
+            cvvmac(&a[k][i], &b[k][i], blockLen, &c[i]);
+    }
+}
+
+
+/* ========================================================================== */
+/*                     Vector-Vector Dot Product (?vvdot)                     */
+/* ========================================================================== */
+
+void utility_svvdot
+(
+    const float* a,
+    const float* b,
+    const int len,
+    float* c
+)
+{
+    c[0] = cblas_sdot (len, a, 1, b, 1);
+}
+
+void utility_cvvdot
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int len,
+    CONJ_FLAG flag,
+    float_complex* c
+)
+{
+    switch(flag){
+        default:
+        case NO_CONJ:
+            cblas_cdotu_sub(len, a, 1, b, 1, c);
+            break;
+        case CONJ:
+            cblas_cdotc_sub(len, a, 1, b, 1, c);
+            break;
+    }
+}
+
+
+/* ========================================================================== */
+/*                       Vector-Scalar Product (?vsmul)                       */
+/* ========================================================================== */
+
+void utility_svsmul
+(
+    float* a,
+    const float* s,
+    const int len,
+    float* c
+)
+{
+#ifdef __ACCELERATE__
+    if(c==NULL)
+        cblas_sscal(len, s[0], a, 1);
+    else
+        vDSP_vsmul(a, 1, s, c, 1, len);
+#else
+    if (c == NULL)
+        cblas_sscal(len, s[0], a, 1);
+    else
+        veclib_svsop(VECLIB_MUL, a, s[0], len, c);
+#endif
+}
+
+void utility_cvsmul
+(
+    float_complex* a,
+    const float_complex* s,
+    const int len,
+    float_complex* c
+)
+{
+    if (c == NULL)
+        cblas_cscal(len, s, a, 1);
+    else
+        veclib_cvvmul(a, s, 1, len, c);
+}
+
+
+/* ========================================================================== */
+/*                       Vector-Scalar Division (?vsdiv)                      */
+/* ========================================================================== */
+
+void utility_svsdiv
+(
+    float* a,
+    const float* s,
+    const int len,
+    float* c
+)
+{
+    if(c==NULL)
+        c = a;
+    if(s[0] == 0.0f){
+        memset(c, 0, len*sizeof(float));
+        return;
+    }
+#ifdef __ACCELERATE__
+    vDSP_vsdiv(a, 1, s, c, 1, len);
+#else
+    veclib_svsop(VECLIB_DIV, a, s[0], len, c);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                       Vector-Scalar Addition (?vsadd)                      */
+/* ========================================================================== */
+
+void utility_svsadd
+(
+    float* a,
+    const float* s,
+    const int len,
+    float* c
+)
+{
+    if(c==NULL)
+        c = a;
+#ifdef __ACCELERATE__
+    vDSP_vsadd(a, 1, s, c, 1, len);
+#else
+    veclib_svsop(VECLIB_ADD, a, s[0], len, c);
+#endif
+}
+
+
+/* ========================================================================== */
+/*                     Vector-Scalar Subtraction (?vssub)                     */
+/* ========================================================================== */
+
+void utility_svssub
+(
+    float* a,
+    const float* s,
+    const int len,
+    float* c
+)
+{
+    veclib_svsop(VECLIB_SUB, a, s[0], len, c==NULL ? a : c);
+}
+
+
+/* ========================================================================== */
+/*              Split-Complex Vector Operations (?vv..._split)                */
+/* ========================================================================== */
+
+void utility_cvsplit
+(
+    const float_complex* a,
+    const int len,
+    float_complex_split* c
+)
+{
+    cblas_scopy(len, (const float*)a, 2, c->re, 1);
+    cblas_scopy(len, &((const float*)a)[1], 2, c->im, 1);
+}
+
+void utility_cvmerge
+(
+    const float_complex_split* a,
+    const int len,
+    float_complex* c
+)
+{
+    cblas_scopy(len, a->re, 1, (float*)c, 2);
+    cblas_scopy(len, a->im, 1, &((float*)c)[1], 2);
+}
+
+void utility_cvvcopy_split
+(
+    const float_complex_split* a,
+    const int len,
+    float_complex_split* c
+)
+{
+    cblas_scopy(len, a->re, 1, c->re, 1);
+    cblas_scopy(len, a->im, 1, c->im, 1);
+}
+
+void utility_cvvadd_split
+(
+    float_complex_split* a,
+    const float_complex_split* b,
+    const int len,
+    float_complex_split* c
+)
+{
+    utility_svvadd(a->re, b->re, len, c==NULL ? NULL : c->re);
+    utility_svvadd(a->im, b->im, len, c==NULL ? NULL : c->im);
+}
+
+void utility_cvvsub_split
+(
+    float_complex_split* a,
+    const float_complex_split* b,
+    const int len,
+    float_complex_split* c
+)
+{
+    utility_svvsub(a->re, b->re, len, c==NULL ? NULL : c->re);
+    utility_svvsub(a->im, b->im, len, c==NULL ? NULL : c->im);
+}
+
+void utility_cvvmul_split
+(
+    float_complex_split* a,
+    const float_complex_split* b,
+    const int len,
+    CONJ_FLAG flag,
+    float_complex_split* c
+)
+{
+#ifdef __ACCELERATE__
+    DSPSplitComplex A, B, C;
+    A.realp = a->re; A.imagp = a->im;
+    B.realp = b->re; B.imagp = b->im;
+    C.realp = c==NULL ? a->re : c->re;
+    C.imagp = c==NULL ? a->im : c->im;
+    if(flag==CONJ)
+        vDSP_zvmul(&B, 1, &A, 1, &C, 1, len, -1); /* (vDSP conjugates the first operand) */
+    else
+        vDSP_zvmul(&A, 1, &B, 1, &C, 1, len, 1);
+#else
+    veclib_cvvmul_split(a, b->re, b->im, 0, flag==CONJ, 0, len, c==NULL ? a : c);
+#endif
+}
+
+void utility_cvvmac_split
+(
+    const float_complex_split* a,
+    const float_complex_split* b,
+    const int len,
+    CONJ_FLAG flag,
+    float_complex_split* c
+)
+{
+#ifdef __ACCELERATE__
+    DSPSplitComplex A, B, C;
+    A.realp = a->re; A.imagp = a->im;
+    B.realp = b->re; B.imagp = b->im;
+    C.realp = c->re; C.imagp = c->im;
+    if(flag==CONJ)
+        vDSP_zvcma(&B, 1, &A, 1, &C, 1, &C, 1, len); /* (vDSP conjugates the first operand) */
+    else
+        vDSP_zvma(&A, 1, &B, 1, &C, 1, &C, 1, len);
+#else
+    veclib_cvvmul_split(a, b->re, b->im, 0, flag==CONJ, 1, len, c);
+#endif
+}
+
+void utility_cvsmul_split
+(
+    float_complex_split* a,
+    const float_complex* s,
+    const int len,
+    float_complex_split* c
+)
+{
+    float s_re, s_im;
+    s_re = crealf(s[0]);
+    s_im = cimagf(s[0]);
+    veclib_cvvmul_split(a, &s_re, &s_im, 1, 0, 0, len, c==NULL ? a : c);
+}
+
+void utility_cvvdot_split
+(
+    const float_complex_split* a,
+    const float_complex_split* b,
+    const int len,
+    CONJ_FLAG flag,
+    float_complex* c
+)
+{
+    float rr, ii, ri, ir;
+    rr = cblas_sdot(len, a->re, 1, b->re, 1);
+    ii = cblas_sdot(len, a->im, 1, b->im, 1);
+    ri = cblas_sdot(len, a->re, 1, b->im, 1);
+    ir = cblas_sdot(len, a->im, 1, b->re, 1);
+    if(flag==CONJ)
+        c[0] = cmplxf(rr + ii, ir - ri);
+    else
+        c[0] = cmplxf(rr - ii, ir + ri);
+}
+
+
+/* ========================================================================== */
+/*                   Reduced-Precision Storage (?vpack/?vunpack)              */
+/* ========================================================================== */
+
+/** Converts a float into IEEE 754 half-precision (round to nearest even) */
+static unsigned short veclib_float2half(float f)
+{
+    unsigned int x, sign, mant, rem, halfway, r;
+    int shift;
+    
+    memcpy(&x, &f, sizeof(unsigned int));
+    sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+    if(x >= 0x7f800000u) /* Inf or NaN (kept quiet) */
+        return (unsigned short)(sign | 0x7c00u | (x > 0x7f800000u ? 0x200u : 0u));
+    if(x >= 0x477ff000u) /* rounds to a value beyond 65504 */
+        return (unsigned short)(sign | 0x7c00u);
+    if(x < 0x38800000u){ /* below 2^-14: subnormal (or zero) half */
+        if(x < 0x33000000u)
+            return (unsigned short)sign;
+        mant = (x & 0x7fffffu) | 0x800000u;
+        shift = 126 - (int)(x >> 23);
+        r = mant >> shift;
+        rem = mant & ((1u << shift) - 1u);
+        halfway = 1u << (shift - 1);
+        if(rem > halfway || (rem == halfway && (r & 1u)))
+            r++;
+        return (unsigned short)(sign | r);
+    }
+    x += 0xfffu + ((x >> 13) & 1u); /* ties to even */
+    return (unsigned short)(sign | ((x - 0x38000000u) >> 13));
+}
+
+/** Converts an IEEE 754 half-precision value into a float (exact) */
+static float veclib_half2float(unsigned short h)
+{
+    unsigned int x, sign, e, m;
+    float f;
+    
+    sign = ((unsigned int)h & 0x8000u) << 16;
+    e = ((unsigned int)h >> 10) & 0x1fu;
+    m = (unsigned int)h & 0x3ffu;
+    if(e == 0){
+        f = (float)m * 5.9604644775390625e-8f; /* m * 2^-24 */
+        return sign ? -f : f;
+    }
+    if(e == 31)
+        x = sign | 0x7f800000u | (m << 13);
+    else
+        x = sign | ((e + 112u) << 23) | (m << 13);
+    memcpy(&f, &x, sizeof(float));
+    return f;
+}
+
+/** Converts a float into bfloat16 (round to nearest even) */
+static unsigned short veclib_float2bfloat(float f)
+{
+    unsigned int x;
+    
+    memcpy(&x, &f, sizeof(unsigned int));
+    if((x & 0x7fffffffu) > 0x7f800000u) /* NaN (kept quiet) */
+        return (unsigned short)((x >> 16) | 0x40u);
+    x += 0x7fffu + ((x >> 16) & 1u);
+    return (unsigned short)(x >> 16);
+}
+
+/** Converts a bfloat16 value into a float (exact) */
+static float veclib_bfloat2float(unsigned short b)
+{
+    unsigned int x;
+    float f;
+    
+    x = (unsigned int)b << 16;
+    memcpy(&f, &x, sizeof(float));
+    return f;
+}
+
+size_t utility_storagePrecisionBytes
+(
+    SAF_STORAGE_PRECISION precision
+)
+{
+    switch(precision){
+        case SAF_STORAGE_FLOAT16:
+        case SAF_STORAGE_BFLOAT16: return sizeof(unsigned short);
+        default:
+        case SAF_STORAGE_FLOAT32:  return sizeof(float);
+    }
+}
+
+void utility_svpack
+(
+    const float* a,
+    const int len,
+    SAF_STORAGE_PRECISION precision,
+    void* c
+)
+{
+    unsigned short* c16;
+    int i;
+    
+    c16 = (unsigned short*)c;
+    switch(precision){
+        case SAF_STORAGE_FLOAT16:
+            for(i=0; i<len; i++)
+                c16[i] = veclib_float2half(a[i]);
+            break;
+        case SAF_STORAGE_BFLOAT16:
+            for(i=0; i<len; i++)
+                c16[i] = veclib_float2bfloat(a[i]);
+            break;
+        default:
+        case SAF_STORAGE_FLOAT32:
+            memcpy(c, a, len*sizeof(float));
+            break;
+    }
+}
+
+void utility_svunpack
+(
+    const void* a,
+    const int len,
+    SAF_STORAGE_PRECISION precision,
+    float* c
+)
+{
+    const unsigned short* a16;
+    int i;
     
+    a16 = (const unsigned short*)a;
+    switch(precision){
+        case SAF_STORAGE_FLOAT16:
+            for(i=0; i<len; i++)
+                c[i] = veclib_half2float(a16[i]);
+            break;
+        case SAF_STORAGE_BFLOAT16:
+            for(i=0; i<len; i++)
+                c[i] = veclib_bfloat2float(a16[i]);
+            break;
+        default:
+        case SAF_STORAGE_FLOAT32:
+            memcpy(c, a, len*sizeof(float));
+            break;
+    }
+}
+
+
+/* ========================================================================== */
+/*                     Singular-Value Decomposition (?svd)                    */
+/* ========================================================================== */
+
+/** Data structure for utility_ssvd() */
+typedef struct _utility_ssvd_data {
+    int maxDim1, maxDim2;
+    int lwork;
+    float* a, *s, *u, *vt, *work;
+}utility_ssvd_data;
+
+void utility_ssvd_create
+(
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
+)
+{
+    *phWork = malloc1d(sizeof(utility_ssvd_data));
+    utility_ssvd_data *h = (utility_ssvd_data*)(*phWork);
+    int m, n, lda, ldu, ldvt, info, lworkMin;
+    float wkopt;
+
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = ldvt = maxDim2;
+    h->a = malloc1d(maxDim1*maxDim2*sizeof(float));
+    h->s = malloc1d(MIN(maxDim1, maxDim2)*sizeof(float));
+    h->u = malloc1d(maxDim1*maxDim1*sizeof(float));
+    h->vt = malloc1d(maxDim2*maxDim2*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions (which is
+     * also sufficient for any smaller dimensions) */
+    lworkMin = MAX(1, MAX(3*MIN(m,n)+MAX(m,n), 5*MIN(m,n)));
+    wkopt = (float)lworkMin;
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    sgesvd_( "A", "A", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, &wkopt, &(h->lwork), &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sgesvd_work(CblasColMajor, 'A', 'A', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, &wkopt, -1);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)wkopt) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float));
+}
+
+void utility_ssvd_destroy
+(
+    void ** const phWork
+)
+{
+    utility_ssvd_data *h = (utility_ssvd_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_ssvd
+(
+    void* const hWork,
+    const float* A,
+    const int dim1,
+    const int dim2,
+    float* U,
+    float* S,
+    float* V,
+    float* sing
+)
+{
+    utility_ssvd_data *h;
+    int i, j, m, n, lda, ldu, ldvt, info;
+    m = dim1; n = dim2; lda = dim1; ldu = dim1; ldvt = dim2;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_ssvd_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_ssvd_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
+    /* store in column major order */
+    for(i=0; i<dim1; i++)
+        for(j=0; j<dim2; j++)
+            h->a[j*dim1+i] = A[i*dim2 +j];
+
+    /* perform the singular value decomposition */
+#ifdef VECLIB_USE_CLAPACK_INTERFACE
+    /* no such implementation in altas-clapack */
+    assert(0);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sgesvd_work(CblasColMajor, 'A', 'A', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, h->work, h->lwork);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    sgesvd_( "A", "A", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, h->work, &(h->lwork), &info );
+#endif
+
+    /* svd failed to converge */
+    if( info != 0 ) {
+        if (S != NULL)
+            memset(S, 0, dim1*dim2*sizeof(float));
+        if (U != NULL)
+            memset(U, 0, dim1*dim1*sizeof(float));
+        if (V != NULL)
+            memset(V, 0, dim2*dim2*sizeof(float));
+        if (sing != NULL)
+            memset(sing, 0, MIN(dim1, dim2)*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
+#endif
+    }
+    /* svd successful */
+    else {
+        if (S != NULL){
+            memset(S, 0, dim1*dim2*sizeof(float));
+            /* singular values on the diagonal MIN(dim1, dim2). The remaining elements are 0.  */
+            for(i=0; i<MIN(dim1, dim2); i++)
+                S[i*dim2+i] = h->s[i];
+        }
+
+        /*return as row-major*/
+        if (U != NULL)
+            for(i=0; i<dim1; i++)
+                for(j=0; j<dim1; j++)
+                    U[i*dim1+j] = h->u[j*dim1+i];
+
+        /* lapack returns VT, i.e. row-major V already */
+        if (V != NULL)
+            for(i=0; i<dim2; i++)
+                for(j=0; j<dim2; j++)
+                    V[i*dim2+j] = h->vt[i*dim2+j];
+
+        if (sing != NULL)
+            for(i=0; i<MIN(dim1, dim2); i++)
+                sing[i] = h->s[i];
+    }
+
+    if(hWork==NULL)
+        utility_ssvd_destroy((void**)&h);
+}
+
+/** Data structure for utility_csvd() */
+typedef struct _utility_csvd_data {
+    int maxDim1, maxDim2;
+    int lwork;
+    float_complex* a, *u, *vt, *work;
+    float* s, *rwork;
+}utility_csvd_data;
+
+void utility_csvd_create
+(
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
+)
+{
+    *phWork = malloc1d(sizeof(utility_csvd_data));
+    utility_csvd_data *h = (utility_csvd_data*)(*phWork);
+    int m, n, lda, ldu, ldvt, info, lworkMin;
+    float_complex wkopt;
+
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = ldvt = maxDim2;
+    h->a = malloc1d(maxDim1*maxDim2*sizeof(float_complex));
+    h->s = malloc1d(MIN(maxDim1, maxDim2)*sizeof(float));
+    h->u = malloc1d(maxDim1*maxDim1*sizeof(float_complex));
+    h->vt = malloc1d(maxDim2*maxDim2*sizeof(float_complex));
+    h->rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 2*MIN(m,n)+MAX(m,n));
+    wkopt = cmplxf((float)lworkMin, 0.0f);
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    cgesvd_( "A", "A", &m, &n, (veclib_float_complex*)h->a, &lda, h->s, (veclib_float_complex*)h->u, &ldu,
+            (veclib_float_complex*)h->vt, &ldvt, (veclib_float_complex*)&wkopt, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgesvd_work(CblasColMajor, 'A', 'A', m, n, (veclib_float_complex*)h->a, lda, h->s, (veclib_float_complex*)h->u, ldu,
+                               (veclib_float_complex*)h->vt, ldvt, (veclib_float_complex*)&wkopt, -1, h->rwork);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)(crealf(wkopt)+0.01f)) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+}
+
+void utility_csvd_destroy
+(
+    void ** const phWork
+)
+{
+    utility_csvd_data *h = (utility_csvd_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->rwork);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_csvd
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim1,
+    const int dim2,
+    float_complex* U,
+    float_complex* S,
+    float_complex* V,
+    float* sing
+)
+{
+    utility_csvd_data *h;
+    int i, j, m, n, lda, ldu, ldvt, info;
+    m = dim1; n = dim2; lda = dim1; ldu = dim1; ldvt = dim2;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_csvd_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_csvd_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
+    /* store in column major order */
+    for(i=0; i<dim1; i++)
+        for(j=0; j<dim2; j++)
+            h->a[j*dim1+i] = A[i*dim2 +j];
+
+    /* perform the singular value decomposition */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cgesvd_( "A", "A", &m, &n, (veclib_float_complex*)h->a, &lda, h->s, (veclib_float_complex*)h->u, &ldu, (veclib_float_complex*)h->vt, &ldvt,
+            (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &info);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgesvd_work(CblasColMajor, 'A', 'A', m, n, (veclib_float_complex*)h->a, lda, h->s, (veclib_float_complex*)h->u, ldu,
+                               (veclib_float_complex*)h->vt, ldvt, (veclib_float_complex*)h->work, h->lwork, h->rwork);
+#endif
+
     /* svd failed to converge */
     if( info != 0 ) {
-        if (S != NULL)
-            memset(S, 0, dim1*dim2*sizeof(float));
-        if (U != NULL)
-            memset(U, 0, dim1*dim1*sizeof(float));
-        if (V != NULL)
-            memset(U, 0, dim2*dim2*sizeof(float));
-        if (sing != NULL)
-            memset(sing, 0, MIN(dim1, dim2)*sizeof(float));
+        if (S != NULL)
+            memset(S, 0, dim1*dim2*sizeof(float_complex));
+        if (U != NULL)
+            memset(U, 0, dim1*dim1*sizeof(float_complex));
+        if (V != NULL)
+            memset(V, 0, dim2*dim2*sizeof(float_complex));
+        if (sing != NULL)
+            memset(sing, 0, MIN(dim1, dim2)*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
+#endif
+    }
+    /* svd successful */
+    else {
+        if (S != NULL){
+            memset(S, 0, dim1*dim2*sizeof(float_complex));
+            /* singular values on the diagonal MIN(dim1, dim2). The remaining elements are 0.  */
+            for(i=0; i<MIN(dim1, dim2); i++)
+                S[i*dim2+i] = cmplxf(h->s[i], 0.0f);
+        }
+        /*return as row-major*/
+        if (U != NULL)
+            for(i=0; i<dim1; i++)
+                for(j=0; j<dim1; j++)
+                    U[i*dim1+j] = h->u[j*dim1+i];
+
+        /* lapack returns VT, i.e. row-major V already */
+        if (V != NULL)
+            for(i=0; i<dim2; i++)
+                for(j=0; j<dim2; j++)
+                    V[i*dim2+j] = conjf(h->vt[i*dim2+j]); /* v^H */
+
+        if (sing != NULL)
+            for(i=0; i<MIN(dim1, dim2); i++)
+                sing[i] = h->s[i];
+    }
+
+    if(hWork==NULL)
+        utility_csvd_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                 Symmetric Eigenvalue Decomposition (?seig)                 */
+/* ========================================================================== */
+
+/** Data structure for utility_sseig() */
+typedef struct _utility_sseig_data {
+    int maxDim;
+    int lwork;
+    float* a, *w, *work;
+}utility_sseig_data;
+
+void utility_sseig_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_sseig_data));
+    utility_sseig_data *h = (utility_sseig_data*)(*phWork);
+    int n, lda, info, lworkMin;
+    float wkopt;
+
+    h->maxDim = maxDim;
+    n = lda = maxDim;
+    h->w = malloc1d(maxDim*sizeof(float));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 3*n-1);
+    wkopt = (float)lworkMin;
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    ssyev_( "Vectors", "Upper", &n, h->a, &lda, h->w, &wkopt, &(h->lwork), &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_ssyev_work(CblasColMajor, 'V', 'U', n, h->a, lda, h->w, &wkopt, -1);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)wkopt) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float));
+}
+
+void utility_sseig_destroy
+(
+    void ** const phWork
+)
+{
+    utility_sseig_data *h = (utility_sseig_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->w);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_sseig
+(
+    void* const hWork,
+    const float* A,
+    const int dim,
+    int sortDecFLAG,
+    float* V,
+    float* D,
+    float* eig
+)
+{
+    utility_sseig_data *h;
+    int i, j, n, lda, info;
+    float* a, *w;
+
+    n = dim;
+    lda = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_sseig_create((void**)&h, dim);
+    else{
+        h = (utility_sseig_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+    w = h->w;
+
+    /* store in column major order (i.e. transpose) */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[i*dim+j] = A[j*dim+i];
+
+    /* solve the eigenproblem */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    ssyev_( "Vectors", "Upper", &n, a, &lda, w, h->work, &(h->lwork), &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_ssyev_work(CblasColMajor, 'V', 'U', n, a, lda, w, h->work, h->lwork);
+#endif
+
+    /* output */
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(float));
+    if( info != 0 ) {
+        /* failed to converge and find the eigenvalues */
+        if(V!=NULL)
+            memset(V, 0, dim*dim*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+    else{
+        if(sortDecFLAG){
+            for(i=0; i<dim; i++){
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[i*dim+j] = a[(dim-j-1)*dim+i]; /* transpose, back to row-major and reverse order */
+                if(D!=NULL)
+                    D[i*dim+i] = w[dim-i-1]; /* store along the diagonal, reversing the order */
+                if(eig!=NULL)
+                    eig[i] = w[dim-i-1];
+            }
+        }
+        else{
+            for(i=0; i<dim; i++){
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[i*dim+j] = a[j*dim+i]; /* transpose, back to row-major */
+                if(D!=NULL)
+                    D[i*dim+i] = w[i]; /* store along the diagonal */
+                if(eig!=NULL)
+                    eig[i] = w[i];
+            }
+        }
+    }
+
+    if(hWork==NULL)
+        utility_sseig_destroy((void**)&h);
+}
+
+/** Data structure for utility_cseig() */
+typedef struct _utility_cseig_data {
+    int maxDim;
+    int lwork;
+    float_complex* a, *work;
+    float* w, *rwork;
+}utility_cseig_data;
+
+void utility_cseig_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_cseig_data));
+    utility_cseig_data *h = (utility_cseig_data*)(*phWork);
+    int n, lda, info, lworkMin;
+    float_complex wkopt;
+
+    h->maxDim = maxDim;
+    n = lda = maxDim;
+    h->w = malloc1d(maxDim*sizeof(float));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->rwork = malloc1d(MAX(1, 3*maxDim-2)*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 2*n-1);
+    wkopt = cmplxf((float)lworkMin, 0.0f);
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    cheev_( "Vectors", "Upper", &n, (veclib_float_complex*)h->a, &lda, h->w, (veclib_float_complex*)&wkopt, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cheev_work(CblasColMajor, 'V', 'U', n, (veclib_float_complex*)h->a, lda, h->w, (veclib_float_complex*)&wkopt, -1, h->rwork);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)(crealf(wkopt)+0.01f)) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+}
+
+void utility_cseig_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cseig_data *h = (utility_cseig_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->w);
+        free(h->rwork);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cseig
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim,
+    int sortDecFLAG,
+    float_complex* V,
+    float_complex* D,
+    float* eig
+)
+{
+    utility_cseig_data *h;
+    int i, j, n, lda, info;
+    float *w;
+    float_complex* a;
+
+    n = dim;
+    lda = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cseig_create((void**)&h, dim);
+    else{
+        h = (utility_cseig_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+    w = h->w;
+
+    /* store in column major order (i.e. transpose) */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[i*dim+j] = A[j*dim+i];
+
+    /* solve the eigenproblem */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cheev_( "Vectors", "Upper", &n, (veclib_float_complex*)a, &lda, w, (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cheev_work(CblasColMajor, 'V', 'U', n, (veclib_float_complex*)a, lda, w, (veclib_float_complex*)h->work, h->lwork, h->rwork);
+#endif
+
+    /* output */
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(float_complex));
+    if( info != 0 ) {
+        /* failed to converge and find the eigenvalues */
+        if(V!=NULL)
+            memset(V, 0, dim*dim*sizeof(float_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+
+    /* transpose, back to row-major and reverse order */
+    else{
+        if(sortDecFLAG){
+            for(i=0; i<dim; i++) {
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[i*dim+j] = a[(dim-j-1)*dim+i];
+                if(D!=NULL)
+                    D[i*dim+i] = cmplxf(w[dim-i-1], 0.0f); /* store along the diagonal, reversing the order */
+                if(eig!=NULL)
+                    eig[i] = w[dim-i-1];
+            }
+        }
+        else {
+            for(i=0; i<dim; i++){
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[i*dim+j] = a[j*dim+i];
+                if(D!=NULL)
+                    D[i*dim+i] = cmplxf(w[i], 0.0f); /* store along the diagonal */
+                if(eig!=NULL)
+                    eig[i] = w[i];
+            }
+        }
+    }
+
+    if(hWork==NULL)
+        utility_cseig_destroy((void**)&h);
+}
+
+/** Data structure for utility_cseigr() */
+typedef struct _utility_cseigr_data {
+    int maxDim;
+    int lwork, lrwork, liwork;
+    float_complex* a, *z, *work;
+    float* w, *rwork;
+    veclib_int* isuppz, *iwork;
+}utility_cseigr_data;
+
+void utility_cseigr_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_cseigr_data));
+    utility_cseigr_data *h = (utility_cseigr_data*)(*phWork);
+    veclib_int n, lda, ldz, il, iu, m, info, iwkopt;
+    float vl, vu, abstol, rwkopt;
+    float_complex wkopt;
+
+    h->maxDim = maxDim;
+    n = lda = ldz = maxDim;
+    il = 1;
+    iu = maxDim;
+    vl = vu = 0.0f;
+    abstol = 0.0f;
+    h->w = malloc1d(maxDim*sizeof(float));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->z = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->isuppz = malloc1d(2*maxDim*sizeof(veclib_int));
+
+    /* query the optimal workspace sizes for the maximum dimensions */
+    wkopt = cmplxf((float)MAX(1, 2*maxDim), 0.0f);
+    rwkopt = (float)MAX(1, 24*maxDim);
+    iwkopt = MAX(1, 10*maxDim);
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = h->lrwork = h->liwork = -1;
+    cheevr_( "Vectors", "Indices", "Upper", &n, (veclib_float_complex*)h->a, &lda, &vl, &vu, &il, &iu, &abstol, &m, h->w, (veclib_float_complex*)h->z, &ldz,
+             h->isuppz, (veclib_float_complex*)&wkopt, &(h->lwork), &rwkopt, &(h->lrwork), &iwkopt, &(h->liwork), &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cheevr_work(CblasColMajor, 'V', 'I', 'U', n, (veclib_float_complex*)h->a, lda, vl, vu, il, iu, abstol, &m, h->w,
+                               (veclib_float_complex*)h->z, ldz, h->isuppz, (veclib_float_complex*)&wkopt, -1, &rwkopt, -1, &iwkopt, -1);
+#endif
+    if(info!=0){
+        /* (the documented minimums, should the query fail) */
+        wkopt = cmplxf((float)MAX(1, 2*maxDim), 0.0f);
+        rwkopt = (float)MAX(1, 24*maxDim);
+        iwkopt = MAX(1, 10*maxDim);
+    }
+    h->lwork = MAX(1, (int)(crealf(wkopt)+0.01f));
+    h->lrwork = MAX(1, (int)(rwkopt+0.01f));
+    h->liwork = MAX(1, (int)iwkopt);
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+    h->rwork = malloc1d(h->lrwork*sizeof(float));
+    h->iwork = malloc1d(h->liwork*sizeof(veclib_int));
+}
+
+void utility_cseigr_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cseigr_data *h = (utility_cseigr_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->z);
+        free(h->w);
+        free(h->isuppz);
+        free(h->work);
+        free(h->rwork);
+        free(h->iwork);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cseigr
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim,
+    const int idxFirst,
+    const int idxLast,
+    int sortDecFLAG,
+    float_complex* V,
+    float* eig
+)
+{
+    utility_cseigr_data *h;
+    int i, j, nEig;
+    veclib_int n, lda, ldz, il, iu, m, info;
+    float vl, vu, abstol;
+    float *w;
+    float_complex* a, *z;
+
+    assert(idxFirst>=0 && idxFirst<=idxLast && idxLast<dim);
+    n = lda = ldz = dim;
+    il = idxFirst+1; /* LAPACK indices are 1-based */
+    iu = idxLast+1;
+    nEig = idxLast-idxFirst+1;
+    vl = vu = 0.0f;
+    abstol = 0.0f;
+    m = 0;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cseigr_create((void**)&h, dim);
+    else{
+        h = (utility_cseigr_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+    z = h->z;
+    w = h->w;
+
+    /* store in column major order (i.e. transpose) */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[i*dim+j] = A[j*dim+i];
+
+    /* solve the eigenproblem, for the requested eigenvalues/vectors only */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cheevr_( "Vectors", "Indices", "Upper", &n, (veclib_float_complex*)a, &lda, &vl, &vu, &il, &iu, &abstol, &m, w, (veclib_float_complex*)z, &ldz,
+             h->isuppz, (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &(h->lrwork), h->iwork, &(h->liwork), &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cheevr_work(CblasColMajor, 'V', 'I', 'U', n, (veclib_float_complex*)a, lda, vl, vu, il, iu, abstol, &m, w,
+                               (veclib_float_complex*)z, ldz, h->isuppz, (veclib_float_complex*)h->work, h->lwork, h->rwork, h->lrwork, h->iwork, h->liwork);
+#endif
+
+    /* output */
+    if( info != 0 || m != nEig ) {
+        /* failed to converge and find the eigenvalues */
+        if(V!=NULL)
+            memset(V, 0, dim*nEig*sizeof(float_complex));
+        if(eig!=NULL)
+            memset(eig, 0, nEig*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+
+    /* transpose, back to row-major and reverse order if requested */
+    else{
+        if(sortDecFLAG){
+            for(i=0; i<nEig; i++) {
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[j*nEig+i] = z[(nEig-i-1)*dim+j];
+                if(eig!=NULL)
+                    eig[i] = w[nEig-i-1];
+            }
+        }
+        else {
+            for(i=0; i<nEig; i++){
+                if(V!=NULL)
+                    for(j=0; j<dim; j++)
+                        V[j*nEig+i] = z[i*dim+j];
+                if(eig!=NULL)
+                    eig[i] = w[i];
+            }
+        }
+    }
+
+    if(hWork==NULL)
+        utility_cseigr_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                     Eigenvalues of Matrix Pair (?eigmp)                    */
+/* ========================================================================== */
+
+/** Data structure for utility_ceigmp() */
+typedef struct _utility_ceigmp_data {
+    int maxDim;
+    int lwork;
+    float_complex* a, *b, *vl, *vr, *alpha, *beta, *work;
+    float* rwork;
+}utility_ceigmp_data;
+
+void utility_ceigmp_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_ceigmp_data));
+    utility_ceigmp_data *h = (utility_ceigmp_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->b = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->vl = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->vr = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->alpha = malloc1d(maxDim*sizeof(float_complex));
+    h->beta = malloc1d(maxDim*sizeof(float_complex));
+    h->lwork = 4*maxDim; /* 2x more than required, but is faster */
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+    h->rwork = malloc1d(4*(h->lwork)*sizeof(float)); /* 2x more than required, but is faster */
+}
+
+void utility_ceigmp_destroy
+(
+    void ** const phWork
+)
+{
+    utility_ceigmp_data *h = (utility_ceigmp_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->b);
+        free(h->vl);
+        free(h->vr);
+        free(h->alpha);
+        free(h->beta);
+        free(h->work);
+        free(h->rwork);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_ceigmp
+(
+    void* const hWork,
+    const float_complex* A,
+    const float_complex* B,
+    const int dim,
+    float_complex* VL,
+    float_complex* VR,
+    float_complex* D
+)
+{
+    utility_ceigmp_data *h;
+    int i, j;
+    int n, lda, ldb, ldvl, ldvr, info;
+    float_complex* a, *b, *vl, *vr, *alpha, *beta;
+
+    n = lda = ldb = ldvl = ldvr = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_ceigmp_create((void**)&h, dim);
+    else{
+        h = (utility_ceigmp_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+    b = h->b;
+    vl = h->vl;
+    vr = h->vr;
+    alpha = h->alpha;
+    beta = h->beta;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            b[j*dim+i] = B[i*dim+j];
+
+    /* solve eigen problem */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cggev_("V", "V", &n, (veclib_float_complex*)a, &lda, (veclib_float_complex*)b, &ldb, (veclib_float_complex*)alpha, (veclib_float_complex*)beta,
+           (veclib_float_complex*)vl, &ldvl, (veclib_float_complex*)vr, &ldvr, (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &info);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cggev_work(CblasColMajor, 'V', 'V', n, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb, (veclib_float_complex*)alpha,
+                              (veclib_float_complex*)beta, (veclib_float_complex*)vl, ldvl, (veclib_float_complex*)vr, ldvr,
+                              (veclib_float_complex*)h->work, h->lwork, h->rwork);
+#endif
+
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(float_complex));
+
+    /* failed to converge and find the eigenvalues */
+    if( info != 0 ) {
+        if(VL!=NULL)
+            memset(VL, 0, dim*dim*sizeof(float_complex));
+        if(VR!=NULL)
+            memset(VR, 0, dim*dim*sizeof(float_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+    /* transpose, back to row-major */
+    else{
+        if(D!=NULL)
+            for(i=0; i<dim; i++)
+                D[i*dim+i] = ccdivf(alpha[i],beta[i]);
+
+        if(VL!=NULL)
+            for(i=0; i<dim; i++)
+                for(j=0; j<dim; j++)
+                    VL[i*dim+j] = vl[j*dim+i];
+        if(VR!=NULL)
+            for(i=0; i<dim; i++)
+                for(j=0; j<dim; j++)
+                    VR[i*dim+j] = vr[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_ceigmp_destroy((void**)&h);
+}
+
+/** Data structure for utility_zeigmp() */
+typedef struct _utility_zeigmp_data {
+    int maxDim;
+    int lwork;
+    double_complex* a, *b, *vl, *vr, *alpha, *beta, *work;
+    double* rwork;
+}utility_zeigmp_data;
+
+void utility_zeigmp_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_zeigmp_data));
+    utility_zeigmp_data *h = (utility_zeigmp_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->a = malloc1d(maxDim*maxDim*sizeof(double_complex));
+    h->b = malloc1d(maxDim*maxDim*sizeof(double_complex));
+    h->vl = malloc1d(maxDim*maxDim*sizeof(double_complex));
+    h->vr = malloc1d(maxDim*maxDim*sizeof(double_complex));
+    h->alpha = malloc1d(maxDim*sizeof(double_complex));
+    h->beta = malloc1d(maxDim*sizeof(double_complex));
+    h->lwork = 4*maxDim; /* 2x more than required, but is faster */
+    h->work = malloc1d(h->lwork*sizeof(double_complex));
+    h->rwork = malloc1d(4*(h->lwork)*sizeof(double)); /* 2x more than required, but is faster */
+}
+
+void utility_zeigmp_destroy
+(
+    void ** const phWork
+)
+{
+    utility_zeigmp_data *h = (utility_zeigmp_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->b);
+        free(h->vl);
+        free(h->vr);
+        free(h->alpha);
+        free(h->beta);
+        free(h->work);
+        free(h->rwork);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_zeigmp
+(
+    void* const hWork,
+    const double_complex* A,
+    const double_complex* B,
+    const int dim,
+    double_complex* VL,
+    double_complex* VR,
+    double_complex* D
+)
+{
+    utility_zeigmp_data *h;
+    int i, j;
+    int n, lda, ldb, ldvl, ldvr, info;
+    double_complex* a, *b, *vl, *vr, *alpha, *beta;
+
+    n = lda = ldb = ldvl = ldvr = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_zeigmp_create((void**)&h, dim);
+    else{
+        h = (utility_zeigmp_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+    b = h->b;
+    vl = h->vl;
+    vr = h->vr;
+    alpha = h->alpha;
+    beta = h->beta;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            b[j*dim+i] = B[i*dim+j]; /* store in column major order */
+
+    /* solve eigen problem */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    zggev_("V", "V", &n, (veclib_double_complex*)a, &lda, (veclib_double_complex*)b, &ldb, (veclib_double_complex*)alpha, (veclib_double_complex*)beta,
+           (veclib_double_complex*)vl, &ldvl, (veclib_double_complex*)vr, &ldvr, (veclib_double_complex*)h->work, &(h->lwork), h->rwork, &info);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_zggev_work(CblasColMajor, 'V', 'V', n, (veclib_double_complex*)a, lda, (veclib_double_complex*)b, ldb, (veclib_double_complex*)alpha,
+                              (veclib_double_complex*)beta, (veclib_double_complex*)vl, ldvl, (veclib_double_complex*)vr, ldvr,
+                              (veclib_double_complex*)h->work, h->lwork, h->rwork);
+#endif
+
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(double_complex));
+
+    /* failed to converge and find the eigenvalues */
+    if( info != 0 ) {
+        if(VL!=NULL)
+            memset(VL, 0, dim*dim*sizeof(double_complex));
+        if(VR!=NULL)
+            memset(VR, 0, dim*dim*sizeof(double_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+    /* transpose, back to row-major */
+    else{
+        if(D!=NULL)
+            for(i=0; i<dim; i++)
+                D[i*dim+i] = ccdiv(alpha[i],beta[i]);
+
+        if(VL!=NULL)
+            for(i=0; i<dim; i++)
+                for(j=0; j<dim; j++)
+                    VL[i*dim+j] = vl[j*dim+i];
+        if(VR!=NULL)
+            for(i=0; i<dim; i++)
+                for(j=0; j<dim; j++)
+                    VR[i*dim+j] = vr[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_zeigmp_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                       Eigenvalue Decomposition (?eig)                      */
+/* ========================================================================== */
+
+/** Data structure for utility_ceig() */
+typedef struct _utility_ceig_data {
+    int maxDim;
+    int lwork;
+    float_complex* w, *vl, *vr, *a, *work;
+    float* rwork, *wr;
+    int* sort_idx;
+}utility_ceig_data;
+
+void utility_ceig_create
+(
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_ceig_data));
+    utility_ceig_data *h = (utility_ceig_data*)(*phWork);
+    int n, lda, ldvl, ldvr, info, lworkMin;
+    float_complex wkopt;
+
+    h->maxDim = maxDim;
+    n = lda = ldvl = ldvr = maxDim;
+    h->w = malloc1d(maxDim*sizeof(float_complex));
+    h->vl = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->vr = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->rwork = malloc1d(2*maxDim*sizeof(float));
+    h->wr = malloc1d(maxDim*sizeof(float));
+    h->sort_idx = malloc1d(maxDim*sizeof(int));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 2*n);
+    wkopt = cmplxf((float)lworkMin, 0.0f);
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    cgeev_( "Vectors", "Vectors", &n, (veclib_float_complex*)h->a, &lda, (veclib_float_complex*)h->w, (veclib_float_complex*)h->vl, &ldvl,
+           (veclib_float_complex*)h->vr, &ldvr, (veclib_float_complex*)&wkopt, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgeev_work(CblasColMajor, 'V', 'V', n, (veclib_float_complex*)h->a, lda, (veclib_float_complex*)h->w, (veclib_float_complex*)h->vl, ldvl,
+                              (veclib_float_complex*)h->vr, ldvr, (veclib_float_complex*)&wkopt, -1, h->rwork);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)(crealf(wkopt)+0.01f)) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+}
+
+void utility_ceig_destroy
+(
+    void ** const phWork
+)
+{
+    utility_ceig_data *h = (utility_ceig_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->w);
+        free(h->vl);
+        free(h->vr);
+        free(h->a);
+        free(h->rwork);
+        free(h->wr);
+        free(h->sort_idx);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_ceig
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim,
+    int sortDecFLAG,
+    float_complex* VL,
+    float_complex* VR,
+    float_complex* D,
+    float* eig
+)
+{
+    utility_ceig_data *h;
+    int i, j, n, lda, ldvl, ldvr, info;
+    float_complex *w, *vl, *vr, *a;
+    float* wr;
+    int* sort_idx;
+
+    n = lda = ldvl = ldvr = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_ceig_create((void**)&h, dim);
+    else{
+        h = (utility_ceig_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    w = h->w;
+    vl = h->vl;
+    vr = h->vr;
+    a = h->a;
+    wr = h->wr;
+    sort_idx = h->sort_idx;
+
+    /* store in column major order (i.e. transpose) */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[i*dim+j] = A[j*dim+i];
+
+	assert(0); /* below code was crashing. Consider using utility_cseig instead, if A is hermitian */
+
+    /* solve the eigenproblem */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cgeev_( "Vectors", "Vectors", &n, (veclib_float_complex*)a, &lda, (veclib_float_complex*)w, (veclib_float_complex*)vl, &ldvl,
+           (veclib_float_complex*)vr, &ldvr, (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgeev_work(CblasColMajor, 'V', 'V', n, (veclib_float_complex*)a, lda, (veclib_float_complex*)w, (veclib_float_complex*)vl, ldvl,
+                              (veclib_float_complex*)vr, ldvr, (veclib_float_complex*)h->work, h->lwork, h->rwork);
+#endif
+
+    /* sort the eigenvalues */
+    for(i=0; i<dim; i++)
+        wr[i] = crealf(w[i]);
+    sortf(wr, NULL, sort_idx, dim, sortDecFLAG);
+
+    /* output */
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(float_complex));
+
+    /* failed to converge and find the eigenvalues */
+    if( info != 0 ) {
+        if(VL!=NULL)
+            memset(VL, 0, dim*dim*sizeof(float_complex));
+        if(VR!=NULL)
+            memset(VR, 0, dim*dim*sizeof(float_complex));
+        if(eig!=NULL)
+            memset(eig, 0, dim*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#endif
+    }
+    /* transpose, back to row-major */
+    else{
+        for(i=0; i<dim; i++){
+            if(VL!=NULL)
+                for(j=0; j<dim; j++)
+                    VL[i*dim+j] = vl[sort_idx[j]*dim+i];
+            if(VR!=NULL)
+                for(j=0; j<dim; j++)
+                    VR[i*dim+j] = vr[sort_idx[j]*dim+i];
+            if(D!=NULL)
+                D[i*dim+i] = cmplxf(wr[i], 0.0f); /* store along the diagonal */
+            if(eig!=NULL)
+                eig[i] = wr[i];
+        }
+    }
+
+    if(hWork==NULL)
+        utility_ceig_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                       General Linear Solver (?glslv)                       */
+/* ========================================================================== */
+
+/** Data structure for utility_sglslv() */
+typedef struct _utility_sglslv_data {
+    int maxDim, maxNCol;
+    int* IPIV;
+    float* a, *b;
+}utility_sglslv_data;
+
+void utility_sglslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_sglslv_data));
+    utility_sglslv_data *h = (utility_sglslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->IPIV = malloc1d(maxDim*sizeof(int));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(float));
+}
+
+void utility_sglslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_sglslv_data *h = (utility_sglslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->IPIV);
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_sglslv
+(
+    void* const hWork,
+    const float* A,
+    const int dim,
+    float* B,
+    int nCol,
+    float* X
+)
+{
+    utility_sglslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    int* IPIV;
+    float* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_sglslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_sglslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    IPIV = h->IPIV;
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#ifdef VECLIB_USE_CLAPACK_INTERFACE
+    info = clapack_sgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    sgesv_( &n, &nrhs, a, &lda, IPIV, b, &ldb, &info );
+#endif
+
+    /* A is singular, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_sglslv_destroy((void**)&h);
+}
+
+/** Data structure for utility_cglslv() */
+typedef struct _utility_cglslv_data {
+    int maxDim, maxNCol;
+    int* IPIV;
+    float_complex* a, *b;
+}utility_cglslv_data;
+
+void utility_cglslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_cglslv_data));
+    utility_cglslv_data *h = (utility_cglslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->IPIV = malloc1d(maxDim*sizeof(int));
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(float_complex));
+}
+
+void utility_cglslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cglslv_data *h = (utility_cglslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->IPIV);
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cglslv
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim,
+    float_complex* B,
+    int nCol,
+    float_complex* X
+)
+{
+    utility_cglslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    int* IPIV;
+    float_complex* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cglslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_cglslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    IPIV = h->IPIV;
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cgesv_( &n, &nrhs, (veclib_float_complex*)a, &lda, IPIV, (veclib_float_complex*)b, &ldb, &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    info = clapack_cgesv(CblasColMajor, n, nrhs, (veclib_float_complex*)a, lda, IPIV, (veclib_float_complex*)b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgesv(CblasColMajor, n, nrhs, (veclib_float_complex*)a, lda, IPIV, (veclib_float_complex*)b, ldb);
+#endif
+
+    /* A is singular, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(float_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_cglslv_destroy((void**)&h);
+}
+
+/** Data structure for utility_dglslv() */
+typedef struct _utility_dglslv_data {
+    int maxDim, maxNCol;
+    int* IPIV;
+    double* a, *b;
+}utility_dglslv_data;
+
+void utility_dglslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_dglslv_data));
+    utility_dglslv_data *h = (utility_dglslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->IPIV = malloc1d(maxDim*sizeof(int));
+    h->a = malloc1d(maxDim*maxDim*sizeof(double));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(double));
+}
+
+void utility_dglslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_dglslv_data *h = (utility_dglslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->IPIV);
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_dglslv
+(
+    void* const hWork,
+    const double* A,
+    const int dim,
+    double* B,
+    int nCol,
+    double* X
+)
+{
+    utility_dglslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    int* IPIV;
+    double* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_dglslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_dglslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    IPIV = h->IPIV;
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#ifdef VECLIB_USE_CLAPACK_INTERFACE
+    info = clapack_dgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_dgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    dgesv_( &n, &nrhs, a, &lda, IPIV, b, &ldb, &info );
+#endif
+
+    /* A is singular, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(double));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_dglslv_destroy((void**)&h);
+}
+
+/** Data structure for utility_zglslv() */
+typedef struct _utility_zglslv_data {
+    int maxDim, maxNCol;
+    int* IPIV;
+    double_complex* a, *b;
+}utility_zglslv_data;
+
+void utility_zglslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_zglslv_data));
+    utility_zglslv_data *h = (utility_zglslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->IPIV = malloc1d(maxDim*sizeof(int));
+    h->a = malloc1d(maxDim*maxDim*sizeof(double_complex));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(double_complex));
+}
+
+void utility_zglslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_zglslv_data *h = (utility_zglslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->IPIV);
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_zglslv
+(
+    void* const hWork,
+    const double_complex* A,
+    const int dim,
+    double_complex* B,
+    int nCol,
+    double_complex* X
+)
+{
+    utility_zglslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    int* IPIV;
+    double_complex* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_zglslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_zglslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    IPIV = h->IPIV;
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    zgesv_( &n, &nrhs, (veclib_double_complex*)a, &lda, IPIV, (veclib_double_complex*)b, &ldb, &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    info = clapack_zgesv(CblasColMajor, n, nrhs, (veclib_double_complex*)a, lda, IPIV, (veclib_double_complex*)b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_zgesv(CblasColMajor, n, nrhs, (veclib_double_complex*)a, lda, IPIV, (veclib_double_complex*)b, ldb);
+#endif
+
+    /* A is singular, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(double_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_zglslv_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                      Symmetric Linear Solver (?slslv)                      */
+/* ========================================================================== */
+
+/** Data structure for utility_sslslv() */
+typedef struct _utility_sslslv_data {
+    int maxDim, maxNCol;
+    float* a, *b;
+}utility_sslslv_data;
+
+void utility_sslslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_sslslv_data));
+    utility_sslslv_data *h = (utility_sslslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->a = malloc1d(maxDim*maxDim*sizeof(float));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(float));
+}
+
+void utility_sslslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_sslslv_data *h = (utility_sslslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_sslslv
+(
+    void* const hWork,
+    const float* A,
+    const int dim,
+    float* B,
+    int nCol,
+    float* X
+)
+{
+    utility_sslslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    float* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_sslslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_sslslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#ifdef VECLIB_USE_CLAPACK_INTERFACE
+    info = clapack_sposv(CblasColMajor, CblasUpper, n, nrhs, a, lda, b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sposv(CblasColMajor, CblasUpper, n, nrhs, a, lda, b, ldb);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    sposv_( "U", &n, &nrhs, a, &lda, b, &ldb, &info );
+#endif
+
+    /* A is not symmetric positive definate, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(float));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_sslslv_destroy((void**)&h);
+}
+
+/** Data structure for utility_cslslv() */
+typedef struct _utility_cslslv_data {
+    int maxDim, maxNCol;
+    float_complex* a, *b;
+}utility_cslslv_data;
+
+void utility_cslslv_create
+(
+    void ** const phWork,
+    int maxDim,
+    int maxNCol
+)
+{
+    *phWork = malloc1d(sizeof(utility_cslslv_data));
+    utility_cslslv_data *h = (utility_cslslv_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->maxNCol = maxNCol;
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+    h->b = malloc1d(maxDim*maxNCol*sizeof(float_complex));
+}
+
+void utility_cslslv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cslslv_data *h = (utility_cslslv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->b);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cslslv
+(
+    void* const hWork,
+    const float_complex* A,
+    const int dim,
+    float_complex* B,
+    int nCol,
+    float_complex* X
+)
+{
+    utility_cslslv_data *h;
+    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
+    float_complex* a, *b;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cslslv_create((void**)&h, dim, nCol);
+    else{
+        h = (utility_cslslv_data*)(hWork);
+        assert(dim<=h->maxDim && nCol<=h->maxNCol);
+    }
+    a = h->a;
+    b = h->b;
+
+    /* store in column major order */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[j*dim+i] = A[i*dim+j];
+    for(i=0; i<dim; i++)
+        for(j=0; j<nCol; j++)
+            b[j*dim+i] = B[i*nCol+j];
+
+    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cposv_( "U", &n, &nrhs, (veclib_float_complex*)a, &lda, (veclib_float_complex*)b, &ldb, &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    info = clapack_cposv(CblasColMajor, CblasUpper, n, nrhs, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cposv(CblasColMajor, CblasUpper, n, nrhs, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb);
+#endif
+
+    /* A is not symmetric positive definate, solution not possible */
+    if(info!=0){
+        memset(X, 0, dim*nCol*sizeof(float_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
+#endif
+    }
+    /* store solution in row-major order */
+    else{
+        for(i=0; i<dim; i++)
+            for(j=0; j<nCol; j++)
+                X[i*nCol+j] = b[j*dim+i];
+    }
+
+    if(hWork==NULL)
+        utility_cslslv_destroy((void**)&h);
+}
+
+
+/* ========================================================================== */
+/*                        Matrix Pseudo-Inverse (?pinv)                       */
+/* ========================================================================== */
+
+/** Data structure for utility_spinv() */
+typedef struct _utility_spinv_data {
+    int maxDim1, maxDim2;
+    int lwork;
+    float* a, *u, *vt, *inva, *work;
+    float* s;
+}utility_spinv_data;
+
+void utility_spinv_create
+(
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
+)
+{
+    *phWork = malloc1d(sizeof(utility_spinv_data));
+    utility_spinv_data *h = (utility_spinv_data*)(*phWork);
+    int m, n, k, lda, ldu, ldvt, info, lworkMin;
+    float wkopt;
+
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = maxDim2;
+    k = ldvt = MIN(m, n);
+    h->a = malloc1d(m*n*sizeof(float));
+    h->s = malloc1d(k*sizeof(float));
+    h->u = malloc1d(ldu*k*sizeof(float));
+    h->vt = malloc1d(ldvt*n*sizeof(float));
+    h->inva = malloc1d(n*m*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, MAX(3*MIN(m,n)+MAX(m,n), 5*MIN(m,n)));
+    wkopt = (float)lworkMin;
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    sgesvd_( "S", "S", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, &wkopt, &(h->lwork), &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sgesvd_work(CblasColMajor, 'S', 'S', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, &wkopt, -1);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)wkopt) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float));
+}
+
+void utility_spinv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_spinv_data *h = (utility_spinv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->inva);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_spinv
+(
+    void* const hWork,
+    const float* inM,
+    const int dim1,
+    const int dim2,
+    float* outM
+)
+{
+    utility_spinv_data *h;
+    int i, j, m, n, k, lda, ldu, ldvt, info;
+    float ss;
+
+    m = lda = ldu = dim1;
+    n = dim2;
+    k = ldvt = MIN(m, n);
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_spinv_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_spinv_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
+    /* store in column major order */
+    for(i=0; i<m; i++)
+        for(j=0; j<n; j++)
+            h->a[j*m+i] = inM[i*n+j];
+
+    /* singular value decomposition */
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    sgesvd_( "S", "S", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, h->work, &(h->lwork), &info );
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_sgesvd_work(CblasColMajor, 'S', 'S', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, h->work, h->lwork);
+#endif
+
+    if( info != 0 ) {
+        memset(outM, 0, dim1*dim2*sizeof(float));
 #ifndef NDEBUG
         saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
 #endif
     }
-    /* svd successful */
     else {
-        if (S != NULL){
-            memset(S, 0, dim1*dim2*sizeof(float));
-            /* singular values on the diagonal MIN(dim1, dim2). The remaining elements are 0.  */
-            for(i=0; i<MIN(dim1, dim2); i++)
-                S[i*dim2+i] = s[i];
+        for(i=0; i<k; i++){
+            if(h->s[i] > 1.0e-5f)
+                ss=1.0f/h->s[i];
+            else
+                ss=h->s[i];
+            cblas_sscal(m, ss, &(h->u[i*m]), 1);
         }
-        
-        /*return as row-major*/
-        if (U != NULL)
-            for(i=0; i<dim1; i++)
-                for(j=0; j<dim1; j++)
-                    U[i*dim1+j] = u[j*dim1+i];
-        
-        /* lapack returns VT, i.e. row-major V already */
-        if (V != NULL)
-            for(i=0; i<dim2; i++)
-                for(j=0; j<dim2; j++)
-                    V[i*dim2+j] = vt[i*dim2+j];
-        
-        if (sing != NULL)
-            for(i=0; i<MIN(dim1, dim2); i++)
-                sing[i] = s[i];
+        cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, n, m, k, 1.0f,
+                    h->vt, ldvt,
+                    h->u, ldu, 0.0f,
+                    h->inva, n);
+
+        /* return in row-major order */
+        for(i=0; i<m; i++)
+            for(j=0; j<n; j++)
+                outM[j*m+i] = h->inva[i*n+j];
     }
-    
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
+
+    if(hWork==NULL)
+        utility_spinv_destroy((void**)&h);
 }
 
-void utility_csvd
+/** Data structure for utility_cpinv() */
+typedef struct _utility_cpinv_data {
+    int maxDim1, maxDim2;
+    int lwork;
+    float_complex* a, *u, *vt, *inva, *work;
+    float* s;
+    float* rwork;
+}utility_cpinv_data;
+
+void utility_cpinv_create
 (
-    const float_complex* A,
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
+)
+{
+    *phWork = malloc1d(sizeof(utility_cpinv_data));
+    utility_cpinv_data *h = (utility_cpinv_data*)(*phWork);
+    int m, n, k, lda, ldu, ldvt, info, lworkMin;
+    float_complex wkopt;
+
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = maxDim2;
+    k = ldvt = MIN(m, n);
+    h->a = malloc1d(m*n*sizeof(float_complex));
+    h->s = malloc1d(k*sizeof(float));
+    h->u = malloc1d(ldu*k*sizeof(float_complex));
+    h->vt = malloc1d(ldvt*n*sizeof(float_complex));
+    h->inva = malloc1d(n*m*sizeof(float_complex));
+    h->rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(float));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 2*MIN(m,n)+MAX(m,n));
+    wkopt = cmplxf((float)lworkMin, 0.0f);
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    cgesvd_( "S", "S", &m, &n, (veclib_float_complex*)h->a, &lda, h->s, (veclib_float_complex*)h->u, &ldu, (veclib_float_complex*)h->vt, &ldvt,
+            (veclib_float_complex*)&wkopt, &(h->lwork), h->rwork, &info );
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgesvd_work(CblasColMajor, 'S', 'S', m, n, (veclib_float_complex*)h->a, lda, h->s, (veclib_float_complex*)h->u, ldu, (veclib_float_complex*)h->vt, ldvt,
+                               (veclib_float_complex*)&wkopt, -1, h->rwork);
+#endif
+    h->lwork = info==0 ? MAX(lworkMin, (int)(crealf(wkopt)+0.01f)) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(float_complex));
+}
+
+void utility_cpinv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cpinv_data *h = (utility_cpinv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->inva);
+        free(h->rwork);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cpinv
+(
+    void* const hWork,
+    const float_complex* inM,
     const int dim1,
     const int dim2,
-    float_complex* U,
-    float_complex* S,
-    float_complex* V,
-    float* sing
+    float_complex* outM
 )
 {
-    int i, j, m, n, lda, ldu, ldvt, info;
-    m = dim1; n = dim2; lda = dim1; ldu = dim1; ldvt = dim2;
-    float_complex* a, *u, *vt, *work;
-    float* s;
+    utility_cpinv_data *h;
+    int i, j, m, n, k, lda, ldu, ldvt, info;
+    float ss;
+    float_complex ss_cmplx;
+    const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f); /* blas */
+
+    m = lda = ldu = dim1;
+    n = dim2;
+    k = ldvt = MIN(m, n);
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cpinv_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_cpinv_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
+    /* store in column major order */
+    for(i=0; i<m; i++)
+        for(j=0; j<n; j++)
+            h->a[j*m+i] = inM[i*n+j];
+
+    /* singular value decomposition */
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cgesvd_( "S", "S", &m, &n, (veclib_float_complex*)h->a, &lda, h->s, (veclib_float_complex*)h->u, &ldu, (veclib_float_complex*)h->vt, &ldvt,
+            (veclib_float_complex*)h->work, &(h->lwork), h->rwork, &info);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    assert(0); /* no such implementation in clapack */
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    info = LAPACKE_cgesvd_work(CblasColMajor, 'S', 'S', m, n, (veclib_float_complex*)h->a, lda, h->s, (veclib_float_complex*)h->u, ldu, (veclib_float_complex*)h->vt, ldvt,
+                               (veclib_float_complex*)h->work, h->lwork, h->rwork);
+#endif
+
+    if( info != 0 ) {
+        memset(outM, 0, dim1*dim2*sizeof(float_complex));
+#ifndef NDEBUG
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
+#endif
+    }
+    else {
+        for(i=0; i<k; i++){
+            if(h->s[i] > 1.0e-5f)
+                ss=1.0f/h->s[i];
+            else
+                ss=h->s[i];
+            ss_cmplx = cmplxf(ss, 0.0f);
+            cblas_cscal(m, &ss_cmplx, &(h->u[i*m]), 1);
+        }
+        cblas_cgemm(CblasColMajor, CblasConjTrans, CblasConjTrans, n, m, k, &calpha,
+                    h->vt, ldvt,
+                    h->u, ldu, &cbeta,
+                    h->inva, n);
+
+        /* return in row-major order */
+        for(i=0; i<m; i++)
+            for(j=0; j<n; j++)
+                outM[j*m+i] = h->inva[i*n+j];
+    }
+
+    if(hWork==NULL)
+        utility_cpinv_destroy((void**)&h);
+}
+
+/** Data structure for utility_dpinv() */
+typedef struct _utility_dpinv_data {
+    int maxDim1, maxDim2;
     int lwork;
-    float_complex wkopt;
-    float* rwork;
+    double* a, *u, *vt, *inva, *work;
+    double* s;
+}utility_dpinv_data;
+
+void utility_dpinv_create
+(
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
+)
+{
+    *phWork = malloc1d(sizeof(utility_dpinv_data));
+    utility_dpinv_data *h = (utility_dpinv_data*)(*phWork);
+    int m, n, k, lda, ldu, ldvt, info, lworkMin;
+    double wkopt;
+
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = maxDim2;
+    k = ldvt = MIN(m, n);
+    h->a = malloc1d(m*n*sizeof(double));
+    h->s = malloc1d(k*sizeof(double));
+    h->u = malloc1d(ldu*k*sizeof(double));
+    h->vt = malloc1d(ldvt*n*sizeof(double));
+    h->inva = malloc1d(n*m*sizeof(double));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, MAX(3*MIN(m,n)+MAX(m,n), 5*MIN(m,n)));
+    wkopt = (double)lworkMin;
+    info = 0;
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    h->lwork = -1;
+    dgesvd_( "S", "S", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, &wkopt, &(h->lwork), &info );
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    float* superb;
+    info = LAPACKE_dgesvd_work(CblasColMajor, 'S', 'S', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, &wkopt, -1);
 #endif
-    
-    a = malloc1d(lda*n*sizeof(float_complex));
-    s = malloc1d(MIN(n,m)*sizeof(float));
-    u = malloc1d(ldu*m*sizeof(float_complex));
-    vt = malloc1d(ldvt*n*sizeof(float_complex));
-    
+    h->lwork = info==0 ? MAX(lworkMin, (int)wkopt) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(double));
+}
+
+void utility_dpinv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_dpinv_data *h = (utility_dpinv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->inva);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_dpinv
+(
+    void* const hWork,
+    const double* inM,
+    const int dim1,
+    const int dim2,
+    double* outM
+)
+{
+    utility_dpinv_data *h;
+    int i, j, m, n, k, lda, ldu, ldvt, info;
+    double ss;
+
+    m = lda = ldu = dim1;
+    n = dim2;
+    k = ldvt = MIN(m, n);
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_dpinv_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_dpinv_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
     /* store in column major order */
-    for(i=0; i<dim1; i++)
-        for(j=0; j<dim2; j++)
-            a[j*dim1+i] = A[i*dim2 +j];
-    
-    /* perform the singular value decomposition */
+    for(i=0; i<m; i++)
+        for(j=0; j<n; j++)
+            h->a[j*m+i] = inM[i*n+j];
+
+    /* singular value decomposition */
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(float));
-    lwork = -1;
-    cgesvd_( "A", "A", (veclib_int*)&m, (veclib_int*)&n, (veclib_float_complex*)a, (veclib_int*)&lda, s, (veclib_float_complex*)u, (veclib_int*)&ldu,
-            (veclib_float_complex*)vt, &ldvt, (veclib_float_complex*)&wkopt, &lwork, rwork, (veclib_int*)&info );
-    lwork = (int)(crealf(wkopt)+0.01f);
-    work = malloc1d( lwork*sizeof(float_complex) );
-    cgesvd_( "A", "A", &m, &n, (veclib_float_complex*)a, &lda, s, (veclib_float_complex*)u, &ldu, (veclib_float_complex*)vt, &ldvt,
-            (veclib_float_complex*)work, &lwork, rwork, &info);
-    free(work);
-    free(rwork);
+    dgesvd_( "S", "S", &m, &n, h->a, &lda, h->s, h->u, &ldu, h->vt, &ldvt, h->work, &(h->lwork), &info );
 #elif defined(VECLIB_USE_CLAPACK_INTERFACE)
     assert(0); /* no such implementation in clapack */
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(float));
-    info = LAPACKE_cgesvd(CblasColMajor, 'A', 'A', m, n, (veclib_float_complex*)a, lda, s, (veclib_float_complex*)u, ldu, vt, ldvt, superb);
-    free(superb);
+    info = LAPACKE_dgesvd_work(CblasColMajor, 'S', 'S', m, n, h->a, lda, h->s, h->u, ldu, h->vt, ldvt, h->work, h->lwork);
 #endif
 
-    /* svd failed to converge */
     if( info != 0 ) {
-        if (S != NULL)
-            memset(S, 0, dim1*dim2*sizeof(float_complex));
-        if (U != NULL)
-            memset(U, 0, dim1*dim1*sizeof(float_complex));
-        if (V != NULL)
-            memset(U, 0, dim2*dim2*sizeof(float_complex));
-        if (sing != NULL)
-            memset(sing, 0, MIN(dim1, dim2)*sizeof(float_complex));
+        memset(outM, 0, dim1*dim2*sizeof(double));
 #ifndef NDEBUG
         saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
 #endif
     }
-    /* svd successful */
     else {
-        if (S != NULL){
-            memset(S, 0, dim1*dim2*sizeof(float_complex));
-            /* singular values on the diagonal MIN(dim1, dim2). The remaining elements are 0.  */
-            for(i=0; i<MIN(dim1, dim2); i++)
-                S[i*dim2+i] = cmplxf(s[i], 0.0f);
+        for(i=0; i<k; i++){
+            if(h->s[i] > 1.0e-9)
+                ss=1.0/h->s[i];
+            else
+                ss=h->s[i];
+            cblas_dscal(m, ss, &(h->u[i*m]), 1);
         }
-        /*return as row-major*/
-        if (U != NULL)
-            for(i=0; i<dim1; i++)
-                for(j=0; j<dim1; j++)
-                    U[i*dim1+j] = u[j*dim1+i];
-        
-        /* lapack returns VT, i.e. row-major V already */
-        if (V != NULL)
-            for(i=0; i<dim2; i++)
-                for(j=0; j<dim2; j++)
-                    V[i*dim2+j] = conjf(vt[i*dim2+j]); /* v^H */
-        
-        if (sing != NULL)
-            for(i=0; i<MIN(dim1, dim2); i++)
-                sing[i] = s[i];
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, n, m, k, 1.0,
+                    h->vt, ldvt,
+                    h->u, ldu, 0.0,
+                    h->inva, n);
+
+        /* return in row-major order */
+        for(i=0; i<m; i++)
+            for(j=0; j<n; j++)
+                outM[j*m+i] = h->inva[i*n+j];
     }
-    
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
-}
 
+    if(hWork==NULL)
+        utility_dpinv_destroy((void**)&h);
+}
 
-/* ========================================================================== */
-/*                 Symmetric Eigenvalue Decomposition (?seig)                 */
-/* ========================================================================== */
+/** Data structure for utility_zpinv() */
+typedef struct _utility_zpinv_data {
+    int maxDim1, maxDim2;
+    int lwork;
+    double_complex* a, *u, *vt, *inva, *work;
+    double* s;
+    double* rwork;
+}utility_zpinv_data;
 
-void utility_sseig
+void utility_zpinv_create
 (
-    const float* A,
-    const int dim,
-    int sortDecFLAG,
-    float* V,
-    float* D,
-    float* eig
+    void ** const phWork,
+    int maxDim1,
+    int maxDim2
 )
 {
-    int i, j, n, lda, info, lwork;
-    float wkopt;
-    float* work, *w, *a;
+    *phWork = malloc1d(sizeof(utility_zpinv_data));
+    utility_zpinv_data *h = (utility_zpinv_data*)(*phWork);
+    int m, n, k, lda, ldu, ldvt, info, lworkMin;
+    double_complex wkopt;
 
-    n = dim;
-    lda = dim;
-    w = malloc1d(dim*sizeof(float));
-    a = malloc1d(dim*dim*sizeof(float));
-    
-    /* store in column major order (i.e. transpose) */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[i*dim+j] = A[j*dim+i];
-    
-    /* solve the eigenproblem */
+    h->maxDim1 = maxDim1;
+    h->maxDim2 = maxDim2;
+    m = lda = ldu = maxDim1;
+    n = maxDim2;
+    k = ldvt = MIN(m, n);
+    h->a = malloc1d(m*n*sizeof(double_complex));
+    h->s = malloc1d(k*sizeof(double));
+    h->u = malloc1d(ldu*k*sizeof(double_complex));
+    h->vt = malloc1d(ldvt*n*sizeof(double_complex));
+    h->inva = malloc1d(n*m*sizeof(double_complex));
+    h->rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(double));
+
+    /* query the optimal workspace size for the maximum dimensions */
+    lworkMin = MAX(1, 2*MIN(m,n)+MAX(m,n));
+    wkopt = cmplx((double)lworkMin, 0.0);
+    info = 0;
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = -1;
-    ssyev_( "Vectors", "Upper", &n, a, &lda, w, &wkopt, &lwork, &info );
-    lwork = (int)wkopt;
-    work = (float*)malloc1d( lwork*sizeof(float) );
-    ssyev_( "Vectors", "Upper", &n, a, &lda, w, work, &lwork, &info );
-    free(work);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
+    h->lwork = -1;
+    zgesvd_( "S", "S", &m, &n, (veclib_double_complex*)h->a, &lda, h->s, (veclib_double_complex*)h->u, &ldu, (veclib_double_complex*)h->vt, &ldvt,
+            (veclib_double_complex*)&wkopt, &(h->lwork), h->rwork, &info );
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_ssyev(CblasColMajor, 'V', 'U', n, a, lda, w );
+    info = LAPACKE_zgesvd_work(CblasColMajor, 'S', 'S', m, n, (veclib_double_complex*)h->a, lda, h->s, (veclib_double_complex*)h->u, ldu, (veclib_double_complex*)h->vt, ldvt,
+                               (veclib_double_complex*)&wkopt, -1, h->rwork);
 #endif
-    
-    /* output */
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(float));
-    if( info != 0 ) {
-        /* failed to converge and find the eigenvalues */
-        if(V!=NULL)
-            memset(V, 0, dim*dim*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
-#endif
-    }
-    else{
-        if(sortDecFLAG){
-            for(i=0; i<dim; i++){
-                if(V!=NULL)
-                    for(j=0; j<dim; j++)
-                        V[i*dim+j] = a[(dim-j-1)*dim+i]; /* transpose, back to row-major and reverse order */
-                if(D!=NULL)
-                    D[i*dim+i] = w[dim-i-1]; /* store along the diagonal, reversing the order */
-                if(eig!=NULL)
-                    eig[i] = w[dim-i-1];
-            }
-        }
-        else{
-            for(i=0; i<dim; i++){
-                if(V!=NULL)
-                    for(j=0; j<dim; j++)
-                        V[i*dim+j] = a[j*dim+i]; /* transpose, back to row-major */
-                if(D!=NULL)
-                    D[i*dim+i] = w[i]; /* store along the diagonal */
-                if(eig!=NULL)
-                    eig[i] = w[i];
-            }
-        }
+    h->lwork = info==0 ? MAX(lworkMin, (int)(creal(wkopt)+0.01)) : lworkMin; /* (the documented minimum, should the query fail) */
+    h->work = malloc1d(h->lwork*sizeof(double_complex));
+}
+
+void utility_zpinv_destroy
+(
+    void ** const phWork
+)
+{
+    utility_zpinv_data *h = (utility_zpinv_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h->s);
+        free(h->u);
+        free(h->vt);
+        free(h->inva);
+        free(h->rwork);
+        free(h->work);
+        free(h);
+        *phWork = NULL;
     }
-    
-    free(w);
-    free(a);
 }
 
-void utility_cseig
+void utility_zpinv
 (
-    const float_complex* A,
-    const int dim,
-    int sortDecFLAG,
-    float_complex* V,
-    float_complex* D,
-    float* eig
+    void* const hWork,
+    const double_complex* inM,
+    const int dim1,
+    const int dim2,
+    double_complex* outM
 )
 {
-    int i, j, n, lda, info;
-    float_complex wkopt;
-    float *w;
-    float_complex* a;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    float *rwork;
-    float_complex *work;
-#endif
+    utility_zpinv_data *h;
+    int i, j, m, n, k, lda, ldu, ldvt, info;
+    double ss;
+    double_complex ss_cmplx;
+    const double_complex calpha = cmplx(1.0, 0.0); const double_complex cbeta = cmplx(0.0, 0.0); /* blas */
 
-    n = dim;
-    lda = dim;
-    w = malloc1d(dim*sizeof(float));
-    a = malloc1d(dim*dim*sizeof(float_complex));
-    
-    /* store in column major order (i.e. transpose) */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[i*dim+j] = A[j*dim+i];
-    
-    /* solve the eigenproblem */
+    m = lda = ldu = dim1;
+    n = dim2;
+    k = ldvt = MIN(m, n);
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_zpinv_create((void**)&h, dim1, dim2);
+    else{
+        h = (utility_zpinv_data*)(hWork);
+        assert(dim1<=h->maxDim1 && dim2<=h->maxDim2);
+    }
+
+    /* store in column major order */
+    for(i=0; i<m; i++)
+        for(j=0; j<n; j++)
+            h->a[j*m+i] = inM[i*n+j];
+
+    /* singular value decomposition */
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    rwork = malloc1d((3*n-2)*sizeof(float));
-    lwork = -1;
-    cheev_( "Vectors", "Upper", &n, (veclib_float_complex*)a, &lda, w, (veclib_float_complex*)&wkopt, &lwork, rwork, &info );
-    lwork = (int)crealf(wkopt);
-    work = (float_complex*)malloc1d( lwork*sizeof(float_complex) );
-    cheev_( "Vectors", "Upper", &n, (veclib_float_complex*)a, &lda, w, (veclib_float_complex*)work, &lwork, rwork, &info );
-    free(work);
-    free(rwork);
+    zgesvd_( "S", "S", &m, &n, (veclib_double_complex*)h->a, &lda, h->s, (veclib_double_complex*)h->u, &ldu, (veclib_double_complex*)h->vt, &ldvt,
+            (veclib_double_complex*)h->work, &(h->lwork), h->rwork, &info);
 #elif defined(VECLIB_USE_CLAPACK_INTERFACE)
     assert(0); /* no such implementation in clapack */
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cheev(CblasColMajor, 'V', 'U', n, (veclib_float_complex*)a, lda, w);
+    info = LAPACKE_zgesvd_work(CblasColMajor, 'S', 'S', m, n, (veclib_double_complex*)h->a, lda, h->s, (veclib_double_complex*)h->u, ldu, (veclib_double_complex*)h->vt, ldvt,
+                               (veclib_double_complex*)h->work, h->lwork, h->rwork);
 #endif
-    
-    /* output */
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(float_complex));
+
     if( info != 0 ) {
-        /* failed to converge and find the eigenvalues */
-        if(V!=NULL)
-            memset(V, 0, dim*dim*sizeof(float_complex));
+        memset(outM, 0, dim1*dim2*sizeof(double_complex));
 #ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
 #endif
     }
-    
-    /* transpose, back to row-major and reverse order */
-    else{
-        if(sortDecFLAG){
-            for(i=0; i<dim; i++) {
-                if(V!=NULL)
-                    for(j=0; j<dim; j++)
-                        V[i*dim+j] = a[(dim-j-1)*dim+i];
-                if(D!=NULL)
-                    D[i*dim+i] = cmplxf(w[dim-i-1], 0.0f); /* store along the diagonal, reversing the order */
-                if(eig!=NULL)
-                    eig[i] = w[dim-i-1];
-            }
-        }
-        else {
-            for(i=0; i<dim; i++){
-                if(V!=NULL)
-                    for(j=0; j<dim; j++)
-                        V[i*dim+j] = a[j*dim+i];
-                if(D!=NULL)
-                    D[i*dim+i] = cmplxf(w[i], 0.0f); /* store along the diagonal */
-                if(eig!=NULL)
-                    eig[i] = w[i];
-            }
+    else {
+        for(i=0; i<k; i++){
+            if(h->s[i] > 1.0e-5)
+                ss=1.0/h->s[i];
+            else
+                ss=h->s[i];
+            ss_cmplx = cmplx(ss, 0.0);
+            cblas_zscal(m, &ss_cmplx, &(h->u[i*m]), 1);
         }
+        cblas_zgemm(CblasColMajor, CblasConjTrans, CblasConjTrans, n, m, k, &calpha,
+                    h->vt, ldvt,
+                    h->u, ldu, &cbeta,
+                    h->inva, n);
+
+        /* return in row-major order */
+        for(i=0; i<m; i++)
+            for(j=0; j<n; j++)
+                outM[j*m+i] = h->inva[i*n+j];
     }
-    
-    free(w);
-    free(a);
+
+    if(hWork==NULL)
+        utility_zpinv_destroy((void**)&h);
 }
 
 
 /* ========================================================================== */
-/*                     Eigenvalues of Matrix Pair (?eigmp)                    */
+/*                       Cholesky Factorisation (?chol)                       */
 /* ========================================================================== */
 
-void utility_ceigmp
+/** Data structure for utility_schol() */
+typedef struct _utility_schol_data {
+    int maxDim;
+    float* a;
+}utility_schol_data;
+
+void utility_schol_create
 (
-    const float_complex* A,
-    const float_complex* B,
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_schol_data));
+    utility_schol_data *h = (utility_schol_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->a = malloc1d(maxDim*maxDim*sizeof(float));
+}
+
+void utility_schol_destroy
+(
+    void ** const phWork
+)
+{
+    utility_schol_data *h = (utility_schol_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_schol
+(
+    void* const hWork,
+    const float* A,
     const int dim,
-    float_complex* VL,
-    float_complex* VR,
-    float_complex* D
+    float* X
 )
 {
-    int i, j;
-    int n, lda, ldb, ldvl, ldvr, info;
-    float_complex* a, *b, *vl, *vr, *alpha, *beta;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    float* rwork;
-    float_complex* work;
-#endif
-    
-    n = lda = ldb = ldvl = ldvr = dim;
-    a = malloc1d(dim*dim*sizeof(float_complex));
-    b = malloc1d(dim*dim*sizeof(float_complex));
-    vl = malloc1d(dim*dim*sizeof(float_complex));
-    vr = malloc1d(dim*dim*sizeof(float_complex));
-    alpha = malloc1d(dim*sizeof(float_complex));
-    beta = malloc1d(dim*sizeof(float_complex));
-    
+    utility_schol_data *h;
+    int i, j, info, n, lda;
+    float* a;
+
+    n = lda = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_schol_create((void**)&h, dim);
+    else{
+        h = (utility_schol_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+
     /* store in column major order */
     for(i=0; i<dim; i++)
         for(j=0; j<dim; j++)
             a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            b[j*dim+i] = B[i*dim+j];
-    
-    /* solve eigen problem */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = 4*n; /* 2x more than required, but is faster */
-    work = malloc1d(lwork*sizeof(float_complex));
-    rwork = malloc1d(4*lwork*sizeof(float)); /* 2x more than required, but is faster */
-    cggev_("V", "V", &n, (veclib_float_complex*)a, &lda, (veclib_float_complex*)b, &ldb, (veclib_float_complex*)alpha, (veclib_float_complex*)beta,
-           (veclib_float_complex*)vl, &ldvl, (veclib_float_complex*)vr, &ldvr, (veclib_float_complex*)work, &lwork, rwork, &info);
-    free(work);
-    free(rwork);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
+
+    /* a is replaced by solution */
+#ifdef VECLIB_USE_CLAPACK_INTERFACE
+    info = clapack_spotrf(CblasColMajor, CblasUpper, n, a, lda);
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cggev(CblasColMajor, 'V', 'V', n, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb, (veclib_float_complex*)alpha,
-                         (veclib_float_complex*)beta, (veclib_float_complex*)vl, ldvl, (veclib_float_complex*)vr, ldvr);
-#endif
-    
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(float_complex));
-    
-    /* failed to converge and find the eigenvalues */
-    if( info != 0 ) {
-        if(VL!=NULL)
-            memset(VL, 0, dim*dim*sizeof(float_complex));
-        if(VR!=NULL)
-            memset(VR, 0, dim*dim*sizeof(float_complex));
+    info = LAPACKE_spotrf(CblasColMajor, CblasUpper, n, a, lda);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    spotrf_( "U", &n, a, &lda, &info );
+#endif
+
+    /* A is not positive definate, solution not possible */
+    if(info>0){
+        memset(X, 0, dim*dim*sizeof(float));
 #ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_CHOL);
 #endif
     }
-    /* transpose, back to row-major */
+    /* store solution in row-major order */
     else{
-        if(D!=NULL)
-            for(i=0; i<dim; i++)
-                D[i*dim+i] = ccdivf(alpha[i],beta[i]);
-        
-        if(VL!=NULL)
-            for(i=0; i<dim; i++)
-                for(j=0; j<dim; j++)
-                    VL[i*dim+j] = vl[j*dim+i];
-        if(VR!=NULL)
-            for(i=0; i<dim; i++)
-                for(j=0; j<dim; j++)
-                    VR[i*dim+j] = vr[j*dim+i];
+        for(i=0; i<dim; i++)
+            for(j=0; j<dim; j++)
+                X[i*dim+j] = j>=i ? a[j*dim+i] : 0.0f;
     }
-    
-    free(a);
-    free(b);
-    free(vl);
-    free(vr);
-    free(alpha);
-    free(beta);
+
+    if(hWork==NULL)
+        utility_schol_destroy((void**)&h);
 }
 
-void utility_zeigmp
+/** Data structure for utility_cchol() */
+typedef struct _utility_cchol_data {
+    int maxDim;
+    float_complex* a;
+}utility_cchol_data;
+
+void utility_cchol_create
 (
-    const double_complex* A,
-    const double_complex* B,
+    void ** const phWork,
+    int maxDim
+)
+{
+    *phWork = malloc1d(sizeof(utility_cchol_data));
+    utility_cchol_data *h = (utility_cchol_data*)(*phWork);
+
+    h->maxDim = maxDim;
+    h->a = malloc1d(maxDim*maxDim*sizeof(float_complex));
+}
+
+void utility_cchol_destroy
+(
+    void ** const phWork
+)
+{
+    utility_cchol_data *h = (utility_cchol_data*)(*phWork);
+
+    if(h!=NULL){
+        free(h->a);
+        free(h);
+        *phWork = NULL;
+    }
+}
+
+void utility_cchol
+(
+    void* const hWork,
+    const float_complex* A,
     const int dim,
-    double_complex* VL,
-    double_complex* VR,
-    double_complex* D
+    float_complex* X
 )
 {
-    int i, j;
-    int n, lda, ldb, ldvl, ldvr, info;
-    double_complex* a, *b, *vl, *vr, *alpha, *beta;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    double* rwork;
-    double_complex* work;
-#endif
-    
-    n = lda = ldb = ldvl = ldvr = dim;
-    a = malloc1d(dim*dim*sizeof(double_complex));
-    b = malloc1d(dim*dim*sizeof(double_complex));
-    vl = malloc1d(dim*dim*sizeof(double_complex));
-    vr = malloc1d(dim*dim*sizeof(double_complex));
-    alpha = malloc1d(dim*sizeof(double_complex));
-    beta = malloc1d(dim*sizeof(double_complex));
-    
+    utility_cchol_data *h;
+    int i, j, info, n, lda;
+    float_complex* a;
+
+    n = lda = dim;
+
+    /* use the workspace provided, or create a temporary one */
+    if(hWork==NULL)
+        utility_cchol_create((void**)&h, dim);
+    else{
+        h = (utility_cchol_data*)(hWork);
+        assert(dim<=h->maxDim);
+    }
+    a = h->a;
+
     /* store in column major order */
     for(i=0; i<dim; i++)
         for(j=0; j<dim; j++)
             a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            b[j*dim+i] = B[i*dim+j]; /* store in column major order */
-    
-    /* solve eigen problem */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = 4*n; /* 2x more than required, but is faster */
-    work = malloc1d(lwork*sizeof(double_complex));
-    rwork = malloc1d(4*lwork*sizeof(double)); /* 2x more than required, but is faster */
-    zggev_("V", "V", &n, (veclib_double_complex*)a, &lda, (veclib_double_complex*)b, &ldb, (veclib_double_complex*)alpha, (veclib_double_complex*)beta,
-           (veclib_double_complex*)vl, &ldvl, (veclib_double_complex*)vr, &ldvr, (veclib_double_complex*)work, &lwork, rwork, &info);
-    free(work);
-    free(rwork);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
+
+    /* a is replaced by solution */
+#if defined(VECLIB_USE_CLAPACK_INTERFACE)
+    info = clapack_cpotrf(CblasColMajor, CblasUpper, n, (veclib_float_complex*)a, lda);
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_zggev(CblasColMajor, 'V', 'V', n, (veclib_double_complex*)a, lda, (veclib_double_complex*)b, ldb, (veclib_double_complex*)alpha,
-                         (veclib_double_complex*)beta, (veclib_double_complex*)vl, ldvl, (veclib_double_complex*)vr, ldvr);
+    info = LAPACKE_cpotrf(CblasColMajor, CblasUpper, n, (veclib_float_complex*)a, lda);
+#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cpotrf_( "U", &n, (veclib_float_complex*)a, &lda, &info );
 #endif
-    
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(double_complex));
-    
-    /* failed to converge and find the eigenvalues */
-    if( info != 0 ) {
-        if(VL!=NULL)
-            memset(VL, 0, dim*dim*sizeof(double_complex));
-        if(VR!=NULL)
-            memset(VR, 0, dim*dim*sizeof(double_complex));
+
+    /* A is not positive definate, solution not possible */
+    if(info>0){
+        memset(X, 0, dim*dim*sizeof(float_complex));
 #ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_CHOL);
 #endif
     }
-    /* transpose, back to row-major */
+    /* store solution in row-major order */
     else{
-        if(D!=NULL)
-            for(i=0; i<dim; i++)
-                D[i*dim+i] = ccdiv(alpha[i],beta[i]);
-        
-        if(VL!=NULL)
-            for(i=0; i<dim; i++)
-                for(j=0; j<dim; j++)
-                    VL[i*dim+j] = vl[j*dim+i];
-        if(VR!=NULL)
-            for(i=0; i<dim; i++)
-                for(j=0; j<dim; j++)
-                    VR[i*dim+j] = vr[j*dim+i];
+        for(i=0; i<dim; i++)
+            for(j=0; j<dim; j++)
+                X[i*dim+j] = j>=i ? a[j*dim+i] : cmplxf(0.0f, 0.0f);
     }
-    
-    free(a);
-    free(b);
-    free(vl);
-    free(vr);
-    free(alpha);
-    free(beta);
+
+    if(hWork==NULL)
+        utility_cchol_destroy((void**)&h);
 }
 
 
 /* ========================================================================== */
-/*                       Eigenvalue Decomposition (?eig)                      */
+/*                           Matrix Inversion (?inv)                          */
 /* ========================================================================== */
 
-void utility_ceig
-(
-    const float_complex* A,
-    const int dim,
-    int sortDecFLAG,
-    float_complex* VL,
-    float_complex* VR,
-    float_complex* D,
-    float* eig
-)
+// TODO: rewrite for row-major
+void utility_sinv(float * A, const int N)
 {
-    int i, j, n, lda, ldvl, ldvr, info;
-    float_complex *w, *vl, *vr, *a;
+    int *IPIV;
+    IPIV = malloc1d(N * sizeof(int));
+    int LWORK = N*N;
+    float *WORK;
+    WORK = (float*)malloc1d(LWORK * sizeof(float));
+    int INFO;
+    
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    float* rwork;
-    float_complex wkopt;
-    float_complex* work;
+    sgetrf_((veclib_int*)&N, (veclib_int*)&N, A, (veclib_int*)&N, IPIV, &INFO);
+    sgetri_((veclib_int*)&N, A, (veclib_int*)&N, IPIV, WORK, &LWORK, &INFO);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    INFO = clapack_sgetrf(CblasColMajor, N, N, A, N, IPIV);
+    INFO = clapack_sgetri(CblasColMajor, N, A, N, IPIV);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    INFO = LAPACKE_sgetrf(CblasColMajor, N, N, A, N, IPIV);
+    INFO = LAPACKE_sgetri(CblasColMajor, N, A, N, IPIV);
 #endif
-
-    n = lda = ldvl = ldvr = dim;
-    w = malloc1d(dim*sizeof(float_complex));
-    vl = malloc1d(dim*dim*sizeof(float_complex));
-    vr = malloc1d(dim*dim*sizeof(float_complex));
-    a = malloc1d(dim*dim*sizeof(float_complex));
     
-    /* store in column major order (i.e. transpose) */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[i*dim+j] = A[j*dim+i];
+    free(IPIV);
+    free(WORK);
+}
 
-	assert(0); /* below code was crashing. Consider using utility_cseig instead, if A is hermitian */
+void utility_dinv(double* A, const int N)
+{
+    int *IPIV;
+    IPIV = malloc1d( (N+1)*sizeof(int));
+    int LWORK = N*N;
+    double *WORK;
+    WORK = malloc1d( LWORK*sizeof(double));
+    int INFO;
     
-    /* solve the eigenproblem */
 #if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = -1;
-    rwork = malloc1d(2*dim*sizeof(float));
-    cgeev_( "Vectors", "Vectors", &n, (veclib_float_complex*)a, &lda, (veclib_float_complex*)w, (veclib_float_complex*)vl, &ldvl,
-           (veclib_float_complex*)vr, &ldvr, (veclib_float_complex*)&wkopt, &lwork, rwork, &info );
-    lwork = (int)crealf(wkopt);
-    work = malloc1d( lwork*sizeof(float_complex) );
-    cgeev_( "Vectors", "Vectors", &n, (veclib_float_complex*)a, &lda, (veclib_float_complex*)w, (veclib_float_complex*)vl, &ldvl,
-           (veclib_float_complex*)vr, &ldvr, (veclib_float_complex*)work, &lwork, rwork, &info );
-    free(rwork);
-    free(work);
+    dgetrf_((veclib_int*)&N, (veclib_int*)&N, A, (veclib_int*)&N, IPIV, &INFO);
+    dgetri_((veclib_int*)&N, A, (veclib_int*)&N, IPIV, WORK, &LWORK, &INFO);
 #elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
+    INFO = clapack_dgetrf(CblasColMajor, N, N, A, N, IPIV);
+    INFO = clapack_dgetri(CblasColMajor, N, A, N, IPIV);
 #elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cgeev(CblasColMajor, 'V', 'V', n, (veclib_float_complex*)a, lda, (veclib_float_complex*)w, (veclib_float_complex*)vl, ldvl,
-                         (veclib_float_complex*)vr, ldvr );
+    INFO = LAPACKE_dgetrf(CblasColMajor, N, N, A, N, IPIV);
+    INFO = LAPACKE_dgetri(CblasColMajor, N, A, N, IPIV);
 #endif
     
-    /* sort the eigenvalues */
-    float* wr;
-    int* sort_idx;
-    wr=malloc1d(dim*sizeof(float));
-    sort_idx=malloc1d(dim*sizeof(int));
-    for(i=0; i<dim; i++)
-        wr[i] = crealf(w[i]);
-    sortf(wr, NULL, sort_idx, dim, sortDecFLAG);
-    
-    /* output */
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(float_complex));
+    free(IPIV);
+    free(WORK);
+}
+
+void utility_cinv(float_complex * A, const int N)
+{
+    int *IPIV;
+    IPIV = malloc1d(N * sizeof(int));
+    int LWORK = N*N;
+    float_complex *WORK;
+    WORK = (float_complex*)malloc1d(LWORK * sizeof(float_complex));
+    int INFO;
     
-    /* failed to converge and find the eigenvalues */
-    if( info != 0 ) {
-        if(VL!=NULL)
-            memset(VL, 0, dim*dim*sizeof(float_complex));
-        if(VR!=NULL)
-            memset(VR, 0, dim*dim*sizeof(float_complex));
-        if(eig!=NULL)
-            memset(eig, 0, dim*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_EVG);
+#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
+    cgetrf_((veclib_int*)&N, (veclib_int*)&N, (veclib_float_complex*)A, (veclib_int*)&N, IPIV, &INFO);
+    cgetri_((veclib_int*)&N, (veclib_float_complex*)A, (veclib_int*)&N, IPIV, (veclib_float_complex*)WORK, &LWORK, &INFO);
+#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
+    INFO = clapack_cgetrf(CblasColMajor, N, N, (veclib_float_complex*)A, N, IPIV);
+    INFO = clapack_cgetri(CblasColMajor, N, (veclib_float_complex*)A, N, IPIV);
+#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
+    INFO = LAPACKE_cgetrf(CblasColMajor, N, N, (veclib_float_complex*)A, N, IPIV);
+    INFO = LAPACKE_cgetri(CblasColMajor, N, (veclib_float_complex*)A, N, IPIV);
 #endif
+    
+    free(IPIV);
+    free(WORK);
+}
+
+
+/* ========================================================================== */
+/*              Fixed-Size Small Matrix Kernels (?mNmul, ?mNinv...)           */
+/* ========================================================================== */
+
+/* The kernels below are written for any N (up to 4), and the public functions
+ * call them with a constant N; so that the compiler may unroll the loops. */
+#define SMALL_MTX_MAX_N ( 4 )
+
+/** Row-major, NxN matrix multiplication 'C = A*B' (single precision) */
+static void smNmul
+(
+    const float* A,
+    const float* B,
+    const int N,
+    float* C
+)
+{
+    int i, j, k;
+    float sum;
+
+    for(i=0; i<N; i++){
+        for(j=0; j<N; j++){
+            sum = 0.0f;
+            for(k=0; k<N; k++)
+                sum += A[i*N+k] * B[k*N+j];
+            C[i*N+j] = sum;
+        }
     }
-    /* transpose, back to row-major */
-    else{
-        for(i=0; i<dim; i++){
-            if(VL!=NULL)
-                for(j=0; j<dim; j++)
-                    VL[i*dim+j] = vl[sort_idx[j]*dim+i];
-            if(VR!=NULL)
-                for(j=0; j<dim; j++)
-                    VR[i*dim+j] = vr[sort_idx[j]*dim+i];
-            if(D!=NULL)
-                D[i*dim+i] = cmplxf(wr[i], 0.0f); /* store along the diagonal */
-            if(eig!=NULL)
-                eig[i] = wr[i];
+}
+
+/** Row-major, NxN matrix multiplication 'C = A*B' (single precision complex) */
+static void cmNmul
+(
+    const float_complex* A,
+    const float_complex* B,
+    const int N,
+    float_complex* C
+)
+{
+    int i, j, k;
+    float_complex sum;
+
+    for(i=0; i<N; i++){
+        for(j=0; j<N; j++){
+            sum = cmplxf(0.0f, 0.0f);
+            for(k=0; k<N; k++)
+                sum = ccaddf(sum, ccmulf(A[i*N+k], B[k*N+j]));
+            C[i*N+j] = sum;
         }
     }
-    
-    free(w);
-    free(vl);
-    free(vr);
-    free(a);
-    free(wr);
-    free(sort_idx);
 }
 
+/** Row-major, NxN matrix-vector multiplication 'y = A*x' (single precision) */
+static void smNvmul
+(
+    const float* A,
+    const float* x,
+    const int N,
+    float* y
+)
+{
+    int i, k;
+    float sum;
 
-/* ========================================================================== */
-/*                       General Linear Solver (?glslv)                       */
-/* ========================================================================== */
+    for(i=0; i<N; i++){
+        sum = 0.0f;
+        for(k=0; k<N; k++)
+            sum += A[i*N+k] * x[k];
+        y[i] = sum;
+    }
+}
 
-void utility_sglslv
+/**
+ * Row-major, NxN matrix-vector multiplication 'y = A*x' (single precision
+ * complex)
+ */
+static void cmNvmul
+(
+    const float_complex* A,
+    const float_complex* x,
+    const int N,
+    float_complex* y
+)
+{
+    int i, k;
+    float_complex sum;
+
+    for(i=0; i<N; i++){
+        sum = cmplxf(0.0f, 0.0f);
+        for(k=0; k<N; k++)
+            sum = ccaddf(sum, ccmulf(A[i*N+k], x[k]));
+        y[i] = sum;
+    }
+}
+
+/**
+ * Solves 'A*X = B' for NxN 'A' and N x nCol 'B' (or, if B is NULL, the
+ * identity matrix, i.e. X = inv(A)), via Gauss-Jordan elimination with partial
+ * pivoting (single precision). 'X' is set to zeros if 'A' is singular.
+ */
+static void smNgaussj
 (
     const float* A,
-    const int dim,
-    float* B,
-    int nCol,
+    const float* B,
+    const int N,
+    const int nCol,
     float* X
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    int* IPIV;
-    float* a, *b;
+    int i, j, k, p;
+    float M[SMALL_MTX_MAX_N][SMALL_MTX_MAX_N], R[SMALL_MTX_MAX_N][SMALL_MTX_MAX_N];
+    float tmp, f;
 
-    IPIV = malloc1d(dim*sizeof(int));
-    a = malloc1d(dim*dim*sizeof(float));
-    b = malloc1d(dim*nrhs*sizeof(float));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
+    for(i=0; i<N; i++){
+        for(j=0; j<N; j++)
+            M[i][j] = A[i*N+j];
         for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#ifdef VECLIB_USE_CLAPACK_INTERFACE
-    info = clapack_sgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_sgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb );
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    sgesv_( &n, &nrhs, a, &lda, IPIV, b, &ldb, &info );
-#endif
-    
-    if(info!=0){
-        /* A is singular, solution not possible */
-        memset(X, 0, dim*nCol*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
+            R[i][j] = B==NULL ? (i==j ? 1.0f : 0.0f) : B[i*nCol+j];
     }
-    else{
-        /* store solution in row-major order */
-        for(i=0; i<dim; i++)
+    for(k=0; k<N; k++){
+        /* pivot on the largest remaining element in this column */
+        p = k;
+        for(i=k+1; i<N; i++)
+            if(fabsf(M[i][k]) > fabsf(M[p][k]))
+                p = i;
+        if(fabsf(M[p][k]) <= FLT_MIN){
+            memset(X, 0, N*nCol*sizeof(float));
+            return;
+        }
+        if(p!=k){
+            for(j=0; j<N; j++){
+                tmp = M[k][j]; M[k][j] = M[p][j]; M[p][j] = tmp;
+            }
+            for(j=0; j<nCol; j++){
+                tmp = R[k][j]; R[k][j] = R[p][j]; R[p][j] = tmp;
+            }
+        }
+
+        /* normalise the pivot row, and eliminate this column from the others */
+        f = 1.0f/M[k][k];
+        for(j=0; j<N; j++)
+            M[k][j] *= f;
+        for(j=0; j<nCol; j++)
+            R[k][j] *= f;
+        for(i=0; i<N; i++){
+            if(i==k)
+                continue;
+            f = M[i][k];
+            for(j=0; j<N; j++)
+                M[i][j] -= f*M[k][j];
             for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
+                R[i][j] -= f*R[k][j];
+        }
     }
-    
-    free(IPIV);
-    free(a);
-    free(b);
+    for(i=0; i<N; i++)
+        for(j=0; j<nCol; j++)
+            X[i*nCol+j] = R[i][j];
 }
 
-void utility_cglslv
+/**
+ * Solves 'A*X = B' for NxN 'A' and N x nCol 'B' (or, if B is NULL, the
+ * identity matrix, i.e. X = inv(A)), via Gauss-Jordan elimination with partial
+ * pivoting (single precision complex). 'X' is set to zeros if 'A' is singular.
+ */
+static void cmNgaussj
 (
     const float_complex* A,
-    const int dim,
-    float_complex* B,
-    int nCol,
+    const float_complex* B,
+    const int N,
+    const int nCol,
     float_complex* X
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    int* IPIV;
-    IPIV = malloc1d(dim*sizeof(int));
-    float_complex* a, *b;
+    int i, j, k, p;
+    float_complex M[SMALL_MTX_MAX_N][SMALL_MTX_MAX_N], R[SMALL_MTX_MAX_N][SMALL_MTX_MAX_N];
+    float_complex tmp, f;
 
-    a = malloc1d(dim*dim*sizeof(float_complex));
-    b = malloc1d(dim*nrhs*sizeof(float_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
+    for(i=0; i<N; i++){
+        for(j=0; j<N; j++)
+            M[i][j] = A[i*N+j];
         for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    cgesv_( &n, &nrhs, (veclib_float_complex*)a, &lda, IPIV, (veclib_float_complex*)b, &ldb, &info );
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    info = clapack_cgesv(CblasColMajor, n, nrhs, (veclib_float_complex*)a, lda, IPIV, (veclib_float_complex*)b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cgesv(CblasColMajor, n, nrhs, (veclib_float_complex*)a, lda, IPIV, (veclib_float_complex*)b, ldb);
-#endif
-    
-    /* A is singular, solution not possible */
-    if(info!=0){
-        memset(X, 0, dim*nCol*sizeof(float_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
+            R[i][j] = B==NULL ? cmplxf(i==j ? 1.0f : 0.0f, 0.0f) : B[i*nCol+j];
     }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
+    for(k=0; k<N; k++){
+        /* pivot on the largest remaining element in this column */
+        p = k;
+        for(i=k+1; i<N; i++)
+            if(cabsf(M[i][k]) > cabsf(M[p][k]))
+                p = i;
+        if(cabsf(M[p][k]) <= FLT_MIN){
+            memset(X, 0, N*nCol*sizeof(float_complex));
+            return;
+        }
+        if(p!=k){
+            for(j=0; j<N; j++){
+                tmp = M[k][j]; M[k][j] = M[p][j]; M[p][j] = tmp;
+            }
+            for(j=0; j<nCol; j++){
+                tmp = R[k][j]; R[k][j] = R[p][j]; R[p][j] = tmp;
+            }
+        }
+
+        /* normalise the pivot row, and eliminate this column from the others */
+        f = ccdivf(cmplxf(1.0f, 0.0f), M[k][k]);
+        for(j=0; j<N; j++)
+            M[k][j] = ccmulf(M[k][j], f);
+        for(j=0; j<nCol; j++)
+            R[k][j] = ccmulf(R[k][j], f);
+        for(i=0; i<N; i++){
+            if(i==k)
+                continue;
+            f = M[i][k];
+            for(j=0; j<N; j++)
+                M[i][j] = ccsubf(M[i][j], ccmulf(f, M[k][j]));
             for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
+                R[i][j] = ccsubf(R[i][j], ccmulf(f, R[k][j]));
+        }
     }
-    
-    free(IPIV);
-    free(a);
-    free(b);
+    for(i=0; i<N; i++)
+        for(j=0; j<nCol; j++)
+            X[i*nCol+j] = R[i][j];
 }
 
-void utility_dglslv
+void utility_sm2mul
 (
-    const double* A,
-    const int dim,
-    double* B,
-    int nCol,
-    double* X
+    const float* A,
+    const float* B,
+    float* C
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    int* IPIV;
-    double* a, *b;
- 
-    IPIV = malloc1d(dim*sizeof(int));
-    a = malloc1d(dim*dim*sizeof(double));
-    b = malloc1d(dim*nrhs*sizeof(double));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#ifdef VECLIB_USE_CLAPACK_INTERFACE
-    info = clapack_dgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_dgesv(CblasColMajor, n, nrhs, a, lda, IPIV, b, ldb);
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    dgesv_( &n, &nrhs, a, &lda, IPIV, b, &ldb, &info );
-#endif
-    
-    /* A is singular, solution not possible */
-    if(info!=0){
-        memset(X, 0, dim*nCol*sizeof(double));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
-    }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
-    }
-    
-    free(IPIV);
-    free(a);
-    free(b);
+    smNmul(A, B, 2, C);
+}
+
+void utility_sm3mul
+(
+    const float* A,
+    const float* B,
+    float* C
+)
+{
+    smNmul(A, B, 3, C);
+}
+
+void utility_sm4mul
+(
+    const float* A,
+    const float* B,
+    float* C
+)
+{
+    smNmul(A, B, 4, C);
+}
+
+void utility_cm2mul
+(
+    const float_complex* A,
+    const float_complex* B,
+    float_complex* C
+)
+{
+    cmNmul(A, B, 2, C);
+}
+
+void utility_cm3mul
+(
+    const float_complex* A,
+    const float_complex* B,
+    float_complex* C
+)
+{
+    cmNmul(A, B, 3, C);
+}
+
+void utility_cm4mul
+(
+    const float_complex* A,
+    const float_complex* B,
+    float_complex* C
+)
+{
+    cmNmul(A, B, 4, C);
+}
+
+void utility_sm2vmul
+(
+    const float* A,
+    const float* x,
+    float* y
+)
+{
+    smNvmul(A, x, 2, y);
+}
+
+void utility_sm3vmul
+(
+    const float* A,
+    const float* x,
+    float* y
+)
+{
+    smNvmul(A, x, 3, y);
+}
+
+void utility_sm4vmul
+(
+    const float* A,
+    const float* x,
+    float* y
+)
+{
+    smNvmul(A, x, 4, y);
+}
+
+void utility_cm2vmul
+(
+    const float_complex* A,
+    const float_complex* x,
+    float_complex* y
+)
+{
+    cmNvmul(A, x, 2, y);
+}
+
+void utility_cm3vmul
+(
+    const float_complex* A,
+    const float_complex* x,
+    float_complex* y
+)
+{
+    cmNvmul(A, x, 3, y);
+}
+
+void utility_cm4vmul
+(
+    const float_complex* A,
+    const float_complex* x,
+    float_complex* y
+)
+{
+    cmNvmul(A, x, 4, y);
+}
+
+void utility_sm2inv
+(
+    const float* A,
+    float* X
+)
+{
+    smNgaussj(A, NULL, 2, 2, X);
+}
+
+void utility_sm3inv
+(
+    const float* A,
+    float* X
+)
+{
+    smNgaussj(A, NULL, 3, 3, X);
+}
+
+void utility_sm4inv
+(
+    const float* A,
+    float* X
+)
+{
+    smNgaussj(A, NULL, 4, 4, X);
+}
+
+void utility_cm2inv
+(
+    const float_complex* A,
+    float_complex* X
+)
+{
+    cmNgaussj(A, NULL, 2, 2, X);
+}
+
+void utility_cm3inv
+(
+    const float_complex* A,
+    float_complex* X
+)
+{
+    cmNgaussj(A, NULL, 3, 3, X);
 }
 
-void utility_zglslv
+void utility_cm4inv
 (
-    const double_complex* A,
-    const int dim,
-    double_complex* B,
-    int nCol,
-    double_complex* X
+    const float_complex* A,
+    float_complex* X
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    int* IPIV;
-    double_complex* a, *b;
- 
-    IPIV = malloc1d(dim*sizeof(int));
-    a = malloc1d(dim*dim*sizeof(double_complex));
-    b = malloc1d(dim*nrhs*sizeof(double_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    zgesv_( &n, &nrhs, (veclib_double_complex*)a, &lda, IPIV, (veclib_double_complex*)b, &ldb, &info );
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    info = clapack_zgesv(CblasColMajor, n, nrhs, (veclib_double_complex*)a, lda, IPIV, (veclib_double_complex*)b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_zgesv(CblasColMajor, n, nrhs, (veclib_double_complex*)a, lda, IPIV, (veclib_double_complex*)b, ldb);
-#endif
-    
-    /* A is singular, solution not possible */
-    if(info!=0){
-        memset(X, 0, dim*nCol*sizeof(double_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
-    }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
-    }
-    
-    free(IPIV);
-    free(a);
-    free(b);
+    cmNgaussj(A, NULL, 4, 4, X);
 }
 
+void utility_sm2slv
+(
+    const float* A,
+    const float* b,
+    float* x
+)
+{
+    smNgaussj(A, b, 2, 1, x);
+}
 
-/* ========================================================================== */
-/*                      Symmetric Linear Solver (?slslv)                      */
-/* ========================================================================== */
+void utility_sm3slv
+(
+    const float* A,
+    const float* b,
+    float* x
+)
+{
+    smNgaussj(A, b, 3, 1, x);
+}
 
-void utility_sslslv
+void utility_sm4slv
 (
     const float* A,
-    const int dim,
-    float* B,
-    int nCol,
-    float* X
+    const float* b,
+    float* x
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    float* a, *b;
- 
-    a = malloc1d(dim*dim*sizeof(float));
-    b = malloc1d(dim*nrhs*sizeof(float));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#ifdef VECLIB_USE_CLAPACK_INTERFACE
-    info = clapack_sposv(CblasColMajor, CblasUpper, n, nrhs, a, lda, b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_sposv(CblasColMajor, CblasUpper, n, nrhs, a, lda, b, ldb);
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    sposv_( "U", &n, &nrhs, a, &lda, b, &ldb, &info );
-#endif
-    
-    /* A is not symmetric positive definate, solution not possible */
-    if(info!=0){
-        memset(X, 0, dim*nCol*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
-    }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
-    }
-    
-    free(a);
-    free(b);
+    smNgaussj(A, b, 4, 1, x);
 }
 
-void utility_cslslv
+void utility_cm2slv
 (
     const float_complex* A,
-    const int dim,
-    float_complex* B,
-    int nCol,
-    float_complex* X
+    const float_complex* b,
+    float_complex* x
 )
 {
-    int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    float_complex* a, *b;
- 
-    a = malloc1d(dim*dim*sizeof(float_complex));
-    b = malloc1d(dim*nrhs*sizeof(float_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    for(i=0; i<dim; i++)
-        for(j=0; j<nCol; j++)
-            b[j*dim+i] = B[i*nCol+j];
-    
-    /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    cposv_( "U", &n, &nrhs, (veclib_float_complex*)a, &lda, (veclib_float_complex*)b, &ldb, &info );
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    info = clapack_cposv(CblasColMajor, CblasUpper, n, nrhs, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cposv(CblasColMajor, CblasUpper, n, nrhs, (veclib_float_complex*)a, lda, (veclib_float_complex*)b, ldb);
-#endif
-    
-    /* A is not symmetric positive definate, solution not possible */
-    if(info!=0){
-        memset(X, 0, dim*nCol*sizeof(float_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_SOLVE_LINEAR_EQUATION);
-#endif
-    }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<nCol; j++)
-                X[i*nCol+j] = b[j*dim+i];
-    }
-    
-    free(a);
-    free(b);
+    cmNgaussj(A, b, 2, 1, x);
 }
 
+void utility_cm3slv
+(
+    const float_complex* A,
+    const float_complex* b,
+    float_complex* x
+)
+{
+    cmNgaussj(A, b, 3, 1, x);
+}
+
+void utility_cm4slv
+(
+    const float_complex* A,
+    const float_complex* b,
+    float_complex* x
+)
+{
+    cmNgaussj(A, b, 4, 1, x);
+}
 
 /* ========================================================================== */
-/*                        Matrix Pseudo-Inverse (?pinv)                       */
+/*                  Packed Hermitian Matrices (?hpherk, ?hpaxpy)              */
 /* ========================================================================== */
 
-void utility_spinv
+/** Returns sum(a.*conj(b)), for complex vectors 'a' and 'b' (plain loops) */
+static float_complex veclib_cdotc_scalar
 (
-    const float* inM,
-    const int dim1,
-    const int dim2,
-    float* outM
+    const float_complex* a,
+    const float_complex* b,
+    const int len
 )
 {
-    
-    int i, j, m, n, k, lda, ldu, ldvt, info;
-    float* a, *s, *u, *vt, *inva;
-    float ss;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    float wkopt;
-    float* work;
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    float* superb;
-#endif
-    
-    m = lda = ldu = dim1;
-    n = dim2;
-    k = ldvt = m < n ? m : n;
-    a = malloc1d(m*n*sizeof(float) );
-    s = (float*)malloc1d(k*sizeof(float));
-    u = (float*)malloc1d(ldu*k*sizeof(float));
-    vt = (float*)malloc1d(ldvt*n*sizeof(float));
-    
-    /* store in column major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            a[j*m+i] = inM[i*n+j];
-    
-    /* singular value decomposition */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = -1;
-    sgesvd_("S", "S", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, &wkopt, &lwork, &info);
-    lwork = (int)wkopt;
-    work = (float*)malloc1d(lwork*sizeof(float));
-    sgesvd_("S", "S", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, work, &lwork, &info );
-    free(work);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(float));
-    info = LAPACKE_sgesvd(CblasColMajor, 'S', 'S', m, n, a, lda, s, u, ldu, vt, ldvt, superb);
-    free(superb);
-#endif
-    
-    if( info != 0 ) {
-        memset(outM, 0, dim1*dim2*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
-#endif
+    int i;
+    float re, im;
+    re = im = 0.0f;
+    for(i=0; i<len; i++){
+        re += crealf(a[i])*crealf(b[i]) + cimagf(a[i])*cimagf(b[i]);
+        im += cimagf(a[i])*crealf(b[i]) - crealf(a[i])*cimagf(b[i]);
     }
-    int incx=1;
-    for(i=0; i<k; i++){
-        if(s[i] > 1.0e-5f)
-            ss=1.0f/s[i];
-        else
-            ss=s[i];
-        cblas_sscal(m, ss, &u[i*m], incx);
-    }
-    inva = (float*)malloc1d(n*m*sizeof(float));
-    int ld_inva=n;
-    cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, n, m, k, 1.0f,
-                vt, ldvt,
-                u, ldu, 0.0f,
-                inva, ld_inva);
-    
-    /* return in row-major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            outM[j*m+i] = inva[i*n+j];
-    
-    /* clean-up */
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
-    free(inva);
+    return cmplxf(re, im);
 }
 
-void utility_cpinv
+#ifdef SAF_VECLIB_AVX2
+/** Returns sum(a.*conj(b)); AVX2 version of veclib_cdotc_scalar() */
+SAF_VECLIB_AVX2_TARGET static float_complex veclib_cdotc_avx2
 (
-    const float_complex* inM,
-    const int dim1,
-    const int dim2,
-    float_complex* outM
+    const float_complex* a,
+    const float_complex* b,
+    const int len
 )
 {
-    int i, j, m, n, k, lda, ldu, ldvt, info;
-    float_complex* a,  *u, *vt, *inva;
-    float_complex  ss_cmplx;
-    const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f); /* blas */
-    float *s;
-    float ss;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    float* rwork;
-    float_complex wkopt;
-    float_complex* work;
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    float* superb;
-#endif
-    
-    m = lda = ldu = dim1;
-    n = dim2;
-    k = ldvt = m < n ? m : n;
-    a = malloc1d(lda*n*sizeof(float_complex));
-    s = malloc1d(MIN(n,m)*sizeof(float));
-    u = malloc1d(ldu*m*sizeof(float_complex));
-    vt = malloc1d(ldvt*n*sizeof(float_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim1; i++)
-        for(j=0; j<dim2; j++)
-            a[j*dim1+i] = inM[i*dim2 +j];
-    
-    /* singular value decomposition */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(float));
-    lwork = -1;
-    cgesvd_( "A", "A", &m, &n, (veclib_float_complex*)a, &lda, s, (veclib_float_complex*)u, &ldu, (veclib_float_complex*)vt, &ldvt,
-            (veclib_float_complex*)&wkopt, &lwork, rwork, &info );
-    lwork = (int)(crealf(wkopt)+0.01f);
-    work = malloc1d( lwork*sizeof(float_complex) );
-    cgesvd_( "A", "A", &m, &n, (veclib_float_complex*)a, &lda, s, (veclib_float_complex*)u, &ldu, (veclib_float_complex*)vt, &ldvt,
-            (veclib_float_complex*)work, &lwork, rwork, &info);
-    free(work);
-    free(rwork);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(float));
-    info = LAPACKE_cgesvd(CblasColMajor, 'S', 'S', m, n, (veclib_float_complex*)a, lda, s, (veclib_float_complex*)u, ldu,
-                          (veclib_float_complex*)vt, ldvt, superb);
-    free(superb);
-#endif
-    
-    if( info != 0 ) {
-        memset(outM, 0, dim1*dim2*sizeof(float_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
-#endif
+    int i;
+    const float* pa, *pb;
+    float p[8], q[8];
+    float_complex tail;
+    __m256 va, vb, vp, vq;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    vp = vq = _mm256_setzero_ps();
+    for(i=0; i<len-3; i+=4){
+        /* vp += [ar*br, ai*bi], vq += [ai*br, ar*bi] */
+        va = _mm256_loadu_ps(&pa[2*i]);
+        vb = _mm256_loadu_ps(&pb[2*i]);
+        vp = _mm256_fmadd_ps(va, vb, vp);
+        vq = _mm256_fmadd_ps(_mm256_permute_ps(va, 0xB1), vb, vq);
     }
-    int incx=1;
-    for(i=0; i<k; i++){
-        if(s[i] > 1.0e-5f)
-            ss=1.0f/s[i];
-        else
-            ss=s[i];
-        ss_cmplx = cmplxf(ss, 0.0f);
-        cblas_cscal(m, &ss_cmplx, &u[i*m], incx);
-    }
-    inva = malloc1d(n*m*sizeof(float_complex));
-    int ld_inva=n;
-    cblas_cgemm(CblasColMajor, CblasConjTrans, CblasConjTrans, n, m, k, &calpha,
-                vt, ldvt,
-                u, ldu, &cbeta,
-                inva, ld_inva);
-    
-    /* return in row-major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            outM[j*m+i] = inva[i*n+j];
+    _mm256_storeu_ps(p, vp);
+    _mm256_storeu_ps(q, vq);
+    _mm256_zeroupper();
+    tail = veclib_cdotc_scalar(&a[i], &b[i], len-i);
+    return cmplxf(p[0]+p[1]+p[2]+p[3]+p[4]+p[5]+p[6]+p[7] + crealf(tail),
+                  q[0]-q[1]+q[2]-q[3]+q[4]-q[5]+q[6]-q[7] + cimagf(tail));
+}
+#endif /* SAF_VECLIB_AVX2 */
 
-    /* clean-up */
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
-    free(inva);
+#ifdef SAF_VECLIB_SSE2
+/** Returns sum(a.*conj(b)); SSE2 version of veclib_cdotc_scalar() */
+static float_complex veclib_cdotc_sse2
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int len
+)
+{
+    int i;
+    const float* pa, *pb;
+    float p[4], q[4];
+    float_complex tail;
+    __m128 va, vb, vp, vq;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    vp = vq = _mm_setzero_ps();
+    for(i=0; i<len-1; i+=2){
+        /* vp += [ar*br, ai*bi], vq += [ai*br, ar*bi] */
+        va = _mm_loadu_ps(&pa[2*i]);
+        vb = _mm_loadu_ps(&pb[2*i]);
+        vp = _mm_add_ps(vp, _mm_mul_ps(va, vb));
+        vq = _mm_add_ps(vq, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(2,3,0,1)), vb));
+    }
+    _mm_storeu_ps(p, vp);
+    _mm_storeu_ps(q, vq);
+    tail = veclib_cdotc_scalar(&a[i], &b[i], len-i);
+    return cmplxf(p[0]+p[1]+p[2]+p[3] + crealf(tail), q[0]-q[1]+q[2]-q[3] + cimagf(tail));
+}
+#endif /* SAF_VECLIB_SSE2 */
+
+#ifdef SAF_VECLIB_NEON
+/** Returns sum(a.*conj(b)); NEON version of veclib_cdotc_scalar() */
+static float_complex veclib_cdotc_neon
+(
+    const float_complex* a,
+    const float_complex* b,
+    const int len
+)
+{
+    int i;
+    const float* pa, *pb;
+    float re[4], im[4];
+    float_complex tail;
+    float32x4x2_t va, vb;
+    float32x4_t vre, vim;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    vre = vim = vdupq_n_f32(0.0f);
+    for(i=0; i<len-3; i+=4){
+        /* (de-interleaved into real and imaginary parts) */
+        va = vld2q_f32(&pa[2*i]);
+        vb = vld2q_f32(&pb[2*i]);
+        vre = vmlaq_f32(vmlaq_f32(vre, va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        vim = vmlsq_f32(vmlaq_f32(vim, va.val[1], vb.val[0]), va.val[0], vb.val[1]);
+    }
+    vst1q_f32(re, vre);
+    vst1q_f32(im, vim);
+    tail = veclib_cdotc_scalar(&a[i], &b[i], len-i);
+    return cmplxf(re[0]+re[1]+re[2]+re[3] + crealf(tail), im[0]+im[1]+im[2]+im[3] + cimagf(tail));
 }
+#endif /* SAF_VECLIB_NEON */
 
-void utility_dpinv
+#ifdef SAF_VECLIB_WASM_SIMD128
+/** Returns sum(a.*conj(b)); WebAssembly SIMD128 version of veclib_cdotc_scalar() */
+static float_complex veclib_cdotc_wasm
 (
-    const double* inM,
-    const int dim1,
-    const int dim2,
-    double* outM
+    const float_complex* a,
+    const float_complex* b,
+    const int len
 )
 {
-    int i, j, m, n, k, lda, ldu, ldvt, info;
-    double* a, *s, *u, *vt, *inva;
-    double ss;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    double wkopt;
-    double* work;
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    double* superb;
-#endif
-    
-    m = lda = ldu = dim1;
-    n = dim2;
-    k = ldvt = m < n ? m : n;
-    a = malloc1d(m*n*sizeof(double) );
-    s = (double*)malloc1d(k*sizeof(double));
-    u = (double*)malloc1d(ldu*k*sizeof(double));
-    vt = (double*)malloc1d(ldvt*n*sizeof(double));
-    
-    /* store in column major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            a[j*m+i] = inM[i*n+j];
-    
-    /* singular value decomposition */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    lwork = -1;
-    dgesvd_("S", "S", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, &wkopt, &lwork, &info);
-    lwork = (int)wkopt;
-    work = (double*)malloc1d(lwork*sizeof(double));
-    dgesvd_("S", "S", &m, &n, a, &lda, s, u, &ldu, vt, &ldvt, work, &lwork, &info );
-    free(work);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(double));
-    info = LAPACKE_dgesvd(CblasColMajor, 'S', 'S', m, n, a, lda, s, u, ldu, vt, ldvt, superb);
-    free(superb);
-#endif
-    
-    if( info != 0 ) {
-        memset(outM, 0, dim1*dim2*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
-#endif
+    int i;
+    const float* pa, *pb;
+    float p[4], q[4];
+    float_complex tail;
+    v128_t va, vb, vp, vq;
+    pa = (const float*)a;
+    pb = (const float*)b;
+    vp = vq = wasm_f32x4_splat(0.0f);
+    for(i=0; i<len-1; i+=2){
+        /* vp += [ar*br, ai*bi], vq += [ai*br, ar*bi] */
+        va = wasm_v128_load(&pa[2*i]);
+        vb = wasm_v128_load(&pb[2*i]);
+        vp = wasm_f32x4_add(vp, wasm_f32x4_mul(va, vb));
+        vq = wasm_f32x4_add(vq, wasm_f32x4_mul(wasm_i32x4_shuffle(va, va, 1, 0, 3, 2), vb));
     }
-    int incx=1;
-    for(i=0; i<k; i++){
-        if(s[i] > 1.0e-9)
-            ss=1.0/s[i];
-        else
-            ss=s[i];
-        cblas_dscal(m, ss, &u[i*m], incx);
-    }
-    inva = (double*)malloc1d(n*m*sizeof(double));
-    int ld_inva=n;
-    cblas_dgemm( CblasColMajor, CblasTrans, CblasTrans, n, m, k, 1.0,
-                vt, ldvt,
-                u, ldu, 0.0,
-                inva, ld_inva);
-    
-    /* return in row-major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            outM[j*m+i] = inva[i*n+j];
-    
-    /* clean-up */
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
-    free(inva);
+    wasm_v128_store(p, vp);
+    wasm_v128_store(q, vq);
+    tail = veclib_cdotc_scalar(&a[i], &b[i], len-i);
+    return cmplxf(p[0]+p[1]+p[2]+p[3] + crealf(tail), q[0]-q[1]+q[2]-q[3] + cimagf(tail));
 }
+#endif /* SAF_VECLIB_WASM_SIMD128 */
 
-void utility_zpinv
+void utility_chpherk
 (
-    const double_complex* inM,
-    const int dim1,
-    const int dim2,
-    double_complex* outM
+    const float_complex* X,
+    const int dim,
+    const int len,
+    const float alpha,
+    const float beta,
+    float_complex* Cp
 )
 {
-    int i, j, m, n, k, lda, ldu, ldvt, info;
-    double_complex* a, *u, *vt, *inva;
-    double_complex ss_cmplx;
-    const double_complex calpha = cmplx(1.0, 0.0); const double_complex cbeta = cmplx(0.0, 0.0); /* blas */
-    double* s;
-    double ss;
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    int lwork;
-    double* rwork;
-    double_complex wkopt;
-    double_complex* work;
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    double* superb;
+    int i, j;
+    float* Cp_j;
+    float_complex XXh;
+    float_complex (*cdotc)(const float_complex*, const float_complex*, const int);
+
+    /* select the kernel once, rather than for each element */
+#if defined(SAF_VECLIB_SSE2)
+    cdotc = veclib_cdotc_sse2;
+#elif defined(SAF_VECLIB_NEON)
+    cdotc = veclib_cdotc_neon;
+#elif defined(SAF_VECLIB_WASM_SIMD128)
+    cdotc = veclib_cdotc_wasm;
+#else
+    cdotc = veclib_cdotc_scalar;
 #endif
-    
-    m = lda = ldu = dim1;
-    n = dim2;
-    k = ldvt = m < n ? m : n;
-    a = malloc1d(lda*n*sizeof(double_complex));
-    s = malloc1d(MIN(n,m)*sizeof(double));
-    u = malloc1d(ldu*m*sizeof(double_complex));
-    vt = malloc1d(ldvt*n*sizeof(double_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim1; i++)
-        for(j=0; j<dim2; j++)
-            a[j*dim1+i] = inM[i*dim2 +j];
-    
-    /* singular value decomposition */
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    rwork = malloc1d(m*MAX(1, 5*MIN(n,m))*sizeof(double));
-    lwork = -1;
-    zgesvd_( "A", "A", &m, &n, (veclib_double_complex*)a, &lda, s, (veclib_double_complex*)u, &ldu, (veclib_double_complex*)vt, &ldvt,
-            (veclib_double_complex*)&wkopt, &lwork, rwork, &info );
-    lwork = (int)(creal(wkopt)+0.01);
-    work = malloc1d( lwork*sizeof(double_complex) );
-    zgesvd_( "A", "A", &m, &n, (veclib_double_complex*)a, &lda, s, (veclib_double_complex*)u, &ldu, (veclib_double_complex*)vt, &ldvt,
-            (veclib_double_complex*)work, &lwork, rwork, &info);
-    free(work);
-    free(rwork);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    assert(0); /* no such implementation in clapack */
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    superb = malloc((MIN(m,n)-1)*sizeof(double));
-    info = LAPACKE_zgesvd(CblasColMajor, 'A', 'A', m, n, (veclib_double_complex*)a, lda, s, (veclib_double_complex*)u, ldu,
-                          (veclib_double_complex*)vt, ldvt, superb);
-    free(superb);
+#if defined(SAF_VECLIB_AVX2)
+    if(veclib_hasAVX2())
+        cdotc = veclib_cdotc_avx2;
 #endif
 
-    if( info != 0 ) {
-        memset(outM, 0, dim1*dim2*sizeof(double_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_SVD);
-#endif
+    /* C(i,j) = beta*C(i,j) + alpha*X(i,:)*X(j,:)', for the upper triangle only */
+    for(j=0; j<dim; j++){
+        Cp_j = (float*)&Cp[j*(j+1)/2]; /* (interleaved real/imag, which avoids the complex helper calls) */
+        for(i=0; i<=j; i++){
+            XXh = cdotc(&X[i*len], &X[j*len], len);
+            if(beta==0.0f){ /* (so that any garbage/NaNs in 'Cp' are not propagated) */
+                Cp_j[2*i]   = alpha*crealf(XXh);
+                Cp_j[2*i+1] = alpha*cimagf(XXh);
+            }
+            else{
+                Cp_j[2*i]   = beta*Cp_j[2*i]   + alpha*crealf(XXh);
+                Cp_j[2*i+1] = beta*Cp_j[2*i+1] + alpha*cimagf(XXh);
+            }
+        }
+        Cp_j[2*j+1] = 0.0f; /* (the diagonal is real) */
     }
-    int incx=1;
-    for(i=0; i<k; i++){
-        if(s[i] > 1.0e-5)
-            ss=1.0/s[i];
-        else
-            ss=s[i];
-        ss_cmplx = cmplx(ss, 0.0);
-        cblas_zscal(m, &ss_cmplx, &u[i*m], incx);
-    }
-    inva = malloc1d(n*m*sizeof(double_complex));
-    int ld_inva=n;
-    cblas_zgemm(CblasColMajor, CblasConjTrans, CblasConjTrans, n, m, k, &calpha,
-                vt, ldvt,
-                u, ldu, &cbeta,
-                inva, ld_inva);
-    
-    /* return in row-major order */
-    for(i=0; i<m; i++)
-        for(j=0; j<n; j++)
-            outM[j*m+i] = inva[i*n+j];
-    
-    /* clean-up */
-    free(a);
-    free(s);
-    free(u);
-    free(vt);
-    free(inva);
 }
 
-
-/* ========================================================================== */
-/*                       Cholesky Factorisation (?chol)                       */
-/* ========================================================================== */
-
-void utility_schol
+void utility_chpaxpy
 (
-    const float* A,
+    const float_complex* Cp,
     const int dim,
-    float* X
+    const float alpha,
+    const int ldC,
+    float_complex* C
 )
 {
-    int i, j, info, n, lda;
-    float* a;
- 
-    n = lda = dim;
-    a = malloc1d(dim*dim*sizeof(float));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    
-    /* a is replaced by solution */
-#ifdef VECLIB_USE_CLAPACK_INTERFACE
-    info = clapack_spotrf(CblasColMajor, CblasUpper, n, a, lda);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_spotrf(CblasColMajor, CblasUpper, n, a, lda);
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    spotrf_( "U", &n, a, &lda, &info );
-#endif
-    
-    /* A is not positive definate, solution not possible */
-    if(info>0){
-        memset(X, 0, dim*dim*sizeof(float));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_CHOL);
-#endif
-    }
-    
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<dim; j++)
-                X[i*dim+j] = j>=i ? a[j*dim+i] : 0.0f;
+    int i, j;
+    float_complex Cij;
+
+    for(j=0; j<dim; j++){
+        for(i=0; i<j; i++){
+            Cij = crmulf(Cp[j*(j+1)/2 + i], alpha);
+            C[i*ldC+j] = ccaddf(C[i*ldC+j], Cij);
+            C[j*ldC+i] = ccaddf(C[j*ldC+i], conjf(Cij));
+        }
+        C[j*ldC+j] = ccaddf(C[j*ldC+j], crmulf(Cp[j*(j+1)/2 + j], alpha));
     }
-    
-    free(a);
 }
 
-void utility_cchol
+
+/* ========================================================================== */
+/*                  Batched Matrix Multiplication (?gemm_batch)               */
+/* ========================================================================== */
+
+void utility_cgemm_batch
 (
     const float_complex* A,
-    const int dim,
-    float_complex* X
+    const int lda,
+    const int strideA,
+    const float_complex* B,
+    const int ldb,
+    const int strideB,
+    const int M,
+    const int N,
+    const int K,
+    const float_complex alpha,
+    const float_complex beta,
+    const int ldc,
+    const int strideC,
+    const int nBatch,
+    float_complex* C
 )
 {
-    int i, j, info, n, lda;
-    float_complex* a;
-    
-    n = lda = dim;
-    a = malloc1d(dim*dim*sizeof(float_complex));
-    
-    /* store in column major order */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[j*dim+i] = A[i*dim+j];
-    
-    /* a is replaced by solution */
-#if defined(VECLIB_USE_CLAPACK_INTERFACE)
-    info = clapack_cpotrf(CblasColMajor, CblasUpper, n, (veclib_float_complex*)a, lda);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    info = LAPACKE_cpotrf(CblasColMajor, CblasUpper, n, (veclib_float_complex*)a, lda);
-#elif defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    cpotrf_( "U", &n, (veclib_float_complex*)a, &lda, &info );
-#endif
-    
-    /* A is not positive definate, solution not possible */
-    if(info>0){
-        memset(X, 0, dim*dim*sizeof(float_complex));
-#ifndef NDEBUG
-        saf_error_print(SAF_WARNING__FAILED_TO_COMPUTE_CHOL);
+#if defined(INTEL_MKL_VERSION) && INTEL_MKL_VERSION >= 20200002
+    cblas_cgemm_batch_strided(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, &alpha,
+                              A, lda, strideA, B, ldb, strideB, &beta,
+                              C, ldc, strideC, nBatch);
+#else
+    int b;
+    for(b=0; b<nBatch; b++)
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, &alpha,
+                    &A[b*strideA], lda, &B[b*strideB], ldb, &beta,
+                    &C[b*strideC], ldc);
 #endif
-    }
-    /* store solution in row-major order */
-    else{
-        for(i=0; i<dim; i++)
-            for(j=0; j<dim; j++)
-                X[i*dim+j] = j>=i ? a[j*dim+i] : cmplxf(0.0f, 0.0f);
-    }
-    
-    free(a);
 }
 
 
 /* ========================================================================== */
-/*                           Matrix Inversion (?inv)                          */
+/*                     BLAS/LAPACK Backend Threading                          */
 /* ========================================================================== */
 
-// TODO: rewrite for row-major
-void utility_sinv(float * A, const int N)
+/** Number of backend threads within the processing functions */
+static volatile int saf_blasThreads_nProcessing = 1;
+
+void saf_blasThreads_setProcessingNumThreads
+(
+    int nThreads
+)
 {
-    int *IPIV;
-    IPIV = malloc1d(N * sizeof(int));
-    int LWORK = N*N;
-    float *WORK;
-    WORK = (float*)malloc1d(LWORK * sizeof(float));
-    int INFO;
-    
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    sgetrf_((veclib_int*)&N, (veclib_int*)&N, A, (veclib_int*)&N, IPIV, &INFO);
-    sgetri_((veclib_int*)&N, A, (veclib_int*)&N, IPIV, WORK, &LWORK, &INFO);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    INFO = clapack_sgetrf(CblasColMajor, N, N, A, N, IPIV);
-    INFO = clapack_sgetri(CblasColMajor, N, A, N, IPIV);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    INFO = LAPACKE_sgetrf(CblasColMajor, N, N, A, N, IPIV);
-    INFO = LAPACKE_sgetri(CblasColMajor, N, A, N, IPIV);
+    saf_blasThreads_nProcessing = MAX(nThreads, 0);
+}
+
+int saf_blasThreads_getProcessingNumThreads(void)
+{
+    return saf_blasThreads_nProcessing;
+}
+
+int saf_blasThreads_begin
+(
+    int nThreads
+)
+{
+#if defined(SAF_USE_INTEL_MKL)
+    /* (0 reverts the calling thread to the global setting) */
+    return mkl_set_num_threads_local(MAX(nThreads, 0));
+#else
+    (void)nThreads;
+    return 0;
 #endif
-    
-    free(IPIV);
-    free(WORK);
 }
 
-void utility_dinv(double* A, const int N)
+int saf_blasThreads_beginProcessing(void)
 {
-    int *IPIV;
-    IPIV = malloc1d( (N+1)*sizeof(int));
-    int LWORK = N*N;
-    double *WORK;
-    WORK = malloc1d( LWORK*sizeof(double));
-    int INFO;
-    
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    dgetrf_((veclib_int*)&N, (veclib_int*)&N, A, (veclib_int*)&N, IPIV, &INFO);
-    dgetri_((veclib_int*)&N, A, (veclib_int*)&N, IPIV, WORK, &LWORK, &INFO);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    INFO = clapack_dgetrf(CblasColMajor, N, N, A, N, IPIV);
-    INFO = clapack_dgetri(CblasColMajor, N, A, N, IPIV);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    INFO = LAPACKE_dgetrf(CblasColMajor, N, N, A, N, IPIV);
-    INFO = LAPACKE_dgetri(CblasColMajor, N, A, N, IPIV);
+    return saf_blasThreads_begin(saf_blasThreads_nProcessing);
+}
+
+void saf_blasThreads_end
+(
+    int prevState
+)
+{
+#if defined(SAF_USE_INTEL_MKL)
+    mkl_set_num_threads_local(prevState);
+#else
+    (void)prevState;
 #endif
-    
-    free(IPIV);
-    free(WORK);
 }
 
-void utility_cinv(float_complex * A, const int N)
+void saf_blasThreads_setGlobalNumThreads
+(
+    int nThreads
+)
 {
-    int *IPIV;
-    IPIV = malloc1d(N * sizeof(int));
-    int LWORK = N*N;
-    float_complex *WORK;
-    WORK = (float_complex*)malloc1d(LWORK * sizeof(float_complex));
-    int INFO;
-    
-#if defined(VECLIB_USE_LAPACK_FORTRAN_INTERFACE)
-    cgetrf_((veclib_int*)&N, (veclib_int*)&N, (veclib_float_complex*)A, (veclib_int*)&N, IPIV, &INFO);
-    cgetri_((veclib_int*)&N, (veclib_float_complex*)A, (veclib_int*)&N, IPIV, (veclib_float_complex*)WORK, &LWORK, &INFO);
-#elif defined(VECLIB_USE_CLAPACK_INTERFACE)
-    INFO = clapack_cgetrf(CblasColMajor, N, N, (veclib_float_complex*)A, N, IPIV);
-    INFO = clapack_cgetri(CblasColMajor, N, (veclib_float_complex*)A, N, IPIV);
-#elif defined(VECLIB_USE_LAPACKE_INTERFACE)
-    INFO = LAPACKE_cgetrf(CblasColMajor, N, N, (veclib_float_complex*)A, N, IPIV);
-    INFO = LAPACKE_cgetri(CblasColMajor, N, (veclib_float_complex*)A, N, IPIV);
+    nThreads = MAX(nThreads, 1);
+#if defined(SAF_USE_INTEL_MKL)
+    mkl_set_num_threads(nThreads);
+#elif defined(SAF_USE_OPEN_BLAS_AND_LAPACKE)
+    openblas_set_num_threads(nThreads);
+#else
+    (void)nThreads;
+#endif
+}
+
+int saf_blasThreads_isScoped(void)
+{
+#if defined(SAF_USE_INTEL_MKL)
+    return 1;
+#else
+    return 0;
 #endif
-    
-    free(IPIV);
-    free(WORK);
 }
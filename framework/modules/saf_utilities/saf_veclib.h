@@ -31,6 +31,11 @@
  *       to enable ATLAS BLAS routines and ATLAS's CLAPACK interface
  *   - SAF_USE_OPENBLAS_WITH_LAPACKE:
  *       to enable OpenBLAS with LAPACKE interface
+ *   - SAF_USE_BUILTIN_BLAS_AND_LAPACK:
+ *       to employ the minimal built-in subset of CBLAS and LAPACKE (see
+ *       saf_builtinBlas.h), which requires no library; e.g. for WebAssembly
+ *       builds (the default for Emscripten, and for SAF_EMBEDDED_PROFILE, if
+ *       none of the above are defined)
  *
  * @see More information can be found here:
  *      https://github.com/leomccormack/Spatial_Audio_Framework
@@ -71,6 +76,14 @@ typedef enum _CONJ_FLAG{
   CONJ = 2      /**< Take the conjugate */
 }CONJ_FLAG;
 
+/**
+ * Number of bins per block in utility_cvvmacsum() (256 bins, i.e. 2kB of
+ * output, leaves most of the L1 cache for streaming in the inputs)
+ */
+#ifndef SAF_VECLIB_MACSUM_BLOCK_LENGTH
+# define SAF_VECLIB_MACSUM_BLOCK_LENGTH ( 256 )
+#endif
+
 /* KEY:
  * ? -> s -> single floating-point precision
  * ? -> d -> double floating-point precision
@@ -81,6 +94,20 @@ typedef enum _CONJ_FLAG{
  * v -> vector
  * m -> matrix */
 
+/* ========================================================================== */
+/*                                CPU Features                                */
+/* ========================================================================== */
+
+/**
+ * Returns 1 if the AVX2 (and FMA) kernels are compiled in, and are supported by
+ * the CPU (and OS) at run-time; 0 otherwise
+ *
+ * @note Other modules may use this to select their own AVX2 code paths (see
+ *       e.g. biQuadCascade_create()).
+ */
+int utility_cpuHasAVX2(void);
+
+
 /* ========================================================================== */
 /*                     Find Index of Min-Abs-Value (?iminv)                   */
 /* ========================================================================== */
@@ -192,6 +219,207 @@ void utility_cvabs(/* Input Arguments */
                    float* c);
 
 
+/* ========================================================================== */
+/*                            Vector-Atan2 (?vatan2)                          */
+/* ========================================================================== */
+
+/**
+ * Single-precision, four-quadrant inverse tangent of vector elements, i.e.
+ * \code{.m}
+ *     c = atan2(a, b)
+ * \endcode
+ *
+ * @param[in]  a   Input vector a (y-coordinates); len x 1
+ * @param[in]  b   Input vector b (x-coordinates); len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c, in radians; len x 1
+ */
+void utility_svatan2(/* Input Arguments */
+                     const float* a,
+                     const float* b,
+                     const int len,
+                     /* Output Arguments */
+                     float* c);
+
+
+/* ========================================================================== */
+/*                   Approximate Vector-Log2/Exp2 (?vlog2/?vexp2)             */
+/* ========================================================================== */
+
+/**
+ * Single-precision, fast approximation of the base-2 logarithm of vector
+ * elements (accurate to ~1e-7 times max(1,|c|)), i.e.
+ * \code{.m}
+ *     c = log2(a)
+ * \endcode
+ *
+ * Intended for e.g. level detection, where the accuracy of log2f() is not
+ * needed. The elements of 'a' must be positive, normal numbers.
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a'); len x 1
+ */
+void utility_svlog2approx(/* Input Arguments */
+                          const float* a,
+                          const int len,
+                          /* Output Arguments */
+                          float* c);
+
+/**
+ * Single-precision, fast approximation of 2 raised to the power of vector
+ * elements (accurate to ~3e-7, relative), i.e.
+ * \code{.m}
+ *     c = 2.^a
+ * \endcode
+ *
+ * The elements of 'a' are clamped to [-126, 126].
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a'); len x 1
+ */
+void utility_svexp2approx(/* Input Arguments */
+                          const float* a,
+                          const int len,
+                          /* Output Arguments */
+                          float* c);
+
+
+/* ========================================================================== */
+/*        Approximate Vector-SinCos/Atan2/Exp/Log/Pow (?vsincos/?vatan2...)   */
+/* ========================================================================== */
+
+/**
+ * Single-precision, fast approximation of the sine and cosine of vector
+ * elements (accurate to ~1e-7, absolute), i.e.
+ * \code{.m}
+ *     s = sin(a); c = cos(a)
+ * \endcode
+ *
+ * @note The arguments are reduced to [-pi/4, pi/4] with a four-part pi/2, so
+ *       the accuracy holds for |a| < 1e5 (which covers any angle in radians or
+ *       phase that is wrapped once per frame); the error grows quickly beyond
+ *       that (e.g. to ~2e-6 at 1.3e5), and larger arguments are invalid.
+ *
+ * @param[in]  a   Input vector a, in radians; len x 1
+ * @param[in]  len Vector length
+ * @param[out] s   Sine of 'a' (may be the same as 'a'); len x 1
+ * @param[out] c   Cosine of 'a'; len x 1
+ */
+void utility_svsincosapprox(/* Input Arguments */
+                            const float* a,
+                            const int len,
+                            /* Output Arguments */
+                            float* s,
+                            float* c);
+
+/**
+ * Single-precision, fast approximation of the four-quadrant inverse tangent of
+ * vector elements (accurate to ~3e-7 radians), i.e.
+ * \code{.m}
+ *     c = atan2(a, b)
+ * \endcode
+ *
+ * Returns 0 if both a and b are zero (regardless of their signs).
+ *
+ * @param[in]  a   Input vector a (y-coordinates); len x 1
+ * @param[in]  b   Input vector b (x-coordinates); len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c, in radians (may be the same as 'a' or 'b');
+ *                 len x 1
+ */
+void utility_svatan2approx(/* Input Arguments */
+                           const float* a,
+                           const float* b,
+                           const int len,
+                           /* Output Arguments */
+                           float* c);
+
+/**
+ * Single-precision, fast approximation of the exponential of vector elements
+ * (accurate to ~3e-7 + 6e-8*|a|, relative), i.e.
+ * \code{.m}
+ *     c = exp(a)
+ * \endcode
+ *
+ * As with utility_svexp2approx(), the result is clamped to [2^-126, 2^126];
+ * i.e. |a| < 87.
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a'); len x 1
+ */
+void utility_svexpapprox(/* Input Arguments */
+                         const float* a,
+                         const int len,
+                         /* Output Arguments */
+                         float* c);
+
+/**
+ * Single-precision, fast approximation of the natural logarithm of vector
+ * elements (accurate to ~1.5e-7 times max(1,|c|)), i.e.
+ * \code{.m}
+ *     c = log(a)
+ * \endcode
+ *
+ * The elements of 'a' must be positive, normal numbers.
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a'); len x 1
+ */
+void utility_svlogapprox(/* Input Arguments */
+                         const float* a,
+                         const int len,
+                         /* Output Arguments */
+                         float* c);
+
+/**
+ * Single-precision, fast approximation of vector elements raised to the power
+ * of vector elements (accurate to ~3e-7 times max(1,|b*log2(a)|), relative),
+ * i.e.
+ * \code{.m}
+ *     c = a.^b
+ * \endcode
+ *
+ * Evaluated as 2^(b*log2(a)); so the elements of 'a' must be positive, normal
+ * numbers, and the result is clamped as in utility_svexp2approx().
+ *
+ * @param[in]  a   Input vector a (bases); len x 1
+ * @param[in]  b   Input vector b (exponents); len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a', but not 'b');
+ *                 len x 1
+ */
+void utility_svpowapprox(/* Input Arguments */
+                         const float* a,
+                         const float* b,
+                         const int len,
+                         /* Output Arguments */
+                         float* c);
+
+/**
+ * Single-precision, fast approximation of the complex exponential of vector
+ * elements, i.e.
+ * \code{.m}
+ *     c = exp(a) = exp(real(a)) .* (cos(imag(a)) + 1i*sin(imag(a)))
+ * \endcode
+ *
+ * The accuracy (and valid range) of the magnitude and phase terms are those
+ * of utility_svexpapprox() and utility_svsincosapprox(), respectively.
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c (may be the same as 'a'); len x 1
+ */
+void utility_cvexpapprox(/* Input Arguments */
+                         const float_complex* a,
+                         const int len,
+                         /* Output Arguments */
+                         float_complex* c);
+
+
 /* ========================================================================== */
 /*                        Vector-Vector Copy (?vvcopy)                        */
 /* ========================================================================== */
@@ -355,6 +583,32 @@ void utility_cvvmul(/* Input Arguments */
                     /* Output Arguments */
 	                float_complex* c);
 
+/**
+ * Single-precision, complex, sum of element-wise vector-vector products i.e.
+ * \code{.m}
+ *     c = a{1}.*b{1} + a{2}.*b{2} + ... + a{nPairs}.*b{nPairs}
+ * \endcode
+ *
+ * The multiply-accumulate is fused, and carried out over blocks of
+ * #SAF_VECLIB_MACSUM_BLOCK_LENGTH bins, so that the output bins remain in the
+ * L1 cache while all of the pairs are accumulated. This is intended for
+ * partitioned convolution, where 'a' and 'b' point to the filter and input
+ * spectra (of each partition and channel) that contribute to one output.
+ *
+ * @param[in]  a      Input vectors a; nPairs x (len x 1)
+ * @param[in]  b      Input vectors b; nPairs x (len x 1)
+ * @param[in]  nPairs Number of vector pairs (c is zeroed if nPairs==0)
+ * @param[in]  len    Vector length
+ * @param[out] c      Output vector c (must not alias 'a' or 'b'); len x 1
+ */
+void utility_cvvmacsum(/* Input Arguments */
+                       const float_complex** a,
+                       const float_complex** b,
+                       const int nPairs,
+                       const int len,
+                       /* Output Arguments */
+                       float_complex* c);
+
 
 /* ========================================================================== */
 /*                     Vector-Vector Dot Product (?vvdot)                     */
@@ -518,10 +772,281 @@ void utility_svssub(/* Input Arguments */
                     float* c);
 
 
+/* ========================================================================== */
+/*              Split-Complex Vector Operations (?vv..._split)                */
+/* ========================================================================== */
+
+/*
+ * These operate on float_complex_split vectors, where the real and imaginary
+ * parts are held in separate arrays. Unlike the interleaved format, no
+ * shuffling is required to vectorise complex multiplications, and afSTFT data
+ * (see complexVector) may be processed without first being copied into an
+ * interleaved buffer.
+ */
+
+/**
+ * Single-precision, converts an interleaved complex vector into split-complex
+ * format
+ *
+ * @param[in]  a   Input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   (&) output vector c; len x 1
+ */
+void utility_cvsplit(/* Input Arguments */
+                     const float_complex* a,
+                     const int len,
+                     /* Output Arguments */
+                     float_complex_split* c);
+
+/**
+ * Single-precision, converts a split-complex vector into interleaved complex
+ * format
+ *
+ * @param[in]  a   (&) input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   Output vector c; len x 1
+ */
+void utility_cvmerge(/* Input Arguments */
+                     const float_complex_split* a,
+                     const int len,
+                     /* Output Arguments */
+                     float_complex* c);
+
+/**
+ * Single-precision, split-complex, vector-vector copy, i.e.
+ * \code{.m}
+ *     c = a
+ * \endcode
+ *
+ * @param[in]  a   (&) input vector a; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   (&) output vector c; len x 1
+ */
+void utility_cvvcopy_split(/* Input Arguments */
+                           const float_complex_split* a,
+                           const int len,
+                           /* Output Arguments */
+                           float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, vector-vector addition, i.e.
+ * \code{.m}
+ *     c = a+b, OR: a = a+b (if c==NULL)
+ * \endcode
+ *
+ * @param[in]  a   (&) input vector a, and output if c==NULL; len x 1
+ * @param[in]  b   (&) input vector b; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   (&) output vector c (set to NULL if you want 'a' as output);
+ *                 len x 1
+ */
+void utility_cvvadd_split(/* Input Arguments */
+                          float_complex_split* a,
+                          const float_complex_split* b,
+                          const int len,
+                          /* Output Arguments */
+                          float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, vector-vector subtraction, i.e.
+ * \code{.m}
+ *     c = a-b, OR: a = a-b (if c==NULL)
+ * \endcode
+ *
+ * @param[in]  a   (&) input vector a, and output if c==NULL; len x 1
+ * @param[in]  b   (&) input vector b; len x 1
+ * @param[in]  len Vector length
+ * @param[out] c   (&) output vector c (set to NULL if you want 'a' as output);
+ *                 len x 1
+ */
+void utility_cvvsub_split(/* Input Arguments */
+                          float_complex_split* a,
+                          const float_complex_split* b,
+                          const int len,
+                          /* Output Arguments */
+                          float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, element-wise vector-vector multiplication,
+ * i.e.
+ * \code{.m}
+ *     c = a.*b, OR: a = a.*b (if c==NULL)
+ *     c = a.*conj(b), OR: a = a.*conj(b) (if c==NULL, and flag==CONJ)
+ * \endcode
+ *
+ * @param[in]  a    (&) input vector a, and output if c==NULL; len x 1
+ * @param[in]  b    (&) input vector b; len x 1
+ * @param[in]  len  Vector length
+ * @param[in]  flag NO_CONJ, or CONJ to take the conjugate of 'b'
+ * @param[out] c    (&) output vector c (set to NULL if you want 'a' as output);
+ *                  len x 1
+ */
+void utility_cvvmul_split(/* Input Arguments */
+                          float_complex_split* a,
+                          const float_complex_split* b,
+                          const int len,
+                          CONJ_FLAG flag,
+                          /* Output Arguments */
+                          float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, element-wise vector-vector multiply-
+ * accumulate, i.e.
+ * \code{.m}
+ *     c = c + a.*b, OR: c = c + a.*conj(b) (if flag==CONJ)
+ * \endcode
+ *
+ * @note This is the inner loop of most frequency-domain mixing and filtering
+ *       operations; e.g. for summing the contributions of all inputs to one
+ *       output of a mixing matrix, per band.
+ *
+ * @param[in]     a    (&) input vector a; len x 1
+ * @param[in]     b    (&) input vector b; len x 1
+ * @param[in]     len  Vector length
+ * @param[in]     flag NO_CONJ, or CONJ to take the conjugate of 'b'
+ * @param[in,out] c    (&) vector c, to which the products are added; len x 1
+ */
+void utility_cvvmac_split(/* Input Arguments */
+                          const float_complex_split* a,
+                          const float_complex_split* b,
+                          const int len,
+                          CONJ_FLAG flag,
+                          /* Input/Output Arguments */
+                          float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, multiplies each element in vector 'a' with
+ * a complex scalar 's', i.e.
+ * \code{.m}
+ *     c = a.*s, OR: a = a.*s (if c==NULL)
+ * \endcode
+ *
+ * @param[in]  a   (&) input vector a, and output if c==NULL; len x 1
+ * @param[in]  s   (&) input complex scalar s; 1 x 1
+ * @param[in]  len Vector length
+ * @param[out] c   (&) output vector c (set to NULL if you want 'a' as output);
+ *                 len x 1
+ */
+void utility_cvsmul_split(/* Input Arguments */
+                          float_complex_split* a,
+                          const float_complex* s,
+                          const int len,
+                          /* Output Arguments */
+                          float_complex_split* c);
+
+/**
+ * Single-precision, split-complex, vector-vector dot product, i.e.
+ * \code{.m}
+ *     c = a*b^T, OR: c = a*b^H (if flag==CONJ), (where size(c) = [1  1])
+ * \endcode
+ *
+ * @param[in]  a    (&) input vector a; len x 1
+ * @param[in]  b    (&) input vector b; len x 1
+ * @param[in]  len  Vector length
+ * @param[in]  flag NO_CONJ, or CONJ to take the conjugate of 'b'
+ * @param[out] c    (&) output scalar c; 1 x 1
+ */
+void utility_cvvdot_split(/* Input Arguments */
+                          const float_complex_split* a,
+                          const float_complex_split* b,
+                          const int len,
+                          CONJ_FLAG flag,
+                          /* Output Arguments */
+                          float_complex* c);
+
+
+/* ========================================================================== */
+/*                   Reduced-Precision Storage (?vpack/?vunpack)              */
+/* ========================================================================== */
+
+/**
+ * Available storage formats for large, read-mostly tables of single-precision
+ * data (e.g. HRTF magnitudes and interpolation tables), which are converted
+ * to/from single-precision on the fly
+ */
+typedef enum _SAF_STORAGE_PRECISION{
+    SAF_STORAGE_FLOAT32 = 1, /**< Single-precision (4 bytes per value) */
+    SAF_STORAGE_FLOAT16,     /**< IEEE 754 half-precision (2 bytes per value);
+                              *   11-bit significand, range of +/-65504 */
+    SAF_STORAGE_BFLOAT16     /**< bfloat16 (2 bytes per value); 8-bit
+                              *   significand, same range as single-precision */
+
+}SAF_STORAGE_PRECISION;
+
+/** Returns the number of bytes used to store one value in a given format */
+size_t utility_storagePrecisionBytes(SAF_STORAGE_PRECISION precision);
+
+/**
+ * Single-precision, converts a vector into a given storage format (rounding
+ * to the nearest representable value, ties to even)
+ *
+ * @note Values outside the range of SAF_STORAGE_FLOAT16 become +/-Inf, and
+ *       those below its smallest subnormal value become (signed) zero.
+ *
+ * @param[in]  a         Input vector a; len x 1
+ * @param[in]  len       Vector length
+ * @param[in]  precision Storage format of 'c'; see #SAF_STORAGE_PRECISION
+ * @param[out] c         Output vector c;
+ *                       len*utility_storagePrecisionBytes(precision) bytes
+ */
+void utility_svpack(/* Input Arguments */
+                    const float* a,
+                    const int len,
+                    SAF_STORAGE_PRECISION precision,
+                    /* Output Arguments */
+                    void* c);
+
+/**
+ * Single-precision, converts a vector from a given storage format (see
+ * utility_svpack()) back into single-precision; this conversion is exact
+ *
+ * @param[in]  a         Input vector a;
+ *                       len*utility_storagePrecisionBytes(precision) bytes
+ * @param[in]  len       Vector length
+ * @param[in]  precision Storage format of 'a'; see #SAF_STORAGE_PRECISION
+ * @param[out] c         Output vector c; len x 1
+ */
+void utility_svunpack(/* Input Arguments */
+                      const void* a,
+                      const int len,
+                      SAF_STORAGE_PRECISION precision,
+                      /* Output Arguments */
+                      float* c);
+
+
 /* ========================================================================== */
 /*                     Singular-Value Decomposition (?svd)                    */
 /* ========================================================================== */
     
+/**
+ * Creates a workspace for utility_ssvd(), for input dimensions up to the
+ * maximums given here
+ *
+ * The copies of the input/output matrices and the LAPACK work arrays are
+ * allocated here, with the workspace size being queried only once for the
+ * maximum dimensions. Passing the workspace then makes utility_ssvd()
+ * allocation-free (which is also true for all of the other decomposition
+ * and solver workspaces in this file), and therefore suitable for calling
+ * every frame from a real-time audio thread. If NULL is passed as the
+ * workspace, a temporary one is created (and destroyed) within the call.
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_ssvd_create(/* Input Arguments */
+                         void ** const phWork,
+                         int maxDim1,
+                         int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_ssvd_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_ssvd_destroy(/* Input Arguments */
+                          void ** const phWork);
+
 /**
  * Row-major, singular value decomposition: single precision, i.e.
  * \code{.m}
@@ -532,18 +1057,20 @@ void utility_svssub(/* Input Arguments */
  *       the singular values as a vector. Also, V is returned untransposed!
  *       (like in Matlab)
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 First dimension of matrix 'A'
- * @param[in]  dim2 Second dimension of matrix 'A'
- * @param[out] U    Left matrix (set to NULL if not needed); FLAT: dim1 x dim1
- * @param[out] S    Singular values along the diagonal min(dim1, dim2), (set to
- *                  NULL if not needed); FLAT: dim1 x dim2
- * @param[out] V    Right matrix (UNTRANSPOSED!) (set to NULL if not needed);
- *                  FLAT: dim2 x dim2
- * @param[out] sing Singular values as a vector, (set to NULL if not needed);
- *                  min(dim1, dim2) x 1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_ssvd_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  First dimension of matrix 'A'
+ * @param[in]  dim2  Second dimension of matrix 'A'
+ * @param[out] U     Left matrix (set to NULL if not needed); FLAT: dim1 x dim1
+ * @param[out] S     Singular values along the diagonal min(dim1, dim2), (set to
+ *                   NULL if not needed); FLAT: dim1 x dim2
+ * @param[out] V     Right matrix (UNTRANSPOSED!) (set to NULL if not needed);
+ *                   FLAT: dim2 x dim2
+ * @param[out] sing  Singular values as a vector, (set to NULL if not needed);
+ *                   min(dim1, dim2) x 1
  */
 void utility_ssvd(/* Input Arguments */
+                  void* const hWork,
                   const float* A,
                   const int dim1,
                   const int dim2,
@@ -553,6 +1080,27 @@ void utility_ssvd(/* Input Arguments */
                   float* V,
                   float* sing);
 
+/**
+ * Creates a workspace for utility_csvd(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_csvd_create(/* Input Arguments */
+                         void ** const phWork,
+                         int maxDim1,
+                         int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_csvd_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_csvd_destroy(/* Input Arguments */
+                          void ** const phWork);
+
 /**
  * Row-major, singular value decomposition: single precision complex, i.e.
  * \code{.m}
@@ -563,18 +1111,20 @@ void utility_ssvd(/* Input Arguments */
  *       the singular values as a vector. Also, V is returned untransposed!
  *       (like in Matlab)
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 First dimension of matrix 'A'
- * @param[in]  dim2 Second dimension of matrix 'A'
- * @param[out] U    Left matrix (set to NULL if not needed); FLAT: dim1 x dim1
- * @param[out] S    Singular values along the diagonal min(dim1, dim2), (set to
- *                  NULL if not needed); FLAT: dim1 x dim2
- * @param[out] V    Right matrix (UNTRANSPOSED!) (set to NULL if not needed);
- *                  FLAT: dim2 x dim2
- * @param[out] sing Singular values as a vector, (set to NULL if not needed);
- *                  min(dim1, dim2) x 1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_csvd_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  First dimension of matrix 'A'
+ * @param[in]  dim2  Second dimension of matrix 'A'
+ * @param[out] U     Left matrix (set to NULL if not needed); FLAT: dim1 x dim1
+ * @param[out] S     Singular values along the diagonal min(dim1, dim2), (set to
+ *                   NULL if not needed); FLAT: dim1 x dim2
+ * @param[out] V     Right matrix (UNTRANSPOSED!) (set to NULL if not needed);
+ *                   FLAT: dim2 x dim2
+ * @param[out] sing  Singular values as a vector, (set to NULL if not needed);
+ *                   min(dim1, dim2) x 1
  */
 void utility_csvd(/* Input Arguments */
+                  void* const hWork,
                   const float_complex* A,
                   const int dim1,
                   const int dim2,
@@ -589,6 +1139,25 @@ void utility_csvd(/* Input Arguments */
 /*                 Symmetric Eigenvalue Decomposition (?seig)                 */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_sseig(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrix 'A'
+ */
+void utility_sseig_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim);
+
+/**
+ * Destroys a workspace created with utility_sseig_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_sseig_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, eigenvalue decomposition of a SYMMETRIC matrix: single precision,
  * i.e.
@@ -599,6 +1168,7 @@ void utility_csvd(/* Input Arguments */
  * @note 'D' contains the eigen values along the diagonal, while 'eig' are the
  *       eigen values as a vector
  *
+ * @param[in]  hWork       Workspace handle (or NULL); see utility_sseig_create()
  * @param[in]  A           Input SYMMETRIC square matrix; FLAT: dim x dim
  * @param[in]  dim         Dimensions for square matrix 'A'
  * @param[in]  sortDecFLAG '1' sort eigen values and vectors in decending order.
@@ -611,6 +1181,7 @@ void utility_csvd(/* Input Arguments */
  *                         needed); dim x 1
  */
 void utility_sseig(/* Input Arguments */
+                   void* const hWork,
                    const float* A,
                    const int dim,
                    int sortDecFLAG,
@@ -619,6 +1190,25 @@ void utility_sseig(/* Input Arguments */
                    float* D,
                    float* eig);
 
+/**
+ * Creates a workspace for utility_cseig(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrix 'A'
+ */
+void utility_cseig_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim);
+
+/**
+ * Destroys a workspace created with utility_cseig_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cseig_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, eigenvalue decomposition of a SYMMETRIC/HERMITION matrix: single
  * precision complex, i.e.
@@ -629,6 +1219,7 @@ void utility_sseig(/* Input Arguments */
  * @note 'D' contains the eigen values along the diagonal, while 'eig' are the
  *       eigen values as a vector
  *
+ * @param[in]  hWork       Workspace handle (or NULL); see utility_cseig_create()
  * @param[in]  A           Input SYMMETRIC square matrix; FLAT: dim x dim
  * @param[in]  dim         Dimensions for square matrix 'A'
  * @param[in]  sortDecFLAG '1' sort eigen values and vectors in decending order.
@@ -641,6 +1232,7 @@ void utility_sseig(/* Input Arguments */
  *                         needed); dim x 1
  */
 void utility_cseig(/* Input Arguments */
+                   void* const hWork,
                    const float_complex* A,
                    const int dim,
                    int sortDecFLAG,
@@ -649,11 +1241,88 @@ void utility_cseig(/* Input Arguments */
                    float_complex* D,
                    float* eig);
 
-
-/* ========================================================================== */
-/*                     Eigenvalues of Matrix Pair (?eigmp)                    */
-/* ========================================================================== */
-
+/**
+ * Creates a workspace for utility_cseigr(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrix 'A'
+ */
+void utility_cseigr_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim);
+
+/**
+ * Destroys a workspace created with utility_cseigr_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cseigr_destroy(/* Input Arguments */
+                            void ** const phWork);
+
+/**
+ * Row-major, eigenvalue decomposition of a SYMMETRIC/HERMITION matrix, which
+ * computes only a subset of the eigenvalues and vectors: single precision
+ * complex, i.e.
+ * \code{.m}
+ *     [V,D] = eig(A); V = V(:,idxFirst+1:idxLast+1); (in ascending order)
+ * \endcode
+ *
+ * This uses the MRRR algorithm (?heevr) with an index range, which is
+ * considerably cheaper than utility_cseig() when only the signal or noise
+ * sub-space is required (e.g. for subspace-based DoA estimators).
+ *
+ * @note The indices refer to the eigenvalues sorted in ascending order,
+ *       regardless of 'sortDecFLAG'; which instead only dictates the order of
+ *       the output (nEig = idxLast-idxFirst+1).
+ *
+ * @param[in]  hWork       Workspace handle (or NULL); see utility_cseigr_create()
+ * @param[in]  A           Input SYMMETRIC square matrix; FLAT: dim x dim
+ * @param[in]  dim         Dimensions for square matrix 'A'
+ * @param[in]  idxFirst    Index of the first eigenvalue to compute (0-based)
+ * @param[in]  idxLast     Index of the last eigenvalue to compute (0-based,
+ *                         inclusive)
+ * @param[in]  sortDecFLAG '1' sort eigen values and vectors in decending order.
+ *                         '0' ascending
+ * @param[out] V           Eigen vectors (set to NULL if not needed);
+ *                         FLAT: dim x nEig
+ * @param[out] eig         Eigen values (set to NULL if not needed); nEig x 1
+ */
+void utility_cseigr(/* Input Arguments */
+                    void* const hWork,
+                    const float_complex* A,
+                    const int dim,
+                    const int idxFirst,
+                    const int idxLast,
+                    int sortDecFLAG,
+                    /* Output Arguments */
+                    float_complex* V,
+                    float* eig);
+
+
+/* ========================================================================== */
+/*                     Eigenvalues of Matrix Pair (?eigmp)                    */
+/* ========================================================================== */
+
+/**
+ * Creates a workspace for utility_ceigmp(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrices 'A' and 'B'
+ */
+void utility_ceigmp_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim);
+
+/**
+ * Destroys a workspace created with utility_ceigmp_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_ceigmp_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, finds eigenvalues of a matrix pair using the QZ method, single
  * precision complex, i.e.
@@ -661,17 +1330,19 @@ void utility_cseig(/* Input Arguments */
  *     [VL,VR,D] = eig(A,B,'qz'); where A*VL = B*VL*VR
  * \endcode
  *
- * @param[in]  A   Input left square matrix; FLAT: dim x dim
- * @param[in]  B   Input right square matrix; FLAT: dim x dim
- * @param[in]  dim Dimensions for square matrices 'A' and 'B'
- * @param[out] VL  Left Eigen vectors (set to NULL if not needed);
- *                 FLAT: dim x dim
- * @param[out] VR  Right Eigen vectors (set to NULL if not needed);
- *                 FLAT: dim x dim
- * @param[out] D   Eigen values along the diagonal (set to NULL if not needed);
- *                 FLAT: dim x dim
+ * @param[in]  hWork Workspace handle (or NULL); see utility_ceigmp_create()
+ * @param[in]  A     Input left square matrix; FLAT: dim x dim
+ * @param[in]  B     Input right square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrices 'A' and 'B'
+ * @param[out] VL    Left Eigen vectors (set to NULL if not needed);
+ *                   FLAT: dim x dim
+ * @param[out] VR    Right Eigen vectors (set to NULL if not needed);
+ *                   FLAT: dim x dim
+ * @param[out] D     Eigen values along the diagonal (set to NULL if not needed);
+ *                   FLAT: dim x dim
  */
 void utility_ceigmp(/* Input Arguments */
+                    void* const hWork,
                     const float_complex* A,
                     const float_complex* B,
                     const int dim,
@@ -680,6 +1351,25 @@ void utility_ceigmp(/* Input Arguments */
                     float_complex* VR,
                     float_complex* D);
 
+/**
+ * Creates a workspace for utility_zeigmp(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrices 'A' and 'B'
+ */
+void utility_zeigmp_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim);
+
+/**
+ * Destroys a workspace created with utility_zeigmp_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_zeigmp_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, finds eigenvalues of a matrix pair using the QZ method, double
  * precision complex, i.e.
@@ -687,17 +1377,19 @@ void utility_ceigmp(/* Input Arguments */
  *     [VL,VR,D] = eig(A,B,'qz'); where A*VL = B*VL*VR
  * \endcode
  *
- * @param[in]  A   Input left square matrix; FLAT: dim x dim
- * @param[in]  B   Input right square matrix; FLAT: dim x dim
- * @param[in]  dim Dimensions for square matrices 'A' and 'B'
- * @param[out] VL  Left Eigen vectors (set to NULL if not needed);
- *                 FLAT: dim x dim
- * @param[out] VR  Right Eigen vectors (set to NULL if not needed);
- *                 FLAT: dim x dim
- * @param[out] D   Eigen values along the diagonal (set to NULL if not needed);
- *                 FLAT: dim x dim
+ * @param[in]  hWork Workspace handle (or NULL); see utility_zeigmp_create()
+ * @param[in]  A     Input left square matrix; FLAT: dim x dim
+ * @param[in]  B     Input right square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrices 'A' and 'B'
+ * @param[out] VL    Left Eigen vectors (set to NULL if not needed);
+ *                   FLAT: dim x dim
+ * @param[out] VR    Right Eigen vectors (set to NULL if not needed);
+ *                   FLAT: dim x dim
+ * @param[out] D     Eigen values along the diagonal (set to NULL if not needed);
+ *                   FLAT: dim x dim
  */
 void utility_zeigmp(/* Input Arguments */
+                    void* const hWork,
                     const double_complex* A,
                     const double_complex* B,
                     const int dim,
@@ -711,6 +1403,25 @@ void utility_zeigmp(/* Input Arguments */
 /*                       Eigenvalue Decomposition (?eig)                      */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_ceig(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum dimensions for square matrix 'A'
+ */
+void utility_ceig_create(/* Input Arguments */
+                         void ** const phWork,
+                         int maxDim);
+
+/**
+ * Destroys a workspace created with utility_ceig_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_ceig_destroy(/* Input Arguments */
+                          void ** const phWork);
+
 /**
  * Row-major, eigenvalue decomposition of a NON-SYMMETRIC matrix: single
  * precision complex, i.e.
@@ -721,6 +1432,7 @@ void utility_zeigmp(/* Input Arguments */
  * @note 'D' contains the eigen values along the diagonal, while 'eig' are the
  *       eigen values as a vector
  *
+ * @param[in]  hWork       Workspace handle (or NULL); see utility_ceig_create()
  * @param[in]  A           Input NON-SYMMETRIC square matrix; FLAT: dim x dim
  * @param[in]  dim         Dimensions for square matrix 'A'
  * @param[in]  sortDecFLAG '1' sort eigen values and vectors in decending order.
@@ -735,6 +1447,7 @@ void utility_zeigmp(/* Input Arguments */
  *                         needed); dim x 1
  */
 void utility_ceig(/* Input Arguments */
+                  void* const hWork,
                   const float_complex* A,
                   const int dim,
                   int sortDecFLAG,
@@ -749,19 +1462,42 @@ void utility_ceig(/* Input Arguments */
 /*                       General Linear Solver (?glslv)                       */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_sglslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_sglslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_sglslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_sglslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, general linear solver: single precision, i.e.
  * \code{.m}
  *     X = linsolve(A,B) = A\B; where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_sglslv_create()
+ * @param[in]  A     Input square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_sglslv(/* Input Arguments */
+                    void* const hWork,
                     const float* A,
                     const int dim,
                     float* B,
@@ -769,19 +1505,42 @@ void utility_sglslv(/* Input Arguments */
                     /* Output Arguments */
                     float* X);
 
+/**
+ * Creates a workspace for utility_cglslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_cglslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_cglslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cglslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, general linear solver: single precision complex, i.e.
  * \code{.m}
  *     X = linsolve(A,B) = A\B; where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_cglslv_create()
+ * @param[in]  A     Input square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_cglslv(/* Input Arguments */
+                    void* const hWork,
                     const float_complex* A,
                     const int dim,
                     float_complex* B,
@@ -789,19 +1548,42 @@ void utility_cglslv(/* Input Arguments */
                     /* Output Arguments */
                     float_complex* X);
 
+/**
+ * Creates a workspace for utility_dglslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_dglslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_dglslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_dglslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, general linear solver: double precision, i.e.
  * \code{.m}
  *     X = linsolve(A,B) = A\B; where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_dglslv_create()
+ * @param[in]  A     Input square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_dglslv(/* Input Arguments */
+                    void* const hWork,
                     const double* A,
                     const int dim,
                     double* B,
@@ -809,19 +1591,42 @@ void utility_dglslv(/* Input Arguments */
                     /* Output Arguments */
                     double* X);
 
+/**
+ * Creates a workspace for utility_zglslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_zglslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_zglslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_zglslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, general linear solver: double precision complex, i.e.
  * \code{.m}
  *     X = linsolve(A,B) = A\B; where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_zglslv_create()
+ * @param[in]  A     Input square matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_zglslv(/* Input Arguments */
+                    void* const hWork,
                     const double_complex* A,
                     const int dim,
                     double_complex* B,
@@ -834,6 +1639,27 @@ void utility_zglslv(/* Input Arguments */
 /*                      Symmetric Linear Solver (?slslv)                      */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_sslslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_sslslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_sslslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_sslslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, linear solver for SYMMETRIC positive-definate 'A': single
  * precision, i.e.
@@ -842,13 +1668,15 @@ void utility_zglslv(/* Input Arguments */
  *     X = linsolve(A,B, opts); where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square SYMMETRIC positive-definate matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_sslslv_create()
+ * @param[in]  A     Input square SYMMETRIC positive-definate matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_sslslv(/* Input Arguments */
+                    void* const hWork,
                     const float* A,
                     const int dim,
                     float* B,
@@ -856,6 +1684,27 @@ void utility_sslslv(/* Input Arguments */
                     /* Output Arguments */
                     float* X);
 
+/**
+ * Creates a workspace for utility_cslslv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim  Maximum dimensions for square matrix 'A'
+ * @param[in] maxNCol Maximum number of columns in right hand side matrix
+ */
+void utility_cslslv_create(/* Input Arguments */
+                           void ** const phWork,
+                           int maxDim,
+                           int maxNCol);
+
+/**
+ * Destroys a workspace created with utility_cslslv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cslslv_destroy(/* Input Arguments */
+                            void ** const phWork);
+
 /**
  * Row-major, linear solver for HERMITIAN positive-definate 'A': single
  * precision complex, i.e.
@@ -864,13 +1713,15 @@ void utility_sslslv(/* Input Arguments */
  *     X = linsolve(A,B, opts); where, AX = B
  * \endcode
  *
- * @param[in]  A    Input square SYMMETRIC positive-definate matrix; FLAT: dim x dim
- * @param[in]  dim  Dimensions for square matrix 'A'
- * @param[in]  B    Right hand side matrix; FLAT: dim x nCol
- * @param[in]  nCol Number of columns in right hand side matrix
- * @param[out] X    The solution; FLAT: dim x nCol
+ * @param[in]  hWork Workspace handle (or NULL); see utility_cslslv_create()
+ * @param[in]  A     Input square SYMMETRIC positive-definate matrix; FLAT: dim x dim
+ * @param[in]  dim   Dimensions for square matrix 'A'
+ * @param[in]  B     Right hand side matrix; FLAT: dim x nCol
+ * @param[in]  nCol  Number of columns in right hand side matrix
+ * @param[out] X     The solution; FLAT: dim x nCol
  */
 void utility_cslslv(/* Input Arguments */
+                    void* const hWork,
                     const float_complex* A,
                     const int dim,
                     float_complex* B,
@@ -883,6 +1734,27 @@ void utility_cslslv(/* Input Arguments */
 /*                        Matrix Pseudo-Inverse (?pinv)                       */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_spinv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_spinv_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim1,
+                          int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_spinv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_spinv_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, general matrix pseudo-inverse (the svd way): single precision,
  * i.e.
@@ -890,18 +1762,41 @@ void utility_cslslv(/* Input Arguments */
  *     B = pinv(A)
  * \endcode
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 Number of rows in 'A' / columns in 'B'
- * @param[in]  dim2 Number of columns in 'A' / rows in 'B'
- * @param[out] B    The solution; FLAT: dim2 x dim1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_spinv_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  Number of rows in 'A' / columns in 'B'
+ * @param[in]  dim2  Number of columns in 'A' / rows in 'B'
+ * @param[out] B     The solution; FLAT: dim2 x dim1
  */
 void utility_spinv(/* Input Arguments */
+                   void* const hWork,
                    const float* A,
                    const int dim1,
                    const int dim2,
                    /* Output Arguments */
                    float* B);
 
+/**
+ * Creates a workspace for utility_cpinv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_cpinv_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim1,
+                          int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_cpinv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cpinv_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, general matrix pseudo-inverse (the svd way): single precision
  * complex, i.e.
@@ -909,18 +1804,41 @@ void utility_spinv(/* Input Arguments */
  *     B = pinv(A)
  * \endcode
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 Number of rows in 'A' / columns in 'B'
- * @param[in]  dim2 Number of columns in 'A' / rows in 'B'
- * @param[out] B    The solution; FLAT: dim2 x dim1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_cpinv_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  Number of rows in 'A' / columns in 'B'
+ * @param[in]  dim2  Number of columns in 'A' / rows in 'B'
+ * @param[out] B     The solution; FLAT: dim2 x dim1
  */
 void utility_cpinv(/* Input Arguments */
+                   void* const hWork,
                    const float_complex* A,
                    const int dim1,
                    const int dim2,
                    /* Output Arguments */
                    float_complex* B);
 
+/**
+ * Creates a workspace for utility_dpinv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_dpinv_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim1,
+                          int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_dpinv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_dpinv_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, general matrix pseudo-inverse (the svd way): double precision,
  * i.e.
@@ -928,18 +1846,41 @@ void utility_cpinv(/* Input Arguments */
  *     B = pinv(A)
  * \endcode
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 Number of rows in 'A' / columns in 'B'
- * @param[in]  dim2 Number of columns in 'A' / rows in 'B'
- * @param[out] B    The solution; FLAT: dim2 x dim1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_dpinv_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  Number of rows in 'A' / columns in 'B'
+ * @param[in]  dim2  Number of columns in 'A' / rows in 'B'
+ * @param[out] B     The solution; FLAT: dim2 x dim1
  */
 void utility_dpinv(/* Input Arguments */
+                   void* const hWork,
                    const double* A,
                    const int dim1,
                    const int dim2,
                    /* Output Arguments */
                    double* B);
 
+/**
+ * Creates a workspace for utility_zpinv(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork  (&) address of workspace handle
+ * @param[in] maxDim1 Maximum number of rows in 'A'
+ * @param[in] maxDim2 Maximum number of columns in 'A'
+ */
+void utility_zpinv_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim1,
+                          int maxDim2);
+
+/**
+ * Destroys a workspace created with utility_zpinv_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_zpinv_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, general matrix pseudo-inverse (the svd way): double precision
  * complex, i.e.
@@ -947,12 +1888,14 @@ void utility_dpinv(/* Input Arguments */
  *     B = pinv(A)
  * \endcode
  *
- * @param[in]  A    Input matrix; FLAT: dim1 x dim2
- * @param[in]  dim1 Number of rows in 'A' / columns in 'B'
- * @param[in]  dim2 Number of columns in 'A' / rows in 'B'
- * @param[out] B    The solution; FLAT: dim2 x dim1
+ * @param[in]  hWork Workspace handle (or NULL); see utility_zpinv_create()
+ * @param[in]  A     Input matrix; FLAT: dim1 x dim2
+ * @param[in]  dim1  Number of rows in 'A' / columns in 'B'
+ * @param[in]  dim2  Number of columns in 'A' / rows in 'B'
+ * @param[out] B     The solution; FLAT: dim2 x dim1
  */
 void utility_zpinv(/* Input Arguments */
+                   void* const hWork,
                    const double_complex* A,
                    const int dim1,
                    const int dim2,
@@ -964,6 +1907,25 @@ void utility_zpinv(/* Input Arguments */
 /*                       Cholesky Factorisation (?chol)                       */
 /* ========================================================================== */
 
+/**
+ * Creates a workspace for utility_schol(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum number of rows/colums in 'A'
+ */
+void utility_schol_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim);
+
+/**
+ * Destroys a workspace created with utility_schol_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_schol_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, Cholesky factorisation of a symmetric matrix positive-definate
  * matrix: single precision, i.e.
@@ -971,17 +1933,38 @@ void utility_zpinv(/* Input Arguments */
  *     X = chol(A); where A = X.'*X
  * \endcode
  *
- * @param[in]  A   Input square symmetric positive-definate matrix;
- *                 FLAT: dim x dim
- * @param[in]  dim Number of rows/colums in 'A'
- * @param[out] X   The solution; FLAT: dim x dim
+ * @param[in]  hWork Workspace handle (or NULL); see utility_schol_create()
+ * @param[in]  A     Input square symmetric positive-definate matrix;
+ *                   FLAT: dim x dim
+ * @param[in]  dim   Number of rows/colums in 'A'
+ * @param[out] X     The solution; FLAT: dim x dim
  */
 void utility_schol(/* Input Arguments */
+                   void* const hWork,
                    const float* A,
                    const int dim,
                    /* Output Arguments */
                    float* X);
 
+/**
+ * Creates a workspace for utility_cchol(), for input dimensions up to the
+ * maximums given here
+ *
+ * @param[in] phWork (&) address of workspace handle
+ * @param[in] maxDim Maximum number of rows/colums in 'A'
+ */
+void utility_cchol_create(/* Input Arguments */
+                          void ** const phWork,
+                          int maxDim);
+
+/**
+ * Destroys a workspace created with utility_cchol_create()
+ *
+ * @param[in] phWork (&) address of workspace handle
+ */
+void utility_cchol_destroy(/* Input Arguments */
+                           void ** const phWork);
+
 /**
  * Row-major, Cholesky factorisation of a hermitian matrix positive-definate
  * matrix: single precision complex, i.e.
@@ -989,12 +1972,14 @@ void utility_schol(/* Input Arguments */
  *     X = chol(A); where A = X.'*X
  * \endcode
  *
- * @param[in]  A   Input square symmetric positive-definate matrix;
- *                 FLAT: dim x dim
- * @param[in]  dim Number of rows/colums in 'A'
- * @param[out] X   The solution; FLAT: dim x dim
+ * @param[in]  hWork Workspace handle (or NULL); see utility_cchol_create()
+ * @param[in]  A     Input square symmetric positive-definate matrix;
+ *                   FLAT: dim x dim
+ * @param[in]  dim   Number of rows/colums in 'A'
+ * @param[out] X     The solution; FLAT: dim x dim
  */
 void utility_cchol(/* Input Arguments */
+                   void* const hWork,
                    const float_complex* A,
                    const int dim,
                    /* Output Arguments */
@@ -1020,6 +2005,586 @@ void utility_dinv(double* A,
 void utility_cinv(float_complex * A,
                   const int N );
 
+
+/* ========================================================================== */
+/*              Fixed-Size Small Matrix Kernels (?mNmul, ?mNinv...)           */
+/* ========================================================================== */
+
+/*
+ * The following are for the 2x2, 3x3 and 4x4 matrices which arise frequently
+ * in spatial audio (loudspeaker triplets, rotation matrices, 2-channel
+ * covariance matrices...), where the overhead of calling BLAS/LAPACK far
+ * exceeds the arithmetic. They are written out for each size (no dispatch, no
+ * memory allocation) and are therefore also safe to call from the audio thread.
+ * All matrices are row-major. The inverse and linear solvers employ Gaussian
+ * elimination with partial pivoting; if 'A' is (numerically) singular, the
+ * output is set to zeros.
+ */
+
+/**
+ * Row-major, 2x2 matrix multiplication: single precision, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 2 x 2
+ * @param[in]  B Input matrix; FLAT: 2 x 2
+ * @param[out] C Output matrix; FLAT: 2 x 2
+ */
+void utility_sm2mul(/* Input Arguments */
+                    const float* A,
+                    const float* B,
+                    /* Output Arguments */
+                    float* C);
+
+/**
+ * Row-major, 3x3 matrix multiplication: single precision, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 3 x 3
+ * @param[in]  B Input matrix; FLAT: 3 x 3
+ * @param[out] C Output matrix; FLAT: 3 x 3
+ */
+void utility_sm3mul(/* Input Arguments */
+                    const float* A,
+                    const float* B,
+                    /* Output Arguments */
+                    float* C);
+
+/**
+ * Row-major, 4x4 matrix multiplication: single precision, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 4 x 4
+ * @param[in]  B Input matrix; FLAT: 4 x 4
+ * @param[out] C Output matrix; FLAT: 4 x 4
+ */
+void utility_sm4mul(/* Input Arguments */
+                    const float* A,
+                    const float* B,
+                    /* Output Arguments */
+                    float* C);
+
+/**
+ * Row-major, 2x2 matrix multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 2 x 2
+ * @param[in]  B Input matrix; FLAT: 2 x 2
+ * @param[out] C Output matrix; FLAT: 2 x 2
+ */
+void utility_cm2mul(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* B,
+                    /* Output Arguments */
+                    float_complex* C);
+
+/**
+ * Row-major, 3x3 matrix multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 3 x 3
+ * @param[in]  B Input matrix; FLAT: 3 x 3
+ * @param[out] C Output matrix; FLAT: 3 x 3
+ */
+void utility_cm3mul(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* B,
+                    /* Output Arguments */
+                    float_complex* C);
+
+/**
+ * Row-major, 4x4 matrix multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     C = A*B;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 4 x 4
+ * @param[in]  B Input matrix; FLAT: 4 x 4
+ * @param[out] C Output matrix; FLAT: 4 x 4
+ */
+void utility_cm4mul(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* B,
+                    /* Output Arguments */
+                    float_complex* C);
+
+/**
+ * Row-major, 2x2 matrix-vector multiplication: single precision, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 2 x 2
+ * @param[in]  x Input vector; 2 x 1
+ * @param[out] y Output vector; 2 x 1
+ */
+void utility_sm2vmul(/* Input Arguments */
+                     const float* A,
+                     const float* x,
+                     /* Output Arguments */
+                     float* y);
+
+/**
+ * Row-major, 3x3 matrix-vector multiplication: single precision, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 3 x 3
+ * @param[in]  x Input vector; 3 x 1
+ * @param[out] y Output vector; 3 x 1
+ */
+void utility_sm3vmul(/* Input Arguments */
+                     const float* A,
+                     const float* x,
+                     /* Output Arguments */
+                     float* y);
+
+/**
+ * Row-major, 4x4 matrix-vector multiplication: single precision, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 4 x 4
+ * @param[in]  x Input vector; 4 x 1
+ * @param[out] y Output vector; 4 x 1
+ */
+void utility_sm4vmul(/* Input Arguments */
+                     const float* A,
+                     const float* x,
+                     /* Output Arguments */
+                     float* y);
+
+/**
+ * Row-major, 2x2 matrix-vector multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 2 x 2
+ * @param[in]  x Input vector; 2 x 1
+ * @param[out] y Output vector; 2 x 1
+ */
+void utility_cm2vmul(/* Input Arguments */
+                     const float_complex* A,
+                     const float_complex* x,
+                     /* Output Arguments */
+                     float_complex* y);
+
+/**
+ * Row-major, 3x3 matrix-vector multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 3 x 3
+ * @param[in]  x Input vector; 3 x 1
+ * @param[out] y Output vector; 3 x 1
+ */
+void utility_cm3vmul(/* Input Arguments */
+                     const float_complex* A,
+                     const float_complex* x,
+                     /* Output Arguments */
+                     float_complex* y);
+
+/**
+ * Row-major, 4x4 matrix-vector multiplication: single precision complex, i.e.
+ * \code{.m}
+ *     y = A*x;
+ * \endcode
+ *
+ * @param[in]  A Input matrix; FLAT: 4 x 4
+ * @param[in]  x Input vector; 4 x 1
+ * @param[out] y Output vector; 4 x 1
+ */
+void utility_cm4vmul(/* Input Arguments */
+                     const float_complex* A,
+                     const float_complex* x,
+                     /* Output Arguments */
+                     float_complex* y);
+
+/**
+ * Row-major, 2x2 matrix inversion: single precision, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 2 x 2
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 2 x 2
+ */
+void utility_sm2inv(/* Input Arguments */
+                    const float* A,
+                    /* Output Arguments */
+                    float* X);
+
+/**
+ * Row-major, 3x3 matrix inversion: single precision, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 3 x 3
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 3 x 3
+ */
+void utility_sm3inv(/* Input Arguments */
+                    const float* A,
+                    /* Output Arguments */
+                    float* X);
+
+/**
+ * Row-major, 4x4 matrix inversion: single precision, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 4 x 4
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 4 x 4
+ */
+void utility_sm4inv(/* Input Arguments */
+                    const float* A,
+                    /* Output Arguments */
+                    float* X);
+
+/**
+ * Row-major, 2x2 matrix inversion: single precision complex, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 2 x 2
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 2 x 2
+ */
+void utility_cm2inv(/* Input Arguments */
+                    const float_complex* A,
+                    /* Output Arguments */
+                    float_complex* X);
+
+/**
+ * Row-major, 3x3 matrix inversion: single precision complex, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 3 x 3
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 3 x 3
+ */
+void utility_cm3inv(/* Input Arguments */
+                    const float_complex* A,
+                    /* Output Arguments */
+                    float_complex* X);
+
+/**
+ * Row-major, 4x4 matrix inversion: single precision complex, i.e.
+ * \code{.m}
+ *     X = inv(A);
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 4 x 4
+ * @param[out] X The inverse of 'A' (zeros if 'A' is singular); FLAT: 4 x 4
+ */
+void utility_cm4inv(/* Input Arguments */
+                    const float_complex* A,
+                    /* Output Arguments */
+                    float_complex* X);
+
+/**
+ * Row-major, 2x2 linear solver: single precision, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 2 x 2
+ * @param[in]  b Right hand side vector; 2 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 2 x 1
+ */
+void utility_sm2slv(/* Input Arguments */
+                    const float* A,
+                    const float* b,
+                    /* Output Arguments */
+                    float* x);
+
+/**
+ * Row-major, 3x3 linear solver: single precision, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 3 x 3
+ * @param[in]  b Right hand side vector; 3 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 3 x 1
+ */
+void utility_sm3slv(/* Input Arguments */
+                    const float* A,
+                    const float* b,
+                    /* Output Arguments */
+                    float* x);
+
+/**
+ * Row-major, 4x4 linear solver: single precision, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 4 x 4
+ * @param[in]  b Right hand side vector; 4 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 4 x 1
+ */
+void utility_sm4slv(/* Input Arguments */
+                    const float* A,
+                    const float* b,
+                    /* Output Arguments */
+                    float* x);
+
+/**
+ * Row-major, 2x2 linear solver: single precision complex, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 2 x 2
+ * @param[in]  b Right hand side vector; 2 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 2 x 1
+ */
+void utility_cm2slv(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* b,
+                    /* Output Arguments */
+                    float_complex* x);
+
+/**
+ * Row-major, 3x3 linear solver: single precision complex, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 3 x 3
+ * @param[in]  b Right hand side vector; 3 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 3 x 1
+ */
+void utility_cm3slv(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* b,
+                    /* Output Arguments */
+                    float_complex* x);
+
+/**
+ * Row-major, 4x4 linear solver: single precision complex, i.e.
+ * \code{.m}
+ *     x = A\b;
+ * \endcode
+ *
+ * @param[in]  A Input square matrix; FLAT: 4 x 4
+ * @param[in]  b Right hand side vector; 4 x 1
+ * @param[out] x The solution (zeros if 'A' is singular); 4 x 1
+ */
+void utility_cm4slv(/* Input Arguments */
+                    const float_complex* A,
+                    const float_complex* b,
+                    /* Output Arguments */
+                    float_complex* x);
+
+/* ========================================================================== */
+/*                  Packed Hermitian Matrices (?hpherk, ?hpaxpy)              */
+/* ========================================================================== */
+
+/*
+ * Hermitian matrices (e.g. spatial covariance matrices) may be stored in packed
+ * format, where only the upper triangle is kept: element (i,j), for i<=j, is
+ * found at Cp[j*(j+1)/2 + i] (i.e. the LAPACK 'U' packed format), and the whole
+ * matrix requires dim*(dim+1)/2 elements. Note that the leading KxK block then
+ * occupies the first K*(K+1)/2 elements for any K<=dim; therefore, a store
+ * sized for the maximum dimensions also serves any lower ones (e.g. lower
+ * spherical harmonic orders) without re-packing.
+ */
+
+/**
+ * Rank-k update of a Hermitian matrix in packed format: single precision
+ * complex, i.e.
+ * \code{.m}
+ *     C = beta*C + alpha*X*X'; (upper triangle only)
+ * \endcode
+ *
+ * @note This requires roughly half of the operations (and memory traffic) of
+ *       the equivalent full cblas_cgemm() call. If 'beta' is 0, then 'Cp' need
+ *       not be initialised.
+ *
+ * @param[in]     X     Input matrix (row-major); FLAT: dim x len
+ * @param[in]     dim   Number of rows in 'X', and dimensions of 'C'
+ * @param[in]     len   Number of columns in 'X' (e.g. time slots)
+ * @param[in]     alpha Scaling applied to X*X'
+ * @param[in]     beta  Scaling applied to the current 'C'
+ * @param[in,out] Cp    Hermitian matrix in packed format; dim*(dim+1)/2 x 1
+ */
+void utility_chpherk(/* Input Arguments */
+                     const float_complex* X,
+                     const int dim,
+                     const int len,
+                     const float alpha,
+                     const float beta,
+                     /* Input/Output Arguments */
+                     float_complex* Cp);
+
+/**
+ * Adds a (scaled) Hermitian matrix in packed format to a full row-major
+ * matrix, i.e.
+ * \code{.m}
+ *     C(1:dim,1:dim) = C(1:dim,1:dim) + alpha*unpack(Cp);
+ * \endcode
+ *
+ * @param[in]     Cp    Hermitian matrix in packed format; dim*(dim+1)/2 x 1
+ * @param[in]     dim   Dimensions of the matrix in 'Cp' (may be less than the
+ *                      dimensions it was packed with; see above)
+ * @param[in]     alpha Scaling applied to 'Cp'
+ * @param[in]     ldC   Leading dimension of 'C' (ldC >= dim)
+ * @param[in,out] C     Full matrix (row-major); FLAT: ? x ldC
+ */
+void utility_chpaxpy(/* Input Arguments */
+                     const float_complex* Cp,
+                     const int dim,
+                     const float alpha,
+                     const int ldC,
+                     /* Input/Output Arguments */
+                     float_complex* C);
+
+
+/* ========================================================================== */
+/*                  Batched Matrix Multiplication (?gemm_batch)               */
+/* ========================================================================== */
+
+/**
+ * Multiplies a batch of matrices of the same dimensions, which are stored at
+ * fixed strides (e.g. one per frequency band): single precision complex, i.e.
+ * \code{.m}
+ *     for b=1:nBatch
+ *         C(:,:,b) = alpha*A(:,:,b)*B(:,:,b) + beta*C(:,:,b);
+ *     end
+ * \endcode
+ *
+ * @note With Intel MKL (2020 Update 2 or newer) this is a single call to
+ *       cblas_cgemm_batch_strided(), such that the library may schedule all of
+ *       the (small) multiplications together; otherwise cblas_cgemm() is
+ *       called for each matrix.
+ *
+ * @param[in]     A       First matrices (row-major); FLAT: nBatch x strideA
+ * @param[in]     lda     Leading dimension of each matrix in 'A'
+ * @param[in]     strideA Distance between first elements of the matrices of
+ *                        'A' (>= M*lda)
+ * @param[in]     B       Second matrices (row-major); FLAT: nBatch x strideB
+ * @param[in]     ldb     Leading dimension of each matrix in 'B'
+ * @param[in]     strideB Distance between the matrices of 'B' (>= K*ldb)
+ * @param[in]     M       Number of rows of each matrix in 'A' and 'C'
+ * @param[in]     N       Number of columns of each matrix in 'B' and 'C'
+ * @param[in]     K       Number of columns/rows of each matrix in 'A'/'B'
+ * @param[in]     alpha   Scaling applied to A*B
+ * @param[in]     beta    Scaling applied to the current 'C' ('C' need not be
+ *                        initialised if 'beta' is 0)
+ * @param[in]     ldc     Leading dimension of each matrix in 'C'
+ * @param[in]     strideC Distance between the matrices of 'C' (>= M*ldc)
+ * @param[in]     nBatch  Number of matrices
+ * @param[in,out] C       Output matrices (row-major); FLAT: nBatch x strideC
+ */
+void utility_cgemm_batch(/* Input Arguments */
+                         const float_complex* A,
+                         const int lda,
+                         const int strideA,
+                         const float_complex* B,
+                         const int ldb,
+                         const int strideB,
+                         const int M,
+                         const int N,
+                         const int K,
+                         const float_complex alpha,
+                         const float_complex beta,
+                         const int ldc,
+                         const int strideC,
+                         const int nBatch,
+                         /* Input/Output Arguments */
+                         float_complex* C);
+
+
+/* ========================================================================== */
+/*                     BLAS/LAPACK Backend Threading                          */
+/* ========================================================================== */
+
+/*
+ * Performance libraries may run their routines (e.g. cblas_cgemm() or the
+ * LAPACK routines behind utility_cseig()) over several internal threads.
+ * While this speeds up the large problems encountered during initialisation,
+ * many instances doing so from their audio callbacks oversubscribe the cores,
+ * and cause jitter. Therefore, the processing functions of the SAF examples
+ * wrap their body with saf_blasThreads_beginProcessing() and
+ * saf_blasThreads_end(), which limit the backend to
+ * saf_blasThreads_getProcessingNumThreads() threads (default: 1) on the calling
+ * thread, for the duration of the call; while initialisation and offline
+ * rendering continue to use the backend's default. The workers of saf_parfor
+ * are limited to one thread each, as they already share out the work.
+ *
+ * The limit is thread-local with Intel MKL (mkl_set_num_threads_local()). The
+ * thread count of OpenBLAS (openblas_set_num_threads()) is process-wide, and is
+ * therefore not changed by the scoped functions; instead, it may be set once by
+ * the host with saf_blasThreads_setGlobalNumThreads(). Apple Accelerate and
+ * ATLAS manage their threads internally, and all functions do nothing.
+ */
+
+/**
+ * Sets the number of backend threads used within the processing functions of
+ * the SAF examples (default: 1; 0: the backend's default); for all instances
+ */
+void saf_blasThreads_setProcessingNumThreads(/* Input Arguments */
+                                             int nThreads);
+
+/** Returns the number of backend threads used within the processing functions */
+int saf_blasThreads_getProcessingNumThreads(void);
+
+/**
+ * Limits the backend to nThreads threads on the calling thread, until the
+ * paired call to saf_blasThreads_end()
+ *
+ * @param[in] nThreads Number of threads (0: the backend's default)
+ * @returns   The previous setting, to be passed to saf_blasThreads_end()
+ */
+int saf_blasThreads_begin(/* Input Arguments */
+                          int nThreads);
+
+/**
+ * saf_blasThreads_begin(saf_blasThreads_getProcessingNumThreads()); i.e. for
+ * the body of an audio callback
+ */
+int saf_blasThreads_beginProcessing(void);
+
+/**
+ * Restores the backend threading of the calling thread, as it was before the
+ * paired call to saf_blasThreads_begin()
+ *
+ * @param[in] prevState Value returned by saf_blasThreads_begin()
+ */
+void saf_blasThreads_end(/* Input Arguments */
+                         int prevState);
+
+/**
+ * Sets the process-wide number of backend threads (MKL and OpenBLAS)
+ *
+ * @param[in] nThreads Number of threads (>=1)
+ */
+void saf_blasThreads_setGlobalNumThreads(/* Input Arguments */
+                                         int nThreads);
+
+/**
+ * Returns 1 if saf_blasThreads_begin() limits the backend (i.e. thread-local
+ * control is supported by the backend), 0 otherwise
+ */
+int saf_blasThreads_isScoped(void);
+
     
 #ifdef __cplusplus
 }/* extern "C" */
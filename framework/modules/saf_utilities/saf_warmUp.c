@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_warmUp.c
+ * @brief Warm-up of a processor, before its first audio callback
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_warmUp.h"
+
+/** Stride with which saf_warmUp_touch() touches a buffer (a cache line) */
+#define WARMUP_TOUCH_STRIDE ( 64 )
+
+double saf_warmUp_run
+(
+    void* const hInst,
+    saf_warmUp_processFunc processFunc,
+    int nInputs,
+    int nOutputs,
+    int blockSize,
+    int nSamples
+)
+{
+    float** inputs, **outputs;
+    int b, nBlocks;
+    double t0, tFirst, tLast;
+
+    if(hInst==NULL || processFunc==NULL || blockSize<1)
+        return 1.0;
+    nInputs = MAX(nInputs, 0);
+    nOutputs = MAX(nOutputs, 0);
+    nBlocks = MAX((nSamples + blockSize - 1)/blockSize, 1);
+
+    /* (the inputs are silent, and the outputs are discarded) */
+    inputs = (float**)calloc2d(MAX(nInputs,1), blockSize, sizeof(float));
+    outputs = (float**)calloc2d(MAX(nOutputs,1), blockSize, sizeof(float));
+    tFirst = tLast = 0.0;
+    for(b=0; b<nBlocks; b++){
+        t0 = saf_benchmark_getTime();
+        processFunc(hInst, inputs, outputs, nInputs, nOutputs, blockSize);
+        tLast = saf_benchmark_getTime() - t0;
+        if(b==0)
+            tFirst = tLast;
+    }
+    free(inputs);
+    free(outputs);
+    return tLast > 0.0 ? tFirst/tLast : 1.0;
+}
+
+void saf_warmUp_touch
+(
+    void* ptr,
+    size_t nBytes,
+    int writeFLAG
+)
+{
+    volatile unsigned char* p = (volatile unsigned char*)ptr;
+    unsigned char sum;
+    size_t i;
+
+    if(ptr==NULL || nBytes==0)
+        return;
+    sum = 0;
+    for(i=0; i<nBytes; i+=WARMUP_TOUCH_STRIDE){
+        if(writeFLAG)
+            p[i] = p[i];
+        else
+            sum += p[i];
+    }
+    if(writeFLAG)
+        p[nBytes-1] = p[nBytes-1];
+    else
+        sum += p[nBytes-1];
+    (void)sum;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * @file saf_warmUp.h
+ * @brief Warm-up of a processor, before its first audio callback
+ *
+ * The first call to a processing function after initialisation would
+ * otherwise be the first to touch the newly allocated buffers and tables
+ * (i.e. page faults, and cold caches), and to run the FFT and BLAS/LAPACK
+ * routines (some of which initialise themselves lazily, e.g. Intel MKL's DFTI
+ * descriptors); all of which adds to the cost of the first few frames.
+ * Therefore, the SAF examples offer a *_prepareToPlay() function, which runs
+ * the processing function over a few blocks of silence with
+ * saf_warmUp_run(), from the calling (non-real-time) thread; and which may
+ * also pre-fault e.g. their large tables with saf_warmUp_touch().
+ *
+ * Processing silence leaves the signal state of a processor as it was after
+ * initialisation (any pending parameter updates or re-initialisations are
+ * applied during the warm-up instead of in the first callback).
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_WARMUP_H_INCLUDED
+#define SAF_WARMUP_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+/** Number of samples of silence processed by the *_prepareToPlay() functions */
+#define SAF_WARMUP_NUM_SAMPLES ( 8192 )
+
+/**
+ * Processing function of an instance; i.e. the signature of the *_process()
+ * functions of the SAF examples
+ */
+typedef void (*saf_warmUp_processFunc)(void* const hInst,
+                                       float** const inputs,
+                                       float** const outputs,
+                                       int nInputs,
+                                       int nOutputs,
+                                       int nSamples);
+
+/**
+ * Runs a processing function over blocks of silence
+ *
+ * @warning Must not be called while the instance is being processed by
+ *          another thread
+ *
+ * @param[in] hInst       Handle of the instance
+ * @param[in] processFunc Processing function of the instance
+ * @param[in] nInputs     Number of input channels (as passed by the host)
+ * @param[in] nOutputs    Number of output channels (as passed by the host)
+ * @param[in] blockSize   Number of samples per block (as passed by the host)
+ * @param[in] nSamples    Total number of samples to process (rounded up to a
+ *                        multiple of blockSize); e.g. SAF_WARMUP_NUM_SAMPLES
+ * @returns   Time taken by the first block, divided by that of the last block
+ *            (i.e. > 1 if the first block incurred a start-up cost)
+ */
+double saf_warmUp_run(/* Input Arguments */
+                      void* const hInst,
+                      saf_warmUp_processFunc processFunc,
+                      int nInputs,
+                      int nOutputs,
+                      int blockSize,
+                      int nSamples);
+
+/**
+ * Touches every page (and every cache line) of a buffer, such that it is
+ * mapped in, and brought into the caches (as far as it fits)
+ *
+ * @warning With writeFLAG enabled, the buffer must not be written to by other
+ *          threads at the same time
+ *
+ * @param[in] ptr       Buffer (may be NULL)
+ * @param[in] nBytes    Size of the buffer, in bytes
+ * @param[in] writeFLAG '1' the buffer is written to (its values are left
+ *                      unchanged), such that the pages are also allocated if
+ *                      they have not been written to yet; '0' read only
+ */
+void saf_warmUp_touch(/* Input Arguments */
+                      void* ptr,
+                      size_t nBytes,
+                      int writeFLAG);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_WARMUP_H_INCLUDED */
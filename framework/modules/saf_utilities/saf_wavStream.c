@@ -0,0 +1,570 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * @file saf_wavStream.c
+ * @brief Streaming reading and writing of (long) multi-channel WAV files,
+ *        frame by frame, for offline analysis and rendering
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#include "saf_utilities.h"
+#include "saf_wavStream.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+/** Number of frames held by the internal buffer of the writer */
+#define WAV_WRITER_BUFFER_FRAMES ( 4096 )
+/** Size of the JUNK chunk reserved by the writer (i.e. of a ds64 chunk) */
+#define WAV_WRITER_JUNK_SIZE ( 28 )
+/** Maximum number of channels converted by SAF_WAV_CHANNELS_FUMA2ACN */
+#define WAV_FUMA_MAX_NUM_CH ( 16 )
+
+/** FuMa channel of each ACN channel (up to third order) */
+static const int wav_acn2fuma[WAV_FUMA_MAX_NUM_CH] = { 0, 2, 3, 1, 8, 6, 4, 5, 7, 15, 13, 11, 9, 10, 12, 14 };
+
+/** Data structure for the reader */
+typedef struct _safWavReader_data {
+#if defined(_WIN32)
+    HANDLE hFile, hMap;
+#endif
+    const unsigned char* base;  /**< mapped file */
+    size_t nBytes;              /**< size of the mapped file, in bytes */
+    const unsigned char* data;  /**< start of the sample data */
+    int nChannels;
+    long long nFrames;
+    int sampleRate;
+    int bytesPerSample;         /**< 2, 3 or 4 (integer PCM), or 4 or 8 (floating point) */
+    int isFloat;                /**< 1: IEEE floating point, 0: integer PCM */
+    int frameLen;               /**< bytes per frame */
+    long long pos;              /**< next frame to read */
+    int convert;                /**< 1: the channels are converted (chMap/chGain) */
+    int chMap[WAV_FUMA_MAX_NUM_CH];    /**< channel of the file read for each output channel */
+    float chGain[WAV_FUMA_MAX_NUM_CH]; /**< gain applied to each output channel */
+
+}safWavReader_data;
+
+/** Data structure for the writer */
+typedef struct _safWavWriter_data {
+    FILE* file;
+    int nChannels;
+    int bytesPerSample;
+    int isFloat;
+    int frameLen;               /**< bytes per frame */
+    long long nFrames;          /**< frames written so far (including those in 'buf') */
+    long long dataPos;          /**< position of the "data" chunk header in the file */
+    long long ds64Pos;          /**< position of the JUNK (later ds64) chunk header in the file */
+    unsigned char* buf;         /**< interleaved frames; WAV_WRITER_BUFFER_FRAMES x frameLen */
+    int nBuf;                   /**< frames in 'buf' */
+    int failed;                 /**< 1 if a write failed */
+
+}safWavWriter_data;
+
+/** Little-endian unsigned integer of 'nBytes' bytes (up to 4) */
+static unsigned int wav_uint(const unsigned char* b, int nBytes)
+{
+    unsigned int val;
+    int i;
+
+    for(i=nBytes-1, val=0; i>=0; i--)
+        val = (val<<8) | b[i];
+    return val;
+}
+
+/** Little-endian unsigned 64-bit integer */
+static unsigned long long wav_uint64(const unsigned char* b)
+{
+    return ((unsigned long long)wav_uint(&b[4], 4) << 32) | (unsigned long long)wav_uint(b, 4);
+}
+
+/** Writes a little-endian unsigned integer of 'nBytes' bytes (up to 8) */
+static void wav_putUint(unsigned char* b, unsigned long long val, int nBytes)
+{
+    int i;
+
+    for(i=0; i<nBytes; i++, val>>=8)
+        b[i] = (unsigned char)(val & 0xFF);
+}
+
+/** Unmaps the file of a reader */
+static void wavReader_unmap(safWavReader_data* h)
+{
+#if defined(_WIN32)
+    if(h->base!=NULL)
+        UnmapViewOfFile((LPCVOID)h->base);
+    if(h->hMap!=NULL)
+        CloseHandle(h->hMap);
+    if(h->hFile!=INVALID_HANDLE_VALUE)
+        CloseHandle(h->hFile);
+    h->hMap = NULL;
+    h->hFile = INVALID_HANDLE_VALUE;
+#else
+    if(h->base!=NULL)
+        munmap((void*)h->base, h->nBytes);
+#endif
+    h->base = NULL;
+}
+
+/** Maps the whole file, read-only; returns 1 if successful */
+static int wavReader_map(safWavReader_data* h, const char* path)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER size;
+
+    h->hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(h->hFile==INVALID_HANDLE_VALUE || !GetFileSizeEx(h->hFile, &size) || size.QuadPart<12)
+        return 0;
+    h->nBytes = (size_t)size.QuadPart;
+    h->hMap = CreateFileMappingA(h->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(h->hMap!=NULL)
+        h->base = (const unsigned char*)MapViewOfFile(h->hMap, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd;
+    struct stat st;
+
+    fd = open(path, O_RDONLY);
+    if(fd<0)
+        return 0;
+    if(fstat(fd, &st)==0 && st.st_size>=12){
+        h->nBytes = (size_t)st.st_size;
+        h->base = (const unsigned char*)mmap(NULL, h->nBytes, PROT_READ, MAP_SHARED, fd, 0);
+        if(h->base==(const unsigned char*)MAP_FAILED)
+            h->base = NULL;
+# ifdef MADV_SEQUENTIAL
+        if(h->base!=NULL)
+            madvise((void*)h->base, h->nBytes, MADV_SEQUENTIAL);
+# endif
+    }
+    close(fd);
+#endif
+    return h->base!=NULL ? 1 : 0;
+}
+
+/** Finds the format and data chunks of a mapped file; returns 1 if valid */
+static int wavReader_parse(safWavReader_data* h)
+{
+    const unsigned char* b;
+    unsigned long long chunkSize, ds64DataSize, offset, dataSize;
+    int format, blockAlign, isRF64, foundFmt;
+
+    b = h->base;
+    isRF64 = memcmp(b, "RF64", 4)==0 || memcmp(b, "BW64", 4)==0;
+    if((memcmp(b, "RIFF", 4)!=0 && !isRF64) || memcmp(&b[8], "WAVE", 4)!=0)
+        return 0;
+
+    /* (skipping any other chunks) */
+    foundFmt = 0;
+    ds64DataSize = 0;
+    for(offset=12; offset+8<=(unsigned long long)h->nBytes; offset += 8 + chunkSize + (chunkSize&1)){
+        b = &(h->base[offset]);
+        chunkSize = (unsigned long long)wav_uint(&b[4], 4);
+        if(memcmp(b, "ds64", 4)==0 && isRF64 && chunkSize>=24 && offset+8+24<=(unsigned long long)h->nBytes)
+            ds64DataSize = wav_uint64(&b[16]);
+        else if(memcmp(b, "fmt ", 4)==0 && chunkSize>=16 && offset+8+chunkSize<=(unsigned long long)h->nBytes){
+            b += 8;
+            format = (int)wav_uint(b, 2);
+            if(format==0xFFFE && chunkSize>=26) /* WAVE_FORMAT_EXTENSIBLE: the format is given by the subformat GUID */
+                format = (int)wav_uint(&b[24], 2);
+            h->nChannels = (int)wav_uint(&b[2], 2);
+            h->sampleRate = (int)wav_uint(&b[4], 4);
+            h->bytesPerSample = (int)wav_uint(&b[14], 2)/8;
+            h->isFloat = format==3 ? 1 : 0;
+            blockAlign = (int)wav_uint(&b[12], 2);
+            if(!((format==1 && h->bytesPerSample>=2 && h->bytesPerSample<=4) ||
+                 (format==3 && (h->bytesPerSample==4 || h->bytesPerSample==8))) ||
+               h->nChannels<1 || blockAlign!=(h->nChannels)*(h->bytesPerSample))
+                return 0;
+            h->frameLen = blockAlign;
+            foundFmt = 1;
+        }
+        else if(memcmp(b, "data", 4)==0 && foundFmt){
+            dataSize = isRF64 && chunkSize==0xFFFFFFFF ? ds64DataSize : chunkSize;
+            dataSize = MIN(dataSize, (unsigned long long)h->nBytes - (offset+8)); /* (truncated files) */
+            h->data = &(h->base[offset+8]);
+            h->nFrames = (long long)(dataSize/(unsigned long long)h->frameLen);
+            return 1;
+        }
+        if(isRF64 && chunkSize==0xFFFFFFFF)
+            return 0; /* (only the data chunk may take its size from the ds64 chunk) */
+    }
+    return 0;
+}
+
+int saf_wavReader_open
+(
+    void ** const phWav,
+    const char* path,
+    SAF_WAV_CHANNEL_CONVERSIONS conversion
+)
+{
+    safWavReader_data* h;
+    int ch, n;
+
+    *phWav = NULL;
+    h = (safWavReader_data*)malloc1d(sizeof(safWavReader_data));
+    memset(h, 0, sizeof(safWavReader_data));
+#if defined(_WIN32)
+    h->hFile = INVALID_HANDLE_VALUE;
+#endif
+    if(!wavReader_map(h, path) || !wavReader_parse(h) ||
+       (conversion==SAF_WAV_CHANNELS_FUMA2ACN && h->nChannels!=4 && h->nChannels!=9 && h->nChannels!=16)){
+        wavReader_unmap(h);
+        free(h);
+        return 0;
+    }
+
+    /* FuMa (maxN) to ACN/SN3D */
+    h->convert = conversion==SAF_WAV_CHANNELS_FUMA2ACN ? 1 : 0;
+    if(h->convert){
+        for(ch=0; ch<h->nChannels; ch++){
+            h->chMap[ch] = wav_acn2fuma[ch];
+            h->chGain[ch] = 1.0f;
+        }
+        h->chGain[0] = sqrtf(2.0f);
+        for(ch=4; ch<MIN(h->nChannels, 9); ch++)
+            h->chGain[ch] = ch==6 ? 1.0f : 2.0f/sqrtf(3.0f);
+        for(ch=9; ch<h->nChannels; ch++){
+            n = ch<12 ? 12-ch : ch-12; /* |m| */
+            h->chGain[ch] = n==0 ? 1.0f : n==1 ? sqrtf(45.0f/32.0f) : n==2 ? 3.0f/sqrtf(5.0f) : sqrtf(8.0f/5.0f);
+        }
+    }
+    *phWav = (void*)h;
+    return 1;
+}
+
+void saf_wavReader_close
+(
+    void ** const phWav
+)
+{
+    safWavReader_data* h = (safWavReader_data*)(*phWav);
+
+    if(h!=NULL){
+        wavReader_unmap(h);
+        free(h);
+        *phWav = NULL;
+    }
+}
+
+int saf_wavReader_getNumChannels(void * const hWav)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    return h->nChannels;
+}
+
+long long saf_wavReader_getNumFrames(void * const hWav)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    return h->nFrames;
+}
+
+int saf_wavReader_getSampleRate(void * const hWav)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    return h->sampleRate;
+}
+
+long long saf_wavReader_getPosition(void * const hWav)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    return h->pos;
+}
+
+void saf_wavReader_seek
+(
+    void * const hWav,
+    long long position
+)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    h->pos = position<0 ? 0 : MIN(position, h->nFrames);
+}
+
+int saf_wavReader_read
+(
+    void * const hWav,
+    float ** const data,
+    int nChannels,
+    int nFrames
+)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    int i, ch, nRead, nCh, bps, off;
+    unsigned int u;
+    unsigned long long u64;
+    float f, g;
+    double d;
+    const unsigned char *frame, *b;
+    float* out;
+
+    nRead = (int)MIN((long long)MAX(nFrames, 0), h->nFrames - h->pos);
+    nCh = MIN(nChannels, h->nChannels);
+    bps = h->bytesPerSample;
+
+    /* converted directly from the mapped sample data; one channel at a time,
+     * so that each format is handled by its own loop */
+    frame = &(h->data[(size_t)(h->pos)*(size_t)(h->frameLen)]);
+    for(ch=0; ch<nCh; ch++){
+        off = (h->convert ? h->chMap[ch] : ch)*bps;
+        g = h->convert ? h->chGain[ch] : 1.0f;
+        out = data[ch];
+        b = frame + off;
+        if(h->isFloat && bps==4){
+            for(i=0; i<nRead; i++, b+=h->frameLen){
+                u = wav_uint(b, 4);
+                memcpy(&f, &u, sizeof(float));
+                out[i] = g*f;
+            }
+        }
+        else if(h->isFloat){
+            for(i=0; i<nRead; i++, b+=h->frameLen){
+                u64 = wav_uint64(b);
+                memcpy(&d, &u64, sizeof(double));
+                out[i] = g*(float)d;
+            }
+        }
+        else{
+            g /= 2147483648.0f;
+            for(i=0; i<nRead; i++, b+=h->frameLen){
+                u = wav_uint(b, bps) << (8*(4-bps)); /* left-justified, so that it may be read as signed */
+                out[i] = g*(float)((int)u);
+            }
+        }
+        if(nRead<nFrames)
+            memset(&out[nRead], 0, (nFrames-nRead)*sizeof(float));
+    }
+    for(ch=nCh; ch<nChannels; ch++)
+        memset(data[ch], 0, MAX(nFrames, 0)*sizeof(float));
+    h->pos += nRead;
+    return nRead;
+}
+
+const float* saf_wavReader_getInterleavedView
+(
+    void * const hWav,
+    long long position,
+    long long* nFrames
+)
+{
+    safWavReader_data* h = (safWavReader_data*)(hWav);
+    const unsigned int one = 1;
+
+    /* (the samples must also be aligned, and in the byte order of the host) */
+    (*nFrames) = 0;
+    if(!h->isFloat || h->bytesPerSample!=4 || h->convert || ((size_t)h->data)%sizeof(float)!=0 ||
+       *(const unsigned char*)&one!=1)
+        return NULL;
+    position = position<0 ? 0 : MIN(position, h->nFrames);
+    (*nFrames) = h->nFrames - position;
+    return (const float*)&(h->data[(size_t)position*(size_t)(h->frameLen)]);
+}
+
+/** Writes the frames held by the internal buffer of a writer to the file */
+static void wavWriter_flushBuffer(safWavWriter_data* h)
+{
+    if(h->nBuf>0 && fwrite(h->buf, (size_t)h->frameLen, (size_t)h->nBuf, h->file)!=(size_t)h->nBuf)
+        h->failed = 1;
+    h->nBuf = 0;
+}
+
+int saf_wavWriter_open
+(
+    void ** const phWav,
+    const char* path,
+    int nChannels,
+    int sampleRate,
+    SAF_WAV_FORMATS format
+)
+{
+    safWavWriter_data* h;
+    unsigned char hdr[12+8+WAV_WRITER_JUNK_SIZE+8+40+8];
+    int fmtSize, extensible, len;
+    static const unsigned char subformatGUID[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
+    *phWav = NULL;
+    if(nChannels<1 || nChannels>65535 || sampleRate<1)
+        return 0;
+    h = (safWavWriter_data*)malloc1d(sizeof(safWavWriter_data));
+    h->file = fopen(path, "wb");
+    if(h->file==NULL){
+        free(h);
+        return 0;
+    }
+    h->nChannels = nChannels;
+    h->bytesPerSample = format==SAF_WAV_PCM16 ? 2 : format==SAF_WAV_PCM24 ? 3 : 4;
+    h->isFloat = format==SAF_WAV_FLOAT32 ? 1 : 0;
+    h->frameLen = nChannels*(h->bytesPerSample);
+    h->nFrames = 0;
+    h->buf = (unsigned char*)malloc1d(WAV_WRITER_BUFFER_FRAMES*(size_t)(h->frameLen));
+    h->nBuf = 0;
+    h->failed = 0;
+
+    /* RIFF header, a JUNK chunk (which is replaced by a ds64 chunk if the file
+     * is promoted to RF64), the format chunk (WAVE_FORMAT_EXTENSIBLE for more
+     * than 2 channels, or more than 16 bits), and the data chunk header. The
+     * sizes are completed by saf_wavWriter_close() */
+    extensible = nChannels>2 || h->bytesPerSample>2;
+    fmtSize = extensible ? 40 : 16;
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "RIFF", 4);
+    memcpy(&hdr[8], "WAVE", 4);
+    h->ds64Pos = 12;
+    memcpy(&hdr[12], "JUNK", 4);
+    wav_putUint(&hdr[16], WAV_WRITER_JUNK_SIZE, 4);
+    len = 12+8+WAV_WRITER_JUNK_SIZE;
+    memcpy(&hdr[len], "fmt ", 4);
+    wav_putUint(&hdr[len+4], (unsigned long long)fmtSize, 4);
+    wav_putUint(&hdr[len+8], extensible ? 0xFFFE : (h->isFloat ? 3 : 1), 2);
+    wav_putUint(&hdr[len+10], (unsigned long long)nChannels, 2);
+    wav_putUint(&hdr[len+12], (unsigned long long)sampleRate, 4);
+    wav_putUint(&hdr[len+16], (unsigned long long)sampleRate*(unsigned long long)(h->frameLen), 4);
+    wav_putUint(&hdr[len+20], (unsigned long long)(h->frameLen), 2);
+    wav_putUint(&hdr[len+22], (unsigned long long)(8*(h->bytesPerSample)), 2);
+    if(extensible){
+        wav_putUint(&hdr[len+24], 22, 2);
+        wav_putUint(&hdr[len+26], (unsigned long long)(8*(h->bytesPerSample)), 2);
+        wav_putUint(&hdr[len+28], 0, 4); /* (no speaker positions; e.g. Ambisonic signals) */
+        wav_putUint(&hdr[len+32], h->isFloat ? 3 : 1, 2);
+        memcpy(&hdr[len+34], subformatGUID, 14);
+    }
+    len += 8+fmtSize;
+    h->dataPos = len;
+    memcpy(&hdr[len], "data", 4);
+    len += 8;
+    if(fwrite(hdr, 1, (size_t)len, h->file)!=(size_t)len){
+        fclose(h->file);
+        free(h->buf);
+        free(h);
+        return 0;
+    }
+    *phWav = (void*)h;
+    return 1;
+}
+
+int saf_wavWriter_close
+(
+    void ** const phWav
+)
+{
+    safWavWriter_data* h = (safWavWriter_data*)(*phWav);
+    unsigned char b[8+WAV_WRITER_JUNK_SIZE];
+    unsigned long long dataSize, riffSize;
+    int success, isRF64;
+
+    if(h==NULL)
+        return 0;
+    wavWriter_flushBuffer(h);
+    dataSize = (unsigned long long)(h->nFrames)*(unsigned long long)(h->frameLen);
+    if((dataSize&1) && fputc(0, h->file)==EOF) /* (chunks are padded to an even size) */
+        h->failed = 1;
+    riffSize = (unsigned long long)(h->dataPos) + 8 + dataSize + (dataSize&1) - 8;
+    isRF64 = riffSize>0xFFFFFFFFULL;
+
+    /* complete the sizes */
+    success = !(h->failed);
+    if(fseek(h->file, 0, SEEK_SET)==0){
+        memcpy(b, isRF64 ? "RF64" : "RIFF", 4);
+        wav_putUint(&b[4], isRF64 ? 0xFFFFFFFFULL : riffSize, 4);
+        success = success && fwrite(b, 1, 8, h->file)==8;
+    }
+    else
+        success = 0;
+    if(isRF64 && success && fseek(h->file, (long)(h->ds64Pos), SEEK_SET)==0){
+        memset(b, 0, sizeof(b));
+        memcpy(b, "ds64", 4);
+        wav_putUint(&b[4], WAV_WRITER_JUNK_SIZE, 4);
+        wav_putUint(&b[8], riffSize, 8);
+        wav_putUint(&b[16], dataSize, 8);
+        wav_putUint(&b[24], (unsigned long long)(h->nFrames), 8);
+        success = fwrite(b, 1, sizeof(b), h->file)==sizeof(b);
+    }
+    if(success && fseek(h->file, (long)(h->dataPos)+4, SEEK_SET)==0){
+        wav_putUint(b, isRF64 ? 0xFFFFFFFFULL : dataSize, 4);
+        success = fwrite(b, 1, 4, h->file)==4;
+    }
+    else
+        success = 0;
+    if(fclose(h->file)!=0)
+        success = 0;
+    free(h->buf);
+    free(h);
+    *phWav = NULL;
+    return success;
+}
+
+void saf_wavWriter_write
+(
+    void * const hWav,
+    const float * const * data,
+    int nChannels,
+    int nFrames
+)
+{
+    safWavWriter_data* h = (safWavWriter_data*)(hWav);
+    int i, ch, n, done, nCh, bps;
+    float x;
+    unsigned int u;
+    unsigned char *frame, *b;
+    const float* in;
+
+    nCh = MIN(nChannels, h->nChannels);
+    bps = h->bytesPerSample;
+    for(done=0; done<nFrames; done+=n){
+        n = MIN(nFrames-done, WAV_WRITER_BUFFER_FRAMES-h->nBuf);
+        frame = &(h->buf[(size_t)(h->nBuf)*(size_t)(h->frameLen)]);
+
+        /* interleaved into the buffer, one channel at a time */
+        for(ch=0; ch<nCh; ch++){
+            in = &(data[ch][done]);
+            b = frame + ch*bps;
+            if(h->isFloat){
+                for(i=0; i<n; i++, b+=h->frameLen){
+                    memcpy(&u, &(in[i]), sizeof(float));
+                    wav_putUint(b, u, 4);
+                }
+            }
+            else{
+                for(i=0; i<n; i++, b+=h->frameLen){
+                    x = CLAMP(in[i], -1.0f, 1.0f)*(bps==2 ? 32767.0f : 8388607.0f);
+                    u = (unsigned int)(int)(x<0.0f ? x-0.5f : x+0.5f);
+                    wav_putUint(b, u, bps);
+                }
+            }
+        }
+        for(ch=nCh; ch<h->nChannels; ch++)
+            for(i=0, b=frame+ch*bps; i<n; i++, b+=h->frameLen)
+                memset(b, 0, bps);
+        h->nBuf += n;
+        h->nFrames += n;
+        if(h->nBuf==WAV_WRITER_BUFFER_FRAMES)
+            wavWriter_flushBuffer(h);
+    }
+}
+
+long long saf_wavWriter_getNumFrames(void * const hWav)
+{
+    safWavWriter_data* h = (safWavWriter_data*)(hWav);
+    return h->nFrames;
+}
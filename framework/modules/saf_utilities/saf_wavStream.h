@@ -0,0 +1,219 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * @file saf_wavStream.h
+ * @brief Streaming reading and writing of (long) multi-channel WAV files,
+ *        frame by frame, for offline analysis and rendering
+ *
+ * The reader memory-maps the whole file, and converts the requested frames
+ * directly from the mapped (interleaved) sample data into the planar buffers
+ * of the caller; which may be the input buffers of a "_process()" function.
+ * Only the pages that are read are loaded by the operating system, and so
+ * files of any length (e.g. multi-hour 64-channel recordings) may be streamed,
+ * without loading them into memory. Integer PCM (16, 24 or 32 bits) and
+ * floating point (32 or 64 bits) data are supported, in RIFF or RF64/BW64
+ * files (i.e. WAV files larger than 4GB); Ambisonic signals in the AmbiX
+ * convention (ACN/SN3D) are read as they are, while FuMa signals (up to third
+ * order) may be converted to ACN/SN3D on the fly (see saf_wavReader_open()).
+ *
+ * The writer interleaves the planar buffers of the caller (e.g. the output
+ * buffers of a "_process()" function) into a fixed-size internal buffer,
+ * which is written to the file whenever it is full. Files are written as RIFF,
+ * and promoted to RF64 when closed, if the sample data grew beyond 4GB.
+ *
+ * @note The reader requires a 64-bit address space for files larger than 2GB.
+ *
+ * @author agent
+ * @date 14.10.2026
+ */
+
+#ifndef SAF_WAVSTREAM_H_INCLUDED
+#define SAF_WAVSTREAM_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Channel conversions carried out by the reader */
+typedef enum {
+    SAF_WAV_CHANNELS_AS_IS = 1,  /**< channels are read as they are (e.g. AmbiX) */
+    SAF_WAV_CHANNELS_FUMA2ACN    /**< FuMa channels (up to third order) are
+                                  *   converted to ACN/SN3D (i.e. AmbiX) */
+} SAF_WAV_CHANNEL_CONVERSIONS;
+
+/** Sample formats of the writer */
+typedef enum {
+    SAF_WAV_PCM16 = 1,  /**< 16-bit integer PCM */
+    SAF_WAV_PCM24,      /**< 24-bit integer PCM */
+    SAF_WAV_FLOAT32     /**< 32-bit floating point */
+} SAF_WAV_FORMATS;
+
+
+/* ========================================================================== */
+/*                                   Reader                                   */
+/* ========================================================================== */
+
+/**
+ * Opens (and memory-maps) a WAV file for reading
+ *
+ * @param[in] phWav      (&) address of wavReader handle (NULL if the file
+ *                       could not be opened)
+ * @param[in] path       File path (WITH file extension)
+ * @param[in] conversion Channel conversion (see SAF_WAV_CHANNEL_CONVERSIONS);
+ *                       with SAF_WAV_CHANNELS_FUMA2ACN, the file must hold
+ *                       4, 9 or 16 channels
+ * @returns   1 if the file was opened, 0 otherwise
+ */
+int saf_wavReader_open(/* Input Arguments */
+                       void ** const phWav,
+                       const char* path,
+                       SAF_WAV_CHANNEL_CONVERSIONS conversion);
+
+/**
+ * Closes (and unmaps) a WAV file opened with saf_wavReader_open()
+ *
+ * @param[in] phWav (&) address of wavReader handle
+ */
+void saf_wavReader_close(/* Input Arguments */
+                         void ** const phWav);
+
+/** Returns the number of channels in the file */
+int saf_wavReader_getNumChannels(/* Input Arguments */
+                                 void * const hWav);
+
+/** Returns the number of sample frames in the file */
+long long saf_wavReader_getNumFrames(/* Input Arguments */
+                                     void * const hWav);
+
+/** Returns the samplerate of the file */
+int saf_wavReader_getSampleRate(/* Input Arguments */
+                                void * const hWav);
+
+/** Returns the position of the next frame to be read */
+long long saf_wavReader_getPosition(/* Input Arguments */
+                                    void * const hWav);
+
+/**
+ * Sets the position of the next frame to be read (clamped to the length of
+ * the file)
+ */
+void saf_wavReader_seek(/* Input Arguments */
+                        void * const hWav,
+                        long long position);
+
+/**
+ * Reads the next frames, converted to float, into planar buffers
+ *
+ * Frames beyond the end of the file are returned as zeros (e.g. for padding the
+ * last frame passed to a "_process()" function); as are any channels beyond
+ * those in the file.
+ *
+ * @param[in]  hWav      wavReader handle
+ * @param[out] data      Planar buffers for the signals; nChannels x nFrames
+ * @param[in]  nChannels Number of channels to read
+ * @param[in]  nFrames   Number of frames to read
+ * @returns    Number of frames which were read from the file (i.e. not
+ *             zero-padded)
+ */
+int saf_wavReader_read(/* Input Arguments */
+                       void * const hWav,
+                       /* Output Arguments */
+                       float ** const data,
+                       /* Input Arguments */
+                       int nChannels,
+                       int nFrames);
+
+/**
+ * Returns a direct (zero-copy) view of the sample data of the file, if it
+ * holds 32-bit floating point samples (and no channel conversion is
+ * requested); e.g. for passing them to saf_fifo_processInterleaved()
+ *
+ * @param[in]  hWav     wavReader handle
+ * @param[in]  position Position of the first frame of the view
+ * @param[out] nFrames  (&) number of frames available from 'position' onwards
+ * @returns    Interleaved signals; FLAT: nFrames x nChannels, or NULL if the
+ *             samples are in another format (use saf_wavReader_read())
+ */
+const float* saf_wavReader_getInterleavedView(/* Input Arguments */
+                                              void * const hWav,
+                                              long long position,
+                                              /* Output Arguments */
+                                              long long* nFrames);
+
+
+/* ========================================================================== */
+/*                                   Writer                                   */
+/* ========================================================================== */
+
+/**
+ * Creates a WAV file for writing
+ *
+ * All memory is allocated here; saf_wavWriter_write() only converts the
+ * samples into a fixed-size internal buffer, and writes it to the file when it
+ * is full.
+ *
+ * @param[in] phWav      (&) address of wavWriter handle (NULL if the file could
+ *                       not be created)
+ * @param[in] path       File path (WITH file extension)
+ * @param[in] nChannels  Number of channels
+ * @param[in] sampleRate Samplerate
+ * @param[in] format     Sample format (see SAF_WAV_FORMATS)
+ * @returns   1 if the file was created, 0 otherwise
+ */
+int saf_wavWriter_open(/* Input Arguments */
+                       void ** const phWav,
+                       const char* path,
+                       int nChannels,
+                       int sampleRate,
+                       SAF_WAV_FORMATS format);
+
+/**
+ * Writes any remaining frames, completes the header of the file, and closes it
+ *
+ * @param[in] phWav (&) address of wavWriter handle
+ * @returns   1 if the whole file was written successfully, 0 otherwise
+ */
+int saf_wavWriter_close(/* Input Arguments */
+                        void ** const phWav);
+
+/**
+ * Appends frames, given as planar buffers, to the file (integer formats are
+ * clipped to -1..1)
+ *
+ * @param[in] hWav      wavWriter handle
+ * @param[in] data      Planar buffers of the signals; nChannels x nFrames
+ * @param[in] nChannels Number of channels given (any further channels of the
+ *                      file are written as zeros)
+ * @param[in] nFrames   Number of frames to write
+ */
+void saf_wavWriter_write(/* Input Arguments */
+                         void * const hWav,
+                         const float * const * data,
+                         int nChannels,
+                         int nFrames);
+
+/** Returns the number of frames written so far */
+long long saf_wavWriter_getNumFrames(/* Input Arguments */
+                                     void * const hWav);
+
+
+#ifdef __cplusplus
+}/* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* SAF_WAVSTREAM_H_INCLUDED */
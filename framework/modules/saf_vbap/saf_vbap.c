@@ -37,30 +37,189 @@
 #define SAVE_PATH3 "../vbapGains_table.txt"
 #endif
 
-void generateVBAPgainTable3D_srcs
+/**
+ * Converts a loudspeaker direction in DEGREES into a unit Cartesian vector
+ */
+static void lsDir2Cart
+(
+    float* ls_dir_deg,
+    float* xyz
+)
+{
+    CH_FLOAT rcoselev;
+
+    xyz[2] = (float)((CH_FLOAT)sin((double)ls_dir_deg[1]*M_PI/180.0));
+    rcoselev = (CH_FLOAT)cos((double)ls_dir_deg[1]*M_PI/180.0);
+    xyz[0] = (float)(rcoselev * (CH_FLOAT)cos((double)ls_dir_deg[0]*M_PI/180.0));
+    xyz[1] = (float)(rcoselev * (CH_FLOAT)sin((double)ls_dir_deg[0]*M_PI/180.0));
+}
+
+/**
+ * Converts the loudspeaker directions into Cartesian coordinates, and builds
+ * their convex hull (which, for points on the sphere, equals their Delaunay
+ * triangulation). The face indices are circularly shifted to start from their
+ * lowest value, and the faces are then sorted in ascending order.
+ */
+static void findLsTriplets_hull
+(
+    float* ls_dirs_deg,
+    int L,
+    float** out_vertices,
+    int** out_faces,
+    int* numOutFaces
+)
+{
+    int i, j, k, minIntVal, minIdx, nFaces;
+    int tmp3[3], circface[3];
+    int* faces;
+    ch_vertex* vertices;
+
+    /* Build the convex hull for the points on the sphere - in this special case the
+       result equals the Delaunay triangulation of the points */
+    vertices = malloc1d(L*sizeof(ch_vertex));
+    (*out_vertices) = (float*)malloc1d(L*3*sizeof(float));
+    for ( i = 0; i < L; i++) {
+        lsDir2Cart(&ls_dirs_deg[i*2], &(*out_vertices)[i*3]);
+        vertices[i].x = (*out_vertices)[i*3+0];
+        vertices[i].y = (*out_vertices)[i*3+1];
+        vertices[i].z = (*out_vertices)[i*3+2];
+    }
+    faces = NULL;
+    convhull_3d_build_quickhull(vertices, L, &faces, &nFaces);
+#ifndef NDEBUG
+    if(faces==NULL)
+        saf_error_print(SAF_ERROR__FAILED_TO_BUILD_CONVEX_HULL);
+#endif
+
+    /* circularily shift the indices to start from lowest value */
+    for(i=0; i<nFaces; i++){
+        minIntVal = L;
+        minIdx = 0;
+        for(j=0; j<3; j++){
+            if (faces[i*3+j] < minIntVal){
+                minIntVal = faces[i*3+j];
+                minIdx=j;
+            }
+        }
+        for(j=minIdx, k=0; j<minIdx+3; j++, k++)
+            circface[k] = faces[i*3+(j % 3)];
+        for(j=0; j<3; j++)
+            faces[i*3+j] = circface[j];
+    }
+
+    /* sort indices in accending order for the first dimension */
+    for (j=0; j<nFaces - 1; j++)  {
+        for (i=0; i<nFaces - 1; i++) {
+            if (faces[(i+1)*3+0] < faces[i*3+0])  {
+                for(k=0; k<3; k++){
+                    tmp3[k] = faces[i*3+k];
+                    faces[i*3+k] = faces[(i+1)*3+k];
+                    faces[(i+1)*3+k] = tmp3[k];
+                }
+            }
+        }
+    }
+
+    /* sort indices in accending order for the second dimension */
+    for (j=0; j<nFaces - 1; j++)  {
+        for (i=0; i<nFaces - 1; i++) {
+            if ( (faces[(i+1)*3+1] < faces[i*3+1]) && (faces[(i+1)*3+0] == faces[i*3+0]) ) {
+                for(k=0; k<3; k++){
+                    tmp3[k] = faces[i*3+k];
+                    faces[i*3+k] = faces[(i+1)*3+k];
+                    faces[(i+1)*3+k] = tmp3[k];
+                }
+            }
+        }
+    }
+#if 0
+    /* sort indices in accending order for the third dimension */
+    for (j=0; j<nFaces - 1; j++)  {
+        for (i=0; i<nFaces - 1; i++) {
+            if ( (faces[(i+1)*3+2] < faces[i*3+2]) && (faces[(i+1)*3+0] == faces[i*3+0]) && (faces[(i+1)*3+1] == faces[i*3+1])) {
+                for(k=0; k<3; k++){
+                    tmp3[k] = faces[i*3+k];
+                    faces[i*3+k] = faces[(i+1)*3+k];
+                    faces[(i+1)*3+k] = tmp3[k];
+                }
+            }
+        }
+    }
+#endif
+
+    free(vertices);
+    (*out_faces) = faces;
+    (*numOutFaces) = nFaces;
+}
+
+/**
+ * Returns 1 if a loudspeaker triangle should be kept, or 0 if it should be
+ * omitted (i.e. if the angle between its normal and centroid is larger than
+ * pi/2, or, if omitLargeTriangles==1, if its aperture is larger than
+ * APERTURE_LIMIT_DEG)
+ */
+static int findLsTriplets_isValidFace
+(
+    float* vertices,
+    int* face,
+    int omitLargeTriangles
+)
+{
+    int j;
+    float dotcc, aperture_lim;
+    float vecs[3][3], cvec[3], centroid[3], a[3], b[3], abc[3];
+
+    for(j=0; j<3; j++){
+        vecs[0][j] = vertices[face[0]*3+j];
+        vecs[1][j] = vertices[face[1]*3+j];
+        vecs[2][j] = vertices[face[2]*3+j];
+    }
+    for(j=0; j<3; j++){
+        a[j] = vecs[1][j]-vecs[0][j];
+        b[j] = vecs[2][j]-vecs[1][j];
+    }
+    ccross(a, b, cvec);
+    for(j=0; j<3; j++)
+        centroid[j] = (vecs[0][j] + vecs[1][j] + vecs[2][j])/3.0f;
+    dotcc = cvec[0] * centroid[0] + cvec[1] * centroid[1] + cvec[2] * centroid[2];
+    if(!(acosf(MAX(MIN(dotcc,0.99999999f),-0.99999999f)/* avoids complex numbers */)<(M_PI/2.0f)))
+        return 0;
+    if(omitLargeTriangles) {
+        aperture_lim = APERTURE_LIMIT_DEG * M_PI/180.0f;
+        dotcc = vecs[0][0] * vecs[1][0] + vecs[0][1] * vecs[1][1] + vecs[0][2] * vecs[1][2];
+        abc[0] = acosf(dotcc);
+        dotcc = vecs[1][0] * vecs[2][0] + vecs[1][1] * vecs[2][1] + vecs[1][2] * vecs[2][2];
+        abc[1] = acosf(dotcc);
+        dotcc = vecs[2][0] * vecs[0][0] + vecs[2][1] * vecs[0][1] + vecs[2][2] * vecs[0][2];
+        abc[2] = acosf(dotcc);
+        if(!(abc[0]<aperture_lim && abc[1]<aperture_lim && abc[2]<aperture_lim))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Triangulates the loudspeaker directions (see findLsTriplets()), optionally
+ * adding dummy loudspeakers at the extreme top/bottom if required. Any dummy
+ * loudspeakers are appended after the L real loudspeakers; i.e.
+ * numOutVertices > L if dummies were added.
+ */
+static void findLsTripletsWithDummies
 (
-    float* src_dirs_deg,
-    int S,
     float* ls_dirs_deg,
     int L,
     int omitLargeTriangles,
     int enableDummies,
-    float spread,
-    float** gtable /* &: S x L */,
-    int* N_gtable /* & S */,
-    int* nTriangles
+    float** out_vertices,
+    int* numOutVertices,
+    int** out_faces,
+    int* numOutFaces
 )
 {
-    int N_points, numOutVertices, numOutFaces;
-    int* out_faces;
-    float *out_vertices, *layoutInvMtx;
     int i, L_d;
     int needDummy[2] = {1, 1};
     float* ls_dirs_d_deg;
-    
-    /* find loudspeaker triangles */
-    out_vertices = NULL;
-    out_faces = NULL;
+
     if(enableDummies){
         /* scan the loudspeaker directions to see if dummies need to be added */
         for(i=0; i<L; i++){
@@ -83,16 +242,184 @@ void generateVBAPgainTable3D_srcs
                 ls_dirs_d_deg[i*2+0] = 0.0f;
                 ls_dirs_d_deg[i*2+1] = 90.0f;
             }
-            
+
             /* triangulate while including the dummy loudspeaker directions */
-            findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+            findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, out_vertices, numOutVertices, out_faces, numOutFaces);
             free(ls_dirs_d_deg);
         }
         else /* triangulate as normal */
-            findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+            findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, out_vertices, numOutVertices, out_faces, numOutFaces);
+    }
+    else /* triangulate as normal */
+        findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, out_vertices, numOutVertices, out_faces, numOutFaces);
+}
+
+/** Number of directions converted at a time by vbap_srcDirs2Cart() */
+#define SRC_DIRS_BLOCK_SIZE ( 64 )
+
+/**
+ * Converts source directions in DEGREES into unit Cartesian vectors; in blocks,
+ * with the vectorised sin/cos of saf_veclib
+ */
+static void vbap_srcDirs2Cart
+(
+    float* src_dirs_deg,
+    int nDirs,
+    float* xyz
+)
+{
+    int i, j, blockSize;
+    float azi[SRC_DIRS_BLOCK_SIZE], elev[SRC_DIRS_BLOCK_SIZE];
+    float sinAzi[SRC_DIRS_BLOCK_SIZE], cosAzi[SRC_DIRS_BLOCK_SIZE];
+    float sinElev[SRC_DIRS_BLOCK_SIZE], cosElev[SRC_DIRS_BLOCK_SIZE];
+
+    for(i=0; i<nDirs; i+=SRC_DIRS_BLOCK_SIZE){
+        blockSize = MIN(SRC_DIRS_BLOCK_SIZE, nDirs-i);
+        for(j=0; j<blockSize; j++){
+            azi[j] = src_dirs_deg[(i+j)*2]*M_PI/180.0f;
+            elev[j] = src_dirs_deg[(i+j)*2+1]*M_PI/180.0f;
+        }
+        utility_svsincosapprox(azi, blockSize, sinAzi, cosAzi);
+        utility_svsincosapprox(elev, blockSize, sinElev, cosElev);
+        for(j=0; j<blockSize; j++){
+            xyz[(i+j)*3]   = cosAzi[j]*cosElev[j];
+            xyz[(i+j)*3+1] = sinAzi[j]*cosElev[j];
+            xyz[(i+j)*3+2] = sinElev[j];
+        }
+    }
+}
+
+/**
+ * Computes the ENERGY normalised VBAP/MDAP gains of all loudspeakers for one
+ * source direction (in DEGREES, and as a unit vector), as in vbap3D().
+ * 'spreadKernel' is NULL for VBAP, or the output of getSpreadKernel3D() (of
+ * MDAP_NUM_SPREAD_SRCS x MDAP_NUM_RINGS directions) for MDAP. In the latter
+ * case, 'src_xyz' is not used (and may be NULL), whereas 'U_spread' and
+ * 'G_spread' are scratch buffers of (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1) x 3
+ * and (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1) x nFaces*3 floats, respectively.
+ * For VBAP, only the triangles of 'hFaceGrid' (see vbap_faceGrid_create()) that
+ * may enclose the source are tested; or all of them, if it is NULL.
+ */
+static void vbap3D_srcGains
+(
+    float* src_dir,
+    float* src_xyz,
+    int ls_num,
+    int* ls_groups,
+    int nFaces,
+    float* spreadKernel,
+    float* layoutInvMtx,
+    void* hFaceGrid,
+    float* U_spread,
+    float* G_spread,
+    float* gains
+)
+{
+    int i, j, k, nspr, nDirs, nCand;
+    float azi_rad, elev_rad, min_val, g_tmp_rms, gains_rms;
+    float g_tmp[3];
+    float* g_spr;
+    int* cand;
+
+    azi_rad  = src_dir[0]*M_PI/180.0f;
+    elev_rad = src_dir[1]*M_PI/180.0f;
+    memset(gains, 0, ls_num*sizeof(float));
+
+    /* MDAP (with spread) */
+    if (spreadKernel!=NULL) {
+        /* the unnormalised gains of all triangles, for all spread directions,
+         * are obtained with a single matrix multiplication */
+        nDirs = MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1;
+        applySpreadKernel3D(azi_rad, elev_rad, spreadKernel, nDirs-1, U_spread);
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, nDirs, nFaces*3, 3, 1.0f,
+                    U_spread, 3,
+                    layoutInvMtx, 3, 0.0f,
+                    G_spread, nFaces*3);
+        for(nspr=0; nspr<nDirs; nspr++){
+            for(i=0; i<nFaces; i++){
+                g_spr = &G_spread[nspr*nFaces*3 + i*3];
+                min_val = MIN(MIN(g_spr[0], g_spr[1]), g_spr[2]);
+                if(min_val>-0.001){
+                    g_tmp_rms = sqrtf(g_spr[0]*g_spr[0] + g_spr[1]*g_spr[1] + g_spr[2]*g_spr[2]);
+                    for(j=0; j<3; j++)
+                        gains[ls_groups[i*3+j]] += g_spr[j]/g_tmp_rms;
+                }
+            }
+        }
+    }
+    /* VBAP (no spread) */
+    else{
+        cand = NULL;
+        nCand = hFaceGrid!=NULL ? vbap_faceGrid_getFaces(hFaceGrid, src_xyz, &cand) : nFaces;
+        for(k=0; k<nCand; k++){
+            i = cand!=NULL ? cand[k] : k;
+            utility_sm3vmul(&layoutInvMtx[i*9], src_xyz, g_tmp);
+            min_val = 2.23e13f;
+            g_tmp_rms = 0.0;
+            for(j=0; j<3; j++){
+                min_val = MIN(min_val, g_tmp[j]);
+                g_tmp_rms +=  powf(g_tmp[j], 2.0f);
+            }
+            g_tmp_rms = sqrtf(g_tmp_rms);
+            if(min_val>-0.001){
+                for(j=0; j<3; j++)
+                    gains[ls_groups[i*3+j]] = g_tmp[j]/g_tmp_rms;
+                break;
+            }
+        }
     }
-    else
-        findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+
+    /* energy normalise */
+    gains_rms = 0.0;
+    for(i=0; i<ls_num; i++)
+        gains_rms += powf(gains[i], 2.0f);
+    gains_rms = sqrtf(gains_rms);
+    for(i=0; i<ls_num; i++)
+        gains[i] = MAX(gains[i]/gains_rms, 0.0f);
+}
+
+void generateVBAPgainTable3D_srcs
+(
+    float* src_dirs_deg,
+    int S,
+    float* ls_dirs_deg,
+    int L,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** gtable /* &: S x L */,
+    int* N_gtable /* & S */,
+    int* nTriangles
+)
+{
+    generateVBAPgainTable3D_srcsParallel(NULL, src_dirs_deg, S, ls_dirs_deg, L, omitLargeTriangles, enableDummies,
+                                         spread, gtable, N_gtable, nTriangles);
+}
+
+void generateVBAPgainTable3D_srcsParallel
+(
+    void* const hPar,
+    float* src_dirs_deg,
+    int S,
+    float* ls_dirs_deg,
+    int L,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** gtable /* &: S x L */,
+    int* N_gtable /* & S */,
+    int* nTriangles
+)
+{
+    int N_points, numOutVertices, numOutFaces;
+    int* out_faces;
+    float *out_vertices, *layoutInvMtx;
+    int i;
+    
+    /* find loudspeaker triangles */
+    out_vertices = NULL;
+    out_faces = NULL;
+    findLsTripletsWithDummies(ls_dirs_deg, L, omitLargeTriangles, enableDummies, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
 #if ENABLE_VBAP_DEBUGGING_CODE
     /* save faces and vertices for verification in matlab: */
     FILE* objfile = fopen(SAVE_PATH, "wt");
@@ -121,14 +448,12 @@ void generateVBAPgainTable3D_srcs
     
     /* Calculate VBAP gains for each source position */
     N_points = S;
-    vbap3D(src_dirs_deg, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx, gtable);
-    if(enableDummies){
-        if(needDummy[0] || needDummy[1]){
-            /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
-            for(i=0; i<N_points; i++)
-                memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
-            (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
-        }
+    vbap3DParallel(hPar, src_dirs_deg, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx, gtable);
+    if(numOutVertices > L){
+        /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
+        for(i=0; i<N_points; i++)
+            memmove(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
+        (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
     }
     
     /* output */
@@ -169,14 +494,30 @@ void generateVBAPgainTable3D
     int* N_gtable,
     int* nTriangles
 )
+{
+    generateVBAPgainTable3DParallel(NULL, ls_dirs_deg, L, az_res_deg, el_res_deg, omitLargeTriangles, enableDummies,
+                                    spread, gtable, N_gtable, nTriangles);
+}
+
+void generateVBAPgainTable3DParallel
+(
+    void* const hPar,
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** gtable /* N_srcs x N_lspkrs  */,
+    int* N_gtable,
+    int* nTriangles
+)
 {
     int i, j, N_azi, N_ele, N_points, numOutVertices, numOutFaces;
     int* out_faces;
     float fi;
     float* azi, *ele, *src_dirs, *out_vertices, *layoutInvMtx;
-    int L_d;
-    int needDummy[2] = {1, 1};
-    float* ls_dirs_d_deg;
     
     /* compute source directions for the grid */
     N_azi = (int)((360.0f/(float)az_res_deg) + 1.5f);
@@ -198,38 +539,7 @@ void generateVBAPgainTable3D
     /* find loudspeaker triangles */
     out_vertices = NULL;
     out_faces = NULL;
-    if(enableDummies){
-        /* scan the loudspeaker directions to see if dummies need to be added */
-        for(i=0; i<L; i++){
-            if(ls_dirs_deg[i*2+1] <= -ADD_DUMMY_LIMIT)
-                needDummy[0] = 0;
-            if(ls_dirs_deg[i*2+1] >=  ADD_DUMMY_LIMIT)
-                needDummy[1] = 0;
-        }
-        if(needDummy[0] || needDummy[1]){
-            /* add dummies to the extreme top/bottom as required */
-            L_d = L+needDummy[0]+needDummy[1];
-            ls_dirs_d_deg = malloc1d(L_d*2*sizeof(float));
-            memcpy(ls_dirs_d_deg, ls_dirs_deg, L*2*sizeof(float));
-            if (needDummy[0]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = -90.0f;
-                i++;
-            }
-            if (needDummy[1]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = 90.0f;
-            }
-            
-            /* triangulate while including the dummy loudspeakers */
-            findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-            free(ls_dirs_d_deg);
-        }
-        else /* triangulate as normal */
-            findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-    }
-    else /* triangulate as normal */
-        findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+    findLsTripletsWithDummies(ls_dirs_deg, L, omitLargeTriangles, enableDummies, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
 #if ENABLE_VBAP_DEBUGGING_CODE
     /* save faces and vertices for verification in matlab: */
     FILE* objfile = fopen(SAVE_PATH, "wt");
@@ -258,42 +568,1384 @@ void generateVBAPgainTable3D
     
     /* Calculate VBAP gains for each source position */
     N_points = N_azi*N_ele;
-    vbap3D(src_dirs, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx,  gtable);
+    vbap3DParallel(hPar, src_dirs, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx,  gtable);
     
     /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
-    if(enableDummies){
-        if(needDummy[0] || needDummy[1]){
-            for(i=0; i<N_points; i++)
-                memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
-            (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
+    if(numOutVertices > L){
+        for(i=0; i<N_points; i++)
+            memmove(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
+        (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
+    }
+    
+    /* output */
+    (*N_gtable) = N_points;
+    (*nTriangles) = numOutFaces;
+#if ENABLE_VBAP_DEBUGGING_CODE
+    /* save gain table for verification in matlab: */
+    FILE* objfile2 = fopen(SAVE_PATH3, "wt");
+    fprintf(objfile2, "vbap_gtable = [\n");
+    for (i = 0; i < N_points; i++) {
+        for (j = 0; j < L; j++) {
+            fprintf(objfile2, " %f", (*gtable)[i*L+j] );
+            if(j<L-1)
+                fprintf(objfile2,",");
+        }
+        fprintf(objfile2, ";\n");
+    }
+    fprintf(objfile2, "];\n\n\n");
+    fclose(objfile2);
+#endif
+    
+    /* clean up */
+    free1d((void**)&(out_vertices));
+    free1d((void**)&(out_faces));
+    free1d((void**)&(layoutInvMtx));
+    free(azi);
+    free(ele);
+    free(src_dirs);
+}
+
+/**
+ * Data structure for a 3-D VBAP gain table, which may be updated incrementally
+ *
+ * The full (unfiltered) convex hull of the loudspeakers is retained, along with
+ * which of its triangles are used for panning and their inverted loudspeaker
+ * matrices. For VBAP, the hull triangle used by each grid direction is also
+ * stored, so that only the directions affected by a layout change need to be
+ * revisited.
+ */
+typedef struct _vbapTable3D_data {
+    /* configuration */
+    int L;                  /**< number of loudspeakers */
+    int L_d;                /**< number of loudspeakers, including dummies */
+    int needDummy[2];       /**< whether a dummy was added below/above */
+    int az_res_deg, el_res_deg, omitLargeTriangles, enableDummies;
+    float spread;           /**< spread in DEGREES, 0: VBAP, >0: MDAP */
+    float* ls_dirs_deg;     /**< loudspeaker (and dummy) directions; FLAT: L_d x 2 */
+    float* vertices;        /**< loudspeaker (and dummy) unit vectors; FLAT: L_d x 3 */
+
+    /* triangulation */
+    int nHullFaces;         /**< number of triangles in the convex hull */
+    int* hullFaces;         /**< convex hull triangles; FLAT: nHullFaces x 3 */
+    int* faceValid;         /**< 1: triangle is used for panning; nHullFaces x 1 */
+    float* faceInvMtx;      /**< inverted loudspeaker matrices; FLAT: nHullFaces x 9 */
+    int nTriangles;         /**< number of triangles used for panning */
+    void* hFaceGrid;        /**< the triangles used for panning that may enclose each direction; see vbap_faceGrid_create() */
+
+    /* gain table */
+    int N_azi, N_ele, N_gtable, nGains;
+    float* azi, *ele;       /**< grid azimuths/elevations, in DEGREES */
+    float* gtableComp;      /**< compressed gain table; FLAT: N_gtable x nGains */
+    int* gtableIdx;         /**< loudspeaker indices; FLAT: N_gtable x nGains */
+    int* faceIdx;           /**< hull triangle used per direction (VBAP only, -1: none); N_gtable x 1 */
+
+    /* MDAP */
+    int mdapDirty;          /**< 1: the arrays below must be re-gathered from the hull triangles */
+    int* ls_groups;         /**< triangles used for panning; FLAT: nTriangles x 3 */
+    float* layoutInvMtx;    /**< their inverted loudspeaker matrices; FLAT: nTriangles x 9 */
+    float kernelSpread;     /**< spread of the cached spread kernel, in DEGREES */
+    float spreadKernel[MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS*3]; /**< see getSpreadKernel3D() */
+    float U_spread[(MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*3]; /**< scratch for the spread directions */
+    float* G_spread;        /**< scratch for the unnormalised gains; FLAT: (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1) x nTriangles*3 */
+    float* gains;           /**< scratch for the gains of all loudspeakers; L_d x 1 */
+
+}vbapTable3D_data;
+
+/**
+ * Tests whether hull triangle 'f' encloses unit vector 'u' (as in vbap3D()),
+ * and if so, returns 1 and its (un-normalised) gains
+ */
+static int vbapTable3D_testFace
+(
+    vbapTable3D_data* h,
+    int f,
+    float u[3],
+    float g_tmp[3]
+)
+{
+    int j;
+    float min_val, g_tmp_rms;
+
+    utility_sm3vmul(&(h->faceInvMtx[f*9]), u, g_tmp);
+    min_val = 2.23e13f;
+    g_tmp_rms = 0.0;
+    for(j=0; j<3; j++){
+        min_val = MIN(min_val, g_tmp[j]);
+        g_tmp_rms +=  powf(g_tmp[j], 2.0f);
+    }
+    g_tmp_rms = sqrtf(g_tmp_rms);
+    if(min_val>-0.001){
+        for(j=0; j<3; j++)
+            g_tmp[j] = g_tmp[j]/g_tmp_rms;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Stores the VBAP gains of direction 'n', obtained with hull triangle 'f' (or
+ * zeros if f==-1). The gains are energy normalised and compressed in
+ * ascending loudspeaker order, as for the dense table.
+ */
+static void vbapTable3D_storeGains
+(
+    vbapTable3D_data* h,
+    int n,
+    int f,
+    float g_tmp[3]
+)
+{
+    int i, j, k, itmp;
+    int idx[3];
+    float ftmp, gains_rms, gain;
+    float gains[3];
+
+    memset(&(h->gtableComp[n*h->nGains]), 0, h->nGains*sizeof(float));
+    memset(&(h->gtableIdx[n*h->nGains]), 0, h->nGains*sizeof(int));
+    h->faceIdx[n] = f;
+    if(f<0)
+        return;
+    for(j=0; j<3; j++){
+        idx[j] = h->hullFaces[f*3+j];
+        gains[j] = g_tmp[j];
+    }
+    for(i=1; i<3; i++){
+        for(j=i; j>0 && idx[j-1]>idx[j]; j--){
+            itmp = idx[j]; idx[j] = idx[j-1]; idx[j-1] = itmp;
+            ftmp = gains[j]; gains[j] = gains[j-1]; gains[j-1] = ftmp;
+        }
+    }
+    gains_rms = 0.0;
+    for(j=0; j<3; j++)
+        gains_rms += powf(gains[j], 2.0f);
+    gains_rms = sqrtf(gains_rms);
+    for(j=0, k=0; j<3 && k<h->nGains; j++){
+        gain = MAX(gains[j]/gains_rms, 0.0f);
+        if(idx[j]<h->L && gain>COMPRESSED_GAIN_THRESHOLD){
+            h->gtableComp[n*h->nGains+k] = gain;
+            h->gtableIdx[n*h->nGains+k] = idx[j];
+            k++;
+        }
+    }
+}
+
+/**
+ * Returns the unit vector of grid direction 'n'
+ */
+static void vbapTable3D_getDir
+(
+    vbapTable3D_data* h,
+    int n,
+    float u[3]
+)
+{
+    float azi_rad, elev_rad;
+
+    azi_rad  = h->azi[n%h->N_azi]*M_PI/180.0f;
+    elev_rad = h->ele[n/h->N_azi]*M_PI/180.0f;
+    u[0] = cosf(azi_rad)*cosf(elev_rad);
+    u[1] = sinf(azi_rad)*cosf(elev_rad);
+    u[2] = sinf(elev_rad);
+}
+
+/**
+ * Gathers the triangles used for panning (if they have changed), and computes
+ * the spread kernel (if the spread has changed), for MDAP
+ */
+static void vbapTable3D_prepareSpread
+(
+    vbapTable3D_data* h,
+    float spread
+)
+{
+    int f, i;
+
+    if(h->mdapDirty){
+        h->ls_groups = realloc1d(h->ls_groups, MAX(h->nTriangles,1)*3*sizeof(int));
+        h->layoutInvMtx = realloc1d(h->layoutInvMtx, MAX(h->nTriangles,1)*9*sizeof(float));
+        h->G_spread = realloc1d(h->G_spread, (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*MAX(h->nTriangles,1)*3*sizeof(float));
+        h->gains = realloc1d(h->gains, h->L_d*sizeof(float));
+        for(f=0, i=0; f<h->nHullFaces; f++){
+            if(h->faceValid[f]){
+                memcpy(&(h->ls_groups[i*3]), &(h->hullFaces[f*3]), 3*sizeof(int));
+                memcpy(&(h->layoutInvMtx[i*9]), &(h->faceInvMtx[f*9]), 9*sizeof(float));
+                i++;
+            }
+        }
+        h->mdapDirty = 0;
+    }
+    if(spread != h->kernelSpread){
+        getSpreadKernel3D(spread, MDAP_NUM_SPREAD_SRCS, MDAP_NUM_RINGS, h->spreadKernel);
+        h->kernelSpread = spread;
+    }
+}
+
+/**
+ * Returns the first triangle (in hull order) that encloses unit vector 'u', and
+ * its gains; or -1 if there is none
+ */
+static int vbapTable3D_findFace
+(
+    vbapTable3D_data* h,
+    float u[3],
+    float g_tmp[3]
+)
+{
+    int k, nCand;
+    int* cand;
+
+    nCand = vbap_faceGrid_getFaces(h->hFaceGrid, u, &cand);
+    for(k=0; k<nCand; k++)
+        if(vbapTable3D_testFace(h, cand[k], u, g_tmp))
+            return cand[k];
+    return -1;
+}
+
+/** VBAP gains of the grid directions first..last-1 (see saf_parfor_func) */
+static void vbapTable3D_vbapRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    vbapTable3D_data* h = (vbapTable3D_data*)hCtx;
+    int n;
+    float u[3], g_tmp[3];
+
+    for(n=first; n<last; n++){
+        vbapTable3D_getDir(h, n, u);
+        vbapTable3D_storeGains(h, n, vbapTable3D_findFace(h, u, g_tmp), g_tmp);
+    }
+}
+
+/** Scratch memory (per thread) for vbapTable3D_mdapRange() */
+typedef struct _vbapTable3D_mdapJob {
+    vbapTable3D_data* h;
+    int maxGains;
+    float* U_spread;    /**< FLAT: nThreads x (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*3 */
+    float* G_spread;    /**< FLAT: nThreads x (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*nTriangles*3 */
+    float* gains;       /**< FLAT: nThreads x L_d */
+    int* nGains;        /**< largest number of gains found by each thread; nThreads x 1 */
+
+}vbapTable3D_mdapJob;
+
+/** MDAP gains of the grid directions first..last-1 (see saf_parfor_func) */
+static void vbapTable3D_mdapRange
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    vbapTable3D_mdapJob* job = (vbapTable3D_mdapJob*)hCtx;
+    vbapTable3D_data* h = job->h;
+    int j, n, nG, nSpr;
+    float src_dir[2];
+    float* gains;
+
+    nSpr = MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1;
+    gains = &(job->gains[threadIndex*(h->L_d)]);
+    for(n=first; n<last; n++){
+        src_dir[0] = h->azi[n%h->N_azi];
+        src_dir[1] = h->ele[n/h->N_azi];
+        vbap3D_srcGains(src_dir, NULL, h->L_d, h->ls_groups, h->nTriangles, h->spreadKernel, h->layoutInvMtx, NULL,
+                        &(job->U_spread[threadIndex*nSpr*3]), &(job->G_spread[threadIndex*nSpr*(h->nTriangles)*3]), gains);
+        for(j=0, nG=0; j<h->L && nG<job->maxGains; j++){
+            if(gains[j]>COMPRESSED_GAIN_THRESHOLD){
+                h->gtableComp[n*job->maxGains+nG] = gains[j];
+                h->gtableIdx[n*job->maxGains+nG] = j;
+                nG++;
+            }
+        }
+        job->nGains[threadIndex] = MAX(job->nGains[threadIndex], nG);
+        h->faceIdx[n] = -1;
+    }
+}
+
+/**
+ * (Re)computes the gains of all grid directions for the current triangulation,
+ * with the directions split over the threads of 'hPar' (which may be NULL)
+ */
+static void vbapTable3D_computeAllGains
+(
+    vbapTable3D_data* h,
+    void* const hPar
+)
+{
+    int i, n, nThreads, nSpr, maxGains;
+    vbapTable3D_mdapJob job;
+
+    /* (the tables are large and read-mostly; see md_large_setFlags()) */
+    free1d_large(h->gtableComp);
+    free1d_large(h->gtableIdx);
+    h->gtableComp = NULL;
+    h->gtableIdx = NULL;
+    h->nGains = 0;
+    if(h->nTriangles==0)
+        return;
+    h->faceIdx = realloc1d_large(h->faceIdx, h->N_gtable*sizeof(int));
+
+    /* VBAP: the first triangle (in hull order) that encloses each direction */
+    if(h->spread <= 0.1f){
+        h->nGains = MIN(3, h->L);
+        h->gtableComp = malloc1d_large(h->N_gtable*h->nGains*sizeof(float));
+        h->gtableIdx = malloc1d_large(h->N_gtable*h->nGains*sizeof(int));
+        saf_parfor_run(hPar, &vbapTable3D_vbapRange, (void*)h, h->N_gtable);
+        return;
+    }
+
+    /* MDAP: gains span (at most) one triangle per spread direction */
+    vbapTable3D_prepareSpread(h, h->spread);
+    maxGains = MIN(3*(MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1), h->L);
+    h->gtableComp = calloc1d_large(h->N_gtable*maxGains, sizeof(float));
+    h->gtableIdx = calloc1d_large(h->N_gtable*maxGains, sizeof(int));
+    nThreads = saf_parfor_getNumThreads(hPar);
+    nSpr = MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1;
+    job.h = h;
+    job.maxGains = maxGains;
+    job.U_spread = malloc1d(nThreads*nSpr*3*sizeof(float));
+    job.G_spread = malloc1d(nThreads*nSpr*(h->nTriangles)*3*sizeof(float));
+    job.gains = malloc1d(nThreads*(h->L_d)*sizeof(float));
+    job.nGains = calloc1d(nThreads, sizeof(int));
+    saf_parfor_run(hPar, &vbapTable3D_mdapRange, (void*)&job, h->N_gtable);
+    for(i=0; i<nThreads; i++)
+        h->nGains = MAX(h->nGains, job.nGains[i]);
+    free(job.U_spread);
+    free(job.G_spread);
+    free(job.gains);
+    free(job.nGains);
+
+    /* trim the table to the largest number of gains actually used */
+    h->nGains = MAX(h->nGains, 1);
+    if(h->nGains < maxGains){
+        for(n=1; n<h->N_gtable; n++){
+            memmove(&(h->gtableComp[n*h->nGains]), &(h->gtableComp[n*maxGains]), h->nGains*sizeof(float));
+            memmove(&(h->gtableIdx[n*h->nGains]), &(h->gtableIdx[n*maxGains]), h->nGains*sizeof(int));
+        }
+        h->gtableComp = realloc1d_large(h->gtableComp, h->N_gtable*h->nGains*sizeof(float));
+        h->gtableIdx = realloc1d_large(h->gtableIdx, h->N_gtable*h->nGains*sizeof(int));
+    }
+}
+
+/**
+ * Determines which dummy loudspeakers are required for a layout
+ */
+static void vbapTable3D_getNeedDummy
+(
+    float* ls_dirs_deg,
+    int L,
+    int enableDummies,
+    int needDummy[2]
+)
+{
+    int i;
+
+    needDummy[0] = needDummy[1] = enableDummies;
+    for(i=0; i<L && enableDummies; i++){
+        if(ls_dirs_deg[i*2+1] <= -ADD_DUMMY_LIMIT)
+            needDummy[0] = 0;
+        if(ls_dirs_deg[i*2+1] >=  ADD_DUMMY_LIMIT)
+            needDummy[1] = 0;
+    }
+}
+
+/**
+ * Inverts the loudspeaker matrix of hull triangle 'f' (if it is used)
+ */
+static void vbapTable3D_invertFace
+(
+    vbapTable3D_data* h,
+    int f
+)
+{
+    float* invMtx;
+
+    if(!h->faceValid[f])
+        return;
+    invMtx = NULL;
+    invertLsMtx3D(h->vertices, &(h->hullFaces[f*3]), 1, &invMtx);
+    memcpy(&(h->faceInvMtx[f*9]), invMtx, 9*sizeof(float));
+    free(invMtx);
+}
+
+/**
+ * Triangulates the loudspeaker layout from scratch (without computing any
+ * gains)
+ */
+static void vbapTable3D_triangulate
+(
+    vbapTable3D_data* h,
+    float* ls_dirs_deg
+)
+{
+    int f, i;
+
+    /* loudspeaker directions, with dummies appended as required */
+    vbapTable3D_getNeedDummy(ls_dirs_deg, h->L, h->enableDummies, h->needDummy);
+    h->L_d = h->L + h->needDummy[0] + h->needDummy[1];
+    h->ls_dirs_deg = realloc1d(h->ls_dirs_deg, h->L_d*2*sizeof(float));
+    memcpy(h->ls_dirs_deg, ls_dirs_deg, h->L*2*sizeof(float));
+    i = h->L;
+    if(h->needDummy[0]){
+        h->ls_dirs_deg[i*2+0] = 0.0f;
+        h->ls_dirs_deg[i*2+1] = -90.0f;
+        i++;
+    }
+    if(h->needDummy[1]){
+        h->ls_dirs_deg[i*2+0] = 0.0f;
+        h->ls_dirs_deg[i*2+1] = 90.0f;
+    }
+
+    /* triangulate, and invert the loudspeaker matrices of the valid triangles */
+    free1d((void**)&(h->vertices));
+    free1d((void**)&(h->hullFaces));
+    findLsTriplets_hull(h->ls_dirs_deg, h->L_d, &(h->vertices), &(h->hullFaces), &(h->nHullFaces));
+    h->faceValid = realloc1d(h->faceValid, MAX(h->nHullFaces,1)*sizeof(int));
+    h->faceInvMtx = realloc1d(h->faceInvMtx, MAX(h->nHullFaces,1)*9*sizeof(float));
+    h->nTriangles = 0;
+    for(f=0; f<h->nHullFaces; f++){
+        h->faceValid[f] = findLsTriplets_isValidFace(h->vertices, &(h->hullFaces[f*3]), h->omitLargeTriangles);
+        h->nTriangles += h->faceValid[f];
+        vbapTable3D_invertFace(h, f);
+    }
+    vbap_faceGrid_destroy(&(h->hFaceGrid));
+    vbap_faceGrid_create(&(h->hFaceGrid), h->faceInvMtx, h->faceValid, h->nHullFaces);
+    h->mdapDirty = 1;
+}
+
+/**
+ * Triangulates the loudspeaker layout from scratch, and computes all gains
+ * (with the directions split over the threads of 'hPar', which may be NULL)
+ */
+static void vbapTable3D_build
+(
+    vbapTable3D_data* h,
+    float* ls_dirs_deg,
+    void* const hPar
+)
+{
+    vbapTable3D_triangulate(h, ls_dirs_deg);
+    vbapTable3D_computeAllGains(h, hPar);
+}
+
+/**
+ * Returns 1 if the hull triangles are still the convex hull of the loudspeaker
+ * vertices (i.e. if no vertex lies in front of any triangle), after the
+ * vertices flagged in 'moved' have been displaced, or 0 otherwise
+ */
+static int vbapTable3D_isConvexHull
+(
+    vbapTable3D_data* h,
+    int* moved
+)
+{
+    int i, j, f, adjacent;
+    double c[3], a[3], ab[3], ac[3], nrm[3], len, dist;
+
+    /* the centroid of the vertices always lies inside their convex hull */
+    c[0] = c[1] = c[2] = 0.0;
+    for(i=0; i<h->L_d; i++)
+        for(j=0; j<3; j++)
+            c[j] += (double)h->vertices[i*3+j]/(double)h->L_d;
+
+    for(f=0; f<h->nHullFaces; f++){
+        for(j=0; j<3; j++){
+            a[j]  = (double)h->vertices[h->hullFaces[f*3+0]*3+j];
+            ab[j] = (double)h->vertices[h->hullFaces[f*3+1]*3+j] - a[j];
+            ac[j] = (double)h->vertices[h->hullFaces[f*3+2]*3+j] - a[j];
         }
+        nrm[0] = ab[1]*ac[2] - ab[2]*ac[1];
+        nrm[1] = ab[2]*ac[0] - ab[0]*ac[2];
+        nrm[2] = ab[0]*ac[1] - ab[1]*ac[0];
+        len = sqrt(nrm[0]*nrm[0] + nrm[1]*nrm[1] + nrm[2]*nrm[2]);
+        if(len < 1e-9)
+            return 0; /* degenerate triangle */
+        if(nrm[0]*(a[0]-c[0]) + nrm[1]*(a[1]-c[1]) + nrm[2]*(a[2]-c[2]) < 0.0)
+            for(j=0; j<3; j++)
+                nrm[j] = -nrm[j];
+
+        /* triangles adjacent to moved vertices are tested against all
+         * vertices, whereas the others only need to be tested against the
+         * moved vertices */
+        adjacent = moved[h->hullFaces[f*3+0]] || moved[h->hullFaces[f*3+1]] || moved[h->hullFaces[f*3+2]];
+        for(i=0; i<h->L_d; i++){
+            if((!adjacent && !moved[i]) || i==h->hullFaces[f*3+0] || i==h->hullFaces[f*3+1] || i==h->hullFaces[f*3+2])
+                continue;
+            dist = 0.0;
+            for(j=0; j<3; j++)
+                dist += nrm[j]*((double)h->vertices[i*3+j]-a[j]);
+            if(dist > 1e-6*len)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+void vbapTable3D_create
+(
+    void** const phVbap,
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread
+)
+{
+    vbapTable3D_createParallel(phVbap, NULL, ls_dirs_deg, L, az_res_deg, el_res_deg, omitLargeTriangles,
+                               enableDummies, spread);
+}
+
+void vbapTable3D_createParallel
+(
+    void** const phVbap,
+    void* const hPar,
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread
+)
+{
+    vbapTable3D_data* h;
+    int i;
+    float fi;
+
+    *phVbap = malloc1d(sizeof(vbapTable3D_data));
+    h = (vbapTable3D_data*)(*phVbap);
+    h->L = L;
+    h->az_res_deg = az_res_deg;
+    h->el_res_deg = el_res_deg;
+    h->omitLargeTriangles = omitLargeTriangles;
+    h->enableDummies = enableDummies;
+    h->spread = spread;
+    h->ls_dirs_deg = NULL;
+    h->vertices = NULL;
+    h->hullFaces = NULL;
+    h->faceValid = NULL;
+    h->faceInvMtx = NULL;
+    h->hFaceGrid = NULL;
+    h->gtableComp = NULL;
+    h->gtableIdx = NULL;
+    h->faceIdx = NULL;
+    h->mdapDirty = 1;
+    h->ls_groups = NULL;
+    h->layoutInvMtx = NULL;
+    h->kernelSpread = -1.0f;
+    h->G_spread = NULL;
+    h->gains = NULL;
+
+    /* source directions for the grid (same as generateVBAPgainTable3D()) */
+    h->N_azi = (int)((360.0f/(float)az_res_deg) + 1.5f);
+    h->N_ele = (int)((180.0f/(float)el_res_deg) + 1.5f);
+    h->N_gtable = h->N_azi*h->N_ele;
+    h->azi = malloc1d(h->N_azi * sizeof(float));
+    h->ele = malloc1d(h->N_ele * sizeof(float));
+    for(fi = -180.0f, i = 0; i<h->N_azi; fi+=(float)az_res_deg, i++)
+        h->azi[i] = fi;
+    for(fi = -90.0f,  i = 0; i<h->N_ele; fi+=(float)el_res_deg, i++)
+        h->ele[i] = fi;
+
+    vbapTable3D_build(h, ls_dirs_deg, hPar);
+}
+
+void vbapTable3D_destroy
+(
+    void** const phVbap
+)
+{
+    vbapTable3D_data* h = (vbapTable3D_data*)(*phVbap);
+
+    if(h!=NULL){
+        free(h->ls_dirs_deg);
+        free1d((void**)&(h->vertices));
+        free1d((void**)&(h->hullFaces));
+        free(h->faceValid);
+        free(h->faceInvMtx);
+        vbap_faceGrid_destroy(&(h->hFaceGrid));
+        free(h->azi);
+        free(h->ele);
+        free1d_large(h->gtableComp);
+        free1d_large(h->gtableIdx);
+        free1d_large(h->faceIdx);
+        free(h->ls_groups);
+        free(h->layoutInvMtx);
+        free(h->G_spread);
+        free(h->gains);
+        free(h);
+        *phVbap = NULL;
+    }
+}
+
+int vbapTable3D_update
+(
+    void* const hVbap,
+    float* ls_dirs_deg,
+    float spread
+)
+{
+    vbapTable3D_data* h = (vbapTable3D_data*)(hVbap);
+    int i, f, n, k, nMoved, nChanged, spreadChanged, limit;
+    int needDummy[2];
+    int* moved, *changedFaces;
+    float u[3], g_tmp[3];
+
+    spreadChanged = spread != h->spread;
+    h->spread = spread;
+
+    /* find the loudspeakers that have moved */
+    moved = calloc1d(h->L_d, sizeof(int));
+    for(i=0, nMoved=0; i<h->L; i++){
+        if(ls_dirs_deg[i*2] != h->ls_dirs_deg[i*2] || ls_dirs_deg[i*2+1] != h->ls_dirs_deg[i*2+1]){
+            moved[i] = 1;
+            nMoved++;
+        }
+    }
+    if(nMoved==0){
+        if(spreadChanged)
+            vbapTable3D_computeAllGains(h, NULL);
+        free(moved);
+        return 1;
+    }
+
+    /* a full rebuild is required if the dummies change, or if the current
+     * triangulation is no longer the convex hull of the layout */
+    vbapTable3D_getNeedDummy(ls_dirs_deg, h->L, h->enableDummies, needDummy);
+    if(needDummy[0]!=h->needDummy[0] || needDummy[1]!=h->needDummy[1] || h->nHullFaces==0){
+        vbapTable3D_build(h, ls_dirs_deg, NULL);
+        free(moved);
+        return 0;
+    }
+    for(i=0; i<h->L; i++){
+        if(moved[i]){
+            h->ls_dirs_deg[i*2] = ls_dirs_deg[i*2];
+            h->ls_dirs_deg[i*2+1] = ls_dirs_deg[i*2+1];
+            lsDir2Cart(&(h->ls_dirs_deg[i*2]), &(h->vertices[i*3]));
+        }
+    }
+    if(!vbapTable3D_isConvexHull(h, moved)){
+        vbapTable3D_build(h, ls_dirs_deg, NULL);
+        free(moved);
+        return 0;
+    }
+
+    /* only the triangles adjacent to the moved loudspeakers need to be
+     * re-validated and re-inverted */
+    changedFaces = malloc1d(h->nHullFaces*sizeof(int));
+    for(f=0, nChanged=0; f<h->nHullFaces; f++){
+        if(moved[h->hullFaces[f*3+0]] || moved[h->hullFaces[f*3+1]] || moved[h->hullFaces[f*3+2]]){
+            h->nTriangles -= h->faceValid[f];
+            h->faceValid[f] = findLsTriplets_isValidFace(h->vertices, &(h->hullFaces[f*3]), h->omitLargeTriangles);
+            h->nTriangles += h->faceValid[f];
+            vbapTable3D_invertFace(h, f);
+            changedFaces[nChanged++] = f;
+        }
+    }
+    vbap_faceGrid_destroy(&(h->hFaceGrid));
+    vbap_faceGrid_create(&(h->hFaceGrid), h->faceInvMtx, h->faceValid, h->nHullFaces);
+    h->mdapDirty = 1;
+
+    /* MDAP gains (or a previously empty table) are recomputed in full */
+    if(h->spread > 0.1f || spreadChanged || h->gtableComp==NULL || h->nTriangles==0)
+        vbapTable3D_computeAllGains(h, NULL);
+    else{
+        /* VBAP uses the first triangle (in hull order) that encloses each
+         * direction. The unchanged triangles before the previously used one
+         * still do not enclose it, so only the changed triangles before it
+         * need to be tested (or all triangles, if the used one changed) */
+        for(n=0; n<h->N_gtable; n++){
+            f = h->faceIdx[n];
+            vbapTable3D_getDir(h, n, u);
+            if(f>=0 && (moved[h->hullFaces[f*3+0]] || moved[h->hullFaces[f*3+1]] || moved[h->hullFaces[f*3+2]]))
+                vbapTable3D_storeGains(h, n, vbapTable3D_findFace(h, u, g_tmp), g_tmp);
+            else{
+                limit = f>=0 ? f : h->nHullFaces;
+                for(k=0; k<nChanged && changedFaces[k]<limit; k++){
+                    if(h->faceValid[changedFaces[k]] && vbapTable3D_testFace(h, changedFaces[k], u, g_tmp)){
+                        vbapTable3D_storeGains(h, n, changedFaces[k], g_tmp);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    free(moved);
+    free(changedFaces);
+    return 1;
+}
+
+void vbapTable3D_getTable
+(
+    void* const hVbap,
+    float** gtableComp,
+    int** gtableIdx,
+    int* nGains,
+    int* N_gtable,
+    int* nTriangles
+)
+{
+    vbapTable3D_data* h = (vbapTable3D_data*)(hVbap);
+
+    (*gtableComp) = h->gtableComp;
+    (*gtableIdx) = h->gtableIdx;
+    (*nGains) = h->nGains;
+    (*N_gtable) = h->N_gtable;
+    (*nTriangles) = h->nTriangles;
+}
+
+int vbapTable3D_getSpreadGains
+(
+    void* const hVbap,
+    int idx,
+    float spread,
+    int maxNumGains,
+    float* gainsComp,
+    int* gainsIdx
+)
+{
+    vbapTable3D_data* h = (vbapTable3D_data*)(hVbap);
+    int j, nG;
+    float src_dir[2], u[3];
+
+    memset(gainsComp, 0, maxNumGains*sizeof(float));
+    memset(gainsIdx, 0, maxNumGains*sizeof(int));
+    if(h->nTriangles==0)
+        return 0;
+
+    /* VBAP gains are simply taken from the table (if it was generated without
+     * spread), otherwise the MDAP gains are computed for this grid direction */
+    if(spread <= 0.1f && h->spread <= 0.1f){
+        nG = MIN(h->nGains, maxNumGains);
+        memcpy(gainsComp, &(h->gtableComp[idx*h->nGains]), nG*sizeof(float));
+        memcpy(gainsIdx, &(h->gtableIdx[idx*h->nGains]), nG*sizeof(int));
+        return nG;
+    }
+    vbapTable3D_prepareSpread(h, spread);
+    src_dir[0] = h->azi[idx%h->N_azi];
+    src_dir[1] = h->ele[idx/h->N_azi];
+    vbapTable3D_getDir(h, idx, u);
+    vbap3D_srcGains(src_dir, u, h->L_d, h->ls_groups, h->nTriangles, spread > 0.1f ? h->spreadKernel : NULL,
+                    h->layoutInvMtx, NULL, h->U_spread, h->G_spread, h->gains);
+    for(j=0, nG=0; j<h->L && nG<maxNumGains; j++){
+        if(h->gains[j]>COMPRESSED_GAIN_THRESHOLD){
+            gainsComp[nG] = h->gains[j];
+            gainsIdx[nG] = j;
+            nG++;
+        }
+    }
+    return nG;
+}
+
+/**
+ * Data structure for the VBAP source tracker; the triangulation is held by a
+ * vbapTable3D_data instance without a gain table
+ */
+typedef struct _vbapTracker3D_data {
+    vbapTable3D_data* h;
+    int* faceAdj;   /**< hull triangle across the edge opposite each vertex (-1: none); FLAT: nHullFaces x 3 */
+    int nSources;
+    int* srcFace;   /**< hull triangle of the last direction of each source (-1: none); nSources x 1 */
+
+}vbapTracker3D_data;
+
+void vbapTracker3D_create
+(
+    void** const phTrk,
+    float* ls_dirs_deg,
+    int L,
+    int omitLargeTriangles,
+    int enableDummies,
+    int nSources
+)
+{
+    vbapTracker3D_data* t;
+    vbapTable3D_data* h;
+    int f, g, k, a, b, nShared, j;
+
+    *phTrk = malloc1d(sizeof(vbapTracker3D_data));
+    t = (vbapTracker3D_data*)(*phTrk);
+    t->h = h = (vbapTable3D_data*)calloc1d(1, sizeof(vbapTable3D_data));
+    h->L = L;
+    h->omitLargeTriangles = omitLargeTriangles;
+    h->enableDummies = enableDummies;
+    h->kernelSpread = -1.0f;
+    vbapTable3D_triangulate(h, ls_dirs_deg);
+
+    /* neighbours of each hull triangle; i.e. the triangle sharing the edge
+     * opposite each of its vertices */
+    t->faceAdj = malloc1d(MAX(h->nHullFaces,1)*3*sizeof(int));
+    for(f=0; f<h->nHullFaces; f++){
+        for(k=0; k<3; k++){
+            a = h->hullFaces[f*3+(k+1)%3];
+            b = h->hullFaces[f*3+(k+2)%3];
+            t->faceAdj[f*3+k] = -1;
+            for(g=0; g<h->nHullFaces && t->faceAdj[f*3+k]<0; g++){
+                if(g==f)
+                    continue;
+                for(j=0, nShared=0; j<3; j++)
+                    nShared += h->hullFaces[g*3+j]==a || h->hullFaces[g*3+j]==b;
+                if(nShared==2)
+                    t->faceAdj[f*3+k] = g;
+            }
+        }
+    }
+
+    t->nSources = nSources;
+    t->srcFace = malloc1d(MAX(nSources,1)*sizeof(int));
+    for(j=0; j<nSources; j++)
+        t->srcFace[j] = -1;
+}
+
+void vbapTracker3D_destroy
+(
+    void** const phTrk
+)
+{
+    vbapTracker3D_data* t = (vbapTracker3D_data*)(*phTrk);
+
+    if(t!=NULL){
+        vbapTable3D_destroy((void**)&(t->h));
+        free(t->faceAdj);
+        free(t->srcFace);
+        free(t);
+        *phTrk = NULL;
+    }
+}
+
+void vbapTracker3D_reset
+(
+    void* const hTrk,
+    int src
+)
+{
+    vbapTracker3D_data* t = (vbapTracker3D_data*)(hTrk);
+    int j;
+
+    for(j=0; j<t->nSources; j++)
+        if(src<0 || j==src)
+            t->srcFace[j] = -1;
+}
+
+int vbapTracker3D_getNumTriangles
+(
+    void* const hTrk
+)
+{
+    vbapTracker3D_data* t = (vbapTracker3D_data*)(hTrk);
+    return t->h->nTriangles;
+}
+
+int vbapTracker3D_getGains
+(
+    void* const hTrk,
+    int src,
+    float azi_deg,
+    float elev_deg,
+    float* gains
+)
+{
+    vbapTracker3D_data* t = (vbapTracker3D_data*)(hTrk);
+    vbapTable3D_data* h = t->h;
+    int j, k, f, step, found, idx;
+    float azi_rad, elev_rad, gains_rms;
+    float u[3], g_tmp[3];
+
+    assert(src>=0 && src<t->nSources);
+    azi_rad  = azi_deg*M_PI/180.0f;
+    elev_rad = elev_deg*M_PI/180.0f;
+    u[0] = cosf(azi_rad)*cosf(elev_rad);
+    u[1] = sinf(azi_rad)*cosf(elev_rad);
+    u[2] = sinf(elev_rad);
+    memset(gains, 0, h->L*sizeof(float));
+
+    /* walk from the previous triangle of this source, across the edge opposite
+     * its most negative gain (i.e. towards the source), until the enclosing
+     * triangle is reached */
+    found = 0;
+    f = t->srcFace[src];
+    for(step=0; f>=0 && h->faceValid[f] && step<VBAP_TRACKER_MAX_NUM_STEPS; step++){
+        utility_sm3vmul(&(h->faceInvMtx[f*9]), u, g_tmp);
+        k = g_tmp[0] < g_tmp[1] ? 0 : 1;
+        k = g_tmp[2] < g_tmp[k] ? 2 : k;
+        if(g_tmp[k] > -0.001f){
+            found = 1;
+            break;
+        }
+        f = t->faceAdj[f*3+k];
+    }
+
+    /* otherwise (e.g. the first direction, a jump, or a gap left by omitted
+     * triangles), fall back to searching the triangles that may enclose it */
+    if(!found)
+        f = h->nTriangles>0 ? vbapTable3D_findFace(h, u, g_tmp) : -1;
+    t->srcFace[src] = f;
+    if(f<0)
+        return 0;
+
+    /* energy normalise (the gains of any dummies are then discarded) */
+    gains_rms = sqrtf(g_tmp[0]*g_tmp[0] + g_tmp[1]*g_tmp[1] + g_tmp[2]*g_tmp[2]);
+    for(j=0; j<3; j++){
+        idx = h->hullFaces[f*3+j];
+        if(idx<h->L)
+            gains[idx] = MAX(g_tmp[j]/gains_rms, 0.0f);
+    }
+    return 1;
+}
+
+/**
+ * Data structure for the 2-D VBAP source tracker
+ */
+typedef struct _vbapTracker2D_data {
+    int L;
+    float* ls_azi_deg;  /**< loudspeaker azimuths in degrees; L x 1 */
+    int* pairs;         /**< loudspeaker pairs, in order of azimuth; FLAT: nPairs x 2 */
+    int nPairs;
+    int nValidPairs;    /**< number of pairs which span less than 180 degrees */
+    int* pairValid;     /**< 1: the pair spans less than 180 degrees, 0: it does not (it is then never used); nPairs x 1 */
+    float* pairInvMtx;  /**< inverted loudspeaker matrix of each pair; FLAT: nPairs x 4 */
+    int nTable;
+    int* tablePair;     /**< pair enclosing each azimuth of the table (-1: none); nTable x 1 */
+    int nSources;
+    int* srcPair;       /**< pair of the last azimuth of each source (-1: none); nSources x 1 */
+
+}vbapTracker2D_data;
+
+/** Returns the (valid) loudspeaker pair enclosing 'u', by testing all pairs;
+ * or -1 if there is none */
+static int vbapTracker2D_findPair
+(
+    vbapTracker2D_data* t,
+    float u[2],
+    float g_tmp[2]
+)
+{
+    int p;
+
+    for(p=0; p<t->nPairs; p++){
+        if(!t->pairValid[p])
+            continue;
+        utility_sm2vmul(&(t->pairInvMtx[p*4]), u, g_tmp);
+        if(MIN(g_tmp[0], g_tmp[1]) > -0.001f)
+            return p;
+    }
+    return -1;
+}
+
+void vbapTracker2D_create
+(
+    void** const phTrk,
+    float* ls_dirs_deg,
+    int L,
+    int nSources
+)
+{
+    vbapTracker2D_data* t;
+    int i, p;
+    float aperture, azi_rad;
+    float u[2], g_tmp[2];
+    float* ls_vertices;
+
+    *phTrk = malloc1d(sizeof(vbapTracker2D_data));
+    t = (vbapTracker2D_data*)(*phTrk);
+    t->L = L;
+    t->ls_azi_deg = malloc1d(MAX(L,1)*sizeof(float));
+    for(i=0; i<L; i++)
+        t->ls_azi_deg[i] = ls_dirs_deg[i*2];
+
+    /* pairs of neighbouring loudspeakers; those spanning 180 degrees or more
+     * (i.e. the gaps of e.g. a stereo or front-only layout) do not enclose
+     * their arc, and are not used */
+    t->pairs = NULL;
+    t->pairInvMtx = NULL;
+    t->nPairs = t->nValidPairs = 0;
+    if(L>=2){
+        findLsPairs(ls_dirs_deg, L, &(t->pairs), &(t->nPairs));
+        ls_vertices = malloc1d(L*2*sizeof(float));
+        for(i=0; i<L; i++){
+            ls_vertices[i*2+0] = cosf(ls_dirs_deg[i*2]*M_PI/180.0f);
+            ls_vertices[i*2+1] = sinf(ls_dirs_deg[i*2]*M_PI/180.0f);
+        }
+        invertLsMtx2D(ls_vertices, t->pairs, t->nPairs, &(t->pairInvMtx));
+        free(ls_vertices);
+    }
+    t->pairValid = malloc1d(MAX(t->nPairs,1)*sizeof(int));
+    for(p=0; p<t->nPairs; p++){
+        aperture = matlab_fmodf(t->ls_azi_deg[t->pairs[p*2+1]] - t->ls_azi_deg[t->pairs[p*2]], 360.0f);
+        t->pairValid[p] = aperture > 0.0f && aperture < 180.0f;
+        t->nValidPairs += t->pairValid[p];
+    }
+
+    /* pair enclosing each azimuth of the table */
+    t->nTable = 360/VBAP_TRACKER_2D_TABLE_RES_DEG;
+    t->tablePair = malloc1d(t->nTable*sizeof(int));
+    for(i=0; i<t->nTable; i++){
+        azi_rad = (float)(i*VBAP_TRACKER_2D_TABLE_RES_DEG)*M_PI/180.0f;
+        u[0] = cosf(azi_rad);
+        u[1] = sinf(azi_rad);
+        t->tablePair[i] = vbapTracker2D_findPair(t, u, g_tmp);
+    }
+
+    t->nSources = nSources;
+    t->srcPair = malloc1d(MAX(nSources,1)*sizeof(int));
+    for(i=0; i<nSources; i++)
+        t->srcPair[i] = -1;
+}
+
+void vbapTracker2D_destroy
+(
+    void** const phTrk
+)
+{
+    vbapTracker2D_data* t = (vbapTracker2D_data*)(*phTrk);
+
+    if(t!=NULL){
+        free(t->ls_azi_deg);
+        free1d((void**)&(t->pairs));
+        free1d((void**)&(t->pairInvMtx));
+        free(t->pairValid);
+        free(t->tablePair);
+        free(t->srcPair);
+        free(t);
+        *phTrk = NULL;
+    }
+}
+
+void vbapTracker2D_reset
+(
+    void* const hTrk,
+    int src
+)
+{
+    vbapTracker2D_data* t = (vbapTracker2D_data*)(hTrk);
+    int j;
+
+    for(j=0; j<t->nSources; j++)
+        if(src<0 || j==src)
+            t->srcPair[j] = -1;
+}
+
+int vbapTracker2D_getNumPairs
+(
+    void* const hTrk
+)
+{
+    vbapTracker2D_data* t = (vbapTracker2D_data*)(hTrk);
+    return t->nValidPairs;
+}
+
+int vbapTracker2D_getGains
+(
+    void* const hTrk,
+    int src,
+    float azi_deg,
+    float* gainsComp,
+    int* gainsIdx
+)
+{
+    vbapTracker2D_data* t = (vbapTracker2D_data*)(hTrk);
+    int j, p, step, found, nearest;
+    float azi_rad, gains_rms, dist, minDist;
+    float u[2], g_tmp[2];
+
+    assert(src>=0 && src<t->nSources);
+    azi_rad = azi_deg*M_PI/180.0f;
+    u[0] = cosf(azi_rad);
+    u[1] = sinf(azi_rad);
+    gainsComp[0] = gainsComp[1] = 0.0f;
+    gainsIdx[0] = gainsIdx[1] = 0;
+
+    /* walk along the ring from the previous pair of this source (or from the
+     * pair of the table, for its first azimuth), past the loudspeaker with the
+     * most negative gain (i.e. towards the source), until the enclosing pair
+     * is reached */
+    found = 0;
+    p = t->srcPair[src];
+    if(p<0 && t->nPairs>0)
+        p = t->tablePair[((int)(matlab_fmodf(azi_deg, 360.0f)/(float)VBAP_TRACKER_2D_TABLE_RES_DEG + 0.5f)) % t->nTable];
+    for(step=0; p>=0 && t->pairValid[p] && step<t->nPairs; step++){
+        utility_sm2vmul(&(t->pairInvMtx[p*4]), u, g_tmp);
+        if(MIN(g_tmp[0], g_tmp[1]) > -0.001f){
+            found = 1;
+            break;
+        }
+        p = g_tmp[0] < g_tmp[1] ? (p+1) % t->nPairs : (p+t->nPairs-1) % t->nPairs;
+    }
+
+    /* otherwise (e.g. the source is in a gap, or it has jumped across one),
+     * fall back to testing all pairs */
+    if(!found)
+        p = t->nPairs>0 ? vbapTracker2D_findPair(t, u, g_tmp) : -1;
+    t->srcPair[src] = p;
+
+    /* with no enclosing pair, the nearest loudspeaker is used */
+    if(p<0){
+        nearest = 0;
+        minDist = 360.0f;
+        for(j=0; j<t->L; j++){
+            dist = fabsf(matlab_fmodf(azi_deg - t->ls_azi_deg[j] + 180.0f, 360.0f) - 180.0f);
+            if(dist<minDist){
+                minDist = dist;
+                nearest = j;
+            }
+        }
+        gainsComp[0] = 1.0f;
+        gainsIdx[0] = nearest;
+        return 1;
+    }
+
+    /* energy normalise */
+    gains_rms = sqrtf(g_tmp[0]*g_tmp[0] + g_tmp[1]*g_tmp[1]);
+    for(j=0; j<2; j++){
+        gainsComp[j] = MAX(g_tmp[j]/gains_rms, 0.0f);
+        gainsIdx[j] = t->pairs[p*2+j];
+    }
+    return 2;
+}
+
+void generateCompressedVBAPgainTable3D
+(
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** gtableComp /* &: N_gtable x nGains */,
+    int** gtableIdx /* &: N_gtable x nGains */,
+    int* nGains,
+    int* N_gtable,
+    int* nTriangles
+)
+{
+    generateCompressedVBAPgainTable3DParallel(NULL, ls_dirs_deg, L, az_res_deg, el_res_deg, omitLargeTriangles,
+                                              enableDummies, spread, gtableComp, gtableIdx, nGains, N_gtable,
+                                              nTriangles);
+}
+
+void generateCompressedVBAPgainTable3DParallel
+(
+    void* const hPar,
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** gtableComp /* &: N_gtable x nGains */,
+    int** gtableIdx /* &: N_gtable x nGains */,
+    int* nGains,
+    int* N_gtable,
+    int* nTriangles
+)
+{
+    void* hVbap;
+    float* tableComp;
+    int* tableIdx;
+    size_t nEntries;
+
+    /* generate the table, and copy it out (the caller frees it with free(),
+     * whereas the handle's tables are large allocations) */
+    vbapTable3D_createParallel(&hVbap, hPar, ls_dirs_deg, L, az_res_deg, el_res_deg, omitLargeTriangles, enableDummies, spread);
+    vbapTable3D_getTable(hVbap, &tableComp, &tableIdx, nGains, N_gtable, nTriangles);
+    (*gtableComp) = NULL;
+    (*gtableIdx) = NULL;
+    if(tableComp!=NULL){
+        nEntries = (size_t)(*N_gtable)*(size_t)(*nGains);
+        (*gtableComp) = malloc1d(nEntries*sizeof(float));
+        (*gtableIdx) = malloc1d(nEntries*sizeof(int));
+        memcpy((*gtableComp), tableComp, nEntries*sizeof(float));
+        memcpy((*gtableIdx), tableIdx, nEntries*sizeof(int));
+    }
+    vbapTable3D_destroy(&hVbap);
+}
+
+int getVBAPgainTableIdx3D
+(
+    float azi_deg,
+    float elev_deg,
+    int az_res_deg,
+    int el_res_deg
+)
+{
+    int N_azi, N_ele, aziIndex, elevIndex;
+
+    N_azi = (int)((360.0f/(float)az_res_deg) + 1.5f);
+    N_ele = (int)((180.0f/(float)el_res_deg) + 1.5f);
+    aziIndex = (int)(matlab_fmodf(azi_deg + 180.0f, 360.0f) / (float)az_res_deg + 0.5f);
+    elevIndex = (int)((elev_deg + 90.0f) / (float)el_res_deg + 0.5f);
+    elevIndex = MIN(MAX(elevIndex, 0), N_ele-1);
+    return elevIndex * N_azi + aziIndex;
+}
+
+void getDBAPgains
+(
+    float* ls_dirs_deg,
+    float* ls_dists_m,
+    int L,
+    float src_azi_deg,
+    float src_elev_deg,
+    float src_dist_m,
+    float rolloff_dB,
+    float blur_m,
+    float* gains
+)
+{
+    int i;
+    float a, r, d2, energy;
+    float src_dir_deg[2], src_xyz[3], ls_xyz[3];
+
+    /* exponent of the inverse distance law */
+    a = rolloff_dB/(20.0f*log10f(2.0f));
+
+    src_dir_deg[0] = src_azi_deg;
+    src_dir_deg[1] = src_elev_deg;
+    lsDir2Cart(src_dir_deg, src_xyz);
+
+    /* gains are proportional to 1/d^a, computed here via the squared distances */
+    energy = 0.0f;
+    for(i=0; i<L; i++){
+        lsDir2Cart(&ls_dirs_deg[i*2], ls_xyz);
+        r = ls_dists_m==NULL ? 1.0f : ls_dists_m[i];
+        d2 = powf(src_dist_m*src_xyz[0] - r*ls_xyz[0], 2.0f) + powf(src_dist_m*src_xyz[1] - r*ls_xyz[1], 2.0f) +
+             powf(src_dist_m*src_xyz[2] - r*ls_xyz[2], 2.0f) + blur_m*blur_m;
+        gains[i] = powf(MAX(d2, 1e-12f), -a/2.0f);
+        energy += gains[i]*gains[i];
     }
-    
-    /* output */
-    (*N_gtable) = N_points;
-    (*nTriangles) = numOutFaces;
-#if ENABLE_VBAP_DEBUGGING_CODE
-    /* save gain table for verification in matlab: */
-    FILE* objfile2 = fopen(SAVE_PATH3, "wt");
-    fprintf(objfile2, "vbap_gtable = [\n");
-    for (i = 0; i < N_points; i++) {
-        for (j = 0; j < L; j++) {
-            fprintf(objfile2, " %f", (*gtable)[i*L+j] );
-            if(j<L-1)
-                fprintf(objfile2,",");
-        }
-        fprintf(objfile2, ";\n");
+
+    /* energy normalisation */
+    energy = 1.0f/sqrtf(energy);
+    utility_svsmul(gains, &energy, L, NULL);
+}
+
+/**
+ * Data structure for a 3-D DBAP gain field
+ *
+ * The grid points are ordered by elevation, then azimuth, then distance, with
+ * the gains of all loudspeakers stored contiguously for each point; such that
+ * the 8 points surrounding a source may be fetched with few cache misses.
+ */
+typedef struct _dbapTable_data {
+    int L;                  /**< number of loudspeakers */
+    int N_azi;              /**< number of azimuths (-180 up to, but excluding, 180) */
+    int N_ele;              /**< number of elevations (-90 up to, and including, 90) */
+    int nDist;              /**< number of distance bins */
+    float az_step_deg;      /**< azimuthal grid spacing, in DEGREES */
+    float el_step_deg;      /**< elevation grid spacing, in DEGREES */
+    float minDist_m;        /**< distance of the nearest bin, in METRES */
+    float dist_step_m;      /**< distance bin spacing, in METRES */
+    float* gfield;          /**< gain field; FLAT: N_ele x N_azi x nDist x L */
+
+}dbapTable_data;
+
+void dbapTable_create
+(
+    void** const phDbap,
+    float* ls_dirs_deg,
+    float* ls_dists_m,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    float minDist_m,
+    float maxDist_m,
+    int nDistBins,
+    float rolloff_dB,
+    float blur_m
+)
+{
+    dbapTable_data* h;
+    int ie, ia, id;
+
+    assert(nDistBins>=2 && maxDist_m>minDist_m);
+    *phDbap = malloc1d(sizeof(dbapTable_data));
+    h = (dbapTable_data*)(*phDbap);
+    h->L = L;
+    h->N_azi = MAX((int)ceilf(360.0f/(float)az_res_deg - 0.001f), 1);
+    h->N_ele = MAX((int)ceilf(180.0f/(float)el_res_deg - 0.001f), 1) + 1;
+    h->nDist = nDistBins;
+    h->az_step_deg = 360.0f/(float)h->N_azi;
+    h->el_step_deg = 180.0f/(float)(h->N_ele-1);
+    h->minDist_m = minDist_m;
+    h->dist_step_m = (maxDist_m-minDist_m)/(float)(nDistBins-1);
+    h->gfield = malloc1d(h->N_ele*h->N_azi*h->nDist*L*sizeof(float));
+
+    for(ie=0; ie<h->N_ele; ie++)
+        for(ia=0; ia<h->N_azi; ia++)
+            for(id=0; id<h->nDist; id++)
+                getDBAPgains(ls_dirs_deg, ls_dists_m, L, -180.0f + (float)ia*h->az_step_deg,
+                             -90.0f + (float)ie*h->el_step_deg, minDist_m + (float)id*h->dist_step_m,
+                             rolloff_dB, blur_m, &(h->gfield[((ie*h->N_azi+ia)*h->nDist+id)*L]));
+}
+
+void dbapTable_destroy
+(
+    void** const phDbap
+)
+{
+    dbapTable_data* h = (dbapTable_data*)(*phDbap);
+
+    if(h!=NULL){
+        free(h->gfield);
+        free(h);
+        *phDbap = NULL;
     }
-    fprintf(objfile2, "];\n\n\n");
-    fclose(objfile2);
-#endif
-    
-    /* clean up */
-    free1d((void**)&(out_vertices));
-    free1d((void**)&(out_faces));
-    free1d((void**)&(layoutInvMtx));
-    free(azi);
-    free(ele);
+}
+
+void dbapTable_getGains
+(
+    void* const hDbap,
+    float azi_deg,
+    float elev_deg,
+    float dist_m,
+    float* gains
+)
+{
+    dbapTable_data* h = (dbapTable_data*)(hDbap);
+    int i, j, L, ia[2], ie[2], id[2];
+    float fa, fe, fd, w, energy;
+    float* g;
+
+    L = h->L;
+
+    /* fractional grid indices; azimuth wraps around, elevation/distance are clamped */
+    fa = matlab_fmodf(azi_deg + 180.0f, 360.0f)/h->az_step_deg;
+    ia[0] = MIN((int)fa, h->N_azi-1);
+    fa -= (float)ia[0];
+    ia[1] = (ia[0]+1) % h->N_azi;
+    fe = MIN(MAX((elev_deg + 90.0f)/h->el_step_deg, 0.0f), (float)(h->N_ele-1));
+    ie[0] = MIN((int)fe, h->N_ele-2);
+    fe -= (float)ie[0];
+    ie[1] = ie[0]+1;
+    fd = MIN(MAX((dist_m - h->minDist_m)/h->dist_step_m, 0.0f), (float)(h->nDist-1));
+    id[0] = MIN((int)fd, h->nDist-2);
+    fd -= (float)id[0];
+    id[1] = id[0]+1;
+
+    /* weighted sum of the 8 surrounding grid points */
+    memset(gains, 0, L*sizeof(float));
+    for(j=0; j<8; j++){
+        w = (j&1 ? fd : 1.0f-fd) * (j&2 ? fa : 1.0f-fa) * (j&4 ? fe : 1.0f-fe);
+        if(w==0.0f)
+            continue;
+        g = &(h->gfield[((ie[(j>>2)&1]*h->N_azi + ia[(j>>1)&1])*h->nDist + id[j&1])*L]);
+        for(i=0; i<L; i++)
+            gains[i] += w*g[i];
+    }
+
+    /* the interpolated gains are re-normalised to be energy preserving */
+    energy = 0.0f;
+    for(i=0; i<L; i++)
+        energy += gains[i]*gains[i];
+    energy = 1.0f/sqrtf(MAX(energy, 1e-12f));
+    utility_svsmul(gains, &energy, L, NULL);
 }
 
 void compressVBAPgainTable3D
@@ -368,8 +2020,9 @@ void VBAPgainTable2InterpTable
         for(j=0; j<nDirs; j++)
             gains_sum[i] += vbap_gtable[i*nDirs+j];
     for(i=0; i<nTable; i++)
-        for(j=0; j<nDirs; j++)
-            vbap_gtable[i*nDirs+j] /= gains_sum[i];
+        if(gains_sum[i] > 0.0f) /* directions without any gains are left as zeros */
+            for(j=0; j<nDirs; j++)
+                vbap_gtable[i*nDirs+j] /= gains_sum[i];
     
     free(gains_sum);
 }
@@ -387,7 +2040,7 @@ void generateVBAPgainTable2D_srcs
 {
     int i, N_points, numOutPairs;
     int* out_pairs;
-    float *layoutInvMtx, *ls_vertices;
+    float *src_azi_deg, *layoutInvMtx, *ls_vertices;
     
     out_pairs = NULL;
     findLsPairs(ls_dirs_deg, L, &out_pairs, &numOutPairs);
@@ -401,12 +2054,16 @@ void generateVBAPgainTable2D_srcs
     layoutInvMtx = NULL;
     invertLsMtx2D(ls_vertices, out_pairs, numOutPairs, &layoutInvMtx);
     
-    /* Calculate VBAP gains for each source position */
+    /* Calculate VBAP gains for each source position (vbap2D() takes only the azimuths) */
     N_points = S;
-    vbap2D(src_dirs_deg, N_points, L, out_pairs, numOutPairs, layoutInvMtx,  gtable);
+    src_azi_deg = malloc1d(S*sizeof(float));
+    for(i=0; i<S; i++)
+        src_azi_deg[i] = src_dirs_deg[i*2];
+    vbap2D(src_azi_deg, N_points, L, out_pairs, numOutPairs, layoutInvMtx,  gtable);
     (*nPairs) = numOutPairs;
     (*N_gtable) = N_points;
     
+    free(src_azi_deg);
     free(ls_vertices);
     free1d((void**)&(out_pairs));
     free1d((void**)&(layoutInvMtx));
@@ -490,180 +2147,37 @@ void findLsTriplets
     int* numOutFaces
 )
 {
-    int i, j, k, numValidFaces, minIntVal, minIdx, nFaces;
-    int tmp3[3], circface[3];
-    int* validFacesID, *valid_faces, *valid_faces2, *faces;
-    float dotcc, aperture_lim;
-    float vecs[3][3], cvec[3], centroid[3], a[3], b[3], abc[3];
-    CH_FLOAT  rcoselev;
-    ch_vertex* vertices;
+    int i, numValidFaces, nFaces;
+    int* faces, *validFacesID;
 
     /* Build the convex hull for the points on the sphere - in this special case the
        result equals the Delaunay triangulation of the points */
-    vertices = malloc1d(L*sizeof(ch_vertex));
     (*numOutVertices)  = L;
-    (*out_vertices) = (float*)malloc1d(L*3*sizeof(float));
-    for ( i = 0; i < L; i++) {
-        (*out_vertices)[i*3+2] = (float)((CH_FLOAT)sin((double)ls_dirs_deg[i*2+1]*M_PI/180.0));
-        rcoselev = (CH_FLOAT)cos((double)ls_dirs_deg[i*2+1]*M_PI/180.0);
-        (*out_vertices)[i*3+0] = (float)(rcoselev * (CH_FLOAT)cos((double)ls_dirs_deg[i*2+0]*M_PI/180.0));
-        (*out_vertices)[i*3+1] = (float)(rcoselev * (CH_FLOAT)sin((double)ls_dirs_deg[i*2+0]*M_PI/180.0));
-        vertices[i].x = (*out_vertices)[i*3+0];
-        vertices[i].y = (*out_vertices)[i*3+1];
-        vertices[i].z = (*out_vertices)[i*3+2];
-    }
-    faces = NULL;
-    convhull_3d_build(vertices, L, &faces, &nFaces);
-#ifndef NDEBUG
-    if(faces==NULL)
-        saf_error_print(SAF_ERROR__FAILED_TO_BUILD_CONVEX_HULL);
-#endif
-
-    /* circularily shift the indices to start from lowest value */
-    for(i=0; i<nFaces; i++){
-        minIntVal = L;
-        minIdx = 0;
-        for(j=0; j<3; j++){
-            if (faces[i*3+j] < minIntVal){
-                minIntVal = faces[i*3+j];
-                minIdx=j;
-            }
-        }
-        for(j=minIdx, k=0; j<minIdx+3; j++, k++)
-            circface[k] = faces[i*3+(j % 3)];
-        for(j=0; j<3; j++)
-            faces[i*3+j] = circface[j];
-    }
-
-    /* sort indices in accending order for the first dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if (faces[(i+1)*3+0] < faces[i*3+0])  {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
-    }
-
-    /* sort indices in accending order for the second dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if ( (faces[(i+1)*3+1] < faces[i*3+1]) && (faces[(i+1)*3+0] == faces[i*3+0]) ) {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
-    }
-#if 0
-    /* sort indices in accending order for the third dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if ( (faces[(i+1)*3+2] < faces[i*3+2]) && (faces[(i+1)*3+0] == faces[i*3+0]) && (faces[(i+1)*3+1] == faces[i*3+1])) {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
-    }
-#endif
+    findLsTriplets_hull(ls_dirs_deg, L, out_vertices, &faces, &nFaces);
 
-    /* Omit triplets if their normals and the centroid to the triplets have an angle larger than pi/2 */
+    /* Omit triplets if their normals and the centroid to the triplets have an
+     * angle larger than pi/2, and (optionally) triangles that have an aperture
+     * larger than APERTURE_LIMIT_DEG */
     numValidFaces = 0;
     validFacesID = malloc1d(nFaces*sizeof(int));
     for(i=0; i<nFaces; i++){
-        for(j=0; j<3; j++){
-            vecs[0][j] = (*out_vertices)[faces[i*3+0]*3+j];
-            vecs[1][j] = (*out_vertices)[faces[i*3+1]*3+j];
-            vecs[2][j] = (*out_vertices)[faces[i*3+2]*3+j];
-        }
-        for(j=0; j<3; j++){
-            a[j] = vecs[1][j]-vecs[0][j];
-            b[j] = vecs[2][j]-vecs[1][j];
-        }
-        ccross(a, b, cvec);
-        for(j=0; j<3; j++)
-            centroid[j] = (vecs[0][j] + vecs[1][j] + vecs[2][j])/3.0f;
-        dotcc = cvec[0] * centroid[0] + cvec[1] * centroid[1] + cvec[2] * centroid[2];
-        if(acosf(MAX(MIN(dotcc,0.99999999f),-0.99999999f)/* avoids complex numbers */)<(M_PI/2.0f)){
-            validFacesID[i] = 1;
-            numValidFaces++;
-        }
-        else{
-            validFacesID[i] = 0;
-        }
-    }
-    valid_faces = malloc1d(numValidFaces*3*sizeof(int));
-    for(i=0, j=0; i<nFaces; i++){
-        if(validFacesID[i]==1){
-            valid_faces[j*3+0] = faces[i*3+0];
-            valid_faces[j*3+1] = faces[i*3+1];
-            valid_faces[j*3+2] = faces[i*3+2];
-            j++;
-        }
-    }
-    free(validFacesID);
-
-    /* Omit Triangules that have an aperture larger than APERTURE_LIMIT_DEG */
-    valid_faces2 = NULL;
-    if(omitLargeTriangles) {
-        aperture_lim = APERTURE_LIMIT_DEG * M_PI/180.0f;
-        nFaces = numValidFaces;
-        numValidFaces = 0;
-        validFacesID = malloc1d(nFaces*sizeof(int));
-        for(i=0; i<nFaces; i++){
-            for(j=0; j<3; j++){
-                vecs[0][j] = (*out_vertices)[valid_faces[i*3+0]*3+j];
-                vecs[1][j] = (*out_vertices)[valid_faces[i*3+1]*3+j];
-                vecs[2][j] = (*out_vertices)[valid_faces[i*3+2]*3+j];
-            }
-            dotcc = vecs[0][0] * vecs[1][0] + vecs[0][1] * vecs[1][1] + vecs[0][2] * vecs[1][2];
-            abc[0] = acosf(dotcc);
-            dotcc = vecs[1][0] * vecs[2][0] + vecs[1][1] * vecs[2][1] + vecs[1][2] * vecs[2][2];
-            abc[1] = acosf(dotcc);
-            dotcc = vecs[2][0] * vecs[0][0] + vecs[2][1] * vecs[0][1] + vecs[2][2] * vecs[0][2];
-            abc[2] = acosf(dotcc);
-            if(abc[0]<aperture_lim && abc[1]<aperture_lim && abc[2]<aperture_lim){
-                validFacesID[i] = 1;
-                numValidFaces++;
-            }
-            else{
-                validFacesID[i] = 0;
-            }
-        }
-        valid_faces2 = malloc1d(numValidFaces*3*sizeof(int));
-        for(i=0, j=0; i<nFaces; i++){
-            if(validFacesID[i]==1){
-                valid_faces2[j*3+0] = valid_faces[i*3+0];
-                valid_faces2[j*3+1] = valid_faces[i*3+1];
-                valid_faces2[j*3+2] = valid_faces[i*3+2];
-                j++;
-            }
-        }
-        free(validFacesID);
+        validFacesID[i] = findLsTriplets_isValidFace((*out_vertices), &faces[i*3], omitLargeTriangles);
+        numValidFaces += validFacesID[i];
     }
 
     /* output valid faces */
     (*numOutFaces) = numValidFaces;
     (*out_faces) = (int*)malloc1d(numValidFaces*3*sizeof(int));
-    if(omitLargeTriangles)
-        memcpy((*out_faces), valid_faces2, numValidFaces*3*sizeof(int));
-    else
-        memcpy((*out_faces), valid_faces, numValidFaces*3*sizeof(int));
+    for(i=0, numValidFaces=0; i<nFaces; i++){
+        if(validFacesID[i]){
+            memcpy(&(*out_faces)[numValidFaces*3], &faces[i*3], 3*sizeof(int));
+            numValidFaces++;
+        }
+    }
 
     /* clean-up */
     free1d((void**)&(faces));
-    free(vertices);
-    free(valid_faces);
-    if(omitLargeTriangles)
-        free(valid_faces2);
+    free(validFacesID);
 }
 
 void invertLsMtx3D
@@ -675,13 +2189,7 @@ void invertLsMtx3D
 )
 {
     int i, j, n;
-    float* tempGroup;
-    float tempInv[9], eye3[9];
-
-    for(i=0; i<3; i++)
-        for(j=0; j<3; j++)
-            eye3[i*3+j] = i==j ? 1.0f : 0.0f;
-    tempGroup = malloc1d(9* sizeof(float));
+    float tempGroup[9], tempInv[9];
 
     /* pre-calculate inversions of the loudspeaker groups and store into matrix */
     (*layoutInvMtx) = malloc1d(N_group * 9 * sizeof(float));
@@ -692,18 +2200,13 @@ void invertLsMtx3D
                 tempGroup[i*3+j] = U_spkr[ls_groups[n*3+i]*3 + j];
 
         /* get inverse of current group */
-        utility_sinv(tempGroup,3);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 3, 3, 3, 1.0,
-                    eye3, 3,
-                    tempGroup, 3, 0.0,
-                    tempInv, 3);
+        utility_sm3inv(tempGroup, tempInv);
 
-        /* store the vectorized inverse as a row the output */
+        /* store the vectorized (transposed) inverse as a row the output */
         for(i=0; i<3; i++)
             for(j=0; j<3; j++)
                 (*layoutInvMtx)[n*9+(i*3+j)] = tempInv[j*3+i];
     }
-    free(tempGroup);
 }
 
 void getSpreadSrcDirs3D
@@ -716,77 +2219,147 @@ void getSpreadSrcDirs3D
     float* U_spread
 )
 {
-    int i, j, ns, nr;
-    float theta, sin_theta, cos_theta, scale, spread_rad, ring_rad, U_spread_norm;
-    float u[3], u_x_u[3][3], u_x[3][3], R_theta[3][3], uu2[3], spreadbase_ns[3];
-    float* spreadbase;
+    float* spreadKernel;
+
+    spreadKernel = malloc1d(num_rings_3d*num_src*3*sizeof(float));
+    getSpreadKernel3D(spread, num_src, num_rings_3d, spreadKernel);
+    applySpreadKernel3D(src_azi_rad, src_elev_rad, spreadKernel, num_rings_3d*num_src, U_spread);
+    free(spreadKernel);
+}
+
+void getSpreadKernel3D
+(
+    float spread,
+    int num_src,
+    int num_rings_3d,
+    float* spreadKernel
+)
+{
+    int ns, nr;
+    float theta, spread_rad, ring_rad, tan_ring;
+
+    /* each auxiliary source lies at angle ns*theta around the source, on a
+     * ring that is squeezed to the desired spread */
+    theta = 2.0f*M_PI/(float)num_src;
+    spread_rad = (spread/2.0f)*M_PI/180.0f;
+    ring_rad = spread_rad/(float)num_rings_3d;
+    for(nr=0; nr<num_rings_3d; nr++){
+        tan_ring = tanf(ring_rad*(float)(nr+1));
+        for (ns = 0; ns<num_src; ns++){
+            spreadKernel[(nr*num_src + ns)*3 + 0] = tan_ring;
+            spreadKernel[(nr*num_src + ns)*3 + 1] = cosf(theta*(float)ns);
+            spreadKernel[(nr*num_src + ns)*3 + 2] = sinf(theta*(float)ns);
+        }
+    }
+}
+
+void applySpreadKernel3D
+(
+    float src_azi_rad,
+    float src_elev_rad,
+    float* spreadKernel,
+    int nDirs,
+    float* U_spread
+)
+{
+    int i, n;
+    float scale, u_dot_b, U_spread_norm, tan_ring, cos_ns, sin_ns;
+    float u[3], uu2[3], b[3], u_x_b[3];
 
-    /* rotation matrix using the axis of rotation-angle definition (around source direction) */
+    /* source direction */
     u[0] = cosf(src_elev_rad) * cosf(src_azi_rad);
     u[1] = cosf(src_elev_rad) * sinf(src_azi_rad);
     u[2] = sinf(src_elev_rad);
-    u_x_u[0][0] = powf(u[0],2.0f); u_x_u[0][1] = u[0]*u[1]; u_x_u[0][2] = u[0]*u[2];
-    u_x_u[1][0] = u[0]*u[1]; u_x_u[1][1] = powf(u[1],2.0f); u_x_u[1][2] = u[1]*u[2];
-    u_x_u[2][0] = u[0]*u[2]; u_x_u[2][1] = u[1]*u[2]; u_x_u[2][2] = powf(u[2],2.0f);
-    u_x[0][0] = 0.0f; u_x[0][1] = -u[2]; u_x[0][2] = u[1];
-    u_x[1][0] = u[2]; u_x[1][1] = 0.0f; u_x[1][2] = -u[0];
-    u_x[2][0] = -u[1]; u_x[2][1] = u[0]; u_x[2][2] = 0.0f;
-    theta = 2.0f*M_PI/(float)num_src;
-    sin_theta = sinf(theta);
-    cos_theta = cosf(theta);
-    for(i=0; i<3; i++)
-        for(j=0; j<3; j++)
-            R_theta[i][j] = sin_theta*u_x[i][j] + (1.0f-cos_theta)*u_x_u[i][j] + (i==j ? cos_theta : 0.0f);
 
-    /*  create a ring of sources on the plane that is purpendicular to the source directions */
-    spreadbase = calloc1d(num_src*3, sizeof(float));
-    if ((src_elev_rad > M_PI/2.0f-0.01f ) || (src_elev_rad<-(M_PI/2.0f-0.01f)))
-        spreadbase[0] = 1.0f;
+    /* first vector of the ring, on the plane that is purpendicular to the
+     * source direction (except near the poles) */
+    if ((src_elev_rad > M_PI/2.0f-0.01f ) || (src_elev_rad<-(M_PI/2.0f-0.01f))){
+        b[0] = 1.0f;
+        b[1] = b[2] = 0.0f;
+    }
     else{
         const float u2[3] = {0.0f, 0.0f, 1.0f};
         ccross(u, (float*)u2, uu2);
-        scale = 0.0f;
-        for(i=0; i<3; i++)
-            scale += powf(uu2[i],2.0f);
-        scale = sqrtf(scale);
+        scale = sqrtf(uu2[0]*uu2[0] + uu2[1]*uu2[1] + uu2[2]*uu2[2]);
         for(i=0; i<3; i++)
-            spreadbase[i] = uu2[i]/scale;
+            b[i] = uu2[i]/scale;
     }
+    ccross(u, b, u_x_b);
+    u_dot_b = u[0]*b[0] + u[1]*b[1] + u[2]*b[2];
 
-    /* get ring of directions by rotating the first vector around the source */
-    for (ns = 1; ns<num_src; ns++){
+    /* rotating the first vector around the source by angle ns*theta gives
+     * (Rodrigues' formula):
+     *   cos(ns*theta) b + sin(ns*theta) (u x b) + (1-cos(ns*theta)) (u.b) u
+     * which is then added to the source direction, scaled by tan(ring_rad).
+     * All vectors are normalised based on the first vector */
+    tan_ring = spreadKernel[0];
+    U_spread_norm = sqrtf(1.0f + 2.0f*tan_ring*u_dot_b + tan_ring*tan_ring);
+    for(n=0; n<nDirs; n++){
+        tan_ring = spreadKernel[n*3+0];
+        cos_ns = spreadKernel[n*3+1];
+        sin_ns = spreadKernel[n*3+2];
         for(i=0; i<3; i++)
-            spreadbase_ns[i] = spreadbase[(ns-1)*3+i];
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 3, 1, 3, 1.0f,
-                    (const float*)R_theta, 3,
-                    spreadbase_ns, 1, 0.0f,
-                    &spreadbase[ns*3], 1);
+            U_spread[n*3+i] = ((1.0f + tan_ring*(1.0f-cos_ns)*u_dot_b)*u[i] + tan_ring*cos_ns*b[i] + tan_ring*sin_ns*u_x_b[i])/U_spread_norm;
     }
 
-    /* squeeze the perpendicular ring to the desired spread */
-    spread_rad = (spread/2.0f)*M_PI/180.0f;
-    ring_rad = spread_rad/(float)num_rings_3d;
-    memset(U_spread, 0, num_rings_3d*num_src*3*sizeof(float));
-    for(nr=0; nr<num_rings_3d; nr++)
-        for (ns = 0; ns<num_src; ns++)
-            for(i=0; i<3; i++)
-                U_spread[(nr*num_src + ns)*3 + i] = u[i] + spreadbase[ns*3+i]*tanf(ring_rad*(float)(nr+1));
-
-    /* normalise vectors to unity (based on first vector) */
-    U_spread_norm = sqrtf(powf(U_spread[0],2.0f) + powf(U_spread[1],2.0f) + powf(U_spread[2],2.0f));
-    for(i=0; i<num_rings_3d*num_src*3; i++)
-        U_spread[i] /= U_spread_norm;
-
     /* append the original source direction at the end */
     for(i=0; i<3; i++)
-        U_spread[(num_rings_3d*num_src)*3 + i] = u[i];
+        U_spread[nDirs*3 + i] = u[i];
+}
 
-    free(spreadbase);
+void vbap3D
+(
+    float* src_dirs,
+    int src_num,
+    int ls_num,
+    int* ls_groups,
+    int nFaces,
+    float spread,
+    float* layoutInvMtx,
+    float** GainMtx
+)
+{
+    vbap3DParallel(NULL, src_dirs, src_num, ls_num, ls_groups, nFaces, spread, layoutInvMtx, GainMtx);
 }
 
+/** Shared (read-only) arguments of vbap3D_range() */
+typedef struct _vbap3D_job {
+    float* src_dirs, *src_xyz;
+    int ls_num, nFaces;
+    int* ls_groups;
+    float* spreadKernel, *layoutInvMtx;
+    void* hFaceGrid;
+    float* U_spread;    /**< scratch per thread; FLAT: nThreads x (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*3 */
+    float* G_spread;    /**< scratch per thread; FLAT: nThreads x (MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1)*nFaces*3 */
+    float* GainMtx;
 
-void vbap3D
+}vbap3D_job;
+
+/** vbap3D() for the sources first..last-1 (see saf_parfor_func) */
+static void vbap3D_range
+(
+    void* const hCtx,
+    int threadIndex,
+    int first,
+    int last
+)
+{
+    vbap3D_job* job = (vbap3D_job*)hCtx;
+    int ns, nSpr;
+    float* U_spread, *G_spread;
+
+    nSpr = MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1;
+    U_spread = job->spreadKernel==NULL ? NULL : &(job->U_spread[threadIndex*nSpr*3]);
+    G_spread = job->spreadKernel==NULL ? NULL : &(job->G_spread[threadIndex*nSpr*(job->nFaces)*3]);
+    for(ns=first; ns<last; ns++)
+        vbap3D_srcGains(&(job->src_dirs[ns*2]), job->src_xyz==NULL ? NULL : &(job->src_xyz[ns*3]), job->ls_num,
+                        job->ls_groups, job->nFaces, job->spreadKernel, job->layoutInvMtx, job->hFaceGrid,
+                        U_spread, G_spread, &(job->GainMtx[ns*(job->ls_num)]));
+}
+
+void vbap3DParallel
 (
+    void* const hPar,
     float* src_dirs,
     int src_num,
     int ls_num,
@@ -797,104 +2370,45 @@ void vbap3D
     float** GainMtx
 )
 {
-    int i, j, ns, nspr;
-    float azi_rad, elev_rad, min_val, g_tmp_rms, gains_rms;
-    float u[3], g_tmp[3], ls_invMtx_s[3];
-    float* gains;
+    int nThreads, nSpr;
+    vbap3D_job job;
 
     (*GainMtx) = malloc1d(src_num*ls_num*sizeof(float));
-    gains = malloc1d(ls_num*sizeof(float));
-
-    /* MDAP (with spread) */
-    if (spread > 0.1f) {
-        const int nSpreadSrcs = 8;
-        const int nRings = 1;
-        float* U_spread;
-        U_spread = malloc1d((nRings*nSpreadSrcs+1)*3*sizeof(float));
-        for(ns=0; ns<src_num; ns++){
-            azi_rad  = src_dirs[ns*2+0]*M_PI/180.0f;
-            elev_rad = src_dirs[ns*2+1]*M_PI/180.0f;
-            getSpreadSrcDirs3D(azi_rad, elev_rad, spread, nSpreadSrcs, nRings, U_spread);
-            memset(gains, 0, ls_num*sizeof(float));
-            for(nspr=0; nspr<(nRings*nSpreadSrcs+1); nspr++){
-                u[0] = U_spread[nspr*3+0];
-                u[1] = U_spread[nspr*3+1];
-                u[2] = U_spread[nspr*3+2];
-                for(i=0; i<nFaces; i++){
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[0]);
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j+3];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[1]);
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j+6];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[2]);
-                    min_val = 2.23e13f;
-                    g_tmp_rms = 0.0;
-                    for(j=0; j<3; j++){
-                        min_val = MIN(min_val, g_tmp[j]);
-                        g_tmp_rms +=  powf(g_tmp[j], 2.0f);
-                    }
-                    g_tmp_rms = sqrtf(g_tmp_rms);
-                    if(min_val>-0.001){
-                        for(j=0; j<3; j++)
-                            gains[ls_groups[i*3+j]] += g_tmp[j]/g_tmp_rms;
-                    }
-                }
-            }
-            gains_rms = 0.0;
-            for(i=0; i<ls_num; i++)
-                gains_rms += powf(gains[i], 2.0f);
-            gains_rms = sqrtf(gains_rms);
-            for(i=0; i<ls_num; i++)
-                (*GainMtx)[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
-        }
+    nThreads = saf_parfor_getNumThreads(hPar);
+    nSpr = MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS+1;
+    job.src_dirs = src_dirs;
+    job.ls_num = ls_num;
+    job.ls_groups = ls_groups;
+    job.nFaces = nFaces;
+    job.layoutInvMtx = layoutInvMtx;
+    job.GainMtx = *GainMtx;
 
-        free(U_spread);
+    /* the spread directions are the same for all sources, relative to each
+     * source direction, and so are only computed once */
+    job.spreadKernel = job.U_spread = job.G_spread = job.src_xyz = NULL;
+    job.hFaceGrid = NULL;
+    if(spread > 0.1f){
+        job.spreadKernel = malloc1d(MDAP_NUM_RINGS*MDAP_NUM_SPREAD_SRCS*3*sizeof(float));
+        job.U_spread = malloc1d(nThreads*nSpr*3*sizeof(float));
+        job.G_spread = malloc1d(nThreads*nSpr*nFaces*3*sizeof(float));
+        getSpreadKernel3D(spread, MDAP_NUM_SPREAD_SRCS, MDAP_NUM_RINGS, job.spreadKernel);
     }
-    /* VBAP (no spread) */
+    /* whereas, without spread, all of the source directions are converted into
+     * unit vectors in one go, and the triangles that may enclose each one are
+     * looked up in a face grid (rather than testing all of them) */
     else{
-        for(ns=0; ns<src_num; ns++){
-            azi_rad  = src_dirs[ns*2+0]*M_PI/180.0f;
-            elev_rad = src_dirs[ns*2+1]*M_PI/180.0f;
-            u[0] = cosf(azi_rad)*cosf(elev_rad);
-            u[1] = sinf(azi_rad)*cosf(elev_rad);
-            u[2] = sinf(elev_rad);
-            memset(gains, 0, ls_num*sizeof(float));
-            for(i=0; i<nFaces; i++){
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[0]);
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j+3];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[1]);
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j+6];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[2]);
-                min_val = 2.23e13f;
-                g_tmp_rms = 0.0;
-                for(j=0; j<3; j++){
-                    min_val = MIN(min_val, g_tmp[j]);
-                    g_tmp_rms +=  powf(g_tmp[j], 2.0f);
-                }
-                g_tmp_rms = sqrtf(g_tmp_rms);
-                if(min_val>-0.001){
-                    for(j=0; j<3; j++)
-                        gains[ls_groups[i*3+j]] = g_tmp[j]/g_tmp_rms;
-                    break;
-                }
-            }
-            gains_rms = 0.0;
-            for(i=0; i<ls_num; i++)
-                gains_rms += powf(gains[i], 2.0f);
-            gains_rms = sqrtf(gains_rms);
-            for(i=0; i<ls_num; i++)
-                (*GainMtx)[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
-        }
+        job.src_xyz = malloc1d(src_num*3*sizeof(float));
+        vbap_srcDirs2Cart(src_dirs, src_num, job.src_xyz);
+        if(src_num >= VBAP_FACE_GRID_MIN_NUM_DIRS)
+            vbap_faceGrid_create(&(job.hFaceGrid), layoutInvMtx, NULL, nFaces);
     }
+    saf_parfor_run(hPar, &vbap3D_range, (void*)&job, src_num);
 
-    free(gains);
+    vbap_faceGrid_destroy(&(job.hFaceGrid));
+    free(job.src_xyz);
+    free(job.spreadKernel);
+    free(job.U_spread);
+    free(job.G_spread);
 }
 
 void findLsPairs
@@ -938,13 +2452,7 @@ void invertLsMtx2D
 )
 {
     int i, j, n;
-    float* tempGroup;
-    float tempInv[4], eye2[4];
-
-    for(i=0; i<2; i++)
-        for(j=0; j<2; j++)
-            eye2[i*2+j] = i==j ? 1.0f : 0.0f;
-    tempGroup = malloc1d(4* sizeof(float));
+    float tempGroup[4], tempInv[4];
 
     /* pre-calculate inversions of the loudspeaker groups and store into matrix */
     (*layoutInvMtx) = malloc1d(N_pairs * 4 * sizeof(float));
@@ -955,19 +2463,13 @@ void invertLsMtx2D
                 tempGroup[i*2+j] = U_spkr[ls_pairs[n*2+i]*2 + j];
 
         /* get inverse of current group */
-        utility_sinv(tempGroup,2);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, 2, 2, 1.0,
-                    eye2, 2,
-                    tempGroup, 2, 0.0,
-                    tempInv, 2);
+        utility_sm2inv(tempGroup, tempInv);
 
-        /* store the vectorized inverse as a row the output */
+        /* store the vectorized (transposed) inverse as a row the output */
         for(i=0; i<2; i++)
             for(j=0; j<2; j++)
                 (*layoutInvMtx)[n*4+(i*2+j)] = tempInv[j*2+i];
     }
-
-    free(tempGroup);
 }
 
 void vbap2D
@@ -983,7 +2485,7 @@ void vbap2D
 {
     int i, j, ns;
     float azi_rad, min_val, g_tmp_rms, gains_rms;
-    float u[2], g_tmp[2], ls_invMtx_s[2];
+    float u[2], g_tmp[2];
     float* gains;
 
     (*GainMtx) = malloc1d(src_num*ls_num*sizeof(float));
@@ -994,18 +2496,7 @@ void vbap2D
         u[1] = sinf(azi_rad);
         memset(gains, 0, ls_num*sizeof(float));
         for(i=0; i<N_pairs; i++){
-            for(j=0; j<2; j++)
-                ls_invMtx_s[j] = layoutInvMtx[i*4+j];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 2, 1.0,
-                        ls_invMtx_s, 2,
-                        u, 2, 0.0,
-                        &g_tmp[0], 1);
-            for(j=0; j<2; j++)
-                ls_invMtx_s[j] = layoutInvMtx[i*4+j+2];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 2, 1.0,
-                        ls_invMtx_s, 2,
-                        u, 2, 0.0,
-                        &g_tmp[1], 1);
+            utility_sm2vmul(&layoutInvMtx[i*4], u, g_tmp);
             min_val = 2.23e13f;
             g_tmp_rms = 0.0;
             for(j=0; j<2; j++){
@@ -80,6 +80,30 @@ void generateVBAPgainTable3D_srcs(/* Input arguments */
                                   int* N_gtable,
                                   int* nTriangles);
 
+/**
+ * Generates a 3-D VBAP gain table based on specified source and loudspeaker
+ * directions (the same as generateVBAPgainTable3D_srcs()), with the source
+ * directions split over the threads of a saf_parfor pool
+ *
+ * @param[in] hPar saf_parfor handle (see saf_parfor_create()); or NULL, to run
+ *                 on the calling thread only
+ *
+ * The remaining arguments are the same as for generateVBAPgainTable3D_srcs().
+ */
+void generateVBAPgainTable3D_srcsParallel(/* Input arguments */
+                                          void * const hPar,
+                                          float* src_dirs_deg,
+                                          int S,
+                                          float* ls_dirs_deg,
+                                          int L,
+                                          int omitLargeTriangles,
+                                          int enableDummies,
+                                          float spread,
+                                          /* Output arguments */
+                                          float** gtable,
+                                          int* N_gtable,
+                                          int* nTriangles);
+
 /**
  * Generates a 3-D VBAP gain table based on specified loudspeaker directions,
  * with optional spreading [2]
@@ -135,6 +159,512 @@ void generateVBAPgainTable3D(/* Input arguments */
                              int* N_gtable,
                              int* nTriangles);
 
+/**
+ * Generates a 3-D VBAP gain table based on specified loudspeaker directions
+ * (the same as generateVBAPgainTable3D()), with the grid directions split over
+ * the threads of a saf_parfor pool
+ *
+ * @param[in] hPar saf_parfor handle (see saf_parfor_create()); or NULL, to run
+ *                 on the calling thread only
+ *
+ * The remaining arguments are the same as for generateVBAPgainTable3D().
+ */
+void generateVBAPgainTable3DParallel(/* Input arguments */
+                                     void * const hPar,
+                                     float* ls_dirs_deg,
+                                     int L,
+                                     int az_res_deg,
+                                     int el_res_deg,
+                                     int omitLargeTriangles,
+                                     int enableDummies,
+                                     float spread,
+                                     /* Output arguments */
+                                     float** gtable,
+                                     int* N_gtable,
+                                     int* nTriangles);
+
+/**
+ * Generates a 3-D VBAP gain table based on specified loudspeaker directions,
+ * with optional spreading [2], directly in its compressed form (i.e. only the
+ * non-zero gains and their loudspeaker indices are stored)
+ *
+ * The grid is the same as that of generateVBAPgainTable3D(), but without ever
+ * allocating the dense N_gtable x L table. The compressed tables should be
+ * accessed as:
+ * \code{.c}
+ *   idx3d = getVBAPgainTableIdx3D(AZI, ELEV, az_res_deg, el_res_deg);
+ *   for (i = 0; i < nGains; i++)
+ *       gains3D[gtableIdx[idx3d*nGains+i]] = gtableComp[idx3d*nGains+i];
+ * \endcode
+ * where unused entries have a gain of zero (and an index of zero). For VBAP
+ * (spread = 0), nGains is always 3, and the table may be converted into an
+ * AMPLITUDE normalised interpolation table (identical to the output of
+ * compressVBAPgainTable3D()) with:
+ * \code{.c}
+ *   VBAPgainTable2InterpTable(gtableComp, N_gtable, nGains);
+ * \endcode
+ *
+ * @note 'gtableComp' and 'gtableIdx' are returned as NULL if the triangulation
+ *       failed. The VBAP gains are ENERGY normalised; i.e. sum(gains^2) = 1
+ *
+ * @param[in]  ls_dirs_deg        Loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in]  L                  Number of loudspeakers
+ * @param[in]  az_res_deg         Azimuthal resolution in DEGREES
+ * @param[in]  el_res_deg         Elevation resolution in DEGREES
+ * @param[in]  omitLargeTriangles '0' normal triangulation, '1' remove large
+ *                                triangles
+ * @param[in]  enableDummies      '0' disabled, '1' enabled. Dummies are placed
+ *                                at +/-90 elevation if required
+ * @param[in]  spread             Spreading factor in DEGREES, 0: VBAP, >0: MDAP
+ * @param[out] gtableComp         (&) The compressed 3D VBAP gain table ENERGY
+ *                                NORMALISED; FLAT: N_gtable x nGains
+ * @param[out] gtableIdx          (&) The loudspeaker indices of the compressed
+ *                                gain table; FLAT: N_gtable x nGains
+ * @param[out] nGains             (&) number of gains per direction
+ * @param[out] N_gtable           (&) number of points in the gain table
+ * @param[out] nTriangles         (&) number of loudspeaker triangles
+ */
+void generateCompressedVBAPgainTable3D(/* Input arguments */
+                                       float* ls_dirs_deg,
+                                       int L,
+                                       int az_res_deg,
+                                       int el_res_deg,
+                                       int omitLargeTriangles,
+                                       int enableDummies,
+                                       float spread,
+                                       /* Output arguments */
+                                       float** gtableComp,
+                                       int** gtableIdx,
+                                       int* nGains,
+                                       int* N_gtable,
+                                       int* nTriangles);
+
+/**
+ * Generates a compressed 3-D VBAP gain table (the same as
+ * generateCompressedVBAPgainTable3D()), with the grid directions split over
+ * the threads of a saf_parfor pool
+ *
+ * @param[in] hPar saf_parfor handle (see saf_parfor_create()); or NULL, to run
+ *                 on the calling thread only
+ *
+ * The remaining arguments are the same as for
+ * generateCompressedVBAPgainTable3D().
+ */
+void generateCompressedVBAPgainTable3DParallel(/* Input arguments */
+                                               void * const hPar,
+                                               float* ls_dirs_deg,
+                                               int L,
+                                               int az_res_deg,
+                                               int el_res_deg,
+                                               int omitLargeTriangles,
+                                               int enableDummies,
+                                               float spread,
+                                               /* Output arguments */
+                                               float** gtableComp,
+                                               int** gtableIdx,
+                                               int* nGains,
+                                               int* N_gtable,
+                                               int* nTriangles);
+
+/**
+ * Creates an instance of a compressed 3-D VBAP gain table, which may later be
+ * updated incrementally with vbapTable3D_update()
+ *
+ * The table is identical to the one returned by
+ * generateCompressedVBAPgainTable3D() for the same arguments.
+ *
+ * @param[in] phVbap             (&) address of the VBAP table handle
+ * @param[in] ls_dirs_deg        Loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in] L                  Number of loudspeakers
+ * @param[in] az_res_deg         Azimuthal resolution in DEGREES
+ * @param[in] el_res_deg         Elevation resolution in DEGREES
+ * @param[in] omitLargeTriangles '0' normal triangulation, '1' remove large
+ *                               triangles
+ * @param[in] enableDummies      '0' disabled, '1' enabled. Dummies are placed
+ *                               at +/-90 elevation if required
+ * @param[in] spread             Spreading factor in DEGREES, 0: VBAP, >0: MDAP
+ */
+void vbapTable3D_create(/* Input arguments */
+                        void** const phVbap,
+                        float* ls_dirs_deg,
+                        int L,
+                        int az_res_deg,
+                        int el_res_deg,
+                        int omitLargeTriangles,
+                        int enableDummies,
+                        float spread);
+
+/**
+ * Creates an instance of a compressed 3-D VBAP gain table (the same as
+ * vbapTable3D_create()), with the grid directions split over the threads of a
+ * saf_parfor pool
+ *
+ * @note The pool is only used during this call; any later
+ *       vbapTable3D_update() runs on the calling thread.
+ *
+ * @param[in] phVbap (&) address of the VBAP table handle
+ * @param[in] hPar   saf_parfor handle (see saf_parfor_create()); or NULL, to
+ *                   run on the calling thread only
+ *
+ * The remaining arguments are the same as for vbapTable3D_create().
+ */
+void vbapTable3D_createParallel(/* Input arguments */
+                                void** const phVbap,
+                                void * const hPar,
+                                float* ls_dirs_deg,
+                                int L,
+                                int az_res_deg,
+                                int el_res_deg,
+                                int omitLargeTriangles,
+                                int enableDummies,
+                                float spread);
+
+/**
+ * Destroys an instance of a compressed 3-D VBAP gain table
+ *
+ * @param[in] phVbap (&) address of the VBAP table handle
+ */
+void vbapTable3D_destroy(/* Input arguments */
+                         void** const phVbap);
+
+/**
+ * Updates the gain table for new loudspeaker directions and/or spread (the
+ * number of loudspeakers must remain the same)
+ *
+ * If the existing triangulation is still the convex hull of the new layout
+ * (e.g. when a few loudspeakers are nudged), then only the triangles connected
+ * to the moved loudspeakers are re-inverted and, for VBAP, only the directions
+ * that may now fall into one of these triangles are recomputed. Otherwise, the
+ * layout is triangulated from scratch. In both cases, the resulting table is
+ * identical to that of a freshly created instance.
+ *
+ * @note Any pointers previously obtained with vbapTable3D_getTable() are
+ *       invalidated by this call.
+ *
+ * @param[in] hVbap       VBAP table handle
+ * @param[in] ls_dirs_deg New loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in] spread      Spreading factor in DEGREES, 0: VBAP, >0: MDAP
+ * @returns 1 if the table was updated incrementally, 0 if it was rebuilt
+ */
+int vbapTable3D_update(/* Input arguments */
+                       void* const hVbap,
+                       float* ls_dirs_deg,
+                       float spread);
+
+/**
+ * Returns the current compressed gain table (as described for
+ * generateCompressedVBAPgainTable3D())
+ *
+ * @note The arrays remain owned by the handle. 'gtableComp' and 'gtableIdx'
+ *       are returned as NULL if the triangulation failed
+ *
+ * @param[in]  hVbap      VBAP table handle
+ * @param[out] gtableComp (&) The compressed 3D VBAP gain table ENERGY
+ *                        NORMALISED; FLAT: N_gtable x nGains
+ * @param[out] gtableIdx  (&) The loudspeaker indices of the compressed gain
+ *                        table; FLAT: N_gtable x nGains
+ * @param[out] nGains     (&) number of gains per direction
+ * @param[out] N_gtable   (&) number of points in the gain table
+ * @param[out] nTriangles (&) number of loudspeaker triangles
+ */
+void vbapTable3D_getTable(/* Input arguments */
+                          void* const hVbap,
+                          /* Output arguments */
+                          float** gtableComp,
+                          int** gtableIdx,
+                          int* nGains,
+                          int* N_gtable,
+                          int* nTriangles);
+
+/**
+ * Computes the gains of one grid direction for any spread, using the current
+ * triangulation (without regenerating the table)
+ *
+ * The non-zero gains are identical to those of the same direction in a table
+ * generated with this spread. This allows, for example, the spread of a
+ * source to be animated without regenerating the whole table.
+ *
+ * @param[in]  hVbap       VBAP table handle
+ * @param[in]  idx         Index of the grid direction (see
+ *                         getVBAPgainTableIdx3D())
+ * @param[in]  spread      Spreading factor in DEGREES, 0: VBAP, >0: MDAP
+ * @param[in]  maxNumGains Maximum number of gains to return (the number of
+ *                         loudspeakers is always sufficient)
+ * @param[out] gainsComp   ENERGY normalised non-zero gains, zero padded;
+ *                         maxNumGains x 1
+ * @param[out] gainsIdx    Loudspeaker indices of the gains; maxNumGains x 1
+ * @returns The number of non-zero gains
+ */
+int vbapTable3D_getSpreadGains(/* Input arguments */
+                               void* const hVbap,
+                               int idx,
+                               float spread,
+                               int maxNumGains,
+                               /* Output arguments */
+                               float* gainsComp,
+                               int* gainsIdx);
+
+/**
+ * Creates an evaluator of the VBAP gains of moving sources, with off-grid
+ * directions
+ *
+ * The triangulation is the same as for vbapTable3D_create(). For each source,
+ * the triangle that enclosed its previous direction is remembered; the search
+ * for the next direction then starts from this triangle and walks across the
+ * hull towards the source, which, for directions that change smoothly over
+ * time, typically takes zero or one step. A full search is performed for the
+ * first direction of a source, or if the walk fails (e.g. for large jumps, or
+ * where triangles have been omitted).
+ *
+ * @param[in] phTrk              (&) address of VBAP tracker handle
+ * @param[in] ls_dirs_deg        Loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in] L                  Number of loudspeakers
+ * @param[in] omitLargeTriangles 0: normal triangulation, 1: discard
+ *                               overly large triangles
+ * @param[in] enableDummies      0: disabled, 1: enabled (as required)
+ * @param[in] nSources           Number of sources to track
+ */
+void vbapTracker3D_create(/* Input arguments */
+                          void** const phTrk,
+                          float* ls_dirs_deg,
+                          int L,
+                          int omitLargeTriangles,
+                          int enableDummies,
+                          int nSources);
+
+/**
+ * Destroys an instance of the VBAP tracker
+ *
+ * @param[in] phTrk (&) address of VBAP tracker handle
+ */
+void vbapTracker3D_destroy(/* Input arguments */
+                           void** const phTrk);
+
+/**
+ * Forgets the previous direction of a source (or of all sources, if src<0);
+ * e.g. if the source has been moved abruptly
+ */
+void vbapTracker3D_reset(/* Input arguments */
+                         void* const hTrk,
+                         int src);
+
+/** Returns the number of triangles used for panning */
+int vbapTracker3D_getNumTriangles(/* Input arguments */
+                                  void* const hTrk);
+
+/**
+ * Computes the VBAP gains of a source for its current direction
+ *
+ * The gains are those of vbap3D() with spread=0 for the same direction (to
+ * within the tolerance of the point-in-triangle test; i.e. on the edge of two
+ * triangles, the one that is kept may differ).
+ *
+ * @param[in]  hTrk     VBAP tracker handle
+ * @param[in]  src      Index of the source; 0..nSources-1
+ * @param[in]  azi_deg  Source azimuth in DEGREES
+ * @param[in]  elev_deg Source elevation in DEGREES
+ * @param[out] gains    ENERGY normalised loudspeaker gains; L x 1
+ * @returns 1 if an enclosing triangle was found, 0 otherwise (in which case
+ *          the gains are all zero)
+ */
+int vbapTracker3D_getGains(/* Input arguments */
+                           void* const hTrk,
+                           int src,
+                           float azi_deg,
+                           float elev_deg,
+                           /* Output arguments */
+                           float* gains);
+
+/**
+ * Creates an evaluator of the 2-D VBAP gains of moving sources, with off-grid
+ * azimuths; i.e. the 2-D counterpart of vbapTracker3D_create()
+ *
+ * The loudspeaker pairs are those of findLsPairs() (i.e. neighbours in
+ * azimuth). For each source, the pair that enclosed its previous azimuth is
+ * remembered, and the search for the next azimuth walks from this pair
+ * towards the source, along the ring. The first azimuth of a source starts
+ * from the pair given by a 1-D table, indexed by azimuth (one pair index per
+ * degree); so neither a gain table, nor a search over all pairs, is needed.
+ *
+ * @param[in] phTrk       (&) address of VBAP tracker handle
+ * @param[in] ls_dirs_deg Loudspeaker directions in DEGREES (only the azimuths
+ *                        are used); FLAT: L x 2
+ * @param[in] L           Number of loudspeakers
+ * @param[in] nSources    Number of sources to track
+ */
+void vbapTracker2D_create(/* Input arguments */
+                          void** const phTrk,
+                          float* ls_dirs_deg,
+                          int L,
+                          int nSources);
+
+/**
+ * Destroys an instance of the 2-D VBAP tracker
+ *
+ * @param[in] phTrk (&) address of VBAP tracker handle
+ */
+void vbapTracker2D_destroy(/* Input arguments */
+                           void** const phTrk);
+
+/**
+ * Forgets the previous azimuth of a source (or of all sources, if src<0)
+ */
+void vbapTracker2D_reset(/* Input arguments */
+                         void* const hTrk,
+                         int src);
+
+/** Returns the number of loudspeaker pairs used for panning */
+int vbapTracker2D_getNumPairs(/* Input arguments */
+                              void* const hTrk);
+
+/**
+ * Computes the 2-D VBAP gains of a source for its current azimuth, as the
+ * gains of its (at most two) loudspeakers
+ *
+ * The gains are those of vbap2D() for the same azimuth. If no pair encloses
+ * the source (i.e. it lies in a gap of more than 180 degrees between two
+ * loudspeakers), the nearest loudspeaker is used instead.
+ *
+ * @param[in]  hTrk      VBAP tracker handle
+ * @param[in]  src       Index of the source; 0..nSources-1
+ * @param[in]  azi_deg   Source azimuth in DEGREES (any range)
+ * @param[out] gainsComp ENERGY normalised gains, zero padded; 2 x 1
+ * @param[out] gainsIdx  Loudspeaker indices of the gains; 2 x 1
+ * @returns The number of gains (1 or 2)
+ */
+int vbapTracker2D_getGains(/* Input arguments */
+                           void* const hTrk,
+                           int src,
+                           float azi_deg,
+                           /* Output arguments */
+                           float* gainsComp,
+                           int* gainsIdx);
+
+/**
+ * Returns the index of the grid point nearest to [azi_deg, elev_deg], for gain
+ * tables generated by generateVBAPgainTable3D() or
+ * generateCompressedVBAPgainTable3D() at the same resolution
+ *
+ * @param[in] azi_deg    Azimuth in DEGREES (any range)
+ * @param[in] elev_deg   Elevation in DEGREES; -90..90
+ * @param[in] az_res_deg Azimuthal resolution of the table in DEGREES
+ * @param[in] el_res_deg Elevation resolution of the table in DEGREES
+ * @returns Index into the gain table
+ */
+int getVBAPgainTableIdx3D(/* Input arguments */
+                          float azi_deg,
+                          float elev_deg,
+                          int az_res_deg,
+                          int el_res_deg);
+
+/**
+ * Computes distance-based amplitude panning (DBAP) [1] gains for a source at
+ * a given direction and distance
+ *
+ * The gain of each loudspeaker is inversely proportional to its distance from
+ * the source, raised to the power of rolloff_dB/(20*log10(2)); i.e. 6.02 dB per
+ * doubling of distance with rolloff_dB = 6.02. The spatial blur is added to
+ * these distances (in quadrature), which avoids the gains collapsing onto a
+ * single loudspeaker as a near-field source approaches it, and which widens
+ * the image as it is increased.
+ *
+ * @note Unlike VBAP, no triangulation is required and the loudspeakers may be
+ *       at different distances, which makes DBAP suitable for sources inside
+ *       the array. The gains are ENERGY normalised; i.e. sum(gains^2) = 1
+ *
+ * @param[in]  ls_dirs_deg  Loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in]  ls_dists_m   Loudspeaker distances in METRES; L x 1 (NULL: all
+ *                          loudspeakers are at 1 m)
+ * @param[in]  L            Number of loudspeakers
+ * @param[in]  src_azi_deg  Source azimuth in DEGREES
+ * @param[in]  src_elev_deg Source elevation in DEGREES
+ * @param[in]  src_dist_m   Source distance in METRES
+ * @param[in]  rolloff_dB   Rolloff in dB per doubling of distance (>0)
+ * @param[in]  blur_m       Spatial blur in METRES (>=0)
+ * @param[out] gains        Loudspeaker gains; L x 1
+ *
+ * @see [1] Lossius, T., Baltazar, P., & de la Hogue, T. (2009). DBAP-distance-
+ *          based amplitude panning. In Proceedings of the International
+ *          Computer Music Conference (ICMC).
+ */
+void getDBAPgains(/* Input arguments */
+                  float* ls_dirs_deg,
+                  float* ls_dists_m,
+                  int L,
+                  float src_azi_deg,
+                  float src_elev_deg,
+                  float src_dist_m,
+                  float rolloff_dB,
+                  float blur_m,
+                  /* Output arguments */
+                  float* gains);
+
+/**
+ * Creates an instance of a precomputed 3-D DBAP gain field, spanning a grid
+ * of directions and distances (see getDBAPgains())
+ *
+ * The azimuthal and elevation resolutions are rounded, such that the grid
+ * divides the sphere evenly. The distance bins are spaced linearly between
+ * minDist_m and maxDist_m. Sources may then be panned with
+ * dbapTable_getGains(), at a cost that does not depend on the grid size; e.g.
+ * when the distances of many sources are animated.
+ *
+ * @param[in] phDbap      (&) address of the DBAP gain field handle
+ * @param[in] ls_dirs_deg Loudspeaker directions in DEGREES; FLAT: L x 2
+ * @param[in] ls_dists_m  Loudspeaker distances in METRES; L x 1 (NULL: all
+ *                        loudspeakers are at 1 m)
+ * @param[in] L           Number of loudspeakers
+ * @param[in] az_res_deg  Azimuthal resolution in DEGREES
+ * @param[in] el_res_deg  Elevation resolution in DEGREES
+ * @param[in] minDist_m   Distance of the nearest bin in METRES
+ * @param[in] maxDist_m   Distance of the furthest bin in METRES
+ * @param[in] nDistBins   Number of distance bins (>=2)
+ * @param[in] rolloff_dB  Rolloff in dB per doubling of distance (>0)
+ * @param[in] blur_m      Spatial blur in METRES (>=0)
+ */
+void dbapTable_create(/* Input arguments */
+                      void** const phDbap,
+                      float* ls_dirs_deg,
+                      float* ls_dists_m,
+                      int L,
+                      int az_res_deg,
+                      int el_res_deg,
+                      float minDist_m,
+                      float maxDist_m,
+                      int nDistBins,
+                      float rolloff_dB,
+                      float blur_m);
+
+/**
+ * Destroys an instance of a 3-D DBAP gain field
+ *
+ * @param[in] phDbap (&) address of the DBAP gain field handle
+ */
+void dbapTable_destroy(/* Input arguments */
+                       void** const phDbap);
+
+/**
+ * Returns the gains for a source at [azi_deg, elev_deg, dist_m], by trilinear
+ * interpolation of the gain field
+ *
+ * @note Distances outside of the range of the gain field are clamped to it.
+ *       The interpolated gains are re-normalised to have the ENERGY-preserving
+ *       property; i.e. sum(gains^2) = 1
+ *
+ * @param[in]  hDbap    DBAP gain field handle
+ * @param[in]  azi_deg  Source azimuth in DEGREES (any range)
+ * @param[in]  elev_deg Source elevation in DEGREES; -90..90
+ * @param[in]  dist_m   Source distance in METRES
+ * @param[out] gains    Loudspeaker gains; L x 1
+ */
+void dbapTable_getGains(/* Input arguments */
+                        void* const hDbap,
+                        float azi_deg,
+                        float elev_deg,
+                        float dist_m,
+                        /* Output arguments */
+                        float* gains);
+
 /**
  * Compresses a VBAP gain table to use less memory and CPU (by removing the
  * elements that are zero)
@@ -156,7 +686,9 @@ void generateVBAPgainTable3D(/* Input arguments */
  * where 'gains' are then the gains for loudspeakers('idx') to pan the source to
  * [AZI ELEV], using the nearest grid point
  *
- * @note The VBAP gains are AMPLITUDE normalised; i.e. sum(gains) = 1
+ * @note The VBAP gains are AMPLITUDE normalised; i.e. sum(gains) = 1. If the
+ *       dense table is not needed otherwise, then it is cheaper to use
+ *       generateCompressedVBAPgainTable3D() instead.
  *
  * @param[in]  vbap_gtable     The 3D VBAP gain table; FLAT: nTable x nDirs
  * @param[in]  nTable          number of points in the gain table
@@ -178,7 +710,9 @@ void compressVBAPgainTable3D(/* Input arguments */
  * Renormalises a vbap gain table in-place, so it may be utilised for
  * interpolation of data (for example, powermaps or HRTFs)
  *
- * @note The VBAP gains are AMPLITUDE normalised; i.e. sum(gains) = 1.
+ * @note The VBAP gains are AMPLITUDE normalised; i.e. sum(gains) = 1. Table
+ *       points without any non-zero gains are left as zeros. This function may
+ *       also be applied to compressed tables (with nDirs = nGains).
  *
  * @param[in,out] vbap_gtable The 3D VBAP gain table; FLAT: nTable x nDirs
  * @param[in]     nTable      Number of points in the gain table
@@ -358,6 +892,47 @@ void getSpreadSrcDirs3D(/* Input Arguments */
                         /* Output Arguments */
                         float* U_spread);
 
+/**
+ * Computes a spread kernel, i.e. the positions of the spread directions
+ * relative to any source direction
+ *
+ * getSpreadSrcDirs3D() is equivalent to calling this function followed by
+ * applySpreadKernel3D(). When the spread directions are required for many
+ * source directions (with the same spread), the kernel need only be computed
+ * once.
+ *
+ * @param[in]  spread       Spread in DEGREES
+ * @param[in]  num_src      Number of auxiliary sources to use for spreading
+ * @param[in]  num_rings_3d Number of concentric rings of num_src each to
+ *                          generate inside the spreading surface
+ * @param[out] spreadKernel Spread kernel; FLAT: (num_src*num_rings_3d) x 3
+ */
+void getSpreadKernel3D(/* Input Arguments */
+                       float spread,
+                       int num_src,
+                       int num_rings_3d,
+                       /* Output Arguments */
+                       float* spreadKernel);
+
+/**
+ * Computes the spread directions for a source direction, from a spread kernel
+ * obtained with getSpreadKernel3D()
+ *
+ * @param[in]  src_azi_rad  Source azimuth, in RADIANS
+ * @param[in]  src_elev_rad Source elevation, in RADIANS
+ * @param[in]  spreadKernel Spread kernel; FLAT: nDirs x 3
+ * @param[in]  nDirs        Number of spread directions (num_src*num_rings_3d)
+ * @param[out] U_spread     Spread directions Cartesian coordinates, followed
+ *                          by the source direction; FLAT: (nDirs+1) x 3
+ */
+void applySpreadKernel3D(/* Input Arguments */
+                         float src_azi_rad,
+                         float src_elev_rad,
+                         float* spreadKernel,
+                         int nDirs,
+                         /* Output Arguments */
+                         float* U_spread);
+
 /**
  * Calculates 3D VBAP gains for pre-calculated loudspeaker triangles and
  * predefined source directions
@@ -384,6 +959,32 @@ void vbap3D(/* Input Arguments */
             /* Output Arguments */
             float** GainMtx);
 
+/**
+ * Calculates 3D VBAP gains (the same as vbap3D()), with the source directions
+ * split over the threads of a saf_parfor pool
+ *
+ * @note Without spread, the triangles that may enclose each source are looked
+ *       up in a coarse grid of the sphere (for larger numbers of sources),
+ *       rather than testing all of them; which gives the same gains as
+ *       testing all of them, for any number of threads.
+ *
+ * @param[in] hPar saf_parfor handle (see saf_parfor_create()); or NULL, to run
+ *                 on the calling thread only
+ *
+ * The remaining arguments are the same as for vbap3D().
+ */
+void vbap3DParallel(/* Input Arguments */
+                    void * const hPar,
+                    float* src_dirs,
+                    int src_num,
+                    int ls_num,
+                    int* ls_groups,
+                    int nFaces,
+                    float spread,
+                    float* layoutInvMtx,
+                    /* Output Arguments */
+                    float** GainMtx);
+
 /**
  * Calculates loudspeaker pairs for a circular grid of loudspeaker directions
  *
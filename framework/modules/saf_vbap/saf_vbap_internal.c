@@ -36,3 +36,167 @@ void ccross(float a[3], float b[3], float c[3]){
     c[2] = a[0]*b[1]-a[1]*b[0];
 }
 
+
+/** Data structure for the face grid */
+typedef struct _vbap_faceGrid_data {
+    int N_azi, N_ele;   /**< number of cells in azimuth/elevation */
+    int* cellStart;     /**< first entry of each cell in 'cellFaces'; (N_azi*N_ele+1) x 1 */
+    int* cellFaces;     /**< triangle indices of all cells */
+
+}vbap_faceGrid_data;
+
+/** Angle between two unit vectors, in radians */
+static float vbap_faceGrid_angle(float a[3], float b[3])
+{
+    float d;
+
+    d = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    return acosf(MIN(MAX(d, -1.0f), 1.0f));
+}
+
+/** Unit vector of a direction, in DEGREES */
+static void vbap_faceGrid_dir2Cart(float azi_deg, float elev_deg, float u[3])
+{
+    float azi_rad, elev_rad;
+
+    azi_rad  = azi_deg*M_PI/180.0f;
+    elev_rad = elev_deg*M_PI/180.0f;
+    u[0] = cosf(azi_rad)*cosf(elev_rad);
+    u[1] = sinf(azi_rad)*cosf(elev_rad);
+    u[2] = sinf(elev_rad);
+}
+
+void vbap_faceGrid_create
+(
+    void** const phGrid,
+    float* layoutInvMtx,
+    int* faceValid,
+    int nFaces
+)
+{
+    vbap_faceGrid_data* h;
+    int i, j, f, c, ia, ie, nCells, nEntries, pass;
+    float norm, res, margin, azi0, ele0;
+    float V[9], corner[3];
+    float *faceCentre, *faceRadius, *cellCentre, *cellRadius;
+
+    h = (vbap_faceGrid_data*)malloc1d(sizeof(vbap_faceGrid_data));
+    *phGrid = (void*)h;
+    h->N_azi = 360/VBAP_FACE_GRID_RES_DEG;
+    h->N_ele = 180/VBAP_FACE_GRID_RES_DEG;
+    nCells = h->N_azi*h->N_ele;
+    res = (float)VBAP_FACE_GRID_RES_DEG;
+    margin = VBAP_FACE_GRID_MARGIN_DEG*M_PI/180.0f;
+
+    /* bounding cap of each triangle: the direction of the centroid of its
+     * vertices (recovered from the inverted matrices, which hold the
+     * transposed inverse of the vertex rows), and the largest angle to them.
+     * Caps of (nearly) a hemisphere or more do not bound their triangle, so
+     * these triangles are given to all cells (radius = pi) */
+    faceCentre = malloc1d(MAX(nFaces,1)*3*sizeof(float));
+    faceRadius = malloc1d(MAX(nFaces,1)*sizeof(float));
+    for(f=0; f<nFaces; f++){
+        if(faceValid!=NULL && !faceValid[f])
+            continue;
+        utility_sm3inv(&layoutInvMtx[f*9], V); /* V[j*3+i]: coordinate j of vertex i */
+        for(j=0; j<3; j++)
+            faceCentre[f*3+j] = V[j*3+0] + V[j*3+1] + V[j*3+2];
+        norm = sqrtf(faceCentre[f*3]*faceCentre[f*3] + faceCentre[f*3+1]*faceCentre[f*3+1] + faceCentre[f*3+2]*faceCentre[f*3+2]);
+        faceRadius[f] = M_PI;
+        if(norm > 1e-6f){
+            for(j=0; j<3; j++)
+                faceCentre[f*3+j] /= norm;
+            faceRadius[f] = 0.0f;
+            for(i=0; i<3; i++){
+                for(j=0; j<3; j++)
+                    corner[j] = V[j*3+i];
+                norm = sqrtf(corner[0]*corner[0] + corner[1]*corner[1] + corner[2]*corner[2]);
+                for(j=0; j<3; j++)
+                    corner[j] /= MAX(norm, 1e-9f);
+                faceRadius[f] = MAX(faceRadius[f], vbap_faceGrid_angle(&faceCentre[f*3], corner));
+            }
+            if(faceRadius[f]+margin >= M_PI/2.0f)
+                faceRadius[f] = M_PI;
+        }
+    }
+
+    /* bounding cap of each cell: its centre direction, and the largest angle to
+     * its corners (which are the furthest points of an azimuth-elevation cell) */
+    cellCentre = malloc1d(nCells*3*sizeof(float));
+    cellRadius = malloc1d(nCells*sizeof(float));
+    for(ie=0; ie<h->N_ele; ie++){
+        for(ia=0; ia<h->N_azi; ia++){
+            c = ie*h->N_azi + ia;
+            azi0 = -180.0f + (float)ia*res;
+            ele0 = -90.0f + (float)ie*res;
+            vbap_faceGrid_dir2Cart(azi0+res/2.0f, ele0+res/2.0f, &cellCentre[c*3]);
+            cellRadius[c] = 0.0f;
+            for(i=0; i<4; i++){
+                vbap_faceGrid_dir2Cart(azi0 + (float)(i%2)*res, ele0 + (float)(i/2)*res, corner);
+                cellRadius[c] = MAX(cellRadius[c], vbap_faceGrid_angle(&cellCentre[c*3], corner));
+            }
+        }
+    }
+
+    /* the triangles of each cell, in ascending order (counted, then stored) */
+    h->cellStart = malloc1d((nCells+1)*sizeof(int));
+    h->cellFaces = NULL;
+    for(pass=0; pass<2; pass++){
+        for(c=0, nEntries=0; c<nCells; c++){
+            h->cellStart[c] = nEntries;
+            for(f=0; f<nFaces; f++){
+                if(faceValid!=NULL && !faceValid[f])
+                    continue;
+                if(faceRadius[f] >= M_PI ||
+                   vbap_faceGrid_angle(&cellCentre[c*3], &faceCentre[f*3]) <= cellRadius[c]+faceRadius[f]+margin){
+                    if(pass==1)
+                        h->cellFaces[nEntries] = f;
+                    nEntries++;
+                }
+            }
+        }
+        h->cellStart[nCells] = nEntries;
+        if(pass==0)
+            h->cellFaces = malloc1d(MAX(nEntries,1)*sizeof(int));
+    }
+
+    free(faceCentre);
+    free(faceRadius);
+    free(cellCentre);
+    free(cellRadius);
+}
+
+void vbap_faceGrid_destroy
+(
+    void** const phGrid
+)
+{
+    vbap_faceGrid_data* h = (vbap_faceGrid_data*)(*phGrid);
+
+    if(h!=NULL){
+        free(h->cellStart);
+        free(h->cellFaces);
+        free(h);
+        *phGrid = NULL;
+    }
+}
+
+int vbap_faceGrid_getFaces
+(
+    void* const hGrid,
+    float u[3],
+    int** faces
+)
+{
+    vbap_faceGrid_data* h = (vbap_faceGrid_data*)(hGrid);
+    int ia, ie, c;
+    float azi_deg, elev_deg;
+
+    azi_deg  = atan2f(u[1], u[0])*180.0f/M_PI;
+    elev_deg = asinf(MIN(MAX(u[2], -1.0f), 1.0f))*180.0f/M_PI;
+    ia = MIN(MAX((int)((azi_deg+180.0f)/(float)VBAP_FACE_GRID_RES_DEG), 0), h->N_azi-1);
+    ie = MIN(MAX((int)((elev_deg+90.0f)/(float)VBAP_FACE_GRID_RES_DEG), 0), h->N_ele-1);
+    c = ie*h->N_azi + ia;
+    (*faces) = &(h->cellFaces[h->cellStart[c]]);
+    return h->cellStart[c+1] - h->cellStart[c];
+}
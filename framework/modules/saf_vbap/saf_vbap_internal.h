@@ -47,6 +47,27 @@ extern "C" {
 /** if omitLargeTriangles==1, triangles with an aperture larger than this are
  * discarded */
 #define APERTURE_LIMIT_DEG ( 180.0f )
+/** Number of auxiliary sources per ring, used for MDAP spreading */
+#define MDAP_NUM_SPREAD_SRCS ( 8 )
+/** Number of concentric rings of auxiliary sources, used for MDAP spreading */
+#define MDAP_NUM_RINGS ( 1 )
+/** Gains at or below this value are omitted from compressed gain tables */
+#define COMPRESSED_GAIN_THRESHOLD ( 0.0000001f )
+/** Size of the (azimuth-elevation) cells of vbap_faceGrid_create(), in degrees */
+#define VBAP_FACE_GRID_RES_DEG ( 10 )
+/** Margin by which the triangles are enlarged when they are assigned to the
+ * cells of vbap_faceGrid_create(), in degrees; this covers the tolerance of the
+ * enclosure test (gains > -0.001, i.e. less than 0.2 degrees outside) */
+#define VBAP_FACE_GRID_MARGIN_DEG ( 1.0f )
+/** Number of source directions from which vbap3DParallel() uses a face grid
+ * (below which, testing all triangles is cheaper than creating the grid) */
+#define VBAP_FACE_GRID_MIN_NUM_DIRS ( 128 )
+/** Maximum number of triangles that vbapTracker3D_getGains() walks across,
+ * before falling back to a search */
+#define VBAP_TRACKER_MAX_NUM_STEPS ( 16 )
+/** Azimuthal resolution of the table of loudspeaker pairs, used by
+ * vbapTracker2D_getGains() for the first azimuth of a source, in degrees */
+#define VBAP_TRACKER_2D_TABLE_RES_DEG ( 1 )
 
 /* ========================================================================== */
 /*                             Internal Functions                             */
@@ -57,6 +78,39 @@ extern "C" {
  */
 void ccross(float a[3], float b[3], float c[3]);
 
+/**
+ * Creates a spatial look-up structure for the loudspeaker triangles, such that
+ * only the triangles that may enclose a direction need to be tested
+ *
+ * The sphere is divided into VBAP_FACE_GRID_RES_DEG cells, and each cell is
+ * given the (ascending) list of triangles whose bounding caps overlap it.
+ * Therefore, the first triangle of a cell's list that encloses a direction is
+ * also the first of all triangles that encloses it.
+ *
+ * @param[in] phGrid       (&) address of the face grid handle
+ * @param[in] layoutInvMtx Inverted loudspeaker matrices, as returned by
+ *                         invertLsMtx3D(); FLAT: nFaces x 9
+ * @param[in] faceValid    1: triangle is used, 0: triangle is omitted (its
+ *                         matrix is not read); nFaces x 1, or NULL if all
+ *                         triangles are used
+ * @param[in] nFaces       Number of triangles
+ */
+void vbap_faceGrid_create(void** const phGrid,
+                          float* layoutInvMtx,
+                          int* faceValid,
+                          int nFaces);
+
+/** Destroys an instance of the face grid */
+void vbap_faceGrid_destroy(void** const phGrid);
+
+/**
+ * Returns the number of triangles that may enclose unit vector 'u', and their
+ * (ascending) indices via 'faces'
+ */
+int vbap_faceGrid_getFaces(void* const hGrid,
+                           float u[3],
+                           int** faces);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -41,6 +41,49 @@
  * may be found here: https://github.com/jvilkamo/afSTFT */
 # include "vecTools.h"
 #endif
+#if defined(__AVX__)
+# include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# include <xmmintrin.h>
+# define AFSTFT_USE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+#endif
+#ifdef AFSTFT_USE_SAF_UTILITIES
+# if defined(_WIN32)
+#  include <windows.h>
+#  define AFSTFT_ATOMIC_LOAD(p)    InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+#  define AFSTFT_ATOMIC_STORE(p,v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#  define AFSTFT_ATOMIC_INC(p)     InterlockedIncrement((volatile LONG*)(p))
+#  define AFSTFT_ATOMIC_DEC(p)     InterlockedDecrement((volatile LONG*)(p))
+#  define AFSTFT_CPU_PAUSE()       YieldProcessor()
+#  define AFSTFT_THREAD_YIELD()    SwitchToThread()
+# else
+#  include <pthread.h>
+#  include <sched.h>
+#  define AFSTFT_THREAD_YIELD()    sched_yield()
+#  define AFSTFT_ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#  define AFSTFT_ATOMIC_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#  define AFSTFT_ATOMIC_INC(p)     __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#  define AFSTFT_ATOMIC_DEC(p)     __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#  if defined(__x86_64__) || defined(__i386__)
+#   define AFSTFT_CPU_PAUSE()      __builtin_ia32_pause()
+#  elif defined(__aarch64__) || defined(__arm__)
+#   define AFSTFT_CPU_PAUSE()      __asm__ __volatile__("yield")
+#  else
+#   define AFSTFT_CPU_PAUSE()      do{}while(0)
+#  endif
+# endif
+/** Maximum number of threads selected by AFSTFT_NUM_THREADS_AUTO */
+# define AFSTFT_MAX_NUM_AUTO_THREADS ( 4 )
+/** Minimum number of channels per thread with AFSTFT_NUM_THREADS_AUTO */
+# define AFSTFT_MIN_CHANNELS_PER_THREAD ( 16 )
+/** Number of polling iterations before a worker thread goes to sleep */
+# define AFSTFT_SPIN_COUNT ( 4096 )
+#endif
+#ifndef M_PI
+# define M_PI ( 3.14159265358979323846264338327950288f )
+#endif
 
 /* Internal function prototypes */
 
@@ -52,6 +95,18 @@ void afHybridInverse(void* handle, complexVector* FD);
 
 void afHybridFree(void* handle);
 
+static void afHybridForwardChannel(void* handle, int ch, complexVector* FD);
+
+static void afHybridInverseChannel(void* handle, complexVector* FD);
+
+static void afHybridLayoutChannel(int hopSize, complexVector* FD);
+
+#ifdef AFSTFT_USE_SAF_UTILITIES
+void afHybridForwardPlanar(void* handle, int ch, int loopPointer, float_complex* inFD, float_complex* outFD, int bandStride);
+
+static void afHybridLayoutPlanar(int hopSize, float_complex* inFD, float_complex* outFD, int bandStride);
+#endif
+
 /* Coefficients for a half-band filter, i.e., the "hybrid filter" applied optionally at the bands 1--4. */
 #define COEFF1 0.031273141818515176604f
 #define COEFF2 0.28127313041521179171f
@@ -64,6 +119,37 @@ const double __afCenterFreq48e3[133] =
 const double __afCenterFreq44100[133] =
 {    0.000000000, 129.216965656, 215.314095512, 301.482605287, 387.579738729, 473.748225285, 559.845379541, 646.013853751, 732.111030944, 861.328154418, 1033.593765929, 1205.859407569, 1378.125069596, 1550.390654200, 1722.656272269, 1894.921852124, 2067.187549340, 2239.453165674, 2411.718752127, 2583.984393174, 2756.250038304, 2928.515610236, 3100.781245532, 3273.046869646, 3445.312517049, 3617.578144885, 3789.843759058, 3962.109385592, 4134.375009576, 4306.640638272, 4478.906262484, 4651.171887467, 4823.437506959, 4995.703134452, 5167.968753839, 5340.234378143, 5512.500004739, 5684.765628127, 5857.031253205, 6029.296881607, 6201.562505487, 6373.828132809, 6546.093756373, 6718.359382855, 6890.625004623, 7062.890629479, 7235.156254481, 7407.421881970, 7579.687505713, 7751.953124821, 7924.218750103, 8096.484373148, 8268.750008140, 8441.015629043, 8613.281251405, 8785.546881031, 8957.812505821, 9130.078124593, 9302.343752690, 9474.609377190, 9646.875004048, 9819.140627591, 9991.406251289, 10163.671877038, 10335.937501008, 10508.203126187, 10680.468750748, 10852.734375129, 11025.000000000, 11197.265624618, 11369.531249516, 11541.796874351, 11714.062498897, 11886.328122716, 12058.593748662, 12230.859372797, 12403.124996237, 12575.390622207, 12747.656246830, 12919.921875455, 13092.187494451, 13264.453118973, 13436.718748035, 13608.984370830, 13781.249991857, 13953.515626614, 14125.781249475, 14298.046875918, 14470.312494312, 14642.578118001, 14814.843746034, 14987.109370627, 15159.374994823, 15331.640617057, 15503.906242865, 15676.171867063, 15848.437494762, 16020.703118027, 16192.968746288, 16365.234371274, 16537.499995256, 16709.765622164, 16882.031246440, 17054.296865897, 17226.562492526, 17398.828113024, 17571.093736919, 17743.359361459, 17915.624990597, 18087.890614243, 18260.156240676, 18432.421855285, 18604.687483097, 18776.953130401, 18949.218754459, 19121.484389530, 19293.749961692, 19466.015606863, 19638.281247918, 19810.546834386, 19982.812450661, 20155.078147972, 20327.343727455, 20499.609346121, 20671.874930324, 20844.140592387, 21016.406233899, 21188.671845644, 21360.937478510, 21533.203108994, 21705.468678356, 21877.734276834, 22050.000000000    };
 
+#ifdef AFSTFT_USE_SAF_UTILITIES
+/** Types of job which may be distributed over the threads */
+typedef enum _AFSTFT_JOB_TYPES{
+    AFSTFT_JOB_FORWARD,        /**< afSTFTforward() */
+    AFSTFT_JOB_INVERSE,        /**< afSTFTinverse() */
+    AFSTFT_JOB_FORWARD_PLANAR, /**< afSTFTforwardPlanar(), afSTFTforwardFrame() */
+    AFSTFT_JOB_INVERSE_PLANAR  /**< afSTFTinversePlanar(), afSTFTinverseFrame() */
+}AFSTFT_JOB_TYPES;
+
+/** Arguments of the transform currently being carried out */
+typedef struct _afSTFT_job{
+    AFSTFT_JOB_TYPES type;
+    int nCH;                 /**< number of channels to process */
+    int nHops;               /**< number of hops to process (planar only) */
+    int hopIndex;            /**< hopIndexIn/hopIndexOut of the first hop */
+    int loopPointer;         /**< hybrid filter loopPointer of the first hop */
+    float** TD;              /**< time-domain signals; nCH x (nHops*hopSize) */
+    complexVector* FD;       /**< (non-planar) frequency-domain signals */
+    float_complex* FDplanar; /**< (planar) frequency-domain signals; consecutive hops are adjacent */
+    int bandStride;          /**< (planar) stride between bands */
+    int chStride;            /**< (planar) stride between channels */
+}afSTFT_job;
+
+/** Per-thread FFT handle and work buffers */
+typedef struct _afSTFT_scratch{
+    void* hSafFFT;
+    float* fftProcessFrameTD;
+    float_complex* fftProcessFrameFD;
+}afSTFT_scratch;
+#endif
+
 /**
  * Main data structure for afSTFTlib
  */
@@ -74,12 +160,13 @@ typedef struct{
     int hLen;
     int pr;
     int LDmode;
+    AFSTFT_PROTOTYPES proto;
     int hopIndexIn;
     int hopIndexOut;
     int totalHops;
     float *protoFilter;
     float *protoFilterI;
-    float **inBuffer;
+    float **inBuffer;   /* mirrored; 2 x hLen, see afSTFT_analysisFold() */
     float *fftProcessFrameTD;
     float **outBuffer;
     int log2n;
@@ -93,8 +180,47 @@ typedef struct{
 #endif
     void *h_afHybrid;
     int hybridMode;
+    int hybridRefine;   /* 1: the lowest bins are split by the hybrid filters, 0: only duplicated (see afSTFTsetHybridRefinement) */
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    /* Multi-threading. The channels are partitioned over the calling
+     * thread and (nThreads-1) worker threads. Workers are woken by
+     * incrementing jobGeneration, and the calling thread waits for
+     * jobsRemaining to reach zero, i.e., a lock-free barrier per hop. */
+    int silenceTail;                /**< number of silent input hops after which the analysis state is all zeros */
+    int* silentHops;                /**< inChannels; consecutive silent input hops (capped at silenceTail) */
+    int* channelSilent;             /**< inChannels; 1: every hop of the last forward call was skipped */
+    int nThreads;                   /**< number of threads, including the calling thread */
+    afSTFT_scratch* scratch;        /**< nThreads; [0] refers to the buffers above */
+    struct _afSTFT_worker* workers; /**< nThreads-1 */
+    afSTFT_job job;                 /**< current job */
+    volatile long jobGeneration;    /**< incremented for each new job */
+    volatile long jobsRemaining;    /**< number of workers yet to finish */
+    volatile long nSleeping;        /**< number of workers waiting on 'cond' */
+    volatile long exitFlag;         /**< set to close the worker threads */
+# if defined(_WIN32)
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+# else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+# endif
+#endif
 } afSTFT;
 
+#ifdef AFSTFT_USE_SAF_UTILITIES
+/** Data structure for one worker thread */
+typedef struct _afSTFT_worker{
+    afSTFT* h;         /**< parent afSTFT */
+    int index;         /**< thread index; 1..nThreads-1 */
+    int threadRunning;
+# if defined(_WIN32)
+    HANDLE thread;
+# else
+    pthread_t thread;
+# endif
+}afSTFT_worker;
+#endif
+
 /**
  * Data structure for the hybrid filtering employed by afSTFTlib.
  *
@@ -109,13 +235,399 @@ typedef struct{
     float hybridCoeffs[3];
     complexVector **analysisBuffer;
     int loopPointer;
-    
+
 } afHybrid;
 
-void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int LDmode, int hybridMode)
+/**
+ * Vector multiply-add: c[j] += a[j]*b[j], for j=0..len-1
+ *
+ * This is the inner loop of both the prototype filter windowing (forward) and
+ * the overlap-add (inverse), and therefore accounts for most of the time-domain
+ * cost of the transform. AVX, SSE or NEON are used, if the compiler targets
+ * them, with the remainder handled by a scalar loop.
+ */
+static void afSTFT_vma
+(
+    const float* a,
+    const float* b,
+    float* c,
+    int len
+)
+{
+    int j;
+    j = 0;
+#if defined(__AVX__)
+    for (; j<=len-8; j+=8)
+        _mm256_storeu_ps(c+j, _mm256_add_ps(_mm256_loadu_ps(c+j),
+                         _mm256_mul_ps(_mm256_loadu_ps(a+j), _mm256_loadu_ps(b+j))));
+#elif defined(AFSTFT_USE_SSE)
+    for (; j<=len-4; j+=4)
+        _mm_storeu_ps(c+j, _mm_add_ps(_mm_loadu_ps(c+j),
+                      _mm_mul_ps(_mm_loadu_ps(a+j), _mm_loadu_ps(b+j))));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; j<=len-4; j+=4)
+        vst1q_f32(c+j, vmlaq_f32(vld1q_f32(c+j), vld1q_f32(a+j), vld1q_f32(b+j)));
+#endif
+    for (; j<len; j++)
+        c[j] += a[j]*b[j];
+}
+
+/**
+ * Writes one hop of input into the circular buffer of channel 'ch' (at hop
+ * 'hopIndex'), then applies the prototype filter and folds the result into
+ * frameTD (2*hopSize)
+ *
+ * The circular buffer is mirrored, i.e. each hop is also written totalHops
+ * hops further on, such that the last totalHops hops may always be read from
+ * one contiguous block (starting at hopIndex+1) without wrapping around.
+ */
+static void afSTFT_analysisFold
+(
+    afSTFT* h,
+    int ch,
+    int hopIndex,
+    float* inTD,
+    float* frameTD
+)
+{
+    int k, lr;
+    float *p1, *p2, *p3;
+
+    /* Copy the input frame into the memory buffer (and its mirror) */
+    memcpy((void*)&(h->inBuffer[ch][hopIndex*h->hopSize]),(void*)inTD,sizeof(float)*(h->hopSize));
+    memcpy((void*)&(h->inBuffer[ch][(hopIndex+h->totalHops)*h->hopSize]),(void*)inTD,sizeof(float)*(h->hopSize));
+
+    /* Apply prototype filter to the collected data in the memory buffer, and fold the result (for the FFT operation). */
+    memset(frameTD, 0, h->hopSize*2*sizeof(float));
+    p1=&(h->inBuffer[ch][(hopIndex+1)*h->hopSize]);
+    lr=0; /* Left or right part of the frame */
+    for (k=0;k<h->totalHops;k++)
+    {
+        p2=&(h->protoFilter[k*h->hopSize]);
+        p3=&(frameTD[lr==1 ? h->hopSize : 0]);
+        lr = 1-lr;
+        afSTFT_vma(p1+k*h->hopSize, p2, p3, h->hopSize);
+    }
+}
+
+/**
+ * Applies the prototype filter to the repeated version of the IFFT'd data in
+ * frameTD (2*hopSize), overlap-adds it into the circular buffer of channel
+ * 'ch' (at hop 'hopIndex'), and copies the completed hop to outTD
+ */
+static void afSTFT_synthesisOverlapAdd
+(
+    afSTFT* h,
+    int ch,
+    int hopIndex,
+    float* frameTD,
+    float* outTD
+)
+{
+    int k, hopIndex_this, lr;
+    float *p1, *p2, *p3;
+
+    /* Clear buffer at the pointer location and increment the pointer */
+    hopIndex_this = hopIndex;
+    memset(&(h->outBuffer[ch][hopIndex_this*h->hopSize]), 0, h->hopSize*sizeof(float));
+    hopIndex_this++;
+    if (hopIndex_this >= h->totalHops)
+        hopIndex_this = 0;
+
+    lr=0; /* Left or right part of the frame */
+    for (k=0;k<h->totalHops;k++)
+    {
+        p1=&(h->outBuffer[ch][h->hopSize*hopIndex_this]);
+        p2=&(h->protoFilterI[k*h->hopSize]);
+        p3=&(frameTD[lr==1 ? h->hopSize : 0]);
+        lr = 1-lr;
+        afSTFT_vma(p2, p3, p1, h->hopSize);
+        hopIndex_this++;
+        if (hopIndex_this >= h->totalHops)
+            hopIndex_this = 0;
+    }
+
+    /* Copy a frame from work memory to the output */
+    memcpy((void*)outTD,(void*)&(h->outBuffer[ch][h->hopSize*hopIndex_this]),sizeof(float)*(h->hopSize));
+}
+
+#ifdef AFSTFT_USE_SAF_UTILITIES
+/**
+ * Updates the silence counter of input channel 'ch' with the hop inTD, and
+ * returns 1 if the forward transform of this hop may be skipped
+ *
+ * Once a channel has been silent for long enough, every hop of its circular
+ * buffer (and of its hybrid filter memory) is zero, so the output is zero and
+ * writing the silent hop into the buffers would not change them. The first
+ * non-silent hop then resumes processing from this (all zero) state, which is
+ * therefore exactly the same as if the channel had been processed throughout.
+ */
+static int afSTFT_updateSilence
+(
+    afSTFT* h,
+    int ch,
+    const float* inTD
+)
+{
+    int k;
+    
+    for(k=0; k<h->hopSize; k++){
+        if(inTD[k]!=0.0f){
+            h->silentHops[ch] = 0;
+            return 0;
+        }
+    }
+    if(h->silentHops[ch] < h->silenceTail){
+        h->silentHops[ch]++;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Carries out the current job (h->job) for channels chStart..chEnd-1, using
+ * the FFT and work buffers of the given scratch
+ */
+static void afSTFT_processChannels
+(
+    afSTFT* h,
+    afSTFT_scratch* s,
+    int chStart,
+    int chEnd
+)
+{
+    afSTFT_job* job = &(h->job);
+    int ch, k, t, nHops, hopIndex, nBands;
+    float_complex* FD, *FDplanar_ch;
+    
+    FD = s->fftProcessFrameFD;
+    nHops = job->type == AFSTFT_JOB_FORWARD || job->type == AFSTFT_JOB_INVERSE ? 1 : job->nHops;
+    nBands = h->hybridMode ? h->hopSize+5 : h->hopSize+1;
+    /* (each channel is taken through all of the hops in turn, such that its
+     * buffers stay in cache) */
+    for (ch=chStart; ch<chEnd; ch++){
+        if(job->type == AFSTFT_JOB_FORWARD || job->type == AFSTFT_JOB_FORWARD_PLANAR)
+            h->channelSilent[ch] = 1;
+        for (t=0; t<nHops; t++){
+            hopIndex = (job->hopIndex + t) % (h->totalHops);
+            switch(job->type){
+                case AFSTFT_JOB_FORWARD:
+                    if(afSTFT_updateSilence(h, ch, job->TD[ch])){
+                        memset(job->FD[ch].re, 0, nBands*sizeof(float));
+                        memset(job->FD[ch].im, 0, nBands*sizeof(float));
+                        break;
+                    }
+                    h->channelSilent[ch] = 0;
+                    afSTFT_analysisFold(h, ch, hopIndex, job->TD[ch], s->fftProcessFrameTD);
+                    saf_rfft_forward(s->hSafFFT, s->fftProcessFrameTD, FD);
+                    for(k = 0; k<h->hopSize+1; k++){
+                        job->FD[ch].re[k] = crealf(FD[k]);
+                        job->FD[ch].im[k] = cimagf(FD[k]);
+                    }
+                
+                    /* Subdivide lowest bands with half-band filters if hybrid mode is enabled */
+                    if (h->hybridMode && h->hybridRefine)
+                        afHybridForwardChannel(h->h_afHybrid, ch, &(job->FD[ch]));
+                    else if (h->hybridMode)
+                        afHybridLayoutChannel(h->hopSize, &(job->FD[ch]));
+                    break;
+                
+                case AFSTFT_JOB_FORWARD_PLANAR:
+                    FDplanar_ch = &(job->FDplanar[ch*(job->chStride) + t]);
+                    if(afSTFT_updateSilence(h, ch, &(job->TD[ch][t*(h->hopSize)]))){
+                        for(k = 0; k<nBands; k++)
+                            FDplanar_ch[k*(job->bandStride)] = cmplxf(0.0f, 0.0f);
+                        break;
+                    }
+                    h->channelSilent[ch] = 0;
+                    afSTFT_analysisFold(h, ch, hopIndex, &(job->TD[ch][t*(h->hopSize)]), s->fftProcessFrameTD);
+                    saf_rfft_forward(s->hSafFFT, s->fftProcessFrameTD, FD);
+                
+                    /* Write the bins (or hybrid-bands) straight into the caller's buffer */
+                    if (h->hybridMode && h->hybridRefine)
+                        afHybridForwardPlanar(h->h_afHybrid, ch, (job->loopPointer + t) % 7, FD, FDplanar_ch, job->bandStride);
+                    else if (h->hybridMode)
+                        afHybridLayoutPlanar(h->hopSize, FD, FDplanar_ch, job->bandStride);
+                    else
+                        for(k = 0; k<h->hopSize+1; k++)
+                            FDplanar_ch[k*(job->bandStride)] = FD[k];
+                    break;
+                
+                case AFSTFT_JOB_INVERSE:
+                    /* Combine subdivided lowest bands if hybrid mode is enabled */
+                    if (h->hybridMode)
+                        afHybridInverseChannel(h->h_afHybrid, &(job->FD[ch]));
+                    for(k = 0; k<h->hopSize+1; k++)
+                        FD[k] = cmplxf(job->FD[ch].re[k], job->FD[ch].im[k]);
+                    break;
+                
+                case AFSTFT_JOB_INVERSE_PLANAR:
+                    FDplanar_ch = &(job->FDplanar[ch*(job->chStride) + t]);
+                    if (h->hybridMode){
+                        /* Since no downsampling was applied, the inverse hybrid filtering is just sum of the bands, and the
+                         * rest are shifted to their original positions */
+                        FD[0] = FDplanar_ch[0];
+                        for(k = 1; k<5; k++)
+                            FD[k] = ccaddf(FDplanar_ch[(2*k-1)*(job->bandStride)], FDplanar_ch[(2*k)*(job->bandStride)]);
+                        for(k = 5; k<h->hopSize+1; k++)
+                            FD[k] = FDplanar_ch[(k+4)*(job->bandStride)];
+                    }
+                    else
+                        for(k = 0; k<h->hopSize+1; k++)
+                            FD[k] = FDplanar_ch[k*(job->bandStride)];
+                    break;
+            }
+        
+            if(job->type == AFSTFT_JOB_INVERSE || job->type == AFSTFT_JOB_INVERSE_PLANAR){
+                /* The low delay mode requires this procedure corresponding to the circular shift of the data in the time domain */
+                if (h->LDmode == 1)
+                    for (k=1; k<h->hopSize; k+=2)
+                        FD[k] = crmulf(FD[k], -1.0f);
+            
+                saf_rfft_backward(s->hSafFFT, FD, s->fftProcessFrameTD);
+                afSTFT_synthesisOverlapAdd(h, ch, hopIndex, s->fftProcessFrameTD, &(job->TD[ch][t*(h->hopSize)]));
+            }
+        }
+    }
+}
+
+/** Worker thread, which processes its share of the channels for each job */
+#if defined(_WIN32)
+static DWORD WINAPI afSTFT_workerThread(LPVOID arg)
+#else
+static void* afSTFT_workerThread(void* arg)
+#endif
+{
+    afSTFT_worker* w = (afSTFT_worker*)arg;
+    afSTFT* h = w->h;
+    long lastGeneration;
+    int i, nCH;
+    unsigned int fpState;
+    
+    /* jobGeneration is zeroed before the workers are created, so a job that
+     * is issued before this thread gets scheduled is not missed */
+    lastGeneration = 0;
+    while(1){
+        /* Poll for the next job for a while, and then go to sleep */
+        for(i=0; i<AFSTFT_SPIN_COUNT; i++){
+            if(AFSTFT_ATOMIC_LOAD(&(h->jobGeneration))!=lastGeneration || AFSTFT_ATOMIC_LOAD(&(h->exitFlag)))
+                break;
+            AFSTFT_CPU_PAUSE();
+        }
+        if(i==AFSTFT_SPIN_COUNT){
+#if defined(_WIN32)
+            EnterCriticalSection(&(h->mutex));
+            AFSTFT_ATOMIC_INC(&(h->nSleeping));
+            while(AFSTFT_ATOMIC_LOAD(&(h->jobGeneration))==lastGeneration && !AFSTFT_ATOMIC_LOAD(&(h->exitFlag)))
+                SleepConditionVariableCS(&(h->cond), &(h->mutex), INFINITE);
+            AFSTFT_ATOMIC_DEC(&(h->nSleeping));
+            LeaveCriticalSection(&(h->mutex));
+#else
+            pthread_mutex_lock(&(h->mutex));
+            AFSTFT_ATOMIC_INC(&(h->nSleeping));
+            while(AFSTFT_ATOMIC_LOAD(&(h->jobGeneration))==lastGeneration && !AFSTFT_ATOMIC_LOAD(&(h->exitFlag)))
+                pthread_cond_wait(&(h->cond), &(h->mutex));
+            AFSTFT_ATOMIC_DEC(&(h->nSleeping));
+            pthread_mutex_unlock(&(h->mutex));
+#endif
+        }
+        if(AFSTFT_ATOMIC_LOAD(&(h->exitFlag)))
+            break;
+        lastGeneration = AFSTFT_ATOMIC_LOAD(&(h->jobGeneration));
+        
+        /* process this thread's share of the channels */
+        nCH = h->job.nCH;
+        fpState = saf_denormals_guardBegin(); /* (as for the calling thread) */
+        afSTFT_processChannels(h, &(h->scratch[w->index]), (w->index)*nCH/(h->nThreads), (w->index+1)*nCH/(h->nThreads));
+        saf_denormals_guardEnd(fpState);
+        AFSTFT_ATOMIC_DEC(&(h->jobsRemaining));
+    }
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Carries out the current job (h->job) over all threads, and returns once
+ * all channels have been processed
+ */
+static void afSTFT_runJob
+(
+    afSTFT* h
+)
+{
+    int i, nCH;
+    
+    nCH = h->job.nCH;
+    if(h->nThreads>1 && nCH>1){
+        /* wake up the workers */
+        AFSTFT_ATOMIC_STORE(&(h->jobsRemaining), h->nThreads-1);
+        AFSTFT_ATOMIC_INC(&(h->jobGeneration));
+        if(AFSTFT_ATOMIC_LOAD(&(h->nSleeping))>0){
+#if defined(_WIN32)
+            EnterCriticalSection(&(h->mutex));
+            WakeAllConditionVariable(&(h->cond));
+            LeaveCriticalSection(&(h->mutex));
+#else
+            pthread_mutex_lock(&(h->mutex));
+            pthread_cond_broadcast(&(h->cond));
+            pthread_mutex_unlock(&(h->mutex));
+#endif
+        }
+        
+        /* the calling thread takes the first share, and then waits for the rest */
+        afSTFT_processChannels(h, &(h->scratch[0]), 0, nCH/(h->nThreads));
+        for(i=0; AFSTFT_ATOMIC_LOAD(&(h->jobsRemaining))>0; i++){
+            if(i<AFSTFT_SPIN_COUNT)
+                AFSTFT_CPU_PAUSE();
+            else
+                AFSTFT_THREAD_YIELD(); /* workers may be sharing this core */
+        }
+    }
+    else
+        afSTFT_processChannels(h, &(h->scratch[0]), 0, nCH);
+}
+#endif /* AFSTFT_USE_SAF_UTILITIES */
+
+/**
+ * Returns sample 'k' of the (10240 sample long) tabulated prototype filter
+ * 'proto', as resampled to a length of 10*hopSize; i.e. the prototype is
+ * decimated for hop sizes that divide 1024, and linearly interpolated otherwise
+ */
+static float afSTFT_sampleProto
+(
+    const float* proto,
+    int k,
+    int hopSize
+)
+{
+    int i;
+    double pos, frac;
+
+    if(1024%hopSize==0)
+        return proto[k*(1024/hopSize)];
+    pos = (double)k*1024.0/(double)hopSize;
+    i = (int)pos;
+    frac = pos - (double)i;
+    return i+1<10240 ? (float)((1.0-frac)*(double)proto[i] + frac*(double)proto[i+1]) : proto[10239];
+}
+
+void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int LDmode, int hybridMode, int nThreads)
 {
-    int k, ch, dsFactor;
+    afSTFTinitWithPrototype(handle, hopSize, inChannels, outChannels, LDmode ? AFSTFT_PROTO_LOW_DELAY : AFSTFT_PROTO_DEFAULT,
+                            hybridMode, nThreads);
+}
+
+void afSTFTinitWithPrototype(void** handle, int hopSize, int inChannels, int outChannels, AFSTFT_PROTOTYPES proto, int hybridMode, int nThreads)
+{
+    int k, ch;
     float eq;
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    int i;
+    afSTFT_worker* w;
+#endif
     
     *handle = malloc(sizeof(afSTFT));
     
@@ -125,12 +637,18 @@ void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int
     h->inChannels = inChannels;
     h->outChannels = outChannels;
     h->hopSize = hopSize;
-    dsFactor=1024/hopSize;
-    h->hLen = 10240/dsFactor;
-    h->totalHops=10;
+    h->proto = proto;
+    switch(proto){
+        default: /* fall through */
+        case AFSTFT_PROTO_DEFAULT:  /* fall through */
+        case AFSTFT_PROTO_LOW_DELAY: h->totalHops = 10; break;
+        case AFSTFT_PROTO_4_HOPS:    h->totalHops = 4;  break;
+        case AFSTFT_PROTO_2_HOPS:    h->totalHops = 2;  break;
+    }
+    h->hLen = h->totalHops*hopSize;
     h->hopIndexIn=0;
     h->hopIndexOut=0;
-    h->LDmode = LDmode;
+    h->LDmode = proto==AFSTFT_PROTO_LOW_DELAY ? 1 : 0;
     h->protoFilter = (float*)malloc(sizeof(float)*h->hLen);
     h->protoFilterI = (float*)malloc(sizeof(float)*h->hLen);
     h->inBuffer = (float**)malloc(sizeof(float*)*h->inChannels);
@@ -170,7 +688,23 @@ void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int
 #endif
     
     /* Normalization to ensure 0dB gain */
-    if (h->LDmode==0) {
+    if (h->proto==AFSTFT_PROTO_4_HOPS || h->proto==AFSTFT_PROTO_2_HOPS) {
+        /* The short prototypes are closed-form perfect reconstruction windows, the (squared) polyphase components of
+         * which already sum to one: the extended lapped transform window [2] (4 hops), and the sine window (2 hops) */
+#ifdef AFSTFT_USE_SAF_UTILITIES
+        eq = 1.0f;
+#else
+        eq = 1.0f/sqrtf((float)h->hopSize*4.0f);
+#endif
+        for (k=0; k<h->hLen; k++) {
+            if(h->proto==AFSTFT_PROTO_4_HOPS)
+                h->protoFilter[k] = (0.5f*cosf(((float)k+0.5f)*M_PI/(float)(2*h->hopSize)) - 0.5f/sqrtf(2.0f)) * -eq;
+            else
+                h->protoFilter[k] = sinf(((float)k+0.5f)*M_PI/(float)(2*h->hopSize))*eq;
+            h->protoFilterI[k] = h->protoFilter[k]; /* (symmetric) */
+        }
+    }
+    else if (h->LDmode==0) {
 #ifdef AFSTFT_USE_SAF_UTILITIES
         eq = 2.0f/sqrtf(5.487604141f);
 #else
@@ -178,8 +712,8 @@ void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int
 #endif
         
         for (k=0; k<h->hLen; k++) {
-            h->protoFilter[h->hLen-k-1] = protoFilter1024[k*dsFactor]*eq;
-            h->protoFilterI[h->hLen-k-1] = protoFilter1024[k*dsFactor]*eq;
+            h->protoFilter[h->hLen-k-1] = afSTFT_sampleProto(protoFilter1024, k, hopSize)*eq;
+            h->protoFilterI[h->hLen-k-1] = afSTFT_sampleProto(protoFilter1024, k, hopSize)*eq;
         }
     }
     else
@@ -190,20 +724,126 @@ void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int
         eq = 1.0f/sqrtf((float)h->hopSize*4.544559956f);
 #endif
         for (k=0; k<h->hLen; k++) {
-            h->protoFilter[h->hLen-k-1] = protoFilter1024LD[k*dsFactor]*eq;
-            h->protoFilterI[k]=protoFilter1024LD[k*dsFactor]*eq; 
+            h->protoFilter[h->hLen-k-1] = afSTFT_sampleProto(protoFilter1024LD, k, hopSize)*eq;
+            h->protoFilterI[k]=afSTFT_sampleProto(protoFilter1024LD, k, hopSize)*eq; 
         }
     }
     for(ch=0;ch<h->inChannels;ch++)
-        h->inBuffer[ch] = (float*)calloc(h->hLen,sizeof(float));
+        h->inBuffer[ch] = (float*)calloc(2*(h->hLen),sizeof(float));
     
     for(ch=0;ch<h->outChannels;ch++)
         h->outBuffer[ch] = (float*)calloc(h->hLen,sizeof(float));
     
     /* Initialize the hybrid filter memory etc. */
     h->hybridMode=hybridMode;
+    h->hybridRefine=1;
     if (h->hybridMode)
         afHybridInit(&(h->h_afHybrid), h->hopSize, h->inChannels,h->outChannels);
+    
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    /* Silence detection (the buffers start out zeroed, i.e. as if silent) */
+    h->silenceTail = h->totalHops + 1 + (h->hybridMode ? 7 : 0);
+    h->silentHops = (int*)malloc(h->inChannels*sizeof(int));
+    h->channelSilent = (int*)malloc(h->inChannels*sizeof(int));
+    for(ch=0; ch<h->inChannels; ch++){
+        h->silentHops[ch] = h->silenceTail;
+        h->channelSilent[ch] = 1;
+    }
+    
+    /* Threading */
+    if(nThreads==AFSTFT_NUM_THREADS_AUTO){
+        nThreads = ((inChannels > outChannels ? inChannels : outChannels) + AFSTFT_MIN_CHANNELS_PER_THREAD - 1)/AFSTFT_MIN_CHANNELS_PER_THREAD;
+        nThreads = nThreads > AFSTFT_MAX_NUM_AUTO_THREADS ? AFSTFT_MAX_NUM_AUTO_THREADS : nThreads;
+    }
+    h->nThreads = nThreads < 1 ? 1 : nThreads;
+    h->jobGeneration = 0;
+    h->jobsRemaining = 0;
+    h->nSleeping = 0;
+    h->exitFlag = 0;
+    h->job.nCH = 0;
+    h->scratch = (afSTFT_scratch*)malloc(h->nThreads*sizeof(afSTFT_scratch));
+    h->scratch[0].hSafFFT = h->hSafFFT;
+    h->scratch[0].fftProcessFrameTD = h->fftProcessFrameTD;
+    h->scratch[0].fftProcessFrameFD = h->fftProcessFrameFD;
+    for(i=1; i<h->nThreads; i++){
+        saf_rfft_create(&(h->scratch[i].hSafFFT), h->hopSize*2);
+        h->scratch[i].fftProcessFrameTD = (float*)calloc(h->hopSize*2, sizeof(float));
+        h->scratch[i].fftProcessFrameFD = (float_complex*)calloc(h->hopSize+1, sizeof(float_complex));
+    }
+# if defined(_WIN32)
+    InitializeCriticalSection(&(h->mutex));
+    InitializeConditionVariable(&(h->cond));
+# else
+    pthread_mutex_init(&(h->mutex), NULL);
+    pthread_cond_init(&(h->cond), NULL);
+# endif
+    h->workers = h->nThreads > 1 ? (afSTFT_worker*)malloc((h->nThreads-1)*sizeof(afSTFT_worker)) : NULL;
+    for(i=0; i<h->nThreads-1; i++){
+        w = &(h->workers[i]);
+        w->h = h;
+        w->index = i+1;
+# if defined(_WIN32)
+        w->thread = CreateThread(NULL, 0, afSTFT_workerThread, (LPVOID)w, 0, NULL);
+        w->threadRunning = w->thread != NULL ? 1 : 0;
+# else
+        w->threadRunning = pthread_create(&(w->thread), NULL, afSTFT_workerThread, (void*)w) == 0 ? 1 : 0;
+# endif
+        if(!w->threadRunning){
+            /* carry on with the threads created so far */
+            for(k=i+1; k<h->nThreads; k++){
+                saf_rfft_destroy(&(h->scratch[k].hSafFFT));
+                free(h->scratch[k].fftProcessFrameTD);
+                free(h->scratch[k].fftProcessFrameFD);
+            }
+            h->nThreads = i+1;
+            break;
+        }
+    }
+#else
+    (void)nThreads; /* multi-threading requires AFSTFT_USE_SAF_UTILITIES */
+#endif
+}
+
+int afSTFTgetProcessingDelay(void* handle)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    int nHops;
+
+    switch(h->proto){
+        default: /* fall through */
+        case AFSTFT_PROTO_DEFAULT:   nHops = 9; break;
+        case AFSTFT_PROTO_LOW_DELAY: nHops = 4; break;
+        case AFSTFT_PROTO_4_HOPS:    nHops = 3; break;
+        case AFSTFT_PROTO_2_HOPS:    nHops = 1; break;
+    }
+    if(h->hybridMode && h->hybridRefine)
+        nHops += 3; /* delay of the hybrid filters */
+    return nHops*h->hopSize;
+}
+
+void afSTFTsetHybridRefinement(void* handle, int enableFLAG)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    afHybrid *hyb_h = h->h_afHybrid;
+    int ch, sample;
+
+    enableFLAG = enableFLAG ? 1 : 0;
+    if (h->hybridMode && enableFLAG && !h->hybridRefine){
+        /* (the filter memory is not updated while the refinement is disabled) */
+        for(ch=0; ch<hyb_h->inChannels; ch++) {
+            for (sample=0;sample<7;sample++) {
+                memset(hyb_h->analysisBuffer[ch][sample].re, 0, sizeof(float)*(h->hopSize+1));
+                memset(hyb_h->analysisBuffer[ch][sample].im, 0, sizeof(float)*(h->hopSize+1));
+            }
+        }
+    }
+    h->hybridRefine = enableFLAG;
+}
+
+int afSTFTgetHybridRefinement(void* handle)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    return h->hybridMode ? h->hybridRefine : 0;
 }
 
 void afSTFTchannelChange(void* handle, int new_inChannels, int new_outChannels)
@@ -217,7 +857,15 @@ void afSTFTchannelChange(void* handle, int new_inChannels, int new_outChannels)
             free(h->inBuffer[i]);
         h->inBuffer = (float**)realloc(h->inBuffer, sizeof(float*)*new_inChannels);
         for(i=h->inChannels; i<new_inChannels; i++)
-            h->inBuffer[i] = (float*)calloc(h->hLen,sizeof(float));
+            h->inBuffer[i] = (float*)calloc(2*(h->hLen),sizeof(float));
+#ifdef AFSTFT_USE_SAF_UTILITIES
+        h->silentHops = (int*)realloc(h->silentHops, new_inChannels*sizeof(int));
+        h->channelSilent = (int*)realloc(h->channelSilent, new_inChannels*sizeof(int));
+        for(i=h->inChannels; i<new_inChannels; i++){
+            h->silentHops[i] = h->silenceTail;
+            h->channelSilent[i] = 1;
+        }
+#endif
     }
     
     if(h->outChannels!=new_outChannels){
@@ -263,7 +911,13 @@ void afSTFTclearBuffers(void* handle)
     int i, ch, sample;
     
     for(i=0; i<h->inChannels; i++)
-        memset(h->inBuffer[i], 0, h->hLen*sizeof(float));
+        memset(h->inBuffer[i], 0, 2*(h->hLen)*sizeof(float));
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    for(i=0; i<h->inChannels; i++){
+        h->silentHops[i] = h->silenceTail;
+        h->channelSilent[i] = 1;
+    }
+#endif
     for(i=0; i<h->outChannels; i++)
         memset(h->outBuffer[i], 0, h->hLen*sizeof(float));
     if (h->hybridMode){
@@ -279,73 +933,36 @@ void afSTFTclearBuffers(void* handle)
 void afSTFTforward(void* handle, float** inTD, complexVector* outFD)
 {
     afSTFT *h = (afSTFT*)(handle);
-    int ch,k,j,hopIndex_this,hopIndex_this2;
-    float *p1,*p2,*p3;
-#ifndef AFSTFT_USE_SAF_UTILITIES
-    float *p4;
-#endif
-    int lr;
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    afHybrid *hyb_h;
     
-    for (ch=0;ch<h->inChannels;ch++)
+    if (h->hybridMode){
+        hyb_h = (afHybrid*)(h->h_afHybrid);
+        hyb_h->loopPointer++;
+        if(hyb_h->loopPointer == 7)
+            hyb_h->loopPointer = 0;
+    }
+    h->job.type = AFSTFT_JOB_FORWARD;
+    h->job.nCH = h->inChannels;
+    h->job.hopIndex = h->hopIndexIn;
+    h->job.TD = inTD;
+    h->job.FD = outFD;
+    afSTFT_runJob(h);
+    h->hopIndexIn++;
+    if (h->hopIndexIn >= h->totalHops)
     {
-        /* Copy the input frame into the memory buffer */
-        hopIndex_this2 = h->hopIndexIn;
-        p1=&(h->inBuffer[ch][hopIndex_this2*h->hopSize]);
-        p2=inTD[ch];
-        memcpy((void*)p1,(void*)p2,sizeof(float)*(h->hopSize));
-        
-        hopIndex_this2++;
-        if (hopIndex_this2 >= h->totalHops)
-        {
-            hopIndex_this2 = 0;
-        }
-        
-        /* Apply prototype filter to the collected data in the memory buffer, and fold the result (for the FFT operation). */
-        p1 = h->fftProcessFrameTD;
-#ifdef AFSTFT_USE_SAF_UTILITIES
-        memset(p1, 0, h->hopSize*2*sizeof(float));
-#else
-        vtClr(p1, h->hopSize*2);
-#endif
-        lr=0; /* Left or right part of the frame */
-        hopIndex_this = hopIndex_this2;
-        for (k=0;k<h->totalHops;k++)
-        {
-            p1=&(h->inBuffer[ch][h->hopSize*hopIndex_this]);
-            p2=&(h->protoFilter[k*h->hopSize]);
-            if (lr==1)
-            {
-                p3=&(h->fftProcessFrameTD[h->hopSize]);
-                lr=0;
-            }
-            else
-            {
-                p3=&(h->fftProcessFrameTD[0]);
-                lr=1;
-            }
-#ifdef AFSTFT_USE_SAF_UTILITIES
-//            utility_svvmul(p1, p2, h->hopSize, h->tempHopBuffer);
-//            utility_svvadd(p3, h->tempHopBuffer, h->hopSize, p3);
-            for (j=0;j<h->hopSize;j++)
-                p3[j] += (p1[j])*(p2[j]);
+        h->hopIndexIn = 0;
+    }
 #else
-            vtVma(p1, p2, p3, h->hopSize);  /* Vector multiply-add */
-#endif
-            hopIndex_this++;
-            if (hopIndex_this >= h->totalHops)
-            {
-                hopIndex_this = 0;
-            }
-        }
+    int ch;
+    float *p1,*p2,*p3,*p4;
+    
+    for (ch=0;ch<h->inChannels;ch++)
+    {
+        /* Buffer the input, apply the prototype filter, and fold the result (for the FFT operation) */
+        afSTFT_analysisFold(h, ch, h->hopIndexIn, inTD[ch], h->fftProcessFrameTD);
         
         /* Apply FFT and copy the data to the output vector */
-#ifdef AFSTFT_USE_SAF_UTILITIES
-        saf_rfft_forward(h->hSafFFT, h->fftProcessFrameTD, h->fftProcessFrameFD);
-        for(k = 0; k<h->hopSize+1; k++){
-            outFD[ch].re[k] = crealf(h->fftProcessFrameFD[k]);
-            outFD[ch].im[k] = cimagf(h->fftProcessFrameFD[k]);
-        }
-#else
         vtRunFFT(h->vtFFT,1);
         outFD[ch].re[0]=h->fftProcessFrameFD[0];
         outFD[ch].im[0]=0.0f; /* DC im = 0 */
@@ -357,7 +974,6 @@ void afSTFTforward(void* handle, float** inTD, complexVector* outFD)
         p4 = h->fftProcessFrameFD + 1 + h->hopSize;
         memcpy((void*)p1,(void*)p3,sizeof(float)*(h->hopSize - 1));
         memcpy((void*)p2,(void*)p4,sizeof(float)*(h->hopSize - 1));
-#endif
     }
     h->hopIndexIn++;
     if (h->hopIndexIn >= h->totalHops)
@@ -366,21 +982,31 @@ void afSTFTforward(void* handle, float** inTD, complexVector* outFD)
     }
     
     /* Subdivide lowest bands with half-band filters if hybrid mode is enabled */
-    if (h->hybridMode)
+    if (h->hybridMode && h->hybridRefine)
     {
         afHybridForward(h->h_afHybrid, outFD);
     }
+    else if (h->hybridMode)
+    {
+        for (ch=0;ch<h->inChannels;ch++)
+            afHybridLayoutChannel(h->hopSize, &(outFD[ch]));
+    }
+#endif
 }
 
 void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
 {
     afSTFT *h = (afSTFT*)(handle);
-    int ch,k,j,hopIndex_this,hopIndex_this2;
-    float *p1,*p2,*p3;
-#ifndef AFSTFT_USE_SAF_UTILITIES
-    float *p4;
-#endif
-    int lr;
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    h->job.type = AFSTFT_JOB_INVERSE;
+    h->job.nCH = h->outChannels;
+    h->job.hopIndex = h->hopIndexOut;
+    h->job.TD = outTD;
+    h->job.FD = inFD;
+    afSTFT_runJob(h);
+#else
+    int ch,k;
+    float *p1,*p2,*p3,*p4;
     
     /* Combine subdivided lowest bands if hybrid mode is enabled */
     if (h->hybridMode)
@@ -390,21 +1016,7 @@ void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
     
     for (ch=0;ch<h->outChannels;ch++)
     {
-        /* Copy data from input to internal memory */
-        hopIndex_this2 = h->hopIndexOut;
-        
         /* Inverse FFT */
-#ifdef AFSTFT_USE_SAF_UTILITIES
-        for(k = 0; k<h->hopSize+1; k++)
-            h->fftProcessFrameFD[k] = cmplxf(inFD[ch].re[k], inFD[ch].im[k]);
-        
-        /* The low delay mode requires this procedure corresponding to the circular shift of the data in the time domain */
-        if (h->LDmode == 1)
-            for (k=1; k<h->hopSize; k+=2)
-                h->fftProcessFrameFD[k] = crmulf(h->fftProcessFrameFD[k], -1.0f);
-        
-        saf_rfft_backward(h->hSafFFT, h->fftProcessFrameFD, h->fftProcessFrameTD);
-#else
         h->fftProcessFrameFD[0] = inFD[ch].re[0]; /* DC */
         h->fftProcessFrameFD[h->hopSize] = inFD[ch].re[h->hopSize]; /* Nyquist */
         p1 = inFD[ch].re + 1;
@@ -425,63 +1037,11 @@ void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
         }
         
         vtRunFFT(h->vtFFT, -1);
-#endif
-        
-        /* Clear buffer at the pointer location and increment the pointer */
-        p1 = &(h->outBuffer[ch][hopIndex_this2*h->hopSize]);
-#ifdef AFSTFT_USE_SAF_UTILITIES
-        memset(p1, 0, h->hopSize*sizeof(float));
-#else
-        vtClr(p1,h->hopSize);
-#endif
-        hopIndex_this2++;
-        if (hopIndex_this2 >= h->totalHops)
-        {
-            hopIndex_this2=0;
-        }
-        hopIndex_this = hopIndex_this2;
-        
-        lr=0; /* Left or right part of the frame */
-        for (k=0;k<h->totalHops;k++)
-        {
-            /* Apply the prototype filter to the repeated version of the IFFT'd data. */
-            p1=&(h->outBuffer[ch][h->hopSize*hopIndex_this]);
-            p2=&(h->protoFilterI[k*h->hopSize]);
-            
-            if (lr==1)
-            {
-                p3=&(h->fftProcessFrameTD[h->hopSize]);
-                lr=0;
-            }
-            else
-            {
-                p3=&(h->fftProcessFrameTD[0]);
-                lr=1;
-            }
- 
-            /* Overlap-add to the existing data in the memory buffer (from previous frames). */
-#ifdef AFSTFT_USE_SAF_UTILITIES
-//            utility_svvmul(p2, p3, h->hopSize, h->tempHopBuffer);
-//            utility_svvadd(p1, h->tempHopBuffer, h->hopSize, p1);
-            for (j=0;j<h->hopSize;j++)
-                p1[j] += (p2[j])*(p3[j]); 
-#else
-            vtVma(p2, p3, p1, h->hopSize); /* Vector multiply-add */
-#endif
-            
-            hopIndex_this++;
-            if (hopIndex_this >= h->totalHops)
-            {
-                hopIndex_this = 0;
-            }
-        }
-        
-        /* Copy a frame from work memory to the output */
-        p1 = outTD[ch];
-        p2 = &(h->outBuffer[ch][h->hopSize*hopIndex_this]);
-        memcpy((void*)p1,(void*)p2,sizeof(float)*(h->hopSize));
         
+        /* Windowed overlap-add into the memory buffer, and copy the completed hop to the output */
+        afSTFT_synthesisOverlapAdd(h, ch, h->hopIndexOut, h->fftProcessFrameTD, outTD[ch]);
     }
+#endif
     h->hopIndexOut++;
     if (h->hopIndexOut >= h->totalHops)
     {
@@ -490,10 +1050,145 @@ void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
     
 }
 
+#ifdef AFSTFT_USE_SAF_UTILITIES
+void afSTFTforwardPlanar
+(
+    void* handle,
+    float** inTD,
+    float_complex* outFD,
+    int bandStride,
+    int chStride
+)
+{
+    afSTFTforwardFrame(handle, inTD, 1, outFD, bandStride, chStride);
+}
+
+void afSTFTforwardFrame
+(
+    void* handle,
+    float** inTD,
+    int nHops,
+    float_complex* outFD,
+    int bandStride,
+    int chStride
+)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    afHybrid *hyb_h;
+    
+    hyb_h = NULL;
+    if (h->hybridMode){
+        hyb_h = (afHybrid*)(h->h_afHybrid);
+        hyb_h->loopPointer++;
+        if(hyb_h->loopPointer == 7)
+            hyb_h->loopPointer = 0;
+    }
+    h->job.type = AFSTFT_JOB_FORWARD_PLANAR;
+    h->job.nCH = h->inChannels;
+    h->job.nHops = nHops;
+    h->job.hopIndex = h->hopIndexIn;
+    h->job.loopPointer = h->hybridMode ? hyb_h->loopPointer : 0;
+    h->job.TD = inTD;
+    h->job.FDplanar = outFD;
+    h->job.bandStride = bandStride;
+    h->job.chStride = chStride;
+    afSTFT_runJob(h);
+    h->hopIndexIn = (h->hopIndexIn + nHops) % (h->totalHops);
+    if (h->hybridMode)
+        hyb_h->loopPointer = (hyb_h->loopPointer + nHops - 1) % 7;
+}
+
+void afSTFTinversePlanar
+(
+    void* handle,
+    float_complex* inFD,
+    int bandStride,
+    int chStride,
+    float** outTD
+)
+{
+    afSTFTinverseFrame(handle, inFD, bandStride, chStride, 1, outTD);
+}
+
+int afSTFTisChannelSilent
+(
+    void* handle,
+    int ch
+)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    
+    return ch < h->inChannels ? h->channelSilent[ch] : 1;
+}
+
+void afSTFTinverseFrame
+(
+    void* handle,
+    float_complex* inFD,
+    int bandStride,
+    int chStride,
+    int nHops,
+    float** outTD
+)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    
+    h->job.type = AFSTFT_JOB_INVERSE_PLANAR;
+    h->job.nCH = h->outChannels;
+    h->job.nHops = nHops;
+    h->job.hopIndex = h->hopIndexOut;
+    h->job.TD = outTD;
+    h->job.FDplanar = inFD;
+    h->job.bandStride = bandStride;
+    h->job.chStride = chStride;
+    afSTFT_runJob(h);
+    h->hopIndexOut = (h->hopIndexOut + nHops) % (h->totalHops);
+}
+#endif /* AFSTFT_USE_SAF_UTILITIES */
+
 void afSTFTfree(void* handle)
 {
     afSTFT *h = (afSTFT*)(handle);
     int ch;
+#ifdef AFSTFT_USE_SAF_UTILITIES
+    int i;
+    
+    /* Close the worker threads */
+    if(h->nThreads>1){
+# if defined(_WIN32)
+        EnterCriticalSection(&(h->mutex));
+        AFSTFT_ATOMIC_STORE(&(h->exitFlag), 1);
+        WakeAllConditionVariable(&(h->cond));
+        LeaveCriticalSection(&(h->mutex));
+        for(i=0; i<h->nThreads-1; i++){
+            WaitForSingleObject(h->workers[i].thread, INFINITE);
+            CloseHandle(h->workers[i].thread);
+        }
+# else
+        pthread_mutex_lock(&(h->mutex));
+        AFSTFT_ATOMIC_STORE(&(h->exitFlag), 1);
+        pthread_cond_broadcast(&(h->cond));
+        pthread_mutex_unlock(&(h->mutex));
+        for(i=0; i<h->nThreads-1; i++)
+            pthread_join(h->workers[i].thread, NULL);
+# endif
+    }
+# if defined(_WIN32)
+    DeleteCriticalSection(&(h->mutex));
+# else
+    pthread_mutex_destroy(&(h->mutex));
+    pthread_cond_destroy(&(h->cond));
+# endif
+    for(i=1; i<h->nThreads; i++){
+        saf_rfft_destroy(&(h->scratch[i].hSafFFT));
+        free(h->scratch[i].fftProcessFrameTD);
+        free(h->scratch[i].fftProcessFrameFD);
+    }
+    free(h->scratch);
+    free(h->workers);
+    free(h->silentHops);
+    free(h->channelSilent);
+#endif
     if (h->hybridMode)
     {
         afHybridFree(h->h_afHybrid);
@@ -548,11 +1243,7 @@ void afHybridInit(void** handle, int hopSize, int inChannels, int outChannels)
 void afHybridForward(void* handle, complexVector* FD)
 {
     afHybrid *h = (afHybrid*)(handle);
-    int ch,band,sample,realImag;
-    float *pr1, *pr2, *pi1, *pi2;
-    float re,im;
-    int sampleIndices[7];
-    int loopPointerThis;
+    int ch;
     h->loopPointer++;
     if( h->loopPointer == 7)
     {
@@ -560,110 +1251,252 @@ void afHybridForward(void* handle, complexVector* FD)
     }
     for (ch=0;ch<h->inChannels;ch++)
     {
-        /* Copy data from input to the memory buffer */
-        pr1 = FD[ch].re;
-        pi1 = FD[ch].im;
-        pr2 = h->analysisBuffer[ch][h->loopPointer].re;
-        pi2 = h->analysisBuffer[ch][h->loopPointer].im;
-        memcpy((void*)pr2,(void*)pr1,sizeof(float)*(h->hopSize+1));
-        memcpy((void*)pi2,(void*)pi1,sizeof(float)*(h->hopSize+1));
+        afHybridForwardChannel(handle, ch, &(FD[ch]));
+    }
+}
+
+static void afHybridForwardChannel(void* handle, int ch, complexVector* FD)
+{
+    /* Processes channel 'ch' only. Note that loopPointer should be advanced by the caller, once per hop. */
+    afHybrid *h = (afHybrid*)(handle);
+    int band,sample,realImag;
+    float *pr1, *pr2, *pi1, *pi2;
+    float re,im;
+    int sampleIndices[7];
+    int loopPointerThis;
+    
+    /* Copy data from input to the memory buffer */
+    pr1 = FD->re;
+    pi1 = FD->im;
+    pr2 = h->analysisBuffer[ch][h->loopPointer].re;
+    pi2 = h->analysisBuffer[ch][h->loopPointer].im;
+    memcpy((void*)pr2,(void*)pr1,sizeof(float)*(h->hopSize+1));
+    memcpy((void*)pi2,(void*)pi1,sizeof(float)*(h->hopSize+1));
+    
+    /* Get the pointer to a position corresponding to the group delay of the linear-phase half-band filter. */
+    loopPointerThis = h->loopPointer - 3;
+    if( loopPointerThis < 0)
+    {
+        loopPointerThis += 7;
+    }
+    pr1 = FD->re;
+    pr2 = h->analysisBuffer[ch][loopPointerThis].re;
+    for (realImag=0;realImag<2;realImag++)
+    {
+        /* The 0.5 multipliers are the center coefficients of the half-band FIR filters. Data is duplicated for the half-bands. */
+        *pr1 = *pr2;
+        *(pr1+1) = *(pr2+1)*0.5f;
+        *(pr1+2) = *(pr1+1);
+        *(pr1+3) = *(pr2+2)*0.5f;
+        *(pr1+4) = *(pr1+3);
+        *(pr1+5) = *(pr2+3)*0.5f;
+        *(pr1+6) = *(pr1+5);
+        *(pr1+7) = *(pr2+4)*0.5f;
+        *(pr1+8) = *(pr1+7);
         
-        /* Get the pointer to a position corresponding to the group delay of the linear-phase half-band filter. */
-        loopPointerThis = h->loopPointer - 3;
-        if( loopPointerThis < 0)
-        {
-            loopPointerThis += 7;
-        }
-        pr1 = FD[ch].re;
-        pr2 = h->analysisBuffer[ch][loopPointerThis].re;
-        for (realImag=0;realImag<2;realImag++)
+        /* The rest of the bands are shifted upwards in the frequency indices, and delayed by the group delay of the half-band filters */
+        memcpy((void*)(pr1+9),(void*)(pr2+5),sizeof(float)*(h->hopSize-4));
+        
+        /* Repeat process for the imaginary part, at next iteration. */
+        pr1 = FD->im;
+        pr2 = h->analysisBuffer[ch][loopPointerThis].im;
+    }
+
+    for (sample=0;sample<7;sample++)
+    {
+        sampleIndices[sample]=h->loopPointer+1+sample;
+        if(sampleIndices[sample] > 6)
         {
-            /* The 0.5 multipliers are the center coefficients of the half-band FIR filters. Data is duplicated for the half-bands. */
-            *pr1 = *pr2;
-            *(pr1+1) = *(pr2+1)*0.5f;
-            *(pr1+2) = *(pr1+1);
-            *(pr1+3) = *(pr2+2)*0.5f;
-            *(pr1+4) = *(pr1+3);
-            *(pr1+5) = *(pr2+3)*0.5f;
-            *(pr1+6) = *(pr1+5);
-            *(pr1+7) = *(pr2+4)*0.5f;
-            *(pr1+8) = *(pr1+7);
-            
-            /* The rest of the bands are shifted upwards in the frequency indices, and delayed by the group delay of the half-band filters */
-            memcpy((void*)(pr1+9),(void*)(pr2+5),sizeof(float)*(h->hopSize-4));
-            
-            /* Repeat process for the imaginary part, at next iteration. */
-            pr1 = FD[ch].im;
-            pr2 = h->analysisBuffer[ch][loopPointerThis].im;
+            sampleIndices[sample]-=7;
         }
-    
-        for (sample=0;sample<7;sample++)
+        
+    }
+    for (band=1; band<5; band++)
+    {
+        /* The rest of the half-band FIR filtering is implemented below. The real<->imaginary shifts are for shifting the half-band filter spectra. */
+        re = -COEFF1*h->analysisBuffer[ch][sampleIndices[6]].im[band];
+        im =  COEFF1*h->analysisBuffer[ch][sampleIndices[6]].re[band];
+        re -= COEFF2*h->analysisBuffer[ch][sampleIndices[4]].im[band];
+        im += COEFF2*h->analysisBuffer[ch][sampleIndices[4]].re[band];
+        re += COEFF2*h->analysisBuffer[ch][sampleIndices[2]].im[band];
+        im -= COEFF2*h->analysisBuffer[ch][sampleIndices[2]].re[band];
+        re += COEFF1*h->analysisBuffer[ch][sampleIndices[0]].im[band];
+        im -= COEFF1*h->analysisBuffer[ch][sampleIndices[0]].re[band];
+        
+        /* The addition or subtraction process below provides the upper and lower half-band spectra (the coefficient 0.5 had the same sign for both bands).
+           The half-band orders are switched for bands=1,3 with respect to band=2,4, because of the organization of the spectral data at the downsampled frequency band signals. As the result of the order switching, the bands are organized by the ascending spectral position. */
+        if (band == 1 || band== 3)
         {
-            sampleIndices[sample]=h->loopPointer+1+sample;
-            if(sampleIndices[sample] > 6)
-            {
-                sampleIndices[sample]-=7;
-            }
-            
+            FD->re[band*2-1] -= re;
+            FD->im[band*2-1] -= im;
+            FD->re[band*2] += re;
+            FD->im[band*2] += im;
         }
-        for (band=1; band<5; band++)
+        else
         {
-            /* The rest of the half-band FIR filtering is implemented below. The real<->imaginary shifts are for shifting the half-band filter spectra. */
-            re = -COEFF1*h->analysisBuffer[ch][sampleIndices[6]].im[band];
-            im =  COEFF1*h->analysisBuffer[ch][sampleIndices[6]].re[band];
-            re -= COEFF2*h->analysisBuffer[ch][sampleIndices[4]].im[band];
-            im += COEFF2*h->analysisBuffer[ch][sampleIndices[4]].re[band];
-            re += COEFF2*h->analysisBuffer[ch][sampleIndices[2]].im[band];
-            im -= COEFF2*h->analysisBuffer[ch][sampleIndices[2]].re[band];
-            re += COEFF1*h->analysisBuffer[ch][sampleIndices[0]].im[band];
-            im -= COEFF1*h->analysisBuffer[ch][sampleIndices[0]].re[band];
-            
-            /* The addition or subtraction process below provides the upper and lower half-band spectra (the coefficient 0.5 had the same sign for both bands).
-               The half-band orders are switched for bands=1,3 with respect to band=2,4, because of the organization of the spectral data at the downsampled frequency band signals. As the result of the order switching, the bands are organized by the ascending spectral position. */
-            if (band == 1 || band== 3)
-            {
-                FD[ch].re[band*2-1] -= re;
-                FD[ch].im[band*2-1] -= im;
-                FD[ch].re[band*2] += re;
-                FD[ch].im[band*2] += im;
-            }
-            else
-            {
-                FD[ch].re[band*2-1] += re;
-                FD[ch].im[band*2-1] += im;
-                FD[ch].re[band*2] -= re;
-                FD[ch].im[band*2] -= im;
-            }
-            
+            FD->re[band*2-1] += re;
+            FD->im[band*2-1] += im;
+            FD->re[band*2] -= re;
+            FD->im[band*2] -= im;
         }
+        
     }
 }
 
 void afHybridInverse(void* handle, complexVector* FD)
 {
     afHybrid *h = (afHybrid*)(handle);
-    int ch,realImag;
-    float *pr;
+    int ch;
 
     for (ch=0;ch<h->outChannels;ch++)
     {
-        pr = FD[ch].re;
-        for (realImag=0;realImag<2;realImag++)
-        {
-            /* Since no downsampling was applied, the inverse hybrid filtering is just sum of the bands */
-            *(pr+1) = *(pr+1) + *(pr+2);
-            *(pr+2) = *(pr+3) + *(pr+4);
-            *(pr+3) = *(pr+5) + *(pr+6);
-            *(pr+4) = *(pr+7) + *(pr+8);
-            
-            /* The rest of the bands are shifted to their original positions */
-            memmove((void*)(pr+5),(void*)(pr+9),sizeof(float)*(h->hopSize-4));
-            
-            /* Repeat process for the imaginary part, at next iteration. */
-            pr = FD[ch].im;
-        }
+        afHybridInverseChannel(handle, &(FD[ch]));
+    }
+}
+
+static void afHybridLayoutChannel(int hopSize, complexVector* FD)
+{
+    /* Same layout as afHybridForwardChannel, but with bins 1..4 halved into both of their bands (rather than split by the
+     * half-band filters), and without the delay */
+    int k, realImag;
+    float *pr;
+
+    pr = FD->re;
+    for (realImag=0;realImag<2;realImag++)
+    {
+        memmove((void*)(pr+9),(void*)(pr+5),sizeof(float)*(hopSize-4));
+        for (k=4; k>=1; k--) /* (in descending order, as the bands are written in place) */
+            pr[2*k] = pr[2*k-1] = 0.5f*pr[k];
+        pr = FD->im;
+    }
+}
+
+static void afHybridInverseChannel(void* handle, complexVector* FD)
+{
+    afHybrid *h = (afHybrid*)(handle);
+    int realImag;
+    float *pr;
+
+    pr = FD->re;
+    for (realImag=0;realImag<2;realImag++)
+    {
+        /* Since no downsampling was applied, the inverse hybrid filtering is just sum of the bands */
+        *(pr+1) = *(pr+1) + *(pr+2);
+        *(pr+2) = *(pr+3) + *(pr+4);
+        *(pr+3) = *(pr+5) + *(pr+6);
+        *(pr+4) = *(pr+7) + *(pr+8);
+        
+        /* The rest of the bands are shifted to their original positions */
+        memmove((void*)(pr+5),(void*)(pr+9),sizeof(float)*(h->hopSize-4));
+        
+        /* Repeat process for the imaginary part, at next iteration. */
+        pr = FD->im;
+    }
+}
+
+#ifdef AFSTFT_USE_SAF_UTILITIES
+void afHybridForwardPlanar(void* handle, int ch, int loopPointer, float_complex* inFD, float_complex* outFD, int bandStride)
+{
+    /* Same as afHybridForward, but for one channel and operating on interleaved complex data. The caller passes the
+     * loopPointer of the hop being processed (such that the channels may be taken through several hops each). */
+    afHybrid *h = (afHybrid*)(handle);
+    int k,b,sample;
+    float re[4],im[4];
+    float *pr, *pi, *out;
+    const float *in, *r0, *r2, *r4, *r6, *i0, *i2, *i4, *i6;
+    const float sgn[4] = {-1.0f, 1.0f, -1.0f, 1.0f};
+    int sampleIndices[7];
+    int loopPointerThis;
+    complexVector* buf;
+    
+    /* Copy data from input to the memory buffer (the complex data are accessed as interleaved floats throughout, such
+     * that no per-bin complex construction calls are made) */
+    buf = h->analysisBuffer[ch];
+    pr = buf[loopPointer].re;
+    pi = buf[loopPointer].im;
+    in = (const float*)inFD;
+    for (k=0; k<h->hopSize+1; k++){
+        pr[k] = in[2*k];
+        pi[k] = in[2*k+1];
+    }
+    
+    /* Get the pointer to a position corresponding to the group delay of the linear-phase half-band filter. */
+    loopPointerThis = loopPointer - 3;
+    if( loopPointerThis < 0)
+        loopPointerThis += 7;
+    pr = buf[loopPointerThis].re;
+    pi = buf[loopPointerThis].im;
+    for (sample=0;sample<7;sample++){
+        sampleIndices[sample]=loopPointer+1+sample;
+        if(sampleIndices[sample] > 6)
+            sampleIndices[sample]-=7;
+    }
+    
+    /* The rest of the bands are shifted upwards in the frequency indices, and delayed by the group delay of the
+     * half-band filters */
+    out = (float*)outFD;
+    out[0] = pr[0];
+    out[1] = pi[0];
+    for (k=5; k<h->hopSize+1; k++){
+        out = (float*)&(outFD[(k+4)*bandStride]);
+        out[0] = pr[k];
+        out[1] = pi[k];
+    }
+    
+    /* Half-band FIR filtering (see afHybridForward) of bins 1..4, which are processed together as vectors of 4 */
+    r0 = buf[sampleIndices[0]].re+1;  i0 = buf[sampleIndices[0]].im+1;
+    r2 = buf[sampleIndices[2]].re+1;  i2 = buf[sampleIndices[2]].im+1;
+    r4 = buf[sampleIndices[4]].re+1;  i4 = buf[sampleIndices[4]].im+1;
+    r6 = buf[sampleIndices[6]].re+1;  i6 = buf[sampleIndices[6]].im+1;
+    for (b=0; b<4; b++){
+        re[b] = -COEFF1*i6[b];
+        im[b] =  COEFF1*r6[b];
+        re[b] -= COEFF2*i4[b];
+        im[b] += COEFF2*r4[b];
+        re[b] += COEFF2*i2[b];
+        im[b] -= COEFF2*r2[b];
+        re[b] += COEFF1*i0[b];
+        im[b] -= COEFF1*r0[b];
+        re[b] *= sgn[b]; /* (bins 1 and 3 are flipped) */
+        im[b] *= sgn[b];
+    }
+    for (b=0; b<4; b++){
+        out = (float*)&(outFD[(2*b+1)*bandStride]);
+        out[0] = 0.5f*pr[b+1] + re[b];
+        out[1] = 0.5f*pi[b+1] + im[b];
+        out = (float*)&(outFD[(2*b+2)*bandStride]);
+        out[0] = 0.5f*pr[b+1] - re[b];
+        out[1] = 0.5f*pi[b+1] - im[b];
+    }
+}
+
+static void afHybridLayoutPlanar(int hopSize, float_complex* inFD, float_complex* outFD, int bandStride)
+{
+    /* Same layout as afHybridForwardPlanar, but with bins 1..4 halved into both of their bands (rather than split by the
+     * half-band filters), and without the delay */
+    int k;
+    const float* in;
+    float* out;
+
+    in = (const float*)inFD;
+    out = (float*)outFD;
+    out[0] = in[0];
+    out[1] = in[1];
+    for (k=1; k<5; k++){
+        out = (float*)&(outFD[(2*k-1)*bandStride]);
+        out[0] = 0.5f*in[2*k];
+        out[1] = 0.5f*in[2*k+1];
+        out = (float*)&(outFD[(2*k)*bandStride]);
+        out[0] = 0.5f*in[2*k];
+        out[1] = 0.5f*in[2*k+1];
+    }
+    for (k=5; k<hopSize+1; k++){
+        out = (float*)&(outFD[(k+4)*bandStride]);
+        out[0] = in[2*k];
+        out[1] = in[2*k+1];
     }
 }
+#endif /* AFSTFT_USE_SAF_UTILITIES */
 
 void afHybridFree(void* handle)
 {
@@ -50,6 +50,9 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef AFSTFT_USE_SAF_UTILITIES
+# include "../../modules/saf_utilities/saf_complex.h"
+#endif
     
 /**
  * afSTFT centre frequencies for 128 hop size and hybrid-mode enabled (48kHz) */
@@ -60,21 +63,47 @@ extern const double __afCenterFreq48e3[133];
 extern const double __afCenterFreq44100[133];
 /**
  * Complex data type used by afSTFTlib
+ *
+ * @note With AFSTFT_USE_SAF_UTILITIES, this is the split-complex vector type
+ *       of SAF, such that each channel of afSTFT data may be passed directly
+ *       to the split-complex routines of saf_veclib (e.g.
+ *       utility_cvvmac_split()).
  */
+#ifdef AFSTFT_USE_SAF_UTILITIES
+typedef float_complex_split complexVector;
+#else
 typedef struct {
     float *re;
     float *im;
 } complexVector;
+#endif
+
+/**
+ * Pass to afSTFTinit() to select the number of threads based on the number of
+ * channels (one per 16 channels, up to 4 threads)
+ */
+#define AFSTFT_NUM_THREADS_AUTO ( 0 )
 
 /**
  * Initialises an instance of afSTFTlib [1]
  *
+ * With nThreads>1, the channels are partitioned over the calling thread and
+ * (nThreads-1) worker threads, which are created here and kept alive until
+ * afSTFTfree(). This is intended for high channel counts (e.g. higher-order
+ * Ambisonics); for a few channels, the synchronisation overhead per hop
+ * outweighs the benefit.
+ *
+ * @note Multi-threading requires AFSTFT_USE_SAF_UTILITIES; otherwise nThreads
+ *       is ignored.
+ *
  * @param[in] handle      (&) afSTFTlib handle
  * @param[in] hopSize     Hop size, in samples
  * @param[in] inChannels  Number of input channels
  * @param[in] outChannels Number of output channels
  * @param[in] LDmode      '0' disable low-delay mode, '1' enable
  * @param[in] hybridMode  '0' disable hybrid-mode, '1' enable
+ * @param[in] nThreads    Number of threads (including the calling thread);
+ *                        '1' single-threaded, or AFSTFT_NUM_THREADS_AUTO
  *
  * @see [1] Vilkamo, J., & Backstrom, T. (2018). Time--Frequency Processing:
  *          Methods and Tools. In Parametric Time-Frequency Domain Spatial
@@ -85,7 +114,92 @@ void afSTFTinit(void** handle,
                 int inChannels,
                 int outChannels,
                 int LDmode,
-                int hybridMode);
+                int hybridMode,
+                int nThreads);
+
+/**
+ * Available prototype filters (see afSTFTinitWithPrototype())
+ *
+ * The longer the prototype, the better the frequency selectivity of the bands,
+ * and thus the less aliasing there is when the bands are processed; at the
+ * cost of a longer delay (see afSTFTgetProcessingDelay()).
+ */
+typedef enum _AFSTFT_PROTOTYPES {
+    AFSTFT_PROTO_DEFAULT = 0,  /**< 10 hops long (the default of afSTFTinit) */
+    AFSTFT_PROTO_LOW_DELAY,    /**< 10 hops long, low-delay (LDmode) */
+    AFSTFT_PROTO_4_HOPS,       /**< 4 hops long; extended lapped transform
+                                *   window [2] */
+    AFSTFT_PROTO_2_HOPS        /**< 2 hops long (i.e. as long as the FFT);
+                                *   sine window */
+
+} AFSTFT_PROTOTYPES;
+
+/**
+ * Initialises an instance of afSTFTlib, as with afSTFTinit(), but with a
+ * choice of prototype filter
+ *
+ * The two 10 hop prototypes are tabulated for hop sizes that divide 1024, and
+ * are interpolated for any other hop sizes; whereas the shorter prototypes are
+ * computed for any hop size, and retain perfect reconstruction. The delays
+ * are 9, 4, 3 and 1 hops, respectively; so for a low total delay, for example,
+ * AFSTFT_PROTO_2_HOPS with a hop size of 128 and the hybrid-mode disabled
+ * delays the signals by 2.7 ms at 48kHz (with more aliasing than the default).
+ *
+ * @note With hybridMode enabled, the hybrid filters add a further 3 hops of
+ *       delay (as with afSTFTinit())
+ *
+ * @param[in] handle      (&) afSTFTlib handle
+ * @param[in] hopSize     Hop size, in samples (the FFT size is 2*hopSize)
+ * @param[in] inChannels  Number of input channels
+ * @param[in] outChannels Number of output channels
+ * @param[in] proto       Prototype filter; see AFSTFT_PROTOTYPES
+ * @param[in] hybridMode  '0' disable hybrid-mode, '1' enable
+ * @param[in] nThreads    Number of threads (including the calling thread);
+ *                        '1' single-threaded, or AFSTFT_NUM_THREADS_AUTO
+ *
+ * @see [2] Malvar, H. S. (1992). Extended lapped transforms: Properties,
+ *          applications, and fast algorithms. IEEE Transactions on Signal
+ *          Processing, 40(11), 2703-2714.
+ */
+void afSTFTinitWithPrototype(void** handle,
+                             int hopSize,
+                             int inChannels,
+                             int outChannels,
+                             AFSTFT_PROTOTYPES proto,
+                             int hybridMode,
+                             int nThreads);
+
+/**
+ * Returns the delay of the forward and backward transforms combined (unaltered
+ * bands in, the same signals out), in samples
+ *
+ * @param[in] handle afSTFTlib handle
+ */
+int afSTFTgetProcessingDelay(void* handle);
+
+/**
+ * Enables/disables the refinement of the lowest bins by the hybrid filters
+ * (on by default, and only relevant with hybridMode enabled)
+ *
+ * With the refinement disabled, the hop+5 band layout is retained, but bins
+ * 1..4 are simply halved into both of their two bands (rather than being split
+ * by the half-band filters), and the 3 hops of hybrid filter delay are removed;
+ * the reconstruction remains perfect. This is intended for consumers that do
+ * not need the finer low-frequency resolution, but rely on the hybrid layout.
+ *
+ * @note Not thread safe. So do not call in the middle of a real-time loop. The
+ *       processing delay changes accordingly (see afSTFTgetProcessingDelay())
+ *
+ * @param[in] handle     afSTFTlib handle
+ * @param[in] enableFLAG '0' only duplicate the lowest bins, '1' split them
+ */
+void afSTFTsetHybridRefinement(void* handle, int enableFLAG);
+
+/**
+ * Returns whether the lowest bins are refined by the hybrid filters (0: no, or
+ * hybridMode is disabled; 1: yes)
+ */
+int afSTFTgetHybridRefinement(void* handle);
 
 /**
  * Re-allocates memory to support a change in the number of input/output
@@ -124,6 +238,115 @@ void afSTFTforward(void* handle, float** inTD, complexVector* outFD);
  */
 void afSTFTinverse(void* handle, complexVector* inFD, float** outTD);
 
+#ifdef AFSTFT_USE_SAF_UTILITIES
+/**
+ * Applies the forward afSTFT transform, writing the result directly into an
+ * interleaved complex buffer with arbitrary band and channel strides.
+ *
+ * Band 'band' of channel 'ch' is written to outFD[band*bandStride +
+ * ch*chStride]. For example, for a buffer laid out as: nBands x nCH x nHops,
+ * pass &outFD[hopIdx] with bandStride=nCH*nHops and chStride=nHops, which
+ * avoids having to copy/transpose the output of afSTFTforward().
+ *
+ * @note This shares the same internal state as afSTFTforward(), so the two
+ *       may be used interchangeably from one hop to the next.
+ *
+ * @param[in]  handle     afSTFTlib handle
+ * @param[in]  inTD       Input time-domain signals; inChannels x hopSize
+ * @param[out] outFD      Output time-frequency domain signals (see above)
+ * @param[in]  bandStride Stride between consecutive bands
+ * @param[in]  chStride   Stride between consecutive channels
+ */
+void afSTFTforwardPlanar(void* handle,
+                         float** inTD,
+                         float_complex* outFD,
+                         int bandStride,
+                         int chStride);
+
+/**
+ * Applies the backward afSTFT transform, reading the input directly from an
+ * interleaved complex buffer with arbitrary band and channel strides (see
+ * afSTFTforwardPlanar()).
+ *
+ * @note Unlike afSTFTinverse(), the input data is left unmodified.
+ *
+ * @param[in]  handle     afSTFTlib handle
+ * @param[in]  inFD       Input time-frequency domain signals
+ * @param[in]  bandStride Stride between consecutive bands
+ * @param[in]  chStride   Stride between consecutive channels
+ * @param[out] outTD      Output time-domain signals; outChannels x hopSize
+ */
+void afSTFTinversePlanar(void* handle,
+                         float_complex* inFD,
+                         int bandStride,
+                         int chStride,
+                         float** outTD);
+
+/**
+ * Applies the forward afSTFT transform to several consecutive hops at once,
+ * in the same manner as afSTFTforwardPlanar()
+ *
+ * Hop 't' of band 'band' of channel 'ch' is written to outFD[band*bandStride +
+ * ch*chStride + t]. For example, for a buffer laid out as: nBands x nCH x
+ * nHops, pass outFD with bandStride=nCH*nHops and chStride=nHops.
+ *
+ * This is equivalent to calling afSTFTforwardPlanar() once per hop, but each
+ * channel is taken through all of the hops before moving on to the next one
+ * (with only one hand-over to the worker threads for the whole frame), and the
+ * input need not be copied into hop-sized buffers beforehand.
+ *
+ * @param[in]  handle     afSTFTlib handle
+ * @param[in]  inTD       Input time-domain signals; inChannels x (nHops*hopSize)
+ * @param[in]  nHops      Number of hops
+ * @param[out] outFD      Output time-frequency domain signals (see above)
+ * @param[in]  bandStride Stride between consecutive bands
+ * @param[in]  chStride   Stride between consecutive channels
+ */
+void afSTFTforwardFrame(void* handle,
+                        float** inTD,
+                        int nHops,
+                        float_complex* outFD,
+                        int bandStride,
+                        int chStride);
+
+/**
+ * Returns 1 if the output of the last forward transform was all zeros for
+ * input channel 'ch', i.e. the channel had been silent for long enough that
+ * the transform was skipped for all of its hops, or 0 otherwise
+ *
+ * Channels with all-zero input hops are tracked by the forward transforms,
+ * and once the filterbank state of a channel has fully decayed (totalHops
+ * hops, plus the hybrid filter delay if enabled) the analysis is skipped and
+ * zeros are written to the output instead. Processing resumes as soon as the
+ * input is no longer silent, with no difference in the output. Callers may
+ * use this to skip their own per-channel processing too.
+ *
+ * @param[in] handle afSTFTlib handle
+ * @param[in] ch     Input channel index
+ * @returns 1: channel is silent, 0: channel is active
+ */
+int afSTFTisChannelSilent(void* handle, int ch);
+
+/**
+ * Applies the backward afSTFT transform to several consecutive hops at once,
+ * reading the input as laid out by afSTFTforwardFrame()
+ *
+ * @param[in]  handle     afSTFTlib handle
+ * @param[in]  inFD       Input time-frequency domain signals
+ * @param[in]  bandStride Stride between consecutive bands
+ * @param[in]  chStride   Stride between consecutive channels
+ * @param[in]  nHops      Number of hops
+ * @param[out] outTD      Output time-domain signals; outChannels x
+ *                        (nHops*hopSize)
+ */
+void afSTFTinverseFrame(void* handle,
+                        float_complex* inFD,
+                        int bandStride,
+                        int chStride,
+                        int nHops,
+                        float** outTD);
+#endif /* AFSTFT_USE_SAF_UTILITIES */
+
 /**
  * Destroys an instance of afSTFTlib
  *
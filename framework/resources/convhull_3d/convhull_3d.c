@@ -28,9 +28,6 @@
  * George Papazafeiropoulos (c) 2014, originally distributed under the BSD
  * (2-clause) license. Taken from: https://github.com/leomccormack/convhull_3d
  *
- * ## Dependencies
- *   CBLAS (optional) for speed ups, especially for very large meshes
- *
  * @see [1] C. Bradford, Barber, David P. Dobkin and Hannu Huhdanpaa, "The
  *          Quickhull Algorithm for Convex Hull". Geometry Center Technical
  *          Report GCG53, July 30, 1993
@@ -49,8 +46,6 @@
 #include "convhull_3d.h"
 #include "../../modules/saf_utilities/saf_utilities.h"
 
-#define CONVHULL_3D_USE_CBLAS
-
 #if defined(_MSC_VER) && !defined(_CRT_SECURE_NO_WARNINGS)
   #define CV_STRNCPY(a,b,c) strncpy_s(a,c+1,b,c);
   #define CV_STRCAT(a,b) strcat_s(a,sizeof(b),b);
@@ -99,7 +94,7 @@ static void sort_int(int*, int*, int*, int, int);
 static ch_vec3 cross(ch_vec3*, ch_vec3*);
 static CH_FLOAT det_4x4(CH_FLOAT*);
 static void plane_3d(CH_FLOAT*, CH_FLOAT*, CH_FLOAT*);
-static void ismember(int*, int*, int*, int, int);
+static void set_neighbour(int*, int*, int, int, int, int);
 
 /* internal functions definitions: */
 static int cmp_asc_float(const void *a,const void *b) {
@@ -271,35 +266,41 @@ static void plane_3d
         (*d) += -p[i] * c[i];
 }
 
-static void ismember
+/**
+ * Sets face 'g' as the neighbour of face 'f' across the edge between vertices
+ * 'a' and 'b' (edge e of a face is between its vertices e and (e+1)%3) */
+static void set_neighbour
 (
-    int* pLeft,          /* left vector; nLeftElements x 1 */
-    int* pRight,         /* right vector; nRightElements x 1 */
-    int* pOut,           /* 0, unless pRight elements are present in pLeft then 1; nLeftElements x 1 */
-    int nLeftElements,   /* number of elements in pLeft */
-    int nRightElements   /* number of elements in pRight */
+    int* faces,
+    int* nbr,
+    int f,
+    int a,
+    int b,
+    int g
 )
 {
-    int i, j;
-    memset(pOut, 0, nLeftElements*sizeof(int));
-    for(i=0; i< nLeftElements; i++)
-        for(j=0; j< nRightElements; j++)
-            if(pLeft[i] == pRight[j] )
-                pOut[i] = 1;
+    int e, x, y;
+
+    for(e=0; e<3; e++){
+        x = faces[f*3+e];
+        y = faces[f*3+(e+1)%3];
+        if((x==a && y==b) || (x==b && y==a)){
+            nbr[f*3+e] = g;
+            return;
+        }
+    }
 }
 
-/* A C version of the 3D quickhull matlab implementation from here:
- * https://www.mathworks.com/matlabcentral/fileexchange/48509-computational-geometry-toolbox?focused=3851550&tab=example
- * (*out_faces) is returned as NULL, if triangulation fails *
- * Original Copyright (c) 2014, George Papazafeiropoulos
- * Distributed under the BSD (2-clause) license
- * Reference: "The Quickhull Algorithm for Convex Hull, C. Bradford Barber, David P. Dobkin
- *             and Hannu Huhdanpaa, Geometry Center Technical Report GCG53, July 30, 1993"
+/**
+ * Builds the 3-D convex hull (see convhull_3d_build()). If 'useOutsideSets' is
+ * enabled, then the visible faces of each point are found via the quickhull
+ * outside sets [1]; otherwise, all faces are tested for each point.
  */
-void convhull_3d_build
+static void convhull_3d_build_internal
 (
     ch_vertex* const in_vertices,
     const int nVert,
+    int useOutsideSets,
     int** out_faces,
     int* nOut_faces
 )
@@ -452,282 +453,350 @@ void convhull_3d_build
     for(i=0; i<num_pleft; i++)
         pleft[i] = ind[i]+d+1;
     
-    /* Loop over all remaining points that are not deleted. Deletion of points
-     occurs every #iter2del# iterations of this while loop */
-    memset(A, 0, (d+1)*(d+1) * sizeof(CH_FLOAT));
-    
-    /* cnt is equal to the points having been selected without deletion of
-     nonvisible points (i.e. points inside the current convex hull) */
-    cnt=0;
-    
-    /* The main loop for the quickhull algorithm */
-    CH_FLOAT detA;
-    CH_FLOAT* points_cf, *points_s;
-    int* visible_ind, *visible, *nonvisible_faces, *f0, *face_s, *u, *gVec, *horizon, *hVec, *pp, *hVec_mem_face;
-    int num_visible_ind, num_nonvisible_faces, n_newfaces, count, vis;
-    int f0_sum, u_len, start, num_p, index, horizon_size1;
-    int FUCKED;
-    FUCKED = 0;
-    u = horizon = NULL;
-    nFaces = d+1;
-    visible_ind = (int*)malloc(nFaces*sizeof(int));
-    points_cf = (CH_FLOAT*)malloc(nFaces*sizeof(CH_FLOAT));
-    points_s = (CH_FLOAT*)malloc(d*sizeof(CH_FLOAT));
-    face_s = (int*)malloc(d*sizeof(int));
-    gVec = (int*)malloc(d*sizeof(int));
-    while( (num_pleft>0) ){
-        /* i is the first point of the points left */
-        i = pleft[0];
-        
-        /* Delete the point selected */
-        for(j=0; j<num_pleft-1; j++)
-            pleft[j] = pleft[j+1];
-        num_pleft--;
-        if(num_pleft == 0)
-            free(pleft);
-        else
-            pleft = (int*)realloc(pleft, num_pleft*sizeof(int));
-        
-        /* Update point selection counter */
+    /* The faces are stored in pools of "slots", which grow geometrically and
+     * are never re-used. New faces are always appended, so the order of the
+     * live slots is also the order in which the faces are output, and the slot
+     * indices (which are also used to store the neighbours of each face) never
+     * need to be remapped when faces are deleted. The plane coefficients are
+     * stored as separate arrays, for the visibility tests. */
+    int nSlots, slotCap, nLive, num_visible, num_horizon, horizonCap, start;
+    int s, t, e, n, x, vis, pi, nU, index, next, failed;
+    int uVec[3];
+    int* alive, *nbr, *live, *visMark, *testMark, *visList, *stack, *horizon, *horizonNbr, *vtxSlot;
+    int* conflictFace, *conflictNext, *conflictHead, *processed;
+    CH_FLOAT px, py, pz, detA;
+    CH_FLOAT* cf0, *cf1, *cf2, *dfs;
+    slotCap = MAX(4*nVert, 64);
+    nSlots = nFaces = d+1;
+    faces = (int*)realloc(faces, slotCap*d*sizeof(int));
+    nbr = (int*)malloc(slotCap*d*sizeof(int));
+    cf0 = (CH_FLOAT*)malloc(slotCap*sizeof(CH_FLOAT));
+    cf1 = (CH_FLOAT*)malloc(slotCap*sizeof(CH_FLOAT));
+    cf2 = (CH_FLOAT*)malloc(slotCap*sizeof(CH_FLOAT));
+    dfs = (CH_FLOAT*)malloc(slotCap*sizeof(CH_FLOAT));
+    alive = (int*)malloc(slotCap*sizeof(int));
+    live = (int*)malloc(slotCap*sizeof(int));
+    visMark = (int*)calloc(slotCap, sizeof(int));
+    testMark = (int*)calloc(slotCap, sizeof(int));
+    conflictHead = (int*)malloc(slotCap*sizeof(int));
+    visList = (int*)malloc(slotCap*sizeof(int));
+    stack = (int*)malloc(slotCap*sizeof(int));
+    horizonCap = 64;
+    horizon = (int*)malloc(horizonCap*(d-1)*sizeof(int));
+    horizonNbr = (int*)malloc(horizonCap*sizeof(int));
+    vtxSlot = (int*)malloc(nVert*sizeof(int));
+    conflictFace = (int*)malloc(nVert*sizeof(int));
+    conflictNext = (int*)malloc(nVert*sizeof(int));
+    processed = (int*)calloc(nVert, sizeof(int));
+    for(i=0; i<nVert; i++){
+        vtxSlot[i] = -1;
+        conflictFace[i] = -1;
+    }
+    for(s=0; s<nSlots; s++){
+        cf0[s] = cf[s*d+0];
+        cf1[s] = cf[s*d+1];
+        cf2[s] = cf[s*d+2];
+        dfs[s] = df[s];
+        alive[s] = 1;
+        live[s] = s;
+        conflictHead[s] = -1;
+    }
+    nLive = nSlots;
+
+    /* Each face of the initial simplex neighbours all of the others */
+    for(s=0; s<nSlots; s++)
+        for(t=0; t<nSlots; t++)
+            if(s!=t)
+                for(e=0; e<d; e++)
+                    set_neighbour(faces, nbr, s, faces[t*d+e], faces[t*d+(e+1)%d], t);
+
+    /* Outside sets: each point left is assigned to one face that it can see.
+     * Points that cannot see any face are inside the hull, and are skipped */
+    if(useOutsideSets){
+        for(j=0; j<num_pleft; j++){
+            p = pleft[j];
+            for(s=0; s<nSlots; s++){
+                if(points[p*(d+1)+0]*cf0[s] + points[p*(d+1)+1]*cf1[s] + points[p*(d+1)+2]*cf2[s] + dfs[s] > 0.0){
+                    conflictFace[p] = s;
+                    conflictNext[p] = conflictHead[s];
+                    conflictHead[s] = p;
+                    break;
+                }
+            }
+        }
+    }
+    for(i=0; i<d+1; i++)
+        processed[i] = 1;
+
+    /* The main loop for the quickhull algorithm. The points with the larger
+     * relative distance from the center are added first. */
+    failed = 0;
+    cnt = 0;
+    for(pi=0; pi<num_pleft; pi++){
+        /* i is the next point of the points left */
+        i = pleft[pi];
+        processed[i] = 1;
+
+        /* Update point selection counter (also used to mark faces as tested
+         * and/or visible for this point) */
         cnt++;
-        
+
         /* find visible faces */
-        for(j=0; j<d; j++)
-            points_s[j] = points[i*(d+1)+j];
-        points_cf = (CH_FLOAT*)realloc(points_cf, nFaces*sizeof(CH_FLOAT));
-        visible_ind = (int*)realloc(visible_ind, nFaces*sizeof(int));
-#ifdef CONVHULL_3D_USE_CBLAS
-  #ifdef CONVHULL_3D_USE_FLOAT_PRECISION
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, nFaces, d, 1.0f,
-                    points_s, d,
-                    cf, d, 0.0f,
-                    points_cf, nFaces);
-  #else
-        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, nFaces, d, 1.0,
-                    points_s, d,
-                    cf, d, 0.0,
-                    points_cf, nFaces);
-  #endif
-#else
-        for (j = 0; j < nFaces; j++) {
-            points_cf[j] = 0;
-            for (k = 0; k < d; k++)
-                points_cf[j] += points_s[k]*cf[j*d+k];
-        }
-#endif
-        num_visible_ind = 0;
-        for(j=0; j<nFaces; j++){
-            if(points_cf[j] + df[j] > 0.0){
-                num_visible_ind++; /* will sum to 0 if none are visible */
-                visible_ind[j] = 1;
+        px = points[i*(d+1)+0];
+        py = points[i*(d+1)+1];
+        pz = points[i*(d+1)+2];
+        num_visible = 0;
+        if(!useOutsideSets){
+            for(j=0; j<nLive; j++){
+                s = live[j];
+                if(px*cf0[s] + py*cf1[s] + pz*cf2[s] + dfs[s] > 0.0){
+                    visMark[s] = cnt;
+                    visList[num_visible++] = s;
+                }
             }
-            else
-                visible_ind[j] = 0;
         }
-        num_nonvisible_faces = nFaces - num_visible_ind;
-        
-        /* proceed if there are any visible faces */
-        if(num_visible_ind!=0){
-            /* Find visible face indices */
-            visible = (int*)malloc(num_visible_ind*sizeof(int));
-            for(j=0, k=0; j<nFaces; j++){
-                if(visible_ind[j]==1){
-                    visible[k]=j;
-                    k++;
+        else if(conflictFace[i]!=-1){
+            /* The visible faces form a connected region, which is found by
+             * flood-filling from the face the point was assigned to */
+            n = 0;
+            stack[n++] = conflictFace[i];
+            testMark[conflictFace[i]] = cnt;
+            while(n>0){
+                s = stack[--n];
+                if(px*cf0[s] + py*cf1[s] + pz*cf2[s] + dfs[s] > 0.0){
+                    visMark[s] = cnt;
+                    visList[num_visible++] = s;
+                    for(e=0; e<d; e++){
+                        t = nbr[s*d+e];
+                        if(testMark[t]!=cnt){
+                            testMark[t] = cnt;
+                            stack[n++] = t;
+                        }
+                    }
                 }
             }
-            
-            /* Find nonvisible faces */
-            nonvisible_faces = (int*)malloc(num_nonvisible_faces*d*sizeof(int));
-            f0 = (int*)malloc(num_nonvisible_faces*d*sizeof(int));
-            for(j=0, k=0; j<nFaces; j++){
-                if(visible_ind[j]==0){
-                    for(l=0; l<d; l++)
-                        nonvisible_faces[k*d+l]= faces[j*d+l];
-                    k++;
+            for(j=1; j<num_visible; j++)
+                for(k=j; k>0 && visList[k-1]>visList[k]; k--){
+                    t = visList[k]; visList[k] = visList[k-1]; visList[k-1] = t;
                 }
+        }
+
+        /* proceed if there are any visible faces */
+        if(num_visible==0)
+            continue;
+
+        /* Create horizon (num_horizon is the number of the edges of the
+         * horizon), from the nonvisible neighbours of each visible face */
+        num_horizon = 0;
+        for(j=0; j<num_visible; j++){
+            vis = visList[j];
+            for(e=0, nU=0; e<d; e++){
+                t = nbr[vis*d+e];
+                if(visMark[t]==cnt)
+                    continue;
+                for(k=0; k<nU && uVec[k]!=t; k++)
+                    ;
+                if(k==nU)
+                    uVec[nU++] = t;
             }
-            
-            /* Create horizon (count is the number of the edges of the horizon) */
-            count=0;
-            for(j=0; j<num_visible_ind; j++){
-                /* visible face */
-                vis = visible[j];
-                for(k=0; k<d; k++)
-                    face_s[k] = faces[vis*d+k];
-                sort_int(face_s, NULL, NULL, d, 0);
-                ismember(nonvisible_faces, face_s, f0, num_nonvisible_faces*d, d);
-                u_len = 0;
-                
-                /* u are the nonvisible faces connected to the face v, if any */
-                for(k=0; k<num_nonvisible_faces; k++){
-                    f0_sum = 0;
-                    for(l=0; l<d; l++)
-                        f0_sum += f0[k*d + l];
-                    if(f0_sum == d-1){
-                        u_len++;
-                        if(u_len==1)
-                            u = (int*)malloc(u_len*sizeof(int));
-                        else
-                            u = (int*)realloc(u, u_len*sizeof(int));
-                        u[u_len-1] = k;
-                    }
+            for(k=1; k<nU; k++)
+                for(l=k; l>0 && uVec[l-1]>uVec[l]; l--){
+                    t = uVec[l]; uVec[l] = uVec[l-1]; uVec[l-1] = t;
                 }
-                for(k=0; k<u_len; k++){
-                    /* The boundary between the visible face v and the k(th) nonvisible face connected to the face v forms part of the horizon */
-                    count++;
-                    if(count==1)
-                        horizon = (int*)malloc(count*(d-1)*sizeof(int));
-                    else
-                        horizon = (int*)realloc(horizon, count*(d-1)*sizeof(int));
-                    for(l=0; l<d; l++)
-                        gVec[l] = nonvisible_faces[u[k]*d+l];
-                    for(l=0, h=0; l<d; l++){
-                        if(f0[u[k]*d+l]){
-                            horizon[(count-1)*(d-1)+h] = gVec[l];
-                            h++;
-                        }
-                    }
+            for(k=0; k<nU; k++){
+                /* The boundary between the visible face and the k(th)
+                 * nonvisible face connected to it forms part of the horizon */
+                if(num_horizon==horizonCap){
+                    horizonCap *= 2;
+                    horizon = (int*)realloc(horizon, horizonCap*(d-1)*sizeof(int));
+                    horizonNbr = (int*)realloc(horizonNbr, horizonCap*sizeof(int));
                 }
-                if(u_len!=0)
-                    free(u);
-            }
-            horizon_size1 = count;
-            for(j=0, l=0; j<nFaces; j++){
-                if(!visible_ind[j]){
-                    /* Delete visible faces */
-                    for(k=0; k<d; k++)
-                        faces[l*d+k] = faces[j*d+k];
-                    
-                    /* Delete the corresponding plane coefficients of the faces */
-                    for(k=0; k<d; k++)
-                        cf[l*d+k] = cf[j*d+k];
-                    df[l] = df[j];
-                    l++;
+                for(l=0, h=0; l<d && h<d-1; l++){
+                    x = faces[uVec[k]*d+l];
+                    if(x==faces[vis*d+0] || x==faces[vis*d+1] || x==faces[vis*d+2])
+                        horizon[num_horizon*(d-1)+(h++)] = x;
                 }
+                horizonNbr[num_horizon] = uVec[k];
+                num_horizon++;
             }
-            
-            /* Update the number of faces */
-            nFaces = nFaces-num_visible_ind;
-            faces = (int*)realloc(faces, nFaces*d*sizeof(int));
-            cf = (CH_FLOAT*)realloc(cf, nFaces*d*sizeof(CH_FLOAT));
-            df = (CH_FLOAT*)realloc(df, nFaces*sizeof(CH_FLOAT));
-            
-            /* start is the first row of the new faces */
-            start=nFaces;
-            
-            /* Add faces connecting horizon to the new point */
-            n_newfaces = horizon_size1;
-            for(j=0; j<n_newfaces; j++){
-                nFaces++;
-                faces = (int*)realloc(faces, nFaces*d*sizeof(int));
-                cf = (CH_FLOAT*)realloc(cf, nFaces*d*sizeof(CH_FLOAT));
-                df = (CH_FLOAT*)realloc(df, nFaces*sizeof(CH_FLOAT));
-                for(k=0; k<d-1; k++)
-                    faces[(nFaces-1)*d+k] = horizon[j*(d-1)+k];
-                faces[(nFaces-1)*d+(d-1)] = i;
-                
-                /* Calculate and store appropriately the plane coefficients of the faces */
-                for(k=0; k<d; k++)
-                    for(l=0; l<d; l++)
-                        p_s[k*d+l] = points[(faces[(nFaces-1)*d+k])*(d+1) + l];
-                plane_3d(p_s, cfi, &dfi);
-                for(k=0; k<d; k++)
-                    cf[(nFaces-1)*d+k] = cfi[k];
-                df[(nFaces-1)] = dfi;
-                if(nFaces > CH_MAX_NUM_FACES){
-                    FUCKED = 1;
-                    nFaces = 0;
+        }
+
+        /* Delete visible faces */
+        for(j=0; j<num_visible; j++)
+            alive[visList[j]] = 0;
+        nFaces -= num_visible;
+
+        /* Grow the pools, if required */
+        if(nSlots+num_horizon > slotCap){
+            while(nSlots+num_horizon > slotCap)
+                slotCap *= 2;
+            faces = (int*)realloc(faces, slotCap*d*sizeof(int));
+            nbr = (int*)realloc(nbr, slotCap*d*sizeof(int));
+            cf0 = (CH_FLOAT*)realloc(cf0, slotCap*sizeof(CH_FLOAT));
+            cf1 = (CH_FLOAT*)realloc(cf1, slotCap*sizeof(CH_FLOAT));
+            cf2 = (CH_FLOAT*)realloc(cf2, slotCap*sizeof(CH_FLOAT));
+            dfs = (CH_FLOAT*)realloc(dfs, slotCap*sizeof(CH_FLOAT));
+            alive = (int*)realloc(alive, slotCap*sizeof(int));
+            live = (int*)realloc(live, slotCap*sizeof(int));
+            visMark = (int*)realloc(visMark, slotCap*sizeof(int));
+            testMark = (int*)realloc(testMark, slotCap*sizeof(int));
+            conflictHead = (int*)realloc(conflictHead, slotCap*sizeof(int));
+            visList = (int*)realloc(visList, slotCap*sizeof(int));
+            stack = (int*)realloc(stack, slotCap*sizeof(int));
+        }
+
+        /* Add faces connecting horizon to the new point */
+        start = nSlots;
+        for(j=0; j<num_horizon; j++){
+            s = nSlots++;
+            nFaces++;
+            for(k=0; k<d-1; k++)
+                faces[s*d+k] = horizon[j*(d-1)+k];
+            faces[s*d+(d-1)] = i;
+
+            /* Calculate and store appropriately the plane coefficients of the faces */
+            for(k=0; k<d; k++)
+                for(l=0; l<d; l++)
+                    p_s[k*d+l] = points[(faces[s*d+k])*(d+1) + l];
+            plane_3d(p_s, cfi, &dfi);
+            cf0[s] = cfi[0];
+            cf1[s] = cfi[1];
+            cf2[s] = cfi[2];
+            dfs[s] = dfi;
+            alive[s] = 1;
+            visMark[s] = testMark[s] = 0;
+            conflictHead[s] = -1;
+            if(nFaces > CH_MAX_NUM_FACES){
+                failed = 1;
+                break;
+            }
+        }
+        if(failed)
+            break;
+
+        /* Orient each new face properly */
+        for(s=start; s<nSlots; s++){
+            /* While new point is coplanar, choose another point (the candidates
+             * are the indices 0..nFaces-1 that are not on the face) */
+            index = -1;
+            detA = 0.0;
+            while(detA==0.0){
+                do{
+                    index++;
+                } while(index==faces[s*d+0] || index==faces[s*d+1] || index==faces[s*d+2]);
+                if(index>=nFaces)
                     break;
+                for(j=0;j<d; j++)
+                    for(l=0; l<d+1; l++)
+                        A[j*(d+1)+l] = points[(faces[s*d+j])*(d+1) + l];
+                for(; j<d+1; j++)
+                    for(l=0; l<d+1; l++)
+                        A[j*(d+1)+l] = points[index*(d+1)+l];
+                detA = det_4x4(A);
+            }
+
+            /* Orient faces so that each point on the original simplex can't see the opposite face */
+            if (detA<0.0){
+                /* If orientation is improper, reverse the order to change the volume sign */
+                t = faces[s*d+1];
+                faces[s*d+1] = faces[s*d+2];
+                faces[s*d+2] = t;
+
+                /* Modify the plane coefficients of the properly oriented faces */
+                cf0[s] = -cf0[s];
+                cf1[s] = -cf1[s];
+                cf2[s] = -cf2[s];
+                dfs[s] = -dfs[s];
+            }
+        }
+
+        /* Connect the new faces to the horizon faces, and to each other (new
+         * faces sharing a horizon vertex also share the edge to the new point) */
+        for(j=0, s=start; s<nSlots; j++, s++){
+            t = horizonNbr[j];
+            set_neighbour(faces, nbr, s, horizon[j*(d-1)+0], horizon[j*(d-1)+1], t);
+            set_neighbour(faces, nbr, t, horizon[j*(d-1)+0], horizon[j*(d-1)+1], s);
+            for(k=0; k<d-1; k++){
+                x = horizon[j*(d-1)+k];
+                if(vtxSlot[x]==-1)
+                    vtxSlot[x] = s;
+                else{
+                    set_neighbour(faces, nbr, s, x, i, vtxSlot[x]);
+                    set_neighbour(faces, nbr, vtxSlot[x], x, i, s);
+                    vtxSlot[x] = -1;
                 }
             }
-            
-            /* Orient each new face properly */
-            hVec = (int*)malloc( nFaces*sizeof(int));
-            hVec_mem_face = (int*)malloc( nFaces*sizeof(int));
-            for(j=0; j<nFaces; j++)
-                hVec[j] = j;
-            for(k=start; k<nFaces; k++){
-                for(j=0; j<d; j++)
-                    face_s[j] = faces[k*d+j];
-                sort_int(face_s, NULL, NULL, d, 0);
-                ismember(hVec, face_s, hVec_mem_face, nFaces, d);
-                num_p = 0;
-                for(j=0; j<nFaces; j++)
-                    if(!hVec_mem_face[j])
-                        num_p++;
-                pp = (int*)malloc(num_p*sizeof(int));
-                for(j=0, l=0; j<nFaces; j++){
-                    if(!hVec_mem_face[j]){
-                        pp[l] = hVec[j];
-                        l++;
+        }
+        for(j=0; j<num_horizon*(d-1); j++)
+            vtxSlot[horizon[j]] = -1;
+
+        if(useOutsideSets){
+            /* Re-assign the points of the deleted faces to the new faces.
+             * Points that cannot see any of them are now inside the hull */
+            for(j=0; j<num_visible; j++){
+                for(p=conflictHead[visList[j]]; p!=-1; p=next){
+                    next = conflictNext[p];
+                    if(processed[p])
+                        continue;
+                    conflictFace[p] = -1;
+                    for(s=start; s<nSlots; s++){
+                        if(points[p*(d+1)+0]*cf0[s] + points[p*(d+1)+1]*cf1[s] + points[p*(d+1)+2]*cf2[s] + dfs[s] > 0.0){
+                            conflictFace[p] = s;
+                            conflictNext[p] = conflictHead[s];
+                            conflictHead[s] = p;
+                            break;
+                        }
                     }
                 }
-                index = 0;
-                detA = 0.0;
-                
-                /* While new point is coplanar, choose another point */
-                while(detA==0.0){
-                    for(j=0;j<d; j++)
-                        for(l=0; l<d+1; l++)
-                            A[j*(d+1)+l] = points[(faces[k*d+j])*(d+1) + l];
-                    for(; j<d+1; j++)
-                        for(l=0; l<d+1; l++)
-                            A[j*(d+1)+l] = points[pp[index]*(d+1)+l];
-                    index++;
-                    detA = det_4x4(A);
-                }
-                
-                /* Orient faces so that each point on the original simplex can't see the opposite face */
-                if (detA<0.0){
-                    /* If orientation is improper, reverse the order to change the volume sign */
-                    for(j=0; j<d; j++)
-                        face_tmp[j] = faces[k*d+j];
-                    for(j=0, l=d-2; j<d-1; j++, l++)
-                        faces[k*d+l] = face_tmp[d-j-1];
-                    
-                    /* Modify the plane coefficients of the properly oriented faces */
-                    for(j=0; j<d; j++)
-                        cf[k*d+j] = -cf[k*d+j];
-                    df[k] = -df[k];
-                    for(l=0; l<d; l++)
-                        for(j=0; j<d+1; j++)
-                            A[l*(d+1)+j] = points[(faces[k*d+l])*(d+1) + j];
-                    for(; l<d+1; l++)
-                        for(j=0; j<d+1; j++)
-                            A[l*(d+1)+j] = points[pp[index]*(d+1)+j];
-                }
-                free(pp);
             }
-            free(horizon);
-            free(f0);
-            free(nonvisible_faces);
-            free(visible);
-            free(hVec);
-            free(hVec_mem_face);
         }
-        if(FUCKED){
-            break;
+        else{
+            /* Update the list of live faces */
+            for(j=0, l=0; j<nLive; j++)
+                if(alive[live[j]])
+                    live[l++] = live[j];
+            for(s=start; s<nSlots; s++)
+                live[l++] = s;
+            nLive = l;
         }
     }
-    
+
     /* output */
-    if(FUCKED){
+    if(failed){
         (*out_faces) = NULL;
         (*nOut_faces) = 0;
     }
     else{
         (*out_faces) = (int*)malloc(nFaces*d*sizeof(int));
-        memcpy((*out_faces),faces, nFaces*d*sizeof(int));
+        for(s=0, k=0; s<nSlots; s++){
+            if(alive[s]){
+                memcpy(&(*out_faces)[k*d], &faces[s*d], d*sizeof(int));
+                k++;
+            }
+        }
         (*nOut_faces) = nFaces;
     }
-    
+
     /* clean-up */
-    free(visible_ind);
-    free(points_cf);
-    free(points_s);
-    free(face_s);
-    free(gVec);
+    free(nbr);
+    free(cf0);
+    free(cf1);
+    free(cf2);
+    free(dfs);
+    free(alive);
+    free(live);
+    free(visMark);
+    free(testMark);
+    free(conflictHead);
+    free(visList);
+    free(stack);
+    free(horizon);
+    free(horizonNbr);
+    free(vtxSlot);
+    free(conflictFace);
+    free(conflictNext);
+    free(processed);
+    free(pleft);
     free(meanp);
     free(absdist);
     free(reldist);
@@ -748,6 +817,28 @@ void convhull_3d_build
     free(A);
 }
 
+void convhull_3d_build
+(
+    ch_vertex* const in_vertices,
+    const int nVert,
+    int** out_faces,
+    int* nOut_faces
+)
+{
+    convhull_3d_build_internal(in_vertices, nVert, 0, out_faces, nOut_faces);
+}
+
+void convhull_3d_build_quickhull
+(
+    ch_vertex* const in_vertices,
+    const int nVert,
+    int** out_faces,
+    int* nOut_faces
+)
+{
+    convhull_3d_build_internal(in_vertices, nVert, 1, out_faces, nOut_faces);
+}
+
 void convhull_3d_export_obj
 (
     ch_vertex* const vertices,
@@ -28,9 +28,6 @@
  * George Papazafeiropoulos (c) 2014, originally distributed under the BSD
  * (2-clause) license. Taken from: https://github.com/leomccormack/convhull_3d
  *
- * ## Dependencies
- *   CBLAS (optional) for speed ups, especially for very large meshes
- *
  * @see [1] C. Bradford, Barber, David P. Dobkin and Hannu Huhdanpaa, "The
  *          Quickhull Algorithm for Convex Hull". Geometry Center Technical
  *          Report GCG53, July 30, 1993
@@ -87,6 +84,33 @@ void convhull_3d_build(/* Input arguments */
                        int** out_faces,
                        int* nOut_faces);
 
+/**
+ * Builds the 3-D convexhull, using the outside sets of the quickhull
+ * algorithm [1] to find the faces visible from each new point
+ *
+ * Each remaining point is assigned to one face that it can see, and the
+ * visible faces are then found by flood-filling from that face, rather than
+ * by testing all faces of the current hull. Points that cannot see any face
+ * are discarded. The points are added in the same order as with
+ * convhull_3d_build(), so the output is normally identical; this variant is
+ * much faster for large (e.g. 1000+ point) spherical grids.
+ *
+ * @param[in]  in_vertices Vector of input vertices; nVert x 1
+ * @param[in]  nVert       Number of vertices
+ * @param[out] out_faces   (&) output face indices; FLAT: nOut_faces x 3
+ * @param[out] nOut_faces  (&) number of output face indices
+ *
+ * @see [1] C. Bradford, Barber, David P. Dobkin and Hannu Huhdanpaa, "The
+ *          Quickhull Algorithm for Convex Hull". Geometry Center Technical
+ *          Report GCG53, July 30, 1993
+ */
+void convhull_3d_build_quickhull(/* Input arguments */
+                                 ch_vertex* const in_vertices,
+                                 const int nVert,
+                                 /* Output arguments */
+                                 int** out_faces,
+                                 int* nOut_faces);
+
 /**
  * Exports the vertices, face indices, and face normals, as an '.obj' file, ready
  * for the GPU.
@@ -58,6 +58,29 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     return st;
 }
 
+kiss_fftr_cfg kiss_fftr_copy(kiss_fftr_cfg src)
+{
+    kiss_fftr_cfg st = NULL;
+    size_t subsize = 0, memneeded;
+    int nfft;
+
+    if (!src)
+        return NULL;
+    nfft = src->substate->nfft;
+    kiss_fft_alloc (nfft, src->substate->inverse, NULL, &subsize);
+    memneeded = sizeof(struct kiss_fftr_state) + subsize + sizeof(kiss_fft_cpx) * ( nfft * 3 / 2);
+    st = (kiss_fftr_cfg) KISS_FFT_MALLOC (memneeded);
+    if (!st)
+        return NULL;
+
+    /* copy the twiddles/factors, and then re-point to the new memory */
+    memcpy(st, src, memneeded);
+    st->substate = (kiss_fft_cfg) (st + 1);
+    st->tmpbuf = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
+    st->super_twiddles = st->tmpbuf + nfft;
+    return st;
+}
+
 void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
 {
     /* input buffer timedata is stored row-wise */
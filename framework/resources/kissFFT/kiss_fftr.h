@@ -34,6 +34,15 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem, size_t * lenm
 */
 
 
+kiss_fftr_cfg kiss_fftr_copy(kiss_fftr_cfg cfg);
+/*
+ Returns a newly allocated copy of cfg, which has its own scratch space; the
+ twiddle factors are copied rather than recomputed. (Added for SAF, so that
+ configurations may be cached and shared across threads.)
+ Free with kiss_fftr_free()
+*/
+
+
 void kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata);
 /*
  input timedata has nfft scalar points
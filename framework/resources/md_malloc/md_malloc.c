@@ -46,11 +46,39 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#define MD_MALLOC_IMPLEMENTATION
 #include "md_malloc.h"
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+#if defined(__linux__)
+# include <sys/syscall.h>
+#endif
+#if !defined(_WIN32) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+# define MAP_ANONYMOUS MAP_ANON
+#endif
+#if defined(_MSC_VER)
+# define MD_THREAD_LOCAL __declspec(thread)
+#else
+# define MD_THREAD_LOCAL __thread
+#endif
+
+/* bytes requested by the calling thread (see md_getNumBytesRequested()) */
+static MD_THREAD_LOCAL size_t md_nBytesRequested = 0;
+
+size_t md_getNumBytesRequested(void)
+{
+    return md_nBytesRequested;
+}
 
 void* malloc1d(size_t dim1_data_size)
 {
     void *ptr = malloc(dim1_data_size);
+    md_nBytesRequested += dim1_data_size;
 #ifndef NDEBUG
     if (ptr == NULL)
         fprintf(stderr, "Error: 'malloc1d' failed to allocate %zu bytes.\n", dim1_data_size);
@@ -61,6 +89,7 @@ void* malloc1d(size_t dim1_data_size)
 void* calloc1d(size_t dim1, size_t data_size)
 {
     void *ptr = calloc(dim1, data_size);
+    md_nBytesRequested += dim1*data_size;
 #ifndef NDEBUG
     if (ptr == NULL)
         fprintf(stderr, "Error: 'calloc1d' failed to allocate %zu bytes.\n", dim1*data_size);
@@ -71,6 +100,7 @@ void* calloc1d(size_t dim1, size_t data_size)
 void* realloc1d(void* ptr, size_t dim1_data_size)
 {
     ptr = realloc(ptr, dim1_data_size);
+    md_nBytesRequested += dim1_data_size;
 #ifndef NDEBUG
     if (ptr == NULL)
         fprintf(stderr, "Error: 'realloc1d' failed to allocate %zu bytes.\n", dim1_data_size);
@@ -93,6 +123,7 @@ void** malloc2d(size_t dim1, size_t dim2, size_t data_size)
     unsigned char* p2;
     stride = dim2*data_size;
     ptr = malloc(dim1*sizeof(void*) + dim1*stride);
+    md_nBytesRequested += dim1*sizeof(void*) + dim1*stride;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'malloc2d' failed to allocate %zu bytes.\n", dim1*sizeof(void*) + dim1*stride);
@@ -110,6 +141,7 @@ void** calloc2d(size_t dim1, size_t dim2, size_t data_size)
     unsigned char* p2;
     stride = dim2*data_size;
     ptr = calloc(dim1, sizeof(void*) + stride);
+    md_nBytesRequested += dim1*sizeof(void*) + dim1*stride;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'calloc2d' failed to allocate %zu bytes.\n", dim1*sizeof(void*) + dim1*stride);
@@ -126,6 +158,7 @@ void** realloc2d(void** ptr, size_t dim1, size_t dim2, size_t data_size)
     unsigned char* p2;
     stride = dim2*data_size;
     ptr = realloc (ptr, dim1*sizeof(void*) + dim1*stride);
+    md_nBytesRequested += dim1*sizeof(void*) + dim1*stride;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'realloc2d' failed to allocate %zu bytes.\n", dim1*sizeof(void*) + dim1*stride);
@@ -153,6 +186,7 @@ void*** malloc3d(size_t dim1, size_t dim2, size_t dim3, size_t data_size)
     stride1 = dim2*dim3*data_size;
     stride2 = dim3*data_size;
     ptr = malloc(dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1);
+    md_nBytesRequested += dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'malloc3d' failed to allocate %zu bytes.\n", dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1);
@@ -176,6 +210,7 @@ void*** calloc3d(size_t dim1, size_t dim2, size_t dim3, size_t data_size)
     stride1 = dim2*dim3*data_size;
     stride2 = dim3*data_size;
     ptr = calloc(dim1, sizeof(void**) + dim2*sizeof(void*) + stride1);
+    md_nBytesRequested += dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'calloc3d' failed to allocate %zu bytes.\n", dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1);
@@ -198,6 +233,7 @@ void*** realloc3d(void*** ptr, size_t dim1, size_t dim2, size_t dim3, size_t dat
     stride1 = dim2*dim3*data_size;
     stride2 = dim3*data_size;
     ptr = realloc(ptr, dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1);
+    md_nBytesRequested += dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1;
 #ifndef NDEBUG
     if(ptr==NULL)
         fprintf(stderr, "Error: 'realloc3d' failed to allocate %zu bytes.\n", dim1*sizeof(void**) + dim1*dim2*sizeof(void*) + dim1*stride1);
@@ -220,3 +256,484 @@ void free3d(void**** ptr)
     }
 }
 
+
+
+/* Arena allocation */
+
+#define MD_ARENA_ALIGN_UP(x) ( ((x) + MD_ARENA_ALIGNMENT - 1) & ~((size_t)MD_ARENA_ALIGNMENT - 1) )
+
+typedef struct _md_arena {
+    unsigned char* raw;  /* backing allocation, as returned by calloc() */
+    unsigned char* base; /* first MD_ARENA_ALIGNMENT aligned byte of 'raw' */
+    size_t capacity;     /* usable bytes, starting from 'base' */
+    size_t used;         /* bytes taken so far (always a multiple of MD_ARENA_ALIGNMENT) */
+} md_arena;
+
+void arena_create(void** phArena, size_t capacity)
+{
+    md_arena* a;
+    *phArena = NULL;
+    a = malloc(sizeof(md_arena));
+    if(a==NULL)
+        return;
+    a->capacity = MD_ARENA_ALIGN_UP(capacity);
+    a->used = 0;
+    a->raw = calloc(a->capacity + MD_ARENA_ALIGNMENT, 1);
+    if(a->raw==NULL){
+#ifndef NDEBUG
+        fprintf(stderr, "Error: 'arena_create' failed to allocate %zu bytes.\n", a->capacity + MD_ARENA_ALIGNMENT);
+#endif
+        free(a);
+        return;
+    }
+    a->base = (unsigned char*)MD_ARENA_ALIGN_UP((size_t)a->raw);
+    *phArena = (void*)a;
+}
+
+void arena_destroy(void** phArena)
+{
+    md_arena* a = (md_arena*)(*phArena);
+    if(a!=NULL){
+        free(a->raw);
+        free(a);
+        *phArena = NULL;
+    }
+}
+
+void arena_reset(void* hArena)
+{
+    md_arena* a = (md_arena*)hArena;
+    a->used = 0;
+}
+
+size_t arena_getUsedBytes(void* hArena)
+{
+    md_arena* a = (md_arena*)hArena;
+    return a->used;
+}
+
+size_t arena_getCapacity(void* hArena)
+{
+    md_arena* a = (md_arena*)hArena;
+    return a->capacity;
+}
+
+size_t arena_size1d(size_t dim1_data_size)
+{
+    return MD_ARENA_ALIGN_UP(dim1_data_size);
+}
+
+size_t arena_size2d(size_t dim1, size_t dim2, size_t data_size)
+{
+    return MD_ARENA_ALIGN_UP(dim1*sizeof(void*)) + MD_ARENA_ALIGN_UP(dim1*dim2*data_size);
+}
+
+size_t arena_size3d(size_t dim1, size_t dim2, size_t dim3, size_t data_size)
+{
+    return MD_ARENA_ALIGN_UP(dim1*sizeof(void**) + dim1*dim2*sizeof(void*)) + MD_ARENA_ALIGN_UP(dim1*dim2*dim3*data_size);
+}
+
+void* arena_malloc1d_aligned(void* hArena, size_t dim1_data_size)
+{
+    md_arena* a = (md_arena*)hArena;
+    size_t size;
+    void* ptr;
+    size = MD_ARENA_ALIGN_UP(dim1_data_size);
+    if(a->used + size > a->capacity){
+#ifndef NDEBUG
+        fprintf(stderr, "Error: 'arena_malloc1d_aligned' failed to allocate %zu bytes (%zu of %zu bytes used).\n", dim1_data_size, a->used, a->capacity);
+#endif
+        return NULL;
+    }
+    ptr = (void*)(a->base + a->used);
+    a->used += size;
+    return ptr;
+}
+
+void* arena_calloc1d_aligned(void* hArena, size_t dim1, size_t data_size)
+{
+    void* ptr = arena_malloc1d_aligned(hArena, dim1*data_size);
+    if(ptr!=NULL)
+        memset(ptr, 0, dim1*data_size);
+    return ptr;
+}
+
+void** arena_malloc2d_aligned(void* hArena, size_t dim1, size_t dim2, size_t data_size)
+{
+    md_arena* a = (md_arena*)hArena;
+    size_t i, stride;
+    void** ptr;
+    unsigned char* p2;
+    stride = dim2*data_size;
+    if(a->used + arena_size2d(dim1, dim2, data_size) > a->capacity){
+#ifndef NDEBUG
+        fprintf(stderr, "Error: 'arena_malloc2d_aligned' failed to allocate %zu bytes (%zu of %zu bytes used).\n", arena_size2d(dim1, dim2, data_size), a->used, a->capacity);
+#endif
+        return NULL;
+    }
+    ptr = (void**)arena_malloc1d_aligned(hArena, dim1*sizeof(void*));
+    p2 = (unsigned char*)arena_malloc1d_aligned(hArena, dim1*stride);
+    for(i=0; i<dim1; i++)
+        ptr[i] = &p2[i*stride];
+    return ptr;
+}
+
+void** arena_calloc2d_aligned(void* hArena, size_t dim1, size_t dim2, size_t data_size)
+{
+    void** ptr = arena_malloc2d_aligned(hArena, dim1, dim2, data_size);
+    if(ptr!=NULL && dim1>0)
+        memset(ptr[0], 0, dim1*dim2*data_size);
+    return ptr;
+}
+
+void*** arena_malloc3d_aligned(void* hArena, size_t dim1, size_t dim2, size_t dim3, size_t data_size)
+{
+    md_arena* a = (md_arena*)hArena;
+    size_t i, j, stride1, stride2;
+    void*** ptr;
+    void** p2;
+    unsigned char* p3;
+    stride1 = dim2*dim3*data_size;
+    stride2 = dim3*data_size;
+    if(a->used + arena_size3d(dim1, dim2, dim3, data_size) > a->capacity){
+#ifndef NDEBUG
+        fprintf(stderr, "Error: 'arena_malloc3d_aligned' failed to allocate %zu bytes (%zu of %zu bytes used).\n", arena_size3d(dim1, dim2, dim3, data_size), a->used, a->capacity);
+#endif
+        return NULL;
+    }
+    ptr = (void***)arena_malloc1d_aligned(hArena, dim1*sizeof(void**) + dim1*dim2*sizeof(void*));
+    p3 = (unsigned char*)arena_malloc1d_aligned(hArena, dim1*stride1);
+    p2 = (void**)(ptr + dim1);
+    for(i=0;i<dim1;i++)
+        ptr[i] = &p2[i*dim2];
+    for(i=0;i<dim1;i++)
+        for(j=0;j<dim2;j++)
+            p2[i*dim2+j] = &p3[i*stride1 + j*stride2];
+    return ptr;
+}
+
+void*** arena_calloc3d_aligned(void* hArena, size_t dim1, size_t dim2, size_t dim3, size_t data_size)
+{
+    void*** ptr = arena_malloc3d_aligned(hArena, dim1, dim2, dim3, data_size);
+    if(ptr!=NULL && dim1>0 && dim2>0)
+        memset(ptr[0][0], 0, dim1*dim2*dim3*data_size);
+    return ptr;
+}
+
+
+/* Large tables */
+
+/* Bytes in front of each large table (keeping the table 64-byte aligned) */
+#define MD_LARGE_HEADER_SIZE ( 64 )
+/* Size of the huge pages that the mappings are aligned to (Linux/x86_64) */
+#define MD_LARGE_HUGE_PAGE_SIZE ( 2*1024*1024 )
+/* Linux memory policy: preferably allocate on the given node */
+#define MD_LARGE_MPOL_PREFERRED ( 1 )
+
+/* Header in front of each large table */
+typedef struct _md_large_header {
+    void* base;     /* start of the allocation, or of the mapping */
+    size_t size;    /* bytes requested */
+    size_t mapSize; /* bytes mapped (0: allocated with malloc()) */
+} md_large_header;
+
+static volatile int md_large_flags = 0;
+
+void md_large_setFlags(int flags)
+{
+    md_large_flags = flags & (MD_LARGE_HUGE_PAGES | MD_LARGE_NUMA_LOCAL);
+}
+
+int md_large_getFlags(void)
+{
+    return md_large_flags;
+}
+
+/* Maps (at least) 'size' zeroed bytes from the OS with the given options, or
+ * returns NULL if this is not possible */
+static void* md_large_map(size_t size, int flags, size_t* mapSize)
+{
+#if defined(_WIN32)
+    void* base;
+    SIZE_T largePage, len;
+    PROCESSOR_NUMBER proc;
+    USHORT node;
+    int useNode;
+
+    useNode = 0;
+    if(flags & MD_LARGE_NUMA_LOCAL){
+        GetCurrentProcessorNumberEx(&proc);
+        useNode = GetNumaProcessorNodeEx(&proc, &node) ? 1 : 0;
+    }
+    base = NULL;
+    largePage = (flags & MD_LARGE_HUGE_PAGES) ? GetLargePageMinimum() : 0;
+    if(largePage>0){
+        /* (fails without the "Lock pages in memory" privilege) */
+        len = (size + largePage - 1)/largePage*largePage;
+        base = useNode ? VirtualAllocExNuma(GetCurrentProcess(), NULL, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node) :
+                         VirtualAlloc(NULL, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+    if(base==NULL && useNode){
+        len = size;
+        base = VirtualAllocExNuma(GetCurrentProcess(), NULL, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+    }
+    if(base==NULL)
+        return NULL;
+    *mapSize = (size_t)len;
+    return base;
+#elif defined(MAP_ANONYMOUS)
+    unsigned char *raw, *base;
+    size_t pageSize, align, len, head, tail;
+
+    /* map enough to trim the mapping to a multiple of, and aligned to, the huge
+     * page size (the kernel only backs whole, aligned huge pages) */
+    pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    align = (flags & MD_LARGE_HUGE_PAGES) ? MD_LARGE_HUGE_PAGE_SIZE : pageSize;
+    align = align < pageSize ? pageSize : align;
+    len = (size + align - 1)/align*align;
+    raw = (unsigned char*)mmap(NULL, len + align - pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(raw==(unsigned char*)MAP_FAILED)
+        return NULL;
+    base = (unsigned char*)(((size_t)raw + align - 1)/align*align);
+    head = (size_t)(base - raw);
+    tail = (align - pageSize) - head;
+    if(head>0)
+        munmap(raw, head);
+    if(tail>0)
+        munmap(base + len, tail);
+# if defined(MADV_HUGEPAGE)
+    if(flags & MD_LARGE_HUGE_PAGES)
+        madvise(base, len, MADV_HUGEPAGE);
+# endif
+# if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+    /* (the pages are not touched yet, so they are all placed by the policy) */
+    if(flags & MD_LARGE_NUMA_LOCAL){
+        unsigned int cpu, node;
+        unsigned long nodeMask[16];
+        if(syscall(SYS_getcpu, &cpu, &node, NULL)==0 && node < 8*sizeof(nodeMask)){
+            memset(nodeMask, 0, sizeof(nodeMask));
+            nodeMask[node/(8*sizeof(unsigned long))] = 1UL << (node%(8*sizeof(unsigned long)));
+            syscall(SYS_mbind, base, len, MD_LARGE_MPOL_PREFERRED, nodeMask, 8*sizeof(nodeMask)+1, 0);
+        }
+    }
+# endif
+    *mapSize = len;
+    return base;
+#else
+    (void)size; (void)flags; (void)mapSize;
+    return NULL;
+#endif
+}
+
+static void* md_large_alloc(const char* func, size_t dim1_data_size, int zero)
+{
+    md_large_header* h;
+    unsigned char *base, *ptr;
+    size_t total, mapSize;
+    int flags;
+
+    md_nBytesRequested += dim1_data_size;
+    total = dim1_data_size + MD_LARGE_HEADER_SIZE;
+    flags = md_large_flags;
+    if((flags & MD_LARGE_HUGE_PAGES) && total < MD_LARGE_HUGE_PAGE_SIZE/2)
+        flags &= ~MD_LARGE_HUGE_PAGES; /* (would waste most of a huge page) */
+
+    /* mapped from the OS */
+    if(flags!=0 && total >= MD_LARGE_MIN_MAPPED_SIZE){
+        mapSize = 0;
+        base = (unsigned char*)md_large_map(total, flags, &mapSize);
+        if(base!=NULL){
+            ptr = base + MD_LARGE_HEADER_SIZE;
+            h = (md_large_header*)(ptr - MD_LARGE_HEADER_SIZE);
+            h->base = base;
+            h->size = dim1_data_size;
+            h->mapSize = mapSize;
+            return ptr; /* (already zeroed) */
+        }
+    }
+
+    /* or with malloc() */
+    base = (unsigned char*)malloc(total + MD_LARGE_HEADER_SIZE - 1);
+    if(base==NULL){
+#ifndef NDEBUG
+        fprintf(stderr, "Error: '%s' failed to allocate %zu bytes.\n", func, dim1_data_size);
+#endif
+        return NULL;
+    }
+    ptr = (unsigned char*)(((size_t)base + 2*MD_LARGE_HEADER_SIZE - 1)/MD_LARGE_HEADER_SIZE*MD_LARGE_HEADER_SIZE);
+    h = (md_large_header*)(ptr - MD_LARGE_HEADER_SIZE);
+    h->base = base;
+    h->size = dim1_data_size;
+    h->mapSize = 0;
+    if(zero)
+        memset(ptr, 0, dim1_data_size);
+    return ptr;
+}
+
+void* malloc1d_large(size_t dim1_data_size)
+{
+    return md_large_alloc("malloc1d_large", dim1_data_size, 0);
+}
+
+void* calloc1d_large(size_t dim1, size_t data_size)
+{
+    return md_large_alloc("calloc1d_large", dim1*data_size, 1);
+}
+
+void* realloc1d_large(void* ptr, size_t dim1_data_size)
+{
+    unsigned char* newPtr;
+    size_t oldSize;
+
+    if(ptr==NULL)
+        return md_large_alloc("realloc1d_large", dim1_data_size, 0);
+    oldSize = ((md_large_header*)((unsigned char*)ptr - MD_LARGE_HEADER_SIZE))->size;
+
+    /* (the new table is placed according to the current options) */
+    newPtr = (unsigned char*)md_large_alloc("realloc1d_large", dim1_data_size, 0);
+    if(newPtr==NULL)
+        return NULL; /* (and 'ptr' remains valid, as with realloc()) */
+    memcpy(newPtr, ptr, oldSize < dim1_data_size ? oldSize : dim1_data_size);
+    free1d_large(ptr);
+    return newPtr;
+}
+
+void free1d_large(void* ptr)
+{
+    md_large_header* h;
+
+    if(ptr==NULL)
+        return;
+    h = (md_large_header*)((unsigned char*)ptr - MD_LARGE_HEADER_SIZE);
+    if(h->mapSize>0){
+#if defined(_WIN32)
+        VirtualFree(h->base, 0, MEM_RELEASE);
+#elif defined(MAP_ANONYMOUS)
+        munmap(h->base, h->mapSize);
+#endif
+    }
+    else
+        free(h->base);
+}
+
+int md_large_isMapped(void* ptr)
+{
+    if(ptr==NULL)
+        return 0;
+    return ((md_large_header*)((unsigned char*)ptr - MD_LARGE_HEADER_SIZE))->mapSize > 0;
+}
+
+
+/* Real-time allocation guard */
+
+typedef struct _md_rtguard_site {
+    const char* func;
+    const char* file;
+    int line;
+    unsigned long nCalls;
+    size_t totalBytes;
+    size_t maxBytes;
+} md_rtguard_site;
+
+static MD_THREAD_LOCAL int md_rtguard_isRT = 0;
+static md_rtguard_site md_rtguard_sites[MD_RTGUARD_MAX_NUM_SITES];
+static int md_rtguard_nSites = 0;
+static unsigned long md_rtguard_nCalls = 0;
+static unsigned long md_rtguard_nDropped = 0; /* calls from sites beyond MD_RTGUARD_MAX_NUM_SITES */
+#if defined(_WIN32)
+static SRWLOCK md_rtguard_lock = SRWLOCK_INIT;
+# define MD_RTGUARD_LOCK()   AcquireSRWLockExclusive(&md_rtguard_lock)
+# define MD_RTGUARD_UNLOCK() ReleaseSRWLockExclusive(&md_rtguard_lock)
+#else
+static pthread_mutex_t md_rtguard_lock = PTHREAD_MUTEX_INITIALIZER;
+# define MD_RTGUARD_LOCK()   pthread_mutex_lock(&md_rtguard_lock)
+# define MD_RTGUARD_UNLOCK() pthread_mutex_unlock(&md_rtguard_lock)
+#endif
+
+void md_rtguard_setRealTimeThread(int isRealTime)
+{
+    md_rtguard_isRT = isRealTime ? 1 : 0;
+}
+
+int md_rtguard_isRealTimeThread(void)
+{
+    return md_rtguard_isRT;
+}
+
+unsigned long md_rtguard_getNumCalls(void)
+{
+    unsigned long nCalls;
+    MD_RTGUARD_LOCK();
+    nCalls = md_rtguard_nCalls;
+    MD_RTGUARD_UNLOCK();
+    return nCalls;
+}
+
+void md_rtguard_printReport(FILE* stream)
+{
+    int i;
+    MD_RTGUARD_LOCK();
+#ifndef MD_MALLOC_RT_GUARD
+    fprintf(stream, "md_rtguard: disabled (define MD_MALLOC_RT_GUARD to enable)\n");
+#endif
+    fprintf(stream, "md_rtguard: %lu allocation(s)/free(s) from real-time threads, at %d call site(s)\n", md_rtguard_nCalls, md_rtguard_nSites);
+    for(i=0; i<md_rtguard_nSites; i++)
+        fprintf(stream, "  %s:%d: %s, %lu call(s), %zu bytes in total, %zu bytes at most\n", md_rtguard_sites[i].file, md_rtguard_sites[i].line,
+                md_rtguard_sites[i].func, md_rtguard_sites[i].nCalls, md_rtguard_sites[i].totalBytes, md_rtguard_sites[i].maxBytes);
+    if(md_rtguard_nDropped>0)
+        fprintf(stream, "  (%lu call(s) from further call sites were not itemised)\n", md_rtguard_nDropped);
+    MD_RTGUARD_UNLOCK();
+}
+
+void md_rtguard_reset(void)
+{
+    MD_RTGUARD_LOCK();
+    md_rtguard_nSites = 0;
+    md_rtguard_nCalls = 0;
+    md_rtguard_nDropped = 0;
+    MD_RTGUARD_UNLOCK();
+}
+
+/* adds a call to the report (only called from real-time threads) */
+static void md_rtguard_add(const char* func, size_t bytes, const char* file, int line)
+{
+    int i;
+    MD_RTGUARD_LOCK();
+    md_rtguard_nCalls++;
+    for(i=0; i<md_rtguard_nSites; i++)
+        if(md_rtguard_sites[i].line==line && md_rtguard_sites[i].func==func && strcmp(md_rtguard_sites[i].file, file)==0)
+            break;
+    if(i==md_rtguard_nSites){
+        if(md_rtguard_nSites==MD_RTGUARD_MAX_NUM_SITES){
+            md_rtguard_nDropped++;
+            MD_RTGUARD_UNLOCK();
+            return;
+        }
+        md_rtguard_sites[i].func = func;
+        md_rtguard_sites[i].file = file;
+        md_rtguard_sites[i].line = line;
+        md_rtguard_sites[i].nCalls = 0;
+        md_rtguard_sites[i].totalBytes = 0;
+        md_rtguard_sites[i].maxBytes = 0;
+        md_rtguard_nSites++;
+    }
+    md_rtguard_sites[i].nCalls++;
+    md_rtguard_sites[i].totalBytes += bytes;
+    if(bytes>md_rtguard_sites[i].maxBytes)
+        md_rtguard_sites[i].maxBytes = bytes;
+    MD_RTGUARD_UNLOCK();
+}
+
+size_t md_rtguard_record(const char* func, size_t pass, size_t bytes, const char* file, int line)
+{
+    if(md_rtguard_isRT)
+        md_rtguard_add(func, bytes, file, line);
+    return pass;
+}
+
+void* md_rtguard_recordPtr(const char* func, void* ptr, const char* file, int line)
+{
+    if(md_rtguard_isRT)
+        md_rtguard_add(func, 0, file, line);
+    return ptr;
+}
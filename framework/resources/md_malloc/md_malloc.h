@@ -38,6 +38,25 @@
  *   free(example3D);
  * \endcode
  *
+ *
+ * The arena functions instead carve all of the "arrays" of e.g. one processor
+ * instance out of a single backing allocation, with every "array" starting on
+ * a MD_ARENA_ALIGNMENT byte boundary:
+ * \code{.c}
+ *   void* hArena;
+ *   arena_create(&hArena, arena_size2d(64, 1024, sizeof(float)) +
+ *                         arena_size1d(512*sizeof(float)));
+ *   float** frame = (float**)arena_malloc2d_aligned(hArena, 64, 1024, sizeof(float));
+ *   float* buffer = (float*)arena_malloc1d_aligned(hArena, 512*sizeof(float));
+ *   // ... no need to free 'frame' or 'buffer' individually, simply call:
+ *   arena_destroy(&hArena);
+ * \endcode
+ *
+ * Defining MD_MALLOC_RT_GUARD (for the whole build) enables a debug mode, in
+ * which all allocations (and calls to free()) made from a thread that has been
+ * marked with md_rtguard_setRealTimeThread() are recorded, along with their
+ * call sites; see md_rtguard_printReport().
+ *
  * @author Leo McCormack
  * @date 11.06.2019
  */
@@ -45,6 +64,10 @@
 #ifndef MD_MALLOC_INCLUDED
 #define MD_MALLOC_INCLUDED
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -101,6 +124,186 @@ void*** realloc3d(void*** ptr, size_t dim1, size_t dim2, size_t dim3, size_t dat
 /**
  * 3-D free */
 void free3d(void**** ptr);
+/**
+ * Returns the total number of bytes requested by the calling thread, through
+ * the functions above (i.e. not accounting for frees); the difference between
+ * two calls gives the bytes allocated in-between, e.g. by an initialisation */
+size_t md_getNumBytesRequested(void);
+
+
+/* Alignment (in bytes) of all arena allocations; i.e. a cache line, and enough
+ * for aligned AVX-512 loads/stores */
+#define MD_ARENA_ALIGNMENT ( 64 )
+
+/**
+ * Creates an arena, with one backing allocation of (at least) 'capacity' bytes
+ *
+ * The sizes returned by arena_size1d(), arena_size2d() and arena_size3d() may
+ * be summed to obtain the capacity required for a given set of "arrays".
+ * The backing allocation is zero initialised.
+ */
+void arena_create(void** phArena, size_t capacity);
+/**
+ * Destroys an arena (and with it, all of the "arrays" allocated from it) */
+void arena_destroy(void** phArena);
+/**
+ * Discards all of the "arrays" allocated from an arena (without freeing the
+ * backing allocation), so that it may be filled again */
+void arena_reset(void* hArena);
+/**
+ * Returns the number of bytes allocated from an arena so far (including the
+ * alignment padding) */
+size_t arena_getUsedBytes(void* hArena);
+/**
+ * Returns the capacity of an arena, in bytes */
+size_t arena_getCapacity(void* hArena);
+
+/**
+ * Number of arena bytes required by arena_malloc1d_aligned() */
+size_t arena_size1d(size_t dim1_data_size);
+/**
+ * Number of arena bytes required by arena_malloc2d_aligned() */
+size_t arena_size2d(size_t dim1, size_t dim2, size_t data_size);
+/**
+ * Number of arena bytes required by arena_malloc3d_aligned() */
+size_t arena_size3d(size_t dim1, size_t dim2, size_t dim3, size_t data_size);
+
+/**
+ * 1-D malloc from an arena; aligned to MD_ARENA_ALIGNMENT bytes
+ *
+ * @returns The allocation, or NULL if the arena does not have enough capacity
+ *          left
+ */
+void* arena_malloc1d_aligned(void* hArena, size_t dim1_data_size);
+/**
+ * 1-D calloc from an arena; aligned to MD_ARENA_ALIGNMENT bytes */
+void* arena_calloc1d_aligned(void* hArena, size_t dim1, size_t data_size);
+/**
+ * 2-D malloc from an arena
+ *
+ * As with malloc2d(), the data is contiguous (i.e. ADR2D() may be used); and
+ * its first element is aligned to MD_ARENA_ALIGNMENT bytes. Therefore, the
+ * rows are also aligned whenever dim2*data_size is a multiple of
+ * MD_ARENA_ALIGNMENT (e.g. frames of 16*k floats).
+ *
+ * @returns The allocation, or NULL if the arena does not have enough capacity
+ *          left
+ */
+void** arena_malloc2d_aligned(void* hArena, size_t dim1, size_t dim2, size_t data_size);
+/**
+ * 2-D calloc from an arena; see arena_malloc2d_aligned() */
+void** arena_calloc2d_aligned(void* hArena, size_t dim1, size_t dim2, size_t data_size);
+/**
+ * 3-D malloc from an arena; contiguous, with its first element aligned to
+ * MD_ARENA_ALIGNMENT bytes (see arena_malloc2d_aligned()) */
+void*** arena_malloc3d_aligned(void* hArena, size_t dim1, size_t dim2, size_t dim3, size_t data_size);
+/**
+ * 3-D calloc from an arena; see arena_malloc3d_aligned() */
+void*** arena_calloc3d_aligned(void* hArena, size_t dim1, size_t dim2, size_t dim3, size_t data_size);
+
+
+/* Large tables
+ *
+ * Large, randomly accessed, read-mostly tables (e.g. VBAP gain tables) may
+ * instead be allocated with malloc1d_large() (and must then be freed with
+ * free1d_large()). Depending on md_large_setFlags(), these are mapped directly
+ * from the OS: backed by huge pages (transparent huge pages via madvise() on
+ * Linux, or large pages via VirtualAlloc() on Windows; the latter requiring
+ * the "Lock pages in memory" privilege), such that fewer TLB entries cover the
+ * table; and/or placed on the NUMA node of the CPU that the calling thread is
+ * running on (i.e. create and initialise an instance on the thread, or a
+ * thread on the socket, that will process it). Any option that is not
+ * available falls back to the default allocation; as do tables smaller than
+ * MD_LARGE_MIN_MAPPED_SIZE. */
+
+/* Back large tables with huge pages, if possible */
+#define MD_LARGE_HUGE_PAGES ( 1 )
+/* Place large tables on the NUMA node of the allocating thread, if possible */
+#define MD_LARGE_NUMA_LOCAL ( 2 )
+/* Tables smaller than this (in bytes) are always allocated with malloc() */
+#define MD_LARGE_MIN_MAPPED_SIZE ( 256*1024 )
+
+/**
+ * Sets the options for all subsequent large tables (any combination of
+ * MD_LARGE_HUGE_PAGES and MD_LARGE_NUMA_LOCAL; default: 0, i.e. malloc()) */
+void md_large_setFlags(int flags);
+/**
+ * Returns the options for large tables */
+int md_large_getFlags(void);
+/**
+ * 1-D malloc of a large table (aligned to at least 64 bytes); to be freed
+ * with free1d_large() */
+void* malloc1d_large(size_t dim1_data_size);
+/**
+ * 1-D calloc of a large table; see malloc1d_large() */
+void* calloc1d_large(size_t dim1, size_t data_size);
+/**
+ * 1-D realloc of a large table (NULL: same as malloc1d_large()) */
+void* realloc1d_large(void* ptr, size_t dim1_data_size);
+/**
+ * Frees a large table (NULL is ignored) */
+void free1d_large(void* ptr);
+/**
+ * Returns 1 if a large table is mapped directly from the OS (i.e. with the
+ * options of md_large_setFlags()), 0 if it was allocated with malloc() */
+int md_large_isMapped(void* ptr);
+
+
+/* Real-time allocation guard */
+
+/* Maximum number of distinct call sites recorded by the real-time guard */
+#define MD_RTGUARD_MAX_NUM_SITES ( 256 )
+
+/**
+ * Marks (1) or unmarks (0) the calling thread as a real-time thread; e.g. at
+ * the start and end of an audio callback
+ */
+void md_rtguard_setRealTimeThread(int isRealTime);
+/**
+ * Returns 1 if the calling thread is currently marked as real-time */
+int md_rtguard_isRealTimeThread(void);
+/**
+ * Returns the total number of allocations/frees recorded from real-time
+ * threads (always 0, unless MD_MALLOC_RT_GUARD is defined) */
+unsigned long md_rtguard_getNumCalls(void);
+/**
+ * Prints the recorded call sites (function, file, line, number of calls, and
+ * the total/largest number of bytes requested) to the given stream (e.g.
+ * stderr) */
+void md_rtguard_printReport(FILE* stream);
+/**
+ * Clears all recorded call sites */
+void md_rtguard_reset(void);
+
+/**
+ * Records a call to 'func' if the calling thread is real-time, and returns
+ * 'pass' (used by the MD_MALLOC_RT_GUARD macros below) */
+size_t md_rtguard_record(const char* func, size_t pass, size_t bytes, const char* file, int line);
+/**
+ * Records a call to 'func' if the calling thread is real-time, and returns
+ * 'ptr' (used by the MD_MALLOC_RT_GUARD macros below) */
+void* md_rtguard_recordPtr(const char* func, void* ptr, const char* file, int line);
+
+#if defined(MD_MALLOC_RT_GUARD) && !defined(MD_MALLOC_IMPLEMENTATION)
+/* Note that the trailing size arguments may be evaluated twice */
+# define malloc1d(s)           malloc1d(md_rtguard_record("malloc1d", (s), (s), __FILE__, __LINE__))
+# define calloc1d(d1, s)       calloc1d(md_rtguard_record("calloc1d", (d1), (d1)*(s), __FILE__, __LINE__), (s))
+# define realloc1d(p, s)       realloc1d((p), md_rtguard_record("realloc1d", (s), (s), __FILE__, __LINE__))
+# define free1d(p)             free1d((void**)md_rtguard_recordPtr("free1d", (void*)(p), __FILE__, __LINE__))
+# define malloc2d(d1, d2, s)   malloc2d(md_rtguard_record("malloc2d", (d1), (d1)*(d2)*(s), __FILE__, __LINE__), (d2), (s))
+# define calloc2d(d1, d2, s)   calloc2d(md_rtguard_record("calloc2d", (d1), (d1)*(d2)*(s), __FILE__, __LINE__), (d2), (s))
+# define realloc2d(p, d1, d2, s) realloc2d((p), md_rtguard_record("realloc2d", (d1), (d1)*(d2)*(s), __FILE__, __LINE__), (d2), (s))
+# define free2d(p)             free2d((void***)md_rtguard_recordPtr("free2d", (void*)(p), __FILE__, __LINE__))
+# define malloc3d(d1, d2, d3, s) malloc3d(md_rtguard_record("malloc3d", (d1), (d1)*(d2)*(d3)*(s), __FILE__, __LINE__), (d2), (d3), (s))
+# define calloc3d(d1, d2, d3, s) calloc3d(md_rtguard_record("calloc3d", (d1), (d1)*(d2)*(d3)*(s), __FILE__, __LINE__), (d2), (d3), (s))
+# define realloc3d(p, d1, d2, d3, s) realloc3d((p), md_rtguard_record("realloc3d", (d1), (d1)*(d2)*(d3)*(s), __FILE__, __LINE__), (d2), (d3), (s))
+# define free3d(p)             free3d((void****)md_rtguard_recordPtr("free3d", (void*)(p), __FILE__, __LINE__))
+# define malloc1d_large(s)     malloc1d_large(md_rtguard_record("malloc1d_large", (s), (s), __FILE__, __LINE__))
+# define calloc1d_large(d1, s) calloc1d_large(md_rtguard_record("calloc1d_large", (d1), (d1)*(s), __FILE__, __LINE__), (s))
+# define realloc1d_large(p, s) realloc1d_large((p), md_rtguard_record("realloc1d_large", (s), (s), __FILE__, __LINE__))
+# define free1d_large(p)       free1d_large(md_rtguard_recordPtr("free1d_large", (void*)(p), __FILE__, __LINE__))
+# define free(p)               free(md_rtguard_recordPtr("free", (void*)(p), __FILE__, __LINE__))
+#endif /* MD_MALLOC_RT_GUARD */
 
 
 #ifdef __cplusplus